@@ -76,6 +76,7 @@ LOCAL_SRC_FILES := \
     src/client/linux/handler/minidump_descriptor.cc \
     src/client/linux/log/log.cc \
     src/client/linux/microdump_writer/microdump_writer.cc \
+    src/client/linux/minidump_writer/file_identifier_cache.cc \
     src/client/linux/minidump_writer/linux_dumper.cc \
     src/client/linux/minidump_writer/linux_ptrace_dumper.cc \
     src/client/linux/minidump_writer/minidump_writer.cc \
@@ -62,6 +62,10 @@
 #define BREAKPAD_SERVER_TYPE           "BreakpadServerType"
 #define BREAKPAD_SERVER_PARAMETER_DICT "BreakpadServerParameters"
 #define BREAKPAD_IN_PROCESS            "BreakpadInProcess"
+#define BREAKPAD_PRELAUNCH_INSPECTOR   "BreakpadPrelaunchInspector"
+#define BREAKPAD_COMPRESS_UPLOADS      "BreakpadCompressUploads"
+#define BREAKPAD_UPLOAD_PRIORITY       "BreakpadUploadPriority"
+#define BREAKPAD_RAW_CAPTURE           "BreakpadRawCapture"
 
 // The keys below are NOT user supplied, and are used internally.
 #define BREAKPAD_PROCESS_START_TIME       "BreakpadProcStartTime"
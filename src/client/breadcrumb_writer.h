@@ -0,0 +1,92 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// breadcrumb_writer.h: Writes the breadcrumbs held by a BreadcrumbBuffer to
+// a minidump's MD_BREADCRUMB_STREAM.
+
+#ifndef CLIENT_BREADCRUMB_WRITER_H__
+#define CLIENT_BREADCRUMB_WRITER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "client/minidump_file_writer-inl.h"
+#include "common/breadcrumb_buffer.h"
+#include "google_breakpad/common/minidump_format.h"
+
+namespace google_breakpad {
+
+// Writes the breadcrumbs of each thread in |breadcrumbs|, one thread after
+// the other, and fills in |dirent|. Doesn't allocate, so it can run in a
+// crash handler. Returns false if the stream could not be written.
+inline bool WriteBreadcrumbStream(MinidumpFileWriter* writer,
+                                  const BreadcrumbBuffer& breadcrumbs,
+                                  MDRawDirectory* dirent) {
+  TypedMDRVA<MDRawBreadcrumbList> list(writer);
+  if (!list.Allocate())
+    return false;
+  list.get()->version = MD_BREADCRUMB_VERSION;
+  list.get()->thread_count = 0;
+
+  for (size_t index = 0; index < breadcrumbs.max_threads(); ++index) {
+    BreadcrumbBuffer::ThreadBreadcrumbs thread;
+    if (!breadcrumbs.ReadThread(index, &thread))
+      continue;
+
+    // A thread may have crashed between claiming its ring and filling in
+    // its first breadcrumb.
+    uint32_t count = static_cast<uint32_t>(thread.recorded_count -
+                                           thread.first);
+    if (!count)
+      continue;
+    TypedMDRVA<MDRawBreadcrumbThread> raw_thread(writer);
+    if (!raw_thread.AllocateObjectAndArray(count, sizeof(MDRawBreadcrumb)))
+      return false;
+    raw_thread.get()->thread_id = thread.thread_id;
+    raw_thread.get()->breadcrumb_count = count;
+    raw_thread.get()->recorded_count = thread.recorded_count;
+    for (uint32_t i = 0; i < count; ++i) {
+      if (!raw_thread.CopyIndexAfterObject(
+              i, &breadcrumbs.GetBreadcrumb(index, thread.first + i),
+              sizeof(MDRawBreadcrumb)))
+        return false;
+    }
+    ++list.get()->thread_count;
+  }
+
+  // The threads follow the list header, so the stream runs to the end of
+  // the last one.
+  dirent->stream_type = MD_BREADCRUMB_STREAM;
+  dirent->location.rva = list.position();
+  dirent->location.data_size = writer->position() - list.position();
+  return true;
+}
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_BREADCRUMB_WRITER_H__
@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crashpad_info_writer.h: Writes a map of annotations, such as a
+// ConcurrentStringDictionary, to a minidump as the simple annotations of an
+// MD_CRASHPAD_INFO_STREAM, which the processor's MinidumpCrashpadInfo reads.
+
+#ifndef CLIENT_CRASHPAD_INFO_WRITER_H__
+#define CLIENT_CRASHPAD_INFO_WRITER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "client/minidump_file_writer-inl.h"
+#include "google_breakpad/common/minidump_format.h"
+
+namespace google_breakpad {
+
+// Writes |length| bytes of |str| as a length-prefixed UTF-8 string, setting
+// |rva| to where it starts.
+inline bool WriteCrashpadInfoString(MinidumpFileWriter* writer,
+                                    const char* str, uint32_t length,
+                                    MDRVA* rva) {
+  UntypedMDRVA mdstring(writer);
+  if (!mdstring.Allocate(sizeof(length) + length + 1))
+    return false;
+  const char terminator = '\0';
+  if (!mdstring.Copy(mdstring.position(), &length, sizeof(length)) ||
+      !mdstring.Copy(mdstring.position() + sizeof(length), str, length) ||
+      !mdstring.Copy(mdstring.position() + sizeof(length) + length,
+                     &terminator, 1))
+    return false;
+  *rva = mdstring.position();
+  return true;
+}
+
+// Writes the entries of |annotations| that have values and fills in
+// |dirent|. |Annotations| is a map such as ConcurrentStringDictionary,
+// whose entries are read with ReadEntry(), so this does not allocate and
+// can run in a crash handler. Returns false if the stream could not be
+// written.
+template <typename Annotations>
+bool WriteCrashpadInfoStream(MinidumpFileWriter* writer,
+                             const Annotations& annotations,
+                             MDRawDirectory* dirent) {
+  TypedMDRVA<MDRawCrashpadInfo> info(writer);
+  if (!info.Allocate())
+    return false;
+  memset(info.get(), 0, sizeof(MDRawCrashpadInfo));
+  info.get()->version = 1;
+
+  // Room is made for every entry, as they are read only once; the count
+  // and data size cover just those with values.
+  TypedMDRVA<MDRawSimpleStringDictionary> dictionary(writer);
+  if (!dictionary.AllocateObjectAndArray(
+          Annotations::num_entries, sizeof(MDRawSimpleStringDictionaryEntry)))
+    return false;
+
+  uint32_t count = 0;
+  typename Annotations::Entry entry;
+  for (size_t i = 0; i < Annotations::num_entries; ++i) {
+    if (!annotations.ReadEntry(i, &entry))
+      continue;
+    MDRawSimpleStringDictionaryEntry raw_entry;
+    if (!WriteCrashpadInfoString(
+            writer, entry.key,
+            static_cast<uint32_t>(strnlen(entry.key, sizeof(entry.key))),
+            &raw_entry.key) ||
+        !WriteCrashpadInfoString(
+            writer, entry.value,
+            static_cast<uint32_t>(strnlen(entry.value, sizeof(entry.value))),
+            &raw_entry.value))
+      return false;
+    if (!dictionary.CopyIndexAfterObject(count++, &raw_entry,
+                                         sizeof(raw_entry)))
+      return false;
+  }
+  dictionary.get()->count = count;
+
+  info.get()->simple_annotations.rva = dictionary.position();
+  info.get()->simple_annotations.data_size =
+      sizeof(MDRawSimpleStringDictionary) +
+      count * sizeof(MDRawSimpleStringDictionaryEntry);
+
+  dirent->stream_type = MD_CRASHPAD_INFO_STREAM;
+  dirent->location = info.location();
+  return true;
+}
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_CRASHPAD_INFO_WRITER_H__
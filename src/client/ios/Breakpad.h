@@ -119,6 +119,22 @@ typedef void (*BreakpadUploadCompletionCallback)(NSString* report_id,
 //                                but pass as URL parameters when
 //                                uploading theminidump to the crash
 //                                server.
+//
+// BREAKPAD_COMPRESS_UPLOADS      If YES, reports are gzip-compressed when
+//                                uploaded, where the OS supports it (iOS
+//                                13 on).  The server must accept request
+//                                bodies with a Content-Encoding of gzip.
+//
+// BREAKPAD_UPLOAD_PRIORITY       The priority of uploads against the
+//                                application's other network traffic,
+//                                from 0.0 to 1.0.  Defaults to 0.5.
+//
+// BREAKPAD_RAW_CAPTURE           If YES, a crash only records the threads'
+//                                states and stacks and where the images
+//                                were loaded, and the minidump is written
+//                                from that by BreakpadConvertRawCaptures,
+//                                normally on the next launch.  This does
+//                                less in the crashing process.
 //=============================================================================
 // The BREAKPAD_PRODUCT, BREAKPAD_VERSION and BREAKPAD_URL are
 // required to have non-NULL values.  By default, the BREAKPAD_PRODUCT
@@ -206,6 +222,12 @@ void BreakpadRemoveUploadParameter(BreakpadRef ref, NSString* key);
 // Returns the number of crash reports waiting to send to the server.
 int BreakpadGetCrashReportCount(BreakpadRef ref);
 
+// Writes the minidumps for the raw captures left by earlier launches (see
+// BREAKPAD_RAW_CAPTURE), before their reports are uploaded.  This does
+// file I/O, so call it off the main thread.  Returns the number of
+// minidumps written.
+int BreakpadConvertRawCaptures(BreakpadRef ref);
+
 // Returns the next upload configuration. The report file is deleted.
 NSDictionary* BreakpadGetNextReportConfiguration(BreakpadRef ref);
 
@@ -225,7 +247,8 @@ void BreakpadUploadNextReportWithParameters(
 // Upload a report to the server.
 // |server_parameters| is additional server parameters to send.
 // |configuration| is the configuration of the breakpad report to send.
-void BreakpadUploadReportWithParametersAndConfiguration(
+// Returns YES if the server accepted the report.
+BOOL BreakpadUploadReportWithParametersAndConfiguration(
     BreakpadRef ref,
     NSDictionary* server_parameters,
     NSDictionary* configuration,
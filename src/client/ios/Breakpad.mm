@@ -86,6 +86,11 @@ using google_breakpad::LongStringDictionary;
 ProtectedMemoryAllocator* gMasterAllocator = NULL;
 ProtectedMemoryAllocator* gKeyValueAllocator = NULL;
 ProtectedMemoryAllocator* gBreakpadAllocator = NULL;
+// Where a raw capture is batched when BREAKPAD_RAW_CAPTURE is set.  It is
+// kept apart from gBreakpadAllocator so that only it is made writable while
+// a crash is recorded.
+ProtectedMemoryAllocator* gRawCaptureAllocator = NULL;
+const vm_size_t kRawCaptureBufferSize = 16 * 1024;
 
 // Mutex for thread-safe access to the key/value dictionary used by breakpad.
 // It's a global instead of an instance variable of Breakpad
@@ -162,8 +167,9 @@ class Breakpad {
   NSDictionary* NextCrashReportConfiguration();
   NSDictionary* FixedUpCrashReportConfiguration(NSDictionary* configuration);
   NSDate* DateOfMostRecentCrashReport();
+  int ConvertRawCaptures();
   void UploadNextReport(NSDictionary* server_parameters);
-  void UploadReportWithConfiguration(NSDictionary* configuration,
+  bool UploadReportWithConfiguration(NSDictionary* configuration,
                                      NSDictionary* server_parameters,
                                      BreakpadUploadCompletionCallback callback);
   void UploadData(NSData* data, NSString* name,
@@ -304,6 +310,8 @@ bool Breakpad::Initialize(NSDictionary* parameters) {
           google_breakpad::ExceptionHandler(
               config_params_->GetValueForKey(BREAKPAD_DUMP_DIRECTORY),
               0, &HandleMinidumpCallback, this, true, 0);
+  if (config_params_->GetValueForKey(BREAKPAD_RAW_CAPTURE) == "YES")
+    handler_->EnableRawCapture(gRawCaptureAllocator);
   NSSetUncaughtExceptionHandler(&Breakpad::UncaughtExceptionHandler);
   return true;
 }
@@ -340,6 +348,9 @@ bool Breakpad::ExtractParameters(NSDictionary* parameters) {
 
   NSDictionary* serverParameters =
       [parameters objectForKey:@BREAKPAD_SERVER_PARAMETER_DICT];
+  id compressUploads = [parameters objectForKey:@BREAKPAD_COMPRESS_UPLOADS];
+  id uploadPriority = [parameters objectForKey:@BREAKPAD_UPLOAD_PRIORITY];
+  id rawCapture = [parameters objectForKey:@BREAKPAD_RAW_CAPTURE];
 
   if (!product)
     product = [parameters objectForKey:@"CFBundleName"];
@@ -397,6 +408,16 @@ bool Breakpad::ExtractParameters(NSDictionary* parameters) {
   dictionary.SetKeyValue(BREAKPAD_VENDOR,          [vendor UTF8String]);
   dictionary.SetKeyValue(BREAKPAD_DUMP_DIRECTORY,
                          [dumpSubdirectory UTF8String]);
+  if (compressUploads) {
+    dictionary.SetKeyValue(BREAKPAD_COMPRESS_UPLOADS,
+                           [compressUploads boolValue] ? "YES" : "NO");
+  }
+  if (uploadPriority) {
+    dictionary.SetKeyValue(BREAKPAD_UPLOAD_PRIORITY,
+                           [[uploadPriority description] UTF8String]);
+  }
+  if ([rawCapture boolValue])
+    dictionary.SetKeyValue(BREAKPAD_RAW_CAPTURE, "YES");
 
   struct timeval tv;
   gettimeofday(&tv, NULL);
@@ -477,6 +498,17 @@ NSDictionary* Breakpad::FixedUpCrashReportConfiguration(NSDictionary* configurat
   // an UUID that is not guaranteed to stay the same over time.
   [fixedConfiguration setObject:KeyValue(@BREAKPAD_DUMP_DIRECTORY)
                     forKey:@kReporterMinidumpDirectoryKey];
+  // How reports are uploaded is up to the process uploading them, not the
+  // one that crashed.
+  NSString* uploadKeys[] = {@BREAKPAD_COMPRESS_UPLOADS,
+                            @BREAKPAD_UPLOAD_PRIORITY};
+  for (NSString* key : uploadKeys) {
+    NSString* value = KeyValue(key);
+    if (value)
+      [fixedConfiguration setObject:value forKey:key];
+    else
+      [fixedConfiguration removeObjectForKey:key];
+  }
   return fixedConfiguration;
 }
 
@@ -504,6 +536,17 @@ NSDate* Breakpad::DateOfMostRecentCrashReport() {
   return mostRecentCrashReportDate;
 }
 
+//=============================================================================
+int Breakpad::ConvertRawCaptures() {
+  NSString* directory = KeyValue(@BREAKPAD_DUMP_DIRECTORY);
+  if (!directory)
+    return 0;
+  // The capture this launch's handler would write is left alone.
+  return google_breakpad::ExceptionHandler::ConvertRawCaptures(
+      [directory fileSystemRepresentation],
+      handler_ ? handler_->raw_capture_path() : NULL);
+}
+
 //=============================================================================
 void Breakpad::HandleNetworkResponse(NSDictionary* configuration,
                                      NSData* data,
@@ -514,14 +557,14 @@ void Breakpad::HandleNetworkResponse(NSDictionary* configuration,
 }
 
 //=============================================================================
-void Breakpad::UploadReportWithConfiguration(
+bool Breakpad::UploadReportWithConfiguration(
     NSDictionary* configuration,
     NSDictionary* server_parameters,
     BreakpadUploadCompletionCallback callback) {
   Uploader* uploader = [[[Uploader alloc]
       initWithConfig:configuration] autorelease];
   if (!uploader)
-    return;
+    return false;
   for (NSString* key in server_parameters) {
     [uploader addServerParameter:[server_parameters objectForKey:key]
                           forKey:key];
@@ -533,15 +576,14 @@ void Breakpad::UploadReportWithConfiguration(
       });
     }];
   }
-  [uploader report];
+  return [uploader report];
 }
 
 //=============================================================================
 void Breakpad::UploadNextReport(NSDictionary* server_parameters) {
   NSDictionary* configuration = NextCrashReportConfiguration();
   if (configuration) {
-    return UploadReportWithConfiguration(configuration, server_parameters,
-                                         nullptr);
+    UploadReportWithConfiguration(configuration, server_parameters, nullptr);
   }
 }
 
@@ -663,7 +705,7 @@ BreakpadRef BreakpadCreate(NSDictionary* parameters) {
     // since once it does its allocations and locks the memory, smashes to
     // itself don't affect anything we care about.
     gMasterAllocator =
-        new ProtectedMemoryAllocator(sizeof(ProtectedMemoryAllocator) * 2);
+        new ProtectedMemoryAllocator(sizeof(ProtectedMemoryAllocator) * 3);
 
     gKeyValueAllocator =
         new (gMasterAllocator->Allocate(sizeof(ProtectedMemoryAllocator)))
@@ -688,6 +730,10 @@ BreakpadRef BreakpadCreate(NSDictionary* parameters) {
           new (gMasterAllocator->Allocate(sizeof(ProtectedMemoryAllocator)))
               ProtectedMemoryAllocator(breakpad_pool_size);
 
+      gRawCaptureAllocator =
+          new (gMasterAllocator->Allocate(sizeof(ProtectedMemoryAllocator)))
+              ProtectedMemoryAllocator(kRawCaptureBufferSize);
+
       // Stack-based autorelease pool for Breakpad::Create() obj-c code.
       NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
       Breakpad* breakpad = Breakpad::Create(parameters);
@@ -697,6 +743,7 @@ BreakpadRef BreakpadCreate(NSDictionary* parameters) {
         gMasterAllocator->Protect();
         gKeyValueAllocator->Protect();
         gBreakpadAllocator->Protect();
+        gRawCaptureAllocator->Protect();
         // Can uncomment this line to figure out how much space was actually
         // allocated using this allocator
         //     printf("gBreakpadAllocator allocated size = %d\n",
@@ -721,6 +768,11 @@ BreakpadRef BreakpadCreate(NSDictionary* parameters) {
     gBreakpadAllocator = NULL;
   }
 
+  if (gRawCaptureAllocator) {
+    gRawCaptureAllocator->~ProtectedMemoryAllocator();
+    gRawCaptureAllocator = NULL;
+  }
+
   delete gMasterAllocator;
   gMasterAllocator = NULL;
 
@@ -736,6 +788,7 @@ void BreakpadRelease(BreakpadRef ref) {
       gMasterAllocator->Unprotect();
       gKeyValueAllocator->Unprotect();
       gBreakpadAllocator->Unprotect();
+      gRawCaptureAllocator->Unprotect();
 
       breakpad->~Breakpad();
 
@@ -870,6 +923,21 @@ int BreakpadGetCrashReportCount(BreakpadRef ref) {
   return false;
 }
 
+//=============================================================================
+int BreakpadConvertRawCaptures(BreakpadRef ref) {
+  try {
+    // Not called at exception time
+    Breakpad* breakpad = (Breakpad*)ref;
+
+    if (breakpad) {
+      return breakpad->ConvertRawCaptures();
+    }
+  } catch(...) {    // don't let exceptions leave this C API
+    fprintf(stderr, "BreakpadConvertRawCaptures() : error\n");
+  }
+  return 0;
+}
+
 //=============================================================================
 void BreakpadUploadNextReport(BreakpadRef ref) {
   BreakpadUploadNextReportWithParameters(ref, nil, nullptr);
@@ -901,7 +969,7 @@ NSDate* BreakpadGetDateOfMostRecentCrashReport(BreakpadRef ref) {
 }
 
 //=============================================================================
-void BreakpadUploadReportWithParametersAndConfiguration(
+BOOL BreakpadUploadReportWithParametersAndConfiguration(
     BreakpadRef ref,
     NSDictionary* server_parameters,
     NSDictionary* configuration,
@@ -909,13 +977,15 @@ void BreakpadUploadReportWithParametersAndConfiguration(
   try {
     Breakpad* breakpad = (Breakpad*)ref;
     if (!breakpad || !configuration)
-      return;
-    breakpad->UploadReportWithConfiguration(configuration, server_parameters,
-                                            callback);
+      return NO;
+    return breakpad->UploadReportWithConfiguration(configuration,
+                                                   server_parameters,
+                                                   callback) ? YES : NO;
   } catch(...) {    // don't let exceptions leave this C API
     fprintf(stderr,
         "BreakpadUploadReportWithParametersAndConfiguration() : error\n");
   }
+  return NO;
 }
 
 //=============================================================================
@@ -930,7 +1000,7 @@ void BreakpadUploadNextReportWithParameters(
     NSDictionary* configuration = breakpad->NextCrashReportConfiguration();
     if (!configuration)
       return;
-    return BreakpadUploadReportWithParametersAndConfiguration(
+    BreakpadUploadReportWithParametersAndConfiguration(
         ref, server_parameters, configuration, callback);
   } catch(...) {    // don't let exceptions leave this C API
     fprintf(stderr, "BreakpadUploadNextReportWithParameters() : error\n");
@@ -62,6 +62,25 @@
   // done.
   int uploadIntervalInSeconds_;
 
+  // The most reports uploaded one after the other, before waiting for the
+  // upload interval again.
+  int uploadBatchSize_;
+
+  // The time to wait after the controller is started before the first
+  // upload.
+  int uploadStartDelayInSeconds_;
+
+  // The time the controller was started.
+  CFAbsoluteTime startTime_;
+
+  // The number of batches in a row with a failed upload, which the wait
+  // before the next batch doubles with.
+  int consecutiveUploadFailures_;
+
+  // The reports whose upload failed, to be tried again before the others,
+  // each with the number of attempts made.
+  NSMutableArray* failedReports_;
+
   // The dictionary that contains additional server parameters to send when
   // uploading crash reports.
   NSDictionary* uploadTimeParameters_;
@@ -87,9 +106,20 @@
 
 // Set the minimal interval between two uploads in seconds. This must be called
 // at least once if the interval is not in the bundle information. A value of 0
-// will prevent uploads.
+// will prevent uploads. After a failed upload, the interval doubles with each
+// failed batch, up to six hours, and the report is tried again, up to five
+// times.
 - (void)setUploadInterval:(int)intervalInSeconds;
 
+// Set the most reports to upload one after the other, before waiting for
+// the upload interval again. Defaults to 1.
+- (void)setUploadBatchSize:(int)batchSize;
+
+// Set the time to wait, once the controller is started, before uploading
+// the first report, so that uploads do not compete with the application's
+// own work at launch. Defaults to 0.
+- (void)setUploadStartDelay:(int)delayInSeconds;
+
 // Set additional server parameters to send when uploading crash reports.
 - (void)setParametersToAddAtUploadTime:(NSDictionary*)uploadTimeParameters;
 
@@ -57,6 +57,18 @@
 // accordingly.
 - (void)reportWillBeSent;
 
+// Returns the number of reports waiting to be uploaded, including those
+// whose upload failed.
+- (int)pendingReportCount;
+
+// Returns the configuration of the next report to upload, a failed one
+// first, or nil if there is none. |attempts| is set to the number of
+// uploads of the report already attempted.
+- (NSDictionary*)nextReportConfiguration:(int*)attempts;
+
+// Returns the time to wait before the next batch after a failed upload.
+- (int)backoffDelay;
+
 @end
 
 #pragma mark -
@@ -68,6 +80,21 @@ namespace {
 // server.
 NSString* const kLastSubmission = @"com.google.Breakpad.LastSubmission";
 
+// The keys of a failed report's configuration and upload attempts in
+// |failedReports_|.
+NSString* const kFailedReportConfiguration = @"configuration";
+NSString* const kFailedReportAttempts = @"attempts";
+
+// The most times the upload of a report is attempted before it is dropped.
+const int kMaxUploadAttempts = 5;
+
+// The longest wait after failed uploads, in seconds.
+const int kMaxUploadBackoffInSeconds = 6 * 60 * 60;
+
+// The priority of uploads against the application's other network traffic,
+// unless the configuration sets one: NSURLSessionTaskPriorityLow.
+NSString* const kDefaultUploadPriority = @"0.25";
+
 // Returns a NSString describing the current platform.
 NSString* GetPlatform() {
   // Name of the system call for getting the platform.
@@ -107,9 +134,18 @@ NSString* GetPlatform() {
 - (id)initSingleton {
   self = [super init];
   if (self) {
-    queue_ = dispatch_queue_create("com.google.BreakpadQueue", NULL);
+    // Uploads are work the user is not waiting on, and should yield to
+    // the application's.
+    queue_ = dispatch_queue_create(
+        "com.google.BreakpadQueue",
+        dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL,
+                                                QOS_CLASS_UTILITY, 0));
     enableUploads_ = NO;
     started_ = NO;
+    uploadBatchSize_ = 1;
+    uploadStartDelayInSeconds_ = 0;
+    consecutiveUploadFailures_ = 0;
+    failedReports_ = [[NSMutableArray alloc] init];
     [self resetConfiguration];
   }
   return self;
@@ -121,6 +157,7 @@ NSString* GetPlatform() {
   dispatch_release(queue_);
   [configuration_ release];
   [uploadTimeParameters_ release];
+  [failedReports_ release];
   [super dealloc];
 }
 
@@ -130,6 +167,11 @@ NSString* GetPlatform() {
   if (started_)
     return;
   started_ = YES;
+  startTime_ = CFAbsoluteTimeGetCurrent();
+  if (![configuration_ objectForKey:@BREAKPAD_UPLOAD_PRIORITY]) {
+    [configuration_ setObject:kDefaultUploadPriority
+                       forKey:@BREAKPAD_UPLOAD_PRIORITY];
+  }
   void(^startBlock)() = ^{
       assert(!breakpadRef_);
       breakpadRef_ = BreakpadCreate(configuration_);
@@ -141,6 +183,12 @@ NSString* GetPlatform() {
     startBlock();
   else
     dispatch_async(queue_, startBlock);
+  // The minidumps of earlier launches' raw captures are written on the
+  // queue, ahead of any upload of their reports.
+  dispatch_async(queue_, ^{
+      if (breakpadRef_)
+        BreakpadConvertRawCaptures(breakpadRef_);
+  });
 }
 
 - (void)stop {
@@ -181,7 +229,17 @@ NSString* GetPlatform() {
         // Set this before calling doSendStoredCrashReport, because that
         // calls sendDelay, which in turn checks this flag.
         enableUploads_ = YES;
-        [self sendStoredCrashReports];
+        NSTimeInterval startDelay = uploadStartDelayInSeconds_ -
+            (CFAbsoluteTimeGetCurrent() - startTime_);
+        if (startDelay > 0) {
+          dispatch_time_t delay = dispatch_time(
+              DISPATCH_TIME_NOW, (int64_t)(startDelay * NSEC_PER_SEC));
+          dispatch_after(delay, queue_, ^{
+              [self sendStoredCrashReports];
+          });
+        } else {
+          [self sendStoredCrashReports];
+        }
       } else {
         // disable the enableUpload_ flag.
         // sendDelay checks this flag and disables the upload of logs by sendStoredCrashReports
@@ -226,6 +284,18 @@ NSString* GetPlatform() {
     uploadIntervalInSeconds_ = 0;
 }
 
+- (void)setUploadBatchSize:(int)batchSize {
+  NSAssert(!started_,
+      @"The controller must not be started when setUploadBatchSize is called");
+  uploadBatchSize_ = batchSize > 0 ? batchSize : 1;
+}
+
+- (void)setUploadStartDelay:(int)delayInSeconds {
+  NSAssert(!started_,
+      @"The controller must not be started when setUploadStartDelay is called");
+  uploadStartDelayInSeconds_ = delayInSeconds > 0 ? delayInSeconds : 0;
+}
+
 - (void)setParametersToAddAtUploadTime:(NSDictionary*)uploadTimeParameters {
   NSAssert(!started_, @"The controller must not be started when "
                       "setParametersToAddAtUploadTime is called");
@@ -270,7 +340,7 @@ NSString* GetPlatform() {
   NSAssert(started_, @"The controller must be started before "
                      "hasReportToUpload is called");
   dispatch_async(queue_, ^{
-      callback(breakpadRef_ && (BreakpadGetCrashReportCount(breakpadRef_) > 0));
+      callback([self pendingReportCount] > 0);
   });
 }
 
@@ -278,7 +348,7 @@ NSString* GetPlatform() {
   NSAssert(started_, @"The controller must be started before "
                      "getCrashReportCount is called");
   dispatch_async(queue_, ^{
-      callback(breakpadRef_ ? BreakpadGetCrashReportCount(breakpadRef_) : 0);
+      callback([self pendingReportCount]);
   });
 }
 
@@ -297,7 +367,8 @@ NSString* GetPlatform() {
         return;
       }
       [self reportWillBeSent];
-      callback(BreakpadGetNextReportConfiguration(breakpadRef_), 0);
+      int attempts = 0;
+      callback([self nextReportConfiguration:&attempts], 0);
   });
 }
 
@@ -339,9 +410,41 @@ NSString* GetPlatform() {
   [userDefaults synchronize];
 }
 
+- (int)pendingReportCount {
+  if (!breakpadRef_)
+    return 0;
+  return BreakpadGetCrashReportCount(breakpadRef_) +
+      static_cast<int>([failedReports_ count]);
+}
+
+- (NSDictionary*)nextReportConfiguration:(int*)attempts {
+  if ([failedReports_ count] > 0) {
+    NSDictionary* failedReport = [failedReports_ objectAtIndex:0];
+    NSDictionary* configuration =
+        [failedReport objectForKey:kFailedReportConfiguration];
+    *attempts = [[failedReport objectForKey:kFailedReportAttempts] intValue];
+    [[configuration retain] autorelease];
+    [failedReports_ removeObjectAtIndex:0];
+    return configuration;
+  }
+  *attempts = 0;
+  return BreakpadGetNextReportConfiguration(breakpadRef_);
+}
+
+- (int)backoffDelay {
+  // Double the wait with each failure, without overflowing.
+  int delay = uploadIntervalInSeconds_;
+  for (int i = 0; i < consecutiveUploadFailures_ &&
+                  delay < kMaxUploadBackoffInSeconds; ++i) {
+    delay *= 2;
+  }
+  return delay < kMaxUploadBackoffInSeconds ? delay
+                                            : kMaxUploadBackoffInSeconds;
+}
+
 // This method must be called from the breakpad queue.
 - (void)sendStoredCrashReports {
-  if (BreakpadGetCrashReportCount(breakpadRef_) == 0)
+  if ([self pendingReportCount] == 0)
     return;
 
   int timeToWait = [self sendDelay];
@@ -350,19 +453,44 @@ NSString* GetPlatform() {
   if (timeToWait == -1)
     return;
 
-  // A report can be sent now.
+  // A batch of reports can be sent now. The reports of a batch share the
+  // connection to the server.
   if (timeToWait == 0) {
     [self reportWillBeSent];
-    BreakpadUploadNextReportWithParameters(breakpadRef_, uploadTimeParameters_,
-                                           uploadCompleteCallback_);
+    BOOL failed = NO;
+    for (int i = 0; i < uploadBatchSize_ && !failed; ++i) {
+      int attempts = 0;
+      NSDictionary* configuration = [self nextReportConfiguration:&attempts];
+      if (!configuration)
+        break;
+      if (!BreakpadUploadReportWithParametersAndConfiguration(
+              breakpadRef_, uploadTimeParameters_, configuration,
+              uploadCompleteCallback_)) {
+        // The rest of the batch waits for the server to come back.
+        failed = YES;
+        if (attempts + 1 < kMaxUploadAttempts) {
+          [failedReports_ insertObject:@{
+              kFailedReportConfiguration : configuration,
+              kFailedReportAttempts : @(attempts + 1)
+          } atIndex:0];
+        }
+      }
+    }
+
+    if (failed) {
+      ++consecutiveUploadFailures_;
+      timeToWait = [self backoffDelay];
+    } else {
+      consecutiveUploadFailures_ = 0;
+    }
 
     // If more reports must be sent, make sure this method is called again.
-    if (BreakpadGetCrashReportCount(breakpadRef_) > 0)
+    if (timeToWait == 0 && [self pendingReportCount] > 0)
       timeToWait = uploadIntervalInSeconds_;
   }
 
   // A report must be sent later.
-  if (timeToWait > 0) {
+  if (timeToWait > 0 && [self pendingReportCount] > 0) {
     dispatch_time_t delay = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(timeToWait * NSEC_PER_SEC));
     dispatch_after(delay, queue_, ^{
         [self sendStoredCrashReports];
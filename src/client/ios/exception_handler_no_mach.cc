@@ -30,10 +30,16 @@
 #include <config.h>  // Must come first
 #endif
 
+#include <dirent.h>
+#include <fcntl.h>
 #include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <TargetConditionals.h>
 
+#include "client/mac/handler/dynamic_images.h"
 #include "client/mac/handler/minidump_generator.h"
+#include "client/mac/handler/raw_capture.h"
 #include "client/ios/exception_handler_no_mach.h"
 
 #ifndef USE_PROTECTED_ALLOCATIONS
@@ -90,7 +96,11 @@ ExceptionHandler::ExceptionHandler(const string& dump_path,
       callback_context_(callback_context),
       directCallback_(NULL),
       installed_exception_handler_(false),
-      is_in_teardown_(false) {
+      is_in_teardown_(false),
+      raw_capture_fd_(-1),
+      raw_capture_allocator_(NULL),
+      raw_capture_buffer_(NULL),
+      raw_capture_buffer_size_(0) {
   // This will update to the ID and C-string pointers
   set_dump_path(dump_path);
   MinidumpGenerator::GatherSystemInformation();
@@ -108,7 +118,11 @@ ExceptionHandler::ExceptionHandler(DirectCallback callback,
       callback_context_(callback_context),
       directCallback_(callback),
       installed_exception_handler_(false),
-      is_in_teardown_(false) {
+      is_in_teardown_(false),
+      raw_capture_fd_(-1),
+      raw_capture_allocator_(NULL),
+      raw_capture_buffer_(NULL),
+      raw_capture_buffer_size_(0) {
   MinidumpGenerator::GatherSystemInformation();
   Setup();
 }
@@ -117,6 +131,82 @@ ExceptionHandler::~ExceptionHandler() {
   Teardown();
 }
 
+bool ExceptionHandler::EnableRawCapture(ProtectedMemoryAllocator* allocator) {
+  vm_size_t buffer_size = allocator->GetFreeSize();
+  char* buffer = allocator->Allocate(buffer_size);
+  if (!buffer)
+    return false;
+  raw_capture_allocator_ = allocator;
+  raw_capture_buffer_ = buffer;
+  raw_capture_buffer_size_ = buffer_size;
+  // The images are identified as they load, so that the capture only has
+  // to copy what the cache already has.
+  DyldImageCache::Enable();
+  return OpenRawCaptureFile();
+}
+
+bool ExceptionHandler::OpenRawCaptureFile() {
+  CloseRawCaptureFile();
+  if (dump_path_.empty())
+    return false;
+
+  // next_minidump_path_ is <dump_path>/<id>.dmp.
+  raw_capture_path_ =
+      next_minidump_path_.substr(0, next_minidump_path_.size() - 4) +
+      RAW_CAPTURE_EXTENSION;
+  raw_capture_fd_ = open(raw_capture_path_.c_str(),
+                         O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  return raw_capture_fd_ >= 0;
+}
+
+void ExceptionHandler::CloseRawCaptureFile() {
+  if (raw_capture_fd_ < 0)
+    return;
+  // The file is only kept if a capture was written to it.
+  struct stat st;
+  if (fstat(raw_capture_fd_, &st) == 0 && st.st_size == 0)
+    unlink(raw_capture_path_.c_str());
+  close(raw_capture_fd_);
+  raw_capture_fd_ = -1;
+}
+
+// static
+int ExceptionHandler::ConvertRawCaptures(const string& dump_path,
+                                         const char* active_path) {
+  DIR* dir = opendir(dump_path.c_str());
+  if (!dir)
+    return 0;
+
+  const size_t extension_length = strlen(RAW_CAPTURE_EXTENSION);
+  int converted = 0;
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != NULL) {
+    string name(entry->d_name);
+    if (name.size() <= extension_length ||
+        name.compare(name.size() - extension_length, extension_length,
+                     RAW_CAPTURE_EXTENSION) != 0) {
+      continue;
+    }
+
+    string raw_capture_path = dump_path + "/" + name;
+    if (active_path && raw_capture_path == active_path)
+      continue;
+
+    string minidump_path = dump_path + "/" +
+        name.substr(0, name.size() - extension_length) + ".dmp";
+    MinidumpGenerator md;
+    if (md.WriteFromRawCapture(raw_capture_path.c_str(),
+                               minidump_path.c_str())) {
+      ++converted;
+    } else {
+      unlink(minidump_path.c_str());
+    }
+    unlink(raw_capture_path.c_str());
+  }
+  closedir(dir);
+  return converted;
+}
+
 bool ExceptionHandler::WriteMinidumpWithException(
     int exception_type,
     int exception_code,
@@ -160,7 +250,14 @@ bool ExceptionHandler::WriteMinidumpWithException(
                                    exception_subcode, thread_name);
       }
 
-      result = md.Write(next_minidump_path_c_);
+      if (raw_capture_fd_ >= 0) {
+        raw_capture_allocator_->Unprotect();
+        result = md.WriteRawCapture(raw_capture_fd_, raw_capture_buffer_,
+                                    raw_capture_buffer_size_);
+        raw_capture_allocator_->Protect();
+      } else {
+        result = md.Write(next_minidump_path_c_);
+      }
     }
 
     // Call user specified callback (if any)
@@ -247,6 +344,7 @@ bool ExceptionHandler::Setup() {
 
 bool ExceptionHandler::Teardown() {
   is_in_teardown_ = true;
+  CloseRawCaptureFile();
 
   if (!UninstallHandlers())
     return false;
@@ -260,6 +358,9 @@ void ExceptionHandler::UpdateNextID() {
 
   next_minidump_path_c_ = next_minidump_path_.c_str();
   next_minidump_id_c_ = next_minidump_id_.c_str();
+
+  if (raw_capture_buffer_)
+    OpenRawCaptureFile();
 }
 
 }  // namespace google_breakpad
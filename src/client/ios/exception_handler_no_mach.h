@@ -34,6 +34,7 @@
 
 #include <string>
 
+#include "client/mac/handler/protected_memory_allocator.h"
 #include "client/mac/handler/ucontext_compat.h"
 #include "common/scoped_ptr.h"
 
@@ -104,6 +105,32 @@ class ExceptionHandler {
     UpdateNextID();  // Necessary to put dump_path_ in next_minidump_path_.
   }
 
+  // Record a raw capture (see client/mac/handler/raw_capture.h) instead of
+  // a minidump when an exception occurs, which avoids reading the images
+  // in the crashing process.  The capture goes in
+  // <dump_path>/<minidump_id>.rawdmp, which is created now, and
+  // ConvertRawCaptures writes the minidump for it later, normally on the
+  // next launch.  The callback is still called with the minidump's id.
+  // The capture is batched in all of |allocator|'s free space, which is
+  // only unprotected while the capture is written, so it should be an
+  // allocator of its own.  Returns false if the file can't be created.
+  bool EnableRawCapture(ProtectedMemoryAllocator* allocator);
+
+  // The raw capture this handler would write, or NULL if raw capture isn't
+  // enabled.
+  const char* raw_capture_path() const {
+    return raw_capture_fd_ >= 0 ? raw_capture_path_.c_str() : NULL;
+  }
+
+  // Write <dump_path>/<id>.dmp for each <dump_path>/<id>.rawdmp, other
+  // than |active_path| (normally a handler's raw_capture_path()), and
+  // delete the captures.  Captures that can't be converted, such as the
+  // empty ones of processes that never crashed, are deleted too.  This
+  // does file I/O and reads this task's images, so it should be kept off
+  // the main thread.  Returns the number of minidumps written.
+  static int ConvertRawCaptures(const string& dump_path,
+                                const char* active_path);
+
  private:
   // Install the SIG exception handlers.
   bool InstallHandlers();
@@ -141,6 +168,11 @@ class ExceptionHandler {
   // path of the next minidump to be written in next_minidump_path_.
   void UpdateNextID();
 
+  // Creates the raw capture file for next_minidump_id_, replacing the one
+  // for the previous id.
+  bool OpenRawCaptureFile();
+  void CloseRawCaptureFile();
+
   // The destination directory for the minidump
   string dump_path_;
 
@@ -171,6 +203,16 @@ class ExceptionHandler {
   // True, if we're in the process of uninstalling the exception handler and
   // the thread.
   bool is_in_teardown_;
+
+  // The raw capture's file, or -1 if raw capture isn't enabled or the file
+  // couldn't be created, and its path.
+  int raw_capture_fd_;
+  string raw_capture_path_;
+
+  // Where the raw capture is batched; NULL unless raw capture is enabled.
+  ProtectedMemoryAllocator* raw_capture_allocator_;
+  char* raw_capture_buffer_;
+  size_t raw_capture_buffer_size_;
 };
 
 }  // namespace google_breakpad
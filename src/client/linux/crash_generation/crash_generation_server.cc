@@ -34,14 +34,16 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <limits.h>
-#include <poll.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <vector>
 
 #include "client/linux/crash_generation/crash_generation_server.h"
@@ -56,6 +58,37 @@ static const char kCommandQuit = 'x';
 
 namespace google_breakpad {
 
+namespace {
+
+uint64_t NowNanoseconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+}  // namespace
+
+struct CrashGenerationServer::DumpRequest {
+  pid_t pid;
+  // Closing this releases the client.
+  int signal_fd;
+  uint64_t queued_ns;
+  char crash_context[sizeof(ExceptionHandler::CrashContext)];
+};
+
+CrashGenerationServer::Metrics::Metrics()
+    : queue_depth(0),
+      max_queue_depth(0),
+      dumps_in_progress(0),
+      dumps_written(0),
+      dumps_failed(0),
+      requests_rejected(0),
+      total_wait_ns(0),
+      max_wait_ns(0),
+      total_write_ns(0),
+      max_write_ns(0) {
+}
+
 CrashGenerationServer::CrashGenerationServer(
   const int listen_fd,
   OnClientDumpRequestCallback dump_callback,
@@ -70,8 +103,16 @@ CrashGenerationServer::CrashGenerationServer(
     exit_callback_(exit_callback),
     exit_context_(exit_context),
     generate_dumps_(generate_dumps),
-    started_(false)
+    started_(false),
+    control_pipe_in_(-1),
+    control_pipe_out_(-1),
+    epoll_fd_(-1),
+    max_concurrent_dumps_(1),
+    max_queued_dumps_(kDefaultMaxQueuedDumps),
+    stopping_workers_(false)
 {
+  pthread_mutex_init(&queue_mutex_, NULL);
+  pthread_cond_init(&queue_cond_, NULL);
   if (dump_path)
     dump_dir_ = *dump_path;
   else
@@ -82,6 +123,8 @@ CrashGenerationServer::~CrashGenerationServer()
 {
   if (started_)
     Stop();
+  pthread_cond_destroy(&queue_cond_);
+  pthread_mutex_destroy(&queue_mutex_);
 }
 
 bool
@@ -105,9 +148,36 @@ CrashGenerationServer::Start()
   control_pipe_in_ = control_pipe[0];
   control_pipe_out_ = control_pipe[1];
 
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0)
+    return false;
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = server_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, server_fd_, &event))
+    return false;
+  event.data.fd = control_pipe_in_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, control_pipe_in_, &event))
+    return false;
+
+  stopping_workers_ = false;
+  for (int i = 0; i < max_concurrent_dumps_; ++i) {
+    pthread_t worker;
+    if (pthread_create(&worker, NULL,
+                       WorkerMain, reinterpret_cast<void*>(this))) {
+      StopWorkers();
+      return false;
+    }
+    workers_.push_back(worker);
+  }
+
   if (pthread_create(&thread_, NULL,
-                     ThreadMain, reinterpret_cast<void*>(this)))
+                     ThreadMain, reinterpret_cast<void*>(this))) {
+    StopWorkers();
     return false;
+  }
 
   started_ = true;
   return true;
@@ -125,13 +195,53 @@ CrashGenerationServer::Stop()
 
   void* dummy;
   pthread_join(thread_, &dummy);
+  StopWorkers();
 
+  close(epoll_fd_);
   close(control_pipe_in_);
   close(control_pipe_out_);
+  epoll_fd_ = control_pipe_in_ = control_pipe_out_ = -1;
 
   started_ = false;
 }
 
+void
+CrashGenerationServer::StopWorkers()
+{
+  pthread_mutex_lock(&queue_mutex_);
+  stopping_workers_ = true;
+  pthread_cond_broadcast(&queue_cond_);
+  pthread_mutex_unlock(&queue_mutex_);
+
+  for (size_t i = 0; i < workers_.size(); ++i)
+    pthread_join(workers_[i], NULL);
+  workers_.clear();
+}
+
+void
+CrashGenerationServer::set_max_concurrent_dumps(int count)
+{
+  assert(!started_);
+  max_concurrent_dumps_ = std::max(count, 1);
+}
+
+void
+CrashGenerationServer::set_max_queued_dumps(size_t count)
+{
+  pthread_mutex_lock(&queue_mutex_);
+  max_queued_dumps_ = count;
+  pthread_mutex_unlock(&queue_mutex_);
+}
+
+CrashGenerationServer::Metrics
+CrashGenerationServer::GetMetrics() const
+{
+  pthread_mutex_lock(&queue_mutex_);
+  Metrics metrics = metrics_;
+  pthread_mutex_unlock(&queue_mutex_);
+  return metrics;
+}
+
 //static
 bool
 CrashGenerationServer::CreateReportChannel(int* server_fd, int* client_fd)
@@ -161,18 +271,12 @@ CrashGenerationServer::CreateReportChannel(int* server_fd, int* client_fd)
 void
 CrashGenerationServer::Run()
 {
-  struct pollfd pollfds[2];
-  memset(&pollfds, 0, sizeof(pollfds));
-
-  pollfds[0].fd = server_fd_;
-  pollfds[0].events = POLLIN;
-
-  pollfds[1].fd = control_pipe_in_;
-  pollfds[1].events = POLLIN;
+  struct epoll_event events[2];
 
   while (true) {
     // infinite timeout
-    int nevents = poll(pollfds, sizeof(pollfds)/sizeof(pollfds[0]), -1);
+    int nevents = epoll_wait(epoll_fd_, events,
+                             sizeof(events)/sizeof(events[0]), -1);
     if (-1 == nevents) {
       if (EINTR == errno) {
         continue;
@@ -181,20 +285,23 @@ CrashGenerationServer::Run()
       }
     }
 
-    if (pollfds[0].revents && !ClientEvent(pollfds[0].revents))
-      return;
-
-    if (pollfds[1].revents && !ControlEvent(pollfds[1].revents))
-      return;
+    for (int i = 0; i < nevents; ++i) {
+      if (events[i].data.fd == server_fd_) {
+        if (!ClientEvent(events[i].events))
+          return;
+      } else if (!ControlEvent(events[i].events)) {
+        return;
+      }
+    }
   }
 }
 
 bool
-CrashGenerationServer::ClientEvent(short revents)
+CrashGenerationServer::ClientEvent(uint32_t events)
 {
-  if (POLLHUP & revents)
+  if (EPOLLHUP & events)
     return false;
-  assert(POLLIN & revents);
+  assert(EPOLLIN & events);
 
   // A process has crashed and has signaled us by writing a datagram
   // to the death signal socket. The datagram contains the crash context needed
@@ -210,24 +317,29 @@ CrashGenerationServer::ClientEvent(short revents)
 
   struct msghdr msg = {0};
   struct iovec iov[1];
-  char crash_context[kCrashContextSize];
+  DumpRequest* request = new DumpRequest;
+  char* crash_context = request->crash_context;
   char control[kControlMsgSize];
-  const ssize_t expected_msg_size = sizeof(crash_context);
+  const ssize_t expected_msg_size = kCrashContextSize;
 
   iov[0].iov_base = crash_context;
-  iov[0].iov_len = sizeof(crash_context);
+  iov[0].iov_len = kCrashContextSize;
   msg.msg_iov = iov;
   msg.msg_iovlen = sizeof(iov)/sizeof(iov[0]);
   msg.msg_control = control;
   msg.msg_controllen = kControlMsgSize;
 
   const ssize_t msg_size = HANDLE_EINTR(recvmsg(server_fd_, &msg, 0));
-  if (msg_size != expected_msg_size)
+  if (msg_size != expected_msg_size) {
+    delete request;
     return true;
+  }
 
   if (msg.msg_controllen != kControlMsgSize ||
-      msg.msg_flags & ~MSG_TRUNC)
+      msg.msg_flags & ~MSG_TRUNC) {
+    delete request;
     return true;
+  }
 
   // Walk the control payload and extract the file descriptor and validated pid.
   pid_t crashing_pid = -1;
@@ -246,6 +358,7 @@ CrashGenerationServer::ClientEvent(short revents)
         // force a leak.
         for (unsigned i = 0; i < num_fds; ++i)
           close(reinterpret_cast<int*>(CMSG_DATA(hdr))[i]);
+        delete request;
         return true;
       } else {
         signal_fd = reinterpret_cast<int*>(CMSG_DATA(hdr))[0];
@@ -260,39 +373,109 @@ CrashGenerationServer::ClientEvent(short revents)
   if (crashing_pid == -1 || signal_fd == -1) {
     if (signal_fd != -1)
       close(signal_fd);
+    delete request;
     return true;
   }
 
-  string minidump_filename;
-  if (!MakeMinidumpFilename(minidump_filename))
-    return true;
+  request->pid = crashing_pid;
+  request->signal_fd = signal_fd;
+  QueueRequest(request);
+  return true;
+}
 
-  if (!google_breakpad::WriteMinidump(minidump_filename.c_str(),
-                                      crashing_pid, crash_context,
-                                      kCrashContextSize)) {
-    close(signal_fd);
-    return true;
+void
+CrashGenerationServer::QueueRequest(DumpRequest* request)
+{
+  pthread_mutex_lock(&queue_mutex_);
+  if (queue_.size() >= max_queued_dumps_ ||
+      !pending_pids_.insert(request->pid).second) {
+    ++metrics_.requests_rejected;
+    pthread_mutex_unlock(&queue_mutex_);
+    close(request->signal_fd);
+    delete request;
+    return;
   }
+  request->queued_ns = NowNanoseconds();
+  queue_.push_back(request);
+  metrics_.queue_depth = queue_.size();
+  metrics_.max_queue_depth =
+      std::max(metrics_.max_queue_depth, metrics_.queue_depth);
+  pthread_cond_signal(&queue_cond_);
+  pthread_mutex_unlock(&queue_mutex_);
+}
 
-  if (dump_callback_) {
-    ClientInfo info(crashing_pid, this);
+void
+CrashGenerationServer::RunWorker()
+{
+  pthread_mutex_lock(&queue_mutex_);
+  while (true) {
+    if (queue_.empty()) {
+      if (stopping_workers_)
+        break;
+      pthread_cond_wait(&queue_cond_, &queue_mutex_);
+      continue;
+    }
+
+    DumpRequest* request = queue_.front();
+    queue_.pop_front();
+    const uint64_t wait_ns = NowNanoseconds() - request->queued_ns;
+    metrics_.queue_depth = queue_.size();
+    metrics_.total_wait_ns += wait_ns;
+    metrics_.max_wait_ns = std::max(metrics_.max_wait_ns, wait_ns);
+    ++metrics_.dumps_in_progress;
+    pthread_mutex_unlock(&queue_mutex_);
+
+    WriteDump(request);
+
+    pthread_mutex_lock(&queue_mutex_);
+    --metrics_.dumps_in_progress;
+  }
+  pthread_mutex_unlock(&queue_mutex_);
+}
+
+// Runs on a worker thread. The dump is written without the queue's lock,
+// so the only state shared with other dumps is the counts.
+void
+CrashGenerationServer::WriteDump(DumpRequest* request)
+{
+  const uint64_t start_ns = NowNanoseconds();
+
+  string minidump_filename;
+  bool written = MakeMinidumpFilename(minidump_filename) &&
+      google_breakpad::WriteMinidump(minidump_filename.c_str(),
+                                     request->pid, request->crash_context,
+                                     sizeof(request->crash_context));
+
+  if (written && dump_callback_) {
+    ClientInfo info(request->pid, this);
 
     dump_callback_(dump_context_, &info, &minidump_filename);
   }
 
   // Send the done signal to the process: it can exit now.
   // (Closing this will make the child's sys_read unblock and return 0.)
-  close(signal_fd);
+  close(request->signal_fd);
 
-  return true;
+  const uint64_t write_ns = NowNanoseconds() - start_ns;
+  pthread_mutex_lock(&queue_mutex_);
+  pending_pids_.erase(request->pid);
+  if (written)
+    ++metrics_.dumps_written;
+  else
+    ++metrics_.dumps_failed;
+  metrics_.total_write_ns += write_ns;
+  metrics_.max_write_ns = std::max(metrics_.max_write_ns, write_ns);
+  pthread_mutex_unlock(&queue_mutex_);
+
+  delete request;
 }
 
 bool
-CrashGenerationServer::ControlEvent(short revents)
+CrashGenerationServer::ControlEvent(uint32_t events)
 {
-  if (POLLHUP & revents)
+  if (EPOLLHUP & events)
     return false;
-  assert(POLLIN & revents);
+  assert(EPOLLIN & events);
 
   char command;
   if (read(control_pipe_in_, &command, 1))
@@ -333,4 +516,12 @@ CrashGenerationServer::ThreadMain(void* arg)
   return NULL;
 }
 
+// static
+void*
+CrashGenerationServer::WorkerMain(void* arg)
+{
+  reinterpret_cast<CrashGenerationServer*>(arg)->RunWorker();
+  return NULL;
+}
+
 }  // namespace google_breakpad
@@ -30,8 +30,14 @@
 #define CLIENT_LINUX_CRASH_GENERATION_CRASH_GENERATION_SERVER_H_
 
 #include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
 
+#include <deque>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "common/using_std_string.h"
 
@@ -51,6 +57,35 @@ public:
   typedef void (*OnClientExitingCallback)(void* context,
                                           const ClientInfo* client_info);
 
+  // Counts of the dump requests a server has handled, for monitoring.
+  struct Metrics {
+    Metrics();
+
+    // The requests waiting for a worker, now and at the most.
+    size_t queue_depth;
+    size_t max_queue_depth;
+
+    // The dumps being written now.
+    int dumps_in_progress;
+
+    uint64_t dumps_written;
+    uint64_t dumps_failed;
+
+    // The requests refused, because the queue was full or the client
+    // already had a request waiting or being written.  The client carries
+    // on without a dump.
+    uint64_t requests_rejected;
+
+    // The time requests waited for a worker, in nanoseconds.
+    uint64_t total_wait_ns;
+    uint64_t max_wait_ns;
+
+    // The time taken to write each dump and run |dump_callback|, in
+    // nanoseconds.
+    uint64_t total_write_ns;
+    uint64_t max_write_ns;
+  };
+
   // Create an instance with the given parameters.
   //
   // Parameter listen_fd: The server fd created by CreateReportChannel().
@@ -79,9 +114,25 @@ public:
   // Return true if initialization is successful; false otherwise.
   bool Start();
 
-  // Stop the server.
+  // Stop the server.  The requests already received are written first.
   void Stop();
 
+  // Sets the most dumps that are written at once, each on its own worker
+  // thread, so that a dump that takes long only holds up the requests
+  // behind it once all the workers are busy.  The default is 1.  Must be
+  // called before Start.
+  void set_max_concurrent_dumps(int count);
+
+  // Sets the most requests that wait for a worker.  Requests beyond these
+  // are refused.  The default is kDefaultMaxQueuedDumps.
+  void set_max_queued_dumps(size_t count);
+
+  static const size_t kDefaultMaxQueuedDumps = 256;
+
+  // Returns a snapshot of the server's counts.  May be called from any
+  // thread.
+  Metrics GetMetrics() const;
+
   // Create a "channel" that can be used by clients to report crashes
   // to a CrashGenerationServer.  |*server_fd| should be passed to
   // this class's constructor, and |*client_fd| should be passed to
@@ -89,23 +140,43 @@ public:
   static bool CreateReportChannel(int* server_fd, int* client_fd);
 
 private:
+  // A client's request, from its receipt to its dump being written.
+  struct DumpRequest;
+
   // Run the server's event loop
   void Run();
 
-  // Invoked when an child process (client) event occurs
+  // Invoked when an child process (client) event occurs.  The request is
+  // received and queued for a worker.
   // Returning true => "keep running", false => "exit loop"
-  bool ClientEvent(short revents);
+  bool ClientEvent(uint32_t events);
 
   // Invoked when the controlling thread (main) event occurs
   // Returning true => "keep running", false => "exit loop"
-  bool ControlEvent(short revents);
+  bool ControlEvent(uint32_t events);
+
+  // Queue |request| for a worker, or refuse it.  Takes ownership.
+  void QueueRequest(DumpRequest* request);
+
+  // Take requests off the queue and write their dumps, until the server
+  // stops and the queue is empty.
+  void RunWorker();
+
+  // Write the dump for |request| and release its client.
+  void WriteDump(DumpRequest* request);
 
   // Return a unique filename at which a minidump can be written
   bool MakeMinidumpFilename(string& outFilename);
 
+  // Stop the worker threads, once they have emptied the queue.
+  void StopWorkers();
+
   // Trampoline to |Run()|
   static void* ThreadMain(void* arg);
 
+  // Trampoline to |RunWorker()|
+  static void* WorkerMain(void* arg);
+
   int server_fd_;
 
   OnClientDumpRequestCallback dump_callback_;
@@ -123,6 +194,23 @@ private:
   pthread_t thread_;
   int control_pipe_in_;
   int control_pipe_out_;
+  int epoll_fd_;
+
+  int max_concurrent_dumps_;
+  size_t max_queued_dumps_;
+  std::vector<pthread_t> workers_;
+
+  // Guards the members below, which the event thread and the workers
+  // share.
+  mutable pthread_mutex_t queue_mutex_;
+  // Signalled when a request is queued, or the workers are to stop.
+  pthread_cond_t queue_cond_;
+  std::deque<DumpRequest*> queue_;
+  // The clients with a request queued or being written.  Each client has
+  // at most one.
+  std::set<pid_t> pending_pids_;
+  bool stopping_workers_;
+  Metrics metrics_;
 
   // disable these
   CrashGenerationServer(const CrashGenerationServer&);
@@ -0,0 +1,212 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_generation_server_unittest.cc: Unit tests for
+// CrashGenerationServer.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "client/linux/crash_generation/client_info.h"
+#include "client/linux/crash_generation/crash_generation_server.h"
+#include "client/linux/handler/exception_handler.h"
+#include "common/linux/eintr_wrapper.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/minidump.h"
+
+using namespace google_breakpad;
+
+namespace {
+
+// Counts the dump callbacks, holding each until another is running at the
+// same time or a few seconds have passed.
+struct DumpCounter {
+  DumpCounter() : active(0), max_active(0), dumps(0) {
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+  }
+
+  ~DumpCounter() {
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&mutex);
+  }
+
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  int active;
+  int max_active;
+  int dumps;
+};
+
+void OnDump(void* context, const ClientInfo* client_info,
+            const string* file_path) {
+  DumpCounter* counter = reinterpret_cast<DumpCounter*>(context);
+  pthread_mutex_lock(&counter->mutex);
+  ++counter->dumps;
+  if (++counter->active > counter->max_active)
+    counter->max_active = counter->active;
+  pthread_cond_broadcast(&counter->cond);
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += 5;
+  while (counter->max_active < 2 &&
+         pthread_cond_timedwait(&counter->cond, &counter->mutex,
+                                &deadline) == 0) {
+  }
+  --counter->active;
+  pthread_mutex_unlock(&counter->mutex);
+}
+
+// Starts |count| processes that each ask for a dump through |client_fd|
+// and exit once it is written. Returns the read end of a pipe whose write
+// end the processes hold until they exit.
+int StartClients(int client_fd, const string& path, int count,
+                 pid_t* children) {
+  int fds[2];
+  if (pipe(fds) != 0)
+    return -1;
+  for (int i = 0; i < count; ++i) {
+    children[i] = fork();
+    if (children[i] == 0) {
+      close(fds[0]);
+      ExceptionHandler handler(MinidumpDescriptor(path), NULL, NULL, NULL,
+                               false, client_fd);
+      _exit(handler.WriteMinidump() ? 0 : 1);
+    }
+  }
+  close(fds[1]);
+  return fds[0];
+}
+
+// Waits for the processes started by StartClients to exit. The server's
+// threads trace them from this process, so waitpid() would also report,
+// and take from the server, their ptrace stops until they have all exited.
+void WaitForClients(int exit_fd, int count, const pid_t* children) {
+  ASSERT_NE(-1, exit_fd);
+  char byte;
+  while (HANDLE_EINTR(read(exit_fd, &byte, 1)) > 0) {
+  }
+  close(exit_fd);
+  for (int i = 0; i < count; ++i) {
+    int status;
+    ASSERT_EQ(children[i], HANDLE_EINTR(waitpid(children[i], &status, 0)));
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(0, WEXITSTATUS(status));
+  }
+}
+
+int CountMinidumps(const string& path) {
+  int count = 0;
+  DIR* dir = opendir(path.c_str());
+  while (struct dirent* entry = readdir(dir)) {
+    const string name = entry->d_name;
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".dmp") == 0) {
+      Minidump minidump(path + "/" + name);
+      EXPECT_TRUE(minidump.Read());
+      ++count;
+    }
+  }
+  closedir(dir);
+  return count;
+}
+
+}  // namespace
+
+TEST(CrashGenerationServerTest, ConcurrentDumps) {
+  int server_fd, client_fd;
+  ASSERT_TRUE(CrashGenerationServer::CreateReportChannel(&server_fd,
+                                                         &client_fd));
+  AutoTempDir temp_dir;
+  const string path = temp_dir.path();
+
+  // The clients are started before the server's threads.
+  const int kClients = 4;
+  pid_t children[kClients];
+  const int exit_fd = StartClients(client_fd, path, kClients, children);
+
+  DumpCounter counter;
+  CrashGenerationServer server(server_fd, OnDump, &counter, NULL, NULL, true,
+                               &path);
+  server.set_max_concurrent_dumps(2);
+  ASSERT_TRUE(server.Start());
+  WaitForClients(exit_fd, kClients, children);
+  server.Stop();
+
+  EXPECT_EQ(kClients, counter.dumps);
+  EXPECT_EQ(2, counter.max_active);
+  EXPECT_EQ(kClients, CountMinidumps(path));
+
+  CrashGenerationServer::Metrics metrics = server.GetMetrics();
+  EXPECT_EQ(static_cast<uint64_t>(kClients), metrics.dumps_written);
+  EXPECT_EQ(0U, metrics.dumps_failed);
+  EXPECT_EQ(0U, metrics.requests_rejected);
+  EXPECT_EQ(0U, metrics.queue_depth);
+  EXPECT_GE(metrics.max_queue_depth, 1U);
+  EXPECT_EQ(0, metrics.dumps_in_progress);
+  EXPECT_GE(metrics.total_write_ns, metrics.max_write_ns);
+  EXPECT_GT(metrics.max_write_ns, 0U);
+  close(client_fd);
+}
+
+TEST(CrashGenerationServerTest, FullQueueRejectsRequests) {
+  int server_fd, client_fd;
+  ASSERT_TRUE(CrashGenerationServer::CreateReportChannel(&server_fd,
+                                                         &client_fd));
+  AutoTempDir temp_dir;
+  const string path = temp_dir.path();
+
+  const int kClients = 2;
+  pid_t children[kClients];
+  const int exit_fd = StartClients(client_fd, path, kClients, children);
+
+  CrashGenerationServer server(server_fd, NULL, NULL, NULL, NULL, true,
+                               &path);
+  server.set_max_queued_dumps(0);
+  ASSERT_TRUE(server.Start());
+  // Refused clients are released without a dump.
+  WaitForClients(exit_fd, kClients, children);
+  server.Stop();
+
+  EXPECT_EQ(0, CountMinidumps(path));
+  CrashGenerationServer::Metrics metrics = server.GetMetrics();
+  EXPECT_EQ(static_cast<uint64_t>(kClients), metrics.requests_rejected);
+  EXPECT_EQ(0U, metrics.dumps_written);
+  close(client_fd);
+}
@@ -0,0 +1,231 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_loop_record.cc: Implement CrashLoopRecord.  See crash_loop_record.h
+// for details.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "client/linux/handler/crash_loop_record.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "client/linux/minidump_writer/line_reader.h"
+#include "common/linux/eintr_wrapper.h"
+#include "common/linux/linux_libc_support.h"
+#include "common/memory_allocator.h"
+#include "third_party/lss/linux_syscall_support.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// At most this many executable mappings are told apart; return addresses
+// in any others are not hashed.
+const int kMaxMappings = 256;
+
+// The stack is searched for return addresses this far above the stack
+// pointer, and up to this many are hashed.
+const size_t kStackScanBytes = 2048;
+const int kStackFrames = 4;
+
+// A mapping of /proc/self/maps, with its file named by a hash of the
+// file's base name, which does not change from one run to the next.
+struct Mapping {
+  uintptr_t start;
+  uintptr_t end;
+  uintptr_t offset;
+  uint64_t name_hash;
+};
+
+const uint32_t kRecordMagic = 0x4c4f4f50;  // 'LOOP'
+
+struct RecordEntry {
+  uint64_t signature;
+  int64_t last_time;
+  uint32_t count;
+  uint32_t padding;
+};
+
+struct Record {
+  uint32_t magic;
+  uint32_t padding;
+  RecordEntry entries[CrashLoopRecord::kSignatureCount];
+};
+
+// 64-bit FNV-1a.
+const uint64_t kHashBasis = 0xcbf29ce484222325ULL;
+
+uint64_t Hash(uint64_t hash, const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Parse a line of /proc/self/maps into |mapping|, returning false if it
+// is not an executable mapping.  Sets |*contains_sp| if it spans |sp|,
+// whatever its permissions.
+bool ParseMapping(const char* line, uintptr_t sp, Mapping* mapping,
+                  bool* contains_sp) {
+  const char* p = my_read_hex_ptr(&mapping->start, line);
+  if (*p != '-')
+    return false;
+  p = my_read_hex_ptr(&mapping->end, p + 1);
+  if (sp >= mapping->start && sp < mapping->end)
+    *contains_sp = true;
+  if (*p != ' ' || my_strlen(p) < 6 || p[3] != 'x')
+    return false;
+  p = my_read_hex_ptr(&mapping->offset, p + 6);
+  const char* name = my_strchr(p, '/');
+  if (!name)
+    name = my_strchr(p, '[');
+  const char* base_name = name ? my_strrchr(name, '/') : NULL;
+  if (base_name)
+    name = base_name + 1;
+  mapping->name_hash =
+      name ? Hash(kHashBasis, name, my_strlen(name)) : kHashBasis;
+  return true;
+}
+
+// Add |address| to |hash| as an offset into the mapping that holds it, if
+// any of |mappings| does.
+bool HashAddress(uint64_t* hash, uintptr_t address,
+                 const Mapping* mappings, int mapping_count) {
+  for (int i = 0; i < mapping_count; ++i) {
+    const Mapping& mapping = mappings[i];
+    if (address >= mapping.start && address < mapping.end) {
+      const uint64_t offset = address - mapping.start + mapping.offset;
+      *hash = Hash(*hash, &mapping.name_hash, sizeof(mapping.name_hash));
+      *hash = Hash(*hash, &offset, sizeof(offset));
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+// static
+uint64_t CrashLoopRecord::Signature(uintptr_t ip, uintptr_t sp) {
+  PageAllocator allocator;
+  Mapping* mappings = reinterpret_cast<Mapping*>(
+      allocator.Alloc(sizeof(Mapping) * kMaxMappings));
+  int mapping_count = 0;
+  uintptr_t stack_end = sp;
+
+  const int fd = sys_open("/proc/self/maps", O_RDONLY, 0);
+  if (fd >= 0 && mappings) {
+    LineReader reader(fd);
+    const char* line;
+    unsigned line_length;
+    while (reader.GetNextLine(&line, &line_length)) {
+      Mapping mapping;
+      bool contains_sp = false;
+      if (ParseMapping(line, sp, &mapping, &contains_sp) &&
+          mapping_count < kMaxMappings) {
+        mappings[mapping_count++] = mapping;
+      }
+      // Only the stack's own mapping is read, so that a stack pointer at
+      // the end of its mapping does not fault.
+      if (contains_sp)
+        stack_end = mapping.end;
+      reader.PopLine(line_length);
+    }
+  }
+  if (fd >= 0)
+    sys_close(fd);
+
+  uint64_t hash = kHashBasis;
+  if (!HashAddress(&hash, ip, mappings, mapping_count))
+    hash = Hash(hash, &ip, sizeof(ip));
+
+  sp &= ~(sizeof(uintptr_t) - 1);
+  if (stack_end - sp > kStackScanBytes)
+    stack_end = sp + kStackScanBytes;
+  int frames = 0;
+  for (uintptr_t address = sp;
+       frames < kStackFrames && address + sizeof(uintptr_t) <= stack_end;
+       address += sizeof(uintptr_t)) {
+    const uintptr_t word = *reinterpret_cast<const uintptr_t*>(address);
+    if (HashAddress(&hash, word, mappings, mapping_count))
+      ++frames;
+  }
+  return hash;
+}
+
+// static
+int CrashLoopRecord::RecordCrash(const char* path, uint64_t signature,
+                                 time_t now, int window_seconds) {
+  const int fd = sys_open(path, O_RDWR | O_CREAT, 0600);
+  if (fd < 0)
+    return 0;
+
+  // A record that can't be read, or isn't one, is started again.
+  Record record;
+  if (HANDLE_EINTR(sys_read(fd, &record, sizeof(record))) !=
+          static_cast<ssize_t>(sizeof(record)) ||
+      record.magic != kRecordMagic) {
+    my_memset(&record, 0, sizeof(record));
+    record.magic = kRecordMagic;
+  }
+
+  RecordEntry* entry = NULL;
+  for (int i = 0; i < kSignatureCount && !entry; ++i) {
+    if (record.entries[i].count && record.entries[i].signature == signature)
+      entry = &record.entries[i];
+  }
+  if (!entry) {
+    entry = &record.entries[0];
+    for (int i = 1; i < kSignatureCount; ++i) {
+      if (record.entries[i].last_time < entry->last_time)
+        entry = &record.entries[i];
+    }
+    my_memset(entry, 0, sizeof(*entry));
+    entry->signature = signature;
+  }
+  // A crash long after the last one starts a new run of them.
+  if (now - entry->last_time > window_seconds || now < entry->last_time)
+    entry->count = 0;
+  ++entry->count;
+  entry->last_time = now;
+
+  const bool written =
+      sys_lseek(fd, 0, SEEK_SET) == 0 &&
+      HANDLE_EINTR(sys_write(fd, &record, sizeof(record))) ==
+          static_cast<ssize_t>(sizeof(record));
+  sys_close(fd);
+  return written ? entry->count : 0;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,68 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_loop_record.h: A small file, kept across restarts of a process,
+// of the signatures of its recent crashes, so that a process crashing the
+// same way again and again can write a full minidump for the first few
+// crashes only.
+
+#ifndef CLIENT_LINUX_HANDLER_CRASH_LOOP_RECORD_H_
+#define CLIENT_LINUX_HANDLER_CRASH_LOOP_RECORD_H_
+
+#include <stdint.h>
+#include <time.h>
+
+namespace google_breakpad {
+
+// Both functions are signal-safe: they allocate nothing from the heap and
+// make only raw system calls.
+class CrashLoopRecord {
+ public:
+  // The number of signatures a record holds.  A new signature replaces
+  // the one seen least recently.
+  static const int kSignatureCount = 16;
+
+  // Return the signature of a crash of this process at instruction IP
+  // with stack pointer SP.  It hashes the module-relative offset of IP and
+  // of the first few return addresses found on the top of the stack, so
+  // that it is the same from one run of the process to the next despite
+  // address space randomization.
+  static uint64_t Signature(uintptr_t ip, uintptr_t sp);
+
+  // Record a crash with SIGNATURE at NOW, in seconds since the epoch, in
+  // the record file at PATH, creating it if need be.  Return how many
+  // crashes with SIGNATURE the record now holds, each within
+  // WINDOW_SECONDS of the one before, counting this one; or 0 if the
+  // record could not be written.
+  static int RecordCrash(const char* path, uint64_t signature, time_t now,
+                         int window_seconds);
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_HANDLER_CRASH_LOOP_RECORD_H_
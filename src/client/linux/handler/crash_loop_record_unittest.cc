@@ -0,0 +1,132 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_loop_record_unittest.cc: Unit tests for CrashLoopRecord.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "client/linux/handler/crash_loop_record.h"
+#include "common/tests/auto_tempdir.h"
+
+using namespace google_breakpad;
+
+namespace {
+
+typedef testing::Test CrashLoopRecordTest;
+
+const int kWindow = 60;
+
+void __attribute__((noinline)) FirstFunction() {
+  asm volatile("");
+}
+
+void __attribute__((noinline)) SecondFunction() {
+  asm volatile("");
+}
+
+}  // namespace
+
+TEST(CrashLoopRecordTest, CountsRepeatsWithinWindow) {
+  AutoTempDir temp_dir;
+  const std::string path = temp_dir.path() + "/record";
+
+  EXPECT_EQ(1, CrashLoopRecord::RecordCrash(path.c_str(), 1, 1000, kWindow));
+  EXPECT_EQ(2, CrashLoopRecord::RecordCrash(path.c_str(), 1, 1030, kWindow));
+  // Each crash is measured from the one before, not from the first.
+  EXPECT_EQ(3, CrashLoopRecord::RecordCrash(path.c_str(), 1, 1080, kWindow));
+  // Another signature is counted apart.
+  EXPECT_EQ(1, CrashLoopRecord::RecordCrash(path.c_str(), 2, 1081, kWindow));
+  EXPECT_EQ(4, CrashLoopRecord::RecordCrash(path.c_str(), 1, 1082, kWindow));
+  // A crash after the window starts a new run.
+  EXPECT_EQ(1, CrashLoopRecord::RecordCrash(path.c_str(), 1, 1200, kWindow));
+}
+
+TEST(CrashLoopRecordTest, ReplacesLeastRecentSignature) {
+  AutoTempDir temp_dir;
+  const std::string path = temp_dir.path() + "/record";
+
+  for (int i = 0; i < CrashLoopRecord::kSignatureCount; ++i) {
+    EXPECT_EQ(1, CrashLoopRecord::RecordCrash(path.c_str(), 100 + i,
+                                              1000 + i, kWindow));
+  }
+  // Signature 100 is the least recent, so it is replaced.
+  EXPECT_EQ(1, CrashLoopRecord::RecordCrash(path.c_str(), 999, 1020,
+                                            kWindow));
+  EXPECT_EQ(1, CrashLoopRecord::RecordCrash(path.c_str(), 100, 1021,
+                                            kWindow));
+  EXPECT_EQ(2, CrashLoopRecord::RecordCrash(path.c_str(), 999, 1022,
+                                            kWindow));
+}
+
+TEST(CrashLoopRecordTest, StartsOverFromBadRecord) {
+  AutoTempDir temp_dir;
+  const std::string path = temp_dir.path() + "/record";
+  FILE* file = fopen(path.c_str(), "w");
+  ASSERT_TRUE(file != NULL);
+  fputs("not a record", file);
+  fclose(file);
+
+  EXPECT_EQ(1, CrashLoopRecord::RecordCrash(path.c_str(), 1, 1000, kWindow));
+  EXPECT_EQ(2, CrashLoopRecord::RecordCrash(path.c_str(), 1, 1001, kWindow));
+}
+
+TEST(CrashLoopRecordTest, UnwritableRecord) {
+  EXPECT_EQ(0, CrashLoopRecord::RecordCrash("/nonexistent/record", 1, 1000,
+                                            kWindow));
+}
+
+TEST(CrashLoopRecordTest, Signature) {
+  const uintptr_t first = reinterpret_cast<uintptr_t>(&FirstFunction);
+  const uintptr_t second = reinterpret_cast<uintptr_t>(&SecondFunction);
+  // Enough return addresses that the search stops within |stack|.
+  uintptr_t stack[64] = {};
+  stack[1] = second;
+  stack[3] = second;
+  stack[6] = first;
+  stack[9] = second;
+  const uintptr_t sp = reinterpret_cast<uintptr_t>(stack);
+
+  const uint64_t signature = CrashLoopRecord::Signature(first, sp);
+  EXPECT_EQ(signature, CrashLoopRecord::Signature(first, sp));
+  EXPECT_NE(signature, CrashLoopRecord::Signature(second, sp));
+
+  // Return addresses on the stack are part of the signature; other words
+  // are not.
+  stack[3] = first;
+  EXPECT_NE(signature, CrashLoopRecord::Signature(first, sp));
+  stack[3] = second;
+  stack[5] = 12345;
+  EXPECT_EQ(signature, CrashLoopRecord::Signature(first, sp));
+}
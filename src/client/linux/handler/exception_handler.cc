@@ -54,6 +54,10 @@
 //                                            V
 //                                         sys_exit
 //
+// With MinidumpDescriptor::prespawn_dump_helper set, HandleSignal instead
+// sends the crash to a helper process started when the ExceptionHandler was
+// created, which runs DoDump (see RunDumpHelper), and only clones a process
+// if the helper cannot take it.
 
 // This code is a little fragmented. Different functions of the ExceptionHandler
 // class run in a number of different contexts. Some of them run in a normal
@@ -77,6 +81,7 @@
 #include <stdio.h>
 #include <sys/mman.h>
 #include <sys/prctl.h>
+#include <sys/socket.h>
 #include <sys/syscall.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -86,6 +91,7 @@
 #include <ucontext.h>
 
 #include <algorithm>
+#include <new>
 #include <utility>
 #include <vector>
 
@@ -93,8 +99,12 @@
 #include "common/linux/breakpad_getcontext.h"
 #include "common/linux/linux_libc_support.h"
 #include "common/memory_allocator.h"
+#include "client/linux/dump_writer_common/ucontext_reader.h"
+#include "client/linux/handler/crash_loop_record.h"
 #include "client/linux/log/log.h"
 #include "client/linux/microdump_writer/microdump_writer.h"
+#include "client/linux/minidump_writer/file_identifier_cache.h"
+#include "client/linux/minidump_writer/warm_dump_state.h"
 #include "client/linux/minidump_writer/linux_dumper.h"
 #include "client/linux/minidump_writer/minidump_writer.h"
 #include "common/linux/eintr_wrapper.h"
@@ -216,6 +226,64 @@ pthread_mutex_t g_handler_stack_mutex_ = PTHREAD_MUTEX_INITIALIZER;
 ExceptionHandler::CrashContext g_crash_context_;
 
 FirstChanceHandler g_first_chance_handler_ = nullptr;
+
+// What the crashing process sends the dump helper for each dump. It is
+// followed by the CrashContext and, if |has_annotations|, by
+// |annotation_count| ConcurrentStringDictionary::Entry structures. The
+// helper already has the mappings and AppMemory regions, as it is
+// restarted when they change. It answers with one byte, 1 if it wrote the
+// dump and 0 if not.
+struct DumpHelperRequest {
+  // The file to write a minidump to, which WriteMinidump() changes for
+  // each dump. Empty for FD and microdump descriptors.
+  char dump_path[PATH_MAX];
+  uint32_t annotation_count;
+  bool has_annotations;
+  bool reference_dump;
+};
+
+// What StartDumpHelper passes the dump helper process.
+struct DumpHelperArgument {
+  ExceptionHandler* handler;
+  // The helper's end of the socket, and the end it closes.
+  int fd;
+  int parent_fd;
+  pid_t parent;
+};
+
+// This function runs in a compromised context: see the top of the file.
+// Sends |size| bytes to the dump helper. The helper may have died, so
+// this must not raise SIGPIPE.
+bool SendToDumpHelper(int fd, const void* data, size_t size) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  while (size > 0) {
+    struct kernel_iovec iov;
+    iov.iov_base = const_cast<uint8_t*>(bytes);
+    iov.iov_len = size;
+    struct kernel_msghdr msg = { 0 };
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    const ssize_t sent = HANDLE_EINTR(sys_sendmsg(fd, &msg, MSG_NOSIGNAL));
+    if (sent <= 0)
+      return false;
+    bytes += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+// Runs in the dump helper process: see RunDumpHelper.
+bool ReceiveFromCrashingProcess(int fd, void* data, size_t size) {
+  uint8_t* bytes = reinterpret_cast<uint8_t*>(data);
+  while (size > 0) {
+    const ssize_t received = HANDLE_EINTR(sys_read(fd, bytes, size));
+    if (received <= 0)
+      return false;
+    bytes += received;
+    size -= received;
+  }
+  return true;
+}
 }  // namespace
 
 // Runs before crashing: normal context.
@@ -238,10 +306,18 @@ ExceptionHandler::ExceptionHandler(const MinidumpDescriptor& descriptor,
     minidump_descriptor_.UpdatePath();
 
 #if defined(__ANDROID__)
-  if (minidump_descriptor_.IsMicrodumpOnConsole())
+  if (minidump_descriptor_.IsMicrodumpOnConsole()) {
     logger::initializeCrashLogWriter();
+    if (minidump_descriptor_.microdump_logd_socket())
+      logger::initializeCrashLogSocket();
+  }
 #endif
 
+  // Mapped before the handlers are installed, so that any crash they catch
+  // can allocate from it.
+  if (minidump_descriptor_.allocator_reserve_size())
+    PageReserve::Create(minidump_descriptor_.allocator_reserve_size());
+
   pthread_mutex_lock(&g_handler_stack_mutex_);
 
   // Pre-fault the crash context struct. This is to avoid failing due to OOM
@@ -256,6 +332,18 @@ ExceptionHandler::ExceptionHandler(const MinidumpDescriptor& descriptor,
   }
   g_handler_stack_->push_back(this);
   pthread_mutex_unlock(&g_handler_stack_mutex_);
+
+  if (minidump_descriptor_.warm_state_interval() > 0) {
+    started_warm_dump_state_ =
+        WarmDumpState::Start(minidump_descriptor_.warm_state_interval());
+  } else if (minidump_descriptor_.cache_module_identifiers()) {
+    UpdateModuleIdentifierCache();
+  }
+
+  // Forked last, so that the helper has the module identifiers and the
+  // handlers' state.
+  if (minidump_descriptor_.prespawn_dump_helper())
+    StartDumpHelper();
 }
 
 // Runs before crashing: normal context.
@@ -271,6 +359,227 @@ ExceptionHandler::~ExceptionHandler() {
     RestoreHandlersLocked();
   }
   pthread_mutex_unlock(&g_handler_stack_mutex_);
+
+  StopDumpHelper();
+
+  if (started_warm_dump_state_)
+    WarmDumpState::Stop();
+}
+
+// Runs before crashing: normal context.
+void ExceptionHandler::set_minidump_descriptor(
+    const MinidumpDescriptor& descriptor) {
+  StopDumpHelper();
+  minidump_descriptor_ = descriptor;
+  if (minidump_descriptor_.prespawn_dump_helper())
+    StartDumpHelper();
+}
+
+// Runs before crashing: normal context.
+bool ExceptionHandler::StartDumpHelper() {
+  // The helper's memory is a copy of this process's from when it was
+  // started, so it cannot write dumps that are read from the dump process's
+  // own memory, or breadcrumbs, which cannot be sent to it.
+  if (IsOutOfProcess() || minidump_descriptor_.write_from_snapshot() ||
+      minidump_descriptor_.breadcrumbs()) {
+    return false;
+  }
+
+  if (minidump_descriptor_.record_dump_timings()) {
+    void* shared = mmap(NULL, sizeof(DumpTimings), PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared != MAP_FAILED)
+      dump_helper_timings_ = reinterpret_cast<DumpTimings*>(shared);
+  }
+  dump_helper_annotations_.reset(new ConcurrentStringDictionary);
+
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1) {
+    StopDumpHelper();
+    return false;
+  }
+
+  static const size_t kDumpHelperStackSize = 64 * 1024;
+  void* stack = mmap(NULL, kDumpHelperStackSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (stack == MAP_FAILED) {
+    close(fds[0]);
+    close(fds[1]);
+    StopDumpHelper();
+    return false;
+  }
+
+  // Without CLONE_VM the helper gets a copy of this process's memory, as
+  // with fork(), but no exit signal is asked for: the application's
+  // SIGCHLD handler and wait() calls never see the helper, which only
+  // StopDumpHelper() reaps. No atfork handlers run either, so whatever
+  // locks other threads held stay held in the copy, which is why the
+  // helper does not allocate.
+  DumpHelperArgument argument;
+  argument.handler = this;
+  argument.fd = fds[1];
+  argument.parent_fd = fds[0];
+  argument.parent = getpid();
+  const pid_t helper = sys_clone(
+      DumpHelperEntry, reinterpret_cast<uint8_t*>(stack) + kDumpHelperStackSize,
+      CLONE_UNTRACED, &argument, NULL, NULL, NULL);
+  munmap(stack, kDumpHelperStackSize);
+  close(fds[1]);
+  if (helper == -1) {
+    close(fds[0]);
+    StopDumpHelper();
+    return false;
+  }
+
+  dump_helper_pid_ = helper;
+  dump_helper_fd_ = fds[0];
+  // Allow the helper to ptrace us. This is done again for each dump, as a
+  // cloned dump process may have been allowed since.
+  sys_prctl(PR_SET_PTRACER, helper, 0, 0, 0);
+  return true;
+}
+
+// Runs before crashing: normal context.
+void ExceptionHandler::StopDumpHelper() {
+  if (dump_helper_fd_ >= 0) {
+    // The helper exits once it reads the end of the socket.
+    close(dump_helper_fd_);
+    dump_helper_fd_ = -1;
+  }
+  if (dump_helper_pid_ > 0) {
+    ignore_result(HANDLE_EINTR(waitpid(dump_helper_pid_, NULL, __WALL)));
+    dump_helper_pid_ = -1;
+  }
+  if (dump_helper_timings_) {
+    munmap(dump_helper_timings_, sizeof(DumpTimings));
+    dump_helper_timings_ = nullptr;
+  }
+  dump_helper_annotations_.reset();
+}
+
+// Runs before crashing: normal context.
+void ExceptionHandler::RestartDumpHelper() {
+  if (dump_helper_pid_ <= 0)
+    return;
+  StopDumpHelper();
+  StartDumpHelper();
+}
+
+// Runs in the dump helper process: see RunDumpHelper.
+// static
+int ExceptionHandler::DumpHelperEntry(void* arg) {
+  const DumpHelperArgument* argument =
+      reinterpret_cast<const DumpHelperArgument*>(arg);
+  sys_close(argument->parent_fd);
+  argument->handler->RunDumpHelper(argument->fd, argument->parent);
+  return 0;
+}
+
+// Runs in the dump helper process, a copy of this process made while other
+// threads may have held locks: like a compromised context, it must not
+// allocate or call into libc beyond system calls.
+void ExceptionHandler::RunDumpHelper(int fd, pid_t parent) {
+  // A crash of the helper is not the process's.
+  for (int i = 0; i < kNumHandledSignals; ++i)
+    InstallDefaultHandler(kExceptionSignals[i]);
+
+  CrashContext context;
+  DumpHelperRequest request;
+  ConcurrentStringDictionary* const annotations =
+      dump_helper_annotations_.get();
+  while (ReceiveFromCrashingProcess(fd, &request, sizeof(request)) &&
+         ReceiveFromCrashingProcess(fd, &context, sizeof(context))) {
+    if (dump_helper_timings_)
+      dump_helper_timings_->End(MD_DUMP_TIMING_CLONE);
+    request.dump_path[sizeof(request.dump_path) - 1] = '\0';
+
+    // The dictionary was allocated before the helper started, and is only
+    // emptied here.
+    if (request.has_annotations)
+      new (annotations) ConcurrentStringDictionary;
+    bool received = true;
+    for (uint32_t i = 0; received && i < request.annotation_count; ++i) {
+      ConcurrentStringDictionary::Entry entry;
+      received = ReceiveFromCrashingProcess(fd, &entry, sizeof(entry));
+      entry.key[sizeof(entry.key) - 1] = '\0';
+      entry.value[sizeof(entry.value) - 1] = '\0';
+      if (request.has_annotations && entry.key[0])
+        annotations->SetKeyValue(entry.key, entry.value);
+    }
+    if (!received)
+      break;
+    minidump_descriptor_.set_annotations(
+        request.has_annotations ? annotations : NULL);
+
+    dump_timings_ = dump_helper_timings_;
+    reference_dump_ = request.reference_dump;
+    const char success =
+        DoDump(parent, &context, sizeof(context), request.dump_path);
+    dump_timings_ = NULL;
+    minidump_descriptor_.set_annotations(NULL);
+    if (HANDLE_EINTR(sys_write(fd, &success, sizeof(success))) != 1)
+      break;
+  }
+}
+
+// This function runs in a compromised context: see the top of the file.
+bool ExceptionHandler::RequestDumpFromHelper(const CrashContext* context,
+                                             uint64_t handle_signal_time_ns,
+                                             bool* success) {
+  DumpTimings* timings = dump_helper_timings_;
+  if (timings) {
+    timings->Clear();
+    timings->start_ns[MD_DUMP_TIMING_HANDLER] = handle_signal_time_ns;
+    timings->End(MD_DUMP_TIMING_HANDLER);
+    timings->Begin(MD_DUMP_TIMING_CLONE);
+  }
+
+  DumpHelperRequest request;
+  my_memset(&request, 0, sizeof(request));
+  request.reference_dump = reference_dump_;
+  if (!minidump_descriptor_.IsFD() &&
+      !minidump_descriptor_.IsMicrodumpOnConsole()) {
+    my_strlcpy(request.dump_path, minidump_descriptor_.path(),
+               sizeof(request.dump_path));
+  }
+  // The annotations are copied out as they are sent, so they are counted
+  // the same way; a value set in between is sent as it was when counted.
+  const ConcurrentStringDictionary* annotations =
+      minidump_descriptor_.annotations();
+  ConcurrentStringDictionary::Entry entry;
+  if (annotations) {
+    request.has_annotations = true;
+    ConcurrentStringDictionary::Iterator iter(*annotations);
+    while (iter.Next(&entry))
+      ++request.annotation_count;
+  }
+
+  sys_prctl(PR_SET_PTRACER, dump_helper_pid_, 0, 0, 0);
+  const int fd = dump_helper_fd_;
+  bool sent = SendToDumpHelper(fd, &request, sizeof(request)) &&
+              SendToDumpHelper(fd, context, sizeof(*context));
+  if (annotations) {
+    ConcurrentStringDictionary::Iterator iter(*annotations);
+    for (uint32_t i = 0; sent && i < request.annotation_count; ++i) {
+      if (!iter.Next(&entry))
+        my_memset(&entry, 0, sizeof(entry));
+      sent = SendToDumpHelper(fd, &entry, sizeof(entry));
+    }
+  }
+
+  char answer;
+  if (!sent || HANDLE_EINTR(sys_read(fd, &answer, sizeof(answer))) != 1) {
+    // The helper is gone, or is in an unknown state; the dump is written
+    // by a cloned process instead, as are any later ones.
+    static const char msg[] = "ExceptionHandler::RequestDumpFromHelper "
+                              "the dump helper did not answer\n";
+    logger::write(msg, sizeof(msg) - 1);
+    sys_close(dump_helper_fd_);
+    dump_helper_fd_ = -1;
+    return false;
+  }
+  *success = answer == 1;
+  return true;
 }
 
 // Runs before crashing: normal context.
@@ -433,14 +742,20 @@ int ExceptionHandler::ThreadEntry(void* arg) {
   // we're allowed to use ptrace
   thread_arg->handler->WaitForContinueSignal();
   sys_close(thread_arg->handler->fdes[0]);
+  if (thread_arg->handler->dump_timings_)
+    thread_arg->handler->dump_timings_->End(MD_DUMP_TIMING_CLONE);
 
-  return thread_arg->handler->DoDump(thread_arg->pid, thread_arg->context,
-                                     thread_arg->context_size) == false;
+  return thread_arg->handler->DoDump(
+      thread_arg->pid, thread_arg->context, thread_arg->context_size,
+      thread_arg->minidump_descriptor->path()) == false;
 }
 
 // This function runs in a compromised context: see the top of the file.
 // Runs on the crashing thread.
 bool ExceptionHandler::HandleSignal(int /*sig*/, siginfo_t* info, void* uc) {
+  if (minidump_descriptor_.record_dump_timings())
+    handle_signal_time_ns_ = DumpTimings::Now();
+
   if (filter_ && !filter_(callback_context_))
     return false;
 
@@ -496,16 +811,45 @@ bool ExceptionHandler::SimulateSignalDelivery(int sig) {
 
 // This function may run in a compromised context: see the top of the file.
 bool ExceptionHandler::GenerateDump(CrashContext* context) {
+  const uint64_t handle_signal_time_ns = handle_signal_time_ns_;
+  handle_signal_time_ns_ = 0;
   if (IsOutOfProcess())
     return crash_generation_client_->RequestDump(context, sizeof(*context));
 
+  reference_dump_ = ShouldWriteReferenceDump(context);
+
+  bool success = false;
+  if (dump_helper_fd_ >= 0 &&
+      RequestDumpFromHelper(context, handle_signal_time_ns, &success)) {
+    if (dump_helper_timings_ && dump_timing_callback_)
+      dump_timing_callback_(*dump_helper_timings_, callback_context_);
+    if (callback_)
+      success = callback_(minidump_descriptor_, callback_context_, success);
+    return success;
+  }
+
+  // The dump process has a copy of this process's memory, not a share of
+  // it, so the timings it records are put in a shared mapping.
+  DumpTimings* timings = NULL;
+  if (minidump_descriptor_.record_dump_timings()) {
+    void* shared = sys_mmap(NULL, sizeof(DumpTimings), PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared != MAP_FAILED) {
+      timings = reinterpret_cast<DumpTimings*>(shared);
+      timings->start_ns[MD_DUMP_TIMING_HANDLER] = handle_signal_time_ns;
+    }
+  }
+
   // Allocating too much stack isn't a problem, and better to err on the side
   // of caution than smash it into random locations.
   static const unsigned kChildStackSize = 16000;
   PageAllocator allocator;
   uint8_t* stack = reinterpret_cast<uint8_t*>(allocator.Alloc(kChildStackSize));
-  if (!stack)
+  if (!stack) {
+    if (timings)
+      sys_munmap(timings, sizeof(DumpTimings));
     return false;
+  }
   // clone() needs the top-most address. (scrub just to be safe)
   stack += kChildStackSize;
   my_memset(stack - 16, 0, 16);
@@ -535,12 +879,20 @@ bool ExceptionHandler::GenerateDump(CrashContext* context) {
     fdes[0] = fdes[1] = -1;
   }
 
+  dump_timings_ = timings;
+  if (timings) {
+    timings->End(MD_DUMP_TIMING_HANDLER);
+    timings->Begin(MD_DUMP_TIMING_CLONE);
+  }
   const pid_t child = sys_clone(
       ThreadEntry, stack, CLONE_FS | CLONE_UNTRACED, &thread_arg, NULL, NULL,
       NULL);
+  dump_timings_ = NULL;
   if (child == -1) {
     sys_close(fdes[0]);
     sys_close(fdes[1]);
+    if (timings)
+      sys_munmap(timings, sizeof(DumpTimings));
     return false;
   }
 
@@ -561,12 +913,39 @@ bool ExceptionHandler::GenerateDump(CrashContext* context) {
     logger::write("\n", 1);
   }
 
-  bool success = r != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  success = r != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  if (timings) {
+    if (dump_timing_callback_)
+      dump_timing_callback_(*timings, callback_context_);
+    sys_munmap(timings, sizeof(DumpTimings));
+  }
   if (callback_)
     success = callback_(minidump_descriptor_, callback_context_, success);
   return success;
 }
 
+// This function runs in a compromised context: see the top of the file.
+bool ExceptionHandler::ShouldWriteReferenceDump(const CrashContext* context) {
+  const string& record_path = minidump_descriptor_.crash_loop_record_path();
+  if (record_path.empty() || minidump_descriptor_.IsMicrodumpOnConsole() ||
+      static_cast<uint32_t>(context->siginfo.si_signo) ==
+          MD_EXCEPTION_CODE_LIN_DUMP_REQUESTED) {
+    return false;
+  }
+
+  struct kernel_timespec now;
+  if (sys_clock_gettime(CLOCK_REALTIME, &now) != 0)
+    return false;
+  const uint64_t signature = CrashLoopRecord::Signature(
+      UContextReader::GetInstructionPointer(&context->context),
+      UContextReader::GetStackPointer(&context->context));
+  const int count = CrashLoopRecord::RecordCrash(
+      record_path.c_str(), signature, now.tv_sec,
+      minidump_descriptor_.crash_loop_window());
+  // A record that can't be written throttles nothing.
+  return count > minidump_descriptor_.crash_loop_full_dumps();
+}
+
 // This function runs in a compromised context: see the top of the file.
 void ExceptionHandler::SendContinueSignalToChild() {
   static const char okToContinueMessage = 'a';
@@ -599,12 +978,27 @@ void ExceptionHandler::WaitForContinueSignal() {
 // This function runs in a compromised context: see the top of the file.
 // Runs on the cloned process.
 bool ExceptionHandler::DoDump(pid_t crashing_process, const void* context,
-                              size_t context_size) {
+                              size_t context_size, const char* dump_path) {
   const bool may_skip_dump =
       minidump_descriptor_.skip_dump_if_principal_mapping_not_referenced();
   const uintptr_t principal_mapping_address =
       minidump_descriptor_.address_within_principal_mapping();
   const bool sanitize_stacks = minidump_descriptor_.sanitize_stacks();
+  const int stack_capture_tasks = minidump_descriptor_.stack_capture_tasks();
+  const bool write_from_snapshot = minidump_descriptor_.write_from_snapshot();
+  const size_t memory_budget = minidump_descriptor_.memory_budget();
+  const bool compress = minidump_descriptor_.compress();
+  // Crashes are dumped whole, unless they repeat an earlier crash; only
+  // dumps that were asked for are sampled.
+  const CrashContext* crash_context =
+      reinterpret_cast<const CrashContext*>(context);
+  size_t stack_sample_size =
+      context_size == sizeof(CrashContext) &&
+      static_cast<uint32_t>(crash_context->siginfo.si_signo) ==
+          MD_EXCEPTION_CODE_LIN_DUMP_REQUESTED ?
+      minidump_descriptor_.stack_sample_size() : 0;
+  if (reference_dump_)
+    stack_sample_size = minidump_descriptor_.reference_dump_stack_size();
   if (minidump_descriptor_.IsMicrodumpOnConsole()) {
     return google_breakpad::WriteMicrodump(
         crashing_process,
@@ -614,6 +1008,7 @@ bool ExceptionHandler::DoDump(pid_t crashing_process, const void* context,
         may_skip_dump,
         principal_mapping_address,
         sanitize_stacks,
+        minidump_descriptor_.microdump_full_stack_size(),
         *minidump_descriptor_.microdump_extra_info());
   }
   if (minidump_descriptor_.IsFD()) {
@@ -626,9 +1021,17 @@ bool ExceptionHandler::DoDump(pid_t crashing_process, const void* context,
                                           app_memory_list_,
                                           may_skip_dump,
                                           principal_mapping_address,
-                                          sanitize_stacks);
+                                          sanitize_stacks,
+                                          stack_capture_tasks,
+                                          write_from_snapshot,
+                                          memory_budget,
+                                          compress,
+                                          dump_timings_,
+                                          minidump_descriptor_.annotations(),
+                                          minidump_descriptor_.breadcrumbs(),
+                                          stack_sample_size);
   }
-  return google_breakpad::WriteMinidump(minidump_descriptor_.path(),
+  return google_breakpad::WriteMinidump(dump_path,
                                         minidump_descriptor_.size_limit(),
                                         crashing_process,
                                         context,
@@ -637,7 +1040,15 @@ bool ExceptionHandler::DoDump(pid_t crashing_process, const void* context,
                                         app_memory_list_,
                                         may_skip_dump,
                                         principal_mapping_address,
-                                        sanitize_stacks);
+                                        sanitize_stacks,
+                                        stack_capture_tasks,
+                                        write_from_snapshot,
+                                        memory_budget,
+                                        compress,
+                                        dump_timings_,
+                                        minidump_descriptor_.annotations(),
+                                        minidump_descriptor_.breadcrumbs(),
+                                        stack_sample_size);
 }
 
 // static
@@ -751,6 +1162,12 @@ void ExceptionHandler::AddMappingInfo(const string& name,
   mapping.first = info;
   memcpy(mapping.second, identifier, sizeof(MDGUID));
   mapping_list_.push_back(mapping);
+  RestartDumpHelper();
+}
+
+// static
+void ExceptionHandler::UpdateModuleIdentifierCache() {
+  FileIdentifierCache::AddMappedFiles();
 }
 
 void ExceptionHandler::RegisterAppMemory(void* ptr, size_t length) {
@@ -765,6 +1182,7 @@ void ExceptionHandler::RegisterAppMemory(void* ptr, size_t length) {
   app_memory.ptr = ptr;
   app_memory.length = length;
   app_memory_list_.push_back(app_memory);
+  RestartDumpHelper();
 }
 
 void ExceptionHandler::UnregisterAppMemory(void* ptr) {
@@ -772,6 +1190,7 @@ void ExceptionHandler::UnregisterAppMemory(void* ptr) {
     std::find(app_memory_list_.begin(), app_memory_list_.end(), ptr);
   if (iter != app_memory_list_.end()) {
     app_memory_list_.erase(iter);
+    RestartDumpHelper();
   }
 }
 
@@ -38,6 +38,7 @@
 
 #include "client/linux/crash_generation/crash_generation_client.h"
 #include "client/linux/handler/minidump_descriptor.h"
+#include "client/linux/minidump_writer/dump_timings.h"
 #include "client/linux/minidump_writer/minidump_writer.h"
 #include "common/scoped_ptr.h"
 #include "common/using_std_string.h"
@@ -121,6 +122,18 @@ class ExceptionHandler {
                                   size_t crash_context_size,
                                   void* context);
 
+  // A callback function to run after a minidump has been written with
+  // MinidumpDescriptor::record_dump_timings set, just before the
+  // MinidumpCallback.  |timings| holds the start and duration of each phase
+  // of the dump that was reached, including MD_DUMP_TIMING_FILE_WRITE,
+  // which the minidump's MD_LINUX_DUMP_TIMING stream cannot hold.  With
+  // MinidumpDescriptor::write_from_snapshot set, the phases after the
+  // thread list may still be running.  |context| is the parameter supplied
+  // by the user as callback_context when the handler was created.  This
+  // runs in the crashing process, in a compromised context.
+  typedef void (*DumpTimingCallback)(const DumpTimings& timings,
+                                     void* context);
+
   // Creates a new ExceptionHandler instance to handle writing minidumps.
   // Before writing a minidump, the optional |filter| callback will be called.
   // Its return value determines whether or not Breakpad should write a
@@ -144,14 +157,18 @@ class ExceptionHandler {
     return minidump_descriptor_;
   }
 
-  void set_minidump_descriptor(const MinidumpDescriptor& descriptor) {
-    minidump_descriptor_ = descriptor;
-  }
+  // Not signal-safe: a helper process forked for the previous descriptor
+  // is stopped, and one is forked for |descriptor| if it asks for one.
+  void set_minidump_descriptor(const MinidumpDescriptor& descriptor);
 
   void set_crash_handler(HandlerCallback callback) {
     crash_handler_ = callback;
   }
 
+  void set_dump_timing_callback(DumpTimingCallback callback) {
+    dump_timing_callback_ = callback;
+  }
+
   void set_crash_generation_client(CrashGenerationClient* client) {
     crash_generation_client_.reset(client);
   }
@@ -219,6 +236,14 @@ class ExceptionHandler {
                       size_t mapping_size,
                       size_t file_offset);
 
+  // Compute the identifiers of the modules now mapped into this process
+  // that have not been seen before, so that the minidump writer can look
+  // them up instead of reading each module at crash time.  Handlers whose
+  // MinidumpDescriptor has cache_module_identifiers set do this when they
+  // are created; call this after loading libraries to cover them too.
+  // Not signal-safe.
+  static void UpdateModuleIdentifierCache();
+
   // Register a block of memory of length bytes starting at address ptr
   // to be copied to the minidump when a crash happens.
   void RegisterAppMemory(void* ptr, size_t length);
@@ -232,6 +257,17 @@ class ExceptionHandler {
   // Report a crash signal from an SA_SIGINFO signal handler.
   bool HandleSignal(int sig, siginfo_t* info, void* uc);
 
+  // Whether the crash dump last written was a reference dump, because the
+  // crash repeated an earlier one (see MinidumpDescriptor::
+  // set_crash_loop_record_path). A MinidumpCallback may check this, for
+  // instance to not upload the dump.
+  bool wrote_reference_dump() const { return reference_dump_; }
+
+  // Whether crash dumps are to be written by the dump helper process (see
+  // MinidumpDescriptor::set_prespawn_dump_helper): false if there is none,
+  // or if it stopped answering and dumps are written by a cloned process.
+  bool has_dump_helper() const { return dump_helper_fd_ >= 0; }
+
  private:
   // Save the old signal handlers and install new ones.
   static bool InstallHandlersLocked();
@@ -240,13 +276,40 @@ class ExceptionHandler {
 
   void PreresolveSymbols();
   bool GenerateDump(CrashContext* context);
+  // Records the crash that |context| describes with CrashLoopRecord, and
+  // returns true if it is to get a reference dump instead of a full one.
+  bool ShouldWriteReferenceDump(const CrashContext* context);
   void SendContinueSignalToChild();
   void WaitForContinueSignal();
 
   static void SignalHandler(int sig, siginfo_t* info, void* uc);
   static int ThreadEntry(void* arg);
+  // Writes the dump of |crashing_process|. |dump_path| is the file that a
+  // minidump is written to if the descriptor is not an FD or a microdump.
   bool DoDump(pid_t crashing_process, const void* context,
-              size_t context_size);
+              size_t context_size, const char* dump_path);
+
+  // Starts the dump helper process for MinidumpDescriptor::
+  // prespawn_dump_helper, unless the descriptor needs a dump process that
+  // is a copy of the crashed one.  Returns false if there is no helper.
+  bool StartDumpHelper();
+  // Stops the dump helper process, if there is one, and reaps it.
+  void StopDumpHelper();
+  // Starts a new dump helper process, if there is one, so that it has the
+  // current mappings and AppMemory regions.
+  void RestartDumpHelper();
+  static int DumpHelperEntry(void* arg);
+  // The loop of the dump helper process: dumps |parent| each time it is
+  // asked to through |fd|, until |fd| is closed.  The helper is a copy of
+  // this process made while other threads may have held locks, so this
+  // only makes system calls and uses memory allocated before the copy.
+  void RunDumpHelper(int fd, pid_t parent);
+  // Asks the dump helper process to write the dump for |context|, and
+  // sets |success| to its answer.  Returns false if the helper could not
+  // be asked or did not answer, in which case the dump is still to be
+  // written.
+  bool RequestDumpFromHelper(const CrashContext* context,
+                             uint64_t handle_signal_time_ns, bool* success);
 
   const FilterCallback filter_;
   const MinidumpCallback callback_;
@@ -262,6 +325,19 @@ class ExceptionHandler {
   // believes are never read.
   volatile HandlerCallback crash_handler_;
 
+  // Volatile for the same reason as |crash_handler_|.
+  volatile DumpTimingCallback dump_timing_callback_ = nullptr;
+
+  // When HandleSignal was entered, if the dump is timed, or else 0.
+  uint64_t handle_signal_time_ns_ = 0;
+
+  // While a timed dump is written, the timings, in memory shared with the
+  // dump process.
+  DumpTimings* dump_timings_ = nullptr;
+
+  // Whether the dump being written, or last written, is a reference dump.
+  bool reference_dump_ = false;
+
   // We need to explicitly enable ptrace of parent processes on some
   // kernels, but we need to know the PID of the cloned process before we
   // can do this. We create a pipe which we can use to block the
@@ -276,6 +352,24 @@ class ExceptionHandler {
   // Callers can request additional memory regions to be included in
   // the dump.
   AppMemoryList app_memory_list_;
+
+  // The dump helper process, and this process's end of the socket it
+  // reads requests from, or -1.  See MinidumpDescriptor::
+  // prespawn_dump_helper.
+  pid_t dump_helper_pid_ = -1;
+  int dump_helper_fd_ = -1;
+
+  // If the descriptor records dump timings, the timings of the helper's
+  // dumps, in memory shared with it.
+  DumpTimings* dump_helper_timings_ = nullptr;
+
+  // Where the dump helper puts the annotations it receives with each
+  // request, allocated before it is started.
+  scoped_ptr<ConcurrentStringDictionary> dump_helper_annotations_;
+
+  // Whether this handler started WarmDumpState's refresh thread, and must
+  // stop it when destroyed.
+  bool started_warm_dump_state_ = false;
 };
 
 typedef bool (*FirstChanceHandler)(int, siginfo_t*, void*);
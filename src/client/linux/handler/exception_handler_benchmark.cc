@@ -0,0 +1,316 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// exception_handler_benchmark.cc: Measures how long ExceptionHandler
+// freezes a crashing process, from the signal to the MinidumpCallback.
+//
+// Usage: exception_handler_benchmark [-t threads] [-m mappings]
+//            [-s stack_kb] [-a app_memory_regions] [-k app_memory_kb]
+//            [-r runs] [-d directory]
+//
+// Each run forks a process that, like linux_dumper_unittest_helper, starts
+// |threads| threads, each using |stack_kb| KB of its stack, maps
+// |mappings| extra pages, every other one executable, and registers
+// |app_memory_regions| heap blocks of |app_memory_kb| KB with
+// RegisterAppMemory.  It installs a handler recording the dump timings and
+// then dereferences NULL.  The minidumps go in |directory| and are
+// deleted.
+//
+// One CSV line is written per run, after a header line: the configuration,
+// the time from just before the crash to the MinidumpCallback, the time
+// until the signal handler was entered, and the duration of each
+// MDDumpTimingPhase, all in microseconds.  A phase that was not reached is
+// left empty.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <alloca.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "client/linux/handler/exception_handler.h"
+#include "client/linux/handler/minidump_descriptor.h"
+#include "client/linux/minidump_writer/dump_timings.h"
+
+using google_breakpad::DumpTimings;
+using google_breakpad::ExceptionHandler;
+using google_breakpad::MinidumpDescriptor;
+
+namespace {
+
+// Written by the crashing process, in memory shared with this one.
+struct RunResult {
+  uint64_t crash_ns;
+  uint64_t callback_ns;
+  bool succeeded;
+  bool have_timings;
+  DumpTimings timings;
+};
+
+// The column names of the MDDumpTimingPhases, in order.
+const char* const kPhaseNames[MD_DUMP_TIMING_PHASE_COUNT] = {
+  "handler",
+  "clone",
+  "thread_enumeration",
+  "mapping_enumeration",
+  "threads_suspend",
+  "thread_list",
+  "proc_files",
+  "module_list",
+  "memory_list",
+  "other_streams",
+  "threads_resume",
+  "file_write",
+};
+
+struct ThreadArgs {
+  size_t stack_kb;
+  int ready_fd;
+  int block_fd;
+};
+
+// Fills |stack_kb| of the thread's stack with a mix of small integers and
+// pointers into it, then blocks until the process dies.
+void* ThreadMain(void* data) {
+  const ThreadArgs* args = static_cast<const ThreadArgs*>(data);
+  const size_t word_count = args->stack_kb * 1024 / sizeof(uintptr_t);
+  volatile uintptr_t* words =
+      static_cast<uintptr_t*>(alloca(word_count * sizeof(uintptr_t)));
+  for (size_t i = 0; i < word_count; ++i) {
+    words[i] = i % 2 ? reinterpret_cast<uintptr_t>(&words[i / 2])
+                     : i % 4096;
+  }
+
+  char byte = 1;
+  if (write(args->ready_fd, &byte, 1) != 1)
+    return NULL;
+  while (read(args->block_fd, &byte, 1) != 0) {
+  }
+  return const_cast<uintptr_t*>(words);
+}
+
+void CopyTimings(const DumpTimings& timings, void* context) {
+  RunResult* result = static_cast<RunResult*>(context);
+  result->timings = timings;
+  result->have_timings = true;
+}
+
+bool MinidumpWritten(const MinidumpDescriptor& descriptor, void* context,
+                     bool succeeded) {
+  RunResult* result = static_cast<RunResult*>(context);
+  result->callback_ns = DumpTimings::Now();
+  result->succeeded = succeeded;
+  unlink(descriptor.path());
+  return true;
+}
+
+// Runs in the forked process, which doesn't return.
+void CrashingProcess(size_t thread_count, size_t mapping_count,
+                     size_t stack_kb, size_t app_memory_count,
+                     size_t app_memory_kb, const char* directory,
+                     RunResult* result) {
+  const size_t page_size = getpagesize();
+  for (size_t i = 0; i < mapping_count; ++i) {
+    int protection = i % 2 ? PROT_READ | PROT_EXEC : PROT_READ;
+    if (mmap(NULL, page_size, protection, MAP_PRIVATE | MAP_ANONYMOUS,
+             -1, 0) == MAP_FAILED) {
+      perror("mmap");
+      _exit(1);
+    }
+  }
+
+  int ready_fds[2];
+  int block_fds[2];
+  if (pipe(ready_fds) != 0 || pipe(block_fds) != 0) {
+    perror("pipe");
+    _exit(1);
+  }
+  ThreadArgs args = { stack_kb, ready_fds[1], block_fds[0] };
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, stack_kb * 1024 + 64 * 1024);
+  for (size_t i = 0; i < thread_count; ++i) {
+    pthread_t thread;
+    if (pthread_create(&thread, &attr, ThreadMain, &args) != 0) {
+      perror("pthread_create");
+      _exit(1);
+    }
+  }
+  pthread_attr_destroy(&attr);
+  for (size_t i = 0; i < thread_count; ++i) {
+    char byte;
+    if (read(ready_fds[0], &byte, 1) != 1) {
+      perror("read");
+      _exit(1);
+    }
+  }
+
+  MinidumpDescriptor descriptor(directory);
+  descriptor.set_record_dump_timings(true);
+  ExceptionHandler handler(descriptor, NULL, MinidumpWritten, result, true,
+                           -1);
+  handler.set_dump_timing_callback(CopyTimings);
+
+  const size_t app_memory_size = app_memory_kb * 1024;
+  for (size_t i = 0; i < app_memory_count; ++i) {
+    char* block = static_cast<char*>(malloc(app_memory_size));
+    memset(block, static_cast<int>(i), app_memory_size);
+    handler.RegisterAppMemory(block, app_memory_size);
+  }
+
+  result->crash_ns = DumpTimings::Now();
+  *reinterpret_cast<volatile int*>(NULL) = 0;
+  _exit(1);
+}
+
+void PrintMicroseconds(uint64_t ns) {
+  printf(",%.1f", ns / 1000.0);
+}
+
+void Usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [-t threads] [-m mappings] [-s stack_kb]\n"
+          "          [-a app_memory_regions] [-k app_memory_kb] [-r runs]\n"
+          "          [-d directory]\n", program);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t thread_count = 16;
+  size_t mapping_count = 0;
+  size_t stack_kb = 16;
+  size_t app_memory_count = 0;
+  size_t app_memory_kb = 4;
+  size_t runs = 5;
+  const char* directory = "/tmp";
+  int ch;
+  while ((ch = getopt(argc, argv, "t:m:s:a:k:r:d:")) != -1) {
+    switch (ch) {
+      case 't':
+        thread_count = strtoul(optarg, NULL, 10);
+        break;
+      case 'm':
+        mapping_count = strtoul(optarg, NULL, 10);
+        break;
+      case 's':
+        stack_kb = strtoul(optarg, NULL, 10);
+        break;
+      case 'a':
+        app_memory_count = strtoul(optarg, NULL, 10);
+        break;
+      case 'k':
+        app_memory_kb = strtoul(optarg, NULL, 10);
+        break;
+      case 'r':
+        runs = strtoul(optarg, NULL, 10);
+        break;
+      case 'd':
+        directory = optarg;
+        break;
+      default:
+        Usage(argv[0]);
+        return 1;
+    }
+  }
+  if (runs == 0 || app_memory_kb == 0) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  void* shared = mmap(NULL, sizeof(RunResult), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  RunResult* result = static_cast<RunResult*>(shared);
+
+  printf("threads,mappings,stack_kb,app_memory_regions,app_memory_kb,run,"
+         "freeze_us,delivery_us");
+  for (int phase = 0; phase < MD_DUMP_TIMING_PHASE_COUNT; ++phase)
+    printf(",%s_us", kPhaseNames[phase]);
+  printf("\n");
+
+  int failures = 0;
+  for (size_t run = 0; run < runs; ++run) {
+    memset(result, 0, sizeof(*result));
+    fflush(stdout);
+    pid_t child = fork();
+    if (child < 0) {
+      perror("fork");
+      return 1;
+    }
+    if (child == 0) {
+      CrashingProcess(thread_count, mapping_count, stack_kb,
+                      app_memory_count, app_memory_kb, directory, result);
+    }
+    int status;
+    if (waitpid(child, &status, 0) != child) {
+      perror("waitpid");
+      return 1;
+    }
+
+    if (!result->callback_ns || !result->succeeded) {
+      fprintf(stderr, "Run %zu: no minidump was written\n", run);
+      ++failures;
+      continue;
+    }
+
+    printf("%zu,%zu,%zu,%zu,%zu,%zu", thread_count, mapping_count, stack_kb,
+           app_memory_count, app_memory_kb, run);
+    PrintMicroseconds(result->callback_ns - result->crash_ns);
+    const DumpTimings& timings = result->timings;
+    if (result->have_timings && timings.reached(MD_DUMP_TIMING_HANDLER)) {
+      PrintMicroseconds(timings.start_ns[MD_DUMP_TIMING_HANDLER] -
+                        result->crash_ns);
+    } else {
+      printf(",");
+    }
+    for (int i = 0; i < MD_DUMP_TIMING_PHASE_COUNT; ++i) {
+      MDDumpTimingPhase phase = static_cast<MDDumpTimingPhase>(i);
+      if (result->have_timings && timings.reached(phase))
+        PrintMicroseconds(timings.duration_ns[phase]);
+      else
+        printf(",");
+    }
+    printf("\n");
+  }
+
+  return failures ? 1 : 0;
+}
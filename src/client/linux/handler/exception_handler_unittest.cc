@@ -261,6 +261,94 @@ TEST(ExceptionHandlerTest, ChildCrashWithFD) {
   ASSERT_NO_FATAL_FAILURE(ChildCrash(true));
 }
 
+TEST(ExceptionHandlerTest, ChildCrashWithSnapshot) {
+  AutoTempDir temp_dir;
+  int fds[2];
+  ASSERT_NE(pipe(fds), -1);
+  // The process that finishes the minidump inherits the writing end of
+  // |done_fds|, so reading from it ends when that process exits.
+  int done_fds[2];
+  ASSERT_NE(pipe(done_fds), -1);
+
+  const pid_t child = fork();
+  if (child == 0) {
+    close(fds[0]);
+    close(done_fds[0]);
+    MinidumpDescriptor descriptor(temp_dir.path());
+    descriptor.set_write_from_snapshot(true);
+    void* fd_param = reinterpret_cast<void*>(fds[1]);
+    ExceptionHandler handler(descriptor, NULL, DoneCallback, fd_param,
+                             true, -1);
+    // Crash with the exception handler in scope.
+    DoNullPointerDereference();
+  }
+  close(fds[1]);
+  close(done_fds[1]);
+
+  ASSERT_NO_FATAL_FAILURE(WaitForProcessToTerminate(child, SIGSEGV));
+  string minidump_path;
+  ASSERT_NO_FATAL_FAILURE(ReadMinidumpPathFromPipe(fds[0], &minidump_path));
+
+  struct pollfd pfd;
+  memset(&pfd, 0, sizeof(pfd));
+  pfd.fd = done_fds[0];
+  pfd.events = POLLIN | POLLERR;
+  ASSERT_EQ(1, HANDLE_EINTR(poll(&pfd, 1, 10000)));
+  char junk;
+  ASSERT_EQ(0, HANDLE_EINTR(read(done_fds[0], &junk, sizeof(junk))));
+  close(done_fds[0]);
+
+  // The streams written before and after the process was released are all
+  // there.
+  Minidump minidump(minidump_path);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpThreadList* threads = minidump.GetThreadList();
+  ASSERT_TRUE(threads);
+  EXPECT_EQ(1U, threads->thread_count());
+  MinidumpException* exception = minidump.GetException();
+  ASSERT_TRUE(exception);
+  EXPECT_EQ(static_cast<uint32_t>(MD_EXCEPTION_CODE_LIN_SIGSEGV),
+            exception->exception()->exception_record.exception_code);
+  MinidumpModuleList* modules = minidump.GetModuleList();
+  ASSERT_TRUE(modules);
+  EXPECT_TRUE(modules->GetMainModule());
+  unlink(minidump_path.c_str());
+}
+
+TEST(ExceptionHandlerTest, ChildCrashWithDumpHelper) {
+  AutoTempDir temp_dir;
+  int fds[2];
+  ASSERT_NE(pipe(fds), -1);
+
+  const pid_t child = fork();
+  if (child == 0) {
+    close(fds[0]);
+    MinidumpDescriptor descriptor(temp_dir.path());
+    descriptor.set_prespawn_dump_helper(true);
+    void* fd_param = reinterpret_cast<void*>(fds[1]);
+    ExceptionHandler handler(descriptor, NULL, DoneCallback, fd_param,
+                             true, -1);
+    // Crash with the exception handler in scope.
+    DoNullPointerDereference();
+  }
+  close(fds[1]);
+
+  ASSERT_NO_FATAL_FAILURE(WaitForProcessToTerminate(child, SIGSEGV));
+  string minidump_path;
+  ASSERT_NO_FATAL_FAILURE(ReadMinidumpPathFromPipe(fds[0], &minidump_path));
+
+  Minidump minidump(minidump_path);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpException* exception = minidump.GetException();
+  ASSERT_TRUE(exception);
+  EXPECT_EQ(static_cast<uint32_t>(MD_EXCEPTION_CODE_LIN_SIGSEGV),
+            exception->exception()->exception_record.exception_code);
+  MinidumpModuleList* modules = minidump.GetModuleList();
+  ASSERT_TRUE(modules);
+  EXPECT_TRUE(modules->GetMainModule());
+  unlink(minidump_path.c_str());
+}
+
 #if !defined(__ANDROID_API__) || __ANDROID_API__ >= __ANDROID_API_N__
 static void* SleepFunction(void* unused) {
   while (true) usleep(1000000);
@@ -1129,6 +1217,44 @@ TEST(ExceptionHandlerTest, WriteMinidumpExceptionStream) {
             raw->exception_record.exception_code);
 }
 
+static void CopyDumpTimings(const DumpTimings& timings, void* context) {
+  *reinterpret_cast<DumpTimings*>(context) = timings;
+}
+
+TEST(ExceptionHandlerTest, DumpTimingCallback) {
+  AutoTempDir temp_dir;
+  MinidumpDescriptor descriptor(temp_dir.path());
+  descriptor.set_record_dump_timings(true);
+  DumpTimings timings;
+  timings.Clear();
+  ExceptionHandler handler(descriptor, NULL, NULL, &timings, false, -1);
+  handler.set_dump_timing_callback(CopyDumpTimings);
+  ASSERT_TRUE(handler.SimulateSignalDelivery(SIGSEGV));
+
+  // The phases timed by this process and by the dump process both arrive.
+  EXPECT_TRUE(timings.reached(MD_DUMP_TIMING_HANDLER));
+  EXPECT_TRUE(timings.reached(MD_DUMP_TIMING_CLONE));
+  EXPECT_TRUE(timings.reached(MD_DUMP_TIMING_THREADS_SUSPEND));
+  EXPECT_TRUE(timings.reached(MD_DUMP_TIMING_FILE_WRITE));
+  EXPECT_LE(timings.start_ns[MD_DUMP_TIMING_HANDLER] +
+            timings.duration_ns[MD_DUMP_TIMING_HANDLER],
+            timings.start_ns[MD_DUMP_TIMING_CLONE]);
+
+  Minidump minidump(handler.minidump_descriptor().path());
+  ASSERT_TRUE(minidump.Read());
+  uint32_t length;
+  ASSERT_TRUE(minidump.SeekToStreamType(MD_LINUX_DUMP_TIMING, &length));
+  MDRawDumpTiming header;
+  ASSERT_TRUE(minidump.ReadBytes(&header, MDRawDumpTiming_minsize));
+  EXPECT_EQ(timings.reached_count() - 1, header.phase_count);
+
+  // A dump written without a signal has no handler phase.
+  timings.Clear();
+  ASSERT_TRUE(handler.WriteMinidump());
+  EXPECT_FALSE(timings.reached(MD_DUMP_TIMING_HANDLER));
+  EXPECT_TRUE(timings.reached(MD_DUMP_TIMING_CLONE));
+}
+
 TEST(ExceptionHandlerTest, GenerateMultipleDumpsWithFD) {
   AutoTempDir temp_dir;
   string path;
@@ -1220,6 +1346,73 @@ TEST(ExceptionHandlerTest, AdditionalMemory) {
   delete[] memory;
 }
 
+// Test that the dump helper writes each minidump to its own file, with the
+// memory regions registered after it was started.
+TEST(ExceptionHandlerTest, AdditionalMemoryWithDumpHelper) {
+  const uint32_t kMemorySize = sysconf(_SC_PAGESIZE);
+  uint8_t* memory = new uint8_t[kMemorySize];
+  const uintptr_t kMemoryAddress = reinterpret_cast<uintptr_t>(memory);
+  for (uint32_t i = 0; i < kMemorySize; ++i) {
+    memory[i] = i % 255;
+  }
+
+  AutoTempDir temp_dir;
+  MinidumpDescriptor descriptor(temp_dir.path());
+  descriptor.set_prespawn_dump_helper(true);
+  ExceptionHandler handler(descriptor, NULL, NULL, NULL, false, -1);
+  ASSERT_TRUE(handler.has_dump_helper());
+  ASSERT_TRUE(handler.WriteMinidump());
+  // A request the helper fails stops it, and the dump is written by a
+  // cloned process instead.
+  ASSERT_TRUE(handler.has_dump_helper());
+  string minidump_1_path(handler.minidump_descriptor().path());
+
+  handler.RegisterAppMemory(memory, kMemorySize);
+  ASSERT_TRUE(handler.has_dump_helper());
+  ASSERT_TRUE(handler.WriteMinidump());
+  ASSERT_TRUE(handler.has_dump_helper());
+  string minidump_2_path(handler.minidump_descriptor().path());
+  ASSERT_STRNE(minidump_1_path.c_str(), minidump_2_path.c_str());
+
+  Minidump minidump1(minidump_1_path);
+  ASSERT_TRUE(minidump1.Read());
+  MinidumpMemoryList* dump_memory_list = minidump1.GetMemoryList();
+  ASSERT_TRUE(dump_memory_list);
+  EXPECT_FALSE(dump_memory_list->GetMemoryRegionForAddress(kMemoryAddress));
+
+  Minidump minidump2(minidump_2_path);
+  ASSERT_TRUE(minidump2.Read());
+  dump_memory_list = minidump2.GetMemoryList();
+  ASSERT_TRUE(dump_memory_list);
+  const MinidumpMemoryRegion* region =
+    dump_memory_list->GetMemoryRegionForAddress(kMemoryAddress);
+  ASSERT_TRUE(region);
+  EXPECT_EQ(kMemoryAddress, region->GetBase());
+  EXPECT_EQ(kMemorySize, region->GetSize());
+  EXPECT_EQ(0, memcmp(region->GetMemory(), memory, kMemorySize));
+
+  unlink(minidump_1_path.c_str());
+  unlink(minidump_2_path.c_str());
+  delete[] memory;
+}
+
+// Test that the dump helper is not one of the application's children, as far
+// as wait() and SIGCHLD are concerned.
+TEST(ExceptionHandlerTest, DumpHelperNotWaitable) {
+  AutoTempDir temp_dir;
+  MinidumpDescriptor descriptor(temp_dir.path());
+  descriptor.set_prespawn_dump_helper(true);
+  ExceptionHandler handler(descriptor, NULL, NULL, NULL, false, -1);
+  ASSERT_TRUE(handler.has_dump_helper());
+
+  int status;
+  EXPECT_EQ(-1, waitpid(-1, &status, WNOHANG));
+  EXPECT_EQ(ECHILD, errno);
+  ASSERT_TRUE(handler.WriteMinidump());
+  EXPECT_TRUE(handler.has_dump_helper());
+  unlink(handler.minidump_descriptor().path());
+}
+
 // Test that a memory region that was previously registered
 // can be unregistered.
 TEST(ExceptionHandlerTest, AdditionalMemoryRemove) {
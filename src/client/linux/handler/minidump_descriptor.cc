@@ -53,6 +53,24 @@ MinidumpDescriptor::MinidumpDescriptor(const MinidumpDescriptor& descriptor)
       skip_dump_if_principal_mapping_not_referenced_(
           descriptor.skip_dump_if_principal_mapping_not_referenced_),
       sanitize_stacks_(descriptor.sanitize_stacks_),
+      cache_module_identifiers_(descriptor.cache_module_identifiers_),
+      warm_state_interval_(descriptor.warm_state_interval_),
+      stack_capture_tasks_(descriptor.stack_capture_tasks_),
+      write_from_snapshot_(descriptor.write_from_snapshot_),
+      memory_budget_(descriptor.memory_budget_),
+      compress_(descriptor.compress_),
+      record_dump_timings_(descriptor.record_dump_timings_),
+      annotations_(descriptor.annotations_),
+      breadcrumbs_(descriptor.breadcrumbs_),
+      stack_sample_size_(descriptor.stack_sample_size_),
+      prespawn_dump_helper_(descriptor.prespawn_dump_helper_),
+      microdump_logd_socket_(descriptor.microdump_logd_socket_),
+      microdump_full_stack_size_(descriptor.microdump_full_stack_size_),
+      allocator_reserve_size_(descriptor.allocator_reserve_size_),
+      crash_loop_record_path_(descriptor.crash_loop_record_path_),
+      crash_loop_window_(descriptor.crash_loop_window_),
+      crash_loop_full_dumps_(descriptor.crash_loop_full_dumps_),
+      reference_dump_stack_size_(descriptor.reference_dump_stack_size_),
       microdump_extra_info_(descriptor.microdump_extra_info_) {
   // The copy constructor is not allowed to be called on a MinidumpDescriptor
   // with a valid path_, as getting its c_path_ would require the heap which
@@ -79,6 +97,24 @@ MinidumpDescriptor& MinidumpDescriptor::operator=(
   skip_dump_if_principal_mapping_not_referenced_ =
       descriptor.skip_dump_if_principal_mapping_not_referenced_;
   sanitize_stacks_ = descriptor.sanitize_stacks_;
+  cache_module_identifiers_ = descriptor.cache_module_identifiers_;
+  warm_state_interval_ = descriptor.warm_state_interval_;
+  stack_capture_tasks_ = descriptor.stack_capture_tasks_;
+  write_from_snapshot_ = descriptor.write_from_snapshot_;
+  memory_budget_ = descriptor.memory_budget_;
+  compress_ = descriptor.compress_;
+  record_dump_timings_ = descriptor.record_dump_timings_;
+  annotations_ = descriptor.annotations_;
+  breadcrumbs_ = descriptor.breadcrumbs_;
+  stack_sample_size_ = descriptor.stack_sample_size_;
+  prespawn_dump_helper_ = descriptor.prespawn_dump_helper_;
+  microdump_logd_socket_ = descriptor.microdump_logd_socket_;
+  microdump_full_stack_size_ = descriptor.microdump_full_stack_size_;
+  allocator_reserve_size_ = descriptor.allocator_reserve_size_;
+  crash_loop_record_path_ = descriptor.crash_loop_record_path_;
+  crash_loop_window_ = descriptor.crash_loop_window_;
+  crash_loop_full_dumps_ = descriptor.crash_loop_full_dumps_;
+  reference_dump_stack_size_ = descriptor.reference_dump_stack_size_;
   microdump_extra_info_ = descriptor.microdump_extra_info_;
   return *this;
 }
@@ -36,6 +36,8 @@
 #include <string>
 
 #include "client/linux/handler/microdump_extra_info.h"
+#include "common/breadcrumb_buffer.h"
+#include "common/concurrent_string_dictionary.h"
 #include "common/using_std_string.h"
 
 // This class describes how a crash dump should be generated, either:
@@ -55,7 +57,25 @@ class MinidumpDescriptor {
         fd_(-1),
         size_limit_(-1),
         address_within_principal_mapping_(0),
-        skip_dump_if_principal_mapping_not_referenced_(false) {}
+        skip_dump_if_principal_mapping_not_referenced_(false),
+        sanitize_stacks_(false),
+        cache_module_identifiers_(false),
+        warm_state_interval_(0),
+        stack_capture_tasks_(1),
+        write_from_snapshot_(false),
+        memory_budget_(0),
+        compress_(false),
+        record_dump_timings_(false),
+        annotations_(NULL),
+        breadcrumbs_(NULL),
+        stack_sample_size_(0),
+        prespawn_dump_helper_(false),
+        microdump_logd_socket_(false),
+        microdump_full_stack_size_(0),
+        allocator_reserve_size_(0),
+        crash_loop_window_(600),
+        crash_loop_full_dumps_(1),
+        reference_dump_stack_size_(4096) {}
 
   explicit MinidumpDescriptor(const string& directory)
       : mode_(kWriteMinidumpToFile),
@@ -65,10 +85,29 @@ class MinidumpDescriptor {
         size_limit_(-1),
         address_within_principal_mapping_(0),
         skip_dump_if_principal_mapping_not_referenced_(false),
-        sanitize_stacks_(false) {
+        sanitize_stacks_(false),
+        cache_module_identifiers_(false),
+        warm_state_interval_(0),
+        stack_capture_tasks_(1),
+        write_from_snapshot_(false),
+        memory_budget_(0),
+        compress_(false),
+        record_dump_timings_(false),
+        annotations_(NULL),
+        breadcrumbs_(NULL),
+        stack_sample_size_(0),
+        prespawn_dump_helper_(false),
+        microdump_logd_socket_(false),
+        microdump_full_stack_size_(0),
+        allocator_reserve_size_(0),
+        crash_loop_window_(600),
+        crash_loop_full_dumps_(1),
+        reference_dump_stack_size_(4096) {
     assert(!directory.empty());
   }
 
+  // |fd| may be a pipe or a socket, in which case each minidump is sent
+  // to it whole once it has been written.
   explicit MinidumpDescriptor(int fd)
       : mode_(kWriteMinidumpToFd),
         fd_(fd),
@@ -76,7 +115,24 @@ class MinidumpDescriptor {
         size_limit_(-1),
         address_within_principal_mapping_(0),
         skip_dump_if_principal_mapping_not_referenced_(false),
-        sanitize_stacks_(false) {
+        sanitize_stacks_(false),
+        cache_module_identifiers_(false),
+        warm_state_interval_(0),
+        stack_capture_tasks_(1),
+        write_from_snapshot_(false),
+        memory_budget_(0),
+        compress_(false),
+        record_dump_timings_(false),
+        annotations_(NULL),
+        breadcrumbs_(NULL),
+        stack_sample_size_(0),
+        prespawn_dump_helper_(false),
+        microdump_logd_socket_(false),
+        microdump_full_stack_size_(0),
+        allocator_reserve_size_(0),
+        crash_loop_window_(600),
+        crash_loop_full_dumps_(1),
+        reference_dump_stack_size_(4096) {
     assert(fd != -1);
   }
 
@@ -86,7 +142,24 @@ class MinidumpDescriptor {
         size_limit_(-1),
         address_within_principal_mapping_(0),
         skip_dump_if_principal_mapping_not_referenced_(false),
-        sanitize_stacks_(false) {}
+        sanitize_stacks_(false),
+        cache_module_identifiers_(false),
+        warm_state_interval_(0),
+        stack_capture_tasks_(1),
+        write_from_snapshot_(false),
+        memory_budget_(0),
+        compress_(false),
+        record_dump_timings_(false),
+        annotations_(NULL),
+        breadcrumbs_(NULL),
+        stack_sample_size_(0),
+        prespawn_dump_helper_(false),
+        microdump_logd_socket_(false),
+        microdump_full_stack_size_(0),
+        allocator_reserve_size_(0),
+        crash_loop_window_(600),
+        crash_loop_full_dumps_(1),
+        reference_dump_stack_size_(4096) {}
 
   explicit MinidumpDescriptor(const MinidumpDescriptor& descriptor);
   MinidumpDescriptor& operator=(const MinidumpDescriptor& descriptor);
@@ -134,6 +207,98 @@ class MinidumpDescriptor {
     sanitize_stacks_ = sanitize_stacks;
   }
 
+  bool cache_module_identifiers() const { return cache_module_identifiers_; }
+  void set_cache_module_identifiers(bool cache_module_identifiers) {
+    cache_module_identifiers_ = cache_module_identifiers;
+  }
+
+  int warm_state_interval() const { return warm_state_interval_; }
+  void set_warm_state_interval(int seconds) { warm_state_interval_ = seconds; }
+
+  int stack_capture_tasks() const { return stack_capture_tasks_; }
+  void set_stack_capture_tasks(int stack_capture_tasks) {
+    stack_capture_tasks_ = stack_capture_tasks;
+  }
+
+  bool write_from_snapshot() const { return write_from_snapshot_; }
+  void set_write_from_snapshot(bool write_from_snapshot) {
+    write_from_snapshot_ = write_from_snapshot;
+  }
+
+  size_t memory_budget() const { return memory_budget_; }
+  void set_memory_budget(size_t memory_budget) {
+    memory_budget_ = memory_budget;
+  }
+
+  bool compress() const { return compress_; }
+  void set_compress(bool compress) { compress_ = compress; }
+
+  bool record_dump_timings() const { return record_dump_timings_; }
+  void set_record_dump_timings(bool record_dump_timings) {
+    record_dump_timings_ = record_dump_timings;
+  }
+
+  const ConcurrentStringDictionary* annotations() const {
+    return annotations_;
+  }
+  void set_annotations(const ConcurrentStringDictionary* annotations) {
+    annotations_ = annotations;
+  }
+
+  const BreadcrumbBuffer* breadcrumbs() const { return breadcrumbs_; }
+  void set_breadcrumbs(const BreadcrumbBuffer* breadcrumbs) {
+    breadcrumbs_ = breadcrumbs;
+  }
+
+  size_t stack_sample_size() const { return stack_sample_size_; }
+  void set_stack_sample_size(size_t stack_sample_size) {
+    stack_sample_size_ = stack_sample_size;
+  }
+
+  bool prespawn_dump_helper() const { return prespawn_dump_helper_; }
+  void set_prespawn_dump_helper(bool prespawn_dump_helper) {
+    prespawn_dump_helper_ = prespawn_dump_helper;
+  }
+
+  bool microdump_logd_socket() const { return microdump_logd_socket_; }
+  void set_microdump_logd_socket(bool microdump_logd_socket) {
+    microdump_logd_socket_ = microdump_logd_socket;
+  }
+
+  size_t microdump_full_stack_size() const {
+    return microdump_full_stack_size_;
+  }
+  void set_microdump_full_stack_size(size_t microdump_full_stack_size) {
+    microdump_full_stack_size_ = microdump_full_stack_size;
+  }
+
+  size_t allocator_reserve_size() const { return allocator_reserve_size_; }
+  void set_allocator_reserve_size(size_t allocator_reserve_size) {
+    allocator_reserve_size_ = allocator_reserve_size;
+  }
+
+  const string& crash_loop_record_path() const {
+    return crash_loop_record_path_;
+  }
+  void set_crash_loop_record_path(const string& crash_loop_record_path) {
+    crash_loop_record_path_ = crash_loop_record_path;
+  }
+
+  int crash_loop_window() const { return crash_loop_window_; }
+  void set_crash_loop_window(int seconds) { crash_loop_window_ = seconds; }
+
+  int crash_loop_full_dumps() const { return crash_loop_full_dumps_; }
+  void set_crash_loop_full_dumps(int crash_loop_full_dumps) {
+    crash_loop_full_dumps_ = crash_loop_full_dumps;
+  }
+
+  size_t reference_dump_stack_size() const {
+    return reference_dump_stack_size_;
+  }
+  void set_reference_dump_stack_size(size_t reference_dump_stack_size) {
+    reference_dump_stack_size_ = reference_dump_stack_size;
+  }
+
   MicrodumpExtraInfo* microdump_extra_info() {
     assert(IsMicrodumpOnConsole());
     return &microdump_extra_info_;
@@ -182,6 +347,111 @@ class MinidumpDescriptor {
   // register values, but elides strings and other program data.
   bool sanitize_stacks_;
 
+  // If set, the ExceptionHandler computes the identifiers of the modules
+  // mapped when it is created, so that writing a minidump of a process
+  // with many modules need not read each of them.  See
+  // ExceptionHandler::UpdateModuleIdentifierCache.
+  bool cache_module_identifiers_;
+
+  // If not 0, the ExceptionHandler keeps copies of the files the minidump
+  // writer reads that rarely change, such as /proc/cpuinfo, along with the
+  // module identifiers, and refreshes them on a background thread every
+  // this many seconds, checking for newly loaded libraries every second.
+  // See WarmDumpState.
+  int warm_state_interval_;
+
+  // The number of tasks that copy thread stacks into the minidump.  With
+  // more than one, the stacks are read concurrently once every thread has
+  // been suspended.  See WriteMinidump in minidump_writer.h.
+  int stack_capture_tasks_;
+
+  // If set, the crashed process is only stopped while its threads and /proc
+  // files are captured. The rest of the minidump is then written in the
+  // background by a process holding a copy-on-write snapshot of its
+  // memory, taken when the dump began, so the MinidumpCallback runs, and the
+  // process may exit, before the minidump is complete. Modules whose files
+  // have been deleted may then lack identifiers.
+  bool write_from_snapshot_;
+
+  // If not 0, about the most bytes of memory that the minidump holds. It is
+  // spent on the crashing thread's stack first, then on the heap memory
+  // that stack points to, then on the AppMemory regions, then on the other
+  // threads' stacks. Unlike |size_limit_|, nothing else in the minidump is
+  // counted.
+  size_t memory_budget_;
+
+  // If true, the minidump is compressed once it is complete, into blocks
+  // of gzip data that Minidump reads without decompressing the whole file.
+  // |size_limit_| applies to the minidump before it is compressed. Has no
+  // effect if the client was built without zlib.
+  bool compress_;
+
+  // If true, the time taken by each phase of writing the minidump, from
+  // entering the signal handler on, is written to an MD_LINUX_DUMP_TIMING
+  // stream, and passed to the handler's DumpTimingCallback if it has one.
+  bool record_dump_timings_;
+
+  // If not NULL, the annotations written to an MD_CRASHPAD_INFO_STREAM in
+  // the minidump. Not owned; it must outlive the ExceptionHandler. Threads
+  // may keep setting values in it while a minidump is written.
+  const ConcurrentStringDictionary* annotations_;
+
+  // If not NULL, the breadcrumbs written to an MD_BREADCRUMB_STREAM in the
+  // minidump. Not owned; it must outlive the ExceptionHandler.
+  const BreadcrumbBuffer* breadcrumbs_;
+
+  // If not 0, dumps requested with ExceptionHandler::WriteMinidump(), such
+  // as those a watchdog writes for a hung process, are stack samples: only
+  // the registers of each thread and about this many bytes of its stack
+  // from the stack pointer are dumped, with no heap or application memory,
+  // and the threads are resumed as soon as those are copied. Crashes are
+  // still dumped whole.
+  size_t stack_sample_size_;
+
+  // If set, the ExceptionHandler starts a helper process when it is
+  // created, and allows it to ptrace the process. Crash dumps are then
+  // written by the helper: the crashing thread only sends it the crash
+  // context and the annotations, and waits for its answer, instead of
+  // cloning a process of its own. The helper is restarted when mappings or
+  // AppMemory regions are added or removed. It sends no SIGCHLD and is not
+  // reported by wait() or waitpid() without __WALL, so the application's
+  // handling of its own children is unaffected. Dumps whose descriptor has
+  // breadcrumbs or write_from_snapshot set, or that the helper cannot take,
+  // are written by a cloned process as before. Off by default.
+  bool prespawn_dump_helper_;
+
+  // If set, an Android microdump is sent to logd through its socket a batch
+  // of lines at a time, rather than one liblog call per line. The socket is
+  // opened when the ExceptionHandler is created; if that fails, liblog is
+  // used as before.
+  bool microdump_logd_socket_;
+
+  // If not 0, a microdump holds only this many bytes of the crashing
+  // thread's stack above the stack pointer in full. Past them, it holds
+  // only the words that point into executable mappings or into the stack,
+  // which is what the stackwalker scans for, so that busy devices drop
+  // fewer log lines.
+  size_t microdump_full_stack_size_;
+
+  // If not 0, the ExceptionHandler maps a PageReserve of this many bytes
+  // when it is created, unless the process has one already, so that the
+  // memory used while writing a dump is neither mapped nor faulted in at
+  // crash time. The reserve is kept for the life of the process.
+  size_t allocator_reserve_size_;
+
+  // If not empty, the ExceptionHandler records the signature of each crash
+  // in the file at this path, which is kept across restarts (see
+  // CrashLoopRecord). Once a signature has crashed |crash_loop_full_dumps_|
+  // times, each within |crash_loop_window_| seconds of the one before, its
+  // later crashes get a reference dump: the registers of each thread and
+  // |reference_dump_stack_size_| bytes of its stack, with the module list,
+  // but no heap or application memory. Dumps that were asked for and
+  // microdumps are not throttled.
+  string crash_loop_record_path_;
+  int crash_loop_window_;
+  int crash_loop_full_dumps_;
+  size_t reference_dump_stack_size_;
+
   // The extra microdump data (e.g. product name/version, build
   // fingerprint, gpu fingerprint) that should be appended to the dump
   // (microdump only). Microdumps don't have the ability of appending
@@ -35,6 +35,14 @@
 #if defined(__ANDROID__)
 #include <android/log.h>
 #include <dlfcn.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
 #else
 #include "third_party/lss/linux_syscall_support.h"
 #endif
@@ -49,12 +57,50 @@ namespace {
 // system/core/include/log/log.h.
 using AndroidLogBufferWriteFunc = int (*)(int bufID, int prio, const char* tag,
                                           const char* text);
+const int kAndroidMainLogId = 0;  // From LOG_ID_MAIN in log.h.
 const int kAndroidCrashLogId = 4;  // From LOG_ID_CRASH in log.h.
 const char kAndroidLogTag[] = "google-breakpad";
 
 bool g_crash_log_initialized = false;
 AndroidLogBufferWriteFunc g_android_log_buf_write = nullptr;
 
+// The header logd expects at the start of each datagram on its socket.
+// From android_log_header_t in Android's system/logging/liblog.
+struct __attribute__((packed)) LogdHeader {
+  uint8_t id;
+  uint16_t tid;
+  uint32_t tv_sec;
+  uint32_t tv_nsec;
+};
+
+const char kLogdSocketPath[] = "/dev/socket/logdw";
+const uint8_t kLogdPriority = ANDROID_LOG_FATAL;
+
+// Lines queued by writeToCrashLog() while the logd socket is open. They are
+// kept in static storage, as they are written in a compromised context, and
+// are sent with one sendmmsg() per batch.
+const int kLogdBatchSize = 16;
+const size_t kLogdMaxLineSize = 4068;  // LOGGER_ENTRY_MAX_PAYLOAD
+
+struct LogdLine {
+  LogdHeader header;
+  char text[kLogdMaxLineSize];
+  struct iovec iov[4];
+};
+
+int g_logd_socket = -1;
+LogdLine g_logd_lines[kLogdBatchSize];
+struct mmsghdr g_logd_messages[kLogdBatchSize];
+int g_logd_line_count = 0;
+
+int writeToCrashLogBuffer(const char* buf) {
+  if (g_android_log_buf_write) {
+    return g_android_log_buf_write(kAndroidCrashLogId, ANDROID_LOG_FATAL,
+                                   kAndroidLogTag, buf);
+  }
+  return __android_log_write(ANDROID_LOG_FATAL, kAndroidLogTag, buf);
+}
+
 }  // namespace
 
 void initializeCrashLogWriter() {
@@ -65,14 +111,84 @@ void initializeCrashLogWriter() {
   g_crash_log_initialized = true;
 }
 
+bool initializeCrashLogSocket() {
+  if (g_logd_socket >= 0)
+    return true;
+
+  int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+  if (fd < 0)
+    return false;
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, kLogdSocketPath, sizeof(addr.sun_path) - 1);
+  if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr),
+              sizeof(addr)) != 0) {
+    close(fd);
+    return false;
+  }
+  g_logd_socket = fd;
+  return true;
+}
+
 int writeToCrashLog(const char* buf) {
-  // Try writing to the crash log ring buffer. If not available, fall back to
-  // the standard log buffer.
-  if (g_android_log_buf_write) {
-    return g_android_log_buf_write(kAndroidCrashLogId, ANDROID_LOG_FATAL,
-                                   kAndroidLogTag, buf);
+  if (g_logd_socket < 0) {
+    // Try writing to the crash log ring buffer. If not available, fall back
+    // to the standard log buffer.
+    return writeToCrashLogBuffer(buf);
   }
-  return __android_log_write(ANDROID_LOG_FATAL, kAndroidLogTag, buf);
+
+  if (g_logd_line_count == kLogdBatchSize)
+    flushCrashLog();
+
+  LogdLine* line = &g_logd_lines[g_logd_line_count];
+  size_t length = strlen(buf);
+  if (length > sizeof(line->text) - 1)
+    length = sizeof(line->text) - 1;
+  memcpy(line->text, buf, length);
+  line->text[length] = '\0';
+
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  line->header.id = g_android_log_buf_write ? kAndroidCrashLogId
+                                           : kAndroidMainLogId;
+  line->header.tid = static_cast<uint16_t>(gettid());
+  line->header.tv_sec = static_cast<uint32_t>(now.tv_sec);
+  line->header.tv_nsec = static_cast<uint32_t>(now.tv_nsec);
+
+  line->iov[0].iov_base = &line->header;
+  line->iov[0].iov_len = sizeof(line->header);
+  line->iov[1].iov_base = const_cast<uint8_t*>(&kLogdPriority);
+  line->iov[1].iov_len = sizeof(kLogdPriority);
+  line->iov[2].iov_base = const_cast<char*>(kAndroidLogTag);
+  line->iov[2].iov_len = sizeof(kAndroidLogTag);
+  line->iov[3].iov_base = line->text;
+  line->iov[3].iov_len = length + 1;
+
+  struct mmsghdr* message = &g_logd_messages[g_logd_line_count];
+  memset(message, 0, sizeof(*message));
+  message->msg_hdr.msg_iov = line->iov;
+  message->msg_hdr.msg_iovlen = 4;
+  ++g_logd_line_count;
+  return static_cast<int>(length);
+}
+
+void flushCrashLog() {
+  int sent = 0;
+  while (sent < g_logd_line_count) {
+    int result = sendmmsg(g_logd_socket, &g_logd_messages[sent],
+                          g_logd_line_count - sent, 0);
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result <= 0)
+      break;
+    sent += result;
+  }
+  // logd didn't take the rest, so write them through liblog instead.
+  for (int i = sent; i < g_logd_line_count; ++i)
+    writeToCrashLogBuffer(g_logd_lines[i].text);
+  g_logd_line_count = 0;
 }
 #endif
 
@@ -47,6 +47,17 @@ void initializeCrashLogWriter();
 // even if the initialization failed, in which case this will silently fall
 // back on write().
 int writeToCrashLog(const char* buf);
+
+// Connects to logd's socket, so that writeToCrashLog() queues lines and
+// sends them to logd a batch at a time instead of making a liblog call for
+// each. Returns false, leaving writeToCrashLog() as it was, if the socket
+// can't be opened. Must be called in a non-compromised context, after
+// initializeCrashLogWriter().
+bool initializeCrashLogSocket();
+
+// Sends the lines writeToCrashLog() has queued, if any. Safe to use in a
+// compromised context.
+void flushCrashLog();
 #endif
 
 }  // namespace logger
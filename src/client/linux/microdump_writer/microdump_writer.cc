@@ -65,6 +65,26 @@ using google_breakpad::UContextReader;
 
 const size_t kLineBufferSize = 2048;
 
+// The upper case hex representation of every byte value, two characters
+// each, so that a byte is encoded with one lookup.
+const char kHexPairs[] =
+    "000102030405060708090A0B0C0D0E0F"
+    "101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F"
+    "303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F"
+    "505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F"
+    "707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F"
+    "909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAF"
+    "B0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF"
+    "D0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF"
+    "F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
 #if !defined(__LP64__)
 // The following are only used by DumpFreeSpace, so need to be compiled
 // in conditionally in the same way.
@@ -138,6 +158,7 @@ class MicrodumpWriter {
                   bool skip_dump_if_principal_mapping_not_referenced,
                   uintptr_t address_within_principal_mapping,
                   bool sanitize_stack,
+                  size_t full_stack_size,
                   const MicrodumpExtraInfo& microdump_extra_info,
                   LinuxDumper* dumper)
       : ucontext_(context ? &context->context : NULL),
@@ -150,8 +171,10 @@ class MicrodumpWriter {
             skip_dump_if_principal_mapping_not_referenced),
         address_within_principal_mapping_(address_within_principal_mapping),
         sanitize_stack_(sanitize_stack),
+        full_stack_size_(full_stack_size),
         microdump_extra_info_(microdump_extra_info),
         log_line_(NULL),
+        log_line_len_(0),
         stack_copy_(NULL),
         stack_len_(0),
         stack_lower_bound_(0),
@@ -177,6 +200,7 @@ class MicrodumpWriter {
     CaptureResult stack_capture_result = CaptureCrashingThreadStack(-1);
     if (stack_capture_result == CAPTURE_UNINTERESTING) {
       LogLine("Microdump skipped (uninteresting)");
+      LogFlush();
       return;
     }
 
@@ -194,6 +218,7 @@ class MicrodumpWriter {
     DumpCPUState();
     DumpMappings();
     LogLine("-----END BREAKPAD MICRODUMP-----");
+    LogFlush();
   }
 
  private:
@@ -209,9 +234,27 @@ class MicrodumpWriter {
 #endif
   }
 
+  // Sends any lines the system log has queued.
+  void LogFlush() {
+#if defined(__ANDROID__)
+    logger::flushCrashLog();
+#endif
+  }
+
+  // Stages |length| characters of |str| in the current line buffer,
+  // truncating the line once it is full.
+  void LogAppendChars(const char* str, size_t length) {
+    const size_t room = kLineBufferSize - 1 - log_line_len_;
+    if (length > room)
+      length = room;
+    memcpy(log_line_ + log_line_len_, str, length);
+    log_line_len_ += length;
+    log_line_[log_line_len_] = '\0';
+  }
+
   // Stages the given string in the current line buffer.
   void LogAppend(const char* str) {
-    my_strlcat(log_line_, str, kLineBufferSize);
+    LogAppendChars(str, my_strlen(str));
   }
 
   // As above (required to take precedence over template specialization below).
@@ -222,27 +265,50 @@ class MicrodumpWriter {
   // Stages the hex repr. of the given int type in the current line buffer.
   template<typename T>
   void LogAppend(T value) {
-    // Make enough room to hex encode the largest int type + NUL.
-    static const char HEX[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
-                               'A', 'B', 'C', 'D', 'E', 'F'};
-    char hexstr[sizeof(T) * 2 + 1];
-    for (int i = sizeof(T) * 2 - 1; i >= 0; --i, value >>= 4)
-      hexstr[i] = HEX[static_cast<uint8_t>(value) & 0x0F];
-    hexstr[sizeof(T) * 2] = '\0';
-    LogAppend(hexstr);
+    char hexstr[sizeof(T) * 2];
+    for (int i = sizeof(T) - 1; i >= 0; --i, value >>= 8)
+      memcpy(&hexstr[i * 2], &kHexPairs[static_cast<uint8_t>(value) * 2], 2);
+    LogAppendChars(hexstr, sizeof(hexstr));
+  }
+
+  // Stages the hex repr. of |value|, without leading zeros, in the current
+  // line buffer.
+  void LogAppendCompact(uintptr_t value) {
+    char hexstr[sizeof(value) * 2];
+    size_t i = sizeof(hexstr);
+    do {
+      hexstr[--i] = kHexPairs[(value & 0x0F) * 2 + 1];
+      value >>= 4;
+    } while (value);
+    LogAppendChars(hexstr + i, sizeof(hexstr) - i);
   }
 
-  // Stages the buffer content hex-encoded in the current line buffer.
+  // Stages the buffer content hex-encoded in the current line buffer,
+  // writing straight into it rather than through a temporary per byte.
   void LogAppend(const void* buf, size_t length) {
     const uint8_t* ptr = reinterpret_cast<const uint8_t*>(buf);
-    for (size_t i = 0; i < length; ++i, ++ptr)
-      LogAppend(*ptr);
+    const size_t room = (kLineBufferSize - 1 - log_line_len_) / 2;
+    if (length > room)
+      length = room;
+    char* out = log_line_ + log_line_len_;
+    for (size_t i = 0; i < length; ++i, out += 2)
+      memcpy(out, &kHexPairs[ptr[i] * 2], 2);
+    log_line_len_ += length * 2;
+    log_line_[log_line_len_] = '\0';
   }
 
   // Writes out the current line buffer on the system log.
   void LogCommitLine() {
-    LogLine(log_line_);
-    log_line_[0] = 0;
+#if defined(__ANDROID__)
+    logger::writeToCrashLog(log_line_);
+#else
+    // The line buffer always has room for the newline, so the line goes
+    // out with a single write.
+    log_line_[log_line_len_] = '\n';
+    logger::write(log_line_, log_line_len_ + 1);
+#endif
+    log_line_len_ = 0;
+    log_line_[0] = '\0';
   }
 
   CaptureResult CaptureCrashingThreadStack(int max_stack_len) {
@@ -405,16 +471,113 @@ class MicrodumpWriter {
     LogAppend(stack_len_);
     LogCommitLine();
 
+    // Only the first |full_stack_size_| bytes above the stack pointer are
+    // dumped in full, if it is set.  The rest of the stack follows filtered.
+    size_t full_len = stack_len_;
+    if (full_stack_size_) {
+      const size_t word_mask = sizeof(uintptr_t) - 1;
+      size_t sp_offset = stack_pointer_ - stack_lower_bound_;
+      if (full_stack_size_ < stack_len_ - sp_offset) {
+        full_len = (sp_offset + full_stack_size_ + word_mask) & ~word_mask;
+        full_len = std::min(full_len, stack_len_);
+      }
+    }
+
     const size_t STACK_DUMP_CHUNK_SIZE = 384;
-    for (size_t stack_off = 0; stack_off < stack_len_;
+    for (size_t stack_off = 0; stack_off < full_len;
          stack_off += STACK_DUMP_CHUNK_SIZE) {
       LogAppend("S ");
       LogAppend(stack_lower_bound_ + stack_off);
       LogAppend(" ");
       LogAppend(stack_copy_ + stack_off,
-                std::min(STACK_DUMP_CHUNK_SIZE, stack_len_ - stack_off));
+                std::min(STACK_DUMP_CHUNK_SIZE, full_len - stack_off));
+      LogCommitLine();
+    }
+
+    if (full_len < stack_len_)
+      DumpFilteredStack(full_len);
+  }
+
+  // Dumps the stack from |offset| on, keeping only the words that the
+  // stackwalker may use when scanning: those that point into executable
+  // mappings or back into the stack. Each line is "F <address>" followed
+  // by runs of kept words, each run written as the hex number of bytes
+  // left out before it, a colon, and the words' hex-encoded bytes. The
+  // processor reads the words that were left out as zeros.
+  void DumpFilteredStack(size_t offset) {
+    const size_t kWordSize = sizeof(uintptr_t);
+    // The most that starting a run and adding its first word can take.
+    const size_t kMaxRunStart = 2 + kWordSize * 4;
+
+    // Words outside of the span of executable mappings can't be code
+    // addresses, and most stack words are, so rule them out first.
+    uintptr_t exec_low = std::numeric_limits<uintptr_t>::max();
+    uintptr_t exec_high = 0;
+    for (size_t i = 0; i < dumper_->mappings().size(); ++i) {
+      const MappingInfo* mapping = dumper_->mappings()[i];
+      if (!mapping->exec)
+        continue;
+      exec_low = std::min(exec_low, mapping->system_mapping_info.start_addr);
+      exec_high = std::max(exec_high, mapping->system_mapping_info.end_addr);
+    }
+
+    const MappingInfo* last_hit_mapping = NULL;
+    bool in_line = false;
+    bool in_run = false;
+    uintptr_t cursor = 0;
+    for (; offset + kWordSize <= stack_len_; offset += kWordSize) {
+      uintptr_t value;
+      memcpy(&value, stack_copy_ + offset, kWordSize);
+      if (!IsStackScanWord(value, exec_low, exec_high, &last_hit_mapping)) {
+        in_run = false;
+        continue;
+      }
+
+      const uintptr_t address = stack_lower_bound_ + offset;
+      if (in_line && log_line_len_ + kMaxRunStart >= kLineBufferSize - 1) {
+        LogCommitLine();
+        in_line = false;
+      }
+      if (!in_line) {
+        LogAppend("F ");
+        LogAppend(address);
+        cursor = address;
+        in_line = true;
+        in_run = false;
+      }
+      if (!in_run) {
+        LogAppend(" ");
+        LogAppendCompact(address - cursor);
+        LogAppend(":");
+        in_run = true;
+      }
+      LogAppend(stack_copy_ + offset, kWordSize);
+      cursor = address + kWordSize;
+    }
+    if (in_line)
       LogCommitLine();
+  }
+
+  // Returns true if the stack word |value| points into the stack or into an
+  // executable mapping. |last_hit_mapping| caches the last mapping found,
+  // as neighbouring return addresses tend to be in the same module.
+  bool IsStackScanWord(uintptr_t value, uintptr_t exec_low,
+                       uintptr_t exec_high,
+                       const MappingInfo** last_hit_mapping) {
+    if (value - stack_lower_bound_ < stack_len_)
+      return true;
+    if (value < exec_low || value >= exec_high)
+      return false;
+    const MappingInfo* mapping = *last_hit_mapping;
+    if (mapping && value >= mapping->system_mapping_info.start_addr &&
+        value < mapping->system_mapping_info.end_addr) {
+      return true;
     }
+    mapping = dumper_->FindMappingNoBias(value);
+    if (!mapping || !mapping->exec)
+      return false;
+    *last_hit_mapping = mapping;
+    return true;
   }
 
   void DumpCPUState() {
@@ -624,8 +787,12 @@ class MicrodumpWriter {
   bool skip_dump_if_principal_mapping_not_referenced_;
   uintptr_t address_within_principal_mapping_;
   bool sanitize_stack_;
+  // If not 0, the number of bytes above the stack pointer to dump in full.
+  size_t full_stack_size_;
   const MicrodumpExtraInfo microdump_extra_info_;
   char* log_line_;
+  // The length of the line staged in |log_line_|.
+  size_t log_line_len_;
 
   // The local copy of crashed process stack memory, beginning at
   // |stack_lower_bound_|.
@@ -652,6 +819,7 @@ bool WriteMicrodump(pid_t crashing_process,
                     bool skip_dump_if_principal_mapping_not_referenced,
                     uintptr_t address_within_principal_mapping,
                     bool sanitize_stack,
+                    size_t full_stack_size,
                     const MicrodumpExtraInfo& microdump_extra_info) {
   LinuxPtraceDumper dumper(crashing_process);
   const ExceptionHandler::CrashContext* context = NULL;
@@ -665,7 +833,7 @@ bool WriteMicrodump(pid_t crashing_process,
   MicrodumpWriter writer(context, mappings,
                          skip_dump_if_principal_mapping_not_referenced,
                          address_within_principal_mapping, sanitize_stack,
-                         microdump_extra_info, &dumper);
+                         full_stack_size, microdump_extra_info, &dumper);
   if (!writer.Init())
     return false;
   writer.Dump();
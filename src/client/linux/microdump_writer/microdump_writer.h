@@ -51,6 +51,9 @@ struct MicrodumpExtraInfo;
 //     build fingerprint (e.g., aosp/occam/mako:5.1.1/LMY47W/1234:eng/dev-keys).
 //   product_info: a (optional) C string which determines the product name and
 //     version (e.g., WebView:42.0.2311.136).
+//   full_stack_size: if not 0, only this many bytes of the stack above the
+//     stack pointer are written in full. Past them, only the words that
+//     point into executable mappings or into the stack are written.
 //
 // Returns true iff successful.
 bool WriteMicrodump(pid_t crashing_process,
@@ -60,6 +63,7 @@ bool WriteMicrodump(pid_t crashing_process,
                     bool skip_dump_if_main_module_not_referenced,
                     uintptr_t address_within_main_module,
                     bool sanitize_stack,
+                    size_t full_stack_size,
                     const MicrodumpExtraInfo& microdump_extra_info);
 
 }  // namespace google_breakpad
@@ -86,7 +86,8 @@ void CrashAndGetMicrodump(const MappingList& mappings,
                           std::string* microdump,
                           bool skip_dump_if_principal_mapping_not_referenced = false,
                           uintptr_t address_within_principal_mapping = 0,
-                          bool sanitize_stack = false) {
+                          bool sanitize_stack = false,
+                          size_t full_stack_size = 0) {
   int fds[2];
   ASSERT_NE(-1, pipe(fds));
 
@@ -132,7 +133,7 @@ void CrashAndGetMicrodump(const MappingList& mappings,
   ASSERT_TRUE(WriteMicrodump(child, &context, sizeof(context), mappings,
                              skip_dump_if_principal_mapping_not_referenced,
                              address_within_principal_mapping, sanitize_stack,
-                             microdump_extra_info));
+                             full_stack_size, microdump_extra_info));
 
   // Revert stderr back to the console.
   dup2(save_err, STDERR_FILENO);
@@ -421,4 +422,30 @@ TEST(MicrodumpWriterTest, NoGPUInfo) {
   ASSERT_TRUE(ContainsMicrodump(buf));
   CheckMicrodumpContents(buf, kBuildFingerprint, kProductInfo, "UNKNOWN");
 }
+
+// Ensure that only the start of the stack is dumped in full when the
+// stack is filtered, and that the rest of it follows in filtered lines.
+TEST(MicrodumpWriterTest, FilteredStack) {
+  const MicrodumpExtraInfo kMicrodumpExtraInfo(
+      MakeMicrodumpExtraInfo("foobar", "bazqux", NULL));
+  std::string full;
+  std::string filtered;
+  MappingList no_mappings;
+
+  CrashAndGetMicrodump(no_mappings, kMicrodumpExtraInfo, &full);
+  CrashAndGetMicrodump(no_mappings, kMicrodumpExtraInfo, &filtered, false, 0u,
+                       false, 256);
+  ASSERT_TRUE(ContainsMicrodump(filtered));
+  CheckMicrodumpContents(filtered, kMicrodumpExtraInfo);
+
+  string full_stack;
+  string filtered_stack;
+  ExtractMicrodumpStackContents(full, &full_stack);
+  ExtractMicrodumpStackContents(filtered, &filtered_stack);
+  EXPECT_LT(filtered_stack.size(), full_stack.size());
+  EXPECT_LT(filtered.size(), full.size());
+  // A test process has return addresses and frame pointers further up
+  // its stack than 256 bytes, which are kept.
+  EXPECT_NE(std::string::npos, filtered.find("\nF "));
+}
 }  // namespace
@@ -0,0 +1,113 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dump_timings.h: Signal-safe timers for the phases of writing a Linux
+// minidump, recorded in its MD_LINUX_DUMP_TIMING stream.
+
+#ifndef CLIENT_LINUX_MINIDUMP_WRITER_DUMP_TIMINGS_H_
+#define CLIENT_LINUX_MINIDUMP_WRITER_DUMP_TIMINGS_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#include "common/linux/linux_libc_support.h"
+#include "google_breakpad/common/minidump_format.h"
+#include "third_party/lss/linux_syscall_support.h"
+
+namespace google_breakpad {
+
+// The start and duration of each MDDumpTimingPhase of one dump, in
+// nanoseconds of CLOCK_MONOTONIC.  A phase that was not reached has a
+// start of 0.  This is plain data, so that ExceptionHandler can place it
+// in memory shared with the process writing the dump.
+struct DumpTimings {
+  // Forget every phase.
+  void Clear() {
+    my_memset(this, 0, sizeof(*this));
+  }
+
+  void Begin(MDDumpTimingPhase phase) {
+    start_ns[phase] = Now();
+    duration_ns[phase] = 0;
+  }
+
+  void End(MDDumpTimingPhase phase) {
+    if (start_ns[phase])
+      duration_ns[phase] = Now() - start_ns[phase];
+  }
+
+  bool reached(MDDumpTimingPhase phase) const {
+    return start_ns[phase] != 0;
+  }
+
+  // The number of phases that were reached.
+  unsigned reached_count() const {
+    unsigned count = 0;
+    for (int i = 0; i < MD_DUMP_TIMING_PHASE_COUNT; ++i)
+      count += reached(static_cast<MDDumpTimingPhase>(i));
+    return count;
+  }
+
+  // CLOCK_MONOTONIC, in nanoseconds.
+  static uint64_t Now() {
+    struct kernel_timespec now;
+    if (sys_clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+      return 0;
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+  }
+
+  uint64_t start_ns[MD_DUMP_TIMING_PHASE_COUNT];
+  uint64_t duration_ns[MD_DUMP_TIMING_PHASE_COUNT];
+};
+
+// Times PHASE in TIMINGS from its construction to its destruction.  Does
+// nothing if TIMINGS is NULL.
+class ScopedDumpTimer {
+ public:
+  ScopedDumpTimer(DumpTimings* timings, MDDumpTimingPhase phase)
+      : timings_(timings), phase_(phase) {
+    if (timings_)
+      timings_->Begin(phase_);
+  }
+
+  ScopedDumpTimer(const ScopedDumpTimer&) = delete;
+  void operator=(const ScopedDumpTimer&) = delete;
+
+  ~ScopedDumpTimer() {
+    if (timings_)
+      timings_->End(phase_);
+  }
+
+ private:
+  DumpTimings* const timings_;
+  const MDDumpTimingPhase phase_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_MINIDUMP_WRITER_DUMP_TIMINGS_H_
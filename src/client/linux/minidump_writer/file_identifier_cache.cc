@@ -0,0 +1,258 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// file_identifier_cache.cc: Implement FileIdentifierCache.  See
+// file_identifier_cache.h for details.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "client/linux/minidump_writer/file_identifier_cache.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "common/linux/file_id.h"
+#include "common/linux/linux_libc_support.h"
+#include "third_party/lss/linux_syscall_support.h"
+
+namespace google_breakpad {
+
+namespace {
+
+using elf::FileID;
+using elf::kDefaultBuildIdSize;
+
+// The longest identifier the cache holds.  Files with longer build IDs
+// are left for the dumper to read at crash time.
+const size_t kMaxIdentifierSize = 64;
+
+// The number of entries in the first table.  Tables are kept at most
+// half full, so that every probe sequence ends at an empty entry.
+const size_t kInitialCapacity = 256;
+
+// What identifies a file's contents, short of reading them.
+struct FileKey {
+  uint64_t device;
+  uint64_t inode;
+  int64_t size;
+  int64_t mtime;
+  int64_t mtime_nsec;
+
+  bool operator==(const FileKey& other) const {
+    return device == other.device && inode == other.inode &&
+           size == other.size && mtime == other.mtime &&
+           mtime_nsec == other.mtime_nsec;
+  }
+};
+
+struct CacheEntry {
+  // Set, with release ordering, once the rest of the entry is written.
+  std::atomic<bool> filled;
+  FileKey key;
+  size_t identifier_size;
+  uint8_t identifier[kMaxIdentifierSize];
+};
+
+// An open-addressed hash table of entries.  CAPACITY is a power of two.
+struct CacheTable {
+  size_t capacity;
+  size_t count;
+  CacheEntry* entries;
+};
+
+// The current table.  When it fills, it is replaced with a larger copy.
+// Tables are never freed, since a signal handler may still be reading
+// one that has been replaced; the copies at most double the memory used.
+std::atomic<CacheTable*> g_table(nullptr);
+
+// Serializes the threads adding to the cache.
+pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+bool StatFile(const char* path, FileKey* key) {
+  struct kernel_stat st;
+  if (sys_stat(path, &st) != 0)
+    return false;
+  key->device = st.st_dev;
+  key->inode = st.st_ino;
+  key->size = st.st_size;
+  key->mtime = st.st_mtime_;
+  // Inodes are reused, so a file written in the same second as a deleted
+  // one may otherwise match it.
+  key->mtime_nsec = st.st_mtime_nsec_;
+  return true;
+}
+
+size_t HashKey(const FileKey& key) {
+  uint64_t hash = key.inode ^ (key.device * 0x9e3779b97f4a7c15ULL);
+  hash ^= hash >> 29;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 32;
+  return static_cast<size_t>(hash);
+}
+
+const CacheEntry* FindEntry(const CacheTable* table, const FileKey& key) {
+  size_t mask = table->capacity - 1;
+  for (size_t i = HashKey(key) & mask; ; i = (i + 1) & mask) {
+    const CacheEntry& entry = table->entries[i];
+    if (!entry.filled.load(std::memory_order_acquire))
+      return nullptr;
+    if (entry.key == key)
+      return &entry;
+  }
+}
+
+// Add an entry to TABLE, which must have room for it.  Called with
+// g_mutex held.
+void InsertEntry(CacheTable* table, const FileKey& key,
+                 const uint8_t* identifier, size_t identifier_size) {
+  size_t mask = table->capacity - 1;
+  size_t i = HashKey(key) & mask;
+  while (table->entries[i].filled.load(std::memory_order_relaxed))
+    i = (i + 1) & mask;
+  CacheEntry& entry = table->entries[i];
+  entry.key = key;
+  entry.identifier_size = identifier_size;
+  my_memcpy(entry.identifier, identifier, identifier_size);
+  entry.filled.store(true, std::memory_order_release);
+  ++table->count;
+}
+
+// Return a table with room for one more entry, replacing the current one
+// if it is full.  Called with g_mutex held.
+CacheTable* TableWithRoom() {
+  CacheTable* table = g_table.load(std::memory_order_relaxed);
+  if (table && (table->count + 1) * 2 <= table->capacity)
+    return table;
+
+  CacheTable* larger = new CacheTable;
+  larger->capacity = table ? table->capacity * 2 : kInitialCapacity;
+  larger->count = 0;
+  larger->entries = new CacheEntry[larger->capacity]();
+  if (table) {
+    for (size_t i = 0; i < table->capacity; ++i) {
+      const CacheEntry& entry = table->entries[i];
+      if (entry.filled.load(std::memory_order_relaxed)) {
+        InsertEntry(larger, entry.key, entry.identifier,
+                    entry.identifier_size);
+      }
+    }
+  }
+  g_table.store(larger, std::memory_order_release);
+  return larger;
+}
+
+}  // namespace
+
+// static
+void FileIdentifierCache::AddMappedFiles() {
+  FILE* maps = fopen("/proc/self/maps", "r");
+  if (!maps)
+    return;
+  char line[PATH_MAX + 128];
+  while (fgets(line, sizeof(line), maps)) {
+    char permissions[5];
+    int path_start = 0;
+    if (sscanf(line, "%*x-%*x %4s %*x %*s %*s %n", permissions,
+               &path_start) != 1 || path_start == 0 ||
+        permissions[2] != 'x' || line[path_start] != '/') {
+      continue;
+    }
+    char* path = line + path_start;
+    path[strcspn(path, "\n")] = '\0';
+    // A deleted file can't be found by its name; the dumper reads it
+    // through /proc instead.
+    static const char kDeletedSuffix[] = " (deleted)";
+    size_t length = strlen(path);
+    if (length >= sizeof(kDeletedSuffix) - 1 &&
+        strcmp(path + length - (sizeof(kDeletedSuffix) - 1),
+               kDeletedSuffix) == 0) {
+      continue;
+    }
+    AddFile(path);
+  }
+  fclose(maps);
+}
+
+// static
+bool FileIdentifierCache::AddFile(const char* path) {
+  FileKey key;
+  if (!StatFile(path, &key))
+    return false;
+
+  pthread_mutex_lock(&g_mutex);
+  const CacheTable* table = g_table.load(std::memory_order_relaxed);
+  bool cached = table && FindEntry(table, key);
+  pthread_mutex_unlock(&g_mutex);
+  if (cached)
+    return true;
+
+  PageAllocator allocator;
+  wasteful_vector<uint8_t> identifier(&allocator, kDefaultBuildIdSize);
+  FileKey key_after;
+  // Only keep the identifier if the file did not change while it was read.
+  if (!FileID(path).ElfFileIdentifier(identifier) ||
+      identifier.size() > kMaxIdentifierSize ||
+      !StatFile(path, &key_after) || !(key_after == key)) {
+    return false;
+  }
+
+  pthread_mutex_lock(&g_mutex);
+  // Another thread may have added the same file meanwhile.
+  if (!FindEntry(TableWithRoom(), key)) {
+    InsertEntry(g_table.load(std::memory_order_relaxed), key,
+                &identifier[0], identifier.size());
+  }
+  pthread_mutex_unlock(&g_mutex);
+  return true;
+}
+
+// static
+bool FileIdentifierCache::Find(const char* path,
+                               wasteful_vector<uint8_t>& identifier) {
+  const CacheTable* table = g_table.load(std::memory_order_acquire);
+  if (!table)
+    return false;
+  FileKey key;
+  if (!StatFile(path, &key))
+    return false;
+  const CacheEntry* entry = FindEntry(table, key);
+  if (!entry)
+    return false;
+  identifier.clear();
+  identifier.insert(identifier.end(), entry->identifier,
+                    entry->identifier + entry->identifier_size);
+  return true;
+}
+
+}  // namespace google_breakpad
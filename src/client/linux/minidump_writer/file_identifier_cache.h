@@ -0,0 +1,66 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// file_identifier_cache.h: A table of ELF file identifiers computed
+// before a crash, so that a crashing process's dumper can look up the
+// identifiers of the files it maps instead of opening and hashing each.
+
+#ifndef CLIENT_LINUX_MINIDUMP_WRITER_FILE_IDENTIFIER_CACHE_H_
+#define CLIENT_LINUX_MINIDUMP_WRITER_FILE_IDENTIFIER_CACHE_H_
+
+#include <stdint.h>
+
+#include "common/memory_allocator.h"
+
+namespace google_breakpad {
+
+// The cache is keyed by each file's device, inode, size and modification
+// time, so its entries stay correct for any process mapping the same
+// file, and a file replaced since it was cached is simply not found.
+// There is one cache per process.
+class FileIdentifierCache {
+ public:
+  // Add the identifier of every file mapped executable into this process
+  // that the cache does not hold yet.  Not signal-safe: call this when the
+  // crash handler is installed, and again after loading libraries.
+  static void AddMappedFiles();
+
+  // Add the identifier of the ELF file at PATH, as it is now, if the
+  // cache does not hold it yet.  Return false if it could not be
+  // computed.  Not signal-safe.
+  static bool AddFile(const char* path);
+
+  // If the cache holds the identifier of the file at PATH, as it is now,
+  // copy it to IDENTIFIER and return true.  This is signal-safe, and may
+  // run while another thread adds to the cache.
+  static bool Find(const char* path, wasteful_vector<uint8_t>& identifier);
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_MINIDUMP_WRITER_FILE_IDENTIFIER_CACHE_H_
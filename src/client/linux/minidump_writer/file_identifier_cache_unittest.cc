@@ -0,0 +1,135 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// file_identifier_cache_unittest.cc: Unit tests for FileIdentifierCache.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "client/linux/minidump_writer/file_identifier_cache.h"
+#include "common/linux/file_id.h"
+#include "common/memory_allocator.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/tests/file_utils.h"
+
+using namespace google_breakpad;
+using google_breakpad::elf::FileID;
+using google_breakpad::elf::kDefaultBuildIdSize;
+
+namespace {
+
+typedef testing::Test FileIdentifierCacheTest;
+
+// Copy this test's own executable into DIRECTORY, returning the copy's path.
+std::string CopyOfExecutable(const AutoTempDir& directory, const char* name) {
+  char exe_path[PATH_MAX];
+  ssize_t length = readlink("/proc/self/exe", exe_path, sizeof(exe_path) - 1);
+  if (length <= 0)
+    return "";
+  exe_path[length] = '\0';
+  std::string path = directory.path() + "/" + name;
+  return CopyFile(exe_path, path.c_str()) ? path : "";
+}
+
+}  // namespace
+
+TEST(FileIdentifierCacheTest, FindsAddedFile) {
+  AutoTempDir temp_dir;
+  std::string path = CopyOfExecutable(temp_dir, "added");
+  ASSERT_FALSE(path.empty());
+
+  PageAllocator allocator;
+  wasteful_vector<uint8_t> expected(&allocator, kDefaultBuildIdSize);
+  ASSERT_TRUE(FileID(path.c_str()).ElfFileIdentifier(expected));
+
+  ASSERT_TRUE(FileIdentifierCache::AddFile(path.c_str()));
+  wasteful_vector<uint8_t> identifier(&allocator, kDefaultBuildIdSize);
+  ASSERT_TRUE(FileIdentifierCache::Find(path.c_str(), identifier));
+  EXPECT_TRUE(identifier == expected);
+}
+
+TEST(FileIdentifierCacheTest, MissesFileNotAdded) {
+  AutoTempDir temp_dir;
+  std::string path = CopyOfExecutable(temp_dir, "not_added");
+  ASSERT_FALSE(path.empty());
+
+  PageAllocator allocator;
+  wasteful_vector<uint8_t> identifier(&allocator, kDefaultBuildIdSize);
+  EXPECT_FALSE(FileIdentifierCache::Find(path.c_str(), identifier));
+}
+
+TEST(FileIdentifierCacheTest, MissesChangedFile) {
+  AutoTempDir temp_dir;
+  std::string path = CopyOfExecutable(temp_dir, "changed");
+  ASSERT_FALSE(path.empty());
+  ASSERT_TRUE(FileIdentifierCache::AddFile(path.c_str()));
+
+  FILE* file = fopen(path.c_str(), "a");
+  ASSERT_TRUE(file);
+  fputc(0, file);
+  fclose(file);
+
+  PageAllocator allocator;
+  wasteful_vector<uint8_t> identifier(&allocator, kDefaultBuildIdSize);
+  EXPECT_FALSE(FileIdentifierCache::Find(path.c_str(), identifier));
+}
+
+TEST(FileIdentifierCacheTest, AddsMappedFiles) {
+  FileIdentifierCache::AddMappedFiles();
+
+  PageAllocator allocator;
+  wasteful_vector<uint8_t> expected(&allocator, kDefaultBuildIdSize);
+  ASSERT_TRUE(FileID("/proc/self/exe").ElfFileIdentifier(expected));
+  wasteful_vector<uint8_t> identifier(&allocator, kDefaultBuildIdSize);
+  ASSERT_TRUE(FileIdentifierCache::Find("/proc/self/exe", identifier));
+  EXPECT_TRUE(identifier == expected);
+}
+
+TEST(FileIdentifierCacheTest, GrowsPastFirstTable) {
+  AutoTempDir temp_dir;
+  PageAllocator allocator;
+  const int kFileCount = 200;
+  for (int i = 0; i < kFileCount; ++i) {
+    std::string path =
+        CopyOfExecutable(temp_dir, ("file" + std::to_string(i)).c_str());
+    ASSERT_FALSE(path.empty());
+    ASSERT_TRUE(FileIdentifierCache::AddFile(path.c_str()));
+  }
+  for (int i = 0; i < kFileCount; ++i) {
+    std::string path = temp_dir.path() + "/file" + std::to_string(i);
+    wasteful_vector<uint8_t> identifier(&allocator, kDefaultBuildIdSize);
+    EXPECT_TRUE(FileIdentifierCache::Find(path.c_str(), identifier));
+  }
+}
@@ -44,11 +44,29 @@ class LineReader {
  public:
   LineReader(int fd)
       : fd_(fd),
+        buf_(inline_buf_),
+        buf_size_(sizeof(inline_buf_)),
         hit_eof_(false),
+        buf_start_(0),
+        buf_scanned_(0),
         buf_used_(0) {
   }
 
-  // The maximum length of a line.
+  // Reads the file through |buffer|, of |size| bytes, which must outlive
+  // the LineReader. A large buffer takes fewer reads for a long file, such
+  // as /proc/<pid>/maps; lines can be up to |size| - 1 bytes long.
+  LineReader(int fd, char* buffer, size_t size)
+      : fd_(fd),
+        buf_(buffer),
+        buf_size_(size),
+        hit_eof_(false),
+        buf_start_(0),
+        buf_scanned_(0),
+        buf_used_(0) {
+    assert(size > 0);
+  }
+
+  // The maximum length of a line, with the built-in buffer.
   static const size_t kMaxLineLen = 512;
 
   // Return the next line from the file.
@@ -62,19 +80,31 @@ class LineReader {
   // get the same line over and over.
   bool GetNextLine(const char** line, unsigned* len) {
     for (;;) {
-      if (buf_used_ == 0 && hit_eof_)
+      if (buf_start_ == buf_used_ && hit_eof_)
         return false;
 
-      for (unsigned i = 0; i < buf_used_; ++i) {
+      // The bytes before |buf_scanned_| were scanned by an earlier call.
+      for (size_t i = buf_scanned_; i < buf_used_; ++i) {
         if (buf_[i] == '\n' || buf_[i] == 0) {
           buf_[i] = 0;
-          *len = i;
-          *line = buf_;
+          buf_scanned_ = i;
+          *len = i - buf_start_;
+          *line = buf_ + buf_start_;
           return true;
         }
       }
+      buf_scanned_ = buf_used_;
+
+      // Lines are popped by moving |buf_start_|, and only moved to the front
+      // of the buffer when more of the file is needed.
+      if (buf_start_ > 0) {
+        buf_used_ -= buf_start_;
+        buf_scanned_ -= buf_start_;
+        my_memmove(buf_, buf_ + buf_start_, buf_used_);
+        buf_start_ = 0;
+      }
 
-      if (buf_used_ == sizeof(buf_)) {
+      if (buf_used_ == buf_size_) {
         // we scanned the whole buffer and didn't find an end-of-line marker.
         // This line is too long to process.
         return false;
@@ -84,10 +114,11 @@ class LineReader {
       // this is the last line in the file it might not have one:
       if (hit_eof_) {
         assert(buf_used_);
-        // There's room for the NUL because of the buf_used_ == sizeof(buf_)
+        // There's room for the NUL because of the buf_used_ == buf_size_
         // check above.
         buf_[buf_used_] = 0;
         *len = buf_used_;
+        buf_scanned_ = buf_used_;
         buf_used_ += 1;  // since we appended the NUL.
         *line = buf_;
         return true;
@@ -95,7 +126,7 @@ class LineReader {
 
       // Otherwise, we should pull in more data from the file
       const ssize_t n = sys_read(fd_, buf_ + buf_used_,
-                                 sizeof(buf_) - buf_used_);
+                                 buf_size_ - buf_used_);
       if (n < 0) {
         return false;
       } else if (n == 0) {
@@ -112,17 +143,28 @@ class LineReader {
   void PopLine(unsigned len) {
     // len doesn't include the NUL byte at the end.
 
-    assert(buf_used_ >= len + 1);
-    buf_used_ -= len + 1;
-    my_memmove(buf_, buf_ + len + 1, buf_used_);
+    assert(buf_used_ - buf_start_ >= len + 1);
+    buf_start_ += len + 1;
+    buf_scanned_ = buf_start_;
+    if (buf_start_ == buf_used_)
+      buf_start_ = buf_scanned_ = buf_used_ = 0;
   }
 
  private:
   const int fd_;
+  char* const buf_;
+  const size_t buf_size_;
 
   bool hit_eof_;
-  unsigned buf_used_;
-  char buf_[kMaxLineLen];
+  // The unread bytes of the file are those of |buf_| from |buf_start_| to
+  // |buf_used_|.
+  size_t buf_start_;
+  size_t buf_scanned_;
+  size_t buf_used_;
+  char inline_buf_[kMaxLineLen];
+
+  LineReader(const LineReader&);
+  void operator=(const LineReader&);
 };
 
 }  // namespace google_breakpad
@@ -34,9 +34,12 @@
 #include <unistd.h>
 #include <sys/types.h>
 
+#include <string>
+
 #include "client/linux/minidump_writer/line_reader.h"
 #include "breakpad_googletest_includes.h"
 #include "common/linux/scoped_tmpfile.h"
+#include "common/using_std_string.h"
 
 using namespace google_breakpad;
 
@@ -159,3 +162,30 @@ TEST(LineReaderTest, TooLong) {
   unsigned len;
   ASSERT_FALSE(reader.GetNextLine(&line, &len));
 }
+
+TEST(LineReaderTest, ManyLinesThroughBuffer) {
+  // Lines that straddle the end of the caller's buffer are moved to its
+  // front as the file is read.
+  string data;
+  for (int i = 0; i < 100; ++i)
+    data += string(i % 7, 'a' + i % 26) + "\n";
+  data += "last";
+  ScopedTmpFile file;
+  ASSERT_TRUE(file.InitString(data.c_str()));
+  char buffer[8];
+  LineReader reader(file.GetFd(), buffer, sizeof(buffer));
+
+  const char* line;
+  unsigned len;
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(reader.GetNextLine(&line, &len));
+    ASSERT_EQ(static_cast<unsigned>(i % 7), len);
+    ASSERT_EQ(string(i % 7, 'a' + i % 26), string(line, len));
+    ASSERT_EQ('\0', line[len]);
+    reader.PopLine(len);
+  }
+  ASSERT_TRUE(reader.GetNextLine(&line, &len));
+  ASSERT_EQ(string("last"), string(line, len));
+  reader.PopLine(len);
+  ASSERT_FALSE(reader.GetNextLine(&line, &len));
+}
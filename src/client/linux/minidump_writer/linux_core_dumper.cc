@@ -40,6 +40,7 @@
 #include <elf.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/procfs.h>
 #if defined(__mips__) && defined(__ANDROID__)
 // To get register definitions.
@@ -86,9 +87,6 @@ bool LinuxCoreDumper::BuildProcPath(char* path, pid_t pid,
 bool LinuxCoreDumper::CopyFromProcess(void* dest, pid_t child,
                                       const void* src, size_t length) {
   ElfCoreDump::Addr virtual_address = reinterpret_cast<ElfCoreDump::Addr>(src);
-  // TODO(benchan): Investigate whether the data to be copied could span
-  // across multiple segments in the core dump file. ElfCoreDump::CopyData
-  // and this method do not handle that case yet.
   if (!core_.CopyData(dest, virtual_address, length)) {
     // If the data segment is not found in the core dump, fill the result
     // with marker characters.
@@ -98,6 +96,10 @@ bool LinuxCoreDumper::CopyFromProcess(void* dest, pid_t child,
   return true;
 }
 
+bool LinuxCoreDumper::PrepareForConcurrentCopies() {
+  return true;
+}
+
 bool LinuxCoreDumper::GetThreadInfoByIndex(size_t index, ThreadInfo* info) {
   if (index >= thread_infos_.size())
     return false;
@@ -158,6 +160,9 @@ bool LinuxCoreDumper::EnumerateThreads() {
     fprintf(stderr, "Invalid core dump file\n");
     return false;
   }
+  // Only the notes are read in order; the memory is read a stack or a
+  // mapping at a time, scattered over what may be gigabytes of core.
+  core_.AdviseSegmentData(MADV_RANDOM);
 
   ElfCoreDump::Note note = core_.GetFirstNote();
   if (!note.IsValid()) {
@@ -74,6 +74,12 @@ class LinuxCoreDumper : public LinuxDumper {
   virtual bool CopyFromProcess(void* dest, pid_t child, const void* src,
                                size_t length);
 
+  // Implements LinuxDumper::PrepareForConcurrentCopies().
+  // The core dump is read through a shared read-only mapping and a sorted
+  // table of its segments, which any number of tasks can use at once.
+  // Always returns true.
+  virtual bool PrepareForConcurrentCopies();
+
   // Implements LinuxDumper::GetThreadInfoByIndex().
   // Reads information about the |index|-th thread of |threads_|.
   // Returns true on success. One must have called |ThreadsSuspend| first.
@@ -40,6 +40,7 @@
 
 #include "client/linux/minidump_writer/linux_dumper.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <elf.h>
 #include <fcntl.h>
@@ -47,7 +48,10 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "client/linux/minidump_writer/dump_timings.h"
+#include "client/linux/minidump_writer/file_identifier_cache.h"
 #include "client/linux/minidump_writer/line_reader.h"
+#include "client/linux/minidump_writer/warm_dump_state.h"
 #include "common/linux/elfutils.h"
 #include "common/linux/file_id.h"
 #include "common/linux/linux_libc_support.h"
@@ -278,6 +282,68 @@ void CrOSPostProcessMappings(wasteful_vector<MappingInfo*>& mappings) {
 
 #endif  // __CHROMEOS__
 
+// Return true if |low| <= |word| <= |high|, in one unsigned comparison.
+inline bool WordInRange(uintptr_t word, uintptr_t low, uintptr_t high) {
+  return word - low <= high - low;
+}
+
+// Where the target has cheap word-sized unsigned vector comparisons, stack
+// words are range checked a block at a time with SIMD instructions, and
+// only the words that fail are checked one by one.  Elsewhere, and with
+// compilers without vector types, every word is checked on its own.
+#if defined(__GNUC__) && \
+    (defined(__AVX2__) || defined(__aarch64__) || defined(__ARM_NEON))
+#define HAVE_WORD_BLOCK_VECTORS 1
+const size_t kWordsPerBlock = 4;
+const size_t kWordBlockSize = kWordsPerBlock * sizeof(uintptr_t);
+typedef uintptr_t WordBlock
+    __attribute__((vector_size(kWordsPerBlock * sizeof(uintptr_t))));
+typedef WordBlock UnalignedWordBlock __attribute__((aligned(1), may_alias));
+#endif
+
+#if defined(__GNUC__)
+// An unaligned view of a stack copy, which the compiler reads and writes
+// inline rather than through my_memcpy.
+typedef uintptr_t UnalignedWord __attribute__((aligned(1), may_alias));
+#endif
+
+// Read or write the word at |p|, which need not be aligned.
+inline uintptr_t LoadWord(const uint8_t* p) {
+#if defined(__GNUC__)
+  return *reinterpret_cast<const UnalignedWord*>(p);
+#else
+  uintptr_t word;
+  my_memcpy(&word, p, sizeof(word));
+  return word;
+#endif
+}
+
+inline void StoreWord(uint8_t* p, uintptr_t word) {
+#if defined(__GNUC__)
+  *reinterpret_cast<UnalignedWord*>(p) = word;
+#else
+  my_memcpy(p, &word, sizeof(word));
+#endif
+}
+
+#if defined(HAVE_WORD_BLOCK_VECTORS)
+// Return a mask with bit i set if the i'th word of the block at |words|,
+// which need not be aligned, is within any of the |count| ranges
+// [|low|[j], |high|[j]].
+inline unsigned BlockWordsInRanges(const uint8_t* words,
+                                   const uintptr_t* low, const uintptr_t* high,
+                                   size_t count) {
+  WordBlock block = *reinterpret_cast<const UnalignedWordBlock*>(words);
+  WordBlock in_range = (block - low[0]) <= (high[0] - low[0]);
+  for (size_t j = 1; j < count; ++j)
+    in_range |= (block - low[j]) <= (high[j] - low[j]);
+  unsigned mask = 0;
+  for (size_t i = 0; i < kWordsPerBlock; ++i)
+    mask |= static_cast<unsigned>(in_range[i] & 1) << i;
+  return mask;
+}
+#endif
+
 }  // namespace
 
 // All interesting auvx entry types are below AT_SYSINFO_EHDR
@@ -292,7 +358,9 @@ LinuxDumper::LinuxDumper(pid_t pid, const char* root_prefix)
       crash_thread_(pid),
       threads_(&allocator_, 8),
       mappings_(&allocator_),
-      auxv_(&allocator_, AT_MAX + 1) {
+      auxv_(&allocator_, AT_MAX + 1),
+      timings_(NULL),
+      executable_ranges_(&allocator_) {
   assert(root_prefix_ && my_strlen(root_prefix_) < PATH_MAX);
   // The passed-in size to the constructor (above) is only a hint.
   // Must call .resize() to do actual initialization of the elements.
@@ -303,7 +371,32 @@ LinuxDumper::~LinuxDumper() {
 }
 
 bool LinuxDumper::Init() {
-  return ReadAuxv() && EnumerateThreads() && EnumerateMappings();
+  if (!ReadAuxv())
+    return false;
+  {
+    ScopedDumpTimer timer(timings_, MD_DUMP_TIMING_THREAD_ENUMERATION);
+    if (!EnumerateThreads())
+      return false;
+  }
+  ScopedDumpTimer timer(timings_, MD_DUMP_TIMING_MAPPING_ENUMERATION);
+  if (!EnumerateMappings())
+    return false;
+  BuildExecutableRanges();
+  return true;
+}
+
+bool LinuxDumper::CopyFromProcessUntraced(void* dest, pid_t child,
+                                          const void* src, size_t length) {
+  CopyFromProcess(dest, child, src, length);
+  return true;
+}
+
+bool LinuxDumper::PrepareForConcurrentCopies() {
+  return false;
+}
+
+bool LinuxDumper::ReadFromSnapshot() {
+  return false;
 }
 
 bool LinuxDumper::LateInit() {
@@ -315,6 +408,9 @@ bool LinuxDumper::LateInit() {
   CrOSPostProcessMappings(mappings_);
 #endif
 
+  // The mappings are final now, and SanitizeStackCopy may run on several
+  // tasks at once from here on, so it only ever reads the table.
+  BuildExecutableRanges();
   return true;
 }
 
@@ -346,12 +442,16 @@ LinuxDumper::ElfFileIdentifierForMapping(const MappingInfo& mapping,
     return false;
   bool filename_modified = HandleDeletedFileInMapping(filename);
 
-  MemoryMappedFile mapped_file(filename, 0);
-  if (!mapped_file.data() || mapped_file.size() < SELFMAG)
-    return false;
+  // Identifiers cached before the crash save opening and reading the file.
+  bool success = FileIdentifierCache::Find(filename, identifier);
+  if (!success) {
+    MemoryMappedFile mapped_file(filename, 0);
+    if (!mapped_file.data() || mapped_file.size() < SELFMAG)
+      return false;
 
-  bool success =
-      FileID::ElfFileIdentifierFromMappedFile(mapped_file.data(), identifier);
+    success = FileID::ElfFileIdentifierFromMappedFile(mapped_file.data(),
+                                                      identifier);
+  }
   if (success && member && filename_modified) {
     mappings_[mapping_id]->name[my_strlen(mapping.name) -
                                 sizeof(kDeletedSuffix) + 1] = '\0';
@@ -518,12 +618,14 @@ void LinuxDumper::GetMappingEffectiveNameAndPath(const MappingInfo& mapping,
 }
 
 bool LinuxDumper::ReadAuxv() {
-  char auxv_path[NAME_MAX];
-  if (!BuildProcPath(auxv_path, pid_, "auxv")) {
-    return false;
+  int fd = WarmDumpState::OpenProcFile(pid_, "auxv");
+  if (fd < 0) {
+    char auxv_path[NAME_MAX];
+    if (!BuildProcPath(auxv_path, pid_, "auxv")) {
+      return false;
+    }
+    fd = sys_open(auxv_path, O_RDONLY, 0);
   }
-
-  int fd = sys_open(auxv_path, O_RDONLY, 0);
   if (fd < 0) {
     return false;
   }
@@ -560,13 +662,32 @@ bool LinuxDumper::EnumerateMappings() {
   // Although the initial executable is usually the first mapping, it's not
   // guaranteed (see http://crosbug.com/25355); therefore, try to use the
   // actual entry point to find the mapping.
-  const void* entry_point_loc = reinterpret_cast<void*>(auxv_[AT_ENTRY]);
+  const uintptr_t entry_point_address = auxv_[AT_ENTRY];
 
   const int fd = sys_open(maps_path, O_RDONLY, 0);
   if (fd < 0)
     return false;
-  LineReader* const line_reader = new(allocator_) LineReader(fd);
-
+  // Processes may have tens of thousands of mappings, so the file is read
+  // in large pieces.
+  static const size_t kMapsBufferSize = 32 * 1024;
+  char* const maps_buffer =
+      reinterpret_cast<char*>(allocator_.Alloc(kMapsBufferSize));
+  LineReader* const line_reader = maps_buffer ?
+      new(allocator_) LineReader(fd, maps_buffer, kMapsBufferSize) :
+      new(allocator_) LineReader(fd);
+
+  // The length of the name of the last mapping in |mappings_|, which the
+  // next mapping is compared with to merge them.
+  size_t last_name_len = 0;
+  // The index of the first mapping that contains the entry point, found as
+  // the mappings are read, or |kNoEntryPoint|.
+  const size_t kNoEntryPoint = static_cast<size_t>(-1);
+  size_t entry_point_index = kNoEntryPoint;
+  // MappingInfo structures are allocated a block at a time, as allocating
+  // each on its own maps new pages for every few of them.
+  static const size_t kMappingBlockSize = 128;
+  MappingInfo* free_mappings = NULL;
+  size_t free_mapping_count = 0;
   const char* line;
   unsigned line_len;
   while (line_reader->GetNextLine(&line, &line_len)) {
@@ -593,20 +714,33 @@ bool LinuxDumper::EnumerateMappings() {
           // matches and either they have the same +x protection flag, or if the
           // previous mapping is not executable and the new one is, to handle
           // lld's output (see crbug.com/716484).
+          const size_t name_len = name ? my_strlen(name) : 0;
           if (name && !mappings_.empty()) {
             MappingInfo* module = mappings_.back();
             if ((start_addr == module->start_addr + module->size) &&
-                (my_strlen(name) == my_strlen(module->name)) &&
-                (my_strncmp(name, module->name, my_strlen(name)) == 0) &&
+                (name_len == last_name_len) &&
+                (my_memcmp(name, module->name, name_len) == 0) &&
                 ((exec == module->exec) || (!module->exec && exec))) {
               module->system_mapping_info.end_addr = end_addr;
               module->size = end_addr - module->start_addr;
               module->exec |= exec;
+              if (entry_point_index == kNoEntryPoint && entry_point_address &&
+                  MappingContainsAddress(*module, entry_point_address)) {
+                entry_point_index = mappings_.size() - 1;
+              }
               line_reader->PopLine(line_len);
               continue;
             }
           }
-          MappingInfo* const module = new(allocator_) MappingInfo;
+          if (free_mapping_count == 0) {
+            free_mappings = reinterpret_cast<MappingInfo*>(
+                allocator_.Alloc(kMappingBlockSize * sizeof(MappingInfo)));
+            if (!free_mappings)
+              break;
+            free_mapping_count = kMappingBlockSize;
+          }
+          MappingInfo* const module = free_mappings++;
+          --free_mapping_count;
           mappings_.push_back(module);
           my_memset(module, 0, sizeof(MappingInfo));
           module->system_mapping_info.start_addr = start_addr;
@@ -615,10 +749,14 @@ bool LinuxDumper::EnumerateMappings() {
           module->size = end_addr - start_addr;
           module->offset = offset;
           module->exec = exec;
-          if (name != NULL) {
-            const unsigned l = my_strlen(name);
-            if (l < sizeof(module->name))
-              my_memcpy(module->name, name, l);
+          last_name_len = 0;
+          if (name != NULL && name_len < sizeof(module->name)) {
+            my_memcpy(module->name, name, name_len);
+            last_name_len = name_len;
+          }
+          if (entry_point_index == kNoEntryPoint && entry_point_address &&
+              MappingContainsAddress(*module, entry_point_address)) {
+            entry_point_index = mappings_.size() - 1;
           }
         }
       }
@@ -626,24 +764,16 @@ bool LinuxDumper::EnumerateMappings() {
     line_reader->PopLine(line_len);
   }
 
-  if (entry_point_loc) {
-    for (size_t i = 0; i < mappings_.size(); ++i) {
-      MappingInfo* module = mappings_[i];
-
-      // If this module contains the entry-point, and it's not already the first
-      // one, then we need to make it be first.  This is because the minidump
-      // format assumes the first module is the one that corresponds to the main
-      // executable (as codified in
-      // processor/minidump.cc:MinidumpModuleList::GetMainModule()).
-      if ((entry_point_loc >= reinterpret_cast<void*>(module->start_addr)) &&
-          (entry_point_loc <
-           reinterpret_cast<void*>(module->start_addr + module->size))) {
-        for (size_t j = i; j > 0; j--)
-          mappings_[j] = mappings_[j - 1];
-        mappings_[0] = module;
-        break;
-      }
-    }
+  // If a module contains the entry-point, and it's not already the first
+  // one, then we need to make it be first.  This is because the minidump
+  // format assumes the first module is the one that corresponds to the main
+  // executable (as codified in
+  // processor/minidump.cc:MinidumpModuleList::GetMainModule()).
+  if (entry_point_index != kNoEntryPoint) {
+    MappingInfo* const module = mappings_[entry_point_index];
+    for (size_t j = entry_point_index; j > 0; j--)
+      mappings_[j] = mappings_[j - 1];
+    mappings_[0] = module;
   }
 
   sys_close(fd);
@@ -787,57 +917,51 @@ bool LinuxDumper::GetStackInfo(const void** stack, size_t* stack_len,
 
 void LinuxDumper::SanitizeStackCopy(uint8_t* stack_copy, size_t stack_len,
                                     uintptr_t stack_pointer,
-                                    uintptr_t sp_offset) {
-  // We optimize the search for containing mappings in three ways:
-  // 1) We expect that pointers into the stack mapping will be common, so
-  //    we cache that address range.
-  // 2) The last referenced mapping is a reasonable predictor for the next
-  //    referenced mapping, so we test that first.
-  // 3) We precompute a bitfield based upon bits 32:32-n of the start and
-  //    stop addresses, and use that to short circuit any values that can
-  //    not be pointers. (n=11)
+                                    uintptr_t sp_offset) const {
+  // A word is kept if it is a small integer, which is no PII risk and may
+  // be a useful register value, or if it points into the stack mapping, the
+  // executable range that the last kept word pointed into, or any other
+  // executable range.  The first three are tested first, a block of words
+  // at a time where SIMD is available, and only the words that fail them
+  // and pass a bitfield prefilter are looked up in the sorted executable
+  // ranges.
   const uintptr_t defaced =
 #if defined(__LP64__)
       0x0defaced0defaced;
 #else
       0x0defaced;
 #endif
-  // the bitfield length is 2^test_bits long.
-  const unsigned int test_bits = 11;
-  // byte length of the corresponding array.
-  const unsigned int array_size = 1 << (test_bits - 3);
-  const unsigned int array_mask = array_size - 1;
-  // The amount to right shift pointers by. This captures the top bits
-  // on 32 bit architectures. On 64 bit architectures this would be
-  // uninformative so we take the same range of bits.
-  const unsigned int shift = 32 - 11;
-  const MappingInfo* last_hit_mapping = nullptr;
-  const MappingInfo* hit_mapping = nullptr;
-  const MappingInfo* stack_mapping = FindMappingNoBias(stack_pointer);
   // The magnitude below which integers are considered to be to be
-  // 'small', and not constitute a PII risk. These are included to
-  // avoid eliding useful register values.
-  const ssize_t small_int_magnitude = 4096;
-
-  char could_hit_mapping[array_size];
-  my_memset(could_hit_mapping, 0, array_size);
+  // 'small', and not constitute a PII risk.
+  const uintptr_t small_int_magnitude = 4096;
+
+  // The ranges that keep a word without a lookup: small integers, the
+  // stack mapping, and the last executable range hit.  Empty ranges are
+  // [0, 0], which only holds a small integer anyway.
+  enum { kSmallInts, kStack, kLastHit, kRangeCount };
+  uintptr_t low[kRangeCount] = { 0 - small_int_magnitude, 0, 0 };
+  uintptr_t high[kRangeCount] = { small_int_magnitude, 0, 0 };
+  const MappingInfo* stack_mapping = FindMappingNoBias(stack_pointer);
+  if (stack_mapping) {
+    low[kStack] = stack_mapping->system_mapping_info.start_addr;
+    high[kStack] = stack_mapping->system_mapping_info.end_addr - 1;
+  }
 
-  // Initialize the bitfield such that if the (pointer >> shift)'th
-  // bit, modulo the bitfield size, is not set then there does not
-  // exist a mapping in mappings_ that would contain that pointer.
-  for (size_t i = 0; i < mappings_.size(); ++i) {
-    if (!mappings_[i]->exec) continue;
-    // For each mapping, work out the (unmodulo'ed) range of bits to
-    // set.
-    uintptr_t start = mappings_[i]->start_addr;
-    uintptr_t end = start + mappings_[i]->size;
-    start >>= shift;
-    end >>= shift;
-    for (size_t bit = start; bit <= end; ++bit) {
-      // Set each bit in the range, applying the modulus.
-      could_hit_mapping[(bit >> 3) & array_mask] |= 1 << (bit & 7);
+  auto sanitize_word = [&](uint8_t* word) {
+    uintptr_t addr = LoadWord(word);
+    for (size_t j = 0; j < kRangeCount; ++j) {
+      if (WordInRange(addr, low[j], high[j]))
+        return;
     }
-  }
+    const AddressRange* range = MayBeExecutable(addr) ?
+        FindExecutableRange(addr) : NULL;
+    if (range) {
+      low[kLastHit] = range->start;
+      high[kLastHit] = range->end - 1;
+      return;
+    }
+    StoreWord(word, defaced);
+  };
 
   // Zero memory that is below the current stack pointer.
   const uintptr_t offset =
@@ -848,35 +972,29 @@ void LinuxDumper::SanitizeStackCopy(uint8_t* stack_copy, size_t stack_len,
 
   // Apply sanitization to each complete pointer-aligned word in the
   // stack.
-  uint8_t* sp;
-  for (sp = stack_copy + offset;
-       sp <= stack_copy + stack_len - sizeof(uintptr_t);
-       sp += sizeof(uintptr_t)) {
-    uintptr_t addr;
-    my_memcpy(&addr, sp, sizeof(uintptr_t));
-    if (static_cast<intptr_t>(addr) <= small_int_magnitude &&
-        static_cast<intptr_t>(addr) >= -small_int_magnitude) {
-      continue;
-    }
-    if (stack_mapping && MappingContainsAddress(*stack_mapping, addr)) {
-      continue;
-    }
-    if (last_hit_mapping && MappingContainsAddress(*last_hit_mapping, addr)) {
-      continue;
-    }
-    uintptr_t test = addr >> shift;
-    if (could_hit_mapping[(test >> 3) & array_mask] & (1 << (test & 7)) &&
-        (hit_mapping = FindMappingNoBias(addr)) != nullptr &&
-        hit_mapping->exec) {
-      last_hit_mapping = hit_mapping;
-      continue;
+  uint8_t* sp = stack_copy + offset;
+  uint8_t* const stack_end = stack_copy + stack_len;
+#if defined(HAVE_WORD_BLOCK_VECTORS)
+  const unsigned all_words = (1U << kWordsPerBlock) - 1;
+  while (stack_end - sp >= static_cast<ptrdiff_t>(kWordBlockSize)) {
+    unsigned kept = BlockWordsInRanges(sp, low, high, kRangeCount);
+    if (kept != all_words) {
+      for (size_t i = 0; i < kWordsPerBlock; ++i) {
+        if (!(kept & (1U << i)))
+          sanitize_word(sp + i * sizeof(uintptr_t));
+      }
     }
-    my_memcpy(sp, &defaced, sizeof(uintptr_t));
+    sp += kWordBlockSize;
+  }
+#endif
+  while (stack_end - sp >= static_cast<ptrdiff_t>(sizeof(uintptr_t))) {
+    sanitize_word(sp);
+    sp += sizeof(uintptr_t);
   }
   // Zero any partial word at the top of the stack, if alignment is
   // such that that is required.
-  if (sp < stack_copy + stack_len) {
-    my_memset(sp, 0, stack_copy + stack_len - sp);
+  if (sp < stack_end) {
+    my_memset(sp, 0, stack_end - sp);
   }
 }
 
@@ -894,17 +1012,97 @@ bool LinuxDumper::StackHasPointerToMapping(const uint8_t* stack_copy,
   const uintptr_t offset =
       (sp_offset + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
 
-  for (const uint8_t* sp = stack_copy + offset;
-       sp <= stack_copy + stack_len - sizeof(uintptr_t);
-       sp += sizeof(uintptr_t)) {
-    uintptr_t addr;
-    my_memcpy(&addr, sp, sizeof(uintptr_t));
-    if (low_addr <= addr && addr <= high_addr)
+  const uint8_t* sp = stack_copy + offset;
+  const uint8_t* const stack_end = stack_copy + stack_len;
+#if defined(HAVE_WORD_BLOCK_VECTORS)
+  while (stack_end - sp >= static_cast<ptrdiff_t>(kWordBlockSize)) {
+    if (BlockWordsInRanges(sp, &low_addr, &high_addr, 1))
+      return true;
+    sp += kWordBlockSize;
+  }
+#endif
+  while (stack_end - sp >= static_cast<ptrdiff_t>(sizeof(uintptr_t))) {
+    if (WordInRange(LoadWord(sp), low_addr, high_addr))
       return true;
+    sp += sizeof(uintptr_t);
   }
   return false;
 }
 
+void LinuxDumper::BuildExecutableRanges() {
+  executable_ranges_.clear();
+  for (size_t i = 0; i < mappings_.size(); ++i) {
+    if (!mappings_[i]->exec)
+      continue;
+    AddressRange range;
+    range.start = mappings_[i]->system_mapping_info.start_addr;
+    range.end = mappings_[i]->system_mapping_info.end_addr;
+    if (range.start >= range.end)
+      continue;
+    // /proc/<pid>/maps lists mappings in address order, so this insertion
+    // sort usually just appends.
+    executable_ranges_.push_back(range);
+    size_t j = executable_ranges_.size() - 1;
+    while (j > 0 && executable_ranges_[j - 1].start > range.start) {
+      executable_ranges_[j] = executable_ranges_[j - 1];
+      --j;
+    }
+    executable_ranges_[j] = range;
+  }
+  // Merge ranges that touch or overlap.
+  size_t merged = 0;
+  for (size_t i = 0; i < executable_ranges_.size(); ++i) {
+    if (merged > 0 &&
+        executable_ranges_[i].start <= executable_ranges_[merged - 1].end) {
+      if (executable_ranges_[i].end > executable_ranges_[merged - 1].end)
+        executable_ranges_[merged - 1].end = executable_ranges_[i].end;
+    } else {
+      executable_ranges_[merged++] = executable_ranges_[i];
+    }
+  }
+  executable_ranges_.resize(merged);
+
+  // Set the bit for each value of bits 21 and up, modulo the bitfield's
+  // size, that some range spans, so that most words that can't be in one
+  // skip the search.  On 32 bit architectures that captures the top bits;
+  // on 64 bit architectures it takes the same range of bits.
+  my_memset(could_be_executable_, 0, sizeof(could_be_executable_));
+  for (size_t i = 0; i < executable_ranges_.size(); ++i) {
+    uintptr_t first = executable_ranges_[i].start >> kExecutableBitShift;
+    uintptr_t last = (executable_ranges_[i].end - 1) >> kExecutableBitShift;
+    const uintptr_t bit_count = sizeof(could_be_executable_) * 8;
+    if (last - first >= bit_count)
+      last = first + bit_count - 1;
+    for (uintptr_t bit = first; bit <= last; ++bit) {
+      could_be_executable_[(bit / 8) % sizeof(could_be_executable_)] |=
+          1 << (bit % 8);
+    }
+  }
+}
+
+bool LinuxDumper::MayBeExecutable(uintptr_t address) const {
+  uintptr_t bit = address >> kExecutableBitShift;
+  return could_be_executable_[(bit / 8) % sizeof(could_be_executable_)] &
+         (1 << (bit % 8));
+}
+
+const LinuxDumper::AddressRange* LinuxDumper::FindExecutableRange(
+    uintptr_t address) const {
+  // Find the last range starting at or below |address|.
+  size_t low = 0;
+  size_t high = executable_ranges_.size();
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    if (executable_ranges_[middle].start <= address)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  if (low == 0 || address >= executable_ranges_[low - 1].end)
+    return NULL;
+  return &executable_ranges_[low - 1];
+}
+
 // Find the mapping which the given memory address falls in.
 const MappingInfo* LinuxDumper::FindMapping(const void* address) const {
   const uintptr_t addr = (uintptr_t) address;
@@ -57,6 +57,8 @@
 
 namespace google_breakpad {
 
+struct DumpTimings;
+
 // Typedef for our parsing of the auxv variables in /proc/pid/auxv.
 #if defined(__i386) || defined(__ARM_EABI__) || \
      (defined(__mips__) && _MIPS_SIM == _ABIO32) || \
@@ -137,8 +139,9 @@ class LinuxDumper {
   //                  the stack mapping, as an optimization).
   //   sp_offset: the offset relative to stack_copy that reflects the
   //              current value of the stack pointer.
+  // Only reads the dumper, so it may run on several tasks at once.
   void SanitizeStackCopy(uint8_t* stack_copy, size_t stack_len,
-                         uintptr_t stack_pointer, uintptr_t sp_offset);
+                         uintptr_t stack_pointer, uintptr_t sp_offset) const;
 
   // Test whether |stack_copy| contains a pointer-aligned word that
   // could be an address within a given mapping.
@@ -160,13 +163,35 @@ class LinuxDumper {
   virtual bool CopyFromProcess(void* dest, pid_t child, const void* src,
                                size_t length) = 0;
 
+  // Same as CopyFromProcess(), but may be called from any task readied by
+  // PrepareForConcurrentCopies(). Returns false if some of the bytes could
+  // only be read by the task that suspended the threads, which must then
+  // copy them again with CopyFromProcess(). The default is to call
+  // CopyFromProcess() and return true.
+  virtual bool CopyFromProcessUntraced(void* dest, pid_t child,
+                                       const void* src, size_t length);
+
+  // Readies CopyFromProcessUntraced() to be called at the same time from
+  // several tasks that share this dumper's address space, including tasks
+  // other than the one that suspended the threads. Returns false if that is
+  // not supported, which is the default.
+  virtual bool PrepareForConcurrentCopies();
+
+  // Makes later CopyFromProcess() calls read the memory of the calling
+  // process instead, which must be a copy of the dumped process made by
+  // fork, or by clone without CLONE_VM, while its threads were stopped.
+  // Each later fork of the caller then reads its own copy. Returns false if
+  // that is not supported, which is the default.
+  virtual bool ReadFromSnapshot();
+
   // Builds a proc path for a certain pid for a node (/proc/<pid>/<node>).
   // |path| is a character array of at least NAME_MAX bytes to return the
   // result.|node| is the final node without any slashes. Returns true on
   // success.
   virtual bool BuildProcPath(char* path, pid_t pid, const char* node) const = 0;
 
-  // Generate a File ID from the .text section of a mapped entry.
+  // Generate a File ID from the .text section of a mapped entry, or find
+  // it in FileIdentifierCache if the file was cached before the crash.
   // If not a member, mapping_id is ignored. This method can also manipulate the
   // |mapping|.name to truncate "(deleted)" from the file name if necessary.
   bool ElfFileIdentifierForMapping(const MappingInfo& mapping,
@@ -197,8 +222,14 @@ class LinuxDumper {
   }
 
   pid_t crash_thread() const { return crash_thread_; }
+  pid_t pid() const { return pid_; }
   void set_crash_thread(pid_t crash_thread) { crash_thread_ = crash_thread; }
 
+  // Records the time taken to list the threads and mappings, and to
+  // suspend and resume the threads, in |timings|, which is not owned.
+  // NULL, the default, records nothing.
+  void set_timings(DumpTimings* timings) { timings_ = timings; }
+
   // Concatenates the |root_prefix_| and |mapping| path. Writes into |path| and
   // returns true unless the string is too long.
   bool GetMappingAbsolutePath(const MappingInfo& mapping,
@@ -265,6 +296,39 @@ class LinuxDumper {
   // Info from /proc/<pid>/auxv
   wasteful_vector<elf_aux_val_t> auxv_;
 
+  // See set_timings.
+  DumpTimings* timings_;
+
+ private:
+  // A range of addresses [start, end) as the kernel maps them.
+  struct AddressRange {
+    uintptr_t start;
+    uintptr_t end;
+  };
+
+  // Build |executable_ranges_| and |could_be_executable_| from |mappings_|.
+  // Called from Init() and LateInit(), before any task that could run
+  // SanitizeStackCopy() concurrently is started, as it allocates.
+  void BuildExecutableRanges();
+
+  // Return false if no range in |executable_ranges_| can hold |address|,
+  // according to |could_be_executable_|.
+  bool MayBeExecutable(uintptr_t address) const;
+
+  // Return the range in |executable_ranges_| that holds |address|, or
+  // NULL if none does.
+  const AddressRange* FindExecutableRange(uintptr_t address) const;
+
+  // The kernel's ranges of the executable mappings, sorted by address with
+  // touching ranges merged, so that SanitizeStackCopy can binary search
+  // them.
+  wasteful_vector<AddressRange> executable_ranges_;
+
+  // A bitfield indexed by bits 21 and up of an address, modulo its size,
+  // whose bit is clear if no executable range spans that value.
+  static const unsigned kExecutableBitShift = 21;
+  uint8_t could_be_executable_[256];
+
 #if defined(__ANDROID__)
  private:
   // Android M and later support packed ELF relocations in shared libraries.
@@ -0,0 +1,209 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// linux_dumper_benchmark.cc: Times LinuxDumper::SanitizeStackCopy and
+// LinuxDumper::StackHasPointerToMapping over synthetic thread stacks.
+//
+// Usage: linux_dumper_benchmark [-s stack_kb] [-t threads] [-m mappings]
+//
+// The dumper is initialized on this process, which first maps |mappings|
+// extra pages, every other one executable, so that the mapping list is as
+// long as a large program's.  Each of |threads| stacks of |stack_kb| KB
+// holds a mix of small integers, pointers into the stack, pointers into
+// executable mappings, heap pointers and other words.  The benchmark
+// reports the total time of each call over all of the stacks and the rate
+// at which stack data was checked.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <vector>
+
+#include "client/linux/minidump_writer/linux_ptrace_dumper.h"
+
+using google_breakpad::LinuxPtraceDumper;
+using google_breakpad::MappingInfo;
+
+namespace {
+
+// A small deterministic generator, so that runs see the same stacks.
+uint64_t NextRandom(uint64_t* state) {
+  *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return *state >> 16;
+}
+
+double Milliseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void Usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [-s stack_kb] [-t threads] [-m mappings]\n", program);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t stack_kb = 256;
+  size_t thread_count = 1000;
+  size_t extra_mappings = 0;
+  int ch;
+  while ((ch = getopt(argc, argv, "s:t:m:")) != -1) {
+    switch (ch) {
+      case 's':
+        stack_kb = strtoul(optarg, NULL, 10);
+        break;
+      case 't':
+        thread_count = strtoul(optarg, NULL, 10);
+        break;
+      case 'm':
+        extra_mappings = strtoul(optarg, NULL, 10);
+        break;
+      default:
+        Usage(argv[0]);
+        return 1;
+    }
+  }
+  if (stack_kb == 0 || thread_count == 0) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  const size_t page_size = getpagesize();
+  for (size_t i = 0; i < extra_mappings; ++i) {
+    int protection = i % 2 ? PROT_READ | PROT_EXEC : PROT_READ;
+    if (mmap(NULL, page_size, protection, MAP_PRIVATE | MAP_ANONYMOUS,
+             -1, 0) == MAP_FAILED) {
+      perror("mmap");
+      return 1;
+    }
+  }
+
+  LinuxPtraceDumper dumper(getpid());
+  if (!dumper.Init()) {
+    fprintf(stderr, "Failed to initialize the dumper\n");
+    return 1;
+  }
+  std::vector<const MappingInfo*> executable;
+  for (const MappingInfo* mapping : dumper.mappings()) {
+    if (mapping->exec)
+      executable.push_back(mapping);
+  }
+  if (executable.empty()) {
+    fprintf(stderr, "No executable mappings found\n");
+    return 1;
+  }
+
+  int local;
+  const uintptr_t stack_pointer = reinterpret_cast<uintptr_t>(&local);
+  std::vector<char> heap(1 << 20);
+  const uintptr_t heap_base = reinterpret_cast<uintptr_t>(heap.data());
+
+  const size_t stack_words = stack_kb * 1024 / sizeof(uintptr_t);
+  std::vector<uintptr_t> stack(stack_words);
+  uint64_t state = 1;
+  for (uintptr_t& word : stack) {
+    uint64_t choice = NextRandom(&state) % 100;
+    uint64_t random = NextRandom(&state);
+    if (choice < 40) {
+      word = random % 8192 - 4096;
+    } else if (choice < 65) {
+      word = stack_pointer + random % 65536;
+    } else if (choice < 80) {
+      const MappingInfo* mapping = executable[random % executable.size()];
+      word = mapping->system_mapping_info.start_addr +
+             (random >> 16) % (mapping->system_mapping_info.end_addr -
+                               mapping->system_mapping_info.start_addr);
+    } else if (choice < 90) {
+      word = heap_base + random % heap.size();
+    } else {
+      word = static_cast<uintptr_t>(random * 0x9e3779b97f4a7c15ULL);
+    }
+  }
+
+  // Search for a mapping that no word points into, so that every word is
+  // checked.
+  const MappingInfo* unreferenced = NULL;
+  for (const MappingInfo* mapping : dumper.mappings()) {
+    bool referenced = false;
+    for (uintptr_t word : stack) {
+      if (word >= mapping->system_mapping_info.start_addr &&
+          word <= mapping->system_mapping_info.end_addr) {
+        referenced = true;
+        break;
+      }
+    }
+    if (!referenced) {
+      unreferenced = mapping;
+      break;
+    }
+  }
+
+  std::vector<uintptr_t> copy(stack_words);
+  uint8_t* copy_bytes = reinterpret_cast<uint8_t*>(copy.data());
+  std::chrono::steady_clock::duration sanitize_time(0);
+  std::chrono::steady_clock::duration search_time(0);
+  size_t found = 0;
+  for (size_t i = 0; i < thread_count; ++i) {
+    copy = stack;
+    auto start = std::chrono::steady_clock::now();
+    dumper.SanitizeStackCopy(copy_bytes, stack_words * sizeof(uintptr_t),
+                             stack_pointer, 0);
+    sanitize_time += std::chrono::steady_clock::now() - start;
+
+    if (unreferenced) {
+      start = std::chrono::steady_clock::now();
+      found += dumper.StackHasPointerToMapping(
+          reinterpret_cast<const uint8_t*>(stack.data()),
+          stack_words * sizeof(uintptr_t), 0, *unreferenced);
+      search_time += std::chrono::steady_clock::now() - start;
+    }
+  }
+
+  const double megabytes = thread_count * stack_kb / 1024.0;
+  printf("mappings: %zu (%zu executable)\n", dumper.mappings().size(),
+         executable.size());
+  printf("SanitizeStackCopy: %.2f ms, %.0f MB/s\n",
+         Milliseconds(sanitize_time),
+         megabytes / (Milliseconds(sanitize_time) / 1000));
+  if (unreferenced) {
+    printf("StackHasPointerToMapping: %.2f ms, %.0f MB/s, %zu found\n",
+           Milliseconds(search_time),
+           megabytes / (Milliseconds(search_time) / 1000), found);
+  }
+  return 0;
+}
@@ -52,12 +52,14 @@
 #include <sys/ptrace.h>
 #include <sys/uio.h>
 #include <sys/wait.h>
+#include <unistd.h>
 
 #if defined(__i386)
 #include <cpuid.h>
 #endif
 
 #include "client/linux/minidump_writer/directory_reader.h"
+#include "client/linux/minidump_writer/dump_timings.h"
 #include "client/linux/minidump_writer/line_reader.h"
 #include "common/linux/eintr_wrapper.h"
 #include "common/linux/linux_libc_support.h"
@@ -77,6 +79,42 @@ typedef struct {
 } __attribute__((packed, aligned(4))) user_vfp_t;
 #endif  // defined(__arm__)
 
+#ifndef PTRACE_SEIZE
+#define PTRACE_SEIZE 0x4206
+#endif
+#ifndef PTRACE_INTERRUPT
+#define PTRACE_INTERRUPT 0x4207
+#endif
+#ifndef PTRACE_EVENT_STOP
+#define PTRACE_EVENT_STOP 128
+#endif
+
+// Checks a thread that has just been stopped, detaching from it if it is
+// not to be dumped.
+static bool KeepStoppedThread(pid_t pid) {
+#if defined(__i386) || defined(__x86_64)
+  // On x86, the stack pointer is NULL or -1, when executing trusted code in
+  // the seccomp sandbox. Not only does this cause difficulties down the line
+  // when trying to dump the thread's stack, it also results in the minidumps
+  // containing information about the trusted threads. This information is
+  // generally completely meaningless and just pollutes the minidumps.
+  // We thus test the stack pointer and exclude any threads that are part of
+  // the seccomp sandbox's trusted code.
+  user_regs_struct regs;
+  if (sys_ptrace(PTRACE_GETREGS, pid, NULL, &regs) == -1 ||
+#if defined(__i386)
+      !regs.esp
+#elif defined(__x86_64)
+      !regs.rsp
+#endif
+      ) {
+    sys_ptrace(PTRACE_DETACH, pid, NULL, NULL);
+    return false;
+  }
+#endif
+  return true;
+}
+
 // Suspends a thread by attaching to it.
 static bool SuspendThread(pid_t pid) {
   // This may fail if the thread has just died or debugged.
@@ -109,29 +147,57 @@ static bool SuspendThread(pid_t pid) {
     if (r < 0)
       return false;
   }
-#if defined(__i386) || defined(__x86_64)
-  // On x86, the stack pointer is NULL or -1, when executing trusted code in
-  // the seccomp sandbox. Not only does this cause difficulties down the line
-  // when trying to dump the thread's stack, it also results in the minidumps
-  // containing information about the trusted threads. This information is
-  // generally completely meaningless and just pollutes the minidumps.
-  // We thus test the stack pointer and exclude any threads that are part of
-  // the seccomp sandbox's trusted code.
-  user_regs_struct regs;
-  if (sys_ptrace(PTRACE_GETREGS, pid, NULL, &regs) == -1 ||
-#if defined(__i386)
-      !regs.esp
-#elif defined(__x86_64)
-      !regs.rsp
-#endif
-      ) {
+  return KeepStoppedThread(pid);
+}
+
+// Starts suspending a thread by seizing and interrupting it, without
+// waiting for it to stop; see WaitForInterruptedThread.  Unlike attaching,
+// this sends the thread no SIGSTOP.  Sets |unsupported| if the kernel
+// predates PTRACE_SEIZE (Linux 3.4).
+static bool InterruptThread(pid_t pid, bool* unsupported) {
+  *unsupported = false;
+  // This may fail if the thread has just died or debugged.
+  errno = 0;
+  if (sys_ptrace(PTRACE_SEIZE, pid, NULL, NULL) != 0 && errno != 0) {
+    *unsupported = errno == EIO;
+    return false;
+  }
+  errno = 0;
+  if (sys_ptrace(PTRACE_INTERRUPT, pid, NULL, NULL) != 0 && errno != 0) {
     sys_ptrace(PTRACE_DETACH, pid, NULL, NULL);
     return false;
   }
-#endif
   return true;
 }
 
+// Waits for a thread that InterruptThread interrupted to stop.
+static bool WaitForInterruptedThread(pid_t pid) {
+  while (true) {
+    int status;
+    int r = HANDLE_EINTR(sys_waitpid(pid, &status, __WALL));
+    if (r < 0) {
+      sys_ptrace(PTRACE_DETACH, pid, NULL, NULL);
+      return false;
+    }
+
+    if (!WIFSTOPPED(status))
+      return false;
+
+    // The interrupt stops the thread with PTRACE_EVENT_STOP, as does a
+    // group-stop of the whole process.
+    if (status >> 16 == PTRACE_EVENT_STOP)
+      break;
+
+    // Any other stop is for a signal, which needs to be reinjected, or it
+    // will otherwise get lost.  The interrupt stays pending meanwhile.
+    r = sys_ptrace(PTRACE_CONT, pid, NULL,
+                   reinterpret_cast<void*>(WSTOPSIG(status)));
+    if (r < 0)
+      return false;
+  }
+  return KeepStoppedThread(pid);
+}
+
 // Resumes a thread by detaching from it.
 static bool ResumeThread(pid_t pid) {
   return sys_ptrace(PTRACE_DETACH, pid, NULL, NULL) >= 0;
@@ -141,7 +207,16 @@ namespace google_breakpad {
 
 LinuxPtraceDumper::LinuxPtraceDumper(pid_t pid)
     : LinuxDumper(pid),
-      threads_suspended_(false) {
+      threads_suspended_(false),
+      process_vm_readv_usable_(true),
+      proc_mem_fd_(-1),
+      read_from_snapshot_(false),
+      page_size_(getpagesize()) {
+}
+
+LinuxPtraceDumper::~LinuxPtraceDumper() {
+  if (proc_mem_fd_ >= 0)
+    sys_close(proc_mem_fd_);
 }
 
 bool LinuxPtraceDumper::BuildProcPath(char* path, pid_t pid,
@@ -173,18 +248,129 @@ bool LinuxPtraceDumper::CopyFromProcess(void* dest, pid_t child,
   static const size_t word_size = sizeof(tmp);
   uint8_t* const local = (uint8_t*) dest;
   uint8_t* const remote = (uint8_t*) src;
+  if (read_from_snapshot_)
+    child = sys_getpid();
 
   while (done < length) {
-    const size_t l = (length - done > word_size) ? word_size : (length - done);
-    if (sys_ptrace(PTRACE_PEEKDATA, child, remote + done, &tmp) == -1) {
-      tmp = 0;
+    // Copy as much of what is left as possible with a single syscall.
+    // Either path stops short at the first page that cannot be read.
+    ssize_t copied = ReadProcessVM(local + done, child, remote + done,
+                                   length - done);
+    if (copied <= 0)
+      copied = ReadProcMem(local + done, remote + done, length - done);
+    if (copied > 0) {
+      done += copied;
+      continue;
+    }
+
+    // Neither bulk path could read the next byte, so the rest of its page
+    // is handled on its own.
+    const uintptr_t address = reinterpret_cast<uintptr_t>(remote + done);
+    size_t page_end = length;
+    if (length - done > page_size_ - address % page_size_)
+      page_end = done + page_size_ - address % page_size_;
+    if (!threads_suspended_ || read_from_snapshot_) {
+      // PTRACE_PEEKDATA needs the threads to be stopped, and a process
+      // cannot trace itself.
+      my_memset(local + done, 0, page_end - done);
+      done = page_end;
+      continue;
+    }
+    // Fall back to PTRACE_PEEKDATA, which needs the thread to be attached.
+    // Words that cannot be read are zeroed.
+    while (done < page_end) {
+      const size_t l =
+          (page_end - done > word_size) ? word_size : (page_end - done);
+      if (sys_ptrace(PTRACE_PEEKDATA, child, remote + done, &tmp) == -1) {
+        tmp = 0;
+      }
+      my_memcpy(local + done, &tmp, l);
+      done += l;
     }
-    my_memcpy(local + done, &tmp, l);
-    done += l;
   }
   return true;
 }
 
+bool LinuxPtraceDumper::CopyFromProcessUntraced(void* dest, pid_t child,
+                                                const void* src,
+                                                size_t length) {
+  uint8_t* const local = reinterpret_cast<uint8_t*>(dest);
+  const uint8_t* const remote = reinterpret_cast<const uint8_t*>(src);
+  if (read_from_snapshot_)
+    child = sys_getpid();
+
+  size_t done = 0;
+  while (done < length) {
+    ssize_t copied = ReadProcessVM(local + done, child, remote + done,
+                                   length - done);
+    if (copied <= 0)
+      copied = ReadProcMem(local + done, remote + done, length - done);
+    if (copied <= 0)
+      return false;
+    done += copied;
+  }
+  return true;
+}
+
+ssize_t LinuxPtraceDumper::ReadProcessVM(void* dest, pid_t child,
+                                         const void* src, size_t length) {
+  if (!process_vm_readv_usable_)
+    return -1;
+
+  struct kernel_iovec local_iov;
+  local_iov.iov_base = dest;
+  local_iov.iov_len = length;
+  struct kernel_iovec remote_iov;
+  remote_iov.iov_base = const_cast<void*>(src);
+  remote_iov.iov_len = length;
+  const ssize_t r =
+      sys_process_vm_readv(child, &local_iov, 1, &remote_iov, 1, 0);
+  // The kernel may be too old for process_vm_readv, or a seccomp policy or
+  // the process's credentials may forbid it; don't try it again.
+  if (r < 0 && (errno == ENOSYS || errno == EPERM))
+    process_vm_readv_usable_ = false;
+  return r;
+}
+
+bool LinuxPtraceDumper::PrepareForConcurrentCopies() {
+  return OpenProcMem();
+}
+
+bool LinuxPtraceDumper::ReadFromSnapshot() {
+  // The descriptor may be shared with the dumped process's other copies;
+  // it is reopened on the caller's own memory when next needed, by which
+  // time the caller may have forked.
+  if (proc_mem_fd_ >= 0)
+    sys_close(proc_mem_fd_);
+  proc_mem_fd_ = -1;
+  read_from_snapshot_ = true;
+  return true;
+}
+
+ssize_t LinuxPtraceDumper::ReadProcMem(void* dest, const void* src,
+                                       size_t length) {
+  if (!OpenProcMem())
+    return -1;
+
+  return HANDLE_EINTR(sys_pread64(proc_mem_fd_, dest, length,
+                                  reinterpret_cast<uintptr_t>(src)));
+}
+
+bool LinuxPtraceDumper::OpenProcMem() {
+  if (proc_mem_fd_ == -1) {
+    char mem_path[NAME_MAX];
+    // All of the threads share an address space, so the process's file
+    // serves every |child|.
+    if (read_from_snapshot_)
+      proc_mem_fd_ = sys_open("/proc/self/mem", O_RDONLY, 0);
+    else if (BuildProcPath(mem_path, pid_, "mem"))
+      proc_mem_fd_ = sys_open(mem_path, O_RDONLY, 0);
+    if (proc_mem_fd_ < 0)
+      proc_mem_fd_ = -2;
+  }
+  return proc_mem_fd_ >= 0;
+}
+
 // This read VFP registers via either PTRACE_GETREGSET or PTRACE_GETREGS
 #if defined(__arm__)
 static bool ReadVFPRegistersArm32(pid_t tid, struct iovec* io) {
@@ -412,19 +598,32 @@ bool LinuxPtraceDumper::IsPostMortem() const {
 bool LinuxPtraceDumper::ThreadsSuspend() {
   if (threads_suspended_)
     return true;
+  ScopedDumpTimer timer(timings_, MD_DUMP_TIMING_THREADS_SUSPEND);
+  // Interrupt every thread before waiting for any of them, so that the
+  // threads stop at the same time rather than one after another; each
+  // stopped thread is checked while later ones are still stopping.
+  // Threads that could not be interrupted are attached to in turn, as
+  // they are on kernels without PTRACE_SEIZE.
+  wasteful_vector<uint8_t> interrupted(&allocator_, threads_.size());
+  bool seize_supported = true;
   for (size_t i = 0; i < threads_.size(); ++i) {
-    if (!SuspendThread(threads_[i])) {
-      // If the thread either disappeared before we could attach to it, or if
-      // it was part of the seccomp sandbox's trusted code, it is OK to
-      // silently drop it from the minidump.
-      if (i < threads_.size() - 1) {
-        my_memmove(&threads_[i], &threads_[i + 1],
-                   (threads_.size() - i - 1) * sizeof(threads_[i]));
-      }
-      threads_.resize(threads_.size() - 1);
-      --i;
+    bool unsupported = false;
+    interrupted.push_back(seize_supported &&
+                          InterruptThread(threads_[i], &unsupported));
+    if (unsupported)
+      seize_supported = false;
+  }
+  size_t suspended = 0;
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    // If the thread either disappeared before we could attach to it, or if
+    // it was part of the seccomp sandbox's trusted code, it is OK to
+    // silently drop it from the minidump.
+    if (interrupted[i] ? WaitForInterruptedThread(threads_[i])
+                       : SuspendThread(threads_[i])) {
+      threads_[suspended++] = threads_[i];
     }
   }
+  threads_.resize(suspended);
   threads_suspended_ = true;
   return threads_.size() > 0;
 }
@@ -432,6 +631,7 @@ bool LinuxPtraceDumper::ThreadsSuspend() {
 bool LinuxPtraceDumper::ThreadsResume() {
   if (!threads_suspended_)
     return false;
+  ScopedDumpTimer timer(timings_, MD_DUMP_TIMING_THREADS_RESUME);
   bool good = true;
   for (size_t i = 0; i < threads_.size(); ++i)
     good &= ResumeThread(threads_[i]);
@@ -44,6 +44,8 @@ class LinuxPtraceDumper : public LinuxDumper {
   // with a process ID of |pid|.
   explicit LinuxPtraceDumper(pid_t pid);
 
+  virtual ~LinuxPtraceDumper();
+
   // Implements LinuxDumper::BuildProcPath().
   // Builds a proc path for a certain pid for a node (/proc/<pid>/<node>).
   // |path| is a character array of at least NAME_MAX bytes to return the
@@ -53,11 +55,31 @@ class LinuxPtraceDumper : public LinuxDumper {
 
   // Implements LinuxDumper::CopyFromProcess().
   // Copies content of |length| bytes from a given process |child|,
-  // starting from |src|, into |dest|. This method uses ptrace to extract
-  // the content from the target process. Always returns true.
+  // starting from |src|, into |dest|. Whole ranges are copied with
+  // process_vm_readv, or else read from /proc/<pid>/mem. Pages that neither
+  // can read are copied a word at a time with PTRACE_PEEKDATA while the
+  // threads are suspended. Bytes that cannot be read are zeroed. Always
+  // returns true.
   virtual bool CopyFromProcess(void* dest, pid_t child, const void* src,
                                size_t length);
 
+  // Implements LinuxDumper::CopyFromProcessUntraced().
+  // Same as CopyFromProcess(), but without PTRACE_PEEKDATA, which only the
+  // task that attached to the threads can use. Returns false, leaving the
+  // rest of |dest| unwritten, at the first page that cannot be read.
+  virtual bool CopyFromProcessUntraced(void* dest, pid_t child,
+                                       const void* src, size_t length);
+
+  // Implements LinuxDumper::PrepareForConcurrentCopies().
+  // Opens /proc/<pid>/mem, so that CopyFromProcessUntraced() can read
+  // through it from any task. Returns false if it cannot be opened.
+  virtual bool PrepareForConcurrentCopies();
+
+  // Implements LinuxDumper::ReadFromSnapshot().
+  // Switches CopyFromProcess() to process_vm_readv on the calling process,
+  // and to /proc/self/mem. Always returns true.
+  virtual bool ReadFromSnapshot();
+
   // Implements LinuxDumper::GetThreadInfoByIndex().
   // Reads information about the |index|-th thread of |threads_|.
   // Returns true on success. One must have called |ThreadsSuspend| first.
@@ -82,9 +104,37 @@ class LinuxPtraceDumper : public LinuxDumper {
   virtual bool EnumerateThreads();
 
  private:
+  // Copies up to |length| bytes from |src| in the address space of |child|
+  // into |dest| with process_vm_readv. Returns the number of bytes copied,
+  // which stops short at the first page that cannot be read, or -1.
+  ssize_t ReadProcessVM(void* dest, pid_t child, const void* src,
+                        size_t length);
+
+  // Same as ReadProcessVM, but reads /proc/<pid>/mem, which, like
+  // PTRACE_PEEKDATA, can read pages the process itself cannot.
+  ssize_t ReadProcMem(void* dest, const void* src, size_t length);
+
+  // Opens |proc_mem_fd_| if that has not been tried yet. Returns true if it
+  // is open.
+  bool OpenProcMem();
+
   // Set to true if all threads of the crashed process are suspended.
   bool threads_suspended_;
 
+  // Cleared once process_vm_readv fails in a way that won't change. Tasks
+  // copying concurrently may each clear it, but never set it.
+  bool process_vm_readv_usable_;
+
+  // The descriptor for /proc/<pid>/mem, opened on first use. -1 until then,
+  // and -2 if it could not be opened.
+  int proc_mem_fd_;
+
+  // Set by ReadFromSnapshot().
+  bool read_from_snapshot_;
+
+  // The size of a page, the unit in which unreadable memory is skipped.
+  size_t page_size_;
+
   // Read the tracee's registers on kernel with PTRACE_GETREGSET support.
   // Returns false if PTRACE_GETREGSET is not defined.
   // Returns true on success.
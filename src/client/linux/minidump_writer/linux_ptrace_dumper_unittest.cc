@@ -50,6 +50,7 @@
 #include <sys/types.h>
 
 #include <string>
+#include <vector>
 
 #include "breakpad_googletest_includes.h"
 #include "client/linux/minidump_writer/linux_ptrace_dumper.h"
@@ -312,6 +313,84 @@ TEST_F(LinuxPtraceDumperMappingsTest, MergedMappings) {
   EXPECT_EQ(1, mapping_count);
 }
 
+// Fixture with three pages of known content, the middle one unmapped, in
+// the process the child dumps.
+class LinuxPtraceDumperCopyTest : public LinuxPtraceDumperChildTest {
+ protected:
+  virtual void SetUp();
+  virtual void TearDown();
+
+  static uint8_t Pattern(size_t offset) {
+    return static_cast<uint8_t>(offset % 251 + 1);
+  }
+
+  size_t page_size_;
+  uint8_t* mapping_;
+};
+
+void LinuxPtraceDumperCopyTest::SetUp() {
+  page_size_ = sysconf(_SC_PAGESIZE);
+  void* mapping = mmap(NULL, 3 * page_size_, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(MAP_FAILED, mapping);
+  mapping_ = reinterpret_cast<uint8_t*>(mapping);
+  for (size_t i = 0; i < 3 * page_size_; ++i)
+    mapping_[i] = Pattern(i);
+  ASSERT_EQ(0, munmap(mapping_ + page_size_, page_size_));
+
+  LinuxPtraceDumperChildTest::SetUp();
+}
+
+void LinuxPtraceDumperCopyTest::TearDown() {
+  munmap(mapping_, page_size_);
+  munmap(mapping_ + 2 * page_size_, page_size_);
+}
+
+TEST_F(LinuxPtraceDumperCopyTest, CopiesWholePage) {
+  LinuxPtraceDumper dumper(getppid());
+  ASSERT_TRUE(dumper.Init());
+
+  std::vector<uint8_t> copy(page_size_, 0);
+  EXPECT_TRUE(dumper.CopyFromProcess(&copy[0], getppid(), mapping_,
+                                     page_size_));
+  for (size_t i = 0; i < page_size_; ++i)
+    ASSERT_EQ(Pattern(i), copy[i]) << "at offset " << i;
+}
+
+TEST_F(LinuxPtraceDumperCopyTest, ZeroesUnmappedPage) {
+  LinuxPtraceDumper dumper(getppid());
+  ASSERT_TRUE(dumper.Init());
+
+  // Copy from a little before the unmapped page to a little after it.
+  const size_t kStart = page_size_ - 20;
+  const size_t kLength = page_size_ + 40;
+  std::vector<uint8_t> copy(kLength, 0xff);
+  EXPECT_TRUE(dumper.CopyFromProcess(&copy[0], getppid(), mapping_ + kStart,
+                                     kLength));
+  for (size_t i = 0; i < kLength; ++i) {
+    const size_t offset = kStart + i;
+    const bool mapped = offset < page_size_ || offset >= 2 * page_size_;
+    ASSERT_EQ(mapped ? Pattern(offset) : 0, copy[i]) << "at offset " << offset;
+  }
+}
+
+TEST_F(LinuxPtraceDumperCopyTest, UntracedCopyReportsUnmappedPage) {
+  LinuxPtraceDumper dumper(getppid());
+  ASSERT_TRUE(dumper.Init());
+  ASSERT_TRUE(dumper.PrepareForConcurrentCopies());
+
+  std::vector<uint8_t> copy(page_size_, 0);
+  EXPECT_TRUE(dumper.CopyFromProcessUntraced(&copy[0], getppid(), mapping_,
+                                             page_size_));
+  for (size_t i = 0; i < page_size_; ++i)
+    ASSERT_EQ(Pattern(i), copy[i]) << "at offset " << i;
+
+  // The tracer is left to copy ranges with pages that cannot be read.
+  EXPECT_FALSE(dumper.CopyFromProcessUntraced(&copy[0], getppid(),
+                                              mapping_ + page_size_ / 2,
+                                              page_size_));
+}
+
 TEST_F(LinuxPtraceDumperChildTest, BuildProcPath) {
   const pid_t pid = getppid();
   LinuxPtraceDumper dumper(pid);
@@ -588,3 +667,91 @@ TEST_F(LinuxPtraceDumperTest, SanitizeStackCopy) {
   ASSERT_TRUE(WIFSIGNALED(status));
   ASSERT_EQ(SIGKILL, WTERMSIG(status));
 }
+
+// Stacks longer than a block are checked a block of words at a time, with
+// the words that are left over checked one by one; every word should be
+// treated as it would be on its own, wherever it falls.
+TEST_F(LinuxPtraceDumperTest, SanitizeLongStackCopy) {
+  static const size_t kNumberOfThreadsInHelperProgram = 1;
+
+  pid_t child_pid = SetupChildProcess(kNumberOfThreadsInHelperProgram);
+  ASSERT_NE(child_pid, -1);
+
+  LinuxPtraceDumper dumper(child_pid);
+  ASSERT_TRUE(dumper.Init());
+  EXPECT_TRUE(dumper.ThreadsSuspend());
+
+  ThreadInfo thread_info;
+  EXPECT_TRUE(dumper.GetThreadInfoByIndex(0, &thread_info));
+
+  const uintptr_t defaced =
+#if defined(__LP64__)
+      0x0defaced0defaced;
+#else
+      0x0defaced;
+#endif
+  const uintptr_t code_pointer = thread_info.GetInstructionPointer();
+  const MappingInfo* code_mapping = dumper.FindMappingNoBias(code_pointer);
+  ASSERT_NE(code_mapping, nullptr);
+  const uintptr_t code_end = code_mapping->system_mapping_info.end_addr;
+  const uintptr_t kept[] = {
+    0, 4096, static_cast<uintptr_t>(-4096), thread_info.stack_pointer,
+    code_pointer, code_mapping->system_mapping_info.start_addr, code_end - 1
+  };
+  const uintptr_t sanitized[] = {
+    4097, static_cast<uintptr_t>(-4097), static_cast<uintptr_t>(0x6867666564636261ULL)
+  };
+
+  // Try each value in each position of a stack of several blocks and a
+  // few words more, both with and without a word below the stack pointer
+  // and a partial word at the top.
+  const size_t kWords = 19;
+  uintptr_t simulated_stack[kWords + 1];
+  for (size_t sp_offset = 0; sp_offset <= sizeof(uintptr_t);
+       sp_offset += sizeof(uintptr_t)) {
+    for (size_t position = sp_offset / sizeof(uintptr_t); position < kWords;
+         ++position) {
+      for (uintptr_t value : kept) {
+        memset(simulated_stack, 0, sizeof(simulated_stack));
+        simulated_stack[position] = value;
+        dumper.SanitizeStackCopy(reinterpret_cast<uint8_t*>(&simulated_stack),
+                                 kWords * sizeof(uintptr_t) + 3,
+                                 thread_info.stack_pointer, sp_offset);
+        ASSERT_EQ(value, simulated_stack[position]);
+      }
+      for (uintptr_t value : sanitized) {
+        memset(simulated_stack, 0, sizeof(simulated_stack));
+        simulated_stack[position] = value;
+        // A pointer into the code mapping in the same block shouldn't
+        // change the outcome for the others.
+        simulated_stack[position ^ 1] = code_pointer;
+        dumper.SanitizeStackCopy(reinterpret_cast<uint8_t*>(&simulated_stack),
+                                 kWords * sizeof(uintptr_t) + 3,
+                                 thread_info.stack_pointer, sp_offset);
+        ASSERT_EQ(defaced, simulated_stack[position]);
+      }
+      // The partial word at the top is cleared.
+      uint8_t* top = reinterpret_cast<uint8_t*>(&simulated_stack[kWords]);
+      EXPECT_EQ(0, top[0] | top[1] | top[2]);
+
+      memset(simulated_stack, 0, sizeof(simulated_stack));
+      simulated_stack[position] = code_end - 1;
+      EXPECT_TRUE(dumper.StackHasPointerToMapping(
+          reinterpret_cast<uint8_t*>(&simulated_stack),
+          kWords * sizeof(uintptr_t), sp_offset, *code_mapping));
+      simulated_stack[position] = code_end + 1;
+      EXPECT_FALSE(dumper.StackHasPointerToMapping(
+          reinterpret_cast<uint8_t*>(&simulated_stack),
+          kWords * sizeof(uintptr_t), sp_offset, *code_mapping));
+    }
+  }
+
+  EXPECT_TRUE(dumper.ThreadsResume());
+  kill(child_pid, SIGKILL);
+
+  // Reap child.
+  int status;
+  ASSERT_NE(-1, HANDLE_EINTR(waitpid(child_pid, &status, 0)));
+  ASSERT_TRUE(WIFSIGNALED(status));
+  ASSERT_EQ(SIGKILL, WTERMSIG(status));
+}
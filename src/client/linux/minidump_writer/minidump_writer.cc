@@ -54,6 +54,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <link.h>
+#include <sched.h>
 #include <stdio.h>
 #if defined(__ANDROID__)
 #include <sys/system_properties.h>
@@ -71,13 +72,18 @@
 #include "client/linux/dump_writer_common/ucontext_reader.h"
 #include "client/linux/handler/exception_handler.h"
 #include "client/linux/minidump_writer/cpu_set.h"
+#include "client/linux/minidump_writer/dump_timings.h"
 #include "client/linux/minidump_writer/line_reader.h"
 #include "client/linux/minidump_writer/linux_dumper.h"
 #include "client/linux/minidump_writer/linux_ptrace_dumper.h"
 #include "client/linux/minidump_writer/pe_file.h"
 #include "client/linux/minidump_writer/pe_structs.h"
 #include "client/linux/minidump_writer/proc_cpuinfo_reader.h"
+#include "client/linux/minidump_writer/warm_dump_state.h"
+#include "client/breadcrumb_writer.h"
+#include "client/crashpad_info_writer.h"
 #include "client/minidump_file_writer.h"
+#include "common/linux/eintr_wrapper.h"
 #include "common/linux/file_id.h"
 #include "common/linux/linux_libc_support.h"
 #include "common/minidump_type_helper.h"
@@ -87,10 +93,13 @@
 namespace {
 
 using google_breakpad::AppMemoryList;
+using google_breakpad::BreadcrumbBuffer;
 using google_breakpad::auto_wasteful_vector;
 using google_breakpad::elf::kDefaultBuildIdSize;
 using google_breakpad::ExceptionHandler;
+using google_breakpad::ConcurrentStringDictionary;
 using google_breakpad::CpuSet;
+using google_breakpad::DumpTimings;
 using google_breakpad::LineReader;
 using google_breakpad::LinuxDumper;
 using google_breakpad::LinuxPtraceDumper;
@@ -105,10 +114,12 @@ using google_breakpad::PEFileFormat;
 using google_breakpad::ProcCpuInfoReader;
 using google_breakpad::RawContextCPU;
 using google_breakpad::RSDS_DEBUG_FORMAT;
+using google_breakpad::ScopedDumpTimer;
 using google_breakpad::ThreadInfo;
 using google_breakpad::TypedMDRVA;
 using google_breakpad::UContextReader;
 using google_breakpad::UntypedMDRVA;
+using google_breakpad::WarmDumpState;
 using google_breakpad::wasteful_vector;
 
 typedef MDTypeHelper<sizeof(void*)>::MDRawDebug MDRawDebug;
@@ -132,6 +143,22 @@ class MinidumpWriter {
   // (exclude the stack data).
   static const unsigned kLimitMinidumpFudgeFactor = 64 * 1024;
 
+  // The most tasks that thread stacks are captured on at once.
+  static const unsigned kMaxStackCaptureTasks = 16;
+  // The stack size of each of those tasks.
+  static const unsigned kStackCaptureTaskStackSize = 16000;
+
+  // The number of bytes around the crashing instruction pointer to dump.
+  static const size_t kIPMemorySize = 256;
+  // The number of bytes around each heap address found on the crashing
+  // thread's stack to dump, when there is a memory budget.
+  static const size_t kPointedMemorySize = 256;
+  // The most heap ranges that are dumped for those addresses.
+  static const unsigned kMaxPointedMemoryRanges = 512;
+  // The number of bytes below the stack pointer that a stack sample takes
+  // in, which leaf functions may use without moving it.
+  static const uintptr_t kStackSampleRedZone = 128;
+
   MinidumpWriter(const char* minidump_path,
                  int minidump_fd,
                  const ExceptionHandler::CrashContext* context,
@@ -149,6 +176,19 @@ class MinidumpWriter {
 #endif
         dumper_(dumper),
         minidump_size_limit_(-1),
+        stack_capture_tasks_(1),
+        write_from_snapshot_(false),
+        memory_budget_(0),
+        timings_(NULL),
+        annotations_(NULL),
+        breadcrumbs_(NULL),
+        stack_sample_size_(0),
+        live_(false),
+        suspend_ns_(0),
+        resume_ns_(0),
+        stack_budgets_(NULL),
+        app_memory_budget_(0),
+        pointed_memory_(dumper_->allocator()),
         memory_blocks_(dumper_->allocator()),
         mapping_list_(mappings),
         app_memory_list_(appmem),
@@ -166,6 +206,8 @@ class MinidumpWriter {
     if (!dumper_->Init())
       return false;
 
+    if (live_)
+      suspend_ns_ = DumpTimings::Now();
     if (!dumper_->ThreadsSuspend() || !dumper_->LateInit())
       return false;
 
@@ -228,6 +270,14 @@ class MinidumpWriter {
     // A minidump file contains a number of tagged streams. This is the number
     // of stream which we write.
     unsigned kNumWriters = 13;
+    if (annotations_)
+      ++kNumWriters;
+    if (breadcrumbs_)
+      ++kNumWriters;
+    if (timings_)
+      ++kNumWriters;
+    if (live_)
+      ++kNumWriters;
 
     TypedMDRVA<MDRawDirectory> dir(&minidump_writer_);
     {
@@ -249,48 +299,41 @@ class MinidumpWriter {
       header.get()->stream_count = kNumWriters;
       header.get()->stream_directory_rva = dir.position();
     }
+    // The writer buffers its output, so push the header out now.
+    if (!minidump_writer_.Flush())
+      return false;
 
     unsigned dir_index = 0;
     MDRawDirectory dirent;
 
-    if (!WriteThreadListStream(&dirent))
-      return false;
-    dir.CopyIndex(dir_index++, &dirent);
-
-    if (!WriteMappings(&dirent))
-      return false;
-    dir.CopyIndex(dir_index++, &dirent);
-
-    if (!WriteAppMemory())
-      return false;
-
-    if (!WriteMemoryListStream(&dirent))
-      return false;
-    dir.CopyIndex(dir_index++, &dirent);
-
-    if (!WriteExceptionStream(&dirent))
-      return false;
+    {
+      ScopedDumpTimer timer(timings_, MD_DUMP_TIMING_THREAD_LIST);
+      if (!WriteThreadListStream(&dirent))
+        return false;
+    }
     dir.CopyIndex(dir_index++, &dirent);
 
-    if (!WriteSystemInfoStream(&dirent))
-      return false;
-    dir.CopyIndex(dir_index++, &dirent);
+    // A sample has all that it needs from the stopped threads.
+    if (stack_sample_size_)
+      dumper_->ThreadsResume();
 
-    dirent.stream_type = MD_LINUX_CPU_INFO;
-    if (!WriteFile(&dirent.location, "/proc/cpuinfo"))
-      NullifyDirectoryEntry(&dirent);
-    dir.CopyIndex(dir_index++, &dirent);
+    // So has a live dump, which reads the rest from the running process.
+    if (live_) {
+      ResumeLive();
+      if (!WriteLiveDumpStream(&dirent, dir_index))
+        NullifyDirectoryEntry(&dirent);
+      dir.CopyIndex(dir_index++, &dirent);
+    }
 
+    // The streams that need the process itself come first, so that with
+    // |write_from_snapshot_| it can be released before the rest.
+    if (timings_)
+      timings_->Begin(MD_DUMP_TIMING_PROC_FILES);
     dirent.stream_type = MD_LINUX_PROC_STATUS;
     if (!WriteProcFile(&dirent.location, GetCrashThread(), "status"))
       NullifyDirectoryEntry(&dirent);
     dir.CopyIndex(dir_index++, &dirent);
 
-    dirent.stream_type = MD_LINUX_LSB_RELEASE;
-    if (!WriteFile(&dirent.location, "/etc/lsb-release"))
-      NullifyDirectoryEntry(&dirent);
-    dir.CopyIndex(dir_index++, &dirent);
-
     dirent.stream_type = MD_LINUX_CMD_LINE;
     if (!WriteProcFile(&dirent.location, GetCrashThread(), "cmdline"))
       NullifyDirectoryEntry(&dirent);
@@ -310,17 +353,107 @@ class MinidumpWriter {
     if (!WriteProcFile(&dirent.location, GetCrashThread(), "maps"))
       NullifyDirectoryEntry(&dirent);
     dir.CopyIndex(dir_index++, &dirent);
+    if (timings_)
+      timings_->End(MD_DUMP_TIMING_PROC_FILES);
+
+    if (write_from_snapshot_ && ReleaseProcess())
+      return true;
+
+    {
+      ScopedDumpTimer timer(timings_, MD_DUMP_TIMING_MODULE_LIST);
+      if (!WriteMappings(&dirent))
+        return false;
+    }
+    dir.CopyIndex(dir_index++, &dirent);
+
+    {
+      ScopedDumpTimer timer(timings_, MD_DUMP_TIMING_MEMORY_LIST);
+      if (!stack_sample_size_ && !WriteExtraMemory())
+        return false;
+
+      if (!WriteMemoryListStream(&dirent))
+        return false;
+    }
+    dir.CopyIndex(dir_index++, &dirent);
+
+    if (timings_)
+      timings_->Begin(MD_DUMP_TIMING_OTHER_STREAMS);
+
+    if (!WriteExceptionStream(&dirent))
+      return false;
+    dir.CopyIndex(dir_index++, &dirent);
+
+    if (!WriteSystemInfoStream(&dirent))
+      return false;
+    dir.CopyIndex(dir_index++, &dirent);
+
+    dirent.stream_type = MD_LINUX_CPU_INFO;
+    if (!WriteFile(&dirent.location, "/proc/cpuinfo"))
+      NullifyDirectoryEntry(&dirent);
+    dir.CopyIndex(dir_index++, &dirent);
+
+    dirent.stream_type = MD_LINUX_LSB_RELEASE;
+    if (!WriteFile(&dirent.location, "/etc/lsb-release"))
+      NullifyDirectoryEntry(&dirent);
+    dir.CopyIndex(dir_index++, &dirent);
 
     dirent.stream_type = MD_LINUX_DSO_DEBUG;
     if (!WriteDSODebugStream(&dirent))
       NullifyDirectoryEntry(&dirent);
     dir.CopyIndex(dir_index++, &dirent);
+    if (timings_)
+      timings_->End(MD_DUMP_TIMING_OTHER_STREAMS);
+
+    dumper_->ThreadsResume();
+
+    if (annotations_) {
+      if (!WriteCrashpadInfoStream(&minidump_writer_, *annotations_,
+                                   &dirent))
+        NullifyDirectoryEntry(&dirent);
+      dir.CopyIndex(dir_index++, &dirent);
+    }
+
+    if (breadcrumbs_) {
+      if (!WriteBreadcrumbStream(&minidump_writer_, *breadcrumbs_, &dirent))
+        NullifyDirectoryEntry(&dirent);
+      dir.CopyIndex(dir_index++, &dirent);
+    }
+
+    // The timing stream comes last, so that it covers the rest.
+    if (timings_) {
+      if (!WriteDumpTimingStream(&dirent))
+        NullifyDirectoryEntry(&dirent);
+      dir.CopyIndex(dir_index++, &dirent);
+    }
 
     // If you add more directory entries, don't forget to update kNumWriters,
     // above.
 
+    ScopedDumpTimer timer(timings_, MD_DUMP_TIMING_FILE_WRITE);
+    // A minidump for a pipe or socket, or one to be compressed, is only
+    // written out when it is complete.
+    if (minidump_writer_.streaming())
+      return minidump_writer_.Close();
+    return minidump_writer_.Flush();
+  }
+
+  // Resumes the threads and forks, so that the dumped process can carry on
+  // once this process exits, and the rest of the minidump is written by the
+  // fork. This process, and so the fork, are copies of the dumped process
+  // made while it was stopped, so the fork reads the memory from its own.
+  // Returns true in the process that is to stop writing, which is this
+  // one unless the dumper cannot read a snapshot or the fork failed.
+  bool ReleaseProcess() {
+    if (!dumper_->ReadFromSnapshot() || !minidump_writer_.Flush())
+      return false;
     dumper_->ThreadsResume();
-    return true;
+
+    if (sys_fork() > 0) {
+      // The fork shares the file, and finishes it.
+      minidump_writer_.Abandon();
+      return true;
+    }
+    return false;
   }
 
   bool FillThreadStack(MDRawThread* thread, uintptr_t stack_pointer,
@@ -329,59 +462,252 @@ class MinidumpWriter {
     const void* stack;
     size_t stack_len;
 
-    thread->stack.start_of_memory_range = stack_pointer;
-    thread->stack.memory.data_size = 0;
-    thread->stack.memory.rva = minidump_writer_.position();
+    ClearThreadStack(thread, stack_pointer);
 
-    if (dumper_->GetStackInfo(&stack, &stack_len, stack_pointer)) {
-      if (max_stack_len >= 0 &&
-          stack_len > static_cast<unsigned int>(max_stack_len)) {
-        stack_len = max_stack_len;
-        // Skip empty chunks of length max_stack_len.
-        uintptr_t int_stack = reinterpret_cast<uintptr_t>(stack);
-        if (max_stack_len > 0) {
-          while (int_stack + max_stack_len < stack_pointer) {
-            int_stack += max_stack_len;
-          }
-        }
-        stack = reinterpret_cast<const void*>(int_stack);
-      }
+    if (GetStackRange(stack_pointer, max_stack_len, &stack, &stack_len)) {
       *stack_copy = reinterpret_cast<uint8_t*>(Alloc(stack_len));
       dumper_->CopyFromProcess(*stack_copy, thread->thread_id, stack,
                                stack_len);
+      if (!PrepareStackCopy(*stack_copy, stack, stack_len, stack_pointer, pc))
+        return true;
+      return WriteStackCopy(thread, *stack_copy, stack, stack_len);
+    }
+    return true;
+  }
 
-      uintptr_t stack_pointer_offset =
-          stack_pointer - reinterpret_cast<uintptr_t>(stack);
-      if (skip_stacks_if_mapping_unreferenced_) {
-        if (!principal_mapping_) {
-          return true;
-        }
-        uintptr_t low_addr = principal_mapping_->system_mapping_info.start_addr;
-        uintptr_t high_addr = principal_mapping_->system_mapping_info.end_addr;
-        if ((pc < low_addr || pc > high_addr) &&
-            !dumper_->StackHasPointerToMapping(*stack_copy, stack_len,
-                                               stack_pointer_offset,
-                                               *principal_mapping_)) {
-          return true;
+  // Records an empty stack for |thread| at |stack_pointer|.
+  void ClearThreadStack(MDRawThread* thread, uintptr_t stack_pointer) {
+    thread->stack.start_of_memory_range = stack_pointer;
+    thread->stack.memory.data_size = 0;
+    thread->stack.memory.rva = minidump_writer_.position();
+  }
+
+  // Finds the part of the stack containing |stack_pointer| that is dumped,
+  // limited to |max_stack_len| bytes unless that is negative, and to the
+  // sample from the stack pointer when sampling. Returns false
+  // if |stack_pointer| is not in a stack, or none of it is to be dumped.
+  bool GetStackRange(uintptr_t stack_pointer, int max_stack_len,
+                     const void** stack, size_t* stack_len) {
+    if (max_stack_len == 0 ||
+        !dumper_->GetStackInfo(stack, stack_len, stack_pointer))
+      return false;
+
+    if (stack_sample_size_) {
+      // Sample from just below the stack pointer, taking in the red zone.
+      uintptr_t int_stack = reinterpret_cast<uintptr_t>(*stack);
+      const uintptr_t stack_end = int_stack + *stack_len;
+      if (stack_pointer > int_stack + kStackSampleRedZone)
+        int_stack = (stack_pointer - kStackSampleRedZone) & ~uintptr_t(15);
+      *stack = reinterpret_cast<const void*>(int_stack);
+      *stack_len = std::min(stack_end - int_stack, stack_sample_size_);
+    }
+
+    if (max_stack_len >= 0 &&
+        *stack_len > static_cast<unsigned int>(max_stack_len)) {
+      *stack_len = max_stack_len;
+      // Skip empty chunks of length max_stack_len.
+      uintptr_t int_stack = reinterpret_cast<uintptr_t>(*stack);
+      if (max_stack_len > 0) {
+        while (int_stack + max_stack_len < stack_pointer) {
+          int_stack += max_stack_len;
         }
       }
+      *stack = reinterpret_cast<const void*>(int_stack);
+    }
+    return true;
+  }
 
-      if (sanitize_stacks_) {
-        dumper_->SanitizeStackCopy(*stack_copy, stack_len, stack_pointer,
-                                   stack_pointer_offset);
+  // Decides whether |stack_copy|, a copy of the |stack_len| bytes at
+  // |stack|, is written to the dump, and sanitizes it if it is and that was
+  // requested. Only reads the dumper's mappings, so it may run on several
+  // tasks at once.
+  bool PrepareStackCopy(uint8_t* stack_copy, const void* stack,
+                        size_t stack_len, uintptr_t stack_pointer,
+                        uintptr_t pc) {
+    uintptr_t stack_pointer_offset =
+        stack_pointer - reinterpret_cast<uintptr_t>(stack);
+    if (skip_stacks_if_mapping_unreferenced_) {
+      if (!principal_mapping_) {
+        return false;
       }
-
-      UntypedMDRVA memory(&minidump_writer_);
-      if (!memory.Allocate(stack_len))
+      uintptr_t low_addr = principal_mapping_->system_mapping_info.start_addr;
+      uintptr_t high_addr = principal_mapping_->system_mapping_info.end_addr;
+      if ((pc < low_addr || pc > high_addr) &&
+          !dumper_->StackHasPointerToMapping(stack_copy, stack_len,
+                                             stack_pointer_offset,
+                                             *principal_mapping_)) {
         return false;
-      memory.Copy(*stack_copy, stack_len);
-      thread->stack.start_of_memory_range = reinterpret_cast<uintptr_t>(stack);
-      thread->stack.memory = memory.location();
-      memory_blocks_.push_back(thread->stack);
+      }
     }
+
+    if (sanitize_stacks_) {
+      dumper_->SanitizeStackCopy(stack_copy, stack_len, stack_pointer,
+                                 stack_pointer_offset);
+    }
+    return true;
+  }
+
+  // Writes |stack_copy| to the dump as the stack of |thread|.
+  bool WriteStackCopy(MDRawThread* thread, const uint8_t* stack_copy,
+                      const void* stack, size_t stack_len) {
+    UntypedMDRVA memory(&minidump_writer_);
+    if (!memory.Allocate(stack_len))
+      return false;
+    memory.Copy(stack_copy, stack_len);
+    thread->stack.start_of_memory_range = reinterpret_cast<uintptr_t>(stack);
+    thread->stack.memory = memory.location();
+    memory_blocks_.push_back(thread->stack);
     return true;
   }
 
+  // A thread's registers and stack, gathered ahead of writing the thread
+  // list when stacks are captured by several tasks.
+  struct ThreadCapture {
+    ThreadInfo info;
+    // Whether |info| could be read.
+    bool have_info;
+    // The part of the stack to dump, or NULL if there is none.
+    const void* stack;
+    size_t stack_len;
+    uint8_t* stack_copy;
+    // Whether a capture task could not copy the whole stack, which is
+    // then copied by the task that suspended the threads.
+    bool copy_failed;
+    // Whether |stack_copy| is written to the dump.
+    bool write_stack;
+  };
+
+  // The share of the stacks that one capture task copies: every
+  // |stride|th thread, starting with the |first|.
+  struct CaptureTask {
+    MinidumpWriter* writer;
+    ThreadCapture* captures;
+    unsigned first;
+    unsigned stride;
+  };
+
+  // Entry point of the tasks cloned by CaptureThreads.
+  static int CaptureTaskEntry(void* arg) {
+    CaptureTask* task = reinterpret_cast<CaptureTask*>(arg);
+    task->writer->CaptureStacks(*task);
+    return 0;
+  }
+
+  void CaptureStacks(const CaptureTask& task) {
+    const unsigned num_threads = dumper_->threads().size();
+    for (unsigned i = task.first; i < num_threads; i += task.stride) {
+      ThreadCapture* capture = &task.captures[i];
+      if (!capture->stack_copy)
+        continue;
+      if (!dumper_->CopyFromProcessUntraced(capture->stack_copy,
+                                            dumper_->threads()[i],
+                                            capture->stack,
+                                            capture->stack_len)) {
+        capture->copy_failed = true;
+        continue;
+      }
+      capture->write_stack =
+          PrepareStackCopy(capture->stack_copy, capture->stack,
+                           capture->stack_len, capture->info.stack_pointer,
+                           capture->info.GetInstructionPointer());
+    }
+  }
+
+  // When more than one stack capture task was asked for, reads the
+  // registers of every thread but the one whose context came from the
+  // signal handler, then copies and prepares their stacks on that many
+  // tasks at once. Registers are read first, here, as only the task that
+  // attached to the threads can read them; for the same reason, stacks the
+  // tasks could not copy whole are copied here afterwards, one by one,
+  // with PTRACE_PEEKDATA to hand. Returns NULL if the threads are
+  // to be captured one by one as the thread list is written, otherwise an
+  // array with an entry for each thread.
+  ThreadCapture* CaptureThreads(int extra_thread_stack_len) {
+    const unsigned num_threads = dumper_->threads().size();
+    if (stack_capture_tasks_ < 2 || num_threads < 2 ||
+        !dumper_->PrepareForConcurrentCopies())
+      return NULL;
+
+    ThreadCapture* captures = reinterpret_cast<ThreadCapture*>(
+        Alloc(num_threads * sizeof(ThreadCapture)));
+    if (!captures)
+      return NULL;
+
+    for (unsigned i = 0; i < num_threads; ++i) {
+      ThreadCapture* capture = &captures[i];
+      my_memset(capture, 0, sizeof(*capture));
+      if (dumper_->threads()[i] == GetCrashThread() && ucontext_ &&
+          !dumper_->IsPostMortem())
+        continue;
+      capture->have_info = dumper_->GetThreadInfoByIndex(i, &capture->info);
+      if (!capture->have_info)
+        continue;
+
+      const int max_stack_len = MaxStackLen(i, extra_thread_stack_len);
+      if (GetStackRange(capture->info.stack_pointer, max_stack_len,
+                        &capture->stack, &capture->stack_len)) {
+        capture->stack_copy =
+            reinterpret_cast<uint8_t*>(Alloc(capture->stack_len));
+      }
+    }
+
+    unsigned task_count = static_cast<unsigned>(stack_capture_tasks_);
+    if (task_count > kMaxStackCaptureTasks)
+      task_count = kMaxStackCaptureTasks;
+    if (task_count > num_threads)
+      task_count = num_threads;
+    CaptureTask tasks[kMaxStackCaptureTasks];
+    pid_t children[kMaxStackCaptureTasks];
+    for (unsigned i = 0; i < task_count; ++i) {
+      tasks[i].writer = this;
+      tasks[i].captures = captures;
+      tasks[i].first = i;
+      tasks[i].stride = task_count;
+      children[i] = -1;
+      // This task takes the first share.
+      if (i == 0)
+        continue;
+
+      uint8_t* stack =
+          reinterpret_cast<uint8_t*>(Alloc(kStackCaptureTaskStackSize));
+      if (!stack)
+        continue;
+      // clone() needs the top-most address. (scrub just to be safe)
+      stack += kStackCaptureTaskStackSize;
+      my_memset(stack - 16, 0, 16);
+      children[i] = sys_clone(CaptureTaskEntry, stack,
+                              CLONE_VM | CLONE_FS | CLONE_FILES |
+                                  CLONE_UNTRACED,
+                              &tasks[i], NULL, NULL, NULL);
+    }
+
+    // Copy this task's share, and that of any task that couldn't be
+    // started.
+    for (unsigned i = 0; i < task_count; ++i) {
+      if (children[i] == -1)
+        CaptureStacks(tasks[i]);
+    }
+    for (unsigned i = 0; i < task_count; ++i) {
+      if (children[i] != -1) {
+        int status;
+        HANDLE_EINTR(sys_waitpid(children[i], &status, __WALL));
+      }
+    }
+
+    for (unsigned i = 0; i < num_threads; ++i) {
+      ThreadCapture* capture = &captures[i];
+      if (!capture->copy_failed)
+        continue;
+      dumper_->CopyFromProcess(capture->stack_copy, dumper_->threads()[i],
+                               capture->stack, capture->stack_len);
+      capture->write_stack =
+          PrepareStackCopy(capture->stack_copy, capture->stack,
+                           capture->stack_len, capture->info.stack_pointer,
+                           capture->info.GetInstructionPointer());
+    }
+    return captures;
+  }
+
   // Write information about the threads.
   bool WriteThreadListStream(MDRawDirectory* dirent) {
     const unsigned num_threads = dumper_->threads().size();
@@ -410,6 +736,11 @@ class MinidumpWriter {
         extra_thread_stack_len = kLimitMaxExtraThreadStackLen;
     }
 
+    if (memory_budget_ && !PlanMemoryBudget())
+      return false;
+
+    ThreadCapture* const captures = CaptureThreads(extra_thread_stack_len);
+
     for (unsigned i = 0; i < num_threads; ++i) {
       MDRawThread thread;
       my_memset(&thread, 0, sizeof(thread));
@@ -426,11 +757,11 @@ class MinidumpWriter {
         const uintptr_t stack_ptr = UContextReader::GetStackPointer(ucontext_);
         if (!FillThreadStack(&thread, stack_ptr,
                              UContextReader::GetInstructionPointer(ucontext_),
-                             -1, &stack_copy))
+                             MaxStackLen(i, -1), &stack_copy))
           return false;
 
-        // Copy 256 bytes around crashing instruction pointer to minidump.
-        const size_t kIPMemorySize = 256;
+        // Copy kIPMemorySize bytes around crashing instruction pointer to
+        // minidump.
         uint64_t ip = UContextReader::GetInstructionPointer(ucontext_);
         // Bound it to the upper and lower bounds of the memory map
         // it's contained within. If it's not in mapped memory,
@@ -456,21 +787,14 @@ class MinidumpWriter {
           }
         }
 
-        if (ip_is_mapped) {
-          UntypedMDRVA ip_memory(&minidump_writer_);
-          if (!ip_memory.Allocate(ip_memory_d.memory.data_size))
-            return false;
-          uint8_t* memory_copy =
-              reinterpret_cast<uint8_t*>(Alloc(ip_memory_d.memory.data_size));
-          dumper_->CopyFromProcess(
-              memory_copy,
-              thread.thread_id,
-              reinterpret_cast<void*>(ip_memory_d.start_of_memory_range),
-              ip_memory_d.memory.data_size);
-          ip_memory.Copy(memory_copy, ip_memory_d.memory.data_size);
-          ip_memory_d.memory = ip_memory.location();
-          memory_blocks_.push_back(ip_memory_d);
-        }
+        // A crash that jumped into the stack has the IP in memory that
+        // was just written, which is left out rather than dumped twice.
+        if (ip_is_mapped &&
+            !WriteUncoveredMemory(
+                thread.thread_id, ip_memory_d.start_of_memory_range,
+                ip_memory_d.start_of_memory_range +
+                    ip_memory_d.memory.data_size))
+          return false;
 
         TypedMDRVA<RawContextCPU> cpu(&minidump_writer_);
         if (!cpu.Allocate())
@@ -483,64 +807,341 @@ class MinidumpWriter {
 #endif
         thread.thread_context = cpu.location();
         crashing_thread_context_ = cpu.location();
+      } else if (captures) {
+        const ThreadCapture& capture = captures[i];
+        if (!capture.have_info)
+          return false;
+
+        ClearThreadStack(&thread, capture.info.stack_pointer);
+        if (capture.write_stack &&
+            !WriteStackCopy(&thread, capture.stack_copy, capture.stack,
+                            capture.stack_len))
+          return false;
+
+        if (!WriteThreadContext(&thread, capture.info))
+          return false;
       } else {
         ThreadInfo info;
         if (!dumper_->GetThreadInfoByIndex(i, &info))
           return false;
 
         uint8_t* stack_copy;
-        int max_stack_len = -1;  // default to no maximum for this thread
-        if (minidump_size_limit_ >= 0 && i >= kLimitBaseThreadCount)
-          max_stack_len = extra_thread_stack_len;
+        const int max_stack_len = MaxStackLen(i, extra_thread_stack_len);
         if (!FillThreadStack(&thread, info.stack_pointer,
                              info.GetInstructionPointer(), max_stack_len,
                              &stack_copy))
           return false;
 
-        TypedMDRVA<RawContextCPU> cpu(&minidump_writer_);
-        if (!cpu.Allocate())
+        if (!WriteThreadContext(&thread, info))
           return false;
-        my_memset(cpu.get(), 0, sizeof(RawContextCPU));
-        info.FillCPUContext(cpu.get());
-        thread.thread_context = cpu.location();
-        if (dumper_->threads()[i] == GetCrashThread()) {
-          crashing_thread_context_ = cpu.location();
-          if (!dumper_->IsPostMortem()) {
-            // This is the crashing thread of a live process, but
-            // no context was provided, so set the crash address
-            // while the instruction pointer is already here.
-            dumper_->set_crash_address(info.GetInstructionPointer());
+      }
+
+      list.CopyIndexAfterObject(i, &thread, sizeof(thread));
+    }
+
+    return true;
+  }
+
+  // Returns the most bytes of the stack of the |index|-th thread to dump,
+  // or -1 for no maximum. Beyond the first kLimitBaseThreadCount threads,
+  // |extra_thread_stack_len| applies when there is a size limit.
+  int MaxStackLen(unsigned index, int extra_thread_stack_len) const {
+    int max_stack_len = -1;  // default to no maximum for this thread
+    if (minidump_size_limit_ >= 0 && index >= kLimitBaseThreadCount)
+      max_stack_len = extra_thread_stack_len;
+    if (stack_budgets_ && stack_budgets_[index] >= 0 &&
+        (max_stack_len < 0 || stack_budgets_[index] < max_stack_len))
+      max_stack_len = stack_budgets_[index];
+    return max_stack_len;
+  }
+
+  // Shares |memory_budget_| out between the memory that may be dumped, in
+  // order of priority, each getting what it needs while the budget lasts:
+  //  1. the memory around the crashing instruction pointer, which is always
+  //     dumped, and the crashing thread's stack;
+  //  2. the heap memory around the addresses found on that stack, unless
+  //     stacks are sanitized;
+  //  3. |app_memory_list_|, in order;
+  //  4. the other threads' stacks, in order.
+  // Sets |stack_budgets_|, |pointed_memory_| and |app_memory_budget_|.
+  // The memory list, module list and other streams are not counted.
+  bool PlanMemoryBudget() {
+    const unsigned num_threads = dumper_->threads().size();
+    stack_budgets_ = reinterpret_cast<int*>(Alloc(num_threads * sizeof(int)));
+    uintptr_t* const stack_pointers =
+        reinterpret_cast<uintptr_t*>(Alloc(num_threads * sizeof(uintptr_t)));
+    if (!stack_budgets_ || !stack_pointers)
+      return false;
+
+    unsigned crash_index = num_threads;
+    for (unsigned i = 0; i < num_threads; ++i) {
+      stack_budgets_[i] = 0;
+      stack_pointers[i] = 0;
+      const bool is_crash_thread = dumper_->threads()[i] == GetCrashThread();
+      if (is_crash_thread)
+        crash_index = i;
+      ThreadInfo info;
+      if (is_crash_thread && ucontext_ && !dumper_->IsPostMortem())
+        stack_pointers[i] = UContextReader::GetStackPointer(ucontext_);
+      else if (dumper_->GetThreadInfoByIndex(i, &info))
+        stack_pointers[i] = info.stack_pointer;
+    }
+
+    size_t budget_left = memory_budget_;
+    const void* stack;
+    size_t stack_len;
+    if (crash_index < num_threads) {
+      budget_left = budget_left > kIPMemorySize ?
+          budget_left - kIPMemorySize : 0;
+      if (GetStackRange(stack_pointers[crash_index], -1, &stack,
+                        &stack_len)) {
+        stack_len = std::min(stack_len, budget_left);
+        stack_budgets_[crash_index] = stack_len;
+        budget_left -= stack_len;
+        if (stack_len && !sanitize_stacks_) {
+          budget_left = PlanPointedMemory(stack, stack_len, stack_pointers,
+                                          num_threads, budget_left);
+        }
+      }
+    }
+
+    app_memory_budget_ = 0;
+    for (AppMemoryList::const_iterator iter = app_memory_list_.begin();
+         iter != app_memory_list_.end(); ++iter) {
+      app_memory_budget_ += iter->length;
+    }
+    app_memory_budget_ = std::min(app_memory_budget_, budget_left);
+    budget_left -= app_memory_budget_;
+
+    for (unsigned i = 0; i < num_threads; ++i) {
+      if (i == crash_index ||
+          !GetStackRange(stack_pointers[i], -1, &stack, &stack_len))
+        continue;
+      stack_len = std::min(stack_len, budget_left);
+      stack_budgets_[i] = stack_len;
+      budget_left -= stack_len;
+    }
+    return true;
+  }
+
+  // Adds to |pointed_memory_| the memory around each address in the
+  // |stack_len| bytes of stack at |stack| that points into the heap, up
+  // to |budget_left| bytes, and returns the bytes left. Mappings holding
+  // one of the |num_threads| |stack_pointers| are not the heap.
+  size_t PlanPointedMemory(const void* stack, size_t stack_len,
+                           const uintptr_t* stack_pointers,
+                           unsigned num_threads, size_t budget_left) {
+    uintptr_t* const stack_copy =
+        reinterpret_cast<uintptr_t*>(Alloc(stack_len));
+    if (!stack_copy)
+      return budget_left;
+    dumper_->CopyFromProcess(stack_copy, GetCrashThread(), stack, stack_len);
+
+    const size_t word_count = stack_len / sizeof(uintptr_t);
+    for (size_t i = 0; i < word_count; ++i) {
+      const uintptr_t address = stack_copy[i];
+      const MappingInfo* mapping =
+          dumper_->FindMapping(reinterpret_cast<void*>(address));
+      if (!mapping || mapping->exec ||
+          (mapping->name[0] && my_strcmp(mapping->name, "[heap]") != 0))
+        continue;
+      bool in_stack = false;
+      for (unsigned j = 0; j < num_threads && !in_stack; ++j) {
+        in_stack = stack_pointers[j] - mapping->start_addr < mapping->size;
+      }
+      if (in_stack)
+        continue;
+
+      // Take half of the range before the address, and half after, within
+      // the mapping, then grow it to cover the ranges it overlaps, which it
+      // replaces.
+      uintptr_t start =
+          std::max(mapping->start_addr,
+                   uintptr_t(address - (kPointedMemorySize / 2)));
+      uintptr_t end =
+          std::min(uintptr_t(address + (kPointedMemorySize / 2)),
+                   uintptr_t(mapping->start_addr + mapping->size));
+      size_t overlapped_size;
+      size_t overlapped_count;
+      for (bool grown = true; grown;) {
+        grown = false;
+        overlapped_size = 0;
+        overlapped_count = 0;
+        for (size_t j = 0; j < pointed_memory_.size(); ++j) {
+          const uintptr_t range_start =
+              pointed_memory_[j].start_of_memory_range;
+          const uintptr_t range_end =
+              range_start + pointed_memory_[j].memory.data_size;
+          if (start >= range_end || end <= range_start)
+            continue;
+          overlapped_size += range_end - range_start;
+          ++overlapped_count;
+          if (range_start < start || range_end > end) {
+            start = std::min(start, range_start);
+            end = std::max(end, range_end);
+            grown = true;
           }
         }
       }
+      const size_t added = end - start - overlapped_size;
+      if (added > budget_left ||
+          pointed_memory_.size() - overlapped_count >= kMaxPointedMemoryRanges)
+        break;
 
-      list.CopyIndexAfterObject(i, &thread, sizeof(thread));
+      for (size_t j = 0; j < pointed_memory_.size();) {
+        const uintptr_t range_start =
+            pointed_memory_[j].start_of_memory_range;
+        if (range_start >= start && range_start < end) {
+          pointed_memory_[j] = pointed_memory_.back();
+          pointed_memory_.pop_back();
+        } else {
+          ++j;
+        }
+      }
+      MDMemoryDescriptor range;
+      my_memset(&range, 0, sizeof(range));
+      range.start_of_memory_range = start;
+      range.memory.data_size = end - start;
+      pointed_memory_.push_back(range);
+      budget_left -= added;
     }
+    return budget_left;
+  }
 
+  // Writes the registers in |info| as the context of |thread|.
+  bool WriteThreadContext(MDRawThread* thread, const ThreadInfo& info) {
+    TypedMDRVA<RawContextCPU> cpu(&minidump_writer_);
+    if (!cpu.Allocate())
+      return false;
+    my_memset(cpu.get(), 0, sizeof(RawContextCPU));
+    info.FillCPUContext(cpu.get());
+    thread->thread_context = cpu.location();
+    if (static_cast<pid_t>(thread->thread_id) == GetCrashThread()) {
+      crashing_thread_context_ = cpu.location();
+      if (!dumper_->IsPostMortem()) {
+        // This is the crashing thread of a live process, but
+        // no context was provided, so set the crash address
+        // while the instruction pointer is already here.
+        dumper_->set_crash_address(info.GetInstructionPointer());
+      }
+    }
     return true;
   }
 
-  // Write application-provided memory regions.
-  bool WriteAppMemory() {
+  // Writes the application-provided memory regions and the heap ranges
+  // that PlanMemoryBudget chose. These may overlap each other and the
+  // stacks, so they are first merged into sorted ranges that don't overlap
+  // or adjoin, and the parts already dumped are left out: the processor
+  // rejects a memory list with overlapping blocks.
+  // With a memory budget, regions are cut short, or left out, once
+  // |app_memory_budget_| runs out.
+  bool WriteExtraMemory() {
+    wasteful_vector<MDMemoryDescriptor> ranges(dumper_->allocator());
     for (AppMemoryList::const_iterator iter = app_memory_list_.begin();
          iter != app_memory_list_.end();
          ++iter) {
-      uint8_t* data_copy =
-        reinterpret_cast<uint8_t*>(dumper_->allocator()->Alloc(iter->length));
-      dumper_->CopyFromProcess(data_copy, GetCrashThread(), iter->ptr,
-                               iter->length);
+      size_t length = iter->length;
+      if (memory_budget_) {
+        length = std::min(length, app_memory_budget_);
+        app_memory_budget_ -= length;
+      }
+      AddMemoryRange(&ranges, reinterpret_cast<uintptr_t>(iter->ptr),
+                     length);
+    }
+    for (size_t i = 0; i < pointed_memory_.size(); ++i) {
+      AddMemoryRange(&ranges, pointed_memory_[i].start_of_memory_range,
+                     pointed_memory_[i].memory.data_size);
+    }
 
-      UntypedMDRVA memory(&minidump_writer_);
-      if (!memory.Allocate(iter->length)) {
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      const uintptr_t start = ranges[i].start_of_memory_range;
+      if (!WriteUncoveredMemory(GetCrashThread(), start,
+                                start + ranges[i].memory.data_size))
         return false;
+    }
+    return true;
+  }
+
+  // Adds the |length| bytes at |start| to |ranges|, which are sorted by
+  // address, merging it with the ranges it overlaps or adjoins. Only the
+  // start and data_size of each range are set.
+  static void AddMemoryRange(wasteful_vector<MDMemoryDescriptor>* ranges,
+                             uintptr_t start, size_t length) {
+    if (!length)
+      return;
+    uintptr_t end = start + length;
+    if (end < start)
+      end = ~uintptr_t(0);
+
+    size_t first = 0;
+    while (first < ranges->size() &&
+           (*ranges)[first].start_of_memory_range +
+               (*ranges)[first].memory.data_size < start)
+      ++first;
+    size_t last = first;
+    while (last < ranges->size() &&
+           (*ranges)[last].start_of_memory_range <= end) {
+      const uintptr_t range_start = (*ranges)[last].start_of_memory_range;
+      start = std::min(start, range_start);
+      end = std::max(end, uintptr_t(range_start +
+                                    (*ranges)[last].memory.data_size));
+      ++last;
+    }
+
+    MDMemoryDescriptor range;
+    my_memset(&range, 0, sizeof(range));
+    range.start_of_memory_range = start;
+    range.memory.data_size = end - start;
+    if (first == last) {
+      ranges->insert(ranges->begin() + first, range);
+    } else {
+      (*ranges)[first] = range;
+      ranges->erase(ranges->begin() + first + 1, ranges->begin() + last);
+    }
+  }
+
+  // Writes the memory of |tid| in [start, end) that none of
+  // |memory_blocks_| holds yet, a block for each stretch of it.
+  bool WriteUncoveredMemory(pid_t tid, uintptr_t start, uintptr_t end) {
+    while (start < end) {
+      // Find the first block that holds part of what is left.
+      uintptr_t covered_start = end;
+      uintptr_t covered_end = end;
+      for (size_t i = 0; i < memory_blocks_.size(); ++i) {
+        const uintptr_t block_start = memory_blocks_[i].start_of_memory_range;
+        const uintptr_t block_end =
+            block_start + memory_blocks_[i].memory.data_size;
+        if (block_start < covered_start && block_end > start &&
+            block_start < block_end) {
+          covered_start = std::max(block_start, start);
+          covered_end = std::min(block_end, end);
+        }
       }
-      memory.Copy(data_copy, iter->length);
-      MDMemoryDescriptor desc;
-      desc.start_of_memory_range = reinterpret_cast<uintptr_t>(iter->ptr);
-      desc.memory = memory.location();
-      memory_blocks_.push_back(desc);
+      if (covered_start > start &&
+          !WriteMemoryBlock(tid, start, covered_start - start))
+        return false;
+      start = covered_end;
     }
+    return true;
+  }
+
+  // Writes the |length| bytes of the memory of |tid| at |start| as a block
+  // of the memory list.
+  bool WriteMemoryBlock(pid_t tid, uintptr_t start, size_t length) {
+    uint8_t* data_copy = reinterpret_cast<uint8_t*>(Alloc(length));
+    if (!data_copy)
+      return false;
+    dumper_->CopyFromProcess(data_copy, tid,
+                             reinterpret_cast<void*>(start), length);
 
+    UntypedMDRVA memory(&minidump_writer_);
+    if (!memory.Allocate(length))
+      return false;
+    memory.Copy(data_copy, length);
+    MDMemoryDescriptor desc;
+    desc.start_of_memory_range = start;
+    desc.memory = memory.location();
+    memory_blocks_.push_back(desc);
     return true;
   }
 
@@ -936,8 +1537,119 @@ class MinidumpWriter {
     return true;
   }
 
+  // Resumes the threads of a live dump. /proc/<pid>/mem is opened first,
+  // so that memory can still be read once PTRACE_PEEKDATA cannot.
+  void ResumeLive() {
+    dumper_->PrepareForConcurrentCopies();
+    dumper_->ThreadsResume();
+    resume_ns_ = DumpTimings::Now();
+  }
+
+  // Writes the MD_LINUX_LIVE_DUMP stream, given the |stopped_stream_count|
+  // streams written before the threads were resumed.
+  bool WriteLiveDumpStream(MDRawDirectory* dirent,
+                           unsigned stopped_stream_count) {
+    TypedMDRVA<MDRawLinuxLiveDump> live(&minidump_writer_);
+    if (!live.Allocate())
+      return false;
+    dirent->stream_type = MD_LINUX_LIVE_DUMP;
+    dirent->location = live.location();
+
+    my_memset(live.get(), 0, sizeof(MDRawLinuxLiveDump));
+    live.get()->version = MD_LINUX_LIVE_DUMP_VERSION;
+    live.get()->stopped_stream_count = stopped_stream_count;
+    live.get()->suspend_ns = suspend_ns_;
+    live.get()->resume_ns = resume_ns_;
+    return true;
+  }
+
+  // Writes the phases in |timings_| that have been reached.
+  bool WriteDumpTimingStream(MDRawDirectory* dirent) {
+    const unsigned phase_count = timings_->reached_count();
+    TypedMDRVA<MDRawDumpTiming> timing(&minidump_writer_);
+    if (!timing.AllocateObjectAndArray(phase_count,
+                                       sizeof(MDRawDumpTimingPhase)))
+      return false;
+    dirent->stream_type = MD_LINUX_DUMP_TIMING;
+    dirent->location = timing.location();
+
+    timing.get()->version = MD_DUMP_TIMING_VERSION;
+    timing.get()->phase_count = phase_count;
+    unsigned index = 0;
+    for (int i = 0; i < MD_DUMP_TIMING_PHASE_COUNT; ++i) {
+      const MDDumpTimingPhase phase = static_cast<MDDumpTimingPhase>(i);
+      if (!timings_->reached(phase))
+        continue;
+      MDRawDumpTimingPhase entry;
+      my_memset(&entry, 0, sizeof(entry));
+      entry.phase = phase;
+      entry.start_ns = timings_->start_ns[phase];
+      entry.duration_ns = timings_->duration_ns[phase];
+      timing.CopyIndexAfterObject(index++, &entry, sizeof(entry));
+    }
+    return true;
+  }
+
   void set_minidump_size_limit(off_t limit) { minidump_size_limit_ = limit; }
 
+  // Sets the number of tasks that copy thread stacks at once. See
+  // CaptureThreads.
+  void set_stack_capture_tasks(int tasks) { stack_capture_tasks_ = tasks; }
+
+  // Sets whether the streams that do not need the process itself are
+  // written by a fork of this process from its own copy of the memory. See
+  // ReleaseProcess.
+  void set_write_from_snapshot(bool write_from_snapshot) {
+    write_from_snapshot_ = write_from_snapshot;
+  }
+
+  // Limits the memory dumped, from stacks and elsewhere, to about |budget|
+  // bytes, 0 meaning no limit. See PlanMemoryBudget.
+  void set_memory_budget(size_t budget) { memory_budget_ = budget; }
+
+  // Sets whether the minidump is compressed once it is complete. Must be
+  // called before Init. See MinidumpFileWriter::SetCompressed.
+  void set_compress(bool compress) {
+    minidump_writer_.SetCompressed(compress);
+  }
+
+  // Records the time taken by each phase of the dump in |timings|, which
+  // is not owned, and writes them to an MD_LINUX_DUMP_TIMING stream. The
+  // phases already in |timings| are kept. Must be called before Init.
+  void set_timings(DumpTimings* timings) {
+    timings_ = timings;
+    dumper_->set_timings(timings);
+  }
+
+  // Writes the entries of |annotations| that have values, which is not
+  // owned, to an MD_CRASHPAD_INFO_STREAM. They are read once the threads
+  // are resumed, so threads that are still running may be changing them.
+  void set_annotations(const ConcurrentStringDictionary* annotations) {
+    annotations_ = annotations;
+  }
+
+  // Writes the breadcrumbs that |breadcrumbs| holds, which is not owned, to
+  // an MD_BREADCRUMB_STREAM. Like the annotations, they are read once the
+  // threads are resumed.
+  void set_breadcrumbs(const BreadcrumbBuffer* breadcrumbs) {
+    breadcrumbs_ = breadcrumbs;
+  }
+
+  // Dumps only a sample of each thread: its registers and at most
+  // |stack_sample_size| bytes of its stack from the stack pointer, 0 meaning
+  // the whole dump. The threads are resumed once the thread list is written,
+  // rather than when the dump is complete, and no heap or application
+  // memory is dumped.
+  void set_stack_sample_size(size_t stack_sample_size) {
+    stack_sample_size_ = stack_sample_size;
+  }
+
+  // Resumes the threads once the thread list, with their registers and
+  // stacks, is written. The rest of the minidump is read from the running
+  // process, and an MD_LINUX_LIVE_DUMP stream says which streams were. Not
+  // for use with set_write_from_snapshot, whose snapshot is consistent.
+  void set_live(bool live) { live_ = live; }
+
  private:
   void* Alloc(unsigned bytes) {
     return dumper_->allocator()->Alloc(bytes);
@@ -987,7 +1699,7 @@ class MinidumpWriter {
         MD_CPU_ARCHITECTURE_AMD64;
 #endif
 
-    const int fd = sys_open("/proc/cpuinfo", O_RDONLY, 0);
+    const int fd = OpenStableFile("/proc/cpuinfo");
     if (fd < 0)
       return false;
 
@@ -1152,7 +1864,7 @@ class MinidumpWriter {
     // read /proc/self/auxv but unfortunately, this file is not always
     // readable from regular Android applications on later versions
     // (>= 4.1) of the Android platform.
-    const int fd = sys_open("/proc/cpuinfo", O_RDONLY, 0);
+    const int fd = OpenStableFile("/proc/cpuinfo");
     if (fd < 0) {
       // Do not return false here to allow the minidump generation
       // to happen properly.
@@ -1316,8 +2028,19 @@ class MinidumpWriter {
 #  error "Unsupported CPU"
 #endif
 
+  // Opens |filename| for reading, or the copy of it that WarmDumpState
+  // made before the crash.
+  static int OpenStableFile(const char* filename) {
+    const int fd = WarmDumpState::OpenFile(filename);
+    return fd >= 0 ? fd : sys_open(filename, O_RDONLY, 0);
+  }
+
   bool WriteFile(MDLocationDescriptor* result, const char* filename) {
-    const int fd = sys_open(filename, O_RDONLY, 0);
+    return WriteOpenFile(result, OpenStableFile(filename));
+  }
+
+  // Writes the contents of |fd|, and closes it.
+  bool WriteOpenFile(MDLocationDescriptor* result, int fd) {
     if (fd < 0)
       return false;
 
@@ -1429,6 +2152,9 @@ class MinidumpWriter {
 
   bool WriteProcFile(MDLocationDescriptor* result, pid_t pid,
                      const char* filename) {
+    const int fd = WarmDumpState::OpenProcFile(dumper_->pid(), filename);
+    if (fd >= 0)
+      return WriteOpenFile(result, fd);
     char buf[NAME_MAX];
     if (!dumper_->BuildProcPath(buf, pid, filename))
       return false;
@@ -1446,10 +2172,40 @@ class MinidumpWriter {
   LinuxDumper* dumper_;
   MinidumpFileWriter minidump_writer_;
   off_t minidump_size_limit_;
+  // The number of tasks copying thread stacks; 1 copies them on this task
+  // as the thread list is written.
+  int stack_capture_tasks_;
+  // If true, this process is a copy of the dumped one. See
+  // set_write_from_snapshot.
+  bool write_from_snapshot_;
+  // The bytes of memory that may be dumped, or 0 for no limit.
+  size_t memory_budget_;
+  // Where the phases of the dump are timed, if not NULL. See set_timings.
+  DumpTimings* timings_;
+  // The annotations to write, if not NULL. See set_annotations.
+  const ConcurrentStringDictionary* annotations_;
+  // The breadcrumbs to write, if not NULL. See set_breadcrumbs.
+  const BreadcrumbBuffer* breadcrumbs_;
+  // The most bytes of each stack to dump when sampling, or 0. See
+  // set_stack_sample_size.
+  size_t stack_sample_size_;
+
+  // set_live, and the CLOCK_MONOTONIC times at which the threads were
+  // suspended and resumed.
+  bool live_;
+  uint64_t suspend_ns_;
+  uint64_t resume_ns_;
+  // With a memory budget, the most bytes of each thread's stack to dump,
+  // by index in the dumper's threads, -1 meaning no maximum.
+  int* stack_budgets_;
+  // With a memory budget, the bytes left for |app_memory_list_|.
+  size_t app_memory_budget_;
+  // With a memory budget, the heap ranges that the crashing thread's stack
+  // points into. Only their start and data_size are set.
+  wasteful_vector<MDMemoryDescriptor> pointed_memory_;
   MDLocationDescriptor crashing_thread_context_;
-  // Blocks of memory written to the dump. These are all currently
-  // written while writing the thread list stream, but saved here
-  // so a memory list stream can be written afterwards.
+  // Blocks of memory written to the dump, saved here so a memory list
+  // stream can be written afterwards. None of them overlap.
   wasteful_vector<MDMemoryDescriptor> memory_blocks_;
   // Additional information about some mappings provided by the caller.
   const MappingList& mapping_list_;
@@ -1475,7 +2231,15 @@ bool WriteMinidumpImpl(const char* minidump_path,
                        const AppMemoryList& appmem,
                        bool skip_stacks_if_mapping_unreferenced,
                        uintptr_t principal_mapping_address,
-                       bool sanitize_stacks) {
+                       bool sanitize_stacks,
+                       int stack_capture_tasks,
+                       bool write_from_snapshot,
+                       size_t memory_budget,
+                       bool compress,
+                       DumpTimings* timings,
+                       const ConcurrentStringDictionary* annotations,
+                       const BreadcrumbBuffer* breadcrumbs,
+                       size_t stack_sample_size) {
   LinuxPtraceDumper dumper(crashing_process);
   const ExceptionHandler::CrashContext* context = NULL;
   if (blob) {
@@ -1490,6 +2254,14 @@ bool WriteMinidumpImpl(const char* minidump_path,
                         principal_mapping_address, sanitize_stacks, &dumper);
   // Set desired limit for file size of minidump (-1 means no limit).
   writer.set_minidump_size_limit(minidump_size_limit);
+  writer.set_stack_capture_tasks(stack_capture_tasks);
+  writer.set_write_from_snapshot(write_from_snapshot);
+  writer.set_memory_budget(memory_budget);
+  writer.set_compress(compress);
+  writer.set_timings(timings);
+  writer.set_annotations(annotations);
+  writer.set_breadcrumbs(breadcrumbs);
+  writer.set_stack_sample_size(stack_sample_size);
   if (!writer.Init())
     return false;
   return writer.Dump();
@@ -1503,30 +2275,52 @@ bool WriteMinidump(const char* minidump_path, pid_t crashing_process,
                    const void* blob, size_t blob_size,
                    bool skip_stacks_if_mapping_unreferenced,
                    uintptr_t principal_mapping_address,
-                   bool sanitize_stacks) {
+                   bool sanitize_stacks,
+                   int stack_capture_tasks,
+                   bool write_from_snapshot,
+                   size_t memory_budget,
+                   bool compress,
+                   DumpTimings* timings,
+                   const ConcurrentStringDictionary* annotations,
+                   const BreadcrumbBuffer* breadcrumbs,
+                   size_t stack_sample_size) {
   return WriteMinidumpImpl(minidump_path, -1, -1,
                            crashing_process, blob, blob_size,
                            MappingList(), AppMemoryList(),
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, stack_capture_tasks,
+                           write_from_snapshot, memory_budget, compress,
+                           timings, annotations, breadcrumbs,
+                           stack_sample_size);
 }
 
 bool WriteMinidump(int minidump_fd, pid_t crashing_process,
                    const void* blob, size_t blob_size,
                    bool skip_stacks_if_mapping_unreferenced,
                    uintptr_t principal_mapping_address,
-                   bool sanitize_stacks) {
+                   bool sanitize_stacks,
+                   int stack_capture_tasks,
+                   bool write_from_snapshot,
+                   size_t memory_budget,
+                   bool compress,
+                   DumpTimings* timings,
+                   const ConcurrentStringDictionary* annotations,
+                   const BreadcrumbBuffer* breadcrumbs,
+                   size_t stack_sample_size) {
   return WriteMinidumpImpl(NULL, minidump_fd, -1,
                            crashing_process, blob, blob_size,
                            MappingList(), AppMemoryList(),
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, stack_capture_tasks,
+                           write_from_snapshot, memory_budget, compress,
+                           timings, annotations, breadcrumbs,
+                           stack_sample_size);
 }
 
 bool WriteMinidump(const char* minidump_path, pid_t process,
-                   pid_t process_blamed_thread) {
+                   pid_t process_blamed_thread, bool live) {
   LinuxPtraceDumper dumper(process);
   // MinidumpWriter will set crash address
   dumper.set_crash_signal(MD_EXCEPTION_CODE_LIN_DUMP_REQUESTED);
@@ -1535,6 +2329,7 @@ bool WriteMinidump(const char* minidump_path, pid_t process,
   AppMemoryList app_memory_list;
   MinidumpWriter writer(minidump_path, -1, NULL, mapping_list,
                         app_memory_list, false, 0, false, &dumper);
+  writer.set_live(live);
   if (!writer.Init())
     return false;
   return writer.Dump();
@@ -1546,13 +2341,24 @@ bool WriteMinidump(const char* minidump_path, pid_t crashing_process,
                    const AppMemoryList& appmem,
                    bool skip_stacks_if_mapping_unreferenced,
                    uintptr_t principal_mapping_address,
-                   bool sanitize_stacks) {
+                   bool sanitize_stacks,
+                   int stack_capture_tasks,
+                   bool write_from_snapshot,
+                   size_t memory_budget,
+                   bool compress,
+                   DumpTimings* timings,
+                   const ConcurrentStringDictionary* annotations,
+                   const BreadcrumbBuffer* breadcrumbs,
+                   size_t stack_sample_size) {
   return WriteMinidumpImpl(minidump_path, -1, -1, crashing_process,
                            blob, blob_size,
                            mappings, appmem,
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, stack_capture_tasks,
+                           write_from_snapshot, memory_budget, compress,
+                           timings, annotations, breadcrumbs,
+                           stack_sample_size);
 }
 
 bool WriteMinidump(int minidump_fd, pid_t crashing_process,
@@ -1561,13 +2367,24 @@ bool WriteMinidump(int minidump_fd, pid_t crashing_process,
                    const AppMemoryList& appmem,
                    bool skip_stacks_if_mapping_unreferenced,
                    uintptr_t principal_mapping_address,
-                   bool sanitize_stacks) {
+                   bool sanitize_stacks,
+                   int stack_capture_tasks,
+                   bool write_from_snapshot,
+                   size_t memory_budget,
+                   bool compress,
+                   DumpTimings* timings,
+                   const ConcurrentStringDictionary* annotations,
+                   const BreadcrumbBuffer* breadcrumbs,
+                   size_t stack_sample_size) {
   return WriteMinidumpImpl(NULL, minidump_fd, -1, crashing_process,
                            blob, blob_size,
                            mappings, appmem,
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, stack_capture_tasks,
+                           write_from_snapshot, memory_budget, compress,
+                           timings, annotations, breadcrumbs,
+                           stack_sample_size);
 }
 
 bool WriteMinidump(const char* minidump_path, off_t minidump_size_limit,
@@ -1577,13 +2394,24 @@ bool WriteMinidump(const char* minidump_path, off_t minidump_size_limit,
                    const AppMemoryList& appmem,
                    bool skip_stacks_if_mapping_unreferenced,
                    uintptr_t principal_mapping_address,
-                   bool sanitize_stacks) {
+                   bool sanitize_stacks,
+                   int stack_capture_tasks,
+                   bool write_from_snapshot,
+                   size_t memory_budget,
+                   bool compress,
+                   DumpTimings* timings,
+                   const ConcurrentStringDictionary* annotations,
+                   const BreadcrumbBuffer* breadcrumbs,
+                   size_t stack_sample_size) {
   return WriteMinidumpImpl(minidump_path, -1, minidump_size_limit,
                            crashing_process, blob, blob_size,
                            mappings, appmem,
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, stack_capture_tasks,
+                           write_from_snapshot, memory_budget, compress,
+                           timings, annotations, breadcrumbs,
+                           stack_sample_size);
 }
 
 bool WriteMinidump(int minidump_fd, off_t minidump_size_limit,
@@ -1593,21 +2421,34 @@ bool WriteMinidump(int minidump_fd, off_t minidump_size_limit,
                    const AppMemoryList& appmem,
                    bool skip_stacks_if_mapping_unreferenced,
                    uintptr_t principal_mapping_address,
-                   bool sanitize_stacks) {
+                   bool sanitize_stacks,
+                   int stack_capture_tasks,
+                   bool write_from_snapshot,
+                   size_t memory_budget,
+                   bool compress,
+                   DumpTimings* timings,
+                   const ConcurrentStringDictionary* annotations,
+                   const BreadcrumbBuffer* breadcrumbs,
+                   size_t stack_sample_size) {
   return WriteMinidumpImpl(NULL, minidump_fd, minidump_size_limit,
                            crashing_process, blob, blob_size,
                            mappings, appmem,
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, stack_capture_tasks,
+                           write_from_snapshot, memory_budget, compress,
+                           timings, annotations, breadcrumbs,
+                           stack_sample_size);
 }
 
 bool WriteMinidump(const char* filename,
                    const MappingList& mappings,
                    const AppMemoryList& appmem,
-                   LinuxDumper* dumper) {
+                   LinuxDumper* dumper,
+                   int stack_capture_tasks) {
   MinidumpWriter writer(filename, -1, NULL, mappings, appmem,
                         false, 0, false, dumper);
+  writer.set_stack_capture_tasks(stack_capture_tasks);
   if (!writer.Init())
     return false;
   return writer.Dump();
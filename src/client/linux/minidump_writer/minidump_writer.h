@@ -39,10 +39,13 @@
 #include <utility>
 
 #include "client/linux/minidump_writer/linux_dumper.h"
+#include "common/breadcrumb_buffer.h"
+#include "common/concurrent_string_dictionary.h"
 #include "google_breakpad/common/minidump_format.h"
 
 namespace google_breakpad {
 
+struct DumpTimings;
 class ExceptionHandler;
 
 #if defined(__aarch64__)
@@ -75,27 +78,76 @@ typedef std::list<AppMemory> AppMemoryList;
 //   crashing_process: the pid of the crashing process. This must be trusted.
 //   blob: a blob of data from the crashing process. See exception_handler.h
 //   blob_size: the length of |blob|, in bytes
+//   stack_capture_tasks: the number of tasks that copy the stacks of the
+//     threads at once, from 1, the default, to 16. See
+//     MinidumpDescriptor::set_stack_capture_tasks.
+//   write_from_snapshot: the calling process is a copy of the crashing one,
+//     made by fork or by clone without CLONE_VM while it was stopped, as
+//     ExceptionHandler's dumping process is. Once the threads and the
+//     process's /proc files are written, the threads are resumed and the
+//     call returns, while a fork of the calling process writes the rest of
+//     the minidump from its copy of the memory. See
+//     MinidumpDescriptor::set_write_from_snapshot.
+//   memory_budget: if not 0, about the most bytes of memory to dump. The
+//     crashing thread's stack comes first, then the heap memory it points
+//     to, the |appdata| regions and the other stacks. See
+//     MinidumpDescriptor::set_memory_budget.
+//   compress: the minidump is compressed once it is complete, into data
+//     that Minidump reads as it is. See MinidumpDescriptor::set_compress.
+//   timings: if not NULL, the time taken by each phase of the dump is
+//     recorded there, and written to an MD_LINUX_DUMP_TIMING stream along
+//     with any phases it already holds. See
+//     MinidumpDescriptor::set_record_dump_timings.
+//   annotations: if not NULL, the entries with values are written as the
+//     simple annotations of an MD_CRASHPAD_INFO_STREAM. See
+//     MinidumpDescriptor::set_annotations.
+//   breadcrumbs: if not NULL, the breadcrumbs that it holds are written to
+//     an MD_BREADCRUMB_STREAM. See MinidumpDescriptor::set_breadcrumbs.
+//   stack_sample_size: if not 0, only the registers of each thread and
+//     about this many bytes of its stack from the stack pointer are dumped,
+//     and the threads are resumed as soon as those are written. See
+//     MinidumpDescriptor::set_stack_sample_size.
 //
 // Returns true iff successful.
 bool WriteMinidump(const char* minidump_path, pid_t crashing_process,
                    const void* blob, size_t blob_size,
                    bool skip_stacks_if_mapping_unreferenced = false,
                    uintptr_t principal_mapping_address = 0,
-                   bool sanitize_stacks = false);
+                   bool sanitize_stacks = false,
+                   int stack_capture_tasks = 1,
+                   bool write_from_snapshot = false,
+                   size_t memory_budget = 0,
+                   bool compress = false,
+                   DumpTimings* timings = NULL,
+                   const ConcurrentStringDictionary* annotations = NULL,
+                   const BreadcrumbBuffer* breadcrumbs = NULL,
+                   size_t stack_sample_size = 0);
 // Same as above but takes an open file descriptor instead of a path.
 bool WriteMinidump(int minidump_fd, pid_t crashing_process,
                    const void* blob, size_t blob_size,
                    bool skip_stacks_if_mapping_unreferenced = false,
                    uintptr_t principal_mapping_address = 0,
-                   bool sanitize_stacks = false);
+                   bool sanitize_stacks = false,
+                   int stack_capture_tasks = 1,
+                   bool write_from_snapshot = false,
+                   size_t memory_budget = 0,
+                   bool compress = false,
+                   DumpTimings* timings = NULL,
+                   const ConcurrentStringDictionary* annotations = NULL,
+                   const BreadcrumbBuffer* breadcrumbs = NULL,
+                   size_t stack_sample_size = 0);
 
 // Alternate form of WriteMinidump() that works with processes that
 // are not expected to have crashed.  If |process_blamed_thread| is
 // meaningful, it will be the one from which a crash signature is
 // extracted.  It is not expected that this function will be called
 // from a compromised context, but it is safe to do so.
+//   live: the process is resumed as soon as the registers and stacks of
+//     its threads are written. The modules, mappings and other memory are
+//     then read while it runs, a best-effort snapshot that an
+//     MD_LINUX_LIVE_DUMP stream marks as such.
 bool WriteMinidump(const char* minidump_path, pid_t process,
-                   pid_t process_blamed_thread);
+                   pid_t process_blamed_thread, bool live = false);
 
 // These overloads also allow passing a list of known mappings and
 // a list of additional memory regions to be included in the minidump.
@@ -105,14 +157,30 @@ bool WriteMinidump(const char* minidump_path, pid_t crashing_process,
                    const AppMemoryList& appdata,
                    bool skip_stacks_if_mapping_unreferenced = false,
                    uintptr_t principal_mapping_address = 0,
-                   bool sanitize_stacks = false);
+                   bool sanitize_stacks = false,
+                   int stack_capture_tasks = 1,
+                   bool write_from_snapshot = false,
+                   size_t memory_budget = 0,
+                   bool compress = false,
+                   DumpTimings* timings = NULL,
+                   const ConcurrentStringDictionary* annotations = NULL,
+                   const BreadcrumbBuffer* breadcrumbs = NULL,
+                   size_t stack_sample_size = 0);
 bool WriteMinidump(int minidump_fd, pid_t crashing_process,
                    const void* blob, size_t blob_size,
                    const MappingList& mappings,
                    const AppMemoryList& appdata,
                    bool skip_stacks_if_mapping_unreferenced = false,
                    uintptr_t principal_mapping_address = 0,
-                   bool sanitize_stacks = false);
+                   bool sanitize_stacks = false,
+                   int stack_capture_tasks = 1,
+                   bool write_from_snapshot = false,
+                   size_t memory_budget = 0,
+                   bool compress = false,
+                   DumpTimings* timings = NULL,
+                   const ConcurrentStringDictionary* annotations = NULL,
+                   const BreadcrumbBuffer* breadcrumbs = NULL,
+                   size_t stack_sample_size = 0);
 
 // These overloads also allow passing a file size limit for the minidump.
 bool WriteMinidump(const char* minidump_path, off_t minidump_size_limit,
@@ -122,7 +190,15 @@ bool WriteMinidump(const char* minidump_path, off_t minidump_size_limit,
                    const AppMemoryList& appdata,
                    bool skip_stacks_if_mapping_unreferenced = false,
                    uintptr_t principal_mapping_address = 0,
-                   bool sanitize_stacks = false);
+                   bool sanitize_stacks = false,
+                   int stack_capture_tasks = 1,
+                   bool write_from_snapshot = false,
+                   size_t memory_budget = 0,
+                   bool compress = false,
+                   DumpTimings* timings = NULL,
+                   const ConcurrentStringDictionary* annotations = NULL,
+                   const BreadcrumbBuffer* breadcrumbs = NULL,
+                   size_t stack_sample_size = 0);
 bool WriteMinidump(int minidump_fd, off_t minidump_size_limit,
                    pid_t crashing_process,
                    const void* blob, size_t blob_size,
@@ -130,12 +206,23 @@ bool WriteMinidump(int minidump_fd, off_t minidump_size_limit,
                    const AppMemoryList& appdata,
                    bool skip_stacks_if_mapping_unreferenced = false,
                    uintptr_t principal_mapping_address = 0,
-                   bool sanitize_stacks = false);
-
+                   bool sanitize_stacks = false,
+                   int stack_capture_tasks = 1,
+                   bool write_from_snapshot = false,
+                   size_t memory_budget = 0,
+                   bool compress = false,
+                   DumpTimings* timings = NULL,
+                   const ConcurrentStringDictionary* annotations = NULL,
+                   const BreadcrumbBuffer* breadcrumbs = NULL,
+                   size_t stack_sample_size = 0);
+
+// Writes a minidump of the process that |dumper| describes, such as a core
+// dump read by LinuxCoreDumper. |stack_capture_tasks| is as above.
 bool WriteMinidump(const char* filename,
                    const MappingList& mappings,
                    const AppMemoryList& appdata,
-                   LinuxDumper* dumper);
+                   LinuxDumper* dumper,
+                   int stack_capture_tasks = 1);
 
 }  // namespace google_breakpad
 
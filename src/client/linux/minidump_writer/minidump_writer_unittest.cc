@@ -32,6 +32,8 @@
 
 #include <fcntl.h>
 #include <poll.h>
+#include <stdlib.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
@@ -42,6 +44,7 @@
 
 #include "breakpad_googletest_includes.h"
 #include "client/linux/handler/exception_handler.h"
+#include "client/linux/minidump_writer/dump_timings.h"
 #include "client/linux/minidump_writer/linux_dumper.h"
 #include "client/linux/minidump_writer/minidump_writer.h"
 #include "client/linux/minidump_writer/minidump_writer_unittest_utils.h"
@@ -127,8 +130,242 @@ TEST(MinidumpWriterTest, SetupWithFD) {
   IGNORE_EINTR(waitpid(child, nullptr, 0));
 }
 
+// Test that a minidump can be sent to a socket, which cannot seek.
+TEST(MinidumpWriterTest, SetupWithSocket) {
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  const pid_t child = fork();
+  if (child == 0) {
+    close(fds[1]);
+    char b;
+    IGNORE_RET(HANDLE_EINTR(read(fds[0], &b, sizeof(b))));
+    close(fds[0]);
+    syscall(__NR_exit_group);
+  }
+  close(fds[0]);
+
+  AutoTempDir temp_dir;
+  string templ = temp_dir.path() + kMDWriterUnitTestFileName;
+
+  // The reader copies everything sent on the socket into |templ|.
+  int sockets[2];
+  ASSERT_NE(-1, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+  const pid_t reader = fork();
+  if (reader == 0) {
+    close(sockets[0]);
+    const int fd = open(templ.c_str(), O_CREAT | O_WRONLY, S_IRWXU);
+    char buffer[4096];
+    ssize_t r;
+    while ((r = HANDLE_EINTR(read(sockets[1], buffer, sizeof(buffer)))) > 0)
+      IGNORE_RET(HANDLE_EINTR(write(fd, buffer, r)));
+    close(fd);
+    _exit(0);
+  }
+  close(sockets[1]);
+
+  ExceptionHandler::CrashContext context;
+  memset(&context, 0, sizeof(context));
+  // Set a non-zero tid to avoid tripping asserts.
+  context.tid = child;
+  ASSERT_TRUE(WriteMinidump(sockets[0], child, &context, sizeof(context)));
+  close(sockets[0]);
+  IGNORE_EINTR(waitpid(reader, nullptr, 0));
+
+  Minidump minidump(templ);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpThreadList* threads = minidump.GetThreadList();
+  ASSERT_TRUE(threads);
+  EXPECT_EQ(1U, threads->thread_count());
+
+  close(fds[1]);
+  IGNORE_EINTR(waitpid(child, nullptr, 0));
+}
+
+// Test that a compressed minidump is smaller and reads the same.
+TEST(MinidumpWriterTest, Compressed) {
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  const pid_t child = fork();
+  if (child == 0) {
+    close(fds[1]);
+    char b;
+    IGNORE_RET(HANDLE_EINTR(read(fds[0], &b, sizeof(b))));
+    close(fds[0]);
+    syscall(__NR_exit_group);
+  }
+  close(fds[0]);
+
+  ExceptionHandler::CrashContext context;
+  memset(&context, 0, sizeof(context));
+  // Set a non-zero tid to avoid tripping asserts.
+  context.tid = child;
+
+  AutoTempDir temp_dir;
+  string plain_path = temp_dir.path() + kMDWriterUnitTestFileName + ".plain";
+  string compressed_path = temp_dir.path() + kMDWriterUnitTestFileName;
+  ASSERT_TRUE(WriteMinidump(plain_path.c_str(), child, &context,
+                            sizeof(context)));
+  ASSERT_TRUE(WriteMinidump(compressed_path.c_str(), child, &context,
+                            sizeof(context), false, 0, false, 1, false, 0,
+                            true));
+  close(fds[1]);
+  IGNORE_EINTR(waitpid(child, nullptr, 0));
+
+  struct stat plain_stat, compressed_stat;
+  ASSERT_EQ(0, stat(plain_path.c_str(), &plain_stat));
+  ASSERT_EQ(0, stat(compressed_path.c_str(), &compressed_stat));
+  EXPECT_LT(compressed_stat.st_size, plain_stat.st_size);
+
+  Minidump plain(plain_path);
+  ASSERT_TRUE(plain.Read());
+  Minidump compressed(compressed_path);
+  ASSERT_TRUE(compressed.Read());
+  MinidumpModuleList* plain_modules = plain.GetModuleList();
+  MinidumpModuleList* compressed_modules = compressed.GetModuleList();
+  ASSERT_TRUE(plain_modules);
+  ASSERT_TRUE(compressed_modules);
+  ASSERT_EQ(plain_modules->module_count(),
+            compressed_modules->module_count());
+  for (unsigned int i = 0; i < plain_modules->module_count(); ++i) {
+    EXPECT_EQ(plain_modules->GetModuleAtIndex(i)->code_file(),
+              compressed_modules->GetModuleAtIndex(i)->code_file());
+  }
+  MinidumpThreadList* threads = compressed.GetThreadList();
+  ASSERT_TRUE(threads);
+  EXPECT_EQ(1U, threads->thread_count());
+}
+
 // Test that mapping info can be specified when writing a minidump,
 // and that it ends up in the module list of the minidump.
+TEST(MinidumpWriterTest, DumpTimings) {
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  const pid_t child = fork();
+  if (child == 0) {
+    close(fds[1]);
+    char b;
+    IGNORE_RET(HANDLE_EINTR(read(fds[0], &b, sizeof(b))));
+    close(fds[0]);
+    syscall(__NR_exit_group);
+  }
+  close(fds[0]);
+
+  ExceptionHandler::CrashContext context;
+  memset(&context, 0, sizeof(context));
+  // Set a non-zero tid to avoid tripping asserts.
+  context.tid = child;
+
+  // A phase timed before the dump is written along with the dump's own.
+  DumpTimings timings;
+  timings.Clear();
+  timings.Begin(MD_DUMP_TIMING_CLONE);
+  timings.End(MD_DUMP_TIMING_CLONE);
+
+  AutoTempDir temp_dir;
+  string templ = temp_dir.path() + kMDWriterUnitTestFileName;
+  ASSERT_TRUE(WriteMinidump(templ.c_str(), child, &context, sizeof(context),
+                            false, 0, false, 1, false, 0, false, &timings));
+  close(fds[1]);
+  IGNORE_EINTR(waitpid(child, nullptr, 0));
+
+  EXPECT_FALSE(timings.reached(MD_DUMP_TIMING_HANDLER));
+  static const MDDumpTimingPhase kWriterPhases[] = {
+    MD_DUMP_TIMING_THREAD_ENUMERATION,
+    MD_DUMP_TIMING_MAPPING_ENUMERATION,
+    MD_DUMP_TIMING_THREADS_SUSPEND,
+    MD_DUMP_TIMING_THREAD_LIST,
+    MD_DUMP_TIMING_PROC_FILES,
+    MD_DUMP_TIMING_MODULE_LIST,
+    MD_DUMP_TIMING_MEMORY_LIST,
+    MD_DUMP_TIMING_OTHER_STREAMS,
+    MD_DUMP_TIMING_THREADS_RESUME,
+    MD_DUMP_TIMING_FILE_WRITE,
+  };
+  for (size_t i = 0; i < sizeof(kWriterPhases) / sizeof(kWriterPhases[0]);
+       ++i) {
+    EXPECT_TRUE(timings.reached(kWriterPhases[i])) << i;
+  }
+  EXPECT_GE(timings.start_ns[MD_DUMP_TIMING_THREAD_LIST],
+            timings.start_ns[MD_DUMP_TIMING_THREADS_SUSPEND] +
+            timings.duration_ns[MD_DUMP_TIMING_THREADS_SUSPEND]);
+
+  Minidump minidump(templ);
+  ASSERT_TRUE(minidump.Read());
+  uint32_t length;
+  ASSERT_TRUE(minidump.SeekToStreamType(MD_LINUX_DUMP_TIMING, &length));
+  ASSERT_GE(length, MDRawDumpTiming_minsize);
+  MDRawDumpTiming header;
+  ASSERT_TRUE(minidump.ReadBytes(&header, MDRawDumpTiming_minsize));
+  EXPECT_EQ(static_cast<uint32_t>(MD_DUMP_TIMING_VERSION), header.version);
+  // Every phase but the file write, which comes after the stream.
+  ASSERT_EQ(timings.reached_count() - 1, header.phase_count);
+  ASSERT_EQ(MDRawDumpTiming_minsize +
+            header.phase_count * sizeof(MDRawDumpTimingPhase), length);
+  uint32_t last_phase = 0;
+  for (uint32_t i = 0; i < header.phase_count; ++i) {
+    MDRawDumpTimingPhase phase;
+    ASSERT_TRUE(minidump.ReadBytes(&phase, sizeof(phase)));
+    ASSERT_LT(phase.phase, static_cast<uint32_t>(MD_DUMP_TIMING_FILE_WRITE));
+    if (i > 0) {
+      EXPECT_GT(phase.phase, last_phase);
+    }
+    last_phase = phase.phase;
+    const MDDumpTimingPhase id = static_cast<MDDumpTimingPhase>(phase.phase);
+    EXPECT_EQ(timings.start_ns[id], phase.start_ns);
+    EXPECT_EQ(timings.duration_ns[id], phase.duration_ns);
+  }
+}
+
+TEST(MinidumpWriterTest, LiveDump) {
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  const pid_t child = fork();
+  if (child == 0) {
+    close(fds[1]);
+    char b;
+    IGNORE_RET(HANDLE_EINTR(read(fds[0], &b, sizeof(b))));
+    close(fds[0]);
+    syscall(__NR_exit_group);
+  }
+  close(fds[0]);
+
+  AutoTempDir temp_dir;
+  string templ = temp_dir.path() + kMDWriterUnitTestFileName;
+  ASSERT_TRUE(WriteMinidump(templ.c_str(), child, child, true));
+  close(fds[1]);
+  IGNORE_EINTR(waitpid(child, nullptr, 0));
+
+  Minidump minidump(templ);
+  ASSERT_TRUE(minidump.Read());
+  uint32_t length;
+  ASSERT_TRUE(minidump.SeekToStreamType(MD_LINUX_LIVE_DUMP, &length));
+  ASSERT_EQ(sizeof(MDRawLinuxLiveDump), length);
+  MDRawLinuxLiveDump live;
+  ASSERT_TRUE(minidump.ReadBytes(&live, sizeof(live)));
+  EXPECT_EQ(static_cast<uint32_t>(MD_LINUX_LIVE_DUMP_VERSION), live.version);
+  // Only the thread list was written while the child was stopped.
+  EXPECT_EQ(1U, live.stopped_stream_count);
+  EXPECT_NE(0U, live.suspend_ns);
+  EXPECT_GE(live.resume_ns, live.suspend_ns);
+  const MDRawDirectory* thread_list = minidump.GetDirectoryEntryAtIndex(0);
+  ASSERT_TRUE(thread_list);
+  EXPECT_EQ(static_cast<uint32_t>(MD_THREAD_LIST_STREAM),
+            thread_list->stream_type);
+
+  // What was read from the running child is still there.
+  MinidumpThreadList* threads = minidump.GetThreadList();
+  ASSERT_TRUE(threads);
+  ASSERT_EQ(1U, threads->thread_count());
+  EXPECT_TRUE(threads->GetThreadAtIndex(0)->GetMemory());
+  MinidumpModuleList* modules = minidump.GetModuleList();
+  ASSERT_TRUE(modules);
+  EXPECT_NE(0U, modules->module_count());
+}
+
 TEST(MinidumpWriterTest, MappingInfo) {
   int fds[2];
   ASSERT_NE(-1, pipe(fds));
@@ -681,6 +918,70 @@ TEST(MinidumpWriterTest, AdditionalMemory) {
   IGNORE_EINTR(waitpid(child, nullptr, 0));
 }
 
+// Test that additional memory regions that overlap or adjoin are dumped
+// as one block.
+TEST(MinidumpWriterTest, OverlappingAdditionalMemory) {
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  const uint32_t kMemorySize = sysconf(_SC_PAGESIZE);
+  uint8_t* memory = new uint8_t[kMemorySize];
+  const uintptr_t kMemoryAddress = reinterpret_cast<uintptr_t>(memory);
+  for (uint32_t i = 0; i < kMemorySize; ++i) {
+    memory[i] = i % 255;
+  }
+
+  const pid_t child = fork();
+  if (child == 0) {
+    close(fds[1]);
+    char b;
+    HANDLE_EINTR(read(fds[0], &b, sizeof(b)));
+    close(fds[0]);
+    syscall(__NR_exit_group);
+  }
+  close(fds[0]);
+
+  ExceptionHandler::CrashContext context;
+  ASSERT_EQ(0, getcontext(&context.context));
+  context.tid = child;
+
+  AutoTempDir temp_dir;
+  string templ = temp_dir.path() + kMDWriterUnitTestFileName;
+  unlink(templ.c_str());
+
+  // The second half, the first half, a repeat of the first half, and the
+  // middle, which overlaps both.
+  MappingList mappings;
+  AppMemoryList memory_list;
+  const size_t kHalf = kMemorySize / 2;
+  const size_t offsets[] = { kHalf, 0, 0, kHalf / 2 };
+  for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i) {
+    AppMemory app_memory;
+    app_memory.ptr = memory + offsets[i];
+    app_memory.length = kHalf;
+    memory_list.push_back(app_memory);
+  }
+  ASSERT_TRUE(WriteMinidump(templ.c_str(), child, &context, sizeof(context),
+                            mappings, memory_list));
+
+  Minidump minidump(templ);
+  ASSERT_TRUE(minidump.Read());
+
+  MinidumpMemoryList* dump_memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(dump_memory_list);
+  const MinidumpMemoryRegion* region =
+    dump_memory_list->GetMemoryRegionForAddress(kMemoryAddress + kHalf);
+  ASSERT_TRUE(region);
+
+  EXPECT_EQ(kMemoryAddress, region->GetBase());
+  EXPECT_EQ(kMemorySize, region->GetSize());
+  EXPECT_EQ(0, memcmp(region->GetMemory(), memory, kMemorySize));
+
+  delete[] memory;
+  close(fds[1]);
+  IGNORE_EINTR(waitpid(child, nullptr, 0));
+}
+
 // Test that an invalid thread stack pointer still results in a minidump.
 TEST(MinidumpWriterTest, InvalidStackPointer) {
   int fds[2];
@@ -939,4 +1240,358 @@ TEST(MinidumpWriterTest, MinidumpSizeLimit) {
   IGNORE_EINTR(waitpid(child_pid, nullptr, 0));
 }
 
+
+TEST(MinidumpWriterTest, StacksCapturedConcurrently) {
+  static const int kNumberOfThreadsInHelperProgram = 10;
+
+  char number_of_threads_arg[3];
+  sprintf(number_of_threads_arg, "%d", kNumberOfThreadsInHelperProgram);
+
+  string helper_path(GetHelperBinary());
+  if (helper_path.empty()) {
+    FAIL() << "Couldn't find helper binary";
+    exit(1);
+  }
+
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  pid_t child_pid = fork();
+  if (child_pid == 0) {
+    // In child process.
+    close(fds[0]);
+
+    // Pass the pipe fd and the number of threads as arguments.
+    char pipe_fd_string[8];
+    sprintf(pipe_fd_string, "%d", fds[1]);
+    execl(helper_path.c_str(),
+          helper_path.c_str(),
+          pipe_fd_string,
+          number_of_threads_arg,
+          NULL);
+  }
+  close(fds[1]);
+
+  // Wait for all child threads to indicate that they have started
+  for (int threads = 0; threads < kNumberOfThreadsInHelperProgram; threads++) {
+    struct pollfd pfd;
+    memset(&pfd, 0, sizeof(pfd));
+    pfd.fd = fds[0];
+    pfd.events = POLLIN | POLLERR;
+
+    const int r = HANDLE_EINTR(poll(&pfd, 1, 1000));
+    ASSERT_EQ(1, r);
+    ASSERT_TRUE(pfd.revents & POLLIN);
+    uint8_t junk;
+    ASSERT_EQ(read(fds[0], &junk, sizeof(junk)),
+              static_cast<ssize_t>(sizeof(junk)));
+  }
+  close(fds[0]);
+
+  // As in MinidumpSizeLimit, give the threads time to reach the busy loop,
+  // which leaves their stacks unchanged between the two dumps.
+  usleep(100000);
+
+  AutoTempDir temp_dir;
+  string serial_dump = temp_dir.path() + "/minidump-writer-serial.dmp";
+  ASSERT_TRUE(WriteMinidump(serial_dump.c_str(), -1,
+                            child_pid, NULL, 0,
+                            MappingList(), AppMemoryList()));
+  string concurrent_dump =
+      temp_dir.path() + "/minidump-writer-concurrent.dmp";
+  ASSERT_TRUE(WriteMinidump(concurrent_dump.c_str(), -1,
+                            child_pid, NULL, 0,
+                            MappingList(), AppMemoryList(),
+                            false, 0, false, 4));
+
+  Minidump serial_minidump(serial_dump);
+  ASSERT_TRUE(serial_minidump.Read());
+  MinidumpThreadList* serial_threads = serial_minidump.GetThreadList();
+  ASSERT_TRUE(serial_threads);
+  Minidump concurrent_minidump(concurrent_dump);
+  ASSERT_TRUE(concurrent_minidump.Read());
+  MinidumpThreadList* concurrent_threads =
+      concurrent_minidump.GetThreadList();
+  ASSERT_TRUE(concurrent_threads);
+
+  // Both dumps hold the same threads, in the same order, with the same
+  // stacks.
+  ASSERT_EQ(static_cast<unsigned>(kNumberOfThreadsInHelperProgram),
+            concurrent_threads->thread_count());
+  ASSERT_EQ(serial_threads->thread_count(),
+            concurrent_threads->thread_count());
+  for (unsigned int i = 0; i < serial_threads->thread_count(); i++) {
+    MinidumpThread* serial_thread = serial_threads->GetThreadAtIndex(i);
+    MinidumpThread* concurrent_thread =
+        concurrent_threads->GetThreadAtIndex(i);
+    uint32_t serial_id, concurrent_id;
+    ASSERT_TRUE(serial_thread->GetThreadID(&serial_id));
+    ASSERT_TRUE(concurrent_thread->GetThreadID(&concurrent_id));
+    EXPECT_EQ(serial_id, concurrent_id);
+
+    MinidumpMemoryRegion* serial_memory = serial_thread->GetMemory();
+    MinidumpMemoryRegion* concurrent_memory = concurrent_thread->GetMemory();
+    ASSERT_TRUE(serial_memory != NULL);
+    ASSERT_TRUE(concurrent_memory != NULL);
+    EXPECT_EQ(serial_memory->GetBase(), concurrent_memory->GetBase());
+    ASSERT_EQ(serial_memory->GetSize(), concurrent_memory->GetSize());
+    EXPECT_EQ(0, memcmp(serial_memory->GetMemory(),
+                        concurrent_memory->GetMemory(),
+                        serial_memory->GetSize()));
+  }
+
+  // Kill the helper program.
+  kill(child_pid, SIGKILL);
+  IGNORE_EINTR(waitpid(child_pid, nullptr, 0));
+}
+
+
+TEST(MinidumpWriterTest, MemoryBudgetLimitsStacks) {
+  static const int kNumberOfThreadsInHelperProgram = 10;
+
+  char number_of_threads_arg[3];
+  sprintf(number_of_threads_arg, "%d", kNumberOfThreadsInHelperProgram);
+
+  string helper_path(GetHelperBinary());
+  if (helper_path.empty()) {
+    FAIL() << "Couldn't find helper binary";
+    exit(1);
+  }
+
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  pid_t child_pid = fork();
+  if (child_pid == 0) {
+    // In child process.
+    close(fds[0]);
+
+    // Pass the pipe fd and the number of threads as arguments.
+    char pipe_fd_string[8];
+    sprintf(pipe_fd_string, "%d", fds[1]);
+    execl(helper_path.c_str(),
+          helper_path.c_str(),
+          pipe_fd_string,
+          number_of_threads_arg,
+          NULL);
+  }
+  close(fds[1]);
+
+  // Wait for all child threads to indicate that they have started
+  for (int threads = 0; threads < kNumberOfThreadsInHelperProgram; threads++) {
+    struct pollfd pfd;
+    memset(&pfd, 0, sizeof(pfd));
+    pfd.fd = fds[0];
+    pfd.events = POLLIN | POLLERR;
+
+    const int r = HANDLE_EINTR(poll(&pfd, 1, 1000));
+    ASSERT_EQ(1, r);
+    ASSERT_TRUE(pfd.revents & POLLIN);
+    uint8_t junk;
+    ASSERT_EQ(read(fds[0], &junk, sizeof(junk)),
+              static_cast<ssize_t>(sizeof(junk)));
+  }
+  close(fds[0]);
+
+  // As in MinidumpSizeLimit, give the threads time to reach the busy loop.
+  usleep(100000);
+
+  AutoTempDir temp_dir;
+  string normal_dump = temp_dir.path() + "/minidump-writer-unittest.dmp";
+  ASSERT_TRUE(WriteMinidump(normal_dump.c_str(), -1,
+                            child_pid, NULL, 0,
+                            MappingList(), AppMemoryList()));
+  Minidump normal_minidump(normal_dump);
+  ASSERT_TRUE(normal_minidump.Read());
+  MinidumpThreadList* normal_threads = normal_minidump.GetThreadList();
+  ASSERT_TRUE(normal_threads);
+  ASSERT_EQ(static_cast<unsigned>(kNumberOfThreadsInHelperProgram),
+            normal_threads->thread_count());
+  size_t total_normal_stack_size = 0;
+  for (unsigned int i = 0; i < normal_threads->thread_count(); i++) {
+    MinidumpMemoryRegion* memory =
+        normal_threads->GetThreadAtIndex(i)->GetMemory();
+    ASSERT_TRUE(memory != NULL);
+    total_normal_stack_size += memory->GetSize();
+  }
+
+  // With half of that to spend, the first threads' stacks are dumped whole
+  // and the others are cut short, or left out.
+  const size_t memory_budget = total_normal_stack_size / 2;
+  string budget_dump = temp_dir.path() + "/minidump-writer-budget.dmp";
+  ASSERT_TRUE(WriteMinidump(budget_dump.c_str(), -1,
+                            child_pid, NULL, 0,
+                            MappingList(), AppMemoryList(),
+                            false, 0, false, 1, false, memory_budget));
+  Minidump budget_minidump(budget_dump);
+  ASSERT_TRUE(budget_minidump.Read());
+  MinidumpThreadList* budget_threads = budget_minidump.GetThreadList();
+  ASSERT_TRUE(budget_threads);
+  ASSERT_EQ(normal_threads->thread_count(), budget_threads->thread_count());
+  size_t total_budget_stack_size = 0;
+  for (unsigned int i = 0; i < budget_threads->thread_count(); i++) {
+    MinidumpMemoryRegion* memory =
+        budget_threads->GetThreadAtIndex(i)->GetMemory();
+    if (memory)
+      total_budget_stack_size += memory->GetSize();
+  }
+  EXPECT_LE(total_budget_stack_size, memory_budget);
+  EXPECT_GT(total_budget_stack_size, 0U);
+  EXPECT_EQ(normal_threads->GetThreadAtIndex(0)->GetMemory()->GetSize(),
+            budget_threads->GetThreadAtIndex(0)->GetMemory()->GetSize());
+
+  // Kill the helper program.
+  kill(child_pid, SIGKILL);
+  IGNORE_EINTR(waitpid(child_pid, nullptr, 0));
+}
+
+TEST(MinidumpWriterTest, MemoryBudgetIncludesPointedHeap) {
+  // A heap block that only the crashing thread's stack points to.
+  static const size_t kHeapBlockSize = 64;
+  char* volatile heap_block = static_cast<char*>(malloc(kHeapBlockSize));
+  ASSERT_TRUE(heap_block);
+  for (size_t i = 0; i < kHeapBlockSize; ++i)
+    heap_block[i] = static_cast<char>(0xa0 + i);
+
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  const pid_t child = fork();
+  if (child == 0) {
+    close(fds[1]);
+    char b;
+    IGNORE_RET(HANDLE_EINTR(read(fds[0], &b, sizeof(b))));
+    close(fds[0]);
+    syscall(__NR_exit_group);
+  }
+  close(fds[0]);
+
+  // The child's stack matches this one up to this frame, so this context
+  // serves as the child's.
+  ExceptionHandler::CrashContext context;
+  memset(&context, 0, sizeof(context));
+  ASSERT_EQ(0, getcontext(&context.context));
+  context.tid = child;
+
+  AutoTempDir temp_dir;
+  string budget_dump = temp_dir.path() + kMDWriterUnitTestFileName;
+  ASSERT_TRUE(WriteMinidump(budget_dump.c_str(), -1,
+                            child, &context, sizeof(context),
+                            MappingList(), AppMemoryList(),
+                            false, 0, false, 1, false, 256 * 1024));
+  close(fds[1]);
+  IGNORE_EINTR(waitpid(child, nullptr, 0));
+
+  Minidump minidump(budget_dump);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpMemoryList* memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(memory_list);
+  const uint64_t address = reinterpret_cast<uintptr_t>(heap_block);
+  MinidumpMemoryRegion* region =
+      memory_list->GetMemoryRegionForAddress(address);
+  ASSERT_TRUE(region);
+  ASSERT_LE(address + kHeapBlockSize, region->GetBase() + region->GetSize());
+  const uint8_t* data = region->GetMemory() + (address - region->GetBase());
+  for (size_t i = 0; i < kHeapBlockSize; ++i)
+    EXPECT_EQ(static_cast<uint8_t>(0xa0 + i), data[i]);
+  free(heap_block);
+}
+
+
+TEST(MinidumpWriterTest, StackSampleLimitsStacks) {
+  static const int kNumberOfThreadsInHelperProgram = 5;
+  static const size_t kStackSampleSize = 1024;
+
+  char number_of_threads_arg[3];
+  sprintf(number_of_threads_arg, "%d", kNumberOfThreadsInHelperProgram);
+
+  string helper_path(GetHelperBinary());
+  if (helper_path.empty()) {
+    FAIL() << "Couldn't find helper binary";
+    exit(1);
+  }
+
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  pid_t child_pid = fork();
+  if (child_pid == 0) {
+    // In child process.
+    close(fds[0]);
+
+    // Pass the pipe fd and the number of threads as arguments.
+    char pipe_fd_string[8];
+    sprintf(pipe_fd_string, "%d", fds[1]);
+    execl(helper_path.c_str(),
+          helper_path.c_str(),
+          pipe_fd_string,
+          number_of_threads_arg,
+          NULL);
+  }
+  close(fds[1]);
+
+  // Wait for all child threads to indicate that they have started
+  for (int threads = 0; threads < kNumberOfThreadsInHelperProgram; threads++) {
+    struct pollfd pfd;
+    memset(&pfd, 0, sizeof(pfd));
+    pfd.fd = fds[0];
+    pfd.events = POLLIN | POLLERR;
+
+    const int r = HANDLE_EINTR(poll(&pfd, 1, 1000));
+    ASSERT_EQ(1, r);
+    ASSERT_TRUE(pfd.revents & POLLIN);
+    uint8_t junk;
+    ASSERT_EQ(read(fds[0], &junk, sizeof(junk)),
+              static_cast<ssize_t>(sizeof(junk)));
+  }
+  close(fds[0]);
+
+  // As in MinidumpSizeLimit, give the threads time to reach the busy loop.
+  usleep(100000);
+
+  // Application memory is left out of a sample.
+  char app_memory[64];
+  AppMemoryList app_memory_list;
+  AppMemory app;
+  app.ptr = app_memory;
+  app.length = sizeof(app_memory);
+  app_memory_list.push_back(app);
+
+  AutoTempDir temp_dir;
+  string sample_dump = temp_dir.path() + "/minidump-writer-sample.dmp";
+  ASSERT_TRUE(WriteMinidump(sample_dump.c_str(), -1,
+                            child_pid, NULL, 0,
+                            MappingList(), app_memory_list,
+                            false, 0, false, 1, false, 0, false, NULL, NULL,
+                            NULL, kStackSampleSize));
+  Minidump minidump(sample_dump);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpThreadList* threads = minidump.GetThreadList();
+  ASSERT_TRUE(threads);
+  ASSERT_EQ(static_cast<unsigned>(kNumberOfThreadsInHelperProgram),
+            threads->thread_count());
+  for (unsigned int i = 0; i < threads->thread_count(); i++) {
+    MinidumpThread* thread = threads->GetThreadAtIndex(i);
+    MinidumpMemoryRegion* memory = thread->GetMemory();
+    ASSERT_TRUE(memory != NULL);
+    EXPECT_LE(memory->GetSize(), kStackSampleSize);
+
+    // The sample starts just below the stack pointer.
+    MinidumpContext* context = thread->GetContext();
+    ASSERT_TRUE(context);
+    uint64_t stack_pointer;
+    ASSERT_TRUE(context->GetStackPointer(&stack_pointer));
+    EXPECT_LE(memory->GetBase(), stack_pointer);
+    EXPECT_GT(memory->GetBase() + memory->GetSize(), stack_pointer);
+  }
+  MinidumpMemoryList* memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(memory_list);
+  EXPECT_FALSE(memory_list->GetMemoryRegionForAddress(
+      reinterpret_cast<uintptr_t>(app_memory)));
+
+  // Kill the helper program.
+  kill(child_pid, SIGKILL);
+  IGNORE_EINTR(waitpid(child_pid, nullptr, 0));
+}
+
 }  // namespace
@@ -0,0 +1,275 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// warm_dump_state.cc: Implement WarmDumpState.  See warm_dump_state.h for
+// details.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "client/linux/minidump_writer/warm_dump_state.h"
+
+#include <fcntl.h>
+#include <link.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#include <atomic>
+
+#include "client/linux/minidump_writer/file_identifier_cache.h"
+#include "common/linux/eintr_wrapper.h"
+#include "common/linux/linux_libc_support.h"
+#include "third_party/lss/linux_syscall_support.h"
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+namespace google_breakpad {
+
+namespace {
+
+// The files copied, named as the dumper asks for them.  The auxv is read
+// through the process's /proc directory, so it is found by OpenProcFile.
+const char* const kCopiedFiles[] = {
+  "/proc/cpuinfo",
+  "/etc/lsb-release",
+  "auxv",
+};
+const size_t kFileCount = sizeof(kCopiedFiles) / sizeof(kCopiedFiles[0]);
+const size_t kAuxvIndex = 2;
+
+// How often, in seconds, the thread checks for newly loaded libraries.
+const int kLibraryCheckInterval = 1;
+
+// The anonymous files holding the copies, or -1.  A replaced copy is only
+// closed by the next refresh, so that a signal handler that has just read
+// its descriptor still finds it open.
+std::atomic<int> g_copies[kFileCount] = {{-1}, {-1}, {-1}};
+int g_retired_copies[kFileCount] = {-1, -1, -1};
+
+// The process that the auxv was copied from.
+std::atomic<pid_t> g_pid(0);
+
+// Serializes refreshes.
+pthread_mutex_t g_refresh_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Serializes Start and Stop, and is held while the thread is joined.
+pthread_mutex_t g_control_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Guards the thread's settings below, and wakes the thread to stop it.
+pthread_mutex_t g_thread_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t g_thread_wake = PTHREAD_COND_INITIALIZER;
+int g_users = 0;
+int g_interval = 0;
+bool g_thread_running = false;
+pthread_t g_thread;
+
+// Copy the file at PATH into a new anonymous file, returning its
+// descriptor, or -1 on failure.
+int CopyToMemory(const char* path) {
+  const int fd = sys_open(path, O_RDONLY, 0);
+  if (fd < 0)
+    return -1;
+  const int copy = sys_memfd_create("breakpad-warm-state", MFD_CLOEXEC);
+  bool copied = copy >= 0;
+  char buffer[4096];
+  while (copied) {
+    const ssize_t r = HANDLE_EINTR(sys_read(fd, buffer, sizeof(buffer)));
+    if (r <= 0) {
+      copied = r == 0;
+      break;
+    }
+    for (ssize_t written = 0; copied && written < r;) {
+      const ssize_t w =
+          HANDLE_EINTR(sys_write(copy, buffer + written, r - written));
+      copied = w > 0;
+      written += w;
+    }
+  }
+  sys_close(fd);
+  if (!copied) {
+    if (copy >= 0)
+      sys_close(copy);
+    return -1;
+  }
+  return copy;
+}
+
+// Make COPY the copy of file INDEX, retiring the one it replaces.  Called
+// with g_refresh_mutex held.
+void Publish(size_t index, int copy) {
+  const int previous = g_copies[index].exchange(copy);
+  if (g_retired_copies[index] >= 0)
+    sys_close(g_retired_copies[index]);
+  g_retired_copies[index] = previous;
+}
+
+// Open the copy of file INDEX through /proc, which gives it an offset of
+// its own.  Signal-safe.
+int OpenCopy(size_t index) {
+  const int copy = g_copies[index].load(std::memory_order_acquire);
+  if (copy < 0)
+    return -1;
+  static const char kFdDirectory[] = "/proc/self/fd/";
+  char path[sizeof(kFdDirectory) + 10];
+  my_memcpy(path, kFdDirectory, sizeof(kFdDirectory) - 1);
+  const unsigned length = my_uint_len(copy);
+  my_uitos(path + sizeof(kFdDirectory) - 1, copy, length);
+  path[sizeof(kFdDirectory) - 1 + length] = '\0';
+  return sys_open(path, O_RDONLY, 0);
+}
+
+#if defined(__GLIBC__)
+int CountLibraryChanges(struct dl_phdr_info* info, size_t, void* data) {
+  *static_cast<unsigned long long*>(data) = info->dlpi_adds + info->dlpi_subs;
+  // Every object reports the same counts.
+  return 1;
+}
+#endif
+
+// Return a number that changes whenever a library is loaded or unloaded,
+// or 0 where the C library does not count them.
+unsigned long long LibraryGeneration() {
+  unsigned long long generation = 0;
+#if defined(__GLIBC__)
+  dl_iterate_phdr(CountLibraryChanges, &generation);
+#endif
+  return generation;
+}
+
+time_t MonotonicSeconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec;
+}
+
+void* RefreshThread(void*) {
+  unsigned long long generation = LibraryGeneration();
+  time_t last_refresh = MonotonicSeconds();
+  pthread_mutex_lock(&g_thread_mutex);
+  while (g_users > 0) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += kLibraryCheckInterval;
+    pthread_cond_timedwait(&g_thread_wake, &g_thread_mutex, &deadline);
+    if (g_users == 0)
+      break;
+    const int interval = g_interval;
+    pthread_mutex_unlock(&g_thread_mutex);
+
+    const unsigned long long current_generation = LibraryGeneration();
+    const time_t now = MonotonicSeconds();
+    if (now - last_refresh >= interval) {
+      WarmDumpState::Refresh();
+      last_refresh = now;
+    } else if (current_generation != generation) {
+      FileIdentifierCache::AddMappedFiles();
+    }
+    generation = current_generation;
+
+    pthread_mutex_lock(&g_thread_mutex);
+  }
+  pthread_mutex_unlock(&g_thread_mutex);
+  return NULL;
+}
+
+}  // namespace
+
+// static
+void WarmDumpState::Refresh() {
+  pthread_mutex_lock(&g_refresh_mutex);
+  g_pid = sys_getpid();
+  for (size_t i = 0; i < kFileCount; ++i) {
+    Publish(i, CopyToMemory(i == kAuxvIndex ? "/proc/self/auxv"
+                                            : kCopiedFiles[i]));
+  }
+  pthread_mutex_unlock(&g_refresh_mutex);
+  FileIdentifierCache::AddMappedFiles();
+}
+
+// static
+bool WarmDumpState::Start(int interval_seconds) {
+  if (interval_seconds < 1)
+    interval_seconds = 1;
+  Refresh();
+
+  pthread_mutex_lock(&g_control_mutex);
+  pthread_mutex_lock(&g_thread_mutex);
+  if (g_users == 0 || interval_seconds < g_interval)
+    g_interval = interval_seconds;
+  pthread_mutex_unlock(&g_thread_mutex);
+  bool started = g_thread_running;
+  if (!started) {
+    started = pthread_create(&g_thread, NULL, RefreshThread, NULL) == 0;
+    g_thread_running = started;
+  }
+  if (started) {
+    pthread_mutex_lock(&g_thread_mutex);
+    ++g_users;
+    pthread_mutex_unlock(&g_thread_mutex);
+  }
+  pthread_mutex_unlock(&g_control_mutex);
+  return started;
+}
+
+// static
+void WarmDumpState::Stop() {
+  pthread_mutex_lock(&g_control_mutex);
+  pthread_mutex_lock(&g_thread_mutex);
+  const bool last = g_users == 1;
+  if (g_users > 0)
+    --g_users;
+  pthread_cond_signal(&g_thread_wake);
+  pthread_mutex_unlock(&g_thread_mutex);
+  if (last && g_thread_running) {
+    pthread_join(g_thread, NULL);
+    g_thread_running = false;
+  }
+  pthread_mutex_unlock(&g_control_mutex);
+}
+
+// static
+int WarmDumpState::OpenFile(const char* path) {
+  for (size_t i = 0; i < kFileCount; ++i) {
+    if (i != kAuxvIndex && my_strcmp(path, kCopiedFiles[i]) == 0)
+      return OpenCopy(i);
+  }
+  return -1;
+}
+
+// static
+int WarmDumpState::OpenProcFile(pid_t pid, const char* name) {
+  if (pid != g_pid.load() || my_strcmp(name, kCopiedFiles[kAuxvIndex]) != 0)
+    return -1;
+  return OpenCopy(kAuxvIndex);
+}
+
+}  // namespace google_breakpad
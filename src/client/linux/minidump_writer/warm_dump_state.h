@@ -0,0 +1,74 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// warm_dump_state.h: Copies of the files that a minidump writer reads
+// which change rarely or never while a process runs, made before a crash
+// so that the dumper reads them from memory instead of asking the kernel
+// to generate them again.
+
+#ifndef CLIENT_LINUX_MINIDUMP_WRITER_WARM_DUMP_STATE_H_
+#define CLIENT_LINUX_MINIDUMP_WRITER_WARM_DUMP_STATE_H_
+
+#include <sys/types.h>
+
+namespace google_breakpad {
+
+// The state covers /proc/cpuinfo, /etc/lsb-release and the process's auxv,
+// each copied into an anonymous file in memory, and the identifiers of the
+// mapped modules, which it adds to FileIdentifierCache.  The mappings
+// themselves are not kept: they change with every thread created and
+// every allocation large enough to be mapped, so the dumper still reads
+// them at crash time.  There is one state per process.
+class WarmDumpState {
+ public:
+  // Copy the files and add the mapped modules' identifiers, replacing
+  // the earlier copies.  Not signal-safe.
+  static void Refresh();
+
+  // Refresh the state now, and then on a background thread every
+  // INTERVAL_SECONDS seconds.  The thread also adds the identifiers of
+  // newly loaded libraries within a second of their loading.  Calls nest:
+  // the thread runs, at the shortest interval asked for, until each call
+  // has been matched by a call to Stop.  Return false if the thread could
+  // not be started.  Not signal-safe.
+  static bool Start(int interval_seconds);
+  static void Stop();
+
+  // If the state holds a copy of the file at PATH, return a new file
+  // descriptor reading the copy from its start, or else -1.  This is
+  // signal-safe, and may run while another thread refreshes the state.
+  static int OpenFile(const char* path);
+
+  // As OpenFile, for the file NAME in PID's /proc directory.  Only the
+  // copies made for this process are found.
+  static int OpenProcFile(pid_t pid, const char* name);
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_MINIDUMP_WRITER_WARM_DUMP_STATE_H_
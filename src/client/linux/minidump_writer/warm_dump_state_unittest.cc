@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// warm_dump_state_unittest.cc: Unit tests for WarmDumpState.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "client/linux/minidump_writer/warm_dump_state.h"
+#include "common/linux/eintr_wrapper.h"
+
+using namespace google_breakpad;
+
+namespace {
+
+typedef testing::Test WarmDumpStateTest;
+
+// Read everything from FD, and close it.
+std::string ReadAll(int fd) {
+  std::string contents;
+  char buffer[4096];
+  ssize_t r;
+  while ((r = HANDLE_EINTR(read(fd, buffer, sizeof(buffer)))) > 0)
+    contents.append(buffer, r);
+  close(fd);
+  return contents;
+}
+
+std::string ReadFile(const char* path) {
+  const int fd = open(path, O_RDONLY);
+  return fd < 0 ? "" : ReadAll(fd);
+}
+
+}  // namespace
+
+TEST(WarmDumpStateTest, CopiesFiles) {
+  WarmDumpState::Refresh();
+
+  const int auxv = WarmDumpState::OpenProcFile(getpid(), "auxv");
+  ASSERT_GE(auxv, 0);
+  std::string expected_auxv = ReadFile("/proc/self/auxv");
+  ASSERT_FALSE(expected_auxv.empty());
+  EXPECT_EQ(expected_auxv, ReadAll(auxv));
+
+  // Each copy is read from its start, however often it is opened.
+  std::string expected_cpuinfo = ReadFile("/proc/cpuinfo");
+  if (!expected_cpuinfo.empty()) {
+    for (int i = 0; i < 2; ++i) {
+      const int cpuinfo = WarmDumpState::OpenFile("/proc/cpuinfo");
+      ASSERT_GE(cpuinfo, 0);
+      std::string copy = ReadAll(cpuinfo);
+      // Clock speeds may change; the first line does not.
+      std::string first_line =
+          expected_cpuinfo.substr(0, expected_cpuinfo.find('\n'));
+      EXPECT_EQ(0U, copy.find(first_line));
+    }
+  }
+}
+
+TEST(WarmDumpStateTest, OnlyCopiedFilesFound) {
+  WarmDumpState::Refresh();
+  EXPECT_EQ(-1, WarmDumpState::OpenFile("/proc/version"));
+  EXPECT_EQ(-1, WarmDumpState::OpenProcFile(getpid(), "maps"));
+
+  // The auxv belongs to this process only.
+  const pid_t child = fork();
+  if (child == 0)
+    _exit(WarmDumpState::OpenProcFile(getpid(), "auxv") == -1 ? 0 : 1);
+  int status;
+  ASSERT_EQ(child, HANDLE_EINTR(waitpid(child, &status, 0)));
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+}
+
+TEST(WarmDumpStateTest, StartAndStopNest) {
+  ASSERT_TRUE(WarmDumpState::Start(60));
+  ASSERT_TRUE(WarmDumpState::Start(1));
+  WarmDumpState::Stop();
+  const int auxv = WarmDumpState::OpenProcFile(getpid(), "auxv");
+  ASSERT_GE(auxv, 0);
+  close(auxv);
+  WarmDumpState::Stop();
+  // An unmatched Stop does nothing.
+  WarmDumpState::Stop();
+}
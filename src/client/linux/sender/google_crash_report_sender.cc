@@ -60,6 +60,8 @@ DEFINE_string(proxy_host, "",
               "Proxy host");
 DEFINE_string(proxy_userpasswd, "",
               "Proxy username/password in user:pass format.");
+DEFINE_bool(compress, false,
+            "Compress the uploads with gzip as they are sent.");
 
 
 bool CheckForRequiredFlagsOrDie() {
@@ -87,6 +89,8 @@ bool CheckForRequiredFlagsOrDie() {
   return true;
 }
 
+// Any arguments after the flags name more minidumps, which are uploaded
+// after the one named by --minidump_path over the same connection.
 int main(int argc, char* argv[]) {
   google::InitGoogleLogging(argv[0]);
   google::ParseCommandLineFlags(&argc, &argv, true);
@@ -104,5 +108,11 @@ int main(int argc, char* argv[]) {
                                              FLAGS_crash_server,
                                              FLAGS_proxy_host,
                                              FLAGS_proxy_userpasswd);
-  g.Upload(NULL, NULL, NULL);
+  g.set_compress_uploads(FLAGS_compress);
+  bool success = g.Upload(NULL, NULL, NULL);
+  for (int i = 1; i < argc; ++i) {
+    g.set_minidump_pathname(argv[i]);
+    success = g.Upload(NULL, NULL, NULL) && success;
+  }
+  return success ? 0 : 1;
 }
@@ -162,6 +162,14 @@ typedef bool (*BreakpadFilterCallback)(int exception_type,
 //                                will write the dump file in-process and then
 //                                launch the reporter executable as a child
 //                                process.
+//
+// BREAKPAD_PRELAUNCH_INSPECTOR   A boolean NSNumber value. If YES, Breakpad
+//                                launches the Inspector when it is created
+//                                and leaves it waiting, so that a crash is
+//                                handed to a running Inspector instead of
+//                                waiting for one to launch.  The Inspector
+//                                exits when this process does.  Ignored
+//                                with BREAKPAD_IN_PROCESS.
 //=============================================================================
 // The BREAKPAD_PRODUCT, BREAKPAD_VERSION and BREAKPAD_URL are
 // required to have non-NULL values.  By default, the BREAKPAD_PRODUCT
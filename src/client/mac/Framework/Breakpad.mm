@@ -167,6 +167,7 @@ class Breakpad {
     : handler_(NULL),
       config_params_(NULL),
       send_and_exit_(true),
+      inspector_prelaunched_(false),
       filter_callback_(NULL),
       filter_callback_context_(NULL) {
     inspector_path_[0] = 0;
@@ -178,6 +179,10 @@ class Breakpad {
 
   bool ExtractParameters(NSDictionary* parameters);
 
+  // Launches the Inspector now, and sets inspector_prelaunched_ if it is
+  // waiting for a crash.
+  void PrelaunchInspector();
+
   // Dispatches to HandleException()
   static bool ExceptionHandlerDirectCallback(void* context,
                                              int exception_type,
@@ -213,6 +218,9 @@ class Breakpad {
 
   bool                    send_and_exit_;  // Exit after sending, if true
 
+  // The Inspector is already running, waiting on its service port.
+  bool                    inspector_prelaunched_;
+
   BreakpadFilterCallback  filter_callback_;
   void*                   filter_callback_context_;
 };
@@ -410,6 +418,9 @@ bool Breakpad::InitializeOutOfProcess(NSDictionary* parameters) {
     return false;
   }
 
+  if ([[parameters objectForKey:@BREAKPAD_PRELAUNCH_INSPECTOR] boolValue])
+    PrelaunchInspector();
+
   // Create the handler (allocating it in our special protected pool)
   handler_ =
       new (gBreakpadAllocator->Allocate(
@@ -419,6 +430,26 @@ bool Breakpad::InitializeOutOfProcess(NSDictionary* parameters) {
   return true;
 }
 
+//=============================================================================
+void Breakpad::PrelaunchInspector() {
+  // Once committed to launching, the service stays registered until the
+  // Inspector checks it out or this process exits.
+  inspector_.LaunchOnDemand();
+
+  InspectorPrelaunchInfo prelaunch;
+  prelaunch.client_pid = getpid();
+  MachSendMessage message(kMsgType_InspectorPrelaunch);
+  message.SetData(&prelaunch, sizeof(prelaunch));
+
+  MachPortSender sender(inspector_.GetServicePort());
+  kern_return_t result = sender.SendMessage(message, 2000);
+  inspector_prelaunched_ = result == KERN_SUCCESS;
+
+#if VERBOSE
+  PRINT_MACH_RESULT(result, "Breakpad: prelaunch SendMessage ");
+#endif
+}
+
 //=============================================================================
 Breakpad::~Breakpad() {
   // Note that we don't use operator delete() on these pointers,
@@ -687,15 +718,17 @@ bool Breakpad::HandleException(int exception_type,
     if (!should_handle) return false;
   }
 
-  // We need to reset the memory protections to be read/write,
-  // since LaunchOnDemand() requires changing state.
-  gBreakpadAllocator->Unprotect();
-  // Configure the server to launch when we message the service port.
-  // The reason we do this here, rather than at startup, is that we
-  // can leak a bootstrap service entry if this method is called and
-  // there never ends up being a crash.
-  inspector_.LaunchOnDemand();
-  gBreakpadAllocator->Protect();
+  if (!inspector_prelaunched_) {
+    // We need to reset the memory protections to be read/write,
+    // since LaunchOnDemand() requires changing state.
+    gBreakpadAllocator->Unprotect();
+    // Configure the server to launch when we message the service port.
+    // The reason we do this here, rather than at startup, is that we
+    // can leak a bootstrap service entry if this method is called and
+    // there never ends up being a crash.
+    inspector_.LaunchOnDemand();
+    gBreakpadAllocator->Protect();
+  }
 
   // The Inspector should send a message to this port to verify it
   // received our information and has finished the inspection.
@@ -36,13 +36,15 @@
 
 #import "client/mac/crash_generation/ConfigFile.h"
 #import "client/mac/handler/minidump_generator.h"
+#import "common/mac/MachIPC.h"
 
 
 // Types of mach messsages (message IDs)
 enum {
   kMsgType_InspectorInitialInfo = 0,    // data is InspectorInfo
   kMsgType_InspectorKeyValuePair = 1,   // data is KeyValueMessageData
-  kMsgType_InspectorAcknowledgement = 2 // no data sent
+  kMsgType_InspectorAcknowledgement = 2,// no data sent
+  kMsgType_InspectorPrelaunch = 3       // data is InspectorPrelaunchInfo
 };
 
 // Initial information sent from the crashed process by
@@ -57,6 +59,13 @@ struct InspectorInfo {
   unsigned int  parameter_count;  // key-value pairs
 };
 
+// Sent by Breakpad.framework to launch the Inspector ahead of a crash.
+// The Inspector then waits for kMsgType_InspectorInitialInfo for as long
+// as the process that launched it is alive.
+struct InspectorPrelaunchInfo {
+  pid_t         client_pid;
+};
+
 // Key/value message data to be sent to the Inspector
 struct KeyValueMessageData {
  public:
@@ -110,7 +119,7 @@ class MinidumpLocation {
 //=============================================================================
 class Inspector {
  public:
-  Inspector() {}
+  Inspector() : client_pid_(0) {}
 
   // given a bootstrap service name, receives mach messages
   // from a crashed process, then inspects it, creates a minidump file
@@ -135,6 +144,12 @@ class Inspector {
 
   kern_return_t   ReadMessages();
 
+  // Waits for the initial message of a request.  A prelaunched Inspector
+  // waits for as long as its client is alive; otherwise the request must
+  // come at once.
+  kern_return_t   WaitForRequest(ReceivePort* receive_port,
+                                 MachReceiveMessage* message);
+
   bool            InspectTask();
   kern_return_t   SendAcknowledgement();
 
@@ -152,6 +167,9 @@ class Inspector {
   mach_port_t     handler_thread_;
   mach_port_t     ack_port_;
 
+  // The process that launched this Inspector ahead of a crash, or 0.
+  pid_t           client_pid_;
+
   SimpleStringDictionary config_params_;
 
   ConfigFile      config_file_;
@@ -29,8 +29,10 @@
 // Utility that can inspect another process and write a crash dump
 
 #include <cstdio>
+#include <errno.h>
 #include <iostream>
 #include <servers/bootstrap.h>
+#include <signal.h>
 #include <stdio.h>
 #include <string.h>
 #include <string>
@@ -59,7 +61,9 @@ void Inspector::Inspect(const char* receive_port_name) {
 
   result = ServiceCheckIn(receive_port_name);
 
-  if (result == KERN_SUCCESS) {
+  // A prelaunched Inspector handles every request its client makes, until
+  // the client crashes or exits.
+  while (result == KERN_SUCCESS) {
     result = ReadMessages();
 
     if (result == KERN_SUCCESS) {
@@ -89,10 +93,14 @@ void Inspector::Inspect(const char* receive_port_name) {
       // lives on, and we might be needed again in the future.
       if (exception_code_) {
         ServiceCheckOut(receive_port_name);
+        break;
       }
     } else {
         PRINT_MACH_RESULT(result, "Inspector: WaitForMessage()");
     }
+
+    if (!client_pid_)
+      break;
   }
 }
 
@@ -194,9 +202,12 @@ kern_return_t Inspector::ReadMessages() {
   ReceivePort receive_port(service_rcv_port_);
 
   MachReceiveMessage message;
-  kern_return_t result = receive_port.WaitForMessage(&message, 1000);
+  kern_return_t result = WaitForRequest(&receive_port, &message);
 
   if (result == KERN_SUCCESS) {
+    // Nothing is kept from an earlier on-demand request.
+    config_params_ = SimpleStringDictionary();
+
     InspectorInfo& info = (InspectorInfo&)*message.GetData();
     exception_type_ = info.exception_type;
     exception_code_ = info.exception_code;
@@ -261,6 +272,33 @@ kern_return_t Inspector::ReadMessages() {
   return result;
 }
 
+//=============================================================================
+kern_return_t Inspector::WaitForRequest(ReceivePort* receive_port,
+                                        MachReceiveMessage* message) {
+  for (;;) {
+    kern_return_t result = receive_port->WaitForMessage(message, 1000);
+
+    if (result == KERN_SUCCESS &&
+        message->GetMessageID() == kMsgType_InspectorPrelaunch) {
+      // Launched ahead of time: everything up to here is done before the
+      // client crashes, so it is only kept waiting for the inspection.
+      InspectorPrelaunchInfo& prelaunch =
+          (InspectorPrelaunchInfo&)*message->GetData();
+      client_pid_ = prelaunch.client_pid;
+      continue;
+    }
+
+    // The client can't tell a prelaunched Inspector that it is exiting,
+    // so check that it is still there now and then.
+    if (result == MACH_RCV_TIMED_OUT && client_pid_ &&
+        (kill(client_pid_, 0) == 0 || errno != ESRCH)) {
+      continue;
+    }
+
+    return result;
+  }
+}
+
 //=============================================================================
 bool Inspector::InspectTask() {
   // keep the task quiet while we're looking at it
@@ -42,11 +42,13 @@ extern "C" { // needed to compile on Leopard
 #include <AvailabilityMacros.h>
 #include <dlfcn.h>
 #include <mach/task_info.h>
+#include <pthread.h>
 #include <sys/sysctl.h>
 #include <TargetConditionals.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <new>
 #include <string>
 #include <vector>
 
@@ -258,6 +260,7 @@ bool FindTextSection(DynamicImage& image) {
 
   bool found_text_section = false;
   bool found_dylib_id_command = false;
+  bool found_uuid_command = false;
   for (unsigned int i = 0; cmd && (i < header->ncmds); ++i) {
     if (!found_text_section) {
       if (cmd->cmd == MachBits::segment_load_command) {
@@ -288,7 +291,18 @@ bool FindTextSection(DynamicImage& image) {
       }
     }
 
-    if (found_dylib_id_command && found_text_section) {
+    if (!found_uuid_command) {
+      if (cmd->cmd == LC_UUID) {
+        const struct uuid_command* uc =
+            reinterpret_cast<const struct uuid_command*>(cmd);
+
+        memcpy(image.uuid_, uc->uuid, sizeof(image.uuid_));
+        image.has_uuid_ = true;
+        found_uuid_command = true;
+      }
+    }
+
+    if (found_dylib_id_command && found_text_section && found_uuid_command) {
       return true;
     }
 
@@ -300,7 +314,7 @@ bool FindTextSection(DynamicImage& image) {
 }
 
 //==============================================================================
-// Initializes vmaddr_, vmsize_, and slide_
+// Initializes vmaddr_, vmsize_, slide_, version_ and uuid_
 void DynamicImage::CalculateMemoryAndVersionInfo() {
   // unless we can process the header, ensure that calls to
   // IsValid() will return false
@@ -308,6 +322,7 @@ void DynamicImage::CalculateMemoryAndVersionInfo() {
   vmsize_ = 0;
   slide_ = 0;
   version_ = 0;
+  has_uuid_ = false;
 
   // The function template above does all the real work.
   if (Is64Bit())
@@ -367,45 +382,27 @@ static uint64_t LookupSymbol(const char* symbol_name,
   return list.n_value;
 }
 
-#if TARGET_OS_IPHONE || MAC_OS_X_VERSION_MIN_REQUIRED >= MAC_OS_X_VERSION_10_6
-static bool HasTaskDyldInfo() {
-  return true;
-}
-#else
-static SInt32 GetOSVersionInternal() {
-  SInt32 os_version = 0;
-  Gestalt(gestaltSystemVersion, &os_version);
-  return os_version;
-}
-
-static SInt32 GetOSVersion() {
-  static SInt32 os_version = GetOSVersionInternal();
-  return os_version;
-}
-
-static bool HasTaskDyldInfo() {
-  return GetOSVersion() >= 0x1060;
-}
-#endif  // TARGET_OS_IPHONE || MAC_OS_X_VERSION_MIN_REQUIRED >= 10_6
-
 uint64_t DynamicImages::GetDyldAllImageInfosPointer() {
-  if (HasTaskDyldInfo()) {
-    task_dyld_info_data_t task_dyld_info;
-    mach_msg_type_number_t count = TASK_DYLD_INFO_COUNT;
-    if (task_info(task_, TASK_DYLD_INFO, (task_info_t)&task_dyld_info,
-                  &count) != KERN_SUCCESS) {
-      return 0;
-    }
-
+  // The kernel knows where dyld keeps its image list, so ask it first
+  // rather than checking the OS version: TASK_DYLD_INFO fails cleanly on
+  // systems older than Mac OS X 10.6.  Only then is dyld's symbol table
+  // read from disk and scanned for _dyld_all_image_infos, which costs I/O
+  // and a walk over every symbol while the handler starts or a crash is
+  // being written.
+  task_dyld_info_data_t task_dyld_info;
+  mach_msg_type_number_t count = TASK_DYLD_INFO_COUNT;
+  if (task_info(task_, TASK_DYLD_INFO, (task_info_t)&task_dyld_info,
+                &count) == KERN_SUCCESS &&
+      task_dyld_info.all_image_info_addr) {
     return (uint64_t)task_dyld_info.all_image_info_addr;
-  } else {
-    const char* imageSymbolName = "_dyld_all_image_infos";
-    const char* dyldPath = "/usr/lib/dyld";
-
-    if (Is64Bit())
-      return LookupSymbol<MachO64>(imageSymbolName, dyldPath, cpu_type_);
-    return LookupSymbol<MachO32>(imageSymbolName, dyldPath, cpu_type_);
   }
+
+  const char* imageSymbolName = "_dyld_all_image_infos";
+  const char* dyldPath = "/usr/lib/dyld";
+
+  if (Is64Bit())
+    return LookupSymbol<MachO64>(imageSymbolName, dyldPath, cpu_type_);
+  return LookupSymbol<MachO32>(imageSymbolName, dyldPath, cpu_type_);
 }
 
 //==============================================================================
@@ -573,4 +570,127 @@ cpu_type_t DynamicImages::DetermineTaskCPUType(task_t task) {
   return GetNativeCPUType();
 }
 
+#pragma mark -
+
+static DyldImageCache* g_dyld_image_cache = NULL;
+static pthread_once_t g_dyld_image_cache_once = PTHREAD_ONCE_INIT;
+
+//==============================================================================
+// static
+DyldImageCache* DyldImageCache::Enable() {
+  pthread_once(&g_dyld_image_cache_once, Create);
+  return g_dyld_image_cache;
+}
+
+//==============================================================================
+// static
+DyldImageCache* DyldImageCache::Get() {
+  return g_dyld_image_cache;
+}
+
+//==============================================================================
+// static
+void DyldImageCache::Create() {
+  vm_address_t address = 0;
+  if (vm_allocate(mach_task_self(),
+                  &address,
+                  round_page(sizeof(DyldImageCache)),
+                  VM_FLAGS_ANYWHERE) != KERN_SUCCESS)
+    return;
+
+  g_dyld_image_cache = new (reinterpret_cast<void*>(address)) DyldImageCache();
+
+  // dyld calls AddImage for each image that is already loaded before this
+  // returns.
+  _dyld_register_func_for_add_image(AddImage);
+  _dyld_register_func_for_remove_image(RemoveImage);
+  SetWritable(false);
+}
+
+//==============================================================================
+// static
+void DyldImageCache::SetWritable(bool writable) {
+  vm_protect(mach_task_self(),
+             reinterpret_cast<vm_address_t>(g_dyld_image_cache),
+             round_page(sizeof(DyldImageCache)),
+             FALSE,
+             writable ? VM_PROT_READ | VM_PROT_WRITE : VM_PROT_READ);
+}
+
+//==============================================================================
+// static
+void DyldImageCache::AddImage(const struct mach_header* header,
+                              intptr_t slide) {
+  DyldImageCache* cache = g_dyld_image_cache;
+
+  // Reuse the entry of an image that has been removed, if there is one.
+  int index = 0;
+  while (index < cache->entry_count_ &&
+         cache->entries_[index].load_address != 0) {
+    ++index;
+  }
+
+  if (index == kMaxEntries) {
+    if (!cache->overflowed_) {
+      SetWritable(true);
+      cache->overflowed_ = true;
+      SetWritable(false);
+    }
+    return;
+  }
+
+  // The load commands are parsed in place, as they are for other tasks.
+  const breakpad_mach_header* image_header =
+      reinterpret_cast<const breakpad_mach_header*>(header);
+  DynamicImage image(reinterpret_cast<uint8_t*>(
+                         const_cast<breakpad_mach_header*>(image_header)),
+                     sizeof(*image_header) + image_header->sizeofcmds,
+                     reinterpret_cast<uintptr_t>(header),
+                     string(),
+                     0,
+                     mach_task_self(),
+                     DynamicImages::GetNativeCPUType());
+  if (!image.IsValid())
+    return;
+
+  // dyld keeps the path for as long as the image is loaded.
+  Dl_info info;
+  const char* file_path = NULL;
+  if (dladdr(header, &info))
+    file_path = info.dli_fname;
+
+  SetWritable(true);
+  Entry& entry = cache->entries_[index];
+  entry.base_address = image.GetVMAddr() + slide;
+  entry.size = image.GetVMSize();
+  entry.file_path = file_path;
+  entry.version = image.GetVersion();
+  entry.file_type = image.GetFileType();
+  entry.cpu_type = header->cputype;
+  entry.has_uuid = image.GetUUID(entry.uuid);
+  // The entry is only used once everything else in it is set.
+  __sync_synchronize();
+  entry.load_address = reinterpret_cast<uintptr_t>(header);
+  if (index == cache->entry_count_)
+    ++cache->entry_count_;
+  SetWritable(false);
+}
+
+//==============================================================================
+// static
+void DyldImageCache::RemoveImage(const struct mach_header* header,
+                                 intptr_t /* slide */) {
+  DyldImageCache* cache = g_dyld_image_cache;
+  const uint64_t load_address = reinterpret_cast<uintptr_t>(header);
+
+  for (int i = 0; i < cache->entry_count_; ++i) {
+    if (cache->entries_[i].load_address == load_address) {
+      SetWritable(true);
+      cache->entries_[i].load_address = 0;
+      SetWritable(false);
+      return;
+    }
+  }
+}
+
 }  // namespace google_breakpad
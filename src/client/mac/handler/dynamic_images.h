@@ -39,6 +39,7 @@
 #include <mach/mach.h>
 #include <mach-o/dyld.h>
 #include <mach-o/loader.h>
+#include <string.h>
 #include <sys/types.h>
 
 #include <string>
@@ -121,6 +122,7 @@ class DynamicImage {
       vmsize_(0),
       slide_(0),
       version_(0),
+      has_uuid_(false),
       file_path_(file_path),
       file_mod_date_(image_mod_date),
       task_(task),
@@ -161,6 +163,15 @@ class DynamicImage {
   bool Is64Bit() { return (GetCPUType() & CPU_ARCH_ABI64) == CPU_ARCH_ABI64; }
 
   uint32_t GetVersion() {return version_;}
+
+  // Copies the image's LC_UUID into |uuid|. Returns false if the image has
+  // none.
+  bool GetUUID(uint8_t uuid[16]) const {
+    if (has_uuid_)
+      memcpy(uuid, uuid_, sizeof(uuid_));
+    return has_uuid_;
+  }
+
   // For sorting
   bool operator<(const DynamicImage& inInfo) {
     return GetLoadAddress() < inInfo.GetLoadAddress();
@@ -179,7 +190,7 @@ class DynamicImage {
   template<typename MachBits>
   friend uint32_t GetFileTypeFromHeader(DynamicImage& image);
 
-  // Initializes vmaddr_, vmsize_, and slide_
+  // Initializes vmaddr_, vmsize_, slide_, version_ and uuid_
   void CalculateMemoryAndVersionInfo();
 
   const vector<uint8_t>   header_;        // our local copy of the header
@@ -189,6 +200,8 @@ class DynamicImage {
   mach_vm_size_t          vmsize_;
   ptrdiff_t               slide_;
   uint32_t                version_;        // Dylib version
+  bool                    has_uuid_;
+  uint8_t                 uuid_[16];       // from LC_UUID
   string                  file_path_;     // path dyld used to load the image
   uintptr_t               file_mod_date_;  // time_t of image file
 
@@ -307,6 +320,68 @@ class DynamicImages {
   vector<DynamicImageRef>  image_list_;
 };
 
+//==============================================================================
+// A cache of the images loaded in the current task, kept up to date from
+// dyld's add and remove image callbacks.  An in-process minidump reads its
+// module list from here, rather than walking dyld's image list and reading
+// each binary's identifier from disk at crash time.  The entries are kept
+// in their own pages, which are read-only except while an image is being
+// added or removed, in the same way as ProtectedMemoryAllocator.
+class DyldImageCache {
+ public:
+  struct Entry {
+    // Address of the image's mach_header; 0 for an unused entry.
+    uint64_t load_address;
+    // The image's __TEXT segment, with the slide applied.
+    uint64_t base_address;
+    uint64_t size;
+    // Path dyld loaded the image from; owned by dyld.
+    const char* file_path;
+    uint32_t version;
+    uint32_t file_type;
+    cpu_type_t cpu_type;
+    bool has_uuid;
+    uint8_t uuid[16];
+  };
+
+  // The most images the cache holds at once.
+  static const int kMaxEntries = 4096;
+
+  // Starts caching the images of the current task, if it has not been
+  // started already, and returns the cache.  dyld's callbacks cannot be
+  // removed, so the cache lasts as long as the task.  Returns NULL if its
+  // memory cannot be allocated.
+  static DyldImageCache* Enable();
+
+  // Returns the cache, or NULL if Enable has not been called.
+  static DyldImageCache* Get();
+
+  // Whether every loaded image has an entry.  False once more images have
+  // been loaded at once than the cache holds.
+  bool IsComplete() const {return !overflowed_;}
+
+  // The number of entries to look through, some of which may be unused.
+  int GetEntryCount() const {return entry_count_;}
+  const Entry& GetEntry(int i) const {return entries_[i];}
+
+ private:
+  DyldImageCache() : entry_count_(0), overflowed_(false) {}
+
+  // Allocates the cache and registers the dyld callbacks.
+  static void Create();
+
+  // dyld callbacks.  dyld calls them one at a time.
+  static void AddImage(const struct mach_header* header, intptr_t slide);
+  static void RemoveImage(const struct mach_header* header, intptr_t slide);
+
+  // Makes the cache's pages writable or read-only.
+  static void SetWritable(bool writable);
+
+  Entry entries_[kMaxEntries];
+  int entry_count_;
+  bool overflowed_;
+};
+
 // Fill bytes with the contents of memory at a particular
 // location in another task.
 kern_return_t ReadTaskMemory(task_port_t target_task,
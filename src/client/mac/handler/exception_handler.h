@@ -104,7 +104,9 @@ class ExceptionHandler {
   // an unhandled exception occurs.  If it is false, minidumps will only
   // be written when WriteMinidump is called.
   // If port_name is non-NULL, attempt to perform out-of-process dump generation
-  // If port_name is NULL, in-process dump generation will be used.
+  // If port_name is NULL, in-process dump generation will be used.  In that
+  // case, calling DyldImageCache::Enable() beforehand lets the module list
+  // be written without reading each module's identifier at crash time.
   ExceptionHandler(const string& dump_path,
                    FilterCallback filter, MinidumpCallback callback,
                    void* callback_context, bool install_handler,
@@ -38,6 +38,7 @@
 #define mach_vm_address_t vm_address_t
 #define mach_vm_deallocate vm_deallocate
 #define mach_vm_read vm_read
+#define mach_vm_read_overwrite vm_read_overwrite
 #define mach_vm_region_recurse vm_region_recurse_64
 #define mach_vm_size_t vm_size_t
 #else
@@ -30,6 +30,10 @@
 #include <config.h>  // Must come first
 #endif
 
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <cstdio>
 
@@ -37,9 +41,11 @@
 #include <mach/machine.h>
 #include <mach/vm_statistics.h>
 #include <mach-o/dyld.h>
+#include <mach-o/dyld_images.h>
 #include <mach-o/loader.h>
 #include <sys/sysctl.h>
 #include <sys/resource.h>
+#include <sys/stat.h>
 
 #include <CoreFoundation/CoreFoundation.h>
 
@@ -55,6 +61,9 @@
 #include <mach/i386/thread_status.h>
 #endif
 
+#include "client/breadcrumb_writer.h"
+#include "client/crashpad_info_writer.h"
+#include "client/mac/handler/raw_capture.h"
 #include "client/minidump_file_writer-inl.h"
 #include "common/mac/file_id.h"
 #include "common/mac/macho_id.h"
@@ -73,6 +82,163 @@ using mach_o::FileID;
 #define LC_SEGMENT_ARCH LC_SEGMENT
 #endif
 
+// The records of a raw capture, read back to be converted.
+struct MinidumpGenerator::RawCaptureContents {
+  struct Thread {
+    RawCaptureThread record;
+    const uint8_t* stack;
+  };
+  struct Image {
+    RawCaptureImage record;
+    string path;
+  };
+
+  RawCaptureHeader header;
+  vector<uint8_t> data;
+  vector<Thread> threads;
+  vector<Image> images;
+
+  const Thread* FindThread(uint32_t thread_id) const {
+    for (size_t i = 0; i < threads.size(); ++i) {
+      if (threads[i].record.thread_id == thread_id)
+        return &threads[i];
+    }
+    return NULL;
+  }
+};
+
+namespace {
+
+// Writes the records of a raw capture after its header, batching them in a
+// buffer supplied by the caller.  Nothing is allocated, and memory that
+// turns out to be unreadable makes a write fail rather than fault.
+class RawCaptureFileWriter {
+ public:
+  RawCaptureFileWriter(int fd, char* buffer, size_t buffer_size)
+      : fd_(fd),
+        buffer_(buffer),
+        buffer_size_(buffer_size),
+        buffer_used_(0),
+        buffer_offset_(sizeof(RawCaptureHeader)) {}
+
+  // Append a record, which must fit in the buffer.
+  bool Append(const void* data, size_t size) {
+    if (size > buffer_size_ - buffer_used_ && !Flush())
+      return false;
+    if (size > buffer_size_)
+      return false;
+    memcpy(buffer_ + buffer_used_, data, size);
+    buffer_used_ += size;
+    return true;
+  }
+
+  // Append |size| bytes of this task's memory at |address|, without
+  // copying them through the buffer.
+  bool AppendMemory(uint64_t address, size_t size) {
+    if (!Flush())
+      return false;
+    if (!WriteAt(buffer_offset_,
+                 reinterpret_cast<const void*>(
+                     static_cast<uintptr_t>(address)),
+                 size)) {
+      return false;
+    }
+    buffer_offset_ += size;
+    return true;
+  }
+
+  bool Flush() {
+    if (!buffer_used_)
+      return true;
+    if (!WriteAt(buffer_offset_, buffer_, buffer_used_))
+      return false;
+    buffer_offset_ += buffer_used_;
+    buffer_used_ = 0;
+    return true;
+  }
+
+  bool WriteAt(off_t offset, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size) {
+      ssize_t written = pwrite(fd_, bytes, size, offset);
+      if (written < 0 && errno == EINTR)
+        continue;
+      if (written <= 0)
+        return false;
+      bytes += written;
+      size -= written;
+      offset += written;
+    }
+    return true;
+  }
+
+ private:
+  int fd_;
+  char* buffer_;
+  size_t buffer_size_;
+  size_t buffer_used_;
+  // Where the buffer's contents go in the file.
+  off_t buffer_offset_;
+};
+
+// Copy the record at |*offset| of a raw capture, which may not be aligned,
+// and move past it.
+template <typename T>
+bool ReadRawCaptureRecord(const vector<uint8_t>& data, size_t* offset,
+                          T* record) {
+  if (data.size() - *offset < sizeof(T))
+    return false;
+  memcpy(record, &data[*offset], sizeof(T));
+  *offset += sizeof(T);
+  return true;
+}
+
+// Fill in the identity of a raw capture's image that the capture doesn't
+// have, from the image of the same path that this task has loaded, which
+// is taken to be the same build.  Failing that, only the identifier is read
+// from the file.  Returns false if neither is found.
+bool FindRawCaptureImageIdentity(DyldImageCache::Entry* entry) {
+  uint32_t image_count = _dyld_image_count();
+  for (uint32_t i = 0; i < image_count; ++i) {
+    const char* name = _dyld_get_image_name(i);
+    if (!name || strcmp(name, entry->file_path) != 0)
+      continue;
+
+    const breakpad_mach_header* header =
+        reinterpret_cast<const breakpad_mach_header*>(
+            _dyld_get_image_header(i));
+    if (!header)
+      return false;
+    // Placed at the captured image's address, so that the segment is
+    // where it was in the crashed task.
+    DynamicImage image(reinterpret_cast<uint8_t*>(
+                           const_cast<breakpad_mach_header*>(header)),
+                       sizeof(*header) + header->sizeofcmds,
+                       entry->load_address,
+                       string(),
+                       0,
+                       mach_task_self(),
+                       DynamicImages::GetNativeCPUType());
+    if (!image.IsValid())
+      return false;
+    entry->base_address = image.GetVMAddr() + image.GetVMAddrSlide();
+    entry->size = image.GetVMSize();
+    entry->version = image.GetVersion();
+    entry->cpu_type = header->cputype;
+    entry->has_uuid = image.GetUUID(entry->uuid);
+    return true;
+  }
+
+  FileID file_id(entry->file_path);
+  entry->base_address = entry->load_address;
+  entry->has_uuid = file_id.MachoIdentifier(entry->cpu_type,
+                                            CPU_SUBTYPE_MULTIPLE,
+                                            entry->uuid);
+  return entry->has_uuid;
+}
+
+}  // namespace
+
 // constructor when generating from within the crashed process
 MinidumpGenerator::MinidumpGenerator()
     : writer_(),
@@ -85,6 +251,12 @@ MinidumpGenerator::MinidumpGenerator()
       cpu_type_(DynamicImages::GetNativeCPUType()),
       task_context_(NULL),
       dynamic_images_(NULL),
+      raw_capture_(NULL),
+      annotations_(NULL),
+      breadcrumbs_(NULL),
+      task_memory_(&allocator_),
+      task_memory_buffer_(0),
+      task_memory_buffer_size_(0),
       memory_blocks_(&allocator_) {
   GatherSystemInformation();
 }
@@ -103,6 +275,12 @@ MinidumpGenerator::MinidumpGenerator(mach_port_t crashing_task,
       cpu_type_(DynamicImages::GetNativeCPUType()),
       task_context_(NULL),
       dynamic_images_(NULL),
+      raw_capture_(NULL),
+      annotations_(NULL),
+      breadcrumbs_(NULL),
+      task_memory_(&allocator_),
+      task_memory_buffer_(0),
+      task_memory_buffer_size_(0),
       memory_blocks_(&allocator_) {
   if (crashing_task != mach_task_self()) {
     dynamic_images_ = new DynamicImages(crashing_task_);
@@ -116,6 +294,7 @@ MinidumpGenerator::MinidumpGenerator(mach_port_t crashing_task,
 }
 
 MinidumpGenerator::~MinidumpGenerator() {
+  ReleaseTaskMemory();
   delete dynamic_images_;
 }
 
@@ -240,6 +419,11 @@ bool MinidumpGenerator::Write(const char* path) {
   };
   bool result = false;
 
+  // Read everything needed from another task at once, so the writers below
+  // don't each have to go back to the kernel.
+  if (dynamic_images_)
+    PrefetchTaskMemory();
+
   // If opening was successful, create the header, directory, and call each
   // writer.  The destructor for the TypedMDRVAs will cause the data to be
   // flushed.  The destructor for the MinidumpFileWriter will close the file.
@@ -257,15 +441,35 @@ bool MinidumpGenerator::Write(const char* path) {
     if (!exception_thread_ && !exception_type_)
       --writer_count;
 
+    // The annotations and breadcrumbs can only be read from this task;
+    // their streams are written after the others.
+    WriteStreamFN task_writers[2];
+    int task_writer_count = 0;
+    if (crashing_task_ == mach_task_self() && !raw_capture_) {
+      if (annotations_) {
+        task_writers[task_writer_count++] =
+            &MinidumpGenerator::WriteCrashpadInfoStream;
+      }
+      if (breadcrumbs_) {
+        task_writers[task_writer_count++] =
+            &MinidumpGenerator::WriteBreadcrumbStream;
+      }
+    }
+
     // Add space for all writers
-    if (!dir.AllocateArray(writer_count))
+    if (!dir.AllocateArray(writer_count + task_writer_count))
       return false;
 
     MDRawHeader* header_ptr = header.get();
     header_ptr->signature = MD_HEADER_SIGNATURE;
     header_ptr->version = MD_HEADER_VERSION;
-    time(reinterpret_cast<time_t*>(&(header_ptr->time_date_stamp)));
-    header_ptr->stream_count = writer_count;
+    if (raw_capture_) {
+      header_ptr->time_date_stamp =
+          static_cast<uint32_t>(raw_capture_->header.time_date_stamp);
+    } else {
+      time(reinterpret_cast<time_t*>(&(header_ptr->time_date_stamp)));
+    }
+    header_ptr->stream_count = writer_count + task_writer_count;
     header_ptr->stream_directory_rva = dir.position();
 
     MDRawDirectory local_dir;
@@ -276,11 +480,209 @@ bool MinidumpGenerator::Write(const char* path) {
       if (result)
         dir.CopyIndex(i, &local_dir);
     }
+
+    for (int i = 0; (result) && (i < task_writer_count); ++i) {
+      result = (this->*task_writers[i])(&local_dir);
+
+      if (result)
+        dir.CopyIndex(writer_count + i, &local_dir);
+    }
+  }
+  // A compressed minidump is only written once the header and directory
+  // are in place.
+  if (result && writer_.streaming())
+    result = writer_.Close();
+  ReleaseTaskMemory();
+  return result;
+}
+
+bool MinidumpGenerator::WriteRawCapture(int fd, char* buffer,
+                                        size_t buffer_size) {
+  if (crashing_task_ != mach_task_self())
+    return false;
+
+  RawCaptureFileWriter file(fd, buffer, buffer_size);
+  RawCaptureHeader header;
+  memset(&header, 0, sizeof(header));
+  header.version = kRawCaptureVersion;
+  header.cpu_type = cpu_type_;
+  header.exception_type = exception_type_;
+  header.exception_code = exception_code_;
+  header.exception_subcode = exception_subcode_;
+  header.exception_thread = exception_thread_;
+  header.handler_thread = handler_thread_;
+  header.time_date_stamp = time(NULL);
+
+  thread_act_port_array_t threads_for_task;
+  mach_msg_type_number_t thread_count;
+
+  if (task_threads(crashing_task_, &threads_for_task, &thread_count))
+    return false;
+
+  RawCaptureThread thread;
+  for (unsigned int i = 0; i < thread_count; ++i) {
+    if (threads_for_task[i] == handler_thread_)
+      continue;
+
+    breakpad_thread_state_data_t state;
+    mach_msg_type_number_t state_count
+        = static_cast<mach_msg_type_number_t>(sizeof(state));
+    if (!GetThreadState(threads_for_task[i], state, &state_count))
+      return false;
+
+    memset(&thread, 0, sizeof(thread));
+    thread.thread_id = threads_for_task[i];
+    thread.state_size = kRawCaptureMaxStateSize;
+    memcpy(thread.state, state, kRawCaptureMaxStateSize);
+    thread.stack_start = CurrentSPForStack(state);
+    thread.stack_size = CalculateStackSize(thread.stack_start);
+    if (!file.Append(&thread, sizeof(thread)) ||
+        !file.AppendMemory(thread.stack_start, thread.stack_size)) {
+      return false;
+    }
+    ++header.thread_count;
+  }
+
+  // The images' identities are copied from the DyldImageCache when it has
+  // them all, and otherwise left to be found when the capture is converted.
+  RawCaptureImage image;
+  DyldImageCache* cache = DyldImageCache::Get();
+  if (cache && cache->IsComplete()) {
+    for (int i = 0; i < cache->GetEntryCount(); ++i) {
+      const DyldImageCache::Entry& entry = cache->GetEntry(i);
+      if (!entry.load_address)
+        continue;
+      const char* path = entry.file_path ? entry.file_path : "";
+      memset(&image, 0, sizeof(image));
+      image.load_address = entry.load_address;
+      image.has_identity = 1;
+      image.has_uuid = entry.has_uuid;
+      image.base_address = entry.base_address;
+      image.size = entry.size;
+      image.version = entry.version;
+      image.file_type = entry.file_type;
+      image.cpu_type = entry.cpu_type;
+      memcpy(image.uuid, entry.uuid, sizeof(image.uuid));
+      image.path_size = static_cast<uint32_t>(strlen(path));
+      if (!file.Append(&image, sizeof(image)) ||
+          !file.Append(path, image.path_size)) {
+        return false;
+      }
+      ++header.image_count;
+    }
+  } else {
+    task_dyld_info_data_t dyld_info;
+    mach_msg_type_number_t dyld_info_count = TASK_DYLD_INFO_COUNT;
+    if (task_info(crashing_task_, TASK_DYLD_INFO,
+                  reinterpret_cast<task_info_t>(&dyld_info),
+                  &dyld_info_count) != KERN_SUCCESS) {
+      return false;
+    }
+    const struct dyld_all_image_infos* all_image_infos =
+        reinterpret_cast<const struct dyld_all_image_infos*>(
+            dyld_info.all_image_info_addr);
+    // infoArray is NULL while dyld is changing it.
+    const struct dyld_image_info* image_infos = all_image_infos->infoArray;
+    uint32_t image_count = image_infos ? all_image_infos->infoArrayCount : 0;
+    for (uint32_t i = 0; i < image_count; ++i) {
+      if (!image_infos[i].imageLoadAddress)
+        continue;
+      const char* path = image_infos[i].imageFilePath;
+      if (!path)
+        path = "";
+      memset(&image, 0, sizeof(image));
+      image.load_address =
+          reinterpret_cast<uintptr_t>(image_infos[i].imageLoadAddress);
+      image.file_type = image_infos[i].imageLoadAddress->filetype;
+      image.path_size = static_cast<uint32_t>(strlen(path));
+      if (!file.Append(&image, sizeof(image)) ||
+          !file.Append(path, image.path_size)) {
+        return false;
+      }
+      ++header.image_count;
+    }
+  }
+
+  // The header goes last, so that a capture that was cut short is never
+  // mistaken for a whole one.
+  if (!file.Flush())
+    return false;
+  header.signature = kRawCaptureSignature;
+  return file.WriteAt(0, &header, sizeof(header));
+}
+
+bool MinidumpGenerator::WriteFromRawCapture(const char* raw_capture_path,
+                                            const char* path) {
+  if (dynamic_images_)
+    return false;
+
+  RawCaptureContents contents;
+  int fd = open(raw_capture_path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  bool read_ok = fstat(fd, &st) == 0 &&
+                 st.st_size >= static_cast<off_t>(sizeof(RawCaptureHeader));
+  if (read_ok) {
+    contents.data.resize(st.st_size);
+    read_ok = read(fd, &contents.data[0], st.st_size) == st.st_size;
+  }
+  close(fd);
+  if (!read_ok)
+    return false;
+
+  size_t offset = 0;
+  RawCaptureHeader& header = contents.header;
+  if (!ReadRawCaptureRecord(contents.data, &offset, &header) ||
+      header.signature != kRawCaptureSignature ||
+      header.version != kRawCaptureVersion) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < header.thread_count; ++i) {
+    RawCaptureContents::Thread thread;
+    if (!ReadRawCaptureRecord(contents.data, &offset, &thread.record) ||
+        thread.record.state_size > kRawCaptureMaxStateSize ||
+        contents.data.size() - offset < thread.record.stack_size) {
+      return false;
+    }
+    thread.stack = &contents.data[0] + offset;
+    offset += thread.record.stack_size;
+    contents.threads.push_back(thread);
   }
+
+  for (uint32_t i = 0; i < header.image_count; ++i) {
+    RawCaptureContents::Image image;
+    if (!ReadRawCaptureRecord(contents.data, &offset, &image.record) ||
+        contents.data.size() - offset < image.record.path_size) {
+      return false;
+    }
+    image.path.assign(reinterpret_cast<const char*>(&contents.data[offset]),
+                      image.record.path_size);
+    offset += image.record.path_size;
+    contents.images.push_back(image);
+  }
+
+  cpu_type_ = header.cpu_type;
+  handler_thread_ = header.handler_thread;
+  SetExceptionInformation(header.exception_type, header.exception_code,
+                          header.exception_subcode, header.exception_thread);
+  raw_capture_ = &contents;
+  bool result = Write(path);
+  raw_capture_ = NULL;
   return result;
 }
 
 size_t MinidumpGenerator::CalculateStackSize(mach_vm_address_t start_addr) {
+  if (raw_capture_) {
+    for (size_t i = 0; i < raw_capture_->threads.size(); ++i) {
+      const RawCaptureThread& thread = raw_capture_->threads[i].record;
+      if (thread.stack_start == start_addr)
+        return static_cast<size_t>(thread.stack_size);
+    }
+    return 0;
+  }
+
   mach_vm_address_t stack_region_base = start_addr;
   mach_vm_size_t stack_region_size;
   natural_t nesting_level = 0;
@@ -366,25 +768,173 @@ bool MinidumpGenerator::WriteStackFromStartAddress(
     if (!memory.Allocate(size))
       return false;
 
-    if (dynamic_images_) {
-      vector<uint8_t> stack_memory;
-      if (ReadTaskMemory(crashing_task_,
-                         start_addr,
-                         size,
-                         stack_memory) != KERN_SUCCESS) {
-        return false;
+    result = CopyTaskMemory(&memory, start_addr, size);
+  }
+
+  stack_location->start_of_memory_range = start_addr;
+  stack_location->memory = memory.location();
+
+  return result;
+}
+
+void MinidumpGenerator::PrefetchTaskMemory() {
+  // Don't hold on to more than this much of the crashed task at once.
+  // Anything past it is read on its own when it is written.
+  const vm_size_t kMaxTaskMemorySize = 32 * 1024 * 1024;  // bytes
+
+  ReleaseTaskMemory();
+
+  thread_act_port_array_t threads_for_task;
+  mach_msg_type_number_t thread_count;
+
+  if (task_threads(crashing_task_, &threads_for_task, &thread_count))
+    return;
+
+  for (unsigned int i = 0; i < thread_count; ++i) {
+    if (threads_for_task[i] != handler_thread_) {
+      breakpad_thread_state_data_t state;
+      mach_msg_type_number_t state_count
+          = static_cast<mach_msg_type_number_t>(sizeof(state));
+
+      if (GetThreadState(threads_for_task[i], state, &state_count)) {
+        mach_vm_address_t start_addr = CurrentSPForStack(state);
+        PlanTaskMemory(start_addr, CalculateStackSize(start_addr));
       }
+    }
+    mach_port_deallocate(mach_task_self(), threads_for_task[i]);
+  }
+  vm_deallocate(mach_task_self(),
+                reinterpret_cast<vm_address_t>(threads_for_task),
+                thread_count * sizeof(*threads_for_task));
+
+  MDMemoryDescriptor ip_memory;
+  if (GetIPMemoryRange(&ip_memory)) {
+    PlanTaskMemory(ip_memory.start_of_memory_range,
+                   ip_memory.memory.data_size);
+  }
+
+  if (task_memory_.empty())
+    return;
 
-      result = memory.Copy(&stack_memory[0], size);
+  // Merge ranges that overlap or touch, so that neighbouring stacks and
+  // the code around the IP are read with a single call.
+  std::sort(task_memory_.begin(), task_memory_.end());
+  size_t merged_count = 1;
+  for (size_t i = 1; i < task_memory_.size(); ++i) {
+    TaskMemoryRange& last = task_memory_[merged_count - 1];
+    const TaskMemoryRange& range = task_memory_[i];
+    if (range.start <= last.start + last.size) {
+      last.size = std::max(last.size, range.start + range.size - last.start);
     } else {
-      result = memory.Copy(reinterpret_cast<const void*>(start_addr), size);
+      task_memory_[merged_count++] = range;
     }
   }
+  task_memory_.resize(merged_count);
 
-  stack_location->start_of_memory_range = start_addr;
-  stack_location->memory = memory.location();
+  vm_size_t buffer_size = 0;
+  for (size_t i = 0; i < task_memory_.size(); ++i) {
+    if (buffer_size + task_memory_[i].size <= kMaxTaskMemorySize)
+      buffer_size += task_memory_[i].size;
+  }
+  if (buffer_size == 0 ||
+      vm_allocate(mach_task_self(), &task_memory_buffer_, buffer_size,
+                  VM_FLAGS_ANYWHERE) != KERN_SUCCESS) {
+    task_memory_buffer_ = 0;
+    return;
+  }
+  task_memory_buffer_size_ = buffer_size;
+
+  vm_size_t offset = 0;
+  for (size_t i = 0; i < task_memory_.size(); ++i) {
+    TaskMemoryRange& range = task_memory_[i];
+    if (offset + range.size > buffer_size)
+      continue;
+
+    mach_vm_address_t local_address = task_memory_buffer_ + offset;
+    mach_vm_size_t bytes_read = 0;
+    kern_return_t ret = mach_vm_read_overwrite(crashing_task_,
+                                               range.start,
+                                               range.size,
+                                               local_address,
+                                               &bytes_read);
+    if (ret == KERN_SUCCESS && bytes_read == range.size) {
+      range.data = reinterpret_cast<const uint8_t*>(local_address);
+      offset += range.size;
+    }
+  }
+}
 
-  return result;
+void MinidumpGenerator::PlanTaskMemory(mach_vm_address_t start_addr,
+                                       mach_vm_size_t size) {
+  if (start_addr == 0 || size == 0)
+    return;
+
+  // mach_vm_read_overwrite works on whole pages.
+  mach_vm_address_t page_mask = getpagesize() - 1;
+  TaskMemoryRange range;
+  range.start = start_addr & ~page_mask;
+  range.size = ((start_addr + size + page_mask) & ~page_mask) - range.start;
+  range.data = NULL;
+  task_memory_.push_back(range);
+}
+
+void MinidumpGenerator::ReleaseTaskMemory() {
+  if (task_memory_buffer_) {
+    vm_deallocate(mach_task_self(), task_memory_buffer_,
+                  task_memory_buffer_size_);
+    task_memory_buffer_ = 0;
+    task_memory_buffer_size_ = 0;
+  }
+  task_memory_.clear();
+}
+
+const uint8_t* MinidumpGenerator::FindPrefetchedMemory(
+    mach_vm_address_t start_addr,
+    size_t size) const {
+  for (size_t i = 0; i < task_memory_.size(); ++i) {
+    const TaskMemoryRange& range = task_memory_[i];
+    if (range.start > start_addr)
+      break;
+    if (range.data && start_addr + size <= range.start + range.size)
+      return range.data + (start_addr - range.start);
+  }
+  return NULL;
+}
+
+bool MinidumpGenerator::CopyTaskMemory(UntypedMDRVA* memory,
+                                       mach_vm_address_t start_addr,
+                                       size_t size) {
+  if (raw_capture_) {
+    // Converting a raw capture, which only has the stacks.
+    for (size_t i = 0; i < raw_capture_->threads.size(); ++i) {
+      const RawCaptureContents::Thread& thread = raw_capture_->threads[i];
+      if (start_addr >= thread.record.stack_start &&
+          start_addr - thread.record.stack_start <= thread.record.stack_size &&
+          size <= thread.record.stack_start + thread.record.stack_size -
+                      start_addr) {
+        return memory->Copy(
+            thread.stack + (start_addr - thread.record.stack_start), size);
+      }
+    }
+    return false;
+  }
+
+  if (!dynamic_images_) {
+    // In-process, just copy from local memory.
+    return memory->Copy(reinterpret_cast<const void*>(start_addr), size);
+  }
+
+  // Out-of-process, use what PrefetchTaskMemory read if it covers this
+  // range, and go to the task otherwise.
+  const uint8_t* prefetched = FindPrefetchedMemory(start_addr, size);
+  if (prefetched)
+    return memory->Copy(prefetched, size);
+
+  vector<uint8_t> bytes;
+  if (ReadTaskMemory(crashing_task_, start_addr, size, bytes) != KERN_SUCCESS)
+    return false;
+
+  return memory->Copy(&bytes[0], size);
 }
 
 bool MinidumpGenerator::WriteStack(breakpad_thread_state_data_t state,
@@ -472,6 +1022,35 @@ uint64_t MinidumpGenerator::CurrentPCForStack(
   }
 }
 
+uint64_t MinidumpGenerator::CurrentSPForStack(
+    breakpad_thread_state_data_t state) {
+  switch (cpu_type_) {
+#ifdef HAS_ARM_SUPPORT
+    case CPU_TYPE_ARM:
+      return CurrentSPForStackARM(state);
+#endif
+#ifdef HAS_ARM64_SUPPORT
+    case CPU_TYPE_ARM64:
+      return CurrentSPForStackARM64(state);
+#endif
+#ifdef HAS_PPC_SUPPORT
+    case CPU_TYPE_POWERPC:
+      return CurrentSPForStackPPC(state);
+    case CPU_TYPE_POWERPC64:
+      return CurrentSPForStackPPC64(state);
+#endif
+#ifdef HAS_X86_SUPPORT
+    case CPU_TYPE_I386:
+      return CurrentSPForStackX86(state);
+    case CPU_TYPE_X86_64:
+      return CurrentSPForStackX86_64(state);
+#endif
+    default:
+      assert(0 && "Unknown CPU type!");
+      return 0;
+  }
+}
+
 #ifdef HAS_ARM_SUPPORT
 bool MinidumpGenerator::WriteStackARM(breakpad_thread_state_data_t state,
                                       MDMemoryDescriptor* stack_location) {
@@ -489,6 +1068,14 @@ MinidumpGenerator::CurrentPCForStackARM(breakpad_thread_state_data_t state) {
   return REGISTER_FROM_THREADSTATE(machine_state, pc);
 }
 
+uint64_t
+MinidumpGenerator::CurrentSPForStackARM(breakpad_thread_state_data_t state) {
+  arm_thread_state_t* machine_state =
+      reinterpret_cast<arm_thread_state_t*>(state);
+
+  return REGISTER_FROM_THREADSTATE(machine_state, sp);
+}
+
 bool MinidumpGenerator::WriteContextARM(breakpad_thread_state_data_t state,
                                         MDLocationDescriptor* register_location)
 {
@@ -546,6 +1133,14 @@ MinidumpGenerator::CurrentPCForStackARM64(breakpad_thread_state_data_t state) {
   return REGISTER_FROM_THREADSTATE(machine_state, pc);
 }
 
+uint64_t
+MinidumpGenerator::CurrentSPForStackARM64(breakpad_thread_state_data_t state) {
+  arm_thread_state64_t* machine_state =
+      reinterpret_cast<arm_thread_state64_t*>(state);
+
+  return REGISTER_FROM_THREADSTATE(machine_state, sp);
+}
+
 bool
 MinidumpGenerator::WriteContextARM64(breakpad_thread_state_data_t state,
                                      MDLocationDescriptor* register_location)
@@ -630,6 +1225,14 @@ MinidumpGenerator::CurrentPCForStackPPC(breakpad_thread_state_data_t state) {
   return REGISTER_FROM_THREADSTATE(machine_state, srr0);
 }
 
+uint64_t
+MinidumpGenerator::CurrentSPForStackPPC(breakpad_thread_state_data_t state) {
+  ppc_thread_state_t* machine_state =
+      reinterpret_cast<ppc_thread_state_t*>(state);
+
+  return REGISTER_FROM_THREADSTATE(machine_state, r1);
+}
+
 uint64_t
 MinidumpGenerator::CurrentPCForStackPPC64(breakpad_thread_state_data_t state) {
   ppc_thread_state64_t* machine_state =
@@ -638,6 +1241,14 @@ MinidumpGenerator::CurrentPCForStackPPC64(breakpad_thread_state_data_t state) {
   return REGISTER_FROM_THREADSTATE(machine_state, srr0);
 }
 
+uint64_t
+MinidumpGenerator::CurrentSPForStackPPC64(breakpad_thread_state_data_t state) {
+  ppc_thread_state64_t* machine_state =
+      reinterpret_cast<ppc_thread_state64_t*>(state);
+
+  return REGISTER_FROM_THREADSTATE(machine_state, r1);
+}
+
 bool MinidumpGenerator::WriteContextPPC(breakpad_thread_state_data_t state,
                                         MDLocationDescriptor* register_location)
 {
@@ -799,6 +1410,14 @@ MinidumpGenerator::CurrentPCForStackX86(breakpad_thread_state_data_t state) {
   return REGISTER_FROM_THREADSTATE(machine_state, eip);
 }
 
+uint64_t
+MinidumpGenerator::CurrentSPForStackX86(breakpad_thread_state_data_t state) {
+  i386_thread_state_t* machine_state =
+      reinterpret_cast<i386_thread_state_t*>(state);
+
+  return REGISTER_FROM_THREADSTATE(machine_state, esp);
+}
+
 uint64_t
 MinidumpGenerator::CurrentPCForStackX86_64(breakpad_thread_state_data_t state) {
   x86_thread_state64_t* machine_state =
@@ -807,6 +1426,14 @@ MinidumpGenerator::CurrentPCForStackX86_64(breakpad_thread_state_data_t state) {
   return REGISTER_FROM_THREADSTATE(machine_state, rip);
 }
 
+uint64_t
+MinidumpGenerator::CurrentSPForStackX86_64(breakpad_thread_state_data_t state) {
+  x86_thread_state64_t* machine_state =
+      reinterpret_cast<x86_thread_state64_t*>(state);
+
+  return REGISTER_FROM_THREADSTATE(machine_state, rsp);
+}
+
 bool MinidumpGenerator::WriteContextX86(breakpad_thread_state_data_t state,
                                         MDLocationDescriptor* register_location)
 {
@@ -898,6 +1525,18 @@ bool MinidumpGenerator::WriteContextX86_64(
 bool MinidumpGenerator::GetThreadState(thread_act_t target_thread,
                                        thread_state_t state,
                                        mach_msg_type_number_t* count) {
+  if (raw_capture_) {
+    const RawCaptureContents::Thread* thread =
+        raw_capture_->FindThread(target_thread);
+    if (!thread)
+      return false;
+    size_t final_size = std::min(static_cast<size_t>(*count),
+                                 static_cast<size_t>(thread->record.state_size));
+    memcpy(state, thread->record.state, final_size);
+    *count = static_cast<mach_msg_type_number_t>(final_size);
+    return true;
+  }
+
   if (task_context_ && target_thread == mach_thread_self()) {
     switch (cpu_type_) {
 #ifdef HAS_ARM_SUPPORT
@@ -992,6 +1631,9 @@ bool MinidumpGenerator::WriteThreadStream(mach_port_t thread_id,
 
 bool MinidumpGenerator::WriteThreadListStream(
     MDRawDirectory* thread_list_stream) {
+  if (raw_capture_)
+    return WriteRawCaptureThreadListStream(thread_list_stream);
+
   TypedMDRVA<MDRawThreadList> list(&writer_);
   thread_act_port_array_t threads_for_task;
   mach_msg_type_number_t thread_count;
@@ -1031,60 +1673,100 @@ bool MinidumpGenerator::WriteThreadListStream(
   return true;
 }
 
+bool MinidumpGenerator::WriteRawCaptureThreadListStream(
+    MDRawDirectory* thread_list_stream) {
+  TypedMDRVA<MDRawThreadList> list(&writer_);
+  uint32_t thread_count =
+      static_cast<uint32_t>(raw_capture_->threads.size());
+
+  if (!list.AllocateObjectAndArray(thread_count, sizeof(MDRawThread)))
+    return false;
+
+  thread_list_stream->stream_type = MD_THREAD_LIST_STREAM;
+  thread_list_stream->location = list.location();
+
+  list.get()->number_of_threads = thread_count;
+
+  MDRawThread thread;
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    memset(&thread, 0, sizeof(MDRawThread));
+
+    if (!WriteThreadStream(raw_capture_->threads[i].record.thread_id,
+                           &thread)) {
+      return false;
+    }
+
+    list.CopyIndexAfterObject(i, &thread, sizeof(MDRawThread));
+  }
+
+  return true;
+}
+
+bool MinidumpGenerator::GetIPMemoryRange(MDMemoryDescriptor* ip_memory) {
+  const size_t kIPMemorySize = 256;  // bytes
+  // A raw capture has no memory but the stacks.
+  if (!exception_thread_ || !exception_type_ || raw_capture_)
+    return false;
+
+  breakpad_thread_state_data_t state;
+  mach_msg_type_number_t stateCount
+    = static_cast<mach_msg_type_number_t>(sizeof(state));
+
+  if (!GetThreadState(exception_thread_, state, &stateCount))
+    return false;
+
+  uint64_t ip = CurrentPCForStack(state);
+  // Bound it to the upper and lower bounds of the region
+  // it's contained within. If it's not in a known memory region,
+  // don't bother trying to write it.
+  mach_vm_address_t addr = static_cast<vm_address_t>(ip);
+  mach_vm_size_t size;
+  natural_t nesting_level = 0;
+  vm_region_submap_info_64 info;
+  mach_msg_type_number_t info_count = VM_REGION_SUBMAP_INFO_COUNT_64;
+  vm_region_recurse_info_t recurse_info;
+  recurse_info = reinterpret_cast<vm_region_recurse_info_t>(&info);
+
+  kern_return_t ret =
+    mach_vm_region_recurse(crashing_task_,
+                           &addr,
+                           &size,
+                           &nesting_level,
+                           recurse_info,
+                           &info_count);
+  if (ret != KERN_SUCCESS || ip < addr || ip >= (addr + size))
+    return false;
+
+  // Try to get 128 bytes before and after the IP, but
+  // settle for whatever's available.
+  memset(ip_memory, 0, sizeof(*ip_memory));
+  ip_memory->start_of_memory_range =
+    std::max(uintptr_t(addr),
+             uintptr_t(ip - (kIPMemorySize / 2)));
+  uintptr_t end_of_range =
+    std::min(uintptr_t(ip + (kIPMemorySize / 2)),
+             uintptr_t(addr + size));
+  uintptr_t range_diff = end_of_range -
+      static_cast<uintptr_t>(ip_memory->start_of_memory_range);
+  ip_memory->memory.data_size = static_cast<uint32_t>(range_diff);
+  return true;
+}
+
 bool MinidumpGenerator::WriteMemoryListStream(
     MDRawDirectory* memory_list_stream) {
   TypedMDRVA<MDRawMemoryList> list(&writer_);
 
   // If the dump has an exception, include some memory around the
   // instruction pointer.
-  const size_t kIPMemorySize = 256;  // bytes
   bool have_ip_memory = false;
   MDMemoryDescriptor ip_memory_d;
-  if (exception_thread_ && exception_type_) {
-    breakpad_thread_state_data_t state;
-    mach_msg_type_number_t stateCount
-      = static_cast<mach_msg_type_number_t>(sizeof(state));
-
-    if (GetThreadState(exception_thread_, state, &stateCount)) {
-      uint64_t ip = CurrentPCForStack(state);
-      // Bound it to the upper and lower bounds of the region
-      // it's contained within. If it's not in a known memory region,
-      // don't bother trying to write it.
-      mach_vm_address_t addr = static_cast<vm_address_t>(ip);
-      mach_vm_size_t size;
-      natural_t nesting_level = 0;
-      vm_region_submap_info_64 info;
-      mach_msg_type_number_t info_count = VM_REGION_SUBMAP_INFO_COUNT_64;
-      vm_region_recurse_info_t recurse_info;
-      recurse_info = reinterpret_cast<vm_region_recurse_info_t>(&info);
-
-      kern_return_t ret =
-        mach_vm_region_recurse(crashing_task_,
-                               &addr,
-                               &size,
-                               &nesting_level,
-                               recurse_info,
-                               &info_count);
-      if (ret == KERN_SUCCESS && ip >= addr && ip < (addr + size)) {
-        // Try to get 128 bytes before and after the IP, but
-        // settle for whatever's available.
-        ip_memory_d.start_of_memory_range =
-          std::max(uintptr_t(addr),
-                   uintptr_t(ip - (kIPMemorySize / 2)));
-        uintptr_t end_of_range = 
-          std::min(uintptr_t(ip + (kIPMemorySize / 2)),
-                   uintptr_t(addr + size));
-        uintptr_t range_diff = end_of_range -
-            static_cast<uintptr_t>(ip_memory_d.start_of_memory_range);
-        ip_memory_d.memory.data_size = static_cast<uint32_t>(range_diff);
-        have_ip_memory = true;
-        // This needs to get appended to the list even though
-        // the memory bytes aren't filled in yet so the entire
-        // list can be written first. The memory bytes will get filled
-        // in after the memory list is written.
-        memory_blocks_.push_back(ip_memory_d);
-      }
-    }
+  if (GetIPMemoryRange(&ip_memory_d)) {
+    have_ip_memory = true;
+    // This needs to get appended to the list even though
+    // the memory bytes aren't filled in yet so the entire
+    // list can be written first. The memory bytes will get filled
+    // in after the memory list is written.
+    memory_blocks_.push_back(ip_memory_d);
   }
 
   // Now fill in the memory list and write it.
@@ -1110,23 +1792,9 @@ bool MinidumpGenerator::WriteMemoryListStream(
     if (!ip_memory.Allocate(ip_memory_d.memory.data_size))
       return false;
 
-    if (dynamic_images_) {
-      // Out-of-process.
-      vector<uint8_t> memory;
-      if (ReadTaskMemory(crashing_task_,
-                         ip_memory_d.start_of_memory_range,
-                         ip_memory_d.memory.data_size,
-                         memory) != KERN_SUCCESS) {
-        return false;
-      }
-
-      ip_memory.Copy(&memory[0], ip_memory_d.memory.data_size);
-    } else {
-      // In-process, just copy from local memory.
-      ip_memory.Copy(
-        reinterpret_cast<const void*>(ip_memory_d.start_of_memory_range),
-        ip_memory_d.memory.data_size);
-    }
+    if (!CopyTaskMemory(&ip_memory, ip_memory_d.start_of_memory_range,
+                        ip_memory_d.memory.data_size))
+      return false;
 
     ip_memory_d.memory = ip_memory.location();
     // Write this again now that the data location is filled in.
@@ -1337,7 +2005,14 @@ bool MinidumpGenerator::WriteModuleStream(unsigned int index,
       module->version_info.file_version_lo |= (modVersion & 0xff);
     }
 
-    if (!WriteCVRecord(module, image->GetCPUType(), name.c_str(), false)) {
+    // The identifier is in the image's load commands, which have been read
+    // already, unless the image has no LC_UUID.
+    uint8_t uuid[16];
+    if (image->GetUUID(uuid)) {
+      if (!WriteCVRecordWithIdentifier(module, name.c_str(), uuid))
+        return false;
+    } else if (!WriteCVRecord(module, image->GetCPUType(), name.c_str(),
+                              false)) {
       return false;
     }
   } else {
@@ -1424,8 +2099,56 @@ int MinidumpGenerator::FindExecutableModule() {
   return 0;
 }
 
+bool MinidumpGenerator::WriteCachedModuleStream(
+    const DyldImageCache::Entry& entry, MDRawModule* module) {
+  memset(module, 0, sizeof(MDRawModule));
+
+  const char* name = entry.file_path ? entry.file_path : "";
+  MDLocationDescriptor string_location;
+  if (!writer_.WriteString(name, 0, &string_location))
+    return false;
+
+  module->base_of_image = entry.base_address;
+  module->size_of_image = static_cast<uint32_t>(entry.size);
+  module->module_name_rva = string_location.rva;
+
+  if (entry.has_uuid)
+    return WriteCVRecordWithIdentifier(module, name, entry.uuid);
+
+  bool in_memory = false;
+#if TARGET_OS_IPHONE
+  in_memory = true;
+#endif
+  return WriteCVRecord(module, entry.cpu_type, name, in_memory);
+}
+
 bool MinidumpGenerator::WriteCVRecord(MDRawModule* module, int cpu_type,
                                       const char* module_path, bool in_memory) {
+  // Get the module identifier
+  unsigned char identifier[16];
+  bool result = false;
+  if (in_memory) {
+    MacFileUtilities::MachoID macho(
+        reinterpret_cast<void*>(module->base_of_image),
+        static_cast<size_t>(module->size_of_image));
+    result = macho.UUIDCommand(cpu_type, CPU_SUBTYPE_MULTIPLE, identifier);
+    if (!result)
+      result = macho.MD5(cpu_type, CPU_SUBTYPE_MULTIPLE, identifier);
+  }
+
+  if (!result) {
+     FileID file_id(module_path);
+     result = file_id.MachoIdentifier(cpu_type, CPU_SUBTYPE_MULTIPLE,
+                                      identifier);
+  }
+
+  return WriteCVRecordWithIdentifier(module, module_path,
+                                     result ? identifier : NULL);
+}
+
+bool MinidumpGenerator::WriteCVRecordWithIdentifier(
+    MDRawModule* module, const char* module_path,
+    const unsigned char* identifier) {
   TypedMDRVA<MDCVInfoPDB70> cv(&writer_);
 
   // Only return the last path component of the full module path
@@ -1450,25 +2173,7 @@ bool MinidumpGenerator::WriteCVRecord(MDRawModule* module, int cpu_type,
   cv_ptr->cv_signature = MD_CVINFOPDB70_SIGNATURE;
   cv_ptr->age = 0;
 
-  // Get the module identifier
-  unsigned char identifier[16];
-  bool result = false;
-  if (in_memory) {
-    MacFileUtilities::MachoID macho(
-        reinterpret_cast<void*>(module->base_of_image),
-        static_cast<size_t>(module->size_of_image));
-    result = macho.UUIDCommand(cpu_type, CPU_SUBTYPE_MULTIPLE, identifier);
-    if (!result)
-      result = macho.MD5(cpu_type, CPU_SUBTYPE_MULTIPLE, identifier);
-  }
-
-  if (!result) {
-     FileID file_id(module_path);
-     result = file_id.MachoIdentifier(cpu_type, CPU_SUBTYPE_MULTIPLE,
-                                      identifier);
-  }
-
-  if (result) {
+  if (identifier) {
     cv_ptr->signature.data1 =
         static_cast<uint32_t>(identifier[0]) << 24 |
         static_cast<uint32_t>(identifier[1]) << 16 |
@@ -1493,6 +2198,15 @@ bool MinidumpGenerator::WriteCVRecord(MDRawModule* module, int cpu_type,
 
 bool MinidumpGenerator::WriteModuleListStream(
     MDRawDirectory* module_list_stream) {
+  if (raw_capture_)
+    return WriteRawCaptureModuleListStream(module_list_stream);
+
+  if (!dynamic_images_) {
+    DyldImageCache* cache = DyldImageCache::Get();
+    if (cache && cache->IsComplete())
+      return WriteCachedModuleListStream(*cache, module_list_stream);
+  }
+
   TypedMDRVA<MDRawModuleList> list(&writer_);
 
   uint32_t image_count = dynamic_images_ ?
@@ -1530,6 +2244,117 @@ bool MinidumpGenerator::WriteModuleListStream(
   return true;
 }
 
+bool MinidumpGenerator::WriteCachedModuleListStream(
+    const DyldImageCache& cache, MDRawDirectory* module_list_stream) {
+  TypedMDRVA<MDRawModuleList> list(&writer_);
+
+  uint32_t image_count = 0;
+  int executable_index = -1;
+  for (int i = 0; i < cache.GetEntryCount(); ++i) {
+    const DyldImageCache::Entry& entry = cache.GetEntry(i);
+    if (!entry.load_address)
+      continue;
+    ++image_count;
+    if (executable_index < 0 && entry.file_type == MH_EXECUTE)
+      executable_index = i;
+  }
+
+  if (!list.AllocateObjectAndArray(image_count, MD_MODULE_SIZE))
+    return false;
+
+  module_list_stream->stream_type = MD_MODULE_LIST_STREAM;
+  module_list_stream->location = list.location();
+  list.get()->number_of_modules = image_count;
+
+  // Write out the executable module as the first one
+  MDRawModule module;
+  int destinationIndex = 0;
+  if (executable_index >= 0) {
+    if (!WriteCachedModuleStream(cache.GetEntry(executable_index), &module))
+      return false;
+    list.CopyIndexAfterObject(destinationIndex++, &module, MD_MODULE_SIZE);
+  }
+
+  for (int i = 0; i < cache.GetEntryCount(); ++i) {
+    const DyldImageCache::Entry& entry = cache.GetEntry(i);
+    if (!entry.load_address || i == executable_index)
+      continue;
+    if (!WriteCachedModuleStream(entry, &module))
+      return false;
+    list.CopyIndexAfterObject(destinationIndex++, &module, MD_MODULE_SIZE);
+  }
+
+  return true;
+}
+
+bool MinidumpGenerator::WriteRawCaptureModuleListStream(
+    MDRawDirectory* module_list_stream) {
+  TypedMDRVA<MDRawModuleList> list(&writer_);
+  const vector<RawCaptureContents::Image>& images = raw_capture_->images;
+  uint32_t image_count = static_cast<uint32_t>(images.size());
+
+  if (!list.AllocateObjectAndArray(image_count, MD_MODULE_SIZE))
+    return false;
+
+  module_list_stream->stream_type = MD_MODULE_LIST_STREAM;
+  module_list_stream->location = list.location();
+  list.get()->number_of_modules = image_count;
+
+  // Write out the executable module as the first one
+  uint32_t executable_index = 0;
+  for (uint32_t i = 0; i < image_count; ++i) {
+    if (images[i].record.file_type == MH_EXECUTE) {
+      executable_index = i;
+      break;
+    }
+  }
+
+  MDRawModule module;
+  for (uint32_t i = 0; i < image_count; ++i) {
+    uint32_t index = i == 0 ? executable_index :
+                     i <= executable_index ? i - 1 : i;
+    const RawCaptureContents::Image& image = images[index];
+
+    DyldImageCache::Entry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.load_address = image.record.load_address;
+    entry.file_path = image.path.c_str();
+    entry.file_type = image.record.file_type;
+    entry.cpu_type = cpu_type_;
+    if (image.record.has_identity) {
+      entry.base_address = image.record.base_address;
+      entry.size = image.record.size;
+      entry.version = image.record.version;
+      entry.cpu_type = image.record.cpu_type;
+      entry.has_uuid = image.record.has_uuid != 0;
+      memcpy(entry.uuid, image.record.uuid, sizeof(entry.uuid));
+    } else if (!FindRawCaptureImageIdentity(&entry)) {
+      // Still list the image, with no identifier or size.
+      entry.base_address = entry.load_address;
+    }
+
+    memset(&module, 0, sizeof(MDRawModule));
+
+    MDLocationDescriptor string_location;
+    if (!writer_.WriteString(entry.file_path, 0, &string_location))
+      return false;
+
+    module.base_of_image = entry.base_address;
+    module.size_of_image = static_cast<uint32_t>(entry.size);
+    module.module_name_rva = string_location.rva;
+
+    // The image was in another task, so it can't be read in place.
+    if (!WriteCVRecordWithIdentifier(&module, entry.file_path,
+                                     entry.has_uuid ? entry.uuid : NULL)) {
+      return false;
+    }
+
+    list.CopyIndexAfterObject(i, &module, MD_MODULE_SIZE);
+  }
+
+  return true;
+}
+
 bool MinidumpGenerator::WriteMiscInfoStream(MDRawDirectory* misc_info_stream) {
   TypedMDRVA<MDRawMiscInfo> info(&writer_);
 
@@ -1541,36 +2366,41 @@ bool MinidumpGenerator::WriteMiscInfoStream(MDRawDirectory* misc_info_stream) {
 
   MDRawMiscInfo* info_ptr = info.get();
   info_ptr->size_of_info = static_cast<uint32_t>(sizeof(MDRawMiscInfo));
-  info_ptr->flags1 = MD_MISCINFO_FLAGS1_PROCESS_ID |
-    MD_MISCINFO_FLAGS1_PROCESS_TIMES |
-    MD_MISCINFO_FLAGS1_PROCESSOR_POWER_INFO;
-
-  // Process ID
-  info_ptr->process_id = getpid();
-
-  // Times
-  struct rusage usage;
-  if (getrusage(RUSAGE_SELF, &usage) != -1) {
-    // Omit the fractional time since the MDRawMiscInfo only wants seconds
-    info_ptr->process_user_time =
-        static_cast<uint32_t>(usage.ru_utime.tv_sec);
-    info_ptr->process_kernel_time =
-        static_cast<uint32_t>(usage.ru_stime.tv_sec);
-  }
-  int mib[4] = { CTL_KERN, KERN_PROC, KERN_PROC_PID,
-                 static_cast<int>(info_ptr->process_id) };
-  uint mibsize = static_cast<uint>(sizeof(mib) / sizeof(mib[0]));
-  struct kinfo_proc proc;
-  size_t size = sizeof(proc);
-  if (sysctl(mib, mibsize, &proc, &size, NULL, 0) == 0) {
-    info_ptr->process_create_time =
-        static_cast<uint32_t>(proc.kp_proc.p_starttime.tv_sec);
+  info_ptr->flags1 = MD_MISCINFO_FLAGS1_PROCESSOR_POWER_INFO;
+
+  // The process a raw capture was taken of is gone by the time it is
+  // converted, so only this one can be described.
+  if (!raw_capture_) {
+    info_ptr->flags1 |= MD_MISCINFO_FLAGS1_PROCESS_ID |
+                        MD_MISCINFO_FLAGS1_PROCESS_TIMES;
+
+    // Process ID
+    info_ptr->process_id = getpid();
+
+    // Times
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != -1) {
+      // Omit the fractional time since the MDRawMiscInfo only wants seconds
+      info_ptr->process_user_time =
+          static_cast<uint32_t>(usage.ru_utime.tv_sec);
+      info_ptr->process_kernel_time =
+          static_cast<uint32_t>(usage.ru_stime.tv_sec);
+    }
+    int mib[4] = { CTL_KERN, KERN_PROC, KERN_PROC_PID,
+                   static_cast<int>(info_ptr->process_id) };
+    uint mibsize = static_cast<uint>(sizeof(mib) / sizeof(mib[0]));
+    struct kinfo_proc proc;
+    size_t proc_size = sizeof(proc);
+    if (sysctl(mib, mibsize, &proc, &proc_size, NULL, 0) == 0) {
+      info_ptr->process_create_time =
+          static_cast<uint32_t>(proc.kp_proc.p_starttime.tv_sec);
+    }
   }
 
   // Speed
   uint64_t speed;
   const uint64_t kOneMillion = 1000 * 1000;
-  size = sizeof(speed);
+  size_t size = sizeof(speed);
   sysctlbyname("hw.cpufrequency_max", &speed, &size, NULL, 0);
   info_ptr->processor_max_mhz = static_cast<uint32_t>(speed / kOneMillion);
   info_ptr->processor_mhz_limit = static_cast<uint32_t>(speed / kOneMillion);
@@ -1606,4 +2436,16 @@ bool MinidumpGenerator::WriteBreakpadInfoStream(
   return true;
 }
 
+bool MinidumpGenerator::WriteCrashpadInfoStream(
+    MDRawDirectory* crashpad_info_stream) {
+  return google_breakpad::WriteCrashpadInfoStream(&writer_, *annotations_,
+                                                  crashpad_info_stream);
+}
+
+bool MinidumpGenerator::WriteBreadcrumbStream(
+    MDRawDirectory* breadcrumb_stream) {
+  return google_breakpad::WriteBreadcrumbStream(&writer_, *breadcrumbs_,
+                                                breadcrumb_stream);
+}
+
 }  // namespace google_breakpad
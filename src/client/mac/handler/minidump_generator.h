@@ -38,6 +38,8 @@
 
 #include "client/mac/handler/ucontext_compat.h"
 #include "client/minidump_file_writer.h"
+#include "common/breadcrumb_buffer.h"
+#include "common/concurrent_string_dictionary.h"
 #include "common/memory_allocator.h"
 #include "common/mac/macho_utilities.h"
 #include "google_breakpad/common/minidump_format.h"
@@ -112,6 +114,26 @@ class MinidumpGenerator {
   // Return true if successful, false otherwise
   bool Write(const char* path);
 
+  // Write a raw capture (see raw_capture.h) of this task to |fd| instead of
+  // a minidump.  Only the thread states, the stacks and the loaded images'
+  // addresses and paths are recorded, so no image is parsed.  The small
+  // records are batched in |buffer|, of |buffer_size| bytes, which should
+  // be allocated ahead of time since this runs while handling a crash.
+  // Only valid when generating from within the crashed process.
+  bool WriteRawCapture(int fd, char* buffer, size_t buffer_size);
+
+  // Write the minidump for the raw capture in |raw_capture_path| into
+  // |path|.  Images the capture doesn't identify are looked up by path
+  // among this task's images, and then on disk.
+  bool WriteFromRawCapture(const char* raw_capture_path, const char* path);
+
+  // Compress the minidump once it is written, into data that Minidump
+  // reads without decompressing it as a whole.  Must be called before
+  // Write().  Return false if the writer was built without zlib.
+  bool SetCompressed(bool compressed) {
+    return writer_.SetCompressed(compressed);
+  }
+
   // Specify some exception information, if applicable
   void SetExceptionInformation(int type, int code, int subcode,
                                mach_port_t thread_name) {
@@ -126,6 +148,21 @@ class MinidumpGenerator {
   // |thread_get_state|.
   void SetTaskContext(breakpad_ucontext_t* task_context);
 
+  // Write the entries of |annotations| that have values, which is not
+  // owned, to an MD_CRASHPAD_INFO_STREAM.  They are read from this task, so
+  // they are only written when the minidump is of this task.  Other threads
+  // may keep setting values while the minidump is written.
+  void SetAnnotations(const ConcurrentStringDictionary* annotations) {
+    annotations_ = annotations;
+  }
+
+  // Write the breadcrumbs that |breadcrumbs| holds, which is not owned, to
+  // an MD_BREADCRUMB_STREAM.  Like the annotations, they are only written
+  // when the minidump is of this task.
+  void SetBreadcrumbs(const BreadcrumbBuffer* breadcrumbs) {
+    breadcrumbs_ = breadcrumbs;
+  }
+
   // Gather system information.  This should be call at least once before using
   // the MinidumpGenerator class.
   static void GatherSystemInformation();
@@ -147,9 +184,12 @@ class MinidumpGenerator {
   bool WriteModuleListStream(MDRawDirectory* module_list_stream);
   bool WriteMiscInfoStream(MDRawDirectory* misc_info_stream);
   bool WriteBreakpadInfoStream(MDRawDirectory* breakpad_info_stream);
+  bool WriteCrashpadInfoStream(MDRawDirectory* crashpad_info_stream);
+  bool WriteBreadcrumbStream(MDRawDirectory* breadcrumb_stream);
 
   // Helpers
   uint64_t CurrentPCForStack(breakpad_thread_state_data_t state);
+  uint64_t CurrentSPForStack(breakpad_thread_state_data_t state);
   bool GetThreadState(thread_act_t target_thread, thread_state_t state,
                       mach_msg_type_number_t* count);
   bool WriteStackFromStartAddress(mach_vm_address_t start_addr,
@@ -160,9 +200,38 @@ class MinidumpGenerator {
                     MDLocationDescriptor* register_location);
   bool WriteCVRecord(MDRawModule* module, int cpu_type,
                      const char* module_path, bool in_memory);
+  // Writes a CV record with |identifier|, or with no identifier if it is
+  // NULL.
+  bool WriteCVRecordWithIdentifier(MDRawModule* module,
+                                   const char* module_path,
+                                   const unsigned char* identifier);
   bool WriteModuleStream(unsigned int index, MDRawModule* module);
+  // Write the module list of the current task from the DyldImageCache,
+  // which must be complete.
+  bool WriteCachedModuleListStream(const DyldImageCache& cache,
+                                   MDRawDirectory* module_list_stream);
+  bool WriteCachedModuleStream(const DyldImageCache::Entry& entry,
+                               MDRawModule* module);
+  // The thread and module lists of a raw capture being converted.
+  bool WriteRawCaptureThreadListStream(MDRawDirectory* thread_list_stream);
+  bool WriteRawCaptureModuleListStream(MDRawDirectory* module_list_stream);
   size_t CalculateStackSize(mach_vm_address_t start_addr);
   int  FindExecutableModule();
+  // Find the memory around the exception thread's instruction pointer.
+  bool GetIPMemoryRange(MDMemoryDescriptor* ip_memory);
+
+  // When dumping another task, read every stack and the memory around the
+  // instruction pointer before any stream is written.  Ranges are merged
+  // first so each page is read only once.
+  void PrefetchTaskMemory();
+  void PlanTaskMemory(mach_vm_address_t start_addr, mach_vm_size_t size);
+  void ReleaseTaskMemory();
+  // Return the prefetched copy of a range, or NULL if it wasn't read.
+  const uint8_t* FindPrefetchedMemory(mach_vm_address_t start_addr,
+                                      size_t size) const;
+  // Copy a range of the crashed task's memory into |memory|.
+  bool CopyTaskMemory(UntypedMDRVA* memory, mach_vm_address_t start_addr,
+                      size_t size);
 
   // Per-CPU implementations of these methods
 #ifdef HAS_ARM_SUPPORT
@@ -171,6 +240,7 @@ class MinidumpGenerator {
   bool WriteContextARM(breakpad_thread_state_data_t state,
                        MDLocationDescriptor* register_location);
   uint64_t CurrentPCForStackARM(breakpad_thread_state_data_t state);
+  uint64_t CurrentSPForStackARM(breakpad_thread_state_data_t state);
 #endif
 #ifdef HAS_ARM64_SUPPORT
   bool WriteStackARM64(breakpad_thread_state_data_t state,
@@ -178,6 +248,7 @@ class MinidumpGenerator {
   bool WriteContextARM64(breakpad_thread_state_data_t state,
                          MDLocationDescriptor* register_location);
   uint64_t CurrentPCForStackARM64(breakpad_thread_state_data_t state);
+  uint64_t CurrentSPForStackARM64(breakpad_thread_state_data_t state);
 #endif
 #ifdef HAS_PPC_SUPPORT
   bool WriteStackPPC(breakpad_thread_state_data_t state,
@@ -185,11 +256,13 @@ class MinidumpGenerator {
   bool WriteContextPPC(breakpad_thread_state_data_t state,
                        MDLocationDescriptor* register_location);
   uint64_t CurrentPCForStackPPC(breakpad_thread_state_data_t state);
+  uint64_t CurrentSPForStackPPC(breakpad_thread_state_data_t state);
   bool WriteStackPPC64(breakpad_thread_state_data_t state,
                        MDMemoryDescriptor* stack_location);
   bool WriteContextPPC64(breakpad_thread_state_data_t state,
                        MDLocationDescriptor* register_location);
   uint64_t CurrentPCForStackPPC64(breakpad_thread_state_data_t state);
+  uint64_t CurrentSPForStackPPC64(breakpad_thread_state_data_t state);
 #endif
 #ifdef HAS_X86_SUPPORT
   bool WriteStackX86(breakpad_thread_state_data_t state,
@@ -197,11 +270,13 @@ class MinidumpGenerator {
   bool WriteContextX86(breakpad_thread_state_data_t state,
                        MDLocationDescriptor* register_location);
   uint64_t CurrentPCForStackX86(breakpad_thread_state_data_t state);
+  uint64_t CurrentSPForStackX86(breakpad_thread_state_data_t state);
   bool WriteStackX86_64(breakpad_thread_state_data_t state,
                         MDMemoryDescriptor* stack_location);
   bool WriteContextX86_64(breakpad_thread_state_data_t state,
                           MDLocationDescriptor* register_location);
   uint64_t CurrentPCForStackX86_64(breakpad_thread_state_data_t state);
+  uint64_t CurrentSPForStackX86_64(breakpad_thread_state_data_t state);
 #endif
 
   // disallow copy ctor and operator=
@@ -236,10 +311,36 @@ class MinidumpGenerator {
   // Information about dynamically loaded code
   DynamicImages* dynamic_images_;
 
+  // The raw capture being converted by WriteFromRawCapture, or NULL.  The
+  // thread states and stacks come from it rather than from a task.
+  struct RawCaptureContents;
+  const RawCaptureContents* raw_capture_;
+
+  // Annotations to write, if not NULL.  See SetAnnotations().
+  const ConcurrentStringDictionary* annotations_;
+
+  // Breadcrumbs to write, if not NULL.  See SetBreadcrumbs().
+  const BreadcrumbBuffer* breadcrumbs_;
+
   // PageAllocator makes it possible to allocate memory
   // directly from the system, even while handling an exception.
   mutable PageAllocator allocator_;
 
+  // Memory read from the crashed task by PrefetchTaskMemory.
+  struct TaskMemoryRange {
+    mach_vm_address_t start;
+    mach_vm_size_t size;
+    // Where the range was copied to, or NULL if it couldn't be read.
+    const uint8_t* data;
+
+    bool operator<(const TaskMemoryRange& other) const {
+      return start < other.start;
+    }
+  };
+  wasteful_vector<TaskMemoryRange> task_memory_;
+  vm_address_t task_memory_buffer_;
+  vm_size_t task_memory_buffer_size_;
+
  protected:
   // Blocks of memory written to the dump. These are all currently
   // written while writing the thread list stream, but saved here
@@ -0,0 +1,104 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// raw_capture.h: The format of a raw capture, which is what an in-process
+// handler can record of a crashed task without building its module list.
+// MinidumpGenerator::WriteRawCapture writes one, and
+// MinidumpGenerator::WriteFromRawCapture turns it into a minidump later,
+// normally on the application's next launch.
+//
+// A raw capture is a RawCaptureHeader followed by header.thread_count
+// RawCaptureThreads, each followed by its stack_size bytes of stack, then
+// header.image_count RawCaptureImages, each followed by its path_size
+// bytes of path.  Records are packed one after another, so they may not be
+// aligned.  The header is written last; a capture whose signature is not
+// kRawCaptureSignature is incomplete.
+
+#ifndef CLIENT_MAC_HANDLER_RAW_CAPTURE_H__
+#define CLIENT_MAC_HANDLER_RAW_CAPTURE_H__
+
+#include <stdint.h>
+
+namespace google_breakpad {
+
+// "BPRC"
+const uint32_t kRawCaptureSignature = 0x43525042;
+const uint32_t kRawCaptureVersion = 1;
+
+// The extension of a raw capture's file, in place of a minidump's ".dmp".
+#define RAW_CAPTURE_EXTENSION ".rawdmp"
+
+// The most bytes of a thread's state that are kept, which is more than any
+// of the flavors MinidumpGenerator reads.
+const uint32_t kRawCaptureMaxStateSize = 512;
+
+struct RawCaptureHeader {
+  uint32_t signature;
+  uint32_t version;
+  uint32_t cpu_type;
+  uint32_t thread_count;
+  uint32_t image_count;
+  // As passed to MinidumpGenerator::SetExceptionInformation.
+  int32_t exception_type;
+  int32_t exception_code;
+  int32_t exception_subcode;
+  uint32_t exception_thread;
+  // The thread that wrote the capture, which has no record.
+  uint32_t handler_thread;
+  // Seconds since the epoch when the capture was written.
+  uint64_t time_date_stamp;
+};
+
+struct RawCaptureThread {
+  uint32_t thread_id;
+  uint32_t state_size;
+  uint8_t state[kRawCaptureMaxStateSize];
+  uint64_t stack_start;
+  uint64_t stack_size;
+};
+
+struct RawCaptureImage {
+  // Address of the image's mach_header.
+  uint64_t load_address;
+  // The rest is only known if the DyldImageCache had an entry for the
+  // image; otherwise it is found from the image's path when the capture is
+  // converted.  has_identity is nonzero when it is known.
+  uint32_t has_identity;
+  uint32_t has_uuid;
+  uint64_t base_address;
+  uint64_t size;
+  uint32_t version;
+  uint32_t file_type;
+  int32_t cpu_type;
+  uint8_t uuid[16];
+  uint32_t path_size;
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_MAC_HANDLER_RAW_CAPTURE_H__
@@ -85,7 +85,9 @@ typedef void (^UploadCompletionBlock)(NSString *reportId, NSError *error);
 
 - (NSMutableDictionary *)parameters;
 
-- (void)report;
+// Uploads the minidump, and the log file if any.  Returns YES if the
+// server accepted the report.
+- (BOOL)report;
 
 // Upload the given data to the crash server.
 - (void)uploadData:(NSData *)data name:(NSString *)name;
@@ -555,7 +555,7 @@ NSDictionary *readConfigurationData(const char *configFile) {
 }
 
 //=============================================================================
-- (void)report {
+- (BOOL)report {
   NSURL *url = [NSURL URLWithString:[parameters_ objectForKey:@BREAKPAD_URL]];
 
   NSString *serverType = [parameters_ objectForKey:@BREAKPAD_SERVER_TYPE];
@@ -590,10 +590,17 @@ NSDictionary *readConfigurationData(const char *configFile) {
 
   if (![self populateServerDictionary:uploadParameters]) {
     [upload release];
-    return;
+    return NO;
   }
 
   [upload setParameters:uploadParameters];
+  [upload setCompressesBody:
+      [[parameters_ objectForKey:@BREAKPAD_COMPRESS_UPLOADS] boolValue]];
+  id priority = [parameters_ objectForKey:@BREAKPAD_UPLOAD_PRIORITY];
+  if (priority)
+    [upload setPriority:[priority floatValue]];
+
+  BOOL accepted = NO;
 
   // Add minidump file
   if (minidumpContents_) {
@@ -610,11 +617,14 @@ NSDictionary *readConfigurationData(const char *configFile) {
 
     if (![url isFileURL]) {
       [self handleNetworkResponse:data withError:error];
+      NSInteger status = [[upload response] statusCode];
+      accepted = !error && status >= 200 && status < 300;
     } else {
       if (error) {
         fprintf(stderr, "Breakpad Uploader: Error writing request file: %s\n",
                 [[error description] UTF8String]);
       }
+      accepted = !error;
     }
 
   } else {
@@ -624,6 +634,7 @@ NSDictionary *readConfigurationData(const char *configFile) {
     }
   }
   [upload release];
+  return accepted;
 }
 
 - (void)uploadData:(NSData *)data name:(NSString *)name {
@@ -34,21 +34,82 @@
 #include <config.h>  // Must come first
 #endif
 
+#include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
 #include "client/minidump_file_writer-inl.h"
 #include "common/linux/linux_libc_support.h"
 #include "common/string_conversion.h"
 #if defined(__linux__) && __linux__
+#include "common/linux/eintr_wrapper.h"
 #include "third_party/lss/linux_syscall_support.h"
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
 #endif
+#endif
+
+namespace {
+
+#ifdef HAVE_LIBZ
+// The header of each block of the blocked gzip data of common/block_gzip.h:
+// the fixed gzip header with the FEXTRA flag set, followed by the extra
+// field's length and the "BP" subfield, whose four bytes hold the size of
+// the whole member, least significant first.
+const uint8_t kGzipBlockHeader[] = {
+  0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 8, 0, 'B', 'P', 4, 0
+};
+const size_t kGzipBlockHeaderSize = sizeof(kGzipBlockHeader) + 4;
+
+// The CRC-32 and the size of the data, which end each member.
+const size_t kGzipTrailerSize = 8;
+
+void PutUInt32(uint32_t value, uint8_t* out) {
+  for (int i = 0; i < 4; ++i)
+    out[i] = static_cast<uint8_t>(value >> (i * 8));
+}
+
+// zlib's allocator, which maps memory rather than use the heap, as the
+// heap of a crashed process may be corrupt.  Each area starts with its
+// size, for FreeZlibMemory.
+voidpf AllocateZlibMemory(voidpf, uInt items, uInt size) {
+  const size_t length = sizeof(size_t) + static_cast<size_t>(items) * size;
+#if defined(__linux__) && __linux__
+  void* memory = sys_mmap(NULL, length, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#else
+  void* memory = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANON, -1, 0);
+#endif
+  if (memory == MAP_FAILED)
+    return Z_NULL;
+  *static_cast<size_t*>(memory) = length;
+  return static_cast<size_t*>(memory) + 1;
+}
+
+void FreeZlibMemory(voidpf, voidpf address) {
+  size_t* memory = static_cast<size_t*>(address) - 1;
+#if defined(__linux__) && __linux__
+  sys_munmap(memory, *memory);
+#else
+  munmap(memory, *memory);
+#endif
+}
+#endif  // HAVE_LIBZ
+
+}  // namespace
 
 #if defined(__ANDROID__)
-#include <errno.h>
 
 namespace {
 
@@ -95,13 +156,21 @@ const MDRVA MinidumpFileWriter::kInvalidMDRVA = static_cast<MDRVA>(-1);
 MinidumpFileWriter::MinidumpFileWriter()
     : file_(-1),
       close_file_when_destroyed_(true),
+      stream_file_(-1),
+      close_stream_file_(false),
+      compressed_(false),
       position_(0),
-      size_(0) {
+      size_(0),
+      buffer_(NULL),
+      buffer_position_(0),
+      buffer_used_(0) {
 }
 
 MinidumpFileWriter::~MinidumpFileWriter() {
   if (close_file_when_destroyed_)
     Close();
+  else if (file_ != -1 && Flush())
+    Trim();
 }
 
 bool MinidumpFileWriter::Open(const char* path) {
@@ -111,36 +180,55 @@ bool MinidumpFileWriter::Open(const char* path) {
 #else
   file_ = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600);
 #endif
+  if (file_ == -1)
+    return false;
 
-  return file_ != -1;
+  if (compressed_ && !UseScratchFile(path))
+    compressed_ = false;
+  AllocateBuffer();
+  return true;
 }
 
 void MinidumpFileWriter::SetFile(const int file) {
   assert(file_ == -1);
   file_ = file;
   close_file_when_destroyed_ = false;
+  if (compressed_ && !UseScratchFile(NULL))
+    compressed_ = false;
+#if defined(__linux__) && __linux__
+  // A pipe or socket can only be written in order, so the minidump is put
+  // together in a file in memory, which Close() then sends to |file|.
+  if (!compressed_ && sys_lseek(file, 0, SEEK_CUR) == -1 && errno == ESPIPE)
+    UseScratchFile(NULL);
+#endif
 #if defined(__ANDROID__)
-  CheckNeedsFTruncateWorkAround(file);
+  CheckNeedsFTruncateWorkAround(file_);
 #endif
+  AllocateBuffer();
 }
 
 bool MinidumpFileWriter::Close() {
   bool result = true;
 
   if (file_ != -1) {
-#if defined(__ANDROID__)
-    if (!NeedsFTruncateWorkAround() && ftruncate(file_, position_)) {
-       return false;
-    }
+    result = Flush();
+    if (!Trim())
+      return false;
+    if (stream_file_ != -1) {
+      result = (compressed_ ? Compress() : Stream()) && result;
+      if (close_stream_file_) {
+#if defined(__linux__) && __linux__
+        result = (sys_close(stream_file_) == 0) && result;
 #else
-    if (ftruncate(file_, position_)) {
-       return false;
-    }
+        result = (close(stream_file_) == 0) && result;
 #endif
+      }
+      stream_file_ = -1;
+    }
 #if defined(__linux__) && __linux__
-    result = (sys_close(file_) == 0);
+    result = (sys_close(file_) == 0) && result;
 #else
-    result = (close(file_) == 0);
+    result = (close(file_) == 0) && result;
 #endif
     file_ = -1;
   }
@@ -148,6 +236,192 @@ bool MinidumpFileWriter::Close() {
   return result;
 }
 
+bool MinidumpFileWriter::Flush() {
+  if (!buffer_used_)
+    return true;
+
+  const size_t used = buffer_used_;
+  buffer_used_ = 0;
+  return WriteAt(buffer_position_, buffer_, used, NULL, 0);
+}
+
+void MinidumpFileWriter::Abandon() {
+  buffer_used_ = 0;
+  if (stream_file_ != -1 && close_stream_file_) {
+#if defined(__linux__) && __linux__
+    sys_close(stream_file_);
+#else
+    close(stream_file_);
+#endif
+  }
+  stream_file_ = -1;
+  if (file_ != -1 && close_file_when_destroyed_) {
+#if defined(__linux__) && __linux__
+    sys_close(file_);
+#else
+    close(file_);
+#endif
+  }
+  file_ = -1;
+}
+
+bool MinidumpFileWriter::SetCompressed(bool compressed) {
+  assert(file_ == -1);
+#ifdef HAVE_LIBZ
+  compressed_ = compressed;
+  return true;
+#else
+  compressed_ = false;
+  return !compressed;
+#endif
+}
+
+bool MinidumpFileWriter::Trim() {
+#if defined(__ANDROID__)
+  if (!NeedsFTruncateWorkAround() && ftruncate(file_, position_)) {
+     return false;
+  }
+#else
+  if (ftruncate(file_, position_)) {
+     return false;
+  }
+#endif
+  return true;
+}
+
+bool MinidumpFileWriter::UseScratchFile(const char* path) {
+  int scratch_file = -1;
+#if defined(__linux__) && __linux__
+  scratch_file = sys_memfd_create("minidump", MFD_CLOEXEC);
+#else
+  if (path) {
+    char scratch_path[PATH_MAX];
+    const int length = snprintf(scratch_path, sizeof(scratch_path),
+                                "%s.XXXXXX", path);
+    if (length > 0 && static_cast<size_t>(length) < sizeof(scratch_path)) {
+      scratch_file = mkstemp(scratch_path);
+      if (scratch_file != -1)
+        unlink(scratch_path);
+    }
+  }
+#endif
+  if (scratch_file < 0)
+    return false;
+
+  stream_file_ = file_;
+  close_stream_file_ = close_file_when_destroyed_;
+  file_ = scratch_file;
+  close_file_when_destroyed_ = true;
+  return true;
+}
+
+bool MinidumpFileWriter::Stream() {
+  uint8_t small_chunk[512];
+  uint8_t* const chunk = buffer_ ? buffer_ : small_chunk;
+  const size_t chunk_size = buffer_ ? kWriteBufferSize : sizeof(small_chunk);
+
+  for (MDRVA done = 0; done < position_;) {
+    size_t length = position_ - done;
+    if (length > chunk_size)
+      length = chunk_size;
+    const ssize_t read_size = ReadAt(done, chunk, length);
+    if (read_size <= 0 || !SendToStreamFile(chunk, read_size))
+      return false;
+    done += read_size;
+  }
+  return true;
+}
+
+bool MinidumpFileWriter::Compress() {
+#ifdef HAVE_LIBZ
+  if (!buffer_)
+    return false;
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  stream.zalloc = AllocateZlibMemory;
+  stream.zfree = FreeZlibMemory;
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS,
+                   8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  const size_t member_capacity = kGzipBlockHeaderSize +
+      deflateBound(&stream, kWriteBufferSize) + kGzipTrailerSize;
+  uint8_t* const member =
+      static_cast<uint8_t*>(AllocateZlibMemory(NULL, 1, member_capacity));
+  bool result = member != NULL;
+
+  for (MDRVA done = 0; result && done < position_;) {
+    size_t length = position_ - done;
+    if (length > kWriteBufferSize)
+      length = kWriteBufferSize;
+    const ssize_t read_size = ReadAt(done, buffer_, length);
+    if (read_size <= 0 || deflateReset(&stream) != Z_OK) {
+      result = false;
+      break;
+    }
+    stream.next_in = buffer_;
+    stream.avail_in = read_size;
+    stream.next_out = member + kGzipBlockHeaderSize;
+    stream.avail_out = member_capacity - kGzipBlockHeaderSize -
+        kGzipTrailerSize;
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+      result = false;
+      break;
+    }
+
+    const size_t member_size =
+        kGzipBlockHeaderSize + stream.total_out + kGzipTrailerSize;
+    memcpy(member, kGzipBlockHeader, sizeof(kGzipBlockHeader));
+    PutUInt32(member_size, member + sizeof(kGzipBlockHeader));
+    PutUInt32(crc32(0, buffer_, read_size),
+              member + member_size - kGzipTrailerSize);
+    PutUInt32(read_size, member + member_size - 4);
+    result = SendToStreamFile(member, member_size);
+    done += read_size;
+  }
+
+  if (member)
+    FreeZlibMemory(NULL, member);
+  deflateEnd(&stream);
+  return result;
+#else
+  return false;
+#endif
+}
+
+ssize_t MinidumpFileWriter::ReadAt(MDRVA position, uint8_t* buffer,
+                                   size_t length) {
+#if defined(__linux__) && __linux__
+  return HANDLE_EINTR(sys_pread64(file_, buffer, length, position));
+#else
+  return pread(file_, buffer, length, position);
+#endif
+}
+
+bool MinidumpFileWriter::SendToStreamFile(const uint8_t* data,
+                                          size_t length) {
+  // A pipe or socket may take less than it is given.
+  for (size_t written = 0; written < length;) {
+#if defined(__linux__) && __linux__
+    const ssize_t r =
+        HANDLE_EINTR(sys_write(stream_file_, data + written,
+                               length - written));
+#else
+    const ssize_t r = write(stream_file_, data + written, length - written);
+#endif
+    if (r <= 0)
+      return false;
+    written += r;
+  }
+  return true;
+}
+
+void MinidumpFileWriter::AllocateBuffer() {
+  if (!buffer_)
+    buffer_ = reinterpret_cast<uint8_t*>(allocator_.Alloc(kWriteBufferSize));
+}
+
 bool MinidumpFileWriter::CopyStringToMDString(const wchar_t* str,
                                               unsigned int length,
                                               TypedMDRVA<MDString>* mdstring) {
@@ -291,9 +565,11 @@ MDRVA MinidumpFileWriter::Allocate(size_t size) {
 
   if (position_ + aligned_size > size_) {
     size_t growth = aligned_size;
-    size_t minimal_growth = getpagesize();
+    size_t minimal_growth = kWriteBufferSize;
 
-    // Ensure that the file grows by at least the size of a memory page
+    // Ensure that the file grows by at least a buffer's worth, so that a
+    // dump made of many small objects doesn't resize the file for each one.
+    // Close() cuts the file back to the size in use.
     if (growth < minimal_growth)
       growth = minimal_growth;
 
@@ -319,16 +595,65 @@ bool MinidumpFileWriter::Copy(MDRVA position, const void* src, ssize_t size) {
   if (static_cast<size_t>(size + position) > size_)
     return false;
 
+  const size_t length = static_cast<size_t>(size);
+  if (!buffer_)
+    return WriteAt(position, src, length, NULL, 0);
+
+  // Data that overlaps or follows the buffered data is added to it, as long
+  // as the buffer has room.
+  const MDRVA buffer_end = buffer_position_ + static_cast<MDRVA>(buffer_used_);
+  if (buffer_used_ && position >= buffer_position_ && position <= buffer_end &&
+      position - buffer_position_ + length <= kWriteBufferSize) {
+    memcpy(buffer_ + (position - buffer_position_), src, length);
+    if (position + length > buffer_end)
+      buffer_used_ = position + length - buffer_position_;
+    return true;
+  }
+
+  // Data too large for the buffer that follows the buffered data is written
+  // along with it.
+  if (length >= kWriteBufferSize && buffer_used_ && position == buffer_end) {
+    buffer_used_ = 0;
+    return WriteAt(buffer_position_, buffer_, buffer_end - buffer_position_,
+                   src, length);
+  }
+
+  // Anything else starts a new run of buffered data.
+  if (!Flush())
+    return false;
+  if (length >= kWriteBufferSize)
+    return WriteAt(position, src, length, NULL, 0);
+  memcpy(buffer_, src, length);
+  buffer_position_ = position;
+  buffer_used_ = length;
+  return true;
+}
+
+bool MinidumpFileWriter::WriteAt(MDRVA position,
+                                 const void* first, size_t first_size,
+                                 const void* second, size_t second_size) {
+  const ssize_t total = static_cast<ssize_t>(first_size + second_size);
+
   // Seek and write the data
+#if defined(__linux__) && __linux__
+  struct kernel_iovec iov[2];
+#else
+  struct iovec iov[2];
+#endif
+  iov[0].iov_base = const_cast<void*>(first);
+  iov[0].iov_len = first_size;
+  iov[1].iov_base = const_cast<void*>(second);
+  iov[1].iov_len = second_size;
+  const int iov_count = second_size ? 2 : 1;
 #if defined(__linux__) && __linux__
   if (sys_lseek(file_, position, SEEK_SET) == static_cast<off_t>(position)) {
-    if (sys_write(file_, src, size) == size) {
+    if (sys_writev(file_, iov, iov_count) == total) {
       return true;
     }
   }
 #else
   if (lseek(file_, position, SEEK_SET) == static_cast<off_t>(position)) {
-    if (write(file_, src, size) == size) {
+    if (writev(file_, iov, iov_count) == total) {
       return true;
     }
   }
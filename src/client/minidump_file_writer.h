@@ -33,8 +33,11 @@
 #ifndef CLIENT_MINIDUMP_FILE_WRITER_H__
 #define CLIENT_MINIDUMP_FILE_WRITER_H__
 
+#include <stdint.h>
+
 #include <string>
 
+#include "common/memory_allocator.h"
 #include "google_breakpad/common/minidump_format.h"
 
 namespace google_breakpad {
@@ -46,6 +49,9 @@ template<typename MDType> class TypedMDRVA;
 // strings using the definitions in minidump_format.h.  Since this class is
 // expected to be used in a situation where the current process may be
 // damaged, it will not allocate heap memory.
+// Writes are gathered in a buffer, so that data written to consecutive
+// positions reaches the file in a single system call.  The buffer is written
+// out when a write does not fit in it, and by Flush() and Close().
 // Sample usage:
 // MinidumpFileWriter writer;
 // writer.Open("/tmp/minidump.dmp");
@@ -83,13 +89,37 @@ public:
   // available.
   // Note that |fd| is not closed when the instance of MinidumpFileWriter is
   // destroyed.
+  // On Linux, |file| may also be a pipe or a socket.  The minidump is then
+  // put together in an anonymous file in memory, and sent to |file| in
+  // order by Close() or the destructor.
   void SetFile(const int file);
 
+  // Sets whether the minidump is compressed by Close() or the destructor
+  // once it is complete, into the blocked gzip data of common/block_gzip.h.
+  // Minidump reads such files without decompressing them as a whole.  The
+  // minidump is put together in a scratch file, in memory on Linux, and
+  // unlinked next to the minidump elsewhere.  Must be called before Open()
+  // or SetFile().  Return false if the writer was built without zlib, in
+  // which case the minidump is not compressed.
+  bool SetCompressed(bool compressed);
+
   // Close the current file (that was either created when Open was called, or
   // specified with SetFile).
   // Return true on success, or false on failure.
   bool Close();
 
+  // Write any buffered data to the file.  This is done by Close(), and by
+  // the destructor when the file is not closed, which also cuts the file
+  // back to the size in use.
+  // Return true on success, or false on failure.
+  bool Flush();
+
+  // Stop writing to the file, without writing buffered data or cutting the
+  // file back, and close it if it was created by Open.  Used when another
+  // process that shares the file finishes it.  Nothing may be written
+  // afterwards.
+  void Abandon();
+
   // Copy the contents of |str| to a MDString and write it to the file.
   // |str| is expected to be either UTF-16 or UTF-32 depending on the size
   // of wchar_t.
@@ -108,33 +138,101 @@ public:
   // Return true on success and set |output| to position, or false on failure
   bool WriteMemory(const void* src, size_t size, MDMemoryDescriptor* output);
 
-  // Copies |size| bytes from |src| to |position|
+  // Copies |size| bytes from |src| to |position|.  The data may stay in the
+  // buffer until a later write, Flush() or Close().
   // Return true on success, or false on failure
   bool Copy(MDRVA position, const void* src, ssize_t size);
 
   // Return the current position for writing to the minidump
   inline MDRVA position() const { return position_; }
 
+  // Whether the minidump is only written to its file by Close(), because
+  // the file is a pipe or socket, or the minidump is compressed.
+  bool streaming() const { return stream_file_ != -1; }
+
  private:
   friend class UntypedMDRVA;
 
+  // The size of the buffer that writes are gathered in, and the least that
+  // the file grows by.
+  static const size_t kWriteBufferSize = 64 * 1024;
+
   // Allocates an area of |size| bytes.
   // Returns the position of the allocation, or kInvalidMDRVA if it was
   // unable to allocate the bytes.
   MDRVA Allocate(size_t size);
 
+  // Cuts the file back to the end of the last allocation.
+  // Return true on success, or false on failure.
+  bool Trim();
+
+  // Moves |file_| to |stream_file_| and puts the minidump together in a
+  // scratch file instead, to be written to |stream_file_| by Close().
+  // |path| names the minidump file, or is NULL if it was given to
+  // SetFile().  Return true on success, or false on failure.
+  bool UseScratchFile(const char* path);
+
+  // Sends the file's first position_ bytes to |stream_file_|, in order.
+  // Return true on success, or false on failure.
+  bool Stream();
+
+  // Compresses the file's first position_ bytes to |stream_file_|, in
+  // blocks of kWriteBufferSize bytes.
+  // Return true on success, or false on failure.
+  bool Compress();
+
+  // Reads up to |length| bytes at |position| in |file_| into |buffer|.
+  // Return the number of bytes read, or -1 on failure.
+  ssize_t ReadAt(MDRVA position, uint8_t* buffer, size_t length);
+
+  // Writes |length| bytes from |data| to |stream_file_|, which may take
+  // them a few at a time.
+  // Return true on success, or false on failure.
+  bool SendToStreamFile(const uint8_t* data, size_t length);
+
+  // Allocates |buffer_|, leaving it NULL if that fails, in which case every
+  // write goes straight to the file.
+  void AllocateBuffer();
+
+  // Writes |first_size| bytes from |first| followed by |second_size| bytes
+  // from |second| to the file at |position|.  |second_size| may be 0.
+  // Return true on success, or false on failure.
+  bool WriteAt(MDRVA position, const void* first, size_t first_size,
+               const void* second, size_t second_size);
+
   // The file descriptor for the output file.
   int file_;
 
   // Whether |file_| should be closed when the instance is destroyed.
   bool close_file_when_destroyed_;
 
+  // The file, pipe or socket that |file_| is sent to by Close(), or -1.
+  int stream_file_;
+
+  // Whether |stream_file_| was created by Open(), and is closed by Close().
+  bool close_stream_file_;
+
+  // Whether Close() compresses the minidump.  See SetCompressed().
+  bool compressed_;
+
   // Current position in buffer
   MDRVA position_;
 
   // Current allocated size
   size_t size_;
 
+  // Supplies |buffer_|.
+  PageAllocator allocator_;
+
+  // kWriteBufferSize bytes holding data not yet written to the file, or NULL.
+  uint8_t* buffer_;
+
+  // The position in the file of the first byte in |buffer_|.
+  MDRVA buffer_position_;
+
+  // The number of bytes of |buffer_| in use.
+  size_t buffer_used_;
+
   // Copy |length| characters from |str| to |mdstring|.  These are distinct
   // because the underlying MDString is a UTF-16 based string.  The wchar_t
   // variant may need to create a MDString that has more characters than the
@@ -41,8 +41,13 @@
 #endif
 
 #include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <vector>
+
 #include "minidump_file_writer-inl.h"
 
 using google_breakpad::MinidumpFileWriter;
@@ -170,11 +175,70 @@ static bool CompareFile(const char* path) {
   return true;
 }
 
+static char Pattern(size_t offset) {
+  return static_cast<char>(offset % 251 + 1);
+}
+
+// Writes out of order, over earlier writes and past the size of the write
+// buffer, and checks that the file holds the data last written everywhere.
+static bool WriteAndCompareBufferedFile(const char* path) {
+  const size_t kHeaderSize = 16;
+  const size_t kSmallSize = 1000;
+  const size_t kPieceSize = 10;
+  const size_t kLargeSize = 200000;
+  std::vector<char> expected(kHeaderSize + kSmallSize + kLargeSize);
+
+  MinidumpFileWriter writer;
+  ASSERT_TRUE(writer.Open(path));
+
+  // Allocated first and written last, as TypedMDRVA does with headers.
+  google_breakpad::UntypedMDRVA header(&writer);
+  ASSERT_TRUE(header.Allocate(kHeaderSize));
+
+  // Small pieces at consecutive positions.
+  google_breakpad::UntypedMDRVA small(&writer);
+  ASSERT_TRUE(small.Allocate(kSmallSize));
+  for (size_t i = 0; i < kSmallSize; i += kPieceSize) {
+    const size_t position = small.position() + i;
+    for (size_t j = 0; j < kPieceSize; ++j)
+      expected[position + j] = Pattern(position + j);
+    ASSERT_TRUE(small.Copy(position, &expected[position], kPieceSize));
+  }
+
+  // Data larger than the buffer, directly after the small pieces.
+  google_breakpad::UntypedMDRVA large(&writer);
+  ASSERT_TRUE(large.Allocate(kLargeSize));
+  for (size_t i = 0; i < kLargeSize; ++i)
+    expected[large.position() + i] = Pattern(i);
+  ASSERT_TRUE(large.Copy(&expected[large.position()], kLargeSize));
+
+  // Over part of the small pieces, then the header.
+  const size_t rewrite = small.position() + 5;
+  for (size_t j = 0; j < kPieceSize; ++j)
+    expected[rewrite + j] = 'r';
+  ASSERT_TRUE(small.Copy(rewrite, &expected[rewrite], kPieceSize));
+  for (size_t j = 0; j < kHeaderSize; ++j)
+    expected[j] = 'h';
+  ASSERT_TRUE(header.Copy(&expected[0], kHeaderSize));
+  ASSERT_TRUE(writer.Close());
+
+  std::vector<char> actual(expected.size() + 1);
+  int fd = open(path, O_RDONLY, 0600);
+  ASSERT_NE(fd, -1);
+  ASSERT_EQ(read(fd, &actual[0], actual.size()),
+            static_cast<ssize_t>(expected.size()));
+  close(fd);
+  ASSERT_EQ(memcmp(&actual[0], &expected[0], expected.size()), 0);
+  return true;
+}
+
 static bool RunTests() {
   const char* path = "/tmp/minidump_file_writer_unittest.dmp";
   ASSERT_TRUE(WriteFile(path));
   ASSERT_TRUE(CompareFile(path));
   unlink(path);
+  ASSERT_TRUE(WriteAndCompareBufferedFile(path));
+  unlink(path);
   return true;
 }
 
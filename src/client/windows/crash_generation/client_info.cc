@@ -57,8 +57,10 @@ ClientInfo::ClientInfo(CrashGenerationServer* crash_server,
       dump_generated_handle_(NULL),
       dump_request_wait_handle_(NULL),
       process_exit_wait_handle_(NULL),
+      dump_work_(NULL),
       crash_id_(NULL) {
   GetSystemTimeAsFileTime(&start_time_);
+  InitializeCriticalSection(&dump_sync_);
 }
 
 bool ClientInfo::Initialize() {
@@ -98,6 +100,12 @@ void ClientInfo::UnregisterDumpRequestWaitAndBlockUntilNoPending() {
   }
 }
 
+void ClientInfo::WaitForPendingDumps() {
+  if (dump_work_) {
+    WaitForThreadpoolWorkCallbacks(dump_work_, FALSE);
+  }
+}
+
 void ClientInfo::UnregisterProcessExitWait(bool block_until_no_pending) {
   if (process_exit_wait_handle_) {
     if (block_until_no_pending) {
@@ -123,6 +131,12 @@ ClientInfo::~ClientInfo() {
   // before deleting the ClientInfo.
   UnregisterProcessExitWait(true);
 
+  // No more dumps can be queued once the dump request wait is gone.
+  if (dump_work_) {
+    WaitForThreadpoolWorkCallbacks(dump_work_, FALSE);
+    CloseThreadpoolWork(dump_work_);
+  }
+
   if (process_handle_) {
     CloseHandle(process_handle_);
   }
@@ -134,6 +148,8 @@ ClientInfo::~ClientInfo() {
   if (dump_generated_handle_) {
     CloseHandle(dump_generated_handle_);
   }
+
+  DeleteCriticalSection(&dump_sync_);
 }
 
 bool ClientInfo::GetClientExceptionInfo(EXCEPTION_POINTERS** ex_info) const {
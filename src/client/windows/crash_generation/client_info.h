@@ -77,6 +77,17 @@ class ClientInfo {
     process_exit_wait_handle_ = value;
   }
 
+  PTP_WORK dump_work() const { return dump_work_; }
+  void set_dump_work(PTP_WORK value) { dump_work_ = value; }
+
+  // Held while a dump of this client is written, so that a client released
+  // early cannot have two dumps written at once.
+  CRITICAL_SECTION* dump_sync() { return &dump_sync_; }
+
+  // Wait for the dumps of this client that are queued or being written to
+  // finish.
+  void WaitForPendingDumps();
+
   // Unregister the dump request wait operation and wait for all callbacks
   // that might already be running to complete before returning.
   void UnregisterDumpRequestWaitAndBlockUntilNoPending();
@@ -157,6 +168,12 @@ class ClientInfo {
   // Wait handle for process exit event.
   HANDLE process_exit_wait_handle_;
 
+  // Thread pool work that writes this client's dumps.
+  PTP_WORK dump_work_;
+
+  // Serializes the dumps of this client.
+  CRITICAL_SECTION dump_sync_;
+
   // Time when the client process started. It is used to determine the uptime
   // for the client process when it signals a crash.
   FILETIME start_time_;
@@ -74,10 +74,9 @@ static const DWORD kPipeMode = PIPE_TYPE_MESSAGE |
 // finish very quickly.
 static const ULONG kPipeIOThreadFlags = WT_EXECUTEINWAITTHREAD;
 
-// Dump request threads will, most likely, generate dumps. That may
-// take some time to finish, so specify WT_EXECUTELONGFUNCTION flag.
-static const ULONG kDumpRequestThreadFlags = WT_EXECUTEINWAITTHREAD |
-                                             WT_EXECUTELONGFUNCTION;
+// Dump request callbacks only queue the dump on the server's thread
+// pool, where it is written, so they too execute in the wait thread.
+static const ULONG kDumpRequestThreadFlags = WT_EXECUTEINWAITTHREAD;
 
 static bool IsClientRequestValid(const ProtocolMessage& msg) {
   return msg.tag == MESSAGE_TAG_UPLOAD_REQUEST ||
@@ -125,6 +124,11 @@ CrashGenerationServer::CrashGenerationServer(
       upload_context_(upload_context),
       generate_dumps_(generate_dumps),
       pre_fetch_custom_info_(true),
+      max_concurrent_dumps_(1),
+      use_process_snapshots_(false),
+      filter_minidumps_(false),
+      dump_pool_(NULL),
+      dump_callback_environ_(),
       dump_path_(dump_path ? *dump_path : L""),
       server_state_(IPC_SERVER_STATE_UNINITIALIZED),
       shutting_down_(false),
@@ -197,6 +201,12 @@ CrashGenerationServer::~CrashGenerationServer() {
     delete client_info;
   }
 
+  // The clients' dumps were all finished as they were deleted.
+  if (dump_pool_) {
+    DestroyThreadpoolEnvironment(&dump_callback_environ_);
+    CloseThreadpool(dump_pool_);
+  }
+
   if (server_alive_handle_) {
     // Release the mutex before closing the handle so that clients requesting
     // dumps wait for a long time for the server to generate a dump.
@@ -223,6 +233,19 @@ bool CrashGenerationServer::Start() {
     return false;
   }
 
+  // Pool for writing the dumps, with a thread per concurrent dump.
+  dump_pool_ = CreateThreadpool(NULL);
+  if (!dump_pool_) {
+    return false;
+  }
+  SetThreadpoolThreadMaximum(dump_pool_, max_concurrent_dumps_);
+  if (!SetThreadpoolThreadMinimum(dump_pool_, 1)) {
+    return false;
+  }
+  InitializeThreadpoolEnvironment(&dump_callback_environ_);
+  SetThreadpoolCallbackPool(&dump_callback_environ_, dump_pool_);
+  SetThreadpoolCallbackRunsLong(&dump_callback_environ_);
+
   // Event to signal the client connection and pipe reads and writes.
   overlapped_.hEvent = CreateEvent(NULL,   // Security descriptor.
                                    TRUE,   // Manual reset.
@@ -773,6 +796,15 @@ void CrashGenerationServer::HandleConnectionRequest() {
 }
 
 bool CrashGenerationServer::AddClient(ClientInfo* client_info) {
+  PTP_WORK dump_work = CreateThreadpoolWork(OnDumpWork,
+                                            client_info,
+                                            &dump_callback_environ_);
+  if (!dump_work) {
+    return false;
+  }
+
+  client_info->set_dump_work(dump_work);
+
   HANDLE request_wait_handle = NULL;
   if (!RegisterWaitForSingleObject(&request_wait_handle,
                                    client_info->dump_requested_handle(),
@@ -825,14 +857,27 @@ void CALLBACK CrashGenerationServer::OnDumpRequest(void* context, BOOLEAN) {
   assert(context);
   ClientInfo* client_info = reinterpret_cast<ClientInfo*>(context);
 
+  // Reset the event before the dump is queued, so that the wait cannot
+  // fire again for the same request.
+  ResetEvent(client_info->dump_requested_handle());
+  SubmitThreadpoolWork(client_info->dump_work());
+}
+
+// static
+void CALLBACK CrashGenerationServer::OnDumpWork(PTP_CALLBACK_INSTANCE,
+                                                void* context,
+                                                PTP_WORK) {
+  assert(context);
+  ClientInfo* client_info = reinterpret_cast<ClientInfo*>(context);
+
   CrashGenerationServer* crash_server = client_info->crash_server();
   assert(crash_server);
+
+  AutoCriticalSection lock(client_info->dump_sync());
   if (crash_server->pre_fetch_custom_info_) {
     client_info->PopulateCustomInfo();
   }
   crash_server->HandleDumpRequest(*client_info);
-
-  ResetEvent(client_info->dump_requested_handle());
 }
 
 // static
@@ -853,6 +898,7 @@ void CrashGenerationServer::HandleClientProcessExit(ClientInfo* client_info) {
   // dump requests that might be pending to finish before proceeding
   // with the client_info cleanup.
   client_info->UnregisterDumpRequestWaitAndBlockUntilNoPending();
+  client_info->WaitForPendingDumps();
 
   if (exit_callback_) {
     exit_callback_(exit_context_, client_info);
@@ -880,12 +926,13 @@ void CrashGenerationServer::HandleClientProcessExit(ClientInfo* client_info) {
 
 void CrashGenerationServer::HandleDumpRequest(const ClientInfo& client_info) {
   bool execute_callback = true;
+  bool client_released = false;
   // Generate the dump only if it's explicitly requested by the
   // server application; otherwise the server might want to generate
   // dump in the callback.
   std::wstring dump_path;
   if (generate_dumps_) {
-    if (!GenerateDump(client_info, &dump_path)) {
+    if (!GenerateDump(client_info, &dump_path, &client_released)) {
       // client proccess terminated or some other error
       execute_callback = false;
     }
@@ -896,11 +943,15 @@ void CrashGenerationServer::HandleDumpRequest(const ClientInfo& client_info) {
     dump_callback_(dump_context_, &client_info, ptr_dump_path);
   }
 
-  SetEvent(client_info.dump_generated_handle());
+  // A client released early may already be waiting on its next request.
+  if (!client_released) {
+    SetEvent(client_info.dump_generated_handle());
+  }
 }
 
 bool CrashGenerationServer::GenerateDump(const ClientInfo& client,
-                                         std::wstring* dump_path) {
+                                         std::wstring* dump_path,
+                                         bool* client_released) {
   assert(client.pid() != 0);
   assert(client.process_handle());
 
@@ -940,6 +991,17 @@ bool CrashGenerationServer::GenerateDump(const ClientInfo& client,
     }
   }
 
+  if (filter_minidumps_) {
+    dump_generator.SetFilterPolicy(&minidump_filter_policy_);
+  }
+
+  // Everything the dump needs from the client is in the snapshot, so the
+  // client can go on while the dump is written.
+  if (use_process_snapshots_ && dump_generator.CaptureProcessSnapshot()) {
+    SetEvent(client.dump_generated_handle());
+    *client_released = true;
+  }
+
   return dump_generator.WriteMinidump();
 }
 
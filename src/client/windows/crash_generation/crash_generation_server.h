@@ -105,6 +105,33 @@ class CrashGenerationServer {
     pre_fetch_custom_info_ = do_pre_fetch;
   }
 
+  // Sets the most dumps that are written at once, for different clients.
+  // Each is written on a thread of the server's own thread pool. The
+  // default is 1. Must be called before Start.
+  void set_max_concurrent_dumps(int count) {
+    max_concurrent_dumps_ = count > 0 ? count : 1;
+  }
+
+  // Sets whether a snapshot of the client is captured before its dump is
+  // written, when the server generates dumps. The client is then released
+  // as soon as the snapshot is taken, and the dump is written from the
+  // snapshot while the client carries on or terminates. Where snapshots
+  // are not supported (before Windows 8.1) the client is dumped directly.
+  // Custom info should be pre-fetched, since the client may be gone by the
+  // time the dump request callback runs.
+  void set_use_process_snapshots(bool use_snapshots) {
+    use_process_snapshots_ = use_snapshots;
+  }
+
+  // Sets the policy that the minidumps the server generates are filtered
+  // by, leaving out the data of modules not in its allowlist and adding
+  // the memory referenced from the clients' stacks up to its budget. Full
+  // memory dumps are not filtered. Must be called before Start.
+  void set_minidump_filter_policy(const MinidumpFilterPolicy& policy) {
+    minidump_filter_policy_ = policy;
+    filter_minidumps_ = true;
+  }
+
  private:
   // Various states the client can be in during the handshake with
   // the server.
@@ -189,6 +216,11 @@ class CrashGenerationServer {
   // Callback for a dump request.
   static void CALLBACK OnDumpRequest(void* context, BOOLEAN timer_or_wait);
 
+  // Thread pool callback that writes a client's dump.
+  static void CALLBACK OnDumpWork(PTP_CALLBACK_INSTANCE instance,
+                                  void* context,
+                                  PTP_WORK work);
+
   // Callback for client process exit event.
   static void CALLBACK OnClientEnd(void* context, BOOLEAN timer_or_wait);
 
@@ -198,8 +230,11 @@ class CrashGenerationServer {
   // Adds the given client to the list of registered clients.
   bool AddClient(ClientInfo* client_info);
 
-  // Generates dump for the given client.
-  bool GenerateDump(const ClientInfo& client, std::wstring* dump_path);
+  // Generates dump for the given client. Sets |client_released| if the
+  // client was released before the dump was written.
+  bool GenerateDump(const ClientInfo& client,
+                    std::wstring* dump_path,
+                    bool* client_released);
 
   // Puts the server in a permanent error state and sets a signal such that
   // the state will be immediately entered after the current state transition
@@ -267,6 +302,20 @@ class CrashGenerationServer {
   // Wether to populate custom information up-front.
   bool pre_fetch_custom_info_;
 
+  // The most dumps written at once.
+  int max_concurrent_dumps_;
+
+  // Whether to dump clients from snapshots.
+  bool use_process_snapshots_;
+
+  // Whether to filter minidumps, and the policy to filter them by.
+  bool filter_minidumps_;
+  MinidumpFilterPolicy minidump_filter_policy_;
+
+  // Thread pool that writes the dumps, and its callback environment.
+  PTP_POOL dump_pool_;
+  TP_CALLBACK_ENVIRON dump_callback_environ_;
+
   // The dump path for the server.
   const std::wstring dump_path_;
 
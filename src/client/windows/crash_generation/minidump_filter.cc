@@ -0,0 +1,262 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// minidump_filter.cc: Decides which module data and memory go into a
+// minidump.
+//
+// See minidump_filter.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "client/windows/crash_generation/minidump_filter.h"
+
+#include <wchar.h>
+
+#include <algorithm>
+
+namespace google_breakpad {
+
+namespace {
+
+// Stacks are read this many bytes at a time.
+const SIZE_T kStackChunkSize = 64 * 1024;
+
+// Values below this are taken to be small integers rather than pointers.
+const ULONG64 kMinPointer = 0x10000;
+
+const DWORD kReadableProtection = PAGE_READONLY |
+                                  PAGE_READWRITE |
+                                  PAGE_WRITECOPY |
+                                  PAGE_EXECUTE_READ |
+                                  PAGE_EXECUTE_READWRITE |
+                                  PAGE_EXECUTE_WRITECOPY;
+
+}  // namespace
+
+MinidumpFilter::MinidumpFilter(const MinidumpFilterPolicy& policy,
+                               HANDLE process_handle,
+                               DWORD crashing_thread_id,
+                               const MINIDUMP_CALLBACK_INFORMATION* next)
+    : policy_(policy),
+      process_handle_(process_handle),
+      crashing_thread_id_(crashing_thread_id),
+      next_(next),
+      next_region_(0),
+      regions_finished_(false),
+      memory_added_(0),
+      readable_base_(0),
+      readable_end_(0) {
+  callback_info_.CallbackRoutine = Callback;
+  callback_info_.CallbackParam = this;
+}
+
+// static
+BOOL CALLBACK MinidumpFilter::Callback(
+    PVOID param,
+    const PMINIDUMP_CALLBACK_INPUT callback_input,
+    PMINIDUMP_CALLBACK_OUTPUT callback_output) {
+  MinidumpFilter* self = reinterpret_cast<MinidumpFilter*>(param);
+  switch (callback_input->CallbackType) {
+  case ModuleCallback: {
+    BOOL result = self->CallNext(callback_input, callback_output, TRUE);
+    // The module itself stays in the module list; only its data goes.
+    if (!self->IsModuleAllowed(callback_input->Module.FullPath)) {
+      callback_output->ModuleWriteFlags &=
+          ~(ModuleWriteDataSeg | ModuleWriteCodeSegs);
+    }
+    return result;
+  }
+
+  case ThreadCallback:
+    self->ScanStack(callback_input->Thread.ThreadId,
+                    callback_input->Thread.StackBase,
+                    callback_input->Thread.StackEnd);
+    return self->CallNext(callback_input, callback_output, TRUE);
+
+  case ThreadExCallback:
+    self->ScanStack(callback_input->ThreadEx.ThreadId,
+                    callback_input->ThreadEx.StackBase,
+                    callback_input->ThreadEx.StackEnd);
+    return self->CallNext(callback_input, callback_output, TRUE);
+
+  case IncludeModuleCallback:
+  case IncludeThreadCallback:
+    return self->CallNext(callback_input, callback_output, TRUE);
+
+  case MemoryCallback:
+    // Every thread has been seen by the first memory callback.
+    if (!self->regions_finished_) {
+      self->FinishRegions();
+    }
+    if (self->next_region_ < self->regions_.size()) {
+      const Region& region = self->regions_[self->next_region_++];
+      callback_output->MemoryBase = region.base;
+      callback_output->MemorySize = region.size;
+      return TRUE;
+    }
+    return self->CallNext(callback_input, callback_output, FALSE);
+
+  case CancelCallback:
+    // Stop receiving cancel callbacks, unless the next callback wants them.
+    callback_output->CheckCancel = FALSE;
+    callback_output->Cancel = FALSE;
+    return self->CallNext(callback_input, callback_output, TRUE);
+  }
+
+  return self->CallNext(callback_input, callback_output, FALSE);
+}
+
+BOOL MinidumpFilter::CallNext(const PMINIDUMP_CALLBACK_INPUT callback_input,
+                              PMINIDUMP_CALLBACK_OUTPUT callback_output,
+                              BOOL result) {
+  if (!next_ || !next_->CallbackRoutine) {
+    return result;
+  }
+  return next_->CallbackRoutine(next_->CallbackParam,
+                                callback_input,
+                                callback_output);
+}
+
+bool MinidumpFilter::IsModuleAllowed(const wchar_t* path) const {
+  if (!policy_.filter_modules) {
+    return true;
+  }
+  if (!path) {
+    return false;
+  }
+
+  const wchar_t* name = path;
+  for (const wchar_t* p = path; *p; ++p) {
+    if (*p == L'\\' || *p == L'/') {
+      name = p + 1;
+    }
+  }
+
+  for (size_t i = 0; i < policy_.module_allowlist.size(); ++i) {
+    if (_wcsicmp(name, policy_.module_allowlist[i].c_str()) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void MinidumpFilter::ScanStack(DWORD thread_id,
+                               ULONG64 stack_base,
+                               ULONG64 stack_end) {
+  if (policy_.stack_referenced_memory_size == 0) {
+    return;
+  }
+
+  std::vector<Region>* regions = thread_id == crashing_thread_id_ ?
+      &crashing_regions_ : &other_regions_;
+
+  // This assumes that the dumped process's pointer width matches ours.
+  const ULONG64 low = (std::min)(stack_base, stack_end) &
+                      ~static_cast<ULONG64>(sizeof(ULONG_PTR) - 1);
+  const ULONG64 high = (std::max)(stack_base, stack_end);
+  std::vector<ULONG_PTR> words(kStackChunkSize / sizeof(ULONG_PTR));
+  for (ULONG64 address = low; address < high; address += kStackChunkSize) {
+    SIZE_T size = static_cast<SIZE_T>(
+        (std::min)(static_cast<ULONG64>(kStackChunkSize), high - address));
+    const void* chunk =
+        reinterpret_cast<const void*>(static_cast<ULONG_PTR>(address));
+    SIZE_T bytes_read = 0;
+    if (!ReadProcessMemory(process_handle_,
+                           chunk,
+                           &words[0],
+                           size,
+                           &bytes_read)) {
+      return;
+    }
+
+    const size_t word_count = bytes_read / sizeof(ULONG_PTR);
+    for (size_t i = 0; i < word_count; ++i) {
+      AddReferencedBlock(words[i], regions);
+    }
+  }
+}
+
+void MinidumpFilter::AddReferencedBlock(ULONG64 pointer,
+                                        std::vector<Region>* regions) {
+  if (pointer < kMinPointer) {
+    return;
+  }
+
+  const ULONG block_size = policy_.stack_referenced_memory_size;
+  const ULONG64 block = pointer - pointer % block_size;
+  if (!recorded_blocks_.insert(block).second) {
+    return;
+  }
+
+  if (pointer < readable_base_ || pointer >= readable_end_) {
+    readable_base_ = readable_end_ = 0;
+    const void* address =
+        reinterpret_cast<const void*>(static_cast<ULONG_PTR>(pointer));
+    MEMORY_BASIC_INFORMATION info;
+    if (VirtualQueryEx(process_handle_,
+                       address,
+                       &info,
+                       sizeof(info)) == 0 ||
+        info.State != MEM_COMMIT ||
+        (info.Protect & kReadableProtection) == 0 ||
+        (info.Protect & PAGE_GUARD) != 0) {
+      return;
+    }
+    readable_base_ = reinterpret_cast<ULONG64>(info.BaseAddress);
+    readable_end_ = readable_base_ + info.RegionSize;
+  }
+
+  // Settle for the part of the block within the readable region.
+  const ULONG64 base = (std::max)(block, readable_base_);
+  const ULONG64 end = (std::min)(block + block_size, readable_end_);
+  Region region = {base, static_cast<ULONG>(end - base)};
+  regions->push_back(region);
+}
+
+void MinidumpFilter::FinishRegions() {
+  regions_finished_ = true;
+
+  const std::vector<Region>* sources[] = {&crashing_regions_,
+                                          &other_regions_};
+  for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); ++i) {
+    for (size_t j = 0; j < sources[i]->size(); ++j) {
+      const Region& region = (*sources[i])[j];
+      if (policy_.memory_budget != 0 &&
+          memory_added_ + region.size > policy_.memory_budget) {
+        return;
+      }
+      regions_.push_back(region);
+      memory_added_ += region.size;
+    }
+  }
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,161 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// minidump_filter.h: MinidumpFilter decides, through the
+// MINIDUMP_CALLBACK_INFORMATION passed to MiniDumpWriteDump, which module
+// data and memory go into a minidump.
+//
+// The dump type flags are all or nothing: MiniDumpWithDataSegs writes the
+// data sections of every module, and MiniDumpWithIndirectlyReferencedMemory
+// follows every pointer on every stack with no bound on the total.  A
+// MinidumpFilterPolicy instead keeps module data only for the modules it
+// names, and adds the memory around the pointers found on the stacks, the
+// crashing thread's first, until a byte budget is spent.
+
+#ifndef CLIENT_WINDOWS_CRASH_GENERATION_MINIDUMP_FILTER_H_
+#define CLIENT_WINDOWS_CRASH_GENERATION_MINIDUMP_FILTER_H_
+
+#include <windows.h>
+#include <dbghelp.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace google_breakpad {
+
+struct MinidumpFilterPolicy {
+  MinidumpFilterPolicy()
+      : filter_modules(false),
+        stack_referenced_memory_size(0),
+        memory_budget(0) {}
+
+  // Whether modules not in |module_allowlist| have their data left out.
+  // Such modules are still listed in the dump, with their version and
+  // debug information, so that stacks through them can be symbolized.
+  bool filter_modules;
+
+  // File names of the modules, without their directories, whose data is
+  // written when |filter_modules| is set.  Names are compared without
+  // regard to case.
+  std::vector<std::wstring> module_allowlist;
+
+  // The bytes of memory written around each pointer found on a thread's
+  // stack, or 0 to write none.  The memory is taken from the block of this
+  // size that contains the pointer.
+  ULONG stack_referenced_memory_size;
+
+  // The most bytes of stack-referenced memory written, or 0 for no limit.
+  // Memory referenced from the crashing thread's stack is written first.
+  ULONG64 memory_budget;
+};
+
+class MinidumpFilter {
+ public:
+  // |process_handle| is the handle the process's memory is read through;
+  // |crashing_thread_id| the thread whose stack is scanned first.  Callbacks
+  // are passed on to |next|, if not NULL, and its results are respected
+  // except where the policy overrides them.
+  MinidumpFilter(const MinidumpFilterPolicy& policy,
+                 HANDLE process_handle,
+                 DWORD crashing_thread_id,
+                 const MINIDUMP_CALLBACK_INFORMATION* next);
+
+  // Returns the callback information to pass to MiniDumpWriteDump.  The
+  // filter must outlive the call.
+  MINIDUMP_CALLBACK_INFORMATION* callback_info() { return &callback_info_; }
+
+  // The bytes of stack-referenced memory given to MiniDumpWriteDump.
+  ULONG64 memory_added() const { return memory_added_; }
+
+ private:
+  struct Region {
+    ULONG64 base;
+    ULONG size;
+  };
+
+  static BOOL CALLBACK Callback(PVOID param,
+                                const PMINIDUMP_CALLBACK_INPUT callback_input,
+                                PMINIDUMP_CALLBACK_OUTPUT callback_output);
+
+  // Passes the callback on to |next_|, returning |result| if there is none.
+  BOOL CallNext(const PMINIDUMP_CALLBACK_INPUT callback_input,
+                PMINIDUMP_CALLBACK_OUTPUT callback_output,
+                BOOL result);
+
+  // Returns true if the data of the module at |path| is to be written.
+  bool IsModuleAllowed(const wchar_t* path) const;
+
+  // Records the memory around the pointers on the stack between
+  // |stack_base| and |stack_end| of thread |thread_id|.
+  void ScanStack(DWORD thread_id, ULONG64 stack_base, ULONG64 stack_end);
+
+  // Records the block around |pointer|, if it points to readable memory
+  // and its block was not recorded already.
+  void AddReferencedBlock(ULONG64 pointer, std::vector<Region>* regions);
+
+  // Orders the recorded regions, crashing thread first, and trims them to
+  // the budget.  Called at the first memory callback, after every thread
+  // has been seen.
+  void FinishRegions();
+
+  MinidumpFilterPolicy policy_;
+  HANDLE process_handle_;
+  DWORD crashing_thread_id_;
+  const MINIDUMP_CALLBACK_INFORMATION* next_;
+  MINIDUMP_CALLBACK_INFORMATION callback_info_;
+
+  // The regions referenced from the crashing thread's stack and from the
+  // other threads' stacks.
+  std::vector<Region> crashing_regions_;
+  std::vector<Region> other_regions_;
+
+  // The bases of the blocks recorded so far.
+  std::set<ULONG64> recorded_blocks_;
+
+  // The regions given to MiniDumpWriteDump, and the next one to give.
+  std::vector<Region> regions_;
+  size_t next_region_;
+  bool regions_finished_;
+
+  ULONG64 memory_added_;
+
+  // The committed, readable memory region last queried, to save queries
+  // for pointers near each other.
+  ULONG64 readable_base_;
+  ULONG64 readable_end_;
+
+  // Disallow copy ctor and operator=.
+  MinidumpFilter(const MinidumpFilter&);
+  void operator=(const MinidumpFilter&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_WINDOWS_CRASH_GENERATION_MINIDUMP_FILTER_H_
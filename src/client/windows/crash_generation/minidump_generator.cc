@@ -266,6 +266,9 @@ MinidumpGenerator::MinidumpGenerator(
       rpcrt4_module_(NULL),
       create_uuid_(NULL),
       process_handle_(process_handle),
+      snapshot_(NULL),
+      snapshot_clone_handle_(NULL),
+      free_snapshot_(NULL),
       process_id_(process_id),
       thread_id_(thread_id),
       requesting_thread_id_(requesting_thread_id),
@@ -280,7 +283,8 @@ MinidumpGenerator::MinidumpGenerator(
       dump_file_is_internal_(false),
       full_dump_file_is_internal_(false),
       additional_streams_(NULL),
-      callback_info_(NULL) {
+      callback_info_(NULL),
+      filter_policy_(NULL) {
   uuid_ = {0};
   InitializeCriticalSection(&module_load_sync_);
   InitializeCriticalSection(&get_proc_address_sync_);
@@ -295,6 +299,10 @@ MinidumpGenerator::~MinidumpGenerator() {
     CloseHandle(full_dump_file_);
   }
 
+  if (snapshot_) {
+    free_snapshot_(GetCurrentProcess(), snapshot_);
+  }
+
   if (dbghelp_module_) {
     FreeLibrary(dbghelp_module_);
   }
@@ -367,7 +375,7 @@ bool MinidumpGenerator::WriteMinidump() {
     // read the memory of the client process.
     if (is_client_pointers_) {
       SIZE_T bytes_read = 0;
-      if (!ReadProcessMemory(process_handle_,
+      if (!ReadProcessMemory(GetMemoryHandle(),
                              assert_info_,
                              &client_assert_info,
                              sizeof(client_assert_info),
@@ -416,7 +424,7 @@ bool MinidumpGenerator::WriteMinidump() {
   // if the client already requested the handle trace to be stored in the dump.
   HandleTraceData handle_trace_data;
   if (exception_pointers_ && (dump_type_ & MiniDumpWithHandleData) == 0) {
-    if (!handle_trace_data.CollectHandleData(process_handle_,
+    if (!handle_trace_data.CollectHandleData(GetMemoryHandle(),
                                              exception_pointers_)) {
       if (dump_file_is_internal_)
         CloseHandle(dump_file_);
@@ -427,17 +435,45 @@ bool MinidumpGenerator::WriteMinidump() {
     }
   }
 
+  // The filter, if any, sees the minidump's callbacks before the user's.
+  scoped_ptr<MinidumpFilter> filter;
+  MINIDUMP_CALLBACK_INFORMATION* filtered_callback_info = callback_info_;
+  if (filter_policy_) {
+    filter.reset(new MinidumpFilter(*filter_policy_,
+                                    GetMemoryHandle(),
+                                    thread_id_,
+                                    callback_info_));
+    filtered_callback_info = filter->callback_info();
+  }
+
+  // A snapshot is dumped through its handle, with a callback that tells
+  // MiniDumpWriteDump what the handle is.
+  HANDLE dump_handle = process_handle_;
+  MINIDUMP_CALLBACK_INFORMATION* full_dump_callback_info = NULL;
+  MINIDUMP_CALLBACK_INFORMATION* dump_callback_info = filtered_callback_info;
+  MINIDUMP_CALLBACK_INFORMATION snapshot_full_dump_callback_info;
+  MINIDUMP_CALLBACK_INFORMATION snapshot_dump_callback_info;
+  if (snapshot_) {
+    dump_handle = reinterpret_cast<HANDLE>(snapshot_);
+    snapshot_full_dump_callback_info.CallbackRoutine = SnapshotCallback;
+    snapshot_full_dump_callback_info.CallbackParam = NULL;
+    full_dump_callback_info = &snapshot_full_dump_callback_info;
+    snapshot_dump_callback_info.CallbackRoutine = SnapshotCallback;
+    snapshot_dump_callback_info.CallbackParam = filtered_callback_info;
+    dump_callback_info = &snapshot_dump_callback_info;
+  }
+
   bool result_full_memory = true;
   if (full_memory_dump) {
     result_full_memory = write_dump(
-        process_handle_,
+        dump_handle,
         process_id_,
         full_dump_file_,
         static_cast<MINIDUMP_TYPE>((dump_type_ & (~MiniDumpNormal))
                                     | MiniDumpWithHandleData),
         dump_exception_pointers,
         &user_streams,
-        NULL) != FALSE;
+        full_dump_callback_info) != FALSE;
   }
 
   // Add handle operations trace stream to the minidump if it was collected.
@@ -447,18 +483,108 @@ bool MinidumpGenerator::WriteMinidump() {
   }
 
   bool result_minidump = write_dump(
-      process_handle_,
+      dump_handle,
       process_id_,
       dump_file_,
       static_cast<MINIDUMP_TYPE>((dump_type_ & (~MiniDumpWithFullMemory))
                                   | MiniDumpNormal),
       dump_exception_pointers,
       &user_streams,
-      callback_info_) != FALSE;
+      dump_callback_info) != FALSE;
 
   return result_minidump && result_full_memory;
 }
 
+bool MinidumpGenerator::CaptureProcessSnapshot() {
+  if (snapshot_) {
+    return false;
+  }
+
+  // The process snapshot functions are exported by kernel32.dll, which is
+  // always loaded, from Windows 8.1 on.
+  HMODULE kernel32 = GetModuleHandle(TEXT("kernel32.dll"));
+  if (!kernel32) {
+    return false;
+  }
+
+  PssCaptureSnapshotType capture_snapshot =
+      reinterpret_cast<PssCaptureSnapshotType>(
+          GetProcAddress(kernel32, "PssCaptureSnapshot"));
+  PssQuerySnapshotType query_snapshot =
+      reinterpret_cast<PssQuerySnapshotType>(
+          GetProcAddress(kernel32, "PssQuerySnapshot"));
+  PssFreeSnapshotType free_snapshot =
+      reinterpret_cast<PssFreeSnapshotType>(
+          GetProcAddress(kernel32, "PssFreeSnapshot"));
+  if (!capture_snapshot || !query_snapshot || !free_snapshot) {
+    return false;
+  }
+
+  // Capture everything MiniDumpWriteDump may read. The address space is
+  // cloned copy-on-write rather than copied.
+  const PSS_CAPTURE_FLAGS capture_flags = static_cast<PSS_CAPTURE_FLAGS>(
+      PSS_CAPTURE_VA_CLONE |
+      PSS_CAPTURE_HANDLES |
+      PSS_CAPTURE_HANDLE_NAME_INFORMATION |
+      PSS_CAPTURE_HANDLE_BASIC_INFORMATION |
+      PSS_CAPTURE_HANDLE_TYPE_SPECIFIC_INFORMATION |
+      PSS_CAPTURE_HANDLE_TRACE |
+      PSS_CAPTURE_THREADS |
+      PSS_CAPTURE_THREAD_CONTEXT |
+      PSS_CAPTURE_THREAD_CONTEXT_EXTENDED |
+      PSS_CREATE_BREAKAWAY |
+      PSS_CREATE_BREAKAWAY_OPTIONAL |
+      PSS_CREATE_USE_VM_ALLOCATIONS |
+      PSS_CREATE_RELEASE_SECTION);
+
+  HPSS snapshot = NULL;
+  if (capture_snapshot(process_handle_,
+                       capture_flags,
+                       CONTEXT_ALL,
+                       &snapshot) != ERROR_SUCCESS) {
+    return false;
+  }
+
+  PSS_VA_CLONE_INFORMATION clone_info = {0};
+  if (query_snapshot(snapshot,
+                     PSS_QUERY_VA_CLONE_INFORMATION,
+                     &clone_info,
+                     sizeof(clone_info)) != ERROR_SUCCESS) {
+    free_snapshot(GetCurrentProcess(), snapshot);
+    return false;
+  }
+
+  snapshot_ = snapshot;
+  snapshot_clone_handle_ = clone_info.VaCloneHandle;
+  free_snapshot_ = free_snapshot;
+  return true;
+}
+
+// static
+BOOL CALLBACK MinidumpGenerator::SnapshotCallback(
+    PVOID param,
+    const PMINIDUMP_CALLBACK_INPUT callback_input,
+    PMINIDUMP_CALLBACK_OUTPUT callback_output) {
+  if (callback_input->CallbackType == IsProcessSnapshotCallback) {
+    callback_output->Status = S_FALSE;
+    return TRUE;
+  }
+
+  MINIDUMP_CALLBACK_INFORMATION* callback_info =
+      reinterpret_cast<MINIDUMP_CALLBACK_INFORMATION*>(param);
+  if (callback_info && callback_info->CallbackRoutine) {
+    return callback_info->CallbackRoutine(callback_info->CallbackParam,
+                                          callback_input,
+                                          callback_output);
+  }
+
+  return TRUE;
+}
+
+HANDLE MinidumpGenerator::GetMemoryHandle() const {
+  return snapshot_clone_handle_ ? snapshot_clone_handle_ : process_handle_;
+}
+
 bool MinidumpGenerator::GenerateDumpFile(wstring* dump_path) {
   // The dump file was already set by handle or this function was previously
   // called.
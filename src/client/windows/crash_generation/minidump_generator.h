@@ -31,9 +31,11 @@
 
 #include <windows.h>
 #include <dbghelp.h>
+#include <processsnapshot.h>
 #include <rpc.h>
 #include <list>
 #include <string>
+#include "client/windows/crash_generation/minidump_filter.h"
 #include "google_breakpad/common/minidump_format.h"
 
 namespace google_breakpad {
@@ -89,6 +91,22 @@ class MinidumpGenerator {
     callback_info_ = callback_info;
   }
 
+  // Filters the minidump, though not the full memory dump, according to
+  // |policy|, which must outlive WriteMinidump. The callback set with
+  // SetCallback still sees every callback. NULL writes everything that
+  // the dump type asks for.
+  void SetFilterPolicy(const MinidumpFilterPolicy* policy) {
+    filter_policy_ = policy;
+  }
+
+  // Captures a snapshot of the process with PssCaptureSnapshot, which
+  // WriteMinidump then reads in place of the process. Once this returns
+  // true, the process can be resumed or terminated while the dump is
+  // written. Returns false if snapshots are not supported (before
+  // Windows 8.1) or the capture fails, in which case the process itself
+  // is dumped.
+  bool CaptureProcessSnapshot();
+
   // Writes the minidump with the given parameters. Stores the
   // dump file path in the dump_path parameter if dump generation
   // succeeds.
@@ -109,6 +127,34 @@ class MinidumpGenerator {
   // Function pointer type for UuidCreate, which is looked up dynamically.
   typedef RPC_STATUS (RPC_ENTRY* UuidCreateType)(UUID* Uuid);
 
+  // Function pointer types for the process snapshot functions, which are
+  // looked up dynamically.
+  typedef DWORD (WINAPI* PssCaptureSnapshotType)(
+      HANDLE ProcessHandle,
+      PSS_CAPTURE_FLAGS CaptureFlags,
+      DWORD ThreadContextFlags,
+      HPSS* SnapshotHandle);
+  typedef DWORD (WINAPI* PssQuerySnapshotType)(
+      HPSS SnapshotHandle,
+      PSS_QUERY_INFORMATION_CLASS InformationClass,
+      void* Buffer,
+      DWORD BufferLength);
+  typedef DWORD (WINAPI* PssFreeSnapshotType)(
+      HANDLE ProcessHandle,
+      HPSS SnapshotHandle);
+
+  // Tells MiniDumpWriteDump that it is reading a snapshot, and passes the
+  // other callbacks on to the MINIDUMP_CALLBACK_INFORMATION in |param|, if
+  // any.
+  static BOOL CALLBACK SnapshotCallback(
+      PVOID param,
+      const PMINIDUMP_CALLBACK_INPUT callback_input,
+      PMINIDUMP_CALLBACK_OUTPUT callback_output);
+
+  // Returns the handle to read the process's memory through: the snapshot's
+  // clone of the process if there is one, or else the process itself.
+  HANDLE GetMemoryHandle() const;
+
   // Loads the appropriate DLL lazily in a thread safe way.
   HMODULE GetDbghelpModule();
 
@@ -141,6 +187,15 @@ class MinidumpGenerator {
   // Handle for the process to dump.
   HANDLE process_handle_;
 
+  // Snapshot of the process to dump, if one was captured.
+  HPSS snapshot_;
+
+  // Clone of the process's address space in |snapshot_|.
+  HANDLE snapshot_clone_handle_;
+
+  // Pointer to the PssFreeSnapshot function, set along with |snapshot_|.
+  PssFreeSnapshotType free_snapshot_;
+
   // Process ID for the process to dump.
   DWORD process_id_;
 
@@ -189,6 +244,9 @@ class MinidumpGenerator {
   // The user defined callback for the various stages of the dump process.
   MINIDUMP_CALLBACK_INFORMATION* callback_info_;
 
+  // The policy the minidump is filtered by, if any.
+  const MinidumpFilterPolicy* filter_policy_;
+
   // Critical section to sychronize action of loading modules dynamically.
   CRITICAL_SECTION module_load_sync_;
 
@@ -55,8 +55,11 @@ typedef struct {
 #define DBG_PRINTEXCEPTION_WIDE_C ((DWORD)0x4001000A)
 #endif
 
-vector<ExceptionHandler*>* ExceptionHandler::handler_stack_ = NULL;
-LONG ExceptionHandler::handler_stack_index_ = 0;
+vector<ExceptionHandler*>* volatile ExceptionHandler::handler_stack_ = NULL;
+vector<vector<ExceptionHandler*>*>*
+    ExceptionHandler::retired_handler_stacks_ = NULL;
+DWORD ExceptionHandler::handler_stack_depth_slot_ = TLS_OUT_OF_INDEXES;
+volatile LONG ExceptionHandler::handling_count_ = 0;
 CRITICAL_SECTION ExceptionHandler::handler_stack_critical_section_;
 volatile LONG ExceptionHandler::instance_count_ = 0;
 
@@ -168,6 +171,7 @@ void ExceptionHandler::Initialize(
 #endif  // _MSC_VER >= 1400
   previous_pch_ = NULL;
   handler_thread_ = NULL;
+  handler_thread_id_ = 0;
   is_shutdown_ = false;
   handler_start_semaphore_ = NULL;
   handler_finish_semaphore_ = NULL;
@@ -177,6 +181,7 @@ void ExceptionHandler::Initialize(
   handler_return_value_ = false;
   handle_debug_exceptions_ = false;
   consume_invalid_handle_exceptions_ = false;
+  filter_minidumps_ = false;
 
   // Attempt to use out-of-process if user has specified a pipe or a
   // crash generation client.
@@ -227,6 +232,8 @@ void ExceptionHandler::Initialize(
                                      0,            // dwCreationFlags
                                      &thread_id);
       assert(handler_thread_ != NULL);
+      if (handler_thread_ != NULL)
+        handler_thread_id_ = thread_id;
     }
 
     dbghelp_module_ = LoadLibrary(L"dbghelp.dll");
@@ -265,9 +272,11 @@ void ExceptionHandler::Initialize(
   // cache coherent code for volatile.
   // TODO(munjal): Fix this in a better way by changing the design if possible.
 
-  // Lazy initialization of the handler_stack_critical_section_
+  // Lazy initialization of the handler_stack_critical_section_ and the
+  // handler stack depth slot.
   if (instance_count == 1) {
     InitializeCriticalSection(&handler_stack_critical_section_);
+    handler_stack_depth_slot_ = TlsAlloc();
   }
 
   if (handler_types != HANDLER_NONE) {
@@ -275,10 +284,11 @@ void ExceptionHandler::Initialize(
 
     // The first time an ExceptionHandler that installs a handler is
     // created, set up the handler stack.
-    if (!handler_stack_) {
-      handler_stack_ = new vector<ExceptionHandler*>();
-    }
-    handler_stack_->push_back(this);
+    vector<ExceptionHandler*>* handler_stack = handler_stack_ ?
+        new vector<ExceptionHandler*>(*handler_stack_) :
+        new vector<ExceptionHandler*>();
+    handler_stack->push_back(this);
+    PublishHandlerStack(handler_stack);
 
     if (handler_types & HANDLER_EXCEPTION)
       previous_filter_ = SetUnhandledExceptionFilter(HandleException);
@@ -318,30 +328,42 @@ ExceptionHandler::~ExceptionHandler() {
     if (handler_types_ & HANDLER_PURECALL)
       _set_purecall_handler(previous_pch_);
 
-    if (handler_stack_->back() == this) {
-      handler_stack_->pop_back();
+    vector<ExceptionHandler*>* handler_stack =
+        new vector<ExceptionHandler*>(*handler_stack_);
+    if (handler_stack->back() == this) {
+      handler_stack->pop_back();
     } else {
       // TODO(mmentovai): use advapi32!ReportEvent to log the warning to the
       // system's application event log.
       fprintf(stderr, "warning: removing Breakpad handler out of order\n");
-      vector<ExceptionHandler*>::iterator iterator = handler_stack_->begin();
-      while (iterator != handler_stack_->end()) {
+      vector<ExceptionHandler*>::iterator iterator = handler_stack->begin();
+      while (iterator != handler_stack->end()) {
         if (*iterator == this) {
-          iterator = handler_stack_->erase(iterator);
+          iterator = handler_stack->erase(iterator);
         } else {
           ++iterator;
         }
       }
     }
 
-    if (handler_stack_->empty()) {
+    if (handler_stack->empty()) {
       // When destroying the last ExceptionHandler that installed a handler,
       // clean up the handler stack.
-      delete handler_stack_;
-      handler_stack_ = NULL;
+      delete handler_stack;
+      handler_stack = NULL;
     }
+    PublishHandlerStack(handler_stack);
 
     LeaveCriticalSection(&handler_stack_critical_section_);
+
+    // A thread that found this handler in the old stack may still be
+    // handling an exception with it.  Exceptions this thread is handling,
+    // for example if a callback exits the process, are not waited for.
+    LONG own_depth = static_cast<LONG>(reinterpret_cast<INT_PTR>(
+        TlsGetValue(handler_stack_depth_slot_)));
+    while (InterlockedCompareExchange(&handling_count_, 0, 0) > own_depth) {
+      Sleep(1);
+    }
   }
 
   // Some of the objects were only initialized if out of process
@@ -376,10 +398,32 @@ ExceptionHandler::~ExceptionHandler() {
   // usage pattern for the code, this race condition is unlikely to hit, but it
   // is a race condition nonetheless.
   if (InterlockedDecrement(&instance_count_) == 0) {
+    if (retired_handler_stacks_) {
+      for (size_t i = 0; i < retired_handler_stacks_->size(); ++i) {
+        delete (*retired_handler_stacks_)[i];
+      }
+      delete retired_handler_stacks_;
+      retired_handler_stacks_ = NULL;
+    }
+    TlsFree(handler_stack_depth_slot_);
+    handler_stack_depth_slot_ = TLS_OUT_OF_INDEXES;
     DeleteCriticalSection(&handler_stack_critical_section_);
   }
 }
 
+// static
+void ExceptionHandler::PublishHandlerStack(
+    vector<ExceptionHandler*>* handler_stack) {
+  vector<ExceptionHandler*>* old_handler_stack =
+      reinterpret_cast<vector<ExceptionHandler*>*>(InterlockedExchangePointer(
+          reinterpret_cast<PVOID volatile*>(&handler_stack_), handler_stack));
+  if (old_handler_stack) {
+    if (!retired_handler_stacks_)
+      retired_handler_stacks_ = new vector<vector<ExceptionHandler*>*>();
+    retired_handler_stacks_->push_back(old_handler_stack);
+  }
+}
+
 bool ExceptionHandler::RequestUpload(DWORD crash_id) {
   return crash_generation_client_->RequestUpload(crash_id);
 }
@@ -420,29 +464,40 @@ DWORD ExceptionHandler::ExceptionHandlerThreadMain(void* lpParameter) {
 // ExceptionHandler instance to use.  The constructor locates the correct
 // instance, and makes it available through get_handler().  The destructor
 // restores the state in effect prior to allocating the AutoExceptionHandler.
+//
+// No lock is taken: the handler stack is read from an immutable snapshot,
+// and how deep into it the thread is, from thread local storage.
 class AutoExceptionHandler {
  public:
-  AutoExceptionHandler() {
-    // Increment handler_stack_index_ so that if another Breakpad handler is
-    // registered using this same HandleException function, and it needs to be
-    // called while this handler is running (either because this handler
-    // declines to handle the exception, or an exception occurs during
+  AutoExceptionHandler() : handler_(NULL), outermost_handler_(NULL) {
+    InterlockedIncrement(&ExceptionHandler::handling_count_);
+
+    // Count this handler in the thread's depth so that if another Breakpad
+    // handler is registered using this same HandleException function, and it
+    // needs to be called while this handler is running (either because this
+    // handler declines to handle the exception, or an exception occurs during
     // handling), HandleException will find the appropriate ExceptionHandler
     // object in handler_stack_ to deliver the exception to.
     //
-    // Because handler_stack_ is addressed in reverse (as |size - index|),
-    // preincrementing handler_stack_index_ avoids needing to subtract 1 from
-    // the argument to |at|.
+    // Because handler_stack_ is addressed in reverse (as |size - depth|),
+    // counting this handler first avoids needing to subtract 1 from the
+    // argument to |at|.
     //
-    // The index is maintained instead of popping elements off of the handler
+    // The depth is kept instead of popping elements off of the handler
     // stack and pushing them at the end of this method.  This avoids ruining
     // the order of elements in the stack in the event that some other thread
     // decides to manipulate the handler stack (such as creating a new
     // ExceptionHandler object) while an exception is being handled.
-    EnterCriticalSection(&ExceptionHandler::handler_stack_critical_section_);
-    handler_ = ExceptionHandler::handler_stack_->at(
-        ExceptionHandler::handler_stack_->size() -
-        ++ExceptionHandler::handler_stack_index_);
+    depth_ = GetDepth() + 1;
+    SetDepth(depth_);
+    vector<ExceptionHandler*>* handler_stack =
+        ExceptionHandler::handler_stack_;
+    if (!handler_stack)
+      return;
+    outermost_handler_ = handler_stack->front();
+    if (depth_ > handler_stack->size())
+      return;
+    handler_ = handler_stack->at(handler_stack->size() - depth_);
 
     // In case another exception occurs while this handler is doing its thing,
     // it should be delivered to the previous filter.
@@ -454,27 +509,58 @@ class AutoExceptionHandler {
   }
 
   ~AutoExceptionHandler() {
-    // Put things back the way they were before entering this handler.
-    SetUnhandledExceptionFilter(ExceptionHandler::HandleException);
+    SetDepth(depth_ - 1);
+
+    // Put things back the way they were before entering this handler, once
+    // no other thread is handling an exception either.
+    if (InterlockedDecrement(&ExceptionHandler::handling_count_) == 0 &&
+        handler_) {
+      SetUnhandledExceptionFilter(ExceptionHandler::HandleException);
 #if _MSC_VER >= 1400  // MSVC 2005/8
-    _set_invalid_parameter_handler(ExceptionHandler::HandleInvalidParameter);
+      _set_invalid_parameter_handler(ExceptionHandler::HandleInvalidParameter);
 #endif  // _MSC_VER >= 1400
-    _set_purecall_handler(ExceptionHandler::HandlePureVirtualCall);
-
-    --ExceptionHandler::handler_stack_index_;
-    LeaveCriticalSection(&ExceptionHandler::handler_stack_critical_section_);
+      _set_purecall_handler(ExceptionHandler::HandlePureVirtualCall);
+    }
   }
 
+  // The handler to deliver the exception to, or NULL if every Breakpad
+  // handler is already handling one on this thread.
   ExceptionHandler* get_handler() const { return handler_; }
 
+  // The handler whose previous handlers come after all of Breakpad's, or
+  // NULL if there are none.
+  ExceptionHandler* get_outermost_handler() const {
+    return outermost_handler_;
+  }
+
  private:
+  static size_t GetDepth() {
+    return reinterpret_cast<size_t>(
+        TlsGetValue(ExceptionHandler::handler_stack_depth_slot_));
+  }
+
+  static void SetDepth(size_t depth) {
+    TlsSetValue(ExceptionHandler::handler_stack_depth_slot_,
+                reinterpret_cast<LPVOID>(depth));
+  }
+
   ExceptionHandler* handler_;
+  ExceptionHandler* outermost_handler_;
+  size_t depth_;
 };
 
 // static
 LONG ExceptionHandler::HandleException(EXCEPTION_POINTERS* exinfo) {
   AutoExceptionHandler auto_exception_handler;
   ExceptionHandler* current_handler = auto_exception_handler.get_handler();
+  if (!current_handler) {
+    // Pass the exception on as though no Breakpad handler were present.
+    ExceptionHandler* outermost_handler =
+        auto_exception_handler.get_outermost_handler();
+    if (outermost_handler && outermost_handler->previous_filter_)
+      return outermost_handler->previous_filter_(exinfo);
+    return EXCEPTION_CONTINUE_SEARCH;
+  }
 
   // Ignore EXCEPTION_BREAKPOINT and EXCEPTION_SINGLE_STEP exceptions.  This
   // logic will short-circuit before calling WriteMinidumpOnHandlerThread,
@@ -592,7 +678,11 @@ void ExceptionHandler::HandleInvalidParameter(const wchar_t* expression,
   bool success = false;
   // In case of out-of-process dump generation, directly call
   // WriteMinidumpWithException since there is no separate thread running.
-  if (current_handler->IsOutOfProcess()) {
+  if (!current_handler) {
+    // Every Breakpad handler is already handling an exception on this
+    // thread; pass the problem on as though none were present.
+    current_handler = auto_exception_handler.get_outermost_handler();
+  } else if (current_handler->IsOutOfProcess()) {
     success = current_handler->WriteMinidumpWithException(
         GetCurrentThreadId(),
         &exception_ptrs,
@@ -603,7 +693,7 @@ void ExceptionHandler::HandleInvalidParameter(const wchar_t* expression,
   }
 
   if (!success) {
-    if (current_handler->previous_iph_) {
+    if (current_handler && current_handler->previous_iph_) {
       // The handler didn't fully handle the exception.  Give it to the
       // previous invalid parameter handler.
       current_handler->previous_iph_(expression,
@@ -673,7 +763,11 @@ void ExceptionHandler::HandlePureVirtualCall() {
   // In case of out-of-process dump generation, directly call
   // WriteMinidumpWithException since there is no separate thread running.
 
-  if (current_handler->IsOutOfProcess()) {
+  if (!current_handler) {
+    // Every Breakpad handler is already handling an exception on this
+    // thread; pass the call on as though none were present.
+    current_handler = auto_exception_handler.get_outermost_handler();
+  } else if (current_handler->IsOutOfProcess()) {
     success = current_handler->WriteMinidumpWithException(
         GetCurrentThreadId(),
         &exception_ptrs,
@@ -684,7 +778,7 @@ void ExceptionHandler::HandlePureVirtualCall() {
   }
 
   if (!success) {
-    if (current_handler->previous_pch_) {
+    if (current_handler && current_handler->previous_pch_) {
       // The handler didn't fully handle the exception.  Give it to the
       // previous purecall handler.
       current_handler->previous_pch_();
@@ -703,6 +797,12 @@ void ExceptionHandler::HandlePureVirtualCall() {
 
 bool ExceptionHandler::WriteMinidumpOnHandlerThread(
     EXCEPTION_POINTERS* exinfo, MDRawAssertionInfo* assertion) {
+  // The handler thread can't hand an exception of its own to itself.  The
+  // filters are swapped while a dump is written, but only until every
+  // thread is done, so one may still reach it here.
+  if (GetCurrentThreadId() == handler_thread_id_)
+    return false;
+
   EnterCriticalSection(&handler_critical_section_);
 
   // There isn't much we can do if the handler thread
@@ -1024,6 +1124,18 @@ bool ExceptionHandler::WriteMinidumpWithExceptionForProcess(
       callback.CallbackRoutine = MinidumpWriteDumpCallback;
       callback.CallbackParam = reinterpret_cast<void*>(&context);
 
+      // The filter sees each callback first, and passes it on to the one
+      // above for the registered memory.
+      MINIDUMP_CALLBACK_INFORMATION* callback_info = &callback;
+      scoped_ptr<MinidumpFilter> filter;
+      if (filter_minidumps_) {
+        filter.reset(new MinidumpFilter(minidump_filter_policy_,
+                                        process,
+                                        requesting_thread_id,
+                                        &callback));
+        callback_info = filter->callback_info();
+      }
+
       // The explicit comparison to TRUE avoids a warning (C4800).
       success = (minidump_write_dump_(process,
                                       GetProcessId(process),
@@ -1031,7 +1143,7 @@ bool ExceptionHandler::WriteMinidumpWithExceptionForProcess(
                                       dump_type_,
                                       exinfo ? &except_info : NULL,
                                       &user_streams,
-                                      &callback) == TRUE);
+                                      callback_info) == TRUE);
 
       CloseHandle(dump_file);
     }
@@ -70,6 +70,7 @@
 
 #include "client/windows/common/ipc_protocol.h"
 #include "client/windows/crash_generation/crash_generation_client.h"
+#include "client/windows/crash_generation/minidump_filter.h"
 #include "common/scoped_ptr.h"
 #include "google_breakpad/common/minidump_format.h"
 
@@ -281,6 +282,16 @@ class ExceptionHandler {
   void RegisterAppMemory(void* ptr, size_t length);
   void UnregisterAppMemory(void* ptr);
 
+  // Filters the minidumps written in process according to |policy|,
+  // leaving out the data of modules not in its allowlist and adding the
+  // memory referenced from the stacks up to its budget. Memory registered
+  // with RegisterAppMemory is always included. Out-of-process dumps are
+  // filtered by the policy set on the CrashGenerationServer.
+  void set_minidump_filter_policy(const MinidumpFilterPolicy& policy) {
+    minidump_filter_policy_ = policy;
+    filter_minidumps_ = true;
+  }
+
  private:
   friend class AutoExceptionHandler;
 
@@ -439,6 +450,7 @@ class ExceptionHandler {
 
   // The exception handler thread.
   HANDLE handler_thread_;
+  DWORD handler_thread_id_;
 
   // True if the exception handler is being destroyed.
   // Starting with MSVC 2005, Visual C has stronger guarantees on volatile vars.
@@ -490,22 +502,48 @@ class ExceptionHandler {
   // the dump.
   AppMemoryList app_memory_info_;
 
+  // Whether to filter minidumps written in process, and the policy to
+  // filter them by.
+  bool filter_minidumps_;
+  MinidumpFilterPolicy minidump_filter_policy_;
+
+  // Replaces handler_stack_ with |handler_stack|, which may be NULL, keeping
+  // the old stack in retired_handler_stacks_.  Called with
+  // handler_stack_critical_section_ held.
+  static void PublishHandlerStack(vector<ExceptionHandler*>* handler_stack);
+
   // A stack of ExceptionHandler objects that have installed unhandled
   // exception filters.  This vector is used by HandleException to determine
   // which ExceptionHandler object to route an exception to.  When an
   // ExceptionHandler is created with install_handler true, it will append
   // itself to this list.
-  static vector<ExceptionHandler*>* handler_stack_;
-
-  // The index of the ExceptionHandler in handler_stack_ that will handle the
-  // next exception.  Note that 0 means the last entry in handler_stack_, 1
-  // means the next-to-last entry, and so on.  This is used by HandleException
-  // to support multiple stacked Breakpad handlers.
-  static LONG handler_stack_index_;
-
-  // handler_stack_critical_section_ guards operations on handler_stack_ and
-  // handler_stack_index_. The critical section is initialized by the
-  // first instance of the class and destroyed by the last instance of it.
+  //
+  // The vector is never changed once it is published here: adding or
+  // removing a handler publishes a changed copy.  That lets the handlers read
+  // it without a lock, so threads that fault at the same moment don't queue
+  // up just to find out which ExceptionHandler to use.
+  static vector<ExceptionHandler*>* volatile handler_stack_;
+
+  // The stacks handler_stack_ pointed to before, which a thread that is
+  // handling an exception may still be reading.  They are deleted with the
+  // last instance of the class.
+  static vector<vector<ExceptionHandler*>*>* retired_handler_stacks_;
+
+  // The thread local storage slot holding how many of the handlers in
+  // handler_stack_ are already handling an exception on the thread.  An
+  // exception that occurs while one is handling it, or that it declines, is
+  // given to the next one down the stack: 0 means the last entry in
+  // handler_stack_, 1 means the next-to-last entry, and so on.
+  static DWORD handler_stack_depth_slot_;
+
+  // The number of exceptions being handled, on all threads, counting
+  // nested ones.  An ExceptionHandler being destroyed waits for those on
+  // other threads to finish, since they may be using it.
+  static volatile LONG handling_count_;
+
+  // handler_stack_critical_section_ serializes changes to handler_stack_.
+  // The critical section is initialized by the first instance of the class
+  // and destroyed by the last instance of it.
   static CRITICAL_SECTION handler_stack_critical_section_;
 
   // The number of instances of this class.
@@ -51,6 +51,9 @@ const MINIDUMP_TYPE kLargerDumpType = static_cast<MINIDUMP_TYPE>(
     MiniDumpWithUnloadedModules |  // Get unloaded modules when available.
     MiniDumpWithIndirectlyReferencedMemory);  // Get memory referenced by stack.
 
+// Data in this module's data section.
+int g_module_data = 1;
+
 // Large dump with all process memory.
 const MINIDUMP_TYPE kFullDumpType = static_cast<MINIDUMP_TYPE>(
     MiniDumpWithFullMemory |  // Full memory from process.
@@ -88,7 +91,9 @@ class MinidumpTest: public testing::Test {
     }
   }
 
-  bool WriteDump(ULONG flags) {
+  bool WriteDump(ULONG flags,
+                 bool from_snapshot = false,
+                 const google_breakpad::MinidumpFilterPolicy* policy = NULL) {
     using google_breakpad::MinidumpGenerator;
 
     // Fake exception is access violation on write to this.
@@ -117,6 +122,9 @@ class MinidumpTest: public testing::Test {
                                 TRUE);
     generator.GenerateDumpFile(&dump_file_);
     generator.GenerateFullDumpFile(&full_dump_file_);
+    if (from_snapshot && !generator.CaptureProcessSnapshot())
+      return false;
+    generator.SetFilterPolicy(policy);
     // And write a dump
     bool result = generator.WriteMinidump();
     return result == TRUE;
@@ -332,4 +340,59 @@ TEST_F(MinidumpTest, FullDump) {
   EXPECT_FALSE(full.HasStream(TokenStream));
 }
 
+TEST_F(MinidumpTest, SnapshotDump) {
+  ASSERT_TRUE(WriteDump(kLargerDumpType, true));
+  DumpAnalysis mini(dump_file_);
+
+  // The snapshot should give the same dump as the process.
+  EXPECT_TRUE(mini.HasStream(ThreadListStream));
+  EXPECT_TRUE(mini.HasStream(ModuleListStream));
+  EXPECT_TRUE(mini.HasStream(MemoryListStream));
+  EXPECT_TRUE(mini.HasStream(ExceptionStream));
+  EXPECT_TRUE(mini.HasStream(SystemInfoStream));
+  EXPECT_TRUE(mini.HasStream(UnloadedModuleListStream));
+  EXPECT_TRUE(mini.HasStream(MiscInfoStream));
+
+  EXPECT_TRUE(mini.HasMemory(this));
+  EXPECT_TRUE(mini.HasTebs());
+  EXPECT_TRUE(mini.HasPeb());
+}
+
+TEST_F(MinidumpTest, FilteredDump) {
+  // The fixture is on the heap, and the fake exception record on the
+  // stack points to it.
+  google_breakpad::MinidumpFilterPolicy policy;
+  policy.stack_referenced_memory_size = 256;
+  ASSERT_TRUE(WriteDump(MiniDumpNormal, false, &policy));
+  DumpAnalysis mini(dump_file_);
+
+  EXPECT_TRUE(mini.HasStream(ThreadListStream));
+  EXPECT_TRUE(mini.HasStream(ModuleListStream));
+  EXPECT_TRUE(mini.HasStream(MemoryListStream));
+  EXPECT_TRUE(mini.HasMemory(this));
+}
+
+TEST_F(MinidumpTest, FilteredDumpBudget) {
+  google_breakpad::MinidumpFilterPolicy policy;
+  policy.stack_referenced_memory_size = 256;
+  policy.memory_budget = 1;
+  ASSERT_TRUE(WriteDump(MiniDumpNormal, false, &policy));
+  DumpAnalysis mini(dump_file_);
+
+  // No block fits the budget, so the dump is as if unfiltered.
+  EXPECT_TRUE(mini.HasStream(MemoryListStream));
+  EXPECT_FALSE(mini.HasMemory(this));
+}
+
+TEST_F(MinidumpTest, FilteredDumpModules) {
+  google_breakpad::MinidumpFilterPolicy policy;
+  policy.filter_modules = true;
+  ASSERT_TRUE(WriteDump(MiniDumpWithDataSegs, false, &policy));
+  DumpAnalysis mini(dump_file_);
+
+  // The test's module stays listed, without its data.
+  EXPECT_TRUE(mini.HasStream(ModuleListStream));
+  EXPECT_FALSE(mini.HasMemory(&g_module_data));
+}
+
 }  // namespace
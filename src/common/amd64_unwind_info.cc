@@ -0,0 +1,352 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// amd64_unwind_info.cc: Convert the unwind data of x86-64 PE images into
+// Breakpad STACK CFI rules.
+//
+// See amd64_unwind_info.h for details, and
+// https://learn.microsoft.com/en-us/cpp/build/exception-handling-x64 for
+// the layout of the data.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "common/amd64_unwind_info.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace google_breakpad {
+
+namespace {
+
+// UNWIND_INFO flags.
+const uint8_t kChainInfo = 0x04;
+
+// Unwind operation codes.
+enum {
+  UWOP_PUSH_NONVOL = 0,  // info is the register number
+  UWOP_ALLOC_LARGE,      // info selects a scaled 16-bit or a 32-bit size
+  UWOP_ALLOC_SMALL,      // info is the size / 8 - 1
+  UWOP_SET_FPREG,        // frame register = RSP + frame offset * 16
+  UWOP_SAVE_NONVOL,      // info is the register, next slot offset / 8
+  UWOP_SAVE_NONVOL_FAR,  // info is the register, next 2 slots the offset
+  UWOP_EPILOG,           // version 2 epilog; UWOP_SAVE_XMM in version 1
+  UWOP_SPARE_CODE,       // UWOP_SAVE_XMM_FAR in version 1
+  UWOP_SAVE_XMM128,      // info is the XMM register, next slot offset / 16
+  UWOP_SAVE_XMM128_FAR,  // info is the XMM register, next 2 slots the offset
+  UWOP_PUSH_MACHFRAME    // info is 1 if an error code was pushed too
+};
+
+// The names the processor gives the registers, by unwind register number.
+const char* const kRegisterNames[] = {
+  "$rax", "$rcx", "$rdx", "$rbx", "$rsp", "$rbp", "$rsi", "$rdi",
+  "$r8",  "$r9",  "$r10", "$r11", "$r12", "$r13", "$r14", "$r15"
+};
+
+const int kRSP = 4;
+
+uint16_t Read16(const uint8_t* bytes) {
+  return bytes[0] | (bytes[1] << 8);
+}
+
+uint32_t Read32(const uint8_t* bytes) {
+  return Read16(bytes) | (static_cast<uint32_t>(Read16(bytes + 2)) << 16);
+}
+
+// Return the postfix expression for BASE plus OFFSET.
+string Offset(const string& base, int64_t offset) {
+  std::ostringstream expression;
+  if (offset < 0)
+    expression << base << " " << -offset << " -";
+  else
+    expression << base << " " << offset << " +";
+  return expression.str();
+}
+
+// The rules set by one STACK CFI record, in the order they were set.
+class RuleSet {
+ public:
+  void Set(const string& name, const string& expression) {
+    for (size_t i = 0; i < rules_.size(); ++i) {
+      if (rules_[i].first == name) {
+        rules_[i].second = expression;
+        return;
+      }
+    }
+    rules_.push_back(std::make_pair(name, expression));
+  }
+
+  bool empty() const { return rules_.empty(); }
+
+  string ToString() const {
+    string result;
+    for (size_t i = 0; i < rules_.size(); ++i) {
+      if (i)
+        result += ' ';
+      result += rules_[i].first + ": " + rules_[i].second;
+    }
+    return result;
+  }
+
+ private:
+  std::vector<std::pair<string, string> > rules_;
+};
+
+}  // namespace
+
+bool AMD64UnwindInfo::GetRules(uint32_t unwind_info_rva, Rules* rules) {
+  std::vector<Operation> operations;
+  if (!ReadOperations(unwind_info_rva, 0, false, &operations))
+    return false;
+
+  // Registers saved with a MOV are at an offset from the frame base: the
+  // stack pointer when the frame register was set or, without one, once
+  // the whole prologue has run.  Find how far below the CFA that is.  The
+  // CFA is the stack pointer before the call, 8 bytes above the stack
+  // pointer at the first instruction.
+  uint64_t cfa_offset = 8;
+  uint64_t frame_base = 0;
+  bool has_frame_register = false;
+  for (size_t i = 0; i < operations.size(); ++i) {
+    const Operation& operation = operations[i];
+    switch (operation.code) {
+      case UWOP_PUSH_NONVOL:
+        cfa_offset += 8;
+        break;
+      case UWOP_ALLOC_LARGE:
+      case UWOP_ALLOC_SMALL:
+        cfa_offset += operation.operand;
+        break;
+      case UWOP_SET_FPREG:
+        if (!has_frame_register)
+          frame_base = cfa_offset;
+        has_frame_register = true;
+        break;
+      case UWOP_PUSH_MACHFRAME:
+        // The caller's stack pointer is loaded from the machine frame,
+        // which the rules cannot express in terms of the CFA.
+        return false;
+    }
+    if (cfa_offset > 0x7fffffff)
+      return false;
+  }
+  if (!has_frame_register)
+    frame_base = cfa_offset;
+
+  RuleSet initial;
+  initial.Set(".cfa", "$rsp 8 +");
+  initial.Set(".ra", ".cfa 8 - ^");
+  std::vector<std::pair<uint32_t, RuleSet> > changes;
+  cfa_offset = 8;
+  bool cfa_uses_frame_register = false;
+  for (size_t i = 0; i < operations.size(); ++i) {
+    const Operation& operation = operations[i];
+    RuleSet* record;
+    if (operation.at_entry || operation.prolog_offset == 0) {
+      record = &initial;
+    } else {
+      if (changes.empty() || changes.back().first < operation.prolog_offset)
+        changes.push_back(std::make_pair(operation.prolog_offset, RuleSet()));
+      else if (changes.back().first > operation.prolog_offset)
+        return false;
+      record = &changes.back().second;
+    }
+
+    switch (operation.code) {
+      case UWOP_PUSH_NONVOL:
+        if (operation.info == kRSP)
+          return false;
+        cfa_offset += 8;
+        if (!cfa_uses_frame_register)
+          record->Set(".cfa", Offset("$rsp", cfa_offset));
+        record->Set(kRegisterNames[operation.info],
+                    Offset(".cfa", -static_cast<int64_t>(cfa_offset)) + " ^");
+        break;
+      case UWOP_ALLOC_LARGE:
+      case UWOP_ALLOC_SMALL:
+        cfa_offset += operation.operand;
+        if (!cfa_uses_frame_register)
+          record->Set(".cfa", Offset("$rsp", cfa_offset));
+        break;
+      case UWOP_SET_FPREG:
+        if (operation.frame_register == 0)
+          return false;
+        cfa_uses_frame_register = true;
+        record->Set(".cfa",
+                    Offset(kRegisterNames[operation.frame_register],
+                           static_cast<int64_t>(cfa_offset) -
+                               operation.frame_offset * 16));
+        break;
+      case UWOP_SAVE_NONVOL:
+      case UWOP_SAVE_NONVOL_FAR:
+        if (operation.info == kRSP)
+          return false;
+        record->Set(kRegisterNames[operation.info],
+                    Offset(".cfa", static_cast<int64_t>(operation.operand) -
+                                       static_cast<int64_t>(frame_base)) +
+                        " ^");
+        break;
+    }
+  }
+
+  rules->initial = initial.ToString();
+  rules->changes.clear();
+  for (size_t i = 0; i < changes.size(); ++i) {
+    if (!changes[i].second.empty()) {
+      rules->changes.push_back(
+          std::make_pair(changes[i].first, changes[i].second.ToString()));
+    }
+  }
+  return true;
+}
+
+bool AMD64UnwindInfo::ReadOperations(uint32_t unwind_info_rva, int depth,
+                                     bool at_entry,
+                                     std::vector<Operation>* operations) {
+  if (depth > kMaxChainDepth)
+    return false;
+
+  // An UnwindInfoAddress with the low bit set is the RVA of another
+  // RUNTIME_FUNCTION entry, whose unwind data this function shares.
+  if (unwind_info_rva & 1) {
+    const uint8_t* entry = image_->ReadRVA(unwind_info_rva & ~1U, 12);
+    if (!entry)
+      return false;
+    return ReadOperations(Read32(entry + 8), depth + 1, at_entry, operations);
+  }
+
+  const uint8_t* header = image_->ReadRVA(unwind_info_rva, 4);
+  if (!header)
+    return false;
+  uint8_t version = header[0] & 0x07;
+  uint8_t flags = header[0] >> 3;
+  uint8_t count = header[2];
+  uint8_t frame_register = header[3] & 0x0f;
+  uint8_t frame_offset = header[3] >> 4;
+  if (version != 1 && version != 2)
+    return false;
+
+  // The slots are padded to an even number, and followed by the
+  // RUNTIME_FUNCTION entry of the function this one is chained from.  The
+  // chained-from function's whole prologue runs before this one's.
+  const uint8_t* slots = image_->ReadRVA(unwind_info_rva, 4 + count * 2);
+  if (!slots)
+    return false;
+  slots += 4;
+  if (flags & kChainInfo) {
+    const uint8_t* parent =
+        image_->ReadRVA(unwind_info_rva + 4 + ((count + 1) & ~1) * 2, 12);
+    if (!parent ||
+        !ReadOperations(Read32(parent + 8), depth + 1, true, operations)) {
+      return false;
+    }
+  }
+
+  // The operations are listed last first, each followed by its extra slots.
+  size_t first = operations->size();
+  for (size_t i = 0; i < count;) {
+    Operation operation;
+    operation.prolog_offset = slots[i * 2];
+    operation.code = slots[i * 2 + 1] & 0x0f;
+    operation.info = slots[i * 2 + 1] >> 4;
+    operation.operand = 0;
+    operation.frame_register = frame_register;
+    operation.frame_offset = frame_offset;
+    operation.at_entry = at_entry;
+
+    size_t slot_count = 1;
+    bool describes_prologue = true;
+    switch (operation.code) {
+      case UWOP_PUSH_NONVOL:
+      case UWOP_ALLOC_SMALL:
+      case UWOP_SET_FPREG:
+      case UWOP_PUSH_MACHFRAME:
+        break;
+      case UWOP_ALLOC_LARGE:
+        if (operation.info > 1)
+          return false;
+        slot_count = operation.info == 0 ? 2 : 3;
+        break;
+      case UWOP_SAVE_NONVOL:
+      case UWOP_SAVE_XMM128:
+        slot_count = 2;
+        break;
+      case UWOP_SAVE_NONVOL_FAR:
+      case UWOP_SAVE_XMM128_FAR:
+        slot_count = 3;
+        break;
+      case UWOP_EPILOG:
+        // Version 2 describes epilogs here; version 1 saved an XMM
+        // register.  Neither affects the rules.
+        slot_count = version == 1 ? 2 : 1;
+        describes_prologue = false;
+        break;
+      case UWOP_SPARE_CODE:
+        slot_count = version == 1 ? 3 : 2;
+        describes_prologue = false;
+        break;
+      default:
+        return false;
+    }
+    if (i + slot_count > count)
+      return false;
+
+    switch (operation.code) {
+      case UWOP_ALLOC_SMALL:
+        operation.operand = operation.info * 8 + 8;
+        break;
+      case UWOP_ALLOC_LARGE:
+        if (operation.info == 0) {
+          operation.operand = Read16(slots + (i + 1) * 2) * 8;
+        } else {
+          operation.operand = Read32(slots + (i + 1) * 2);
+        }
+        break;
+      case UWOP_SAVE_NONVOL:
+        operation.operand = Read16(slots + (i + 1) * 2) * 8;
+        break;
+      case UWOP_SAVE_NONVOL_FAR:
+        operation.operand = Read32(slots + (i + 1) * 2);
+        break;
+      case UWOP_SAVE_XMM128:
+      case UWOP_SAVE_XMM128_FAR:
+        // The processor does not recover XMM registers.
+        describes_prologue = false;
+        break;
+    }
+    i += slot_count;
+    if (describes_prologue)
+      operations->push_back(operation);
+  }
+  std::reverse(operations->begin() + first, operations->end());
+  return true;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// amd64_unwind_info.h: Convert the unwind data of x86-64 PE images into
+// Breakpad STACK CFI rules.
+//
+// A PE32+ image describes how to unwind each of its non-leaf functions in
+// its exception directory (.pdata): a table of RUNTIME_FUNCTION entries,
+// each naming an UNWIND_INFO structure that lists the function's prologue
+// operations.  AMD64UnwindInfo replays those operations to find the rules
+// in effect after each one.  It reads the structures by their documented
+// layout, without any Windows headers, so that it can be used on any
+// platform.
+
+#ifndef COMMON_AMD64_UNWIND_INFO_H__
+#define COMMON_AMD64_UNWIND_INFO_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class AMD64UnwindInfo {
+ public:
+  // Provides the bytes of the image being read.
+  class ImageReader {
+   public:
+    virtual ~ImageReader() {}
+
+    // Return a pointer to SIZE bytes of the image at RVA, or NULL if the
+    // image does not contain them.
+    virtual const uint8_t* ReadRVA(uint32_t rva, size_t size) = 0;
+  };
+
+  // The STACK CFI rules for one function.
+  struct Rules {
+    // The rules in effect at the function's first instruction, for its
+    // STACK CFI INIT record.
+    string initial;
+
+    // The rules that change during the function's prologue, as pairs of
+    // the offset from the start of the function at which they take effect
+    // and the rules themselves, in increasing order of offset.  Each is a
+    // STACK CFI record.
+    std::vector<std::pair<uint32_t, string> > changes;
+  };
+
+  // How deep a chain of UNWIND_INFO structures may be followed.
+  static const int kMaxChainDepth = 32;
+
+  explicit AMD64UnwindInfo(ImageReader* image) : image_(image) {}
+
+  // Set RULES to the rules for the function whose RUNTIME_FUNCTION entry
+  // has UNWIND_INFO_RVA as its UnwindInfoAddress, following chained
+  // entries.  Return false if the unwind data is malformed, or if it uses
+  // an operation that STACK CFI rules cannot describe, such as the machine
+  // frame pushed for a trap handler.
+  bool GetRules(uint32_t unwind_info_rva, Rules* rules);
+
+ private:
+  // A prologue operation, with the operand from its extra slots.
+  struct Operation {
+    uint8_t prolog_offset;
+    uint8_t code;
+    uint8_t info;
+    uint32_t operand;
+    // The frame register and its scaled offset from the UNWIND_INFO
+    // that lists the operation.
+    uint8_t frame_register;
+    uint8_t frame_offset;
+    // True if the operation belongs to a function chained from, whose
+    // whole prologue has run by the first instruction.
+    bool at_entry;
+  };
+
+  // Append the operations of the UNWIND_INFO at UNWIND_INFO_RVA to
+  // OPERATIONS in the order they run, preceded by those of the functions it
+  // is chained from.  Return false if the data is malformed.
+  bool ReadOperations(uint32_t unwind_info_rva, int depth, bool at_entry,
+                      std::vector<Operation>* operations);
+
+  ImageReader* image_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_AMD64_UNWIND_INFO_H__
@@ -0,0 +1,226 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// amd64_unwind_info_unittest.cc: Unit tests for AMD64UnwindInfo.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <string.h>
+
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/amd64_unwind_info.h"
+
+namespace {
+
+using google_breakpad::AMD64UnwindInfo;
+using std::make_pair;
+using std::vector;
+
+// An image made of bytes placed at chosen RVAs.
+class FakeImage : public AMD64UnwindInfo::ImageReader {
+ public:
+  FakeImage() : bytes_(0x1000, 0xcc) {}
+
+  // Place BYTES at RVA.
+  void Put(uint32_t rva, const vector<uint8_t>& bytes) {
+    memcpy(&bytes_[rva], &bytes[0], bytes.size());
+  }
+
+  // Place an UNWIND_INFO at RVA with the given flags, frame register and
+  // offset, and slots, followed by CHAINED_RVA as the UnwindInfoAddress of
+  // the function it is chained from if there is one.
+  void PutUnwindInfo(uint32_t rva, uint8_t flags, uint8_t frame,
+                     const vector<uint16_t>& slots,
+                     uint32_t chained_rva = 0) {
+    vector<uint8_t> bytes;
+    bytes.push_back(1 | (flags << 3));
+    bytes.push_back(0x20);  // size_of_prolog
+    bytes.push_back(slots.size());
+    bytes.push_back(frame);
+    for (size_t i = 0; i < slots.size(); ++i) {
+      bytes.push_back(slots[i] & 0xff);
+      bytes.push_back(slots[i] >> 8);
+    }
+    if (slots.size() % 2) {
+      bytes.push_back(0);
+      bytes.push_back(0);
+    }
+    if (flags & 0x04) {
+      PutRuntimeFunction(&bytes, 0x100, 0x180, chained_rva);
+    }
+    Put(rva, bytes);
+  }
+
+  static void PutRuntimeFunction(vector<uint8_t>* bytes, uint32_t begin,
+                                 uint32_t end, uint32_t unwind_info_rva) {
+    uint32_t fields[] = { begin, end, unwind_info_rva };
+    for (size_t i = 0; i < 3; ++i) {
+      for (int shift = 0; shift < 32; shift += 8)
+        bytes->push_back(fields[i] >> shift);
+    }
+  }
+
+  const uint8_t* ReadRVA(uint32_t rva, size_t size) {
+    if (rva > bytes_.size() || size > bytes_.size() - rva)
+      return NULL;
+    return &bytes_[rva];
+  }
+
+ private:
+  vector<uint8_t> bytes_;
+};
+
+// Return an unwind code slot.
+uint16_t Code(uint8_t prolog_offset, uint8_t operation, uint8_t info) {
+  return prolog_offset | (operation << 8) | (info << 12);
+}
+
+const char kEntryRules[] = ".cfa: $rsp 8 + .ra: .cfa 8 - ^";
+
+TEST(AMD64UnwindInfo, PushesAndAllocation) {
+  // push rbx; push rsi; sub rsp, 0x20
+  FakeImage image;
+  image.PutUnwindInfo(0x200, 0, 0,
+                      { Code(6, 2, 3), Code(2, 0, 6), Code(1, 0, 3) });
+  AMD64UnwindInfo unwind_info(&image);
+  AMD64UnwindInfo::Rules rules;
+  ASSERT_TRUE(unwind_info.GetRules(0x200, &rules));
+  EXPECT_EQ(kEntryRules, rules.initial);
+  ASSERT_EQ(3U, rules.changes.size());
+  EXPECT_EQ(make_pair(1U, string(".cfa: $rsp 16 + $rbx: .cfa 16 - ^")),
+            rules.changes[0]);
+  EXPECT_EQ(make_pair(2U, string(".cfa: $rsp 24 + $rsi: .cfa 24 - ^")),
+            rules.changes[1]);
+  EXPECT_EQ(make_pair(6U, string(".cfa: $rsp 56 +")), rules.changes[2]);
+}
+
+TEST(AMD64UnwindInfo, LargeAllocations) {
+  // sub rsp, 0x1000; sub rsp, 0x123458
+  FakeImage image;
+  image.PutUnwindInfo(0x200, 0, 0,
+                      { Code(14, 1, 1), 0x3458, 0x0012, Code(7, 1, 0),
+                        0x0200 });
+  AMD64UnwindInfo unwind_info(&image);
+  AMD64UnwindInfo::Rules rules;
+  ASSERT_TRUE(unwind_info.GetRules(0x200, &rules));
+  ASSERT_EQ(2U, rules.changes.size());
+  EXPECT_EQ(make_pair(7U, string(".cfa: $rsp 4104 +")), rules.changes[0]);
+  EXPECT_EQ(make_pair(14U, string(".cfa: $rsp 1197152 +")),
+            rules.changes[1]);
+}
+
+TEST(AMD64UnwindInfo, SavesRelativeToFrameBase) {
+  // mov [rsp+8], rbx; push rdi; sub rsp, 0x20; mov [rsp+0x20], rbp
+  // The saves are at offsets from the stack pointer after the allocation.
+  FakeImage image;
+  image.PutUnwindInfo(0x200, 0, 0,
+                      { Code(15, 4, 5), 4, Code(10, 2, 3), Code(6, 0, 7),
+                        Code(5, 4, 3), 6 });
+  AMD64UnwindInfo unwind_info(&image);
+  AMD64UnwindInfo::Rules rules;
+  ASSERT_TRUE(unwind_info.GetRules(0x200, &rules));
+  ASSERT_EQ(4U, rules.changes.size());
+  EXPECT_EQ(make_pair(5U, string("$rbx: .cfa 0 + ^")), rules.changes[0]);
+  EXPECT_EQ(make_pair(6U, string(".cfa: $rsp 16 + $rdi: .cfa 16 - ^")),
+            rules.changes[1]);
+  EXPECT_EQ(make_pair(10U, string(".cfa: $rsp 48 +")), rules.changes[2]);
+  EXPECT_EQ(make_pair(15U, string("$rbp: .cfa 16 - ^")), rules.changes[3]);
+}
+
+TEST(AMD64UnwindInfo, FrameRegister) {
+  // push rbp; sub rsp, 0x40; lea rbp, [rsp+0x20]; mov [rbp+0x30], rsi
+  FakeImage image;
+  image.PutUnwindInfo(0x200, 0, 5 | (2 << 4),
+                      { Code(14, 4, 6), 6, Code(9, 3, 0), Code(5, 2, 7),
+                        Code(1, 0, 5) });
+  AMD64UnwindInfo unwind_info(&image);
+  AMD64UnwindInfo::Rules rules;
+  ASSERT_TRUE(unwind_info.GetRules(0x200, &rules));
+  ASSERT_EQ(4U, rules.changes.size());
+  EXPECT_EQ(make_pair(1U, string(".cfa: $rsp 16 + $rbp: .cfa 16 - ^")),
+            rules.changes[0]);
+  EXPECT_EQ(make_pair(5U, string(".cfa: $rsp 80 +")), rules.changes[1]);
+  EXPECT_EQ(make_pair(9U, string(".cfa: $rbp 48 +")), rules.changes[2]);
+  EXPECT_EQ(make_pair(14U, string("$rsi: .cfa 32 - ^")), rules.changes[3]);
+}
+
+TEST(AMD64UnwindInfo, Chained) {
+  // The function at 0x300 continues the one at 0x200, so the rules from
+  // its prologue apply from the first instruction.
+  FakeImage image;
+  image.PutUnwindInfo(0x200, 0, 0, { Code(5, 2, 1), Code(1, 0, 3) });
+  image.PutUnwindInfo(0x300, 0x04, 0, { Code(1, 0, 6) }, 0x200);
+  AMD64UnwindInfo unwind_info(&image);
+  AMD64UnwindInfo::Rules rules;
+  ASSERT_TRUE(unwind_info.GetRules(0x300, &rules));
+  EXPECT_EQ(".cfa: $rsp 32 + .ra: .cfa 8 - ^ $rbx: .cfa 16 - ^",
+            rules.initial);
+  ASSERT_EQ(1U, rules.changes.size());
+  EXPECT_EQ(make_pair(1U, string(".cfa: $rsp 40 + $rsi: .cfa 40 - ^")),
+            rules.changes[0]);
+
+  // An entry that refers to another RUNTIME_FUNCTION shares its data.
+  vector<uint8_t> entry;
+  FakeImage::PutRuntimeFunction(&entry, 0x100, 0x180, 0x200);
+  image.Put(0x400, entry);
+  ASSERT_TRUE(unwind_info.GetRules(0x401, &rules));
+  EXPECT_EQ(kEntryRules, rules.initial);
+  EXPECT_EQ(2U, rules.changes.size());
+}
+
+TEST(AMD64UnwindInfo, ChainLoop) {
+  FakeImage image;
+  image.PutUnwindInfo(0x200, 0x04, 0, {}, 0x300);
+  image.PutUnwindInfo(0x300, 0x04, 0, {}, 0x200);
+  AMD64UnwindInfo unwind_info(&image);
+  AMD64UnwindInfo::Rules rules;
+  EXPECT_FALSE(unwind_info.GetRules(0x200, &rules));
+}
+
+TEST(AMD64UnwindInfo, Unsupported) {
+  FakeImage image;
+  AMD64UnwindInfo unwind_info(&image);
+  AMD64UnwindInfo::Rules rules;
+
+  // A trap handler's machine frame.
+  image.PutUnwindInfo(0x200, 0, 0, { Code(0, 10, 0) });
+  EXPECT_FALSE(unwind_info.GetRules(0x200, &rules));
+
+  // An operation missing its extra slot.
+  image.PutUnwindInfo(0x200, 0, 0, { Code(4, 4, 3) });
+  EXPECT_FALSE(unwind_info.GetRules(0x200, &rules));
+
+  // Unwind data past the end of the image.
+  EXPECT_FALSE(unwind_info.GetRules(0xffe, &rules));
+}
+
+}  // namespace
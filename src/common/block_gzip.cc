@@ -0,0 +1,460 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// block_gzip.cc: Implement BlockGzipWriter and GunzipData.  See
+// block_gzip.h for details.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "common/block_gzip.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+namespace google_breakpad {
+
+namespace {
+
+#ifdef HAVE_LIBZ
+// The header of each block: the fixed gzip header with the FEXTRA flag
+// set, followed by the extra field's length and the "BP" subfield, whose
+// four bytes hold the size of the whole member, least significant first.
+const uint8_t kBlockHeader[] = {
+  0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 8, 0, 'B', 'P', 4, 0
+};
+const size_t kBlockHeaderSize = sizeof(kBlockHeader) + 4;
+
+// The CRC-32 and the size of the data, which end each member.
+const size_t kTrailerSize = 8;
+
+void PutUInt32(uint32_t value, char* out) {
+  for (int i = 0; i < 4; ++i)
+    out[i] = static_cast<char>(value >> (i * 8));
+}
+
+uint32_t GetUInt32(const char* in) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i)
+    value |= static_cast<uint32_t>(static_cast<uint8_t>(in[i])) << (i * 8);
+  return value;
+}
+
+// Compress BLOCK into a complete gzip member in *MEMBER.
+bool CompressBlock(const vector<char>& block, vector<char>* member) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS,
+                   8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  uLong bound = deflateBound(&stream, block.size());
+  member->resize(kBlockHeaderSize + bound + kTrailerSize);
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(block.data()));
+  stream.avail_in = block.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&(*member)[kBlockHeaderSize]);
+  stream.avail_out = bound;
+  int result = deflate(&stream, Z_FINISH);
+  size_t compressed_size = stream.total_out;
+  deflateEnd(&stream);
+  if (result != Z_STREAM_END)
+    return false;
+
+  size_t member_size = kBlockHeaderSize + compressed_size + kTrailerSize;
+  member->resize(member_size);
+  memcpy(&(*member)[0], kBlockHeader, sizeof(kBlockHeader));
+  PutUInt32(member_size, &(*member)[sizeof(kBlockHeader)]);
+  uLong crc = crc32(0, reinterpret_cast<const Bytef*>(block.data()),
+                    block.size());
+  PutUInt32(crc, &(*member)[member_size - kTrailerSize]);
+  PutUInt32(block.size(), &(*member)[member_size - 4]);
+  return true;
+}
+
+// Where one block of blocked gzip data is, and where its data goes.
+struct Block {
+  const char* compressed;
+  size_t compressed_size;
+  size_t offset, size;
+  uint32_t crc;
+};
+
+// Find every block of DATA, storing them in *BLOCKS and the total size of
+// their contents in *SIZE.  Return false if DATA was not written by
+// BlockGzipWriter.
+bool FindBlocks(const char* data, size_t size, vector<Block>* blocks,
+                size_t* total_size) {
+  *total_size = 0;
+  size_t position = 0;
+  while (position < size) {
+    const char* member = data + position;
+    if (size - position < kBlockHeaderSize + kTrailerSize ||
+        memcmp(member, kBlockHeader, sizeof(kBlockHeader)) != 0) {
+      return false;
+    }
+    size_t member_size = GetUInt32(member + sizeof(kBlockHeader));
+    if (member_size < kBlockHeaderSize + kTrailerSize ||
+        member_size > size - position) {
+      return false;
+    }
+    Block block;
+    block.compressed = member + kBlockHeaderSize;
+    block.compressed_size = member_size - kBlockHeaderSize - kTrailerSize;
+    block.offset = *total_size;
+    block.size = GetUInt32(member + member_size - 4);
+    block.crc = GetUInt32(member + member_size - kTrailerSize);
+    blocks->push_back(block);
+    *total_size += block.size;
+    position += member_size;
+  }
+  return !blocks->empty();
+}
+
+// Decompress BLOCK into its place in OUTPUT.
+bool InflateBlock(const Block& block, char* output) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+    return false;
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(block.compressed));
+  stream.avail_in = block.compressed_size;
+  stream.next_out = reinterpret_cast<Bytef*>(output + block.offset);
+  stream.avail_out = block.size;
+  int result = inflate(&stream, Z_FINISH);
+  bool complete = result == Z_STREAM_END && stream.avail_out == 0;
+  inflateEnd(&stream);
+  return complete &&
+         crc32(0, reinterpret_cast<const Bytef*>(output + block.offset),
+               block.size) == block.crc;
+}
+
+// Decompress gzip data of any kind, one member after another.
+bool InflateSerially(const char* data, size_t size, vector<char>* output) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // Accept only the gzip wrapper.
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+    return false;
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  stream.avail_in = size;
+  int result = Z_OK;
+  while (result != Z_STREAM_END || stream.avail_in) {
+    if (result == Z_STREAM_END && inflateReset(&stream) != Z_OK)
+      break;
+    // inflateReset clears total_out, so the output's size says how much
+    // has been decompressed.
+    size_t used = output->size();
+    output->resize(std::max<size_t>(output->size() * 2, 1 << 16));
+    stream.next_out = reinterpret_cast<Bytef*>(&(*output)[used]);
+    stream.avail_out = output->size() - used;
+    result = inflate(&stream, Z_NO_FLUSH);
+    output->resize(used + (output->size() - used - stream.avail_out));
+    if (result != Z_OK && result != Z_STREAM_END)
+      break;
+  }
+  inflateEnd(&stream);
+  return result == Z_STREAM_END && !stream.avail_in;
+}
+#endif  // HAVE_LIBZ
+
+}  // namespace
+
+BlockGzipReader::BlockGzipReader(std::istream* stream)
+    : stream_(stream), size_(0), current_(0), position_(0) {
+  setg(NULL, NULL, NULL);
+}
+
+bool BlockGzipReader::Open() {
+  blocks_.clear();
+  size_ = 0;
+  position_ = 0;
+#ifdef HAVE_LIBZ
+  // Read each member's header and trailer, skipping its contents.
+  uint64_t member_offset = 0;
+  char header[kBlockHeaderSize];
+  for (;;) {
+    stream_->clear();
+    if (!stream_->seekg(member_offset) ||
+        !stream_->read(header, sizeof(header))) {
+      break;
+    }
+    if (memcmp(header, kBlockHeader, sizeof(kBlockHeader)) != 0)
+      return false;
+    size_t member_size = GetUInt32(header + sizeof(kBlockHeader));
+    char trailer[kTrailerSize];
+    if (member_size < kBlockHeaderSize + kTrailerSize ||
+        !stream_->seekg(member_offset + member_size - kTrailerSize) ||
+        !stream_->read(trailer, sizeof(trailer))) {
+      return false;
+    }
+    BlockInfo block;
+    block.member_offset = member_offset;
+    block.compressed_size = member_size - kBlockHeaderSize - kTrailerSize;
+    block.offset = size_;
+    block.size = GetUInt32(trailer + 4);
+    block.crc = GetUInt32(trailer);
+    blocks_.push_back(block);
+    size_ += block.size;
+    member_offset += member_size;
+  }
+  stream_->clear();
+#endif
+  current_ = blocks_.size();
+  setg(NULL, NULL, NULL);
+  return !blocks_.empty();
+}
+
+bool BlockGzipReader::Load(uint64_t position) {
+#ifdef HAVE_LIBZ
+  // Find the last block starting at or before POSITION.
+  size_t index = std::upper_bound(
+      blocks_.begin(), blocks_.end(), position,
+      [](uint64_t position, const BlockInfo& block) {
+        return position < block.offset;
+      }) - blocks_.begin();
+  if (index == 0)
+    return false;
+  --index;
+  const BlockInfo& info = blocks_[index];
+  if (position >= info.offset + info.size)
+    return false;
+
+  if (index != current_) {
+    current_ = blocks_.size();
+    compressed_.resize(info.compressed_size);
+    block_.resize(info.size);
+    stream_->clear();
+    if (!stream_->seekg(info.member_offset + kBlockHeaderSize) ||
+        !stream_->read(compressed_.data(), compressed_.size())) {
+      return false;
+    }
+    Block block;
+    block.compressed = compressed_.data();
+    block.compressed_size = compressed_.size();
+    block.offset = 0;
+    block.size = info.size;
+    block.crc = info.crc;
+    if (!InflateBlock(block, block_.data()))
+      return false;
+    current_ = index;
+  }
+  setg(block_.data(), block_.data() + (position - info.offset),
+       block_.data() + info.size);
+  return true;
+#else
+  return false;
+#endif
+}
+
+BlockGzipReader::int_type BlockGzipReader::underflow() {
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+  uint64_t position = position_;
+  if (eback())
+    position = blocks_[current_].offset + blocks_[current_].size;
+  if (!Load(position)) {
+    position_ = position;
+    setg(NULL, NULL, NULL);
+    return traits_type::eof();
+  }
+  return traits_type::to_int_type(*gptr());
+}
+
+BlockGzipReader::pos_type BlockGzipReader::seekoff(
+    off_type offset, std::ios_base::seekdir direction,
+    std::ios_base::openmode mode) {
+  uint64_t base = 0;
+  if (direction == std::ios_base::cur) {
+    base = position_;
+    if (eback())
+      base = blocks_[current_].offset + (gptr() - eback());
+  } else if (direction == std::ios_base::end) {
+    base = size_;
+  }
+  if (offset < 0 && static_cast<uint64_t>(-offset) > base)
+    return pos_type(off_type(-1));
+  return seekpos(pos_type(off_type(base + offset)), mode);
+}
+
+BlockGzipReader::pos_type BlockGzipReader::seekpos(
+    pos_type position, std::ios_base::openmode mode) {
+  if (!(mode & std::ios_base::in) || off_type(position) < 0 ||
+      static_cast<uint64_t>(off_type(position)) > size_) {
+    return pos_type(off_type(-1));
+  }
+  const uint64_t target = off_type(position);
+  if (current_ < blocks_.size() && target >= blocks_[current_].offset &&
+      target < blocks_[current_].offset + blocks_[current_].size) {
+    // The block is already decompressed.
+    setg(block_.data(), block_.data() + (target - blocks_[current_].offset),
+         block_.data() + block_.size());
+  } else {
+    // Find the block when it is read.
+    position_ = target;
+    setg(NULL, NULL, NULL);
+  }
+  return position;
+}
+
+BlockGzipWriter::BlockGzipWriter(std::ostream* stream, int thread_count,
+                                 size_t block_size)
+    : stream_(stream),
+      thread_count_(std::max(thread_count, 1)),
+      block_size_(block_size),
+      failed_(false) {
+  block_.resize(block_size_);
+  setp(&block_[0], &block_[0] + block_size_);
+}
+
+BlockGzipWriter::~BlockGzipWriter() {
+  Finish();
+}
+
+bool BlockGzipWriter::Finish() {
+  EndBlock(true);
+  return !failed_;
+}
+
+BlockGzipWriter::int_type BlockGzipWriter::overflow(int_type c) {
+  EndBlock(false);
+  if (traits_type::eq_int_type(c, traits_type::eof()))
+    return traits_type::not_eof(c);
+  *pptr() = traits_type::to_char_type(c);
+  pbump(1);
+  return c;
+}
+
+void BlockGzipWriter::EndBlock(bool flush) {
+  size_t used = pptr() - pbase();
+  if (used) {
+    block_.resize(used);
+    queue_.push_back(vector<char>());
+    queue_.back().swap(block_);
+    block_.resize(block_size_);
+    setp(&block_[0], &block_[0] + block_size_);
+  }
+  if (queue_.empty() || (!flush && queue_.size() < thread_count_))
+    return;
+
+#ifdef HAVE_LIBZ
+  // Compress the queued blocks in place of their contents.
+  std::atomic<size_t> next_block(0);
+  std::atomic<bool> compressed(true);
+  auto compress_blocks = [&]() {
+    for (size_t i = next_block++; i < queue_.size(); i = next_block++) {
+      vector<char> member;
+      if (!CompressBlock(queue_[i], &member))
+        compressed = false;
+      queue_[i].swap(member);
+    }
+  };
+  vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count_ && i < queue_.size(); ++i)
+    threads.push_back(std::thread(compress_blocks));
+  compress_blocks();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  if (!compressed)
+    failed_ = true;
+  for (const vector<char>& member : queue_) {
+    if (!failed_ && !stream_->write(member.data(), member.size()))
+      failed_ = true;
+  }
+#else
+  failed_ = true;
+#endif
+  queue_.clear();
+}
+
+bool IsGzipData(const char* data, size_t size) {
+  return size >= 2 && static_cast<uint8_t>(data[0]) == 0x1f &&
+         static_cast<uint8_t>(data[1]) == 0x8b;
+}
+
+bool GunzipData(const char* data, size_t size, int thread_count,
+                char** output, size_t* output_size) {
+  *output = NULL;
+  *output_size = 0;
+#ifdef HAVE_LIBZ
+  vector<Block> blocks;
+  size_t total_size;
+  if (!FindBlocks(data, size, &blocks, &total_size)) {
+    vector<char> contents;
+    if (!InflateSerially(data, size, &contents))
+      return false;
+    *output_size = contents.size() + 1;
+    *output = new char[*output_size];
+    memcpy(*output, contents.data(), contents.size());
+    (*output)[contents.size()] = '\0';
+    return true;
+  }
+
+  char* buffer = new char[total_size + 1];
+  std::atomic<size_t> next_block(0);
+  std::atomic<bool> inflated(true);
+  auto inflate_blocks = [&]() {
+    for (size_t i = next_block++; i < blocks.size() && inflated;
+         i = next_block++) {
+      if (!InflateBlock(blocks[i], buffer))
+        inflated = false;
+    }
+  };
+  vector<std::thread> threads;
+  for (int i = 1; i < thread_count && i < static_cast<int>(blocks.size());
+       ++i) {
+    threads.push_back(std::thread(inflate_blocks));
+  }
+  inflate_blocks();
+  for (std::thread& thread : threads)
+    thread.join();
+  if (!inflated) {
+    delete[] buffer;
+    return false;
+  }
+  buffer[total_size] = '\0';
+  *output = buffer;
+  *output_size = total_size + 1;
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace google_breakpad
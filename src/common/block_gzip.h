@@ -0,0 +1,172 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// block_gzip.h: Write and read gzip data made up of separately compressed
+// blocks, so that large symbol files can be stored compressed and still
+// be decompressed on several threads.
+//
+// Each block is a complete gzip member whose header carries an extra
+// field, "BP", holding the size of the whole member, much as in the BGZF
+// format.  A series of members is itself valid gzip data, so the files can
+// still be read with gunzip or zcat, while the sizes form an index that
+// lets a reader find every block without decompressing any of them.
+
+#ifndef COMMON_BLOCK_GZIP_H__
+#define COMMON_BLOCK_GZIP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+namespace google_breakpad {
+
+using std::vector;
+
+// A stream buffer that compresses everything written to it into blocked
+// gzip data on another stream.  For example:
+//
+//   BlockGzipWriter writer(&file, 4);
+//   std::ostream compressed(&writer);
+//   module.Write(compressed, ALL_SYMBOL_DATA);
+//   writer.Finish();
+class BlockGzipWriter : public std::streambuf {
+ public:
+  static const size_t kDefaultBlockSize = 1 << 20;
+
+  // Compress the data written to this buffer into STREAM, in blocks of
+  // BLOCK_SIZE bytes, compressing up to THREAD_COUNT blocks at once.
+  BlockGzipWriter(std::ostream* stream, int thread_count,
+                  size_t block_size = kDefaultBlockSize);
+
+  // Compress and write any data not yet written.
+  ~BlockGzipWriter();
+
+  // Compress and write the data not yet written.  Return false if the
+  // data could not be compressed or written, now or earlier.
+  bool Finish();
+
+ protected:
+  int_type overflow(int_type c);
+
+ private:
+  // Queue the data in the current block, starting a new one, and compress
+  // and write the queue if it is full or FLUSH is true.
+  void EndBlock(bool flush);
+
+  std::ostream* stream_;
+  size_t thread_count_;
+  size_t block_size_;
+  vector<char> block_;
+  vector<vector<char> > queue_;
+  bool failed_;
+
+  BlockGzipWriter(const BlockGzipWriter&);
+  void operator=(const BlockGzipWriter&);
+};
+
+// A stream buffer that reads the blocked gzip data on another stream as
+// the data it holds, decompressing only the blocks that are read, so that
+// reading small parts of a large file stays cheap.  For example:
+//
+//   BlockGzipReader reader(&file);
+//   if (reader.Open()) {
+//     std::istream contents(&reader);
+//     contents.seekg(offset);
+//     contents.read(buffer, size);
+//   }
+class BlockGzipReader : public std::streambuf {
+ public:
+  // Read the blocked gzip data on STREAM, which must remain valid as long
+  // as this buffer is used.
+  explicit BlockGzipReader(std::istream* stream);
+
+  // Find every block of the data.  Return false if STREAM does not hold
+  // data written by BlockGzipWriter, or if the reader was built without
+  // zlib.
+  bool Open();
+
+ protected:
+  int_type underflow();
+  pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+                   std::ios_base::openmode mode);
+  pos_type seekpos(pos_type position, std::ios_base::openmode mode);
+
+ private:
+  // Where one block is in the compressed data, and in the data it holds.
+  struct BlockInfo {
+    uint64_t member_offset;
+    size_t compressed_size;
+    uint64_t offset;
+    size_t size;
+    uint32_t crc;
+  };
+
+  // Decompress the block holding POSITION, and make POSITION the next
+  // character read.  Return false if POSITION is past the end of the data,
+  // or the block could not be decompressed.
+  bool Load(uint64_t position);
+
+  std::istream* stream_;
+  vector<BlockInfo> blocks_;
+
+  // The size of the data the blocks hold.
+  uint64_t size_;
+
+  // The index of the block decompressed into |block_|, or blocks_.size()
+  // if there is none.  The get area covers |block_| unless it is empty.
+  size_t current_;
+
+  // The position to read from next, while the get area is empty.
+  uint64_t position_;
+
+  vector<char> block_;
+  vector<char> compressed_;
+
+  BlockGzipReader(const BlockGzipReader&);
+  void operator=(const BlockGzipReader&);
+};
+
+// Return true if DATA begins like gzip data.
+bool IsGzipData(const char* data, size_t size);
+
+// Decompress the gzip data DATA into a new[]-allocated buffer followed by
+// a NUL character, storing the buffer in *OUTPUT and its size, NUL
+// included, in *OUTPUT_SIZE.  Data written by BlockGzipWriter is
+// decompressed on up to THREAD_COUNT threads, each block straight into its
+// place in the buffer; other gzip data is decompressed on the calling
+// thread.  Return false if DATA is not valid gzip data.
+bool GunzipData(const char* data, size_t size, int thread_count,
+                char** output, size_t* output_size);
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_BLOCK_GZIP_H__
@@ -0,0 +1,218 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// block_gzip_unittest.cc: Unit tests for BlockGzipWriter and GunzipData.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <string.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/block_gzip.h"
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+namespace {
+
+using google_breakpad::BlockGzipReader;
+using google_breakpad::BlockGzipWriter;
+using google_breakpad::GunzipData;
+using google_breakpad::IsGzipData;
+using std::string;
+
+#ifdef HAVE_LIBZ
+// Return symbol-file-like text of about SIZE bytes.
+string SampleText(size_t size) {
+  std::ostringstream text;
+  for (int line = 0; text.tellp() < static_cast<std::streamoff>(size);
+       ++line) {
+    text << std::hex << line * 0x10 << " 10 " << std::dec << line % 977
+         << " " << line % 13 << "\n";
+  }
+  return text.str();
+}
+
+// Compress TEXT with BlockGzipWriter.
+string Compress(const string& text, int thread_count, size_t block_size) {
+  std::ostringstream compressed;
+  BlockGzipWriter writer(&compressed, thread_count, block_size);
+  std::ostream stream(&writer);
+  stream << text;
+  EXPECT_TRUE(writer.Finish());
+  return compressed.str();
+}
+
+// Decompress DATA with GunzipData, storing the result in *TEXT.
+bool Decompress(const string& data, int thread_count, string* text) {
+  char* output;
+  size_t output_size;
+  if (!GunzipData(data.data(), data.size(), thread_count,
+                  &output, &output_size)) {
+    return false;
+  }
+  EXPECT_EQ('\0', output[output_size - 1]);
+  text->assign(output, output_size - 1);
+  delete[] output;
+  return true;
+}
+
+TEST(BlockGzip, RoundTrip) {
+  string text = SampleText(100000);
+  string compressed = Compress(text, 1, BlockGzipWriter::kDefaultBlockSize);
+  EXPECT_TRUE(IsGzipData(compressed.data(), compressed.size()));
+  EXPECT_LT(compressed.size(), text.size());
+  string decompressed;
+  ASSERT_TRUE(Decompress(compressed, 1, &decompressed));
+  EXPECT_EQ(text, decompressed);
+}
+
+TEST(BlockGzip, ManyBlocksOnManyThreads) {
+  string text = SampleText(100000);
+  // The output does not depend on the number of threads.
+  string compressed = Compress(text, 4, 4096);
+  EXPECT_EQ(Compress(text, 1, 4096), compressed);
+  for (int threads = 1; threads <= 8; threads *= 2) {
+    string decompressed;
+    ASSERT_TRUE(Decompress(compressed, threads, &decompressed));
+    EXPECT_EQ(text, decompressed);
+  }
+}
+
+TEST(BlockGzip, EmptyBlocksNotWritten) {
+  EXPECT_EQ("", Compress("", 2, 4096));
+  EXPECT_FALSE(IsGzipData("", 0));
+}
+
+TEST(BlockGzip, PlainGzip) {
+  string text = SampleText(50000);
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  ASSERT_EQ(Z_OK, deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                               16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY));
+  string compressed(deflateBound(&stream, text.size()) + 32, '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+  stream.avail_in = text.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+  stream.avail_out = compressed.size();
+  ASSERT_EQ(Z_STREAM_END, deflate(&stream, Z_FINISH));
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  ASSERT_TRUE(IsGzipData(compressed.data(), compressed.size()));
+
+  string decompressed;
+  ASSERT_TRUE(Decompress(compressed, 4, &decompressed));
+  EXPECT_EQ(text, decompressed);
+
+  // Concatenated members are read one after another, like gunzip does.
+  ASSERT_TRUE(Decompress(compressed + compressed, 4, &decompressed));
+  EXPECT_EQ(text + text, decompressed);
+}
+
+TEST(BlockGzip, CorruptData) {
+  string text = SampleText(20000);
+  string compressed = Compress(text, 2, 4096);
+  string decompressed;
+
+  string truncated = compressed.substr(0, compressed.size() - 1);
+  EXPECT_FALSE(Decompress(truncated, 2, &decompressed));
+
+  // Damage the compressed data of the first block, past its header.
+  string damaged = compressed;
+  damaged[30] ^= 0x55;
+  EXPECT_FALSE(Decompress(damaged, 2, &decompressed));
+
+  EXPECT_FALSE(Decompress(string("\x1f\x8b not gzip"), 1, &decompressed));
+}
+
+TEST(BlockGzip, ReaderSeeks) {
+  string text = SampleText(100000);
+  std::istringstream compressed(Compress(text, 2, 4096));
+  BlockGzipReader reader(&compressed);
+  ASSERT_TRUE(reader.Open());
+  std::istream stream(&reader);
+
+  // Read across block boundaries, backwards and forwards.
+  const size_t offsets[] = { 0, 4090, 50000, 4096, 99990, 1 };
+  for (size_t offset : offsets) {
+    char buffer[20];
+    size_t size = std::min(sizeof(buffer), text.size() - offset);
+    ASSERT_TRUE(stream.seekg(offset));
+    EXPECT_EQ(static_cast<std::streamoff>(offset), stream.tellg());
+    ASSERT_TRUE(stream.read(buffer, size));
+    EXPECT_EQ(text.substr(offset, size), string(buffer, size));
+    EXPECT_EQ(static_cast<std::streamoff>(offset + size), stream.tellg());
+  }
+
+  ASSERT_TRUE(stream.seekg(0, std::ios_base::end));
+  EXPECT_EQ(static_cast<std::streamoff>(text.size()), stream.tellg());
+  EXPECT_EQ(std::char_traits<char>::eof(), stream.get());
+
+  stream.clear();
+  ASSERT_TRUE(stream.seekg(0));
+  std::ostringstream all;
+  all << stream.rdbuf();
+  EXPECT_EQ(text, all.str());
+}
+
+TEST(BlockGzip, ReaderRejectsOtherData) {
+  std::istringstream plain("MDMP not compressed");
+  BlockGzipReader plain_reader(&plain);
+  EXPECT_FALSE(plain_reader.Open());
+
+  std::istringstream empty("");
+  BlockGzipReader empty_reader(&empty);
+  EXPECT_FALSE(empty_reader.Open());
+
+  string compressed = Compress(SampleText(20000), 1, 4096);
+  std::istringstream truncated(compressed.substr(0, compressed.size() - 1));
+  BlockGzipReader truncated_reader(&truncated);
+  EXPECT_FALSE(truncated_reader.Open());
+}
+#else  // HAVE_LIBZ
+TEST(BlockGzip, Unavailable) {
+  std::ostringstream compressed;
+  BlockGzipWriter writer(&compressed, 1);
+  std::ostream stream(&writer);
+  stream << "MODULE Linux x86_64 000000000000000000000000000000000 a.out\n";
+  EXPECT_FALSE(writer.Finish());
+
+  char* output;
+  size_t output_size;
+  EXPECT_FALSE(GunzipData("\x1f\x8b", 2, 1, &output, &output_size));
+}
+#endif  // HAVE_LIBZ
+
+}  // namespace
@@ -0,0 +1,253 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef COMMON_BREADCRUMB_BUFFER_H_
+#define COMMON_BREADCRUMB_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+
+#include "google_breakpad/common/minidump_format.h"
+
+namespace google_breakpad {
+
+// BreadcrumbBuffer keeps the most recent breadcrumbs that each thread
+// records, such as the last RPCs it sent, in a ring of MDRawBreadcrumbs of
+// its own, so that they can be written to a minidump's
+// MD_BREADCRUMB_STREAM.
+//
+// Recording is meant for hot paths: a thread only writes to its own ring,
+// so it takes no locks and, after its first breadcrumb, makes no system
+// calls. A thread's first breadcrumb claims a ring, which it keeps for the
+// life of the buffer; once every ring is claimed, other threads' breadcrumbs
+// are dropped.
+//
+// The rings are read without waiting, so a crash handler can read them.
+// The oldest breadcrumb in a full ring is left out, as the thread may have
+// been overwriting it; a thread that keeps recording while its ring is
+// read may overwrite more.
+class BreadcrumbBuffer {
+ public:
+  // The breadcrumbs that one thread holds, as ReadThread() finds them.
+  struct ThreadBreadcrumbs {
+    uint32_t thread_id;
+    // How many breadcrumbs the thread recorded, including those that were
+    // overwritten. The most recent has the sequence number
+    // |recorded_count| - 1.
+    uint64_t recorded_count;
+    // The sequence number of the oldest breadcrumb that is held.
+    uint64_t first;
+  };
+
+  // Makes room for |max_threads| threads to each hold at least their most
+  // recent |breadcrumbs_per_thread| breadcrumbs. Rings have a power of two
+  // slots, one of which is left out when read.
+  BreadcrumbBuffer(size_t max_threads, size_t breadcrumbs_per_thread)
+      : id_(NextId()),
+        max_threads_(max_threads),
+        slot_mask_(RoundUpToPowerOfTwo(breadcrumbs_per_thread + 1) - 1),
+        claimed_threads_(0),
+        rings_(new Ring[max_threads]),
+        slots_(new MDRawBreadcrumb[max_threads * (slot_mask_ + 1)]) {
+    for (size_t i = 0; i < max_threads_; ++i) {
+      rings_[i].next.store(0, std::memory_order_relaxed);
+      rings_[i].ready.store(false, std::memory_order_relaxed);
+      rings_[i].owner = NULL;
+      rings_[i].thread_id = 0;
+      rings_[i].slots = &slots_[i * (slot_mask_ + 1)];
+    }
+  }
+
+  ~BreadcrumbBuffer() {
+    delete[] rings_;
+    delete[] slots_;
+  }
+
+  BreadcrumbBuffer(const BreadcrumbBuffer&) = delete;
+  void operator=(const BreadcrumbBuffer&) = delete;
+
+  // Records a breadcrumb of |category| holding the first
+  // MD_BREADCRUMB_DATA_SIZE bytes of |data| for the calling thread. Returns
+  // false if the thread has no ring.
+  bool Record(uint32_t category, const void* data, size_t size) {
+    Ring* ring = ThreadRing();
+    if (!ring)
+      return false;
+
+    uint64_t sequence = ring->next.load(std::memory_order_relaxed);
+    MDRawBreadcrumb& breadcrumb = ring->slots[sequence & slot_mask_];
+    breadcrumb.timestamp_ns = Now();
+    breadcrumb.category = category;
+    if (size > MD_BREADCRUMB_DATA_SIZE)
+      size = MD_BREADCRUMB_DATA_SIZE;
+    breadcrumb.data_size = static_cast<uint32_t>(size);
+    memcpy(breadcrumb.data, data, size);
+    ring->next.store(sequence + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Records a breadcrumb holding the start of the string |str|.
+  bool Record(uint32_t category, const char* str) {
+    size_t size = 0;
+    while (size < MD_BREADCRUMB_DATA_SIZE && str[size])
+      ++size;
+    return Record(category, str, size);
+  }
+
+  size_t max_threads() const { return max_threads_; }
+
+  // Fills in |thread| for the |index|-th ring, and returns whether a thread
+  // has claimed it. Doesn't wait or allocate, so it may be called from a
+  // crash handler, or from a copy of the process made during a crash.
+  bool ReadThread(size_t index, ThreadBreadcrumbs* thread) const {
+    if (index >= max_threads_ ||
+        !rings_[index].ready.load(std::memory_order_acquire))
+      return false;
+
+    const Ring& ring = rings_[index];
+    thread->thread_id = ring.thread_id;
+    thread->recorded_count = ring.next.load(std::memory_order_acquire);
+    // The slot after the most recent breadcrumb is the next to be written.
+    thread->first = thread->recorded_count > slot_mask_ ?
+        thread->recorded_count - slot_mask_ : 0;
+    return true;
+  }
+
+  // Returns the breadcrumb with |sequence| number in the |index|-th ring,
+  // which should be one that ReadThread() reports as held.
+  const MDRawBreadcrumb& GetBreadcrumb(size_t index, uint64_t sequence) const {
+    return rings_[index].slots[sequence & slot_mask_];
+  }
+
+ private:
+  // The size of a cache line, which pads the Rings apart.
+  static const size_t kCacheLineSize = 64;
+
+  struct Ring {
+    // The sequence number of the next breadcrumb. Only written by the
+    // owning thread.
+    std::atomic<uint64_t> next;
+    // Set once |owner| and |thread_id| are.
+    std::atomic<bool> ready;
+    const void* owner;
+    uint32_t thread_id;
+    MDRawBreadcrumb* slots;
+    // Keeps each thread's |next| off the cache lines of the others.
+    char padding[kCacheLineSize];
+  };
+
+  // The calling thread's ring, as it last found it.
+  struct ThreadCache {
+    uint64_t buffer_id;
+    Ring* ring;
+  };
+
+  static uint64_t NextId() {
+    static std::atomic<uint64_t> last_id(0);
+    return ++last_id;
+  }
+
+  static size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t power = 1;
+    while (power < value)
+      power <<= 1;
+    return power;
+  }
+
+  static uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  static uint32_t CurrentThreadId() {
+#if defined(__linux__)
+    return static_cast<uint32_t>(syscall(__NR_gettid));
+#elif defined(__APPLE__)
+    return pthread_mach_thread_np(pthread_self());
+#else
+    return 0;
+#endif
+  }
+
+  // Returns the calling thread's ring, claiming one the first time, or NULL
+  // if all of them are claimed.
+  Ring* ThreadRing() {
+    static thread_local ThreadCache cache = {0, NULL};
+    if (cache.buffer_id != id_) {
+      cache.ring = FindOrClaimRing(&cache);
+      cache.buffer_id = id_;
+    }
+    return cache.ring;
+  }
+
+  // Finds the ring that the thread owning |owner| already claimed, if it
+  // recorded into another buffer since, or claims a new one.
+  Ring* FindOrClaimRing(const ThreadCache* owner) {
+    uint32_t thread_id = CurrentThreadId();
+    size_t claimed = claimed_threads_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < claimed && i < max_threads_; ++i) {
+      Ring& ring = rings_[i];
+      if (ring.ready.load(std::memory_order_acquire) &&
+          ring.owner == owner && ring.thread_id == thread_id)
+        return &ring;
+    }
+
+    size_t index = claimed_threads_.fetch_add(1, std::memory_order_acq_rel);
+    if (index >= max_threads_)
+      return NULL;
+    Ring& ring = rings_[index];
+    ring.owner = owner;
+    ring.thread_id = thread_id;
+    ring.ready.store(true, std::memory_order_release);
+    return &ring;
+  }
+
+  // Tells apart buffers that may be created at the same address.
+  const uint64_t id_;
+  const size_t max_threads_;
+  // One less than the number of slots in each ring.
+  const size_t slot_mask_;
+  std::atomic<size_t> claimed_threads_;
+  Ring* rings_;
+  MDRawBreadcrumb* slots_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_BREADCRUMB_BUFFER_H_
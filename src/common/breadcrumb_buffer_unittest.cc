@@ -0,0 +1,155 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/breadcrumb_buffer.h"
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+namespace {
+
+string BreadcrumbData(const MDRawBreadcrumb& breadcrumb) {
+  return string(reinterpret_cast<const char*>(breadcrumb.data),
+                breadcrumb.data_size);
+}
+
+}  // namespace
+
+TEST(BreadcrumbBufferTest, RecordAndRead) {
+  BreadcrumbBuffer buffer(4, 8);
+  BreadcrumbBuffer::ThreadBreadcrumbs thread;
+  EXPECT_FALSE(buffer.ReadThread(0, &thread));
+
+  ASSERT_TRUE(buffer.Record(1, "first"));
+  ASSERT_TRUE(buffer.Record(2, "second"));
+
+  EXPECT_FALSE(buffer.ReadThread(1, &thread));
+  ASSERT_TRUE(buffer.ReadThread(0, &thread));
+  EXPECT_EQ(2u, thread.recorded_count);
+  EXPECT_EQ(0u, thread.first);
+
+  const MDRawBreadcrumb& first = buffer.GetBreadcrumb(0, 0);
+  const MDRawBreadcrumb& second = buffer.GetBreadcrumb(0, 1);
+  EXPECT_EQ(1u, first.category);
+  EXPECT_EQ("first", BreadcrumbData(first));
+  EXPECT_EQ(2u, second.category);
+  EXPECT_EQ("second", BreadcrumbData(second));
+  EXPECT_LE(first.timestamp_ns, second.timestamp_ns);
+
+  // Data beyond what a breadcrumb holds is cut off.
+  string long_data(MD_BREADCRUMB_DATA_SIZE + 10, 'x');
+  ASSERT_TRUE(buffer.Record(3, long_data.data(), long_data.size()));
+  EXPECT_EQ(string(MD_BREADCRUMB_DATA_SIZE, 'x'),
+            BreadcrumbData(buffer.GetBreadcrumb(0, 2)));
+}
+
+TEST(BreadcrumbBufferTest, WrapAround) {
+  BreadcrumbBuffer buffer(1, 3);
+  for (int i = 0; i < 10; ++i) {
+    char data[16];
+    snprintf(data, sizeof(data), "%d", i);
+    ASSERT_TRUE(buffer.Record(0, data));
+  }
+
+  BreadcrumbBuffer::ThreadBreadcrumbs thread;
+  ASSERT_TRUE(buffer.ReadThread(0, &thread));
+  EXPECT_EQ(10u, thread.recorded_count);
+  // At least the three most recent are held, oldest first.
+  ASSERT_GE(thread.recorded_count - thread.first, 3u);
+  EXPECT_EQ("7", BreadcrumbData(buffer.GetBreadcrumb(0, 7)));
+  EXPECT_EQ("8", BreadcrumbData(buffer.GetBreadcrumb(0, 8)));
+  EXPECT_EQ("9", BreadcrumbData(buffer.GetBreadcrumb(0, 9)));
+  for (uint64_t i = thread.first; i < thread.recorded_count; ++i) {
+    char data[16];
+    snprintf(data, sizeof(data), "%d", static_cast<int>(i));
+    EXPECT_EQ(data, BreadcrumbData(buffer.GetBreadcrumb(0, i)));
+  }
+}
+
+TEST(BreadcrumbBufferTest, ThreadsHaveTheirOwnRings) {
+  const size_t kThreads = 4;
+  const int kBreadcrumbs = 1000;
+  BreadcrumbBuffer buffer(kThreads, 16);
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kThreads; ++t) {
+    threads.push_back(std::thread([&buffer, t]() {
+      for (int i = 0; i < kBreadcrumbs; ++i)
+        buffer.Record(static_cast<uint32_t>(t), &i, sizeof(i));
+    }));
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  // Once every ring is claimed, another thread's breadcrumbs are dropped.
+  EXPECT_FALSE(buffer.Record(0, "dropped"));
+
+  std::set<uint32_t> categories;
+  for (size_t index = 0; index < kThreads; ++index) {
+    BreadcrumbBuffer::ThreadBreadcrumbs thread;
+    ASSERT_TRUE(buffer.ReadThread(index, &thread));
+    EXPECT_EQ(static_cast<uint64_t>(kBreadcrumbs), thread.recorded_count);
+    uint32_t category = buffer.GetBreadcrumb(index, thread.first).category;
+    categories.insert(category);
+    for (uint64_t i = thread.first; i < thread.recorded_count; ++i) {
+      const MDRawBreadcrumb& breadcrumb = buffer.GetBreadcrumb(index, i);
+      EXPECT_EQ(category, breadcrumb.category);
+      int value;
+      ASSERT_EQ(sizeof(value), breadcrumb.data_size);
+      memcpy(&value, breadcrumb.data, sizeof(value));
+      EXPECT_EQ(static_cast<int>(i), value);
+    }
+  }
+  EXPECT_EQ(kThreads, categories.size());
+}
+
+TEST(BreadcrumbBufferTest, SwitchingBuffersKeepsRings) {
+  BreadcrumbBuffer first(2, 4);
+  BreadcrumbBuffer second(2, 4);
+  ASSERT_TRUE(first.Record(0, "a"));
+  ASSERT_TRUE(second.Record(0, "b"));
+  ASSERT_TRUE(first.Record(0, "c"));
+
+  BreadcrumbBuffer::ThreadBreadcrumbs thread;
+  ASSERT_TRUE(first.ReadThread(0, &thread));
+  EXPECT_EQ(2u, thread.recorded_count);
+  EXPECT_FALSE(first.ReadThread(1, &thread));
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,374 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef COMMON_CONCURRENT_STRING_DICTIONARY_H_
+#define COMMON_CONCURRENT_STRING_DICTIONARY_H_
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "common/simple_string_dictionary.h"
+
+namespace google_breakpad {
+
+// ConcurrentNonAllocatingMap is a map/dictionary collection like
+// NonAllocatingMap, with the same fixed storage and no dynamic allocations,
+// for annotations that many threads update at once while the process may
+// crash at any time.
+//
+// Keys are hashed into the entries, so setting or looking up a key usually
+// touches a single entry instead of searching all of them. Once a key is
+// set it keeps its entry for the life of the map, even when it is removed,
+// so that concurrent writers never see a key move. At most NumEntries
+// distinct keys can therefore ever be set; NumEntries must be a power of
+// two.
+//
+// Each entry's value is guarded by a sequence lock. Writers of different
+// keys don't wait for each other, and nobody waits for a reader. Readers
+// copy values out and retry if a writer changed one under them. ReadEntry(),
+// meant for crash handlers, stops retrying after a few attempts, so it
+// returns even if the crash interrupted a writer; the value may then be
+// torn. Values must not be set from a signal handler.
+template <size_t KeySize, size_t ValueSize, size_t NumEntries>
+class ConcurrentNonAllocatingMap {
+ public:
+  // Constant and publicly accessible versions of the template parameters.
+  static const size_t key_size = KeySize;
+  static const size_t value_size = ValueSize;
+  static const size_t num_entries = NumEntries;
+
+  static_assert(NumEntries > 0 && (NumEntries & (NumEntries - 1)) == 0,
+                "NumEntries must be a power of two");
+
+  // A copy of an entry, as NonAllocatingMap stores them.
+  typedef typename NonAllocatingMap<KeySize, ValueSize, NumEntries>::Entry
+      Entry;
+
+  // An Iterator copies out the entries of a ConcurrentNonAllocatingMap that
+  // have values, with ReadEntry().
+  class Iterator {
+   public:
+    explicit Iterator(const ConcurrentNonAllocatingMap& map)
+        : map_(map),
+          current_(0) {
+    }
+    Iterator(const Iterator&) = delete;
+    void operator=(const Iterator&) = delete;
+
+    // Copies the next entry with a value into |entry| and returns true, or
+    // returns false at the end of the collection.
+    bool Next(Entry* entry) {
+      while (current_ < map_.num_entries) {
+        if (map_.ReadEntry(current_++, entry))
+          return true;
+      }
+      return false;
+    }
+
+   private:
+    const ConcurrentNonAllocatingMap& map_;
+    size_t current_;
+  };
+
+  ConcurrentNonAllocatingMap() : slots_() {
+  }
+
+  ConcurrentNonAllocatingMap(const ConcurrentNonAllocatingMap&) = delete;
+  void operator=(const ConcurrentNonAllocatingMap&) = delete;
+
+  // Returns the number of keys that have values. The upper limit for this is
+  // NumEntries.
+  size_t GetCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < num_entries; ++i) {
+      if (slots_[i].state.load(std::memory_order_acquire) == kKeyed &&
+          slots_[i].active.load(std::memory_order_relaxed)) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  // Given |key|, copies its corresponding value into |value|, which must
+  // have room for |value_size| bytes, and returns true. |key| must not be
+  // NULL. If the key is not found, returns false.
+  bool GetValueForKey(const char* key, char* value) const {
+    assert(key);
+    if (!key)
+      return false;
+
+    size_t index = FindKey(key, Hash(key));
+    if (index == num_entries)
+      return false;
+
+    return ReadValue(slots_[index], value, 0);
+  }
+
+  // Stores |value| into |key|, replacing the existing value if |key| is
+  // already present. |key| must not be NULL. If |value| is NULL, the key is
+  // removed from the map. If there is no more space in the map, then the
+  // operation silently fails. Returns an index into the map that can be used
+  // to quickly set the value again, or |num_entries| on failure or when
+  // clearing a key with a null value.
+  size_t SetKeyValue(const char* key, const char* value) {
+    if (!value) {
+      RemoveKey(key);
+      return num_entries;
+    }
+
+    assert(key);
+    if (!key)
+      return num_entries;
+
+    // Key must not be an empty string.
+    assert(key[0] != '\0');
+    if (key[0] == '\0')
+      return num_entries;
+
+    size_t index = FindOrAddKey(key, Hash(key));
+    if (index == num_entries)
+      return num_entries;
+
+    WriteValue(&slots_[index], value);
+    return index;
+  }
+
+  // Sets a value for a key that has already been set with SetKeyValue(),
+  // using the index returned from that function. This skips the lookup, for
+  // values that are updated often.
+  void SetValueAtIndex(size_t index, const char* value) {
+    assert(index < num_entries);
+    if (index >= num_entries)
+      return;
+
+    Slot* slot = &slots_[index];
+    assert(slot->state.load(std::memory_order_relaxed) == kKeyed);
+    if (slot->state.load(std::memory_order_acquire) != kKeyed)
+      return;
+
+    WriteValue(slot, value);
+  }
+
+  // Given |key|, removes any associated value. |key| must not be NULL. If
+  // the key is not found, this is a noop. Unlike NonAllocatingMap, the index
+  // returned by SetKeyValue() stays valid.
+  bool RemoveKey(const char* key) {
+    assert(key);
+    if (!key)
+      return false;
+
+    return RemoveAtIndex(FindKey(key, Hash(key)));
+  }
+
+  // Removes the value using an index that was returned from SetKeyValue().
+  bool RemoveAtIndex(size_t index) {
+    if (index >= num_entries ||
+        slots_[index].state.load(std::memory_order_acquire) != kKeyed)
+      return false;
+
+    WriteValue(&slots_[index], NULL);
+    return true;
+  }
+
+  // Copies the entry at |index| into |entry|, and returns whether it has a
+  // value. Only waits for a writer for a few attempts, so it may be called
+  // from a crash handler, or from a copy of the process made during a crash.
+  bool ReadEntry(size_t index, Entry* entry) const {
+    if (index >= num_entries)
+      return false;
+
+    const Slot& slot = slots_[index];
+    if (slot.state.load(std::memory_order_acquire) != kKeyed)
+      return false;
+
+    memcpy(entry->key, slot.key, key_size);
+    return ReadValue(slot, entry->value, kCrashReadAttempts);
+  }
+
+  // Copies the keys that have values, and their values, into |map|.
+  void CopyTo(NonAllocatingMap<KeySize, ValueSize, NumEntries>* map) const {
+    Entry entry;
+    Iterator iter(*this);
+    while (iter.Next(&entry))
+      map->SetKeyValue(entry.key, entry.value);
+  }
+
+ private:
+  // The states of an entry's key. Once kKeyed, an entry stays so.
+  enum {
+    kFree = 0,
+    kClaimed,  // A writer is copying the key in.
+    kKeyed
+  };
+
+  // How many times ReadEntry() tries to copy a value that is being written.
+  static const int kCrashReadAttempts = 16;
+
+  struct Slot {
+    std::atomic<uint32_t> state;
+    // Even while the value is stable, odd while a writer changes it.
+    std::atomic<uint32_t> sequence;
+    // Whether the key has a value. Only set with |sequence| odd.
+    std::atomic<bool> active;
+    uint32_t hash;
+    char key[KeySize];
+    char value[ValueSize];
+  };
+
+  // Returns the FNV-1a hash of the part of |key| that fits in an entry.
+  static uint32_t Hash(const char* key) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < key_size - 1 && key[i]; ++i) {
+      hash ^= static_cast<uint8_t>(key[i]);
+      hash *= 16777619u;
+    }
+    return hash;
+  }
+
+  static bool KeyMatches(const Slot& slot, const char* key, uint32_t hash) {
+    return slot.hash == hash && strncmp(slot.key, key, key_size - 1) == 0;
+  }
+
+  // Copies |source| into |dest| of |size| bytes, truncating it.
+  static void CopyString(char* dest, const char* source, size_t size) {
+    size_t i = 0;
+    for (; i < size - 1 && source[i]; ++i)
+      dest[i] = source[i];
+    dest[i] = '\0';
+  }
+
+  // Returns the index of the entry holding |key|, or |num_entries| if there
+  // is none.
+  size_t FindKey(const char* key, uint32_t hash) const {
+    size_t index = hash & (num_entries - 1);
+    for (size_t probe = 0; probe < num_entries; ++probe) {
+      const Slot& slot = slots_[index];
+      uint32_t state = slot.state.load(std::memory_order_acquire);
+      if (state == kFree)
+        return num_entries;
+      // A key still being claimed has no value yet, so it can't be the one
+      // asked for.
+      if (state == kKeyed && KeyMatches(slot, key, hash))
+        return index;
+      index = (index + 1) & (num_entries - 1);
+    }
+    return num_entries;
+  }
+
+  // Returns the index of the entry holding |key|, claiming one for it if
+  // there is none, or |num_entries| if the map is full.
+  size_t FindOrAddKey(const char* key, uint32_t hash) {
+    size_t index = hash & (num_entries - 1);
+    for (size_t probe = 0; probe < num_entries; ++probe) {
+      Slot* slot = &slots_[index];
+      uint32_t state = slot->state.load(std::memory_order_acquire);
+      if (state == kFree &&
+          slot->state.compare_exchange_strong(state, kClaimed,
+                                              std::memory_order_acquire)) {
+        slot->hash = hash;
+        CopyString(slot->key, key, key_size);
+        slot->state.store(kKeyed, std::memory_order_release);
+        return index;
+      }
+      // Another writer may be claiming this entry, possibly for the same
+      // key; its key is only known once it is published.
+      while (state != kKeyed)
+        state = slot->state.load(std::memory_order_acquire);
+      if (KeyMatches(*slot, key, hash))
+        return index;
+      index = (index + 1) & (num_entries - 1);
+    }
+    return num_entries;
+  }
+
+  // Sets the value of |slot| to |value|, or clears it if |value| is NULL.
+  static void WriteValue(Slot* slot, const char* value) {
+    uint32_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    for (;;) {
+      if (!(sequence & 1) &&
+          slot->sequence.compare_exchange_weak(sequence, sequence + 1,
+                                               std::memory_order_relaxed)) {
+        break;
+      }
+      sequence = slot->sequence.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (value) {
+      CopyString(slot->value, value, value_size);
+      slot->active.store(true, std::memory_order_relaxed);
+    } else {
+      slot->value[0] = '\0';
+      slot->active.store(false, std::memory_order_relaxed);
+    }
+
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  // Copies the value of |slot| into |value| and returns whether it has one,
+  // trying until the copy is consistent, or at most |attempts| times if that
+  // is not 0.
+  static bool ReadValue(const Slot& slot, char* value, int attempts) {
+    bool active;
+    for (int attempt = 1;; ++attempt) {
+      uint32_t before = slot.sequence.load(std::memory_order_acquire);
+      memcpy(value, slot.value, value_size);
+      active = slot.active.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      uint32_t after = slot.sequence.load(std::memory_order_relaxed);
+      if ((before == after && !(before & 1)) || attempt == attempts)
+        break;
+    }
+    value[value_size - 1] = '\0';
+    if (!active)
+      value[0] = '\0';
+    return active;
+  }
+
+  Slot slots_[NumEntries];
+};
+
+template <size_t KeySize, size_t ValueSize, size_t NumEntries>
+const size_t
+    ConcurrentNonAllocatingMap<KeySize, ValueSize, NumEntries>::key_size;
+template <size_t KeySize, size_t ValueSize, size_t NumEntries>
+const size_t
+    ConcurrentNonAllocatingMap<KeySize, ValueSize, NumEntries>::value_size;
+template <size_t KeySize, size_t ValueSize, size_t NumEntries>
+const size_t
+    ConcurrentNonAllocatingMap<KeySize, ValueSize, NumEntries>::num_entries;
+
+// A size that suits most annotations, like SimpleStringDictionary.
+typedef ConcurrentNonAllocatingMap<256, 256, 64> ConcurrentStringDictionary;
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_CONCURRENT_STRING_DICTIONARY_H_
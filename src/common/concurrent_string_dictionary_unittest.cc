@@ -0,0 +1,181 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/concurrent_string_dictionary.h"
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+TEST(ConcurrentNonAllocatingMapTest, SetGetRemove) {
+  typedef ConcurrentNonAllocatingMap<5, 9, 4> TestMap;
+  TestMap map;
+  char value[TestMap::value_size];
+
+  EXPECT_EQ(0u, map.GetCount());
+  EXPECT_FALSE(map.GetValueForKey("key1", value));
+
+  size_t index = map.SetKeyValue("key1", "value1");
+  ASSERT_LT(index, TestMap::num_entries);
+  ASSERT_TRUE(map.GetValueForKey("key1", value));
+  EXPECT_STREQ("value1", value);
+  EXPECT_EQ(1u, map.GetCount());
+
+  // Setting the key again uses the same entry.
+  EXPECT_EQ(index, map.SetKeyValue("key1", "value2"));
+  ASSERT_TRUE(map.GetValueForKey("key1", value));
+  EXPECT_STREQ("value2", value);
+
+  map.SetValueAtIndex(index, "value3");
+  ASSERT_TRUE(map.GetValueForKey("key1", value));
+  EXPECT_STREQ("value3", value);
+
+  // Keys and values are truncated to fit.
+  map.SetKeyValue("key2345", "0123456789");
+  ASSERT_TRUE(map.GetValueForKey("key2", value));
+  EXPECT_STREQ("01234567", value);
+  ASSERT_TRUE(map.GetValueForKey("key2999", value));
+  EXPECT_EQ(2u, map.GetCount());
+
+  // A removed key keeps its entry, and its index stays valid.
+  EXPECT_TRUE(map.RemoveKey("key1"));
+  EXPECT_FALSE(map.GetValueForKey("key1", value));
+  EXPECT_EQ(1u, map.GetCount());
+  map.SetValueAtIndex(index, "value4");
+  ASSERT_TRUE(map.GetValueForKey("key1", value));
+  EXPECT_STREQ("value4", value);
+  EXPECT_EQ(TestMap::num_entries, map.SetKeyValue("key1", NULL));
+  EXPECT_FALSE(map.GetValueForKey("key1", value));
+  EXPECT_FALSE(map.RemoveKey("key9"));
+}
+
+TEST(ConcurrentNonAllocatingMapTest, Full) {
+  typedef ConcurrentNonAllocatingMap<8, 8, 4> TestMap;
+  TestMap map;
+  char key[TestMap::key_size];
+  char value[TestMap::value_size];
+
+  for (size_t i = 0; i < TestMap::num_entries; ++i) {
+    snprintf(key, sizeof(key), "key%zu", i);
+    EXPECT_LT(map.SetKeyValue(key, "value"), TestMap::num_entries);
+  }
+  EXPECT_EQ(TestMap::num_entries, map.SetKeyValue("more", "value"));
+  EXPECT_FALSE(map.GetValueForKey("more", value));
+
+  // Every key can still be found, whatever entry it hashed to.
+  for (size_t i = 0; i < TestMap::num_entries; ++i) {
+    snprintf(key, sizeof(key), "key%zu", i);
+    EXPECT_TRUE(map.GetValueForKey(key, value)) << key;
+  }
+}
+
+TEST(ConcurrentNonAllocatingMapTest, IterateAndCopy) {
+  ConcurrentStringDictionary map;
+  map.SetKeyValue("one", "1");
+  map.SetKeyValue("two", "2");
+  map.SetKeyValue("three", "3");
+  map.RemoveKey("two");
+
+  ConcurrentStringDictionary::Entry entry;
+  ConcurrentStringDictionary::Iterator iter(map);
+  size_t count = 0;
+  while (iter.Next(&entry)) {
+    EXPECT_TRUE(strcmp(entry.key, "one") == 0 ||
+                strcmp(entry.key, "three") == 0) << entry.key;
+    ++count;
+  }
+  EXPECT_EQ(2u, count);
+
+  SimpleStringDictionary copy;
+  map.CopyTo(&copy);
+  EXPECT_EQ(2u, copy.GetCount());
+  EXPECT_STREQ("1", copy.GetValueForKey("one"));
+  EXPECT_STREQ("3", copy.GetValueForKey("three"));
+  EXPECT_FALSE(copy.GetValueForKey("two"));
+}
+
+TEST(ConcurrentNonAllocatingMapTest, ConcurrentWriters) {
+  typedef ConcurrentNonAllocatingMap<16, 32, 16> TestMap;
+  TestMap map;
+  const int kThreads = 4;
+  const int kRounds = 2000;
+
+  // Every thread sets the same shared keys, and one of its own, to values
+  // whose two halves must match; a reader checks it never sees them torn.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&map, t]() {
+      char own_key[16];
+      snprintf(own_key, sizeof(own_key), "thread%d", t);
+      size_t own_index = map.SetKeyValue(own_key, "start");
+      char value[32];
+      for (int i = 0; i < kRounds; ++i) {
+        snprintf(value, sizeof(value), "%d-%d:%d-%d", t, i, t, i);
+        map.SetKeyValue("shared", value);
+        map.SetKeyValue(i % 2 ? "odd" : "even", value);
+        map.SetValueAtIndex(own_index, value);
+      }
+    });
+  }
+  threads.emplace_back([&map]() {
+    char value[32];
+    for (int i = 0; i < kRounds; ++i) {
+      if (!map.GetValueForKey("shared", value))
+        continue;
+      const char* colon = strchr(value, ':');
+      ASSERT_TRUE(colon) << value;
+      EXPECT_EQ(string(value, colon - value), string(colon + 1)) << value;
+    }
+  });
+  for (std::thread& thread : threads)
+    thread.join();
+
+  // Each key got exactly one entry.
+  EXPECT_EQ(static_cast<size_t>(kThreads) + 3, map.GetCount());
+  char value[32];
+  for (int t = 0; t < kThreads; ++t) {
+    char own_key[16];
+    snprintf(own_key, sizeof(own_key), "thread%d", t);
+    ASSERT_TRUE(map.GetValueForKey(own_key, value));
+    char expected[32];
+    snprintf(expected, sizeof(expected), "%d-%d:%d-%d",
+             t, kRounds - 1, t, kRounds - 1);
+    EXPECT_STREQ(expected, value);
+  }
+}
+
+}  // namespace google_breakpad
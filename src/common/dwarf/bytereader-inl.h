@@ -33,6 +33,11 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <string.h>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 
 namespace google_breakpad {
 
@@ -97,6 +102,17 @@ inline uint64_t ByteReader::ReadEightBytes(const uint8_t* buffer) const {
 
 inline uint64_t ByteReader::ReadUnsignedLEB128(const uint8_t* buffer,
                                              size_t* len) const {
+  // Most numbers are attribute and form codes, small sizes and line
+  // advances, which take one or two bytes.
+  if (!(buffer[0] & 0x80)) {
+    *len = 1;
+    return buffer[0];
+  }
+  if (!(buffer[1] & 0x80)) {
+    *len = 2;
+    return (buffer[0] & 0x7f) | static_cast<uint64_t>(buffer[1]) << 7;
+  }
+
   uint64_t result = 0;
   size_t num_read = 0;
   unsigned int shift = 0;
@@ -122,6 +138,19 @@ inline uint64_t ByteReader::ReadUnsignedLEB128(const uint8_t* buffer,
 
 inline int64_t ByteReader::ReadSignedLEB128(const uint8_t* buffer,
                                           size_t* len) const {
+  if (!(buffer[0] & 0x80)) {
+    *len = 1;
+    // Sign-extend from bit 6.
+    return static_cast<int64_t>(buffer[0] ^ 0x40) - 0x40;
+  }
+  if (!(buffer[1] & 0x80)) {
+    *len = 2;
+    // Sign-extend from bit 13.
+    return static_cast<int64_t>(((buffer[0] & 0x7f) |
+                                 static_cast<uint32_t>(buffer[1]) << 7) ^
+                                0x2000) - 0x2000;
+  }
+
   int64_t result = 0;
   unsigned int shift = 0;
   size_t num_read = 0;
@@ -140,6 +169,61 @@ inline int64_t ByteReader::ReadSignedLEB128(const uint8_t* buffer,
   return result;
 }
 
+inline const uint8_t* ByteReader::SkipLEB128(const uint8_t* buffer) const {
+  while (*buffer++ & 0x80) {}
+  return buffer;
+}
+
+// Decode unsigned LEB128 numbers from whole little-endian words.  The
+// bytes of a number are those up to the first one whose high bit is
+// clear; their low seven bits are then gathered together, with PEXT
+// where the compiler targets BMI2 and with three shift-and-mask steps
+// otherwise.
+
+inline const uint8_t* ByteReader::ReadUnsignedLEB128s(const uint8_t* buffer,
+                                                      const uint8_t* end,
+                                                      uint64_t* values,
+                                                      size_t count) const {
+  const uint64_t kHighBits = 0x8080808080808080ULL;
+  for (size_t i = 0; i < count; i++) {
+    if (end - buffer >= 8) {
+      uint64_t word;
+      memcpy(&word, buffer, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      word = __builtin_bswap64(word);
+#endif
+      const uint64_t stops = ~word & kHighBits;
+      if (stops) {
+        // The lowest stop bit is bit 8 * n - 1 for an n-byte number.
+        const int bits = __builtin_ctzll(stops) + 1;
+        const uint64_t number_bytes =
+            bits == 64 ? word : word & ((1ULL << bits) - 1);
+#if defined(__BMI2__)
+        values[i] = _pext_u64(number_bytes, ~kHighBits);
+#else
+        uint64_t x = number_bytes & ~kHighBits;
+        x = (x & 0x007f007f007f007fULL) | ((x & 0x7f007f007f007f00ULL) >> 1);
+        x = (x & 0x00003fff00003fffULL) | ((x & 0x3fff00003fff0000ULL) >> 2);
+        x = (x & 0x000000000fffffffULL) | ((x & 0x0fffffff00000000ULL) >> 4);
+        values[i] = x;
+#endif
+        buffer += bits / 8;
+        continue;
+      }
+    }
+    // Numbers of more than eight bytes, and those near END.
+    const uint8_t* last = buffer;
+    while (last < end && (*last & 0x80))
+      last++;
+    if (last >= end)
+      return NULL;
+    size_t len;
+    values[i] = ReadUnsignedLEB128(buffer, &len);
+    buffer += len;
+  }
+  return buffer;
+}
+
 inline uint64_t ByteReader::ReadOffset(const uint8_t* buffer) const {
   assert(this->offset_reader_);
   return (this->*offset_reader_)(buffer);
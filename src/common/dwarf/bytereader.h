@@ -122,6 +122,21 @@ class ByteReader {
   // bytes with the high bit on all but the last.
   int64_t ReadSignedLEB128(const uint8_t* buffer, size_t* len) const;
 
+  // Return a pointer just past the signed or unsigned LEB128 number at
+  // BUFFER, without decoding it.
+  const uint8_t* SkipLEB128(const uint8_t* buffer) const;
+
+  // Read COUNT consecutive unsigned LEB128 numbers from BUFFER into
+  // VALUES, and return a pointer just past the last of them. END is the
+  // end of the data BUFFER points into; if the numbers would run past it,
+  // return NULL. Where eight bytes are left before END, numbers of up to
+  // eight bytes are decoded a word at a time rather than a byte at a
+  // time.
+  const uint8_t* ReadUnsignedLEB128s(const uint8_t* buffer,
+                                     const uint8_t* end,
+                                     uint64_t* values,
+                                     size_t count) const;
+
   // Indicate that addresses on this architecture are SIZE bytes long. SIZE
   // must be either 4 or 8. (DWARF allows addresses to be any number of
   // bytes in length from 1 to 255, but we only support 32- and 64-bit
@@ -91,6 +91,64 @@ TEST_F(Reader, SimpleConstructor) {
   EXPECT_EQ(0xfec319c9, reader.ReadAddress(data + 35));
 }
 
+// Values of every length, for the one- and two-byte fast paths and the
+// general loop.
+TEST_F(Reader, LEB128Lengths) {
+  ByteReader reader(ENDIANNESS_LITTLE);
+  const uint64_t unsigned_values[] = {
+    0, 1, 0x3f, 0x40, 0x7f, 0x80, 0x2000, 0x3fff, 0x4000, 0x1fffff,
+    0x200000, 0xffffffffULL, 0x7fffffffffffffffULL, 0xffffffffffffffffULL
+  };
+  const int64_t signed_values[] = {
+    0, 1, -1, 0x3f, -0x40, 0x40, -0x41, 0x1fff, -0x2000, 0x2000, -0x2001,
+    0xfffff, -0x100000, 0x7fffffffffffffffLL, -0x7fffffffffffffffLL - 1
+  };
+  for (size_t i = 0; i < sizeof(unsigned_values) / sizeof(uint64_t); i++) {
+    CFISection section(kLittleEndian, 4);
+    section.ULEB128(unsigned_values[i]).D8(0xff);
+    ASSERT_TRUE(section.GetContents(&contents));
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(contents.data());
+    size_t leb128_size;
+    EXPECT_EQ(unsigned_values[i],
+              reader.ReadUnsignedLEB128(data, &leb128_size));
+    EXPECT_EQ(contents.size() - 1, leb128_size);
+    EXPECT_EQ(data + leb128_size, reader.SkipLEB128(data));
+  }
+  for (size_t i = 0; i < sizeof(signed_values) / sizeof(int64_t); i++) {
+    CFISection section(kLittleEndian, 4);
+    section.LEB128(signed_values[i]).D8(0xff);
+    ASSERT_TRUE(section.GetContents(&contents));
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(contents.data());
+    size_t leb128_size;
+    EXPECT_EQ(signed_values[i], reader.ReadSignedLEB128(data, &leb128_size));
+    EXPECT_EQ(contents.size() - 1, leb128_size);
+    EXPECT_EQ(data + leb128_size, reader.SkipLEB128(data));
+  }
+}
+
+TEST_F(Reader, UnsignedLEB128s) {
+  ByteReader reader(ENDIANNESS_BIG);
+  const uint64_t values[] = {
+    0x7f, 0x80, 0x3fff, 0x4000, 0x0fffffffffffffULL, 0x100000000000000ULL,
+    0xffffffffffffffffULL, 2, 0xa0927048ba8121afULL, 0, 0x1234567
+  };
+  const size_t count = sizeof(values) / sizeof(values[0]);
+  CFISection section(kLittleEndian, 4);
+  for (size_t i = 0; i < count; i++)
+    section.ULEB128(values[i]);
+  ASSERT_TRUE(section.GetContents(&contents));
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(contents.data());
+  const uint8_t* end = data + contents.size();
+
+  uint64_t read[count];
+  EXPECT_EQ(end, reader.ReadUnsignedLEB128s(data, end, read, count));
+  for (size_t i = 0; i < count; i++)
+    EXPECT_EQ(values[i], read[i]) << i;
+
+  // A number that runs past END.
+  EXPECT_EQ(NULL, reader.ReadUnsignedLEB128s(data, end - 1, read, count));
+}
+
 TEST_F(Reader, ValidEncodings) {
   ByteReader reader(ENDIANNESS_LITTLE);
   EXPECT_TRUE(reader.ValidEncoding(
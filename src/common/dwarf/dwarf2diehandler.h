@@ -325,6 +325,9 @@ class DIEDispatcher: public Dwarf2Handler {
                                  enum DwarfForm form,
                                  uint64_t signature);
   void EndDIE(uint64_t offset);
+  // A DIE for which StartDIE returns false has no handler, and neither do
+  // its descendants.
+  bool SkipsSubtrees() { return true; }
 
  private:
 
@@ -279,6 +279,8 @@ enum DwarfAttribute {
   DW_AT_addr_base = 0x73,
   DW_AT_rnglists_base = 0x74,
   DW_AT_dwo_name = 0x76,
+  DW_AT_macros = 0x79,
+  DW_AT_loclists_base = 0x8c,
   // SGI/MIPS extensions.
   DW_AT_MIPS_fde = 0x2001,
   DW_AT_MIPS_loop_begin = 0x2002,
@@ -314,6 +316,7 @@ enum DwarfAttribute {
   DW_AT_body_begin = 0x2105,
   DW_AT_body_end   = 0x2106,
   DW_AT_GNU_vector = 0x2107,
+  DW_AT_GNU_macros = 0x2119,
   // Extensions for Fission.  See http://gcc.gnu.org/wiki/DebugFission.
   DW_AT_GNU_dwo_name = 0x2130,
   DW_AT_GNU_dwo_id = 0x2131,
@@ -321,6 +324,7 @@ enum DwarfAttribute {
   DW_AT_GNU_addr_base = 0x2133,
   DW_AT_GNU_pubnames = 0x2134,
   DW_AT_GNU_pubtypes = 0x2135,
+  DW_AT_GNU_locviews = 0x2137,
   // VMS extensions.
   DW_AT_VMS_rtnbeg_pd_address = 0x2201,
   // UPC extension.
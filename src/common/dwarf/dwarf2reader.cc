@@ -75,6 +75,7 @@ CompilationUnit::CompilationUnit(const string& path,
                                  ByteReader* reader, Dwarf2Handler* handler)
     : path_(path), offset_from_section_start_(offset), reader_(reader),
       sections_(sections), handler_(handler), abbrevs_(),
+      abbrev_cache_(NULL),
       string_buffer_(NULL), string_buffer_length_(0),
       line_string_buffer_(NULL), line_string_buffer_length_(0),
       str_offsets_buffer_(NULL), str_offsets_buffer_length_(0),
@@ -82,7 +83,7 @@ CompilationUnit::CompilationUnit(const string& path,
       is_split_dwarf_(false), is_type_unit_(false), dwo_id_(0), dwo_name_(),
       skeleton_dwo_id_(0), addr_base_(0),
       str_offsets_base_(0), have_checked_for_dwp_(false),
-      should_process_split_dwarf_(false), low_pc_(0),
+      split_dwarf_cache_(NULL), should_process_split_dwarf_(false), low_pc_(0),
       has_source_line_info_(false), source_line_offset_(0) {}
 
 // Initialize a compilation unit from a .dwo or .dwp file.
@@ -116,19 +117,36 @@ void CompilationUnit::ReadAbbrevs() {
       GetSectionByName(sections_, ".debug_abbrev");
   assert(iter != sections_.end());
 
-  abbrevs_ = new std::vector<Abbrev>;
-  abbrevs_->resize(1);
-
   // The only way to check whether we are reading over the end of the
   // buffer would be to first compute the size of the leb128 data by
   // reading it, then go back and read it again.
   const uint8_t* abbrev_start = iter->second.first +
                                       header_.abbrev_offset;
-  const uint8_t* abbrevptr = abbrev_start;
-#ifndef NDEBUG
   const uint64_t abbrev_length = iter->second.second - header_.abbrev_offset;
-#endif
 
+  if (!abbrev_cache_) {
+    owned_abbrevs_.reset(new std::vector<Abbrev>);
+    ParseAbbrevs(abbrev_start, abbrev_length, owned_abbrevs_.get());
+    abbrevs_ = owned_abbrevs_.get();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(abbrev_cache_->mutex_);
+  std::unique_ptr<const std::vector<Abbrev>>& table =
+      abbrev_cache_->tables_[header_.abbrev_offset];
+  if (!table) {
+    std::vector<Abbrev>* abbrevs = new std::vector<Abbrev>;
+    table.reset(abbrevs);
+    ParseAbbrevs(abbrev_start, abbrev_length, abbrevs);
+  }
+  abbrevs_ = table.get();
+}
+
+void CompilationUnit::ParseAbbrevs(const uint8_t* abbrev_start,
+                                   uint64_t abbrev_length,
+                                   std::vector<Abbrev>* abbrevs) {
+  abbrevs->resize(1);
+  const uint8_t* abbrevptr = abbrev_start;
   uint64_t highest_number = 0;
 
   while (1) {
@@ -153,13 +171,21 @@ void CompilationUnit::ReadAbbrevs() {
 
     assert(abbrevptr < abbrev_start + abbrev_length);
 
+    abbrev.has_fixed_size = true;
+    abbrev.fixed_size = 0;
+    abbrev.address_count = 0;
+    abbrev.offset_count = 0;
+    abbrev.ref_addr_count = 0;
+    abbrev.has_sibling = false;
     while (1) {
-      const uint64_t nametemp = reader_->ReadUnsignedLEB128(abbrevptr, &len);
-      abbrevptr += len;
-
-      assert(abbrevptr < abbrev_start + abbrev_length);
-      const uint64_t formtemp = reader_->ReadUnsignedLEB128(abbrevptr, &len);
-      abbrevptr += len;
+      // An attribute code and a form code.
+      uint64_t codes[2];
+      abbrevptr = reader_->ReadUnsignedLEB128s(
+          abbrevptr, abbrev_start + abbrev_length, codes, 2);
+      if (!abbrevptr)
+        break;
+      const uint64_t nametemp = codes[0];
+      const uint64_t formtemp = codes[1];
       if (nametemp == 0 && formtemp == 0)
         break;
 
@@ -172,23 +198,110 @@ void CompilationUnit::ReadAbbrevs() {
                            static_cast<enum DwarfForm>(formtemp),
                            value);
       abbrev.attributes.push_back(abbrev_attr);
+      AddFormSize(abbrev_attr.form_, &abbrev);
+      if (abbrev_attr.attr_ == DW_AT_sibling) {
+        switch (abbrev_attr.form_) {
+          case DW_FORM_ref1:
+          case DW_FORM_ref2:
+          case DW_FORM_ref4:
+          case DW_FORM_ref8:
+          case DW_FORM_ref_udata:
+            abbrev.has_sibling = true;
+            break;
+          default:
+            break;
+        }
+      }
+    }
+    abbrevs->push_back(abbrev);
+    if (!abbrevptr) {
+      // The table runs off the end of the section.
+      break;
     }
-    abbrevs_->push_back(abbrev);
   }
 
   // Account of cases where entries are out of order.
-  std::sort(abbrevs_->begin(), abbrevs_->end(),
+  std::sort(abbrevs->begin(), abbrevs->end(),
     [](const CompilationUnit::Abbrev& lhs, const CompilationUnit::Abbrev& rhs) {
       return lhs.number < rhs.number;
   });
 
   // Ensure that there are no missing sections.
-  assert(abbrevs_->size() == highest_number + 1);
+  assert(abbrevs->size() == highest_number + 1);
+}
+
+void CompilationUnit::AddFormSize(enum DwarfForm form, Abbrev* abbrev) {
+  switch (form) {
+    case DW_FORM_flag_present:
+    case DW_FORM_implicit_const:
+      return;
+    case DW_FORM_addrx1:
+    case DW_FORM_data1:
+    case DW_FORM_flag:
+    case DW_FORM_ref1:
+    case DW_FORM_strx1:
+      abbrev->fixed_size += 1;
+      return;
+    case DW_FORM_addrx2:
+    case DW_FORM_ref2:
+    case DW_FORM_data2:
+    case DW_FORM_strx2:
+      abbrev->fixed_size += 2;
+      return;
+    case DW_FORM_addrx3:
+    case DW_FORM_strx3:
+      abbrev->fixed_size += 3;
+      return;
+    case DW_FORM_addrx4:
+    case DW_FORM_ref4:
+    case DW_FORM_data4:
+    case DW_FORM_strx4:
+    case DW_FORM_ref_sup4:
+      abbrev->fixed_size += 4;
+      return;
+    case DW_FORM_ref8:
+    case DW_FORM_data8:
+    case DW_FORM_ref_sig8:
+    case DW_FORM_ref_sup8:
+      abbrev->fixed_size += 8;
+      return;
+    case DW_FORM_data16:
+      abbrev->fixed_size += 16;
+      return;
+    case DW_FORM_addr:
+      abbrev->address_count++;
+      return;
+    case DW_FORM_ref_addr:
+      abbrev->ref_addr_count++;
+      return;
+    case DW_FORM_strp:
+    case DW_FORM_line_strp:
+    case DW_FORM_strp_sup:
+    case DW_FORM_sec_offset:
+      abbrev->offset_count++;
+      return;
+    default:
+      // Strings, LEB128 numbers, blocks and indirect forms vary in size,
+      // and SkipAttribute reports the forms it doesn't know.
+      abbrev->has_fixed_size = false;
+      return;
+  }
 }
 
 // Skips a single DIE's attributes.
 const uint8_t* CompilationUnit::SkipDIE(const uint8_t* start,
                                         const Abbrev& abbrev) {
+  if (abbrev.has_fixed_size) {
+    // DWARF2 and 3/4 differ on whether ref_addr is address size or
+    // offset size; see SkipAttribute.
+    const uint64_t address_count = header_.version == 2 ?
+        abbrev.address_count + abbrev.ref_addr_count : abbrev.address_count;
+    const uint64_t offset_count = header_.version == 2 ?
+        abbrev.offset_count : abbrev.offset_count + abbrev.ref_addr_count;
+    return start + abbrev.fixed_size +
+        address_count * reader_->AddressSize() +
+        offset_count * reader_->OffsetSize();
+  }
   for (AttributeList::const_iterator i = abbrev.attributes.begin();
        i != abbrev.attributes.end();
        i++)  {
@@ -197,6 +310,92 @@ const uint8_t* CompilationUnit::SkipDIE(const uint8_t* start,
   return start;
 }
 
+// Skips a DIE and its descendants.
+const uint8_t* CompilationUnit::SkipSubtree(const uint8_t* start,
+                                            const Abbrev& abbrev,
+                                            const uint8_t* end) {
+  const Abbrev* current = &abbrev;
+  uint64_t depth = 0;
+  while (1) {
+    // Skip CURRENT's attributes, and its children too if it says where
+    // its next sibling starts.
+    const uint8_t* sibling = NULL;
+    if (current->has_children && current->has_sibling)
+      sibling = FindSibling(start, *current, end);
+    if (sibling) {
+      start = sibling;
+    } else {
+      start = SkipDIE(start, *current);
+      if (!start)
+        return NULL;
+      if (current->has_children)
+        depth++;
+    }
+
+    // Read the next DIE's abbreviation code, ending any lists of children
+    // that end here.
+    uint64_t abbrev_num = 0;
+    while (abbrev_num == 0) {
+      if (depth == 0)
+        return start;
+      if (start >= end)
+        return NULL;
+      size_t len;
+      abbrev_num = reader_->ReadUnsignedLEB128(start, &len);
+      start += len;
+      if (abbrev_num == 0)
+        depth--;
+    }
+    if (abbrev_num >= abbrevs_->size())
+      return NULL;
+    current = &(*abbrevs_)[static_cast<size_t>(abbrev_num)];
+  }
+}
+
+// Finds a DIE's next sibling from its DW_AT_sibling attribute.
+const uint8_t* CompilationUnit::FindSibling(const uint8_t* start,
+                                            const Abbrev& abbrev,
+                                            const uint8_t* end) {
+  for (AttributeList::const_iterator i = abbrev.attributes.begin();
+       i != abbrev.attributes.end();
+       i++)  {
+    if (i->attr_ != DW_AT_sibling) {
+      start = SkipAttribute(start, i->form_);
+      if (!start || start >= end)
+        return NULL;
+      continue;
+    }
+
+    // Sibling references are relative to the start of the unit.
+    uint64_t offset;
+    size_t len;
+    switch (i->form_) {
+      case DW_FORM_ref1:
+        offset = reader_->ReadOneByte(start);
+        break;
+      case DW_FORM_ref2:
+        offset = reader_->ReadTwoBytes(start);
+        break;
+      case DW_FORM_ref4:
+        offset = reader_->ReadFourBytes(start);
+        break;
+      case DW_FORM_ref8:
+        offset = reader_->ReadEightBytes(start);
+        break;
+      case DW_FORM_ref_udata:
+        offset = reader_->ReadUnsignedLEB128(start, &len);
+        break;
+      default:
+        return NULL;
+    }
+    if (offset <= static_cast<uint64_t>(start - buffer_) ||
+        offset > static_cast<uint64_t>(end - buffer_))
+      return NULL;
+    return buffer_ + offset;
+  }
+  return NULL;
+}
+
 // Skips a single attribute form's data.
 const uint8_t* CompilationUnit::SkipAttribute(const uint8_t* start,
                                               enum DwarfForm form) {
@@ -249,12 +448,10 @@ const uint8_t* CompilationUnit::SkipAttribute(const uint8_t* start,
     case DW_FORM_addrx:
     case DW_FORM_rnglistx:
     case DW_FORM_loclistx:
-      reader_->ReadUnsignedLEB128(start, &len);
-      return start + len;
+      return reader_->SkipLEB128(start);
 
     case DW_FORM_sdata:
-      reader_->ReadSignedLEB128(start, &len);
-      return start + len;
+      return reader_->SkipLEB128(start);
     case DW_FORM_addr:
       return start + reader_->AddressSize();
     case DW_FORM_ref_addr:
@@ -537,11 +734,9 @@ const uint8_t* CompilationUnit::ProcessOffsetBaseAttribute(
       return start + strlen(str) + 1;
     }
     case DW_FORM_udata:
-      reader_->ReadUnsignedLEB128(start, &len);
-      return start + len;
+      return reader_->SkipLEB128(start);
     case DW_FORM_sdata:
-      reader_->ReadSignedLEB128(start, &len);
-      return start + len;
+      return reader_->SkipLEB128(start);
     case DW_FORM_addr:
       reader_->ReadAddress(start);
       return start + reader_->AddressSize();
@@ -565,8 +760,7 @@ const uint8_t* CompilationUnit::ProcessOffsetBaseAttribute(
     case DW_FORM_ref8:
       return start + 8;
     case DW_FORM_ref_udata:
-      reader_->ReadUnsignedLEB128(start, &len);
-      return start + len;
+      return reader_->SkipLEB128(start);
     case DW_FORM_ref_addr:
       // DWARF2 and 3/4 differ on whether ref_addr is address size or
       // offset size.
@@ -615,12 +809,10 @@ const uint8_t* CompilationUnit::ProcessOffsetBaseAttribute(
     case DW_FORM_ref_sup8:
       return start + 8;
     case DW_FORM_loclistx:
-      reader_->ReadUnsignedLEB128(start, &len);
-      return start + len;
+      return reader_->SkipLEB128(start);
     case DW_FORM_strx:
     case DW_FORM_GNU_str_index: {
-      reader_->ReadUnsignedLEB128(start, &len);
-      return start + len;
+      return reader_->SkipLEB128(start);
     }
     case DW_FORM_strx1: {
       return start + 1;
@@ -637,8 +829,7 @@ const uint8_t* CompilationUnit::ProcessOffsetBaseAttribute(
 
     case DW_FORM_addrx:
     case DW_FORM_GNU_addr_index:
-      reader_->ReadUnsignedLEB128(start, &len);
-      return start + len;
+      return reader_->SkipLEB128(start);
     case DW_FORM_addrx1:
       return start + 1;
     case DW_FORM_addrx2:
@@ -648,8 +839,7 @@ const uint8_t* CompilationUnit::ProcessOffsetBaseAttribute(
     case DW_FORM_addrx4:
       return start + 4;
     case DW_FORM_rnglistx:
-      reader_->ReadUnsignedLEB128(start, &len);
-      return start + len;
+      return reader_->SkipLEB128(start);
   }
   fprintf(stderr,"Unhandled form type 0x%x\n", form);
   return nullptr;
@@ -941,9 +1131,11 @@ bool CompilationUnit::ProcessDIEs() {
   else
     lengthstart += 4;
 
+  const uint8_t* end = lengthstart + header_.length;
+  const bool skips_subtrees = handler_->SkipsSubtrees();
   std::stack<uint64_t> die_stack;
 
-  while (dieptr < (lengthstart + header_.length)) {
+  while (dieptr < end) {
     // We give the user the absolute offset from the beginning of
     // debug_info, since they need it to deal with ref_addr forms.
     uint64_t absolute_offset = (dieptr - buffer_) + offset_from_section_start_;
@@ -975,6 +1167,19 @@ bool CompilationUnit::ProcessDIEs() {
     const Abbrev& abbrev = abbrevs_->at(static_cast<size_t>(abbrev_num));
     const enum DwarfTag tag = abbrev.tag;
     if (!handler_->StartDIE(absolute_offset, tag)) {
+      if (skips_subtrees && abbrev.has_children) {
+        dieptr = SkipSubtree(dieptr, abbrev, end);
+        if (!dieptr) {
+          fprintf(stderr,
+                  "An error happens when skipping the children of the DIE at "
+                  "offset 0x%" PRIx64
+                  ". Stopped processing following DIEs in this CU.\n",
+                  absolute_offset);
+          return false;
+        }
+        handler_->EndDIE(absolute_offset);
+        continue;
+      }
       dieptr = SkipDIE(dieptr, abbrev);
       if (!dieptr) {
         fprintf(stderr,
@@ -1022,44 +1227,18 @@ bool CompilationUnit::ProcessSplitDwarf(std::string& split_file,
     return false;
   struct stat statbuf;
   bool found_in_dwp = false;
-  if (!have_checked_for_dwp_) {
-    // Look for a .dwp file in the same directory as the executable.
+  if (split_dwarf_cache_) {
+    std::lock_guard<std::mutex> lock(split_dwarf_cache_->mutex_);
+    std::unique_ptr<DwpFile>& dwp_file = split_dwarf_cache_->files_[path_];
+    if (!dwp_file)
+      dwp_file = OpenDwpFile();
+    found_in_dwp = ReadSplitDwarfFromDwp(*dwp_file, split_file, sections,
+                                         split_byte_reader, cu_offset);
+  } else if (!have_checked_for_dwp_) {
     have_checked_for_dwp_ = true;
-    string dwp_suffix(".dwp");
-    std::string dwp_path = path_ + dwp_suffix;
-    if (stat(dwp_path.c_str(), &statbuf) != 0) {
-      // Fall back to a split .debug file in the same directory.
-      string debug_suffix(".debug");
-      dwp_path = path_;
-      size_t found = path_.rfind(debug_suffix);
-      if (found != string::npos &&
-          found + debug_suffix.length() == path_.length())
-        dwp_path = dwp_path.replace(found, debug_suffix.length(), dwp_suffix);
-    }
-    if (stat(dwp_path.c_str(), &statbuf) == 0) {
-      split_elf_reader_ = std::make_unique<ElfReader>(dwp_path);
-      int width = GetElfWidth(*split_elf_reader_.get());
-      if (width != 0) {
-        split_byte_reader = ByteReader(reader_->GetEndianness());
-        split_byte_reader.SetAddressSize(width);
-        dwp_reader_ = std::make_unique<DwpReader>(split_byte_reader,
-                                                  split_elf_reader_.get());
-        dwp_reader_->Initialize();
-        // If we have a .dwp file, read the debug sections for the requested CU.
-        dwp_reader_->ReadDebugSectionsForCU(dwo_id_, &sections);
-        if (!sections.empty()) {
-          SectionMap::const_iterator cu_iter =
-              GetSectionByName(sections, ".debug_info_offset");
-          SectionMap::const_iterator debug_info_iter =
-              GetSectionByName(sections, ".debug_info");
-          assert(cu_iter != sections.end());
-          assert(debug_info_iter != sections.end());
-          cu_offset = cu_iter->second.first - debug_info_iter->second.first;
-          found_in_dwp = true;
-          split_file = dwp_path;
-        }
-      }
-    }
+    dwp_file_ = OpenDwpFile();
+    found_in_dwp = ReadSplitDwarfFromDwp(*dwp_file_, split_file, sections,
+                                         split_byte_reader, cu_offset);
   }
   if (!found_in_dwp) {
     // If no .dwp file, try to open the .dwo file.
@@ -1079,6 +1258,60 @@ bool CompilationUnit::ProcessSplitDwarf(std::string& split_file,
   return !split_file.empty();
 }
 
+std::unique_ptr<CompilationUnit::DwpFile> CompilationUnit::OpenDwpFile() {
+  std::unique_ptr<DwpFile> dwp_file(new DwpFile);
+  struct stat statbuf;
+  // Look for a .dwp file in the same directory as the executable.
+  string dwp_suffix(".dwp");
+  std::string dwp_path = path_ + dwp_suffix;
+  if (stat(dwp_path.c_str(), &statbuf) != 0) {
+    // Fall back to a split .debug file in the same directory.
+    string debug_suffix(".debug");
+    dwp_path = path_;
+    size_t found = path_.rfind(debug_suffix);
+    if (found != string::npos &&
+        found + debug_suffix.length() == path_.length())
+      dwp_path = dwp_path.replace(found, debug_suffix.length(), dwp_suffix);
+  }
+  if (stat(dwp_path.c_str(), &statbuf) != 0)
+    return dwp_file;
+  dwp_file->path = dwp_path;
+  dwp_file->elf_reader = std::make_unique<ElfReader>(dwp_path);
+  int width = GetElfWidth(*dwp_file->elf_reader.get());
+  if (width == 0)
+    return dwp_file;
+  dwp_file->byte_reader =
+      std::make_unique<ByteReader>(reader_->GetEndianness());
+  dwp_file->byte_reader->SetAddressSize(width);
+  dwp_file->dwp_reader = std::make_unique<DwpReader>(
+      *dwp_file->byte_reader, dwp_file->elf_reader.get());
+  dwp_file->dwp_reader->Initialize();
+  return dwp_file;
+}
+
+bool CompilationUnit::ReadSplitDwarfFromDwp(const DwpFile& dwp_file,
+                                            std::string& split_file,
+                                            SectionMap& sections,
+                                            ByteReader& split_byte_reader,
+                                            uint64_t& cu_offset) {
+  if (!dwp_file.dwp_reader)
+    return false;
+  split_byte_reader = *dwp_file.byte_reader;
+  // If we have a .dwp file, read the debug sections for the requested CU.
+  dwp_file.dwp_reader->ReadDebugSectionsForCU(dwo_id_, &sections);
+  if (sections.empty())
+    return false;
+  SectionMap::const_iterator cu_iter =
+      GetSectionByName(sections, ".debug_info_offset");
+  SectionMap::const_iterator debug_info_iter =
+      GetSectionByName(sections, ".debug_info");
+  assert(cu_iter != sections.end());
+  assert(debug_info_iter != sections.end());
+  cu_offset = cu_iter->second.first - debug_info_iter->second.first;
+  split_file = dwp_file.path;
+  return true;
+}
+
 void CompilationUnit::ReadDebugSectionsFromDwo(ElfReader* elf_reader,
                                                SectionMap* sections) {
   static const char* const section_names[] = {
@@ -1099,6 +1332,13 @@ void CompilationUnit::ReadDebugSectionsFromDwo(ElfReader* elf_reader,
           base_name, std::make_pair(
              reinterpret_cast<const uint8_t*>(section_data),
              section_size)));
+    // A .dwo file holds a single unit, at the start of .debug_info; Start
+    // looks for it where a .dwp file's unit would be.
+    if (section_data != NULL && base_name == ".debug_info")
+      sections->insert(std::make_pair(
+          ".debug_info_offset", std::make_pair(
+             reinterpret_cast<const uint8_t*>(section_data),
+             section_size)));
   }
 }
 
@@ -1133,6 +1373,8 @@ void DwpReader::Initialize() {
     shndx_pool_ = pindex_ + nslots_ * sizeof(uint32_t);
     if (shndx_pool_ >= cu_index_ + cu_index_size_) {
       version_ = 0;
+    } else {
+      ParseHashTable();
     }
   } else if (version_ == 2 || version_ == 5) {
     ncolumns_ = byte_reader_.ReadFourBytes(
@@ -1154,6 +1396,26 @@ void DwpReader::Initialize() {
         elf_reader_->GetSectionByName(".debug_rnglists.dwo", &rnglist_size_);
     if (size_table_ >= cu_index_ + cu_index_size_) {
       version_ = 0;
+    } else {
+      ParseHashTable();
+    }
+  }
+}
+
+void DwpReader::ParseHashTable() {
+  for (uint32_t slot = 0; slot < nslots_; ++slot) {
+    uint64_t signature = byte_reader_.ReadEightBytes(
+        reinterpret_cast<const uint8_t*>(phash_) + slot * sizeof(uint64_t));
+    if (version_ == 1) {
+      // Version 1 marks empty slots with a zero signature.
+      if (signature != 0)
+        units_.insert(std::make_pair(signature, slot));
+    } else {
+      // Later versions mark them with a zero row.
+      uint32_t index = byte_reader_.ReadFourBytes(
+          reinterpret_cast<const uint8_t*>(pindex_) + slot * sizeof(uint32_t));
+      if (index != 0)
+        units_.insert(std::make_pair(signature, index));
     }
   }
 }
@@ -1279,42 +1541,18 @@ void DwpReader::ReadDebugSectionsForCU(uint64_t dwo_id,
   }
 }
 
-int DwpReader::LookupCU(uint64_t dwo_id) {
-  uint32_t slot = static_cast<uint32_t>(dwo_id) & (nslots_ - 1);
-  uint64_t probe = byte_reader_.ReadEightBytes(
-      reinterpret_cast<const uint8_t*>(phash_) + slot * sizeof(uint64_t));
-  if (probe != 0 && probe != dwo_id) {
-    uint32_t secondary_hash =
-        (static_cast<uint32_t>(dwo_id >> 32) & (nslots_ - 1)) | 1;
-    do {
-      slot = (slot + secondary_hash) & (nslots_ - 1);
-      probe = byte_reader_.ReadEightBytes(
-          reinterpret_cast<const uint8_t*>(phash_) + slot * sizeof(uint64_t));
-    } while (probe != 0 && probe != dwo_id);
-  }
-  if (probe == 0)
+int DwpReader::LookupCU(uint64_t dwo_id) const {
+  auto unit = units_.find(dwo_id);
+  if (unit == units_.end())
     return -1;
-  return slot;
-}
-
-uint32_t DwpReader::LookupCUv2(uint64_t dwo_id) {
-  uint32_t slot = static_cast<uint32_t>(dwo_id) & (nslots_ - 1);
-  uint64_t probe = byte_reader_.ReadEightBytes(
-      reinterpret_cast<const uint8_t*>(phash_) + slot * sizeof(uint64_t));
-  uint32_t index = byte_reader_.ReadFourBytes(
-      reinterpret_cast<const uint8_t*>(pindex_) + slot * sizeof(uint32_t));
-  if (index != 0 && probe != dwo_id) {
-    uint32_t secondary_hash =
-        (static_cast<uint32_t>(dwo_id >> 32) & (nslots_ - 1)) | 1;
-    do {
-      slot = (slot + secondary_hash) & (nslots_ - 1);
-      probe = byte_reader_.ReadEightBytes(
-          reinterpret_cast<const uint8_t*>(phash_) + slot * sizeof(uint64_t));
-      index = byte_reader_.ReadFourBytes(
-          reinterpret_cast<const uint8_t*>(pindex_) + slot * sizeof(uint32_t));
-    } while (index != 0 && probe != dwo_id);
-  }
-  return index;
+  return unit->second;
+}
+
+uint32_t DwpReader::LookupCUv2(uint64_t dwo_id) const {
+  auto unit = units_.find(dwo_id);
+  if (unit == units_.end())
+    return 0;
+  return unit->second;
 }
 
 LineInfo::LineInfo(const uint8_t* buffer, uint64_t buffer_length,
@@ -1782,8 +2020,7 @@ bool LineInfo::ProcessOneOpcode(ByteReader* reader,
       // Ignore unknown opcode  silently
       if (header.std_opcode_lengths) {
         for (int i = 0; i < (*header.std_opcode_lengths)[opcode]; i++) {
-          reader->ReadUnsignedLEB128(start, &templen);
-          start += templen;
+          start = reader->SkipLEB128(start);
           oplen += templen;
         }
       }
@@ -1848,12 +2085,15 @@ void LineInfo::ReadLines() {
 }
 
 bool RangeListReader::ReadRanges(enum DwarfForm form, uint64_t data) {
+  uint64_t offset;
+  return FindRangeList(form, data, &offset) && ReadRangeList(offset);
+}
+
+bool RangeListReader::FindRangeList(enum DwarfForm form, uint64_t data,
+                                    uint64_t* offset) {
   if (form == DW_FORM_sec_offset) {
-    if (cu_info_->version_ <= 4) {
-      return ReadDebugRanges(data);
-    } else {
-      return ReadDebugRngList(data);
-    }
+    *offset = data;
+    return true;
   } else if (form == DW_FORM_rnglistx) {
     if (cu_info_->ranges_base_ == 0) {
       // In split dwarf, there's no DW_AT_rnglists_base attribute, range_base
@@ -1861,15 +2101,29 @@ bool RangeListReader::ReadRanges(enum DwarfForm form, uint64_t data) {
       cu_info_->ranges_base_ = reader_->OffsetSize() == 4? 12: 20;
     }
     offset_array_ = cu_info_->ranges_base_;
+    // Reject indices whose offset table entry lies outside the section.
+    if (reader_->OffsetSize() == 0 || offset_array_ > cu_info_->size_ ||
+        data >= (cu_info_->size_ - offset_array_) / reader_->OffsetSize()) {
+      return false;
+    }
     uint64_t index_offset = reader_->OffsetSize() * data;
     uint64_t range_list_offset =
         reader_->ReadOffset(cu_info_->buffer_ + offset_array_ + index_offset);
 
-    return ReadDebugRngList(offset_array_ + range_list_offset);
+    *offset = offset_array_ + range_list_offset;
+    return true;
   }
   return false;
 }
 
+bool RangeListReader::ReadRangeList(uint64_t offset) {
+  if (cu_info_->version_ <= 4) {
+    return ReadDebugRanges(offset);
+  } else {
+    return ReadDebugRngList(offset);
+  }
+}
+
 bool RangeListReader::ReadDebugRanges(uint64_t offset) {
   const uint64_t max_address =
     (reader_->AddressSize() == 4) ? 0xffffffffUL
@@ -3216,15 +3470,23 @@ bool CallFrameInfo::ReadFDEFields(FDE* fde) {
 }
 
 bool CallFrameInfo::Start() {
+  return Start(0, buffer_length_);
+}
+
+bool CallFrameInfo::Start(size_t begin, size_t end) {
   const uint8_t* buffer_end = buffer_ + buffer_length_;
   const uint8_t* cursor;
   bool all_ok = true;
   const uint8_t* entry_end;
   bool ok;
 
-  // Traverse all the entries in buffer_, skipping CIEs and offering
-  // FDEs to the handler.
-  for (cursor = buffer_; cursor < buffer_end;
+  // The CIEs parsed so far, by section offset.  There are usually only a
+  // few, each shared by many FDEs.
+  std::map<uint64_t, CIE> cies;
+
+  // Traverse the entries in the range, skipping CIEs and offering FDEs
+  // to the handler.
+  for (cursor = buffer_ + begin; cursor < buffer_ + end;
        cursor = entry_end, all_ok = all_ok && ok) {
     FDE fde;
 
@@ -3272,18 +3534,25 @@ bool CallFrameInfo::Start() {
       continue;
     }
 
-    CIE cie;
+    std::map<uint64_t, CIE>::iterator cie_it = cies.find(fde.id);
+    if (cie_it == cies.end()) {
+      CIE cie;
 
-    // Parse this FDE's CIE header.
-    if (!ReadEntryPrologue(buffer_ + fde.id, &cie))
-      continue;
-    // This had better be an actual CIE.
-    if (cie.kind != kCIE) {
-      reporter_->BadCIEId(fde.offset, fde.id);
-      continue;
+      // Parse this FDE's CIE header.
+      if (!ReadEntryPrologue(buffer_ + fde.id, &cie))
+        continue;
+      // This had better be an actual CIE.
+      if (cie.kind != kCIE) {
+        reporter_->BadCIEId(fde.offset, fde.id);
+        continue;
+      }
+      // Only CIEs that parse are kept, so that a bad CIE is reported for
+      // each FDE that uses it.  A CIE that parses reports nothing.
+      if (!ReadCIEFields(&cie))
+        continue;
+      cie_it = cies.insert(std::make_pair(fde.id, cie)).first;
     }
-    if (!ReadCIEFields(&cie))
-      continue;
+    CIE& cie = cie_it->second;
 
     // TODO(nbilling): This could lead to strange behavior if a single buffer
     // contained a mixture of DWARF versions as well as address sizes. Not
@@ -3350,6 +3619,36 @@ bool CallFrameInfo::Start() {
   return all_ok;
 }
 
+void CallFrameInfo::SplitEntries(size_t pieces,
+                                 std::vector<size_t>* boundaries) {
+  boundaries->clear();
+  boundaries->push_back(0);
+  const uint8_t* buffer_end = buffer_ + buffer_length_;
+  const uint8_t* cursor = buffer_;
+  size_t piece = 1;
+  while (piece < pieces && cursor < buffer_end) {
+    size_t offset = cursor - buffer_;
+    if (offset >= buffer_length_ / pieces * piece) {
+      if (offset > boundaries->back())
+        boundaries->push_back(offset);
+      piece++;
+    }
+
+    // Find the next entry as ReadEntryPrologue would, stopping at the
+    // .eh_frame terminator or at anything that may not parse.
+    size_t length_size;
+    uint64_t length = reader_->ReadInitialLength(cursor, &length_size);
+    if (length_size > size_t(buffer_end - cursor))
+      break;
+    cursor += length_size;
+    if ((length == 0 && eh_frame_) || length > size_t(buffer_end - cursor))
+      break;
+    cursor += length;
+  }
+  if (buffer_length_ > boundaries->back())
+    boundaries->push_back(buffer_length_);
+}
+
 const char* CallFrameInfo::KindName(EntryKind kind) {
   if (kind == CallFrameInfo::kUnknown)
     return "entry";
@@ -45,7 +45,9 @@
 
 #include <list>
 #include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <memory>
@@ -282,6 +284,16 @@ class RangeListReader {
   // Read ranges from cu_info as specified by form and data.
   bool ReadRanges(enum DwarfForm form, uint64_t data);
 
+  // Set *offset to the position in cu_info's section of the list that
+  // form and data refer to, looking DW_FORM_rnglistx indices up in the
+  // offset table. Returns false if the list can't be located. Lists
+  // found this way can be read with ReadRangeList, and a list referred
+  // to both ways yields the same offset.
+  bool FindRangeList(enum DwarfForm form, uint64_t data, uint64_t* offset);
+
+  // Read the list at an offset returned by FindRangeList.
+  bool ReadRangeList(uint64_t offset);
+
  private:
   // Read dwarf4 .debug_ranges at offset.
   bool ReadDebugRanges(uint64_t offset);
@@ -414,6 +426,14 @@ class Dwarf2Handler {
   // ending the parent.
   virtual void EndDIE(uint64_t offset) { }
 
+  // Return true if skipping a DIE, by returning false from StartDIE,
+  // should skip its descendants too.  The reader then jumps past the
+  // whole subtree without reporting any of its DIEs, following the DIE's
+  // DW_AT_sibling attribute when it has one, and calls EndDIE for the
+  // skipped DIE alone.  Otherwise each descendant is offered to StartDIE
+  // in turn.
+  virtual bool SkipsSubtrees() { return false; }
+
 };
 
 // The base of DWARF2/3 debug info is a DIE (Debugging Information
@@ -453,14 +473,28 @@ class Dwarf2Handler {
 
 class CompilationUnit {
  public:
+  class AbbrevCache;
+  class SplitDwarfCache;
 
   // Initialize a compilation unit.  This requires a map of sections,
   // the offset of this compilation unit in the .debug_info section, a
   // ByteReader, and a Dwarf2Handler class to call callbacks in.
   CompilationUnit(const string& path, const SectionMap& sections,
                   uint64_t offset, ByteReader* reader, Dwarf2Handler* handler);
-  virtual ~CompilationUnit() {
-    if (abbrevs_) delete abbrevs_;
+  virtual ~CompilationUnit() {}
+
+  // Takes this unit's abbreviation table from CACHE, parsing it into
+  // CACHE only if no earlier unit using CACHE had the same table.  Every
+  // unit given CACHE must read the same .debug_abbrev section.  CACHE is
+  // not owned, and must outlive this unit.  Call this before Start.
+  void set_abbrev_cache(AbbrevCache* cache) { abbrev_cache_ = cache; }
+
+  // Takes the .dwp file that ProcessSplitDwarf looks for from CACHE,
+  // opening it and parsing its index into CACHE only if no earlier unit
+  // using CACHE looked for it.  CACHE is not owned, and must outlive this
+  // unit and the sections ProcessSplitDwarf returns.
+  void set_split_dwarf_cache(SplitDwarfCache* cache) {
+    split_dwarf_cache_ = cache;
   }
 
   // Initialize a compilation unit from a .dwo or .dwp file.
@@ -520,6 +554,21 @@ class CompilationUnit {
     enum DwarfTag tag;
     bool has_children;
     AttributeList attributes;
+
+    // True if the size of every attribute's data depends only on the
+    // unit header, in which case a DIE's attributes take fixed_size bytes
+    // plus address_count addresses, offset_count offsets and
+    // ref_addr_count DW_FORM_ref_addr references, and SkipDIE need not
+    // look at them.
+    bool has_fixed_size;
+    uint64_t fixed_size;
+    uint64_t address_count;
+    uint64_t offset_count;
+    uint64_t ref_addr_count;
+
+    // True if attributes includes a DW_AT_sibling with a unit-relative
+    // reference form.
+    bool has_sibling;
   };
 
   // A DWARF2/3 compilation unit header.  This is not the same size as
@@ -538,6 +587,16 @@ class CompilationUnit {
   // Reads the DWARF2/3 abbreviations for this compilation unit
   void ReadAbbrevs();
 
+  // Parses the abbreviation table at ABBREV_START, in the ABBREV_LENGTH
+  // bytes left in the section, into ABBREVS, indexed by abbreviation
+  // number.
+  void ParseAbbrevs(const uint8_t* abbrev_start, uint64_t abbrev_length,
+                    std::vector<Abbrev>* abbrevs);
+
+  // Adds FORM's data size to ABBREV's fixed size, or clears its
+  // has_fixed_size if the size varies from one DIE to the next.
+  static void AddFormSize(enum DwarfForm form, Abbrev* abbrev);
+
   // Read the abbreviation offset for this compilation unit
   size_t ReadAbbrevOffset(const uint8_t* headerptr);
 
@@ -670,6 +729,20 @@ class CompilationUnit {
   // START, and return the new place to position the stream to.
   const uint8_t* SkipDIE(const uint8_t* start, const Abbrev& abbrev);
 
+  // Skips the die with attributes specified in ABBREV starting at START,
+  // and all of its descendants, none of which may extend past END.
+  // Return the new place to position the stream to, or NULL if the DIEs
+  // can't be read.
+  const uint8_t* SkipSubtree(const uint8_t* start, const Abbrev& abbrev,
+                             const uint8_t* end);
+
+  // Returns the position of the next sibling of the DIE with attributes
+  // specified in ABBREV starting at START, as given by its DW_AT_sibling
+  // attribute, or NULL if that isn't a position after START and no later
+  // than END.
+  const uint8_t* FindSibling(const uint8_t* start, const Abbrev& abbrev,
+                             const uint8_t* end);
+
   // Skips the attribute starting at START, with FORM, and return the
   // new place to position the stream to.
   const uint8_t* SkipAttribute(const uint8_t* start, enum DwarfForm form);
@@ -678,6 +751,21 @@ class CompilationUnit {
   void ReadDebugSectionsFromDwo(ElfReader* elf_reader,
                                 SectionMap* sections);
 
+  // A .dwp file and its readers.  The readers are NULL if the file is
+  // missing or unusable.
+  struct DwpFile;
+
+  // Look for the .dwp file next to the file this unit is in, and open it.
+  std::unique_ptr<DwpFile> OpenDwpFile();
+
+  // Read this unit's split sections from DWP_FILE into SECTIONS, and set
+  // the other arguments as ProcessSplitDwarf does.  Return true if the
+  // .dwp file has this unit.
+  bool ReadSplitDwarfFromDwp(const DwpFile& dwp_file, std::string& split_file,
+                             SectionMap& sections,
+                             ByteReader& split_byte_reader,
+                             uint64_t& cu_offset);
+
   // Path of the file containing the debug information.
   const string path_;
 
@@ -703,8 +791,13 @@ class CompilationUnit {
 
   // Set of DWARF2/3 abbreviations for this compilation unit.  Indexed
   // by abbreviation number, which means that abbrevs_[0] is not
-  // valid.
-  std::vector<Abbrev>* abbrevs_;
+  // valid.  This points into abbrev_cache_ if there is one, and into
+  // owned_abbrevs_ otherwise.
+  const std::vector<Abbrev>* abbrevs_;
+  std::unique_ptr<std::vector<Abbrev>> owned_abbrevs_;
+
+  // See set_abbrev_cache.
+  AbbrevCache* abbrev_cache_;
 
   // String section buffer and length, if we have a string section.
   // This is here to avoid doing a section lookup for strings in
@@ -767,11 +860,14 @@ class CompilationUnit {
   // True if we have already looked for a .dwp file.
   bool have_checked_for_dwp_;
 
-  // ElfReader for the dwo/dwo file.
+  // ElfReader for the dwo file.
   std::unique_ptr<ElfReader> split_elf_reader_;
 
-  // DWP reader.
-  std::unique_ptr<DwpReader> dwp_reader_;
+  // The .dwp file, if there is no split_dwarf_cache_.
+  std::unique_ptr<DwpFile> dwp_file_;
+
+  // See set_split_dwarf_cache.
+  SplitDwarfCache* split_dwarf_cache_;
 
   bool should_process_split_dwarf_;
 
@@ -783,6 +879,46 @@ class CompilationUnit {
   uint64_t source_line_offset_;
 };
 
+// The parsed abbreviation tables of one file's .debug_abbrev section,
+// keyed by their offset in the section.  Compilation units usually share
+// a handful of tables, so units given the same cache parse each table
+// only once.  Units on several threads may share a cache; tables are
+// never changed or removed once added.
+class CompilationUnit::AbbrevCache {
+ public:
+  AbbrevCache() {}
+
+ private:
+  friend class CompilationUnit;
+
+  std::mutex mutex_;
+  std::map<uint64_t, std::unique_ptr<const std::vector<Abbrev>>> tables_;
+};
+
+struct CompilationUnit::DwpFile {
+  string path;
+  std::unique_ptr<ElfReader> elf_reader;
+  std::unique_ptr<ByteReader> byte_reader;
+  std::unique_ptr<DwpReader> dwp_reader;
+};
+
+// The .dwp files that one file's skeleton units refer to, each opened
+// and its index parsed once, by the first unit that looks for it.  Units
+// on several threads may share a cache; the files stay open until the
+// cache is destroyed.
+class CompilationUnit::SplitDwarfCache {
+ public:
+  SplitDwarfCache() {}
+
+ private:
+  friend class CompilationUnit;
+
+  // Guards files_ and the readers in it, which are not thread-safe.
+  std::mutex mutex_;
+  // Keyed by the path of the file whose units refer to the .dwp file.
+  std::map<string, std::unique_ptr<DwpFile>> files_;
+};
+
 // A Reader for a .dwp file.  Supports the fetching of DWARF debug
 // info for a given dwo_id.
 //
@@ -800,20 +936,24 @@ class DwpReader {
  public:
   DwpReader(const ByteReader& byte_reader, ElfReader* elf_reader);
 
-  // Read the CU index and initialize data members.
+  // Read the CU index and initialize data members.  The index's hash
+  // table is parsed here, once, so looking up a unit does not probe it.
   void Initialize();
 
   // Read the debug sections for the given dwo_id.
   void ReadDebugSectionsForCU(uint64_t dwo_id, SectionMap* sections);
 
  private:
+  // Fill units_ from the hash table.
+  void ParseHashTable();
+
   // Search a v1 hash table for "dwo_id".  Returns the slot index
   // where the dwo_id was found, or -1 if it was not found.
-  int LookupCU(uint64_t dwo_id);
+  int LookupCU(uint64_t dwo_id) const;
 
   // Search a v2 hash table for "dwo_id".  Returns the row index
   // in the offsets and sizes tables, or 0 if it was not found.
-  uint32_t LookupCUv2(uint64_t dwo_id);
+  uint32_t LookupCUv2(uint64_t dwo_id) const;
 
   // The ELF reader for the .dwp file.
   ElfReader* elf_reader_;
@@ -851,6 +991,10 @@ class DwpReader {
   // Pointer to the beginning of the index table.
   const char* pindex_;
 
+  // The parsed hash table: the slot (version 1) or the row of the section
+  // tables (version 2) of each dwo_id in it.
+  std::unordered_map<uint64_t, uint32_t> units_;
+
   // Pointer to the beginning of the section index pool (version 1).
   const char* shndx_pool_;
 
@@ -1112,6 +1256,21 @@ class CallFrameInfo {
   // false if we encounter an error.
   bool Start();
 
+  // Like Start, but parse only the entries that begin at section offsets
+  // from BEGIN up to, but not including, END.  BEGIN must be the offset
+  // of an entry.  Each CIE is parsed once per call, however many FDEs
+  // refer to it.
+  bool Start(size_t begin, size_t end);
+
+  // Divide the section into about PIECES runs of entries of similar size,
+  // which can be parsed independently, even on different threads, by
+  // passing consecutive elements of *BOUNDARIES to Start(begin, end),
+  // each with a CallFrameInfo of its own.  The runs together visit the
+  // same entries as Start.  *BOUNDARIES starts with zero and ends with
+  // BUFFER_LENGTH.  This only reads the entries' lengths, and reports
+  // nothing: problems are reported when the runs are parsed.
+  void SplitEntries(size_t pieces, std::vector<size_t>* boundaries);
+
   // Return the textual name of KIND. For error reporting.
   static const char* KindName(EntryKind kind);
 
@@ -453,6 +453,58 @@ TEST_F(CFI, TwoFDEsTwoCIEs) {
   EXPECT_TRUE(parser.Start());
 }
 
+// Three FDEs sharing a CIE, parsed in separate pieces.
+TEST_F(CFI, SplitEntries) {
+  CFISection section(kLittleEndian, 4);
+  Label cie;
+  section
+      .Mark(&cie)
+      .CIEHeader(0x2e9b5uLL, 0x8d1f, 0x2a, 3, "")
+      .FinishEntry()
+      .FDEHeader(cie, 0x3000, 0x100)
+      .FinishEntry()
+      .FDEHeader(cie, 0x1000, 0x200)
+      .FinishEntry()
+      .FDEHeader(cie, 0x2000, 0x300)
+      .FinishEntry();
+
+  PERHAPS_WRITE_DEBUG_FRAME_FILE("SplitEntries", section);
+
+  {
+    InSequence s;
+    EXPECT_CALL(handler, Entry(_, 0x3000, 0x100, 3, "", 0x2a))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, End()).WillOnce(Return(true));
+    EXPECT_CALL(handler, Entry(_, 0x1000, 0x200, 3, "", 0x2a))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, End()).WillOnce(Return(true));
+    EXPECT_CALL(handler, Entry(_, 0x2000, 0x300, 3, "", 0x2a))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, End()).WillOnce(Return(true));
+  }
+
+  string contents;
+  EXPECT_TRUE(section.GetContents(&contents));
+  ByteReader byte_reader(ENDIANNESS_LITTLE);
+  byte_reader.SetAddressSize(4);
+  CallFrameInfo splitter(reinterpret_cast<const uint8_t*>(contents.data()),
+                         contents.size(),
+                         &byte_reader, &handler, &reporter);
+  std::vector<size_t> boundaries;
+  splitter.SplitEntries(3, &boundaries);
+  ASSERT_EQ(4U, boundaries.size());
+  EXPECT_EQ(0U, boundaries.front());
+  EXPECT_EQ(contents.size(), boundaries.back());
+  for (size_t i = 0; i + 1 < boundaries.size(); i++) {
+    EXPECT_LT(boundaries[i], boundaries[i + 1]);
+    ByteReader piece_reader(byte_reader);
+    CallFrameInfo parser(reinterpret_cast<const uint8_t*>(contents.data()),
+                         contents.size(),
+                         &piece_reader, &handler, &reporter);
+    EXPECT_TRUE(parser.Start(boundaries[i], boundaries[i + 1]));
+  }
+}
+
 // An FDE whose CIE specifies a version we don't recognize.
 TEST_F(CFI, BadVersion) {
   CFISection section(kBigEndian, 4);
@@ -107,6 +107,7 @@ class MockDwarf2Handler: public Dwarf2Handler {
                                                enum DwarfForm form,
                                                uint64_t signature));
   MOCK_METHOD1(EndDIE, void(uint64_t offset));
+  MOCK_METHOD0(SkipsSubtrees, bool());
 };
 
 struct DIEFixture {
@@ -125,6 +126,7 @@ struct DIEFixture {
     EXPECT_CALL(handler, ProcessAttributeBuffer(_, _, _, _, _)).Times(0);
     EXPECT_CALL(handler, ProcessAttributeString(_, _, _, _)).Times(0);
     EXPECT_CALL(handler, EndDIE(_)).Times(0);
+    EXPECT_CALL(handler, SkipsSubtrees()).WillRepeatedly(Return(false));
   }
 
   // Return a reference to a section map whose .debug_info section refers
@@ -628,6 +630,184 @@ TEST_P(DwarfForms, implicit_const) {
   ParseCompilationUnit(GetParam());
 }
 
+TEST_P(DwarfForms, skip_fixed_size) {
+  const DwarfHeaderParams& params = GetParam();
+  Label abbrev_table = abbrevs.Here();
+  abbrevs.Abbrev(1, google_breakpad::DW_TAG_compile_unit,
+                 google_breakpad::DW_children_yes)
+      .EndAbbrev()
+      .Abbrev(2, google_breakpad::DW_TAG_subprogram,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_low_pc, google_breakpad::DW_FORM_addr)
+      .Attribute(google_breakpad::DW_AT_specification,
+                 google_breakpad::DW_FORM_ref_addr)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_strp)
+      .Attribute(google_breakpad::DW_AT_decl_line,
+                 google_breakpad::DW_FORM_data2)
+      .Attribute(google_breakpad::DW_AT_external,
+                 google_breakpad::DW_FORM_flag_present)
+      .EndAbbrev()
+      .Abbrev(3, google_breakpad::DW_TAG_variable,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_decl_line,
+                 google_breakpad::DW_FORM_data1)
+      .EndAbbrev()
+      .EndTable();
+
+  info.set_format_size(params.format_size);
+  info.set_endianness(params.endianness);
+  info.Header(params.version, abbrev_table, params.address_size,
+              google_breakpad::DW_UT_compile)
+      .ULEB128(1)                       // DW_TAG_compile_unit
+      .ULEB128(2)                       // DW_TAG_subprogram, skipped
+      .Append(params.endianness, params.address_size, 0x5f4f0c71);
+  if (params.version == 2)
+    info.Append(params.endianness, params.address_size, 0x3f01);
+  else
+    info.SectionOffset(0x3f01);
+  info.SectionOffset(0x72b8);
+  info.D16(0x6d2e)
+      .ULEB128(3)                       // DW_TAG_variable
+      .D8(0x2a)
+      .D8(0);                           // end of children
+  info.Finish();
+
+  ExpectBeginCompilationUnit(params, google_breakpad::DW_TAG_compile_unit);
+  EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_subprogram))
+      .InSequence(s)
+      .WillOnce(Return(false));
+  EXPECT_CALL(handler, EndDIE(_))
+      .InSequence(s)
+      .WillOnce(Return());
+  EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_variable))
+      .InSequence(s)
+      .WillOnce(Return(true));
+  EXPECT_CALL(handler,
+              ProcessAttributeUnsigned(_, google_breakpad::DW_AT_decl_line,
+                                       google_breakpad::DW_FORM_data1, 0x2a))
+      .InSequence(s)
+      .WillOnce(Return());
+  EXPECT_CALL(handler, EndDIE(_))
+      .InSequence(s)
+      .WillOnce(Return());
+  ExpectEndCompilationUnit();
+
+  ParseCompilationUnit(params);
+}
+
+TEST_P(DwarfForms, skip_subtree) {
+  const DwarfHeaderParams& params = GetParam();
+  Label abbrev_table = abbrevs.Here();
+  abbrevs.Abbrev(1, google_breakpad::DW_TAG_compile_unit,
+                 google_breakpad::DW_children_yes)
+      .EndAbbrev()
+      .Abbrev(2, google_breakpad::DW_TAG_structure_type,
+              google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_sibling, google_breakpad::DW_FORM_ref4)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .Abbrev(3, google_breakpad::DW_TAG_member,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .Abbrev(4, google_breakpad::DW_TAG_class_type,
+              google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .Abbrev(5, google_breakpad::DW_TAG_variable,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_decl_line,
+                 google_breakpad::DW_FORM_data1)
+      .EndAbbrev()
+      .EndTable();
+
+  Label sibling;
+  info.set_format_size(params.format_size);
+  info.set_endianness(params.endianness);
+  info.Header(params.version, abbrev_table, params.address_size,
+              google_breakpad::DW_UT_compile)
+      .ULEB128(1)                       // DW_TAG_compile_unit
+      .ULEB128(2)                       // DW_TAG_structure_type, skipped
+      .D32(sibling)
+      .AppendCString("s")
+      .ULEB128(3).AppendCString("a")    // DW_TAG_member
+      // Not a valid abbreviation code: the skip must follow DW_AT_sibling
+      // rather than read structure_type's children.
+      .ULEB128(0x7f)
+      .D8(0)                            // end of structure_type's children
+      .Mark(&sibling)
+      .ULEB128(4).AppendCString("c")    // DW_TAG_class_type, skipped
+      .ULEB128(4).AppendCString("d")    // DW_TAG_class_type
+      .ULEB128(3).AppendCString("e")    // DW_TAG_member
+      .D8(0)                            // end of inner class_type's children
+      .ULEB128(3).AppendCString("f")    // DW_TAG_member
+      .D8(0)                            // end of outer class_type's children
+      .ULEB128(5)                       // DW_TAG_variable
+      .D8(0x2a)
+      .D8(0);                           // end of compile_unit's children
+  info.Finish();
+
+  EXPECT_CALL(handler, SkipsSubtrees()).WillRepeatedly(Return(true));
+  ExpectBeginCompilationUnit(params, google_breakpad::DW_TAG_compile_unit);
+  EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_structure_type))
+      .InSequence(s)
+      .WillOnce(Return(false));
+  EXPECT_CALL(handler, EndDIE(_))
+      .InSequence(s)
+      .WillOnce(Return());
+  EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_class_type))
+      .InSequence(s)
+      .WillOnce(Return(false));
+  EXPECT_CALL(handler, EndDIE(_))
+      .InSequence(s)
+      .WillOnce(Return());
+  EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_variable))
+      .InSequence(s)
+      .WillOnce(Return(true));
+  EXPECT_CALL(handler,
+              ProcessAttributeUnsigned(_, google_breakpad::DW_AT_decl_line,
+                                       google_breakpad::DW_FORM_data1, 0x2a))
+      .InSequence(s)
+      .WillOnce(Return());
+  EXPECT_CALL(handler, EndDIE(_))
+      .InSequence(s)
+      .WillOnce(Return());
+  ExpectEndCompilationUnit();
+
+  ParseCompilationUnit(params);
+}
+
+TEST_P(DwarfForms, shared_abbrev_cache) {
+  StartSingleAttributeDIE(GetParam(), (DwarfTag) 0x3f5d0be1,
+                          (DwarfAttribute) 0x6b2c0e9d,
+                          google_breakpad::DW_FORM_data4);
+  info.D32(0x0cfdf8f7);
+  info.Finish();
+
+  // Two units sharing a cache should each see the table, whether it is
+  // parsed or found in the cache.
+  for (int i = 0; i < 2; ++i) {
+    ExpectBeginCompilationUnit(GetParam(), (DwarfTag) 0x3f5d0be1);
+    EXPECT_CALL(handler,
+                ProcessAttributeUnsigned(_, (DwarfAttribute) 0x6b2c0e9d,
+                                         google_breakpad::DW_FORM_data4,
+                                         0x0cfdf8f7))
+        .InSequence(s)
+        .WillOnce(Return());
+    ExpectEndCompilationUnit();
+  }
+
+  ByteReader byte_reader(GetParam().endianness == kLittleEndian ?
+                         ENDIANNESS_LITTLE : ENDIANNESS_BIG);
+  CompilationUnit::AbbrevCache abbrev_cache;
+  const SectionMap& sections = MakeSectionMap();
+  for (int i = 0; i < 2; ++i) {
+    CompilationUnit parser("", sections, 0, &byte_reader, &handler);
+    parser.set_abbrev_cache(&abbrev_cache);
+    EXPECT_EQ(parser.Start(), info_contents.size());
+  }
+}
+
 // Tests for the other attribute forms could go here.
 
 INSTANTIATE_TEST_SUITE_P(
@@ -966,3 +1146,54 @@ TEST(RangeList, Dwarf5ReadRangeList_sec_offset) {
   EXPECT_FALSE(range_list_reader.ReadRanges(DW_FORM_sec_offset,
                                             rnglists_contents.size()));
 }
+
+TEST(RangeList, FindRangeList) {
+  using google_breakpad::RangeListReader;
+  using google_breakpad::DW_FORM_sec_offset;
+  using google_breakpad::DW_FORM_rnglistx;
+  using google_breakpad::DW_FORM_data4;
+
+  // A .debug_rnglists header with a two-entry offset table.
+  Section rnglists(kBigEndian);
+  rnglists.D32(0);  // Length, unused here
+  rnglists.D16(5);  // Version
+  rnglists.D8(4);   // Address size
+  rnglists.D8(0);   // Segment selector size
+  rnglists.D32(2);  // Offset entry count
+  const uint64_t ranges_base = rnglists.Size();
+  rnglists.D32(8).D32(9);
+  rnglists.D8(google_breakpad::DW_RLE_end_of_list);
+  rnglists.D8(google_breakpad::DW_RLE_end_of_list);
+  string rnglists_contents;
+  assert(rnglists.GetContents(&rnglists_contents));
+
+  RangeListReader::CURangesInfo cu_info;
+  cu_info.version_ = 5;
+  cu_info.ranges_base_ = ranges_base;
+  cu_info.buffer_ =
+      reinterpret_cast<const uint8_t*>(rnglists_contents.data());
+  cu_info.size_ = rnglists_contents.size();
+
+  ByteReader byte_reader(ENDIANNESS_BIG);
+  byte_reader.SetOffsetSize(4);
+  byte_reader.SetAddressSize(4);
+  MockRangeListHandler handler;
+  RangeListReader range_list_reader(&byte_reader, &cu_info, &handler);
+
+  // An index and a section offset naming the same list find the same one.
+  uint64_t offset = 0;
+  EXPECT_TRUE(range_list_reader.FindRangeList(DW_FORM_rnglistx, 1, &offset));
+  EXPECT_EQ(ranges_base + 9, offset);
+  EXPECT_TRUE(range_list_reader.FindRangeList(DW_FORM_sec_offset,
+                                              ranges_base + 9, &offset));
+  EXPECT_EQ(ranges_base + 9, offset);
+  // Indices beyond the end of the section, including ones whose table
+  // offset would overflow, are rejected.
+  EXPECT_FALSE(range_list_reader.FindRangeList(DW_FORM_rnglistx, 4, &offset));
+  EXPECT_FALSE(range_list_reader.FindRangeList(DW_FORM_rnglistx,
+                                               1ULL << 62, &offset));
+  EXPECT_FALSE(range_list_reader.FindRangeList(DW_FORM_data4, 0, &offset));
+
+  EXPECT_CALL(handler, Finish());
+  EXPECT_TRUE(range_list_reader.ReadRangeList(ranges_base + 9));
+}
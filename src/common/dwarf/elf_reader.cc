@@ -46,6 +46,7 @@
 #include <map>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 // TODO(saugustine): Add support for compressed debug.
 // Also need to add configure tests for zlib.
@@ -353,6 +354,7 @@ class ElfReaderImpl {
         fd_(fd),
         section_headers_(NULL),
         program_headers_(NULL),
+        section_name_index_built_(false),
         opd_section_(NULL),
         base_for_text_(0),
         plts_supported_(false),
@@ -745,54 +747,72 @@ class ElfReaderImpl {
   // "size".  Returns NULL if the section name is not found.
   const char* GetSectionContentsByName(const string& section_name,
                                        size_t* size) {
-    for (unsigned int k = 0u; k < GetNumSections(); ++k) {
-      // When searching for sections in a .dwp file, the sections
-      // we're looking for will always be at the end of the section
-      // table, so reverse the direction of iteration.
-      int shndx = is_dwp_ ? GetNumSections() - k - 1 : k;
-      const char* name = GetSectionName(section_headers_[shndx].sh_name);
-      if (name != NULL && ElfReader::SectionNamesMatch(section_name, name)) {
-        const ElfSectionReader<ElfArch>* section = GetSection(shndx);
-        if (section == NULL) {
-          return NULL;
-        } else {
-          *size = section->section_size();
-          return section->contents();
-        }
-      }
-    }
-    return NULL;
+    int shndx = FindSectionIndexByName(section_name);
+    if (shndx < 0)
+      return NULL;
+    const ElfSectionReader<ElfArch>* section = GetSection(shndx);
+    if (section == NULL)
+      return NULL;
+    *size = section->section_size();
+    return section->contents();
   }
 
   // This is like GetSectionContentsByName() but it returns a lot of extra
   // information about the section.
   const char* GetSectionInfoByName(const string& section_name,
                                    ElfReader::SectionInfo* info) {
-    for (unsigned int k = 0u; k < GetNumSections(); ++k) {
+    int shndx = FindSectionIndexByName(section_name);
+    if (shndx < 0)
+      return NULL;
+    const ElfSectionReader<ElfArch>* section = GetSection(shndx);
+    if (section == NULL)
+      return NULL;
+    info->type = section->header().sh_type;
+    info->flags = section->header().sh_flags;
+    info->addr = section->header().sh_addr;
+    info->offset = section->header().sh_offset;
+    info->size = section->header().sh_size;
+    info->link = section->header().sh_link;
+    info->info = section->header().sh_info;
+    info->addralign = section->header().sh_addralign;
+    info->entsize = section->header().sh_entsize;
+    return section->contents();
+  }
+
+  // Return the index of the first section whose name matches
+  // "section_name" as ElfReader::SectionNamesMatch does, or -1 if there
+  // is none.  The section names are hashed on the first call, so that
+  // files with many sections aren't searched linearly for each name.
+  int FindSectionIndexByName(std::string_view section_name) {
+    if (!section_name_index_built_) {
       // When searching for sections in a .dwp file, the sections
       // we're looking for will always be at the end of the section
-      // table, so reverse the direction of iteration.
-      int shndx = is_dwp_ ? GetNumSections() - k - 1 : k;
-      const char* name = GetSectionName(section_headers_[shndx].sh_name);
-      if (name != NULL && ElfReader::SectionNamesMatch(section_name, name)) {
-        const ElfSectionReader<ElfArch>* section = GetSection(shndx);
-        if (section == NULL) {
-          return NULL;
-        } else {
-          info->type = section->header().sh_type;
-          info->flags = section->header().sh_flags;
-          info->addr = section->header().sh_addr;
-          info->offset = section->header().sh_offset;
-          info->size = section->header().sh_size;
-          info->link = section->header().sh_link;
-          info->info = section->header().sh_info;
-          info->addralign = section->header().sh_addralign;
-          info->entsize = section->header().sh_entsize;
-          return section->contents();
-        }
+      // table, so the last section of each name is the one found.
+      for (unsigned int k = 0u; k < GetNumSections(); ++k) {
+        int shndx = is_dwp_ ? GetNumSections() - k - 1 : k;
+        const char* name = GetSectionName(section_headers_[shndx].sh_name);
+        if (name != NULL)
+          section_name_index_.emplace(name, shndx);
       }
+      section_name_index_built_ = true;
     }
-    return NULL;
+
+    int found = -1;
+    auto it = section_name_index_.find(section_name);
+    if (it != section_name_index_.end())
+      found = it->second;
+    // A .debug_ name also matches its compressed .zdebug_ section.
+    const std::string_view debug_prefix{".debug_"};
+    if (StringViewStartsWith(section_name, debug_prefix)) {
+      string zdebug_name = ".zdebug_";
+      zdebug_name.append(section_name.substr(debug_prefix.length()));
+      it = section_name_index_.find(zdebug_name);
+      if (it != section_name_index_.end() &&
+          (found < 0 || (is_dwp_ ? it->second > found : it->second < found))) {
+        found = it->second;
+      }
+    }
+    return found;
   }
 
   // p_vaddr of the first PT_LOAD segment (if any), or 0 if no PT_LOAD
@@ -1020,6 +1040,12 @@ class ElfReaderImpl {
   // destroyed.
   vector<ElfSectionReader<ElfArch>*> sections_;
 
+  // The first section of each name, in the order sections are searched,
+  // built by FindSectionIndexByName.  The names point into the section
+  // header string table.
+  std::unordered_map<std::string_view, int> section_name_index_;
+  bool section_name_index_built_;
+
   // For PowerPC64 we need to keep track of function descriptors when looking up
   // values for funtion symbols values. Function descriptors are kept in the
   // .opd section and are dereferenced to find the function address.
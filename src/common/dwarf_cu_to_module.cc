@@ -49,6 +49,7 @@
 #include <algorithm>
 #include <memory>
 #include <numeric>
+#include <thread>
 #include <utility>
 
 #include "common/string_view.h"
@@ -62,7 +63,6 @@ using std::map;
 using std::pair;
 using std::sort;
 using std::vector;
-using std::unique_ptr;
 
 // Data provided by a DWARF specification DIE.
 //
@@ -123,7 +123,11 @@ DwarfCUToModule::FileContext::FileContext(const string& filename,
     : filename_(filename),
       module_(module),
       handle_inter_cu_refs_(handle_inter_cu_refs),
-      file_private_(new FilePrivate()) {
+      file_private_(new FilePrivate()),
+      unit_functions_(NULL),
+      demangle_cache_(NULL),
+      has_inter_cu_refs_(false),
+      thread_count_(1) {
 }
 
 DwarfCUToModule::FileContext::~FileContext() {
@@ -158,6 +162,18 @@ void DwarfCUToModule::FileContext::ClearSpecifications() {
     file_private_->specifications.clear();
 }
 
+void DwarfCUToModule::FileContext::set_unit_functions(
+    vector<Module::Function*>* functions) {
+  unit_functions_ = functions;
+}
+
+void DwarfCUToModule::FileContext::NoteReference(
+    uint64_t offset, uint64_t compilation_unit_start,
+    uint64_t compilation_unit_end) {
+  if (offset < compilation_unit_start || offset >= compilation_unit_end)
+    has_inter_cu_refs_ = true;
+}
+
 bool DwarfCUToModule::FileContext::IsUnhandledInterCUReference(
     uint64_t offset, uint64_t compilation_unit_start) const {
   if (handle_inter_cu_refs_)
@@ -175,6 +191,7 @@ struct DwarfCUToModule::CUContext {
             uint64_t low_pc,
             uint64_t addr_base)
       : version(0),
+        end_offset(0),
         file_context(file_context_arg),
         reporter(reporter_arg),
         ranges_handler(ranges_handler_arg),
@@ -197,6 +214,9 @@ struct DwarfCUToModule::CUContext {
   // Dwarf version of the source CU.
   uint8_t version;
 
+  // The offset of the end of this CU within .debug_info.
+  uint64_t end_offset;
+
   // The DWARF-bearing file into which this CU was incorporated.
   FileContext* file_context;
 
@@ -400,6 +420,8 @@ void DwarfCUToModule::GenericDIEHandler::ProcessAttributeReference(
   switch (attr) {
     case DW_AT_specification: {
       FileContext* file_context = cu_context_->file_context;
+      file_context->NoteReference(data, cu_context_->reporter->cu_offset(),
+                                  cu_context_->end_offset);
       if (file_context->IsUnhandledInterCUReference(
               data, cu_context_->reporter->cu_offset())) {
         cu_context_->reporter->UnhandledInterCUReference(offset_, data);
@@ -424,6 +446,8 @@ void DwarfCUToModule::GenericDIEHandler::ProcessAttributeReference(
       break;
     }
     case DW_AT_abstract_origin: {
+      cu_context_->file_context->NoteReference(
+          data, cu_context_->reporter->cu_offset(), cu_context_->end_offset);
       const AbstractOriginByOffset& origins =
           cu_context_->file_context->file_private_->origins;
       AbstractOriginByOffset::const_iterator origin = origins.find(data);
@@ -451,7 +475,9 @@ void DwarfCUToModule::GenericDIEHandler::ProcessAttributeString(
     case DW_AT_MIPS_linkage_name:
     case DW_AT_linkage_name: {
       string demangled;
-      Language::DemangleResult result =
+      DemangleCache* cache = cu_context_->file_context->demangle_cache_;
+      Language::DemangleResult result = cache ?
+          cache->DemangleName(cu_context_->language, data, &demangled) :
           cu_context_->language->DemangleName(data, &demangled);
       switch (result) {
         case Language::kDemangleSuccess:
@@ -568,7 +594,7 @@ class DwarfCUToModule::LexicalBlockHandler : public GenericDIEHandler {
   LexicalBlockHandler(CUContext* cu_context,
                       uint64_t offset,
                       int inline_nest_level,
-                      vector<unique_ptr<Module::Inline>>& inlines)
+                      Module::InlineList& inlines)
       : GenericDIEHandler(cu_context, nullptr, offset),
         inline_nest_level_(inline_nest_level),
         inlines_(inlines) {}
@@ -579,11 +605,11 @@ class DwarfCUToModule::LexicalBlockHandler : public GenericDIEHandler {
 
  private:
   int inline_nest_level_;
-  // A vector of inlines in the same nest level. It's owned by its parent
-  // function/inline. At Finish(), add this inline into the vector.
-  vector<unique_ptr<Module::Inline>>& inlines_;
-  // A vector of child inlines.
-  vector<unique_ptr<Module::Inline>> child_inlines_;
+  // The inlines in the same nest level. It's owned by its parent
+  // function/inline. At Finish(), add this inline into the list.
+  Module::InlineList& inlines_;
+  // The child inlines, and those nested in them.
+  Module::InlineList child_inlines_;
 };
 
 // A handler for DW_TAG_inlined_subroutine DIEs.
@@ -593,7 +619,7 @@ class DwarfCUToModule::InlineHandler : public GenericDIEHandler {
                 DIEContext* parent_context,
                 uint64_t offset,
                 int inline_nest_level,
-                vector<unique_ptr<Module::Inline>>& inlines)
+                Module::InlineList& inlines)
       : GenericDIEHandler(cu_context, parent_context, offset),
         low_pc_(0),
         high_pc_(0),
@@ -625,11 +651,11 @@ class DwarfCUToModule::InlineHandler : public GenericDIEHandler {
   int call_site_file_id_;      // DW_AT_call_file
   int inline_nest_level_;
   bool has_range_data_;
-  // A vector of inlines in the same nest level. It's owned by its parent
-  // function/inline. At Finish(), add this inline into the vector.
-  vector<unique_ptr<Module::Inline>>& inlines_;
-  // A vector of child inlines.
-  vector<unique_ptr<Module::Inline>> child_inlines_;
+  // The inlines in the same nest level. It's owned by its parent
+  // function/inline. At Finish(), add this inline into the list.
+  Module::InlineList& inlines_;
+  // The child inlines, and those nested in them.
+  Module::InlineList child_inlines_;
 };
 
 void DwarfCUToModule::InlineHandler::ProcessAttributeUnsigned(
@@ -735,10 +761,9 @@ void DwarfCUToModule::InlineHandler::Finish() {
   inline_origin_map.SetReference(specification_offset_, specification_offset_);
   Module::InlineOrigin* origin =
       inline_origin_map.GetOrCreateInlineOrigin(specification_offset_, name_);
-  unique_ptr<Module::Inline> in(
-      new Module::Inline(origin, ranges, call_site_line_, call_site_file_id_,
-                         inline_nest_level_, std::move(child_inlines_)));
-  inlines_.push_back(std::move(in));
+  int index = inlines_.Add(origin, -1, ranges, call_site_line_,
+                           call_site_file_id_, inline_nest_level_);
+  inlines_.Append(child_inlines_, index);
 }
 
 DIEHandler* DwarfCUToModule::LexicalBlockHandler::FindChildHandler(
@@ -757,11 +782,9 @@ DIEHandler* DwarfCUToModule::LexicalBlockHandler::FindChildHandler(
 }
 
 void DwarfCUToModule::LexicalBlockHandler::Finish() {
-  // Insert child inlines inside the lexical block into the inline vector from
+  // Insert child inlines inside the lexical block into the inline list from
   // parent as if the block does not exit.
-  inlines_.insert(inlines_.end(),
-                  std::make_move_iterator(child_inlines_.begin()),
-                  std::make_move_iterator(child_inlines_.end()));
+  inlines_.Append(child_inlines_, -1);
 }
 
 // A handler for DIEs that contain functions and contribute a
@@ -819,7 +842,7 @@ class DwarfCUToModule::FuncHandler: public GenericDIEHandler {
   DwarfForm ranges_form_; // DW_FORM_sec_offset or DW_FORM_rnglistx
   uint64_t ranges_data_;  // DW_AT_ranges
   bool inline_;
-  vector<unique_ptr<Module::Inline>> child_inlines_;
+  Module::InlineList child_inlines_;
   bool handle_inline_;
   bool has_qualified_name_;
   bool has_range_data_;
@@ -1148,6 +1171,8 @@ DwarfCUToModule::DwarfCUToModule(FileContext* file_context,
       source_line_offset_(source_line_offset) {}
 
 DwarfCUToModule::~DwarfCUToModule() {
+  if (line_thread_.joinable())
+    line_thread_.join();
 }
 
 void DwarfCUToModule::ProcessAttributeSigned(enum DwarfAttribute attr,
@@ -1214,6 +1239,14 @@ void DwarfCUToModule::ProcessAttributeString(enum DwarfAttribute attr,
 }
 
 bool DwarfCUToModule::EndAttributes() {
+  // Every attribute the line program needs is known now, so it can be
+  // read while the DIEs are walked.
+  if (has_source_line_info_ && cu_context_->language->HasFunctions() &&
+      cu_context_->file_context->thread_count_ > 1) {
+    line_reader_clone_.reset(line_reader_->Clone());
+    if (line_reader_clone_.get())
+      ReadSourceLines(source_line_offset_, true);
+  }
   return true;
 }
 
@@ -1279,7 +1312,7 @@ void DwarfCUToModule::SetLanguage(DwarfLanguage language) {
   }
 }
 
-void DwarfCUToModule::ReadSourceLines(uint64_t offset) {
+void DwarfCUToModule::ReadSourceLines(uint64_t offset, bool concurrently) {
   const SectionMap& section_map
       = cu_context_->file_context->section_map();
   SectionMap::const_iterator map_entry
@@ -1311,11 +1344,51 @@ void DwarfCUToModule::ReadSourceLines(uint64_t offset) {
     line_string_section_start = map_entry->second.first;
     line_string_section_length = map_entry->second.second;
   }
+  Module* module = cu_context_->file_context->module_;
+  if (concurrently) {
+    // Module isn't thread-safe, so the files are recorded separately.
+    line_module_.reset(new Module(module->name(), module->os(),
+                                  module->architecture(),
+                                  module->identifier()));
+    line_thread_ = std::thread([=]() {
+      line_reader_clone_->ReadProgram(
+          line_section_start, line_section_length,
+          string_section_start, string_section_length,
+          line_string_section_start, line_string_section_length,
+          line_module_.get(), &lines_, &files_);
+    });
+    return;
+  }
   line_reader_->ReadProgram(
       line_section_start, line_section_length,
       string_section_start, string_section_length,
       line_string_section_start, line_string_section_length,
-      cu_context_->file_context->module_, &lines_, &files_);
+      module, &lines_, &files_);
+}
+
+void DwarfCUToModule::FinishSourceLines() {
+  if (!line_thread_.joinable()) {
+    line_reader_clone_.reset();
+    return;
+  }
+  line_thread_.join();
+  line_reader_clone_.reset();
+
+  Module* module = cu_context_->file_context->module_;
+  map<Module::File*, Module::File*> files;
+  auto file_in_module = [&](Module::File* line_file) -> Module::File* {
+    if (!line_file)
+      return NULL;
+    Module::File*& file = files[line_file];
+    if (!file)
+      file = module->FindFile(line_file->name);
+    return file;
+  };
+  for (auto& file : files_)
+    file.second = file_in_module(file.second);
+  for (Module::Line& line : lines_)
+    line.file = file_in_module(line.file);
+  line_module_.reset();
 }
 
 namespace {
@@ -1324,10 +1397,6 @@ class FunctionRange {
   FunctionRange(const Module::Range& range, Module::Function* function) :
       address(range.address), size(range.size), function(function) { }
 
-  void AddLine(Module::Line& line) {
-    function->lines.push_back(line);
-  }
-
   Module::Address address;
   Module::Address size;
   Module::Function* function;
@@ -1370,28 +1439,146 @@ inline bool within(const T& item, Module::Address address) {
   // start of ITEM, or if it falls after ITEM's end.
   return address - item.address < item.size;
 }
-}
 
-void DwarfCUToModule::AssignLinesToFunctions() {
-  vector<Module::Function*>* functions = &cu_context_->functions;
-  WarningReporter* reporter = cu_context_->reporter;
+// Visits a compilation unit's lines in order by address.  The line
+// program emits each sequence's rows in address order, so the lines in
+// the order they were read form a few sorted runs, one per sequence.
+// When those runs don't overlap, visiting them from the lowest starting
+// address to the highest visits every line in order, without sorting or
+// copying the lines.  Where they do overlap, the lines are sorted.
+class SortedLineCursor {
+ public:
+  explicit SortedLineCursor(vector<Module::Line>* lines)
+      : lines_(lines), run_(0), index_(0) {
+    for (size_t begin = 0; begin < lines->size();) {
+      size_t end = begin + 1;
+      // Each row of a sequence ends where the next begins.
+      while (end < lines->size() &&
+             (*lines)[end - 1].address + (*lines)[end - 1].size ==
+                 (*lines)[end].address) {
+        ++end;
+      }
+      runs_.push_back(Run(begin, end));
+      begin = end;
+    }
+    std::stable_sort(runs_.begin(), runs_.end(),
+                     [lines](const Run& a, const Run& b) {
+                       return (*lines)[a.first].address <
+                              (*lines)[b.first].address;
+                     });
+    for (size_t i = 1; i < runs_.size(); ++i) {
+      if ((*lines)[runs_[i - 1].second - 1].address >
+          (*lines)[runs_[i].first].address) {
+        std::sort(lines->begin(), lines->end(),
+                  Module::Line::CompareByAddress);
+        runs_.assign(1, Run(0, lines->size()));
+        break;
+      }
+    }
+    if (!runs_.empty())
+      index_ = runs_[0].first;
+  }
 
-  // This would be simpler if we assumed that source line entries
-  // don't cross function boundaries.  However, there's no real reason
-  // to assume that (say) a series of function definitions on the same
-  // line wouldn't get coalesced into one line number entry.  The
-  // DWARF spec certainly makes no such promises.
-  //
-  // So treat the functions and lines as peers, and take the trouble
-  // to compute their ranges' intersections precisely.  In any case,
-  // the hair here is a constant factor for performance; the
-  // complexity from here on out is linear.
+  // The current line, or NULL if every line has been visited.
+  const Module::Line* line() const {
+    return run_ < runs_.size() ? &(*lines_)[index_] : NULL;
+  }
 
-  // Put both our functions and lines in order by address.
-  std::sort(functions->begin(), functions->end(),
-            Module::Function::CompareByAddress);
-  std::sort(lines_.begin(), lines_.end(), Module::Line::CompareByAddress);
+  // Move on to the next line by address.
+  void Next() {
+    if (++index_ == runs_[run_].second && ++run_ < runs_.size())
+      index_ = runs_[run_].first;
+  }
+
+ private:
+  // The beginning and end of a sorted run of lines.
+  typedef std::pair<size_t, size_t> Run;
+
+  vector<Module::Line>* lines_;
+  vector<Run> runs_;
+  size_t run_;
+  size_t index_;
+};
+
+// Visits lines given as pointers that are already in order by address.
+class LinePointerCursor {
+ public:
+  LinePointerCursor(const Module::Line* const* begin,
+                    const Module::Line* const* end)
+      : it_(begin), end_(end) { }
+
+  const Module::Line* line() const { return it_ != end_ ? *it_ : NULL; }
+  void Next() { ++it_; }
+
+ private:
+  const Module::Line* const* it_;
+  const Module::Line* const* end_;
+};
+
+// Receives the pieces of lines that AssignLinesInRange assigns to
+// functions, and the warnings it raises.
+class LineAssignment {
+ public:
+  virtual ~LineAssignment() { }
+  virtual void AddLine(FunctionRange* range, const Module::Line& line) = 0;
+  virtual void UncoveredFunction(const Module::Function* function) = 0;
+  virtual void UncoveredLine(const Module::Line* line) = 0;
+};
+
+// Adds lines to their functions and reports warnings as they come.
+class DirectLineAssignment : public LineAssignment {
+ public:
+  explicit DirectLineAssignment(DwarfCUToModule::WarningReporter* reporter)
+      : reporter_(reporter) { }
+
+  void AddLine(FunctionRange* range, const Module::Line& line) {
+    range->function->lines.push_back(line);
+  }
+  void UncoveredFunction(const Module::Function* function) {
+    reporter_->UncoveredFunction(*function);
+  }
+  void UncoveredLine(const Module::Line* line) {
+    reporter_->UncoveredLine(*line);
+  }
 
+ private:
+  DwarfCUToModule::WarningReporter* reporter_;
+};
+
+// Records lines and warnings, so that those of address ranges swept on
+// separate threads can be added and reported in address order afterwards.
+class RecordedLineAssignment : public LineAssignment {
+ public:
+  void AddLine(FunctionRange* range, const Module::Line& line) {
+    lines.push_back(std::make_pair(range->function, line));
+  }
+  void UncoveredFunction(const Module::Function* function) {
+    warnings.push_back(Warning(function, NULL));
+  }
+  void UncoveredLine(const Module::Line* line) {
+    warnings.push_back(Warning(NULL, line));
+  }
+
+  // An uncovered function, or an uncovered line.
+  typedef std::pair<const Module::Function*, const Module::Line*> Warning;
+
+  vector<std::pair<Module::Function*, Module::Line> > lines;
+  vector<Warning> warnings;
+};
+
+// Sweeps the function ranges from RANGE_IT to RANGES_END and the lines
+// LINE_IT visits, both in order by address, from CURRENT up to END,
+// handing ASSIGNMENT the piece of each line that falls in each range.
+// CURRENT must be the start of the first range or line, or an address at
+// which a range starts after all earlier ranges have ended; in the
+// latter case, LINE_IT must start at the first line reaching CURRENT.
+template <typename LineCursor>
+void AssignLinesInRange(vector<FunctionRange>::iterator range_it,
+                        vector<FunctionRange>::iterator ranges_end,
+                        LineCursor* line_it,
+                        Module::Address current,
+                        Module::Address end,
+                        LineAssignment* assignment) {
   // The last line that we used any piece of.  We use this only for
   // generating warnings.
   const Module::Line* last_line_used = NULL;
@@ -1401,45 +1588,10 @@ void DwarfCUToModule::AssignLinesToFunctions() {
   const Module::Function* last_function_cited = NULL;
   const Module::Line* last_line_cited = NULL;
 
-  // Prepare a sorted list of ranges with range-to-function mapping
-  vector<FunctionRange> sorted_ranges;
-  FillSortedFunctionRanges(sorted_ranges, functions);
-
-  // Make a single pass through both the range and line vectors from lower to
-  // higher addresses, populating each range's function lines vector with lines
-  // from our lines_ vector that fall within the range.
-  vector<FunctionRange>::iterator range_it = sorted_ranges.begin();
-  vector<Module::Line>::const_iterator line_it = lines_.begin();
-
-  Module::Address current;
-
-  // Pointers to the referents of func_it and line_it, or NULL if the
+  // Pointers to the referents of range_it and line_it, or NULL if the
   // iterator is at the end of the sequence.
-  FunctionRange* range;
-  const Module::Line* line;
-
-  // Start current at the beginning of the first line or function,
-  // whichever is earlier.
-  if (range_it != sorted_ranges.end() && line_it != lines_.end()) {
-    range = &*range_it;
-    line = &*line_it;
-    current = std::min(range->address, line->address);
-  } else if (line_it != lines_.end()) {
-    range = NULL;
-    line = &*line_it;
-    current = line->address;
-  } else if (range_it != sorted_ranges.end()) {
-    range = &*range_it;
-    line = NULL;
-    current = range->address;
-  } else {
-    return;
-  }
-
-  // Some dwarf producers handle linker-removed functions by using -1 as a
-  // tombstone in the line table. So the end marker can be -1.
-  if (current == Module::kMaxAddress)
-    return;
+  FunctionRange* range = range_it != ranges_end ? &*range_it : NULL;
+  const Module::Line* line = line_it->line();
 
   while (range || line) {
     // This loop has two invariants that hold at the top.
@@ -1489,12 +1641,12 @@ void DwarfCUToModule::AssignLinesToFunctions() {
         Module::Line l = *line;
         l.address = current;
         l.size = next_transition - current;
-        range->AddLine(l);
+        assignment->AddLine(range, l);
         last_line_used = line;
       } else {
         // Covered by a range, but no line.
         if (range->function != last_function_cited) {
-          reporter->UncoveredFunction(*(range->function));
+          assignment->UncoveredFunction(range->function);
           last_function_cited = range->function;
         }
         if (line && within(*range, line->address))
@@ -1520,7 +1672,7 @@ void DwarfCUToModule::AssignLinesToFunctions() {
             && !(range
                  && line == last_line_used
                  && range->address - line->address == line->size)) {
-          reporter->UncoveredLine(*line);
+          assignment->UncoveredLine(line);
           last_line_cited = line;
         }
         if (range && within(*line, range->address))
@@ -1549,24 +1701,25 @@ void DwarfCUToModule::AssignLinesToFunctions() {
     // each place we compute next_transition.
 
     // Some dwarf producers handle linker-removed functions by using -1 as a
-    // tombstone in the line table. So the end marker can be -1.
-    if (!next_transition || next_transition == Module::kMaxAddress)
+    // tombstone in the line table. So the end marker can be -1, which is
+    // END when sweeping to the end of the address space.
+    if (!next_transition || next_transition >= end)
       break;
 
     // Advance iterators as needed. If lines overlap or functions overlap,
     // then we could go around more than once. We don't worry too much
     // about what result we produce in that case, just as long as we don't
     // hang or crash.
-    while (range_it != sorted_ranges.end()
+    while (range_it != ranges_end
            && next_transition >= range_it->address
            && !within(*range_it, next_transition))
       range_it++;
-    range = (range_it != sorted_ranges.end()) ? &(*range_it) : NULL;
-    while (line_it != lines_.end()
-           && next_transition >= line_it->address
-           && !within(*line_it, next_transition))
-      line_it++;
-    line = (line_it != lines_.end()) ? &*line_it : NULL;
+    range = (range_it != ranges_end) ? &(*range_it) : NULL;
+    while (line_it->line()
+           && next_transition >= line_it->line()->address
+           && !within(*line_it->line(), next_transition))
+      line_it->Next();
+    line = line_it->line();
 
     // We must make progress.
     assert(next_transition > current);
@@ -1574,13 +1727,151 @@ void DwarfCUToModule::AssignLinesToFunctions() {
   }
 }
 
+// The fewest function ranges worth sweeping on a thread of their own.
+const size_t kMinRangesPerThread = 4096;
+
+// Return the indices at which to split RANGES, which are sorted by
+// address, into pieces to sweep on up to THREAD_COUNT threads, or no
+// indices if there are too few ranges to be worth it.  Each piece starts
+// with a range that starts after every earlier range ends.
+vector<size_t> SplitFunctionRanges(const vector<FunctionRange>& ranges,
+                                   int thread_count) {
+  vector<size_t> splits;
+  size_t pieces = std::min(static_cast<size_t>(std::max(thread_count, 1)),
+                           ranges.size() / kMinRangesPerThread);
+  if (pieces < 2)
+    return splits;
+  Module::Address end = 0;
+  for (size_t i = 0; i < ranges.size() && splits.size() + 1 < pieces; ++i) {
+    if (i >= (splits.size() + 1) * ranges.size() / pieces &&
+        ranges[i].address >= end) {
+      splits.push_back(i);
+    }
+    Module::Address range_end = ranges[i].address + ranges[i].size;
+    if (range_end < ranges[i].address)
+      range_end = Module::kMaxAddress;
+    end = std::max(end, range_end);
+  }
+  return splits;
+}
+}
+
+void DwarfCUToModule::AssignLinesToFunctions() {
+  vector<Module::Function*>* functions = &cu_context_->functions;
+  WarningReporter* reporter = cu_context_->reporter;
+
+  // This would be simpler if we assumed that source line entries
+  // don't cross function boundaries.  However, there's no real reason
+  // to assume that (say) a series of function definitions on the same
+  // line wouldn't get coalesced into one line number entry.  The
+  // DWARF spec certainly makes no such promises.
+  //
+  // So treat the functions and lines as peers, and take the trouble
+  // to compute their ranges' intersections precisely.  In any case,
+  // the hair here is a constant factor for performance; the
+  // complexity from here on out is linear.
+
+  // Put both our functions and lines in order by address.
+  std::sort(functions->begin(), functions->end(),
+            Module::Function::CompareByAddress);
+  SortedLineCursor line_it(&lines_);
+
+  // Prepare a sorted list of ranges with range-to-function mapping
+  vector<FunctionRange> sorted_ranges;
+  FillSortedFunctionRanges(sorted_ranges, functions);
+
+  // Start current at the beginning of the first line or function,
+  // whichever is earlier.
+  Module::Address current;
+  if (!sorted_ranges.empty() && line_it.line())
+    current = std::min(sorted_ranges[0].address, line_it.line()->address);
+  else if (line_it.line())
+    current = line_it.line()->address;
+  else if (!sorted_ranges.empty())
+    current = sorted_ranges[0].address;
+  else
+    return;
+
+  // Some dwarf producers handle linker-removed functions by using -1 as a
+  // tombstone in the line table. So the end marker can be -1.
+  if (current == Module::kMaxAddress)
+    return;
+
+  // Make a single pass through both the range and line vectors from lower to
+  // higher addresses, populating each range's function lines vector with lines
+  // from our lines_ vector that fall within the range.
+  vector<size_t> splits =
+      SplitFunctionRanges(sorted_ranges,
+                          cu_context_->file_context->thread_count_);
+  if (splits.empty()) {
+    DirectLineAssignment assignment(reporter);
+    AssignLinesInRange(sorted_ranges.begin(), sorted_ranges.end(), &line_it,
+                       current, Module::kMaxAddress, &assignment);
+    return;
+  }
+
+  // Otherwise, make a pass through each piece of the address space on a
+  // thread of its own, then add the lines and report the warnings in
+  // address order, as a single pass would have.
+  vector<const Module::Line*> sorted_lines;
+  sorted_lines.reserve(lines_.size());
+  for (; line_it.line(); line_it.Next())
+    sorted_lines.push_back(line_it.line());
+  vector<size_t> bounds(1, 0);
+  bounds.insert(bounds.end(), splits.begin(), splits.end());
+  bounds.push_back(sorted_ranges.size());
+  const size_t piece_count = bounds.size() - 1;
+  vector<RecordedLineAssignment> assignments(piece_count);
+  auto sweep = [&](size_t piece) {
+    Module::Address start =
+        piece == 0 ? current : sorted_ranges[bounds[piece]].address;
+    Module::Address end = piece + 1 < piece_count
+                              ? sorted_ranges[bounds[piece + 1]].address
+                              : Module::kMaxAddress;
+    // The first line that reaches START.
+    size_t first = std::lower_bound(
+        sorted_lines.begin(), sorted_lines.end(), start,
+        [](const Module::Line* line, Module::Address address) {
+          return line->address < address;
+        }) - sorted_lines.begin();
+    while (first > 0 && within(*sorted_lines[first - 1], start))
+      --first;
+    LinePointerCursor cursor(sorted_lines.data() + first,
+                             sorted_lines.data() + sorted_lines.size());
+    AssignLinesInRange(sorted_ranges.begin() + bounds[piece],
+                       sorted_ranges.begin() + bounds[piece + 1], &cursor,
+                       start, end, &assignments[piece]);
+  };
+  vector<std::thread> threads;
+  for (size_t piece = 1; piece < piece_count; ++piece)
+    threads.push_back(std::thread(sweep, piece));
+  sweep(0);
+  for (std::thread& thread : threads)
+    thread.join();
+
+  const Module::Function* last_function_cited = NULL;
+  const Module::Line* last_line_cited = NULL;
+  for (const RecordedLineAssignment& assignment : assignments) {
+    for (const auto& line : assignment.lines)
+      line.first->lines.push_back(line.second);
+    for (const RecordedLineAssignment::Warning& warning :
+         assignment.warnings) {
+      if (warning.first && warning.first != last_function_cited) {
+        reporter->UncoveredFunction(*warning.first);
+        last_function_cited = warning.first;
+      } else if (warning.second && warning.second != last_line_cited) {
+        reporter->UncoveredLine(*warning.second);
+        last_line_cited = warning.second;
+      }
+    }
+  }
+}
+
 void DwarfCUToModule::AssignFilesToInlines() {
   // Assign File* to Inlines inside this CU.
-  auto assignFile = [this](unique_ptr<Module::Inline>& in) {
-    in->call_site_file = files_[in->call_site_file_id];
-  };
   for (auto func : cu_context_->functions) {
-    Module::Inline::InlineDFS(func->inlines, assignFile);
+    for (Module::Inline& in : func->inlines)
+      in.call_site_file = files_[in.call_site_file_id];
   }
 }
 
@@ -1593,9 +1884,12 @@ void DwarfCUToModule::Finish() {
   if (!cu_context_->language->HasFunctions())
     return;
 
-  // Read source line info, if we have any.
-  if (has_source_line_info_)
-    ReadSourceLines(source_line_offset_);
+  // Read source line info, if we have any and it wasn't read while the
+  // DIEs were walked.
+  if (line_reader_clone_.get())
+    FinishSourceLines();
+  else if (has_source_line_info_)
+    ReadSourceLines(source_line_offset_, false);
 
   vector<Module::Function*>* functions = &cu_context_->functions;
 
@@ -1604,6 +1898,17 @@ void DwarfCUToModule::Finish() {
 
   AssignFilesToInlines();
 
+  // Hand our functions to whoever is collecting this unit's, if anyone.
+  vector<Module::Function*>* unit_functions =
+      cu_context_->file_context->unit_functions_;
+  if (unit_functions) {
+    unit_functions->insert(unit_functions->end(), functions->begin(),
+                           functions->end());
+    functions->clear();
+    cu_context_->file_context->ClearSpecifications();
+    return;
+  }
+
   // Add our functions, which now have source lines assigned to them,
   // to module_, and remove duplicate functions.
   for (Module::Function* func : *functions)
@@ -1628,6 +1933,10 @@ bool DwarfCUToModule::StartCompilationUnit(uint64_t offset,
                                            uint64_t cu_length,
                                            uint8_t dwarf_version) {
   cu_context_->version = dwarf_version;
+  // CU_LENGTH excludes the initial length field, which is 12 bytes long in
+  // the 64-bit DWARF format and 4 bytes long otherwise.
+  cu_context_->end_offset =
+      offset + cu_length + (offset_size == 8 ? 12 : 4);
   return dwarf_version >= 2;
 }
 
@@ -41,6 +41,7 @@
 #include <stdint.h>
 
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "common/language.h"
@@ -92,9 +93,37 @@ class DwarfCUToModule: public RootDIEHandler {
 
     const SectionMap& section_map() const;
 
+    // Have each compilation unit's functions appended to FUNCTIONS when
+    // the unit is finished, instead of being added to the module.  The
+    // caller takes ownership of them, and adds them to a module itself.
+    // This lets units be converted into separate modules and merged.
+    void set_unit_functions(vector<Module::Function*>* functions);
+
+    // Demangle linkage names through CACHE, which may be shared with other
+    // contexts, even on other threads.  Not owned.
+    void set_demangle_cache(DemangleCache* cache) { demangle_cache_ = cache; }
+
+    // Let each compilation unit use up to COUNT threads: one reads the
+    // unit's line program while its DIEs are walked, if the
+    // LineToModuleHandler can be cloned, and lines are assigned to
+    // functions over up to COUNT address ranges at once.  This is for
+    // units too large to share the work out between, such as the single
+    // unit of a program built with LTO.  The default is 1.
+    void set_thread_count(int count) { thread_count_ = count; }
+
+    // Returns true if a DW_AT_specification or DW_AT_abstract_origin
+    // attribute in any unit converted with this context referred to a DIE
+    // outside its own unit.
+    bool has_inter_cu_refs() const { return has_inter_cu_refs_; }
+
    private:
     friend class DwarfCUToModule;
 
+    // Notes a reference to the DIE at OFFSET from the compilation unit
+    // occupying [COMPILATION_UNIT_START, COMPILATION_UNIT_END).
+    void NoteReference(uint64_t offset, uint64_t compilation_unit_start,
+                       uint64_t compilation_unit_end);
+
     // Clears all the Specifications if HANDLE_INTER_CU_REFS_ is false.
     void ClearSpecifications();
 
@@ -120,6 +149,20 @@ class DwarfCUToModule: public RootDIEHandler {
     // Inter-compilation unit data used internally by the handlers.
     scoped_ptr<FilePrivate> file_private_;
     std::vector<uint8_t *> uncompressed_sections_;
+
+    // See set_unit_functions.  Not owned; NULL if functions go straight
+    // to the module.
+    vector<Module::Function*>* unit_functions_;
+
+    // See set_demangle_cache.  Not owned; NULL if names are demangled
+    // directly.
+    DemangleCache* demangle_cache_;
+
+    // See has_inter_cu_refs.
+    bool has_inter_cu_refs_;
+
+    // See set_thread_count.
+    int thread_count_;
   };
 
   // An abstract base class for handlers that handle DWARF range lists for
@@ -163,6 +206,12 @@ class DwarfCUToModule: public RootDIEHandler {
                              uint64_t line_string_length,
                              Module* module, vector<Module::Line>* lines,
                              map<uint32_t, Module::File*>* files) = 0;
+
+    // Return a new handler, owned by the caller, that reads line programs
+    // as this one would for the current compilation unit, and that can do
+    // so on another thread while this one is in use.  Return NULL, as
+    // this default does, if the handler can't be cloned.
+    virtual LineToModuleHandler* Clone() const { return NULL; }
   };
 
   // The interface DwarfCUToModule uses to report warnings. The member
@@ -370,8 +419,15 @@ class DwarfCUToModule: public RootDIEHandler {
   // Read source line information at OFFSET in the .debug_line
   // section.  Record source files in module_, but record source lines
   // in lines_; we apportion them to functions in
-  // AssignLinesToFunctions.
-  void ReadSourceLines(uint64_t offset);
+  // AssignLinesToFunctions.  If CONCURRENTLY, start a thread that reads
+  // them with line_reader_clone_, recording files in line_module_, and
+  // return; FinishSourceLines waits for it.
+  void ReadSourceLines(uint64_t offset, bool concurrently);
+
+  // Wait for the thread ReadSourceLines started, if any, point lines_ and
+  // files_ at module_'s files instead of line_module_'s, and release
+  // line_reader_clone_.
+  void FinishSourceLines();
 
   // Assign the lines in lines_ to the individual line lists of the
   // functions in functions_.  (DWARF line information maps an entire
@@ -410,6 +466,12 @@ class DwarfCUToModule: public RootDIEHandler {
 
   // The map from file index to File* in this CU.
   std::map<uint32_t, Module::File*> files_;
+
+  // While the line program is read on line_thread_, the clone of
+  // line_reader_ reading it, and the module it records files in.
+  scoped_ptr<LineToModuleHandler> line_reader_clone_;
+  scoped_ptr<Module> line_module_;
+  std::thread line_thread_;
 };
 
 }  // namespace google_breakpad
@@ -965,6 +965,53 @@ TEST_F(FuncLinePairing, GapThenFunction) {
   TestLine(1, 0, 20, 2, "line-file-2", 174314698);
 }
 
+// Sequences may come in any order; each one's rows are contiguous.
+TEST_F(FuncLinePairing, SequencesOutOfOrder) {
+  PushLine(30, 2, "line-file-3", 137102433);
+  PushLine(32, 2, "line-file-3", 137102434);
+  PushLine(10, 2, "line-file-1", 20293278);
+  PushLine(12, 2, "line-file-1", 20293279);
+  PushLine(20, 4, "line-file-2", 91051467);
+
+  StartCU();
+  DefineFunction(&root_handler_, "function1", 10, 4, NULL);
+  DefineFunction(&root_handler_, "function2", 20, 4, NULL);
+  DefineFunction(&root_handler_, "function3", 30, 4, NULL);
+  root_handler_.Finish();
+
+  TestFunctionCount(3);
+  TestFunction(0, "function1", 10, 4);
+  TestLineCount(0, 2);
+  TestLine(0, 0, 10, 2, "line-file-1", 20293278);
+  TestLine(0, 1, 12, 2, "line-file-1", 20293279);
+  TestFunction(1, "function2", 20, 4);
+  TestLineCount(1, 1);
+  TestLine(1, 0, 20, 4, "line-file-2", 91051467);
+  TestFunction(2, "function3", 30, 4);
+  TestLineCount(2, 2);
+  TestLine(2, 0, 30, 2, "line-file-3", 137102433);
+  TestLine(2, 1, 32, 2, "line-file-3", 137102434);
+}
+
+// Sequences whose addresses interleave are put in order all the same.
+TEST_F(FuncLinePairing, SequencesInterleaved) {
+  PushLine(10, 2, "line-file-1", 20293278);
+  PushLine(20, 2, "line-file-1", 20293279);
+  PushLine(15, 2, "line-file-2", 91051467);
+  EXPECT_CALL(reporter_, UncoveredFunction(_)).WillOnce(Return());
+
+  StartCU();
+  DefineFunction(&root_handler_, "function1", 10, 12, NULL);
+  root_handler_.Finish();
+
+  TestFunctionCount(1);
+  TestFunction(0, "function1", 10, 12);
+  TestLineCount(0, 3);
+  TestLine(0, 0, 10, 2, "line-file-1", 20293278);
+  TestLine(0, 1, 15, 2, "line-file-2", 91051467);
+  TestLine(0, 2, 20, 2, "line-file-1", 20293279);
+}
+
 // If GCC emits padding after one function to align the start of
 // the next, then it will attribute the padding instructions to
 // the last source line of function (to reduce the size of the
@@ -1053,6 +1100,32 @@ TEST_F(FuncLinePairing, WarnOnceLine) {
   TestLine(1, 0, 13, 1, "filename1", 118581871);
 }
 
+// Lines are assigned to functions over several address ranges at once
+// when there are enough functions, with the same result.  Each line
+// covers two functions, so some cross the boundaries between the ranges.
+TEST_F(FuncLinePairing, ManyFunctionsOnThreads) {
+  const int kFunctionCount = 3 * 4096;
+  const Module::Address kBase = 0x10000;
+  file_context_.set_thread_count(4);
+  for (int i = 0; i < kFunctionCount; i += 2)
+    PushLine(kBase + i * 0x10, 0x20, "line-file", i);
+  PushLine(kBase + kFunctionCount * 0x10 + 0x100, 4, "line-file", -1);
+  EXPECT_CALL(reporter_, UncoveredLine(_)).WillOnce(Return());
+
+  StartCU();
+  for (int i = 0; i < kFunctionCount; ++i) {
+    DefineFunction(&root_handler_, "function", kBase + i * 0x10, 0x10,
+                   NULL);
+  }
+  root_handler_.Finish();
+
+  TestFunctionCount(kFunctionCount);
+  for (int i = 0; i < kFunctionCount; ++i) {
+    TestLineCount(i, 1);
+    TestLine(i, 0, kBase + i * 0x10, 0x10, "line-file", i - i % 2);
+  }
+}
+
 class CXXQualifiedNames: public CUFixtureBase,
                          public TestWithParam<DwarfTag> { };
 
@@ -1291,6 +1364,50 @@ TEST_F(Specifications, MangledNameRust) {
                0x93cd3dfc1aa10097ULL, 0x0397d47a0b4ca0d4ULL);
 }
 
+TEST_F(Specifications, MangledNameThroughDemangleCache) {
+  google_breakpad::DemangleCache demangle_cache;
+  file_context_.set_demangle_cache(&demangle_cache);
+  PushLine(0x93cd3dfc1aa10097ULL, 0x0397d47a0b4ca0d4ULL, "line-file", 54883661);
+
+  StartCU();
+  DeclarationDIE(&root_handler_, 0xcd3c51b946fb1eeeLL,
+                 google_breakpad::DW_TAG_subprogram, "declaration-name",
+                 "_ZN1C1fEi");
+  DefinitionDIE(&root_handler_, google_breakpad::DW_TAG_subprogram,
+                0xcd3c51b946fb1eeeLL, "",
+                0x93cd3dfc1aa10097ULL, 0x0397d47a0b4ca0d4ULL);
+  root_handler_.Finish();
+
+  TestFunctionCount(1);
+  TestFunction(0, "C::f(int)",
+               0x93cd3dfc1aa10097ULL, 0x0397d47a0b4ca0d4ULL);
+}
+
+TEST_F(Specifications, RememberedDemangleFailure) {
+  // A name the cache already failed to demangle is still reported.
+  google_breakpad::DemangleCache demangle_cache;
+  string demangled;
+  EXPECT_EQ(google_breakpad::Language::kDemangleFailure,
+            demangle_cache.DemangleName(google_breakpad::Language::CPlusPlus,
+                                        "_Znot-a-name", &demangled));
+  file_context_.set_demangle_cache(&demangle_cache);
+  EXPECT_CALL(reporter_, DemangleError("_Znot-a-name")).Times(1);
+  PushLine(0x93cd3dfc1aa10097ULL, 0x0397d47a0b4ca0d4ULL, "line-file", 54883661);
+
+  StartCU();
+  DeclarationDIE(&root_handler_, 0xcd3c51b946fb1eeeLL,
+                 google_breakpad::DW_TAG_subprogram, "declaration-name",
+                 "_Znot-a-name");
+  DefinitionDIE(&root_handler_, google_breakpad::DW_TAG_subprogram,
+                0xcd3c51b946fb1eeeLL, "",
+                0x93cd3dfc1aa10097ULL, 0x0397d47a0b4ca0d4ULL);
+  root_handler_.Finish();
+
+  TestFunctionCount(1);
+  TestFunction(0, "declaration-name",
+               0x93cd3dfc1aa10097ULL, 0x0397d47a0b4ca0d4ULL);
+}
+
 TEST_F(Specifications, MemberFunction) {
   PushLine(0x3341a248634e7170ULL, 0x5f6938ee5553b953ULL, "line-file", 18116691);
 
@@ -1868,5 +1985,40 @@ TEST_F(Reporter, UnnamedFunction) {
   reporter.UnnamedFunction(0x90c0baff9dedb2d9ULL);
 }
 
+TEST(DemangleCache, ResultsDependOnLanguage) {
+  google_breakpad::DemangleCache demangle_cache;
+  string demangled;
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ(google_breakpad::Language::kDemangleSuccess,
+              demangle_cache.DemangleName(google_breakpad::Language::CPlusPlus,
+                                          "_ZN1C1fEi", &demangled));
+    EXPECT_EQ("C::f(int)", demangled);
+    EXPECT_EQ(google_breakpad::Language::kDontDemangle,
+              demangle_cache.DemangleName(google_breakpad::Language::Java,
+                                          "_ZN1C1fEi", &demangled));
+    EXPECT_EQ("", demangled);
+  }
+}
+
+TEST(DemangleCache, DistinguishesNamesAndRemembersRefusals) {
+  google_breakpad::DemangleCache demangle_cache;
+  string demangled;
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ(google_breakpad::Language::kDemangleSuccess,
+              demangle_cache.DemangleName(google_breakpad::Language::CPlusPlus,
+                                          "_ZN1C1fEi", &demangled));
+    EXPECT_EQ("C::f(int)", demangled);
+    EXPECT_EQ(google_breakpad::Language::kDemangleSuccess,
+              demangle_cache.DemangleName(google_breakpad::Language::CPlusPlus,
+                                          "_ZN1C1gEi", &demangled));
+    EXPECT_EQ("C::g(int)", demangled);
+    EXPECT_EQ(google_breakpad::Language::kDontDemangle,
+              demangle_cache.DemangleName(google_breakpad::Language::CPlusPlus,
+                                          "main", &demangled));
+    EXPECT_EQ("", demangled);
+  }
+}
+
 // Would be nice to also test:
 // - overlapping lines, functions
+
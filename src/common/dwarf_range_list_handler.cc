@@ -56,4 +56,28 @@ void DwarfRangeListHandler::Finish() {
   );
 }
 
+bool DwarfRangeListCache::Lookup(const RangeListReader::CURangesInfo& cu_info,
+                                 uint64_t offset,
+                                 vector<Module::Range>* ranges) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = lists_.find(MakeKey(cu_info, offset));
+  if (it == lists_.end())
+    return false;
+  ranges->insert(ranges->end(), it->second.begin(), it->second.end());
+  return true;
+}
+
+void DwarfRangeListCache::Store(const RangeListReader::CURangesInfo& cu_info,
+                                uint64_t offset,
+                                const vector<Module::Range>& ranges) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lists_.emplace(MakeKey(cu_info, offset), ranges);
+}
+
+DwarfRangeListCache::Key DwarfRangeListCache::MakeKey(
+    const RangeListReader::CURangesInfo& cu_info, uint64_t offset) {
+  return Key(cu_info.buffer_, offset, cu_info.version_,
+             cu_info.base_address_, cu_info.addr_buffer_, cu_info.addr_base_);
+}
+
 } // namespace google_breakpad
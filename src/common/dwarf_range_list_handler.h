@@ -38,6 +38,9 @@
 #ifndef COMMON_LINUX_DWARF_RANGE_LIST_HANDLER_H
 #define COMMON_LINUX_DWARF_RANGE_LIST_HANDLER_H
 
+#include <map>
+#include <mutex>
+#include <tuple>
 #include <vector>
 
 #include "common/module.h"
@@ -66,6 +69,35 @@ class DwarfRangeListHandler: public RangeListHandler {
   vector<Module::Range>* ranges_;
 };
 
+// Range lists decoded once and shared by every unit that refers to them,
+// such as a CU and the functions that reuse its list, or rnglistx and
+// sec_offset references to the same list. Lists are keyed by where they
+// start in their section and by the CU state that their decoding depends
+// on, so units converted on different threads may share a cache.
+class DwarfRangeListCache {
+ public:
+  // If the list at OFFSET in CU_INFO's section has been stored, append
+  // its ranges to RANGES and return true.
+  bool Lookup(const RangeListReader::CURangesInfo& cu_info, uint64_t offset,
+              vector<Module::Range>* ranges) const;
+
+  // Remember RANGES as the decoded list at OFFSET in CU_INFO's section.
+  void Store(const RangeListReader::CURangesInfo& cu_info, uint64_t offset,
+             const vector<Module::Range>& ranges);
+
+ private:
+  // The list's section and offset, the CU's version and base address,
+  // and the CU's .debug_addr section and contribution.
+  typedef std::tuple<const uint8_t*, uint64_t, uint16_t, uint64_t,
+                     const uint8_t*, uint64_t> Key;
+
+  static Key MakeKey(const RangeListReader::CURangesInfo& cu_info,
+                     uint64_t offset);
+
+  mutable std::mutex mutex_;
+  std::map<Key, vector<Module::Range> > lists_;
+};
+
 } // namespace google_breakpad
 
 #endif // COMMON_LINUX_DWARF_RANGE_LIST_HANDLER_H
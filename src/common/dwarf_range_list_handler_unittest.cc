@@ -0,0 +1,134 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dwarf_range_list_handler_unittest.cc: Unit tests for
+// google_breakpad::DwarfRangeListHandler and DwarfRangeListCache.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/dwarf_range_list_handler.h"
+
+using std::vector;
+
+using google_breakpad::DwarfRangeListCache;
+using google_breakpad::DwarfRangeListHandler;
+using google_breakpad::Module;
+using google_breakpad::RangeListReader;
+
+TEST(DwarfRangeListHandler, SortsRanges) {
+  vector<Module::Range> ranges;
+  DwarfRangeListHandler handler(&ranges);
+  handler.AddRange(0x30, 0x38);
+  handler.AddRange(0x10, 0x20);
+  handler.Finish();
+  ASSERT_EQ(2U, ranges.size());
+  EXPECT_EQ(0x10U, ranges[0].address);
+  EXPECT_EQ(0x10U, ranges[0].size);
+  EXPECT_EQ(0x30U, ranges[1].address);
+  EXPECT_EQ(0x8U, ranges[1].size);
+}
+
+class DwarfRangeListCacheTest : public ::testing::Test {
+ public:
+  DwarfRangeListCacheTest() {
+    cu_info.version_ = 5;
+    cu_info.base_address_ = 0x1000;
+    cu_info.buffer_ = section;
+    cu_info.size_ = sizeof(section);
+    list.push_back(Module::Range(0x1010, 0x20));
+    list.push_back(Module::Range(0x1040, 0x8));
+  }
+
+  uint8_t section[64] = {};
+  RangeListReader::CURangesInfo cu_info;
+  vector<Module::Range> list;
+  DwarfRangeListCache cache;
+};
+
+TEST_F(DwarfRangeListCacheTest, Miss) {
+  vector<Module::Range> ranges;
+  EXPECT_FALSE(cache.Lookup(cu_info, 12, &ranges));
+  EXPECT_TRUE(ranges.empty());
+}
+
+TEST_F(DwarfRangeListCacheTest, Hit) {
+  cache.Store(cu_info, 12, list);
+  vector<Module::Range> ranges;
+  ASSERT_TRUE(cache.Lookup(cu_info, 12, &ranges));
+  ASSERT_EQ(2U, ranges.size());
+  EXPECT_EQ(0x1010U, ranges[0].address);
+  EXPECT_EQ(0x20U, ranges[0].size);
+  EXPECT_EQ(0x1040U, ranges[1].address);
+  EXPECT_EQ(0x8U, ranges[1].size);
+}
+
+// A list's offset pairs are relative to the CU's base address, so units
+// with different base addresses must not share its decoding.
+TEST_F(DwarfRangeListCacheTest, KeyedOnCUState) {
+  cache.Store(cu_info, 12, list);
+  vector<Module::Range> ranges;
+  EXPECT_FALSE(cache.Lookup(cu_info, 16, &ranges));
+  RangeListReader::CURangesInfo other = cu_info;
+  other.base_address_ = 0x2000;
+  EXPECT_FALSE(cache.Lookup(other, 12, &ranges));
+  other = cu_info;
+  other.addr_base_ = 8;
+  EXPECT_FALSE(cache.Lookup(other, 12, &ranges));
+  other = cu_info;
+  other.version_ = 4;
+  EXPECT_FALSE(cache.Lookup(other, 12, &ranges));
+  other = cu_info;
+  other.ranges_base_ = 12;
+  EXPECT_TRUE(cache.Lookup(other, 12, &ranges));
+}
+
+TEST_F(DwarfRangeListCacheTest, Threads) {
+  vector<std::thread> threads;
+  for (uint64_t i = 0; i < 4; ++i) {
+    threads.push_back(std::thread([this, i]() {
+      for (uint64_t offset = i; offset < 64; offset += 4) {
+        vector<Module::Range> ranges;
+        if (!cache.Lookup(cu_info, offset, &ranges))
+          cache.Store(cu_info, offset, list);
+      }
+    }));
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  for (uint64_t offset = 0; offset < 64; ++offset) {
+    vector<Module::Range> ranges;
+    EXPECT_TRUE(cache.Lookup(cu_info, offset, &ranges));
+    EXPECT_EQ(2U, ranges.size());
+  }
+}
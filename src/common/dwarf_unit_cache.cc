@@ -0,0 +1,968 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dwarf_unit_cache.cc: Implement google_breakpad::DwarfUnitCache.
+// See dwarf_unit_cache.h for details.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/dwarf_unit_cache.h"
+#include "common/md5.h"
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The version of the digests and of the entries' layout.  Change it
+// whenever either of them, or anything in DwarfCUToModule's conversion,
+// changes, so that older entries are no longer found.
+const uint32_t kFormatVersion = 2;
+
+// The first word of every entry.  An entry written on a machine with the
+// other byte order doesn't start with it.
+const uint32_t kEntryMagic = 0x43555042;  // "BPUC"
+
+// The file index stored for a NULL Module::File pointer.
+const uint32_t kNoFile = 0xffffffff;
+
+template<typename T>
+void Append(string* stream, const T& value) {
+  stream->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(string* stream, const string& str) {
+  Append<uint64_t>(stream, str.size());
+  stream->append(str);
+}
+
+// Whether ATTR, in FORM, holds an offset into a section that
+// DwarfCUToModule either doesn't read, or reads only to find data that
+// UnitHasher records in resolved form.  Such offsets change whenever
+// the units placed before this one do, so they are left out of the
+// digest.
+bool IsSectionOffset(enum DwarfAttribute attr, enum DwarfForm form,
+                     int version) {
+  switch (attr) {
+    case DW_AT_str_offsets_base:
+    case DW_AT_addr_base:
+    case DW_AT_GNU_addr_base:
+    case DW_AT_rnglists_base:
+    case DW_AT_loclists_base:
+    case DW_AT_GNU_ranges_base:
+    case DW_AT_macro_info:
+    case DW_AT_macros:
+    case DW_AT_GNU_macros:
+    case DW_AT_GNU_locviews:
+      return true;
+    // Before DWARF 4, location list pointers used the data forms.
+    case DW_AT_location:
+    case DW_AT_string_length:
+    case DW_AT_return_addr:
+    case DW_AT_data_member_location:
+    case DW_AT_frame_base:
+    case DW_AT_segment:
+    case DW_AT_static_link:
+    case DW_AT_use_location:
+    case DW_AT_vtable_elem_location:
+      if (version < 4 && (form == DW_FORM_data4 || form == DW_FORM_data8))
+        return true;
+      break;
+    default:
+      break;
+  }
+  return form == DW_FORM_sec_offset;
+}
+
+bool IsAddressForm(enum DwarfForm form) {
+  switch (form) {
+    case DW_FORM_addr:
+    case DW_FORM_GNU_addr_index:
+    case DW_FORM_addrx:
+    case DW_FORM_addrx1:
+    case DW_FORM_addrx2:
+    case DW_FORM_addrx3:
+    case DW_FORM_addrx4:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// A Dwarf2Handler that records in a byte stream everything about a
+// compilation unit that its conversion by DwarfCUToModule depends on,
+// and computes the unit's key from the stream.
+class UnitHasher : public Dwarf2Handler {
+ public:
+  UnitHasher(const SectionMap& sections, ByteReader* byte_reader,
+             uint64_t offset, bool handle_inline)
+      : sections_(sections),
+        byte_reader_(byte_reader),
+        offset_(offset),
+        version_(0),
+        tombstone_(0),
+        dies_(0),
+        die_offset_(0),
+        cacheable_(true),
+        largest_reference_(0),
+        unit_low_pc_(0),
+        unit_ranges_base_(0),
+        unit_addr_base_(0),
+        has_lines_(false),
+        line_offset_(0),
+        die_low_pc_is_zero_(false),
+        die_high_pc_(0),
+        discarded_end_(0),
+        omitted_line_end_(0) {
+    Append(&stream_, kFormatVersion);
+    Append<uint8_t>(&stream_, handle_inline);
+  }
+
+  bool StartCompilationUnit(uint64_t offset, uint8_t address_size,
+                            uint8_t offset_size, uint64_t cu_length,
+                            uint8_t dwarf_version) {
+    version_ = dwarf_version;
+    tombstone_ = address_size >= 8 ? Module::kMaxAddress :
+        (uint64_t(1) << (address_size * 8)) - 1;
+    Append(&stream_, address_size);
+    Append(&stream_, offset_size);
+    Append(&stream_, dwarf_version);
+    return true;
+  }
+
+  bool NeedSplitDebugInfo() { return false; }
+
+  bool StartDIE(uint64_t offset, enum DwarfTag tag) {
+    EndAttributes();
+    ++dies_;
+    Append<uint8_t>(&stream_, kDIE);
+    Append<uint64_t>(&stream_, offset - offset_);
+    Append<uint32_t>(&stream_, tag);
+    die_offset_ = offset;
+    return true;
+  }
+
+  void EndDIE(uint64_t offset) {
+    EndAttributes();
+    Append<uint8_t>(&stream_, kEndDIE);
+  }
+
+  void ProcessAttributeUnsigned(uint64_t offset, enum DwarfAttribute attr,
+                                enum DwarfForm form, uint64_t data) {
+    Attribute(attr, form);
+    bool root = dies_ == 1;
+    switch (attr) {
+      case DW_AT_stmt_list:
+        // The line program is recorded once the DIEs are done.
+        if (root) {
+          has_lines_ = true;
+          line_offset_ = data;
+        }
+        return;
+      case DW_AT_ranges: {
+        // The ranges are recorded once the root DIE's bases are known.
+        PendingRanges ranges = { die_offset_, form, data };
+        ranges_.push_back(ranges);
+        return;
+      }
+      case DW_AT_low_pc:
+        if (root)
+          unit_low_pc_ = data;
+        die_low_pc_is_zero_ = data == 0;
+        break;
+      case DW_AT_high_pc:
+        if (!IsAddressForm(form))
+          die_high_pc_ = data;
+        break;
+      case DW_AT_rnglists_base:
+        if (root)
+          unit_ranges_base_ = data;
+        break;
+      case DW_AT_addr_base:
+      case DW_AT_GNU_addr_base:
+        if (root)
+          unit_addr_base_ = data;
+        break;
+      default:
+        break;
+    }
+    if (IsAddressForm(form))
+      Address(data);
+    else if (!IsSectionOffset(attr, form, version_))
+      Append(&stream_, data);
+  }
+
+  void ProcessAttributeSigned(uint64_t offset, enum DwarfAttribute attr,
+                              enum DwarfForm form, int64_t data) {
+    Attribute(attr, form);
+    Append(&stream_, data);
+  }
+
+  void ProcessAttributeReference(uint64_t offset, enum DwarfAttribute attr,
+                                 enum DwarfForm form, uint64_t data) {
+    Attribute(attr, form);
+    // A reference before the unit wraps around to a large value, and is
+    // caught in Finish along with those past its end.
+    uint64_t relative = data - offset_;
+    largest_reference_ = std::max(largest_reference_, relative);
+    Append(&stream_, relative);
+  }
+
+  void ProcessAttributeBuffer(uint64_t offset, enum DwarfAttribute attr,
+                              enum DwarfForm form, const uint8_t* data,
+                              uint64_t len) {
+    // DwarfCUToModule reads no blocks or expressions, which may hold
+    // addresses.
+    Attribute(attr, form);
+  }
+
+  void ProcessAttributeString(uint64_t offset, enum DwarfAttribute attr,
+                              enum DwarfForm form, const string& data) {
+    if (attr == DW_AT_dwo_name || attr == DW_AT_GNU_dwo_name)
+      cacheable_ = false;
+    Attribute(attr, form);
+    AppendString(&stream_, data);
+  }
+
+  void ProcessAttributeSignature(uint64_t offset, enum DwarfAttribute attr,
+                                 enum DwarfForm form, uint64_t signature) {
+    Attribute(attr, form);
+    Append(&stream_, signature);
+  }
+
+  // Record the unit's ranges and lines, now that the LENGTH bytes of the
+  // unit have been read, and set KEY.  Return false if the unit can't be
+  // cached.
+  bool Finish(uint64_t length, DwarfUnitCache::Key* key);
+
+ private:
+  // Markers for the parts of the stream.
+  enum {
+    kDIE = 1,
+    kEndDIE,
+    kAttribute,
+    kAddress,
+    kFixedAddress,
+    kRanges,
+    kMissingRanges,
+    kBadRanges,
+    kLines,
+    kMissingLines,
+    kDirectory,
+    kFile,
+    kLine
+  };
+
+  // A DW_AT_ranges attribute of the DIE at DIE_OFFSET.
+  struct PendingRanges {
+    uint64_t die_offset;
+    enum DwarfForm form;
+    uint64_t data;
+  };
+
+  // Collects the ranges of a range list into the stream.
+  class RangesHasher : public RangeListHandler {
+   public:
+    explicit RangesHasher(UnitHasher* hasher) : hasher_(hasher) { }
+    void AddRange(uint64_t begin, uint64_t end) {
+      hasher_->Range(begin, end);
+    }
+
+   private:
+    UnitHasher* hasher_;
+  };
+
+  // Collects the line program's files and lines into the stream.
+  class LinesHasher : public LineInfoHandler {
+   public:
+    explicit LinesHasher(UnitHasher* hasher) : hasher_(hasher) { }
+    void DefineDir(const string& name, uint32_t dir_num) {
+      Append<uint8_t>(&hasher_->stream_, kDirectory);
+      Append(&hasher_->stream_, dir_num);
+      AppendString(&hasher_->stream_, name);
+    }
+    void DefineFile(const string& name, int32_t file_num, uint32_t dir_num,
+                    uint64_t mod_time, uint64_t length) {
+      Append<uint8_t>(&hasher_->stream_, kFile);
+      Append(&hasher_->stream_, file_num);
+      Append(&hasher_->stream_, dir_num);
+      AppendString(&hasher_->stream_, name);
+    }
+    void AddLine(uint64_t address, uint64_t length, uint32_t file_num,
+                 uint32_t line_num, uint32_t column_num) {
+      hasher_->Line(address, length, file_num, line_num);
+    }
+
+   private:
+    UnitHasher* hasher_;
+  };
+
+  bool IsTombstone(uint64_t address) const {
+    return address >= tombstone_ - 1;
+  }
+
+  void Attribute(enum DwarfAttribute attr, enum DwarfForm form) {
+    Append<uint8_t>(&stream_, kAttribute);
+    Append<uint32_t>(&stream_, attr);
+    Append<uint32_t>(&stream_, form);
+  }
+
+  // Record ADDRESS, which moves with the unit, unless it is one of the
+  // values used for discarded code.
+  void Address(uint64_t address) {
+    if (address == 0 || IsTombstone(address)) {
+      FixedAddress(address);
+      return;
+    }
+    Append<uint8_t>(&stream_, kAddress);
+    addresses_.push_back(std::make_pair(stream_.size(), address));
+    Append<uint64_t>(&stream_, 0);
+  }
+
+  // Record ADDRESS, which belongs to code that was discarded.
+  void FixedAddress(uint64_t address) {
+    Append<uint8_t>(&stream_, kFixedAddress);
+    Append(&stream_, address);
+  }
+
+  // Note that the discarded code at zero extends to END.
+  void Discarded(uint64_t end) {
+    discarded_end_ = std::max(discarded_end_, end);
+  }
+
+  void EndAttributes() {
+    if (die_low_pc_is_zero_)
+      Discarded(die_high_pc_);
+    die_low_pc_is_zero_ = false;
+    die_high_pc_ = 0;
+  }
+
+  void Range(uint64_t begin, uint64_t end) {
+    if (begin == 0 || IsTombstone(begin)) {
+      if (begin == 0)
+        Discarded(end);
+      FixedAddress(begin);
+      FixedAddress(end);
+    } else {
+      Address(begin);
+      Address(end);
+    }
+  }
+
+  // Record a line as DwarfLineToModule::AddLine sees it, treating the
+  // lines it omits as discarded code.
+  void Line(uint64_t address, uint64_t length, uint32_t file_num,
+            uint32_t line_num) {
+    Append<uint8_t>(&stream_, kLine);
+    Append(&stream_, length);
+    Append(&stream_, file_num);
+    Append(&stream_, line_num);
+    if (length != 0 && (address == 0 || address == omitted_line_end_)) {
+      omitted_line_end_ = address + length;
+      Discarded(omitted_line_end_);
+      FixedAddress(address);
+      return;
+    }
+    if (length != 0)
+      omitted_line_end_ = 0;
+    Address(address);
+  }
+
+  void HashRanges();
+  void HashLines();
+
+  const SectionMap& sections_;
+  ByteReader* byte_reader_;
+
+  // The unit's offset in .debug_info, and its header's values.
+  uint64_t offset_;
+  int version_;
+  uint64_t tombstone_;
+
+  // The number of DIEs started so far, and the offset of the last.
+  uint64_t dies_;
+  uint64_t die_offset_;
+
+  bool cacheable_;
+  uint64_t largest_reference_;
+
+  // The root DIE's values needed to read range lists.
+  uint64_t unit_low_pc_;
+  uint64_t unit_ranges_base_;
+  uint64_t unit_addr_base_;
+
+  vector<PendingRanges> ranges_;
+
+  bool has_lines_;
+  uint64_t line_offset_;
+
+  // Whether the current DIE's low_pc is zero, and its high_pc if that is
+  // a length.
+  bool die_low_pc_is_zero_;
+  uint64_t die_high_pc_;
+
+  // The end of the highest discarded code at zero found so far.
+  uint64_t discarded_end_;
+
+  // See DwarfLineToModule::omitted_line_end_.
+  uint64_t omitted_line_end_;
+
+  string stream_;
+
+  // The positions in stream_ of the addresses that move with the unit,
+  // with their values.
+  vector<std::pair<size_t, uint64_t>> addresses_;
+};
+
+void UnitHasher::HashRanges() {
+  for (const PendingRanges& ranges : ranges_) {
+    Append<uint8_t>(&stream_, kRanges);
+    Append<uint64_t>(&stream_, ranges.die_offset - offset_);
+    // As DwarfCUToModule::CUContext::AssembleRangeListInfo does.
+    RangeListReader::CURangesInfo info;
+    info.version_ = version_;
+    info.base_address_ = unit_low_pc_;
+    info.ranges_base_ = unit_ranges_base_;
+    SectionMap::const_iterator section = GetSectionByName(
+        sections_, version_ <= 4 ? ".debug_ranges" : ".debug_rnglists");
+    SectionMap::const_iterator addr = GetSectionByName(sections_,
+                                                       ".debug_addr");
+    if (section == sections_.end() ||
+        (version_ > 4 && addr == sections_.end())) {
+      Append<uint8_t>(&stream_, kMissingRanges);
+      continue;
+    }
+    info.buffer_ = section->second.first;
+    info.size_ = section->second.second;
+    if (version_ > 4) {
+      info.addr_buffer_ = addr->second.first;
+      info.addr_buffer_size_ = addr->second.second;
+      info.addr_base_ = unit_addr_base_;
+    }
+    RangesHasher handler(this);
+    RangeListReader reader(byte_reader_, &info, &handler);
+    if (!reader.ReadRanges(ranges.form, ranges.data))
+      Append<uint8_t>(&stream_, kBadRanges);
+  }
+}
+
+void UnitHasher::HashLines() {
+  if (!has_lines_)
+    return;
+  // As DwarfCUToModule::ReadSourceLines does.
+  SectionMap::const_iterator lines = GetSectionByName(sections_,
+                                                      ".debug_line");
+  if (lines == sections_.end() || line_offset_ >= lines->second.second) {
+    Append<uint8_t>(&stream_, kMissingLines);
+    return;
+  }
+  const uint8_t* strings = NULL;
+  uint64_t strings_length = 0;
+  SectionMap::const_iterator section = GetSectionByName(sections_,
+                                                        ".debug_str");
+  if (section != sections_.end()) {
+    strings = section->second.first;
+    strings_length = section->second.second;
+  }
+  const uint8_t* line_strings = NULL;
+  uint64_t line_strings_length = 0;
+  section = GetSectionByName(sections_, ".debug_line_str");
+  if (section != sections_.end()) {
+    line_strings = section->second.first;
+    line_strings_length = section->second.second;
+  }
+  Append<uint8_t>(&stream_, kLines);
+  LinesHasher handler(this);
+  LineInfo reader(lines->second.first + line_offset_,
+                  lines->second.second - line_offset_, byte_reader_,
+                  strings, strings_length, line_strings, line_strings_length,
+                  &handler);
+  reader.Start();
+}
+
+bool UnitHasher::Finish(uint64_t length, DwarfUnitCache::Key* key) {
+  if (!cacheable_ || largest_reference_ >= length)
+    return false;
+  EndAttributes();
+  HashRanges();
+  HashLines();
+
+  // Take the addresses relative to the lowest, unless the unit's code
+  // could extend down to the discarded code at zero, or up to the
+  // tombstones, in which case moving it might change how it converts.
+  uint64_t base = 0;
+  if (!addresses_.empty()) {
+    uint64_t lowest = Module::kMaxAddress;
+    uint64_t highest = 0;
+    for (const auto& address : addresses_) {
+      lowest = std::min(lowest, address.second);
+      highest = std::max(highest, address.second);
+    }
+    if (lowest > discarded_end_ && highest < tombstone_ / 2)
+      base = lowest;
+  }
+  Append<uint8_t>(&stream_, base != 0);
+  for (const auto& address : addresses_) {
+    uint64_t value = address.second - base;
+    memcpy(&stream_[address.first], &value, sizeof(value));
+  }
+
+  MD5Context context;
+  MD5Init(&context);
+  MD5Update(&context, reinterpret_cast<const unsigned char*>(stream_.data()),
+            stream_.size());
+  unsigned char digest[16];
+  MD5Final(digest, &context);
+  char hex[sizeof(digest) * 2 + 1];
+  for (size_t i = 0; i < sizeof(digest); ++i)
+    snprintf(hex + i * 2, 3, "%02x", digest[i]);
+  key->digest = hex;
+  key->base = base;
+  key->offset = offset_;
+  return true;
+}
+
+}  // namespace
+
+// Writes the entry for a unit whose key is KEY.
+class DwarfUnitCache::EntryWriter {
+ public:
+  EntryWriter(const DwarfUnitCache::Key& key,
+              const Module::InlineOriginMap* origins)
+      : key_(key), ok_(true) {
+    if (origins) {
+      for (const auto& origin : origins->inline_origins_)
+        origin_offsets_[origin.second] = origin.first;
+    }
+  }
+
+  // Append the entry for FUNCTIONS, with ORIGINS' inline origins, to
+  // ENTRY.  Return false if any of it can't be stored.
+  bool Write(const Module::InlineOriginMap* origins,
+             const vector<Module::Function*>& functions, string* entry);
+
+ private:
+  // Append ADDRESS relative to the key's base.
+  void Address(Module::Address address) {
+    if (address < key_.base)
+      ok_ = false;
+    Append(&body_, address - key_.base);
+  }
+
+  // Append OFFSET relative to the unit's start.
+  void Offset(uint64_t offset) {
+    if (offset < key_.offset)
+      ok_ = false;
+    Append(&body_, offset - key_.offset);
+  }
+
+  void File(const Module::File* file) {
+    if (!file) {
+      Append(&body_, kNoFile);
+      return;
+    }
+    auto inserted = file_indices_.insert(
+        std::make_pair(file, static_cast<uint32_t>(files_.size())));
+    if (inserted.second)
+      files_.push_back(file);
+    Append(&body_, inserted.first->second);
+  }
+
+  void Ranges(const vector<Module::Range>& ranges) {
+    Ranges(ranges.data(), ranges.size());
+  }
+
+  void Ranges(const Module::Range* ranges, size_t count) {
+    Append<uint64_t>(&body_, count);
+    for (size_t i = 0; i < count; ++i) {
+      Address(ranges[i].address);
+      Append(&body_, ranges[i].size);
+    }
+  }
+
+  void Inlines(const Module::InlineList& inlines);
+
+  const DwarfUnitCache::Key& key_;
+  bool ok_;
+  std::map<const Module::InlineOrigin*, uint64_t> origin_offsets_;
+  std::map<const Module::File*, uint32_t> file_indices_;
+  vector<const Module::File*> files_;
+  string body_;
+};
+
+void DwarfUnitCache::EntryWriter::Inlines(
+    const Module::InlineList& inlines) {
+  Append<uint64_t>(&body_, inlines.size());
+  for (const Module::Inline& in : inlines) {
+    auto origin = origin_offsets_.find(in.origin);
+    if (origin == origin_offsets_.end()) {
+      ok_ = false;
+      return;
+    }
+    Offset(origin->second);
+    Append<int32_t>(&body_, in.parent);
+    Ranges(inlines.ranges(in), in.range_count);
+    Append<int32_t>(&body_, in.call_site_line);
+    Append<int32_t>(&body_, in.call_site_file_id);
+    File(in.call_site_file);
+    Append<int32_t>(&body_, in.inline_nest_level);
+  }
+}
+
+bool DwarfUnitCache::EntryWriter::Write(const Module::InlineOriginMap* origins,
+                        const vector<Module::Function*>& functions,
+                        string* entry) {
+  if (origins) {
+    Append<uint64_t>(&body_, origins->inline_origins_.size());
+    for (const auto& origin : origins->inline_origins_) {
+      Offset(origin.first);
+      AppendString(&body_, origin.second->name.str());
+    }
+    Append<uint64_t>(&body_, origins->references_.size());
+    for (const auto& reference : origins->references_) {
+      Offset(reference.first);
+      Offset(reference.second);
+    }
+  } else {
+    Append<uint64_t>(&body_, 0);
+    Append<uint64_t>(&body_, 0);
+  }
+
+  Append<uint64_t>(&body_, functions.size());
+  for (const Module::Function* function : functions) {
+    if (function->spill_run >= 0)
+      return false;
+    AppendString(&body_, function->name.str());
+    Address(function->address);
+    Append(&body_, function->parameter_size);
+    Append<uint8_t>(&body_, function->is_multiple);
+    Append<uint8_t>(&body_, function->prefer_extern_name);
+    Ranges(function->ranges);
+    Append<uint64_t>(&body_, function->lines.size());
+    for (const Module::Line& line : function->lines) {
+      Address(line.address);
+      Append(&body_, line.size);
+      File(line.file);
+      Append<int32_t>(&body_, line.number);
+    }
+    Inlines(function->inlines);
+  }
+  if (!ok_)
+    return false;
+
+  Append(entry, kEntryMagic);
+  Append(entry, kFormatVersion);
+  Append<uint64_t>(entry, files_.size());
+  for (const Module::File* file : files_)
+    AppendString(entry, file->name);
+  entry->append(body_);
+  return true;
+}
+
+// Reads the entry for a unit whose key is KEY into a unit module.
+class DwarfUnitCache::EntryReader {
+ public:
+  EntryReader(const DwarfUnitCache::Key& key, const string& entry,
+              Module* unit)
+      : key_(key), cursor_(entry.data()), end_(entry.data() + entry.size()),
+        unit_(unit) { }
+
+  // Read the entry, adding its functions to FUNCTIONS and its inline
+  // origins to ORIGINS.  Return false, adding nothing, if the entry is
+  // malformed.
+  bool Read(Module::InlineOriginMap* origins,
+            vector<Module::Function*>* functions);
+
+ private:
+  template<typename T>
+  bool Value(T* value) {
+    if (static_cast<size_t>(end_ - cursor_) < sizeof(*value))
+      return false;
+    memcpy(value, cursor_, sizeof(*value));
+    cursor_ += sizeof(*value);
+    return true;
+  }
+
+  bool String(string* str) {
+    uint64_t size;
+    if (!Value(&size) || size > static_cast<uint64_t>(end_ - cursor_))
+      return false;
+    str->assign(cursor_, size);
+    cursor_ += size;
+    return true;
+  }
+
+  // Read a count of items, each at least MINIMUM_SIZE bytes long.
+  bool Count(size_t minimum_size, uint64_t* count) {
+    return Value(count) &&
+           *count <= static_cast<uint64_t>(end_ - cursor_) / minimum_size;
+  }
+
+  bool Address(Module::Address* address) {
+    if (!Value(address))
+      return false;
+    *address += key_.base;
+    return true;
+  }
+
+  bool Offset(uint64_t* offset) {
+    if (!Value(offset))
+      return false;
+    *offset += key_.offset;
+    return true;
+  }
+
+  bool File(Module::File** file) {
+    uint32_t index;
+    if (!Value(&index))
+      return false;
+    if (index == kNoFile) {
+      *file = NULL;
+      return true;
+    }
+    if (index >= files_.size())
+      return false;
+    *file = files_[index];
+    return true;
+  }
+
+  bool Ranges(vector<Module::Range>* ranges);
+  bool Inlines(Module::InlineList* inlines);
+
+  const DwarfUnitCache::Key& key_;
+  const char* cursor_;
+  const char* end_;
+  Module* unit_;
+  vector<Module::File*> files_;
+  std::map<uint64_t, Module::InlineOrigin*> origins_;
+};
+
+bool DwarfUnitCache::EntryReader::Ranges(vector<Module::Range>* ranges) {
+  uint64_t count;
+  if (!Count(sizeof(uint64_t) * 2, &count))
+    return false;
+  ranges->reserve(count);
+  for (uint64_t i = 0; i < count; ++i) {
+    Module::Address address, size;
+    if (!Address(&address) || !Value(&size))
+      return false;
+    ranges->push_back(Module::Range(address, size));
+  }
+  return true;
+}
+
+bool DwarfUnitCache::EntryReader::Inlines(Module::InlineList* inlines) {
+  uint64_t count;
+  if (!Count(1, &count))
+    return false;
+  for (uint64_t i = 0; i < count; ++i) {
+    uint64_t origin_offset;
+    vector<Module::Range> ranges;
+    int32_t parent, call_site_line, call_site_file_id, inline_nest_level;
+    Module::File* call_site_file;
+    if (!Offset(&origin_offset) || !Value(&parent) || !Ranges(&ranges) ||
+        !Value(&call_site_line) || !Value(&call_site_file_id) ||
+        !File(&call_site_file) || !Value(&inline_nest_level))
+      return false;
+    auto origin = origins_.find(origin_offset);
+    if (origin == origins_.end() || parent < -1 ||
+        parent >= static_cast<int64_t>(i))
+      return false;
+    int index = inlines->Add(origin->second, parent, ranges, call_site_line,
+                             call_site_file_id, inline_nest_level);
+    (*inlines)[index].call_site_file = call_site_file;
+  }
+  return true;
+}
+
+bool DwarfUnitCache::EntryReader::Read(Module::InlineOriginMap* origins,
+                       vector<Module::Function*>* functions) {
+  uint32_t magic, version;
+  if (!Value(&magic) || magic != kEntryMagic ||
+      !Value(&version) || version != kFormatVersion)
+    return false;
+
+  uint64_t count;
+  if (!Count(sizeof(uint64_t), &count))
+    return false;
+  for (uint64_t i = 0; i < count; ++i) {
+    string name;
+    if (!String(&name))
+      return false;
+    files_.push_back(unit_->FindFile(name));
+  }
+
+  if (!Count(sizeof(uint64_t) * 2, &count))
+    return false;
+  for (uint64_t i = 0; i < count; ++i) {
+    uint64_t offset;
+    string name;
+    if (!Offset(&offset) || !String(&name) ||
+        origins->inline_origins_.count(offset))
+      return false;
+    // Origins not referred to if the entry turns out to be bad are
+    // harmless, as only those of inlines are written.
+    origins_[offset] = origins->Intern(unit_->AddStringToPool(name));
+  }
+  map<uint64_t, uint64_t> references;
+  if (!Count(sizeof(uint64_t) * 2, &count))
+    return false;
+  for (uint64_t i = 0; i < count; ++i) {
+    uint64_t offset, specification_offset;
+    if (!Offset(&offset) || !Offset(&specification_offset))
+      return false;
+    references[offset] = specification_offset;
+  }
+
+  vector<std::unique_ptr<Module::Function>> read_functions;
+  if (!Count(1, &count))
+    return false;
+  for (uint64_t i = 0; i < count; ++i) {
+    string name;
+    Module::Address address;
+    if (!String(&name) || !Address(&address))
+      return false;
+    std::unique_ptr<Module::Function> function(
+        new Module::Function(unit_->AddStringToPool(name), address));
+    uint8_t is_multiple, prefer_extern_name;
+    if (!Value(&function->parameter_size) || !Value(&is_multiple) ||
+        !Value(&prefer_extern_name) || !Ranges(&function->ranges))
+      return false;
+    function->is_multiple = is_multiple;
+    function->prefer_extern_name = prefer_extern_name;
+    uint64_t line_count;
+    if (!Count(sizeof(uint64_t) * 3, &line_count))
+      return false;
+    function->lines.resize(line_count);
+    for (Module::Line& line : function->lines) {
+      int32_t number;
+      if (!Address(&line.address) || !Value(&line.size) ||
+          !File(&line.file) || !Value(&number))
+        return false;
+      line.number = number;
+    }
+    if (!Inlines(&function->inlines))
+      return false;
+    read_functions.push_back(std::move(function));
+  }
+  if (cursor_ != end_)
+    return false;
+
+  origins->inline_origins_.insert(origins_.begin(), origins_.end());
+  origins->references_.insert(references.begin(), references.end());
+  for (std::unique_ptr<Module::Function>& function : read_functions)
+    functions->push_back(function.release());
+  return true;
+}
+
+bool DwarfUnitCache::ComputeKey(const string& path, const SectionMap& sections,
+                                uint64_t offset, ByteReader* byte_reader,
+                                CompilationUnit::AbbrevCache* abbrev_cache,
+                                Key* key) const {
+  UnitHasher hasher(sections, byte_reader, offset, handle_inline_);
+  CompilationUnit reader(path, sections, offset, byte_reader, &hasher);
+  reader.set_abbrev_cache(abbrev_cache);
+  uint64_t length = reader.Start();
+  if (length == 0 || reader.ShouldProcessSplitDwarf())
+    return false;
+  return hasher.Finish(length, key);
+}
+
+bool DwarfUnitCache::Load(const Key& key, const string& filename,
+                          Module* unit,
+                          vector<Module::Function*>* functions) const {
+  FILE* file = fopen(EntryPath(key).c_str(), "rb");
+  if (!file)
+    return false;
+  string entry;
+  char buffer[1 << 16];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    entry.append(buffer, size);
+  bool read_error = ferror(file);
+  fclose(file);
+  if (read_error)
+    return false;
+
+  EntryReader reader(key, entry, unit);
+  return reader.Read(&unit->inline_origin_maps[filename], functions);
+}
+
+bool DwarfUnitCache::Store(const Key& key, const string& filename,
+                           Module* unit,
+                           const vector<Module::Function*>& functions) const {
+  // DwarfCUToModule only ever fills in the map for the file it reads.
+  const Module::InlineOriginMap* origins = NULL;
+  for (const auto& map : unit->inline_origin_maps) {
+    if (map.first != filename)
+      return false;
+    origins = &map.second;
+  }
+  string entry;
+  EntryWriter writer(key, origins);
+  if (!writer.Write(origins, functions, &entry))
+    return false;
+
+  // Write the entry under a name of its own, and then move it into
+  // place, so that other dumps never see a partial entry.
+  static std::atomic<unsigned> next_temporary(0);
+  string path = EntryPath(key);
+  string temporary = path + ".tmp." + std::to_string(getpid()) + "." +
+                     std::to_string(next_temporary++);
+  FILE* file = fopen(temporary.c_str(), "wb");
+  if (!file)
+    return false;
+  bool written = fwrite(entry.data(), 1, entry.size(), file) == entry.size();
+  if (fclose(file) != 0)
+    written = false;
+  if (!written || rename(temporary.c_str(), path.c_str()) != 0) {
+    unlink(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+string DwarfUnitCache::EntryPath(const Key& key) const {
+  return directory_ + "/" + key.digest;
+}
+
+}  // namespace google_breakpad
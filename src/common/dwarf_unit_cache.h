@@ -0,0 +1,122 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dwarf_unit_cache.h: Define google_breakpad::DwarfUnitCache, which keeps
+// the functions converted from DWARF compilation units in a directory, so
+// that dumping a later build in which a unit is unchanged can reuse them
+// instead of converting the unit again.
+
+#ifndef COMMON_DWARF_UNIT_CACHE_H__
+#define COMMON_DWARF_UNIT_CACHE_H__
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "common/dwarf/bytereader.h"
+#include "common/dwarf/dwarf2reader.h"
+#include "common/module.h"
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+// A unit's entry is named by a digest of everything DwarfCUToModule reads
+// while converting it: its DIEs, with strings, addresses and ranges
+// resolved, and its line program.  Addresses are taken relative to the
+// lowest one of the unit, and DIE offsets relative to the unit's start,
+// so a unit that only moved when the file was relinked keeps its entry;
+// loading the entry moves the functions to the unit's new place.
+//
+// Units that refer to DIEs in other units or use split DWARF get no key.
+// Units whose code overlaps the addresses the toolchain uses for
+// discarded code (zero and the tombstone values) are reused only at the
+// same addresses.
+//
+// An entry holds only the functions, with their lines and inlines, and
+// the inline origins; the warnings DwarfCUToModule gave while converting
+// the unit are not repeated when the entry is loaded.
+//
+// All of the member functions may be called from several threads at once.
+class DwarfUnitCache {
+ public:
+  // The name of a unit's entry, and where the unit lies in the file.
+  struct Key {
+    Key() : base(0), offset(0) { }
+
+    // The hexadecimal digest of the unit's contents.
+    string digest;
+
+    // The address the unit's addresses are relative to in the entry, and
+    // the unit's offset in .debug_info.
+    uint64_t base;
+    uint64_t offset;
+  };
+
+  // Keep the entries in the existing directory DIRECTORY.  HANDLE_INLINE
+  // must match the conversions that the stored functions come from.
+  DwarfUnitCache(const string& directory, bool handle_inline)
+      : directory_(directory), handle_inline_(handle_inline) { }
+
+  // Compute the key of the compilation unit at OFFSET in the .debug_info
+  // section of SECTIONS, which were read from PATH, reading its
+  // abbreviations through ABBREV_CACHE, which may be NULL.  Return false
+  // if the unit can't be cached.
+  bool ComputeKey(const string& path, const SectionMap& sections,
+                  uint64_t offset, ByteReader* byte_reader,
+                  CompilationUnit::AbbrevCache* abbrev_cache,
+                  Key* key) const;
+
+  // Add the functions stored under KEY to FUNCTIONS, built in UNIT as
+  // DwarfCUToModule would have built them for the unit KEY names, with
+  // their inline origins in UNIT's map for FILENAME.  Return false,
+  // adding no functions, if there is no usable entry.
+  bool Load(const Key& key, const string& filename, Module* unit,
+            vector<Module::Function*>* functions) const;
+
+  // Store FUNCTIONS, converted in UNIT from the unit KEY names, with the
+  // inline origins in UNIT's map for FILENAME.  Return false if they
+  // could not be stored.
+  bool Store(const Key& key, const string& filename, Module* unit,
+             const vector<Module::Function*>& functions) const;
+
+ private:
+  // Write and read entries.
+  class EntryWriter;
+  class EntryReader;
+
+  // Return the name of KEY's entry.
+  string EntryPath(const Key& key) const;
+
+  string directory_;
+  bool handle_inline_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_DWARF_UNIT_CACHE_H__
@@ -0,0 +1,256 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dwarf_unit_cache_unittest.cc: Unit tests for
+// google_breakpad::DwarfUnitCache.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/dwarf/bytereader-inl.h"
+#include "common/dwarf/dwarf2reader_test_common.h"
+#include "common/dwarf_unit_cache.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::ByteReader;
+using google_breakpad::DwarfUnitCache;
+using google_breakpad::ENDIANNESS_LITTLE;
+using google_breakpad::Module;
+using google_breakpad::SectionMap;
+using google_breakpad::test_assembler::Label;
+using google_breakpad::test_assembler::kLittleEndian;
+
+using std::vector;
+
+namespace {
+
+// Return the abbreviations used by the units that Unit returns.
+string Abbreviations() {
+  TestAbbrevTable abbrevs;
+  abbrevs.Abbrev(1, google_breakpad::DW_TAG_compile_unit,
+                 google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .Attribute(google_breakpad::DW_AT_low_pc, google_breakpad::DW_FORM_addr)
+      .EndAbbrev()
+      .Abbrev(2, google_breakpad::DW_TAG_subprogram,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .Attribute(google_breakpad::DW_AT_declaration,
+                 google_breakpad::DW_FORM_flag_present)
+      .EndAbbrev()
+      .Abbrev(3, google_breakpad::DW_TAG_subprogram,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_specification,
+                 google_breakpad::DW_FORM_ref4)
+      .Attribute(google_breakpad::DW_AT_low_pc, google_breakpad::DW_FORM_addr)
+      .Attribute(google_breakpad::DW_AT_high_pc,
+                 google_breakpad::DW_FORM_data4)
+      .EndAbbrev()
+      .Abbrev(4, google_breakpad::DW_TAG_variable,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_type, google_breakpad::DW_FORM_ref_addr)
+      .EndAbbrev()
+      .EndTable();
+  string contents;
+  EXPECT_TRUE(abbrevs.GetContents(&contents));
+  return contents;
+}
+
+// Return a compilation unit holding a function named NAME, defined at
+// ADDRESS by a DIE referring to its declaration.  If REFERENCE is not
+// zero, the unit also refers to the DIE at that offset in .debug_info.
+string Unit(const string& name, uint64_t address, uint64_t reference = 0) {
+  TestCompilationUnit info;
+  info.set_format_size(4);
+  info.set_endianness(kLittleEndian);
+  Label start = info.start();
+  start = 0;
+  info.Header(4, Label(0), 8, google_breakpad::DW_UT_compile)
+      .ULEB128(1).AppendCString("unit.cc").D64(address);
+  Label declaration = info.Here();
+  info.ULEB128(2).AppendCString(name)
+      .ULEB128(3).D32(declaration).D64(address).D32(0x40);
+  if (reference)
+    info.ULEB128(4).D32(reference);
+  info.D8(0);
+  info.Finish();
+  string contents;
+  EXPECT_TRUE(info.GetContents(&contents));
+  return contents;
+}
+
+class DwarfUnitCacheTest : public ::testing::Test {
+ public:
+  DwarfUnitCacheTest()
+      : cache_(temp_dir_.path(), false),
+        abbrevs_(Abbreviations()),
+        byte_reader_(ENDIANNESS_LITTLE) { }
+
+  // Compute the key of the unit at OFFSET in the .debug_info section
+  // INFO.
+  bool ComputeKey(const string& info, uint64_t offset,
+                  DwarfUnitCache::Key* key) {
+    SectionMap sections;
+    sections[".debug_info"] = std::make_pair(
+        reinterpret_cast<const uint8_t*>(info.data()), info.size());
+    sections[".debug_abbrev"] = std::make_pair(
+        reinterpret_cast<const uint8_t*>(abbrevs_.data()), abbrevs_.size());
+    return cache_.ComputeKey("file", sections, offset, &byte_reader_, NULL,
+                             key);
+  }
+
+  AutoTempDir temp_dir_;
+  DwarfUnitCache cache_;
+  string abbrevs_;
+  ByteReader byte_reader_;
+};
+
+}  // namespace
+
+TEST_F(DwarfUnitCacheTest, KeyIgnoresPlacement) {
+  string unit = Unit("f", 0x1000);
+  DwarfUnitCache::Key key;
+  ASSERT_TRUE(ComputeKey(unit, 0, &key));
+  EXPECT_EQ(0x1000U, key.base);
+  EXPECT_EQ(0U, key.offset);
+
+  // The same unit, moved to a higher address, after another unit.
+  string info = Unit("g", 0x500) + Unit("f", 0x8000);
+  DwarfUnitCache::Key moved_key;
+  ASSERT_TRUE(ComputeKey(info, unit.size(), &moved_key));
+  EXPECT_EQ(key.digest, moved_key.digest);
+  EXPECT_EQ(0x8000U, moved_key.base);
+  EXPECT_EQ(unit.size(), moved_key.offset);
+
+  DwarfUnitCache::Key renamed_key;
+  ASSERT_TRUE(ComputeKey(Unit("h", 0x1000), 0, &renamed_key));
+  EXPECT_NE(key.digest, renamed_key.digest);
+}
+
+TEST_F(DwarfUnitCacheTest, NoKeyForReferenceToOtherUnit) {
+  string first = Unit("g", 0x500);
+  string info = first + Unit("f", 0x1000, 0xb);
+  DwarfUnitCache::Key key;
+  EXPECT_TRUE(ComputeKey(info, 0, &key));
+  EXPECT_FALSE(ComputeKey(info, first.size(), &key));
+}
+
+TEST_F(DwarfUnitCacheTest, NoRelativeAddressesNearDiscardedCode) {
+  // A unit placed at zero is only reused at zero, since its code can't
+  // be told apart from discarded code.
+  DwarfUnitCache::Key key;
+  ASSERT_TRUE(ComputeKey(Unit("f", 0), 0, &key));
+  EXPECT_EQ(0U, key.base);
+  DwarfUnitCache::Key moved_key;
+  ASSERT_TRUE(ComputeKey(Unit("f", 0x1000), 0, &moved_key));
+  EXPECT_NE(key.digest, moved_key.digest);
+}
+
+TEST_F(DwarfUnitCacheTest, StoreAndLoad) {
+  Module unit("name", "os", "architecture", "id");
+  Module::File* file = unit.FindFile("file.cc");
+  Module::InlineOriginMap& origins = unit.inline_origin_maps["file"];
+  origins.SetReference(0x130, 0x130);
+  Module::InlineOrigin* origin =
+      origins.GetOrCreateInlineOrigin(0x130, unit.AddStringToPool("inlined"));
+  Module::Function* function =
+      new Module::Function(unit.AddStringToPool("f"), 0x1010);
+  function->ranges.push_back(Module::Range(0x1010, 0x40));
+  function->prefer_extern_name = true;
+  Module::Line line = { 0x1020, 0x8, file, 12 };
+  function->lines.push_back(line);
+  vector<Module::Range> inline_ranges(1, Module::Range(0x1024, 0x4));
+  function->inlines.Add(origin, -1, inline_ranges, 7, 1, 0);
+  function->inlines[0].call_site_file = file;
+  vector<Module::Function*> functions(1, function);
+
+  DwarfUnitCache::Key key;
+  key.digest = "0123";
+  key.base = 0x1000;
+  key.offset = 0x100;
+  EXPECT_TRUE(cache_.Store(key, "file", &unit, functions));
+  delete function;
+
+  // Load the unit as if it had moved.
+  key.base = 0x7000;
+  key.offset = 0x300;
+  Module loaded("name", "os", "architecture", "id");
+  vector<Module::Function*> loaded_functions;
+  ASSERT_TRUE(cache_.Load(key, "file", &loaded, &loaded_functions));
+  ASSERT_EQ(1U, loaded_functions.size());
+  std::unique_ptr<Module::Function> loaded_function(loaded_functions[0]);
+  EXPECT_EQ("f", loaded_function->name);
+  EXPECT_EQ(0x7010U, loaded_function->address);
+  EXPECT_TRUE(loaded_function->prefer_extern_name);
+  ASSERT_EQ(1U, loaded_function->ranges.size());
+  EXPECT_EQ(0x7010U, loaded_function->ranges[0].address);
+  EXPECT_EQ(0x40U, loaded_function->ranges[0].size);
+  ASSERT_EQ(1U, loaded_function->lines.size());
+  EXPECT_EQ(0x7020U, loaded_function->lines[0].address);
+  EXPECT_EQ(0x8U, loaded_function->lines[0].size);
+  EXPECT_EQ(loaded.FindExistingFile("file.cc"),
+            loaded_function->lines[0].file);
+  EXPECT_EQ(12, loaded_function->lines[0].number);
+  ASSERT_EQ(1U, loaded_function->inlines.size());
+  const Module::Inline* in = &loaded_function->inlines[0];
+  EXPECT_EQ("inlined", in->origin->name);
+  EXPECT_EQ(in->origin,
+            loaded.inline_origin_maps["file"].GetOrCreateInlineOrigin(
+                0x330, "other"));
+  EXPECT_EQ(-1, in->parent);
+  ASSERT_EQ(1U, in->range_count);
+  EXPECT_EQ(0x7024U, loaded_function->inlines.ranges(*in)[0].address);
+  EXPECT_EQ(7, in->call_site_line);
+  EXPECT_EQ(loaded.FindExistingFile("file.cc"), in->call_site_file);
+
+  key.digest = "4567";
+  EXPECT_FALSE(cache_.Load(key, "file", &loaded, &loaded_functions));
+}
+
+TEST_F(DwarfUnitCacheTest, StoreRejectsAddressBelowBase) {
+  Module unit("name", "os", "architecture", "id");
+  std::unique_ptr<Module::Function> function(
+      new Module::Function(unit.AddStringToPool("f"), 0x800));
+  vector<Module::Function*> functions(1, function.get());
+  DwarfUnitCache::Key key;
+  key.digest = "0123";
+  key.base = 0x1000;
+  EXPECT_FALSE(cache_.Store(key, "file", &unit, functions));
+}
@@ -48,6 +48,7 @@
 #include <rustc_demangle.h>
 #endif
 
+#include <functional>
 #include <limits>
 
 namespace {
@@ -220,4 +221,25 @@ const Language * const Language::Swift = &SwiftLanguageSingleton;
 const Language * const Language::Rust = &RustLanguageSingleton;
 const Language * const Language::Assembler = &AssemblerLanguageSingleton;
 
+Language::DemangleResult DemangleCache::DemangleName(const Language* language,
+                                                     const string& mangled,
+                                                     string* demangled) {
+  Shard& shard = shards_[std::hash<string>()(mangled) % kShardCount];
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const ResultMap& results = shard.results[language];
+    ResultMap::const_iterator it = results.find(mangled);
+    if (it != results.end()) {
+      *demangled = it->second.second;
+      return it->second.first;
+    }
+  }
+
+  Language::DemangleResult result = language->DemangleName(mangled, demangled);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.results[language].insert(
+      std::make_pair(mangled, Result(result, *demangled)));
+  return result;
+}
+
 } // namespace google_breakpad
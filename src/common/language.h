@@ -37,8 +37,11 @@
 #ifndef COMMON_LINUX_LANGUAGE_H__
 #define COMMON_LINUX_LANGUAGE_H__
 
+#include <mutex>
 #include <string>
+#include <utility>
 
+#include "common/unordered.h"
 #include "common/using_std_string.h"
 
 namespace google_breakpad {
@@ -99,6 +102,43 @@ class Language {
                         * const Assembler;
 };
 
+// Remembers the results of Language::DemangleName, so that a name that
+// appears in many compilation units, or in both the debugging information
+// and the symbol table, is demangled only once.  A single cache may be
+// shared by several threads at once; it is split into shards, each with
+// its own lock, so that threads demangling different names seldom wait.
+class DemangleCache {
+ public:
+  DemangleCache() {}
+
+  // Demangle MANGLED as LANGUAGE->DemangleName would, returning the same
+  // result and demangled name.  If MANGLED has been demangled for
+  // LANGUAGE before, return the remembered result instead.
+  Language::DemangleResult DemangleName(const Language* language,
+                                        const string& mangled,
+                                        string* demangled);
+
+ private:
+  typedef std::pair<Language::DemangleResult, string> Result;
+  typedef unordered_map<string, Result> ResultMap;
+
+  static const size_t kShardCount = 16;
+
+  struct Shard {
+    std::mutex mutex;
+    // The results for each language, indexed by mangled name, including
+    // the names the language declined to demangle.  The demangling itself
+    // happens outside the lock, so two threads may both demangle a name
+    // that is not yet here; they reach the same result.
+    unordered_map<const Language*, ResultMap> results;
+  };
+
+  Shard shards_[kShardCount];
+
+  DemangleCache(const DemangleCache&);
+  void operator=(const DemangleCache&);
+};
+
 } // namespace google_breakpad
 
 #endif  // COMMON_LINUX_LANGUAGE_H__
@@ -0,0 +1,219 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// bulk_dump_symbols.cc: Implement DumpSymbolsToStore.  See
+// bulk_dump_symbols.h for details.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "common/linux/bulk_dump_symbols.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "common/module.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The bytes of ELF file that justify giving a file one more thread.
+const off_t kBytesPerThread = 32 << 20;
+
+// A file to dump, and its place in the caller's list.
+struct BulkDumpJob {
+  string binary;
+  off_t size;
+  size_t index;
+};
+
+// Create each directory in RELATIVE_PATH, a '/'-separated path under
+// ROOT, that doesn't exist yet.
+bool MakeDirectories(const string& root, const string& relative_path) {
+  for (size_t slash = relative_path.find('/'); ;
+       slash = relative_path.find('/', slash + 1)) {
+    string path = root + "/" + relative_path.substr(0, slash);
+    if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+      fprintf(stderr, "Could not create directory %s: %s\n", path.c_str(),
+              strerror(errno));
+      return false;
+    }
+    if (slash == string::npos)
+      return true;
+  }
+}
+
+// Dump JOB's symbols into STORE_DIRECTORY, converting them on THREAD_COUNT
+// threads.
+bool DumpToStore(const BulkDumpJob& job,
+                 const string& obj_os,
+                 const std::vector<string>& debug_dirs,
+                 const DumpOptions& options,
+                 int thread_count,
+                 const string& store_directory) {
+  DumpOptions file_options = options;
+  file_options.thread_count = thread_count;
+  Module* module;
+  if (!ReadSymbolData(job.binary, job.binary, obj_os, "", debug_dirs,
+                      file_options, &module)) {
+    fprintf(stderr, "Failed to read symbols from %s\n", job.binary.c_str());
+    return false;
+  }
+  std::unique_ptr<Module> owned_module(module);
+
+  string relative_path = SymbolStorePath(*module);
+  if (!MakeDirectories(store_directory,
+                       relative_path.substr(0, relative_path.rfind('/')))) {
+    return false;
+  }
+  string path = store_directory + "/" + relative_path;
+  // The same module may be listed twice, so name the partial file after
+  // the job writing it.
+  string temporary_path = path + "." + std::to_string(job.index) + ".tmp";
+  std::ofstream stream(temporary_path.c_str());
+  bool written = module->Write(stream, options.symbol_data,
+                               options.preserve_load_address);
+  stream.close();
+  if (!written || stream.fail() ||
+      rename(temporary_path.c_str(), path.c_str()) != 0) {
+    fprintf(stderr, "Failed to write %s\n", path.c_str());
+    unlink(temporary_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+string SymbolStorePath(const Module& module) {
+  return module.name() + "/" + module.identifier() + "/" + module.name() +
+         ".sym";
+}
+
+bool DumpSymbolsToStore(const std::vector<string>& binaries,
+                        const string& obj_os,
+                        const std::vector<string>& debug_dirs,
+                        const DumpOptions& options,
+                        size_t memory_budget,
+                        const string& store_directory,
+                        std::vector<string>* failed_binaries) {
+  std::vector<bool> failed(binaries.size(), false);
+  std::vector<BulkDumpJob> jobs;
+  for (size_t i = 0; i < binaries.size(); ++i) {
+    struct stat st;
+    if (stat(binaries[i].c_str(), &st) != 0) {
+      fprintf(stderr, "Could not access %s: %s\n", binaries[i].c_str(),
+              strerror(errno));
+      failed[i] = true;
+      continue;
+    }
+    BulkDumpJob job = { binaries[i], st.st_size, i };
+    jobs.push_back(job);
+  }
+  // The largest files take longest, so start them first, leaving the
+  // small ones to fill in the threads around them.
+  std::stable_sort(jobs.begin(), jobs.end(),
+                   [](const BulkDumpJob& a, const BulkDumpJob& b) {
+                     return a.size > b.size;
+                   });
+
+  int thread_count = std::max(options.thread_count, 1);
+  std::mutex mutex;
+  std::condition_variable finished;
+  size_t next_job = 0;
+  int free_threads = thread_count;
+  size_t memory_in_use = 0;
+  int running = 0;
+  auto dump_jobs = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (next_job < jobs.size()) {
+      const BulkDumpJob& job = jobs[next_job];
+      size_t job_memory = job.size;
+      if (free_threads == 0 ||
+          (memory_budget && running &&
+           memory_in_use + job_memory > memory_budget)) {
+        finished.wait(lock);
+        continue;
+      }
+      ++next_job;
+      int wanted_threads = 1 + job.size / kBytesPerThread;
+      int job_threads = std::min(free_threads, wanted_threads);
+      // Keep a thread for the files after this one.
+      if (next_job < jobs.size() && job_threads == free_threads &&
+          job_threads > 1) {
+        --job_threads;
+      }
+      free_threads -= job_threads;
+      memory_in_use += job_memory;
+      ++running;
+      lock.unlock();
+
+      bool dumped = DumpToStore(job, obj_os, debug_dirs, options,
+                                job_threads, store_directory);
+
+      lock.lock();
+      free_threads += job_threads;
+      memory_in_use -= job_memory;
+      --running;
+      if (!dumped)
+        failed[job.index] = true;
+      finished.notify_all();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < thread_count && i < static_cast<int>(jobs.size()); ++i)
+    threads.push_back(std::thread(dump_jobs));
+  dump_jobs();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  bool all_dumped = true;
+  for (size_t i = 0; i < binaries.size(); ++i) {
+    if (failed[i]) {
+      all_dumped = false;
+      if (failed_binaries)
+        failed_binaries->push_back(binaries[i]);
+    }
+  }
+  return all_dumped;
+}
+
+}  // namespace google_breakpad
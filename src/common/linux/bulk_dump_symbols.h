@@ -0,0 +1,80 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// bulk_dump_symbols.h: Dump the symbols of many ELF files at once into a
+// symbol store directory.
+
+#ifndef COMMON_LINUX_BULK_DUMP_SYMBOLS_H__
+#define COMMON_LINUX_BULK_DUMP_SYMBOLS_H__
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "common/linux/dump_symbols.h"
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class Module;
+
+// Return the path, relative to a symbol store directory, at which
+// SimpleSymbolSupplier looks for MODULE's symbol file:
+// <debug file>/<identifier>/<debug file>.sym.
+string SymbolStorePath(const Module& module);
+
+// Dump the symbols of each of the ELF files BINARIES, as WriteSymbolFile
+// does, writing each to its SymbolStorePath under STORE_DIRECTORY, which
+// must exist.  Subdirectories are created as needed, and each symbol file
+// is written under a temporary name and then renamed, so readers of the
+// store never see a partial file.
+//
+// OPTIONS.thread_count threads are shared by all the files: files are
+// started largest first, each taking a share of the free threads in
+// proportion to its size for its own parallel stages, but leaving one
+// for the files after it, and smaller files are dumped on the threads
+// that remain.  While MEMORY_BUDGET is nonzero,
+// a file is only started once the sizes of the files being dumped,
+// including it, total at most MEMORY_BUDGET bytes, or nothing else is
+// being dumped.
+//
+// A file that can't be dumped is reported on stderr and added to
+// *FAILED_BINARIES, if that is non-NULL, and the others are dumped anyway.
+// Return true if every file was dumped.
+bool DumpSymbolsToStore(const std::vector<string>& binaries,
+                        const string& obj_os,
+                        const std::vector<string>& debug_dirs,
+                        const DumpOptions& options,
+                        size_t memory_budget,
+                        const string& store_directory,
+                        std::vector<string>* failed_binaries);
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_LINUX_BULK_DUMP_SYMBOLS_H__
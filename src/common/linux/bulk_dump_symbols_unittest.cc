@@ -0,0 +1,168 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// bulk_dump_symbols_unittest.cc: Unit tests for DumpSymbolsToStore.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <elf.h>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/linux/bulk_dump_symbols.h"
+#include "common/linux/dump_symbols.h"
+#include "common/linux/synth_elf.h"
+#include "common/module.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::DumpOptions;
+using google_breakpad::DumpSymbolsToStore;
+using google_breakpad::Module;
+using google_breakpad::ReadSymbolData;
+using google_breakpad::SymbolStorePath;
+using google_breakpad::WriteSymbolFile;
+using google_breakpad::synth_elf::ELF;
+using google_breakpad::synth_elf::StringTable;
+using google_breakpad::synth_elf::SymbolTable;
+using google_breakpad::test_assembler::kLittleEndian;
+using google_breakpad::test_assembler::Section;
+using std::vector;
+
+class BulkDumpSymbols : public ::testing::Test {
+ public:
+  // Write an ELF file at PATH with a text section filled with FILL, whose
+  // contents give the module its identifier, and a public symbol NAME.
+  void WriteELF(const string& path, uint8_t fill, const string& name) {
+    ELF elf(EM_X86_64, ELFCLASS64, kLittleEndian);
+    Section text(kLittleEndian);
+    text.Append(4096, fill);
+    elf.AddSection(".text", text, SHT_PROGBITS);
+    StringTable table(kLittleEndian);
+    SymbolTable syms(kLittleEndian, 8, table);
+    syms.AddSymbol(name, static_cast<uint64_t>(0x1000),
+                   static_cast<uint64_t>(0x10),
+                   ELF32_ST_INFO(STB_GLOBAL, STT_FUNC), SHN_UNDEF + 1);
+    int index = elf.AddSection(".dynstr", table, SHT_STRTAB);
+    elf.AddSection(".dynsym", syms, SHT_DYNSYM, SHF_ALLOC, 0, index,
+                   sizeof(Elf64_Sym));
+    elf.Finish();
+    string contents;
+    ASSERT_TRUE(elf.GetContents(&contents));
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write(contents.data(), contents.size());
+    ASSERT_TRUE(file.good());
+  }
+
+  // Check that STORE holds the same symbol file for BINARY as
+  // WriteSymbolFile produces.
+  void ExpectInStore(const string& store, const string& binary) {
+    DumpOptions options(ALL_SYMBOL_DATA, true, false, false);
+    Module* module;
+    ASSERT_TRUE(ReadSymbolData(binary, binary, "Linux", "", vector<string>(),
+                               options, &module));
+    string path = store + "/" + SymbolStorePath(*module);
+    delete module;
+
+    std::stringstream expected;
+    ASSERT_TRUE(WriteSymbolFile(binary, binary, "Linux", "", vector<string>(),
+                                options, expected));
+    std::ifstream file(path.c_str());
+    ASSERT_TRUE(file.good()) << path;
+    string contents((std::istreambuf_iterator<char>(file)),
+                    std::istreambuf_iterator<char>());
+    EXPECT_EQ(expected.str(), contents);
+  }
+
+  AutoTempDir temp_dir;
+};
+
+TEST_F(BulkDumpSymbols, SymbolStorePath) {
+  Module module("libfoo.so", "Linux", "x86_64", "0123456789ABCDEF0", "");
+  EXPECT_EQ("libfoo.so/0123456789ABCDEF0/libfoo.so.sym",
+            SymbolStorePath(module));
+}
+
+TEST_F(BulkDumpSymbols, DumpsEveryFile) {
+  vector<string> binaries;
+  for (int i = 0; i < 6; ++i) {
+    string path = temp_dir.path() + "/lib" + std::to_string(i) + ".so";
+    WriteELF(path, i + 1, "function" + std::to_string(i));
+    binaries.push_back(path);
+  }
+  string not_elf = temp_dir.path() + "/README";
+  std::ofstream(not_elf.c_str()) << "not an ELF file\n";
+  binaries.insert(binaries.begin() + 2, not_elf);
+  binaries.push_back(temp_dir.path() + "/missing.so");
+
+  string store = temp_dir.path() + "/store";
+  ASSERT_EQ(0, mkdir(store.c_str(), 0755));
+  DumpOptions options(ALL_SYMBOL_DATA, true, false, false);
+  options.thread_count = 4;
+  vector<string> failed;
+  EXPECT_FALSE(DumpSymbolsToStore(binaries, "Linux", vector<string>(),
+                                  options, 0, store, &failed));
+  ASSERT_EQ(2U, failed.size());
+  EXPECT_EQ(not_elf, failed[0]);
+  EXPECT_EQ(temp_dir.path() + "/missing.so", failed[1]);
+
+  for (const string& binary : binaries) {
+    if (binary != failed[0] && binary != failed[1])
+      ExpectInStore(store, binary);
+  }
+}
+
+TEST_F(BulkDumpSymbols, MemoryBudget) {
+  vector<string> binaries;
+  for (int i = 0; i < 3; ++i) {
+    string path = temp_dir.path() + "/lib" + std::to_string(i) + ".so";
+    WriteELF(path, i + 1, "function" + std::to_string(i));
+    binaries.push_back(path);
+  }
+  string store = temp_dir.path() + "/store";
+  ASSERT_EQ(0, mkdir(store.c_str(), 0755));
+  DumpOptions options(ALL_SYMBOL_DATA, true, false, false);
+  options.thread_count = 3;
+  // Every file is over budget, so they are dumped one at a time.
+  EXPECT_TRUE(DumpSymbolsToStore(binaries, "Linux", vector<string>(),
+                                 options, 1, store, NULL));
+  for (const string& binary : binaries)
+    ExpectInStore(store, binary);
+}
+
+}  // namespace
@@ -0,0 +1,103 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// crc32_unittest.cc: Unit tests for the CRC32 routines, checking every
+// implementation against a bit-at-a-time reference.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/linux/crc32.h"
+
+namespace {
+
+using google_breakpad::ComputeCrc32;
+using google_breakpad::UpdateCrc32;
+using std::string;
+using std::vector;
+
+uint32_t ReferenceCrc32(const uint8_t* data, size_t len) {
+  uint32_t c = 0xFFFFFFFF;
+  for (size_t i = 0; i < len; ++i) {
+    c ^= data[i];
+    for (int bit = 0; bit < 8; ++bit)
+      c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+  }
+  return c ^ 0xFFFFFFFF;
+}
+
+vector<uint8_t> MakeData(size_t size) {
+  vector<uint8_t> data(size);
+  uint32_t state = 0x12345678;
+  for (size_t i = 0; i < size; ++i) {
+    state = state * 1103515245 + 12345;
+    data[i] = static_cast<uint8_t>(state >> 16);
+  }
+  return data;
+}
+
+TEST(Crc32, KnownValues) {
+  EXPECT_EQ(0U, ComputeCrc32("", 0));
+  EXPECT_EQ(0xCBF43926U, ComputeCrc32(string("123456789")));
+  EXPECT_EQ(0x414FA339U,
+            ComputeCrc32(string("The quick brown fox jumps over the lazy dog")));
+}
+
+TEST(Crc32, MatchesReference) {
+  // Lengths around every path's block sizes, at every alignment.
+  vector<uint8_t> data = MakeData(600);
+  for (size_t offset = 0; offset < 16; ++offset) {
+    for (size_t len = 0; len + offset <= data.size(); ++len) {
+      ASSERT_EQ(ReferenceCrc32(&data[offset], len),
+                ComputeCrc32(&data[offset], len))
+          << "offset " << offset << " length " << len;
+    }
+  }
+}
+
+TEST(Crc32, Incremental) {
+  vector<uint8_t> data = MakeData(1 << 20);
+  uint32_t expected = ReferenceCrc32(&data[0], data.size());
+  EXPECT_EQ(expected, ComputeCrc32(&data[0], data.size()));
+  const size_t kSplits[] = { 1, 15, 64, 65, 4096, 100000, (1 << 20) - 3 };
+  for (size_t split : kSplits) {
+    uint32_t crc = UpdateCrc32(0, &data[0], split);
+    crc = UpdateCrc32(crc, &data[split], data.size() - split);
+    EXPECT_EQ(expected, crc) << "split " << split;
+  }
+}
+
+}  // namespace
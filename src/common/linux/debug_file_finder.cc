@@ -0,0 +1,241 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// debug_file_finder.cc: Find the debug file that an ELF file was stripped
+// of, by its build id or its .gnu_debuglink section.
+//
+// See debug_file_finder.h for details.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "common/linux/debug_file_finder.h"
+
+#include <elf.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "common/linux/crc32.h"
+#include "common/linux/elfutils.h"
+#include "common/linux/file_id.h"
+#include "common/linux/memory_mapped_file.h"
+#include "common/memory_allocator.h"
+
+namespace google_breakpad {
+
+namespace {
+
+using elf::FileID;
+using elf::kDefaultBuildIdSize;
+
+// Return BUILD_ID as lowercase hex, as debug file paths and debuginfod
+// URLs spell it.
+string BuildIdString(const std::vector<uint8_t>& build_id) {
+  string result;
+  for (uint8_t byte : build_id) {
+    char buf[3];
+    snprintf(buf, sizeof(buf), "%02x", byte);
+    result.append(buf);
+  }
+  return result;
+}
+
+// Given |left_abspath|, find the absolute path for |right_path| and see if the
+// two absolute paths are the same.
+bool IsSameFile(const char* left_abspath, const string& right_path) {
+  char right_abspath[PATH_MAX];
+  if (!realpath(right_path.c_str(), right_abspath))
+    return false;
+  return strcmp(left_abspath, right_abspath) == 0;
+}
+
+// Return true if PATH is an ELF file whose build id is BUILD_ID.
+bool HasBuildId(const string& path, const std::vector<uint8_t>& build_id) {
+  MemoryMappedFile file(path.c_str(), 0);
+  if (!file.data() || file.size() < EI_NIDENT || !IsValidElf(file.data()))
+    return false;
+  PageAllocator allocator;
+  wasteful_vector<uint8_t> file_build_id(&allocator, kDefaultBuildIdSize);
+  return FileID::ElfFileBuildId(file.data(), file_build_id) &&
+         file_build_id.size() == build_id.size() &&
+         std::equal(build_id.begin(), build_id.end(), file_build_id.begin());
+}
+
+// Return true if PATH is an ELF file whose CRC-32 is CRC.
+bool HasCrc(const string& path, uint32_t crc) {
+  MemoryMappedFile file(path.c_str(), 0);
+  if (!file.data())
+    return false;
+  // Something that isn't even an ELF file can't be the debug file, so
+  // don't spend a pass over it.
+  if (file.size() < EI_NIDENT || !IsValidElf(file.data())) {
+    fprintf(stderr, "Not a valid ELF file: %s\n", path.c_str());
+    return false;
+  }
+  madvise(const_cast<void*>(file.data()), file.size(), MADV_SEQUENTIAL);
+  if (ComputeCrc32(file.data(), file.size()) != crc) {
+    fprintf(stderr, "Error reading debug ELF file - CRC32 mismatch: %s\n",
+            path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+string LocalDebugFileFinder::Find(const DebugFileQuery& query) {
+  char obj_file_abspath[PATH_MAX];
+  if (!realpath(query.obj_file.c_str(), obj_file_abspath)) {
+    fprintf(stderr, "Cannot resolve absolute path for %s\n",
+            query.obj_file.c_str());
+    return string();
+  }
+
+  // The candidates, in the order they are preferred, and whether each
+  // is checked by its build id rather than by the debuglink CRC.
+  string build_id = BuildIdString(query.build_id);
+  std::vector<string> paths;
+  std::vector<bool> by_build_id;
+  for (const string& debug_dir : debug_dirs_) {
+    if (build_id.size() > 2) {
+      paths.push_back(debug_dir + "/.build-id/" + build_id.substr(0, 2) + "/" +
+                      build_id.substr(2) + ".debug");
+      by_build_id.push_back(true);
+    }
+    if (!query.debuglink.empty()) {
+      string debuglink_path = debug_dir + "/" + query.debuglink;
+      // There is the annoying case of /path/to/foo.so having foo.so as the
+      // debug link file name. Thus this may end up opening /path/to/foo.so
+      // again, and there is a small chance of the two files having the same
+      // CRC.
+      if (IsSameFile(obj_file_abspath, debuglink_path))
+        continue;
+      paths.push_back(debuglink_path);
+      by_build_id.push_back(false);
+    }
+  }
+
+  // Most candidates don't exist, and the rest are mostly large files to
+  // checksum, so check several at once.  Once a candidate checks out,
+  // those after it needn't be checked.
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> found(paths.size());
+  auto check = [&]() {
+    size_t i;
+    while ((i = next++) < paths.size()) {
+      if (i > found)
+        break;
+      if (access(paths[i].c_str(), R_OK) != 0)
+        continue;
+      bool match = by_build_id[i] ? HasBuildId(paths[i], query.build_id)
+                                  : HasCrc(paths[i], query.debuglink_crc);
+      if (!match)
+        continue;
+      size_t previous = found;
+      while (i < previous && !found.compare_exchange_weak(previous, i)) {}
+    }
+  };
+  size_t thread_count =
+      std::min(paths.size(), static_cast<size_t>(std::max(thread_count_, 1)));
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i)
+    threads.push_back(std::thread(check));
+  check();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  if (found < paths.size())
+    return paths[found];
+
+  fprintf(stderr, "Failed to find debug ELF file for '%s' after trying:\n",
+          query.obj_file.c_str());
+  for (const string& path : paths)
+    fprintf(stderr, "  %s\n", path.c_str());
+  return string();
+}
+
+string DebuginfodFinder::Find(const DebugFileQuery& query) {
+  if (query.build_id.empty())
+    return string();
+  string build_id = BuildIdString(query.build_id);
+  string directory = cache_directory_ + "/" + build_id;
+  string path = directory + "/debuginfo";
+  if (HasBuildId(path, query.build_id))
+    return path;
+  if (server_urls_.empty())
+    return string();
+
+  // Fetch into a file of its own, and only move it into place once it
+  // checks out, so that the cache never holds a partial or wrong file,
+  // even with several dumps sharing it.
+  if ((mkdir(cache_directory_.c_str(), 0755) != 0 && errno != EEXIST) ||
+      (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)) {
+    fprintf(stderr, "Cannot create debuginfod cache directory %s\n",
+            directory.c_str());
+    return string();
+  }
+  string temp_path = path + ".XXXXXX";
+  int fd = mkstemp(&temp_path[0]);
+  if (fd < 0) {
+    fprintf(stderr, "Cannot create a file in %s\n", directory.c_str());
+    return string();
+  }
+  close(fd);
+  for (const string& server_url : server_urls_) {
+    string url = server_url;
+    while (!url.empty() && url[url.size() - 1] == '/')
+      url.erase(url.size() - 1);
+    url += "/buildid/" + build_id + "/debuginfo";
+    if (!fetcher_(url, temp_path))
+      continue;
+    if (!HasBuildId(temp_path, query.build_id)) {
+      fprintf(stderr, "Fetched a debug file with the wrong build id from %s\n",
+              url.c_str());
+      continue;
+    }
+    if (rename(temp_path.c_str(), path.c_str()) == 0)
+      return path;
+  }
+  unlink(temp_path.c_str());
+  fprintf(stderr, "Failed to fetch debug ELF file for '%s' with build id %s\n",
+          query.obj_file.c_str(), build_id.c_str());
+  return string();
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// debug_file_finder.h: Find the debug file that an ELF file was stripped
+// of, by its build id or its .gnu_debuglink section.
+
+#ifndef COMMON_LINUX_DEBUG_FILE_FINDER_H__
+#define COMMON_LINUX_DEBUG_FILE_FINDER_H__
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+// What a stripped ELF file says of its debug file.
+struct DebugFileQuery {
+  DebugFileQuery() : debuglink_crc(0) {}
+
+  // The stripped file.
+  string obj_file;
+  // The contents of its build id note, or empty if it has none.
+  std::vector<uint8_t> build_id;
+  // The file name in its .gnu_debuglink section, and the CRC-32 of the
+  // debug file given with it; empty if it has no such section.
+  string debuglink;
+  uint32_t debuglink_crc;
+};
+
+// An interface for finding debug files.  Finders may be used from any
+// thread, though only one at a time.
+class DebugFileFinder {
+ public:
+  virtual ~DebugFileFinder() {}
+
+  // Return the path of the debug file that QUERY describes, or an empty
+  // string if none is found.
+  virtual string Find(const DebugFileQuery& query) = 0;
+};
+
+// A finder that looks in local directories.  In each directory, in turn,
+// it tries <dir>/.build-id/<xx>/<rest>.debug, named by the build id as
+// GDB names it, and then <dir>/<debuglink>.  The candidates are checked,
+// against the build id or the debuglink CRC, on up to THREAD_COUNT threads
+// at once, but the first of them that checks out is found, as if they
+// were checked one after another.
+class LocalDebugFileFinder : public DebugFileFinder {
+ public:
+  LocalDebugFileFinder(const std::vector<string>& debug_dirs,
+                       int thread_count)
+      : debug_dirs_(debug_dirs), thread_count_(thread_count) {}
+
+  virtual string Find(const DebugFileQuery& query);
+
+ private:
+  std::vector<string> debug_dirs_;
+  int thread_count_;
+};
+
+// A finder that asks debuginfod servers for debug files by their build
+// ids, keeping those it fetches in a cache directory laid out as the
+// debuginfod client's is, <cache>/<build-id>/debuginfo, where it finds
+// them again without asking.
+class DebuginfodFinder : public DebugFileFinder {
+ public:
+  // Fetch URL into the file at PATH, returning true if the server had it.
+  typedef std::function<bool(const string& url, const string& path)> Fetcher;
+
+  // Ask the servers at SERVER_URLS, in turn, using FETCHER, and cache
+  // the debug files found in CACHE_DIRECTORY, which is created if need
+  // be.
+  DebuginfodFinder(const std::vector<string>& server_urls,
+                   const string& cache_directory,
+                   const Fetcher& fetcher)
+      : server_urls_(server_urls),
+        cache_directory_(cache_directory),
+        fetcher_(fetcher) {}
+
+  virtual string Find(const DebugFileQuery& query);
+
+ private:
+  std::vector<string> server_urls_;
+  string cache_directory_;
+  Fetcher fetcher_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_LINUX_DEBUG_FILE_FINDER_H__
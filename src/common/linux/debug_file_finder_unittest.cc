@@ -0,0 +1,258 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// debug_file_finder_unittest.cc: Unit tests for LocalDebugFileFinder and
+// DebuginfodFinder.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <elf.h>
+#include <sys/stat.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/linux/crc32.h"
+#include "common/linux/debug_file_finder.h"
+#include "common/linux/elf_gnu_compat.h"
+#include "common/linux/synth_elf.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/tests/file_utils.h"
+#include "common/using_std_string.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::ComputeCrc32;
+using google_breakpad::CopyFile;
+using google_breakpad::DebugFileQuery;
+using google_breakpad::DebuginfodFinder;
+using google_breakpad::LocalDebugFileFinder;
+using google_breakpad::WriteFile;
+using google_breakpad::synth_elf::ELF;
+using google_breakpad::synth_elf::Notes;
+using google_breakpad::test_assembler::kLittleEndian;
+using google_breakpad::test_assembler::Section;
+using std::vector;
+
+const uint8_t kBuildId[] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+                            0x00, 0x11, 0x22, 0x33};
+const char kBuildIdString[] = "0123456789abcdef00112233";
+const uint8_t kOtherBuildId[] = {0xfe, 0xdc, 0xba, 0x98};
+
+class DebugFileFinderTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    obj_file_ = temp_dir_.path() + "/libfoo.so";
+    ASSERT_TRUE(WriteElf(obj_file_, kBuildId, sizeof(kBuildId), 1));
+    query_.obj_file = obj_file_;
+  }
+
+  // Write an ELF file to PATH, with the given build id, and text filled
+  // with FILL so that files differ.  Make the directories it is in.
+  bool WriteElf(const string& path, const uint8_t* build_id,
+                size_t build_id_size, uint8_t fill) {
+    for (size_t slash = path.find('/', temp_dir_.path().size() + 1);
+         slash != string::npos; slash = path.find('/', slash + 1)) {
+      mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+    ELF elf(EM_386, ELFCLASS64, kLittleEndian);
+    Section text(kLittleEndian);
+    text.Append(64, fill);
+    elf.AddSection(".text", text, SHT_PROGBITS);
+    Notes notes(kLittleEndian);
+    notes.AddNote(NT_GNU_BUILD_ID, "GNU", build_id, build_id_size);
+    elf.AddSection(".note.gnu.build-id", notes, SHT_NOTE);
+    elf.Finish();
+    string contents;
+    if (!elf.GetContents(&contents))
+      return false;
+    contents_ = contents;
+    return WriteFile(path.c_str(), contents.data(), contents.size());
+  }
+
+  // The CRC-32 of the last file WriteElf wrote.
+  uint32_t LastCrc() {
+    return ComputeCrc32(contents_.data(), contents_.size());
+  }
+
+  AutoTempDir temp_dir_;
+  string obj_file_;
+  string contents_;
+  DebugFileQuery query_;
+};
+
+TEST_F(DebugFileFinderTest, LocalFindsByBuildId) {
+  string debug_dir = temp_dir_.path() + "/debug";
+  string expected = debug_dir + "/.build-id/01/23456789abcdef00112233.debug";
+  ASSERT_TRUE(WriteElf(expected, kBuildId, sizeof(kBuildId), 2));
+  query_.build_id.assign(kBuildId, kBuildId + sizeof(kBuildId));
+
+  LocalDebugFileFinder finder(vector<string>(1, debug_dir), 1);
+  EXPECT_EQ(expected, finder.Find(query_));
+}
+
+TEST_F(DebugFileFinderTest, LocalRejectsWrongBuildId) {
+  string debug_dir = temp_dir_.path() + "/debug";
+  ASSERT_TRUE(WriteElf(debug_dir + "/.build-id/01/23456789abcdef00112233.debug",
+                       kOtherBuildId, sizeof(kOtherBuildId), 2));
+  query_.build_id.assign(kBuildId, kBuildId + sizeof(kBuildId));
+
+  LocalDebugFileFinder finder(vector<string>(1, debug_dir), 1);
+  EXPECT_EQ("", finder.Find(query_));
+}
+
+TEST_F(DebugFileFinderTest, LocalFindsByDebuglink) {
+  string debug_dir = temp_dir_.path() + "/debug";
+  string expected = debug_dir + "/libfoo.so.debug";
+  ASSERT_TRUE(WriteElf(expected, kBuildId, sizeof(kBuildId), 2));
+  query_.debuglink = "libfoo.so.debug";
+  query_.debuglink_crc = LastCrc();
+
+  LocalDebugFileFinder finder(vector<string>(1, debug_dir), 1);
+  EXPECT_EQ(expected, finder.Find(query_));
+
+  query_.debuglink_crc ^= 1;
+  EXPECT_EQ("", finder.Find(query_));
+}
+
+TEST_F(DebugFileFinderTest, LocalSkipsObjFile) {
+  // A debug link naming the stripped file itself, in its own directory,
+  // never finds it, even with the right CRC.
+  query_.debuglink = "libfoo.so";
+  query_.debuglink_crc = LastCrc();
+
+  LocalDebugFileFinder finder(vector<string>(1, temp_dir_.path()), 1);
+  EXPECT_EQ("", finder.Find(query_));
+}
+
+TEST_F(DebugFileFinderTest, LocalPrefersEarlierCandidates) {
+  vector<string> debug_dirs;
+  for (int i = 0; i < 6; ++i)
+    debug_dirs.push_back(temp_dir_.path() + "/debug" + std::to_string(i));
+  // The third directory has the file by its debug link, and the fourth by
+  // its build id; the others have files that don't check out.
+  query_.build_id.assign(kBuildId, kBuildId + sizeof(kBuildId));
+  query_.debuglink = "libfoo.so.debug";
+  ASSERT_TRUE(WriteElf(debug_dirs[2] + "/libfoo.so.debug",
+                       kBuildId, sizeof(kBuildId), 2));
+  query_.debuglink_crc = LastCrc();
+  ASSERT_TRUE(WriteElf(debug_dirs[0] + "/libfoo.so.debug",
+                       kBuildId, sizeof(kBuildId), 3));
+  ASSERT_TRUE(WriteElf(debug_dirs[1] +
+                       "/.build-id/01/23456789abcdef00112233.debug",
+                       kOtherBuildId, sizeof(kOtherBuildId), 2));
+  ASSERT_TRUE(WriteElf(debug_dirs[3] +
+                       "/.build-id/01/23456789abcdef00112233.debug",
+                       kBuildId, sizeof(kBuildId), 2));
+  ASSERT_TRUE(WriteElf(debug_dirs[5] + "/libfoo.so.debug",
+                       kBuildId, sizeof(kBuildId), 2));
+
+  for (int thread_count = 1; thread_count <= 8; ++thread_count) {
+    LocalDebugFileFinder finder(debug_dirs, thread_count);
+    EXPECT_EQ(debug_dirs[2] + "/libfoo.so.debug", finder.Find(query_))
+        << thread_count << " threads";
+  }
+}
+
+class DebuginfodFinderTest : public DebugFileFinderTest {
+ public:
+  void SetUp() {
+    DebugFileFinderTest::SetUp();
+    cache_ = temp_dir_.path() + "/cache";
+    query_.build_id.assign(kBuildId, kBuildId + sizeof(kBuildId));
+    fetcher_ = [this](const string& url, const string& path) {
+      urls_.push_back(url);
+      std::map<string, string>::const_iterator it = served_.find(url);
+      return it != served_.end() && CopyFile(it->second, path);
+    };
+  }
+
+  // Have the fake server answer URL with the file at PATH.
+  void Serve(const string& url, const string& path) {
+    served_[url] = path;
+  }
+
+  string cache_;
+  std::map<string, string> served_;
+  vector<string> urls_;
+  DebuginfodFinder::Fetcher fetcher_;
+};
+
+TEST_F(DebuginfodFinderTest, FetchesAndCaches) {
+  string served = temp_dir_.path() + "/served";
+  ASSERT_TRUE(WriteElf(served, kBuildId, sizeof(kBuildId), 2));
+  string url = string("http://two/buildid/") + kBuildIdString + "/debuginfo";
+  Serve(url, served);
+
+  vector<string> servers;
+  servers.push_back("http://one");
+  servers.push_back("http://two/");
+  DebuginfodFinder finder(servers, cache_, fetcher_);
+  string expected = cache_ + "/" + kBuildIdString + "/debuginfo";
+  EXPECT_EQ(expected, finder.Find(query_));
+  ASSERT_EQ(2U, urls_.size());
+  EXPECT_EQ(string("http://one/buildid/") + kBuildIdString + "/debuginfo",
+            urls_[0]);
+  EXPECT_EQ(url, urls_[1]);
+
+  // The second time, the file comes from the cache.
+  urls_.clear();
+  EXPECT_EQ(expected, finder.Find(query_));
+  EXPECT_TRUE(urls_.empty());
+}
+
+TEST_F(DebuginfodFinderTest, RejectsWrongBuildId) {
+  string served = temp_dir_.path() + "/served";
+  ASSERT_TRUE(WriteElf(served, kOtherBuildId, sizeof(kOtherBuildId), 2));
+  Serve(string("http://one/buildid/") + kBuildIdString + "/debuginfo",
+        served);
+
+  DebuginfodFinder finder(vector<string>(1, "http://one"), cache_, fetcher_);
+  EXPECT_EQ("", finder.Find(query_));
+  EXPECT_EQ(1U, urls_.size());
+
+  // Nothing was left in the cache.
+  struct stat st;
+  EXPECT_NE(0, stat((cache_ + "/" + kBuildIdString + "/debuginfo").c_str(),
+                    &st));
+}
+
+TEST_F(DebuginfodFinderTest, NeedsBuildId) {
+  query_.build_id.clear();
+  query_.debuglink = "libfoo.so.debug";
+  DebuginfodFinder finder(vector<string>(1, "http://one"), cache_, fetcher_);
+  EXPECT_EQ("", finder.Find(query_));
+  EXPECT_TRUE(urls_.empty());
+}
+
+}  // namespace
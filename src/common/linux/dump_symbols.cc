@@ -54,9 +54,17 @@
 #ifdef HAVE_LIBZSTD
 #include <zstd.h>
 #endif
+#ifdef HAVE_LIBLZMA
+#include <lzma.h>
+#endif
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -66,8 +74,9 @@
 #include "common/dwarf_cu_to_module.h"
 #include "common/dwarf_line_to_module.h"
 #include "common/dwarf_range_list_handler.h"
-#include "common/linux/crc32.h"
-#include "common/linux/eintr_wrapper.h"
+#include "common/dwarf_unit_cache.h"
+#include "common/linux/debug_file_finder.h"
+#include "common/linux/elf_section_index.h"
 #include "common/linux/elfutils.h"
 #include "common/linux/elfutils-inl.h"
 #include "common/linux/elf_symbols_to_module.h"
@@ -85,6 +94,8 @@
 // This namespace contains helper functions.
 namespace {
 
+using google_breakpad::DebugFileFinder;
+using google_breakpad::DebugFileQuery;
 using google_breakpad::DumpOptions;
 using google_breakpad::DwarfCFIToModule;
 using google_breakpad::DwarfCUToModule;
@@ -93,8 +104,8 @@ using google_breakpad::DwarfRangeListHandler;
 using google_breakpad::ElfClass;
 using google_breakpad::ElfClass32;
 using google_breakpad::ElfClass64;
+using google_breakpad::ElfSectionIndex;
 using google_breakpad::elf::FileID;
-using google_breakpad::FindElfSectionByName;
 using google_breakpad::GetOffset;
 using google_breakpad::IsValidElf;
 using google_breakpad::elf::kDefaultBuildIdSize;
@@ -240,24 +251,46 @@ bool LoadStabs(const typename ElfClass::Ehdr* elf_header,
 
 // A range handler that accepts rangelist data parsed by
 // google_breakpad::RangeListReader and populates a range vector (typically
-// owned by a function) with the results.
+// owned by a function) with the results. If CACHE is non-NULL, lists are
+// decoded once and shared through it.
 class DumperRangesHandler : public DwarfCUToModule::RangesHandler {
  public:
-  DumperRangesHandler(google_breakpad::ByteReader* reader) :
-      reader_(reader) { }
+  DumperRangesHandler(google_breakpad::ByteReader* reader,
+                      google_breakpad::DwarfRangeListCache* cache = NULL) :
+      reader_(reader), cache_(cache) { }
 
   bool ReadRanges(
       enum google_breakpad::DwarfForm form, uint64_t data,
       google_breakpad::RangeListReader::CURangesInfo* cu_info,
       vector<Module::Range>* ranges) {
-    DwarfRangeListHandler handler(ranges);
+    if (!cache_) {
+      DwarfRangeListHandler handler(ranges);
+      google_breakpad::RangeListReader range_list_reader(reader_, cu_info,
+                                                      &handler);
+      return range_list_reader.ReadRanges(form, data);
+    }
+    vector<Module::Range> list;
+    DwarfRangeListHandler handler(&list);
     google_breakpad::RangeListReader range_list_reader(reader_, cu_info,
                                                     &handler);
-    return range_list_reader.ReadRanges(form, data);
+    uint64_t offset;
+    if (!range_list_reader.FindRangeList(form, data, &offset))
+      return false;
+    if (cache_->Lookup(*cu_info, offset, ranges))
+      return true;
+    // Decoding may move the CU's base address, so key on the one it began
+    // with.
+    google_breakpad::RangeListReader::CURangesInfo key_info = *cu_info;
+    if (!range_list_reader.ReadRangeList(offset))
+      return false;
+    cache_->Store(key_info, offset, list);
+    ranges->insert(ranges->end(), list.begin(), list.end());
+    return true;
   }
 
  private:
   google_breakpad::ByteReader* reader_;
+  google_breakpad::DwarfRangeListCache* cache_;
 };
 
 // A line-to-module loader that accepts line number info parsed by
@@ -288,9 +321,21 @@ class DumperLineToModule: public DwarfCUToModule::LineToModuleHandler {
                                   &handler);
     parser.Start();
   }
+  DumperLineToModule* Clone() const {
+    // The clone may read on another thread while this converter's reader
+    // is in use, so it reads with a copy, which has this unit's sizes.
+    DumperLineToModule* clone = new DumperLineToModule(byte_reader_);
+    clone->own_byte_reader_.reset(
+        new google_breakpad::ByteReader(*byte_reader_));
+    clone->byte_reader_ = clone->own_byte_reader_.get();
+    clone->compilation_dir_ = compilation_dir_;
+    return clone;
+  }
  private:
   string compilation_dir_;
   google_breakpad::ByteReader* byte_reader_;
+  // The reader a clone owns; NULL otherwise.
+  scoped_ptr<google_breakpad::ByteReader> own_byte_reader_;
 };
 
 template<typename ElfClass>
@@ -313,57 +358,184 @@ uint32_t GetCompressionHeader(
   return sizeof (*header);
 }
 
-std::pair<uint8_t *, uint64_t> UncompressZlibSectionContents(
-    const uint8_t* compressed_buffer, uint64_t compressed_size, uint64_t uncompressed_size) {
-  google_breakpad::scoped_array<uint8_t> uncompressed_buffer(
-    new uint8_t[uncompressed_size]);
-
+bool UncompressZlibSectionContents(
+    const uint8_t* compressed_buffer, uint64_t compressed_size,
+    uint8_t* uncompressed_buffer, uint64_t uncompressed_size) {
   uLongf size = static_cast<uLongf>(uncompressed_size);
 
   int status = uncompress(
-    uncompressed_buffer.get(), &size, compressed_buffer, compressed_size);
+    uncompressed_buffer, &size, compressed_buffer, compressed_size);
 
-  return status != Z_OK
-      ? std::make_pair(nullptr, 0)
-      : std::make_pair(uncompressed_buffer.release(), uncompressed_size);
+  return status == Z_OK;
 }
 
 #ifdef HAVE_LIBZSTD
-std::pair<uint8_t *, uint64_t> UncompressZstdSectionContents(
-    const uint8_t* compressed_buffer, uint64_t compressed_size,uint64_t uncompressed_size) {
-
-  google_breakpad::scoped_array<uint8_t> uncompressed_buffer(new uint8_t[uncompressed_size]);
-  size_t out_size = ZSTD_decompress(uncompressed_buffer.get(), uncompressed_size,
+bool UncompressZstdSectionContents(
+    const uint8_t* compressed_buffer, uint64_t compressed_size,
+    uint8_t* uncompressed_buffer, uint64_t uncompressed_size) {
+  size_t out_size = ZSTD_decompress(uncompressed_buffer, uncompressed_size,
     compressed_buffer, compressed_size);
   if (ZSTD_isError(out_size)) {
-    return std::make_pair(nullptr, 0);
+    return false;
   }
   assert(out_size == uncompressed_size);
-  return std::make_pair(uncompressed_buffer.release(), uncompressed_size);
+  return true;
+}
+#endif
+
+#ifdef HAVE_LIBLZMA
+// Decompress the xz stream in the SIZE bytes at CONTENTS into anonymous
+// memory that MAPPING takes over, and set *DATA and *DATA_SIZE to the
+// result.  An xz stream does not say up front how large it is, so the
+// output is decompressed into a mapping that is grown as it fills, rather
+// than into a temporary file or a buffer sized by a first pass.  Return
+// false if the stream is corrupt.
+bool UncompressXzContents(const uint8_t* contents, uint64_t size,
+                          MmapWrapper* mapping, uint8_t** data,
+                          uint64_t* data_size) {
+  lzma_stream stream = LZMA_STREAM_INIT;
+  if (lzma_stream_decoder(&stream, UINT64_MAX, 0) != LZMA_OK)
+    return false;
+
+  size_t page_size = getpagesize();
+  size_t capacity = (size * 4 + page_size - 1) / page_size * page_size;
+  void* base = mmap(NULL, capacity, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    lzma_end(&stream);
+    return false;
+  }
+  stream.next_in = contents;
+  stream.avail_in = size;
+  lzma_ret status = LZMA_OK;
+  while (status == LZMA_OK) {
+    if (stream.total_out == capacity) {
+      void* grown = mremap(base, capacity, capacity * 2, MREMAP_MAYMOVE);
+      if (grown == MAP_FAILED)
+        break;
+      base = grown;
+      capacity *= 2;
+    }
+    stream.next_out = static_cast<uint8_t*>(base) + stream.total_out;
+    stream.avail_out = capacity - stream.total_out;
+    status = lzma_code(&stream, LZMA_FINISH);
+  }
+  uint64_t out_size = stream.total_out;
+  lzma_end(&stream);
+  mapping->set(base, capacity);
+  if (status != LZMA_STREAM_END)
+    return false;
+  *data = static_cast<uint8_t*>(base);
+  *data_size = out_size;
+  return true;
 }
 #endif
 
-std::pair<uint8_t *, uint64_t> UncompressSectionContents(
+// Decompress the COMPRESSED_SIZE bytes at COMPRESSED_BUFFER into the
+// UNCOMPRESSED_SIZE bytes at UNCOMPRESSED_BUFFER.  Return false if the
+// data is corrupt or COMPRESSION_TYPE is not supported.
+bool UncompressSectionContents(
     uint64_t compression_type, const uint8_t* compressed_buffer,
-    uint64_t compressed_size, uint64_t uncompressed_size) {
+    uint64_t compressed_size, uint8_t* uncompressed_buffer,
+    uint64_t uncompressed_size) {
   if (compression_type == ELFCOMPRESS_ZLIB) {
-    return UncompressZlibSectionContents(compressed_buffer, compressed_size, uncompressed_size);
+    return UncompressZlibSectionContents(compressed_buffer, compressed_size,
+                                         uncompressed_buffer,
+                                         uncompressed_size);
   }
 
 #ifdef HAVE_LIBZSTD
   if (compression_type == ELFCOMPRESS_ZSTD) {
-    return UncompressZstdSectionContents(compressed_buffer, compressed_size, uncompressed_size);
+    return UncompressZstdSectionContents(compressed_buffer, compressed_size,
+                                         uncompressed_buffer,
+                                         uncompressed_size);
   }
 #endif
 
-  return std::make_pair(nullptr, 0);
+  return false;
+}
+
+// A compressed ELF section, and the anonymous memory it is decompressed
+// into.  The memory is mapped rather than allocated so that it goes back
+// to the system as soon as the section is no longer needed, and its pages
+// are only committed as the decompressor fills them.
+struct UncompressedSection {
+  UncompressedSection() : contents(NULL), size(0), compression_type(0),
+                          data(NULL), data_size(0), uncompressed(false) {}
+
+  // Map DATA_SIZE bytes of anonymous memory for the section's contents.
+  // Return false if that fails.
+  bool Map() {
+    void* mapped = mmap(NULL, data_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED)
+      return false;
+    mapping.set(mapped, data_size);
+    data = static_cast<uint8_t*>(mapped);
+    return true;
+  }
+
+  void Uncompress() {
+    uncompressed = UncompressSectionContents(compression_type, contents,
+                                             size, data, data_size);
+  }
+
+  string name;
+  // The compressed contents, following the compression header.
+  const uint8_t* contents;
+  uint64_t size;
+  uint64_t compression_type;
+  // The memory the section is decompressed into.
+  uint8_t* data;
+  uint64_t data_size;
+  MmapWrapper mapping;
+  bool uncompressed;
+
+ private:
+  // Disallow copy constructor and assignment operator.
+  UncompressedSection(const UncompressedSection&);
+  void operator=(const UncompressedSection&);
+};
+
+// Decompress SECTIONS, using up to THREAD_COUNT threads.  The largest
+// sections are started first, since they bound how long this takes.
+void UncompressSections(vector<UncompressedSection*>* sections,
+                        int thread_count) {
+  std::sort(sections->begin(), sections->end(),
+            [](const UncompressedSection* a, const UncompressedSection* b) {
+              return a->data_size > b->data_size;
+            });
+  std::atomic<size_t> next_section(0);
+  auto uncompress_sections = [&]() {
+    for (size_t i = next_section++; i < sections->size();
+         i = next_section++) {
+      (*sections)[i]->Uncompress();
+    }
+  };
+  vector<std::thread> threads;
+  for (int i = 1; i < thread_count && i < static_cast<int>(sections->size());
+       ++i) {
+    threads.push_back(std::thread(uncompress_sections));
+  }
+  uncompress_sections();
+  for (std::thread& thread : threads)
+    thread.join();
 }
 
-void StartProcessSplitDwarf(google_breakpad::CompilationUnit* reader,
-                            Module* module,
-                            google_breakpad::Endianness endianness,
-                            bool handle_inter_cu_refs,
-                            bool handle_inline) {
+// Convert the split DWARF unit that READER's skeleton unit refers to into
+// MODULE.  If UNIT_FUNCTIONS is not NULL, the unit's functions are built
+// in MODULE but added to UNIT_FUNCTIONS instead, as DwarfCUToModule's
+// FileContext::set_unit_functions describes.  The .dwp file is taken from
+// SPLIT_DWARF_CACHE, which may be NULL.
+void StartProcessSplitDwarf(
+    google_breakpad::CompilationUnit* reader,
+    Module* module,
+    vector<Module::Function*>* unit_functions,
+    google_breakpad::Endianness endianness,
+    bool handle_inter_cu_refs,
+    bool handle_inline,
+    google_breakpad::CompilationUnit::SplitDwarfCache* split_dwarf_cache,
+    google_breakpad::DemangleCache* demangle_cache) {
   std::string split_file;
   google_breakpad::SectionMap split_sections;
   google_breakpad::ByteReader split_byte_reader(endianness);
@@ -373,6 +545,9 @@ void StartProcessSplitDwarf(google_breakpad::CompilationUnit* reader,
     return;
   DwarfCUToModule::FileContext file_context(split_file, module,
                                             handle_inter_cu_refs);
+  file_context.set_demangle_cache(demangle_cache);
+  if (unit_functions)
+    file_context.set_unit_functions(unit_functions);
   for (auto section : split_sections)
     file_context.AddSectionToSectionMap(section.first, section.second.first,
                                         section.second.second);
@@ -404,12 +579,148 @@ void StartProcessSplitDwarf(google_breakpad::CompilationUnit* reader,
       split_file, file_context.section_map(), cu_offset, &split_byte_reader,
       &die_dispatcher);
   split_reader.SetSplitDwarf(reader->GetAddrBase(), reader->GetDWOID());
+  split_reader.set_split_dwarf_cache(split_dwarf_cache);
   split_reader.Start();
   // Normally, it won't happen unless we have transitive reference.
   if (split_reader.ShouldProcessSplitDwarf()) {
-    StartProcessSplitDwarf(&split_reader, module, endianness,
-                           handle_inter_cu_refs, handle_inline);
+    StartProcessSplitDwarf(&split_reader, module, unit_functions, endianness,
+                           handle_inter_cu_refs, handle_inline,
+                           split_dwarf_cache, demangle_cache);
+  }
+}
+
+// Return the offsets of the units in the .debug_info section INFO, of
+// length LENGTH, found by following their initial length fields.  Return
+// false if a unit's length is malformed.
+bool FindUnitOffsets(const uint8_t* info, uint64_t length,
+                     const google_breakpad::ByteReader& byte_reader,
+                     vector<uint64_t>* offsets) {
+  for (uint64_t offset = 0; offset < length;) {
+    if (length - offset < 4)
+      return false;
+    uint64_t header_length = 4;
+    uint64_t unit_length = byte_reader.ReadFourBytes(info + offset);
+    if (unit_length == 0xffffffff) {
+      if (length - offset < 12)
+        return false;
+      header_length = 12;
+      unit_length = byte_reader.ReadEightBytes(info + offset + 4);
+    }
+    if (unit_length > length - offset - header_length)
+      return false;
+    offsets->push_back(offset);
+    offset += header_length + unit_length;
+  }
+  return true;
+}
+
+// A compilation unit converted on its own, into a module of its own.
+struct ConvertedUnit {
+  ~ConvertedUnit() {
+    for (Module::Function* function : functions)
+      delete function;
+  }
+
+  scoped_ptr<Module> module;
+  // The unit's functions, built in MODULE and owned by this object.
+  vector<Module::Function*> functions;
+};
+
+// Convert the compilation units at OFFSETS in DWARF_FILENAME's .debug_info
+// section separately on THREAD_COUNT threads, then add their functions to
+// MODULE in unit order, so that MODULE ends up as if the units had been
+// converted one after another.  Return false, leaving MODULE untouched, if
+// a unit fails to parse or refers to a DIE in another unit: converting
+// units one at a time is the only way to handle those.  Skeleton units'
+// split DWARF files are read and converted by the thread that read the
+// skeleton, taking .dwp files from SPLIT_DWARF_CACHE.  The units share
+// ABBREV_CACHE.  If UNIT_CACHE is not NULL, units found in it are loaded
+// from it instead of being converted, and the others, except skeleton
+// units, are stored in it.  Names are demangled through DEMANGLE_CACHE,
+// and range lists are shared through RANGE_LIST_CACHE.
+bool LoadDwarfUnitsInParallel(
+    const string& dwarf_filename,
+    const google_breakpad::SectionMap& sections,
+    google_breakpad::Endianness endianness,
+    const vector<uint64_t>& offsets,
+    bool handle_inter_cu_refs,
+    bool handle_inline,
+    int thread_count,
+    google_breakpad::CompilationUnit::AbbrevCache* abbrev_cache,
+    google_breakpad::CompilationUnit::SplitDwarfCache* split_dwarf_cache,
+    const google_breakpad::DwarfUnitCache* unit_cache,
+    google_breakpad::DemangleCache* demangle_cache,
+    google_breakpad::DwarfRangeListCache* range_list_cache,
+    Module* module) {
+  vector<ConvertedUnit> units(offsets.size());
+  std::atomic<size_t> next_unit(0);
+  std::atomic<bool> failed(false);
+  auto convert_units = [&]() {
+    google_breakpad::ByteReader byte_reader(endianness);
+    DumperRangesHandler ranges_handler(&byte_reader, range_list_cache);
+    DumperLineToModule line_to_module(&byte_reader);
+    while (!failed) {
+      size_t i = next_unit++;
+      if (i >= offsets.size())
+        break;
+      ConvertedUnit* unit = &units[i];
+      unit->module.reset(new Module(module->name(), module->os(),
+                                    module->architecture(),
+                                    module->identifier()));
+      google_breakpad::DwarfUnitCache::Key key;
+      bool cacheable = unit_cache &&
+          unit_cache->ComputeKey(dwarf_filename, sections, offsets[i],
+                                 &byte_reader, abbrev_cache, &key);
+      if (cacheable && unit_cache->Load(key, dwarf_filename,
+                                        unit->module.get(), &unit->functions))
+        continue;
+      DwarfCUToModule::FileContext file_context(dwarf_filename,
+                                                unit->module.get(),
+                                                handle_inter_cu_refs);
+      for (const auto& section : sections)
+        file_context.AddSectionToSectionMap(section.first,
+                                            section.second.first,
+                                            section.second.second);
+      file_context.set_unit_functions(&unit->functions);
+      file_context.set_demangle_cache(demangle_cache);
+      DwarfCUToModule::WarningReporter reporter(dwarf_filename, offsets[i]);
+      DwarfCUToModule root_handler(&file_context, &line_to_module,
+                                   &ranges_handler, &reporter, handle_inline);
+      google_breakpad::DIEDispatcher die_dispatcher(&root_handler);
+      google_breakpad::CompilationUnit reader(dwarf_filename,
+                                           file_context.section_map(),
+                                           offsets[i],
+                                           &byte_reader,
+                                           &die_dispatcher);
+      reader.set_abbrev_cache(abbrev_cache);
+      reader.set_split_dwarf_cache(split_dwarf_cache);
+      if (reader.Start() == 0 || file_context.has_inter_cu_refs()) {
+        failed = true;
+      } else if (reader.ShouldProcessSplitDwarf()) {
+        StartProcessSplitDwarf(&reader, unit->module.get(), &unit->functions,
+                               endianness, handle_inter_cu_refs, handle_inline,
+                               split_dwarf_cache, demangle_cache);
+      } else if (cacheable) {
+        unit_cache->Store(key, dwarf_filename, unit->module.get(),
+                          unit->functions);
+      }
+    }
+  };
+  vector<std::thread> threads;
+  for (int i = 1; i < thread_count; ++i)
+    threads.push_back(std::thread(convert_units));
+  convert_units();
+  for (std::thread& thread : threads)
+    thread.join();
+  if (failed)
+    return false;
+
+  for (ConvertedUnit& unit : units) {
+    module->AddUnitFunctions(unit.module.get(), unit.functions);
+    unit.functions.clear();
+    unit.module.reset();
   }
+  return true;
 }
 
 template<typename ElfClass>
@@ -418,6 +729,9 @@ bool LoadDwarf(const string& dwarf_filename,
                const bool big_endian,
                bool handle_inter_cu_refs,
                bool handle_inline,
+               int thread_count,
+               const string& unit_cache_directory,
+               google_breakpad::DemangleCache* demangle_cache,
                Module* module) {
   typedef typename ElfClass::Shdr Shdr;
 
@@ -429,12 +743,19 @@ bool LoadDwarf(const string& dwarf_filename,
   DwarfCUToModule::FileContext file_context(dwarf_filename,
                                             module,
                                             handle_inter_cu_refs);
+  file_context.set_demangle_cache(demangle_cache);
+  // Units converted one at a time, such as a program's single LTO unit,
+  // can still use the threads within themselves.
+  file_context.set_thread_count(thread_count);
 
-  // Build a map of the ELF file's sections.
+  // Build a map of the ELF file's sections, decompressing those that are
+  // compressed all at once, so that several threads can share the work.
   const Shdr* sections =
       GetOffset<ElfClass, Shdr>(elf_header, elf_header->e_shoff);
   int num_sections = elf_header->e_shnum;
   const Shdr* section_names = sections + elf_header->e_shstrndx;
+  std::list<UncompressedSection> compressed_sections;
+  vector<UncompressedSection*> sections_to_uncompress;
   for (int i = 0; i < num_sections; i++) {
     const Shdr* section = &sections[i];
     string name = GetOffset<ElfClass, char>(elf_header,
@@ -454,23 +775,33 @@ bool LoadDwarf(const string& dwarf_filename,
     uint32_t compression_header_size =
       GetCompressionHeader<ElfClass>(chdr, contents, size);
 
-    if (compression_header_size == 0 || chdr.ch_size == 0) {
+    if (compression_header_size == 0 || chdr.ch_size == 0 ||
+        compression_header_size > size) {
       continue;
     }
 
-    contents += compression_header_size;
-    size -= compression_header_size;
-
-    std::pair<uint8_t *, uint64_t> uncompressed =
-      UncompressSectionContents(chdr.ch_type, contents, size, chdr.ch_size);
-
-    if (uncompressed.first != nullptr && uncompressed.second != 0) {
-      file_context.AddManagedSectionToSectionMap(name, uncompressed.first, uncompressed.second);
+    compressed_sections.emplace_back();
+    UncompressedSection* uncompressed = &compressed_sections.back();
+    uncompressed->name = name;
+    uncompressed->contents = contents + compression_header_size;
+    uncompressed->size = size - compression_header_size;
+    uncompressed->compression_type = chdr.ch_type;
+    uncompressed->data_size = chdr.ch_size;
+    if (uncompressed->Map())
+      sections_to_uncompress.push_back(uncompressed);
+  }
+  UncompressSections(&sections_to_uncompress, thread_count);
+  for (const UncompressedSection& section : compressed_sections) {
+    if (section.uncompressed) {
+      file_context.AddSectionToSectionMap(section.name, section.data,
+                                          section.data_size);
     }
   }
 
-  // .debug_ranges and .debug_rnglists reader
-  DumperRangesHandler ranges_handler(&byte_reader);
+  // .debug_ranges and .debug_rnglists reader. Decoded lists are shared
+  // by all of the file's units, on whichever thread converts them.
+  google_breakpad::DwarfRangeListCache range_list_cache;
+  DumperRangesHandler ranges_handler(&byte_reader, &range_list_cache);
 
   // Parse all the compilation units in the .debug_info section.
   DumperLineToModule line_to_module(&byte_reader);
@@ -483,6 +814,30 @@ bool LoadDwarf(const string& dwarf_filename,
   // .debug_info section.
   assert(debug_info_section.first);
   uint64_t debug_info_length = debug_info_section.second;
+  // Units usually share a few abbreviation tables; parse each only once.
+  google_breakpad::CompilationUnit::AbbrevCache abbrev_cache;
+  // Skeleton units usually share one .dwp file; open and index it once.
+  google_breakpad::CompilationUnit::SplitDwarfCache split_dwarf_cache;
+  // Cached units are loaded separately, so they take the same path as
+  // units converted on several threads.
+  scoped_ptr<google_breakpad::DwarfUnitCache> unit_cache;
+  if (!unit_cache_directory.empty()) {
+    unit_cache.reset(new google_breakpad::DwarfUnitCache(unit_cache_directory,
+                                                         handle_inline));
+  }
+  if (thread_count > 1 || unit_cache.get()) {
+    vector<uint64_t> offsets;
+    if (FindUnitOffsets(debug_info_section.first, debug_info_length,
+                        byte_reader, &offsets) &&
+        (offsets.size() > 1 || unit_cache.get()) &&
+        LoadDwarfUnitsInParallel(dwarf_filename, file_context.section_map(),
+                                 endianness, offsets, handle_inter_cu_refs,
+                                 handle_inline, thread_count, &abbrev_cache,
+                                 &split_dwarf_cache, unit_cache.get(),
+                                 demangle_cache, &range_list_cache, module)) {
+      return true;
+    }
+  }
   for (uint64_t offset = 0; offset < debug_info_length;) {
     // Make a handler for the root DIE that populates MODULE with the
     // data that was found.
@@ -497,6 +852,8 @@ bool LoadDwarf(const string& dwarf_filename,
                                          offset,
                                          &byte_reader,
                                          &die_dispatcher);
+    reader.set_abbrev_cache(&abbrev_cache);
+    reader.set_split_dwarf_cache(&split_dwarf_cache);
     // Process the entire compilation unit; get the offset of the next.
     uint64_t result = reader.Start();
     if (result == 0) {
@@ -505,8 +862,9 @@ bool LoadDwarf(const string& dwarf_filename,
     offset += result;
     // Start to process split dwarf file.
     if (reader.ShouldProcessSplitDwarf()) {
-      StartProcessSplitDwarf(&reader, module, endianness, handle_inter_cu_refs,
-                             handle_inline);
+      StartProcessSplitDwarf(&reader, module, NULL, endianness,
+                             handle_inter_cu_refs, handle_inline,
+                             &split_dwarf_cache, demangle_cache);
     }
   }
   return true;
@@ -544,6 +902,67 @@ bool DwarfCFIRegisterNames(const typename ElfClass::Ehdr* elf_header,
   }
 }
 
+// Parse the call frame information in the CFI_SIZE bytes at CFI with
+// BYTE_READER, adding it to MODULE.  With a THREAD_COUNT above one, the
+// entries are divided into pieces parsed on that many threads, each into
+// a module of its own, and the pieces' entries are then added to MODULE
+// in section order, so that MODULE ends up as if the section had been
+// parsed in one pass.
+void ParseDwarfCFI(const uint8_t* cfi, size_t cfi_size, bool eh_frame,
+                   const google_breakpad::ByteReader& byte_reader,
+                   const vector<string>& register_names,
+                   DwarfCFIToModule::Reporter* module_reporter,
+                   google_breakpad::CallFrameInfo::Reporter* dwarf_reporter,
+                   int thread_count, Module* module) {
+  google_breakpad::ByteReader reader(byte_reader);
+  DwarfCFIToModule handler(module, register_names, module_reporter);
+  google_breakpad::CallFrameInfo parser(cfi, cfi_size, &reader, &handler,
+                                        dwarf_reporter, eh_frame);
+  vector<size_t> boundaries;
+  if (thread_count > 1) {
+    // Use more pieces than threads, so that threads that finish early can
+    // take on pieces that are still waiting.
+    parser.SplitEntries(thread_count * 4, &boundaries);
+  }
+  if (boundaries.size() < 3) {
+    parser.Start();
+    return;
+  }
+
+  const size_t piece_count = boundaries.size() - 1;
+  vector<scoped_ptr<Module>> pieces(piece_count);
+  std::atomic<size_t> next_piece(0);
+  auto parse_pieces = [&]() {
+    while (true) {
+      size_t i = next_piece++;
+      if (i >= piece_count)
+        break;
+      pieces[i].reset(new Module(module->name(), module->os(),
+                                 module->architecture(),
+                                 module->identifier()));
+      google_breakpad::ByteReader piece_reader(byte_reader);
+      DwarfCFIToModule piece_handler(pieces[i].get(), register_names,
+                                     module_reporter);
+      google_breakpad::CallFrameInfo piece_parser(cfi, cfi_size,
+                                                  &piece_reader,
+                                                  &piece_handler,
+                                                  dwarf_reporter, eh_frame);
+      piece_parser.Start(boundaries[i], boundaries[i + 1]);
+    }
+  };
+  vector<std::thread> threads;
+  for (int i = 1; i < thread_count && i < static_cast<int>(piece_count); ++i)
+    threads.push_back(std::thread(parse_pieces));
+  parse_pieces();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (scoped_ptr<Module>& piece : pieces) {
+    module->AddUnitStackFrameEntries(piece.get());
+    piece.reset();
+  }
+}
+
 template<typename ElfClass>
 bool LoadDwarfCFI(const string& dwarf_filename,
                   const typename ElfClass::Ehdr* elf_header,
@@ -553,6 +972,7 @@ bool LoadDwarfCFI(const string& dwarf_filename,
                   const typename ElfClass::Shdr* got_section,
                   const typename ElfClass::Shdr* text_section,
                   const bool big_endian,
+                  int thread_count,
                   Module* module) {
   // Find the appropriate set of register names for this file's
   // architecture.
@@ -574,7 +994,6 @@ bool LoadDwarfCFI(const string& dwarf_filename,
 
   // Plug together the parser, handler, and their entourages.
   DwarfCFIToModule::Reporter module_reporter(dwarf_filename, section_name);
-  DwarfCFIToModule handler(module, register_names, &module_reporter);
   google_breakpad::ByteReader byte_reader(endianness);
 
   byte_reader.SetAddressSize(ElfClass::kAddrSize);
@@ -590,10 +1009,8 @@ bool LoadDwarfCFI(const string& dwarf_filename,
   google_breakpad::CallFrameInfo::Reporter dwarf_reporter(dwarf_filename,
                                                        section_name);
   if (!IsCompressedHeader<ElfClass>(section)) {
-    google_breakpad::CallFrameInfo parser(cfi, cfi_size,
-                                          &byte_reader, &handler,
-                                          &dwarf_reporter, eh_frame);
-    parser.Start();
+    ParseDwarfCFI(cfi, cfi_size, eh_frame, byte_reader, register_names,
+                  &module_reporter, &dwarf_reporter, thread_count, module);
     return true;
   }
 
@@ -615,17 +1032,20 @@ bool LoadDwarfCFI(const string& dwarf_filename,
   cfi += compression_header_size;
   cfi_size -= compression_header_size;
 
-  std::pair<uint8_t *, uint64_t> uncompressed =
-    UncompressSectionContents(chdr.ch_type, cfi, cfi_size, chdr.ch_size);
-
-  if (uncompressed.first == nullptr || uncompressed.second == 0) {
+  UncompressedSection uncompressed;
+  uncompressed.contents = cfi;
+  uncompressed.size = cfi_size;
+  uncompressed.compression_type = chdr.ch_type;
+  uncompressed.data_size = chdr.ch_size;
+  if (uncompressed.Map())
+    uncompressed.Uncompress();
+  if (!uncompressed.uncompressed) {
     fprintf(stderr, "%s: decompression failed\n", dwarf_filename.c_str());
     return false;
   }
-  google_breakpad::CallFrameInfo parser(uncompressed.first, uncompressed.second,
-                                        &byte_reader, &handler, &dwarf_reporter,
-                                        eh_frame);
-  parser.Start();
+  ParseDwarfCFI(uncompressed.data, uncompressed.data_size, eh_frame,
+                byte_reader, register_names, &module_reporter,
+                &dwarf_reporter, thread_count, module);
   return true;
 }
 
@@ -678,100 +1098,135 @@ bool ElfEndianness(const typename ElfClass::Ehdr* elf_header,
   return false;
 }
 
-// Given |left_abspath|, find the absolute path for |right_path| and see if the
-// two absolute paths are the same.
-bool IsSameFile(const char* left_abspath, const string& right_path) {
-  char right_abspath[PATH_MAX];
-  if (!realpath(right_path.c_str(), right_abspath))
-    return false;
-  return strcmp(left_abspath, right_abspath) == 0;
-}
-
-// Read the .gnu_debuglink and get the debug file name. If anything goes
-// wrong, return an empty string.
-string ReadDebugLink(const uint8_t* debuglink,
-                     const size_t debuglink_size,
-                     const bool big_endian,
-                     const string& obj_file,
-                     const std::vector<string>& debug_dirs) {
+// Read the file name and CRC in the .gnu_debuglink section DEBUGLINK into
+// QUERY.  If anything goes wrong, leave them empty.
+void ReadDebugLink(const uint8_t* debuglink,
+                   const size_t debuglink_size,
+                   const bool big_endian,
+                   DebugFileQuery* query) {
   // Include '\0' + CRC32 (4 bytes).
-  size_t debuglink_len = strlen(reinterpret_cast<const char*>(debuglink)) + 5;
+  size_t debuglink_len =
+      strnlen(reinterpret_cast<const char*>(debuglink), debuglink_size) + 5;
   debuglink_len = 4 * ((debuglink_len + 3) / 4);  // Round up to 4 bytes.
 
   // Sanity check.
   if (debuglink_len != debuglink_size) {
     fprintf(stderr, "Mismatched .gnu_debuglink string / section size: "
             "%zx %zx\n", debuglink_len, debuglink_size);
-    return string();
-  }
-
-  char obj_file_abspath[PATH_MAX];
-  if (!realpath(obj_file.c_str(), obj_file_abspath)) {
-    fprintf(stderr, "Cannot resolve absolute path for %s\n", obj_file.c_str());
-    return string();
+    return;
   }
 
-  std::vector<string> searched_paths;
-  string debuglink_path;
-  std::vector<string>::const_iterator it;
-  for (it = debug_dirs.begin(); it < debug_dirs.end(); ++it) {
-    const string& debug_dir = *it;
-    debuglink_path = debug_dir + "/" +
-                     reinterpret_cast<const char*>(debuglink);
-
-    // There is the annoying case of /path/to/foo.so having foo.so as the
-    // debug link file name. Thus this may end up opening /path/to/foo.so again,
-    // and there is a small chance of the two files having the same CRC.
-    if (IsSameFile(obj_file_abspath, debuglink_path))
-      continue;
+  // The CRC is the last 4 bytes in |debuglink|.
+  const google_breakpad::Endianness endianness = big_endian ?
+      google_breakpad::ENDIANNESS_BIG : google_breakpad::ENDIANNESS_LITTLE;
+  google_breakpad::ByteReader byte_reader(endianness);
+  query->debuglink = reinterpret_cast<const char*>(debuglink);
+  query->debuglink_crc =
+      byte_reader.ReadFourBytes(&debuglink[debuglink_size - 4]);
+}
 
-    searched_paths.push_back(debug_dir);
-    int debuglink_fd = open(debuglink_path.c_str(), O_RDONLY);
-    if (debuglink_fd < 0)
-      continue;
+#ifdef HAVE_LIBLZMA
+// Add the symbols of the MiniDebugInfo in GNU_DEBUGDATA_SECTION, a section
+// of the ELF file at ELF_HEADER, to MODULE.  MiniDebugInfo is an ELF file
+// of its own, xz-compressed, whose symbol table holds the functions a
+// stripped library's .dynsym leaves out.  Return false if there is none.
+template<typename ElfClass>
+bool LoadMiniDebugInfo(const string& obj_file,
+                       const typename ElfClass::Ehdr* elf_header,
+                       const typename ElfClass::Shdr* gnu_debugdata_section,
+                       const bool big_endian,
+                       Module* module,
+                       google_breakpad::DemangleCache* demangle_cache) {
+  typedef typename ElfClass::Ehdr Ehdr;
+  typedef typename ElfClass::Shdr Shdr;
 
-    FDWrapper debuglink_fd_wrapper(debuglink_fd);
+  MmapWrapper mapping;
+  uint8_t* data;
+  uint64_t data_size;
+  if (!UncompressXzContents(
+          GetOffset<ElfClass, uint8_t>(elf_header,
+                                       gnu_debugdata_section->sh_offset),
+          gnu_debugdata_section->sh_size, &mapping, &data, &data_size)) {
+    fprintf(stderr, "%s: failed to decompress \".gnu_debugdata\" section\n",
+            obj_file.c_str());
+    return false;
+  }
+  const Ehdr* debug_header = reinterpret_cast<const Ehdr*>(data);
+  if (data_size < sizeof(Ehdr) || !IsValidElf(debug_header) ||
+      debug_header->e_ident[EI_CLASS] != ElfClass::kClass ||
+      debug_header->e_shstrndx >= debug_header->e_shnum ||
+      debug_header->e_shoff > data_size ||
+      debug_header->e_shnum >
+          (data_size - debug_header->e_shoff) / sizeof(Shdr)) {
+    fprintf(stderr, "%s: \".gnu_debugdata\" section is not an ELF file"
+            " of the same class\n", obj_file.c_str());
+    return false;
+  }
 
-    // The CRC is the last 4 bytes in |debuglink|.
-    const google_breakpad::Endianness endianness = big_endian ?
-        google_breakpad::ENDIANNESS_BIG : google_breakpad::ENDIANNESS_LITTLE;
-    google_breakpad::ByteReader byte_reader(endianness);
-    uint32_t expected_crc =
-        byte_reader.ReadFourBytes(&debuglink[debuglink_size - 4]);
+  const Shdr* sections =
+      GetOffset<ElfClass, Shdr>(debug_header, debug_header->e_shoff);
+  const Shdr* section_names = sections + debug_header->e_shstrndx;
+  if (section_names->sh_offset > data_size ||
+      section_names->sh_size > data_size - section_names->sh_offset)
+    return false;
+  const char* names =
+      GetOffset<ElfClass, char>(debug_header, section_names->sh_offset);
+  const ElfSectionIndex<ElfClass> section_index(
+      sections, names, names + section_names->sh_size, debug_header->e_shnum);
+  const Shdr* symbols_section = section_index.Find(".symtab", SHT_SYMTAB);
+  const Shdr* strings_section = section_index.Find(".strtab", SHT_STRTAB);
+  if (!symbols_section || !strings_section)
+    return false;
+  for (const Shdr* section : {symbols_section, strings_section}) {
+    if (section->sh_offset > data_size ||
+        section->sh_size > data_size - section->sh_offset)
+      return false;
+  }
+  return ELFSymbolsToModule(GetOffset<ElfClass, uint8_t>(
+                                debug_header, symbols_section->sh_offset),
+                            symbols_section->sh_size,
+                            GetOffset<ElfClass, uint8_t>(
+                                debug_header, strings_section->sh_offset),
+                            strings_section->sh_size,
+                            big_endian,
+                            ElfClass::kAddrSize,
+                            module,
+                            demangle_cache);
+}
+#endif  // HAVE_LIBLZMA
+
+// One of the stages of LoadSymbols, which each convert sections that the
+// others don't read.  A concurrent stage starts on a thread of its own when
+// it is made; any other runs when it is finished.  Either way, the stage's
+// work is complete once Finish returns, so finishing stages in the order
+// they would run one after another keeps their results in that order.
+class LoadStage {
+ public:
+  LoadStage(bool concurrent, std::function<void()> work)
+      : work_(std::move(work)) {
+    if (concurrent)
+      thread_ = std::thread(work_);
+  }
 
-    uint32_t actual_crc = 0;
-    while (true) {
-      const size_t kReadSize = 4096;
-      char buf[kReadSize];
-      ssize_t bytes_read = HANDLE_EINTR(read(debuglink_fd, &buf, kReadSize));
-      if (bytes_read < 0) {
-        fprintf(stderr, "Error reading debug ELF file %s.\n",
-                debuglink_path.c_str());
-        return string();
-      }
-      if (bytes_read == 0)
-        break;
-      actual_crc = google_breakpad::UpdateCrc32(actual_crc, buf, bytes_read);
-    }
-    if (actual_crc != expected_crc) {
-      fprintf(stderr, "Error reading debug ELF file - CRC32 mismatch: %s\n",
-              debuglink_path.c_str());
-      continue;
-    }
+  ~LoadStage() { Finish(); }
 
-    // Found debug file.
-    return debuglink_path;
+  // Wait for the stage's work to complete, or do it now if the stage is
+  // not concurrent.  Does nothing if it is already complete.
+  void Finish() {
+    if (thread_.joinable())
+      thread_.join();
+    else if (work_)
+      work_();
+    work_ = nullptr;
   }
 
-  // Not found case.
-  fprintf(stderr, "Failed to find debug ELF file for '%s' after trying:\n",
-          obj_file.c_str());
-  for (it = searched_paths.begin(); it < searched_paths.end(); ++it) {
-    const string& debug_dir = *it;
-    fprintf(stderr, "  %s/%s\n", debug_dir.c_str(), debuglink);
-  }
-  return string();
-}
+ private:
+  std::function<void()> work_;
+  std::thread thread_;
+
+  LoadStage(const LoadStage&);
+  void operator=(const LoadStage&);
+};
 
 //
 // LoadSymbolsInfo
@@ -785,8 +1240,9 @@ class LoadSymbolsInfo {
  public:
   typedef typename ElfClass::Addr Addr;
 
-  explicit LoadSymbolsInfo(const std::vector<string>& dbg_dirs) :
-    debug_dirs_(dbg_dirs),
+  // Debug files are looked for by each of FINDERS in turn.
+  explicit LoadSymbolsInfo(const std::vector<DebugFileFinder*>& finders) :
+    finders_(finders),
     has_loading_addr_(false) {}
 
   // Keeps track of which sections have been loaded so sections don't
@@ -818,21 +1274,37 @@ class LoadSymbolsInfo {
     }
   }
 
-  // Setters and getters
-  const std::vector<string>& debug_dirs() const {
-    return debug_dirs_;
+  bool can_find_debug_file() const {
+    return !finders_.empty();
   }
 
-  string debuglink_file() const {
-    return debuglink_file_;
+  // Start looking for the debug file that QUERY describes, on a thread of
+  // its own if CONCURRENT is set.
+  void StartFindingDebugFile(const DebugFileQuery& query, bool concurrent) {
+    find_stage_.reset(new LoadStage(concurrent, [this, query]() {
+      for (DebugFileFinder* finder : finders_) {
+        debuglink_file_ = finder->Find(query);
+        if (!debuglink_file_.empty())
+          break;
+      }
+    }));
   }
-  void set_debuglink_file(string file) {
-    debuglink_file_ = file;
+
+  bool finding_debug_file() const {
+    return find_stage_.get() != NULL;
+  }
+
+  // Return the full path to the debug file found, waiting for the search
+  // to finish, or an empty string if none was found or looked for.
+  string debuglink_file() {
+    if (find_stage_.get())
+      find_stage_->Finish();
+    return debuglink_file_;
   }
 
  private:
-  const std::vector<string>& debug_dirs_; // Directories in which to
-                                          // search for the debug ELF file.
+  std::vector<DebugFileFinder*> finders_;  // What searches for the debug
+                                           // ELF file.
 
   string debuglink_file_;  // Full path to the debug ELF file.
 
@@ -846,6 +1318,8 @@ class LoadSymbolsInfo {
 
   std::set<string> loaded_sections_;  // Tracks the Loaded ELF sections
                                       // between calls to LoadSymbols().
+
+  scoped_ptr<LoadStage> find_stage_;  // Searches for the debug ELF file.
 };
 
 template<typename ElfClass>
@@ -880,18 +1354,182 @@ bool LoadSymbols(const string& obj_file,
   const char* names =
       GetOffset<ElfClass, char>(elf_header, section_names->sh_offset);
   const char* names_end = names + section_names->sh_size;
+  const ElfSectionIndex<ElfClass> section_index(sections, names, names_end,
+                                                elf_header->e_shnum);
   bool found_debug_info_section = false;
   bool found_usable_info = false;
   bool usable_info_parsed = false;
 
+  // A stripped file's debug file is only needed once the file turns out
+  // to have no debugging information of its own, but its section headers
+  // already tell whether it does; if it doesn't, start looking for the
+  // debug file now, so that the search overlaps converting the symbol
+  // table and the call frame information.
+  if (read_gnu_debug_link) {
+    bool has_debug_info = false;
+    if ((options.symbol_data & SYMBOLS_AND_FILES) ||
+        (options.symbol_data & INLINES)) {
+      has_debug_info =
+          section_index.Find(".debug_info", SHT_PROGBITS) ||
+          (elf_header->e_machine == EM_MIPS &&
+           section_index.Find(".debug_info", SHT_MIPS_DWARF));
+#ifndef NO_STABS_SUPPORT
+      has_debug_info =
+          has_debug_info || section_index.Find(".stab", SHT_PROGBITS);
+#endif  // NO_STABS_SUPPORT
+    }
+    if (!has_debug_info) {
+      DebugFileQuery query;
+      query.obj_file = obj_file;
+      PageAllocator allocator;
+      wasteful_vector<uint8_t> build_id(&allocator, kDefaultBuildIdSize);
+      if (FileID::ElfFileBuildId(elf_header, build_id))
+        query.build_id.assign(build_id.begin(), build_id.end());
+      const Shdr* gnu_debuglink_section =
+          section_index.Find(".gnu_debuglink", SHT_PROGBITS);
+      if (gnu_debuglink_section) {
+        ReadDebugLink(GetOffset<ElfClass, uint8_t>(
+                          elf_header, gnu_debuglink_section->sh_offset),
+                      gnu_debuglink_section->sh_size, big_endian, &query);
+      }
+      if (!query.build_id.empty() || !query.debuglink.empty())
+        info->StartFindingDebugFile(query, options.thread_count > 1);
+    }
+  }
+
+  // The symbol table and the call frame information are read from
+  // sections of their own.  With several threads, each is converted into a
+  // module of its own while the STABS and DWARF are converted into MODULE,
+  // and added to MODULE where converting the stages one after another
+  // would have, so that MODULE ends up the same either way.  A memory
+  // budget can only spill what is in MODULE, so it keeps them in sequence.
+  const bool concurrent =
+      options.thread_count > 1 && options.memory_budget == 0;
+  auto new_fragment = [module]() {
+    return new Module(module->name(), module->os(), module->architecture(),
+                      module->identifier());
+  };
+
+  // Find the call frame information, and start converting it.
+  bool debug_frame_result = false;
+  bool eh_frame_result = false;
+  scoped_ptr<Module> debug_frame_fragment;
+  scoped_ptr<Module> eh_frame_fragment;
+  scoped_ptr<LoadStage> debug_frame_stage;
+  scoped_ptr<LoadStage> eh_frame_stage;
+  if (options.symbol_data & CFI) {
+    // Dwarf Call Frame Information (CFI) is actually independent from
+    // the other DWARF debugging information, and can be used alone.
+    const Shdr* dwarf_cfi_section =
+        section_index.Find(".debug_frame", SHT_PROGBITS);
+
+    // .debug_frame section type is SHT_PROGBITS for mips on pnacl toolchains,
+    // but MIPS_DWARF for regular gnu toolchains, so both need to be checked
+    if (elf_header->e_machine == EM_MIPS && !dwarf_cfi_section) {
+      dwarf_cfi_section = section_index.Find(".debug_frame", SHT_MIPS_DWARF);
+    }
+
+    if (dwarf_cfi_section) {
+      info->LoadedSection(".debug_frame");
+      if (concurrent)
+        debug_frame_fragment.reset(new_fragment());
+      Module* target = concurrent ? debug_frame_fragment.get() : module;
+      debug_frame_stage.reset(new LoadStage(concurrent,
+                                            [=, &debug_frame_result]() {
+        debug_frame_result =
+            LoadDwarfCFI<ElfClass>(obj_file, elf_header, ".debug_frame",
+                                   dwarf_cfi_section, false, 0, 0, big_endian,
+                                   options.thread_count, target);
+      }));
+    }
+
+    // Linux C++ exception handling information can also provide
+    // unwinding data.
+    const Shdr* eh_frame_section =
+        section_index.Find(".eh_frame", SHT_PROGBITS);
+    if (eh_frame_section) {
+      // Pointers in .eh_frame data may be relative to the base addresses of
+      // certain sections. Provide those sections if present.
+      const Shdr* got_section = section_index.Find(".got", SHT_PROGBITS);
+      const Shdr* text_section = section_index.Find(".text", SHT_PROGBITS);
+      info->LoadedSection(".eh_frame");
+      if (concurrent)
+        eh_frame_fragment.reset(new_fragment());
+      Module* target = concurrent ? eh_frame_fragment.get() : module;
+      eh_frame_stage.reset(new LoadStage(concurrent, [=, &eh_frame_result]() {
+        eh_frame_result =
+            LoadDwarfCFI<ElfClass>(obj_file, elf_header, ".eh_frame",
+                                   eh_frame_section, true,
+                                   got_section, text_section, big_endian,
+                                   options.thread_count, target);
+      }));
+    }
+  }
+
   if ((options.symbol_data & SYMBOLS_AND_FILES) ||
       (options.symbol_data & INLINES)) {
+    // The symbol table and the DWARF units mostly name the same functions;
+    // demangle each name once for all of them.
+    google_breakpad::DemangleCache demangle_cache;
+
+    // See if there are export symbols available.  Look in dynsym only if
+    // the full symbol table is not available.
+    const Shdr* symbols_section = section_index.Find(".symtab", SHT_SYMTAB);
+    const Shdr* strings_section = section_index.Find(".strtab", SHT_STRTAB);
+    // A file stripped down to its .dynsym may keep the rest of its symbol
+    // table as MiniDebugInfo in .gnu_debugdata; read both.
+    const Shdr* gnu_debugdata_section = NULL;
+    if (symbols_section && strings_section) {
+      info->LoadedSection(".symtab");
+    } else {
+      symbols_section = section_index.Find(".dynsym", SHT_DYNSYM);
+      strings_section = section_index.Find(".dynstr", SHT_STRTAB);
+      if (symbols_section && strings_section)
+        info->LoadedSection(".dynsym");
+      else
+        symbols_section = NULL;
+#ifdef HAVE_LIBLZMA
+      gnu_debugdata_section =
+          section_index.Find(".gnu_debugdata", SHT_PROGBITS);
+      if (gnu_debugdata_section)
+        info->LoadedSection(".gnu_debugdata");
+#endif
+    }
+    bool symbols_result = false;
+    scoped_ptr<Module> symbols_fragment;
+    scoped_ptr<LoadStage> symbols_stage;
+    if (symbols_section || gnu_debugdata_section) {
+      if (concurrent)
+        symbols_fragment.reset(new_fragment());
+      Module* target = concurrent ? symbols_fragment.get() : module;
+      symbols_stage.reset(new LoadStage(concurrent, [&, target]() {
+        if (symbols_section) {
+          symbols_result =
+              ELFSymbolsToModule(GetOffset<ElfClass, uint8_t>(
+                                     elf_header, symbols_section->sh_offset),
+                                 symbols_section->sh_size,
+                                 GetOffset<ElfClass, uint8_t>(
+                                     elf_header, strings_section->sh_offset),
+                                 strings_section->sh_size,
+                                 big_endian,
+                                 ElfClass::kAddrSize,
+                                 target,
+                                 &demangle_cache);
+        }
+#ifdef HAVE_LIBLZMA
+        if (gnu_debugdata_section &&
+            LoadMiniDebugInfo<ElfClass>(obj_file, elf_header,
+                                        gnu_debugdata_section, big_endian,
+                                        target, &demangle_cache)) {
+          symbols_result = true;
+        }
+#endif
+      }));
+    }
+
 #ifndef NO_STABS_SUPPORT
     // Look for STABS debugging information, and load it if present.
-    const Shdr* stab_section =
-      FindElfSectionByName<ElfClass>(".stab", SHT_PROGBITS,
-                                     sections, names, names_end,
-                                     elf_header->e_shnum);
+    const Shdr* stab_section = section_index.Find(".stab", SHT_PROGBITS);
     if (stab_section) {
       const Shdr* stabstr_section = stab_section->sh_link + sections;
       if (stabstr_section) {
@@ -909,79 +1547,22 @@ bool LoadSymbols(const string& obj_file,
     }
 #endif  // NO_STABS_SUPPORT
 
-    // See if there are export symbols available.
-    const Shdr* symtab_section =
-        FindElfSectionByName<ElfClass>(".symtab", SHT_SYMTAB,
-                                       sections, names, names_end,
-                                       elf_header->e_shnum);
-    const Shdr* strtab_section =
-        FindElfSectionByName<ElfClass>(".strtab", SHT_STRTAB,
-                                       sections, names, names_end,
-                                       elf_header->e_shnum);
-    if (symtab_section && strtab_section) {
-      info->LoadedSection(".symtab");
-
-      const uint8_t* symtab =
-          GetOffset<ElfClass, uint8_t>(elf_header,
-                                       symtab_section->sh_offset);
-      const uint8_t* strtab =
-          GetOffset<ElfClass, uint8_t>(elf_header,
-                                       strtab_section->sh_offset);
-      bool result =
-          ELFSymbolsToModule(symtab,
-                             symtab_section->sh_size,
-                             strtab,
-                             strtab_section->sh_size,
-                             big_endian,
-                             ElfClass::kAddrSize,
-                             module);
-      found_usable_info = found_usable_info || result;
-    } else {
-      // Look in dynsym only if full symbol table was not available.
-      const Shdr* dynsym_section =
-          FindElfSectionByName<ElfClass>(".dynsym", SHT_DYNSYM,
-                                         sections, names, names_end,
-                                         elf_header->e_shnum);
-      const Shdr* dynstr_section =
-          FindElfSectionByName<ElfClass>(".dynstr", SHT_STRTAB,
-                                         sections, names, names_end,
-                                         elf_header->e_shnum);
-      if (dynsym_section && dynstr_section) {
-        info->LoadedSection(".dynsym");
-
-        const uint8_t* dynsyms =
-            GetOffset<ElfClass, uint8_t>(elf_header,
-                                         dynsym_section->sh_offset);
-        const uint8_t* dynstrs =
-            GetOffset<ElfClass, uint8_t>(elf_header,
-                                         dynstr_section->sh_offset);
-        bool result =
-            ELFSymbolsToModule(dynsyms,
-                               dynsym_section->sh_size,
-                               dynstrs,
-                               dynstr_section->sh_size,
-                               big_endian,
-                               ElfClass::kAddrSize,
-                               module);
-        found_usable_info = found_usable_info || result;
-      }
+    if (symbols_stage.get()) {
+      symbols_stage->Finish();
+      if (symbols_fragment.get())
+        module->AddUnitExterns(symbols_fragment.get());
+      found_usable_info = found_usable_info || symbols_result;
     }
 
     // Only Load .debug_info after loading symbol table to avoid duplicate
     // PUBLIC records.
     // Look for DWARF debugging information, and load it if present.
-    const Shdr* dwarf_section =
-      FindElfSectionByName<ElfClass>(".debug_info", SHT_PROGBITS,
-                                     sections, names, names_end,
-                                     elf_header->e_shnum);
+    const Shdr* dwarf_section = section_index.Find(".debug_info", SHT_PROGBITS);
 
     // .debug_info section type is SHT_PROGBITS for mips on pnacl toolchains,
     // but MIPS_DWARF for regular gnu toolchains, so both need to be checked
     if (elf_header->e_machine == EM_MIPS && !dwarf_section) {
-      dwarf_section =
-        FindElfSectionByName<ElfClass>(".debug_info", SHT_MIPS_DWARF,
-                                       sections, names, names_end,
-                                       elf_header->e_shnum);
+      dwarf_section = section_index.Find(".debug_info", SHT_MIPS_DWARF);
     }
 
     if (dwarf_section) {
@@ -990,7 +1571,10 @@ bool LoadSymbols(const string& obj_file,
       info->LoadedSection(".debug_info");
       bool result = LoadDwarf<ElfClass>(obj_file, elf_header, big_endian,
                                options.handle_inter_cu_refs,
-                               options.symbol_data & INLINES, module);
+                               options.symbol_data & INLINES,
+                               options.thread_count,
+                               options.unit_cache_directory,
+                               &demangle_cache, module);
       usable_info_parsed = usable_info_parsed || result;
       if (!result){
         fprintf(stderr, "%s: \".debug_info\" section found, but failed to load "
@@ -999,60 +1583,21 @@ bool LoadSymbols(const string& obj_file,
     }
   }
 
-  if (options.symbol_data & CFI) {
-    // Dwarf Call Frame Information (CFI) is actually independent from
-    // the other DWARF debugging information, and can be used alone.
-    const Shdr* dwarf_cfi_section =
-        FindElfSectionByName<ElfClass>(".debug_frame", SHT_PROGBITS,
-                                       sections, names, names_end,
-                                       elf_header->e_shnum);
-
-    // .debug_frame section type is SHT_PROGBITS for mips on pnacl toolchains,
-    // but MIPS_DWARF for regular gnu toolchains, so both need to be checked
-    if (elf_header->e_machine == EM_MIPS && !dwarf_cfi_section) {
-      dwarf_cfi_section =
-          FindElfSectionByName<ElfClass>(".debug_frame", SHT_MIPS_DWARF,
-                                        sections, names, names_end,
-                                        elf_header->e_shnum);
-    }
-
-    if (dwarf_cfi_section) {
-      // Ignore the return value of this function; even without call frame
-      // information, the other debugging information could be perfectly
-      // useful.
-      info->LoadedSection(".debug_frame");
-      bool result =
-          LoadDwarfCFI<ElfClass>(obj_file, elf_header, ".debug_frame",
-                                 dwarf_cfi_section, false, 0, 0, big_endian,
-                                 module);
-      found_usable_info = found_usable_info || result;
-    }
-
-    // Linux C++ exception handling information can also provide
-    // unwinding data.
-    const Shdr* eh_frame_section =
-        FindElfSectionByName<ElfClass>(".eh_frame", SHT_PROGBITS,
-                                       sections, names, names_end,
-                                       elf_header->e_shnum);
-    if (eh_frame_section) {
-      // Pointers in .eh_frame data may be relative to the base addresses of
-      // certain sections. Provide those sections if present.
-      const Shdr* got_section =
-          FindElfSectionByName<ElfClass>(".got", SHT_PROGBITS,
-                                         sections, names, names_end,
-                                         elf_header->e_shnum);
-      const Shdr* text_section =
-          FindElfSectionByName<ElfClass>(".text", SHT_PROGBITS,
-                                         sections, names, names_end,
-                                         elf_header->e_shnum);
-      info->LoadedSection(".eh_frame");
-      // As above, ignore the return value of this function.
-      bool result =
-          LoadDwarfCFI<ElfClass>(obj_file, elf_header, ".eh_frame",
-                                 eh_frame_section, true,
-                                 got_section, text_section, big_endian, module);
-      found_usable_info = found_usable_info || result;
-    }
+  // Ignore the results of the call frame information stages beyond
+  // noting that some usable information was found; even without call frame
+  // information, the other debugging information could be perfectly
+  // useful.
+  if (debug_frame_stage.get()) {
+    debug_frame_stage->Finish();
+    if (debug_frame_fragment.get())
+      module->AddUnitStackFrameEntries(debug_frame_fragment.get());
+    found_usable_info = found_usable_info || debug_frame_result;
+  }
+  if (eh_frame_stage.get()) {
+    eh_frame_stage->Finish();
+    if (eh_frame_fragment.get())
+      module->AddUnitStackFrameEntries(eh_frame_fragment.get());
+    found_usable_info = found_usable_info || eh_frame_result;
   }
 
   if (!found_debug_info_section) {
@@ -1060,40 +1605,20 @@ bool LoadSymbols(const string& obj_file,
             " (no \".stab\" or \".debug_info\" sections)\n",
             obj_file.c_str());
 
-    // Failed, but maybe there's a .gnu_debuglink section?
+    // Failed, but maybe there's a debug file?  It is looked for above.
     if (read_gnu_debug_link) {
-      const Shdr* gnu_debuglink_section
-          = FindElfSectionByName<ElfClass>(".gnu_debuglink", SHT_PROGBITS,
-                                           sections, names,
-                                           names_end, elf_header->e_shnum);
-      if (gnu_debuglink_section) {
-        if (!info->debug_dirs().empty()) {
-          const uint8_t* debuglink_contents =
-              GetOffset<ElfClass, uint8_t>(elf_header,
-                                           gnu_debuglink_section->sh_offset);
-          string debuglink_file =
-              ReadDebugLink(debuglink_contents,
-                            gnu_debuglink_section->sh_size,
-                            big_endian,
-                            obj_file,
-                            info->debug_dirs());
-          info->set_debuglink_file(debuglink_file);
-        } else {
-          fprintf(stderr, ".gnu_debuglink section found in '%s', "
-                  "but no debug path specified.\n", obj_file.c_str());
-        }
-      } else {
-        fprintf(stderr, "%s does not contain a .gnu_debuglink section.\n",
-                obj_file.c_str());
+      if (!info->finding_debug_file()) {
+        fprintf(stderr, "%s has neither a build id nor a .gnu_debuglink "
+                "section.\n", obj_file.c_str());
       }
     } else {
       // Return true if some usable information was found, since the caller
-      // doesn't want to use .gnu_debuglink.
+      // doesn't want to look for a debug file.
       return found_usable_info;
     }
 
-    // No debug info was found, let the user try again with .gnu_debuglink
-    // if present.
+    // No debug info was found, let the user try again with the debug file
+    // if one is found.
     return false;
   }
 
@@ -1215,15 +1740,28 @@ bool ReadSymbolDataElfClass(const typename ElfClass::Ehdr* elf_header,
                                       module, options.enable_multiple_field)) {
     return false;
   }
+  module->SetMemoryBudget(options.memory_budget);
+  // Nothing reads the functions' lines before they are written.
+  module->SetCompactLines(true);
+  module->SetWriteThreadCount(options.thread_count);
 
   // Figure out what endianness this file is.
   bool big_endian;
   if (!ElfEndianness<ElfClass>(elf_header, &big_endian))
     return false;
 
-  LoadSymbolsInfo<ElfClass> info(debug_dirs);
+  // Debug files are looked for in DEBUG_DIRS, and then by the finder in
+  // OPTIONS.
+  google_breakpad::LocalDebugFileFinder local_finder(debug_dirs,
+                                                     options.thread_count);
+  std::vector<DebugFileFinder*> finders;
+  if (!debug_dirs.empty())
+    finders.push_back(&local_finder);
+  if (options.debug_file_finder)
+    finders.push_back(options.debug_file_finder);
+  LoadSymbolsInfo<ElfClass> info(finders);
   if (!LoadSymbols<ElfClass>(obj_filename, big_endian, elf_header,
-                             !debug_dirs.empty(), &info,
+                             info.can_find_debug_file(), &info,
                              options, module.get())) {
     const string debuglink_file = info.debuglink_file();
     if (debuglink_file.empty())
@@ -43,6 +43,7 @@
 
 namespace google_breakpad {
 
+class DebugFileFinder;
 class Module;
 
 struct DumpOptions {
@@ -53,19 +54,48 @@ struct DumpOptions {
       : symbol_data(symbol_data),
         handle_inter_cu_refs(handle_inter_cu_refs),
         enable_multiple_field(enable_multiple_field),
-        preserve_load_address(preserve_load_address) {}
+        preserve_load_address(preserve_load_address),
+        thread_count(1),
+        memory_budget(0),
+        debug_file_finder(NULL) {}
 
   SymbolData symbol_data;
   bool handle_inter_cu_refs;
   bool enable_multiple_field;
   bool preserve_load_address;
+  // The number of threads that decompress compressed debug sections and
+  // convert DWARF compilation units and call frame information.  With
+  // more than one, units and runs of CFI entries are converted separately
+  // and merged in their original order, giving the same output as a
+  // single thread.  Files whose units refer to one another's DIEs, or
+  // that use split DWARF, are converted one unit at a time regardless.
+  // Without a memory budget, the symbol table, .debug_frame and .eh_frame
+  // are also each converted alongside the STABS and DWARF.
+  int thread_count;
+  // The bytes of function line and inline data and of call frame info
+  // kept in memory before it is spilled to temporary files; zero keeps it
+  // all in memory.  See Module::SetMemoryBudget.
+  size_t memory_budget;
+  // An existing directory in which the functions converted from each
+  // DWARF compilation unit are kept, so that later dumps reuse those of
+  // the units that haven't changed, even if they moved.  Empty, the
+  // default, keeps none.  See DwarfUnitCache.
+  string unit_cache_directory;
+  // Where to look for the debug file of a stripped file, such as a
+  // DebuginfodFinder, once it isn't found in the debug directories.  NULL,
+  // the default, looks in those alone.  The search runs alongside the
+  // conversion of the file's symbol table and call frame information
+  // when thread_count is more than one.  The caller owns the finder, and
+  // must not use it for two dumps at once.
+  DebugFileFinder* debug_file_finder;
 };
 
 // Find all the debugging information in OBJ_FILE, an ELF executable
 // or shared library, and write it to SYM_STREAM in the Breakpad symbol
 // file format.
-// If OBJ_FILE has been stripped but contains a .gnu_debuglink section,
-// then look for the debug file in DEBUG_DIRS.
+// If OBJ_FILE has been stripped but has a build id or a .gnu_debuglink
+// section, then look for the debug file in DEBUG_DIRS, and then with
+// OPTIONS.debug_file_finder.
 // SYMBOL_DATA allows limiting the type of symbol data written.
 bool WriteSymbolFile(const string& load_path,
                      const string& obj_file,
@@ -87,7 +117,8 @@ bool WriteSymbolFileHeader(const string& load_path,
 
 // As above, but simply return the debugging information in MODULE
 // instead of writing it to a stream. The caller owns the resulting
-// Module object and must delete it when finished.
+// Module object and must delete it when finished.  The module keeps its
+// functions' lines packed; see Module::SetCompactLines.
 bool ReadSymbolData(const string& load_path,
                     const string& obj_file,
                     const string& obj_os,
@@ -0,0 +1,701 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dump_symbols_benchmark.cc: Times the stages of dumping symbols from a
+// synthetic ELF file, and measures the memory each one uses: reading
+// DWARF compilation units and line programs, reading DWARF CFI, reading
+// the ELF symbol table, and Module::Write.
+//
+// Usage: dump_symbols_benchmark [-c units] [-d dies] [-l lines]
+//                               [-f entries] [-t threads] [-i iterations]
+//                               [-j]
+//
+// The files are built with synth_elf and the DWARF test assemblers.
+// .debug_info holds |units| compilation units of |dies| functions each,
+// and each unit's line program has |lines| rows.  .debug_frame holds
+// |entries| FDEs, and .symtab one mangled symbol per function.  Each stage
+// reads a file holding only its own sections; the write stage writes a
+// module read from a file holding all of them.
+//
+// For each stage, the benchmark reports the wall time, the number and
+// size of the allocations made through operator new, and the peak
+// resident set size, both overall and above what was resident when the
+// stage began.  With -j, the results are printed as JSON so that runs can
+// be compared over time.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <assert.h>
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "common/dwarf/cfi_assembler.h"
+#include "common/dwarf/dwarf2enums.h"
+#include "common/dwarf/dwarf2reader_test_common.h"
+#include "common/linux/dump_symbols.h"
+#include "common/linux/synth_elf.h"
+#include "common/module.h"
+#include "common/path_helper.h"
+#include "common/scoped_ptr.h"
+#include "common/test_assembler.h"
+#include "common/using_std_string.h"
+
+namespace {
+
+// Counts the allocations made through operator new.  Memory that C code
+// allocates with malloc directly, such as zlib's, isn't counted.
+std::atomic<uint64_t> allocation_count(0);
+std::atomic<uint64_t> allocated_bytes(0);
+
+}  // namespace
+
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  void* pointer = malloc(size ? size : 1);
+  if (!pointer)
+    throw std::bad_alloc();
+  return pointer;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& nothrow) noexcept {
+  return operator new(size, nothrow);
+}
+
+void operator delete(void* pointer) noexcept {
+  free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+  free(pointer);
+}
+
+namespace google_breakpad {
+
+// Not exported by dump_symbols.h; see dump_symbols_unittest.cc.
+bool ReadSymbolDataInternal(const uint8_t* obj_file,
+                            const string& obj_filename,
+                            const string& obj_os,
+                            const string& module_id,
+                            const std::vector<string>& debug_dir,
+                            const DumpOptions& options,
+                            Module** module);
+
+}  // namespace google_breakpad
+
+namespace {
+
+using google_breakpad::CFISection;
+using google_breakpad::DumpOptions;
+using google_breakpad::Module;
+using google_breakpad::ReadSymbolDataInternal;
+using google_breakpad::scoped_ptr;
+using google_breakpad::synth_elf::ELF;
+using google_breakpad::synth_elf::StringTable;
+using google_breakpad::synth_elf::SymbolTable;
+using google_breakpad::test_assembler::Label;
+using google_breakpad::test_assembler::Section;
+using google_breakpad::test_assembler::kLittleEndian;
+using std::vector;
+
+struct Options {
+  Options()
+      : num_units(100),
+        dies_per_unit(100),
+        lines_per_unit(2000),
+        num_cfi_entries(10000),
+        threads(1),
+        iterations(3),
+        json(false) { }
+
+  uint64_t num_units;
+  uint64_t dies_per_unit;
+  uint64_t lines_per_unit;
+  uint64_t num_cfi_entries;
+  uint64_t threads;
+  uint64_t iterations;
+  bool json;
+};
+
+// The sections that a synthetic file holds.
+enum Sections {
+  kDwarf = 1 << 0,
+  kCFI = 1 << 1,
+  kSymbols = 1 << 2,
+  kEverything = kDwarf | kCFI | kSymbols
+};
+
+// Where the synthetic code is.  Each line row covers four bytes.
+const uint64_t kTextAddress = 0x10000;
+const uint64_t kBytesPerLine = 4;
+const uint64_t kCFIEntrySize = 0x20;
+
+// The result of one stage.
+struct Result {
+  string name;
+  uint64_t iterations;
+  double ns_per_iteration;
+  // Counted for the last iteration.
+  uint64_t allocations;
+  uint64_t allocated_bytes;
+  // The most resident at once in any iteration, and how much that was
+  // above what was resident when the iteration began, in kilobytes.
+  uint64_t peak_rss_kb;
+  uint64_t peak_rss_growth_kb;
+  // What one iteration covers, such as functions read, and how many.
+  const char* item;
+  uint64_t items_per_iteration;
+};
+
+// Returns the bytes of code each unit covers.
+uint64_t UnitSize(const Options& options) {
+  return std::max(options.lines_per_unit, options.dies_per_unit) *
+         kBytesPerLine;
+}
+
+uint64_t FunctionSize(const Options& options) {
+  return UnitSize(options) / options.dies_per_unit;
+}
+
+uint64_t FunctionAddress(const Options& options, uint64_t unit,
+                         uint64_t die) {
+  return kTextAddress + unit * UnitSize(options) +
+         die * FunctionSize(options);
+}
+
+string FunctionName(uint64_t unit, uint64_t die) {
+  return "function_" + std::to_string(unit) + "_" + std::to_string(die);
+}
+
+// Returns the Itanium mangling of bench::NAME().
+string MangledName(const string& name) {
+  return "_ZN5bench" + std::to_string(name.size()) + name + "Ev";
+}
+
+string Contents(Section& section) {
+  string contents;
+  if (!section.GetContents(&contents)) {
+    fprintf(stderr, "Can't assemble a synthetic section\n");
+    exit(1);
+  }
+  return contents;
+}
+
+string Abbreviations() {
+  TestAbbrevTable abbrevs;
+  abbrevs.Abbrev(1, google_breakpad::DW_TAG_compile_unit,
+                 google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .Attribute(google_breakpad::DW_AT_comp_dir,
+                 google_breakpad::DW_FORM_string)
+      .Attribute(google_breakpad::DW_AT_low_pc, google_breakpad::DW_FORM_addr)
+      .Attribute(google_breakpad::DW_AT_high_pc,
+                 google_breakpad::DW_FORM_data4)
+      .Attribute(google_breakpad::DW_AT_stmt_list,
+                 google_breakpad::DW_FORM_sec_offset)
+      .EndAbbrev()
+      .Abbrev(2, google_breakpad::DW_TAG_subprogram,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .Attribute(google_breakpad::DW_AT_low_pc, google_breakpad::DW_FORM_addr)
+      .Attribute(google_breakpad::DW_AT_high_pc,
+                 google_breakpad::DW_FORM_data4)
+      .EndAbbrev()
+      .EndTable();
+  return Contents(abbrevs);
+}
+
+// Appends a version 4 line program for |unit| to |lines|: one file, and
+// a row every kBytesPerLine bytes, each a line further on.
+void AppendLineProgram(const Options& options, uint64_t unit,
+                       Section* lines) {
+  const uint8_t kLineBase = static_cast<uint8_t>(-5);
+  const uint8_t kLineRange = 14;
+  const uint8_t kOpcodeBase = 13;
+  const uint8_t kStandardOpcodeLengths[] = {
+    0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1
+  };
+
+  Label unit_length, header_length;
+  lines->D32(unit_length);
+  uint64_t unit_start = lines->Size();
+  lines->D16(4).D32(header_length);
+  uint64_t header_start = lines->Size();
+  lines->D8(1)   // minimum_instruction_length
+      .D8(1)     // maximum_operations_per_instruction
+      .D8(1)     // default_is_stmt
+      .D8(kLineBase).D8(kLineRange).D8(kOpcodeBase);
+  for (uint8_t length : kStandardOpcodeLengths)
+    lines->D8(length);
+  lines->D8(0);  // No include directories.
+  lines->AppendCString("unit_" + std::to_string(unit) + ".cc")
+      .ULEB128(0).ULEB128(0).ULEB128(0)
+      .D8(0);
+  header_length = lines->Size() - header_start;
+
+  lines->D8(0).ULEB128(9).D8(google_breakpad::DW_LNE_set_address)
+      .D64(FunctionAddress(options, unit, 0));
+  // A special opcode that advances the line by one and the address by
+  // kBytesPerLine, and appends a row.
+  const uint8_t advance_row =
+      (1 - static_cast<int8_t>(kLineBase)) + kLineRange * kBytesPerLine +
+      kOpcodeBase;
+  uint64_t end = UnitSize(options);
+  if (options.lines_per_unit) {
+    lines->D8(google_breakpad::DW_LNS_copy);
+    for (uint64_t row = 1; row < options.lines_per_unit; ++row)
+      lines->D8(advance_row);
+    end -= (options.lines_per_unit - 1) * kBytesPerLine;
+  }
+  lines->D8(google_breakpad::DW_LNS_advance_pc).ULEB128(end)
+      .D8(0).ULEB128(1).D8(google_breakpad::DW_LNE_end_sequence);
+  unit_length = lines->Size() - unit_start;
+}
+
+// Appends .debug_info, .debug_abbrev and .debug_line to |elf|.
+void AddDwarf(const Options& options, ELF* elf) {
+  string info;
+  Section lines(kLittleEndian);
+  for (uint64_t unit = 0; unit < options.num_units; ++unit) {
+    uint64_t line_offset = lines.Size();
+    AppendLineProgram(options, unit, &lines);
+
+    TestCompilationUnit cu;
+    cu.set_format_size(4);
+    cu.set_endianness(kLittleEndian);
+    cu.Header(4, Label(0), 8, google_breakpad::DW_UT_compile)
+        .ULEB128(1)
+        .AppendCString("unit_" + std::to_string(unit) + ".cc")
+        .AppendCString("/bench")
+        .D64(FunctionAddress(options, unit, 0))
+        .D32(UnitSize(options))
+        .D32(line_offset);
+    for (uint64_t die = 0; die < options.dies_per_unit; ++die) {
+      cu.ULEB128(2)
+          .AppendCString(FunctionName(unit, die))
+          .D64(FunctionAddress(options, unit, die))
+          .D32(FunctionSize(options));
+    }
+    cu.D8(0);
+    cu.Finish();
+    info += Contents(cu);
+  }
+
+  Section info_section(kLittleEndian);
+  info_section.Append(info);
+  Section abbrevs(kLittleEndian);
+  abbrevs.Append(Abbreviations());
+  elf->AddSection(".debug_info", info_section, SHT_PROGBITS);
+  elf->AddSection(".debug_abbrev", abbrevs, SHT_PROGBITS);
+  elf->AddSection(".debug_line", lines, SHT_PROGBITS);
+}
+
+// Appends a .debug_frame with one CIE and an FDE for each entry, in the
+// form x86-64 prologues take, to |elf|.
+void AddCFI(const Options& options, ELF* elf) {
+  CFISection frame(kLittleEndian, 8);
+  Label cie;
+  frame.Mark(&cie)
+      .CIEHeader(1, -8, 16, 3)
+      .D8(google_breakpad::DW_CFA_def_cfa).ULEB128(7).ULEB128(8)
+      .D8(google_breakpad::DW_CFA_offset | 16).ULEB128(1)
+      .FinishEntry();
+  for (uint64_t entry = 0; entry < options.num_cfi_entries; ++entry) {
+    frame.FDEHeader(cie, kTextAddress + entry * kCFIEntrySize, kCFIEntrySize)
+        .D8(google_breakpad::DW_CFA_advance_loc | 1)
+        .D8(google_breakpad::DW_CFA_def_cfa_offset).ULEB128(16)
+        .D8(google_breakpad::DW_CFA_offset | 6).ULEB128(2)
+        .D8(google_breakpad::DW_CFA_advance_loc | 3)
+        .D8(google_breakpad::DW_CFA_def_cfa_register).ULEB128(6)
+        .FinishEntry();
+  }
+  elf->AddSection(".debug_frame", frame, SHT_PROGBITS);
+}
+
+// Appends a .symtab naming each function, and its .strtab, to |elf|.
+void AddSymbols(const Options& options, int text_index, ELF* elf) {
+  StringTable names(kLittleEndian);
+  SymbolTable symbols(kLittleEndian, 8, names);
+  for (uint64_t unit = 0; unit < options.num_units; ++unit) {
+    for (uint64_t die = 0; die < options.dies_per_unit; ++die) {
+      symbols.AddSymbol(MangledName(FunctionName(unit, die)),
+                        FunctionAddress(options, unit, die),
+                        FunctionSize(options),
+                        ELF32_ST_INFO(STB_GLOBAL, STT_FUNC), text_index);
+    }
+  }
+  int names_index = elf->AddSection(".strtab", names, SHT_STRTAB);
+  elf->AddSection(".symtab", symbols, SHT_SYMTAB, SHF_ALLOC, 0, names_index,
+                  sizeof(Elf64_Sym));
+}
+
+// Returns an x86-64 ELF file holding |sections|.
+vector<uint8_t> BuildElf(const Options& options, int sections) {
+  ELF elf(EM_X86_64, ELFCLASS64, kLittleEndian);
+  // The file's identifier is a hash of the start of .text.
+  Section text(kLittleEndian);
+  text.Append(4096, 0xcc);
+  int text_index = elf.AddSection(".text", text, SHT_PROGBITS,
+                                  SHF_ALLOC | SHF_EXECINSTR, kTextAddress);
+  if (sections & kSymbols)
+    AddSymbols(options, text_index, &elf);
+  if (sections & kDwarf)
+    AddDwarf(options, &elf);
+  if (sections & kCFI)
+    AddCFI(options, &elf);
+  elf.Finish();
+  string file = Contents(elf);
+  return vector<uint8_t>(file.begin(), file.end());
+}
+
+// A stream buffer that counts the bytes written to it and drops them.
+class CountingStreamBuf : public std::streambuf {
+ public:
+  CountingStreamBuf() : count_(0) { }
+
+  uint64_t count() const { return count_; }
+
+ protected:
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+      ++count_;
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char*, std::streamsize n) override {
+    count_ += n;
+    return n;
+  }
+
+ private:
+  uint64_t count_;
+};
+
+// Returns the value of |field|, in kilobytes, from /proc/self/status, or
+// zero if it can't be read.
+uint64_t ReadStatusKilobytes(const char* field) {
+  FILE* status = fopen("/proc/self/status", "r");
+  if (!status)
+    return 0;
+  char line[256];
+  uint64_t value = 0;
+  size_t field_length = strlen(field);
+  while (fgets(line, sizeof(line), status)) {
+    if (strncmp(line, field, field_length) == 0 &&
+        line[field_length] == ':') {
+      value = strtoull(line + field_length + 1, NULL, 10);
+      break;
+    }
+  }
+  fclose(status);
+  return value;
+}
+
+// Measures the memory one run of a stage uses.
+class MemoryProbe {
+ public:
+  // Returns memory that earlier runs freed to the system and resets the
+  // peak resident set size to what is resident now, if the kernel
+  // allows it, and starts counting allocations.
+  MemoryProbe() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    FILE* clear_refs = fopen("/proc/self/clear_refs", "w");
+    peak_was_reset_ = clear_refs && fputs("5", clear_refs) >= 0;
+    if (clear_refs && fclose(clear_refs) != 0)
+      peak_was_reset_ = false;
+    start_rss_kb_ = ReadStatusKilobytes("VmRSS");
+    start_allocations_ = allocation_count.load(std::memory_order_relaxed);
+    start_bytes_ = allocated_bytes.load(std::memory_order_relaxed);
+  }
+
+  uint64_t allocations() const {
+    return allocation_count.load(std::memory_order_relaxed) -
+           start_allocations_;
+  }
+
+  uint64_t bytes() const {
+    return allocated_bytes.load(std::memory_order_relaxed) - start_bytes_;
+  }
+
+  // Returns the peak resident set size since the probe was made.  Where
+  // the peak couldn't be reset, this is the process's peak so far.
+  uint64_t peak_rss_kb() const {
+    uint64_t peak = peak_was_reset_ ? ReadStatusKilobytes("VmHWM") : 0;
+    if (!peak) {
+      struct rusage usage;
+      if (getrusage(RUSAGE_SELF, &usage) == 0)
+        peak = usage.ru_maxrss;
+    }
+    return peak;
+  }
+
+  uint64_t peak_rss_growth_kb() const {
+    uint64_t peak = peak_rss_kb();
+    return peak > start_rss_kb_ ? peak - start_rss_kb_ : 0;
+  }
+
+ private:
+  bool peak_was_reset_;
+  uint64_t start_rss_kb_;
+  uint64_t start_allocations_;
+  uint64_t start_bytes_;
+};
+
+// Reads the module in |file| with |symbol_data|, exiting on failure.
+Module* ReadModule(const Options& options, const vector<uint8_t>& file,
+                   SymbolData symbol_data) {
+  DumpOptions dump_options(symbol_data, true, false, false);
+  dump_options.thread_count = static_cast<int>(options.threads);
+  Module* module = NULL;
+  if (!ReadSymbolDataInternal(&file[0], "bench.so", "Linux", "",
+                              vector<string>(), dump_options, &module)) {
+    fprintf(stderr, "Can't read the synthetic file\n");
+    exit(1);
+  }
+  return module;
+}
+
+// Times reading a file holding |sections| with |symbol_data|, and measures
+// its memory.
+Result BenchmarkRead(const Options& options, const char* name, int sections,
+                     SymbolData symbol_data, const char* item,
+                     uint64_t items) {
+  vector<uint8_t> file = BuildElf(options, sections);
+  Result result = {name, options.iterations, 0, 0, 0, 0, 0, item, items};
+  double total_ns = 0;
+  for (uint64_t i = 0; i < options.iterations; ++i) {
+    MemoryProbe probe;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    scoped_ptr<Module> module(ReadModule(options, file, symbol_data));
+    total_ns += std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+    result.allocations = probe.allocations();
+    result.allocated_bytes = probe.bytes();
+    result.peak_rss_kb = std::max(result.peak_rss_kb, probe.peak_rss_kb());
+    result.peak_rss_growth_kb =
+        std::max(result.peak_rss_growth_kb, probe.peak_rss_growth_kb());
+  }
+  result.ns_per_iteration = total_ns / options.iterations;
+  return result;
+}
+
+// Times writing a module read from a file holding every section, and
+// measures its memory.  Each iteration writes a freshly read module.
+Result BenchmarkWrite(const Options& options) {
+  vector<uint8_t> file = BuildElf(options, kEverything);
+  Result result = {"write", options.iterations, 0, 0, 0, 0, 0, "bytes", 0};
+  double total_ns = 0;
+  for (uint64_t i = 0; i < options.iterations; ++i) {
+    scoped_ptr<Module> module(
+        ReadModule(options, file, ALL_SYMBOL_DATA));
+    CountingStreamBuf buffer;
+    std::ostream stream(&buffer);
+    MemoryProbe probe;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    if (!module->Write(stream, ALL_SYMBOL_DATA)) {
+      fprintf(stderr, "Can't write the synthetic module\n");
+      exit(1);
+    }
+    total_ns += std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+    result.allocations = probe.allocations();
+    result.allocated_bytes = probe.bytes();
+    result.peak_rss_kb = std::max(result.peak_rss_kb, probe.peak_rss_kb());
+    result.peak_rss_growth_kb =
+        std::max(result.peak_rss_growth_kb, probe.peak_rss_growth_kb());
+    result.items_per_iteration = buffer.count();
+  }
+  result.ns_per_iteration = total_ns / options.iterations;
+  return result;
+}
+
+void PrintResults(const Options& options, const vector<Result>& results) {
+  if (!options.json) {
+    for (const Result& result : results) {
+      printf("%-12s %14.0f ns/iteration %10llu allocations %12llu bytes "
+             "%8llu KB peak RSS (+%llu KB)  (%llu %s)\n",
+             result.name.c_str(), result.ns_per_iteration,
+             static_cast<unsigned long long>(result.allocations),
+             static_cast<unsigned long long>(result.allocated_bytes),
+             static_cast<unsigned long long>(result.peak_rss_kb),
+             static_cast<unsigned long long>(result.peak_rss_growth_kb),
+             static_cast<unsigned long long>(result.items_per_iteration),
+             result.item);
+    }
+    return;
+  }
+
+  printf("{\n  \"parameters\": {\"units\": %llu, \"dies_per_unit\": %llu, "
+         "\"lines_per_unit\": %llu, \"cfi_entries\": %llu, "
+         "\"threads\": %llu},\n  \"benchmarks\": [\n",
+         static_cast<unsigned long long>(options.num_units),
+         static_cast<unsigned long long>(options.dies_per_unit),
+         static_cast<unsigned long long>(options.lines_per_unit),
+         static_cast<unsigned long long>(options.num_cfi_entries),
+         static_cast<unsigned long long>(options.threads));
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& result = results[i];
+    printf("    {\"name\": \"%s\", \"iterations\": %llu, "
+           "\"ns_per_iteration\": %.1f, \"allocations\": %llu, "
+           "\"allocated_bytes\": %llu, \"peak_rss_kb\": %llu, "
+           "\"peak_rss_growth_kb\": %llu, \"%s\": %llu}%s\n",
+           result.name.c_str(),
+           static_cast<unsigned long long>(result.iterations),
+           result.ns_per_iteration,
+           static_cast<unsigned long long>(result.allocations),
+           static_cast<unsigned long long>(result.allocated_bytes),
+           static_cast<unsigned long long>(result.peak_rss_kb),
+           static_cast<unsigned long long>(result.peak_rss_growth_kb),
+           result.item,
+           static_cast<unsigned long long>(result.items_per_iteration),
+           i + 1 < results.size() ? "," : "");
+  }
+  printf("  ]\n}\n");
+}
+
+void Usage(int argc, char* argv[], bool error) {
+  FILE* fp = error ? stderr : stdout;
+  fprintf(fp,
+          "Usage: %s [options...]\n"
+          "Time the stages of dumping symbols from synthetic ELF files, and\n"
+          "measure their memory.\n"
+          "\n"
+          "Options:\n"
+          "  -c <units>\t Compilation units (default 100)\n"
+          "  -d <dies>\t Function DIEs in each unit (default 100)\n"
+          "  -l <lines>\t Line rows in each unit (default 2000)\n"
+          "  -f <entries>\t CFI entries (default 10000)\n"
+          "  -t <threads>\t Threads reading DWARF and CFI (default 1)\n"
+          "  -i <iterations> Runs of each stage (default 3)\n"
+          "  -j\t\t Print results as JSON\n"
+          "  -h:\t\t Usage\n",
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+void SetupOptions(int argc, char* argv[], Options* options) {
+  int ch;
+  while ((ch = getopt(argc, argv, "c:d:l:f:t:i:jh")) != -1) {
+    switch (ch) {
+      case 'c':
+        options->num_units = strtoull(optarg, NULL, 0);
+        break;
+      case 'd':
+        options->dies_per_unit = strtoull(optarg, NULL, 0);
+        break;
+      case 'l':
+        options->lines_per_unit = strtoull(optarg, NULL, 0);
+        break;
+      case 'f':
+        options->num_cfi_entries = strtoull(optarg, NULL, 0);
+        break;
+      case 't':
+        options->threads = strtoull(optarg, NULL, 0);
+        break;
+      case 'i':
+        options->iterations = strtoull(optarg, NULL, 0);
+        break;
+      case 'j':
+        options->json = true;
+        break;
+      case 'h':
+        Usage(argc, argv, false);
+        exit(0);
+      default:
+        Usage(argc, argv, true);
+        exit(1);
+    }
+  }
+  if (options->num_units == 0 || options->dies_per_unit == 0 ||
+      options->num_cfi_entries == 0 || options->threads == 0 ||
+      options->iterations == 0 || optind != argc) {
+    Usage(argc, argv, true);
+    exit(1);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  SetupOptions(argc, argv, &options);
+
+  uint64_t functions = options.num_units * options.dies_per_unit;
+  vector<Result> results;
+  results.push_back(BenchmarkRead(options, "dwarf", kDwarf,
+                                  SYMBOLS_AND_FILES,
+                                  "functions", functions));
+  results.push_back(BenchmarkRead(options, "cfi", kCFI, CFI,
+                                  "entries", options.num_cfi_entries));
+  results.push_back(BenchmarkRead(options, "elf_symbols", kSymbols,
+                                  SYMBOLS_AND_FILES,
+                                  "symbols", functions));
+  results.push_back(BenchmarkWrite(options));
+  PrintResults(options, results);
+  return 0;
+}
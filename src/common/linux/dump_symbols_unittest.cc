@@ -38,6 +38,9 @@
 #include <elf.h>
 #include <link.h>
 #include <stdio.h>
+#ifdef HAVE_LIBLZMA
+#include <lzma.h>
+#endif
 
 #include <sstream>
 #include <vector>
@@ -154,6 +157,138 @@ TYPED_TEST(DumpSymbols, SimplePublic) {
   delete module;
 }
 
+// With several threads, the symbol table is converted alongside the rest,
+// and the result is the same.
+TYPED_TEST(DumpSymbols, SimplePublicThreads) {
+  ELF elf(TypeParam::kMachine, TypeParam::kClass, kLittleEndian);
+  Section text(kLittleEndian);
+  text.Append(4096, 0);
+  elf.AddSection(".text", text, SHT_PROGBITS);
+
+  StringTable table(kLittleEndian);
+  SymbolTable syms(kLittleEndian, TypeParam::kAddrSize, table);
+  syms.AddSymbol("superfunc",
+                   (typename TypeParam::Addr)0x1000,
+                   (typename TypeParam::Addr)0x10,
+                 ELF32_ST_INFO(STB_GLOBAL, STT_FUNC),
+                 SHN_UNDEF + 1);
+  syms.AddSymbol("otherfunc",
+                   (typename TypeParam::Addr)0x1000,
+                   (typename TypeParam::Addr)0x10,
+                 ELF32_ST_INFO(STB_GLOBAL, STT_FUNC),
+                 SHN_UNDEF + 1);
+  int index = elf.AddSection(".strtab", table, SHT_STRTAB);
+  elf.AddSection(".symtab", syms,
+                 SHT_SYMTAB,          // type
+                 SHF_ALLOC,           // flags
+                 0,                   // addr
+                 index,               // link
+                 sizeof(typename TypeParam::Sym));  // entsize
+
+  elf.Finish();
+  this->GetElfContents(elf);
+
+  Module* module;
+  DumpOptions options(ALL_SYMBOL_DATA, true, false, false);
+  options.thread_count = 4;
+  EXPECT_TRUE(ReadSymbolDataInternal(this->elfdata,
+                                     "foo",
+                                     "Linux",
+                                     "",
+                                     vector<string>(),
+                                     options,
+                                     &module));
+
+  stringstream s;
+  module->Write(s, ALL_SYMBOL_DATA);
+  const string expected =
+    string("MODULE Linux ") + TypeParam::kMachineName
+    + " 000000000000000000000000000000000 foo\n"
+    "INFO CODE_ID 00000000000000000000000000000000\n"
+    "PUBLIC 1000 0 superfunc\n";
+  EXPECT_EQ(expected, s.str());
+  delete module;
+}
+
+#ifdef HAVE_LIBLZMA
+// The symbols of MiniDebugInfo, an xz-compressed ELF file in the
+// .gnu_debugdata section, are read along with those of .dynsym.
+TYPED_TEST(DumpSymbols, MiniDebugInfo) {
+  ELF debug_elf(TypeParam::kMachine, TypeParam::kClass, kLittleEndian);
+  StringTable debug_table(kLittleEndian);
+  SymbolTable debug_syms(kLittleEndian, TypeParam::kAddrSize, debug_table);
+  debug_syms.AddSymbol("localfunc",
+                       (typename TypeParam::Addr)0x1100,
+                       (typename TypeParam::Addr)0x10,
+                       ELF32_ST_INFO(STB_LOCAL, STT_FUNC),
+                       SHN_UNDEF + 1);
+  int debug_index = debug_elf.AddSection(".strtab", debug_table, SHT_STRTAB);
+  debug_elf.AddSection(".symtab", debug_syms,
+                       SHT_SYMTAB,          // type
+                       0,                   // flags
+                       0,                   // addr
+                       debug_index,         // link
+                       sizeof(typename TypeParam::Sym));  // entsize
+  debug_elf.Finish();
+  string debug_contents;
+  ASSERT_TRUE(debug_elf.GetContents(&debug_contents));
+  vector<uint8_t> compressed(lzma_stream_buffer_bound(debug_contents.size()));
+  size_t compressed_size = 0;
+  ASSERT_EQ(LZMA_OK, lzma_easy_buffer_encode(
+      LZMA_PRESET_DEFAULT, LZMA_CHECK_CRC64, NULL,
+      reinterpret_cast<const uint8_t*>(debug_contents.data()),
+      debug_contents.size(), &compressed[0], &compressed_size,
+      compressed.size()));
+
+  ELF elf(TypeParam::kMachine, TypeParam::kClass, kLittleEndian);
+  Section text(kLittleEndian);
+  text.Append(4096, 0);
+  elf.AddSection(".text", text, SHT_PROGBITS);
+  StringTable table(kLittleEndian);
+  SymbolTable syms(kLittleEndian, TypeParam::kAddrSize, table);
+  syms.AddSymbol("superfunc",
+                   (typename TypeParam::Addr)0x1000,
+                   (typename TypeParam::Addr)0x10,
+                 ELF32_ST_INFO(STB_GLOBAL, STT_FUNC),
+                 SHN_UNDEF + 1);
+  int index = elf.AddSection(".dynstr", table, SHT_STRTAB);
+  elf.AddSection(".dynsym", syms,
+                 SHT_DYNSYM,          // type
+                 SHF_ALLOC,           // flags
+                 0,                   // addr
+                 index,               // link
+                 sizeof(typename TypeParam::Sym));  // entsize
+  Section gnu_debugdata(kLittleEndian);
+  gnu_debugdata.Append(string(reinterpret_cast<const char*>(&compressed[0]),
+                              compressed_size));
+  elf.AddSection(".gnu_debugdata", gnu_debugdata, SHT_PROGBITS);
+
+  elf.Finish();
+  this->GetElfContents(elf);
+
+  Module* module;
+  DumpOptions options(ALL_SYMBOL_DATA, true, false, false);
+  EXPECT_TRUE(ReadSymbolDataInternal(this->elfdata,
+                                     "foo",
+                                     "Linux",
+                                     "",
+                                     vector<string>(),
+                                     options,
+                                     &module));
+
+  stringstream s;
+  module->Write(s, ALL_SYMBOL_DATA);
+  const string expected =
+    string("MODULE Linux ") + TypeParam::kMachineName
+    + " 000000000000000000000000000000000 foo\n"
+    "INFO CODE_ID 00000000000000000000000000000000\n"
+    "PUBLIC 1000 0 superfunc\n"
+    "PUBLIC 1100 0 localfunc\n";
+  EXPECT_EQ(expected, s.str());
+  delete module;
+}
+#endif  // HAVE_LIBLZMA
+
 TYPED_TEST(DumpSymbols, ModuleIdOverride) {
   ELF elf(TypeParam::kMachine, TypeParam::kClass, kLittleEndian);
   // Zero out text section for simplicity.
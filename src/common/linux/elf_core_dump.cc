@@ -37,8 +37,11 @@
 
 #include <stddef.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 namespace google_breakpad {
 
 // Implementation of ElfCoreDump::Note.
@@ -101,8 +104,9 @@ size_t ElfCoreDump::Note::AlignedSize(size_t size) {
 
 ElfCoreDump::ElfCoreDump() : proc_mem_fd_(-1) {}
 
-ElfCoreDump::ElfCoreDump(const MemoryRange& content)
-    : content_(content), proc_mem_fd_(-1) {}
+ElfCoreDump::ElfCoreDump(const MemoryRange& content) : proc_mem_fd_(-1) {
+  SetContent(content);
+}
 
 ElfCoreDump::~ElfCoreDump() {
   if (proc_mem_fd_ != -1) {
@@ -113,6 +117,23 @@ ElfCoreDump::~ElfCoreDump() {
 
 void ElfCoreDump::SetContent(const MemoryRange& content) {
   content_ = content;
+
+  // A core from a large process has thousands of segments, so look them up
+  // in a sorted table rather than walking the program headers each time.
+  load_segments_.clear();
+  if (!IsValid() || GetHeader()->e_phentsize < sizeof(Phdr))
+    return;
+  for (unsigned i = 0, n = GetProgramHeaderCount(); i < n; ++i) {
+    const Phdr* program = GetProgramHeader(i);
+    if (!program || program->p_type != PT_LOAD || program->p_filesz == 0)
+      continue;
+    LoadSegment segment;
+    segment.virtual_address = program->p_vaddr;
+    segment.file_size = program->p_filesz;
+    segment.file_offset = program->p_offset;
+    load_segments_.push_back(segment);
+  }
+  std::sort(load_segments_.begin(), load_segments_.end());
 }
 
 void ElfCoreDump::SetProcMem(int fd) {
@@ -163,23 +184,41 @@ unsigned ElfCoreDump::GetProgramHeaderCount() const {
   return header ? header->e_phnum : 0;
 }
 
-bool ElfCoreDump::CopyData(void* buffer, Addr virtual_address, size_t length) {
-  for (unsigned i = 0, n = GetProgramHeaderCount(); i < n; ++i) {
-    const Phdr* program = GetProgramHeader(i);
-    if (program->p_type != PT_LOAD)
-      continue;
+const ElfCoreDump::LoadSegment* ElfCoreDump::FindLoadSegment(
+    Addr virtual_address) const {
+  LoadSegment key;
+  key.virtual_address = virtual_address;
+  std::vector<LoadSegment>::const_iterator next =
+      std::upper_bound(load_segments_.begin(), load_segments_.end(), key);
+  if (next == load_segments_.begin())
+    return NULL;
+  const LoadSegment* segment = &*(next - 1);
+  if (virtual_address - segment->virtual_address >= segment->file_size)
+    return NULL;
+  return segment;
+}
 
-    size_t offset_in_segment = virtual_address - program->p_vaddr;
-    if (virtual_address >= program->p_vaddr &&
-        offset_in_segment < program->p_filesz) {
-      const void* data =
-          content_.GetData(program->p_offset + offset_in_segment, length);
-      if (data) {
-        memcpy(buffer, data, length);
-        return true;
-      }
-    }
+bool ElfCoreDump::CopyData(void* buffer, Addr virtual_address, size_t length) {
+  uint8_t* dest = static_cast<uint8_t*>(buffer);
+  Addr address = virtual_address;
+  size_t left = length;
+  while (left) {
+    const LoadSegment* segment = FindLoadSegment(address);
+    if (!segment)
+      break;
+    size_t offset_in_segment = address - segment->virtual_address;
+    size_t chunk = std::min(left, segment->file_size - offset_in_segment);
+    const void* data =
+        content_.GetData(segment->file_offset + offset_in_segment, chunk);
+    if (!data)
+      break;
+    memcpy(dest, data, chunk);
+    dest += chunk;
+    address += chunk;
+    left -= chunk;
   }
+  if (left == 0)
+    return true;
 
   /* fallback: if available, read from /proc/<pid>/mem */
   if (proc_mem_fd_ != -1) {
@@ -193,6 +232,26 @@ bool ElfCoreDump::CopyData(void* buffer, Addr virtual_address, size_t length) {
   return false;
 }
 
+void ElfCoreDump::AdviseSegmentData(int advice) const {
+  if (load_segments_.empty())
+    return;
+  size_t start = content_.length();
+  size_t end = 0;
+  for (const LoadSegment& segment : load_segments_) {
+    start = std::min(start, segment.file_offset);
+    end = std::max(end, segment.file_offset + segment.file_size);
+  }
+  end = std::min(end, content_.length());
+  if (start >= end)
+    return;
+
+  const uintptr_t page_mask = getpagesize() - 1;
+  uintptr_t first = reinterpret_cast<uintptr_t>(content_.data() + start);
+  uintptr_t last = reinterpret_cast<uintptr_t>(content_.data() + end);
+  first &= ~page_mask;
+  madvise(reinterpret_cast<void*>(first), last - first, advice);
+}
+
 ElfCoreDump::Note ElfCoreDump::GetFirstNote() const {
   MemoryRange note_content;
   const Phdr* program_header = GetFirstProgramHeaderOfType(PT_NOTE);
@@ -37,6 +37,8 @@
 #include <link.h>
 #include <stddef.h>
 
+#include <vector>
+
 #include "common/memory_range.h"
 
 namespace google_breakpad {
@@ -107,7 +109,8 @@ class ElfCoreDump {
 
   ~ElfCoreDump();
 
-  // Sets the core dump content to |content|.
+  // Sets the core dump content to |content|, and indexes its PT_LOAD
+  // segments by virtual address.
   void SetContent(const MemoryRange& content);
 
   // Returns true if a valid ELF header in the core dump, or false otherwise.
@@ -132,10 +135,18 @@ class ElfCoreDump {
 
   // Copies |length| bytes of data starting at |virtual_address| in the core
   // dump to |buffer|. |buffer| should be a valid pointer to a buffer of at
-  // least |length| bytes. Returns true if the data to be copied is found in
-  // the core dump, or false otherwise.
+  // least |length| bytes. The data may span PT_LOAD segments that are
+  // contiguous in memory. Returns true if the data to be copied is found in
+  // the core dump, or false otherwise. May be called from several threads
+  // at once.
   bool CopyData(void* buffer, Addr virtual_address, size_t length);
 
+  // Passes |advice| to madvise() for the part of the content that holds the
+  // segments' data, for when the content is a mapping of the core dump file.
+  // For a large core, MADV_RANDOM keeps reads of scattered memory, such as
+  // thread stacks, from pulling in unrelated data around them.
+  void AdviseSegmentData(int advice) const;
+
   // Returns the first note found in the note section of the core dump, or
   // an empty note if no note is found.
   Note GetFirstNote() const;
@@ -144,9 +155,27 @@ class ElfCoreDump {
   void SetProcMem(const int fd);
 
  private:
+  // Where a PT_LOAD segment's data is in the core dump file.
+  struct LoadSegment {
+    Addr virtual_address;
+    size_t file_size;
+    size_t file_offset;
+
+    bool operator<(const LoadSegment& other) const {
+      return virtual_address < other.virtual_address;
+    }
+  };
+
+  // Returns the segment holding |virtual_address|, or NULL if none does.
+  const LoadSegment* FindLoadSegment(Addr virtual_address) const;
+
   // Core dump content.
   MemoryRange content_;
 
+  // The PT_LOAD segments of |content_| with data in the file, sorted by
+  // virtual address.
+  std::vector<LoadSegment> load_segments_;
+
   // Descriptor for /proc/<pid>/mem.
   int proc_mem_fd_;
 };
@@ -130,6 +130,57 @@ TEST(ElfCoreDumpTest, TestElfHeader) {
   EXPECT_TRUE(core.IsValid());
 }
 
+TEST(ElfCoreDumpTest, CopyDataFromUnsortedSegments) {
+  // A core with three PT_LOAD segments, listed out of address order: two
+  // contiguous in memory at 0x1000 and 0x1010, and one at 0x3000.
+  struct {
+    ElfCoreDump::Ehdr header;
+    ElfCoreDump::Phdr programs[3];
+    uint8_t data[0x30];
+  } core_data;
+  memset(&core_data, 0, sizeof(core_data));
+  ElfCoreDump::Ehdr* header = &core_data.header;
+  header->e_ident[0] = ELFMAG0;
+  header->e_ident[1] = ELFMAG1;
+  header->e_ident[2] = ELFMAG2;
+  header->e_ident[3] = ELFMAG3;
+  header->e_ident[4] = ElfCoreDump::kClass;
+  header->e_version = EV_CURRENT;
+  header->e_type = ET_CORE;
+  header->e_phoff = offsetof(__typeof__(core_data), programs);
+  header->e_phentsize = sizeof(ElfCoreDump::Phdr);
+  header->e_phnum = 3;
+  const size_t data_offset = offsetof(__typeof__(core_data), data);
+  const ElfCoreDump::Addr addresses[3] = { 0x3000, 0x1010, 0x1000 };
+  for (int i = 0; i < 3; ++i) {
+    core_data.programs[i].p_type = PT_LOAD;
+    core_data.programs[i].p_vaddr = addresses[i];
+    core_data.programs[i].p_offset = data_offset + i * 0x10;
+    core_data.programs[i].p_filesz = 0x10;
+  }
+  for (size_t i = 0; i < sizeof(core_data.data); ++i)
+    core_data.data[i] = i;
+
+  ElfCoreDump core(MemoryRange(&core_data, sizeof(core_data)));
+  ASSERT_TRUE(core.IsValid());
+
+  uint8_t buffer[0x20];
+  ASSERT_TRUE(core.CopyData(buffer, 0x3004, 4));
+  EXPECT_EQ(0x04, buffer[0]);
+  EXPECT_EQ(0x07, buffer[3]);
+
+  // Data spanning the two contiguous segments.
+  ASSERT_TRUE(core.CopyData(buffer, 0x1008, 0x10));
+  EXPECT_EQ(0x28, buffer[0]);
+  EXPECT_EQ(0x2f, buffer[7]);
+  EXPECT_EQ(0x10, buffer[8]);
+  EXPECT_EQ(0x17, buffer[15]);
+
+  EXPECT_FALSE(core.CopyData(buffer, 0x0ff0, 4));
+  EXPECT_FALSE(core.CopyData(buffer, 0x1018, 0x10));
+  EXPECT_FALSE(core.CopyData(buffer, 0x3010, 1));
+}
+
 TEST(ElfCoreDumpTest, ValidCoreFile) {
   CrashGenerator crash_generator;
   if (!crash_generator.HasDefaultCorePattern()) {
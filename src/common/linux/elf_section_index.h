@@ -0,0 +1,111 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// elf_section_index.h: Find the sections of an ELF file by name through a
+// hash table.
+//
+// FindElfSectionByName searches the section header table linearly, and
+// allocates nothing, as its callers in a crashing process need.  For a
+// file with tens of thousands of sections, such as a relocatable object
+// built with -ffunction-sections, looking up each of the dozens of
+// sections dump_syms wants that way takes time proportional to their
+// product.  ElfSectionIndex hashes the section names once and finds the
+// same sections as FindElfSectionByName.
+
+#ifndef COMMON_LINUX_ELF_SECTION_INDEX_H_
+#define COMMON_LINUX_ELF_SECTION_INDEX_H_
+
+#include <string.h>
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "common/linux/elfutils.h"
+
+namespace google_breakpad {
+
+template<typename ElfClass>
+class ElfSectionIndex {
+ public:
+  typedef typename ElfClass::Shdr Shdr;
+  typedef typename ElfClass::Word Word;
+
+  // Indexes the |nsection| section headers at |sections|, whose names are
+  // in the string table from |section_names| to |names_end|.  The index
+  // refers to those, which must outlive it.
+  ElfSectionIndex(const Shdr* sections,
+                  const char* section_names,
+                  const char* names_end,
+                  int nsection)
+      : sections_(sections), next_(nsection > 0 ? nsection : 0, -1) {
+    // Walk the sections backwards, so that each chain lists sections in
+    // table order.
+    for (int i = nsection - 1; i >= 0; --i) {
+      if (sections[i].sh_name >=
+          static_cast<size_t>(names_end - section_names)) {
+        continue;
+      }
+      const char* name = section_names + sections[i].sh_name;
+      size_t name_len = strnlen(name, names_end - name);
+      // Names without a terminator in the table, and empty names, are
+      // never found.
+      if (name_len == 0 || name + name_len == names_end)
+        continue;
+      int& first = first_[std::string_view(name, name_len)];
+      next_[i] = first ? first - 1 : -1;
+      first = i + 1;
+    }
+  }
+
+  // Returns the first section named |name| of type |section_type|, or
+  // NULL if there is none.
+  const Shdr* Find(const char* name, Word section_type) const {
+    auto it = first_.find(std::string_view(name));
+    if (it == first_.end())
+      return NULL;
+    for (int i = it->second - 1; i >= 0; i = next_[i]) {
+      if (sections_[i].sh_type == section_type)
+        return sections_ + i;
+    }
+    return NULL;
+  }
+
+ private:
+  const Shdr* sections_;
+  // One more than the index of the first section of each name; a new
+  // entry is zero.
+  std::unordered_map<std::string_view, int> first_;
+  // The index of the next section with the same name as each one, or -1.
+  std::vector<int> next_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_LINUX_ELF_SECTION_INDEX_H_
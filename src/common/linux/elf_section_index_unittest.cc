@@ -0,0 +1,140 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// elf_section_index_unittest.cc: Unit tests for ElfSectionIndex.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <elf.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/linux/elf_section_index.h"
+#include "common/linux/elfutils.h"
+#include "common/linux/elfutils-inl.h"
+#include "common/using_std_string.h"
+
+namespace {
+
+using google_breakpad::ElfClass32;
+using google_breakpad::ElfClass64;
+using google_breakpad::ElfSectionIndex;
+using google_breakpad::FindElfSectionByName;
+using ::testing::Test;
+using ::testing::Types;
+
+template<typename ElfClass>
+class ElfSectionIndexTest : public Test {
+ public:
+  typedef typename ElfClass::Shdr Shdr;
+
+  // Adds a section named |name| of type |type|.
+  void AddSection(const string& name, uint32_t type) {
+    Shdr section = Shdr();
+    section.sh_name = names_.size();
+    section.sh_type = type;
+    sections_.push_back(section);
+    names_.append(name);
+    names_.push_back('\0');
+  }
+
+  // Checks that the index finds the same section as FindElfSectionByName.
+  void ExpectSameSection(const ElfSectionIndex<ElfClass>& index,
+                         const char* name, uint32_t type) {
+    const Shdr* expected = FindElfSectionByName<ElfClass>(
+        name, type, &sections_[0], names_.data(),
+        names_.data() + names_.size(), sections_.size());
+    EXPECT_EQ(expected, index.Find(name, type)) << name << " " << type;
+  }
+
+  std::vector<Shdr> sections_;
+  string names_;
+};
+
+typedef Types<ElfClass32, ElfClass64> ElfClasses;
+TYPED_TEST_SUITE(ElfSectionIndexTest, ElfClasses);
+
+TYPED_TEST(ElfSectionIndexTest, FindsSections) {
+  this->AddSection("", SHT_NULL);
+  this->AddSection(".text", SHT_PROGBITS);
+  this->AddSection(".debug_info", SHT_MIPS_DWARF);
+  this->AddSection(".symtab", SHT_SYMTAB);
+  this->AddSection(".debug_info", SHT_PROGBITS);
+  this->AddSection(".debug_info", SHT_PROGBITS);
+  this->AddSection(".strtab", SHT_STRTAB);
+  // Many sections, as -ffunction-sections makes.
+  for (int i = 0; i < 1000; ++i)
+    this->AddSection(".text.function" + std::to_string(i), SHT_PROGBITS);
+  this->AddSection(".text", SHT_PROGBITS);
+
+  ElfSectionIndex<TypeParam> index(
+      &this->sections_[0], this->names_.data(),
+      this->names_.data() + this->names_.size(), this->sections_.size());
+  EXPECT_EQ(&this->sections_[1], index.Find(".text", SHT_PROGBITS));
+  EXPECT_EQ(&this->sections_[2], index.Find(".debug_info", SHT_MIPS_DWARF));
+  EXPECT_EQ(&this->sections_[4], index.Find(".debug_info", SHT_PROGBITS));
+  EXPECT_EQ(&this->sections_[507],
+            index.Find(".text.function500", SHT_PROGBITS));
+  EXPECT_EQ(NULL, index.Find(".text", SHT_NOBITS));
+  EXPECT_EQ(NULL, index.Find(".bss", SHT_NOBITS));
+  EXPECT_EQ(NULL, index.Find("", SHT_NULL));
+
+  const char* const kNames[] = {
+    ".text", ".debug_info", ".symtab", ".strtab", ".dynsym",
+    ".text.function0", ".text.function999", ".text.function", ""
+  };
+  const uint32_t kTypes[] = {
+    SHT_NULL, SHT_PROGBITS, SHT_SYMTAB, SHT_STRTAB, SHT_MIPS_DWARF
+  };
+  for (const char* name : kNames) {
+    for (uint32_t type : kTypes)
+      this->ExpectSameSection(index, name, type);
+  }
+}
+
+TYPED_TEST(ElfSectionIndexTest, IgnoresBadNames) {
+  this->AddSection(".text", SHT_PROGBITS);
+  this->AddSection(".data", SHT_PROGBITS);
+  // A name offset past the string table.
+  this->sections_[0].sh_name = this->names_.size() + 10;
+  // A name that runs to the end of the table without a terminator.
+  this->names_.resize(this->names_.size() - 1);
+
+  ElfSectionIndex<TypeParam> index(
+      &this->sections_[0], this->names_.data(),
+      this->names_.data() + this->names_.size(), this->sections_.size());
+  EXPECT_EQ(NULL, index.Find(".text", SHT_PROGBITS));
+  EXPECT_EQ(NULL, index.Find(".data", SHT_PROGBITS));
+}
+
+}  // namespace
@@ -44,6 +44,7 @@
 #include <utility>
 
 #include "common/byte_cursor.h"
+#include "common/language.h"
 #include "common/module.h"
 
 namespace google_breakpad {
@@ -147,7 +148,8 @@ bool ELFSymbolsToModule(const uint8_t* symtab_section,
                         size_t string_size,
                         const bool big_endian,
                         size_t value_size,
-                        Module* module) {
+                        Module* module,
+                        DemangleCache* demangle_cache) {
   ByteBuffer symbols(symtab_section, symtab_size);
   // Ensure that the string section is null-terminated.
   if (string_section[string_size - 1] != '\0') {
@@ -166,13 +168,25 @@ bool ELFSymbolsToModule(const uint8_t* symtab_section,
       auto ext = std::make_unique<Module::Extern>(iterator->value);
       ext->name = SymbolString(iterator->name_offset, strings);
 #if !defined(__ANDROID__)  // Android NDK doesn't provide abi::__cxa_demangle.
-      int status = 0;
-      char* demangled =
-          abi::__cxa_demangle(ext->name.c_str(), NULL, NULL, &status);
-      if (demangled) {
-        if (status == 0)
+      // Mangled C++ names are often in the debugging information too, so
+      // let the cache shared with it answer for those.  Anything else goes
+      // straight to the demangler, which also accepts bare type names.
+      if (demangle_cache && ext->name.compare(0, 2, "_Z") == 0) {
+        string demangled;
+        if (demangle_cache->DemangleName(Language::CPlusPlus, ext->name,
+                                         &demangled) ==
+            Language::kDemangleSuccess) {
           ext->name = demangled;
-        free(demangled);
+        }
+      } else {
+        int status = 0;
+        char* demangled =
+            abi::__cxa_demangle(ext->name.c_str(), NULL, NULL, &status);
+        if (demangled) {
+          if (status == 0)
+            ext->name = demangled;
+          free(demangled);
+        }
       }
 #endif
       module->AddExtern(std::move(ext));
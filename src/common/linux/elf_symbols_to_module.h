@@ -42,15 +42,19 @@
 
 namespace google_breakpad {
 
+class DemangleCache;
 class Module;
 
+// If DEMANGLE_CACHE is non-NULL, C++ names are demangled through it; it
+// is not owned.
 bool ELFSymbolsToModule(const uint8_t* symtab_section,
                         size_t symtab_size,
                         const uint8_t* string_section,
                         size_t string_size,
                         const bool big_endian,
                         size_t value_size,
-                        Module* module);
+                        Module* module,
+                        DemangleCache* demangle_cache = NULL);
 
 }  // namespace google_breakpad
 
@@ -158,6 +158,12 @@ bool FileID::ElfFileIdentifierFromMappedFile(const void* base,
   return HashElfTextSection(base, identifier);
 }
 
+// static
+bool FileID::ElfFileBuildId(const void* base,
+                            wasteful_vector<uint8_t>& build_id) {
+  return FindElfBuildIDNote(base, build_id);
+}
+
 bool FileID::ElfFileIdentifier(wasteful_vector<uint8_t>& identifier) {
   MemoryMappedFile mapped_file(path_.c_str(), 0);
   if (!mapped_file.data())  // Should probably check if size >= ElfW(Ehdr)?
@@ -68,6 +68,13 @@ class FileID {
       const void* base,
       wasteful_vector<uint8_t>& identifier);
 
+  // Load the contents of the build id note of the elf file mapped into
+  // memory at |base| into |build_id|, without falling back on a hash of
+  // its text as ElfFileIdentifierFromMappedFile does.  Return false if the
+  // file has no build id note.
+  static bool ElfFileBuildId(const void* base,
+                             wasteful_vector<uint8_t>& build_id);
+
   // Convert the |identifier| data to a string.  The string will
   // be formatted as a UUID in all uppercase without dashes.
   // (e.g., 22F065BBFC9C49F780FE26A7CEBD7BCE).
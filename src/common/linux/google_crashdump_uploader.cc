@@ -169,6 +169,7 @@ bool GoogleCrashdumpUploader::CheckRequiredParametersArePresent() {
 bool GoogleCrashdumpUploader::Upload(int* http_status_code,
                                      string* http_response_header,
                                      string* http_response_body) {
+  // Only the first upload loads libcurl; later ones reuse its handle.
   bool ok = http_layer_->Init();
   if (!ok) {
     std::cout << "http layer init failed";
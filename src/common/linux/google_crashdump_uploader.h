@@ -82,6 +82,19 @@ class GoogleCrashdumpUploader {
               string* http_response_header,
               string* http_response_body);
 
+  // Make the next Upload send another minidump.  The uploader keeps its
+  // libcurl handle between uploads, so a batch of minidumps uploaded one
+  // after the other reuses the connection to the crash server.
+  void set_minidump_pathname(const string& minidump_pathname) {
+    minidump_pathname_ = minidump_pathname;
+  }
+
+  // Compress uploads with gzip as they are sent; see
+  // LibcurlWrapper::set_compress_uploads.
+  void set_compress_uploads(bool compress_uploads) {
+    http_layer_->set_compress_uploads(compress_uploads);
+  }
+
  private:
   bool CheckRequiredParametersArePresent();
 
@@ -34,6 +34,11 @@
 
 #include <assert.h>
 #include <dlfcn.h>
+
+#include <mutex>
+#include <vector>
+
+#include "common/linux/multipart_body.h"
 #include "third_party/curl/curl.h"
 
 namespace {
@@ -50,12 +55,54 @@ static size_t WriteCallback(void* ptr, size_t size,
   return real_size;
 }
 
+// Easy handles of finished requests, kept for later ones, which then reuse
+// their connections to the same servers.
+std::mutex idle_curls_mutex;
+std::vector<CURL*> idle_curls;
+
 }  // namespace
 
 namespace google_breakpad {
 
 static const char kUserAgent[] = "Breakpad/1.0 (Linux)";
 
+// static
+void* HTTPUpload::LoadCurlLib(string* error_description) {
+  // libcurl is loaded by the first request, and kept for the later ones.
+  static string load_error;
+  static void* curl_lib = [] {
+    // We may have been linked statically; if curl_easy_init is in the
+    // current binary, no need to search for a dynamic version.
+    void* lib = dlopen(NULL, RTLD_NOW);
+    if (!CheckCurlLib(lib)) {
+      fprintf(stderr,
+              "Failed to open curl lib from binary, use libcurl.so instead\n");
+      dlerror();  // Clear dlerror before attempting to open libraries.
+      dlclose(lib);
+      lib = NULL;
+    }
+    if (!lib) {
+      lib = dlopen("libcurl.so", RTLD_NOW);
+    }
+    if (!lib) {
+      load_error = dlerror();
+      lib = dlopen("libcurl.so.4", RTLD_NOW);
+    }
+    if (!lib) {
+      // Debian gives libcurl a different name when it is built against
+      // GnuTLS instead of OpenSSL.
+      lib = dlopen("libcurl-gnutls.so.4", RTLD_NOW);
+    }
+    if (!lib) {
+      lib = dlopen("libcurl.so.3", RTLD_NOW);
+    }
+    return lib;
+  }();
+  if (!curl_lib && error_description != NULL)
+    *error_description = load_error;
+  return curl_lib;
+}
+
 // static
 bool HTTPUpload::SendRequest(const string& url,
                              const map<string, string>& parameters,
@@ -65,51 +112,55 @@ bool HTTPUpload::SendRequest(const string& url,
                              const string& ca_certificate_file,
                              string* response_body,
                              long* response_code,
-                             string* error_description) {
+                             string* error_description,
+                             bool compress) {
   if (response_code != NULL)
     *response_code = 0;
 
   if (!CheckParameters(parameters))
     return false;
 
-  // We may have been linked statically; if curl_easy_init is in the
-  // current binary, no need to search for a dynamic version.
-  void* curl_lib = dlopen(NULL, RTLD_NOW);
-  if (!CheckCurlLib(curl_lib)) {
-    fprintf(stderr,
-            "Failed to open curl lib from binary, use libcurl.so instead\n");
-    dlerror();  // Clear dlerror before attempting to open libraries.
-    dlclose(curl_lib);
-    curl_lib = NULL;
-  }
+  void* curl_lib = LoadCurlLib(error_description);
   if (!curl_lib) {
-    curl_lib = dlopen("libcurl.so", RTLD_NOW);
-  }
-  if (!curl_lib) {
-    if (error_description != NULL)
-      *error_description = dlerror();
-    curl_lib = dlopen("libcurl.so.4", RTLD_NOW);
+    return false;
   }
-  if (!curl_lib) {
-    // Debian gives libcurl a different name when it is built against GnuTLS
-    // instead of OpenSSL.
-    curl_lib = dlopen("libcurl-gnutls.so.4", RTLD_NOW);
+
+  MultipartBody body;
+  if (compress) {
+    // The body is built here rather than with curl_formadd, to compress
+    // all of it as it is sent.
+    for (map<string, string>::const_iterator iter = files.begin();
+         iter != files.end(); ++iter) {
+      body.AddFile(iter->first, iter->second);
+    }
+    for (map<string, string>::const_iterator iter = parameters.begin();
+         iter != parameters.end(); ++iter) {
+      body.AddParameter(iter->first, iter->second);
+    }
+    if (!body.Start(true)) {
+      if (error_description != NULL)
+        *error_description = "Failed to compress the request";
+      return false;
+    }
   }
-  if (!curl_lib) {
-    curl_lib = dlopen("libcurl.so.3", RTLD_NOW);
+
+  CURL* curl = NULL;
+  {
+    std::lock_guard<std::mutex> lock(idle_curls_mutex);
+    if (!idle_curls.empty()) {
+      curl = idle_curls.back();
+      idle_curls.pop_back();
+    }
   }
-  if (!curl_lib) {
-    return false;
+  if (!curl) {
+    CURL* (*curl_easy_init)(void);
+    *(void**) (&curl_easy_init) = dlsym(curl_lib, "curl_easy_init");
+    curl = (*curl_easy_init)();
   }
-
-  CURL* (*curl_easy_init)(void);
-  *(void**) (&curl_easy_init) = dlsym(curl_lib, "curl_easy_init");
-  CURL* curl = (*curl_easy_init)();
   if (error_description != NULL)
     *error_description = "No Error";
 
   if (!curl) {
-    dlclose(curl_lib);
     return false;
   }
 
@@ -131,33 +182,46 @@ bool HTTPUpload::SendRequest(const string& url,
   if (!ca_certificate_file.empty())
     (*curl_easy_setopt)(curl, CURLOPT_CAINFO, ca_certificate_file.c_str());
 
+  struct curl_slist* headerlist = NULL;
+  struct curl_slist* (*curl_slist_append)(struct curl_slist*, const char*);
+  *(void**) (&curl_slist_append) = dlsym(curl_lib, "curl_slist_append");
+
   struct curl_httppost* formpost = NULL;
   struct curl_httppost* lastptr = NULL;
-  // Add form data.
-  CURLFORMcode (*curl_formadd)(struct curl_httppost**, struct curl_httppost**, ...);
-  *(void**) (&curl_formadd) = dlsym(curl_lib, "curl_formadd");
-  map<string, string>::const_iterator iter = parameters.begin();
-  for (; iter != parameters.end(); ++iter)
-    (*curl_formadd)(&formpost, &lastptr,
-                 CURLFORM_COPYNAME, iter->first.c_str(),
-                 CURLFORM_COPYCONTENTS, iter->second.c_str(),
-                 CURLFORM_END);
-
-  // Add form files.
-  for (iter = files.begin(); iter != files.end(); ++iter) {
-    (*curl_formadd)(&formpost, &lastptr,
-                 CURLFORM_COPYNAME, iter->first.c_str(),
-                 CURLFORM_FILE, iter->second.c_str(),
-                 CURLFORM_END);
-  }
+  if (compress) {
+    string content_type_header = "Content-Type: " + body.content_type();
+    headerlist = (*curl_slist_append)(headerlist,
+                                      content_type_header.c_str());
+    headerlist = (*curl_slist_append)(headerlist, "Content-Encoding: gzip");
+    headerlist = (*curl_slist_append)(headerlist,
+                                      "Transfer-Encoding: chunked");
+    (*curl_easy_setopt)(curl, CURLOPT_POST, 1L);
+    (*curl_easy_setopt)(curl, CURLOPT_READFUNCTION, MultipartBody::CurlRead);
+    (*curl_easy_setopt)(curl, CURLOPT_READDATA, &body);
+  } else {
+    // Add form data.
+    CURLFORMcode (*curl_formadd)(struct curl_httppost**, struct curl_httppost**, ...);
+    *(void**) (&curl_formadd) = dlsym(curl_lib, "curl_formadd");
+    map<string, string>::const_iterator iter = parameters.begin();
+    for (; iter != parameters.end(); ++iter)
+      (*curl_formadd)(&formpost, &lastptr,
+                   CURLFORM_COPYNAME, iter->first.c_str(),
+                   CURLFORM_COPYCONTENTS, iter->second.c_str(),
+                   CURLFORM_END);
 
-  (*curl_easy_setopt)(curl, CURLOPT_HTTPPOST, formpost);
+    // Add form files.
+    for (iter = files.begin(); iter != files.end(); ++iter) {
+      (*curl_formadd)(&formpost, &lastptr,
+                   CURLFORM_COPYNAME, iter->first.c_str(),
+                   CURLFORM_FILE, iter->second.c_str(),
+                   CURLFORM_END);
+    }
+
+    (*curl_easy_setopt)(curl, CURLOPT_HTTPPOST, formpost);
+  }
 
   // Disable 100-continue header.
-  struct curl_slist* headerlist = NULL;
   char buf[] = "Expect:";
-  struct curl_slist* (*curl_slist_append)(struct curl_slist*, const char*);
-  *(void**) (&curl_slist_append) = dlsym(curl_lib, "curl_slist_append");
   headerlist = (*curl_slist_append)(headerlist, buf);
   (*curl_easy_setopt)(curl, CURLOPT_HTTPHEADER, headerlist);
 
@@ -189,9 +253,14 @@ bool HTTPUpload::SendRequest(const string& url,
   if (error_description != NULL)
     *error_description = (*curl_easy_strerror)(err_code);
 
-  void (*curl_easy_cleanup)(CURL*);
-  *(void**) (&curl_easy_cleanup) = dlsym(curl_lib, "curl_easy_cleanup");
-  (*curl_easy_cleanup)(curl);
+  // Keep the handle, with its connections, for the next request.
+  void (*curl_easy_reset)(CURL*);
+  *(void**) (&curl_easy_reset) = dlsym(curl_lib, "curl_easy_reset");
+  (*curl_easy_reset)(curl);
+  {
+    std::lock_guard<std::mutex> lock(idle_curls_mutex);
+    idle_curls.push_back(curl);
+  }
   if (formpost != NULL) {
     void (*curl_formfree)(struct curl_httppost*);
     *(void**) (&curl_formfree) = dlsym(curl_lib, "curl_formfree");
@@ -202,7 +271,6 @@ bool HTTPUpload::SendRequest(const string& url,
     *(void**) (&curl_slist_free_all) = dlsym(curl_lib, "curl_slist_free_all");
     (*curl_slist_free_all)(headerlist);
   }
-  dlclose(curl_lib);
   return err_code == CURLE_OK;
 }
 
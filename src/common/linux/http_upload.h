@@ -57,6 +57,13 @@ class HTTPUpload {
   // received (or 0 if the request failed before getting an HTTP response).
   // If the send fails, a description of the error will be
   // returned in error_description.
+  // If compress is true, the whole request body, files included, is
+  // compressed with gzip as it is sent, for servers that accept requests
+  // with "Content-Encoding: gzip"; this fails when zlib was not found at
+  // build time.
+  // libcurl is only loaded by the first request, and later requests reuse
+  // the connections of earlier ones, so queued uploads to the same server
+  // are cheaper when sent one after the other.
   static bool SendRequest(const string& url,
                           const map<string, string>& parameters,
                           const map<string, string>& files,
@@ -65,7 +72,8 @@ class HTTPUpload {
                           const string& ca_certificate_file,
                           string* response_body,
                           long* response_code,
-                          string* error_description);
+                          string* error_description,
+                          bool compress = false);
 
  private:
   // Checks that the given list of parameters has only printable
@@ -76,6 +84,10 @@ class HTTPUpload {
   // Checks the curl_lib parameter points to a valid curl lib.
   static bool CheckCurlLib(void* curl_lib);
 
+  // Returns the curl lib, loading it if this is the first request, or
+  // NULL, with a description of the error in error_description.
+  static void* LoadCurlLib(string* error_description);
+
   // No instances of this class should be created.
   // Disallow all constructors, destructors, and operator=.
   HTTPUpload();
@@ -31,11 +31,17 @@
 #endif
 
 #include <dlfcn.h>
+#include <stdio.h>
 
 #include <iostream>
 #include <string>
 
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
 #include "common/linux/libcurl_wrapper.h"
+#include "common/linux/multipart_body.h"
 #include "common/using_std_string.h"
 
 namespace google_breakpad {
@@ -44,6 +50,10 @@ LibcurlWrapper::LibcurlWrapper()
       curl_lib_(nullptr),
       last_curl_error_(""),
       curl_(nullptr),
+      accept_compressed_(false),
+      follow_redirects_(false),
+      prefer_http2_(false),
+      compress_uploads_(false),
       formpost_(nullptr),
       lastptr_(nullptr),
       headerlist_(nullptr) {}
@@ -82,11 +92,9 @@ bool LibcurlWrapper::AddFile(const string& upload_file_path,
   if (!CheckInit()) return false;
 
   std::cout << "Adding " << upload_file_path << " to form upload.";
-  // Add form file.
-  (*formadd_)(&formpost_, &lastptr_,
-              CURLFORM_COPYNAME, basename.c_str(),
-              CURLFORM_FILE, upload_file_path.c_str(),
-              CURLFORM_END);
+  // The file is added to the form by SendRequest, which only then knows
+  // whether to compress it.
+  files_.push_back(std::make_pair(basename, upload_file_path));
 
   return true;
 }
@@ -110,6 +118,39 @@ bool LibcurlWrapper::SendRequest(const string& url,
                                  string* http_response_data) {
   if (!CheckInit()) return false;
 
+#ifdef HAVE_LIBZ
+  if (compress_uploads_) {
+    // Build the body here rather than with curl_formadd, to compress all
+    // of it as it is sent.
+    MultipartBody body;
+    for (const auto& file : files_)
+      body.AddFile(file.first, file.second);
+    for (const auto& parameter : parameters)
+      body.AddParameter(parameter.first, parameter.second);
+    if (!body.Start(true)) {
+      Reset();
+      return false;
+    }
+    string content_type_header = "Content-Type: " + body.content_type();
+    headerlist_ = (*slist_append_)(headerlist_, content_type_header.c_str());
+    headerlist_ = (*slist_append_)(headerlist_, "Content-Encoding: gzip");
+    // libcurl leaves this out of HTTP/2 requests, which need no chunks.
+    headerlist_ = (*slist_append_)(headerlist_, "Transfer-Encoding: chunked");
+    (*easy_setopt_)(curl_, CURLOPT_POST, 1L);
+    (*easy_setopt_)(curl_, CURLOPT_READFUNCTION, MultipartBody::CurlRead);
+    (*easy_setopt_)(curl_, CURLOPT_READDATA, &body);
+    return SendRequestInner(url, http_status_code, http_header_data,
+                            http_response_data);
+  }
+#endif
+
+  for (const auto& file : files_) {
+    (*formadd_)(&formpost_, &lastptr_,
+                CURLFORM_COPYNAME, file.first.c_str(),
+                CURLFORM_FILE, file.second.c_str(),
+                CURLFORM_END);
+  }
+
   std::map<string, string>::const_iterator iter = parameters.begin();
   for (; iter != parameters.end(); ++iter)
     (*formadd_)(&formpost_, &lastptr_,
@@ -135,6 +176,62 @@ bool LibcurlWrapper::SendGetRequest(const string& url,
                           http_response_data);
 }
 
+// CURL_HTTP_VERSION_2TLS, which third_party/curl/curl.h predates.  Older
+// libcurls reject it and keep using HTTP/1.1.
+static const long kHttpVersion2Tls = 4;
+
+// The body of a PUT request, read from a file by ReadCallback, and
+// compressed with gzip as it is read if |compress| is set.
+struct PutBody {
+  explicit PutBody(FILE* file) : file(file), compress(false) {}
+
+  FILE* file;
+  bool compress;
+#ifdef HAVE_LIBZ
+  z_stream stream;
+  bool end_of_file;
+  bool finished;
+  char input[1 << 16];
+#endif
+};
+
+// Callback to give the server the next part of a request body.
+static size_t ReadCallback(char* buffer, size_t size,
+                           size_t nitems, void* userp) {
+  PutBody* body = reinterpret_cast<PutBody*>(userp);
+  size_t capacity = size * nitems;
+  if (!body->compress) {
+    size_t read = fread(buffer, 1, capacity, body->file);
+    return ferror(body->file) ? CURL_READFUNC_ABORT : read;
+  }
+
+#ifdef HAVE_LIBZ
+  z_stream* stream = &body->stream;
+  stream->next_out = reinterpret_cast<Bytef*>(buffer);
+  stream->avail_out = static_cast<uInt>(capacity);
+  while (stream->avail_out > 0 && !body->finished) {
+    if (stream->avail_in == 0 && !body->end_of_file) {
+      size_t read = fread(body->input, 1, sizeof(body->input), body->file);
+      if (ferror(body->file))
+        return CURL_READFUNC_ABORT;
+      body->end_of_file = read < sizeof(body->input);
+      stream->next_in = reinterpret_cast<Bytef*>(body->input);
+      stream->avail_in = static_cast<uInt>(read);
+    }
+    int flush =
+        body->end_of_file && stream->avail_in == 0 ? Z_FINISH : Z_NO_FLUSH;
+    int result = deflate(stream, flush);
+    if (result == Z_STREAM_END)
+      body->finished = true;
+    else if (result != Z_OK && result != Z_BUF_ERROR)
+      return CURL_READFUNC_ABORT;
+  }
+  return capacity - stream->avail_out;
+#else
+  return CURL_READFUNC_ABORT;
+#endif
+}
+
 bool LibcurlWrapper::SendPutRequest(const string& url,
                                     const string& path,
                                     long* http_status_code,
@@ -143,13 +240,50 @@ bool LibcurlWrapper::SendPutRequest(const string& url,
   if (!CheckInit()) return false;
 
   FILE* file = fopen(path.c_str(), "rb");
+  if (!file) {
+    fprintf(stderr, "Failed to open %s for upload\n", path.c_str());
+    return false;
+  }
+
+  // The file is streamed to the server, never read in full.
+  PutBody body(file);
+#ifdef HAVE_LIBZ
+  if (compress_uploads_) {
+    body.stream = z_stream();
+    body.end_of_file = false;
+    body.finished = false;
+    // Window bits of 15 + 16 produce a gzip wrapper.  Symbol files are
+    // mostly text, so even the fastest level shrinks them greatly without
+    // making compression slower than the upload.
+    if (deflateInit2(&body.stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+      fprintf(stderr, "Failed to start compressing %s\n", path.c_str());
+      fclose(file);
+      return false;
+    }
+    body.compress = true;
+    headerlist_ = (*slist_append_)(headerlist_, "Content-Encoding: gzip");
+  }
+#endif
+  if (!body.compress && fseeko(file, 0, SEEK_END) == 0) {
+    curl_off_t size = ftello(file);
+    rewind(file);
+    if (size >= 0)
+      (*easy_setopt_)(curl_, CURLOPT_INFILESIZE_LARGE, size);
+  }
+
   (*easy_setopt_)(curl_, CURLOPT_UPLOAD, 1L);
   (*easy_setopt_)(curl_, CURLOPT_PUT, 1L);
-  (*easy_setopt_)(curl_, CURLOPT_READDATA, file);
+  (*easy_setopt_)(curl_, CURLOPT_READFUNCTION, ReadCallback);
+  (*easy_setopt_)(curl_, CURLOPT_READDATA, &body);
 
   bool success = SendRequestInner(url, http_status_code, http_header_data,
                                   http_response_data);
 
+#ifdef HAVE_LIBZ
+  if (body.compress)
+    deflateEnd(&body.stream);
+#endif
   fclose(file);
   return success;
 }
@@ -177,6 +311,10 @@ bool LibcurlWrapper::SendSimplePostRequest(const string& url,
 }
 
 bool LibcurlWrapper::Init() {
+  // Keep the handle, and the connections it holds, of an earlier Init.
+  if (init_ok_)
+    return true;
+
   // First check to see if libcurl was statically linked:
   curl_lib_ = dlopen(nullptr, RTLD_NOW);
   if (curl_lib_ &&
@@ -286,6 +424,21 @@ bool LibcurlWrapper::SendRequestInner(const string& url,
   headerlist_ = (*slist_append_)(headerlist_, buf);
   (*easy_setopt_)(curl_, CURLOPT_HTTPHEADER, headerlist_);
 
+  // An empty string asks for every encoding libcurl can decode.
+  if (accept_compressed_)
+    (*easy_setopt_)(curl_, CURLOPT_ENCODING, "");
+  if (follow_redirects_)
+    (*easy_setopt_)(curl_, CURLOPT_FOLLOWLOCATION, 1L);
+  if (prefer_http2_)
+    (*easy_setopt_)(curl_, CURLOPT_HTTP_VERSION, kHttpVersion2Tls);
+  if (!proxy_host_.empty())
+    (*easy_setopt_)(curl_, CURLOPT_PROXY, proxy_host_.c_str());
+  if (!proxy_userpwd_.empty())
+    (*easy_setopt_)(curl_, CURLOPT_PROXYUSERPWD, proxy_userpwd_.c_str());
+  // Keep libcurl from timing out name lookups with signals, which are not
+  // safe when wrappers are used on several threads.
+  (*easy_setopt_)(curl_, CURLOPT_NOSIGNAL, 1L);
+
   if (http_response_data != nullptr) {
     http_response_data->clear();
     (*easy_setopt_)(curl_, CURLOPT_WRITEFUNCTION, WriteCallback);
@@ -318,6 +471,8 @@ bool LibcurlWrapper::SendRequestInner(const string& url,
 }
 
 void LibcurlWrapper::Reset() {
+  files_.clear();
+
   if (headerlist_ != nullptr) {
     (*slist_free_all_)(headerlist_);
     headerlist_ = nullptr;
@@ -326,6 +481,7 @@ void LibcurlWrapper::Reset() {
   if (formpost_ != nullptr) {
     (*formfree_)(formpost_);
     formpost_ = nullptr;
+    lastptr_ = nullptr;
   }
 
   (*easy_reset_)(curl_);
@@ -34,6 +34,8 @@
 
 #include <string>
 #include <map>
+#include <utility>
+#include <vector>
 
 #include "common/using_std_string.h"
 #include "third_party/curl/curl.h"
@@ -41,11 +43,17 @@
 namespace google_breakpad {
 
 // This class is only safe to be used on single-threaded code because of its
-// usage of libcurl's curl_global_cleanup().
+// usage of libcurl's curl_global_cleanup().  Several wrappers can still
+// send requests on different threads at once, provided they are all
+// initialized and destroyed while no other thread is using libcurl.
+//
+// A wrapper keeps one libcurl handle for all its requests, so that they
+// reuse the connections of earlier ones to the same server.
 class LibcurlWrapper {
  public:
   LibcurlWrapper();
   virtual ~LibcurlWrapper();
+  // Load libcurl.  Calling this again once it has succeeded does nothing.
   virtual bool Init();
   virtual bool SetProxy(const string& proxy_host,
                         const string& proxy_userpwd);
@@ -72,6 +80,36 @@ class LibcurlWrapper {
                              string* http_header_data,
                              string* http_response_data);
 
+  // These apply to every request sent from now on.  With accept_compressed
+  // set, the server may compress its response, which is decompressed as it
+  // arrives.  With follow_redirects set, HTTP redirects are followed.
+  void set_accept_compressed(bool accept_compressed) {
+    accept_compressed_ = accept_compressed;
+  }
+  void set_follow_redirects(bool follow_redirects) {
+    follow_redirects_ = follow_redirects;
+  }
+
+  // These also apply to every request sent from now on.  With prefer_http2
+  // set, HTTP/2 is used for https URLs when both libcurl and the server
+  // support it.  With compress_uploads set, SendPutRequest gzips the file,
+  // and SendRequest the whole multipart body with the files added by
+  // AddFile, as they are sent, and marks the body with "Content-Encoding:
+  // gzip"; this has no effect when zlib was not found at build time.
+  // set_proxy names a proxy, and optionally its user and password, for
+  // every request, unlike SetProxy, whose settings are cleared after the
+  // next request.
+  void set_prefer_http2(bool prefer_http2) {
+    prefer_http2_ = prefer_http2;
+  }
+  void set_compress_uploads(bool compress_uploads) {
+    compress_uploads_ = compress_uploads;
+  }
+  void set_proxy(const string& proxy_host, const string& proxy_userpwd) {
+    proxy_host_ = proxy_host;
+    proxy_userpwd_ = proxy_userpwd;
+  }
+
  private:
   // This function initializes class state corresponding to function
   // pointers into the CURL library.
@@ -95,8 +133,18 @@ class LibcurlWrapper {
 
   CURL* curl_;                   // Pointer for handle for CURL calls.
 
+  bool accept_compressed_;
+  bool follow_redirects_;
+  bool prefer_http2_;
+  bool compress_uploads_;
+  string proxy_host_;
+  string proxy_userpwd_;
+
   CURL* (*easy_init_)(void);
 
+  // The names and paths of the files added by AddFile.
+  std::vector<std::pair<string, string>> files_;
+
   // Stateful pointers for calling into curl_formadd()
   struct curl_httppost* formpost_;
   struct curl_httppost* lastptr_;
@@ -0,0 +1,217 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// multipart_body.cc: Produces the body of a multipart/form-data request
+// as it is sent.
+//
+// See multipart_body.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "common/linux/multipart_body.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <random>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+#include "third_party/curl/curl.h"
+
+namespace google_breakpad {
+
+struct MultipartBody::Compressor {
+#ifdef HAVE_LIBZ
+  z_stream stream;
+  bool finished;
+  char input[1 << 16];
+#endif
+};
+
+MultipartBody::MultipartBody()
+    : next_part_(0),
+      pending_offset_(0),
+      file_(nullptr),
+      finished_(false) {
+  std::random_device random;
+  char boundary[40];
+  snprintf(boundary, sizeof(boundary), "----------------%08x%08x",
+           static_cast<unsigned>(random()), static_cast<unsigned>(random()));
+  boundary_ = boundary;
+}
+
+MultipartBody::~MultipartBody() {
+  if (file_)
+    fclose(file_);
+#ifdef HAVE_LIBZ
+  if (compressor_)
+    deflateEnd(&compressor_->stream);
+#endif
+}
+
+void MultipartBody::AddParameter(const string& name, const string& value) {
+  Part part;
+  part.header = "--" + boundary_ + "\r\n"
+                "Content-Disposition: form-data; name=\"" + name + "\"\r\n"
+                "\r\n";
+  part.value = value;
+  parts_.push_back(part);
+}
+
+void MultipartBody::AddFile(const string& name, const string& path) {
+  string basename = path.substr(path.rfind('/') + 1);
+  Part part;
+  part.header = "--" + boundary_ + "\r\n"
+                "Content-Disposition: form-data; name=\"" + name +
+                "\"; filename=\"" + basename + "\"\r\n"
+                "Content-Type: application/octet-stream\r\n"
+                "\r\n";
+  part.path = path;
+  parts_.push_back(part);
+}
+
+bool MultipartBody::Start(bool compress) {
+  for (const Part& part : parts_) {
+    if (!part.path.empty() && access(part.path.c_str(), R_OK) != 0) {
+      fprintf(stderr, "Failed to open %s for upload\n", part.path.c_str());
+      return false;
+    }
+  }
+  if (!compress)
+    return true;
+#ifdef HAVE_LIBZ
+  compressor_.reset(new Compressor());
+  compressor_->stream = z_stream();
+  compressor_->finished = false;
+  // Window bits of 15 + 16 produce a gzip wrapper.  As for
+  // LibcurlWrapper::SendPutRequest, the fastest level keeps compression
+  // from being slower than the upload.
+  if (deflateInit2(&compressor_->stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16,
+                   8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    compressor_.reset();
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+string MultipartBody::content_type() const {
+  return "multipart/form-data; boundary=" + boundary_;
+}
+
+long MultipartBody::ReadUncompressed(char* buffer, size_t size) {
+  size_t produced = 0;
+  while (produced < size) {
+    if (pending_offset_ < pending_.size()) {
+      size_t count = std::min(size - produced,
+                              pending_.size() - pending_offset_);
+      memcpy(buffer + produced, pending_.data() + pending_offset_, count);
+      pending_offset_ += count;
+      produced += count;
+    } else if (file_) {
+      size_t count = fread(buffer + produced, 1, size - produced, file_);
+      if (ferror(file_))
+        return -1;
+      produced += count;
+      if (count == 0) {
+        fclose(file_);
+        file_ = nullptr;
+        pending_ = "\r\n";
+        pending_offset_ = 0;
+      }
+    } else if (next_part_ < parts_.size()) {
+      const Part& part = parts_[next_part_++];
+      pending_ = part.header;
+      pending_offset_ = 0;
+      if (part.path.empty()) {
+        pending_ += part.value + "\r\n";
+      } else {
+        file_ = fopen(part.path.c_str(), "rb");
+        if (!file_)
+          return -1;
+      }
+    } else if (!finished_) {
+      pending_ = "--" + boundary_ + "--\r\n";
+      pending_offset_ = 0;
+      finished_ = true;
+    } else {
+      break;
+    }
+  }
+  return static_cast<long>(produced);
+}
+
+long MultipartBody::Read(char* buffer, size_t size) {
+  if (!compressor_)
+    return ReadUncompressed(buffer, size);
+
+#ifdef HAVE_LIBZ
+  z_stream* stream = &compressor_->stream;
+  stream->next_out = reinterpret_cast<Bytef*>(buffer);
+  stream->avail_out = static_cast<uInt>(size);
+  while (stream->avail_out > 0 && !compressor_->finished) {
+    bool end = false;
+    if (stream->avail_in == 0) {
+      long read = ReadUncompressed(compressor_->input,
+                                   sizeof(compressor_->input));
+      if (read < 0)
+        return -1;
+      end = read == 0;
+      stream->next_in = reinterpret_cast<Bytef*>(compressor_->input);
+      stream->avail_in = static_cast<uInt>(read);
+    }
+    int result = deflate(stream, end ? Z_FINISH : Z_NO_FLUSH);
+    if (result == Z_STREAM_END)
+      compressor_->finished = true;
+    else if (result != Z_OK && result != Z_BUF_ERROR)
+      return -1;
+  }
+  return static_cast<long>(size - stream->avail_out);
+#else
+  return -1;
+#endif
+}
+
+// static
+size_t MultipartBody::CurlRead(char* buffer, size_t size, size_t nitems,
+                               void* userp) {
+  MultipartBody* body = reinterpret_cast<MultipartBody*>(userp);
+  long read = body->Read(buffer, size * nitems);
+  return read < 0 ? CURL_READFUNC_ABORT : static_cast<size_t>(read);
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,113 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// multipart_body.h: MultipartBody produces the body of a
+// multipart/form-data POST request as it is sent.
+//
+// The files in the body are only read as it is sent, never in full, and
+// the whole body may be compressed with gzip on the way, for servers that
+// accept requests with "Content-Encoding: gzip".  Since the size of a
+// compressed body is not known until it has been sent, such requests are
+// sent with chunked transfer encoding.
+
+#ifndef COMMON_LINUX_MULTIPART_BODY_H_
+#define COMMON_LINUX_MULTIPART_BODY_H_
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class MultipartBody {
+ public:
+  MultipartBody();
+  ~MultipartBody();
+
+  // Add a part named NAME holding VALUE.
+  void AddParameter(const string& name, const string& value);
+
+  // Add a part named NAME holding the contents of the file at PATH.
+  void AddFile(const string& name, const string& path);
+
+  // Prepare to produce the body, compressed with gzip if COMPRESS is set.
+  // Return false if one of the files can't be read, or if COMPRESS is set
+  // but zlib was not found at build time.
+  bool Start(bool compress);
+
+  // The value of the request's Content-Type header.
+  string content_type() const;
+
+  // Fill BUFFER with up to SIZE bytes of the body, and return how many, 0
+  // once it has all been produced, or -1 if a file can't be read.
+  long Read(char* buffer, size_t size);
+
+  // A libcurl CURLOPT_READFUNCTION reading the MultipartBody USERP.
+  static size_t CurlRead(char* buffer, size_t size, size_t nitems,
+                         void* userp);
+
+ private:
+  struct Part {
+    // The delimiter and headers that start the part.
+    string header;
+    // The part's contents, unless it is a file's.
+    string value;
+    // The path of the file holding the part's contents, if any.
+    string path;
+  };
+
+  // Like Read, but without compression.
+  long ReadUncompressed(char* buffer, size_t size);
+
+  string boundary_;
+  std::vector<Part> parts_;
+
+  // The next part to start, text waiting to be produced before it, and the
+  // file being copied into the body, if any.
+  size_t next_part_;
+  string pending_;
+  size_t pending_offset_;
+  FILE* file_;
+  bool finished_;
+
+  // The zlib state when compressing; see multipart_body.cc.
+  struct Compressor;
+  std::unique_ptr<Compressor> compressor_;
+
+  MultipartBody(const MultipartBody&);
+  void operator=(const MultipartBody&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_LINUX_MULTIPART_BODY_H_
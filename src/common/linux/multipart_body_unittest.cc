@@ -0,0 +1,150 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// multipart_body_unittest.cc: Unit tests for
+// google_breakpad::MultipartBody.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "common/linux/multipart_body.h"
+
+#include <stdio.h>
+
+#include <string>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::MultipartBody;
+
+// Read all of BODY, SIZE bytes at a time.
+bool ReadAll(MultipartBody* body, size_t size, string* contents) {
+  string buffer(size, '\0');
+  long read;
+  while ((read = body->Read(&buffer[0], size)) > 0)
+    contents->append(buffer, 0, read);
+  return read == 0;
+}
+
+class MultipartBodyTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    path_ = temp_dir_.path() + "/dump.dmp";
+    FILE* file = fopen(path_.c_str(), "wb");
+    ASSERT_TRUE(file);
+    for (int i = 0; i < 20000; ++i)
+      fprintf(file, "line %d\n", i);
+    fclose(file);
+    file_contents_.clear();
+    for (int i = 0; i < 20000; ++i)
+      file_contents_ += "line " + std::to_string(i) + "\n";
+  }
+
+  // The body MultipartBody should produce for BODY, as AddParameters adds
+  // its parts.
+  string Expected(const MultipartBody& body) {
+    string boundary = body.content_type().substr(
+        string("multipart/form-data; boundary=").size());
+    return "--" + boundary + "\r\n"
+           "Content-Disposition: form-data; name=\"upload_file_minidump\"; "
+           "filename=\"dump.dmp\"\r\n"
+           "Content-Type: application/octet-stream\r\n"
+           "\r\n" + file_contents_ + "\r\n"
+           "--" + boundary + "\r\n"
+           "Content-Disposition: form-data; name=\"prod\"\r\n"
+           "\r\n"
+           "product\r\n"
+           "--" + boundary + "--\r\n";
+  }
+
+  void AddParts(MultipartBody* body) {
+    body->AddFile("upload_file_minidump", path_);
+    body->AddParameter("prod", "product");
+  }
+
+  AutoTempDir temp_dir_;
+  string path_;
+  string file_contents_;
+};
+
+TEST_F(MultipartBodyTest, Uncompressed) {
+  // Sizes that split the parts' headers and the file anywhere.
+  for (size_t size : {1, 7, 4096, 1 << 20}) {
+    MultipartBody body;
+    AddParts(&body);
+    ASSERT_TRUE(body.Start(false));
+    string contents;
+    ASSERT_TRUE(ReadAll(&body, size, &contents));
+    EXPECT_EQ(Expected(body), contents);
+  }
+}
+
+TEST_F(MultipartBodyTest, MissingFile) {
+  MultipartBody body;
+  body.AddFile("upload_file_minidump", path_ + ".missing");
+  EXPECT_FALSE(body.Start(false));
+}
+
+#ifdef HAVE_LIBZ
+TEST_F(MultipartBodyTest, Compressed) {
+  for (size_t size : {3, 512, 1 << 20}) {
+    MultipartBody body;
+    AddParts(&body);
+    ASSERT_TRUE(body.Start(true));
+    string compressed;
+    ASSERT_TRUE(ReadAll(&body, size, &compressed));
+    EXPECT_LT(compressed.size(), file_contents_.size() / 2);
+
+    z_stream stream = z_stream();
+    ASSERT_EQ(Z_OK, inflateInit2(&stream, 15 + 16));
+    string contents(Expected(body).size() + 1, '\0');
+    stream.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&contents[0]);
+    stream.avail_out = static_cast<uInt>(contents.size());
+    EXPECT_EQ(Z_STREAM_END, inflate(&stream, Z_FINISH));
+    contents.resize(contents.size() - stream.avail_out);
+    inflateEnd(&stream);
+    EXPECT_EQ(Expected(body), contents);
+  }
+}
+#endif  // HAVE_LIBZ
+
+}  // namespace
@@ -34,8 +34,10 @@
 
 #include <stdio.h>
 
+#include <atomic>
 #include <iostream>
 #include <regex>
+#include <thread>
 
 #include "common/linux/libcurl_wrapper.h"
 
@@ -194,5 +196,34 @@ SymbolStatus SymbolCollectorClient::CheckSymbolStatus(
       SymbolStatus::Missing;
 }
 
+// static
+void SymbolCollectorClient::CheckSymbolStatuses(
+    const std::vector<LibcurlWrapper*>& libcurl_wrappers,
+    const string& api_url,
+    const string& api_key,
+    const std::vector<SymbolId>& symbol_ids,
+    std::vector<SymbolStatus>* statuses) {
+  statuses->assign(symbol_ids.size(), SymbolStatus::Unknown);
+  std::atomic<size_t> next_symbol(0);
+  auto check = [&](LibcurlWrapper* libcurl_wrapper) {
+    for (size_t i = next_symbol++; i < symbol_ids.size();
+         i = next_symbol++) {
+      (*statuses)[i] = CheckSymbolStatus(libcurl_wrapper, api_url, api_key,
+                                         symbol_ids[i].debug_file,
+                                         symbol_ids[i].debug_id);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < libcurl_wrappers.size() && i < symbol_ids.size();
+       ++i) {
+    threads.emplace_back(check, libcurl_wrappers[i]);
+  }
+  if (!libcurl_wrappers.empty())
+    check(libcurl_wrappers[0]);
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
 }  // namespace sym_upload
 }  // namespace google_breakpad
@@ -30,6 +30,7 @@
 #define COMMON_LINUX_SYMBOL_COLLECTOR_CLIENT_H_
 
 #include <string>
+#include <vector>
 
 #include "common/linux/libcurl_wrapper.h"
 #include "common/using_std_string.h"
@@ -42,6 +43,12 @@ struct UploadUrlResponse {
   string upload_key;
 };
 
+// The names a sym-upload-v2 service knows a symbol file by.
+struct SymbolId {
+  string debug_file;
+  string debug_id;
+};
+
 enum SymbolStatus {
   Found,
   Missing,
@@ -79,6 +86,18 @@ class SymbolCollectorClient {
       const string& api_key,
       const string& debug_file,
       const string& debug_id);
+
+  // Checks the status of every symbol in |symbol_ids|, storing the results
+  // in the same order in |statuses|.  The checks are shared among
+  // |libcurl_wrappers|, each sending its share in turn on a thread of its
+  // own, so a caller with many files learns which need uploading in the
+  // time of a few round trips, over connections its uploads can reuse.
+  static void CheckSymbolStatuses(
+      const std::vector<LibcurlWrapper*>& libcurl_wrappers,
+      const string& api_url,
+      const string& api_key,
+      const std::vector<SymbolId>& symbol_ids,
+      std::vector<SymbolStatus>* statuses);
 };
 
 }  // namespace sym_upload
@@ -38,8 +38,12 @@
 #include <assert.h>
 #include <stdio.h>
 
+#include <atomic>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "common/linux/http_upload.h"
@@ -102,14 +106,11 @@ string CompactIdentifier(const string& uuid) {
   return result;
 }
 
-// |options| describes the current sym_upload options.
-// |module_parts| contains the strings parsed from the MODULE entry of the
-// Breakpad symbol file being uploaded.
-// |compacted_id| is the debug_id from the MODULE entry of the Breakpad symbol
-// file being uploaded, with all hyphens removed.
-bool SymUploadV1Start(
+// Returns the form parameters that describe a symbol file to a
+// 'sym-upload-v1' server.  The arguments are as for SymUploadV1Start.
+static std::map<string, string> SymUploadV1Parameters(
     const Options& options,
-    std::vector<string> module_parts,
+    const std::vector<string>& module_parts,
     const string& compacted_id) {
   std::map<string, string> parameters;
   // Add parameters
@@ -123,6 +124,20 @@ bool SymUploadV1Start(
   parameters["debug_file"] = module_parts[4];
   parameters["code_file"] = module_parts[4];
   parameters["debug_identifier"] = compacted_id;
+  return parameters;
+}
+
+// |options| describes the current sym_upload options.
+// |module_parts| contains the strings parsed from the MODULE entry of the
+// Breakpad symbol file being uploaded.
+// |compacted_id| is the debug_id from the MODULE entry of the Breakpad symbol
+// file being uploaded, with all hyphens removed.
+bool SymUploadV1Start(
+    const Options& options,
+    std::vector<string> module_parts,
+    const string& compacted_id) {
+  std::map<string, string> parameters =
+      SymUploadV1Parameters(options, module_parts, compacted_id);
 
   std::map<string, string> files;
   files["symbol_file"] = options.symbolsPath;
@@ -157,25 +172,55 @@ bool SymUploadV1Start(
   return success;
 }
 
+// Uploads the symbol file at |path| as SymUploadV1Start does, but through
+// |libcurl_wrapper|, so that its connection can be reused by later files.
+static bool SymUploadV1Send(
+    LibcurlWrapper* libcurl_wrapper,
+    const Options& options,
+    const string& path,
+    const std::vector<string>& module_parts,
+    const string& compacted_id) {
+  libcurl_wrapper->AddFile(path, "symbol_file");
+
+  string response;
+  long response_code = 0;
+  if (!libcurl_wrapper->SendRequest(
+          options.uploadURLStr,
+          SymUploadV1Parameters(options, module_parts, compacted_id),
+          &response_code,
+          /*http_header_data=*/nullptr,
+          &response)) {
+    printf("Failed to send symbol file %s\n", path.c_str());
+    return false;
+  } else if (response_code != 200) {
+    printf("Failed to send symbol file %s: Response code %ld\n",
+           path.c_str(), response_code);
+    printf("Response:\n");
+    printf("%s\n", response.c_str());
+    return false;
+  }
+  return true;
+}
+
+// |libcurl_wrapper| sends the requests, and may have sent others before.
 // |options| describes the current sym_upload options.
+// |path| is the symbol file to upload.
 // |code_id| is the basename of the module for which symbols are being
 // uploaded.
 // |debug_id| is the debug_id of the module for which symbols are being
 // uploaded.
-bool SymUploadV2Start(
+// |check_status| asks the server first whether it already has the file.
+static bool SymUploadV2Send(
+    LibcurlWrapper* libcurl_wrapper,
     const Options& options,
+    const string& path,
     const string& code_file,
     const string& debug_id,
-    const string& type) {
-  google_breakpad::LibcurlWrapper libcurl_wrapper;
-  if (!libcurl_wrapper.Init()) {
-    printf("Failed to init google_breakpad::LibcurlWrapper.\n");
-    return false;
-  }
-
-  if (!options.force) {
+    const string& type,
+    bool check_status) {
+  if (check_status) {
     SymbolStatus symbolStatus = SymbolCollectorClient::CheckSymbolStatus(
-        &libcurl_wrapper,
+        libcurl_wrapper,
         options.uploadURLStr,
         options.api_key,
         code_file,
@@ -192,7 +237,7 @@ bool SymUploadV2Start(
 
   UploadUrlResponse uploadUrlResponse;
   if (!SymbolCollectorClient::CreateUploadUrl(
-      &libcurl_wrapper,
+      libcurl_wrapper,
       options.uploadURLStr,
       options.api_key,
       &uploadUrlResponse)) {
@@ -204,13 +249,13 @@ bool SymUploadV2Start(
   string upload_key = uploadUrlResponse.upload_key;
   string header;
   string response;
-  long response_code;
+  long response_code = 0;
 
-  if (!libcurl_wrapper.SendPutRequest(signed_url,
-                                      options.symbolsPath,
-                                      &response_code,
-                                      &header,
-                                      &response)) {
+  if (!libcurl_wrapper->SendPutRequest(signed_url,
+                                       path,
+                                       &response_code,
+                                       &header,
+                                       &response)) {
     printf("Failed to send symbol file.\n");
     printf("Response code: %ld\n", response_code);
     printf("Response:\n");
@@ -227,7 +272,7 @@ bool SymUploadV2Start(
   }
 
   CompleteUploadResult completeUploadResult =
-      SymbolCollectorClient::CompleteUpload(&libcurl_wrapper,
+      SymbolCollectorClient::CompleteUpload(libcurl_wrapper,
                                             options.uploadURLStr,
                                             options.api_key,
                                             upload_key,
@@ -247,28 +292,233 @@ bool SymUploadV2Start(
   return true;
 }
 
+// |options| describes the current sym_upload options.
+// |code_id| is the basename of the module for which symbols are being
+// uploaded.
+// |debug_id| is the debug_id of the module for which symbols are being
+// uploaded.
+bool SymUploadV2Start(
+    const Options& options,
+    const string& code_file,
+    const string& debug_id,
+    const string& type) {
+  google_breakpad::LibcurlWrapper libcurl_wrapper;
+  if (!libcurl_wrapper.Init()) {
+    printf("Failed to init google_breakpad::LibcurlWrapper.\n");
+    return false;
+  }
+  libcurl_wrapper.set_compress_uploads(options.compress);
+
+  return SymUploadV2Send(&libcurl_wrapper, options, options.symbolsPath,
+                         code_file, debug_id, type, !options.force);
+}
+
+// Sets |code_file|, |debug_id| and |type| to the values 'sym-upload-v2'
+// sends for the symbol file at |path|, reading them from its MODULE line
+// for Breakpad symbols.  Returns false if the file cannot be parsed.
+static bool SymUploadV2Identity(const Options& options,
+                                const string& path,
+                                string* code_file,
+                                string* debug_id,
+                                string* type) {
+  if (options.type.empty() || options.type == kBreakpadSymbolType) {
+    // Breakpad upload so read these from input file.
+    std::vector<string> module_parts;
+    if (!ModuleDataForSymbolFile(path, &module_parts)) {
+      fprintf(stderr, "Failed to parse symbol file %s!\n", path.c_str());
+      return false;
+    }
+    *code_file = module_parts[4];
+    *debug_id = CompactIdentifier(module_parts[3]);
+    *type = kBreakpadSymbolType;
+  } else {
+    // Native upload so these must be explicitly set.
+    *code_file = options.code_file;
+    *debug_id = options.debug_id;
+    *type = options.type;
+  }
+  return true;
+}
+
+// A symbol file given to UploadSymbolFiles, and what is known about it.
+struct SymbolFileUpload {
+  enum State { PENDING, PRESENT, UPLOADED, FAILED };
+
+  explicit SymbolFileUpload(const string& path) : path(path), state(PENDING) {}
+
+  string path;
+  // The names 'sym-upload-v2' sends for the file.
+  SymbolId symbol_id;
+  string type;
+  State state;
+};
+
+// Uploads |file| with |libcurl_wrapper|, using the protocol |options|
+// selects.  |check_status| asks a 'sym-upload-v2' server whether it has
+// the file before sending it.
+static bool UploadSymbolFile(LibcurlWrapper* libcurl_wrapper,
+                             const Options& options,
+                             const SymbolFileUpload& file,
+                             bool check_status) {
+  if (options.upload_protocol == UploadProtocol::SYM_UPLOAD_V2) {
+    return SymUploadV2Send(libcurl_wrapper, options, file.path,
+                           file.symbol_id.debug_file,
+                           file.symbol_id.debug_id, file.type, check_status);
+  }
+
+  std::vector<string> module_parts;
+  if (!ModuleDataForSymbolFile(file.path, &module_parts)) {
+    fprintf(stderr, "Failed to parse symbol file %s!\n", file.path.c_str());
+    return false;
+  }
+  return SymUploadV1Send(libcurl_wrapper, options, file.path, module_parts,
+                         CompactIdentifier(module_parts[3]));
+}
+
+// Uploads every file in |options.symbol_files|, or |options.symbolsPath|
+// if that is empty, on up to |options.parallelism| threads.  Each thread
+// has its own LibcurlWrapper for all the files it sends, and so reuses its
+// connections to the servers.  The wrappers are created and destroyed on
+// this thread, since libcurl's global setup and cleanup are not
+// thread-safe.
+//
+// With 'sym-upload-v2', unless |options.force| is set, the server is asked
+// about every file, reading only each file's MODULE line, before any file
+// is sent, and the files it has are skipped.  With |options.list_missing|
+// set, the paths of the files it lacks are printed and nothing is sent.
+// Returns true if every file was checked and, if need be, uploaded.
+static bool UploadSymbolFiles(const Options& options) {
+  std::vector<SymbolFileUpload> files;
+  if (options.symbol_files.empty()) {
+    files.emplace_back(options.symbolsPath);
+  } else {
+    for (const string& path : options.symbol_files)
+      files.emplace_back(path);
+  }
+  size_t thread_count = options.parallelism > 1 ? options.parallelism : 1;
+  if (thread_count > files.size())
+    thread_count = files.size();
+
+  std::vector<std::unique_ptr<LibcurlWrapper>> wrappers;
+  std::vector<LibcurlWrapper*> wrapper_pointers;
+  for (size_t i = 0; i < thread_count; ++i) {
+    wrappers.emplace_back(new LibcurlWrapper);
+    LibcurlWrapper* wrapper = wrappers.back().get();
+    if (!wrapper->Init()) {
+      printf("Failed to init google_breakpad::LibcurlWrapper.\n");
+      return false;
+    }
+    wrapper->set_prefer_http2(true);
+    wrapper->set_compress_uploads(options.compress);
+    wrapper->set_proxy(options.proxy, options.proxy_user_pwd);
+    wrapper_pointers.push_back(wrapper);
+  }
+
+  bool v2 = options.upload_protocol == UploadProtocol::SYM_UPLOAD_V2;
+  bool check_first = v2 && (!options.force || options.list_missing);
+  if (v2) {
+    std::vector<size_t> checked;
+    std::vector<SymbolId> symbol_ids;
+    for (size_t i = 0; i < files.size(); ++i) {
+      SymbolFileUpload& file = files[i];
+      if (!SymUploadV2Identity(options, file.path, &file.symbol_id.debug_file,
+                               &file.symbol_id.debug_id, &file.type)) {
+        file.state = SymbolFileUpload::FAILED;
+      } else if (check_first) {
+        checked.push_back(i);
+        symbol_ids.push_back(file.symbol_id);
+      }
+    }
+
+    std::vector<SymbolStatus> statuses;
+    SymbolCollectorClient::CheckSymbolStatuses(wrapper_pointers,
+                                               options.uploadURLStr,
+                                               options.api_key,
+                                               symbol_ids,
+                                               &statuses);
+    for (size_t i = 0; i < checked.size(); ++i) {
+      SymbolFileUpload& file = files[checked[i]];
+      if (statuses[i] == SymbolStatus::Found) {
+        file.state = SymbolFileUpload::PRESENT;
+      } else if (statuses[i] == SymbolStatus::Unknown) {
+        printf("%s: failed to check for existing symbol\n",
+               file.path.c_str());
+        file.state = SymbolFileUpload::FAILED;
+      }
+    }
+  }
+
+  size_t failures = 0;
+  size_t present = 0;
+  for (const SymbolFileUpload& file : files) {
+    if (file.state == SymbolFileUpload::FAILED)
+      ++failures;
+    else if (file.state == SymbolFileUpload::PRESENT)
+      ++present;
+  }
+
+  if (options.list_missing) {
+    for (const SymbolFileUpload& file : files) {
+      if (file.state == SymbolFileUpload::PENDING)
+        printf("%s\n", file.path.c_str());
+    }
+    return failures == 0;
+  }
+
+  std::atomic<size_t> next_file(0);
+  std::mutex output_mutex;
+  auto upload = [&](LibcurlWrapper* wrapper) {
+    for (size_t i = next_file++; i < files.size(); i = next_file++) {
+      SymbolFileUpload& file = files[i];
+      if (file.state != SymbolFileUpload::PENDING)
+        continue;
+      bool uploaded = UploadSymbolFile(wrapper, options, file, false);
+      std::lock_guard<std::mutex> lock(output_mutex);
+      file.state =
+          uploaded ? SymbolFileUpload::UPLOADED : SymbolFileUpload::FAILED;
+      printf("%s: %s\n", file.path.c_str(),
+             uploaded ? "uploaded" : "upload failed");
+      fflush(stdout);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i)
+    threads.emplace_back(upload, wrapper_pointers[i]);
+  upload(wrapper_pointers[0]);
+  for (std::thread& thread : threads)
+    thread.join();
+
+  failures = 0;
+  size_t uploaded = 0;
+  for (const SymbolFileUpload& file : files) {
+    if (file.state == SymbolFileUpload::FAILED)
+      ++failures;
+    else if (file.state == SymbolFileUpload::UPLOADED)
+      ++uploaded;
+  }
+  printf("Sent %zu of %zu symbol files; %zu were already present", uploaded,
+         files.size(), present);
+  if (failures > 0)
+    printf(" and %zu failed", failures);
+  printf(".\n");
+  return failures == 0;
+}
+
 //=============================================================================
 void Start(Options* options) {
+  if (options->symbol_files.size() > 1 || options->list_missing) {
+    options->success = UploadSymbolFiles(*options);
+    return;
+  }
+
   if (options->upload_protocol == UploadProtocol::SYM_UPLOAD_V2) {
     string code_file;
     string debug_id;
     string type;
-
-    if (options->type.empty() || options->type == kBreakpadSymbolType) {
-      // Breakpad upload so read these from input file.
-      std::vector<string> module_parts;
-      if (!ModuleDataForSymbolFile(options->symbolsPath, &module_parts)) {
-        fprintf(stderr, "Failed to parse symbol file!\n");
-        return;
-      }
-      code_file = module_parts[4];
-      debug_id = CompactIdentifier(module_parts[3]);
-      type = kBreakpadSymbolType;
-    } else {
-      // Native upload so these must be explicitly set.
-      code_file = options->code_file;
-      debug_id = options->debug_id;
-      type = options->type;
+    if (!SymUploadV2Identity(*options, options->symbolsPath,
+                             &code_file, &debug_id, &type)) {
+      return;
     }
 
     options->success = SymUploadV2Start(*options, code_file, debug_id, type);
@@ -34,6 +34,7 @@
 #define COMMON_LINUX_SYMBOL_UPLOAD_H_
 
 #include <string>
+#include <vector>
 
 #include "common/using_std_string.h"
 
@@ -48,7 +49,13 @@ enum class UploadProtocol {
 constexpr char kBreakpadSymbolType[] = "BREAKPAD";
 
 struct Options {
-  Options() : upload_protocol(UploadProtocol::SYM_UPLOAD_V1), force(false) {}
+  Options()
+      : success(false),
+        upload_protocol(UploadProtocol::SYM_UPLOAD_V1),
+        force(false),
+        parallelism(1),
+        compress(false),
+        list_missing(false) {}
 
   string symbolsPath;
   string uploadURLStr;
@@ -64,6 +71,26 @@ struct Options {
   string code_file;
   string debug_id;
   string type;
+
+  // When this holds more than one path, these files are uploaded instead
+  // of symbolsPath, up to |parallelism| at a time.  Each upload thread
+  // keeps its connections open from one file to the next, and uses HTTP/2
+  // where the server supports it.  With 'sym-upload-v2', the server is
+  // asked about all of the files before any is sent, and those it already
+  // has are skipped unless |force| is set.  success is set only if every
+  // file is uploaded or skipped.
+  std::vector<string> symbol_files;
+  int parallelism;
+
+  // Compress symbol files with gzip as they are sent.  This only affects
+  // the 'sym-upload-v2' protocol.
+  bool compress;
+
+  // Only ask a 'sym-upload-v2' server which of the symbol files it lacks,
+  // printing their paths, and upload nothing.  Only the MODULE line of
+  // each file is read, so the files may be the headers "dump_syms -i"
+  // writes, letting a build dump just the modules the server lacks.
+  bool list_missing;
 };
 
 // Starts upload to symbol server with options.
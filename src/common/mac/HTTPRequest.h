@@ -40,6 +40,8 @@ NS_ASSUME_NONNULL_BEGIN
  @protected
   NSURL* URL_;                   // The destination URL (STRONG)
   NSHTTPURLResponse* response_;  // The response from the send (STRONG)
+  BOOL compressesBody_;          // Whether to gzip the body
+  float priority_;               // The priority of the request's task
 }
 
 /**
@@ -57,6 +59,25 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (NSData*)bodyData;  // Internal, don't call outside class hierarchy.
 
+/**
+ Sets whether the body is gzip-compressed and sent with a
+ Content-Encoding: gzip header, which the server must accept. The body is
+ sent uncompressed where compression is unavailable (before iOS 13 and
+ macOS 10.15). Defaults to NO.
+ */
+- (void)setCompressesBody:(BOOL)compressesBody;
+
+/**
+ Sets the priority of the request against the process's other network
+ traffic, from 0.0 (lowest) to 1.0 (highest), as for
+ NSURLSessionTask. Defaults to 0.5.
+ */
+- (void)setPriority:(float)priority;
+
+/**
+ Sends the request. Requests share an NSURLSession, so that successive
+ requests to the same server reuse its connection.
+ */
 - (NSData*)send:(NSError**)error;
 
 /**
@@ -51,11 +51,86 @@
 #define USE_NSURLSESSION 0
 #endif
 
+#if (defined(__IPHONE_13_0) || defined(MAC_OS_X_VERSION_10_15))
+#define HAS_DATA_COMPRESSION_API 1
+#else
+#define HAS_DATA_COMPRESSION_API 0
+#endif
+
+#if USE_NSURLSESSION
+// Returns the session all requests are sent through, so that the
+// connections it keeps open are reused by the next request.
+static NSURLSession* SharedURLSession() {
+  static NSURLSession* session = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    NSURLSessionConfiguration* config =
+        [NSURLSessionConfiguration defaultSessionConfiguration];
+    [config setTimeoutIntervalForRequest:240.0];
+    session = [[NSURLSession sessionWithConfiguration:config] retain];
+  });
+  return session;
+}
+#endif  // USE_NSURLSESSION
+
+// Returns the CRC-32 of |length| bytes at |bytes|, as gzip uses it.
+static uint32_t GzipCRC32(const uint8_t* bytes, NSUInteger length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (NSUInteger i = 0; i < length; ++i) {
+    crc ^= bytes[i];
+    for (int bit = 0; bit < 8; ++bit)
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+// Returns |data| compressed in the gzip format, or nil if it cannot be
+// compressed. NSData compresses to raw deflate data, which only needs the
+// gzip header and trailer around it.
+static NSData* GzipData(NSData* data) {
+#if HAS_DATA_COMPRESSION_API
+  if (@available(iOS 13.0, macOS 10.15, *)) {
+    NSData* deflated =
+        [data compressedDataUsingAlgorithm:NSDataCompressionAlgorithmZlib
+                                     error:nil];
+    if (!deflated)
+      return nil;
+
+    static const uint8_t kHeader[10] = {
+      0x1f, 0x8b,  // Magic number.
+      8,           // Deflate.
+      0,           // No flags.
+      0, 0, 0, 0,  // No modification time.
+      0,           // No extra flags.
+      255          // Unknown operating system.
+    };
+    uint32_t crc = GzipCRC32((const uint8_t*)[data bytes], [data length]);
+    uint32_t size = (uint32_t)[data length];
+    const uint8_t trailer[8] = {
+      (uint8_t)crc, (uint8_t)(crc >> 8),
+      (uint8_t)(crc >> 16), (uint8_t)(crc >> 24),
+      (uint8_t)size, (uint8_t)(size >> 8),
+      (uint8_t)(size >> 16), (uint8_t)(size >> 24)
+    };
+
+    NSMutableData* gzipped = [NSMutableData
+        dataWithCapacity:sizeof(kHeader) + [deflated length] + sizeof(trailer)];
+    [gzipped appendBytes:kHeader length:sizeof(kHeader)];
+    [gzipped appendData:deflated];
+    [gzipped appendBytes:trailer length:sizeof(trailer)];
+    return gzipped;
+  }
+#endif  // HAS_DATA_COMPRESSION_API
+  return nil;
+}
+
 // As -[NSURLConnection sendSynchronousRequest:returningResponse:error:] has
 // been deprecated with iOS 9.0 / OS X 10.11 SDKs, this function re-implements
 // it using -[NSURLSession dataTaskWithRequest:completionHandler:] which is
-// available on iOS 7+.
+// available on iOS 7+. |priority| is the task's priority; it is ignored
+// where NSURLSession is not used.
 static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
+                                           float priority,
                                            NSURLResponse** outResponse,
                                            NSError** outError) {
 #if USE_NSURLSESSION
@@ -64,11 +139,7 @@ static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
   __block NSURLResponse* response = nil;
   dispatch_semaphore_t waitSemaphone = dispatch_semaphore_create(0);
 
-  NSURLSessionConfiguration* config =
-      [NSURLSessionConfiguration defaultSessionConfiguration];
-  [config setTimeoutIntervalForRequest:240.0];
-  NSURLSession* session = [NSURLSession sessionWithConfiguration:config];
-  NSURLSessionDataTask *task = [session
+  NSURLSessionDataTask *task = [SharedURLSession()
       dataTaskWithRequest:req
         completionHandler:^(NSData* data, NSURLResponse* resp, NSError* err) {
           if (outError)
@@ -79,6 +150,7 @@ static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
             result = [data retain];
           dispatch_semaphore_signal(waitSemaphone);
         }];
+  [task setPriority:priority];
   [task resume];
 
 #if HAS_BACKGROUND_TASK_API
@@ -127,6 +199,7 @@ static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
     *outResponse = [response autorelease];
   return [result autorelease];
 #else  // USE_NSURLSESSION
+  (void)priority;
   return [NSURLConnection sendSynchronousRequest:req
                                returningResponse:outResponse
                                            error:outError];
@@ -139,6 +212,8 @@ static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
 - (id)initWithURL:(NSURL*)URL {
   if ((self = [super init])) {
     URL_ = [URL copy];
+    compressesBody_ = NO;
+    priority_ = 0.5;
   }
 
   return self;
@@ -162,6 +237,16 @@ static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
   return response_;
 }
 
+//=============================================================================
+- (void)setCompressesBody:(BOOL)compressesBody {
+  compressesBody_ = compressesBody;
+}
+
+//=============================================================================
+- (void)setPriority:(float)priority {
+  priority_ = priority;
+}
+
 //=============================================================================
 - (NSString*)HTTPMethod {
   @throw [NSException
@@ -196,7 +281,15 @@ static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
 
   NSData* bodyData = [self bodyData];
   if ([bodyData length] > 0) {
-    [req setHTTPBody:bodyData];
+    NSData* gzippedBody = nil;
+    if (compressesBody_ && ![URL_ isFileURL])
+      gzippedBody = GzipData(bodyData);
+    if (gzippedBody) {
+      [req setValue:@"gzip" forHTTPHeaderField:@"Content-Encoding"];
+      [req setHTTPBody:gzippedBody];
+    } else {
+      [req setHTTPBody:bodyData];
+    }
   }
 
   [req setHTTPMethod:[self HTTPMethod]];
@@ -209,7 +302,7 @@ static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
     [[req HTTPBody] writeToURL:[req URL] options:0 error:withError];
   } else {
     NSURLResponse* response = nil;
-    data = SendSynchronousNSURLRequest(req, &response, withError);
+    data = SendSynchronousNSURLRequest(req, priority_, &response, withError);
     response_ = (NSHTTPURLResponse*)[response retain];
   }
   [req release];
@@ -45,12 +45,17 @@
 #include <mach-o/fat.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <mutex>
 #include <ostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "common/dwarf/bytereader-inl.h"
@@ -119,10 +124,64 @@ vector<string> list_directory(const string& directory) {
   closedir(dir);
   return entries;
 }
+
+// Return the Breakpad identifier for a Mach-O file with the given UUID.
+string IdentifierFromUUID(const unsigned char uuid[16]) {
+  char identifier_string[40];
+  FileID::ConvertIdentifierToString(uuid, identifier_string,
+                                    sizeof(identifier_string));
+
+  string compacted(identifier_string);
+  for(size_t i = compacted.find('-'); i != string::npos;
+      i = compacted.find('-', i))
+    compacted.erase(i, 1);
+
+  // The pdb for these IDs has an extra byte, so to make everything uniform put
+  // a 0 on the end of mac IDs.
+  compacted += "0";
+
+  return compacted;
+}
+
+// A LoadCommandHandler that finds a Mach-O image's LC_UUID command.
+class UUIDFinder : public google_breakpad::mach_o::Reader::LoadCommandHandler {
+ public:
+  UUIDFinder() : found_(false) { }
+
+  bool UnknownCommand(google_breakpad::mach_o::LoadCommandType type,
+                      const google_breakpad::ByteBuffer& contents) {
+    // The contents include the command's type and size.
+    if (type != LC_UUID || contents.Size() < 8 + sizeof(uuid_))
+      return true;
+    memcpy(uuid_, contents.start + 8, sizeof(uuid_));
+    found_ = true;
+    return false;
+  }
+
+  bool found() const { return found_; }
+  const unsigned char* uuid() const { return uuid_; }
+
+ private:
+  bool found_;
+  unsigned char uuid_[16];
+};
 }
 
 namespace google_breakpad {
 
+DumpSymbols::~DumpSymbols() {
+  ReleaseContents();
+}
+
+void DumpSymbols::ReleaseContents() {
+  if (mapped_contents_)
+    munmap(mapped_contents_, size_);
+  mapped_contents_ = nullptr;
+  owned_contents_.reset();
+  contents_ = nullptr;
+  size_ = 0;
+}
+
 bool DumpSymbols::Read(const string& filename) {
   selected_object_file_ = nullptr;
   struct stat st;
@@ -132,8 +191,6 @@ bool DumpSymbols::Read(const string& filename) {
     return false;
   }
 
-  from_disk_ = true;
-
   // Does this filename refer to a dSYM bundle?
   string contents_path = filename + "/Contents/Resources/DWARF";
   string object_filename;
@@ -158,50 +215,64 @@ bool DumpSymbols::Read(const string& filename) {
     object_filename = filename;
   }
 
-  // Read the file's contents into memory.
-  bool read_ok = true;
-  string error;
-  scoped_array<uint8_t> contents;
-  off_t total = 0;
-  if (stat(object_filename.c_str(), &st) != -1) {
-    FILE* f = fopen(object_filename.c_str(), "rb");
-    if (f) {
-      contents.reset(new uint8_t[st.st_size]);
-      while (total < st.st_size && !feof(f)) {
-        size_t read = fread(&contents[0] + total, 1, st.st_size - total, f);
-        if (read == 0) {
-          if (ferror(f)) {
-            read_ok = false;
-            error = strerror(errno);
-          }
-          break;
-        }
-        total += read;
-      }
-      fclose(f);
-    } else {
-      error = strerror(errno);
-    }
-  }
-
-  if (!read_ok) {
+  // Map the file's contents into memory. Every object file in it, and its
+  // identifier, is read from this one mapping; pages of sections nobody
+  // asks for are never touched.
+  int fd = open(object_filename.c_str(), O_RDONLY);
+  if (fd == -1 || fstat(fd, &st) == -1) {
     fprintf(stderr, "Error reading object file: %s: %s\n",
-            object_filename.c_str(), error.c_str());
+            object_filename.c_str(), strerror(errno));
+    if (fd != -1)
+      close(fd);
     return false;
   }
-  return ReadData(contents.release(), total, object_filename);
+  void* mapped = nullptr;
+  if (st.st_size > 0) {
+    mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      fprintf(stderr, "Error mapping object file: %s: %s\n",
+              object_filename.c_str(), strerror(errno));
+      close(fd);
+      return false;
+    }
+  }
+  close(fd);
+
+  ReleaseContents();
+  mapped_contents_ = mapped;
+  contents_ = static_cast<const uint8_t*>(mapped);
+  size_ = st.st_size;
+  object_filename_ = object_filename;
+  return ReadObjectFiles();
 }
 
 bool DumpSymbols::ReadData(uint8_t* contents, size_t size,
                            const std::string& filename) {
-  contents_.reset(contents);
+  ReleaseContents();
+  owned_contents_.reset(contents);
+  contents_ = contents;
   size_ = size;
   object_filename_ = filename;
+  return ReadObjectFiles();
+}
+
+bool DumpSymbols::ReadObjectFiles() {
+  object_files_.clear();
+  shared_cache_images_.clear();
+  shared_cache_ = mach_o::SharedCacheReader::IsSharedCache(contents_, size_);
+  if (shared_cache_) {
+    mach_o::SharedCacheReader::Reporter cache_reporter(object_filename_);
+    mach_o::SharedCacheReader cache_reader(&cache_reporter);
+    if (!cache_reader.Read(contents_, size_))
+      return false;
+    shared_cache_images_ = cache_reader.images();
+    return true;
+  }
 
   // Get the list of object files present in the file.
   FatReader::Reporter fat_reporter(object_filename_);
   FatReader fat_reader(&fat_reporter);
-  if (!fat_reader.Read(contents_.get(), size)) {
+  if (!fat_reader.Read(contents_, size_)) {
     return false;
   }
 
@@ -270,41 +341,25 @@ void DumpSymbols::SetReportWarnings(bool report_warnings) {
 }
 
 string DumpSymbols::Identifier() {
-  scoped_ptr<FileID> file_id;
+  if (!SelectObjectFile())
+    return string();
+  return Identifier(*selected_object_file_);
+}
 
-  if (from_disk_) {
-    file_id.reset(new FileID(object_filename_.c_str()));
-  } else {
-    file_id.reset(new FileID(contents_.get(), size_));
-  }
+string DumpSymbols::Identifier(const SuperFatArch& object_file) const {
+  // Hash the contents already in memory, rather than reading the file
+  // again.
+  FileID file_id(const_cast<uint8_t*>(contents_), size_);
   unsigned char identifier_bytes[16];
-  scoped_ptr<Module> module;
-  if (!selected_object_file_) {
-    if (!CreateEmptyModule(module))
-      return string();
-  }
-  cpu_type_t cpu_type = selected_object_file_->cputype;
-  cpu_subtype_t cpu_subtype = selected_object_file_->cpusubtype;
-  if (!file_id->MachoIdentifier(cpu_type, cpu_subtype, identifier_bytes)) {
+  cpu_type_t cpu_type = object_file.cputype;
+  cpu_subtype_t cpu_subtype = object_file.cpusubtype;
+  if (!file_id.MachoIdentifier(cpu_type, cpu_subtype, identifier_bytes)) {
     fprintf(stderr, "Unable to calculate UUID of mach-o binary %s!\n",
             object_filename_.c_str());
     return "";
   }
 
-  char identifier_string[40];
-  FileID::ConvertIdentifierToString(identifier_bytes, identifier_string,
-                                    sizeof(identifier_string));
-
-  string compacted(identifier_string);
-  for(size_t i = compacted.find('-'); i != string::npos;
-      i = compacted.find('-', i))
-    compacted.erase(i, 1);
-
-  // The pdb for these IDs has an extra byte, so to make everything uniform put
-  // a 0 on the end of mac IDs.
-  compacted += "0";
-
-  return compacted;
+  return IdentifierFromUUID(identifier_bytes);
 }
 
 // A range handler that accepts rangelist data parsed by
@@ -363,7 +418,7 @@ class DumpSymbols::DumperLineToModule:
   ByteReader* byte_reader_;  // WEAK
 };
 
-bool DumpSymbols::CreateEmptyModule(scoped_ptr<Module>& module) {
+bool DumpSymbols::SelectObjectFile() {
   // Select an object file, if SetArchitecture hasn't been called to set one
   // explicitly.
   if (!selected_object_file_) {
@@ -385,11 +440,23 @@ bool DumpSymbols::CreateEmptyModule(scoped_ptr<Module>& module) {
   }
 
   assert(selected_object_file_);
+  return true;
+}
+
+bool DumpSymbols::CreateEmptyModule(scoped_ptr<Module>& module) {
+  if (!SelectObjectFile())
+    return false;
+  string object_name;
+  return CreateEmptyModule(*selected_object_file_, &object_name, module);
+}
 
-  // Find the name of the selected file's architecture, to appear in
+bool DumpSymbols::CreateEmptyModule(const SuperFatArch& object_file,
+                                    string* object_name,
+                                    scoped_ptr<Module>& module) const {
+  // Find the name of the object file's architecture, to appear in
   // the MODULE record and in error messages.
   const char* selected_arch_name = GetNameFromCPUType(
-      selected_object_file_->cputype, selected_object_file_->cpusubtype);
+      object_file.cputype, object_file.cpusubtype);
 
   // In certain cases, it is possible that architecture info can't be reliably
   // determined, e.g. new architectures that breakpad is unware of. In that
@@ -403,10 +470,10 @@ bool DumpSymbols::CreateEmptyModule(scoped_ptr<Module>& module) {
 
   // Produce a name to use in error messages that includes the
   // filename, and the architecture, if there is more than one.
-  selected_object_name_ = object_filename_;
+  *object_name = object_filename_;
   if (object_files_.size() > 1) {
-    selected_object_name_ += ", architecture ";
-    selected_object_name_ += selected_arch_name;
+    *object_name += ", architecture ";
+    *object_name += selected_arch_name;
   }
 
   // Compute a module name, to appear in the MODULE record.
@@ -418,7 +485,7 @@ bool DumpSymbols::CreateEmptyModule(scoped_ptr<Module>& module) {
   }
 
   // Choose an identifier string, to appear in the MODULE record.
-  string identifier = Identifier();
+  string identifier = Identifier(object_file);
   if (identifier.empty())
     return false;
 
@@ -482,6 +549,7 @@ void DumpSymbols::StartProcessSplitDwarf(
 }
 
 void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
+                            const string& object_name,
                             const mach_o::Reader& macho_reader,
                             const mach_o::SectionMap& dwarf_sections,
                             bool handle_inter_cu_refs) const {
@@ -491,7 +559,7 @@ void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
   ByteReader byte_reader(endianness);
 
   // Construct a context for this file.
-  DwarfCUToModule::FileContext file_context(selected_object_name_,
+  DwarfCUToModule::FileContext file_context(object_name,
                                             module,
                                             handle_inter_cu_refs);
 
@@ -510,7 +578,7 @@ void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
   // There had better be a __debug_info section!
   if (debug_info_entry == file_context.section_map().end()) {
     fprintf(stderr, "%s: __DWARF segment of file has no __debug_info section\n",
-            selected_object_name_.c_str());
+            object_name.c_str());
     return;
   }
   const std::pair<const uint8_t*, uint64_t>& debug_info_section =
@@ -525,16 +593,18 @@ void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
   // Walk the __debug_info section, one compilation unit at a time.
   uint64_t debug_info_length = debug_info_section.second;
   bool handle_inline = symbol_data_ & INLINES;
+  // Units usually share a few abbreviation tables; parse each only once.
+  CompilationUnit::AbbrevCache abbrev_cache;
   for (uint64_t offset = 0; offset < debug_info_length;) {
     // Make a handler for the root DIE that populates MODULE with the
     // debug info.
     std::unique_ptr<DwarfCUToModule::WarningReporter> reporter;
     if (report_warnings_) {
       reporter = std::make_unique<DwarfCUToModule::WarningReporter>(
-        selected_object_name_, offset);
+        object_name, offset);
     } else {
       reporter = std::make_unique<DwarfCUToModule::NullWarningReporter>(
-        selected_object_name_, offset);
+        object_name, offset);
     }
     DwarfCUToModule root_handler(&file_context, &line_to_module,
                                  &ranges_handler, reporter.get(),
@@ -542,11 +612,12 @@ void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
     // Make a Dwarf2Handler that drives our DIEHandler.
     DIEDispatcher die_dispatcher(&root_handler);
     // Make a DWARF parser for the compilation unit at OFFSET.
-    CompilationUnit dwarf_reader(selected_object_name_,
+    CompilationUnit dwarf_reader(object_name,
                                                file_context.section_map(),
                                                offset,
                                                &byte_reader,
                                                &die_dispatcher);
+    dwarf_reader.set_abbrev_cache(&abbrev_cache);
     // Process the entire compilation unit; get the offset of the next.
     offset += dwarf_reader.Start();
     // Start to process split dwarf file.
@@ -558,6 +629,7 @@ void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
 }
 
 bool DumpSymbols::ReadCFI(google_breakpad::Module* module,
+                          const string& object_name,
                           const mach_o::Reader& macho_reader,
                           const mach_o::Section& section,
                           bool eh_frame) const {
@@ -584,7 +656,7 @@ bool DumpSymbols::ReadCFI(google_breakpad::Module* module,
           stderr,
           "%s: cannot convert DWARF call frame information for architecture "
           "'%s' (%d, %d) to Breakpad symbol file: no register name table\n",
-          selected_object_name_.c_str(), arch_name, macho_reader.cpu_type(),
+          object_name.c_str(), arch_name, macho_reader.cpu_type(),
           macho_reader.cpu_subtype());
       return false;
     }
@@ -595,7 +667,7 @@ bool DumpSymbols::ReadCFI(google_breakpad::Module* module,
   size_t cfi_size = section.contents.Size();
 
   // Plug together the parser, handler, and their entourages.
-  DwarfCFIToModule::Reporter module_reporter(selected_object_name_,
+  DwarfCFIToModule::Reporter module_reporter(object_name,
                                              section.section_name);
   DwarfCFIToModule handler(module, register_names, &module_reporter);
   ByteReader byte_reader(macho_reader.big_endian() ?
@@ -607,7 +679,7 @@ bool DumpSymbols::ReadCFI(google_breakpad::Module* module,
   // this is the only base address the CFI parser will need.
   byte_reader.SetCFIDataBase(section.address, cfi);
 
-  CallFrameInfo::Reporter dwarf_reporter(selected_object_name_,
+  CallFrameInfo::Reporter dwarf_reporter(object_name,
                                                        section.section_name);
   CallFrameInfo parser(cfi, cfi_size,
                                      &byte_reader, &handler, &dwarf_reporter,
@@ -625,11 +697,13 @@ class DumpSymbols::LoadCommandDumper:
   // file, and adding data to MODULE.
   LoadCommandDumper(const DumpSymbols& dumper,
                     google_breakpad::Module* module,
+                    const string& object_name,
                     const mach_o::Reader& reader,
                     SymbolData symbol_data,
                     bool handle_inter_cu_refs)
       : dumper_(dumper),
         module_(module),
+        object_name_(object_name),
         reader_(reader),
         symbol_data_(symbol_data),
         handle_inter_cu_refs_(handle_inter_cu_refs) { }
@@ -640,39 +714,41 @@ class DumpSymbols::LoadCommandDumper:
  private:
   const DumpSymbols& dumper_;
   google_breakpad::Module* module_;  // WEAK
+  const string& object_name_;
   const mach_o::Reader& reader_;
   const SymbolData symbol_data_;
   const bool handle_inter_cu_refs_;
 };
 
 bool DumpSymbols::LoadCommandDumper::SegmentCommand(const Segment& segment) {
-  mach_o::SectionMap section_map;
-  if (!reader_.MapSegmentSections(segment, &section_map))
-    return false;
-
   if (segment.name == "__TEXT") {
     module_->SetLoadAddress(segment.vmaddr);
-    if (symbol_data_ & CFI) {
-      mach_o::SectionMap::const_iterator eh_frame =
-          section_map.find("__eh_frame");
-      if (eh_frame != section_map.end()) {
-        // If there is a problem reading this, don't treat it as a fatal error.
-        dumper_.ReadCFI(module_, reader_, eh_frame->second, true);
-      }
+    // Only __eh_frame is wanted from __TEXT, so find it by name rather
+    // than mapping every section.
+    mach_o::Section eh_frame;
+    if ((symbol_data_ & CFI) &&
+        reader_.FindSection(segment, "__eh_frame", &eh_frame)) {
+      // If there is a problem reading this, don't treat it as a fatal error.
+      dumper_.ReadCFI(module_, object_name_, reader_, eh_frame, true);
     }
     return true;
   }
 
   if (segment.name == "__DWARF") {
+    mach_o::SectionMap section_map;
+    if (!reader_.MapSegmentSections(segment, &section_map))
+      return false;
     if ((symbol_data_ & SYMBOLS_AND_FILES) || (symbol_data_ & INLINES)) {
-      dumper_.ReadDwarf(module_, reader_, section_map, handle_inter_cu_refs_);
+      dumper_.ReadDwarf(module_, object_name_, reader_, section_map,
+                        handle_inter_cu_refs_);
     }
     if (symbol_data_ & CFI) {
       mach_o::SectionMap::const_iterator debug_frame
           = section_map.find("__debug_frame");
       if (debug_frame != section_map.end()) {
         // If there is a problem reading this, don't treat it as a fatal error.
-        dumper_.ReadCFI(module_, reader_, debug_frame->second, false);
+        dumper_.ReadCFI(module_, object_name_, reader_, debug_frame->second,
+                        false);
       }
     }
   }
@@ -698,23 +774,31 @@ bool DumpSymbols::LoadCommandDumper::SymtabCommand(const ByteBuffer& entries,
 }
 
 bool DumpSymbols::ReadSymbolData(Module** out_module) {
+  if (!SelectObjectFile())
+    return false;
+  return ReadObjectFile(*selected_object_file_, out_module);
+}
+
+bool DumpSymbols::ReadObjectFile(const SuperFatArch& object_file,
+                                 Module** out_module) const {
   scoped_ptr<Module> module;
-  if (!CreateEmptyModule(module))
+  string object_name;
+  if (!CreateEmptyModule(object_file, &object_name, module))
     return false;
 
-  // Parse the selected object file.
-  mach_o::Reader::Reporter reporter(selected_object_name_);
+  // Parse the object file.
+  mach_o::Reader::Reporter reporter(object_name);
   mach_o::Reader reader(&reporter);
-  if (!reader.Read(&contents_[0]
-                   + selected_object_file_->offset,
-                   selected_object_file_->size,
-                   selected_object_file_->cputype,
-                   selected_object_file_->cpusubtype))
+  if (!reader.Read(contents_ + object_file.offset,
+                   object_file.size,
+                   object_file.cputype,
+                   object_file.cpusubtype))
     return false;
 
   // Walk its load commands, and deal with whatever is there.
-  LoadCommandDumper load_command_dumper(*this, module.get(), reader,
-                                        symbol_data_, handle_inter_cu_refs_);
+  LoadCommandDumper load_command_dumper(*this, module.get(), object_name,
+                                        reader, symbol_data_,
+                                        handle_inter_cu_refs_);
   if (!reader.WalkLoadCommands(&load_command_dumper))
     return false;
 
@@ -723,6 +807,160 @@ bool DumpSymbols::ReadSymbolData(Module** out_module) {
   return true;
 }
 
+bool DumpSymbols::ReadSymbolDataForArchitectures(
+    const vector<ArchInfo>& archs,
+    int thread_count,
+    vector<Module*>* modules) {
+  modules->clear();
+  vector<const SuperFatArch*> object_files;
+  if (archs.empty()) {
+    for (const SuperFatArch& object_file : object_files_)
+      object_files.push_back(&object_file);
+  }
+  for (const ArchInfo& arch : archs) {
+    const SuperFatArch* object_file =
+        FindBestMatchForArchitecture(arch.cputype, arch.cpusubtype);
+    if (!object_file) {
+      fprintf(stderr, "%s: no architecture '%s' is present in file.\n",
+              object_filename_.c_str(),
+              GetNameFromCPUType(arch.cputype, arch.cpusubtype));
+      return false;
+    }
+    object_files.push_back(object_file);
+  }
+
+  // Each object file is a separate part of contents_ and becomes a
+  // separate module, so they can be read concurrently.
+  vector<Module*> results(object_files.size(), nullptr);
+  std::atomic<size_t> next_object_file(0);
+  std::atomic<bool> succeeded(true);
+  auto read_object_files = [&]() {
+    for (size_t i = next_object_file++; i < object_files.size();
+         i = next_object_file++) {
+      if (!ReadObjectFile(*object_files[i], &results[i]))
+        succeeded = false;
+    }
+  };
+  vector<std::thread> threads;
+  for (int i = 1; i < thread_count &&
+                  i < static_cast<int>(object_files.size()); ++i) {
+    threads.push_back(std::thread(read_object_files));
+  }
+  read_object_files();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  if (!succeeded) {
+    for (Module* module : results)
+      delete module;
+    return false;
+  }
+  modules->swap(results);
+  return true;
+}
+
+bool DumpSymbols::ReadSharedCacheImage(const mach_o::SharedCacheImage& image,
+                                       Module** out_module) const {
+  string object_name = object_filename_ + ", image " + image.path;
+  mach_o::Reader::Reporter reporter(object_name);
+  mach_o::Reader reader(&reporter);
+  if (!reader.ReadImage(contents_, size_, image.file_offset, CPU_TYPE_ANY,
+                        CPU_SUBTYPE_MULTIPLE)) {
+    return false;
+  }
+
+  const char* arch_name = GetNameFromCPUType(reader.cpu_type(),
+                                             reader.cpu_subtype());
+  if (strcmp(arch_name, kUnknownArchName) == 0) {
+    fprintf(stderr, "%s: unknown architecture (%d, %d)\n",
+            object_name.c_str(), reader.cpu_type(), reader.cpu_subtype());
+    return false;
+  }
+  if (strcmp(arch_name, "i386") == 0)
+    arch_name = "x86";
+
+  // Images in the cache are never hashed; their UUID is their identifier.
+  UUIDFinder uuid_finder;
+  reader.WalkLoadCommands(&uuid_finder);
+  if (!uuid_finder.found()) {
+    fprintf(stderr, "%s: image has no LC_UUID load command\n",
+            object_name.c_str());
+    return false;
+  }
+
+  scoped_ptr<Module> module(
+      new Module(google_breakpad::BaseName(image.path), "mac", arch_name,
+                 IdentifierFromUUID(uuid_finder.uuid()), "",
+                 enable_multiple_, prefer_extern_name_));
+  LoadCommandDumper load_command_dumper(*this, module.get(), object_name,
+                                        reader, symbol_data_,
+                                        handle_inter_cu_refs_);
+  if (!reader.WalkLoadCommands(&load_command_dumper))
+    return false;
+
+  *out_module = module.release();
+  return true;
+}
+
+bool DumpSymbols::ReadSharedCacheImages(
+    const vector<string>& images,
+    int thread_count,
+    const std::function<bool(Module*)>& handler) {
+  vector<const mach_o::SharedCacheImage*> selected;
+  if (images.empty()) {
+    for (const mach_o::SharedCacheImage& image : shared_cache_images_)
+      selected.push_back(&image);
+  }
+  for (const string& name : images) {
+    const mach_o::SharedCacheImage* found = nullptr;
+    for (const mach_o::SharedCacheImage& image : shared_cache_images_) {
+      if (image.path == name ||
+          google_breakpad::BaseName(image.path) == name) {
+        found = &image;
+        break;
+      }
+    }
+    if (!found) {
+      fprintf(stderr, "%s: no image '%s' is present in the dyld shared"
+              " cache\n", object_filename_.c_str(), name.c_str());
+      return false;
+    }
+    selected.push_back(found);
+  }
+
+  // Every image is read from the one mapping of the cache, and becomes a
+  // separate module, so they can be read concurrently.
+  std::atomic<size_t> next_image(0);
+  std::atomic<bool> succeeded(true);
+  std::atomic<bool> stopped(false);
+  std::mutex handler_mutex;
+  auto read_images = [&]() {
+    for (size_t i = next_image++; i < selected.size() && !stopped;
+         i = next_image++) {
+      Module* module = nullptr;
+      if (!ReadSharedCacheImage(*selected[i], &module)) {
+        succeeded = false;
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(handler_mutex);
+      if (!handler(module)) {
+        succeeded = false;
+        stopped = true;
+      }
+    }
+  };
+  vector<std::thread> threads;
+  for (int i = 1; i < thread_count &&
+                  i < static_cast<int>(selected.size()); ++i) {
+    threads.push_back(std::thread(read_images));
+  }
+  read_images();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  return succeeded;
+}
+
 // Read the selected object file's debugging information, and write out the
 // header only to |stream|. Return true on success; if an error occurs, report
 // it and return false.
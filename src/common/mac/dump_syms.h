@@ -38,6 +38,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <functional>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -65,19 +66,20 @@ class DumpSymbols {
         object_filename_(),
         contents_(),
         size_(0),
-        from_disk_(false),
+        owned_contents_(),
+        mapped_contents_(nullptr),
         object_files_(),
         selected_object_file_(),
-        selected_object_name_(),
         enable_multiple_(enable_multiple),
         module_name_(module_name),
         prefer_extern_name_(prefer_extern_name),
-        report_warnings_(true) {}
-  ~DumpSymbols() = default;
+        report_warnings_(true),
+        shared_cache_(false) {}
+  ~DumpSymbols();
 
   // Prepare to read debugging information from |filename|. |filename| may be
-  // the name of a fat file, a Mach-O file, or a dSYM bundle containing either
-  // of the above.
+  // the name of a fat file, a Mach-O file, a dSYM bundle containing either
+  // of the above, or a dyld shared cache.
   //
   // If |module_name_| is empty, uses the basename of |filename| as the module
   // name. Otherwise, uses |module_name_| as the module name.
@@ -131,23 +133,92 @@ class DumpSymbols {
   // it when finished.
   bool ReadSymbolData(Module** module);
 
+  // Read the debugging information of the object file that best matches
+  // each architecture in `archs`, or of every object file if `archs` is
+  // empty, and store a module for each in `modules`, in the same order.
+  // Up to `thread_count` object files are read at once, all from the
+  // contents already loaded by Read or ReadData.  The caller owns the
+  // resulting module objects.  If an architecture is missing or an object
+  // file can't be read, report it and return false, leaving `modules`
+  // empty.  This does not change the selected architecture.
+  bool ReadSymbolDataForArchitectures(const vector<ArchInfo>& archs,
+                                      int thread_count,
+                                      vector<Module*>* modules);
+
   // Return an identifier string for the file this DumpSymbols is dumping.
   std::string Identifier();
 
+  // Return true if the file read by Read or ReadData is a dyld shared
+  // cache. Its images are dumped with ReadSharedCacheImages; it has no
+  // architectures to select.
+  bool IsSharedCache() const { return shared_cache_; }
+
+  // Return the images in the dyld shared cache read by Read or ReadData.
+  const vector<mach_o::SharedCacheImage>& SharedCacheImages() const {
+    return shared_cache_images_;
+  }
+
+  // Read the debugging information of each image in the dyld shared cache
+  // whose install name or basename is in `images`, or of every image if
+  // `images` is empty, and pass a module for it to `handler`, which takes
+  // ownership of it. The images are read in place from the contents
+  // loaded by Read, up to `thread_count` at once; `handler` is called for
+  // one image at a time, in no particular order. If a named image is
+  // missing, report it and return false without reading any. If an image
+  // can't be read, report it and carry on with the others. Return true if
+  // every image was read and `handler` returned true for each; stop early
+  // if `handler` returns false.
+  bool ReadSharedCacheImages(const vector<string>& images,
+                             int thread_count,
+                             const std::function<bool(Module*)>& handler);
+
  private:
   // Used internally.
   class DumperLineToModule;
   class DumperRangesHandler;
   class LoadCommandDumper;
 
+  // Unmap or free contents_, whichever Read or ReadData left it in.
+  void ReleaseContents();
+
+  // Find the object files in contents_ and store them in object_files_,
+  // or, if contents_ is a dyld shared cache, find its images and store
+  // them in shared_cache_images_. On failure, report the problem and
+  // return false.
+  bool ReadObjectFiles();
+
+  // Read the dyld shared cache image |image| in contents_ and store its
+  // debugging information in a new module in |*out_module|.
+  bool ReadSharedCacheImage(const mach_o::SharedCacheImage& image,
+                            Module** out_module) const;
+
   // This method behaves similarly to NXFindBestFatArch, but it supports
   // SuperFatArch.
   SuperFatArch* FindBestMatchForArchitecture(
       cpu_type_t cpu_type, cpu_subtype_t cpu_subtype);
 
-  // Creates an empty module object.
+  // Select the object file to dump if SetArchitecture hasn't been called
+  // to select one explicitly.  Return false if there is no single choice.
+  bool SelectObjectFile();
+
+  // Creates an empty module object for the selected object file.
   bool CreateEmptyModule(scoped_ptr<Module>& module);
 
+  // Creates an empty module object for |object_file|, and sets
+  // |*object_name| to the name to use for it in error messages: the file
+  // name, followed by the architecture if the file is a fat binary.
+  bool CreateEmptyModule(const SuperFatArch& object_file,
+                         string* object_name,
+                         scoped_ptr<Module>& module) const;
+
+  // Return an identifier string for |object_file|.
+  string Identifier(const SuperFatArch& object_file) const;
+
+  // Read |object_file|'s debugging information and store it in a new
+  // module in |*out_module|.
+  bool ReadObjectFile(const SuperFatArch& object_file,
+                      Module** out_module) const;
+
   // Process the split dwarf file referenced by reader.
   void StartProcessSplitDwarf(google_breakpad::CompilationUnit* reader,
                               Module* module,
@@ -156,8 +227,10 @@ class DumpSymbols {
                               bool handle_inline) const;
 
   // Read debugging information from |dwarf_sections|, which was taken from
-  // |macho_reader|, and add it to |module|.
+  // |macho_reader|, and add it to |module|.  |object_name| names the
+  // object file in warnings.
   void ReadDwarf(google_breakpad::Module* module,
+                 const string& object_name,
                  const mach_o::Reader& macho_reader,
                  const mach_o::SectionMap& dwarf_sections,
                  bool handle_inter_cu_refs) const;
@@ -168,6 +241,7 @@ class DumpSymbols {
   // .debug_frame data. On success, return true; on failure, report
   // the problem and return false.
   bool ReadCFI(google_breakpad::Module* module,
+               const string& object_name,
                const mach_o::Reader& macho_reader,
                const mach_o::Section& section,
                bool eh_frame) const;
@@ -183,16 +257,20 @@ class DumpSymbols {
   // then this is the resource file within that bundle.
   std::string object_filename_;
 
-  // The complete contents of object_filename_, mapped into memory.
-  scoped_array<uint8_t> contents_;
+  // The complete contents of object_filename_, mapped into memory. The
+  // fat reader, the Mach-O readers and the identifier computation all work
+  // on this one copy.
+  const uint8_t* contents_;
 
   // The size of contents_.
   size_t size_;
 
-  // Indicates which entry point to DumpSymbols was used, i.e. Read vs ReadData.
-  // This is used to indicate that downstream code paths can/should also read
-  // from disk or not.
-  bool from_disk_;
+  // If contents_ was passed to ReadData, the buffer holding it.
+  scoped_array<uint8_t> owned_contents_;
+
+  // If contents_ was mapped from object_filename_ by Read, the start of the
+  // mapping, which is unmapped on destruction; otherwise, NULL.
+  void* mapped_contents_;
 
   // A vector of SuperFatArch structures describing the object files
   // object_filename_ contains. If object_filename_ refers to a fat binary,
@@ -204,12 +282,6 @@ class DumpSymbols {
   // SetArchitecture hasn't been called yet.
   const SuperFatArch* selected_object_file_;
 
-  // A string that identifies the selected object file, for use in error
-  // messages.  This is usually object_filename_, but if that refers to a
-  // fat binary, it includes an indication of the particular architecture
-  // within that binary.
-  string selected_object_name_;
-
   // Whether symbols sharing an address should be collapsed into a single entry
   // and marked with an `m` in the output. 
   // See: https://crbug.com/google-breakpad/751 and docs at 
@@ -231,6 +303,11 @@ class DumpSymbols {
 
   // Whether or not to report warnings
   bool report_warnings_;
+
+  // True if contents_ is a dyld shared cache, whose images are listed in
+  // shared_cache_images_ and whose object_files_ is empty.
+  bool shared_cache_;
+  vector<mach_o::SharedCacheImage> shared_cache_images_;
 };
 
 }  // namespace google_breakpad
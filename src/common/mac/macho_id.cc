@@ -74,6 +74,21 @@ void MachoID::Update(MachoWalker* walker, off_t offset, size_t size) {
   if (!update_function_ || !size)
     return;
 
+  // If the bytes are already in memory, hash them where they are.
+  if (const void* memory = walker->MemoryAt(offset, size)) {
+    unsigned char* bytes =
+        static_cast<unsigned char*>(const_cast<void*>(memory));
+    // Keep each update's size within what MD5Update accepts.
+    const size_t kMaxUpdateSize = 1 << 30;
+    while (size > 0) {
+      size_t update_size = size < kMaxUpdateSize ? size : kMaxUpdateSize;
+      (this->*update_function_)(bytes, update_size);
+      bytes += update_size;
+      size -= update_size;
+    }
+    return;
+  }
+
   // Read up to 4k bytes at a time
   unsigned char buffer[4096];
   size_t buffer_size;
@@ -40,6 +40,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <limits>
 
@@ -160,6 +161,118 @@ bool FatReader::Read(const uint8_t* buffer, size_t size) {
   return false;
 }
 
+void SharedCacheReader::Reporter::TooShort() {
+  fprintf(stderr, "%s: file too short for the dyld shared cache data it"
+          " claims to contain\n", filename_.c_str());
+}
+
+void SharedCacheReader::Reporter::MisplacedImage(const string& path) {
+  fprintf(stderr, "%s: the image '%s' does not lie within the dyld shared"
+          " cache file\n", filename_.c_str(), path.c_str());
+}
+
+void SharedCacheReader::Reporter::SplitCache() {
+  fprintf(stderr, "%s: dyld shared caches split into subcache files are not"
+          " supported\n", filename_.c_str());
+}
+
+bool SharedCacheReader::IsSharedCache(const uint8_t* buffer, size_t size) {
+  static const char kMagic[] = "dyld_v1 ";
+  return size >= 16 && memcmp(buffer, kMagic, sizeof(kMagic) - 1) == 0;
+}
+
+bool SharedCacheReader::Read(const uint8_t* buffer, size_t size) {
+  // Offsets of the dyld_cache_header fields used here. The header has
+  // grown over time; mapping_offset, the offset of the mapping list that
+  // follows it, gives its size.
+  const size_t kMappingOffset = 0x10;
+  const size_t kSubCacheArrayCount = 0x18c;
+  const size_t kImagesOffset = 0x1c0;
+  // The sizes of dyld_cache_mapping_info and dyld_cache_image_info.
+  const size_t kMappingSize = 32;
+  const size_t kImageSize = 32;
+
+  images_.clear();
+  ByteBuffer cache(buffer, size);
+  ByteCursor cursor(&cache, false);
+  uint32_t mapping_offset, mapping_count, images_offset, images_count;
+  cursor.Skip(kMappingOffset) >> mapping_offset >> mapping_count
+      >> images_offset >> images_count;
+  if (!cursor || mapping_offset > size) {
+    reporter_->TooShort();
+    return false;
+  }
+
+  if (mapping_offset >= kSubCacheArrayCount + 4) {
+    uint32_t subcache_count;
+    cursor.set_here(buffer + kSubCacheArrayCount) >> subcache_count;
+    if (subcache_count != 0) {
+      reporter_->SplitCache();
+      return false;
+    }
+  }
+  // Newer caches list their images in a second table, leaving the first
+  // empty.
+  if (images_count == 0 && mapping_offset >= kImagesOffset + 8) {
+    cursor.set_here(buffer + kImagesOffset) >> images_offset >> images_count;
+  }
+  if (mapping_count > (size - mapping_offset) / kMappingSize ||
+      images_offset > size ||
+      images_count > (size - images_offset) / kImageSize) {
+    reporter_->TooShort();
+    return false;
+  }
+
+  struct Mapping {
+    uint64_t address, size, file_offset;
+  };
+  vector<Mapping> mappings(mapping_count);
+  cursor.set_here(buffer + mapping_offset);
+  for (Mapping& mapping : mappings) {
+    cursor >> mapping.address >> mapping.size >> mapping.file_offset;
+    cursor.Skip(8);  // maxProt, initProt
+  }
+
+  images_.resize(images_count);
+  cursor.set_here(buffer + images_offset);
+  for (SharedCacheImage& image : images_) {
+    uint64_t mod_time, inode;
+    uint32_t path_offset, pad;
+    cursor >> image.address >> mod_time >> inode >> path_offset >> pad;
+    const uint8_t* path_end = path_offset < size ?
+        static_cast<const uint8_t*>(
+            memchr(buffer + path_offset, '\0', size - path_offset)) :
+        nullptr;
+    if (!path_end) {
+      reporter_->TooShort();
+      images_.clear();
+      return false;
+    }
+    image.path.assign(reinterpret_cast<const char*>(buffer + path_offset),
+                      path_end - (buffer + path_offset));
+
+    // Find the image's header in the file through the mapping that holds
+    // its address.
+    bool placed = false;
+    for (const Mapping& mapping : mappings) {
+      if (image.address >= mapping.address &&
+          image.address - mapping.address < mapping.size) {
+        image.file_offset =
+            mapping.file_offset + (image.address - mapping.address);
+        placed = image.file_offset >= mapping.file_offset &&
+                 image.file_offset < size;
+        break;
+      }
+    }
+    if (!placed) {
+      reporter_->MisplacedImage(image.path);
+      images_.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
 void Reader::Reporter::BadHeader() {
   fprintf(stderr, "%s: file is not a Mach-O object file\n", filename_.c_str());
 }
@@ -232,10 +345,19 @@ bool Reader::Read(const uint8_t* buffer,
                   size_t size,
                   cpu_type_t expected_cpu_type,
                   cpu_subtype_t expected_cpu_subtype) {
+  return ReadImage(buffer, size, 0, expected_cpu_type, expected_cpu_subtype);
+}
+
+bool Reader::ReadImage(const uint8_t* buffer,
+                       size_t size,
+                       size_t header_offset,
+                       cpu_type_t expected_cpu_type,
+                       cpu_subtype_t expected_cpu_subtype) {
   assert(!buffer_.start);
   buffer_.start = buffer;
   buffer_.end = buffer + size;
   ByteCursor cursor(&buffer_, true);
+  cursor.Skip(header_offset);
   uint32_t magic;
   if (!(cursor >> magic)) {
     reporter_->HeaderTruncated();
@@ -566,5 +688,43 @@ bool Reader::MapSegmentSections(const Segment& segment,
   return WalkSegmentSections(segment, &mapper);
 }
 
+// A SectionHandler that looks for a section with a given name.
+class Reader::SectionFinder : public SectionHandler {
+ public:
+  // Create a SectionHandler that looks for a section named NAME, and sets
+  // SECTION to describe it if found.
+  SectionFinder(const string& name, Section* section)
+      : name_(name), section_(section), found_() { }
+
+  // Return true if the traversal found the section, false otherwise.
+  bool found() const { return found_; }
+
+  bool HandleSection(const Section& section) {
+    if (section.section_name == name_) {
+      *section_ = section;
+      found_ = true;
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  // The name of the section our creator is looking for.
+  const string& name_;
+
+  // Where we should store the section if found. (WEAK)
+  Section* section_;
+
+  // True if we found the section.
+  bool found_;
+};
+
+bool Reader::FindSection(const Segment& segment, const string& name,
+                         Section* section) const {
+  SectionFinder finder(name, section);
+  WalkSegmentSections(segment, &finder);
+  return finder.found();
+}
+
 }  // namespace mach_o
 }  // namespace google_breakpad
@@ -152,6 +152,79 @@ class FatReader {
   vector<SuperFatArch> object_files_;
 };
 
+// An image in a dyld shared cache.
+struct SharedCacheImage {
+  // The image's install name, such as "/usr/lib/libobjc.A.dylib".
+  string path;
+
+  // The address of the image's Mach-O header, when the cache is loaded at
+  // its preferred address.
+  uint64_t address;
+
+  // The offset of the image's Mach-O header within the cache file.
+  uint64_t file_offset;
+};
+
+// A parser for dyld shared cache files, in which the system's dylibs are
+// prelinked into a single file. Each image in the cache is a Mach-O image
+// whose file offsets are relative to the start of the cache rather than to
+// its own header; Reader::ReadImage can read them in place.
+//
+// Only caches that hold all their images in one file are supported, not
+// those split into subcache files.
+class SharedCacheReader {
+ public:
+  // A class for reporting errors found while parsing dyld shared caches.
+  // The default definitions of these methods print messages to stderr.
+  class Reporter {
+   public:
+    // Create a reporter that attributes problems to |filename|.
+    explicit Reporter(const string& filename) : filename_(filename) { }
+
+    virtual ~Reporter() { }
+
+    // The file ends abruptly: its header, mapping list, image list or an
+    // image's path lies beyond the end of the file.
+    virtual void TooShort();
+
+    // The image named |path| is not in any of the cache's mappings, or
+    // its header lies beyond the end of the file.
+    virtual void MisplacedImage(const string& path);
+
+    // The cache's images are stored in separate subcache files.
+    virtual void SplitCache();
+
+   private:
+    // The filename to which the reader should attribute problems.
+    string filename_;
+  };
+
+  // Return true if the |size| bytes at |buffer| begin with the magic
+  // number of a dyld shared cache.
+  static bool IsSharedCache(const uint8_t* buffer, size_t size);
+
+  // Create a dyld shared cache reader that uses |reporter| to report
+  // problems.
+  explicit SharedCacheReader(Reporter* reporter) : reporter_(reporter) { }
+
+  // Read the |size| bytes at |buffer| as a dyld shared cache. On success,
+  // return true; on failure, report the problem to reporter_ and return
+  // false.
+  bool Read(const uint8_t* buffer, size_t size);
+
+  // Return the images in the cache, in the order the cache lists them.
+  // Assuming Read returned true, each image's header lies within the bytes
+  // passed to Read.
+  const vector<SharedCacheImage>& images() const { return images_; }
+
+ private:
+  // We use this to report problems parsing the file's contents. (WEAK)
+  Reporter* reporter_;
+
+  // The images in the cache.
+  vector<SharedCacheImage> images_;
+};
+
 // A segment in a Mach-O file. All these fields have been byte-swapped as
 // appropriate for use by the executing architecture.
 struct Segment {
@@ -383,6 +456,16 @@ class Reader {
                 expected_cpu_subtype);
   }
 
+  // Read the Mach-O image whose header lies |header_offset| bytes into the
+  // |size| bytes at |buffer|, and whose segment and symbol table offsets
+  // are relative to |buffer| rather than to the header, as for an image
+  // in a dyld shared cache. Otherwise, this behaves like Read.
+  bool ReadImage(const uint8_t* buffer,
+                 size_t size,
+                 size_t header_offset,
+                 cpu_type_t expected_cpu_type,
+                 cpu_subtype_t expected_cpu_subtype);
+
   // Return this file's characteristics, as found in the Mach-O header.
   cpu_type_t    cpu_type()    const { return cpu_type_; }
   cpu_subtype_t cpu_subtype() const { return cpu_subtype_; }
@@ -422,10 +505,18 @@ class Reader {
   bool MapSegmentSections(const Segment& segment, SectionMap* section_map)
     const;
 
+  // Set |section| to describe the section of |segment| named |name|, if
+  // present, without mapping the segment's other sections. Its contents
+  // refer to bytes in |segment|'s contents. If we find the section, return
+  // true; otherwise, return false.
+  bool FindSection(const Segment& segment, const string& name,
+                   Section* section) const;
+
  private:
   // Used internally.
   class SegmentFinder;
   class SectionMapper;
+  class SectionFinder;
 
   // We use this to report problems parsing the file's contents. (WEAK)
   Reporter* reporter_;
@@ -54,6 +54,8 @@ using mach_o::Reader;
 using mach_o::Section;
 using mach_o::SectionMap;
 using mach_o::Segment;
+using mach_o::SharedCacheImage;
+using mach_o::SharedCacheReader;
 using test_assembler::Endianness;
 using test_assembler::Label;
 using test_assembler::kBigEndian;
@@ -85,6 +87,15 @@ class MockFatReaderReporter: public FatReader::Reporter {
   MOCK_METHOD0(TooShort, void());
 };
 
+class MockSharedCacheReaderReporter: public SharedCacheReader::Reporter {
+ public:
+  MockSharedCacheReaderReporter(const string& filename)
+      : SharedCacheReader::Reporter(filename) { }
+  MOCK_METHOD0(TooShort, void());
+  MOCK_METHOD1(MisplacedImage, void(const string& path));
+  MOCK_METHOD0(SplitCache, void());
+};
+
 class MockReaderReporter: public Reader::Reporter {
  public:
   MockReaderReporter(const string& filename) : Reader::Reporter(filename) { }
@@ -1721,6 +1732,12 @@ TEST_F(LoadCommand, MapSegmentSections) {
   ASSERT_TRUE(section_map.find("bergamot") != section_map.end());
   EXPECT_THAT(section_map["bergamot"],
               MatchSection(false, "bergamot", "head", 0x13e6c8a9));
+
+  // Sections can also be found one at a time.
+  Section section;
+  ASSERT_TRUE(reader.FindSection(segment, "bergamot", &section));
+  EXPECT_THAT(section, MatchSection(false, "bergamot", "head", 0x13e6c8a9));
+  EXPECT_FALSE(reader.FindSection(segment, "cara cara", &section));
 }
 
 TEST_F(LoadCommand, FindSegment) {
@@ -1948,3 +1965,156 @@ TEST_F(Symtab, SymtabMisplacedStrings) {
   EXPECT_FALSE(reader.WalkLoadCommands(&load_command_handler));
 }
 
+// dyld shared cache tests.
+
+const uint64_t kCacheBaseAddress = 0x7fff20000000ULL;
+
+struct SharedCacheFixture : public ReaderFixture {
+  SharedCacheFixture()
+      : config(kLittleEndian, 64),
+        cache_reporter("cache filename"),
+        cache_reader(&cache_reporter) {
+    EXPECT_CALL(cache_reporter, TooShort()).Times(0);
+    EXPECT_CALL(cache_reporter, MisplacedImage(_)).Times(0);
+    EXPECT_CALL(cache_reporter, SplitCache()).Times(0);
+    cache.start() = 0;
+  }
+
+  // Append a cache header to 'cache' listing one mapping, of the whole
+  // file at kCacheBaseAddress, and one image, whose header is at
+  // |image_address| and whose install name is "/usr/lib/libfrith.dylib".
+  // Fill the header out to |header_size| bytes, with |subcache_count| as
+  // the number of subcaches.
+  void AppendHeader(Label image_address, size_t header_size = 0x1c8,
+                    uint32_t subcache_count = 0) {
+    Label mappings, images, path;
+    cache
+        .Append("dyld_v1  x86_64h")
+        .D32(mappings)                  // mappingOffset
+        .D32(1)                         // mappingCount
+        .D32(images)                    // imagesOffset
+        .D32(1);                        // imagesCount
+    cache.Append(0x18c - cache.Size(), 0);
+    cache
+        .D32(subcache_count);           // subCacheArrayCount
+    cache.Append(header_size - cache.Size(), 0);
+    cache
+        .Mark(&mappings)
+        .D64(kCacheBaseAddress)         // address
+        .D64(0x100000)                  // size
+        .D64(0)                         // fileOffset
+        .D32(5).D32(5)                  // maxProt, initProt
+        .Mark(&images)
+        .D64(image_address)             // address
+        .D64(0).D64(0)                  // modTime, inode
+        .D32(path)                      // pathFileOffset
+        .D32(0)                         // pad
+        .Mark(&path)
+        .AppendCString("/usr/lib/libfrith.dylib")
+        .Align(8);
+  }
+
+  void ReadCache(bool expect_parse_success = true) {
+    ASSERT_TRUE(cache.GetContents(&cache_contents));
+    cache_bytes = reinterpret_cast<const uint8_t*>(cache_contents.data());
+    EXPECT_TRUE(SharedCacheReader::IsSharedCache(cache_bytes,
+                                                 cache_contents.size()));
+    EXPECT_EQ(expect_parse_success,
+              cache_reader.Read(cache_bytes, cache_contents.size()));
+  }
+
+  WithConfiguration config;
+  SizedSection cache;
+  MockSharedCacheReaderReporter cache_reporter;
+  SharedCacheReader cache_reader;
+  string cache_contents;
+  const uint8_t* cache_bytes;
+};
+
+class SharedCache: public SharedCacheFixture, public Test { };
+
+TEST_F(SharedCache, ReadImageInPlace) {
+  // The image's segment lies after it in the cache, and its load command
+  // gives its offset from the start of the cache.
+  LoadedSection segment;
+  segment.address() = kCacheBaseAddress + 0x8000;
+  segment.Append(42, '*');
+  SegmentLoadCommand segment_command;
+  segment_command.Header("__TEXT", segment, 5, 5, 0);
+  LoadCommands load_commands;
+  load_commands.Place(&segment_command);
+  SizedSection image;
+  image
+      .D32(0xfeedfacf)                          // magic number
+      .D32(CPU_TYPE_X86_64)                     // cpu type
+      .D32(CPU_SUBTYPE_X86_64_ALL)              // cpu subtype
+      .D32(MH_DYLIB)                            // file type
+      .D32(load_commands.final_command_count()) // number of load commands
+      .D32(load_commands.final_size())          // their size in bytes
+      .D32(MH_DYLDLINK)                         // flags
+      .D32(0);                                  // reserved
+  image.Place(&load_commands);
+
+  AppendHeader(image.start() + kCacheBaseAddress);
+  cache.Place(&image).Place(&segment);
+  ReadCache();
+
+  const vector<SharedCacheImage>& images = cache_reader.images();
+  ASSERT_EQ(1U, images.size());
+  EXPECT_EQ("/usr/lib/libfrith.dylib", images[0].path);
+  EXPECT_EQ(kCacheBaseAddress + image.start().Value(), images[0].address);
+  EXPECT_EQ(image.start().Value(), images[0].file_offset);
+
+  EXPECT_TRUE(reader.ReadImage(cache_bytes, cache_contents.size(),
+                               images[0].file_offset, CPU_TYPE_ANY, 0));
+  EXPECT_EQ(CPU_TYPE_X86_64, reader.cpu_type());
+  EXPECT_EQ(static_cast<FileType>(MH_DYLIB), reader.file_type());
+
+  Segment actual_segment;
+  EXPECT_CALL(load_command_handler, SegmentCommand(_))
+      .WillOnce(DoAll(SaveArg<0>(&actual_segment), Return(true)));
+  EXPECT_TRUE(reader.WalkLoadCommands(&load_command_handler));
+  EXPECT_EQ("__TEXT", actual_segment.name);
+  EXPECT_EQ(segment.start().Value(), actual_segment.fileoff);
+  EXPECT_EQ(cache_bytes + segment.start().Value(),
+            actual_segment.contents.start);
+  EXPECT_EQ(42U, actual_segment.contents.Size());
+}
+
+TEST_F(SharedCache, NotACache) {
+  const uint8_t mach_o[] = { 0xcf, 0xfa, 0xed, 0xfe, 7, 0, 0, 1,
+                             3, 0, 0, 0, 6, 0, 0, 0, 0, 0, 0, 0 };
+  EXPECT_FALSE(SharedCacheReader::IsSharedCache(mach_o, sizeof(mach_o)));
+}
+
+TEST_F(SharedCache, TooShort) {
+  EXPECT_CALL(cache_reporter, TooShort()).Times(1);
+  cache
+      .Append("dyld_v1  x86_64h")
+      .D32(0x20)                        // mappingOffset
+      .D32(2)                           // mappingCount, beyond the end
+      .D32(0x20)                        // imagesOffset
+      .D32(0)                           // imagesCount
+      .D64(kCacheBaseAddress).D64(0x1000);
+  ReadCache(false);
+}
+
+TEST_F(SharedCache, MisplacedImage) {
+  EXPECT_CALL(cache_reporter, MisplacedImage("/usr/lib/libfrith.dylib"))
+      .Times(1);
+  AppendHeader(kCacheBaseAddress - 0x1000);
+  ReadCache(false);
+}
+
+TEST_F(SharedCache, ImageBeyondEndOfFile) {
+  EXPECT_CALL(cache_reporter, MisplacedImage("/usr/lib/libfrith.dylib"))
+      .Times(1);
+  AppendHeader(kCacheBaseAddress + 0x80000);
+  ReadCache(false);
+}
+
+TEST_F(SharedCache, SplitCache) {
+  EXPECT_CALL(cache_reporter, SplitCache()).Times(1);
+  AppendHeader(kCacheBaseAddress, 0x200, 3);
+  ReadCache(false);
+}
@@ -68,6 +68,11 @@ class MachoWalker {
   // Read |size| bytes from the opened file at |offset| into |buffer|
   bool ReadBytes(void* buffer, size_t size, off_t offset);
 
+  // If this walker reads from memory and all |size| bytes at |offset| lie
+  // within it, return a pointer to them; otherwise, return NULL.  This lets
+  // callers use the bytes without copying them through ReadBytes.
+  const void* MemoryAt(off_t offset, size_t size) const;
+
   // Return the current header and header offset
   bool CurrentHeader(struct mach_header_64* header, off_t* offset);
 
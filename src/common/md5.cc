@@ -142,8 +142,8 @@ void MD5Final(unsigned char digest[16], struct MD5Context *ctx)
   byteReverse(ctx->in, 14);
 
   /* Append length in bits and transform */
-  memcpy(&ctx->in[14], &ctx->bits[0], sizeof(u32));
-  memcpy(&ctx->in[15], &ctx->bits[1], sizeof(u32));
+  memcpy(&ctx->in[14 * sizeof(u32)], &ctx->bits[0], sizeof(u32));
+  memcpy(&ctx->in[15 * sizeof(u32)], &ctx->bits[1], sizeof(u32));
 
   MD5Transform(ctx->buf, (u32*) ctx->in);
   byteReverse((unsigned char*) ctx->buf, 4);
@@ -31,9 +31,11 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/mman.h>
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -51,8 +53,99 @@
 
 namespace google_breakpad {
 
-// This is very simple allocator which fetches pages from the kernel directly.
-// Thus, it can be used even when the heap may be corrupted.
+// Memory mapped in advance for PageAllocators, which take their pages from
+// it before asking the kernel for more.  Mapping it, and touching every
+// page, before a crash spares the allocations made while handling one a
+// system call each, and keeps them working when the process has run out of
+// memory.  Pages are taken from the top and may only be given back from
+// there, which suits the nested, short-lived allocators of a crash handler;
+// pages given back out of order stay taken.  Safe to use from several
+// threads, and from signal handlers.
+class PageReserve {
+ public:
+  // Maps |bytes| of memory, rounded up to whole pages, as the reserve.
+  // Returns false if there is a reserve already or the mapping fails.
+  static bool Create(size_t bytes) {
+    const size_t page_size = getpagesize();
+    bytes = (bytes + page_size - 1) / page_size * page_size;
+    if (!bytes || base_.load())
+      return false;
+    void* a = sys_mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (a == MAP_FAILED)
+      return false;
+    uint8_t* base = reinterpret_cast<uint8_t*>(a);
+    for (size_t offset = 0; offset < bytes; offset += page_size)
+      base[offset] = 0;
+#if defined(MEMORY_SANITIZER)
+    __msan_unpoison(a, bytes);
+#endif
+    uint8_t* expected = NULL;
+    if (!base_.compare_exchange_strong(expected, base)) {
+      sys_munmap(a, bytes);
+      return false;
+    }
+    size_ = bytes;
+    used_ = 0;
+    return true;
+  }
+
+  // Unmaps the reserve.  Returns false, leaving it mapped, if any of it is
+  // still taken.
+  static bool Destroy() {
+    uint8_t* base = base_.load();
+    size_t expected = 0;
+    if (!base || !used_.compare_exchange_strong(expected, size_))
+      return false;
+    base_ = NULL;
+    sys_munmap(base, size_);
+    size_ = 0;
+    used_ = 0;
+    return true;
+  }
+
+  // Returns |bytes|, a multiple of the page size, from the reserve, or NULL
+  // if it does not have that many left.
+  static uint8_t* Take(size_t bytes) {
+    uint8_t* base = base_.load();
+    if (!base)
+      return NULL;
+    size_t used = used_.load();
+    do {
+      if (size_ - used < bytes)
+        return NULL;
+    } while (!used_.compare_exchange_weak(used, used + bytes));
+    return base + used;
+  }
+
+  // Gives back |bytes| at |p|, taken from the reserve, cleared as freshly
+  // mapped pages are.  Returns false if they are not the most recently
+  // taken, and so stay taken.
+  static bool Give(uint8_t* p, size_t bytes) {
+    memset(p, 0, bytes);
+    size_t offset = p - base_.load();
+    size_t expected = offset + bytes;
+    return used_.compare_exchange_strong(expected, offset);
+  }
+
+  // Returns true if |p| is in the reserve.
+  static bool Owns(const void* p) {
+    const uint8_t* base = base_.load();
+    return base && p >= base && p < base + size_;
+  }
+
+  // The number of bytes left in the reserve.
+  static size_t available() { return base_.load() ? size_ - used_ : 0; }
+
+ private:
+  static inline std::atomic<uint8_t*> base_{NULL};
+  static inline size_t size_ = 0;
+  static inline std::atomic<size_t> used_{0};
+};
+
+// This is very simple allocator which fetches pages from the kernel directly,
+// or from the PageReserve if there is one. Thus, it can be used even when the
+// heap may be corrupted.
 //
 // There is no free operation. The pages are only freed when the object is
 // destroyed.
@@ -115,16 +208,20 @@ class PageAllocator {
 
  private:
   uint8_t* GetNPages(size_t num_pages) {
-    void* a = sys_mmap(NULL, page_size_ * num_pages, PROT_READ | PROT_WRITE,
-                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    if (a == MAP_FAILED)
-      return NULL;
+    void* a = PageReserve::Take(page_size_ * num_pages);
+    if (!a) {
+      a = sys_mmap(NULL, page_size_ * num_pages, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (a == MAP_FAILED)
+        return NULL;
 
 #if defined(MEMORY_SANITIZER)
-    // We need to indicate to MSan that memory allocated through sys_mmap is
-    // initialized, since linux_syscall_support.h doesn't have MSan hooks.
-    __msan_unpoison(a, page_size_ * num_pages);
+      // We need to indicate to MSan that memory allocated through sys_mmap
+      // is initialized, since linux_syscall_support.h doesn't have MSan
+      // hooks.
+      __msan_unpoison(a, page_size_ * num_pages);
 #endif
+    }
 
     struct PageHeader* header = reinterpret_cast<PageHeader*>(a);
     header->next = last_;
@@ -141,7 +238,14 @@ class PageAllocator {
 
     for (PageHeader* cur = last_; cur; cur = next) {
       next = cur->next;
-      sys_munmap(cur, cur->num_pages * page_size_);
+      // Freed newest first, so the reserve gets back what this allocator
+      // took from it unless another allocator has taken more since.
+      if (PageReserve::Owns(cur)) {
+        PageReserve::Give(reinterpret_cast<uint8_t*>(cur),
+                          cur->num_pages * page_size_);
+      } else {
+        sys_munmap(cur, cur->num_pages * page_size_);
+      }
     }
   }
 
@@ -69,6 +69,50 @@ TEST(PageAllocatorTest, LargeObject) {
   }
 }
 
+TEST(PageAllocatorTest, Reserve) {
+  const size_t page_size = getpagesize();
+  ASSERT_TRUE(PageReserve::Create(4 * page_size));
+  EXPECT_FALSE(PageReserve::Create(page_size));
+  EXPECT_EQ(4 * page_size, PageReserve::available());
+
+  uint8_t* outer_page;
+  {
+    PageAllocator outer;
+    outer_page = reinterpret_cast<uint8_t*>(outer.Alloc(16));
+    ASSERT_TRUE(PageReserve::Owns(outer_page));
+    memset(outer_page, 0xff, 16);
+    {
+      PageAllocator inner;
+      // With its header, this takes two pages.
+      void* p = inner.Alloc(page_size);
+      ASSERT_TRUE(PageReserve::Owns(p));
+      EXPECT_EQ(page_size, PageReserve::available());
+      // What does not fit in the reserve is mapped.
+      void* q = inner.Alloc(2 * page_size);
+      ASSERT_TRUE(q != NULL);
+      EXPECT_FALSE(PageReserve::Owns(q));
+      EXPECT_TRUE(inner.OwnsPointer(q));
+    }
+    EXPECT_EQ(3 * page_size, PageReserve::available());
+    EXPECT_FALSE(PageReserve::Destroy());
+  }
+  EXPECT_EQ(4 * page_size, PageReserve::available());
+
+  // Pages given back are cleared for their next allocator.
+  {
+    PageAllocator allocator;
+    uint8_t* p = reinterpret_cast<uint8_t*>(allocator.Alloc(16));
+    ASSERT_EQ(outer_page, p);
+    for (int i = 0; i < 16; ++i)
+      EXPECT_EQ(0, p[i]);
+  }
+
+  EXPECT_TRUE(PageReserve::Destroy());
+  EXPECT_EQ(0U, PageReserve::available());
+  PageAllocator allocator;
+  EXPECT_FALSE(PageReserve::Owns(allocator.Alloc(16)));
+}
+
 namespace {
 typedef testing::Test WastefulVectorTest;
 }
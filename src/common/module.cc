@@ -43,17 +43,307 @@
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <thread>
 #include <utility>
 
 namespace google_breakpad {
 
-using std::dec;
-using std::hex;
 using std::unique_ptr;
 
+// A temporary file holding function lines and inlines and call frame info
+// moved out of memory, as a series of runs.  Each run is written in one go
+// and read back from its start in the order it was written, through a
+// buffer of its own, so that several runs can be merged.  The file lives
+// no longer than its module, so pointers to the module's files and inline
+// origins are written as they are.
+class Module::SpillFile {
+ public:
+  SpillFile() : file_(tmpfile()) {}
+  ~SpillFile() {
+    if (file_)
+      fclose(file_);
+  }
+
+  bool valid() const { return file_ != NULL; }
+
+  // Start a new run at the end of the file, and return its index.  The
+  // data written until the next call belongs to it.
+  int StartRun() {
+    Run run;
+    run.begin = run.end = 0;
+    if (fseeko(file_, 0, SEEK_END) == 0)
+      run.begin = run.end = ftello(file_);
+    runs_.push_back(run);
+    Rewind(runs_.size() - 1);
+    return runs_.size() - 1;
+  }
+
+  bool Write(const void* data, size_t size) {
+    if (size && fwrite(data, size, 1, file_) != 1)
+      return false;
+    runs_.back().end += size;
+    return true;
+  }
+
+  template<typename T>
+  bool WriteValue(const T& value) { return Write(&value, sizeof(value)); }
+
+  bool WriteString(const string& str) {
+    return WriteValue<uint64_t>(str.size()) && Write(str.data(), str.size());
+  }
+
+  // Go back to the start of RUN.
+  void Rewind(int run) {
+    runs_[run].position = runs_[run].begin;
+    runs_[run].buffer.clear();
+    runs_[run].buffer_position = 0;
+  }
+
+  // Go back to the start of every run.
+  void RewindAll() {
+    for (size_t i = 0; i < runs_.size(); ++i)
+      Rewind(i);
+  }
+
+  // Read SIZE bytes from the current position of RUN into DATA.
+  bool Read(int run, void* data, size_t size) {
+    Run* r = &runs_[run];
+    char* out = static_cast<char*>(data);
+    while (size) {
+      if (r->buffer_position == r->buffer.size()) {
+        uint64_t length = r->end - r->position;
+        if (length > kBufferSize)
+          length = kBufferSize;
+        if (!length || fseeko(file_, r->position, SEEK_SET) != 0)
+          return false;
+        r->buffer.resize(length);
+        if (fread(&r->buffer[0], length, 1, file_) != 1)
+          return false;
+        r->position += length;
+        r->buffer_position = 0;
+      }
+      size_t count = std::min(size, r->buffer.size() - r->buffer_position);
+      memcpy(out, &r->buffer[r->buffer_position], count);
+      r->buffer_position += count;
+      out += count;
+      size -= count;
+    }
+    return true;
+  }
+
+  template<typename T>
+  bool ReadValue(int run, T* value) { return Read(run, value, sizeof(*value)); }
+
+  bool ReadString(int run, string* str) {
+    uint64_t size;
+    if (!ReadValue(run, &size))
+      return false;
+    str->resize(size);
+    return !size || Read(run, &(*str)[0], size);
+  }
+
+ private:
+  static const size_t kBufferSize = 64 * 1024;
+
+  struct Run {
+    // The run's extent in the file, and where its buffer will next be
+    // filled from.
+    uint64_t begin, end, position;
+    vector<char> buffer;
+    size_t buffer_position;
+  };
+
+  FILE* file_;
+  vector<Run> runs_;
+};
+
+// Symbol file records formatted into one large buffer, which is handed
+// to the stream in big writes; formatting numbers through an ostream's
+// manipulators costs much more than the records' I/O.  A writer with no
+// stream just collects its records, to be appended to another.
+class Module::RecordWriter {
+ public:
+  explicit RecordWriter(std::ostream* stream) : stream_(stream) {
+    if (stream_)
+      buffer_.reserve(kFlushSize + kFlushSize / 4);
+  }
+
+  void Append(StringView str) { buffer_.append(str.data(), str.size()); }
+  void Append(char c) { buffer_.push_back(c); }
+
+  // Append VALUE in lowercase hexadecimal, without leading zeros.
+  void AppendHex(uint64_t value) {
+    char digits[16];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    do {
+      p -= 2;
+      memcpy(p, &tables_.hex_pairs[(value & 0xff) * 2], 2);
+      value >>= 8;
+    } while (value);
+    if (*p == '0' && p + 1 < end)
+      ++p;
+    buffer_.append(p, end - p);
+  }
+
+  // Append VALUE in decimal.
+  void AppendDecimal(int64_t value) {
+    char digits[20];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : value;
+    while (magnitude >= 100) {
+      p -= 2;
+      memcpy(p, &tables_.decimal_pairs[(magnitude % 100) * 2], 2);
+      magnitude /= 100;
+    }
+    if (magnitude >= 10) {
+      p -= 2;
+      memcpy(p, &tables_.decimal_pairs[magnitude * 2], 2);
+    } else {
+      *--p = static_cast<char>('0' + magnitude);
+    }
+    if (value < 0)
+      buffer_.push_back('-');
+    buffer_.append(p, end - p);
+  }
+
+  // Hand the buffer to the stream once it is full.  Return false if the
+  // stream has failed.
+  bool FlushIfFull() {
+    return buffer_.size() < kFlushSize || Flush();
+  }
+
+  bool Flush() {
+    if (!buffer_.empty()) {
+      stream_->write(buffer_.data(), buffer_.size());
+      buffer_.clear();
+    }
+    return stream_->good();
+  }
+
+  const string& buffer() const { return buffer_; }
+
+ private:
+  static const size_t kFlushSize = 1 << 20;
+
+  // The digits of every byte value in hexadecimal, and of every number
+  // below 100 in decimal, two characters apiece.
+  struct DigitTables {
+    DigitTables() {
+      static const char kHexDigits[] = "0123456789abcdef";
+      for (int i = 0; i < 256; ++i) {
+        hex_pairs[i * 2] = kHexDigits[i >> 4];
+        hex_pairs[i * 2 + 1] = kHexDigits[i & 0xf];
+      }
+      for (int i = 0; i < 100; ++i) {
+        decimal_pairs[i * 2] = static_cast<char>('0' + i / 10);
+        decimal_pairs[i * 2 + 1] = static_cast<char>('0' + i % 10);
+      }
+    }
+    char hex_pairs[512];
+    char decimal_pairs[200];
+  };
+  static const DigitTables tables_;
+
+  std::ostream* stream_;
+  string buffer_;
+};
+
+const Module::RecordWriter::DigitTables Module::RecordWriter::tables_;
+
+namespace {
+
+// Append VALUE to BYTES in seven-bit groups, least significant first, with
+// the high bit of each byte set if more follow.
+void AppendVarint(vector<uint8_t>* bytes, uint64_t value) {
+  while (value >= 0x80) {
+    bytes->push_back(static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  bytes->push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t ReadVarint(const uint8_t** cursor) {
+  uint64_t value = 0;
+  int shift = 0;
+  uint8_t byte;
+  do {
+    byte = *(*cursor)++;
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return value;
+}
+
+// Map small signed differences to small unsigned ones, and back.
+uint64_t ZigZag(uint64_t difference) {
+  return (difference << 1) ^ (0 - (difference >> 63));
+}
+
+uint64_t UnZigZag(uint64_t value) {
+  return (value >> 1) ^ (0 - (value & 1));
+}
+
+size_t RuleMapSize(const Module::RuleMap& rules) {
+  // Roughly the overhead of a map node holding two strings.
+  const size_t kNodeSize = 32 + 2 * sizeof(string);
+  size_t size = 0;
+  for (const auto& rule : rules)
+    size += kNodeSize + rule.first.size() + rule.second.size();
+  return size;
+}
+
+}  // namespace
+
+int Module::InlineList::Add(InlineOrigin* origin, int parent,
+                            const vector<Range>& ranges, int call_site_line,
+                            int call_site_file_id, int inline_nest_level) {
+  Inline in;
+  in.origin = origin;
+  in.parent = parent;
+  in.call_site_line = call_site_line;
+  in.call_site_file_id = call_site_file_id;
+  in.call_site_file = nullptr;
+  in.inline_nest_level = inline_nest_level;
+  in.first_range = static_cast<uint32_t>(ranges_.size());
+  in.range_count = static_cast<uint32_t>(ranges.size());
+  inlines_.push_back(in);
+  ranges_.insert(ranges_.end(), ranges.begin(), ranges.end());
+  return static_cast<int>(inlines_.size() - 1);
+}
+
+void Module::InlineList::Append(const InlineList& other, int parent) {
+  int first = static_cast<int>(inlines_.size());
+  uint32_t first_range = static_cast<uint32_t>(ranges_.size());
+  inlines_.insert(inlines_.end(), other.inlines_.begin(),
+                  other.inlines_.end());
+  ranges_.insert(ranges_.end(), other.ranges_.begin(), other.ranges_.end());
+  for (size_t i = first; i < inlines_.size(); ++i) {
+    Inline& in = inlines_[i];
+    in.parent = in.parent < 0 ? parent : in.parent + first;
+    in.first_range += first_range;
+  }
+}
+
+Module::InlineOrigin* Module::InlineOriginMap::Intern(StringView name) {
+  bool named = name != "<name omitted>";
+  if (named) {
+    auto found = origins_by_name_.find(name);
+    if (found != origins_by_name_.end())
+      return found->second;
+  }
+  origins_.emplace_back(new InlineOrigin(name));
+  InlineOrigin* origin = origins_.back().get();
+  if (named)
+    origins_by_name_[name] = origin;
+  return origin;
+}
+
 Module::InlineOrigin* Module::InlineOriginMap::GetOrCreateInlineOrigin(
     uint64_t offset,
     StringView name) {
@@ -65,14 +355,16 @@ Module::InlineOrigin* Module::InlineOriginMap::GetOrCreateInlineOrigin(
     specification_offset = references_[specification_offset];
     iter = references_.find(specification_offset);
   }
-  if (inline_origins_.find(specification_offset) != inline_origins_.end()) {
-    if (inline_origins_[specification_offset]->name == "<name omitted>") {
-      inline_origins_[specification_offset]->name = name;
-    }
-    return inline_origins_[specification_offset];
+  InlineOrigin*& origin = inline_origins_[specification_offset];
+  if (!origin) {
+    origin = Intern(name);
+  } else if (origin->name == "<name omitted>" && name != "<name omitted>") {
+    // Only this offset refers to an origin whose name was omitted, so it
+    // can be named in place, and shared from now on.
+    origin->name = name;
+    origins_by_name_.insert(std::make_pair(name, origin));
   }
-  inline_origins_[specification_offset] = new Module::InlineOrigin(name);
-  return inline_origins_[specification_offset];
+  return origin;
 }
 
 void Module::InlineOriginMap::SetReference(uint64_t offset,
@@ -114,6 +406,13 @@ Module::Module(const string& name,
       id_(id),
       code_id_(code_id),
       load_address_(0),
+      externs_sorted_(0),
+      extern_replaced_count_(0),
+      memory_budget_(0),
+      resident_bytes_(0),
+      compact_lines_(false),
+      write_thread_count_(1),
+      spill_failed_(false),
       enable_multiple_field_(enable_multiple_field),
       prefer_extern_name_(prefer_extern_name) {}
 
@@ -134,6 +433,166 @@ void Module::SetAddressRanges(const vector<Range>& ranges) {
   address_ranges_ = ranges;
 }
 
+void Module::SetMemoryBudget(size_t budget) {
+  memory_budget_ = budget;
+}
+
+void Module::AddSpillableData(size_t size) {
+  if (!memory_budget_)
+    return;
+  resident_bytes_ += size;
+  if (resident_bytes_ > memory_budget_)
+    Spill();
+}
+
+void Module::Spill() {
+  resident_bytes_ = 0;
+  if (!spill_)
+    spill_.reset(new SpillFile());
+  if (!spill_->valid()) {
+    fprintf(stderr, "cannot create a file to spill symbol data to: %s\n",
+            strerror(errno));
+    memory_budget_ = 0;
+    return;
+  }
+
+  bool written = true;
+  int run = spill_->StartRun();
+  for (Function* func : functions_) {
+    if (!written)
+      break;
+    if (func->spill_run >= 0 ||
+        (func->lines.empty() && func->packed_lines.empty() &&
+         func->inlines.empty())) {
+      continue;
+    }
+    // Runs hold lines packed, whether or not they were in memory.
+    if (!func->lines.empty())
+      PackLines(func->lines, &func->packed_lines);
+    written = spill_->WriteValue<uint64_t>(func->packed_lines.size()) &&
+              spill_->Write(func->packed_lines.data(),
+                            func->packed_lines.size()) &&
+              SpillInlines(func->inlines);
+    func->spill_run = run;
+    vector<Line>().swap(func->lines);
+    vector<uint8_t>().swap(func->packed_lines);
+    InlineList().swap(func->inlines);
+  }
+
+  if (written && !stack_frame_entries_.empty()) {
+    run = spill_->StartRun();
+    for (const unique_ptr<StackFrameEntry>& entry : stack_frame_entries_) {
+      written = written &&
+                spill_->WriteValue(entry->address) &&
+                spill_->WriteValue(entry->size) &&
+                spill_->WriteValue<uint64_t>(entry->initial_rules.size());
+      for (const auto& rule : entry->initial_rules) {
+        written = written && spill_->WriteString(rule.first) &&
+                  spill_->WriteString(rule.second);
+      }
+      written = written &&
+                spill_->WriteValue<uint64_t>(entry->rule_changes.size());
+      for (const auto& change : entry->rule_changes) {
+        written = written && spill_->WriteValue(change.first) &&
+                  spill_->WriteValue<uint64_t>(change.second.size());
+        for (const auto& rule : change.second) {
+          written = written && spill_->WriteString(rule.first) &&
+                    spill_->WriteString(rule.second);
+        }
+      }
+    }
+    spilled_stack_frame_runs_.push_back(
+        std::make_pair(run, stack_frame_entries_.size()));
+    stack_frame_entries_.clear();
+  }
+
+  if (!written) {
+    fprintf(stderr, "error spilling symbol data: %s\n", strerror(errno));
+    spill_failed_ = true;
+    memory_budget_ = 0;
+  }
+}
+
+bool Module::SpillInlines(const InlineList& inlines) {
+  if (!spill_->WriteValue<uint64_t>(inlines.size()))
+    return false;
+  for (const Inline& in : inlines) {
+    spilled_inline_origins_.insert(in.origin);
+    if (in.call_site_file)
+      spilled_files_.insert(in.call_site_file);
+    if (!spill_->WriteValue(in.origin) ||
+        !spill_->WriteValue(in.parent) ||
+        !spill_->WriteValue(in.call_site_line) ||
+        !spill_->WriteValue(in.call_site_file_id) ||
+        !spill_->WriteValue(in.call_site_file) ||
+        !spill_->WriteValue(in.inline_nest_level) ||
+        !spill_->WriteValue(in.range_count) ||
+        !spill_->Write(inlines.ranges(in), in.range_count * sizeof(Range))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Module::ReadSpilledInlines(int run, InlineList* inlines) {
+  uint64_t count;
+  if (!spill_->ReadValue(run, &count))
+    return false;
+  vector<Range> ranges;
+  for (uint64_t i = 0; i < count; ++i) {
+    InlineOrigin* origin;
+    int parent, call_site_line, call_site_file_id, inline_nest_level;
+    File* call_site_file;
+    uint32_t range_count;
+    if (!spill_->ReadValue(run, &origin) ||
+        !spill_->ReadValue(run, &parent) ||
+        !spill_->ReadValue(run, &call_site_line) ||
+        !spill_->ReadValue(run, &call_site_file_id) ||
+        !spill_->ReadValue(run, &call_site_file) ||
+        !spill_->ReadValue(run, &inline_nest_level) ||
+        !spill_->ReadValue(run, &range_count)) {
+      return false;
+    }
+    ranges.assign(range_count, Range(0, 0));
+    if (!spill_->Read(run, ranges.data(), range_count * sizeof(Range)))
+      return false;
+    int index = inlines->Add(origin, parent, ranges, call_site_line,
+                             call_site_file_id, inline_nest_level);
+    (*inlines)[index].call_site_file = call_site_file;
+  }
+  return true;
+}
+
+bool Module::ReadSpilledStackFrameEntry(int run, StackFrameEntry* entry) {
+  auto read_rules = [&](RuleMap* rules) {
+    uint64_t count;
+    if (!spill_->ReadValue(run, &count))
+      return false;
+    for (uint64_t i = 0; i < count; ++i) {
+      string name, rule;
+      if (!spill_->ReadString(run, &name) || !spill_->ReadString(run, &rule))
+        return false;
+      (*rules)[name] = rule;
+    }
+    return true;
+  };
+  uint64_t change_count;
+  if (!spill_->ReadValue(run, &entry->address) ||
+      !spill_->ReadValue(run, &entry->size) ||
+      !read_rules(&entry->initial_rules) ||
+      !spill_->ReadValue(run, &change_count)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < change_count; ++i) {
+    Address address;
+    if (!spill_->ReadValue(run, &address) ||
+        !read_rules(&entry->rule_changes[address])) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool Module::AddFunction(Function* function) {
   // FUNC lines must not hold an empty name, so catch the problem early if
   // callers try to add one.
@@ -145,17 +604,16 @@ bool Module::AddFunction(Function* function) {
 
   // FUNCs are better than PUBLICs as they come with sizes, so remove an extern
   // with the same address if present.
-  Extern ext(function->address);
-  ExternSet::iterator it_ext = externs_.find(&ext);
-  if (it_ext == externs_.end() &&
+  SortExterns(true);
+  size_t ext_index = FindExtern(function->address);
+  if (ext_index == externs_sorted_ &&
       architecture_ == "arm" &&
       (function->address & 0x1) == 0) {
     // ARM THUMB functions have bit 0 set. ARM64 does not have THUMB.
-    Extern arm_thumb_ext(function->address | 0x1);
-    it_ext = externs_.find(&arm_thumb_ext);
+    ext_index = FindExtern(function->address | 0x1);
   }
-  if (it_ext != externs_.end()) {
-    Extern* found_ext = it_ext->get();
+  if (ext_index != externs_sorted_) {
+    Extern* found_ext = externs_[ext_index].get();
     bool name_mismatch = found_ext->name != function->name;
     if (enable_multiple_field_) {
       bool is_multiple_based_on_name;
@@ -176,17 +634,24 @@ bool Module::AddFunction(Function* function) {
           is_multiple_based_on_name || found_ext->is_multiple;
     }
     if (name_mismatch && prefer_extern_name_) {
-      function->name = AddStringToPool(it_ext->get()->name);
+      function->name = AddStringToPool(found_ext->name);
     }
-    externs_.erase(it_ext);
+    extern_replaced_[ext_index] = true;
+    ++extern_replaced_count_;
   }
 #if _DEBUG
   {
     // There should be no other PUBLIC symbols that overlap with the function.
     for (const Range& range : function->ranges) {
       Extern debug_ext(range.address);
-      ExternSet::iterator it_debug = externs_.lower_bound(&ext);
-      assert(it_debug == externs_.end() ||
+      ExternList::const_iterator it_debug = std::lower_bound(
+          externs_.begin(), externs_.begin() + externs_sorted_, &debug_ext,
+          ExternCompare());
+      while (it_debug != externs_.begin() + externs_sorted_ &&
+             extern_replaced_[it_debug - externs_.begin()]) {
+        ++it_debug;
+      }
+      assert(it_debug == externs_.begin() + externs_sorted_ ||
              (*it_debug)->address >= range.address + range.size);
     }
   }
@@ -208,15 +673,133 @@ bool Module::AddFunction(Function* function) {
     // now owns it.
     return false;
   }
+  if (compact_lines_ && !function->lines.empty()) {
+    PackLines(function->lines, &function->packed_lines);
+    vector<Line>().swap(function->lines);
+  }
+  AddSpillableData(function->lines.size() * sizeof(Line) +
+                   function->packed_lines.size() +
+                   function->inlines.MemorySize());
   return true;
 }
 
+void Module::PackLines(const vector<Line>& lines, vector<uint8_t>* packed) {
+  packed->clear();
+  packed->reserve(lines.size() * 6);
+  AppendVarint(packed, lines.size());
+  // Most lines are short and begin where the previous one ended, and
+  // neighbouring lines are usually from the same file and close together
+  // in it, so each column's differences are mostly single bytes.
+  for (const Line& line : lines)
+    AppendVarint(packed, line.size);
+  Address end = 0;
+  for (const Line& line : lines) {
+    AppendVarint(packed, ZigZag(line.address - end));
+    end = line.address + line.size;
+  }
+  uint64_t number = 0;
+  for (const Line& line : lines) {
+    AppendVarint(packed, ZigZag(static_cast<uint64_t>(line.number) - number));
+    number = static_cast<uint64_t>(line.number);
+  }
+  uint32_t file_index = 0;
+  for (const Line& line : lines) {
+    auto inserted = packed_file_indices_.insert(
+        std::make_pair(line.file, static_cast<uint32_t>(packed_files_.size())));
+    if (inserted.second)
+      packed_files_.push_back(line.file);
+    AppendVarint(packed, ZigZag(static_cast<uint64_t>(inserted.first->second) -
+                                file_index));
+    file_index = inserted.first->second;
+  }
+  packed->shrink_to_fit();
+}
+
+void Module::UnpackLines(const vector<uint8_t>& packed,
+                         vector<Line>* lines) const {
+  const uint8_t* cursor = packed.data();
+  lines->resize(ReadVarint(&cursor));
+  for (Line& line : *lines)
+    line.size = ReadVarint(&cursor);
+  Address end = 0;
+  for (Line& line : *lines) {
+    line.address = end + UnZigZag(ReadVarint(&cursor));
+    end = line.address + line.size;
+  }
+  uint64_t number = 0;
+  for (Line& line : *lines) {
+    number += UnZigZag(ReadVarint(&cursor));
+    line.number = static_cast<int>(number);
+  }
+  uint64_t file_index = 0;
+  for (Line& line : *lines) {
+    file_index = static_cast<uint32_t>(file_index +
+                                       UnZigZag(ReadVarint(&cursor)));
+    line.file = packed_files_[file_index];
+  }
+  assert(cursor == packed.data() + packed.size());
+}
+
+void Module::AddUnitFunctions(Module* unit,
+                              const vector<Function*>& functions) {
+  // UNIT's origins are interned among this module's, and the inlines
+  // pointed at the results.
+  map<InlineOrigin*, InlineOrigin*> origins_in_module;
+  for (auto& unit_origins : unit->inline_origin_maps) {
+    InlineOriginMap& origins = inline_origin_maps[unit_origins.first];
+    for (const auto& origin : unit_origins.second.inline_origins_) {
+      InlineOrigin*& interned = origins_in_module[origin.second];
+      if (!interned)
+        interned = origins.Intern(AddStringToPool(origin.second->name.str()));
+      bool inserted =
+          origins.inline_origins_.insert(std::make_pair(origin.first,
+                                                        interned)).second;
+      assert(inserted);
+      (void)inserted;
+    }
+    origins.references_.insert(unit_origins.second.references_.begin(),
+                               unit_origins.second.references_.end());
+  }
+
+  map<File*, File*> files;
+  auto file_in_module = [&](File* unit_file) -> File* {
+    if (!unit_file)
+      return NULL;
+    File*& file = files[unit_file];
+    if (!file)
+      file = FindFile(unit_file->name);
+    return file;
+  };
+  for (Function* function : functions) {
+    function->name = AddStringToPool(function->name.str());
+    for (Line& line : function->lines)
+      line.file = file_in_module(line.file);
+    for (Inline& in : function->inlines) {
+      in.call_site_file = file_in_module(in.call_site_file);
+      in.origin = origins_in_module[in.origin];
+    }
+    if (!AddFunction(function))
+      delete function;
+  }
+}
+
 void Module::AddStackFrameEntry(std::unique_ptr<StackFrameEntry> stack_frame_entry) {
   if (!AddressIsInModule(stack_frame_entry->address)) {
     return;
   }
 
+  size_t size = sizeof(StackFrameEntry) +
+                RuleMapSize(stack_frame_entry->initial_rules);
+  for (const auto& change : stack_frame_entry->rule_changes)
+    size += RuleMapSize(change.second);
   stack_frame_entries_.push_back(std::move(stack_frame_entry));
+  AddSpillableData(size);
+}
+
+void Module::AddUnitStackFrameEntries(Module* unit) {
+  for (std::unique_ptr<StackFrameEntry>& entry : unit->stack_frame_entries_)
+    AddStackFrameEntry(std::move(entry));
+  unit->stack_frame_entries_.clear();
 }
 
 void Module::AddExtern(std::unique_ptr<Extern> ext) {
@@ -224,10 +807,66 @@ void Module::AddExtern(std::unique_ptr<Extern> ext) {
     return;
   }
 
-  std::pair<ExternSet::iterator,bool> ret = externs_.emplace(std::move(ext));
-  if (!ret.second && enable_multiple_field_) {
-    (*ret.first)->is_multiple = true;
+  externs_.push_back(std::move(ext));
+}
+
+void Module::AddUnitExterns(Module* unit) {
+  // Adding a function sorts the externs, after which they are no longer in
+  // the order they were added.
+  assert(unit->externs_sorted_ == 0);
+  for (std::unique_ptr<Extern>& ext : unit->externs_)
+    AddExtern(std::move(ext));
+  unit->externs_.clear();
+}
+
+void Module::SortExterns(bool merged_only) {
+  if (externs_sorted_ == externs_.size() &&
+      (merged_only || extern_replaced_count_ == 0)) {
+    return;
+  }
+
+  // Drop the replaced externs, then merge in the new ones.  Both sorts
+  // are stable, so the first extern added at an address comes first.
+  ExternList::iterator sorted_end = externs_.begin();
+  for (size_t i = 0; i < externs_sorted_; ++i) {
+    if (!extern_replaced_[i])
+      *sorted_end++ = std::move(externs_[i]);
+  }
+  sorted_end = externs_.erase(sorted_end, externs_.begin() + externs_sorted_);
+  std::stable_sort(sorted_end, externs_.end(), ExternCompare());
+  std::inplace_merge(externs_.begin(), sorted_end, externs_.end(),
+                     ExternCompare());
+
+  // Keep the first extern at each address.
+  ExternList::iterator kept = externs_.begin();
+  for (ExternList::iterator it = externs_.begin(); it != externs_.end();
+       ++it) {
+    if (kept != externs_.begin() && (*(kept - 1))->address == (*it)->address) {
+      if (enable_multiple_field_)
+        (*(kept - 1))->is_multiple = true;
+      continue;
+    }
+    if (kept != it)
+      *kept = std::move(*it);
+    ++kept;
+  }
+  externs_.erase(kept, externs_.end());
+
+  externs_sorted_ = externs_.size();
+  extern_replaced_.assign(externs_sorted_, false);
+  extern_replaced_count_ = 0;
+}
+
+size_t Module::FindExtern(Address address) const {
+  Extern key(address);
+  ExternList::const_iterator end = externs_.begin() + externs_sorted_;
+  ExternList::const_iterator it =
+      std::lower_bound(externs_.begin(), end, &key, ExternCompare());
+  if (it == end || (*it)->address != address ||
+      extern_replaced_[it - externs_.begin()]) {
+    return externs_sorted_;
   }
+  return it - externs_.begin();
 }
 
 void Module::GetFunctions(vector<Function*>* vec,
@@ -237,6 +876,7 @@ void Module::GetFunctions(vector<Function*>* vec,
 
 void Module::GetExterns(vector<Extern*>* vec,
                         vector<Extern*>::iterator i) {
+  SortExterns(false);
   auto pos = vec->insert(i, externs_.size(), nullptr);
   for (const std::unique_ptr<Extern>& ext : externs_) {
     *pos = ext.get();
@@ -309,16 +949,18 @@ void Module::AssignSourceIds() {
 
   // Also mark all files cited by inline callsite by setting each one's source
   // id to zero.
-  auto markInlineFiles = [](unique_ptr<Inline>& in) {
-    // There are some artificial inline functions which don't belong to
-    // any file. Those will have file id -1.
-    if (in->call_site_file) {
-      in->call_site_file->source_id = 0;
-    }
-  };
   for (auto func : functions_) {
-    Inline::InlineDFS(func->inlines, markInlineFiles);
+    for (const Inline& in : func->inlines) {
+      // There are some artificial inline functions which don't belong to
+      // any file. Those will have file id -1.
+      if (in.call_site_file)
+        in.call_site_file->source_id = 0;
+    }
   }
+  for (File* file : spilled_files_)
+    file->source_id = 0;
+  for (File* file : packed_files_)
+    file->source_id = 0;
 
   // Finally, assign source ids to those files that have been marked.
   // We could have just assigned source id numbers while traversing
@@ -335,16 +977,14 @@ void Module::AssignSourceIds() {
 void Module::CreateInlineOrigins(
     set<InlineOrigin*, InlineOriginCompare>& inline_origins) {
   // Only add origins that have file and deduplicate origins with same name and
-  // file id by doing a DFS.
-  auto addInlineOrigins = [&](unique_ptr<Inline>& in) {
-    auto it = inline_origins.find(in->origin);
-    if (it == inline_origins.end())
-      inline_origins.insert(in->origin);
-    else
-      in->origin = *it;
-  };
-  for (Function* func : functions_)
-    Module::Inline::InlineDFS(func->inlines, addInlineOrigins);
+  // file id.  Each file's origins were interned by name as they were
+  // created, so this only merges those of different files.
+  for (Function* func : functions_) {
+    for (Inline& in : func->inlines)
+      in.origin = *inline_origins.insert(in.origin).first;
+  }
+  inline_origins.insert(spilled_inline_origins_.begin(),
+                        spilled_inline_origins_.end());
   int next_id = 0;
   for (InlineOrigin* origin : inline_origins) {
     origin->id = next_id++;
@@ -357,14 +997,70 @@ bool Module::ReportError() {
   return false;
 }
 
-bool Module::WriteRuleMap(const RuleMap& rule_map, std::ostream& stream) {
+void Module::WriteRuleMap(const RuleMap& rule_map, RecordWriter* out) {
   for (RuleMap::const_iterator it = rule_map.begin();
        it != rule_map.end(); ++it) {
     if (it != rule_map.begin())
-      stream << ' ';
-    stream << it->first << ": " << it->second;
+      out->Append(' ');
+    out->Append(it->first);
+    out->Append(": ");
+    out->Append(it->second);
+  }
+}
+
+void Module::WriteFunction(Function* func, Address load_offset,
+                           RecordWriter* out) const {
+  if (!func->packed_lines.empty())
+    UnpackLines(func->packed_lines, &func->lines);
+  vector<Line>::iterator line_it = func->lines.begin();
+  for (auto range_it = func->ranges.cbegin();
+       range_it != func->ranges.cend(); ++range_it) {
+    out->Append(func->is_multiple ? "FUNC m " : "FUNC ");
+    out->AppendHex(range_it->address - load_offset);
+    out->Append(' ');
+    out->AppendHex(range_it->size);
+    out->Append(' ');
+    out->AppendHex(func->parameter_size);
+    out->Append(' ');
+    out->Append(func->name);
+    out->Append('\n');
+
+    // Write out inlines.
+    for (const Inline& in : func->inlines) {
+      out->Append("INLINE ");
+      out->AppendDecimal(in.inline_nest_level);
+      out->Append(' ');
+      out->AppendDecimal(in.call_site_line);
+      out->Append(' ');
+      out->AppendDecimal(in.getCallSiteFileID());
+      out->Append(' ');
+      out->AppendDecimal(in.origin->id);
+      const Range* ranges = func->inlines.ranges(in);
+      for (uint32_t i = 0; i < in.range_count; ++i) {
+        out->Append(' ');
+        out->AppendHex(ranges[i].address - load_offset);
+        out->Append(' ');
+        out->AppendHex(ranges[i].size);
+      }
+      out->Append('\n');
+    }
+
+    while ((line_it != func->lines.end()) &&
+           (line_it->address >= range_it->address) &&
+           (line_it->address < (range_it->address + range_it->size))) {
+      out->AppendHex(line_it->address - load_offset);
+      out->Append(' ');
+      out->AppendHex(line_it->size);
+      out->Append(' ');
+      out->AppendDecimal(line_it->number);
+      out->Append(' ');
+      out->AppendDecimal(line_it->file->source_id);
+      out->Append('\n');
+      ++line_it;
+    }
   }
-  return stream.good();
+  if (!func->packed_lines.empty())
+    vector<Line>().swap(func->lines);
 }
 
 bool Module::AddressIsInModule(Address address) const {
@@ -381,14 +1077,29 @@ bool Module::AddressIsInModule(Address address) const {
 }
 
 bool Module::Write(std::ostream& stream, SymbolData symbol_data, bool preserve_load_address) {
-  stream << "MODULE " << os_ << " " << architecture_ << " "
-         << id_ << " " << name_ << "\n";
-  if (!stream.good())
-    return ReportError();
+  if (spill_failed_)
+    return false;
+  if (spill_)
+    spill_->RewindAll();
+
+  RecordWriter out(&stream);
+  out.Append("MODULE ");
+  out.Append(os_);
+  out.Append(' ');
+  out.Append(architecture_);
+  out.Append(' ');
+  out.Append(id_);
+  out.Append(' ');
+  out.Append(name_);
+  out.Append('\n');
 
   if (!code_id_.empty()) {
-    stream << "INFO CODE_ID " << code_id_ << "\n";
+    out.Append("INFO CODE_ID ");
+    out.Append(code_id_);
+    out.Append('\n');
   }
+  if (!out.Flush())
+    return ReportError();
 
   // load_address is subtracted from each line. If we use zero instead, we
   // preserve the original addresses present in the ELF binary.
@@ -408,102 +1119,150 @@ bool Module::Write(std::ostream& stream, SymbolData symbol_data, bool preserve_l
          file_it != files_.end(); ++file_it) {
       File* file = file_it->second;
       if (file->source_id >= 0) {
-        stream << "FILE " << file->source_id << " " <<  file->name << "\n";
-        if (!stream.good())
+        out.Append("FILE ");
+        out.AppendDecimal(file->source_id);
+        out.Append(' ');
+        out.Append(file->name);
+        out.Append('\n');
+        if (!out.FlushIfFull())
           return ReportError();
       }
     }
 
     // Write out inline origins.
     for (InlineOrigin* origin : inline_origins) {
-      stream << "INLINE_ORIGIN " << origin->id << " " << origin->name << "\n";
-      if (!stream.good())
+      out.Append("INLINE_ORIGIN ");
+      out.AppendDecimal(origin->id);
+      out.Append(' ');
+      out.Append(origin->name);
+      out.Append('\n');
+      if (!out.FlushIfFull())
         return ReportError();
     }
     // Write out functions and their inlines and lines.
-    for (FunctionSet::const_iterator func_it = functions_.begin();
-         func_it != functions_.end(); ++func_it) {
-      Function* func = *func_it;
-      vector<Line>::iterator line_it = func->lines.begin();
-      for (auto range_it = func->ranges.cbegin();
-           range_it != func->ranges.cend(); ++range_it) {
-        stream << "FUNC " << (func->is_multiple ? "m " : "") << hex
-               << (range_it->address - load_offset) << " " << range_it->size
-               << " " << func->parameter_size << " " << func->name << dec
-               << "\n";
-
-        if (!stream.good())
-          return ReportError();
-
-        // Write out inlines.
-        auto write_inline = [&](unique_ptr<Inline>& in) {
-          stream << "INLINE ";
-          stream << in->inline_nest_level << " " << in->call_site_line << " "
-                 << in->getCallSiteFileID() << " " << in->origin->id << hex;
-          for (const Range& r : in->ranges)
-            stream << " " << (r.address - load_offset) << " " << r.size;
-          stream << dec << "\n";
+    if (write_thread_count_ > 1 && !spill_ && functions_.size() > 1) {
+      // Format batches of consecutive functions on several threads, and
+      // write each batch's chunks out in order before starting the next,
+      // so that only one batch's text is held at a time.
+      const size_t kChunkFunctions = 256;
+      const size_t chunks_per_batch = write_thread_count_ * 4;
+      vector<Function*> functions(functions_.begin(), functions_.end());
+      for (size_t batch = 0; batch < functions.size();
+           batch += kChunkFunctions * chunks_per_batch) {
+        size_t batch_end = std::min(functions.size(),
+                                    batch + kChunkFunctions * chunks_per_batch);
+        size_t chunk_count =
+            (batch_end - batch + kChunkFunctions - 1) / kChunkFunctions;
+        vector<RecordWriter> chunks(chunk_count, RecordWriter(NULL));
+        std::atomic<size_t> next_chunk(0);
+        auto format_chunks = [&]() {
+          for (size_t i = next_chunk++; i < chunk_count; i = next_chunk++) {
+            size_t begin = batch + i * kChunkFunctions;
+            size_t end = std::min(batch_end, begin + kChunkFunctions);
+            for (size_t j = begin; j < end; ++j)
+              WriteFunction(functions[j], load_offset, &chunks[i]);
+          }
         };
-        Module::Inline::InlineDFS(func->inlines, write_inline);
-        if (!stream.good())
-          return ReportError();
-
-        while ((line_it != func->lines.end()) &&
-               (line_it->address >= range_it->address) &&
-               (line_it->address < (range_it->address + range_it->size))) {
-          stream << hex
-                 << (line_it->address - load_offset) << " "
-                 << line_it->size << " "
-                 << dec
-                 << line_it->number << " "
-                 << line_it->file->source_id << "\n";
-
-          if (!stream.good())
+        vector<std::thread> threads;
+        for (size_t i = 1; i < std::min<size_t>(write_thread_count_,
+                                                chunk_count); ++i) {
+          threads.push_back(std::thread(format_chunks));
+        }
+        format_chunks();
+        for (std::thread& thread : threads)
+          thread.join();
+        for (const RecordWriter& chunk : chunks) {
+          out.Append(chunk.buffer());
+          if (!out.FlushIfFull())
             return ReportError();
-
-          ++line_it;
         }
       }
+    } else {
+      for (FunctionSet::const_iterator func_it = functions_.begin();
+           func_it != functions_.end(); ++func_it) {
+        Function* func = *func_it;
+        // Bring back the lines and inlines of a spilled function; since
+        // runs are written in this order, each is just the next record of
+        // its run.
+        if (func->spill_run >= 0) {
+          uint64_t packed_size;
+          if (!spill_->ReadValue(func->spill_run, &packed_size))
+            return ReportError();
+          func->packed_lines.resize(packed_size);
+          if (!spill_->Read(func->spill_run, func->packed_lines.data(),
+                            packed_size) ||
+              !ReadSpilledInlines(func->spill_run, &func->inlines)) {
+            return ReportError();
+          }
+          for (Inline& in : func->inlines)
+            in.origin = *inline_origins.find(in.origin);
+        }
+        WriteFunction(func, load_offset, &out);
+        if (func->spill_run >= 0) {
+          vector<uint8_t>().swap(func->packed_lines);
+          InlineList().swap(func->inlines);
+        }
+        if (!out.FlushIfFull())
+          return ReportError();
+      }
     }
 
     // Write out 'PUBLIC' records.
-    for (ExternSet::const_iterator extern_it = externs_.begin();
+    SortExterns(false);
+    for (ExternList::const_iterator extern_it = externs_.begin();
          extern_it != externs_.end(); ++extern_it) {
       Extern* ext = extern_it->get();
-      stream << "PUBLIC " << (ext->is_multiple ? "m " : "") << hex
-             << (ext->address - load_offset) << " 0 " << ext->name << dec
-             << "\n";
+      out.Append(ext->is_multiple ? "PUBLIC m " : "PUBLIC ");
+      out.AppendHex(ext->address - load_offset);
+      out.Append(" 0 ");
+      out.Append(ext->name);
+      out.Append('\n');
+      if (!out.FlushIfFull())
+        return ReportError();
     }
   }
 
   if (symbol_data & CFI) {
-    // Write out 'STACK CFI INIT' and 'STACK CFI' records.
-    for (auto frame_it = stack_frame_entries_.begin();
-         frame_it != stack_frame_entries_.end(); ++frame_it) {
-      StackFrameEntry* entry = frame_it->get();
-      stream << "STACK CFI INIT " << hex
-             << (entry->address - load_offset) << " "
-             << entry->size << " " << dec;
-      if (!stream.good()
-          || !WriteRuleMap(entry->initial_rules, stream))
-        return ReportError();
-
-      stream << "\n";
+    // Write out 'STACK CFI INIT' and 'STACK CFI' records, starting with
+    // the spilled entries, which were added first.
+    auto write_entry = [&](const StackFrameEntry* entry) {
+      out.Append("STACK CFI INIT ");
+      out.AppendHex(entry->address - load_offset);
+      out.Append(' ');
+      out.AppendHex(entry->size);
+      out.Append(' ');
+      WriteRuleMap(entry->initial_rules, &out);
+      out.Append('\n');
 
       // Write out this entry's delta rules as 'STACK CFI' records.
       for (RuleChangeMap::const_iterator delta_it = entry->rule_changes.begin();
            delta_it != entry->rule_changes.end(); ++delta_it) {
-        stream << "STACK CFI " << hex
-               << (delta_it->first - load_offset) << " " << dec;
-        if (!stream.good()
-            || !WriteRuleMap(delta_it->second, stream))
+        out.Append("STACK CFI ");
+        out.AppendHex(delta_it->first - load_offset);
+        out.Append(' ');
+        WriteRuleMap(delta_it->second, &out);
+        out.Append('\n');
+      }
+      return out.FlushIfFull();
+    };
+    for (const auto& run : spilled_stack_frame_runs_) {
+      for (size_t i = 0; i < run.second; ++i) {
+        StackFrameEntry entry;
+        if (!ReadSpilledStackFrameEntry(run.first, &entry) ||
+            !write_entry(&entry)) {
           return ReportError();
-
-        stream << "\n";
+        }
       }
     }
+    for (auto frame_it = stack_frame_entries_.begin();
+         frame_it != stack_frame_entries_.end(); ++frame_it) {
+      if (!write_entry(frame_it->get()))
+        return ReportError();
+    }
   }
 
+  if (!out.Flush())
+    return ReportError();
   return true;
 }
 
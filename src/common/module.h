@@ -101,6 +101,92 @@ class Module {
     Address size;
   };
 
+  struct InlineOrigin {
+    explicit InlineOrigin(StringView name) : id(-1), name(name) {}
+
+    // A unique id for each InlineOrigin object. INLINE records use the id to
+    // refer to its INLINE_ORIGIN record.
+    int id;
+
+    // The inlined function's name.
+    StringView name;
+  };
+
+  // A inlined call site.
+  struct Inline {
+    InlineOrigin* origin;
+
+    // The index in the enclosing InlineList of the inline this one is
+    // nested in, or -1 if it is not nested in another.
+    int parent;
+
+    int call_site_line;
+
+    // The id is only meanful inside a CU. It's only used for looking up real
+    // File* after scanning a CU.
+    int call_site_file_id;
+
+    File* call_site_file;
+
+    int inline_nest_level;
+
+    // This inline's address ranges are the RANGE_COUNT ranges starting at
+    // FIRST_RANGE in the enclosing InlineList's ranges.
+    uint32_t first_range;
+    uint32_t range_count;
+
+    int getCallSiteFileID() const {
+      return call_site_file ? call_site_file->source_id : -1;
+    }
+  };
+
+  // The inlined call sites of a function, or of a part of one.  Rather
+  // than a tree of separately allocated nodes, the inlines are kept in one
+  // array in depth-first order, each followed by the inlines nested in it,
+  // and their ranges in another.
+  class InlineList {
+   public:
+    typedef vector<Inline>::iterator iterator;
+    typedef vector<Inline>::const_iterator const_iterator;
+
+    // Append an inline of ORIGIN covering RANGES, nested in the inline at
+    // index PARENT, or -1 for none, and return its index.
+    int Add(InlineOrigin* origin, int parent, const vector<Range>& ranges,
+            int call_site_line, int call_site_file_id,
+            int inline_nest_level);
+
+    // Append the inlines of OTHER, nesting those of its inlines that are
+    // not nested in another in the inline at index PARENT, or -1 for none.
+    void Append(const InlineList& other, int parent);
+
+    // The ranges of IN, which must be one of this list's inlines.
+    const Range* ranges(const Inline& in) const {
+      return ranges_.data() + in.first_range;
+    }
+
+    // The memory this list holds, for Module::SetMemoryBudget.
+    size_t MemorySize() const {
+      return inlines_.size() * sizeof(Inline) + ranges_.size() * sizeof(Range);
+    }
+
+    size_t size() const { return inlines_.size(); }
+    bool empty() const { return inlines_.empty(); }
+    Inline& operator[](size_t i) { return inlines_[i]; }
+    const Inline& operator[](size_t i) const { return inlines_[i]; }
+    iterator begin() { return inlines_.begin(); }
+    iterator end() { return inlines_.end(); }
+    const_iterator begin() const { return inlines_.begin(); }
+    const_iterator end() const { return inlines_.end(); }
+    void swap(InlineList& other) {
+      inlines_.swap(other.inlines_);
+      ranges_.swap(other.ranges_);
+    }
+
+   private:
+    vector<Inline> inlines_;
+    vector<Range> ranges_;
+  };
+
   // A function.
   struct Function {
     Function(StringView name_input, const Address& address_input) :
@@ -126,8 +212,12 @@ class Module {
     // address.
     vector<Line> lines;
 
+    // The lines in the packed form kept by a module with compact lines,
+    // which leaves LINES empty.  See Module::SetCompactLines.
+    vector<uint8_t> packed_lines;
+
     // Inlined call sites belonging to this functions.
-    vector<std::unique_ptr<Inline>> inlines;
+    InlineList inlines;
 
     // If this symbol has been folded with other symbols in the linked binary.
     bool is_multiple = false;
@@ -135,69 +225,17 @@ class Module {
     // If the function's name should be filled out from a matching Extern,
     // should they not match.
     bool prefer_extern_name = false;
-  };
 
-  struct InlineOrigin {
-    explicit InlineOrigin(StringView name) : id(-1), name(name) {}
-
-    // A unique id for each InlineOrigin object. INLINE records use the id to
-    // refer to its INLINE_ORIGIN record.
-    int id;
-
-    // The inlined function's name.
-    StringView name;
-  };
-
-  // A inlined call site.
-  struct Inline {
-    Inline(InlineOrigin* origin,
-           const vector<Range>& ranges,
-           int call_site_line,
-           int call_site_file_id,
-           int inline_nest_level,
-           vector<std::unique_ptr<Inline>> child_inlines)
-        : origin(origin),
-          ranges(ranges),
-          call_site_line(call_site_line),
-          call_site_file_id(call_site_file_id),
-          call_site_file(nullptr),
-          inline_nest_level(inline_nest_level),
-          child_inlines(std::move(child_inlines)) {}
-
-    InlineOrigin* origin;
-
-    // The list of addresses and sizes.
-    vector<Range> ranges;
-
-    int call_site_line;
-
-    // The id is only meanful inside a CU. It's only used for looking up real
-    // File* after scanning a CU.
-    int call_site_file_id;
-
-    File* call_site_file;
-
-    int inline_nest_level;
-
-    // A list of inlines which are children of this inline.
-    vector<std::unique_ptr<Inline>> child_inlines;
-
-    int getCallSiteFileID() const {
-      return call_site_file ? call_site_file->source_id : -1;
-    }
-
-    static void InlineDFS(
-        vector<std::unique_ptr<Module::Inline>>& inlines,
-        std::function<void(std::unique_ptr<Module::Inline>&)> const& forEach) {
-      for (std::unique_ptr<Module::Inline>& in : inlines) {
-        forEach(in);
-        InlineDFS(in->child_inlines, forEach);
-      }
-    }
+    // The spill run holding this function's lines and inlines, or -1 if
+    // they are in memory.  See Module::SetMemoryBudget.
+    int spill_run = -1;
   };
 
   typedef map<uint64_t, InlineOrigin*> InlineOriginByOffset;
 
+  // The inline origins of one file.  Origins are interned by name as they
+  // are created, so the DIEs of the same inlined function in different
+  // compilation units share one InlineOrigin.
   class InlineOriginMap {
    public:
     // Add INLINE ORIGIN to the module. Return a pointer to origin .
@@ -208,13 +246,15 @@ class Module {
     // DW_AT_specification doesn't exist in that DIE.
     void SetReference(uint64_t offset, uint64_t specification_offset);
 
-    ~InlineOriginMap() {
-      for (const auto& iter : inline_origins_) {
-        delete iter.second;
-      }
-    }
-
    private:
+    friend class Module;
+    friend class DwarfUnitCache;
+
+    // Return this file's origin named NAME, creating it if there is none.
+    // Origins whose name is omitted are never shared, as a later DIE may
+    // still name them.
+    InlineOrigin* Intern(StringView name);
+
     // A map from a DW_TAG_subprogram's offset to the DW_TAG_subprogram.
     InlineOriginByOffset inline_origins_;
 
@@ -222,6 +262,11 @@ class Module {
     // specification or abstract origin subprogram. The set of values in this
     // map should always be the same set of keys in inline_origins_.
     map<uint64_t, uint64_t> references_;
+
+    // The origins in inline_origins_, which several offsets may share, and
+    // those of them with a name, by name.
+    vector<std::unique_ptr<InlineOrigin>> origins_;
+    map<StringView, InlineOrigin*> origins_by_name_;
   };
 
   map<std::string, InlineOriginMap> inline_origin_maps;
@@ -294,7 +339,8 @@ class Module {
   struct ExternCompare {
     // Defining is_transparent allows
     // std::set<std::unique_ptr<Extern>, ExternCompare>::find() to be called
-    // with an Extern* and have set use the overloads below.
+    // with an Extern* and have set use the overloads below.  They also let
+    // std::lower_bound search a sorted vector of externs for an Extern*.
     using is_transparent = void;
     bool operator() (const std::unique_ptr<Extern>& lhs,
                      const std::unique_ptr<Extern>& rhs) const {
@@ -343,22 +389,63 @@ class Module {
   // this method is called.
   void SetAddressRanges(const vector<Range>& ranges);
 
+  // Keep about BUDGET bytes of function lines and inlines and of call
+  // frame info in memory.  Whenever the data added since the last spill
+  // exceeds BUDGET, it is moved to a temporary file as a run in the order
+  // Write emits it, and Write merges the runs back in, so the output does
+  // not change.  Zero, the default, keeps all of the data in memory.
+  // GetFunctions and GetStackFrameEntries do not see the data moved out.
+  void SetMemoryBudget(size_t budget);
+
+  // If COMPACT is true, pack the lines of each function added from now on
+  // into a few bytes apiece: each column of the lines is stored as the
+  // differences between neighbouring entries, with files as 32-bit
+  // indices.  Write unpacks each function's lines only while writing it.  The functions GetFunctions
+  // returns have no lines.  Defaults to false.
+  void SetCompactLines(bool compact) { compact_lines_ = compact; }
+
+  // Format the functions of modules that have not spilled any on up to
+  // COUNT threads while writing them; the output does not change.
+  // Defaults to 1.
+  void SetWriteThreadCount(int count) { write_thread_count_ = count; }
+
   // Add FUNCTION to the module. FUNCTION's name must not be empty.
   // This module owns all Function objects added with this function:
   // destroying the module destroys them as well.
   // Return false if the function is duplicate and needs to be freed.
   bool AddFunction(Function* function);
 
+  // Add FUNCTIONS, which were built in UNIT, to the module as
+  // AddFunction would, freeing the duplicates.  Their names are copied to
+  // this module's string pool, their lines and inlines are pointed at
+  // this module's files, and their inlines at this module's inline
+  // origins, which take in UNIT's, so UNIT can be destroyed afterwards.
+  // UNIT's inline origins must not share DIE offsets with this module's.
+  void AddUnitFunctions(Module* unit, const vector<Function*>& functions);
+
   // Add STACK_FRAME_ENTRY to the module.
   // This module owns all StackFrameEntry objects added with this
   // function: destroying the module destroys them as well.
   void AddStackFrameEntry(std::unique_ptr<StackFrameEntry> stack_frame_entry);
 
-  // Add PUBLIC to the module.
+  // Move UNIT's stack frame entries to the end of this module's, adding
+  // each as AddStackFrameEntry would.
+  void AddUnitStackFrameEntries(Module* unit);
+
+  // Add PUBLIC to the module.  If an extern at the same address has
+  // already been added, EXT is dropped, and the earlier one marked as
+  // multiple if the multiple field is enabled.  Externs are appended and
+  // sorted in bulk when a function or the output next needs them, so
+  // adding a large symbol table costs one allocation per extern.
   // This module owns all Extern objects added with this function:
   // destroying the module destroys them as well.
   void AddExtern(std::unique_ptr<Extern> ext);
 
+  // Move UNIT's externs to the end of this module's, adding each as
+  // AddExtern would, in the order they were added to UNIT.  No function
+  // may have been added to UNIT.
+  void AddUnitExterns(Module* unit);
+
   // If this module has a file named NAME, return a pointer to it. If
   // it has none, then create one and return a pointer to the new
   // file. This module owns all File objects created using these
@@ -443,15 +530,56 @@ class Module {
   // errno to find the appropriate cause.  Return false.
   static bool ReportError();
 
-  // Write RULE_MAP to STREAM, in the form appropriate for 'STACK CFI'
-  // records, without a final newline. Return true if all goes well;
-  // if an error occurs, return false, and leave errno set.
-  static bool WriteRuleMap(const RuleMap& rule_map, std::ostream& stream);
+  // A buffer that Write formats records into.
+  class RecordWriter;
+
+  // Append RULE_MAP to OUT, in the form appropriate for 'STACK CFI'
+  // records, without a final newline.
+  static void WriteRuleMap(const RuleMap& rule_map, RecordWriter* out);
+
+  // Append FUNC's FUNC, INLINE and line records to OUT, with addresses
+  // less LOAD_OFFSET, unpacking its lines for the time being.  FUNC's
+  // spilled data, if any, must have been read back.
+  void WriteFunction(Function* func, Address load_offset,
+                     RecordWriter* out) const;
 
   // Returns true of the specified address resides with an specified address
   // range, or if no ranges have been specified.
   bool AddressIsInModule(Address address) const;
 
+  // The temporary file holding the data moved out of memory.
+  class SpillFile;
+
+  // Note that the module holds SIZE more bytes of data that could be
+  // spilled, and spill it all if that exceeds the memory budget.
+  void AddSpillableData(size_t size);
+
+  // Move the lines and inlines of the functions in memory, followed by the
+  // call frame info, to new runs of the spill file.
+  void Spill();
+
+  // Write INLINES to the spill file, or read them back.
+  bool SpillInlines(const InlineList& inlines);
+  bool ReadSpilledInlines(int run, InlineList* inlines);
+
+  // Append the packed form of LINES to PACKED, or unpack PACKED into
+  // LINES.  See SetCompactLines.
+  void PackLines(const vector<Line>& lines, vector<uint8_t>* packed);
+  void UnpackLines(const vector<uint8_t>& packed, vector<Line>* lines) const;
+
+  // Read back the call frame info entry at the current position of RUN.
+  bool ReadSpilledStackFrameEntry(int run, StackFrameEntry* entry);
+
+  // Merge the externs added since the last call into the sorted ones,
+  // keeping the first added at each address, and drop those a function
+  // has replaced.  With MERGED_ONLY set, do nothing unless externs have
+  // been added, so that looking up one function's extern stays cheap.
+  void SortExterns(bool merged_only);
+
+  // Return the index in externs_ of the sorted extern at ADDRESS that no
+  // function has replaced, or externs_sorted_ if there is none.
+  size_t FindExtern(Address address) const;
+
   // Module header entries.
   string name_, os_, architecture_, id_, code_id_;
 
@@ -477,8 +605,8 @@ class Module {
   // A set containing Function structures, sorted by address.
   typedef set<Function*, FunctionCompare> FunctionSet;
 
-  // A set containing Extern structures, sorted by address.
-  typedef set<std::unique_ptr<Extern>, ExternCompare> ExternSet;
+  // A vector of Extern structures; see externs_.
+  typedef vector<std::unique_ptr<Extern>> ExternList;
 
   // The module owns all the files and functions that have been added
   // to it; destroying the module frees the Files and Functions these
@@ -493,11 +621,46 @@ class Module {
   vector<std::unique_ptr<StackFrameEntry>> stack_frame_entries_;
 
   // The module owns all the externs that have been added to it;
-  // destroying the module frees the Externs these point to.
-  ExternSet externs_;
+  // destroying the module frees the Externs these point to.  The first
+  // externs_sorted_ are sorted by address, at most one per address, and
+  // the rest are in the order they were added.  extern_replaced_ flags
+  // the sorted externs that a function at the same address has replaced;
+  // they stay in place until the next SortExterns, so that removing them
+  // does not shift the others.
+  ExternList externs_;
+  size_t externs_sorted_;
+  vector<bool> extern_replaced_;
+  size_t extern_replaced_count_;
 
   unordered_set<string> common_strings_;
 
+  // See SetMemoryBudget.  resident_bytes_ estimates the size of the data
+  // added since the last spill.
+  size_t memory_budget_;
+  size_t resident_bytes_;
+
+  // The spill file, created by the first spill, and the runs in it that
+  // hold call frame info, along with the number of entries in each.
+  std::unique_ptr<SpillFile> spill_;
+  vector<std::pair<int, size_t>> spilled_stack_frame_runs_;
+
+  // The files and inline origins referred to by spilled functions.
+  set<File*> spilled_files_;
+  set<InlineOrigin*> spilled_inline_origins_;
+
+  // See SetCompactLines.  Packed lines refer to files by their index in
+  // packed_files_; since functions are never removed, every file there is
+  // cited by some function's lines.
+  bool compact_lines_;
+  vector<File*> packed_files_;
+  unordered_map<File*, uint32_t> packed_file_indices_;
+
+  // See SetWriteThreadCount.
+  int write_thread_count_;
+
+  // Set if the spill file could not be written; Write then fails.
+  bool spill_failed_;
+
   // Whether symbols sharing an address should be collapsed into a single entry
   // and marked with an `m` in the output. See
   // https://bugs.chromium.org/p/google-breakpad/issues/detail?id=751 and docs
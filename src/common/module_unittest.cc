@@ -681,6 +681,57 @@ TEST(Module, ConstructFunctionsAndExternsWithSameAddress) {
                contents.c_str());
 }
 
+// Externs added out of order, and after functions have replaced some of
+// them, should still be written in address order, keeping the first
+// extern at each address that no function replaced.
+TEST(Module, ConstructExternsAroundFunctions) {
+  stringstream s;
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID, "", true);
+
+  const struct {
+    Module::Address address;
+    const char* name;
+  } first_externs[] = {
+    { 0x3000, "c" }, { 0x1000, "a" }, { 0x2000, "b" }, { 0x1000, "a2" },
+  };
+  for (const auto& e : first_externs) {
+    auto ext = std::make_unique<Module::Extern>(e.address);
+    ext->name = e.name;
+    m.AddExtern(std::move(ext));
+  }
+
+  Module::Function* function = new Module::Function("b", 0x2000);
+  function->ranges.push_back(Module::Range(0x2000, 0x10));
+  function->parameter_size = 0;
+  m.AddFunction(function);
+
+  // This one takes the place of the replaced extern; the other repeats
+  // an address still held by an extern.
+  const struct {
+    Module::Address address;
+    const char* name;
+  } later_externs[] = {
+    { 0x2000, "b2" }, { 0x3000, "c2" }, { 0x0800, "z" },
+  };
+  for (const auto& e : later_externs) {
+    auto ext = std::make_unique<Module::Extern>(e.address);
+    ext->name = e.name;
+    m.AddExtern(std::move(ext));
+  }
+
+  m.Write(s, ALL_SYMBOL_DATA);
+  string contents = s.str();
+
+  EXPECT_STREQ("MODULE " MODULE_OS " " MODULE_ARCH " " MODULE_ID " " MODULE_NAME
+               "\n"
+               "FUNC 2000 10 0 b\n"
+               "PUBLIC 800 0 z\n"
+               "PUBLIC m 1000 0 a\n"
+               "PUBLIC 2000 0 b2\n"
+               "PUBLIC m 3000 0 c\n",
+               contents.c_str());
+}
+
 // If there exists an extern and a function at the same address, only write
 // out the FUNC entry.
 TEST(Module, ConstructFunctionsAndExternsWithSameAddressPreferExternName) {
@@ -781,3 +832,349 @@ TEST(Module, ConstructFunctionsAndThumbExternsWithSameAddress) {
                "PUBLIC cc00 0 arm_func\n",
                contents.c_str());
 }
+
+// Functions built in separate unit modules should be written exactly as if
+// they had been built in the module they are added to.
+TEST(Module, AddUnitFunctions) {
+  stringstream s;
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID, "", true);
+  for (int i = 0; i < 2; ++i) {
+    std::unique_ptr<Module> unit(
+        new Module(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID));
+    Module::File* header = unit->FindFile("header.h");
+    Module::File* source = unit->FindFile(i ? "b.cc" : "a.cc");
+    Module::Address address = 0x1000 + i * 0x100;
+    Module::Function* function = new Module::Function(
+        unit->AddStringToPool(i ? "b_function" : "a_function"), address);
+    function->ranges.push_back(Module::Range(address, 0x80));
+    Module::Line line = { address, 0x10, source, 10 + i };
+    function->lines.push_back(line);
+    Module::Line header_line = { address + 0x10, 0x10, header, 20 + i };
+    function->lines.push_back(header_line);
+    uint64_t origin_offset = 0x40 + i * 0x20;
+    Module::InlineOriginMap& origins = unit->inline_origin_maps["file"];
+    origins.SetReference(origin_offset, origin_offset);
+    Module::InlineOrigin* origin = origins.GetOrCreateInlineOrigin(
+        origin_offset, unit->AddStringToPool("inlined"));
+    vector<Module::Range> inline_ranges(
+        1, Module::Range(address + 0x20, 0x10));
+    int in = function->inlines.Add(origin, -1, inline_ranges, 30 + i, 0, 0);
+    function->inlines[in].call_site_file = header;
+
+    vector<Module::Function*> functions(1, function);
+    // A duplicate, which should be dropped.
+    if (i)
+      functions.push_back(generate_duplicate_function("dup"));
+    else
+      functions.insert(functions.begin(), generate_duplicate_function("dup"));
+    m.AddUnitFunctions(unit.get(), functions);
+  }
+
+  m.Write(s, ALL_SYMBOL_DATA);
+  string contents = s.str();
+  EXPECT_STREQ("MODULE os-name architecture id-string name with spaces\n"
+               "FILE 0 a.cc\n"
+               "FILE 1 b.cc\n"
+               "FILE 2 header.h\n"
+               "INLINE_ORIGIN 0 inlined\n"
+               "FUNC 1000 80 0 a_function\n"
+               "INLINE 0 30 2 0 1020 10\n"
+               "1000 10 10 0\n"
+               "1010 10 20 2\n"
+               "FUNC 1100 80 0 b_function\n"
+               "INLINE 0 31 2 0 1120 10\n"
+               "1100 10 11 1\n"
+               "1110 10 21 2\n"
+               "FUNC m d35402aac7a7ad5c 200b26e605f99071 f14ac4fed48c4a99"
+               " dup\n",
+               contents.c_str());
+}
+
+// Inline origins of the same name share one InlineOrigin, but those whose
+// name is omitted stay apart until they are named.
+TEST(Module, InternInlineOrigins) {
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  Module::InlineOriginMap& origins = m.inline_origin_maps["file"];
+  for (uint64_t offset = 0x10; offset <= 0x40; offset += 0x10)
+    origins.SetReference(offset, offset);
+  Module::InlineOrigin* a = origins.GetOrCreateInlineOrigin(0x10, "a");
+  EXPECT_EQ(a, origins.GetOrCreateInlineOrigin(0x20, "a"));
+  Module::InlineOrigin* omitted1 =
+      origins.GetOrCreateInlineOrigin(0x30, "<name omitted>");
+  Module::InlineOrigin* omitted2 =
+      origins.GetOrCreateInlineOrigin(0x40, "<name omitted>");
+  EXPECT_NE(a, omitted1);
+  EXPECT_NE(omitted1, omitted2);
+  EXPECT_EQ(omitted1, origins.GetOrCreateInlineOrigin(0x30, "b"));
+  EXPECT_EQ("b", omitted1->name);
+  EXPECT_EQ("<name omitted>", omitted2->name);
+}
+
+// Appending one inline list to another nests its outermost inlines in the
+// given one, and keeps each inline's ranges.
+TEST(Module, AppendInlineList) {
+  Module::InlineOrigin origin("inlined");
+  Module::InlineList inner;
+  int outer = inner.Add(&origin, -1, vector<Module::Range>(
+                            1, Module::Range(0x10, 0x8)), 1, 0, 1);
+  inner.Add(&origin, outer, vector<Module::Range>(
+                1, Module::Range(0x14, 0x2)), 2, 0, 2);
+  inner.Add(&origin, -1, vector<Module::Range>(
+                2, Module::Range(0x20, 0x4)), 3, 0, 1);
+
+  Module::InlineList list;
+  int top = list.Add(&origin, -1, vector<Module::Range>(
+                         1, Module::Range(0x8, 0x20)), 4, 0, 0);
+  list.Append(inner, top);
+  ASSERT_EQ(4U, list.size());
+  EXPECT_EQ(-1, list[0].parent);
+  EXPECT_EQ(0, list[1].parent);
+  EXPECT_EQ(1, list[2].parent);
+  EXPECT_EQ(0, list[3].parent);
+  EXPECT_EQ(2, list[2].call_site_line);
+  ASSERT_EQ(1U, list[2].range_count);
+  EXPECT_EQ(0x14U, list.ranges(list[2])[0].address);
+  ASSERT_EQ(2U, list[3].range_count);
+  EXPECT_EQ(0x20U, list.ranges(list[3])[1].address);
+}
+
+TEST(Module, AddUnitStackFrameEntries) {
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  vector<Module::Range> address_ranges = {
+    Module::Range(0x1000ULL, 0x2000ULL),
+  };
+  m.SetAddressRanges(address_ranges);
+  auto entry = std::make_unique<Module::StackFrameEntry>();
+  entry->address = 0x1000ULL;
+  entry->size = 0x100ULL;
+  m.AddStackFrameEntry(std::move(entry));
+
+  Module unit(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  for (Module::Address address : {0x2000ULL, 0x4000ULL, 0x1800ULL}) {
+    entry = std::make_unique<Module::StackFrameEntry>();
+    entry->address = address;
+    entry->size = 0x100ULL;
+    entry->initial_rules[".cfa"] = "he was a handsome man";
+    unit.AddStackFrameEntry(std::move(entry));
+  }
+  m.AddUnitStackFrameEntries(&unit);
+
+  // The entries are appended in order, subject to the address ranges.
+  vector<Module::StackFrameEntry*> entries;
+  m.GetStackFrameEntries(&entries);
+  ASSERT_EQ(3U, entries.size());
+  EXPECT_EQ(0x1000ULL, entries[0]->address);
+  EXPECT_EQ(0x2000ULL, entries[1]->address);
+  EXPECT_EQ(0x1800ULL, entries[2]->address);
+  EXPECT_EQ("he was a handsome man", entries[2]->initial_rules[".cfa"]);
+  unit.GetStackFrameEntries(&entries);
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST(Module, AddUnitExterns) {
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  auto ext = std::make_unique<Module::Extern>(0xabc0);
+  ext->name = "first";
+  m.AddExtern(std::move(ext));
+
+  // Externs moved from a unit come after the module's own, so the first
+  // added at an address is still the one kept.
+  Module unit(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  for (Module::Address address : {0xabc0ULL, 0x1000ULL}) {
+    ext = std::make_unique<Module::Extern>(address);
+    ext->name = "unit";
+    unit.AddExtern(std::move(ext));
+  }
+  m.AddUnitExterns(&unit);
+  vector<Module::Extern*> externs;
+  unit.GetExterns(&externs, externs.end());
+  EXPECT_TRUE(externs.empty());
+
+  stringstream s;
+  m.Write(s, ALL_SYMBOL_DATA);
+  EXPECT_STREQ("MODULE " MODULE_OS " " MODULE_ARCH " "
+               MODULE_ID " " MODULE_NAME "\n"
+               "PUBLIC 1000 0 unit\n"
+               "PUBLIC abc0 0 first\n",
+               s.str().c_str());
+}
+
+// A module that spills its data to disk should write exactly what one that
+// keeps it in memory does, however often it spills, and as often as asked.
+TEST(Module, WriteSpilled) {
+  auto fill = [](Module* m) {
+    Module::File* file_a = m->FindFile("a.cc");
+    Module::File* file_b = m->FindFile("b.cc");
+    Module::InlineOriginMap& origins = m->inline_origin_maps["file"];
+    // Add the functions out of address order, so that the runs interleave.
+    for (int i = 0; i < 8; ++i) {
+      Module::Address address = 0x1000 + ((i * 5) % 8) * 0x100;
+      Module::Function* function = new Module::Function(
+          m->AddStringToPool("function" + std::to_string(i)), address);
+      function->ranges.push_back(Module::Range(address, 0x80));
+      function->ranges.push_back(Module::Range(address + 0x800, 0x10));
+      Module::Line line = { address, 0x10, i % 2 ? file_a : file_b, i };
+      function->lines.push_back(line);
+      Module::Line other_line = { address + 0x800, 0x10, file_a, 100 + i };
+      function->lines.push_back(other_line);
+      if (i % 3 == 0) {
+        origins.SetReference(i, i);
+        Module::InlineOrigin* origin = origins.GetOrCreateInlineOrigin(
+            i, m->AddStringToPool(i ? "inlined" : "other"));
+        vector<Module::Range> ranges(1, Module::Range(address + 0x20, 0x8));
+        int parent = function->inlines.Add(origin, -1, ranges, 200 + i, 0, 0);
+        int child = function->inlines.Add(origin, parent, ranges, 7, 0, 1);
+        function->inlines[child].call_site_file = file_b;
+      }
+      m->AddFunction(function);
+
+      auto entry = std::make_unique<Module::StackFrameEntry>();
+      entry->address = address;
+      entry->size = 0x80;
+      entry->initial_rules[".cfa"] = "$sp " + std::to_string(i) + " +";
+      entry->rule_changes[address + 4][".ra"] = ".cfa 8 - ^";
+      m->AddStackFrameEntry(std::move(entry));
+    }
+    m->AddExtern(std::make_unique<Module::Extern>(0x900));
+  };
+
+  Module in_memory(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  fill(&in_memory);
+  stringstream expected;
+  ASSERT_TRUE(in_memory.Write(expected, ALL_SYMBOL_DATA));
+
+  Module spilled(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  spilled.SetMemoryBudget(100);
+  fill(&spilled);
+  vector<Module::StackFrameEntry*> entries;
+  spilled.GetStackFrameEntries(&entries);
+  EXPECT_LT(entries.size(), 8U);
+  for (int i = 0; i < 2; ++i) {
+    stringstream s;
+    ASSERT_TRUE(spilled.Write(s, ALL_SYMBOL_DATA));
+    EXPECT_EQ(expected.str(), s.str());
+  }
+}
+
+// A module that packs its lines should write exactly what one that keeps
+// them as they are does, whether or not it also spills them.
+TEST(Module, WriteCompactLines) {
+  auto fill = [](Module* m) {
+    Module::File* files[3] = {
+      m->FindFile("a.cc"), m->FindFile("b.cc"), m->FindFile("unused.cc")
+    };
+    for (int i = 0; i < 8; ++i) {
+      Module::Address address = 0xfedc000000000000ULL + i * 0x1000;
+      Module::Function* function = new Module::Function(
+          m->AddStringToPool("function" + std::to_string(i)), address);
+      function->ranges.push_back(Module::Range(address, 0x800));
+      // Lines with gaps, overlaps, large and negative steps in the line
+      // number, and files to and fro.
+      Module::Address line_address = address;
+      for (int j = 0; j < 20; ++j) {
+        Module::Address size = (j % 3) ? 0x10 : 0x234;
+        Module::Line line = { line_address, size,
+                              files[(i + j / 4) % 2],
+                              j % 5 ? 1000 * i + j : 2000000000 - j };
+        function->lines.push_back(line);
+        line_address += j % 4 ? size : size / 2;
+      }
+      m->AddFunction(function);
+    }
+  };
+
+  Module plain(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  fill(&plain);
+  stringstream expected;
+  ASSERT_TRUE(plain.Write(expected, ALL_SYMBOL_DATA));
+
+  for (size_t budget = 0; budget <= 100; budget += 100) {
+    Module compact(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+    compact.SetCompactLines(true);
+    compact.SetMemoryBudget(budget);
+    fill(&compact);
+    vector<Module::Function*> functions;
+    compact.GetFunctions(&functions, functions.end());
+    ASSERT_EQ(8U, functions.size());
+    EXPECT_TRUE(functions[0]->lines.empty());
+    for (int i = 0; i < 2; ++i) {
+      stringstream s;
+      ASSERT_TRUE(compact.Write(s, ALL_SYMBOL_DATA));
+      EXPECT_EQ(expected.str(), s.str());
+    }
+  }
+}
+
+// Records are formatted without the stream, so check the extremes of each
+// number against what the stream itself would print.
+TEST(Module, WriteNumberExtremes) {
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  Module::File* file = m.FindFile("file.cc");
+  const Module::Address addresses[] = {
+    0, 1, 0xf, 0x10, 0xff, 0x100, 0x1000, 0xffffffffffffffffULL
+  };
+  const int numbers[] = { 0, 9, 10, 99, 100, 2147483647 };
+  stringstream expected;
+  expected << "MODULE os-name architecture id-string name with spaces\n"
+           << "FILE 0 file.cc\n";
+  for (size_t i = 0; i < sizeof(addresses) / sizeof(addresses[0]); ++i) {
+    Module::Address address = i * 0x10000 + 0x8000;
+    Module::Function* function = new Module::Function(
+        m.AddStringToPool("function" + std::to_string(i)), address);
+    function->ranges.push_back(Module::Range(address, 0x100));
+    function->parameter_size = addresses[i];
+    int number = numbers[i % (sizeof(numbers) / sizeof(numbers[0]))];
+    Module::Line line = { address, addresses[i], file, number };
+    function->lines.push_back(line);
+    m.AddFunction(function);
+    expected << "FUNC " << std::hex << address << " 100 "
+             << addresses[i] << " function" << std::dec << i << "\n"
+             << std::hex << address << " " << addresses[i] << " "
+             << std::dec << number << " 0\n";
+  }
+
+  stringstream s;
+  ASSERT_TRUE(m.Write(s, ALL_SYMBOL_DATA));
+  EXPECT_EQ(expected.str(), s.str());
+}
+
+// Functions formatted on several threads should come out exactly as they
+// do when formatted one after another.
+TEST(Module, WriteOnThreads) {
+  auto fill = [](Module* m) {
+    Module::File* file = m->FindFile("a.cc");
+    Module::InlineOriginMap& origins = m->inline_origin_maps["file"];
+    origins.SetReference(1, 1);
+    Module::InlineOrigin* origin =
+        origins.GetOrCreateInlineOrigin(1, m->AddStringToPool("inlined"));
+    for (int i = 0; i < 3000; ++i) {
+      Module::Address address = 0x10000 + i * 0x100;
+      Module::Function* function = new Module::Function(
+          m->AddStringToPool("function" + std::to_string(i)), address);
+      function->ranges.push_back(Module::Range(address, 0x80));
+      Module::Line line = { address, 0x10, file, i };
+      function->lines.push_back(line);
+      if (i % 7 == 0) {
+        vector<Module::Range> ranges(1, Module::Range(address + 0x20, 0x8));
+        function->inlines.Add(origin, -1, ranges, i, 0, 0);
+      }
+      m->AddFunction(function);
+    }
+    m->AddExtern(std::make_unique<Module::Extern>(0x900));
+  };
+
+  Module serial(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  fill(&serial);
+  stringstream expected;
+  ASSERT_TRUE(serial.Write(expected, ALL_SYMBOL_DATA));
+
+  Module threaded(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  threaded.SetCompactLines(true);
+  threaded.SetWriteThreadCount(4);
+  fill(&threaded);
+  for (int i = 0; i < 2; ++i) {
+    stringstream s;
+    ASSERT_TRUE(threaded.Write(s, ALL_SYMBOL_DATA));
+    EXPECT_EQ(expected.str(), s.str());
+  }
+}
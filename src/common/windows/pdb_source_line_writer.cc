@@ -38,13 +38,18 @@
 #include <dia2.h>
 #include <diacreate.h>
 #include <ImageHlp.h>
+#include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #include <algorithm>
+#include <condition_variable>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <thread>
 #include <utility>
 
 #include "common/windows/dia_util.h"
@@ -63,9 +68,14 @@ namespace google_breakpad {
 namespace {
 
 using std::set;
+using std::string;
 using std::unique_ptr;
 using std::vector;
 
+// The number of functions and public symbols whose records a thread gathers
+// at a time when dumping on several threads.
+const size_t kSymbolsPerChunk = 256;
+
 // The symbol (among possibly many) selected to represent an rva.
 struct SelectedSymbol {
   SelectedSymbol(const CComPtr<IDiaSymbol>& symbol, bool is_public)
@@ -114,6 +124,58 @@ void MaybeRecordSymbol(DWORD rva,
   }
 }
 
+// Selects the symbol to use for each rva of session's functions and public
+// symbols.  Returns true on success.
+bool SelectSymbols(IDiaSession* session, SymbolMap* rva_symbol) {
+  CComPtr<IDiaSymbol> global;
+  if (FAILED(session->get_globalScope(&global))) {
+    fprintf(stderr, "get_globalScope failed\n");
+    return false;
+  }
+
+  // Find all function symbols first, then record public symbols that are not
+  // also private symbols.
+  const enum SymTagEnum kTags[] = { SymTagFunction, SymTagPublicSymbol };
+  for (enum SymTagEnum tag : kTags) {
+    CComPtr<IDiaEnumSymbols> symbols;
+    if (FAILED(global->findChildren(tag, NULL, nsNone, &symbols)))
+      continue;
+
+    CComPtr<IDiaSymbol> symbol;
+    ULONG count = 0;
+    while (SUCCEEDED(symbols->Next(1, &symbol, &count)) && count == 1) {
+      DWORD rva;
+      if (SUCCEEDED(symbol->get_relativeVirtualAddress(&rva))) {
+        // Potentially record this as the canonical symbol for this rva.
+        MaybeRecordSymbol(rva, symbol, tag == SymTagPublicSymbol, rva_symbol);
+      } else {
+        fprintf(stderr, "get_relativeVirtualAddress failed on the symbol\n");
+        return false;
+      }
+
+      symbol.Release();
+    }
+  }
+  return true;
+}
+
+// Appends the printf-style |format| to |output|.
+void AppendFormat(string* output, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  int length = _vscprintf(format, args);
+  va_end(args);
+  if (length <= 0)
+    return;
+
+  size_t offset = output->size();
+  output->resize(offset + length + 1);
+  va_start(args, format);
+  vsnprintf(&(*output)[offset], length + 1, format, args);
+  va_end(args);
+  output->resize(offset + length);
+}
+
 
 
 bool SymbolsMatch(IDiaSymbol* a, IDiaSymbol* b) {
@@ -173,6 +235,10 @@ const DWORD kUndecorateOptions = UNDNAME_NO_MS_KEYWORDS |
 
 #define arraysize(f) (sizeof(f) / sizeof(*f))
 
+// Serializes calls into DbgHelp, which is not thread-safe, when symbols are
+// dumped on several threads.
+std::mutex dbghelp_mutex;
+
 void StripLlvmSuffixAndUndecorate(BSTR* name) {
   // LLVM sometimes puts a suffix on symbols to give them a globally unique
   // name. The suffix is either some string preceded by a period (like in the
@@ -196,6 +262,7 @@ void StripLlvmSuffixAndUndecorate(BSTR* name) {
     if (c == L'.' || (c == L'$' && len - i == 32 + 1)) {
       (*name)[i] = L'\0';
       wchar_t undecorated[1024];
+      std::lock_guard<std::mutex> lock(dbghelp_mutex);
       DWORD res = UnDecorateSymbolNameW(*name, undecorated,
                                         arraysize(undecorated),
                                         kUndecorateOptions);
@@ -293,6 +360,14 @@ void PDBSourceLineWriter::Inline::SetChildInlines(
   child_inlines_ = std::move(child_inlines);
 }
 
+void PDBSourceLineWriter::Inline::RemapOriginIds(
+    const vector<int>& origin_ids) {
+  origin_id_ = origin_ids[origin_id_];
+  for (const unique_ptr<Inline>& in : child_inlines_) {
+    in->RemapOriginIds(origin_ids);
+  }
+}
+
 void PDBSourceLineWriter::Inline::Print(FILE* output) const {
   // Ignore INLINE record that doesn't have any range.
   if (ranges_.empty())
@@ -401,7 +476,7 @@ void PDBSourceLineWriter::Lines::AddLine(const Line& line) {
 }
 
 PDBSourceLineWriter::PDBSourceLineWriter(bool handle_inline)
-    : output_(NULL), handle_inline_(handle_inline) {}
+    : output_(NULL), handle_inline_(handle_inline), thread_count_(1) {}
 
 PDBSourceLineWriter::~PDBSourceLineWriter() {
   Close();
@@ -522,7 +597,8 @@ bool PDBSourceLineWriter::GetLines(IDiaEnumLineNumbers* lines,
   return true;
 }
 
-void PDBSourceLineWriter::PrintLines(const Lines& lines) const {
+void PDBSourceLineWriter::PrintLines(const Lines& lines,
+                                     string* output) const {
   // The line number format is:
   // <rva> <line number> <source file id>
   for (const auto& kv : lines.GetLineMap()) {
@@ -530,15 +606,18 @@ void PDBSourceLineWriter::PrintLines(const Lines& lines) const {
     AddressRangeVector ranges;
     MapAddressRange(image_map_, AddressRange(l.rva, l.length), &ranges);
     for (auto& range : ranges) {
-      fprintf(output_, "%lx %lx %lu %lu\n", range.rva, range.length, l.line_num,
-              l.file_id);
+      AppendFormat(output, "%lx %lx %lu %lu\n", range.rva, range.length,
+                   l.line_num, l.file_id);
     }
   }
 }
 
-bool PDBSourceLineWriter::PrintFunction(IDiaSymbol* function,
-                                        IDiaSymbol* block,
-                                        bool has_multiple_symbols) {
+bool PDBSourceLineWriter::GetFunctionRecord(IDiaSession* session,
+                                            IDiaSymbol* function,
+                                            IDiaSymbol* block,
+                                            bool has_multiple_symbols,
+                                            InlineOriginMap* inline_origins,
+                                            SymbolRecord* record) const {
   // The function format is:
   // FUNC <address> <length> <param_stack_size> <function>
   DWORD rva;
@@ -575,12 +654,13 @@ bool PDBSourceLineWriter::PrintFunction(IDiaSymbol* function,
                   &ranges);
   for (size_t i = 0; i < ranges.size(); ++i) {
     const char* optional_multiple_field = has_multiple_symbols ? "m " : "";
-    fprintf(output_, "FUNC %s%lx %lx %x %ws\n", optional_multiple_field,
-            ranges[i].rva, ranges[i].length, stack_param_size, name.m_str);
+    AppendFormat(&record->header, "FUNC %s%lx %lx %x %ws\n",
+                 optional_multiple_field, ranges[i].rva, ranges[i].length,
+                 stack_param_size, name.m_str);
   }
 
   CComPtr<IDiaEnumLineNumbers> lines;
-  if (FAILED(session_->findLinesByRVA(rva, DWORD(length), &lines))) {
+  if (FAILED(session->findLinesByRVA(rva, DWORD(length), &lines))) {
     return false;
   }
 
@@ -591,16 +671,33 @@ bool PDBSourceLineWriter::PrintFunction(IDiaSymbol* function,
     return false;
   }
   if (handle_inline_) {
-    vector<unique_ptr<Inline>> inlines;
-    if (!GetInlines(block, &line_list, 0, &inlines)) {
+    if (!GetInlines(session, block, &line_list, 0, inline_origins,
+                    &record->inlines)) {
       return false;
     }
-    PrintInlines(inlines);
   }
-  PrintLines(line_list);
+  PrintLines(line_list, &record->lines);
+  return true;
+}
+
+bool PDBSourceLineWriter::PrintFunction(IDiaSymbol* function,
+                                        IDiaSymbol* block,
+                                        bool has_multiple_symbols) {
+  SymbolRecord record;
+  if (!GetFunctionRecord(session_, function, block, has_multiple_symbols,
+                         &inline_origins_, &record)) {
+    return false;
+  }
+  PrintRecord(record);
   return true;
 }
 
+void PDBSourceLineWriter::PrintRecord(const SymbolRecord& record) const {
+  fputs(record.header.c_str(), output_);
+  PrintInlines(record.inlines);
+  fputs(record.lines.c_str(), output_);
+}
+
 bool PDBSourceLineWriter::PrintSourceFiles() {
   CComPtr<IDiaSymbol> global;
   if (FAILED(session_->get_globalScope(&global))) {
@@ -657,72 +754,37 @@ bool PDBSourceLineWriter::PrintSourceFiles() {
 
 bool PDBSourceLineWriter::PrintFunctions() {
   ULONG count = 0;
-  DWORD rva = 0;
   CComPtr<IDiaSymbol> global;
-  HRESULT hr;
 
   if (FAILED(session_->get_globalScope(&global))) {
     fprintf(stderr, "get_globalScope failed\n");
     return false;
   }
 
-  CComPtr<IDiaEnumSymbols> symbols = NULL;
-
-  // Find all function symbols first.
-  SymbolMap rva_symbol;
-  hr = global->findChildren(SymTagFunction, NULL, nsNone, &symbols);
-
-  if (SUCCEEDED(hr)) {
-    CComPtr<IDiaSymbol> symbol = NULL;
-
-    while (SUCCEEDED(symbols->Next(1, &symbol, &count)) && count == 1) {
-      if (SUCCEEDED(symbol->get_relativeVirtualAddress(&rva))) {
-        // Potentially record this as the canonical symbol for this rva.
-        MaybeRecordSymbol(rva, symbol, false, &rva_symbol);
-      } else {
-        fprintf(stderr, "get_relativeVirtualAddress failed on the symbol\n");
-        return false;
-      }
-
-      symbol.Release();
-    }
-
-    symbols.Release();
-  }
-
-  // Find all public symbols and record public symbols that are not also private
-  // symbols.
-  hr = global->findChildren(SymTagPublicSymbol, NULL, nsNone, &symbols);
-
-  if (SUCCEEDED(hr)) {
-    CComPtr<IDiaSymbol> symbol = NULL;
+  if (thread_count_ > 1) {
+    if (!PrintSymbolsInParallel())
+      return false;
+  } else {
+    SymbolMap rva_symbol;
+    if (!SelectSymbols(session_, &rva_symbol))
+      return false;
 
-    while (SUCCEEDED(symbols->Next(1, &symbol, &count)) && count == 1) {
-      if (SUCCEEDED(symbol->get_relativeVirtualAddress(&rva))) {
-        // Potentially record this as the canonical symbol for this rva.
-        MaybeRecordSymbol(rva, symbol, true, &rva_symbol);
+    // For each rva, dump the selected symbol at the address.
+    SymbolMap::iterator it;
+    for (it = rva_symbol.begin(); it != rva_symbol.end(); ++it) {
+      CComPtr<IDiaSymbol> symbol = it->second.symbol;
+      // Only print public symbols if there is no function symbol for the
+      // address.
+      if (!it->second.is_public) {
+        if (!PrintFunction(symbol, symbol, it->second.is_multiple))
+          return false;
       } else {
-        fprintf(stderr, "get_relativeVirtualAddress failed on the symbol\n");
-        return false;
+        SymbolRecord record;
+        if (!GetPublicRecord(session_, symbol, it->second.is_multiple,
+                             &record))
+          return false;
+        PrintRecord(record);
       }
-
-      symbol.Release();
-    }
-
-    symbols.Release();
-  }
-
-  // For each rva, dump the selected symbol at the address.
-  SymbolMap::iterator it;
-  for (it = rva_symbol.begin(); it != rva_symbol.end(); ++it) {
-    CComPtr<IDiaSymbol> symbol = it->second.symbol;
-    // Only print public symbols if there is no function symbol for the address.
-    if (!it->second.is_public) {
-      if (!PrintFunction(symbol, symbol, it->second.is_multiple))
-        return false;
-    } else {
-      if (!PrintCodePublicSymbol(symbol, it->second.is_multiple))
-        return false;
     }
   }
 
@@ -782,6 +844,185 @@ bool PDBSourceLineWriter::PrintFunctions() {
   return true;
 }
 
+struct PDBSourceLineWriter::RecordChunk {
+  vector<SymbolRecord> records;
+  // The names of the inline origins the records refer to, by the ids used in
+  // the records.
+  vector<wstring> inline_origin_names;
+};
+
+struct PDBSourceLineWriter::RecordQueue {
+  explicit RecordQueue(size_t window)
+      : window(window),
+        next_chunk(0),
+        printed_chunks(0),
+        chunk_count(SIZE_MAX),
+        failed(false) {}
+
+  std::mutex mutex;
+  // Signalled when a chunk is gathered or printed, or a thread fails.
+  std::condition_variable changed;
+  // The number of chunks that may be gathered ahead of printing.
+  const size_t window;
+  // The next chunk for a thread to claim.
+  size_t next_chunk;
+  // The number of chunks printed.
+  size_t printed_chunks;
+  // The number of chunks of kSymbolsPerChunk symbols, once a thread has
+  // selected the symbols.
+  size_t chunk_count;
+  // The gathered chunks that have not been printed, by chunk number.
+  map<size_t, unique_ptr<RecordChunk>> chunks;
+  // Set if any thread could not gather its records.
+  bool failed;
+};
+
+void PDBSourceLineWriter::GatherRecords(const wstring& pdb_file,
+                                        RecordQueue* queue) const {
+  const bool initialized = SUCCEEDED(CoInitialize(NULL));
+  bool ok = initialized;
+  if (ok) {
+    // Every thread selects the symbols from its own session, and so arrives
+    // at the same list of symbols; symbols from one session can't be used
+    // with another.
+    CComPtr<IDiaDataSource> data_source;
+    CComPtr<IDiaSession> session;
+    OmapData omap_data;
+    SymbolMap rva_symbol;
+    ok = CreateDiaDataSourceInstance(data_source) &&
+         SUCCEEDED(data_source->loadDataFromPdb(pdb_file.c_str())) &&
+         SUCCEEDED(data_source->openSession(&session)) &&
+         GetOmapDataAndDisableTranslation(session, &omap_data) &&
+         SelectSymbols(session, &rva_symbol);
+
+    vector<SymbolMap::const_iterator> symbols;
+    for (SymbolMap::const_iterator it = rva_symbol.begin();
+         ok && it != rva_symbol.end(); ++it) {
+      symbols.push_back(it);
+    }
+    const size_t chunk_count =
+        (symbols.size() + kSymbolsPerChunk - 1) / kSymbolsPerChunk;
+
+    while (ok) {
+      size_t chunk_number;
+      {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        queue->chunk_count = chunk_count;
+        queue->changed.notify_all();
+        queue->changed.wait(lock, [queue] {
+          return queue->failed || queue->next_chunk >= queue->chunk_count ||
+                 queue->next_chunk < queue->printed_chunks + queue->window;
+        });
+        if (queue->failed || queue->next_chunk >= queue->chunk_count)
+          break;
+        chunk_number = queue->next_chunk++;
+      }
+
+      unique_ptr<RecordChunk> chunk(new RecordChunk);
+      InlineOriginMap inline_origins;
+      size_t end = (chunk_number + 1) * kSymbolsPerChunk;
+      if (end > symbols.size())
+        end = symbols.size();
+      for (size_t i = chunk_number * kSymbolsPerChunk; ok && i < end; ++i) {
+        const SelectedSymbol& selected = symbols[i]->second;
+        chunk->records.push_back(SymbolRecord());
+        if (!selected.is_public) {
+          ok = GetFunctionRecord(session, selected.symbol, selected.symbol,
+                                 selected.is_multiple, &inline_origins,
+                                 &chunk->records.back());
+        } else {
+          ok = GetPublicRecord(session, selected.symbol, selected.is_multiple,
+                               &chunk->records.back());
+        }
+      }
+      chunk->inline_origin_names.resize(inline_origins.size());
+      for (const auto& origin : inline_origins)
+        chunk->inline_origin_names[origin.second.id] = origin.first;
+
+      std::lock_guard<std::mutex> lock(queue->mutex);
+      if (ok)
+        queue->chunks[chunk_number] = std::move(chunk);
+      queue->changed.notify_all();
+    }
+  }
+
+  if (!ok) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->failed = true;
+    queue->changed.notify_all();
+  }
+  if (initialized)
+    CoUninitialize();
+}
+
+bool PDBSourceLineWriter::PrintSymbolsInParallel() {
+  CComPtr<IDiaSymbol> global;
+  CComBSTR pdb_file;
+  if (FAILED(session_->get_globalScope(&global)) ||
+      FAILED(global->get_symbolsFileName(&pdb_file))) {
+    fprintf(stderr, "failed to get the pdb file name\n");
+    return false;
+  }
+
+  RecordQueue queue(4 * thread_count_);
+  vector<std::thread> threads;
+  for (int i = 0; i < thread_count_; ++i) {
+    threads.push_back(std::thread(&PDBSourceLineWriter::GatherRecords, this,
+                                  wstring(pdb_file), &queue));
+  }
+
+  // Print the chunks in order as they arrive.  Each chunk numbers its inline
+  // origins in the order it found them, so giving its new origins the next
+  // ids here numbers them just as a single thread would.
+  bool ok = true;
+  for (;;) {
+    unique_ptr<RecordChunk> chunk;
+    {
+      std::unique_lock<std::mutex> lock(queue.mutex);
+      queue.changed.wait(lock, [&queue] {
+        return queue.failed || queue.printed_chunks >= queue.chunk_count ||
+               queue.chunks.count(queue.printed_chunks) != 0;
+      });
+      if (queue.failed) {
+        ok = false;
+        break;
+      }
+      if (queue.printed_chunks >= queue.chunk_count)
+        break;
+      auto it = queue.chunks.find(queue.printed_chunks);
+      chunk = std::move(it->second);
+      queue.chunks.erase(it);
+    }
+
+    vector<int> origin_ids;
+    for (const wstring& name : chunk->inline_origin_names) {
+      auto iter = inline_origins_.find(name);
+      if (iter == inline_origins_.end()) {
+        InlineOrigin origin;
+        origin.id = inline_origins_.size();
+        origin.name = name;
+        iter = inline_origins_.insert(std::make_pair(name, origin)).first;
+      }
+      origin_ids.push_back(iter->second.id);
+    }
+    for (SymbolRecord& record : chunk->records) {
+      for (const unique_ptr<Inline>& in : record.inlines)
+        in->RemapOriginIds(origin_ids);
+      PrintRecord(record);
+    }
+
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    ++queue.printed_chunks;
+    queue.changed.notify_all();
+  }
+
+  for (std::thread& thread : threads)
+    thread.join();
+  if (!ok)
+    fprintf(stderr, "failed to gather symbols on a worker thread\n");
+  return ok;
+}
+
 void PDBSourceLineWriter::PrintInlineOrigins() const {
   struct OriginCompare {
     bool operator()(const InlineOrigin lhs, const InlineOrigin rhs) const {
@@ -797,10 +1038,13 @@ void PDBSourceLineWriter::PrintInlineOrigins() const {
   }
 }
 
-bool PDBSourceLineWriter::GetInlines(IDiaSymbol* block,
-                                     Lines* line_list,
-                                     int inline_nest_level,
-                                     vector<unique_ptr<Inline>>* inlines) {
+bool PDBSourceLineWriter::GetInlines(
+    IDiaSession* session,
+    IDiaSymbol* block,
+    Lines* line_list,
+    int inline_nest_level,
+    InlineOriginMap* inline_origins,
+    vector<unique_ptr<Inline>>* inlines) const {
   CComPtr<IDiaEnumSymbols> inline_callsites;
   if (FAILED(block->findChildrenEx(SymTagInlineSite, nullptr, nsNone,
                                    &inline_callsites))) {
@@ -815,7 +1059,7 @@ bool PDBSourceLineWriter::GetInlines(IDiaSymbol* block,
     // All inlinee lines have the same file id.
     DWORD file_id = 0;
     DWORD call_site_line = 0;
-    if (FAILED(session_->findInlineeLines(callsite, &lines))) {
+    if (FAILED(session->findInlineeLines(callsite, &lines))) {
       return false;
     }
     CComPtr<IDiaLineNumber> dia_line;
@@ -843,20 +1087,20 @@ bool PDBSourceLineWriter::GetInlines(IDiaSymbol* block,
     if (SysStringLen(name) == 0) {
       name = SysAllocString(L"<name omitted>");
     }
-    auto iter = inline_origins_.find(name);
-    if (iter == inline_origins_.end()) {
+    auto iter = inline_origins->find(name);
+    if (iter == inline_origins->end()) {
       InlineOrigin origin;
-      origin.id = inline_origins_.size();
+      origin.id = inline_origins->size();
       origin.name = name;
-      inline_origins_[name] = origin;
+      (*inline_origins)[name] = origin;
     }
-    new_inline->SetOriginId(inline_origins_[name].id);
+    new_inline->SetOriginId((*inline_origins)[name].id);
     new_inline->SetCallSiteLine(call_site_line);
     new_inline->SetCallSiteFileId(file_id);
     // Go to next level.
     vector<unique_ptr<Inline>> child_inlines;
-    if (!GetInlines(callsite, line_list, inline_nest_level + 1,
-                    &child_inlines)) {
+    if (!GetInlines(session, callsite, line_list, inline_nest_level + 1,
+                    inline_origins, &child_inlines)) {
       return false;
     }
     new_inline->SetChildInlines(std::move(child_inlines));
@@ -1047,8 +1291,10 @@ bool PDBSourceLineWriter::PrintFrameData() {
   return PrintFrameDataUsingPDB();
 }
 
-bool PDBSourceLineWriter::PrintCodePublicSymbol(IDiaSymbol* symbol,
-                                                bool has_multiple_symbols) {
+bool PDBSourceLineWriter::GetPublicRecord(IDiaSession* session,
+                                          IDiaSymbol* symbol,
+                                          bool has_multiple_symbols,
+                                          SymbolRecord* record) const {
   BOOL is_code;
   if (FAILED(symbol->get_code(&is_code))) {
     return false;
@@ -1072,9 +1318,9 @@ bool PDBSourceLineWriter::PrintCodePublicSymbol(IDiaSymbol* symbol,
   MapAddressRange(image_map_, AddressRange(rva, 1), &ranges);
   for (size_t i = 0; i < ranges.size(); ++i) {
     const char* optional_multiple_field = has_multiple_symbols ? "m " : "";
-    fprintf(output_, "PUBLIC %s%lx %x %ws\n", optional_multiple_field,
-            ranges[i].rva, stack_param_size > 0 ? stack_param_size : 0,
-            name.m_str);
+    AppendFormat(&record->header, "PUBLIC %s%lx %x %ws\n",
+                 optional_multiple_field, ranges[i].rva,
+                 stack_param_size > 0 ? stack_param_size : 0, name.m_str);
   }
 
   // Now walk the function in the original untranslated space, asking DIA
@@ -1086,15 +1332,18 @@ bool PDBSourceLineWriter::PrintCodePublicSymbol(IDiaSymbol* symbol,
   for (;;) {
     // This steps to the next block in the original image. Simply doing
     // rva++ would also be correct, but would emit tons of unnecessary
-    // entries.
-    rva = image_map_.subsequent_rva_block[rva];
+    // entries.  The map is only read, as several threads may share it.
+    std::map<DWORD, DWORD>::const_iterator next_block =
+        image_map_.subsequent_rva_block.find(rva);
+    rva = next_block != image_map_.subsequent_rva_block.end() ?
+        next_block->second : 0;
     if (rva == 0)
       break;
 
     CComPtr<IDiaSymbol> next_sym = NULL;
     LONG displacement;
-    if (FAILED(session_->findSymbolByRVAEx(rva, SymTagPublicSymbol, &next_sym,
-                                           &displacement))) {
+    if (FAILED(session->findSymbolByRVAEx(rva, SymTagPublicSymbol, &next_sym,
+                                          &displacement))) {
       break;
     }
 
@@ -1104,8 +1353,8 @@ bool PDBSourceLineWriter::PrintCodePublicSymbol(IDiaSymbol* symbol,
     AddressRangeVector next_ranges;
     MapAddressRange(image_map_, AddressRange(rva, 1), &next_ranges);
     for (size_t i = 0; i < next_ranges.size(); ++i) {
-      fprintf(output_, "PUBLIC %lx %x %ws\n", next_ranges[i].rva,
-              stack_param_size > 0 ? stack_param_size : 0, name.m_str);
+      AppendFormat(&record->header, "PUBLIC %lx %x %ws\n", next_ranges[i].rva,
+                   stack_param_size > 0 ? stack_param_size : 0, name.m_str);
     }
   }
 
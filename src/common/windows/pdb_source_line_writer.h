@@ -102,6 +102,14 @@ class PDBSourceLineWriter {
   // determined, this method returns false.
   bool UsesGUID(bool *uses_guid);
 
+  // Sets the number of threads WriteSymbols uses to gather the FUNC and
+  // PUBLIC records, with their lines and inlines.  With more than one, each
+  // thread opens its own DIA session on the pdb file and gathers the records
+  // of a range of addresses at a time, and the records are printed in the
+  // same order, and with the same INLINE_ORIGIN ids, as on one thread.
+  // Defaults to 1.
+  void set_thread_count(int thread_count) { thread_count_ = thread_count; }
+
  private:
   // InlineOrigin represents INLINE_ORIGIN record in a symbol file. It's an
   // inlined function.
@@ -142,6 +150,10 @@ class PDBSourceLineWriter {
 
     void SetChildInlines(std::vector<std::unique_ptr<Inline>> child_inlines);
 
+    // Replaces the origin id of this Inline and its children, origin_id, with
+    // origin_ids[origin_id].
+    void RemapOriginIds(const vector<int>& origin_ids);
+
     void Print(FILE* output) const;
 
    private:
@@ -196,6 +208,27 @@ class PDBSourceLineWriter {
     map<DWORD, Line> line_map_;
   };
 
+  // The INLINE_ORIGIN records found so far, by function name.
+  typedef map<wstring, InlineOrigin> InlineOriginMap;
+
+  // The records printed for one function or public symbol.
+  struct SymbolRecord {
+    // The FUNC or PUBLIC lines.
+    std::string header;
+    // The function's INLINE records, if inlines are handled.
+    vector<std::unique_ptr<Inline>> inlines;
+    // The function's line records.
+    std::string lines;
+  };
+
+  // The records gathered from one range of the selected symbols, in rva
+  // order.
+  struct RecordChunk;
+
+  // The work shared by the threads gathering records.  See
+  // set_thread_count.
+  struct RecordQueue;
+
   // Construct Line from IDiaLineNumber. The output Line is stored at line.
   // Return true on success.
   bool GetLine(IDiaLineNumber* dia_line, Line* line) const;
@@ -205,20 +238,44 @@ class PDBSourceLineWriter {
   // Returns true on success.
   bool GetLines(IDiaEnumLineNumbers* lines, Lines* line_list) const;
 
-  // Outputs the line/address pairs for each line in the enumerator.
-  void PrintLines(const Lines& lines) const;
+  // Appends the line/address pairs for each line in the enumerator to
+  // output.
+  void PrintLines(const Lines& lines, std::string* output) const;
 
-  // Outputs a function address and name, followed by its source line list.
-  // block can be the same object as function, or it can be a reference to a
-  // code block that is lexically part of this function, but resides at a
-  // separate address. If has_multiple_symbols is true, this function's
-  // instructions correspond to multiple symbols. Returns true on success.
+  // Gathers a function address and name, followed by its source line list,
+  // into record, using session to look up the lines and inline_origins to
+  // number the inlined functions.  block can be the same object as function,
+  // or it can be a reference to a code block that is lexically part of this
+  // function, but resides at a separate address. If has_multiple_symbols is
+  // true, this function's instructions correspond to multiple symbols.
+  // Returns true on success.
+  bool GetFunctionRecord(IDiaSession* session,
+                         IDiaSymbol* function,
+                         IDiaSymbol* block,
+                         bool has_multiple_symbols,
+                         InlineOriginMap* inline_origins,
+                         SymbolRecord* record) const;
+
+  // Outputs a function as gathered by GetFunctionRecord, using session_ and
+  // inline_origins_.  Returns true on success.
   bool PrintFunction(IDiaSymbol *function, IDiaSymbol *block,
                      bool has_multiple_symbols);
 
+  // Outputs a record gathered by GetFunctionRecord or GetPublicRecord.
+  void PrintRecord(const SymbolRecord& record) const;
+
   // Outputs all functions as described above.  Returns true on success.
   bool PrintFunctions();
 
+  // Outputs the functions and public symbols of the pdb file, gathering their
+  // records on thread_count_ threads.  Returns true on success.
+  bool PrintSymbolsInParallel();
+
+  // The body of each thread started by PrintSymbolsInParallel: opens a
+  // session on pdb_file and gathers records for queue until every address
+  // range has been claimed.
+  void GatherRecords(const wstring& pdb_file, RecordQueue* queue) const;
+
   // Outputs all of the source files in the session's pdb file.
   // Returns true on success.
   bool PrintSourceFiles();
@@ -230,14 +287,19 @@ class PDBSourceLineWriter {
   // `line_list` since inner lines are more precise source location. If the
   // block has children wih SymTagInlineSite Tag, it will recursively (DFS) call
   // itself with each child as first argument. Returns true on success.
+  // `session`: the session to look up inlinee lines in.
   // `block`: the IDiaSymbol that may have inline sites.
   // `line_list`: the list of lines inside current function.
   // `inline_nest_level`: the nest level of block's Inlines.
+  // `inline_origins`: the origins of the inlined functions, extended with any
+  // new ones.
   // `inlines`: the vector to store the list of inlines for the block.
-  bool GetInlines(IDiaSymbol* block,
+  bool GetInlines(IDiaSession* session,
+                  IDiaSymbol* block,
                   Lines* line_list,
                   int inline_nest_level,
-                  vector<std::unique_ptr<Inline>>* inlines);
+                  InlineOriginMap* inline_origins,
+                  vector<std::unique_ptr<Inline>>* inlines) const;
 
   // Outputs all inlines.
   void PrintInlines(const vector<std::unique_ptr<Inline>>& inlines) const;
@@ -256,12 +318,16 @@ class PDBSourceLineWriter {
   // backtraces in the absence of frame pointers.  Returns true on success.
   bool PrintFrameData();
 
-  // Outputs a single public symbol address and name, if the symbol corresponds
-  // to a code address.  Returns true on success.  If symbol is does not
-  // correspond to code, returns true without outputting anything. If
+  // Gathers a single public symbol address and name into record, if the
+  // symbol corresponds to a code address, using session to find the rest of a
+  // symbol split by OMAP.  Returns true on success.  If symbol is does not
+  // correspond to code, returns true leaving record empty. If
   // has_multiple_symbols is true, the symbol corresponds to a code address and
   // the instructions correspond to multiple symbols.
-  bool PrintCodePublicSymbol(IDiaSymbol *symbol, bool has_multiple_symbols);
+  bool GetPublicRecord(IDiaSession* session,
+                       IDiaSymbol* symbol,
+                       bool has_multiple_symbols,
+                       SymbolRecord* record) const;
 
   // Outputs a line identifying the PDB file that is being dumped, along with
   // its uuid and age.
@@ -338,7 +404,7 @@ class PDBSourceLineWriter {
   unordered_map<wstring, DWORD> unique_files_;
 
   // The INLINE_ORIGINS records. The key is the function name.
-  std::map<wstring, InlineOrigin> inline_origins_;
+  InlineOriginMap inline_origins_;
 
   // This is used for calculating post-transform symbol addresses and lengths.
   ImageMap image_map_;
@@ -346,6 +412,9 @@ class PDBSourceLineWriter {
   // If we should output INLINE/INLINE_ORIGIN records
   bool handle_inline_;
 
+  // See set_thread_count.
+  int thread_count_;
+
   // Disallow copy ctor and operator=
   PDBSourceLineWriter(const PDBSourceLineWriter&);
   void operator=(const PDBSourceLineWriter&);
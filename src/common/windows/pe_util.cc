@@ -39,66 +39,14 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 
+#include "common/amd64_unwind_info.h"
 #include "common/windows/string_utils-inl.h"
 #include "common/windows/guid_string.h"
 
 namespace {
 
-/*
- * Not defined in WinNT.h prior to SDK 10.0.20348.0 for some reason.
- * Definitions taken from: http://uninformed.org/index.cgi?v=4&a=1&p=13
- *
- */
-typedef unsigned char UBYTE;
-
-#if !defined(UNW_FLAG_EHANDLER)
-#define UNW_FLAG_EHANDLER  0x01
-#endif
-#if !defined(UNW_FLAG_UHANDLER)
-#define UNW_FLAG_UHANDLER  0x02
-#endif
-#if !defined(UNW_FLAG_CHAININFO)
-#define UNW_FLAG_CHAININFO 0x04
-#endif
-
-union UnwindCode {
-  struct {
-    UBYTE offset_in_prolog;
-    UBYTE unwind_operation_code : 4;
-    UBYTE operation_info : 4;
-  };
-  USHORT frame_offset;
-};
-
-enum UnwindOperationCodes {
-  UWOP_PUSH_NONVOL = 0, /* info == register number */
-  UWOP_ALLOC_LARGE,     /* no info, alloc size in next 2 slots */
-  UWOP_ALLOC_SMALL,     /* info == size of allocation / 8 - 1 */
-  UWOP_SET_FPREG,       /* no info, FP = RSP + UNWIND_INFO.FPRegOffset*16 */
-  UWOP_SAVE_NONVOL,     /* info == register number, offset in next slot */
-  UWOP_SAVE_NONVOL_FAR, /* info == register number, offset in next 2 slots */
-  // XXX: these are missing from MSDN!
-  // See: http://www.osronline.com/ddkx/kmarch/64bitamd_4rs7.htm
-  UWOP_SAVE_XMM,
-  UWOP_SAVE_XMM_FAR,
-  UWOP_SAVE_XMM128,     /* info == XMM reg number, offset in next slot */
-  UWOP_SAVE_XMM128_FAR, /* info == XMM reg number, offset in next 2 slots */
-  UWOP_PUSH_MACHFRAME   /* info == 0: no error-code, 1: error-code */
-};
-
-// See: http://msdn.microsoft.com/en-us/library/ddssxxy8.aspx
-// Note: some fields removed as we don't use them.
-struct UnwindInfo {
-  UBYTE version : 3;
-  UBYTE flags : 5;
-  UBYTE size_of_prolog;
-  UBYTE count_of_codes;
-  UBYTE frame_register : 4;
-  UBYTE frame_offset : 4;
-  UnwindCode unwind_code[1];
-};
-
 struct CV_INFO_PDB70 {
   ULONG cv_signature;
   GUID signature;
@@ -108,18 +56,47 @@ struct CV_INFO_PDB70 {
 
 #define CV_SIGNATURE_RSDS 'SDSR'
 
+// Serializes ImageHlp calls, which are not thread-safe, so that modules can
+// be converted on several threads.
+std::mutex image_hlp_mutex;
+
 // A helper class to scope a PLOADED_IMAGE.
 class AutoImage {
 public:
-  explicit AutoImage(PLOADED_IMAGE img) : img_(img) {}
+  explicit AutoImage(const std::string& img_file) {
+    std::lock_guard<std::mutex> lock(image_hlp_mutex);
+    img_ = ImageLoad(const_cast<PSTR>(img_file.c_str()), NULL);
+  }
   ~AutoImage() {
-    if (img_)
+    if (img_) {
+      std::lock_guard<std::mutex> lock(image_hlp_mutex);
       ImageUnload(img_);
+    }
   }
 
   operator PLOADED_IMAGE() { return img_; }
   PLOADED_IMAGE operator->() { return img_; }
 
+private:
+  PLOADED_IMAGE img_;
+};
+
+// Reads the unwind data of a loaded image for AMD64UnwindInfo.
+class LoadedImageReader : public google_breakpad::AMD64UnwindInfo::ImageReader {
+public:
+  explicit LoadedImageReader(PLOADED_IMAGE img) : img_(img) {}
+
+  const uint8_t* ReadRVA(uint32_t rva, size_t size) {
+    PIMAGE_SECTION_HEADER section =
+      ImageRvaToSection(img_->FileHeader, img_->MappedAddress, rva);
+    if (!section || rva - section->VirtualAddress > section->SizeOfRawData ||
+        size > section->SizeOfRawData - (rva - section->VirtualAddress)) {
+      return NULL;
+    }
+    return static_cast<const uint8_t*>(
+      ImageRvaToVa(img_->FileHeader, img_->MappedAddress, rva, NULL));
+  }
+
 private:
   PLOADED_IMAGE img_;
 };
@@ -140,7 +117,7 @@ bool ReadModuleInfo(const wstring & pe_file, PDBModuleInfo * info) {
     return false;
   }
 
-  AutoImage img(ImageLoad((PSTR)img_file.c_str(), NULL));
+  AutoImage img(img_file);
   if (!img) {
     fprintf(stderr, "Failed to load %s\n", img_file.c_str());
     return false;
@@ -214,7 +191,7 @@ bool ReadPEInfo(const wstring & pe_file, PEModuleInfo * info) {
     return false;
   }
 
-  AutoImage img(ImageLoad((PSTR)img_file.c_str(), NULL));
+  AutoImage img(img_file);
   if (!img) {
     fprintf(stderr, "Failed to open PE file: %S\n", pe_file.c_str());
     return false;
@@ -256,7 +233,7 @@ bool PrintPEFrameData(const wstring & pe_file, FILE * out_file)
     return false;
   }
 
-  AutoImage img(ImageLoad((PSTR)img_file.c_str(), NULL));
+  AutoImage img(img_file);
   if (!img) {
     fprintf(stderr, "Failed to load %s\n", img_file.c_str());
     return false;
@@ -273,107 +250,33 @@ bool PrintPEFrameData(const wstring & pe_file, FILE * out_file)
     DataDirectory[IMAGE_DIRECTORY_ENTRY_EXCEPTION].VirtualAddress;
   DWORD exception_size = optional_header->
     DataDirectory[IMAGE_DIRECTORY_ENTRY_EXCEPTION].Size;
+  LoadedImageReader image(img);
+  const uint8_t* funcs_data = image.ReadRVA(exception_rva, exception_size);
+  if (!funcs_data) {
+    return exception_size == 0;
+  }
   PIMAGE_RUNTIME_FUNCTION_ENTRY funcs =
-    static_cast<PIMAGE_RUNTIME_FUNCTION_ENTRY>(
-      ImageRvaToVa(img->FileHeader,
-        img->MappedAddress,
-        exception_rva,
-        &img->LastRvaSection));
+    reinterpret_cast<PIMAGE_RUNTIME_FUNCTION_ENTRY>(
+      const_cast<uint8_t*>(funcs_data));
+
+  // Replay each function's prologue to find the rules after each of its
+  // instructions.  Functions whose unwind data cannot be described by
+  // STACK CFI records are left to the processor's other unwinding methods.
+  AMD64UnwindInfo unwind_info(&image);
+  AMD64UnwindInfo::Rules rules;
   for (DWORD i = 0; i < exception_size / sizeof(*funcs); i++) {
-    DWORD unwind_rva = funcs[i].UnwindInfoAddress;
-    // handle chaining
-    while (unwind_rva & 0x1) {
-      unwind_rva ^= 0x1;
-      PIMAGE_RUNTIME_FUNCTION_ENTRY chained_func =
-        static_cast<PIMAGE_RUNTIME_FUNCTION_ENTRY>(
-          ImageRvaToVa(img->FileHeader,
-            img->MappedAddress,
-            unwind_rva,
-            &img->LastRvaSection));
-      unwind_rva = chained_func->UnwindInfoAddress;
+    if (funcs[i].EndAddress <= funcs[i].BeginAddress ||
+        !unwind_info.GetRules(funcs[i].UnwindInfoAddress, &rules)) {
+      continue;
     }
-
-    UnwindInfo *unwind_info = static_cast<UnwindInfo*>(
-      ImageRvaToVa(img->FileHeader,
-        img->MappedAddress,
-        unwind_rva,
-        &img->LastRvaSection));
-
-    DWORD stack_size = 8;  // minimal stack size is 8 for RIP
-    DWORD rip_offset = 8;
-    do {
-      for (UBYTE c = 0; c < unwind_info->count_of_codes; c++) {
-        UnwindCode *unwind_code = &unwind_info->unwind_code[c];
-        switch (unwind_code->unwind_operation_code) {
-        case UWOP_PUSH_NONVOL: {
-          stack_size += 8;
-          break;
-        }
-        case UWOP_ALLOC_LARGE: {
-          if (unwind_code->operation_info == 0) {
-            c++;
-            if (c < unwind_info->count_of_codes)
-              stack_size += (unwind_code + 1)->frame_offset * 8;
-          }
-          else {
-            c += 2;
-            if (c < unwind_info->count_of_codes)
-              stack_size += (unwind_code + 1)->frame_offset |
-              ((unwind_code + 2)->frame_offset << 16);
-          }
-          break;
-        }
-        case UWOP_ALLOC_SMALL: {
-          stack_size += unwind_code->operation_info * 8 + 8;
-          break;
-        }
-        case UWOP_SET_FPREG:
-        case UWOP_SAVE_XMM:
-        case UWOP_SAVE_XMM_FAR:
-          break;
-        case UWOP_SAVE_NONVOL:
-        case UWOP_SAVE_XMM128: {
-          c++;  // skip slot with offset
-          break;
-        }
-        case UWOP_SAVE_NONVOL_FAR:
-        case UWOP_SAVE_XMM128_FAR: {
-          c += 2;  // skip 2 slots with offset
-          break;
-        }
-        case UWOP_PUSH_MACHFRAME: {
-          if (unwind_code->operation_info) {
-            stack_size += 88;
-          }
-          else {
-            stack_size += 80;
-          }
-          rip_offset += 80;
-          break;
-        }
-        }
-      }
-      if (unwind_info->flags & UNW_FLAG_CHAININFO) {
-        PIMAGE_RUNTIME_FUNCTION_ENTRY chained_func =
-          reinterpret_cast<PIMAGE_RUNTIME_FUNCTION_ENTRY>(
-          (unwind_info->unwind_code +
-            ((unwind_info->count_of_codes + 1) & ~1)));
-
-        unwind_info = static_cast<UnwindInfo*>(
-          ImageRvaToVa(img->FileHeader,
-            img->MappedAddress,
-            chained_func->UnwindInfoAddress,
-            &img->LastRvaSection));
-      }
-      else {
-        unwind_info = NULL;
-      }
-    } while (unwind_info);
-    fprintf(out_file, "STACK CFI INIT %lx %lx .cfa: $rsp .ra: .cfa %lu - ^\n",
+    fprintf(out_file, "STACK CFI INIT %lx %lx %s\n",
       funcs[i].BeginAddress,
-      funcs[i].EndAddress - funcs[i].BeginAddress, rip_offset);
-    fprintf(out_file, "STACK CFI %lx .cfa: $rsp %lu +\n",
-      funcs[i].BeginAddress, stack_size);
+      funcs[i].EndAddress - funcs[i].BeginAddress, rules.initial.c_str());
+    for (size_t j = 0; j < rules.changes.size(); j++) {
+      fprintf(out_file, "STACK CFI %lx %s\n",
+        funcs[i].BeginAddress + rules.changes[j].first,
+        rules.changes[j].second.c_str());
+    }
   }
 
   return true;
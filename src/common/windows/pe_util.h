@@ -45,7 +45,8 @@ bool ReadModuleInfo(const wstring& pe_file, PDBModuleInfo* info);
 // Reads |pe_file| and populates |info|. Returns true on success.
 bool ReadPEInfo(const wstring& pe_file, PEModuleInfo* info);
 
-// Reads |pe_file| and prints frame data (aka. unwind info) to |out_file|.
+// Reads |pe_file| and prints frame data (aka. unwind info) to |out_file|,
+// as STACK CFI records for each instruction of each function's prologue.
 // Only supports PE32+ format, ie. a 64bit PE file.
 bool PrintPEFrameData(const wstring& pe_file, FILE* out_file);
 
@@ -327,7 +327,7 @@ typedef enum {
   MD_EXCEPTION_STREAM            =  6,  /* MDRawExceptionStream */
   MD_SYSTEM_INFO_STREAM          =  7,  /* MDRawSystemInfo */
   MD_THREAD_EX_LIST_STREAM       =  8,
-  MD_MEMORY_64_LIST_STREAM       =  9,
+  MD_MEMORY_64_LIST_STREAM       =  9,  /* MDRawMemory64List */
   MD_COMMENT_STREAM_A            = 10,
   MD_COMMENT_STREAM_W            = 11,
   MD_HANDLE_DATA_STREAM          = 12,
@@ -357,6 +357,9 @@ typedef enum {
   MD_LINUX_AUXV                  = 0x47670008,  /* /proc/$x/auxv      */
   MD_LINUX_MAPS                  = 0x47670009,  /* /proc/$x/maps      */
   MD_LINUX_DSO_DEBUG             = 0x4767000A,  /* MDRawDebug{32,64}  */
+  MD_LINUX_DUMP_TIMING           = 0x4767000B,  /* MDRawDumpTiming    */
+  MD_BREADCRUMB_STREAM           = 0x4767000C,  /* MDRawBreadcrumbList */
+  MD_LINUX_LIVE_DUMP             = 0x4767000D,  /* MDRawLinuxLiveDump */
 
   /* Crashpad extension types. 0x4350 = "CP"
    * See Crashpad's minidump/minidump_extensions.h. */
@@ -553,6 +556,23 @@ static const size_t MDRawMemoryList_minsize = offsetof(MDRawMemoryList,
                                                        memory_ranges[0]);
 
 
+typedef struct {
+  uint64_t start_of_memory_range;
+  uint64_t data_size;
+} MDMemoryDescriptor64;  /* MINIDUMP_MEMORY_DESCRIPTOR64 */
+
+/* The memory of every range follows the list contiguously, starting at
+ * base_rva, in the order of memory_ranges. */
+typedef struct {
+  uint64_t             number_of_memory_ranges;
+  MDRVA64              base_rva;
+  MDMemoryDescriptor64 memory_ranges[1];
+} MDRawMemory64List;  /* MINIDUMP_MEMORY64_LIST */
+
+static const size_t MDRawMemory64List_minsize = offsetof(MDRawMemory64List,
+                                                         memory_ranges[0]);
+
+
 #define MD_EXCEPTION_MAXIMUM_PARAMETERS 15u
 
 typedef struct {
@@ -1084,6 +1104,110 @@ typedef struct {
   uint64_t  dynamic;
 } MDRawDebug64;
 
+/* The phases of writing a Linux minidump that are timed in the
+ * MD_LINUX_DUMP_TIMING stream.  The first two are timed by the crashing
+ * process and the rest by the process writing the minidump. */
+typedef enum {
+  /* From entering the signal handler to starting the dump process. */
+  MD_DUMP_TIMING_HANDLER = 0,
+  /* From starting the dump process until it may ptrace the crashing one. */
+  MD_DUMP_TIMING_CLONE = 1,
+  /* Listing the threads of the crashing process. */
+  MD_DUMP_TIMING_THREAD_ENUMERATION = 2,
+  /* Reading the mappings from /proc/$x/maps. */
+  MD_DUMP_TIMING_MAPPING_ENUMERATION = 3,
+  /* Attaching to and stopping each thread. */
+  MD_DUMP_TIMING_THREADS_SUSPEND = 4,
+  /* The thread list, with the registers and stacks of each thread. */
+  MD_DUMP_TIMING_THREAD_LIST = 5,
+  /* The files copied from /proc/$x. */
+  MD_DUMP_TIMING_PROC_FILES = 6,
+  /* The module list, with the identifiers of the modules. */
+  MD_DUMP_TIMING_MODULE_LIST = 7,
+  /* The memory list, with the regions other than stacks. */
+  MD_DUMP_TIMING_MEMORY_LIST = 8,
+  /* The exception, system information and remaining Linux streams. */
+  MD_DUMP_TIMING_OTHER_STREAMS = 9,
+  /* Detaching from the threads. */
+  MD_DUMP_TIMING_THREADS_RESUME = 10,
+  /* Writing out what remains of the minidump once the timing stream has
+   * been written, so only reported to the crashing process. */
+  MD_DUMP_TIMING_FILE_WRITE = 11,
+  MD_DUMP_TIMING_PHASE_COUNT = 12
+} MDDumpTimingPhase;
+
+typedef struct {
+  uint32_t  phase;  /* MDDumpTimingPhase */
+  uint32_t  reserved;
+  uint64_t  start_ns;  /* CLOCK_MONOTONIC, in nanoseconds */
+  uint64_t  duration_ns;
+} MDRawDumpTimingPhase;
+
+/* Only the phases that were reached are listed, in MDDumpTimingPhase
+ * order. */
+typedef struct {
+  uint32_t  version;  /* MD_DUMP_TIMING_VERSION */
+  uint32_t  phase_count;
+  MDRawDumpTimingPhase  phases[0];
+} MDRawDumpTiming;
+
+static const size_t MDRawDumpTiming_minsize = offsetof(MDRawDumpTiming,
+                                                       phases[0]);
+
+#define MD_DUMP_TIMING_VERSION 1
+
+/* The most bytes of data that a breadcrumb holds. */
+#define MD_BREADCRUMB_DATA_SIZE 48
+
+/* A breadcrumb recorded by a thread of the client, such as an RPC it
+ * sent or an allocation it made.  The client gives each one a category
+ * and up to MD_BREADCRUMB_DATA_SIZE bytes of data, usually text. */
+typedef struct {
+  uint64_t  timestamp_ns;  /* Monotonic clock, in nanoseconds; on Linux,
+                            * CLOCK_MONOTONIC as in MDRawDumpTimingPhase */
+  uint32_t  category;
+  uint32_t  data_size;     /* The bytes of data that are used */
+  uint8_t   data[MD_BREADCRUMB_DATA_SIZE];
+} MDRawBreadcrumb;
+
+/* The breadcrumbs that a thread recorded most recently, oldest first.
+ * Earlier ones were overwritten, so recorded_count may be larger than
+ * breadcrumb_count. */
+typedef struct {
+  uint32_t  thread_id;
+  uint32_t  breadcrumb_count;
+  uint64_t  recorded_count;
+  MDRawBreadcrumb  breadcrumbs[0];
+} MDRawBreadcrumbThread;
+
+static const size_t MDRawBreadcrumbThread_minsize =
+    offsetof(MDRawBreadcrumbThread, breadcrumbs[0]);
+
+/* The MD_BREADCRUMB_STREAM holds thread_count MDRawBreadcrumbThreads, one
+ * after the other, each followed by its breadcrumbs. */
+typedef struct {
+  uint32_t  version;  /* MD_BREADCRUMB_VERSION */
+  uint32_t  thread_count;
+} MDRawBreadcrumbList;
+
+#define MD_BREADCRUMB_VERSION 1
+
+/* The MD_LINUX_LIVE_DUMP stream marks a minidump of a process that was
+ * resumed part way through the dump.  The first stopped_stream_count
+ * streams of the directory, the thread list with the registers and stacks
+ * of the threads among them, were written while its threads were stopped.
+ * The others, such as the module and memory lists, were written while it
+ * ran, so they are a best-effort snapshot that need not agree with the
+ * threads, nor with each other. */
+typedef struct {
+  uint32_t  version;  /* MD_LINUX_LIVE_DUMP_VERSION */
+  uint32_t  stopped_stream_count;
+  uint64_t  suspend_ns;  /* CLOCK_MONOTONIC, in nanoseconds */
+  uint64_t  resume_ns;   /* CLOCK_MONOTONIC, in nanoseconds */
+} MDRawLinuxLiveDump;
+
+#define MD_LINUX_LIVE_DUMP_VERSION 1
+
 /* Crashpad extension types. See Crashpad's minidump/minidump_extensions.h. */
 
 typedef struct {
@@ -61,9 +61,23 @@ class BasicSourceLineResolver : public SourceLineResolverBase {
   using SourceLineResolverBase::HasModule;
   using SourceLineResolverBase::IsModuleCorrupt;
   using SourceLineResolverBase::FillSourceLineInfo;
+  using SourceLineResolverBase::FillSourceLineInfoWithInlineRecords;
+  using SourceLineResolverBase::ExpandInlineFrames;
   using SourceLineResolverBase::FindWindowsFrameInfo;
   using SourceLineResolverBase::FindCFIFrameInfo;
 
+  // Parses symbol files of modules loaded from now on using up to
+  // |load_thread_count| threads.  Only large symbol files are split, and
+  // the resulting modules are the same as with the default of 1, which
+  // parses on the calling thread.
+  void set_load_thread_count(int load_thread_count);
+
+  // Moves the records of modules loaded from now on out of their maps into
+  // sorted arrays once they are parsed, which takes less memory and gives
+  // the same lookups.  Frozen modules cannot be serialized for
+  // FastSourceLineResolver, so this is off by default.
+  void set_freeze_modules(bool freeze_modules);
+
  private:
   // friend declarations:
   friend class BasicModuleFactory;
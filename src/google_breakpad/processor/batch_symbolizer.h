@@ -0,0 +1,128 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// batch_symbolizer.h: Symbolizes many module-relative addresses at once,
+// without a minidump.
+//
+// Profilers record their samples as a module and an offset into it,
+// millions at a time, with the same addresses recurring.  BatchSymbolizer
+// groups a batch of such addresses by module, fetches and loads each
+// module's symbols once, and looks up each distinct address once, in
+// address order.  Results name functions and source files by their index
+// in a string table shared by every batch, so that they stay compact.
+
+#ifndef GOOGLE_BREAKPAD_PROCESSOR_BATCH_SYMBOLIZER_H__
+#define GOOGLE_BREAKPAD_PROCESSOR_BATCH_SYMBOLIZER_H__
+
+#include <stddef.h>
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+class CodeModule;
+class SourceLineResolverInterface;
+class SymbolSupplier;
+
+class BatchSymbolizer {
+ public:
+  // Marks a Result field that names nothing.
+  static const uint32_t kNoString = 0xffffffff;
+
+  // An address to symbolize: an offset into modules[module], where modules
+  // is the vector passed to Symbolize.
+  struct Address {
+    size_t module;
+    uint64_t offset;
+  };
+
+  struct Result {
+    // Indexes into strings(), or kNoString if the address is in no known
+    // function or has no known source line.
+    uint32_t function_name;
+    uint32_t source_file;
+    int source_line;
+    // The address's offset from the start of its function.
+    uint64_t function_offset;
+  };
+
+  // Neither supplier nor resolver is owned.  supplier may be NULL if every
+  // module's symbols are already loaded in resolver.
+  BatchSymbolizer(SymbolSupplier* supplier,
+                  SourceLineResolverInterface* resolver);
+
+  // Symbolizes addresses, storing the result for addresses[i] in
+  // (*results)[i].  Symbols are requested without system information.
+  // Modules whose symbols cannot be found are remembered and not requested
+  // again.  Returns the number of addresses found in some function.
+  size_t Symbolize(const std::vector<const CodeModule*>& modules,
+                   const std::vector<Address>& addresses,
+                   std::vector<Result>* results);
+
+  // The function names and source files that results refer to.
+  const std::vector<string>& strings() const { return strings_; }
+
+  // Empties the string table, invalidating the results returned so far,
+  // to bound its size over a long run.
+  void ClearStrings();
+
+ private:
+  // Makes sure module's symbols are loaded, fetching them if need be.
+  // Returns false if they cannot be loaded.
+  bool LoadModule(const CodeModule* module);
+
+  // Looks up the address offset bytes into module.
+  Result Lookup(const CodeModule* module, uint64_t offset);
+
+  // Returns the index of str in strings_, adding it if it is not there.
+  uint32_t Intern(const string& str);
+
+  SymbolSupplier* supplier_;
+  SourceLineResolverInterface* resolver_;
+
+  // The code files of modules whose symbols could not be loaded.
+  std::set<string> no_symbol_modules_;
+
+  std::vector<string> strings_;
+  std::unordered_map<string, uint32_t> string_indexes_;
+
+  // Disallow unwanted copy ctor and assignment operator
+  BatchSymbolizer(const BatchSymbolizer&);
+  void operator=(const BatchSymbolizer&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // GOOGLE_BREAKPAD_PROCESSOR_BATCH_SYMBOLIZER_H__
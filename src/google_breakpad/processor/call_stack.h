@@ -44,6 +44,8 @@
 #ifndef GOOGLE_BREAKPAD_PROCESSOR_CALL_STACK_H__
 #define GOOGLE_BREAKPAD_PROCESSOR_CALL_STACK_H__
 
+#include <stddef.h>
+
 #include <cstdint>
 #include <vector>
 
@@ -51,34 +53,79 @@ namespace google_breakpad {
 
 using std::vector;
 
+class Arena;
+class SourceLineResolverInterface;
 struct StackFrame;
 template<typename T> class linked_ptr;
 
 class CallStack {
  public:
-  CallStack() { Clear(); }
+  CallStack() : frame_pool_(NULL) { Clear(); }
   ~CallStack();
 
   // Resets the CallStack to its initial empty state
   void Clear();
 
+  // Returns |size| bytes for a frame of this call stack, which are released
+  // all at once when the call stack is cleared or destroyed.  Frames are
+  // allocated here with new (call_stack) StackFrameX(...); see StackFrame.
+  // Frames of a call stack should only be allocated by one thread at a time.
+  void* AllocateFrame(size_t size);
+
   const vector<StackFrame*>* frames() const { return &frames_; }
 
+  // Constructs the inlined frames recorded in the frames' inline_records,
+  // such as by a StackFrameSymbolizer with set_lazy_inline_frames, with
+  // |resolver|, and inserts them before the frames they are inlined into,
+  // as the stack walk would have.  Returns false if the inlined frames of
+  // some frame could not be constructed, because its module is no longer
+  // loaded; those are dropped.
+  bool ExpandInlineFrames(SourceLineResolverInterface* resolver);
+
   // Set the TID associated with this call stack.
   void set_tid(uint32_t tid) { tid_ = tid; }
 
   uint32_t tid() const { return tid_; }
 
+  // Set the index, in ProcessState::threads(), of the thread whose walk
+  // this call stack's frames were copied from.
+  void set_duplicate_of(int thread_index) { duplicate_of_ = thread_index; }
+
+  // The index of the thread this call stack duplicates, or -1 if it was
+  // walked itself.  Output tools may use this to collapse identical
+  // threads.
+  int duplicate_of() const { return duplicate_of_; }
+
+  // Set whether the walk that produced this call stack stopped because it
+  // used up its StackwalkBudget.
+  void set_budget_exhausted(bool exhausted) { budget_exhausted_ = exhausted; }
+
+  // True if the walk stopped early because it used up its StackwalkBudget,
+  // so the outermost frames may be missing.
+  bool budget_exhausted() const { return budget_exhausted_; }
+
  private:
   // Stackwalker is responsible for building the frames_ vector.
+  // MinidumpProcessor fills it when reusing another thread's walk.
   friend class Stackwalker;
+  friend class MinidumpProcessor;
 
   // Storage for pushed frames.
   vector<StackFrame*> frames_;
 
+  // Where the frames allocated with AllocateFrame are carved from, created
+  // along with the first of them.
+  Arena* frame_pool_;
+
   // The TID associated with this call stack. Default to 0 if it's not
   // available.
   uint32_t tid_;
+
+  // See duplicate_of().
+  int duplicate_of_;
+
+  // See budget_exhausted().
+  bool budget_exhausted_;
 };
 
 }  // namespace google_breakpad
@@ -36,15 +36,16 @@
 
 #include <stddef.h>
 
+#include <string>
 #include <vector>
 
+#include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
+#include "google_breakpad/processor/code_module.h"
 #include "processor/linked_ptr.h"
 
 namespace google_breakpad {
 
-class CodeModule;
-
 class CodeModules {
  public:
   virtual ~CodeModules() {}
@@ -86,9 +87,25 @@ class CodeModules {
   // comparison with pointers returned by the other Get methods.
   virtual const CodeModule* GetModuleAtIndex(unsigned int index) const = 0;
 
+  // Returns the module lowest in memory whose code_file is |code_file|, or
+  // NULL if there is none.  Ownership of the returned CodeModule is retained
+  // by the CodeModules object.  This implementation visits every module;
+  // implementations that hold many modules should index them instead.
+  virtual const CodeModule* GetModuleForCodeFile(
+      const string& code_file) const {
+    unsigned int count = module_count();
+    for (unsigned int sequence = 0; sequence < count; ++sequence) {
+      const CodeModule* module = GetModuleAtSequence(sequence);
+      if (module && module->code_file() == code_file)
+        return module;
+    }
+    return NULL;
+  }
+
   // Creates a new copy of this CodeModules object, which the caller takes
   // ownership of.  The new object will also contain copies of the existing
-  // object's child CodeModule objects.  The new CodeModules object may be of
+  // object's child CodeModule objects, or share them with the existing object
+  // where they cannot change.  The new CodeModules object may be of
   // a different concrete class than the object being copied, but will behave
   // identically to the copied object as far as the CodeModules and CodeModule
   // interfaces are concerned, except that the order that GetModuleAtIndex
@@ -0,0 +1,136 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// concurrent_source_line_resolver.h: ConcurrentSourceLineResolver is a
+// SourceLineResolverBase that may be shared by several threads, for example
+// the workers of a symbolication service that should all use one warm copy
+// of each symbol file.
+//
+// Loaded modules are kept in a fixed number of shards keyed by the module's
+// code file, each guarded by its own reader/writer lock.  Lookups only hold
+// a shard's lock in shared mode long enough to take a reference to the
+// module, so they do not block each other, and a module that is unloaded
+// while being looked up stays alive until the lookup finishes.  Loading a
+// module holds no lock while parsing.  When several threads load the same
+// module at once, one of them parses it and the others wait for its result.
+//
+// The modules themselves are the ones used by BasicSourceLineResolver or
+// FastSourceLineResolver, selected at construction.  Modules are kept in
+// the shards rather than in SourceLineResolverBase's module map, so
+// set_module_cache_budget() and module_cache_stats() do not apply here;
+// HottestModules() and ModuleMemoryUsages() do.
+//
+// See "google_breakpad/processor/source_line_resolver_interface.h" for more
+// documentation.
+
+#ifndef GOOGLE_BREAKPAD_PROCESSOR_CONCURRENT_SOURCE_LINE_RESOLVER_H__
+#define GOOGLE_BREAKPAD_PROCESSOR_CONCURRENT_SOURCE_LINE_RESOLVER_H__
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/source_line_resolver_base.h"
+
+namespace google_breakpad {
+
+class ConcurrentSourceLineResolver : public SourceLineResolverBase {
+ public:
+  enum ModuleType {
+    // Parse text symbol files, as BasicSourceLineResolver does, into
+    // frozen modules (see BasicSourceLineResolver::set_freeze_modules).
+    kBasicModules,
+    // Load serialized modules, as FastSourceLineResolver does.
+    kFastModules,
+  };
+
+  explicit ConcurrentSourceLineResolver(ModuleType module_type = kBasicModules);
+  virtual ~ConcurrentSourceLineResolver();
+
+  // Unlike the other resolvers, the LoadModule* methods return true if
+  // |module| was already loaded, or was loaded by another thread while this
+  // call waited for it, since the symbols are then available either way.
+  virtual bool LoadModule(const CodeModule* module, const string& map_file);
+  virtual bool LoadModuleUsingMapBuffer(const CodeModule* module,
+                                        const string& map_buffer);
+  virtual bool LoadModuleUsingMemoryBuffer(const CodeModule* module,
+                                           char* memory_buffer,
+                                           size_t memory_buffer_size);
+  virtual bool ShouldDeleteMemoryBufferAfterLoadModule();
+  virtual void UnloadModule(const CodeModule* module);
+  virtual bool HasModule(const CodeModule* module);
+  virtual bool IsModuleCorrupt(const CodeModule* module);
+  virtual void FillSourceLineInfo(
+      StackFrame* frame,
+      std::deque<std::unique_ptr<StackFrame>>* inlined_frames);
+  virtual void FillSourceLineInfoWithInlineRecords(StackFrame* frame);
+  virtual bool ExpandInlineFrames(
+      const StackFrame& frame,
+      std::deque<std::unique_ptr<StackFrame>>* inlined_frames);
+  virtual WindowsFrameInfo* FindWindowsFrameInfo(const StackFrame* frame);
+  virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame);
+  virtual std::vector<ModuleHits> HottestModules(size_t max_count);
+  virtual std::vector<ModuleMemoryUsage> ModuleMemoryUsages();
+
+  // The number of shards the loaded modules are spread across.
+  static const int kShardCount = 16;
+
+ private:
+  // A loaded module, together with the symbol buffer it refers to if the
+  // resolver owns one.  Defined in the .cc file.
+  struct LoadedModule;
+  // One shard of the module map.  Defined in the .cc file.
+  class ModuleShard;
+
+  ModuleShard* ShardFor(const string& code_file) const;
+
+  // Returns the loaded module for |module|, or an empty pointer.  The
+  // returned reference keeps the module alive even if it is unloaded.
+  std::shared_ptr<LoadedModule> FindModule(const CodeModule* module) const;
+
+  // Loads |memory_buffer| as the symbols for |module|.  If |owned_buffer| is
+  // true, the resolver takes ownership of |memory_buffer| and deletes it
+  // when it is no longer needed.
+  bool LoadModuleInternal(const CodeModule* module,
+                          char* memory_buffer,
+                          size_t memory_buffer_size,
+                          bool owned_buffer);
+
+  const ModuleType module_type_;
+  ModuleShard* shards_;
+
+  // Disallow unwanted copy ctor and assignment operator
+  ConcurrentSourceLineResolver(const ConcurrentSourceLineResolver&);
+  void operator=(const ConcurrentSourceLineResolver&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // GOOGLE_BREAKPAD_PROCESSOR_CONCURRENT_SOURCE_LINE_RESOLVER_H__
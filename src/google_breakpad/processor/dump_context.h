@@ -72,6 +72,22 @@ class DumpContext : public DumpObject {
   // pointer for all CPU architectures.
   bool GetStackPointer(uint64_t* sp) const;
 
+  // The CPU type and the registers that processing looks at for every
+  // thread, read out of the CPU-specific context together.
+  struct Registers {
+    // As returned by GetContextCPU.
+    uint32_t cpu;
+    // The size of the CPU's pointers, and so of its stack slots.
+    size_t pointer_size;
+    uint64_t instruction_pointer;
+    uint64_t stack_pointer;
+  };
+
+  // Fills |registers| from the context, switching on the CPU type once,
+  // for callers that need more than one of them.  Returns false if the
+  // context is invalid or its CPU type unknown.
+  bool GetRegisters(Registers* registers) const;
+
   // Print a human-readable representation of the object to stdout.
   void Print();
 
@@ -59,6 +59,8 @@ class FastSourceLineResolver : public SourceLineResolverBase {
   virtual ~FastSourceLineResolver() { }
 
   using SourceLineResolverBase::FillSourceLineInfo;
+  using SourceLineResolverBase::FillSourceLineInfoWithInlineRecords;
+  using SourceLineResolverBase::ExpandInlineFrames;
   using SourceLineResolverBase::FindCFIFrameInfo;
   using SourceLineResolverBase::FindWindowsFrameInfo;
   using SourceLineResolverBase::HasModule;
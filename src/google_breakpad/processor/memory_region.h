@@ -38,6 +38,8 @@
 #define GOOGLE_BREAKPAD_PROCESSOR_MEMORY_REGION_H__
 
 
+#include <stddef.h>
+
 #include "google_breakpad/common/breakpad_types.h"
 
 
@@ -67,8 +69,49 @@ class MemoryRegion {
   virtual bool GetMemoryAtAddress(uint64_t address, uint32_t* value) const = 0;
   virtual bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const = 0;
 
+  // Bulk access to count consecutive values starting at address, for
+  // callers such as stack scanners that read many words in a row.  This
+  // behaves like count calls to GetMemoryAtAddress, storing the values in
+  // the array pointed to by values, but checks the bounds of the whole
+  // range once.  Returns false if any part of the range is out of the
+  // region's bounds.  The default implementations make the individual
+  // GetMemoryAtAddress calls; subclasses with direct access to their
+  // contents should override them.
+  virtual bool GetMemoryArrayAtAddress(uint64_t address, uint32_t* values,
+                                       size_t count) const {
+    return GetMemoryArrayAtAddressInternal(address, values, count);
+  }
+  virtual bool GetMemoryArrayAtAddress(uint64_t address, uint64_t* values,
+                                       size_t count) const {
+    return GetMemoryArrayAtAddressInternal(address, values, count);
+  }
+
   // Print a human-readable representation of the object to stdout.
   virtual void Print() const = 0;
+
+ protected:
+  // Returns true if count values of type T starting at address lie within
+  // the region.
+  template<typename T>
+  bool ContainsArray(uint64_t address, size_t count) const {
+    uint64_t base = GetBase();
+    uint64_t size = GetSize();
+    return address >= base && address - base <= size &&
+           count <= (size - (address - base)) / sizeof(T);
+  }
+
+ private:
+  template<typename T>
+  bool GetMemoryArrayAtAddressInternal(uint64_t address, T* values,
+                                       size_t count) const {
+    if (!ContainsArray<T>(address, count))
+      return false;
+    for (size_t i = 0; i < count; ++i) {
+      if (!GetMemoryAtAddress(address + i * sizeof(T), &values[i]))
+        return false;
+    }
+    return true;
+  }
 };
 
 
@@ -58,8 +58,18 @@ class MicrodumpModules : public BasicCodeModules {
   // Takes over ownership of |module|.
   void Add(const CodeModule* module);
 
+  // Takes over ownership of every module in |modules|.  Adding many
+  // modules at once is cheaper than one at a time, since the address
+  // index is rebuilt once.
+  void Add(const std::vector<const CodeModule*>& modules);
+
   // Enables/disables module address range shrink.
   void SetEnableModuleShrink(bool is_enabled);
+
+ private:
+  // Stores |module| in map_, taking over ownership of it, without
+  // updating the index.
+  void StoreModule(const CodeModule* module);
 };
 
 // MicrodumpContext carries a CPU-specific context.
@@ -82,8 +92,9 @@ class MicrodumpMemoryRegion : public MemoryRegion {
 
   // Set this region's address and contents. If we have placed an
   // instance of this class in a test fixture class, individual tests
-  // can use this to provide the region's contents.
-  void Init(uint64_t base_address, const std::vector<uint8_t>& contents);
+  // can use this to provide the region's contents.  Pass |contents| with
+  // std::move to hand over its buffer without a copy.
+  void Init(uint64_t base_address, std::vector<uint8_t> contents);
 
   virtual uint64_t GetBase() const;
   virtual uint32_t GetSize() const;
@@ -92,6 +103,10 @@ class MicrodumpMemoryRegion : public MemoryRegion {
   virtual bool GetMemoryAtAddress(uint64_t address, uint16_t* value) const;
   virtual bool GetMemoryAtAddress(uint64_t address, uint32_t* value) const;
   virtual bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const;
+  virtual bool GetMemoryArrayAtAddress(uint64_t address, uint32_t* values,
+                                       size_t count) const;
+  virtual bool GetMemoryArrayAtAddress(uint64_t address, uint64_t* values,
+                                       size_t count) const;
 
   // Print a human-readable representation of the object to stdout.
   virtual void Print() const;
@@ -102,6 +117,12 @@ class MicrodumpMemoryRegion : public MemoryRegion {
   template<typename ValueType>
   bool GetMemoryLittleEndian(uint64_t address, ValueType* value) const;
 
+  // Like GetMemoryLittleEndian, but fetches COUNT consecutive values into
+  // VALUES.
+  template<typename ValueType>
+  bool GetMemoryArrayLittleEndian(uint64_t address, ValueType* values,
+                                  size_t count) const;
+
   uint64_t base_address_;
   std::vector<uint8_t> contents_;
 };
@@ -114,6 +135,8 @@ class Microdump {
   virtual ~Microdump() {}
 
   DumpContext* GetContext() { return context_.get(); }
+  // The crashing thread's stack.  If the microdump holds a filtered stack,
+  // the words that were left out of it read as zeros.
   MicrodumpMemoryRegion* GetMemory() { return stack_region_.get(); }
   MicrodumpModules* GetModules() { return modules_.get(); }
   SystemInfo* GetSystemInfo() { return system_info_.get(); }
@@ -32,7 +32,14 @@
 #ifndef GOOGLE_BREAKPAD_PROCESSOR_MICRODUMP_PROCESSOR_H__
 #define GOOGLE_BREAKPAD_PROCESSOR_MICRODUMP_PROCESSOR_H__
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/process_result.h"
@@ -58,6 +65,82 @@ class MicrodumpProcessor {
   StackFrameSymbolizer* frame_symbolizer_;
 };
 
+// Processes the microdumps found in a stream of log output, such as that of
+// "adb logcat", for as long as it runs.  Every microdump is processed
+// against one StackFrameSymbolizer, so symbols loaded for one are there for
+// the next, and the results are handed to a callback in stream order.
+class MicrodumpStreamProcessor {
+ public:
+  // Receives each microdump's result.  |index| counts the microdumps from
+  // 0 in stream order, and |contents| holds its log lines.  Called on one
+  // thread at a time.
+  typedef std::function<void(size_t index, const string& contents,
+                             ProcessResult result,
+                             const ProcessState& process_state)>
+      ResultCallback;
+
+  // Does not take ownership of |frame_symbolizer|, which must NOT be NULL.
+  // With |worker_count| above 1, that many microdumps are processed at
+  // once, and the symbolizer's resolver must be safe to share across
+  // threads, as ConcurrentSourceLineResolver is.  Otherwise each microdump
+  // is processed, and |callback| called, on the thread that completes it.
+  MicrodumpStreamProcessor(StackFrameSymbolizer* frame_symbolizer,
+                           int worker_count,
+                           ResultCallback callback);
+
+  // Calls Finish().
+  ~MicrodumpStreamProcessor();
+
+  // Adds one line of log output, without its line terminator.  A line that
+  // ends a microdump queues it for processing.  Blocks while twice
+  // |worker_count| microdumps are already waiting for their callbacks.
+  void AddLine(const string& line);
+
+  // Queues the whole contents of one microdump.  Blocks as AddLine does.
+  void AddMicrodump(const string& contents);
+
+  // Waits until every queued microdump has been handed to the callback.
+  // A microdump that was begun but not ended is dropped.  More lines may be
+  // added afterwards.
+  void Finish();
+
+  // The number of microdumps queued so far.
+  size_t microdump_count() const { return next_index_; }
+
+ private:
+  // One microdump, from being queued to being handed to the callback.
+  struct Job;
+
+  // Runs on each worker thread.
+  void RunWorker();
+
+  // Hands finished jobs at the front of |unreported_| to the callback.
+  // Called with |mutex_| held by |lock|, which is released around the
+  // callback.
+  void ReportJobs(std::unique_lock<std::mutex>* lock);
+
+  StackFrameSymbolizer* frame_symbolizer_;
+  const int worker_count_;
+  ResultCallback callback_;
+
+  // The lines of the microdump being read, while |in_microdump_|.
+  bool in_microdump_;
+  string contents_;
+  size_t next_index_;
+
+  // Jobs move from |pending_| to the workers, and are reported in the
+  // order they appear in |unreported_|.  |reporting_| is set while a
+  // thread is calling the callback, so that reports stay in order.
+  std::mutex mutex_;
+  std::condition_variable pending_ready_;
+  std::condition_variable job_reported_;
+  std::deque<Job*> pending_;
+  std::deque<std::unique_ptr<Job> > unreported_;
+  bool reporting_;
+  bool stopping_;
+  std::vector<std::thread> workers_;
+};
+
 }  // namespace google_breakpad
 
 #endif  // GOOGLE_BREAKPAD_PROCESSOR_MICRODUMP_PROCESSOR_H__
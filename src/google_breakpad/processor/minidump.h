@@ -87,6 +87,7 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "common/using_std_string.h"
@@ -214,7 +215,8 @@ class MinidumpMemoryRegion : public MinidumpObject,
 
   // Returns a pointer to the base of the memory region.  Returns the
   // cached value if available, otherwise, reads the minidump file and
-  // caches the memory region.
+  // caches the memory region.  If the minidump is held in memory, the
+  // returned pointer points into the minidump data and nothing is copied.
   const uint8_t* GetMemory() const;
 
   // The address of the base of the memory region.
@@ -226,11 +228,19 @@ class MinidumpMemoryRegion : public MinidumpObject,
   // Frees the cached memory region, if cached.
   void FreeMemory();
 
-  // Obtains the value of memory at the pointer specified by address.
+  // Obtains the value of memory at the pointer specified by address.  If
+  // the region's memory has not been read whole by GetMemory, and the
+  // minidump is not held in memory, only the pages holding the value are
+  // read, through the minidump's page cache.  See
+  // Minidump::set_page_cache_budget.
   bool GetMemoryAtAddress(uint64_t address, uint8_t* value) const override;
   bool GetMemoryAtAddress(uint64_t address, uint16_t* value) const override;
   bool GetMemoryAtAddress(uint64_t address, uint32_t* value) const override;
   bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const override;
+  bool GetMemoryArrayAtAddress(uint64_t address, uint32_t* values,
+                               size_t count) const override;
+  bool GetMemoryArrayAtAddress(uint64_t address, uint64_t* values,
+                               size_t count) const override;
 
   // Print a human-readable representation of the object to stdout.
   void Print() const override;
@@ -242,15 +252,28 @@ class MinidumpMemoryRegion : public MinidumpObject,
  private:
   friend class MinidumpThread;
   friend class MinidumpMemoryList;
+  friend class MinidumpMemory64List;
 
   // Identify the base address and size of the memory region, and the
   // location it may be found in the minidump file.
   void SetDescriptor(MDMemoryDescriptor* descriptor);
+  void SetRange(uint64_t base, uint32_t size, uint64_t rva);
+
+  // Copies |count| bytes at |offset| within the region into |bytes|, from
+  // the memory that GetMemory returns if it is held or the minidump is in
+  // memory, and otherwise through the minidump's page cache.
+  bool CopyMemory(uint32_t offset, void* bytes, size_t count) const;
 
   // Implementation for GetMemoryAtAddress
   template<typename T> bool GetMemoryAtAddressInternal(uint64_t address,
                                                        T*        value) const;
 
+  // Implementation for GetMemoryArrayAtAddress
+  template<typename T> bool GetMemoryArrayAtAddressInternal(uint64_t address,
+                                                            T*       values,
+                                                            size_t   count)
+      const;
+
   // Knobs for controlling display of memory printing.
   bool hexdump_;
   unsigned int hexdump_width_;
@@ -259,11 +282,18 @@ class MinidumpMemoryRegion : public MinidumpObject,
   static uint32_t max_bytes_;
 
   // Base address and size of the memory region, and its position in the
-  // minidump file.
-  MDMemoryDescriptor* descriptor_;
+  // minidump file, which may be past 4GB for a region of a
+  // MinidumpMemory64List.
+  uint64_t base_;
+  uint32_t size_;
+  uint64_t rva_;
 
   // Cached memory.
   mutable vector<uint8_t>* memory_;
+
+  // Memory within the minidump's own data, used instead of memory_ when
+  // the minidump is held in memory.
+  mutable const uint8_t* mapped_memory_;
 };
 
 
@@ -337,8 +367,8 @@ class MinidumpThreadList : public MinidumpStream {
   // Sequential access to threads.
   virtual MinidumpThread* GetThreadAtIndex(unsigned int index) const;
 
-  // Random access to threads.
-  MinidumpThread* GetThreadByID(uint32_t thread_id);
+  // Random access to threads.  Returns NULL if no thread has |thread_id|.
+  MinidumpThread* GetThreadByID(uint32_t thread_id) const;
 
   // Print a human-readable representation of the object to stdout.
   void Print();
@@ -349,7 +379,7 @@ class MinidumpThreadList : public MinidumpStream {
  private:
   friend class Minidump;
 
-  typedef map<uint32_t, MinidumpThread*> IDToThreadMap;
+  typedef std::unordered_map<uint32_t, MinidumpThread*> IDToThreadMap;
   typedef vector<MinidumpThread> MinidumpThreads;
 
   static const uint32_t kStreamType = MD_THREAD_LIST_STREAM;
@@ -429,6 +459,10 @@ class MinidumpThreadNameList : public MinidumpStream {
   // Sequential access to thread names.
   virtual MinidumpThreadName* GetThreadNameAtIndex(unsigned int index) const;
 
+  // Random access to thread names.  Returns NULL if no thread name has
+  // |thread_id|; if several do, the first one is returned.
+  MinidumpThreadName* GetThreadNameByID(uint32_t thread_id) const;
+
   // Print a human-readable representation of the object to stdout.
   void Print();
 
@@ -438,12 +472,17 @@ class MinidumpThreadNameList : public MinidumpStream {
  private:
   friend class Minidump;
 
+  typedef std::unordered_map<uint32_t, MinidumpThreadName*>
+      IDToThreadNameMap;
   typedef vector<MinidumpThreadName> MinidumpThreadNames;
 
   static const uint32_t kStreamType = MD_THREAD_NAME_LIST_STREAM;
 
   bool Read(uint32_t aExpectedSize) override;
 
+  // Access to thread names using the thread ID as the key.
+  IDToThreadNameMap id_to_thread_name_map_;
+
   // The list of thread names.
   MinidumpThreadNames* thread_names_;
   uint32_t thread_name_count_;
@@ -519,9 +558,10 @@ class MinidumpModule : public MinidumpObject,
   explicit MinidumpModule(Minidump* minidump);
 
   // This works like MinidumpStream::Read, but is driven by
-  // MinidumpModuleList.  No size checking is done, because
-  // MinidumpModuleList handles that directly.
-  bool Read();
+  // MinidumpModuleList, which reads and swaps every module's MD_MODULE_SIZE
+  // byte record at once and passes this module's in |raw_module|.  No size
+  // checking is done, because MinidumpModuleList handles that directly.
+  bool Read(const uint8_t* raw_module);
 
   // Reads indirectly-referenced data, including the module name, CodeView
   // record, and miscellaneous debugging record.  This is necessary to allow
@@ -597,6 +637,8 @@ class MinidumpModuleList : public MinidumpStream,
   const MinidumpModule* GetModuleAtSequence(
       unsigned int sequence) const override;
   const MinidumpModule* GetModuleAtIndex(unsigned int index) const override;
+  const MinidumpModule* GetModuleForCodeFile(
+      const string& code_file) const override;
   const CodeModules* Copy() const override;
 
   // Returns a vector of all modules which address ranges needed to be shrunk
@@ -624,13 +666,36 @@ class MinidumpModuleList : public MinidumpStream,
                   uint32_t module_count,
                   bool is_android);
 
+  // Builds ranges_ and code_file_index_ from range_map_, once it is
+  // complete.
+  void IndexModules();
+
   // The largest number of modules that will be read from a minidump.  The
   // default is 1024.
   static uint32_t max_modules_;
 
-  // Access to modules using addresses as the key.
+  // An entry in ranges_, covering addresses [base, high].
+  struct ModuleRange {
+    uint64_t base;
+    uint64_t high;
+    unsigned int module_index;
+
+    // Orders ranges by their high address, for lower_bound.
+    bool operator<(uint64_t address) const { return high < address; }
+  };
+
+  // Access to modules using addresses as the key.  range_map_ resolves
+  // overlapping modules while the list is read; lookups then use ranges_.
   RangeMap<uint64_t, unsigned int>* range_map_;
 
+  // The ranges in range_map_, in address order.  Its index is the
+  // sequence, so lookups by address and by sequence are a binary search and
+  // an array access respectively.
+  vector<ModuleRange> ranges_;
+
+  // The index of the lowest module in ranges_ with each code_file.
+  std::unordered_map<string, unsigned int> code_file_index_;
+
   MinidumpModules* modules_;
   uint32_t module_count_;
 };
@@ -685,8 +750,26 @@ class MinidumpMemoryList : public MinidumpStream {
   // The default is 256.
   static uint32_t max_regions_;
 
-  // Access to memory regions using addresses as the key.
-  RangeMap<uint64_t, unsigned int>* range_map_;
+  // An entry in address_index_, covering addresses [base, end).
+  struct AddressIndexEntry {
+    uint64_t base;
+    uint64_t end;
+    unsigned int region_index;
+
+    bool operator<(const AddressIndexEntry& other) const {
+      return base < other.base;
+    }
+  };
+
+  // Access to memory regions using addresses as the key.  The entries are
+  // sorted by base address and don't overlap, so a lookup is a binary
+  // search over a flat array.
+  vector<AddressIndexEntry> address_index_;
+
+  // The position in address_index_ of the last successful lookup.  Stack
+  // walking tends to look up nearby addresses repeatedly, so this is
+  // checked before searching.
+  mutable size_t last_hit_;
 
   // The list of descriptors.  This is maintained separately from the list
   // of regions, because MemoryRegion doesn't own its MemoryDescriptor, it
@@ -700,6 +783,85 @@ class MinidumpMemoryList : public MinidumpStream {
 };
 
 
+// MinidumpMemory64List contains the memory of a full-memory minidump, such
+// as one written with MiniDumpWithFullMemory on Windows: every committed
+// range of the process, often tens of thousands of ranges and gigabytes of
+// data.  Unlike those of MinidumpMemoryList, the ranges carry no location of
+// their own; their data follows one another from a single base RVA, so each
+// range's position is the base plus the sizes of the ranges before it.
+//
+// Only the range descriptors are read with the stream.  A range's
+// MinidumpMemoryRegion is created when it is first asked for, and reads its
+// data as any region does: a page at a time through the page cache, or
+// straight out of the minidump if it is held in memory (see
+// Minidump::set_use_mmap), so no range is copied whole unless GetMemory is
+// called on it.  A range larger than kMaxRegionBytes is split into several
+// regions, as MemoryRegion sizes are 32 bits.
+class MinidumpMemory64List : public MinidumpStream {
+ public:
+  MinidumpMemory64List(const MinidumpMemory64List&) = delete;
+  void operator=(const MinidumpMemory64List&) = delete;
+  ~MinidumpMemory64List() override;
+
+  // The largest region a range is split into.
+  static const uint32_t kMaxRegionBytes = 0x80000000;
+
+  static void set_max_regions(uint32_t max_regions) {
+    max_regions_ = max_regions;
+  }
+  static uint32_t max_regions() { return max_regions_; }
+
+  unsigned int region_count() const {
+    return valid_ ? static_cast<unsigned int>(regions_.size()) : 0;
+  }
+
+  // Sequential access to memory regions, in the order of the ranges in the
+  // minidump.
+  MinidumpMemoryRegion* GetMemoryRegionAtIndex(unsigned int index);
+
+  // Random access to memory regions.  Returns the region encompassing
+  // the address identified by address.
+  virtual MinidumpMemoryRegion* GetMemoryRegionForAddress(uint64_t address);
+
+  // Print a human-readable representation of the object to stdout.  The
+  // memory itself is not printed.
+  void Print();
+
+ private:
+  friend class Minidump;
+
+  static const uint32_t kStreamType = MD_MEMORY_64_LIST_STREAM;
+
+  explicit MinidumpMemory64List(Minidump* minidump);
+
+  bool Read(uint32_t expected_size) override;
+
+  // The largest number of memory regions that will be read from a minidump.
+  // The default is 1048576.
+  static uint32_t max_regions_;
+
+  // A region of memory, and the position of its data in the minidump file.
+  struct Region {
+    uint64_t base;
+    uint32_t size;
+    uint64_t rva;
+  };
+
+  vector<Region> regions_;
+
+  // The positions in regions_ of the regions, sorted by base address.
+  // Regions don't overlap, so a lookup is a binary search.
+  vector<unsigned int> address_index_;
+
+  // The position in address_index_ of the last successful lookup.
+  size_t last_hit_;
+
+  // The MinidumpMemoryRegion of each region, by position in regions_, or
+  // NULL if it hasn't been asked for.
+  vector<MinidumpMemoryRegion*> region_objects_;
+};
+
+
 // MinidumpException wraps MDRawExceptionStream, which contains information
 // about the exception that caused the minidump to be generated, if the
 // minidump was generated in an exception handler called as a result of an
@@ -1054,6 +1216,10 @@ class MinidumpMemoryInfo : public MinidumpObject {
   // MinidumpMemoryInfoList handles that directly.
   bool Read();
 
+  // Like Read, but takes the already-swapped record from |memory_info|, as
+  // MinidumpMemoryInfoList reads and swaps the whole array at once.
+  bool Read(const MDRawMemoryInfo& memory_info);
+
   MDRawMemoryInfo memory_info_;
 };
 
@@ -1089,8 +1255,21 @@ class MinidumpMemoryInfoList : public MinidumpStream {
   // Access to memory info using addresses as the key.
   RangeMap<uint64_t, unsigned int>* range_map_;
 
+  // Reads the info at index into infos_ if it has not been read yet.
+  // Only needed in lazy parsing mode, where Read doesn't read the infos.
+  bool ReadInfoAtIndex(unsigned int index) const;
+
+  // Populates range_map_ from every info.  Only needed in lazy parsing
+  // mode, where Read doesn't populate it.
+  bool BuildRangeMap() const;
+
   MinidumpMemoryInfos* infos_;
   uint32_t info_count_;
+
+  // The offset of the first MDRawMemoryInfo in the minidump, and whether
+  // range_map_ holds every info.
+  off_t infos_offset_;
+  mutable bool range_map_built_;
 };
 
 // MinidumpLinuxMaps wraps information about a single mapped memory region
@@ -1101,37 +1280,37 @@ class MinidumpLinuxMaps : public MinidumpObject {
   void operator=(const MinidumpLinuxMaps&) = delete;
 
   // The memory address of the base of the mapped region.
-  uint64_t GetBase() const { return valid_ ? region_.start : 0; }
+  uint64_t GetBase() const { return valid_ ? entry_.start : 0; }
   // The size of the mapped region.
-  uint64_t GetSize() const { return valid_ ? region_.end - region_.start : 0; }
+  uint64_t GetSize() const { return valid_ ? entry_.end - entry_.start : 0; }
 
   // The permissions of the mapped region.
   bool IsReadable() const {
-    return valid_ ? region_.permissions & MappedMemoryRegion::READ : false;
+    return valid_ ? entry_.permissions & MappedMemoryRegion::READ : false;
   }
   bool IsWriteable() const {
-    return valid_ ? region_.permissions & MappedMemoryRegion::WRITE : false;
+    return valid_ ? entry_.permissions & MappedMemoryRegion::WRITE : false;
   }
   bool IsExecutable() const {
-    return valid_ ? region_.permissions & MappedMemoryRegion::EXECUTE : false;
+    return valid_ ? entry_.permissions & MappedMemoryRegion::EXECUTE : false;
   }
   bool IsPrivate() const {
-    return valid_ ? region_.permissions & MappedMemoryRegion::PRIVATE : false;
+    return valid_ ? entry_.permissions & MappedMemoryRegion::PRIVATE : false;
   }
 
   // The offset of the mapped region.
-  uint64_t GetOffset() const { return valid_ ? region_.offset : 0; }
+  uint64_t GetOffset() const { return valid_ ? entry_.offset : 0; }
 
   // The major device number.
-  uint8_t GetMajorDevice() const { return valid_ ? region_.major_device : 0; }
+  uint8_t GetMajorDevice() const { return valid_ ? entry_.major_device : 0; }
   // The minor device number.
-  uint8_t GetMinorDevice() const { return valid_ ? region_.minor_device : 0; }
+  uint8_t GetMinorDevice() const { return valid_ ? entry_.minor_device : 0; }
 
   // The inode of the mapped region.
-  uint64_t GetInode() const { return valid_ ? region_.inode : 0; }
+  uint64_t GetInode() const { return valid_ ? entry_.inode : 0; }
 
   // The pathname of the mapped region.
-  const string GetPathname() const { return valid_ ? region_.path : ""; }
+  const string GetPathname() const { return valid_ ? *path_ : ""; }
 
   // Print the contents of this mapping.
   void Print() const;
@@ -1143,8 +1322,11 @@ class MinidumpLinuxMaps : public MinidumpObject {
   // This caller owns the pointer.
   explicit MinidumpLinuxMaps(Minidump* minidump);
 
-  // The memory region struct that this class wraps.
-  MappedMemoryRegion region_;
+  // The memory region that this class wraps. Its path and line are held by
+  // the MinidumpLinuxMapsList.
+  ProcMapsEntry entry_;
+  const string* path_;
+  StringView line_;
 };
 
 // MinidumpLinuxMapsList corresponds to the Linux-exclusive MD_LINUX_MAPS
@@ -1157,7 +1339,9 @@ class MinidumpLinuxMapsList : public MinidumpStream {
   ~MinidumpLinuxMapsList() override;
 
   // Get number of mappings.
-  unsigned int get_maps_count() const { return valid_ ? maps_count_ : 0; }
+  unsigned int get_maps_count() const {
+    return valid_ && ParseMaps() ? maps_count_ : 0;
+  }
 
   // Get mapping at the given memory address. The caller owns the pointer.
   const MinidumpLinuxMaps* GetLinuxMapsForAddress(uint64_t address) const;
@@ -1182,10 +1366,22 @@ class MinidumpLinuxMapsList : public MinidumpStream {
   // This method returns whether the stream was read successfully.
   bool Read(uint32_t expected_size) override;
 
+  // Parses the stream contents into maps_, if not already done.  Read
+  // does this directly except in lazy parsing mode.
+  bool ParseMaps() const;
+
+  // The stream contents, and the mappings parsed from them.
+  mutable string maps_data_;
+  mutable ProcMapsTable maps_table_;
+
   // The list of individual mappings.
-  MinidumpLinuxMappings* maps_;
+  mutable MinidumpLinuxMappings* maps_;
   // The number of mappings.
-  uint32_t maps_count_;
+  mutable uint32_t maps_count_;
+
+  // The location and size of the stream, for ParseMaps.
+  off_t maps_offset_;
+  uint32_t maps_length_;
 };
 
 // MinidumpCrashpadInfo wraps MDRawCrashpadInfo, which is an optional stream in
@@ -1232,12 +1428,49 @@ class MinidumpCrashpadInfo : public MinidumpStream {
   std::map<std::string, std::string> simple_annotations_;
 };
 
+// MinidumpBreadcrumbs wraps the MDRawBreadcrumbList of an
+// MD_BREADCRUMB_STREAM, an optional stream holding the breadcrumbs that
+// the client's threads recorded most recently.
+class MinidumpBreadcrumbs : public MinidumpStream {
+ public:
+  // The breadcrumbs of one thread, oldest first.
+  struct Thread {
+    uint32_t thread_id;
+    // Including the breadcrumbs that were overwritten before the dump.
+    uint64_t recorded_count;
+    std::vector<MDRawBreadcrumb> breadcrumbs;
+  };
+
+  const std::vector<Thread>* threads() const {
+    return valid_ ? &threads_ : nullptr;
+  }
+
+  // Returns the data of |breadcrumb| as text, with bytes that are not
+  // printable ASCII, and backslashes, escaped as \xNN.
+  static string DataToString(const MDRawBreadcrumb& breadcrumb);
+
+  // Print a human-readable representation of the object to stdout.
+  void Print();
+
+ private:
+  friend class Minidump;
+
+  static const uint32_t kStreamType = MD_BREADCRUMB_STREAM;
+
+  explicit MinidumpBreadcrumbs(Minidump* minidump);
+
+  bool Read(uint32_t expected_size);
+
+  std::vector<Thread> threads_;
+};
+
 
 // Minidump is the user's interface to a minidump file.  It wraps MDRawHeader
 // and provides access to the minidump's top-level stream directory.
 class Minidump {
  public:
-  // path is the pathname of a file containing the minidump.
+  // path is the pathname of a file containing the minidump, which may have
+  // been compressed by MinidumpFileWriter::SetCompressed.
   explicit Minidump(const string& path,
                     bool hexdump=false,
                     unsigned int hexdump_width=16);
@@ -1245,6 +1478,11 @@ class Minidump {
   // weak pointer to input, and the caller must ensure that the stream
   // is valid as long as the Minidump object is.
   explicit Minidump(std::istream& input);
+  // data points to size bytes of minidump data already held in memory.
+  // Minidump holds a weak pointer to data, and the caller must ensure that
+  // it remains valid as long as the Minidump object is.  Memory regions are
+  // served directly out of data without being copied.
+  Minidump(const uint8_t* data, size_t size);
 
   Minidump(const Minidump&) = delete;
   void operator=(const Minidump&) = delete;
@@ -1265,6 +1503,50 @@ class Minidump {
   }
   static uint32_t max_string_length() { return max_string_length_; }
 
+  // The size of the pages that MinidumpMemoryRegion reads through the
+  // page cache, counted from the start of each region.
+  static const uint32_t kPageCachePageSize = 4096;
+
+  // Sets the bytes of pages that the page caches of all Minidumps together
+  // may hold before each evicts its least recently used pages, keeping at
+  // least the last page it read.  0 disables the page caches, so that
+  // memory regions are read whole on first access, as GetMemory does.  The
+  // default is 64MB.  Must not be changed while a Minidump is in use.
+  static void set_page_cache_budget(uint64_t budget) {
+    page_cache_budget_ = budget;
+  }
+  static uint64_t page_cache_budget() { return page_cache_budget_; }
+
+  // The bytes of pages that the page caches of all Minidumps now hold.
+  static uint64_t page_cache_bytes();
+
+  // If use_mmap is true, a minidump opened from a path is mapped into
+  // memory instead of being read through an ifstream, and memory regions
+  // point into the mapping instead of being copied.  Falls back to the
+  // ifstream if the file cannot be mapped.  Must be called before Read().
+  // Not supported on Windows, where it has no effect.
+  void set_use_mmap(bool use_mmap) { use_mmap_ = use_mmap; }
+
+  // If readahead is true, a minidump opened from a path asks the kernel to
+  // start reading all of its streams as soon as Read() has found them in
+  // the directory, and the stacks of all threads once the thread list is
+  // read, so that the reads that follow find the data already in the page
+  // cache instead of each waiting on the storage.  Has no effect on
+  // compressed minidumps, or where the system has no posix_fadvise.
+  void set_readahead(bool readahead) { readahead_ = readahead; }
+  bool readahead() const { return readahead_; }
+
+  // Asks the kernel to start reading the first kPrefetchBytes of the
+  // minidump file at |path| into the page cache, without waiting for it,
+  // such as for the next minidump of a batch while the current one is
+  // processed.
+  static const size_t kPrefetchBytes = 4 * 1024 * 1024;
+  static void Prefetch(const string& path);
+
+  // True if the minidump data is held in memory, either because it was
+  // provided as a buffer or because it was mapped by Open.
+  bool IsInMemory() const { return data_ != nullptr; }
+
   virtual const MDRawHeader* header() const {
     return valid_ ? &header_ : nullptr;
   }
@@ -1283,6 +1565,13 @@ class Minidump {
   // The minidump is expected to be positioned at the beginning of the
   // header.  Read() sets up the stream list and map, and validates the
   // Minidump object.
+  //
+  // Once a Read() has succeeded, later calls return true without reading
+  // anything, keeping the streams already parsed.  One Minidump can then
+  // be handed to several consumers in turn, such as MinidumpProcessor and
+  // the Print methods, each of which calls Read() and the stream getters,
+  // and each stream is decoded only once.  A Minidump is not safe to use
+  // from several threads at once.
   virtual bool Read();
 
   // The next set of methods are stubs that call GetStream.  They exist to
@@ -1293,6 +1582,7 @@ class Minidump {
   virtual MinidumpThreadNameList* GetThreadNameList();
   virtual MinidumpModuleList* GetModuleList();
   virtual MinidumpMemoryList* GetMemoryList();
+  virtual MinidumpMemory64List* GetMemory64List();
   virtual MinidumpException* GetException();
   virtual MinidumpAssertion* GetAssertion();
   virtual MinidumpSystemInfo* GetSystemInfo();
@@ -1301,10 +1591,22 @@ class Minidump {
   virtual MinidumpBreakpadInfo* GetBreakpadInfo();
   virtual MinidumpMemoryInfoList* GetMemoryInfoList();
   MinidumpCrashpadInfo* GetCrashpadInfo();
+  MinidumpBreadcrumbs* GetBreadcrumbs();
 
   // The next method also calls GetStream, but is exclusive for Linux dumps.
   virtual MinidumpLinuxMapsList* GetLinuxMapsList();
 
+  // Returns the memory region holding |address|, from the memory list, or
+  // failing that, from the full-memory list.  Returns NULL if neither
+  // holds it.
+  MinidumpMemoryRegion* GetMemoryRegionForAddress(uint64_t address);
+
+  // Deletes the parsed stream of |stream_type|, an MD_*_STREAM value, if
+  // it has been read, to give back its memory.  The next getter call for
+  // the stream reads it again.  Pointers to the stream, and to objects it
+  // owns such as threads and memory regions, are invalid afterwards.
+  void ReleaseStream(uint32_t stream_type);
+
   // The next set of methods are provided for users who wish to access
   // data in minidump files directly, while leveraging the rest of
   // this class and related classes to handle the basic minidump
@@ -1328,6 +1630,23 @@ class Minidump {
   // Returns the current position of the minidump file.
   off_t Tell();
 
+  // If readahead is set, asks the kernel to start reading each of
+  // |locations| in the minidump file, in one batch.  See set_readahead.
+  void ReadAhead(const vector<MDLocationDescriptor>& locations);
+
+  // Returns a pointer to count bytes at offset within the minidump data,
+  // without copying them.  Returns NULL if the minidump is not held in
+  // memory (see IsInMemory) or if the range is out of bounds.  The data is
+  // raw: it is not byte-swapped for other-endian minidumps.
+  const uint8_t* GetDataAtOffset(off_t offset, size_t count) const;
+
+  // Returns a pointer to count bytes at offset within the minidump, as
+  // GetDataAtOffset does, but read through the page cache of this
+  // Minidump if it is not held in memory, with offset as the key of the
+  // page.  The pointer remains valid until the next call.  Returns NULL
+  // if the bytes cannot be read.  Moves the file position.
+  const uint8_t* ReadCachedPage(off_t offset, size_t count);
+
   // Medium-level I/O routines.
 
   // ReadString returns a string which is owned by the caller!  offset
@@ -1335,6 +1654,11 @@ class Minidump {
   // minidump file.
   string* ReadString(off_t offset);
 
+  // Reads the length-encoded string at offset into string_utf8, reusing its
+  // storage.  Returns false if the string cannot be read or is not valid
+  // UTF-16.
+  bool ReadString(off_t offset, string* string_utf8);
+
   bool ReadUTF8String(off_t offset, string* string_utf8);
 
   bool ReadStringList(off_t offset, std::vector<std::string>* string_list);
@@ -1378,12 +1702,21 @@ class Minidump {
   // Get current hexdump display settings.
   unsigned int HexdumpMode() const { return hexdump_ ? hexdump_width_ : 0; }
 
+  // If lazy_parsing is true, streams with many records, such as
+  // MinidumpMemoryInfoList and MinidumpLinuxMapsList, validate only their
+  // headers when read, and decode individual records as they're accessed.
+  // Problems with individual records are then reported by the accessors
+  // instead of failing the stream as a whole.
+  void set_lazy_parsing(bool lazy_parsing) { lazy_parsing_ = lazy_parsing; }
+  bool lazy_parsing() const { return lazy_parsing_; }
+
  private:
   // MinidumpStreamInfo is used in the MinidumpStreamMap.  It lets
   // the Minidump object locate interesting streams quickly, and
   // provides a convenient place to stash MinidumpStream objects.
   struct MinidumpStreamInfo {
-    MinidumpStreamInfo() : stream_index(0), stream(nullptr) {}
+    MinidumpStreamInfo()
+        : stream_index(0), stream(nullptr), read_failed(false) {}
     ~MinidumpStreamInfo() { delete stream; }
 
     // Index into the MinidumpDirectoryEntries vector
@@ -1391,6 +1724,10 @@ class Minidump {
 
     // Pointer to the stream if cached, or NULL if not yet populated
     MinidumpStream* stream;
+
+    // True if the stream could not be read, so that GetStream does not
+    // try again each time it is asked for.
+    bool            read_failed;
   };
 
   typedef vector<MDRawDirectory> MinidumpDirectoryEntries;
@@ -1401,6 +1738,14 @@ class Minidump {
   // Opens the minidump file, or if already open, seeks to the beginning.
   bool Open();
 
+  // Maps the file at path_ into memory, setting data_ and data_size_.
+  // Returns false if the file cannot be mapped.
+  bool MapFile();
+
+  // The pages of memory regions read by ReadCachedPage, least recently
+  // used last.  Defined in minidump.cc.
+  class PageCache;
+
   // The largest number of top-level streams that will be read from a minidump.
   // Note that streams are only read (and only consume memory) as needed,
   // when directed by the caller.  The default is 128.
@@ -1412,6 +1757,9 @@ class Minidump {
   // by as many as 3 bytes in UTF-8.
   static unsigned int max_string_length_;
 
+  // See set_page_cache_budget.
+  static uint64_t page_cache_budget_;
+
   MDRawHeader               header_;
 
   // The list of streams.
@@ -1428,6 +1776,27 @@ class Minidump {
   // Set based on the path in Open, or directly in the constructor.
   std::istream*             stream_;
 
+  // When Open finds that path_ holds a minidump compressed by
+  // MinidumpFileWriter, the file and the BlockGzipReader that decompresses
+  // it for stream_.
+  std::istream*             compressed_file_;
+  std::streambuf*           decompressor_;
+
+  // Minidump data held in memory, if any.  When data_ is set, ReadBytes,
+  // SeekSet and Tell operate on data_position_ instead of stream_.  data_
+  // is either provided by the caller or mapped by MapFile, in which case
+  // data_mapped_ is true and the mapping is released by the destructor.
+  const uint8_t*            data_;
+  size_t                    data_size_;
+  size_t                    data_position_;
+  bool                      data_mapped_;
+
+  // Whether Open should try to map path_ into memory.  See set_use_mmap.
+  bool                      use_mmap_;
+
+  // Whether to read streams and stacks ahead.  See set_readahead.
+  bool                      readahead_;
+
   // swap_ is true if the minidump file should be byte-swapped.  If the
   // minidump was produced by a CPU that is other-endian than the CPU
   // processing the minidump, this will be true.  If the two CPUs are
@@ -1445,6 +1814,16 @@ class Minidump {
   // Knobs for controlling display of memory printing.
   bool                      hexdump_;
   unsigned int              hexdump_width_;
+
+  // Whether streams defer decoding their records.  See set_lazy_parsing.
+  bool                      lazy_parsing_;
+
+  // Created by the first ReadCachedPage.
+  PageCache*                page_cache_;
+
+  // Holds the UTF-16 data of each string read by ReadString when the
+  // minidump is not held in memory.
+  std::vector<uint8_t>      string_buffer_;
 };
 
 
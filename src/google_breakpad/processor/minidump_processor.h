@@ -30,21 +30,113 @@
 #define GOOGLE_BREAKPAD_PROCESSOR_MINIDUMP_PROCESSOR_H__
 
 #include <assert.h>
+#include <set>
 #include <string>
 
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
 #include "google_breakpad/processor/process_result.h"
+#include "google_breakpad/processor/stackwalk_budget.h"
 
 namespace google_breakpad {
 
 class Minidump;
+class MissingSymbolsCache;
+class ProcessObserver;
 class ProcessState;
 class StackFrameSymbolizer;
 class SourceLineResolverInterface;
 class SymbolSupplier;
 struct SystemInfo;
 
+// The settings that control how much work MinidumpProcessor::Process does
+// for a minidump.  A processor keeps one set, changed through its set_*
+// methods, and Process can also be given a set for a single minidump, so
+// that one processor can give some minidumps a full analysis and only walk
+// the stacks of others.
+struct ProcessingOptions {
+  ProcessingOptions();
+
+  // Clears the flags for the analyses that follow the stack walks, leaving
+  // only the walks themselves: exploitability rating and the use of
+  // objdump.
+  void DisableAnalysis();
+
+  // Sets the options for the least work that still yields a crash
+  // signature: only the requesting thread is walked, or the highest-ranked
+  // thread of a minidump that names none, to at most |frame_count| frames,
+  // counting inlined ones.  Symbols are not prefetched, so only the modules
+  // those frames reach have theirs loaded, and the analyses are disabled.
+  void EnableSignatureMode(int frame_count);
+
+  // Enables the exploitability scanner, which attempts to guess how likely
+  // it is that the crash represents an exploitable memory corruption
+  // issue.  Defaults to false.
+  bool enable_exploitability;
+
+  // Permits shelling out to objdump for purposes of disassembly during
+  // normal crash processing, but not during exploitability analysis.
+  // Defaults to false.
+  bool enable_objdump;
+
+  // Permits the exploitability scanner to shell out to objdump for
+  // purposes of disassembly.  This results in significantly more overhead
+  // than enable_objdump.  Defaults to false.
+  bool enable_objdump_for_exploitability;
+
+  // The maximum number of threads to process.  This can be exceeded if the
+  // requesting thread comes after the limit.  -1, the default, means no
+  // limit.
+  int max_thread_count;
+
+  // Chooses the threads processed under max_thread_count by rank rather
+  // than by their order in the minidump.  See
+  // MinidumpProcessor::set_prioritize_threads.  Defaults to false.
+  bool prioritize_threads;
+
+  // The modules whose code a thread is taken to be idle in when its
+  // instruction pointer is there.  See MinidumpProcessor::set_idle_modules.
+  std::set<string> idle_modules;
+
+  // The number of threads used to walk stacks.  See
+  // MinidumpProcessor::set_stackwalk_worker_count.  Defaults to 1.
+  int stackwalk_worker_count;
+
+  // Reuses walks between identical thread stacks.  See
+  // MinidumpProcessor::set_deduplicate_stacks.  Defaults to false.
+  bool deduplicate_stacks;
+
+  // Fetches all symbols before walking.  See
+  // MinidumpProcessor::set_prefetch_symbols.  Defaults to false.
+  bool prefetch_symbols;
+
+  // Fetches the symbols the requesting thread needs before walking.  See
+  // MinidumpProcessor::set_prefetch_requesting_thread_symbols.  Defaults to
+  // false.
+  bool prefetch_requesting_thread_symbols;
+
+  // Fills the frames' source line info once every stack is walked.  See
+  // MinidumpProcessor::set_defer_source_line_info.  Defaults to false.
+  bool defer_source_line_info;
+
+  // Limits the work done walking stacks.  See
+  // MinidumpProcessor::set_stackwalk_limits.  Defaults to no limits.
+  StackwalkLimits stackwalk_limits;
+
+  // Records where the time and work of processing went.  See
+  // MinidumpProcessor::set_collect_stats.  Defaults to false.
+  bool collect_stats;
+
+  // Has the ProcessState refer to the Minidump's module lists rather than
+  // copy them.  See MinidumpProcessor::set_borrow_modules.  Defaults to
+  // false.
+  bool borrow_modules;
+
+  // Bounds the minidump data held in memory while processing, in bytes.
+  // See MinidumpProcessor::set_memory_limit.  Defaults to 0, no limit.
+  uint64_t memory_limit;
+};
+
 class MinidumpProcessor {
  public:
   // Initializes this MinidumpProcessor.  supplier should be an
@@ -73,9 +165,25 @@ class MinidumpProcessor {
                         ProcessState* process_state);
 
   // Processes the minidump structure and fills process_state with the
-  // result.
+  // result.  minidump must have been Read.  The streams parsed here stay
+  // cached in minidump, for whatever else is read from it afterwards.
   ProcessResult Process(Minidump* minidump,
                         ProcessState* process_state);
+
+  // Processes the minidump structure as above, using |options| instead of
+  // this processor's own options.
+  ProcessResult Process(Minidump* minidump,
+                        const ProcessingOptions& options,
+                        ProcessState* process_state);
+
+  // Processes the minidump structure as above, using |options|, and hands
+  // |observer| each part of the result as soon as it is ready.  |observer|
+  // may be NULL.  See ProcessObserver.
+  ProcessResult Process(Minidump* minidump,
+                        const ProcessingOptions& options,
+                        ProcessObserver* observer,
+                        ProcessState* process_state);
+
   // Populates the cpu_* fields of the |info| parameter with textual
   // representations of the CPU type that the minidump in |dump| was
   // produced on.  Returns false if this information is not available in
@@ -129,43 +237,184 @@ class MinidumpProcessor {
   // Sets the flag to enable/disable use of objdump during normal crash
   // processing. This is independent from the flag for use of objdump during
   // exploitability analysis.
-  void set_enable_objdump(bool enabled) { enable_objdump_ = enabled; }
+  void set_enable_objdump(bool enabled) {
+    options_.enable_objdump = enabled;
+  }
 
   // Sets the flag to enable/disable use of objdump during exploitability
   // analysis. This is independent from the flag for use of objdump during
   // normal crash processing.
   void set_enable_objdump_for_exploitability(bool enabled) {
-    enable_objdump_for_exploitability_ = enabled;
+    options_.enable_objdump_for_exploitability = enabled;
   }
 
   // Sets the maximum number of threads to process.
   void set_max_thread_count(int max_thread_count) {
-    max_thread_count_ = max_thread_count;
+    options_.max_thread_count = max_thread_count;
   }
 
+  // Sets the flag to enable/disable choosing which threads to process,
+  // when set_max_thread_count limits them, by ranking them instead of
+  // taking the first ones in the minidump.  The ranking reads only each
+  // thread's registers: the requesting thread comes first, then threads
+  // whose instruction pointer is outside the idle modules, then the idle
+  // ones, each ordered by how much stack they use.  The processed threads
+  // keep their order in the minidump, and when stacks are walked by several
+  // workers, the higher-ranked ones are walked first, so that they take
+  // precedence for set_stackwalk_limits.  The limit then applies even to
+  // minidumps that name no requesting thread.  Defaults to false.
+  void set_prioritize_threads(bool enabled) {
+    options_.prioritize_threads = enabled;
+  }
+
+  // Sets the modules, by file name without directory, that threads blocked
+  // waiting are found in, for set_prioritize_threads.  Defaults to the
+  // system libraries that wrap blocking system calls on Windows, Linux,
+  // Android and macOS.
+  void set_idle_modules(const std::set<string>& modules) {
+    options_.idle_modules = modules;
+  }
+
+  // Sets the number of threads used to walk the minidump's thread stacks.
+  // Values of 1 or less (the default) walk every stack on the calling
+  // thread.  With more workers, stacks are walked concurrently, starting
+  // with the requesting thread, and the results are stored in their
+  // original order.  The StackFrameSymbolizer must be safe to use from
+  // several threads at once; the default implementation is.  The
+  // exploitability rating, which needs only the requesting thread's stack,
+  // runs as soon as that stack is walked, alongside the remaining walks.
+  void set_stackwalk_worker_count(int worker_count) {
+    options_.stackwalk_worker_count = worker_count;
+  }
+
+  // Sets the flag to enable/disable reusing one thread's walk for other
+  // threads whose stacks would walk identically.  Two threads match when
+  // their register contexts and stack memory are equal once every word
+  // that points into the thread's own stack is taken relative to the
+  // stack's base.  The copied frames are moved to the other thread's
+  // stack, and CallStack::duplicate_of() records which thread was walked.
+  // Only x86, amd64, arm and arm64 stacks are matched.  Defaults to false.
+  void set_deduplicate_stacks(bool enabled) {
+    options_.deduplicate_stacks = enabled;
+  }
+
+  // Sets the flag to enable/disable fetching the symbols of every module in
+  // the dump before any stack is walked, instead of one module at a time as
+  // frames reach it.  The requests go through
+  // SymbolSupplier::GetCStringSymbolDataAsync, so a supplier that overrides
+  // it has them all in flight at once.  The modules the requesting thread
+  // most likely runs in are requested first.  Defaults to false.
+  void set_prefetch_symbols(bool enabled) {
+    options_.prefetch_symbols = enabled;
+  }
+
+  // Sets the flag to enable/disable fetching, before any stack is walked,
+  // the symbols of the modules the requesting thread most likely runs in:
+  // the one holding its instruction pointer and those that words at the top
+  // of its stack point into.  They are requested at once, as
+  // set_prefetch_symbols describes, so that the thread's first frames don't
+  // wait behind modules that only other threads reach; other modules are
+  // still fetched as frames reach them.  With set_prefetch_symbols as well,
+  // the other modules are fetched after these, still before walking.
+  // Defaults to false.
+  void set_prefetch_requesting_thread_symbols(bool enabled) {
+    options_.prefetch_requesting_thread_symbols = enabled;
+  }
+
+  // Shares |cache|'s record of modules without symbols with the
+  // StackFrameSymbolizer, so that modules found to have no symbols while
+  // processing one minidump are not requested again for later ones, or by
+  // other processors sharing |cache|.  |cache| is not owned.  See
+  // StackFrameSymbolizer::set_missing_symbols_cache.
+  void set_missing_symbols_cache(MissingSymbolsCache* cache);
+
+  // Names the modules whose callers are unwound by frame pointer before
+  // CFI.  See StackFrameSymbolizer::set_frame_pointer_modules.
+  void set_frame_pointer_modules(const std::set<string>& modules);
+
+  // Records the inlined frames in the frames' inline_records, for
+  // ProcessState::ExpandInlineFrames to construct for the threads that
+  // want them.  See StackFrameSymbolizer::set_lazy_inline_frames.
+  void set_lazy_inline_frames(bool enabled);
+
+  // Limits the stack words scanned, symbolizer calls made and time spent
+  // walking each thread's stack, and all of a minidump's stacks, and the
+  // frames found in each thread's, and stops walks where the stack looks
+  // corrupt.  A thread whose walk reaches a limit keeps the frames found so
+  // far, and its CallStack::budget_exhausted() is set.  See StackwalkLimits
+  // and Stackwalker::ResumeWalk.
+  void set_stackwalk_limits(const StackwalkLimits& limits) {
+    options_.stackwalk_limits = limits;
+  }
+
+  // Sets the flag to enable/disable recording, in a ProcessStats that
+  // ProcessState::stats() returns, the time spent fetching and loading
+  // symbols, walking stacks and rating exploitability, the frames found by
+  // each kind of unwinding, the stack words scanned and the failed reads
+  // of stack memory.  Defaults to false.
+  void set_collect_stats(bool enabled) {
+    options_.collect_stats = enabled;
+  }
+
+  // Sets the flag to enable/disable having the ProcessState refer to the
+  // Minidump's module lists instead of copying every module into it.  The
+  // ProcessState must then not be used once the Minidump is destroyed,
+  // unless ProcessState::CopyModules is called first.  Process given a
+  // filename calls it before returning.  Defaults to false.
+  void set_borrow_modules(bool enabled) {
+    options_.borrow_modules = enabled;
+  }
+
+  // Sets a ceiling, in bytes, on the minidump data that processing holds
+  // in memory, for minidumps too large to process otherwise, such as
+  // full-memory dumps.  Under a limit, the streams that processing is done
+  // with are released from the Minidump (see Minidump::ReleaseStream), and
+  // thread stacks read whole are freed once walked.  Stacks are walked by
+  // several workers only if all of them fit in the limit alongside the
+  // page caches' pages; otherwise each is walked in turn through the page
+  // cache.  Once the page caches hold more than the limit, the remaining
+  // walks scan no stack, and those that needed to report
+  // CallStack::budget_exhausted().  Symbols and the ProcessState are not
+  // counted.  0, the default, means no limit.
+  void set_memory_limit(uint64_t bytes) {
+    options_.memory_limit = bytes;
+  }
+
+  // Sets the flag to enable/disable walking every stack before looking up
+  // any frame's source line info.  The walks still fetch and load the
+  // symbols that unwinding needs, but the frames' functions, source lines
+  // and inlined frames are then looked up all at once, grouped by module
+  // and in order of address, which keeps the lookups in each module's
+  // tables together.  The results are the same, except that the frame
+  // limits count only the frames walked, not their inlined frames.  Ignored
+  // when Process is given an observer, which wants each thread as soon as
+  // it is walked.  Defaults to false.
+  void set_defer_source_line_info(bool enabled) {
+    options_.defer_source_line_info = enabled;
+  }
+
+  // Processes minidumps only as far as a crash signature needs.  See
+  // ProcessingOptions::EnableSignatureMode.
+  void set_signature_mode(int frame_count) {
+    options_.EnableSignatureMode(frame_count);
+  }
+
+  // The options used by Process when it is not given any.
+  const ProcessingOptions& options() const { return options_; }
+  void set_options(const ProcessingOptions& options) { options_ = options; }
+
  private:
+  // Fills the source line info of the frames of |process_state|'s
+  // threads, walked with set_defer_source_line_info, and inserts their
+  // inlined frames.
+  void FillDeferredSourceLineInfo(ProcessState* process_state);
+
   StackFrameSymbolizer* frame_symbolizer_;
   // Indicate whether resolver_helper_ is owned by this instance.
   bool own_frame_symbolizer_;
 
-  // This flag enables the exploitability scanner which attempts to
-  // guess how likely it is that the crash represents an exploitable
-  // memory corruption issue.
-  bool enable_exploitability_;
-
-  // This flag permits the processor to shell out to objdump for purposes of
-  // disassembly during normal crash processing, but not during exploitability
-  // analysis.
-  bool enable_objdump_;
-
-  // This flag permits the exploitability scanner to shell out to objdump for
-  // purposes of disassembly. This results in significantly more overhead than
-  // the enable_objdump_ flag.
-  bool enable_objdump_for_exploitability_;
-
-  // The maximum number of threads to process. This can be exceeded if the
-  // requesting thread comes after the limit. Setting this to -1 means no limit.
-  int max_thread_count_;
+  // See set_options.
+  ProcessingOptions options_;
 };
 
 }  // namespace google_breakpad
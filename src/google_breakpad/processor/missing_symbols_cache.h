@@ -0,0 +1,117 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// missing_symbols_cache.h: MissingSymbolsCache remembers which modules have
+// no usable symbols, so that processing several minidumps does not ask the
+// SymbolSupplier for them over and over.
+//
+// StackFrameSymbolizer already remembers such modules until its next
+// Reset(), that is, for one minidump.  A MissingSymbolsCache lives as long
+// as its owner wants, and may be shared by any number of
+// StackFrameSymbolizers and MinidumpProcessors on any number of threads.
+//
+// Modules are identified by debug file and debug identifier, the same
+// things a SymbolSupplier uses to find their symbol files.  Entries expire
+// after a time-to-live, so that symbols uploaded later are eventually
+// picked up.
+
+#ifndef GOOGLE_BREAKPAD_PROCESSOR_MISSING_SYMBOLS_CACHE_H__
+#define GOOGLE_BREAKPAD_PROCESSOR_MISSING_SYMBOLS_CACHE_H__
+
+#include <stddef.h>
+#include <time.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class CodeModule;
+
+class MissingSymbolsCache {
+ public:
+  // Entries are forgotten |ttl_seconds| after they are added.  At most
+  // |max_entries| modules are remembered; when the cache is full, expired
+  // entries are dropped, and if none are, the oldest ones are.
+  explicit MissingSymbolsCache(time_t ttl_seconds = kDefaultTTLSeconds,
+                               size_t max_entries = kDefaultMaxEntries);
+  virtual ~MissingSymbolsCache() {}
+
+  // Returns true if |module| was recorded as missing symbols within the
+  // time-to-live.
+  bool IsMissing(const CodeModule* module);
+
+  // Records that |module| has no usable symbols.  Modules without a debug
+  // file or identifier are not recorded, since they cannot be told apart.
+  void AddMissing(const CodeModule* module);
+
+  // Forgets |module|, for example after its symbols have been uploaded.
+  void Remove(const CodeModule* module);
+
+  // Forgets every module.
+  void Clear();
+
+  // Returns the number of modules remembered, including expired ones not
+  // yet dropped.
+  size_t size();
+
+  static const time_t kDefaultTTLSeconds = 60 * 60;
+  static const size_t kDefaultMaxEntries = 1 << 16;
+
+ protected:
+  // Returns the current time.  Tests override this.
+  virtual time_t Now() const;
+
+ private:
+  typedef std::pair<string, string> Key;
+
+  // Sets |key| for |module| and returns true if it can be recorded.
+  static bool GetKey(const CodeModule* module, Key* key);
+
+  // Makes room for one more entry.  The caller must hold mutex_.
+  void TrimLocked(time_t now);
+
+  time_t ttl_seconds_;
+  size_t max_entries_;
+
+  // Guards entries_, which maps each module to the time it was added.
+  std::mutex mutex_;
+  std::map<Key, time_t> entries_;
+
+  // Disallow unwanted copy ctor and assignment operator
+  MissingSymbolsCache(const MissingSymbolsCache&);
+  void operator=(const MissingSymbolsCache&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // GOOGLE_BREAKPAD_PROCESSOR_MISSING_SYMBOLS_CACHE_H__
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 
+#include "common/string_view.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
 
@@ -50,11 +51,48 @@ struct MappedMemoryRegion {
   string line;
 };
 
+// A mapped memory region as ParseProcMapsTable() finds it. Rather than
+// copies of its path and line, it holds their place in a ProcMapsTable and
+// in the input.
+struct ProcMapsEntry {
+  uint64_t start;
+  uint64_t end;
+  uint64_t offset;
+  uint64_t inode;
+  uint8_t permissions;  // MappedMemoryRegion::Permission bits
+  uint8_t major_device;
+  uint8_t minor_device;
+
+  // Index of the path in ProcMapsTable::paths.
+  uint32_t path_index;
+
+  // Where the line is in the parsed input.
+  size_t line_offset;
+  size_t line_length;
+};
+
+// The regions of a /proc/<pid>/maps, with each distinct path held once, as
+// most are mapped several times.
+struct ProcMapsTable {
+  std::vector<ProcMapsEntry> entries;
+  std::vector<string> paths;
+
+  void Clear() {
+    entries.clear();
+    paths.clear();
+  }
+};
+
 // Parses /proc/<pid>/maps input data and stores in |regions|. Returns true
 // and updates |regions| if and only if all of |input| was successfully parsed.
 bool ParseProcMaps(const string& input,
                    std::vector<MappedMemoryRegion>* regions);
 
+// Parses /proc/<pid>/maps input data into |table| in a single pass, without
+// copying each line. Returns true and updates |table| if and only if all of
+// |input| was successfully parsed.
+bool ParseProcMapsTable(StringView input, ProcMapsTable* table);
+
 }  // namespace google_breakpad
 
 #endif  // BASE_DEBUG_PROC_MAPS_LINUX_H_
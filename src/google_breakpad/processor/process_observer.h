@@ -0,0 +1,65 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_observer.h: An interface for receiving the results of
+// MinidumpProcessor::Process as they become ready, rather than once the
+// whole minidump has been processed.
+
+#ifndef GOOGLE_BREAKPAD_PROCESSOR_PROCESS_OBSERVER_H__
+#define GOOGLE_BREAKPAD_PROCESSOR_PROCESS_OBSERVER_H__
+
+namespace google_breakpad {
+
+class ProcessState;
+
+// Is handed the parts of a ProcessState as MinidumpProcessor::Process
+// fills them in, so that a caller can show the first threads while the
+// others are still being walked.  The calls are never made concurrently,
+// but when stacks are walked by several workers, they may come from any of
+// the workers.  If Process does not return PROCESS_OK, what was delivered
+// may be incomplete.
+class ProcessObserver {
+ public:
+  virtual ~ProcessObserver() {}
+
+  // Called once, before any thread.  Everything in |process_state| is set
+  // except the threads' stacks, the exploitability rating, the modules
+  // found without symbols and the stats; requesting_thread() is final.
+  virtual void OnProcessInfo(const ProcessState& process_state) = 0;
+
+  // Called as the stack of each thread, at |thread_index| in
+  // process_state.threads(), is complete: the requesting thread first, if
+  // there is one, then the others in order.  The threads after
+  // |thread_index| may not have been walked, or added, yet.
+  virtual void OnThread(const ProcessState& process_state,
+                        int thread_index) = 0;
+};
+
+}  // namespace google_breakpad
+
+#endif  // GOOGLE_BREAKPAD_PROCESSOR_PROCESS_OBSERVER_H__
@@ -50,6 +50,8 @@ using std::vector;
 
 class CallStack;
 class CodeModules;
+class ProcessStats;
+class SourceLineResolverInterface;
 
 enum ExploitabilityRating {
   EXPLOITABILITY_HIGH,                 // The crash likely represents
@@ -91,12 +93,32 @@ enum ExploitabilityRating {
 
 class ProcessState {
  public:
-  ProcessState() : modules_(NULL), unloaded_modules_(NULL) { Clear(); }
+  ProcessState()
+      : modules_(NULL),
+        unloaded_modules_(NULL),
+        modules_borrowed_(false),
+        stats_(NULL) { Clear(); }
   ~ProcessState();
 
   // Resets the ProcessState to its default values
   void Clear();
 
+  // If the module lists are borrowed from the Minidump they were processed
+  // from (see MinidumpProcessor::set_borrow_modules), replaces them with
+  // copies that the ProcessState owns, and points the stack frames and the
+  // lists of modules without symbols at the copies, so that the
+  // ProcessState can outlive the Minidump.  Does nothing otherwise.
+  void CopyModules();
+
+  // True if modules() and unloaded_modules() belong to a Minidump, which
+  // must outlive any use of them.
+  bool modules_borrowed() const { return modules_borrowed_; }
+
+  // Constructs the inlined frames recorded in the frames of every thread
+  // with |resolver|.  See CallStack::ExpandInlineFrames.  Returns false if
+  // some could not be constructed.
+  bool ExpandInlineFrames(SourceLineResolverInterface* resolver);
+
   // Accessors.  See the data declarations below.
   uint32_t time_date_stamp() const { return time_date_stamp_; }
   uint32_t process_create_time() const { return process_create_time_; }
@@ -112,6 +134,9 @@ class ProcessState {
     return &thread_memory_regions_;
   }
   const vector<string>* thread_names() const { return &thread_names_; }
+  const vector<MinidumpBreadcrumbs::Thread>* breadcrumbs() const {
+    return &breadcrumbs_;
+  }
   const SystemInfo* system_info() const { return &system_info_; }
   const CodeModules* modules() const { return modules_; }
   const CodeModules* unloaded_modules() const { return unloaded_modules_; }
@@ -125,6 +150,8 @@ class ProcessState {
     return &modules_with_corrupt_symbols_;
   }
   ExploitabilityRating exploitability() const { return exploitability_; }
+  // NULL unless MinidumpProcessor::set_collect_stats was enabled.
+  const ProcessStats* stats() const { return stats_; }
 
  private:
   // MinidumpProcessor and MicrodumpProcessor are responsible for building
@@ -188,6 +215,11 @@ class ProcessState {
   // ID was not present in the THREAD_NAME_LIST.
   vector<string> thread_names_;
 
+  // The breadcrumbs that threads recorded most recently, from the
+  // minidump's MD_BREADCRUMB_STREAM, if it has one.  A thread that
+  // recorded breadcrumbs need not be in threads_, as it may have exited.
+  vector<MinidumpBreadcrumbs::Thread> breadcrumbs_;
+
   // OS and CPU information.
   SystemInfo system_info_;
 
@@ -199,6 +231,10 @@ class ProcessState {
   // ProcessState.
   const CodeModules *unloaded_modules_;
 
+  // True if modules_ and unloaded_modules_ are owned by a Minidump rather
+  // than by the ProcessState.
+  bool modules_borrowed_;
+
   // The modules which virtual address ranges were shrunk down due to
   // virtual address conflicts.
   vector<linked_ptr<const CodeModule> > shrunk_range_modules_;
@@ -213,6 +249,9 @@ class ProcessState {
   // engine. When the exploitability engine is not enabled this
   // defaults to EXPLOITABILITY_NOT_ANALYZED.
   ExploitabilityRating exploitability_;
+
+  // Where the time and work of processing went, if it was recorded.
+  ProcessStats* stats_;
 };
 
 }  // namespace google_breakpad
@@ -0,0 +1,189 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_stats.h: ProcessStats records where the time and work of
+// processing one minidump went.
+//
+// MinidumpProcessor fills a ProcessStats when
+// MinidumpProcessor::set_collect_stats is enabled, and ProcessState::stats
+// returns it.  It tells apart a dump that is slow because of fetching or
+// loading symbols from one that is slow because its stacks are scanned, or
+// because of the exploitability rating.
+
+#ifndef GOOGLE_BREAKPAD_PROCESSOR_PROCESS_STATS_H__
+#define GOOGLE_BREAKPAD_PROCESSOR_PROCESS_STATS_H__
+
+#include <stddef.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+#include "google_breakpad/processor/stack_frame.h"
+
+namespace google_breakpad {
+
+// The counters may be updated from several threads at once, as stacks are
+// walked and symbols fetched concurrently; they should be read once
+// processing is done.
+class ProcessStats {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  // The number of StackFrame::FrameTrust values.
+  static const int kFrameTrustCount = StackFrame::FRAME_TRUST_LEAF + 1;
+
+  // One module whose symbols were loaded into the resolver.
+  struct ModuleLoad {
+    string code_file;
+    // The time the SymbolSupplier took to return the symbol data.  For
+    // prefetched symbols, this is the time from the request to its
+    // result, which overlaps with the other modules' requests.
+    uint64_t supplier_nanoseconds;
+    // The time the resolver took to load the symbol data.
+    uint64_t load_nanoseconds;
+    size_t symbol_data_size;
+    // False if the resolver could not load the symbol data.
+    bool loaded;
+  };
+
+  ProcessStats();
+
+  // Returns the nanoseconds from |start| until now.
+  static uint64_t NanosecondsSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - start).count();
+  }
+
+  // Records a SymbolSupplier call that took |nanoseconds|, whatever its
+  // result.
+  void AddSymbolSupplierCall(uint64_t nanoseconds) {
+    ++symbol_supplier_calls_;
+    symbol_supplier_nanoseconds_ += nanoseconds;
+  }
+
+  // Records the loading of one module's symbols.
+  void AddModuleLoad(const ModuleLoad& load);
+
+  // Records |words| stack words inspected while scanning for return
+  // addresses.
+  void AddScannedWords(uint64_t words) { scanned_words_ += words; }
+
+  // Records a failed read from a thread's stack memory while walking it.
+  void AddMemoryReadFailure() { ++memory_read_failures_; }
+
+  // Records a frame of a walked stack.
+  void AddFrame(StackFrame::FrameTrust trust) {
+    if (trust >= 0 && trust < kFrameTrustCount)
+      ++frames_by_trust_[trust];
+  }
+
+  void set_stackwalk_nanoseconds(uint64_t nanoseconds) {
+    stackwalk_nanoseconds_ = nanoseconds;
+  }
+  void set_exploitability_nanoseconds(uint64_t nanoseconds) {
+    exploitability_nanoseconds_ = nanoseconds;
+  }
+  void set_total_nanoseconds(uint64_t nanoseconds) {
+    total_nanoseconds_ = nanoseconds;
+  }
+
+  uint64_t symbol_supplier_calls() const { return symbol_supplier_calls_; }
+  uint64_t symbol_supplier_nanoseconds() const {
+    return symbol_supplier_nanoseconds_;
+  }
+  uint64_t scanned_words() const { return scanned_words_; }
+  uint64_t memory_read_failures() const { return memory_read_failures_; }
+  uint64_t frames_by_trust(StackFrame::FrameTrust trust) const {
+    return trust >= 0 && trust < kFrameTrustCount
+               ? frames_by_trust_[trust].load()
+               : 0;
+  }
+
+  // The time spent walking every thread's stack, including the symbols
+  // fetched and loaded for them, but not those prefetched beforehand.
+  uint64_t stackwalk_nanoseconds() const { return stackwalk_nanoseconds_; }
+  // The time spent rating exploitability.  When stacks are walked in
+  // parallel, this overlaps with the walks.
+  uint64_t exploitability_nanoseconds() const {
+    return exploitability_nanoseconds_;
+  }
+  // The time spent in MinidumpProcessor::Process.
+  uint64_t total_nanoseconds() const { return total_nanoseconds_; }
+
+  // The modules whose symbols were loaded, in the order they were.
+  const std::vector<ModuleLoad>& module_loads() const {
+    return module_loads_;
+  }
+
+  // Returns the stats that work done on the calling thread is recorded
+  // in, or NULL if none is being recorded.  A StackFrameSymbolizer may be
+  // shared by processors working on different minidumps at once, so it
+  // records into the stats of whichever minidump the calling thread is
+  // processing.
+  static ProcessStats* Current();
+
+  // Makes |stats| the calling thread's current stats until the Scope is
+  // destroyed.  |stats| may be NULL.
+  class Scope {
+   public:
+    explicit Scope(ProcessStats* stats);
+    ~Scope();
+
+   private:
+    ProcessStats* previous_;
+
+    Scope(const Scope&);
+    void operator=(const Scope&);
+  };
+
+ private:
+  std::atomic<uint64_t> symbol_supplier_calls_;
+  std::atomic<uint64_t> symbol_supplier_nanoseconds_;
+  std::atomic<uint64_t> scanned_words_;
+  std::atomic<uint64_t> memory_read_failures_;
+  std::atomic<uint64_t> frames_by_trust_[kFrameTrustCount];
+  uint64_t stackwalk_nanoseconds_;
+  uint64_t exploitability_nanoseconds_;
+  uint64_t total_nanoseconds_;
+
+  std::mutex module_loads_mutex_;
+  std::vector<ModuleLoad> module_loads_;
+
+  // Disallow unwanted copy ctor and assignment operator
+  ProcessStats(const ProcessStats&);
+  void operator=(const ProcessStats&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // GOOGLE_BREAKPAD_PROCESSOR_PROCESS_STATS_H__
@@ -40,10 +40,14 @@
 #ifndef GOOGLE_BREAKPAD_PROCESSOR_SOURCE_LINE_RESOLVER_BASE_H__
 #define GOOGLE_BREAKPAD_PROCESSOR_SOURCE_LINE_RESOLVER_BASE_H__
 
+#include <atomic>
 #include <deque>
+#include <list>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "google_breakpad/processor/source_line_resolver_interface.h"
 
@@ -64,9 +68,91 @@ class SourceLineResolverBase : public SourceLineResolverInterface {
   // LoadMap() method.
   // Place dynamically allocated heap buffer in symbol_data. Caller has the
   // ownership of the buffer, and should call delete [] to free the buffer.
+  // A gzip-compressed file is decompressed into the buffer, using up to
+  // |decompression_thread_count| threads for files written in blocks by
+  // BlockGzipWriter.
   static bool ReadSymbolFile(const string& file_name,
                              char** symbol_data,
-                             size_t* symbol_data_size);
+                             size_t* symbol_data_size,
+                             int decompression_thread_count = 1);
+
+  // Counters describing how the loaded modules are used, for sizing the
+  // module cache budget.
+  struct ModuleCacheStats {
+    // HasModule() calls that found the module loaded, and calls that did not.
+    uint64_t hits;
+    uint64_t misses;
+    // Modules unloaded to stay within the budget.
+    uint64_t evictions;
+    // The number of loaded modules, and an estimate of the memory they use,
+    // including any symbol buffers they refer to.
+    size_t module_count;
+    size_t resident_bytes;
+  };
+
+  // Limits the estimated memory used by loaded modules to |budget| bytes.
+  // When loading a module takes the total over budget, the least recently
+  // used modules are unloaded until it fits again.  The module just loaded
+  // is never evicted, so a single module larger than the budget remains
+  // resident.  A budget of 0, the default, never evicts anything, and
+  // lookups other than HasModule() only keep track of which modules were
+  // used while a budget is set.
+  void set_module_cache_budget(size_t budget);
+  size_t module_cache_budget() const { return module_cache_budget_; }
+
+  ModuleCacheStats module_cache_stats() const;
+
+  // A loaded module, and the number of HasModule() calls that have found
+  // it since it was loaded.
+  struct ModuleHits {
+    string code_file;
+    string code_identifier;
+    string debug_file;
+    string debug_identifier;
+    uint64_t hits;
+  };
+
+  // Returns up to |max_count| of the loaded modules, those with the most
+  // hits first, for example to record which symbols a long-running process
+  // should load again when it restarts.
+  virtual std::vector<ModuleHits> HottestModules(size_t max_count);
+
+  // An estimate of the memory a loaded module uses, in bytes, by the kind
+  // of record it holds: the records' text, the structures built from them
+  // and the maps that index them.
+  struct ModuleMemoryUsage {
+    string code_file;
+    size_t files;
+    // FUNC records, with their line and INLINE records.
+    size_t functions;
+    size_t public_symbols;
+    size_t inline_origins;
+    // STACK WIN records, of every type.
+    size_t windows_frame_info;
+    size_t cfi_initial_rules;
+    size_t cfi_delta_rules;
+    // The whole module, as module_cache_stats() and the budget count it.
+    size_t resident_bytes;
+    // The part of resident_bytes that is symbol data the module keeps
+    // referring to rather than structures it built: in a buffer the
+    // resolver copied the data into, or in one the caller supplied to
+    // LoadModuleUsingMemoryBuffer, such as a mapped symbol file.
+    size_t copied_buffer_bytes;
+    size_t supplied_buffer_bytes;
+  };
+
+  // Returns the memory used by each loaded module, largest first, for
+  // example to see where a long-running process's memory goes.
+  virtual std::vector<ModuleMemoryUsage> ModuleMemoryUsages();
+
+  // Sets the number of threads LoadModule uses to decompress a compressed
+  // symbol file.  Defaults to 1.
+  void set_decompression_thread_count(int thread_count) {
+    decompression_thread_count_ = thread_count;
+  }
+  int decompression_thread_count() const {
+    return decompression_thread_count_;
+  }
 
  protected:
   // Users are not allowed create SourceLineResolverBase instance directly.
@@ -87,6 +173,10 @@ class SourceLineResolverBase : public SourceLineResolverInterface {
   virtual void FillSourceLineInfo(
       StackFrame* frame,
       std::deque<std::unique_ptr<StackFrame>>* inlined_frames);
+  virtual void FillSourceLineInfoWithInlineRecords(StackFrame* frame);
+  virtual bool ExpandInlineFrames(
+      const StackFrame& frame,
+      std::deque<std::unique_ptr<StackFrame>>* inlined_frames);
   virtual WindowsFrameInfo* FindWindowsFrameInfo(const StackFrame* frame);
   virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame);
 
@@ -119,6 +209,47 @@ class SourceLineResolverBase : public SourceLineResolverInterface {
   ModuleFactory* module_factory_;
 
  private:
+  // Bookkeeping for one loaded module in the module cache.
+  struct CachedModule {
+    string code_file;
+    string code_identifier;
+    string debug_file;
+    string debug_identifier;
+    size_t resident_bytes;
+    uint64_t hits;
+  };
+  // Loaded modules, most recently used first.
+  typedef std::list<CachedModule> ModuleLRUList;
+  typedef map<string, ModuleLRUList::iterator, CompareString> ModuleLRUIndex;
+
+  // Marks |code_file| as the most recently used module.  Only done while a
+  // budget is set.
+  void TouchModule(const string& code_file);
+
+  // Counts a HasModule() hit for |code_file|, and marks it as the most
+  // recently used module.
+  void CountModuleHit(const string& code_file);
+
+  // Unloads least recently used modules, other than |keep|, until the
+  // resident modules fit in the budget.
+  void EvictModules(const string& keep);
+
+  // Unloads the module loaded for |code_file| and frees its buffer.
+  void UnloadModuleByName(const string& code_file);
+
+  size_t module_cache_budget_;
+  size_t resident_bytes_;
+  ModuleLRUList module_lru_;
+  ModuleLRUIndex module_lru_index_;
+  // Lookups may run concurrently (see StackFrameSymbolizer), so the LRU
+  // order they update has its own lock and the counters are atomic.
+  std::mutex module_lru_mutex_;
+  std::atomic<uint64_t> module_cache_hits_;
+  std::atomic<uint64_t> module_cache_misses_;
+  uint64_t module_cache_evictions_;
+
+  int decompression_thread_count_;
+
   // ModuleFactory needs to have access to protected type Module.
   friend class ModuleFactory;
 
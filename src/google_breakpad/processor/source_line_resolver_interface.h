@@ -100,6 +100,25 @@ class SourceLineResolverInterface {
       StackFrame* frame,
       std::deque<std::unique_ptr<StackFrame>>* inlined_frames) = 0;
 
+  // Fills in the StackFrame as FillSourceLineInfo does, but records the
+  // inlined frames compactly in the frame's inline_records instead of
+  // constructing them, which ExpandInlineFrames does once they are wanted.
+  // Resolvers that cannot record inlined frames fill in the frame without
+  // them.
+  virtual void FillSourceLineInfoWithInlineRecords(StackFrame* frame) {
+    FillSourceLineInfo(frame, nullptr);
+  }
+
+  // Constructs the inlined frames recorded in |frame|'s inline_records,
+  // adding them to |inlined_frames| innermost first, as FillSourceLineInfo
+  // would have.  |frame|'s module must still be loaded.  Returns false if
+  // the inlined frames cannot be constructed.
+  virtual bool ExpandInlineFrames(
+      const StackFrame& frame,
+      std::deque<std::unique_ptr<StackFrame>>* inlined_frames) {
+    return false;
+  }
+
   // If Windows stack walking information is available covering
   // FRAME's instruction address, return a WindowsFrameInfo structure
   // describing it. If the information is not available, returns NULL.
@@ -29,15 +29,35 @@
 #ifndef GOOGLE_BREAKPAD_PROCESSOR_STACK_FRAME_H__
 #define GOOGLE_BREAKPAD_PROCESSOR_STACK_FRAME_H__
 
+#include <stddef.h>
+
+#include <new>
 #include <string>
+#include <vector>
 
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
+#include "google_breakpad/processor/call_stack.h"
 
 namespace google_breakpad {
 
 class CodeModule;
 
+// An inlined frame, recorded by a source line resolver in the frame it is
+// inlined into instead of being built as a StackFrame of its own.  See
+// SourceLineResolverInterface::FillSourceLineInfoWithInlineRecords.
+struct InlineFrameRecord {
+  // The INLINE_ORIGIN record of the inlined function.
+  int origin_id;
+  // The source line the inlined frame is at, and the FILE record of its
+  // source file, or -1 if it has none.
+  int source_line;
+  int source_file_id;
+  // The start of the inlined range containing the instruction, relative to
+  // the module's base address, or 0 if it is not known.
+  uint64_t function_base;
+};
+
 struct StackFrame {
   // Indicates how well the instruction pointer derived during
   // stack walking is trusted. Since the stack walker can resort to
@@ -69,6 +89,26 @@ struct StackFrame {
         is_multiple(false) {}
   virtual ~StackFrame() {}
 
+  // A frame may be allocated in the frame pool of the CallStack that it is
+  // walked into, with new (call_stack) StackFrameX(...), rather than on the
+  // heap; a NULL call stack means the heap.  Either way it is deleted with
+  // delete, which for a pooled frame leaves its memory to be released along
+  // with the pool.
+  static void* operator new(size_t size) { return Allocate(size, NULL); }
+  static void* operator new(size_t size, CallStack* pool) {
+    return Allocate(size, pool);
+  }
+  static void operator delete(void* frame) {
+    if (!frame)
+      return;
+    char* memory = static_cast<char*>(frame) - kAllocationHeaderSize;
+    if (!*memory)
+      ::operator delete(memory);
+  }
+  static void operator delete(void* frame, CallStack* pool) {
+    operator delete(frame);
+  }
+
   // Return a string describing how this stack frame was found
   // by the stackwalker.
   string trust_description() const {
@@ -151,6 +191,26 @@ struct StackFrame {
   // name, filename, etc. information above represents the state of an arbitrary
   // one of these functions.
   bool is_multiple;
+
+  // The inlined frames at this frame's instruction, innermost first, if
+  // the resolver recorded them here instead of building them.  The source
+  // line above is then the one the outermost of them is called from, as it
+  // would be with the inlined frames built.  See
+  // CallStack::ExpandInlineFrames.
+  std::vector<InlineFrameRecord> inline_records;
+
+ private:
+  // Each frame is preceded by a byte telling whether it is pooled, padded
+  // so that the frame stays aligned.
+  static const size_t kAllocationHeaderSize = alignof(max_align_t);
+
+  static void* Allocate(size_t size, CallStack* pool) {
+    size += kAllocationHeaderSize;
+    char* memory = static_cast<char*>(
+        pool ? pool->AllocateFrame(size) : ::operator new(size));
+    *memory = pool != NULL;
+    return memory + kAllocationHeaderSize;
+  }
 };
 
 }  // namespace google_breakpad
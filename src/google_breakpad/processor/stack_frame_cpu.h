@@ -178,6 +178,13 @@ struct StackFrameAMD64 : public StackFrame {
   // Overriden to return the return address as saved on the stack.
   virtual uint64_t ReturnAddress() const;
 
+  // Copies the context flags and the integer and control registers of
+  // |callee|'s context, the ones that context_validity describes, into
+  // this caller frame's context.  The floating-point and vector registers,
+  // which no caller frame recovers, are left as they are, so that a walk
+  // does not copy them from frame to frame.
+  void CopyIntegerRegisters(const StackFrameAMD64& callee);
+
   // Register state. This is only fully valid for the topmost frame in a
   // stack. In other frames, which registers are present depends on what
   // debugging information we had available. Refer to context_validity.
@@ -320,6 +327,11 @@ struct StackFrameARM64 : public StackFrame {
   StackFrameARM64() : context(),
                       context_validity(CONTEXT_VALID_NONE) {}
 
+  // Copies the context flags, the CPSR and the integer registers of
+  // |callee|'s context into this caller frame's context, as
+  // StackFrameAMD64::CopyIntegerRegisters does.
+  void CopyIntegerRegisters(const StackFrameARM64& callee);
+
   // Return the validity flag for register xN.
   static uint64_t RegisterValidFlag(int n) {
     return 1ULL << n;
@@ -30,24 +30,44 @@
 
 // Helper class that encapsulates the logic of how symbol supplier interacts
 // with source line resolver to fill stack frame information.
+//
+// The default implementation may be shared by several stackwalkers running on
+// different threads.  Symbol loading (the SymbolSupplier and the resolver's
+// LoadModule* calls) is serialized, while lookups in modules that are already
+// loaded only take a shared lock, so the resolver must tolerate concurrent
+// const lookups.  BasicSourceLineResolver and FastSourceLineResolver do.
+//
+// FindWindowsFrameInfo and FindCFIFrameInfo results are cached by module
+// and module-relative address, so that the many threads of a dump that are
+// parked in the same few functions only consult the resolver once.
+// FillSourceLineInfo results can be cached the same way; see
+// set_cache_source_line_info.
 
 #ifndef GOOGLE_BREAKPAD_PROCESSOR_STACK_FRAME_SYMBOLIZER_H__
 #define GOOGLE_BREAKPAD_PROCESSOR_STACK_FRAME_SYMBOLIZER_H__
 
+#include <condition_variable>
 #include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
 #include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "google_breakpad/processor/symbol_supplier.h"
 
 namespace google_breakpad {
 class CFIFrameInfo;
 class CodeModules;
-class SymbolSupplier;
+class MissingSymbolsCache;
+class ProcessStats;
 class SourceLineResolverInterface;
 struct StackFrame;
 struct SystemInfo;
@@ -73,10 +93,11 @@ class StackFrameSymbolizer {
   StackFrameSymbolizer(SymbolSupplier* supplier,
                        SourceLineResolverInterface* resolver);
 
-  virtual ~StackFrameSymbolizer() { }
+  virtual ~StackFrameSymbolizer();
 
   // Encapsulate the step of resolving source line info for a stack frame.
-  // "frame" must not be NULL.
+  // "frame" must not be NULL.  Symbols fetched and loaded for the frame are
+  // recorded in the calling thread's ProcessStats::Current(), if any.
   virtual SymbolizerResult FillSourceLineInfo(
       const CodeModules* modules,
       const CodeModules* unloaded_modules,
@@ -84,15 +105,103 @@ class StackFrameSymbolizer {
       StackFrame* stack_frame,
       std::deque<std::unique_ptr<StackFrame>>* inlined_frames);
 
+  // Does what FillSourceLineInfo does but look up the frame's source line
+  // info: sets its module, and fetches and loads the module's symbols,
+  // returning the same result.  FillSourceLineInfoBatch fills the frame
+  // later, along with the others found this way.
+  virtual SymbolizerResult LoadSymbolsForFrame(
+      const CodeModules* modules,
+      const CodeModules* unloaded_modules,
+      const SystemInfo* system_info,
+      StackFrame* stack_frame);
+
+  // Fills the source line info of |frames|, whose symbols were loaded by
+  // LoadSymbolsForFrame, as FillSourceLineInfo would have, and sets
+  // (*inlined_frames)[i] to the inlined frames of frames[i].  The frames
+  // are looked up grouped by module and in order of address, so that each
+  // module's tables are gone through once rather than at random.  Frames
+  // whose module has no symbols are left alone.
+  void FillSourceLineInfoBatch(
+      const std::vector<StackFrame*>& frames,
+      std::vector<std::deque<std::unique_ptr<StackFrame>>>* inlined_frames);
+
   virtual WindowsFrameInfo* FindWindowsFrameInfo(const StackFrame* frame);
 
   virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame);
 
+  // Fetches and loads the symbols for |modules| before any frame needs
+  // them, so that a later FillSourceLineInfo finds them already loaded.
+  // Every request is issued up front, in order, through
+  // SymbolSupplier::GetCStringSymbolDataAsync, and this returns once all
+  // of them have completed.  Modules that are already loaded, known to
+  // have no symbols, or being prefetched by another call are skipped.  A
+  // module whose request is interrupted is requested again when a frame
+  // needs it.
+  virtual void PrefetchSymbols(const std::vector<const CodeModule*>& modules,
+                               const SystemInfo* system_info);
+
   // Reset internal (locally owned) data as if the helper is re-instantiated.
   // A typical case is to call Reset() after processing an individual report
   // before start to process next one, in order to reset internal information
-  // about missing symbols found so far.
-  virtual void Reset() { no_symbol_modules_.clear(); }
+  // about missing symbols found so far.  The frame info and source line
+  // caches are cleared too, unless set_persist_frame_info_cache(true) has
+  // been called.
+  virtual void Reset();
+
+  // If |persist| is true, cached frame info and source line info survive
+  // Reset(), so that they are reused across dumps that share modules.
+  // Entries are keyed by the module's code file and debug identifier, so a
+  // different build of a module never sees another build's entries.
+  // Defaults to false.
+  void set_persist_frame_info_cache(bool persist) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    persist_frame_info_cache_ = persist;
+  }
+
+  // If |enabled| is true, the function, source line and inlined frames
+  // that FillSourceLineInfo finds for a frame are cached by module and
+  // module-relative address, and frames at an address already seen, in
+  // any thread sharing this symbolizer, are filled from the cache without
+  // consulting the resolver.  Addresses are rebased onto each frame's
+  // module, so entries apply wherever the module was loaded.  This pays
+  // off when many dumps crash in the same places; combine it with
+  // set_persist_frame_info_cache(true) to keep entries across dumps.
+  // Call before processing starts.  Defaults to false.
+  void set_cache_source_line_info(bool enabled) {
+    cache_source_line_info_ = enabled;
+  }
+
+  // If |enabled| is true, FillSourceLineInfo records the inlined frames it
+  // finds in the frame's inline_records instead of constructing them, for
+  // callers that may never want them, such as for threads that are not
+  // printed.  CallStack::ExpandInlineFrames constructs them later, while
+  // the modules are still loaded.  Call before processing starts.
+  // Defaults to false.
+  void set_lazy_inline_frames(bool enabled) { lazy_inline_frames_ = enabled; }
+  bool lazy_inline_frames() const { return lazy_inline_frames_; }
+
+  // Shares |cache|'s record of modules without symbols, which unlike the
+  // record kept for one minidump survives Reset() and may be shared with
+  // other symbolizers.  Modules found in |cache| are not requested from
+  // the supplier, and modules found to have no symbols are added to it.
+  // |cache| is not owned and must outlive this symbolizer's use of it.
+  // Call before processing starts.  NULL, the default, disables sharing.
+  void set_missing_symbols_cache(MissingSymbolsCache* cache) {
+    missing_symbols_cache_ = cache;
+  }
+
+  // Names the modules known to keep a frame pointer in every function,
+  // such as those built with -fno-omit-frame-pointer.  A name matches a
+  // module whose code file or debug file has that file name, without its
+  // directory.  Stackwalkers that support it unwind callers in these
+  // modules by frame pointer before trying CFI, which is cheaper and as
+  // accurate for them.  Call before processing starts.
+  void set_frame_pointer_modules(const std::set<string>& modules) {
+    frame_pointer_modules_ = modules;
+  }
+
+  // Returns true if |frame|'s module was named in set_frame_pointer_modules.
+  virtual bool PrefersFramePointer(const StackFrame* frame) const;
 
   // Returns true if there is valid implementation for stack symbolization.
   virtual bool HasImplementation() { return resolver_ && supplier_; }
@@ -106,6 +215,164 @@ class StackFrameSymbolizer {
   // A list of modules known to have symbols missing. This helps avoid
   // repeated lookups for the missing symbols within one minidump.
   std::set<string> no_symbol_modules_;
+  // Guards no_symbol_modules_ and the resolver's module set.  Held shared
+  // while looking up loaded modules and exclusively while loading one.
+  std::shared_mutex mutex_;
+  // Modules whose symbols PrefetchSymbols has requested and not yet
+  // loaded.  A frame in one of them waits on |prefetched_| for that request
+  // rather than asking the supplier for the same symbols a second time,
+  // since suppliers keep one buffer per module.  Guarded by mutex_.
+  std::set<string> prefetching_modules_;
+  std::condition_variable_any prefetched_;
+  // Modules without symbols shared with other symbolizers, or NULL.
+  MissingSymbolsCache* missing_symbols_cache_;
+  // See set_frame_pointer_modules.
+  std::set<string> frame_pointer_modules_;
+
+ private:
+  // Identifies a frame info lookup: the frame's module and its address
+  // relative to that module's base.
+  struct FrameInfoKey {
+    string code_file;
+    string debug_identifier;
+    uint64_t rva;
+
+    bool operator<(const FrameInfoKey& other) const {
+      if (rva != other.rva)
+        return rva < other.rva;
+      if (code_file != other.code_file)
+        return code_file < other.code_file;
+      return debug_identifier < other.debug_identifier;
+    }
+
+    bool operator==(const FrameInfoKey& other) const {
+      return rva == other.rva && code_file == other.code_file &&
+             debug_identifier == other.debug_identifier;
+    }
+  };
+
+  struct FrameInfoKeyHash {
+    size_t operator()(const FrameInfoKey& key) const;
+  };
+
+  // The fields that FillSourceLineInfo sets in one frame.  Each base is
+  // kept relative to the module's base address, or not at all if the
+  // resolver left it unset.
+  struct SourceLineInfo {
+    string function_name;
+    uint64_t function_base;
+    bool has_function_base;
+    string source_file_name;
+    int source_line;
+    uint64_t source_line_base;
+    bool has_source_line_base;
+    bool is_multiple;
+  };
+
+  // A FillSourceLineInfo result: the frame's own info, then that of each
+  // inlined frame it produced, innermost first, or the inlined frames it
+  // recorded if lazy_inline_frames_ is set.
+  struct CachedSourceLineInfo {
+    SourceLineInfo frame;
+    std::vector<SourceLineInfo> inlined_frames;
+    std::vector<InlineFrameRecord> inline_records;
+    SymbolizerResult result;
+  };
+
+  // Cached lookup results.  A NULL value records that the resolver had no
+  // frame info for that address.
+  typedef std::map<FrameInfoKey, std::unique_ptr<WindowsFrameInfo> >
+      WindowsFrameInfoCache;
+  typedef std::map<FrameInfoKey, std::unique_ptr<CFIFrameInfo> >
+      CFIFrameInfoCache;
+  typedef std::unordered_map<FrameInfoKey, CachedSourceLineInfo,
+                             FrameInfoKeyHash> SourceLineInfoCache;
+
+  // Each cache is emptied once it holds this many entries, which bounds
+  // the memory a persistent cache can use.
+  static const size_t kMaxCachedFrameInfo = 1 << 16;
+
+  // Sets |key| from |frame| and returns true if |frame|'s lookups may be
+  // cached: its module must be loaded into the resolver, so that a result
+  // never outlives symbols that arrive later.  The caller must hold mutex_.
+  bool GetFrameInfoKey(const StackFrame* frame, FrameInfoKey* key);
+
+  WindowsFrameInfoCache windows_frame_info_cache_;
+  CFIFrameInfoCache cfi_frame_info_cache_;
+  SourceLineInfoCache source_line_info_cache_;
+  bool persist_frame_info_cache_;
+  // Guards the caches and persist_frame_info_cache_.
+  std::mutex cache_mutex_;
+  // See set_cache_source_line_info.
+  bool cache_source_line_info_;
+
+  // See set_lazy_inline_frames.
+  bool lazy_inline_frames_;
+
+  // Fills |frame|, whose module is loaded into the resolver, and appends
+  // its inlined frames, from the source line cache when enabled or else
+  // from the resolver, and returns the result.  The caller must hold
+  // mutex_, shared or exclusive.
+  SymbolizerResult FillFromLoadedModule(
+      StackFrame* frame,
+      std::deque<std::unique_ptr<StackFrame>>* inlined_frames);
+
+  // Records in |info| what the resolver set in |frame|, which was a copy
+  // of |unfilled| before it was filled.
+  static void SaveSourceLineInfo(const StackFrame& frame,
+                                 const StackFrame& unfilled,
+                                 SourceLineInfo* info);
+
+  // Sets |frame|'s fields from |info|, rebased onto |frame|'s module.
+  static void RestoreSourceLineInfo(const SourceLineInfo& info,
+                                    StackFrame* frame);
+
+  // FillSourceLineInfo, or LoadSymbolsForFrame if |fill| is false.
+  SymbolizerResult Symbolize(
+      const CodeModules* modules,
+      const CodeModules* unloaded_modules,
+      const SystemInfo* system_info,
+      StackFrame* frame,
+      std::deque<std::unique_ptr<StackFrame>>* inlined_frames,
+      bool fill);
+
+  // If |module| has already been loaded into the resolver or is known to
+  // have no symbols, fills |frame| accordingly if |fill| is true, sets
+  // |result| and returns true.  Returns false if |module| still needs its
+  // symbols fetched.  The caller must hold mutex_, shared or exclusive.
+  bool FillFromKnownModule(
+      const CodeModule* module,
+      StackFrame* frame,
+      std::deque<std::unique_ptr<StackFrame>>* inlined_frames,
+      bool fill,
+      SymbolizerResult* result);
+
+  // The result of symbolizing a frame in |module|, which is loaded into
+  // the resolver.
+  SymbolizerResult LoadedModuleResult(const CodeModule* module);
+
+  // Records that |module| has no usable symbols.  The caller must hold
+  // mutex_ exclusively.
+  void RecordNoSymbols(const CodeModule* module);
+
+  // Loads |module|'s symbol data into the resolver, returning whether it
+  // loaded.  If |stats| is not NULL, the load is recorded in it, along
+  // with the |supplier_nanoseconds| the data took to fetch.
+  bool LoadModule(const CodeModule* module,
+                  char* symbol_data,
+                  size_t symbol_data_size,
+                  ProcessStats* stats,
+                  uint64_t supplier_nanoseconds);
+
+  // Loads the symbol data that a prefetch request for |module| returned,
+  // or records that |module| has none.  |stats| and |supplier_nanoseconds|
+  // are as for LoadModule.
+  void LoadPrefetchedSymbols(const CodeModule* module,
+                             SymbolSupplier::SymbolResult result,
+                             char* symbol_data,
+                             size_t symbol_data_size,
+                             ProcessStats* stats,
+                             uint64_t supplier_nanoseconds);
 };
 
 }  // namespace google_breakpad
@@ -0,0 +1,128 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// stackwalk_budget.h: StackwalkBudget limits the work done walking the
+// stacks of one minidump.
+//
+// Stackwalker::max_frames_scanned limits how many frames stack scanning
+// may produce, but not what each scan costs.  Corrupt stacks can make
+// every frame scan far down the stack, and a dump with many such threads
+// takes seconds to walk.  StackwalkLimits caps the stack words scanned,
+// the StackFrameSymbolizer calls made and the time spent, both for each
+// thread and for all the threads of a minidump.  It can also stop a walk
+// where the stack looks corrupt from then on.  A walk that reaches a limit
+// stops early, and its CallStack reports budget_exhausted();
+// Stackwalker::ResumeWalk can finish it later.
+
+#ifndef GOOGLE_BREAKPAD_PROCESSOR_STACKWALK_BUDGET_H__
+#define GOOGLE_BREAKPAD_PROCESSOR_STACKWALK_BUDGET_H__
+
+#include <atomic>
+#include <chrono>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+// The limits enforced by a StackwalkBudget.  0, the default for each,
+// means no limit.
+struct StackwalkLimits {
+  StackwalkLimits();
+
+  // Returns true if any limit is set.
+  bool IsLimited() const;
+
+  // Limits for the walk of each thread.
+  uint64_t max_scanned_words_per_thread;
+  uint64_t max_symbolizer_calls_per_thread;
+  uint64_t max_milliseconds_per_thread;
+  // Counts inlined frames as well as the frames unwound to.
+  uint64_t max_frames_per_thread;
+  // Stops a walk after this many frames in a row that were found by stack
+  // scanning and have no symbols, which past a corrupt frame are mostly
+  // stale return addresses.
+  uint64_t max_unsymbolized_scanned_frames;
+  // If true, stops a walk at a caller frame whose stack pointer is outside
+  // the thread's stack memory.
+  bool stop_outside_stack;
+
+  // Limits for the walks of all the threads of a minidump together.
+  uint64_t max_scanned_words;
+  uint64_t max_symbolizer_calls;
+  uint64_t max_milliseconds;
+};
+
+// Accounts for the work done walking one minidump's stacks.  One budget
+// is shared by the walks of every thread of the minidump, which may run
+// concurrently; threads walking at the same time may overshoot the
+// minidump's limits by the work of one frame each.  The time limit for the
+// minidump counts from the budget's construction.
+class StackwalkBudget {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  explicit StackwalkBudget(const StackwalkLimits& limits);
+
+  const StackwalkLimits& limits() const { return limits_; }
+
+  // Returns how many more stack words a walk that has scanned
+  // |thread_words| so far may scan.
+  uint64_t ScannableWords(uint64_t thread_words) const;
+
+  // Charges the minidump for |words| scanned stack words.
+  void AddScannedWords(uint64_t words) { scanned_words_ += words; }
+
+  // Allows no more stack scanning, by any walk, whatever the limits.
+  void StopScanning() { scanning_stopped_ = true; }
+
+  // Returns true if a walk that has made |thread_calls| symbolizer calls
+  // so far may make another.
+  bool AllowsSymbolizerCall(uint64_t thread_calls) const;
+
+  // Charges the minidump for one symbolizer call.
+  void AddSymbolizerCall() { ++symbolizer_calls_; }
+
+  // Returns true if a walk that started at |thread_start| has used up its
+  // time, or the minidump has used up its own.
+  bool OutOfTime(Clock::time_point thread_start) const;
+
+ private:
+  StackwalkLimits limits_;
+  Clock::time_point start_;
+  std::atomic<uint64_t> scanned_words_;
+  std::atomic<uint64_t> symbolizer_calls_;
+  std::atomic<bool> scanning_stopped_;
+
+  // Disallow unwanted copy ctor and assignment operator
+  StackwalkBudget(const StackwalkBudget&);
+  void operator=(const StackwalkBudget&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // GOOGLE_BREAKPAD_PROCESSOR_STACKWALK_BUDGET_H__
@@ -40,6 +40,7 @@
 #ifndef GOOGLE_BREAKPAD_PROCESSOR_STACKWALKER_H__
 #define GOOGLE_BREAKPAD_PROCESSOR_STACKWALKER_H__
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <vector>
@@ -48,10 +49,15 @@
 #include "google_breakpad/common/breakpad_types.h"
 #include "google_breakpad/processor/code_modules.h"
 #include "google_breakpad/processor/memory_region.h"
+#include "google_breakpad/processor/process_stats.h"
 #include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "google_breakpad/processor/stackwalk_budget.h"
+#include "processor/basic_code_modules.h"
+#include "processor/module_address_filter.h"
 
 namespace google_breakpad {
 
+class AddressValidityCache;
 class CallStack;
 class DumpContext;
 class StackFrameSymbolizer;
@@ -76,10 +82,50 @@ class Stackwalker {
   // CodeModules passed to the StackWalker constructor (which currently
   // happens to be the lifetime of the Breakpad's ProcessingState object).
   // There is a check for duplicate modules so no duplicates are expected.
+  // If a budget has been set and the walk uses it up, the walk stops early
+  // and |stack| reports budget_exhausted().
   bool Walk(CallStack* stack,
             vector<const CodeModule*>* modules_without_symbols,
             vector<const CodeModule*>* modules_with_corrupt_symbols);
 
+  // Continues a walk of |stack| that stopped early, because it used up its
+  // budget or was interrupted, from its outermost frame, and appends the
+  // frames Walk would have gone on to find.  |stack| must have been walked
+  // from the same context, memory and modules as this stackwalker's, and
+  // this stackwalker's budget, if any, must allow more than the one that
+  // stopped the walk.  The limit on consecutive unsymbolized scanned frames
+  // counts afresh.  An empty |stack| is walked from the start.  Returns
+  // as Walk does.
+  bool ResumeWalk(CallStack* stack,
+                  vector<const CodeModule*>* modules_without_symbols,
+                  vector<const CodeModule*>* modules_with_corrupt_symbols);
+
+  // Limits the work done by Walk to what |budget| allows, and charges the
+  // work to it.  |budget| is not owned, and may be shared with the
+  // stackwalkers of other threads.  NULL, the default, sets no limit.
+  void set_budget(StackwalkBudget* budget) { budget_ = budget; }
+
+  // Records the stack words that Walk scans in |stats|, which is not
+  // owned.  NULL, the default, records nothing.
+  void set_stats(ProcessStats* stats) { stats_ = stats; }
+
+  // Remembers the results of checking candidate return addresses while
+  // scanning in |cache|, which is not owned, and may be shared with the
+  // stackwalkers of the other threads of the same minidump.  NULL, the
+  // default, remembers nothing.
+  void set_validity_cache(AddressValidityCache* cache) {
+    validity_cache_ = cache;
+  }
+
+  // If |defer| is true, Walk only sets each frame's module and loads its
+  // symbols, which unwinding needs, and leaves its source line info and
+  // inlined frames for StackFrameSymbolizer::FillSourceLineInfoBatch to
+  // fill once the stacks are walked.  The frame limits then count only the
+  // frames walked.  Defaults to false.
+  void set_defer_source_line_info(bool defer) {
+    defer_source_line_info_ = defer;
+  }
+
   // Returns a new concrete subclass suitable for the CPU that a stack was
   // generated on, according to the CPU type indicated by the context
   // argument.  If no suitable concrete subclass exists, returns NULL.
@@ -129,11 +175,12 @@ class Stackwalker {
 
   // Checks whether we should stop the stack trace.
   // (either we reached the end-of-stack or we detected a
-  //  broken callstack invariant)
+  //  broken callstack invariant, or the budget stops walks whose stack
+  //  pointer leaves the stack memory)
   bool TerminateWalk(uint64_t caller_ip,
                      uint64_t caller_sp,
                      uint64_t callee_sp,
-                     bool first_unwind) const;
+                     bool first_unwind);
 
   // The default number of words to search through on the stack
   // for a return address.
@@ -168,28 +215,84 @@ class Stackwalker {
                             InstructionType* location_found,
                             InstructionType* ip_found,
                             int searchwords) {
-    for (InstructionType location = location_start;
-         location <= location_start + searchwords * sizeof(InstructionType);
-         location += sizeof(InstructionType)) {
-      InstructionType ip;
-      if (!memory_->GetMemoryAtAddress(location, &ip))
+    // The scan covers searchwords + 1 words, stopping early at the end of
+    // the stack memory.
+    uint64_t memory_base = memory_->GetBase();
+    uint64_t memory_end = memory_base + memory_->GetSize();
+    if (location_start < memory_base || location_start >= memory_end)
+      return false;
+    uint64_t word_count =
+        std::min(static_cast<uint64_t>(searchwords) + 1,
+                 (memory_end - location_start) / sizeof(InstructionType));
+    // A scan cut short by the budget that finds nothing might have found
+    // the return address further down, so the walk is then incomplete.
+    bool cut_short = false;
+    if (budget_) {
+      uint64_t scannable_words = budget_->ScannableWords(words_scanned_);
+      if (scannable_words < word_count) {
+        word_count = scannable_words;
+        cut_short = true;
+      }
+    }
+
+    if (!modules_)
+      return false;
+    InitModuleFilter();
+
+    // Read the stack in chunks, so that there's one bounds check and
+    // virtual call per chunk instead of per word, and so that the chunk can
+    // be prefiltered with module_filter_ at once.
+    const size_t kChunkWords = ModuleAddressFilter::kMaxWords;
+    InstructionType words[kChunkWords];
+    for (uint64_t word_index = 0; word_index < word_count;
+         word_index += kChunkWords) {
+      size_t chunk_words = static_cast<size_t>(
+          std::min(static_cast<uint64_t>(kChunkWords),
+                   word_count - word_index));
+      InstructionType chunk_start = static_cast<InstructionType>(
+          location_start + word_index * sizeof(InstructionType));
+      if (!memory_->GetMemoryArrayAtAddress(chunk_start, words, chunk_words))
         break;
 
-      // The return address points to the instruction after a call. If the
-      // caller was a no return function, this might point past the end of the
-      // function. Subtract one from the instruction pointer so it points into
-      // the call instruction instead.
-      if (modules_ && modules_->GetModuleForAddress(ip  - 1) &&
-          InstructionAddressSeemsValid(ip - 1)) {
-        *ip_found = ip;
-        *location_found = location;
-        return true;
+      uint32_t candidates = module_filter_.Filter(words, chunk_words);
+      for (size_t i = 0; candidates && i < chunk_words; ++i) {
+        if (!(candidates & (1U << i)))
+          continue;
+        InstructionType ip = words[i];
+
+        // The return address points to the instruction after a call. If the
+        // caller was a no return function, this might point past the end of
+        // the function. Subtract one from the instruction pointer so it
+        // points into the call instruction instead.
+        if (ModulesContain(ip - 1) && InstructionAddressSeemsValid(ip - 1)) {
+          *ip_found = ip;
+          *location_found = static_cast<InstructionType>(
+              chunk_start + i * sizeof(InstructionType));
+          ChargeScannedWords(i + 1);
+          return true;
+        }
       }
+      ChargeScannedWords(chunk_words);
     }
     // nothing found
+    if (cut_short)
+      budget_exhausted_ = true;
     return false;
   }
 
+  // Returns true if |address| is within one of modules_.  Most addresses
+  // that are not are rejected by module_filter_ without a lookup, so this
+  // is cheaper than modules_->GetModuleForAddress for checking many
+  // candidate code addresses.
+  bool AddressIsInModule(uint64_t address) {
+    if (!modules_)
+      return false;
+    InitModuleFilter();
+    // Filter checks each word less one, as for a return address.
+    uint64_t word = address + 1;
+    return module_filter_.Filter(&word, 1) && ModulesContain(address);
+  }
+
   // Information about the system that produced the minidump.  Subclasses
   // and the SymbolSupplier may find this information useful.
   const SystemInfo* system_info_;
@@ -207,11 +310,87 @@ class Stackwalker {
   // This field is optional and may be NULL.
   const CodeModules* unloaded_modules_;
 
+  // The call stack being walked, in whose frame pool subclasses allocate
+  // the frames they return, with new (frame_pool_) StackFrameX(...).  Set
+  // by Walk; until then it is NULL, and frames go on the heap.
+  CallStack* frame_pool_;
+
  protected:
   // The StackFrameSymbolizer implementation.
   StackFrameSymbolizer* frame_symbolizer_;
 
  private:
+  // Summary of modules_ used to skip stack words that can't be return
+  // addresses without looking them up.  Built by the first stack scan.
+  ModuleAddressFilter module_filter_;
+  bool module_filter_initialized_;
+
+  // modules_, if it is a BasicCodeModules, as it is for modules copied
+  // into a ProcessState.  Its lookups are used by stack scans in place of
+  // modules_'s virtual ones.  Set along with module_filter_.
+  const BasicCodeModules* basic_modules_;
+
+  // Sets up module_filter_ and basic_modules_ for modules_, which must not
+  // be NULL, the first time it is called.
+  void InitModuleFilter() {
+    if (!module_filter_initialized_) {
+      module_filter_.Init(modules_);
+      module_filter_initialized_ = true;
+      basic_modules_ = dynamic_cast<const BasicCodeModules*>(modules_);
+    }
+  }
+
+  // Looks |address| up in modules_, after InitModuleFilter.
+  bool ModulesContain(uint64_t address) const {
+    return basic_modules_ ? basic_modules_->ContainsAddress(address) :
+                            modules_->GetModuleForAddress(address) != NULL;
+  }
+
+  // Charges |words| scanned stack words to the current walk and budget_,
+  // and records them in stats_.
+  void ChargeScannedWords(uint64_t words) {
+    if (budget_) {
+      words_scanned_ += words;
+      budget_->AddScannedWords(words);
+    }
+    if (stats_)
+      stats_->AddScannedWords(words);
+  }
+
+  // Returns true if the current walk may go on to another frame, charging
+  // the symbolizer call that frame will need.  Sets budget_exhausted_ if
+  // not.
+  bool ChargeNextFrame();
+
+  // Resets the current walk's use of budget_, before walking |stack|.
+  void StartWalk(CallStack* stack);
+
+  // Walks |stack| on from |first_frame|, which may be NULL and is taken
+  // ownership of, to its outermost frame.  |scanned_frames| is the count of
+  // dubious frames already in |stack|.  Returns as Walk does.
+  bool WalkFrom(StackFrame* first_frame,
+                uint32_t scanned_frames,
+                CallStack* stack,
+                vector<const CodeModule*>* modules_without_symbols,
+                vector<const CodeModule*>* modules_with_corrupt_symbols);
+
+  // See set_budget.  The rest is the current walk's use of budget_, and
+  // whether that has reached a limit.
+  StackwalkBudget* budget_;
+  uint64_t words_scanned_;
+  uint64_t symbolizer_calls_;
+  StackwalkBudget::Clock::time_point walk_start_;
+  bool budget_exhausted_;
+
+  // See set_stats.
+  ProcessStats* stats_;
+
+  // See set_validity_cache.
+  AddressValidityCache* validity_cache_;
+
+  // See set_defer_source_line_info.
+  bool defer_source_line_info_;
+
   // Obtains the context frame, the innermost called procedure in a stack
   // trace.  Returns NULL on failure.  GetContextFrame allocates a new
   // StackFrame (or StackFrame subclass), ownership of which is taken by
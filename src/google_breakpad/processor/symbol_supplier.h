@@ -32,6 +32,9 @@
 #ifndef GOOGLE_BREAKPAD_PROCESSOR_SYMBOL_SUPPLIER_H__
 #define GOOGLE_BREAKPAD_PROCESSOR_SYMBOL_SUPPLIER_H__
 
+#include <stddef.h>
+
+#include <functional>
 #include <string>
 #include "common/using_std_string.h"
 
@@ -91,6 +94,34 @@ class SymbolSupplier {
 
   // Frees the data buffer allocated for the module in GetCStringSymbolData.
   virtual void FreeSymbolData(const CodeModule* module) = 0;
+
+  // Receives the result of GetCStringSymbolDataAsync.  The arguments are
+  // those GetCStringSymbolData would have produced; as there, the caller
+  // must call FreeSymbolData(module) once symbol_data is no longer needed.
+  typedef std::function<void(SymbolResult result,
+                             const string& symbol_file,
+                             char* symbol_data,
+                             size_t symbol_data_size)> SymbolDataCallback;
+
+  // Starts fetching the symbol data for the given CodeModule, and calls
+  // callback exactly once with the result.  The callback may run on any
+  // thread, before or after this returns, and callbacks for different
+  // modules may run concurrently.  module and system_info must stay valid
+  // until the callback has run.  Suppliers backed by a remote store should
+  // override this so that several requests are in flight at once; the
+  // default calls GetCStringSymbolData and then callback on the calling
+  // thread.
+  virtual void GetCStringSymbolDataAsync(const CodeModule* module,
+                                         const SystemInfo* system_info,
+                                         SymbolDataCallback callback) {
+    string symbol_file;
+    char* symbol_data = NULL;
+    size_t symbol_data_size = 0;
+    SymbolResult result = GetCStringSymbolData(module, system_info,
+                                               &symbol_file, &symbol_data,
+                                               &symbol_data_size);
+    callback(result, symbol_file, symbol_data, symbol_data_size);
+  }
 };
 
 }  // namespace google_breakpad
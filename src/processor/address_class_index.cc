@@ -0,0 +1,150 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// address_class_index.cc: Classifies the addresses of a crashed process by
+// the memory they lie in.
+//
+// See address_class_index.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/address_class_index.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "google_breakpad/processor/minidump.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Prefixes for memory mapping names.
+const char kHeapPrefix[] = "[heap";
+const char kStackPrefix[] = "[stack";
+
+}  // namespace
+
+AddressClassIndex::AddressClassIndex() : combinations_(0) {
+}
+
+void AddressClassIndex::Build(const MinidumpLinuxMapsList* maps) {
+  ranges_.clear();
+  combinations_ = 0;
+  const unsigned int count = maps ? maps->get_maps_count() : 0;
+  ranges_.reserve(count);
+  for (unsigned int i = 0; i < count; ++i) {
+    const MinidumpLinuxMaps* mapping = maps->GetLinuxMapsAtIndex(i);
+    if (!mapping)
+      continue;
+    uint32_t classes = kMapped;
+    if (mapping->IsExecutable())
+      classes |= kExecutable;
+    if (mapping->IsWriteable())
+      classes |= kWritable;
+    const string pathname = mapping->GetPathname();
+    if (pathname.empty())
+      classes |= kAnonymous;
+    else if (!pathname.compare(0, strlen(kStackPrefix), kStackPrefix))
+      classes |= kStack;
+    else if (!pathname.compare(0, strlen(kHeapPrefix), kHeapPrefix))
+      classes |= kHeap;
+    Add(mapping->GetBase(), mapping->GetSize(), classes);
+  }
+  Sort();
+}
+
+void AddressClassIndex::Add(uint64_t base, uint64_t size, uint32_t classes) {
+  if (size == 0)
+    return;
+  Range range = { base, base + size, classes };
+  ranges_.push_back(range);
+  combinations_ |= uint64_t(1) << (classes & 63);
+}
+
+void AddressClassIndex::Sort() {
+  // Mappings are normally listed in address order already.
+  if (!std::is_sorted(ranges_.begin(), ranges_.end()))
+    std::stable_sort(ranges_.begin(), ranges_.end());
+}
+
+size_t AddressClassIndex::Find(uint64_t address) const {
+  Range key = { address, 0, 0 };
+  std::vector<Range>::const_iterator after =
+      std::upper_bound(ranges_.begin(), ranges_.end(), key);
+  if (after == ranges_.begin())
+    return ranges_.size();
+  return after - ranges_.begin() - 1;
+}
+
+uint32_t AddressClassIndex::Classify(uint64_t address) const {
+  size_t index = Find(address);
+  if (index == ranges_.size() || address >= ranges_[index].end)
+    return 0;
+  return ranges_[index].classes;
+}
+
+void AddressClassIndex::Classify(const uint64_t* addresses, size_t count,
+                                 uint32_t* classes) const {
+  // Visit the addresses in order, so that each search resumes where the
+  // last one ended.
+  std::vector<size_t> order(count);
+  for (size_t i = 0; i < count; ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [addresses](size_t a, size_t b) {
+    return addresses[a] < addresses[b];
+  });
+
+  std::vector<Range>::const_iterator next = ranges_.begin();
+  for (size_t i = 0; i < count; ++i) {
+    const uint64_t address = addresses[order[i]];
+    Range key = { address, 0, 0 };
+    next = std::upper_bound(next, ranges_.end(), key);
+    classes[order[i]] =
+        next != ranges_.begin() && address < (next - 1)->end
+            ? (next - 1)->classes
+            : 0;
+  }
+}
+
+bool AddressClassIndex::HasMappingWith(uint32_t classes) const {
+  for (uint32_t combination = 0; combination < 64; ++combination) {
+    if ((combinations_ >> combination) & 1 &&
+        (combination & classes) == classes) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace google_breakpad
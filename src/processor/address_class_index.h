@@ -0,0 +1,110 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// address_class_index.h: Classifies the addresses of a crashed process by
+// the memory they lie in.
+//
+// The exploitability rules ask of a few addresses whether they lie in
+// executable, writable, stack or heap memory, and whether any such memory
+// is both executable and stack or heap.  AddressClassIndex answers all of
+// these from one sorted table of the process's mappings, built once per
+// minidump, instead of walking the mappings for each question.
+
+#ifndef PROCESSOR_ADDRESS_CLASS_INDEX_H__
+#define PROCESSOR_ADDRESS_CLASS_INDEX_H__
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+class MinidumpLinuxMapsList;
+
+class AddressClassIndex {
+ public:
+  // The classes an address can have, as bits of a mask.  An address that
+  // lies in no mapping has none.
+  enum Class {
+    kMapped = 1 << 0,
+    kExecutable = 1 << 1,
+    kWritable = 1 << 2,
+    kStack = 1 << 3,
+    kHeap = 1 << 4,
+    // The mapping has no name, so whether it is a stack or heap is unknown.
+    kAnonymous = 1 << 5
+  };
+
+  AddressClassIndex();
+
+  // Replaces the index with the mappings in maps, which may be NULL.
+  void Build(const MinidumpLinuxMapsList* maps);
+
+  // Adds the mapping from base to base + size, with the classes in
+  // classes.  Sort must be called after the last mapping is added.
+  void Add(uint64_t base, uint64_t size, uint32_t classes);
+  void Sort();
+
+  // Returns the classes of address.
+  uint32_t Classify(uint64_t address) const;
+
+  // Stores the classes of each of the count addresses in classes, looking
+  // them all up with one pass over the mappings.
+  void Classify(const uint64_t* addresses, size_t count,
+                uint32_t* classes) const;
+
+  // Returns true if some mapping has every class in classes.
+  bool HasMappingWith(uint32_t classes) const;
+
+  bool empty() const { return ranges_.empty(); }
+
+ private:
+  struct Range {
+    uint64_t base;
+    uint64_t end;
+    uint32_t classes;
+
+    bool operator<(const Range& other) const { return base < other.base; }
+  };
+
+  // Returns the index of the last range whose base is at most address, or
+  // ranges_.size() if there is none.
+  size_t Find(uint64_t address) const;
+
+  std::vector<Range> ranges_;
+
+  // Bit c is set if some mapping's classes are exactly c.
+  uint64_t combinations_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_ADDRESS_CLASS_INDEX_H__
@@ -0,0 +1,114 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// address_class_index_unittest.cc: Unit tests for AddressClassIndex.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "breakpad_googletest_includes.h"
+#include "processor/address_class_index.h"
+
+namespace {
+
+using google_breakpad::AddressClassIndex;
+
+const uint32_t kCode =
+    AddressClassIndex::kMapped | AddressClassIndex::kExecutable;
+const uint32_t kData =
+    AddressClassIndex::kMapped | AddressClassIndex::kWritable |
+    AddressClassIndex::kAnonymous;
+const uint32_t kStack =
+    AddressClassIndex::kMapped | AddressClassIndex::kWritable |
+    AddressClassIndex::kStack;
+
+class AddressClassIndexTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    // Added out of order, to be sorted.
+    index_.Add(0x7000, 0x1000, kStack);
+    index_.Add(0x1000, 0x1000, kCode);
+    index_.Add(0x2000, 0x800, kData);
+    index_.Sort();
+  }
+
+  AddressClassIndex index_;
+};
+
+TEST_F(AddressClassIndexTest, ClassifiesOneAddress) {
+  EXPECT_EQ(0U, index_.Classify(0));
+  EXPECT_EQ(0U, index_.Classify(0xfff));
+  EXPECT_EQ(kCode, index_.Classify(0x1000));
+  EXPECT_EQ(kCode, index_.Classify(0x1fff));
+  EXPECT_EQ(kData, index_.Classify(0x2000));
+  EXPECT_EQ(0U, index_.Classify(0x2800));
+  EXPECT_EQ(kStack, index_.Classify(0x7fff));
+  EXPECT_EQ(0U, index_.Classify(0x8000));
+  EXPECT_EQ(0U, index_.Classify(~0ULL));
+}
+
+TEST_F(AddressClassIndexTest, ClassifiesAddressesTogether) {
+  const uint64_t addresses[] = {
+    0x7800, 0x1004, 0x2900, 0x0, 0x2004, 0x1008, 0x9000
+  };
+  const size_t count = sizeof(addresses) / sizeof(addresses[0]);
+  uint32_t classes[count];
+  index_.Classify(addresses, count, classes);
+  for (size_t i = 0; i < count; ++i)
+    EXPECT_EQ(index_.Classify(addresses[i]), classes[i]) << i;
+  EXPECT_EQ(kStack, classes[0]);
+  EXPECT_EQ(kCode, classes[1]);
+}
+
+TEST_F(AddressClassIndexTest, FindsMappingsWithClasses) {
+  EXPECT_TRUE(index_.HasMappingWith(AddressClassIndex::kExecutable));
+  EXPECT_TRUE(index_.HasMappingWith(AddressClassIndex::kWritable |
+                                    AddressClassIndex::kStack));
+  EXPECT_FALSE(index_.HasMappingWith(AddressClassIndex::kExecutable |
+                                     AddressClassIndex::kStack));
+  EXPECT_FALSE(index_.HasMappingWith(AddressClassIndex::kHeap));
+
+  index_.Add(0x9000, 0x1000,
+             AddressClassIndex::kMapped | AddressClassIndex::kExecutable |
+             AddressClassIndex::kHeap);
+  index_.Sort();
+  EXPECT_TRUE(index_.HasMappingWith(AddressClassIndex::kExecutable |
+                                    AddressClassIndex::kHeap));
+}
+
+TEST(AddressClassIndexEmptyTest, ClassifiesNothing) {
+  AddressClassIndex index;
+  index.Build(NULL);
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(0U, index.Classify(0x1000));
+  EXPECT_FALSE(index.HasMappingWith(AddressClassIndex::kMapped));
+}
+
+}  // namespace
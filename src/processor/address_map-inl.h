@@ -46,6 +46,13 @@ namespace google_breakpad {
 template<typename AddressType, typename EntryType>
 bool AddressMap<AddressType, EntryType>::Store(const AddressType& address,
                                                const EntryType& entry) {
+  // An address above every stored one, as most are when read from a symbol
+  // file, is appended at the end of the map without searching it.
+  if (map_.empty() || address > map_.rbegin()->first) {
+    map_.emplace_hint(map_.end(), address, entry);
+    return true;
+  }
+
   // Ensure that the specified address doesn't conflict with something already
   // in the map.
   if (map_.find(address) != map_.end()) {
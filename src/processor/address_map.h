@@ -43,6 +43,7 @@ namespace google_breakpad {
 
 // Forward declarations (for later friend declarations).
 template<class, class> class AddressMapSerializer;
+template<typename, typename> class FlatAddressMap;
 
 template<typename AddressType, typename EntryType>
 class AddressMap {
@@ -68,6 +69,7 @@ class AddressMap {
 
  private:
   friend class AddressMapSerializer<AddressType, EntryType>;
+  friend class FlatAddressMap<AddressType, EntryType>;
   friend class ModuleComparer;
 
   // Convenience types.
@@ -0,0 +1,106 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// address_validity_cache.h: Remembers which code addresses stack scanning
+// found to be plausible return addresses.
+//
+// Stack scanning checks each candidate return address with
+// Stackwalker::InstructionAddressSeemsValid, which looks the address up in
+// the modules and then in their symbols.  The stacks of a minidump's
+// threads hold many of the same code addresses, and one stack is often
+// scanned over the same words for several frames, so the same addresses
+// are checked over and over.  An AddressValidityCache, shared by the
+// stackwalkers of all the threads of one minidump, keeps the results of
+// the most recent checks in a small table, which holds an address in a
+// single word so that threads walking at the same time can use it
+// without locks.
+
+#ifndef PROCESSOR_ADDRESS_VALIDITY_CACHE_H__
+#define PROCESSOR_ADDRESS_VALIDITY_CACHE_H__
+
+#include <stddef.h>
+
+#include <atomic>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+class AddressValidityCache {
+ public:
+  // The table has 2^kIndexBits slots, each of which holds the result for
+  // one address at a time.
+  static const int kIndexBits = 12;
+  static const size_t kSlots = static_cast<size_t>(1) << kIndexBits;
+
+  AddressValidityCache() {
+    for (size_t i = 0; i < kSlots; ++i)
+      slots_[i].store(0, std::memory_order_relaxed);
+  }
+
+  // Returns true, setting |*valid| to the result recorded for |address|,
+  // if one is still in the table.
+  bool Lookup(uint64_t address, bool* valid) const {
+    uint64_t entry = slots_[Index(address)].load(std::memory_order_relaxed);
+    if ((entry & kPresent) == 0 || entry >> kStateBits != Tag(address))
+      return false;
+    *valid = (entry & kValid) != 0;
+    return true;
+  }
+
+  // Records |valid| as the result for |address|, in place of the result
+  // for whichever address shared its slot.
+  void Insert(uint64_t address, bool valid) {
+    slots_[Index(address)].store(
+        Tag(address) << kStateBits | kPresent | (valid ? kValid : 0),
+        std::memory_order_relaxed);
+  }
+
+ private:
+  // An entry holds the address's tag above two bits of state.  Its slot
+  // mixes the bits the tag leaves out with the low bits of the tag, so
+  // that the tag and the slot together give the whole address back.
+  static const int kStateBits = 2;
+  static const uint64_t kPresent = 1;
+  static const uint64_t kValid = 2;
+
+  static uint64_t Tag(uint64_t address) { return address >> kIndexBits; }
+  static size_t Index(uint64_t address) {
+    return static_cast<size_t>((address ^ Tag(address)) & (kSlots - 1));
+  }
+
+  std::atomic<uint64_t> slots_[kSlots];
+
+  // Disallow unwanted copy ctor and assignment operator
+  AddressValidityCache(const AddressValidityCache&);
+  void operator=(const AddressValidityCache&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_ADDRESS_VALIDITY_CACHE_H__
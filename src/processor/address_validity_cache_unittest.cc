@@ -0,0 +1,122 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// address_validity_cache_unittest.cc: Unit tests for AddressValidityCache.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/address_validity_cache.h"
+
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+
+namespace {
+
+using google_breakpad::AddressValidityCache;
+
+TEST(AddressValidityCache, Empty) {
+  AddressValidityCache cache;
+  bool valid;
+  EXPECT_FALSE(cache.Lookup(0, &valid));
+  EXPECT_FALSE(cache.Lookup(0x401000, &valid));
+}
+
+TEST(AddressValidityCache, Results) {
+  AddressValidityCache cache;
+  cache.Insert(0x401000, true);
+  cache.Insert(0x7f0000123456ULL, false);
+  cache.Insert(0xfffffffffffff000ULL, true);
+
+  bool valid = false;
+  EXPECT_TRUE(cache.Lookup(0x401000, &valid));
+  EXPECT_TRUE(valid);
+  EXPECT_TRUE(cache.Lookup(0x7f0000123456ULL, &valid));
+  EXPECT_FALSE(valid);
+  EXPECT_TRUE(cache.Lookup(0xfffffffffffff000ULL, &valid));
+  EXPECT_TRUE(valid);
+
+  // Nearby addresses, and addresses with the same low bits, aren't found.
+  EXPECT_FALSE(cache.Lookup(0x401001, &valid));
+  EXPECT_FALSE(cache.Lookup(0x402000, &valid));
+  EXPECT_FALSE(cache.Lookup(0x1401000, &valid));
+
+  // A later result for the same address replaces the earlier one.
+  cache.Insert(0x401000, false);
+  EXPECT_TRUE(cache.Lookup(0x401000, &valid));
+  EXPECT_FALSE(valid);
+}
+
+TEST(AddressValidityCache, SharedSlot) {
+  // 0x1000 and 0x2003 share a slot, so each pushes the other out.
+  AddressValidityCache cache;
+  bool valid;
+  cache.Insert(0x1000, true);
+  cache.Insert(0x2003, false);
+  EXPECT_FALSE(cache.Lookup(0x1000, &valid));
+  EXPECT_TRUE(cache.Lookup(0x2003, &valid));
+  EXPECT_FALSE(valid);
+  cache.Insert(0x1000, true);
+  EXPECT_FALSE(cache.Lookup(0x2003, &valid));
+  EXPECT_TRUE(cache.Lookup(0x1000, &valid));
+  EXPECT_TRUE(valid);
+}
+
+TEST(AddressValidityCache, Threads) {
+  // Threads sharing a cache only ever find the results recorded for the
+  // addresses they look up.
+  AddressValidityCache cache;
+  const uint64_t kAddresses = 3 * AddressValidityCache::kSlots;
+  std::vector<std::thread> threads;
+  std::vector<int> mismatches(4, 0);
+  for (int t = 0; t < 4; ++t) {
+    threads.push_back(std::thread([&cache, &mismatches, kAddresses, t]() {
+      for (int pass = 0; pass < 8; ++pass) {
+        for (uint64_t i = 0; i < kAddresses; ++i) {
+          uint64_t address = 0x7f0000000000ULL + (i * 7 + t) * 0x41;
+          bool valid;
+          if (cache.Lookup(address, &valid)) {
+            if (valid != ((address & 4) != 0))
+              ++mismatches[t];
+          } else {
+            cache.Insert(address, (address & 4) != 0);
+          }
+        }
+      }
+    }));
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  for (int t = 0; t < 4; ++t)
+    EXPECT_EQ(0, mismatches[t]);
+}
+
+}  // namespace
@@ -0,0 +1,129 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// arena.cc: A bump allocator for objects freed all at once.
+//
+// See arena.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/arena.h"
+
+#include <stdint.h>
+
+namespace google_breakpad {
+
+namespace {
+
+// Size of the blocks objects are carved from by default.
+const size_t kDefaultBlockSize = 64 * 1024;
+
+}  // namespace
+
+Arena::Arena()
+    : block_size_(kDefaultBlockSize),
+      block_free_(NULL),
+      block_left_(0),
+      block_bytes_(0) {}
+
+Arena::Arena(size_t block_size)
+    : block_size_(block_size),
+      block_free_(NULL),
+      block_left_(0),
+      block_bytes_(0) {}
+
+Arena::~Arena() {
+  RunCleanups();
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  if (size > block_size_ / 4) {
+    large_blocks_.push_back(std::unique_ptr<char[]>(new char[size]));
+    block_bytes_ += size;
+    return large_blocks_.back().get();
+  }
+  size_t padding =
+      -reinterpret_cast<uintptr_t>(block_free_) & (alignment - 1);
+  if (padding + size > block_left_) {
+    blocks_.push_back(std::unique_ptr<char[]>(new char[block_size_]));
+    block_bytes_ += block_size_;
+    block_free_ = blocks_.back().get();
+    block_left_ = block_size_;
+    padding = 0;
+  }
+  char* result = block_free_ + padding;
+  block_free_ = result + size;
+  block_left_ -= padding + size;
+  return result;
+}
+
+void Arena::Adopt(Arena* other) {
+  // Keep filling this arena's current block; |other|'s partly used block is
+  // simply retired.
+  blocks_.reserve(blocks_.size() + other->blocks_.size());
+  for (std::unique_ptr<char[]>& block : other->blocks_)
+    blocks_.push_back(std::move(block));
+  for (std::unique_ptr<char[]>& block : other->large_blocks_)
+    large_blocks_.push_back(std::move(block));
+  cleanups_.insert(cleanups_.end(), other->cleanups_.begin(),
+                   other->cleanups_.end());
+  block_bytes_ += other->block_bytes_;
+  other->blocks_.clear();
+  other->large_blocks_.clear();
+  other->cleanups_.clear();
+  other->block_free_ = NULL;
+  other->block_left_ = 0;
+  other->block_bytes_ = 0;
+}
+
+void Arena::Clear() {
+  RunCleanups();
+  large_blocks_.clear();
+  block_bytes_ = 0;
+  if (blocks_.empty())
+    return;
+  blocks_.resize(1);
+  block_free_ = blocks_[0].get();
+  block_left_ = block_size_;
+  block_bytes_ = block_size_;
+}
+
+void Arena::AddCleanup(void* object, void (*destroy)(void* object)) {
+  Cleanup cleanup = {object, destroy};
+  cleanups_.push_back(cleanup);
+}
+
+void Arena::RunCleanups() {
+  for (size_t i = cleanups_.size(); i > 0; --i)
+    cleanups_[i - 1].destroy(cleanups_[i - 1].object);
+  std::vector<Cleanup>().swap(cleanups_);
+}
+
+}  // namespace google_breakpad
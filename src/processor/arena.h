@@ -0,0 +1,118 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// arena.h: Arena, a bump allocator for objects freed all at once.
+//
+// Arena carves objects out of large blocks of memory, and destroys and frees
+// them together when the arena goes away.  A loaded symbol module keeps its
+// records in one, so loading it costs a malloc per block rather than per
+// record, and unloading it frees the blocks after running the destructors
+// of the records that have one.
+
+#ifndef PROCESSOR_ARENA_H__
+#define PROCESSOR_ARENA_H__
+
+#include <stddef.h>
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace google_breakpad {
+
+class Arena {
+ public:
+  Arena();
+  // Carves objects out of blocks of |block_size| bytes, for arenas that hold
+  // little.  Allocations over a quarter of that get a block of their own.
+  explicit Arena(size_t block_size);
+  ~Arena();
+
+  // Constructs a T from |args| in the arena.  The object lives until the
+  // arena is destroyed or cleared, and must not be deleted.
+  template<typename T, typename... Args>
+  T* New(Args&&... args) {
+    T* object = new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value)
+      AddCleanup(object, &Destroy<T>);
+    return object;
+  }
+
+  // Returns |size| bytes of uninitialized memory aligned to |alignment|,
+  // which must be a power of two no larger than alignof(max_align_t).
+  void* Allocate(size_t size, size_t alignment);
+
+  // Moves the objects of |other| into this arena, leaving |other| empty.
+  // Used to gather the records of symbol file sections parsed on separate
+  // threads into one module.
+  void Adopt(Arena* other);
+
+  // Destroys all objects and frees all memory but the first block, which
+  // later allocations reuse.
+  void Clear();
+
+  // Returns the number of bytes the arena has allocated for its blocks.
+  size_t allocated_bytes() const { return block_bytes_; }
+
+ private:
+  // A destructor to run when the arena is destroyed.
+  struct Cleanup {
+    void* object;
+    void (*destroy)(void* object);
+  };
+
+  template<typename T>
+  static void Destroy(void* object) {
+    static_cast<T*>(object)->~T();
+  }
+
+  void AddCleanup(void* object, void (*destroy)(void* object));
+
+  // Runs the destructors, most recently constructed object first.
+  void RunCleanups();
+
+  const size_t block_size_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  // Allocations too large to share a block.
+  std::vector<std::unique_ptr<char[]>> large_blocks_;
+  char* block_free_;
+  size_t block_left_;
+  size_t block_bytes_;
+  std::vector<Cleanup> cleanups_;
+
+  // Disallow copy constructor and assignment operator.
+  Arena(const Arena&);
+  void operator=(const Arena&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_ARENA_H__
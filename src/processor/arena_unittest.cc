@@ -0,0 +1,119 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// arena_unittest.cc: Unit tests for Arena.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/arena.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+
+namespace {
+
+using google_breakpad::Arena;
+using std::string;
+
+// Counts its live instances in |*count|.
+class Counted {
+ public:
+  explicit Counted(int* count) : count_(count) { ++*count_; }
+  ~Counted() { --*count_; }
+
+ private:
+  int* count_;
+};
+
+TEST(Arena, ConstructsAlignedObjects) {
+  Arena arena;
+  EXPECT_EQ(0U, arena.allocated_bytes());
+  std::vector<double*> doubles;
+  for (int i = 0; i < 20000; ++i) {
+    // Odd sized allocations in between, to misalign the next one.
+    arena.Allocate(1 + i % 7, 1);
+    doubles.push_back(arena.New<double>(i));
+  }
+  for (int i = 0; i < 20000; ++i) {
+    ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(doubles[i]) % alignof(double));
+    ASSERT_EQ(i, *doubles[i]);
+  }
+  EXPECT_GT(arena.allocated_bytes(), 20000 * sizeof(double));
+
+  string* text = arena.New<string>(100, 'x');
+  EXPECT_EQ(string(100, 'x'), *text);
+  char* large = static_cast<char*>(arena.Allocate(1 << 20, 1));
+  large[(1 << 20) - 1] = 'y';
+  EXPECT_EQ(string(100, 'x'), *text);
+}
+
+TEST(Arena, RunsDestructors) {
+  int count = 0;
+  {
+    Arena arena;
+    for (int i = 0; i < 1000; ++i)
+      arena.New<Counted>(&count);
+    EXPECT_EQ(1000, count);
+    arena.Clear();
+    EXPECT_EQ(0, count);
+    EXPECT_GT(arena.allocated_bytes(), 0U);
+    arena.New<Counted>(&count);
+    EXPECT_EQ(1, count);
+  }
+  EXPECT_EQ(0, count);
+}
+
+TEST(Arena, AdoptKeepsObjects) {
+  int count = 0;
+  Arena arena;
+  string* kept = arena.New<string>("kept");
+  {
+    Arena other;
+    arena.New<Counted>(&count);
+    other.New<Counted>(&count);
+    string* moved = other.New<string>("moved");
+    size_t other_bytes = other.allocated_bytes();
+    arena.Adopt(&other);
+    EXPECT_EQ(0U, other.allocated_bytes());
+    EXPECT_GE(arena.allocated_bytes(), other_bytes);
+    EXPECT_EQ("moved", *moved);
+  }
+  // Destroying |other| left the adopted objects alone.
+  EXPECT_EQ(2, count);
+  EXPECT_EQ("kept", *kept);
+  arena.Clear();
+  EXPECT_EQ(0, count);
+}
+
+}  // namespace
@@ -41,6 +41,11 @@
 
 #include <assert.h>
 
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "google_breakpad/processor/code_module.h"
@@ -59,35 +64,43 @@ BasicCodeModules::BasicCodeModules(const CodeModules* that,
                             "|that|";
   assert(that);
 
-  map_.SetMergeStrategy(strategy);
-
   const CodeModule *main_module = that->GetMainModule();
   if (main_module)
     main_address_ = main_module->base_address();
 
+  // The copies are stored in a map of their own rather than in map_, so
+  // that once it is gone, the Index is their only owner and can be shared.
+  ModuleMap map;
+  map.SetMergeStrategy(strategy);
+
   unsigned int count = that->module_count();
+  vector<linked_ptr<const CodeModule> > modules;
+  modules.reserve(count);
   for (unsigned int i = 0; i < count; ++i) {
     // Make a copy of the module and insert it into the map.  Use
     // GetModuleAtIndex because ordering is unimportant when slurping the
     // entire list, and GetModuleAtIndex may be faster than
     // GetModuleAtSequence.
     linked_ptr<const CodeModule> module(that->GetModuleAtIndex(i)->Copy());
-    if (!map_.StoreRange(module->base_address(), module->size(), module)) {
+    if (!map.StoreRange(module->base_address(), module->size(), module)) {
       BPLOG(ERROR) << "Module " << module->code_file()
                    << " could not be stored";
+      continue;
     }
+    modules.push_back(module);
   }
 
   // Report modules with shrunk ranges.
-  for (unsigned int i = 0; i < count; ++i) {
-    linked_ptr<const CodeModule> module(that->GetModuleAtIndex(i)->Copy());
+  for (size_t i = 0; i < modules.size(); ++i) {
+    const CodeModule* module = modules[i].get();
+    linked_ptr<const CodeModule> stored;
     uint64_t delta = 0;
-    if (map_.RetrieveRange(module->base_address() + module->size() - 1,
-                           &module, NULL /* base */, &delta, NULL /* size */) &&
+    if (map.RetrieveRange(module->base_address() + module->size() - 1,
+                          &stored, NULL /* base */, &delta, NULL /* size */) &&
         delta > 0) {
-      BPLOG(INFO) << "The range for module " << module->code_file()
+      BPLOG(INFO) << "The range for module " << stored->code_file()
                   << " was shrunk down by " << HexString(delta) << " bytes.";
-      linked_ptr<CodeModule> shrunk_range_module(module->Copy());
+      linked_ptr<CodeModule> shrunk_range_module(stored->Copy());
       shrunk_range_module->SetShrinkDownDelta(delta);
       shrunk_range_modules_.push_back(shrunk_range_module);
     }
@@ -95,27 +108,40 @@ BasicCodeModules::BasicCodeModules(const CodeModules* that,
 
   // TODO(ivanpe): Report modules with conflicting ranges.  The list of such
   // modules should be copied from |that|.
+
+  std::shared_ptr<Index> index = BuildIndex(map);
+  index->modules.swap(modules);
+  index_ = index;
 }
 
-BasicCodeModules::BasicCodeModules() : main_address_(0), map_() { }
+BasicCodeModules::BasicCodeModules() : main_address_(0), map_(),
+                                       index_(new Index()) { }
+
+BasicCodeModules::BasicCodeModules(const BasicCodeModules* that)
+    : main_address_(that->main_address_),
+      map_(),
+      index_(that->index_) {
+  // GetShrunkRangeModules hands out linked_ptrs to these, so they are not
+  // shared with |that|.
+  for (size_t i = 0; i < that->shrunk_range_modules_.size(); ++i) {
+    shrunk_range_modules_.push_back(linked_ptr<const CodeModule>(
+        that->shrunk_range_modules_[i]->Copy()));
+  }
+}
 
 BasicCodeModules::~BasicCodeModules() {
 }
 
 unsigned int BasicCodeModules::module_count() const {
-  return map_.GetCount();
+  return static_cast<unsigned int>(index_->ranges.size());
 }
 
 const CodeModule* BasicCodeModules::GetModuleForAddress(
     uint64_t address) const {
-  linked_ptr<const CodeModule> module;
-  if (!map_.RetrieveRange(address, &module, NULL /* base */, NULL /* delta */,
-                          NULL /* size */)) {
+  const CodeModule* module = FindModule(address);
+  if (!module)
     BPLOG(INFO) << "No module at " << HexString(address);
-    return NULL;
-  }
-
-  return module.get();
+  return module;
 }
 
 const CodeModule* BasicCodeModules::GetMainModule() const {
@@ -124,27 +150,38 @@ const CodeModule* BasicCodeModules::GetMainModule() const {
 
 const CodeModule* BasicCodeModules::GetModuleAtSequence(
     unsigned int sequence) const {
-  linked_ptr<const CodeModule> module;
-  if (!map_.RetrieveRangeAtIndex(sequence, &module, NULL /* base */,
-                                 NULL /* delta */, NULL /* size */)) {
-    BPLOG(ERROR) << "RetrieveRangeAtIndex failed for sequence " << sequence;
+  const vector<ModuleRange>& ranges = index_->ranges;
+  if (sequence >= ranges.size()) {
+    BPLOG(ERROR) << "Index out of range: " << sequence << "/"
+                 << ranges.size();
     return NULL;
   }
 
-  return module.get();
+  return ranges[sequence].module;
 }
 
 const CodeModule* BasicCodeModules::GetModuleAtIndex(
     unsigned int index) const {
-  // This class stores everything in a RangeMap, without any more-efficient
-  // way to walk the list of CodeModule objects.  Implement GetModuleAtIndex
-  // using GetModuleAtSequence, which meets all of the requirements, and
-  // in addition, guarantees ordering.
+  // The modules are indexed in address order, so GetModuleAtSequence meets
+  // all of the requirements, and in addition, guarantees ordering.
   return GetModuleAtSequence(index);
 }
 
+const CodeModule* BasicCodeModules::GetModuleForCodeFile(
+    const string& code_file) const {
+  std::unordered_map<string, unsigned int>::const_iterator it =
+      index_->code_files.find(code_file);
+  if (it == index_->code_files.end())
+    return NULL;
+  return index_->ranges[it->second].module;
+}
+
 const CodeModules* BasicCodeModules::Copy() const {
-  return new BasicCodeModules(this, map_.GetMergeStrategy());
+  // An Index over modules in map_ doesn't keep them alive, so the copy
+  // needs modules of its own.
+  if (index_->modules.empty() && !index_->ranges.empty())
+    return new BasicCodeModules(this, map_.GetMergeStrategy());
+  return new BasicCodeModules(this);
 }
 
 vector<linked_ptr<const CodeModule> >
@@ -152,4 +189,43 @@ BasicCodeModules::GetShrunkRangeModules() const {
   return shrunk_range_modules_;
 }
 
+void BasicCodeModules::IndexModules() {
+  index_ = BuildIndex(map_);
+}
+
+// static
+std::shared_ptr<BasicCodeModules::Index> BasicCodeModules::BuildIndex(
+    const ModuleMap& map) {
+  std::shared_ptr<Index> index(new Index());
+  vector<ModuleRange>& ranges = index->ranges;
+  ranges.reserve(map.GetCount());
+
+  // Walk the map from the top down, one nearest-range lookup per module,
+  // rather than by RetrieveRangeAtIndex, which walks the map from its start
+  // on every call.
+  uint64_t address = ~static_cast<uint64_t>(0);
+  linked_ptr<const CodeModule> module;
+  uint64_t base = 0;
+  uint64_t size = 0;
+  while (map.RetrieveNearestRange(address, &module, &base, NULL /* delta */,
+                                  &size)) {
+    ModuleRange range = { base, base + size - 1, module.get() };
+    ranges.push_back(range);
+    if (base == 0)
+      break;
+    address = base - 1;
+  }
+  std::reverse(ranges.begin(), ranges.end());
+
+  // Visiting the modules from the top down would leave the highest of any
+  // with the same code_file in the map, so insert them in address order.
+  index->code_files.reserve(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    index->code_files.insert(
+        std::make_pair(ranges[i].module->code_file(),
+                       static_cast<unsigned int>(i)));
+  }
+  return index;
+}
+
 }  // namespace google_breakpad
@@ -42,6 +42,10 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "google_breakpad/processor/code_modules.h"
@@ -56,7 +60,9 @@ class BasicCodeModules : public CodeModules {
   // implementation.  This is useful to make a copy of the data relevant to
   // the CodeModules and CodeModule interfaces without requiring all of the
   // resources that other implementations may require.  A copy will be
-  // made of each contained CodeModule using CodeModule::Copy.
+  // made of each contained CodeModule using CodeModule::Copy.  The copies
+  // and the indexes over them are immutable, so Copy() shares them rather
+  // than copying each module again.
   BasicCodeModules(const CodeModules *that, MergeRangeStrategy strategy);
 
   virtual ~BasicCodeModules();
@@ -67,13 +73,37 @@ class BasicCodeModules : public CodeModules {
   virtual const CodeModule* GetMainModule() const;
   virtual const CodeModule* GetModuleAtSequence(unsigned int sequence) const;
   virtual const CodeModule* GetModuleAtIndex(unsigned int index) const;
+  virtual const CodeModule* GetModuleForCodeFile(
+      const string& code_file) const;
   virtual const CodeModules* Copy() const;
   virtual std::vector<linked_ptr<const CodeModule> >
   GetShrunkRangeModules() const;
 
+  // Returns the module containing |address|, or NULL if there is none.
+  // This is GetModuleForAddress without the virtual call or the logging of
+  // misses, for callers such as stack scanning that test many addresses
+  // which are mostly not code.
+  const CodeModule* FindModule(uint64_t address) const {
+    const std::vector<ModuleRange>& ranges = index_->ranges;
+    std::vector<ModuleRange>::const_iterator range =
+        std::lower_bound(ranges.begin(), ranges.end(), address);
+    if (range == ranges.end() || address < range->base)
+      return NULL;
+    return range->module;
+  }
+
+  // Returns true if |address| is within any module.
+  bool ContainsAddress(uint64_t address) const {
+    return FindModule(address) != NULL;
+  }
+
  protected:
   BasicCodeModules();
 
+  // Rebuilds the indexes from map_.  Subclasses that store modules in map_
+  // must call this after changing it.
+  void IndexModules();
+
   // The base address of the main module.
   uint64_t main_address_;
 
@@ -86,6 +116,43 @@ class BasicCodeModules : public CodeModules {
   std::vector<linked_ptr<const CodeModule> > shrunk_range_modules_;
 
  private:
+  // The address range a module occupies in map_, after any shrinking.
+  struct ModuleRange {
+    uint64_t base;
+    uint64_t high;
+    const CodeModule* module;
+
+    // Orders ranges by their high address, for lower_bound.
+    bool operator<(uint64_t address) const { return high < address; }
+  };
+
+  // The lookup structures over a set of modules.  An Index is never changed
+  // once built, so copies of a BasicCodeModules share it.
+  struct Index {
+    // The modules, if the Index owns them.  When the modules are in map_,
+    // they are owned by map_ instead, and the Index can't be shared.
+    std::vector<linked_ptr<const CodeModule> > modules;
+
+    // The modules' ranges, in address order.  A binary search of this array
+    // is cheaper than a lookup in a RangeMap, and its index is the
+    // sequence, so lookups by address and sequence share it.
+    std::vector<ModuleRange> ranges;
+
+    // The sequence of the lowest module with each code_file.
+    std::unordered_map<string, unsigned int> code_files;
+  };
+
+  typedef RangeMap<uint64_t, linked_ptr<const CodeModule> > ModuleMap;
+
+  // Creates a copy of |that| which shares its Index.
+  explicit BasicCodeModules(const BasicCodeModules* that);
+
+  // Returns a new Index over the modules in |map|.  The Index doesn't own
+  // the modules.
+  static std::shared_ptr<Index> BuildIndex(const ModuleMap& map);
+
+  std::shared_ptr<const Index> index_;
+
   // Disallow copy constructor and assignment operator.
   BasicCodeModules(const BasicCodeModules& that);
   void operator=(const BasicCodeModules& that);
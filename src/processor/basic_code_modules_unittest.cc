@@ -0,0 +1,170 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// basic_code_modules_unittest.cc: Unit tests for BasicCodeModules.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/basic_code_modules.h"
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/microdump.h"
+#include "processor/basic_code_module.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicCodeModules;
+using google_breakpad::CodeModule;
+using google_breakpad::CodeModules;
+using google_breakpad::MicrodumpModules;
+using google_breakpad::scoped_ptr;
+
+CodeModule* NewModule(uint64_t base, uint64_t size, const string& name) {
+  return new BasicCodeModule(base, size, name, "id", name, "id", "1");
+}
+
+class BasicCodeModulesTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    // Added out of address order, with one module at address 0 and one at
+    // the top of the address space.
+    modules_.Add(NewModule(0x20000, 0x1000, "middle"));
+    modules_.Add(NewModule(0, 0x1000, "bottom"));
+    modules_.Add(NewModule(0xfffffffffffff000ULL, 0x1000, "top"));
+    modules_.Add(NewModule(0x10000, 0x1000, "low"));
+  }
+
+  MicrodumpModules modules_;
+};
+
+TEST_F(BasicCodeModulesTest, Lookup) {
+  struct {
+    uint64_t address;
+    const char* module;
+  } cases[] = {
+    { 0, "bottom" },
+    { 0xfff, "bottom" },
+    { 0x1000, NULL },
+    { 0xffff, NULL },
+    { 0x10000, "low" },
+    { 0x10fff, "low" },
+    { 0x11000, NULL },
+    { 0x20800, "middle" },
+    { 0xffffffffffffefffULL, NULL },
+    { 0xfffffffffffff000ULL, "top" },
+    { 0xffffffffffffffffULL, "top" },
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+    const CodeModule* module = modules_.GetModuleForAddress(cases[i].address);
+    EXPECT_EQ(module, modules_.FindModule(cases[i].address)) << i;
+    EXPECT_EQ(cases[i].module != NULL,
+              modules_.ContainsAddress(cases[i].address)) << i;
+    if (cases[i].module) {
+      ASSERT_TRUE(module) << i;
+      EXPECT_EQ(cases[i].module, module->code_file()) << i;
+    } else {
+      EXPECT_FALSE(module) << i;
+    }
+  }
+}
+
+TEST_F(BasicCodeModulesTest, Sequence) {
+  const char* expected[] = { "bottom", "low", "middle", "top" };
+  ASSERT_EQ(4U, modules_.module_count());
+  for (unsigned int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(modules_.GetModuleAtSequence(i));
+    EXPECT_EQ(expected[i], modules_.GetModuleAtSequence(i)->code_file());
+    EXPECT_EQ(modules_.GetModuleAtSequence(i), modules_.GetModuleAtIndex(i));
+  }
+  EXPECT_FALSE(modules_.GetModuleAtSequence(4));
+}
+
+TEST_F(BasicCodeModulesTest, Copy) {
+  scoped_ptr<const CodeModules> copy(modules_.Copy());
+  ASSERT_EQ(4U, copy->module_count());
+  EXPECT_EQ("bottom", copy->GetModuleAtSequence(0)->code_file());
+  EXPECT_EQ("top", copy->GetModuleAtSequence(3)->code_file());
+  ASSERT_TRUE(copy->GetModuleForAddress(0x10800));
+  EXPECT_EQ("low", copy->GetModuleForAddress(0x10800)->code_file());
+  EXPECT_FALSE(copy->GetModuleForAddress(0x30000));
+}
+
+TEST_F(BasicCodeModulesTest, CopyOfCopy) {
+  // A copy of a copy shares its modules with the first copy.
+  scoped_ptr<const CodeModules> copy(modules_.Copy());
+  scoped_ptr<const CodeModules> second(copy->Copy());
+  ASSERT_EQ(4U, second->module_count());
+  for (unsigned int i = 0; i < 4; ++i)
+    EXPECT_EQ(copy->GetModuleAtSequence(i), second->GetModuleAtSequence(i));
+  EXPECT_EQ(copy->GetMainModule(), second->GetMainModule());
+
+  // The copies outlive the object they were made from.
+  copy.reset();
+  ASSERT_TRUE(second->GetModuleForAddress(0x20800));
+  EXPECT_EQ("middle", second->GetModuleForAddress(0x20800)->code_file());
+}
+
+TEST_F(BasicCodeModulesTest, CodeFile) {
+  modules_.Add(NewModule(0x30000, 0x1000, "low"));
+
+  const CodeModule* module = modules_.GetModuleForCodeFile("low");
+  ASSERT_TRUE(module);
+  EXPECT_EQ(0x10000U, module->base_address());
+  EXPECT_FALSE(modules_.GetModuleForCodeFile("missing"));
+
+  scoped_ptr<const CodeModules> copy(modules_.Copy());
+  module = copy->GetModuleForCodeFile("top");
+  ASSERT_TRUE(module);
+  EXPECT_EQ(0xfffffffffffff000ULL, module->base_address());
+  EXPECT_EQ(copy->GetModuleAtSequence(1), copy->GetModuleForCodeFile("low"));
+}
+
+TEST(BasicCodeModules, ShrunkRanges) {
+  // With shrinking enabled, an overlapping module is stored with its range
+  // cut down, and lookups must use the stored range.
+  MicrodumpModules modules;
+  modules.SetEnableModuleShrink(true);
+  modules.Add(NewModule(0x10000, 0x2000, "first"));
+  modules.Add(NewModule(0x11000, 0x2000, "second"));
+
+  ASSERT_EQ(2U, modules.module_count());
+  ASSERT_TRUE(modules.FindModule(0x10800));
+  EXPECT_EQ("first", modules.FindModule(0x10800)->code_file());
+  ASSERT_TRUE(modules.FindModule(0x12800));
+  EXPECT_EQ("second", modules.FindModule(0x12800)->code_file());
+  EXPECT_FALSE(modules.FindModule(0x13000));
+}
+
+}  // namespace
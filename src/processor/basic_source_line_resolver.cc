@@ -41,9 +41,12 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <atomic>
 #include <limits>
 #include <map>
 #include <memory>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -52,6 +55,7 @@
 #include "processor/module_factory.h"
 
 #include "processor/tokenize.h"
+#include "processor/windows_frame_program.h"
 
 using std::deque;
 using std::make_pair;
@@ -70,47 +74,197 @@ namespace google_breakpad {
 
 namespace {
 
-// Utility function to tokenize given the presence of an optional initial
-// field. In this case, optional_field is the expected string for the optional
-// field, and max_tokens is the maximum number of tokens including the optional
-// field. Refer to the documentation for Tokenize for descriptions of the other
-// arguments.
-bool TokenizeWithOptionalField(char* line,
-                               const char* optional_field,
-                               const char* separators,
-                               int max_tokens,
-                               vector<char*>* tokens) {
-  // First tokenize assuming the optional field is not present.  If we then see
-  // the optional field, additionally tokenize the last token into two tokens.
-  if (!Tokenize(line, separators, max_tokens - 1, tokens)) {
-    return false;
-  }
-
-  if (strcmp(tokens->front(), optional_field) == 0) {
-    // The optional field is present. Split the last token in two to recover the
-    // field prior to the last.
-    vector<char*> last_tokens;
-    if (!Tokenize(tokens->back(), separators, 2, &last_tokens)) {
+// Whether |c| separates the fields of a record, like kWhitespace below.
+inline bool IsFieldSeparator(char c) {
+  return c == ' ' || c == '\r' || c == '\n';
+}
+
+// Advances |*cursor| to the start of the next field.  Returns false if the
+// record ends first.
+inline bool SkipFieldSeparators(char** cursor) {
+  while (IsFieldSeparator(**cursor))
+    ++*cursor;
+  return **cursor != '\0';
+}
+
+inline int HexDigitValue(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  c |= 0x20;  // Lower case.
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+// Returns the end of the field starting at |field|.
+inline char* FieldEnd(char* field) {
+  while (*field != '\0' && !IsFieldSeparator(*field))
+    ++field;
+  return field;
+}
+
+// Whether a fast parse of the field at |start| that stopped at |position|
+// has to be redone with strtoull or strtol, which also accept leading
+// spaces, a sign and, for base 16, a "0x" prefix.
+inline bool NeedsLibraryParse(const char* start, const char* position) {
+  return position == start ||
+         (position == start + 1 && start[0] == '0' && (start[1] | 0x20) == 'x');
+}
+
+// Parses the number field at |*cursor| and advances |*cursor| to its end.
+// These give the same results as calling strtoull or strtol on the field
+// and checking it with SymbolParseHelper::IsValidAfterNumber, including
+// rejecting the maximum value that they return on overflow, but convert
+// plain digits without calling them.
+bool ParseHexField(char** cursor, uint64_t* value) {
+  char* start = *cursor;
+  char* position = start;
+  uint64_t result = 0;
+  int digit;
+  while ((digit = HexDigitValue(*position)) >= 0) {
+    if (result >> 60)
+      return false;  // Overflow.
+    result = (result << 4) | digit;
+    ++position;
+  }
+  if (NeedsLibraryParse(start, position)) {
+    position = FieldEnd(start);
+    char saved = *position;
+    *position = '\0';
+    char* after_number;
+    result = strtoull(start, &after_number, 16);
+    *position = saved;
+    if (after_number != position)
       return false;
-    }
-    // Replace the previous last token with the two new tokens.
-    tokens->pop_back();
-    tokens->push_back(last_tokens[0]);
-    tokens->push_back(last_tokens[1]);
+  } else if (*position != '\0' && !IsFieldSeparator(*position)) {
+    return false;
   }
+  if (result == std::numeric_limits<unsigned long long>::max())
+    return false;
+  *value = result;
+  *cursor = position;
+  return true;
+}
 
+bool ParseLongField(char** cursor, int base, long* value) {
+  char* start = *cursor;
+  char* position = start;
+  const unsigned long kMax = std::numeric_limits<long>::max();
+  unsigned long result = 0;
+  int digit;
+  while ((digit = HexDigitValue(*position)) >= 0 && digit < base) {
+    if (result > (kMax - digit) / base)
+      return false;  // Overflow.
+    result = result * base + digit;
+    ++position;
+  }
+  long signed_result = static_cast<long>(result);
+  if (NeedsLibraryParse(start, position)) {
+    position = FieldEnd(start);
+    char saved = *position;
+    *position = '\0';
+    char* after_number;
+    signed_result = strtol(start, &after_number, base);
+    *position = saved;
+    if (after_number != position)
+      return false;
+  } else if (*position != '\0' && !IsFieldSeparator(*position)) {
+    return false;
+  }
+  if (signed_result == std::numeric_limits<long>::max())
+    return false;
+  *value = signed_result;
+  *cursor = position;
   return true;
 }
 
+// Returns the trailing text field of a record, which starts after the
+// separator at |cursor| and runs to the end of the line, or NULL if it is
+// empty.  This matches how Tokenize returns its last token.
+char* ParseTrailingField(char* cursor) {
+  if (*cursor == '\0')
+    return NULL;
+  ++cursor;
+  while (*cursor == '\r' || *cursor == '\n')
+    ++cursor;
+  if (*cursor == '\0')
+    return NULL;
+  cursor[strcspn(cursor, "\r\n")] = '\0';
+  return cursor;
+}
+
+// Returns the start of the first line after |position| that begins a
+// top-level record, or NULL if there is none before |end|.  Line and INLINE
+// records belong to the FUNC before them, and all other records start with
+// an upper case keyword.
+char* FindRecordBoundary(char* position, char* end) {
+  while (position < end) {
+    position = static_cast<char*>(memchr(position, '\n', end - position));
+    if (!position || ++position >= end)
+      return NULL;
+    if (*position >= 'A' && *position <= 'Z' &&
+        strncmp(position, "INLINE ", 7) != 0) {
+      return position;
+    }
+  }
+  return NULL;
+}
+
 }  // namespace
 
 static const char* kWhitespace = " \r\n";
 static const int kMaxErrorsPrinted = 5;
 static const int kMaxErrorsBeforeBailing = 100;
+// Approximate heap overhead of one entry in the std::map based containers a
+// Module stores its records in, used to estimate its resident size.
+static const size_t kMapEntryOverheadBytes = 64;
+
+// Replaces the map overhead of |count| records in the estimate
+// |*resident_bytes| with the |flat_bytes| of the arrays they were moved to.
+static void AccountFrozenRecords(size_t count, size_t flat_bytes,
+                                 size_t* resident_bytes) {
+  size_t map_bytes = count * kMapEntryOverheadBytes;
+  *resident_bytes -= std::min(map_bytes, *resident_bytes);
+  *resident_bytes += flat_bytes;
+}
+
+// Returns the counter in |usage| that |record| is accounted to.  Line and
+// INLINE records, and the MODULE and INFO lines, count with the functions.
+static size_t* RecordBytes(const char* record,
+                           SourceLineResolverBase::ModuleMemoryUsage* usage) {
+  if (strncmp(record, "FILE ", 5) == 0)
+    return &usage->files;
+  if (strncmp(record, "PUBLIC ", 7) == 0)
+    return &usage->public_symbols;
+  if (strncmp(record, "INLINE_ORIGIN ", 14) == 0)
+    return &usage->inline_origins;
+  if (strncmp(record, "STACK WIN ", 10) == 0)
+    return &usage->windows_frame_info;
+  if (strncmp(record, "STACK CFI INIT ", 15) == 0)
+    return &usage->cfi_initial_rules;
+  if (strncmp(record, "STACK CFI ", 10) == 0)
+    return &usage->cfi_delta_rules;
+  return &usage->functions;
+}
+// Symbol data is not split into sections smaller than this for parallel
+// loading, and each loader thread gets about kLoadChunksPerThread sections
+// so that threads finishing early can pick up more.
+static const size_t kMinLoadChunkBytes = 64 * 1024;
+static const size_t kLoadChunksPerThread = 4;
 
 BasicSourceLineResolver::BasicSourceLineResolver() :
     SourceLineResolverBase(new BasicModuleFactory) { }
 
+void BasicSourceLineResolver::set_load_thread_count(int load_thread_count) {
+  static_cast<BasicModuleFactory*>(module_factory_)->set_load_thread_count(
+      load_thread_count);
+}
+
+void BasicSourceLineResolver::set_freeze_modules(bool freeze_modules) {
+  static_cast<BasicModuleFactory*>(module_factory_)->set_freeze_modules(
+      freeze_modules);
+}
+
 // static
 void BasicSourceLineResolver::Module::LogParseError(
    const string& message,
@@ -125,14 +279,79 @@ void BasicSourceLineResolver::Module::LogParseError(
   }
 }
 
+struct BasicSourceLineResolver::Module::ParsedChunk {
+  struct ParseError {
+    const char* message;
+    int line_number;
+    bool is_inline;
+  };
+  struct PublicSymbolRecord {
+    PublicSymbol* symbol;
+    int line_number;
+  };
+  struct WindowsFrameInfoRecord {
+    int type;
+    MemAddr rva;
+    MemAddr code_size;
+    WindowsFrameInfo* info;
+  };
+  struct CFIInitialRulesRecord {
+    MemAddr address;
+    MemAddr size;
+    const char* rules;
+  };
+  // A line or INLINE record that comes before any FUNC or PUBLIC record in
+  // the chunk, and so belongs to the function open in the previous chunk.
+  struct LeadingRecord {
+    char* record;
+    int line_number;
+  };
+
+  ParsedChunk()
+      : opens_function(false),
+        last_function(NULL),
+        record_count(0),
+        num_errors(0),
+        inline_num_errors(0),
+        memory_usage() {}
+
+  // Counts a parse error, keeping the first few of each kind for logging.
+  void AddError(const char* message, int line_number, bool is_inline) {
+    int* count = is_inline ? &inline_num_errors : &num_errors;
+    if (++(*count) <= kMaxErrorsPrinted) {
+      ParseError error = {message, line_number, is_inline};
+      errors.push_back(error);
+    }
+  }
+
+  // The names and file names of the chunk's records, and the records.
+  StringPool strings;
+  Arena arena;
+  vector<std::pair<long, StringView>> files;
+  vector<std::pair<long, InlineOrigin*>> inline_origins;
+  vector<Function*> functions;
+  vector<PublicSymbolRecord> public_symbols;
+  vector<WindowsFrameInfoRecord> windows_frame_info;
+  vector<CFIInitialRulesRecord> cfi_initial_rules;
+  vector<std::pair<MemAddr, const char*>> cfi_delta_rules;
+  vector<LeadingRecord> leading_records;
+
+  // Whether the chunk has a FUNC or PUBLIC record, after which
+  // |last_function| is the function open at its end.
+  bool opens_function;
+  Function* last_function;
+
+  int record_count;
+  int num_errors;
+  int inline_num_errors;
+  vector<ParseError> errors;
+  ModuleMemoryUsage memory_usage;
+};
+
 bool BasicSourceLineResolver::Module::LoadMapFromMemory(
     char* memory_buffer,
     size_t memory_buffer_size) {
-  linked_ptr<Function> cur_func;
-  int line_number = 0;
   int num_errors = 0;
-  int inline_num_errors = 0;
-  char* save_ptr;
 
   // If the length is 0, we can still pretend we have a symbol file. This is
   // for scenarios that want to test symbol lookup, but don't necessarily care
@@ -163,40 +382,218 @@ bool BasicSourceLineResolver::Module::LoadMapFromMemory(
   if (has_null_terminator_in_the_middle) {
     LogParseError(
        "Null terminator is not expected in the middle of the symbol data",
-       line_number,
+       0,
        &num_errors);
   }
 
+  // Split large buffers into about kLoadChunksPerThread sections per thread,
+  // each starting at a top-level record and null terminated in place of the
+  // newline before it.
+  vector<char*> chunk_begins(1, memory_buffer);
+  size_t chunk_count = 1;
+  if (load_thread_count_ > 1) {
+    chunk_count = std::min(
+        static_cast<size_t>(load_thread_count_) * kLoadChunksPerThread,
+        last_null_terminator / kMinLoadChunkBytes);
+  }
+  char* buffer_end = memory_buffer + last_null_terminator;
+  for (size_t i = 1; i < chunk_count; ++i) {
+    char* target = memory_buffer + last_null_terminator * i / chunk_count;
+    if (target <= chunk_begins.back())
+      continue;
+    char* boundary = FindRecordBoundary(target, buffer_end);
+    if (!boundary)
+      break;
+    boundary[-1] = '\0';
+    chunk_begins.push_back(boundary);
+  }
+
+  vector<ParsedChunk> chunks(chunk_begins.size());
+  if (chunks.size() == 1) {
+    ParseChunk(chunk_begins[0], &chunks[0]);
+  } else {
+    std::atomic<size_t> next_chunk(0);
+    auto parse_chunks = [&chunk_begins, &chunks, &next_chunk]() {
+      size_t i;
+      while ((i = next_chunk.fetch_add(1)) < chunks.size())
+        ParseChunk(chunk_begins[i], &chunks[i]);
+    };
+    vector<std::thread> threads;
+    int thread_count = std::min(static_cast<size_t>(load_thread_count_),
+                                chunks.size());
+    for (int i = 1; i < thread_count; ++i)
+      threads.emplace_back(parse_chunks);
+    parse_chunks();
+    for (std::thread& thread : threads)
+      thread.join();
+  }
+
+  Function* cur_func = NULL;
+  int line_number = 0;
+  int inline_num_errors = 0;
+  for (ParsedChunk& chunk : chunks) {
+    MergeChunk(&chunk, line_number, &cur_func, &num_errors,
+               &inline_num_errors);
+    line_number += chunk.record_count;
+    if (num_errors > kMaxErrorsBeforeBailing) {
+      break;
+    }
+  }
+  for (ParsedChunk& chunk : chunks) {
+    for (Function* function : chunk.functions) {
+      function->IndexInlines();
+      if (freeze_) {
+        size_t line_count = function->lines.GetCount();
+        function->FreezeLines();
+        AccountFrozenRecords(line_count, function->line_index.ResidentBytes(),
+                             &memory_usage_.functions);
+      }
+    }
+  }
+  if (freeze_)
+    Freeze();
+  is_corrupt_ = num_errors > 0;
+  return true;
+}
+
+size_t BasicSourceLineResolver::Module::ResidentBytes() const {
+  return memory_usage_.files + memory_usage_.functions +
+         memory_usage_.public_symbols + memory_usage_.inline_origins +
+         memory_usage_.windows_frame_info + memory_usage_.cfi_initial_rules +
+         memory_usage_.cfi_delta_rules;
+}
+
+void BasicSourceLineResolver::Module::GetMemoryUsage(
+    ModuleMemoryUsage* usage) const {
+  string code_file = usage->code_file;
+  *usage = memory_usage_;
+  usage->code_file = code_file;
+  usage->resident_bytes = ResidentBytes();
+}
+
+void BasicSourceLineResolver::Module::Freeze() {
+  frozen_functions_.Build(functions_);
+  AccountFrozenRecords(frozen_functions_.size(),
+                       frozen_functions_.ResidentBytes(),
+                       &memory_usage_.functions);
+  functions_.Clear();
+
+  frozen_public_symbols_.Build(public_symbols_);
+  AccountFrozenRecords(frozen_public_symbols_.size(),
+                       frozen_public_symbols_.ResidentBytes(),
+                       &memory_usage_.public_symbols);
+  public_symbols_.Clear();
+
+  for (int type = 0; type < WindowsFrameInfo::STACK_INFO_LAST; ++type) {
+    frozen_windows_frame_info_[type].Build(windows_frame_info_[type]);
+    AccountFrozenRecords(frozen_windows_frame_info_[type].size(),
+                         frozen_windows_frame_info_[type].ResidentBytes(),
+                         &memory_usage_.windows_frame_info);
+    windows_frame_info_[type].Clear();
+  }
+
+  frozen_cfi_initial_rules_.Build(cfi_initial_rules_);
+  AccountFrozenRecords(frozen_cfi_initial_rules_.size(),
+                       frozen_cfi_initial_rules_.ResidentBytes(),
+                       &memory_usage_.cfi_initial_rules);
+  cfi_initial_rules_.Clear();
+
+  frozen_cfi_delta_rules_.Build(cfi_delta_rules_);
+  AccountFrozenRecords(frozen_cfi_delta_rules_.size(),
+                       frozen_cfi_delta_rules_.ResidentBytes(),
+                       &memory_usage_.cfi_delta_rules);
+  cfi_delta_rules_.clear();
+
+  frozen_ = true;
+}
+
+bool BasicSourceLineResolver::Module::RetrieveFunction(
+    MemAddr address, Function** function, MemAddr* function_base,
+    MemAddr* function_size) const {
+  if (frozen_) {
+    return frozen_functions_.RetrieveNearestRange(
+        address, function, function_base, NULL /* delta */, function_size);
+  }
+  return functions_.RetrieveNearestRange(address, function, function_base,
+                                         NULL /* delta */, function_size);
+}
+
+bool BasicSourceLineResolver::Module::RetrieveLine(
+    const Function* function, MemAddr address, Line** line,
+    MemAddr* line_base) const {
+  if (frozen_) {
+    return function->line_index.RetrieveRange(address, line, line_base,
+                                              NULL /* delta */,
+                                              NULL /* size */);
+  }
+  return function->lines.RetrieveRange(address, line, line_base,
+                                       NULL /* delta */, NULL /* size */);
+}
+
+bool BasicSourceLineResolver::Module::RetrievePublicSymbol(
+    MemAddr address, PublicSymbol** public_symbol,
+    MemAddr* public_address) const {
+  if (frozen_) {
+    return frozen_public_symbols_.Retrieve(address, public_symbol,
+                                           public_address);
+  }
+  return public_symbols_.Retrieve(address, public_symbol, public_address);
+}
+
+bool BasicSourceLineResolver::Module::RetrieveWindowsFrameInfo(
+    WindowsFrameInfo::StackInfoTypes type, MemAddr address,
+    WindowsFrameInfo** frame_info) const {
+  if (frozen_)
+    return frozen_windows_frame_info_[type].RetrieveRange(address, frame_info);
+  return windows_frame_info_[type].RetrieveRange(address, frame_info);
+}
+
+// static
+void BasicSourceLineResolver::Module::ParseChunk(char* chunk_begin,
+                                                 ParsedChunk* chunk) {
+  Function* cur_func = NULL;
+  int line_number = 0;
+  char* save_ptr;
   char* buffer;
-  buffer = strtok_r(memory_buffer, "\r\n", &save_ptr);
+  buffer = strtok_r(chunk_begin, "\r\n", &save_ptr);
 
   while (buffer != NULL) {
     ++line_number;
+    // Each record keeps roughly its text (names, CFI rules) plus a map
+    // entry; the records that allocate a struct add its size below.
+    *RecordBytes(buffer, &chunk->memory_usage) +=
+        kMapEntryOverheadBytes + (save_ptr - buffer);
 
     if (strncmp(buffer, "FILE ", 5) == 0) {
-      if (!ParseFile(buffer)) {
-        LogParseError("ParseFile on buffer failed", line_number, &num_errors);
+      if (!ParseFile(buffer, chunk)) {
+        chunk->AddError("ParseFile on buffer failed", line_number, false);
       }
     } else if (strncmp(buffer, "STACK ", 6) == 0) {
-      if (!ParseStackInfo(buffer)) {
-        LogParseError("ParseStackInfo failed", line_number, &num_errors);
+      if (!ParseStackInfo(buffer, chunk)) {
+        chunk->AddError("ParseStackInfo failed", line_number, false);
       }
     } else if (strncmp(buffer, "FUNC ", 5) == 0) {
-      cur_func.reset(ParseFunction(buffer));
-      if (!cur_func.get()) {
-        LogParseError("ParseFunction failed", line_number, &num_errors);
+      chunk->opens_function = true;
+      cur_func = ParseFunction(buffer, &chunk->arena);
+      if (!cur_func) {
+        chunk->AddError("ParseFunction failed", line_number, false);
       } else {
+        cur_func->name = chunk->strings.Add(cur_func->name);
         // StoreRange will fail if the function has an invalid address or size.
         // We'll silently ignore this, the function and any corresponding lines
-        // will be destroyed when cur_func is released.
-        functions_.StoreRange(cur_func->address, cur_func->size, cur_func);
+        // stay unreferenced in the arena until the module is unloaded.
+        chunk->functions.push_back(cur_func);
+        chunk->memory_usage.functions += sizeof(Function);
       }
     } else if (strncmp(buffer, "PUBLIC ", 7) == 0) {
       // Clear cur_func: public symbols don't contain line number information.
-      cur_func.reset();
+      chunk->opens_function = true;
+      cur_func = NULL;
 
-      if (!ParsePublicSymbol(buffer)) {
-        LogParseError("ParsePublicSymbol failed", line_number, &num_errors);
+      if (!ParsePublicSymbol(buffer, line_number, chunk)) {
+        chunk->AddError("ParsePublicSymbol failed", line_number, false);
+      } else {
+        chunk->memory_usage.public_symbols += sizeof(PublicSymbol);
       }
     } else if (strncmp(buffer, "MODULE ", 7) == 0) {
       // Ignore these.  They're not of any use to BasicSourceLineResolver,
@@ -209,73 +606,165 @@ bool BasicSourceLineResolver::Module::LoadMapFromMemory(
       // Ignore these as well, they're similarly just for housekeeping.
       //
       // INFO CODE_ID <code id> <filename>
-    } else if (strncmp(buffer, "INLINE ", 7) == 0) {
-      linked_ptr<Inline> in = ParseInline(buffer);
-      if (!in.get())
-        LogParseError("ParseInline failed", line_number, &inline_num_errors);
-      else
-        cur_func->AppendInline(in);
     } else if (strncmp(buffer, "INLINE_ORIGIN ", 14) == 0) {
-      if (!ParseInlineOrigin(buffer)) {
-        LogParseError("ParseInlineOrigin failed", line_number,
-                      &inline_num_errors);
-      }
-    } else {
-      if (!cur_func.get()) {
-        LogParseError("Found source line data without a function",
-                       line_number, &num_errors);
+      if (!ParseInlineOrigin(buffer, chunk)) {
+        chunk->AddError("ParseInlineOrigin failed", line_number, true);
       } else {
-        Line* line = ParseLine(buffer);
-        if (!line) {
-          LogParseError("ParseLine failed", line_number, &num_errors);
-        } else {
-          cur_func->lines.StoreRange(line->address, line->size,
-                                     linked_ptr<Line>(line));
-        }
+        chunk->memory_usage.inline_origins += sizeof(InlineOrigin);
       }
+    } else if (!chunk->opens_function) {
+      // A line or INLINE record for the function the previous chunk ended
+      // with; it is parsed when the chunks are merged.
+      ParsedChunk::LeadingRecord leading = {buffer, line_number};
+      chunk->leading_records.push_back(leading);
+    } else {
+      ParseFunctionRecord(buffer, line_number, cur_func, chunk);
     }
-    if (num_errors > kMaxErrorsBeforeBailing) {
+    if (chunk->num_errors > kMaxErrorsBeforeBailing) {
       break;
     }
     buffer = strtok_r(NULL, "\r\n", &save_ptr);
   }
-  is_corrupt_ = num_errors > 0;
-  return true;
+  chunk->last_function = cur_func;
+  chunk->record_count = line_number;
+}
+
+// static
+void BasicSourceLineResolver::Module::ParseFunctionRecord(
+    char* record, int line_number, Function* function, ParsedChunk* chunk) {
+  if (strncmp(record, "INLINE ", 7) == 0) {
+    Inline* in = ParseInline(record, &chunk->arena);
+    if (!in) {
+      chunk->AddError("ParseInline failed", line_number, true);
+    } else if (!function) {
+      chunk->AddError("Found inline data without a function", line_number,
+                      true);
+    } else {
+      function->AppendInline(in);
+      chunk->memory_usage.functions += sizeof(Inline);
+    }
+  } else {
+    if (!function) {
+      chunk->AddError("Found source line data without a function",
+                      line_number, false);
+    } else {
+      Line* line = ParseLine(record, &chunk->arena);
+      if (!line) {
+        chunk->AddError("ParseLine failed", line_number, false);
+      } else {
+        function->lines.StoreRange(line->address, line->size, line);
+        chunk->memory_usage.functions += sizeof(Line);
+      }
+    }
+  }
+}
+
+void BasicSourceLineResolver::Module::MergeChunk(
+    ParsedChunk* chunk, int first_line_number, Function** cur_func,
+    int* num_errors, int* inline_num_errors) {
+  for (const ParsedChunk::LeadingRecord& leading : chunk->leading_records) {
+    ParseFunctionRecord(leading.record, leading.line_number, *cur_func,
+                        chunk);
+  }
+  if (chunk->opens_function) {
+    *cur_func = chunk->last_function;
+  }
+
+  strings_.Adopt(&chunk->strings);
+  arena_.Adopt(&chunk->arena);
+  for (const auto& file : chunk->files) {
+    files_.insert(make_pair(file.first, file.second));
+  }
+  for (const auto& origin : chunk->inline_origins) {
+    inline_origins_.insert(origin);
+  }
+  for (Function* function : chunk->functions) {
+    functions_.StoreRange(function->address, function->size, function);
+  }
+  for (const ParsedChunk::PublicSymbolRecord& record : chunk->public_symbols) {
+    if (!public_symbols_.Store(record.symbol->address, record.symbol)) {
+      chunk->AddError("ParsePublicSymbol failed", record.line_number, false);
+    }
+  }
+  for (const ParsedChunk::WindowsFrameInfoRecord& record :
+       chunk->windows_frame_info) {
+    // See ParseStackInfo for why a failure to store is not an error.
+    windows_frame_info_[record.type].StoreRange(record.rva, record.code_size,
+                                                record.info);
+  }
+  for (const ParsedChunk::CFIInitialRulesRecord& record :
+       chunk->cfi_initial_rules) {
+    cfi_initial_rules_.StoreRange(record.address, record.size, record.rules);
+  }
+  for (const auto& delta : chunk->cfi_delta_rules) {
+    cfi_delta_rules_[delta.first] = delta.second;
+  }
+  const ModuleMemoryUsage& usage = chunk->memory_usage;
+  memory_usage_.files += usage.files;
+  memory_usage_.functions += usage.functions;
+  memory_usage_.public_symbols += usage.public_symbols;
+  memory_usage_.inline_origins += usage.inline_origins;
+  memory_usage_.windows_frame_info += usage.windows_frame_info;
+  memory_usage_.cfi_initial_rules += usage.cfi_initial_rules;
+  memory_usage_.cfi_delta_rules += usage.cfi_delta_rules;
+
+  // Log in file order.  Errors beyond the first few the chunk kept are only
+  // counted.
+  std::stable_sort(chunk->errors.begin(), chunk->errors.end(),
+                   [](const ParsedChunk::ParseError& a,
+                      const ParsedChunk::ParseError& b) {
+                     return a.line_number < b.line_number;
+                   });
+  int logged_errors = 0;
+  int logged_inline_errors = 0;
+  for (const ParsedChunk::ParseError& error : chunk->errors) {
+    if (error.is_inline) {
+      LogParseError(error.message, first_line_number + error.line_number,
+                    inline_num_errors);
+      ++logged_inline_errors;
+    } else {
+      LogParseError(error.message, first_line_number + error.line_number,
+                    num_errors);
+      ++logged_errors;
+    }
+  }
+  *num_errors += chunk->num_errors - logged_errors;
+  *inline_num_errors += chunk->inline_num_errors - logged_inline_errors;
 }
 
 void BasicSourceLineResolver::Module::ConstructInlineFrames(
     StackFrame* frame,
     MemAddr address,
-    const ContainedRangeMap<uint64_t, linked_ptr<Inline>>& inline_map,
+    const NestedRangeIndex<uint64_t, Inline*>& inline_map,
     deque<unique_ptr<StackFrame>>* inlined_frames) const {
-  vector<const linked_ptr<Inline>*> inlines;
+  vector<Inline* const*> inlines;
   if (!inline_map.RetrieveRanges(address, inlines)) {
     return;
   }
 
-  for (const linked_ptr<Inline>* const in : inlines) {
+  for (Inline* const* in : inlines) {
     unique_ptr<StackFrame> new_frame =
         unique_ptr<StackFrame>(new StackFrame(*frame));
-    auto origin = inline_origins_.find(in->get()->origin_id);
+    auto origin = inline_origins_.find((*in)->origin_id);
     if (origin != inline_origins_.end()) {
-      new_frame->function_name = origin->second->name;
+      new_frame->function_name = origin->second->name.str();
     } else {
       new_frame->function_name = "<name omitted>";
     }
     
     // Store call site file and line in current frame, which will be updated
     // later.
-    new_frame->source_line = in->get()->call_site_line;
-    if (in->get()->has_call_site_file_id) {
-      auto file = files_.find(in->get()->call_site_file_id);
+    new_frame->source_line = (*in)->call_site_line;
+    if ((*in)->has_call_site_file_id) {
+      auto file = files_.find((*in)->call_site_file_id);
       if (file != files_.end()) {
-        new_frame->source_file_name = file->second;
+        new_frame->source_file_name = file->second.str();
       }
     }
 
     // Use the starting address of the inlined range as inlined function base.
     new_frame->function_base = new_frame->module->base_address();
-    for (const auto& range : in->get()->inline_ranges) {
+    for (const auto& range : (*in)->inline_ranges) {
       if (address >= range.first && address < range.first + range.second) {
         new_frame->function_base += range.first;
         break;
@@ -301,9 +790,71 @@ void BasicSourceLineResolver::Module::ConstructInlineFrames(
   }
 }
 
+void BasicSourceLineResolver::Module::RecordInlines(
+    StackFrame* frame,
+    MemAddr address,
+    const NestedRangeIndex<uint64_t, Inline*>& inline_map,
+    int line_file_id) const {
+  vector<Inline* const*> inlines;
+  if (!inline_map.RetrieveRanges(address, inlines)) {
+    return;
+  }
+
+  vector<InlineFrameRecord> records;
+  for (Inline* const* in : inlines) {
+    InlineFrameRecord record;
+    record.origin_id = (*in)->origin_id;
+    record.source_line = (*in)->call_site_line;
+    record.source_file_id = -1;
+    if ((*in)->has_call_site_file_id &&
+        files_.find((*in)->call_site_file_id) != files_.end()) {
+      record.source_file_id = (*in)->call_site_file_id;
+    }
+    record.function_base = 0;
+    for (const auto& range : (*in)->inline_ranges) {
+      if (address >= range.first && address < range.first + range.second) {
+        record.function_base = range.first;
+        break;
+      }
+    }
+    records.push_back(record);
+  }
+  RecordInlineFrames(frame, line_file_id, &records);
+}
+
+bool BasicSourceLineResolver::Module::GetInlineOriginName(
+    int origin_id, string* name) const {
+  auto origin = inline_origins_.find(origin_id);
+  if (origin == inline_origins_.end())
+    return false;
+  *name = origin->second->name.str();
+  return true;
+}
+
+bool BasicSourceLineResolver::Module::GetFileName(int file_id,
+                                                  string* name) const {
+  FileMap::const_iterator file = files_.find(file_id);
+  if (file == files_.end())
+    return false;
+  *name = file->second.str();
+  return true;
+}
+
 void BasicSourceLineResolver::Module::LookupAddress(
     StackFrame* frame,
     deque<unique_ptr<StackFrame>>* inlined_frames) const {
+  LookupAddress(frame, inlined_frames, false);
+}
+
+void BasicSourceLineResolver::Module::LookupAddressWithInlineRecords(
+    StackFrame* frame) const {
+  LookupAddress(frame, NULL, true);
+}
+
+void BasicSourceLineResolver::Module::LookupAddress(
+    StackFrame* frame,
+    deque<unique_ptr<StackFrame>>* inlined_frames,
+    bool record_inlines) const {
   MemAddr address = frame->instruction - frame->module->base_address();
 
   // First, look for a FUNC record that covers address. Use
@@ -312,38 +863,40 @@ void BasicSourceLineResolver::Module::LookupAddress(
   // extent of the PUBLIC symbol we find, below. This does mean we
   // need to check that address indeed falls within the function we
   // find; do the range comparison in an overflow-friendly way.
-  linked_ptr<Function> func;
-  linked_ptr<PublicSymbol> public_symbol;
+  Function* func = NULL;
+  PublicSymbol* public_symbol;
   MemAddr function_base;
   MemAddr function_size;
   MemAddr public_address;
-  if (functions_.RetrieveNearestRange(address, &func, &function_base,
-                                      NULL /* delta */, &function_size) &&
+  if (RetrieveFunction(address, &func, &function_base, &function_size) &&
       address >= function_base && address - function_base < function_size) {
-    frame->function_name = func->name;
+    frame->function_name = func->name.str();
     frame->function_base = frame->module->base_address() + function_base;
     frame->is_multiple = func->is_multiple;
 
-    linked_ptr<Line> line;
+    Line* line;
     MemAddr line_base;
-    if (func->lines.RetrieveRange(address, &line, &line_base, NULL /* delta */,
-                                  NULL /* size */)) {
+    int line_file_id = -1;
+    if (RetrieveLine(func, address, &line, &line_base)) {
       FileMap::const_iterator it = files_.find(line->source_file_id);
       if (it != files_.end()) {
-        frame->source_file_name = files_.find(line->source_file_id)->second;
+        frame->source_file_name = it->second.str();
       }
       frame->source_line = line->line;
       frame->source_line_base = frame->module->base_address() + line_base;
+      line_file_id = line->source_file_id;
     }
 
     // Check if this is inlined function call.
     if (inlined_frames) {
-      ConstructInlineFrames(frame, address, func->inlines, inlined_frames);
+      ConstructInlineFrames(frame, address, func->inline_index,
+                            inlined_frames);
+    } else if (record_inlines) {
+      RecordInlines(frame, address, func->inline_index, line_file_id);
     }
-  } else if (public_symbols_.Retrieve(address,
-                                      &public_symbol, &public_address) &&
-             (!func.get() || public_address > function_base)) {
-    frame->function_name = public_symbol->name;
+  } else if (RetrievePublicSymbol(address, &public_symbol, &public_address) &&
+             (!func || public_address > function_base)) {
+    frame->function_name = public_symbol->name.str();
     frame->function_base = frame->module->base_address() + public_address;
     frame->is_multiple = public_symbol->is_multiple;
   }
@@ -360,12 +913,12 @@ WindowsFrameInfo* BasicSourceLineResolver::Module::FindWindowsFrameInfo(
   // includes its own program string.
   // WindowsFrameInfo::STACK_INFO_FPO is the older type
   // corresponding to the FPO_DATA struct. See stackwalker_x86.cc.
-  linked_ptr<WindowsFrameInfo> frame_info;
-  if ((windows_frame_info_[WindowsFrameInfo::STACK_INFO_FRAME_DATA]
-       .RetrieveRange(address, &frame_info))
-      || (windows_frame_info_[WindowsFrameInfo::STACK_INFO_FPO]
-          .RetrieveRange(address, &frame_info))) {
-    result->CopyFrom(*frame_info.get());
+  WindowsFrameInfo* frame_info;
+  if (RetrieveWindowsFrameInfo(WindowsFrameInfo::STACK_INFO_FRAME_DATA,
+                               address, &frame_info)
+      || RetrieveWindowsFrameInfo(WindowsFrameInfo::STACK_INFO_FPO,
+                                  address, &frame_info)) {
+    result->CopyFrom(*frame_info);
     return result.release();
   }
 
@@ -376,10 +929,9 @@ WindowsFrameInfo* BasicSourceLineResolver::Module::FindWindowsFrameInfo(
   // below. However, this does mean we need to check that ADDRESS
   // falls within the retrieved function's range; do the range
   // comparison in an overflow-friendly way.
-  linked_ptr<Function> function;
+  Function* function = NULL;
   MemAddr function_base, function_size;
-  if (functions_.RetrieveNearestRange(address, &function, &function_base,
-                                      NULL /* delta */, &function_size) &&
+  if (RetrieveFunction(address, &function, &function_base, &function_size) &&
       address >= function_base && address - function_base < function_size) {
     result->parameter_size = function->parameter_size;
     result->valid |= WindowsFrameInfo::VALID_PARAMETER_SIZE;
@@ -388,10 +940,10 @@ WindowsFrameInfo* BasicSourceLineResolver::Module::FindWindowsFrameInfo(
 
   // PUBLIC symbols might have a parameter size. Use the function we
   // found above to limit the range the public symbol covers.
-  linked_ptr<PublicSymbol> public_symbol;
+  PublicSymbol* public_symbol;
   MemAddr public_address;
-  if (public_symbols_.Retrieve(address, &public_symbol, &public_address) &&
-      (!function.get() || public_address > function_base)) {
+  if (RetrievePublicSymbol(address, &public_symbol, &public_address) &&
+      (!function || public_address > function_base)) {
     result->parameter_size = public_symbol->parameter_size;
   }
 
@@ -408,10 +960,39 @@ CFIFrameInfo* BasicSourceLineResolver::Module::FindCFIFrameInfo(
   // provides an initial set of register recovery rules. Then, walk
   // forward from the initial rule's starting address to frame's
   // instruction address, applying delta rules.
+  if (frozen_) {
+    if (!frozen_cfi_initial_rules_.RetrieveRange(address, &initial_rules,
+                                                 &initial_base,
+                                                 NULL /* delta */,
+                                                 &initial_size)) {
+      return NULL;
+    }
+    return AssembleCFIFrameInfo(frozen_cfi_delta_rules_, address,
+                                initial_rules, initial_base);
+  }
   if (!cfi_initial_rules_.RetrieveRange(address, &initial_rules, &initial_base,
                                         NULL /* delta */, &initial_size)) {
     return NULL;
   }
+  return AssembleCFIFrameInfo(cfi_delta_rules_, address, initial_rules,
+                              initial_base);
+}
+
+template<typename DeltaRules>
+CFIFrameInfo* BasicSourceLineResolver::Module::AssembleCFIFrameInfo(
+    const DeltaRules& delta_rules, MemAddr address,
+    const string& initial_rules, MemAddr initial_base) const {
+  // The rules only depend on the initial rule and the last delta rule
+  // applied, so they may have been assembled before.
+  typename DeltaRules::const_iterator last_delta =
+    delta_rules.upper_bound(address);
+  bool has_delta = last_delta != delta_rules.begin() &&
+                   (--last_delta)->first >= initial_base;
+  MemAddr delta_address = has_delta ? last_delta->first : 0;
+  CFIFrameInfo* cached =
+      cfi_frame_info_cache_.Find(initial_base, has_delta, delta_address);
+  if (cached)
+    return cached;
 
   // Create a frame info structure, and populate it with the rules from
   // the STACK CFI INIT record.
@@ -420,65 +1001,76 @@ CFIFrameInfo* BasicSourceLineResolver::Module::FindCFIFrameInfo(
     return NULL;
 
   // Find the first delta rule that falls within the initial rule's range.
-  map<MemAddr, string>::const_iterator delta =
-    cfi_delta_rules_.lower_bound(initial_base);
+  typename DeltaRules::const_iterator delta =
+    delta_rules.lower_bound(initial_base);
 
   // Apply delta rules up to and including the frame's address.
-  while (delta != cfi_delta_rules_.end() && delta->first <= address) {
+  while (delta != delta_rules.end() && delta->first <= address) {
     ParseCFIRuleSet(delta->second, rules.get());
     delta++;
   }
 
+  cfi_frame_info_cache_.Insert(initial_base, has_delta, delta_address,
+                               *rules);
   return rules.release();
 }
 
-bool BasicSourceLineResolver::Module::ParseFile(char* file_line) {
+// static
+bool BasicSourceLineResolver::Module::ParseFile(char* file_line,
+                                                ParsedChunk* chunk) {
   long index;
   char* filename;
   if (SymbolParseHelper::ParseFile(file_line, &index, &filename)) {
-    files_.insert(make_pair(index, string(filename)));
+    chunk->files.push_back(make_pair(index, chunk->strings.Add(filename)));
     return true;
   }
   return false;
 }
 
+// static
 bool BasicSourceLineResolver::Module::ParseInlineOrigin(
-  char* inline_origin_line) {
+  char* inline_origin_line, ParsedChunk* chunk) {
   bool has_file_id;
   long origin_id;
-  long source_file_id;
+  // Left alone by the new format, which has no file id.
+  long source_file_id = -1;
   char* origin_name;
   if (SymbolParseHelper::ParseInlineOrigin(inline_origin_line, &has_file_id,
                                            &origin_id, &source_file_id,
                                            &origin_name)) {
-    inline_origins_.insert(make_pair(
+    chunk->inline_origins.push_back(make_pair(
         origin_id,
-        new InlineOrigin(has_file_id, source_file_id, origin_name)));
+        chunk->arena.New<InlineOrigin>(has_file_id, source_file_id,
+                                       chunk->strings.Add(origin_name))));
     return true;
   }
   return false;
 }
 
-linked_ptr<BasicSourceLineResolver::Inline>
-BasicSourceLineResolver::Module::ParseInline(char* inline_line) {
+// static
+BasicSourceLineResolver::Inline*
+BasicSourceLineResolver::Module::ParseInline(char* inline_line, Arena* arena) {
   bool has_call_site_file_id;
   long inline_nest_level;
   long call_site_line;
-  long call_site_file_id;
+  // Left alone by the old format, which has no call site file id.
+  long call_site_file_id = -1;
   long origin_id;
   vector<std::pair<MemAddr, MemAddr>> ranges;
   if (SymbolParseHelper::ParseInline(inline_line, &has_call_site_file_id,
                                      &inline_nest_level, &call_site_line,
                                      &call_site_file_id, &origin_id, &ranges)) {
-    return linked_ptr<Inline>(new Inline(has_call_site_file_id,
-                                         inline_nest_level, call_site_line,
-                                         call_site_file_id, origin_id, ranges));
+    return arena->New<Inline>(has_call_site_file_id, inline_nest_level,
+                              call_site_line, call_site_file_id, origin_id,
+                              std::move(ranges));
   }
-  return linked_ptr<Inline>();
+  return NULL;
 }
 
+// static
 BasicSourceLineResolver::Function*
-BasicSourceLineResolver::Module::ParseFunction(char* function_line) {
+BasicSourceLineResolver::Module::ParseFunction(char* function_line,
+                                               Arena* arena) {
   bool is_multiple;
   uint64_t address;
   uint64_t size;
@@ -486,13 +1078,15 @@ BasicSourceLineResolver::Module::ParseFunction(char* function_line) {
   char* name;
   if (SymbolParseHelper::ParseFunction(function_line, &is_multiple, &address,
                                        &size, &stack_param_size, &name)) {
-    return new Function(name, address, size, stack_param_size, is_multiple);
+    return arena->New<Function>(name, address, size, stack_param_size,
+                                is_multiple);
   }
   return NULL;
 }
 
+// static
 BasicSourceLineResolver::Line* BasicSourceLineResolver::Module::ParseLine(
-    char* line_line) {
+    char* line_line, Arena* arena) {
   uint64_t address;
   uint64_t size;
   long line_number;
@@ -500,12 +1094,15 @@ BasicSourceLineResolver::Line* BasicSourceLineResolver::Module::ParseLine(
 
   if (SymbolParseHelper::ParseLine(line_line, &address, &size, &line_number,
                                    &source_file)) {
-    return new Line(address, size, source_file, line_number);
+    return arena->New<Line>(address, size, source_file, line_number);
   }
   return NULL;
 }
 
-bool BasicSourceLineResolver::Module::ParsePublicSymbol(char* public_line) {
+// static
+bool BasicSourceLineResolver::Module::ParsePublicSymbol(char* public_line,
+                                                        int line_number,
+                                                        ParsedChunk* chunk) {
   bool is_multiple;
   uint64_t address;
   long stack_param_size;
@@ -518,20 +1115,25 @@ bool BasicSourceLineResolver::Module::ParsePublicSymbol(char* public_line) {
     // RtlDescribeChunkLZNT1, and RtlReserveChunkLZNT1.  They would conflict
     // with one another if they were allowed into the public_symbols_ map,
     // but since the address is obviously invalid, gracefully accept them
-    // as input without putting them into the map.
+    // as input without putting them into the map.  Other conflicts are
+    // reported when the chunk is merged.
     if (address == 0) {
       return true;
     }
 
-    linked_ptr<PublicSymbol> symbol(new PublicSymbol(name, address,
-                                                     stack_param_size,
-                                                     is_multiple));
-    return public_symbols_.Store(address, symbol);
+    ParsedChunk::PublicSymbolRecord record = {
+        chunk->arena.New<PublicSymbol>(chunk->strings.Add(name), address,
+                                       stack_param_size, is_multiple),
+        line_number};
+    chunk->public_symbols.push_back(record);
+    return true;
   }
   return false;
 }
 
-bool BasicSourceLineResolver::Module::ParseStackInfo(char* stack_info_line) {
+// static
+bool BasicSourceLineResolver::Module::ParseStackInfo(char* stack_info_line,
+                                                     ParsedChunk* chunk) {
   // Skip "STACK " prefix.
   stack_info_line += 6;
 
@@ -548,13 +1150,19 @@ bool BasicSourceLineResolver::Module::ParseStackInfo(char* stack_info_line) {
   if (strcmp(platform, "WIN") == 0) {
     int type = 0;
     uint64_t rva, code_size;
-    linked_ptr<WindowsFrameInfo>
-      stack_frame_info(WindowsFrameInfo::ParseFromString(stack_info_line,
-                                                         type,
-                                                         rva,
-                                                         code_size));
-    if (stack_frame_info == NULL)
+    scoped_ptr<WindowsFrameInfo>
+      parsed_info(WindowsFrameInfo::ParseFromString(stack_info_line,
+                                                    type,
+                                                    rva,
+                                                    code_size));
+    if (parsed_info == NULL)
       return false;
+    // Compile the program once here, rather than for every frame it
+    // unwinds.
+    if (!parsed_info->program_string.empty()) {
+      parsed_info->compiled_program =
+          WindowsFrameProgram::Compile(parsed_info->program_string);
+    }
 
     // TODO(mmentovai): I wanted to use StoreRange's return value as this
     // method's return value, but MSVC infrequently outputs stack info that
@@ -576,19 +1184,45 @@ bool BasicSourceLineResolver::Module::ParseStackInfo(char* stack_info_line) {
     // if ContainedRangeMap were modified to allow replacement of
     // already-stored values.
 
-    windows_frame_info_[type].StoreRange(rva, code_size, stack_frame_info);
+    ParsedChunk::WindowsFrameInfoRecord record = {
+        type, rva, code_size,
+        chunk->arena.New<WindowsFrameInfo>(*parsed_info)};
+    chunk->windows_frame_info.push_back(record);
     return true;
   } else if (strcmp(platform, "CFI") == 0) {
     // DWARF CFI stack frame info
-    return ParseCFIFrameInfo(stack_info_line);
+    return ParseCFIFrameInfo(stack_info_line, chunk);
   } else {
     // Something unrecognized.
     return false;
   }
 }
 
+// static
 bool BasicSourceLineResolver::Module::ParseCFIFrameInfo(
-    char* stack_info_line) {
+    char* stack_info_line, ParsedChunk* chunk) {
+  bool is_initial;
+  MemAddr address;
+  MemAddr size;
+  char* rules;
+  if (!ParseCFIRecord(stack_info_line, &is_initial, &address, &size, &rules))
+    return false;
+
+  if (is_initial) {
+    ParsedChunk::CFIInitialRulesRecord record = {address, size, rules};
+    chunk->cfi_initial_rules.push_back(record);
+  } else {
+    chunk->cfi_delta_rules.push_back(make_pair(address, rules));
+  }
+  return true;
+}
+
+// static
+bool BasicSourceLineResolver::Module::ParseCFIRecord(char* stack_info_line,
+                                                     bool* is_initial,
+                                                     MemAddr* address,
+                                                     MemAddr* size,
+                                                     char** rules) {
   char* cursor;
 
   // Is this an INIT record or a delta record?
@@ -607,9 +1241,10 @@ bool BasicSourceLineResolver::Module::ParseCFIFrameInfo(
     char* initial_rules = strtok_r(NULL, "\r\n", &cursor);
     if (!initial_rules) return false;
 
-    MemAddr address = strtoul(address_field, NULL, 16);
-    MemAddr size    = strtoul(size_field,    NULL, 16);
-    cfi_initial_rules_.StoreRange(address, size, initial_rules);
+    *is_initial = true;
+    *address = strtoul(address_field, NULL, 16);
+    *size    = strtoul(size_field,    NULL, 16);
+    *rules = initial_rules;
     return true;
   }
 
@@ -617,12 +1252,14 @@ bool BasicSourceLineResolver::Module::ParseCFIFrameInfo(
   char* address_field = init_or_address;
   char* delta_rules = strtok_r(NULL, "\r\n", &cursor);
   if (!delta_rules) return false;
-  MemAddr address = strtoul(address_field, NULL, 16);
-  cfi_delta_rules_[address] = delta_rules;
+  *is_initial = false;
+  *address = strtoul(address_field, NULL, 16);
+  *size = 0;
+  *rules = delta_rules;
   return true;
 }
 
-bool BasicSourceLineResolver::Function::AppendInline(linked_ptr<Inline> in) {
+bool BasicSourceLineResolver::Function::AppendInline(Inline* in) {
   // This happends if in's parent wasn't added due to a malformed INLINE record.
   if (in->inline_nest_level > last_added_inline_nest_level + 1)
     return false;
@@ -742,58 +1379,60 @@ bool SymbolParseHelper::ParseInline(
   assert(strncmp(inline_line, "INLINE ", 7) == 0);
   inline_line += 7; // skip prefix
 
-  vector<char*> tokens;
-  // Increase max_tokens if necessary.
-  Tokenize(inline_line, kWhitespace, 512, &tokens);
+  // Count the fields first, since the format is told apart by their number.
+  size_t field_count = 0;
+  for (char* cursor = inline_line; SkipFieldSeparators(&cursor);
+       cursor = FieldEnd(cursor)) {
+    ++field_count;
+  }
 
-  // Determine the version of INLINE record by parity of the vector length.
-  *has_call_site_file_id = tokens.size() % 2 == 0;
+  // Determine the version of INLINE record by parity of the field count.
+  *has_call_site_file_id = field_count % 2 == 0;
 
-  // The length of the vector should be at least 5.
-  if (tokens.size() < 5) {
+  // There should be at least 5 fields.
+  if (field_count < 5) {
     return false;
   }
 
-  char* after_number;
-  size_t next_idx = 0;
-
-  *inline_nest_level = strtol(tokens[next_idx++], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) || *inline_nest_level < 0 ||
-      *inline_nest_level == std::numeric_limits<long>::max()) {
+  char* cursor = inline_line;
+  SkipFieldSeparators(&cursor);
+  if (!ParseLongField(&cursor, 10, inline_nest_level) ||
+      *inline_nest_level < 0) {
     return false;
   }
 
-  *call_site_line = strtol(tokens[next_idx++], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) || *call_site_line < 0 ||
-      *call_site_line == std::numeric_limits<long>::max()) {
+  SkipFieldSeparators(&cursor);
+  if (!ParseLongField(&cursor, 10, call_site_line) || *call_site_line < 0) {
     return false;
   }
 
+  size_t next_field = 2;
   if (*has_call_site_file_id) {
-    *call_site_file_id = strtol(tokens[next_idx++], &after_number, 10);
+    SkipFieldSeparators(&cursor);
     // If the file id is -1, it might be an artificial function that doesn't
     // have file id. So, we consider -1 as a valid special case.
-    if (!IsValidAfterNumber(after_number) || *call_site_file_id < -1 ||
-        *call_site_file_id == std::numeric_limits<long>::max()) {
+    if (!ParseLongField(&cursor, 10, call_site_file_id) ||
+        *call_site_file_id < -1) {
       return false;
     }
+    ++next_field;
   }
 
-  *origin_id = strtol(tokens[next_idx++], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) || *origin_id < 0 ||
-      *origin_id == std::numeric_limits<long>::max()) {
+  SkipFieldSeparators(&cursor);
+  if (!ParseLongField(&cursor, 10, origin_id) || *origin_id < 0) {
     return false;
   }
+  ++next_field;
 
-  while (next_idx < tokens.size()) {
-    MemAddr address = strtoull(tokens[next_idx++], &after_number, 16);
-    if (!IsValidAfterNumber(after_number) ||
-        address == std::numeric_limits<unsigned long long>::max()) {
+  for (; next_field < field_count; next_field += 2) {
+    MemAddr address;
+    MemAddr size;
+    SkipFieldSeparators(&cursor);
+    if (!ParseHexField(&cursor, &address)) {
       return false;
     }
-    MemAddr size = strtoull(tokens[next_idx++], &after_number, 16);
-    if (!IsValidAfterNumber(after_number) ||
-        size == std::numeric_limits<unsigned long long>::max()) {
+    SkipFieldSeparators(&cursor);
+    if (!ParseHexField(&cursor, &size)) {
       return false;
     }
     ranges->push_back({address, size});
@@ -810,34 +1449,32 @@ bool SymbolParseHelper::ParseFunction(char* function_line, bool* is_multiple,
   assert(strncmp(function_line, "FUNC ", 5) == 0);
   function_line += 5;  // skip prefix
 
-  vector<char*> tokens;
-  if (!TokenizeWithOptionalField(function_line, "m", kWhitespace, 5, &tokens)) {
+  char* cursor = function_line;
+  if (!SkipFieldSeparators(&cursor)) {
     return false;
   }
+  *is_multiple = cursor[0] == 'm' && IsFieldSeparator(cursor[1]);
+  if (*is_multiple) {
+    ++cursor;
+  }
 
-  *is_multiple = strcmp(tokens[0], "m") == 0;
-  int next_token = *is_multiple ? 1 : 0;
-
-  char* after_number;
-  *address = strtoull(tokens[next_token++], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *address == std::numeric_limits<unsigned long long>::max()) {
+  if (!SkipFieldSeparators(&cursor) || !ParseHexField(&cursor, address) ||
+      !SkipFieldSeparators(&cursor) || !ParseHexField(&cursor, size)) {
     return false;
   }
-  *size = strtoull(tokens[next_token++], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *size == std::numeric_limits<unsigned long long>::max()) {
+  // As before, a record with the optional field also ends at the first line
+  // break after <size>.
+  if (*is_multiple && !(cursor = ParseTrailingField(cursor))) {
     return false;
   }
-  *stack_param_size = strtol(tokens[next_token++], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *stack_param_size == std::numeric_limits<long>::max() ||
+  if (!SkipFieldSeparators(&cursor) ||
+      !ParseLongField(&cursor, 16, stack_param_size) ||
       *stack_param_size < 0) {
     return false;
   }
-  *name = tokens[next_token++];
+  *name = ParseTrailingField(cursor);
 
-  return true;
+  return *name != NULL;
 }
 
 // static
@@ -845,30 +1482,31 @@ bool SymbolParseHelper::ParseLine(char* line_line, uint64_t* address,
                                   uint64_t* size, long* line_number,
                                   long* source_file) {
   // <address> <size> <line number> <source file id>
-  vector<char*> tokens;
-  if (!Tokenize(line_line, kWhitespace, 4, &tokens)) {
+  char* cursor = line_line;
+  if (!SkipFieldSeparators(&cursor) || !ParseHexField(&cursor, address) ||
+      !SkipFieldSeparators(&cursor) || !ParseHexField(&cursor, size) ||
+      !SkipFieldSeparators(&cursor) ||
+      !ParseLongField(&cursor, 10, line_number)) {
     return false;
   }
-
-  char* after_number;
-  *address  = strtoull(tokens[0], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *address == std::numeric_limits<unsigned long long>::max()) {
-    return false;
-  }
-  *size = strtoull(tokens[1], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *size == std::numeric_limits<unsigned long long>::max()) {
+  // The source file id is the rest of the line, which may hold a comment.
+  char* source_file_field = ParseTrailingField(cursor);
+  if (!source_file_field) {
     return false;
   }
-  *line_number = strtol(tokens[2], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) ||
-      *line_number == std::numeric_limits<long>::max()) {
-    return false;
+  if (*source_file_field >= '0' && *source_file_field <= '9') {
+    if (!ParseLongField(&source_file_field, 10, source_file)) {
+      return false;
+    }
+  } else {
+    char* after_number;
+    *source_file = strtol(source_file_field, &after_number, 10);
+    if (!IsValidAfterNumber(after_number) ||
+        *source_file == std::numeric_limits<long>::max()) {
+      return false;
+    }
   }
-  *source_file = strtol(tokens[3], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) || *source_file < 0 ||
-      *source_file == std::numeric_limits<long>::max()) {
+  if (*source_file < 0) {
     return false;
   }
 
@@ -894,29 +1532,31 @@ bool SymbolParseHelper::ParsePublicSymbol(char* public_line, bool* is_multiple,
   assert(strncmp(public_line, "PUBLIC ", 7) == 0);
   public_line += 7;  // skip prefix
 
-  vector<char*> tokens;
-  if (!TokenizeWithOptionalField(public_line, "m", kWhitespace, 4, &tokens)) {
+  char* cursor = public_line;
+  if (!SkipFieldSeparators(&cursor)) {
     return false;
   }
+  *is_multiple = cursor[0] == 'm' && IsFieldSeparator(cursor[1]);
+  if (*is_multiple) {
+    ++cursor;
+  }
 
-  *is_multiple = strcmp(tokens[0], "m") == 0;
-  int next_token = *is_multiple ? 1 : 0;
-
-  char* after_number;
-  *address = strtoull(tokens[next_token++], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *address == std::numeric_limits<unsigned long long>::max()) {
+  if (!SkipFieldSeparators(&cursor) || !ParseHexField(&cursor, address)) {
     return false;
   }
-  *stack_param_size = strtol(tokens[next_token++], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *stack_param_size == std::numeric_limits<long>::max() ||
+  // As before, a record with the optional field also ends at the first line
+  // break after <address>.
+  if (*is_multiple && !(cursor = ParseTrailingField(cursor))) {
+    return false;
+  }
+  if (!SkipFieldSeparators(&cursor) ||
+      !ParseLongField(&cursor, 16, stack_param_size) ||
       *stack_param_size < 0) {
     return false;
   }
-  *name = tokens[next_token++];
+  *name = ParseTrailingField(cursor);
 
-  return true;
+  return *name != NULL;
 }
 
 // static
@@ -41,22 +41,27 @@
 
 #include "common/scoped_ptr.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "processor/arena.h"
 #include "processor/source_line_resolver_base_types.h"
+#include "processor/string_pool.h"
 
 #include "processor/address_map-inl.h"
 #include "processor/range_map-inl.h"
 #include "processor/contained_range_map-inl.h"
+#include "processor/flat_address_map-inl.h"
+#include "processor/flat_range_map-inl.h"
+#include "processor/nested_range_index-inl.h"
 
-#include "processor/linked_ptr.h"
 #include "google_breakpad/processor/stack_frame.h"
 #include "processor/cfi_frame_info.h"
+#include "processor/cfi_frame_info_cache.h"
 #include "processor/windows_frame_info.h"
 
 namespace google_breakpad {
 
 struct
 BasicSourceLineResolver::Function : public SourceLineResolverBase::Function {
-  Function(const string& function_name,
+  Function(StringView function_name,
            MemAddr function_address,
            MemAddr code_size,
            int set_parameter_size,
@@ -71,10 +76,28 @@ BasicSourceLineResolver::Function : public SourceLineResolverBase::Function {
 
   // Append inline into corresponding RangeMap.
   // This function assumes it's called in the order of reading INLINE records.
-  bool AppendInline(linked_ptr<Inline> in);
-
-  ContainedRangeMap<MemAddr, linked_ptr<Inline>> inlines;
-  RangeMap<MemAddr, linked_ptr<Line>> lines;
+  bool AppendInline(Inline* in);
+
+  // Builds |inline_index| from |inlines|, which is then cleared.  Called
+  // once the function's INLINE records have all been appended.
+  void IndexInlines() {
+    inline_index.Build(inlines);
+    inlines.Clear();
+  }
+
+  // Moves |lines| into |line_index|, which lookups in a frozen module use.
+  void FreezeLines() {
+    line_index.Build(lines);
+    lines.Clear();
+  }
+
+  // The inlines and lines are owned by the module's arena.  |inlines| holds
+  // the inlines as they are appended, and |inline_index| once they are
+  // indexed, which is what lookups use.
+  ContainedRangeMap<MemAddr, Inline*> inlines;
+  NestedRangeIndex<MemAddr, Inline*> inline_index;
+  RangeMap<MemAddr, Line*> lines;
+  FlatRangeMap<MemAddr, Line*> line_index;
 
  private:
   typedef SourceLineResolverBase::Function Base;
@@ -86,7 +109,14 @@ BasicSourceLineResolver::Function : public SourceLineResolverBase::Function {
 
 class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
  public:
-  explicit Module(const string& name) : name_(name), is_corrupt_(false) { }
+  // A module created with |freeze| set moves its records out of their maps
+  // into sorted arrays once they are loaded.  Lookups give the same
+  // results, but ModuleSerializer cannot serialize a frozen module.
+  explicit Module(const string& name, int load_thread_count = 1,
+                  bool freeze = false)
+      : name_(name), is_corrupt_(false), memory_usage_(),
+        load_thread_count_(load_thread_count), freeze_(freeze),
+        frozen_(false) { }
   virtual ~Module() { }
 
   // Loads a map from the given buffer in char* type.
@@ -94,6 +124,9 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
   // The passed in |memory buffer| is of size |memory_buffer_size|.  If it is
   // not null terminated, LoadMapFromMemory() will null terminate it by
   // modifying the passed in buffer.
+  // With a |load_thread_count| above 1, large buffers are split into
+  // sections at record boundaries that are parsed on that many threads and
+  // then merged in file order, giving the same module as a serial load.
   virtual bool LoadMapFromMemory(char* memory_buffer,
                                  size_t memory_buffer_size);
 
@@ -106,6 +139,7 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
   virtual void LookupAddress(
       StackFrame* frame,
       std::deque<std::unique_ptr<StackFrame>>* inlined_frame) const;
+  virtual void LookupAddressWithInlineRecords(StackFrame* frame) const;
 
   // Construct inlined frames for |frame| and store them in |inline_frames|.
   // |frame|'s source line and source file name may be updated if an inlined
@@ -114,7 +148,7 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
   virtual void ConstructInlineFrames(
       StackFrame* frame,
       MemAddr address,
-      const ContainedRangeMap<uint64_t, linked_ptr<Inline>>& inline_map,
+      const NestedRangeIndex<uint64_t, Inline*>& inline_map,
       std::deque<std::unique_ptr<StackFrame>>* inline_frames) const;
 
   // If Windows stack walking information is available covering ADDRESS,
@@ -130,13 +164,40 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
   // returned CFIFrameInfo object.
   virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame) const;
 
+  // The parsed records, estimated while loading.  The memory buffer is not
+  // counted, since the module does not keep it.
+  virtual size_t ResidentBytes() const;
+  virtual void GetMemoryUsage(ModuleMemoryUsage* usage) const;
+
+  // Tells whether the records have been moved into sorted arrays.
+  bool IsFrozen() const { return frozen_; }
+
  private:
+  // Looks up the given relative address for LookupAddress, or with
+  // |record_inlines| set, for LookupAddressWithInlineRecords.
+  void LookupAddress(StackFrame* frame,
+                     std::deque<std::unique_ptr<StackFrame>>* inlined_frames,
+                     bool record_inlines) const;
+
+  // Records the inlines of |inline_map| containing |address| in |frame|,
+  // whose source line is in the FILE record |line_file_id|.
+  void RecordInlines(StackFrame* frame, MemAddr address,
+                     const NestedRangeIndex<uint64_t, Inline*>& inline_map,
+                     int line_file_id) const;
+
+  virtual bool GetInlineOriginName(int origin_id, string* name) const;
+  virtual bool GetFileName(int file_id, string* name) const;
+
   // Friend declarations.
   friend class BasicSourceLineResolver;
   friend class ModuleComparer;
   friend class ModuleSerializer;
 
-  typedef std::map<int, string> FileMap;
+  typedef std::map<int, StringView> FileMap;
+
+  // The records parsed from one section of a symbol file, in file order,
+  // waiting to be merged into the module.
+  struct ParsedChunk;
 
   // Logs parse errors.  |*num_errors| is increased every time LogParseError is
   // called.
@@ -145,44 +206,110 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
       int line_number,
       int* num_errors);
 
+  // Parses the null terminated section of a symbol file starting at
+  // |chunk_begin| into |chunk|.  Touches no module state, so sections can
+  // be parsed concurrently.
+  static void ParseChunk(char* chunk_begin, ParsedChunk* chunk);
+
+  // Parses a line or INLINE record belonging to |function|, which may be
+  // NULL if the record has no enclosing FUNC.
+  static void ParseFunctionRecord(char* record, int line_number,
+                                  Function* function, ParsedChunk* chunk);
+
+  // Stores the records of |chunk|, whose first record is on line
+  // |first_line_number| + 1, into the module and logs its parse errors.
+  // |*cur_func| is the function still open at the end of the previous
+  // chunk, and is updated to the one open at the end of this chunk.
+  void MergeChunk(ParsedChunk* chunk, int first_line_number,
+                  Function** cur_func,
+                  int* num_errors, int* inline_num_errors);
+
   // Parses a file declaration
-  bool ParseFile(char* file_line);
+  static bool ParseFile(char* file_line, ParsedChunk* chunk);
 
   // Parses an inline origin declaration.
-  bool ParseInlineOrigin(char* inline_origin_line);
+  static bool ParseInlineOrigin(char* inline_origin_line, ParsedChunk* chunk);
 
-  // Parses an inline declaration.
-  linked_ptr<Inline> ParseInline(char* inline_line);
+  // Parses an inline declaration, returning a new Inline object allocated in
+  // |arena|.
+  static Inline* ParseInline(char* inline_line, Arena* arena);
 
-  // Parses a function declaration, returning a new Function object.
-  Function* ParseFunction(char* function_line);
+  // Parses a function declaration, returning a new Function object allocated
+  // in |arena| whose name points into |function_line|.
+  static Function* ParseFunction(char* function_line, Arena* arena);
 
-  // Parses a line declaration, returning a new Line object.
-  Line* ParseLine(char* line_line);
+  // Parses a line declaration, returning a new Line object allocated in
+  // |arena|.
+  static Line* ParseLine(char* line_line, Arena* arena);
 
-  // Parses a PUBLIC symbol declaration, storing it in public_symbols_.
+  // Parses a PUBLIC symbol declaration, adding it to |chunk|.
   // Returns false if an error occurs.
-  bool ParsePublicSymbol(char* public_line);
-
-  // Parses a STACK WIN or STACK CFI frame info declaration, storing
-  // it in the appropriate table.
-  bool ParseStackInfo(char* stack_info_line);
-
-  // Parses a STACK CFI record, storing it in cfi_frame_info_.
-  bool ParseCFIFrameInfo(char* stack_info_line);
+  static bool ParsePublicSymbol(char* public_line, int line_number,
+                                ParsedChunk* chunk);
+
+  // Parses a STACK WIN or STACK CFI frame info declaration, adding it to
+  // |chunk|.
+  static bool ParseStackInfo(char* stack_info_line, ParsedChunk* chunk);
+
+  // Parses a STACK CFI record, adding it to |chunk|.
+  static bool ParseCFIFrameInfo(char* stack_info_line, ParsedChunk* chunk);
+
+  // Splits the STACK CFI record |stack_info_line|, after its "STACK CFI "
+  // prefix, into whether it is an INIT record, its address, the size of an
+  // INIT record's range and its rules, which point inside |stack_info_line|.
+  static bool ParseCFIRecord(char* stack_info_line, bool* is_initial,
+                             MemAddr* address, MemAddr* size, char** rules);
+
+  // Moves the records of the loaded module out of the maps below into
+  // their frozen_ counterparts, and frees the maps.  The lines of each
+  // function are frozen as its inlines are indexed.
+  void Freeze();
+
+  // Lookups in whichever of the maps or the sorted arrays hold the
+  // records.
+  bool RetrieveFunction(MemAddr address, Function** function,
+                        MemAddr* function_base, MemAddr* function_size) const;
+  bool RetrieveLine(const Function* function, MemAddr address, Line** line,
+                    MemAddr* line_base) const;
+  bool RetrievePublicSymbol(MemAddr address, PublicSymbol** public_symbol,
+                            MemAddr* public_address) const;
+  bool RetrieveWindowsFrameInfo(WindowsFrameInfo::StackInfoTypes type,
+                                MemAddr address,
+                                WindowsFrameInfo** frame_info) const;
+
+  // Assembles the rules for |address| from |initial_rules|, the STACK CFI
+  // INIT rules for the range starting at |initial_base|, and the
+  // |delta_rules|, which are cfi_delta_rules_ or frozen_cfi_delta_rules_.
+  template<typename DeltaRules>
+  CFIFrameInfo* AssembleCFIFrameInfo(const DeltaRules& delta_rules,
+                                     MemAddr address,
+                                     const string& initial_rules,
+                                     MemAddr initial_base) const;
 
   string name_;
+  // The function, public symbol and inline origin names and the file names
+  // the records below refer to.  Declared first so that it outlives them.
+  StringPool strings_;
+  // The records the maps below point to, freed all at once with the module.
+  Arena arena_;
   FileMap files_;
-  std::map<int, linked_ptr<InlineOrigin>> inline_origins_;
-  RangeMap< MemAddr, linked_ptr<Function> > functions_;
-  AddressMap< MemAddr, linked_ptr<PublicSymbol> > public_symbols_;
+  std::map<int, InlineOrigin*> inline_origins_;
+  RangeMap< MemAddr, Function* > functions_;
+  AddressMap< MemAddr, PublicSymbol* > public_symbols_;
   bool is_corrupt_;
+  // The estimate ResidentBytes() sums, by kind of record.
+  ModuleMemoryUsage memory_usage_;
+  int load_thread_count_;
+  // Whether to freeze the module once it is loaded, and whether it has
+  // been.
+  bool freeze_;
+  bool frozen_;
 
   // Each element in the array is a ContainedRangeMap for a type
   // listed in WindowsFrameInfoTypes. These are split by type because
   // there may be overlaps between maps of different types, but some
   // information is only available as certain types.
-  ContainedRangeMap< MemAddr, linked_ptr<WindowsFrameInfo> >
+  ContainedRangeMap< MemAddr, WindowsFrameInfo* >
     windows_frame_info_[WindowsFrameInfo::STACK_INFO_LAST];
 
   // DWARF CFI stack walking data. The Module stores the initial rule sets
@@ -202,6 +329,18 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
   // this map, or the end of the range as given by the cfi_initial_rules_
   // entry (which FindCFIFrameInfo looks up first).
   std::map<MemAddr, string> cfi_delta_rules_;
+
+  // The records of the maps above once the module is frozen, which are
+  // then empty.
+  FlatRangeMap<MemAddr, Function*> frozen_functions_;
+  FlatAddressMap<MemAddr, PublicSymbol*> frozen_public_symbols_;
+  NestedRangeIndex<MemAddr, WindowsFrameInfo*>
+    frozen_windows_frame_info_[WindowsFrameInfo::STACK_INFO_LAST];
+  FlatRangeMap<MemAddr, string> frozen_cfi_initial_rules_;
+  FlatAddressMap<MemAddr, string> frozen_cfi_delta_rules_;
+
+  // The rule sets FindCFIFrameInfo has assembled from the records above.
+  mutable CFIFrameInfoCache cfi_frame_info_cache_;
 };
 
 }  // namespace google_breakpad
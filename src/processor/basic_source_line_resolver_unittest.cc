@@ -33,10 +33,15 @@
 #include <assert.h>
 #include <stdio.h>
 
+#include <fstream>
+#include <iterator>
 #include <string>
+#include <vector>
 
 #include "breakpad_googletest_includes.h"
+#include "common/block_gzip.h"
 #include "common/scoped_ptr.h"
+#include "common/tests/auto_tempdir.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
 #include "google_breakpad/processor/code_module.h"
@@ -49,10 +54,13 @@
 
 namespace {
 
+using google_breakpad::AutoTempDir;
 using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::BlockGzipWriter;
 using google_breakpad::CFIFrameInfo;
 using google_breakpad::CodeModule;
 using google_breakpad::MemoryRegion;
+using google_breakpad::SourceLineResolverBase;
 using google_breakpad::StackFrame;
 using google_breakpad::WindowsFrameInfo;
 using google_breakpad::scoped_ptr;
@@ -420,6 +428,308 @@ TEST_F(TestBasicSourceLineResolver, TestUnload)
   ASSERT_TRUE(resolver.HasModule(&module1));
 }
 
+#ifdef HAVE_LIBZ
+TEST_F(TestBasicSourceLineResolver, TestLoadCompressed)
+{
+  char* symbols;
+  size_t symbols_size;
+  ASSERT_TRUE(SourceLineResolverBase::ReadSymbolFile(
+      testdata_dir + "/module1.out", &symbols, &symbols_size));
+  AutoTempDir temp_dir;
+  string compressed_file = temp_dir.path() + "/module1.out.gz";
+  {
+    std::ofstream file(compressed_file.c_str(), std::ios::binary);
+    // Small blocks, so that there are several to decompress at once.
+    BlockGzipWriter writer(&file, 2, 256);
+    std::ostream stream(&writer);
+    stream.write(symbols, symbols_size - 1);
+    ASSERT_TRUE(writer.Finish());
+  }
+  delete [] symbols;
+
+  TestCodeModule module1("module1");
+  ASSERT_TRUE(resolver.LoadModule(&module1, testdata_dir + "/module1.out"));
+  BasicSourceLineResolver compressed_resolver;
+  compressed_resolver.set_decompression_thread_count(3);
+  ASSERT_TRUE(compressed_resolver.LoadModule(&module1, compressed_file));
+  ASSERT_FALSE(compressed_resolver.IsModuleCorrupt(&module1));
+
+  for (uint64_t address = 0x1000; address < 0x3200; address += 0x10) {
+    StackFrame frame;
+    frame.instruction = address;
+    frame.module = &module1;
+    compressed_resolver.FillSourceLineInfo(&frame, nullptr);
+    StackFrame expected_frame;
+    expected_frame.instruction = address;
+    expected_frame.module = &module1;
+    resolver.FillSourceLineInfo(&expected_frame, nullptr);
+    ASSERT_EQ(frame.function_name, expected_frame.function_name);
+    ASSERT_EQ(frame.source_file_name, expected_frame.source_file_name);
+    ASSERT_EQ(frame.source_line, expected_frame.source_line);
+  }
+
+  // A damaged file fails to load instead of loading as garbage.
+  string truncated_file = temp_dir.path() + "/truncated.out";
+  {
+    std::ifstream file(compressed_file.c_str(), std::ios::binary);
+    string data((std::istreambuf_iterator<char>(file)),
+                std::istreambuf_iterator<char>());
+    std::ofstream out(truncated_file.c_str(), std::ios::binary);
+    out.write(data.data(), data.size() - 1);
+  }
+  TestCodeModule module2("module2");
+  ASSERT_FALSE(compressed_resolver.LoadModule(&module2, truncated_file));
+}
+#endif  // HAVE_LIBZ
+
+TEST_F(TestBasicSourceLineResolver, TestModuleCacheStats)
+{
+  TestCodeModule module1("module1");
+  TestCodeModule module2("module2");
+  ASSERT_EQ(resolver.module_cache_budget(), 0U);
+  ASSERT_FALSE(resolver.HasModule(&module1));
+  ASSERT_TRUE(resolver.LoadModule(&module1, testdata_dir + "/module1.out"));
+  ASSERT_TRUE(resolver.HasModule(&module1));
+  size_t module1_bytes = resolver.module_cache_stats().resident_bytes;
+  ASSERT_GT(module1_bytes, 0U);
+
+  ASSERT_TRUE(resolver.LoadModule(&module2, testdata_dir + "/module2.out"));
+  BasicSourceLineResolver::ModuleCacheStats stats =
+      resolver.module_cache_stats();
+  EXPECT_EQ(stats.hits, 1U);
+  EXPECT_EQ(stats.misses, 1U);
+  EXPECT_EQ(stats.evictions, 0U);
+  EXPECT_EQ(stats.module_count, 2U);
+  EXPECT_GT(stats.resident_bytes, module1_bytes);
+
+  resolver.UnloadModule(&module2);
+  stats = resolver.module_cache_stats();
+  EXPECT_EQ(stats.module_count, 1U);
+  EXPECT_EQ(stats.resident_bytes, module1_bytes);
+}
+
+TEST_F(TestBasicSourceLineResolver, TestModuleCacheBudget)
+{
+  TestCodeModule module1("module1");
+  TestCodeModule module2("module2");
+  resolver.set_module_cache_budget(1 << 30);
+  ASSERT_TRUE(resolver.LoadModule(&module1, testdata_dir + "/module1.out"));
+  size_t module1_bytes = resolver.module_cache_stats().resident_bytes;
+  ASSERT_TRUE(resolver.LoadModule(&module2, testdata_dir + "/module2.out"));
+  size_t module2_bytes =
+      resolver.module_cache_stats().resident_bytes - module1_bytes;
+
+  // Touching module1 makes module2 the least recently used module, so
+  // shrinking the budget to fit only one of them evicts module2.
+  StackFrame frame;
+  frame.instruction = 0x1000;
+  frame.module = &module1;
+  resolver.FillSourceLineInfo(&frame, nullptr);
+  resolver.set_module_cache_budget(module1_bytes + module2_bytes - 1);
+  EXPECT_TRUE(resolver.HasModule(&module1));
+  EXPECT_FALSE(resolver.HasModule(&module2));
+  EXPECT_EQ(resolver.module_cache_stats().evictions, 1U);
+
+  // Loading module2 again pushes module1 out instead.
+  resolver.set_module_cache_budget(module2_bytes);
+  ASSERT_TRUE(resolver.LoadModule(&module2, testdata_dir + "/module2.out"));
+  EXPECT_FALSE(resolver.HasModule(&module1));
+  EXPECT_TRUE(resolver.HasModule(&module2));
+  EXPECT_EQ(resolver.module_cache_stats().evictions, 2U);
+
+  // A module larger than the whole budget is still kept once loaded.
+  resolver.set_module_cache_budget(1);
+  EXPECT_FALSE(resolver.HasModule(&module2));
+  ASSERT_TRUE(resolver.LoadModule(&module2, testdata_dir + "/module2.out"));
+  EXPECT_TRUE(resolver.HasModule(&module2));
+  BasicSourceLineResolver::ModuleCacheStats stats =
+      resolver.module_cache_stats();
+  EXPECT_EQ(stats.module_count, 1U);
+  EXPECT_EQ(stats.resident_bytes, module2_bytes);
+}
+
+TEST_F(TestBasicSourceLineResolver, TestHottestModules)
+{
+  TestCodeModule module1("module1");
+  TestCodeModule module2("module2");
+  TestCodeModule module0("module0");
+  ASSERT_TRUE(resolver.LoadModule(&module1, testdata_dir + "/module1.out"));
+  ASSERT_TRUE(resolver.LoadModule(&module2, testdata_dir + "/module2.out"));
+  ASSERT_TRUE(resolver.LoadModule(&module0, testdata_dir + "/module0.out"));
+  ASSERT_TRUE(resolver.HasModule(&module2));
+  ASSERT_TRUE(resolver.HasModule(&module2));
+  ASSERT_TRUE(resolver.HasModule(&module1));
+
+  std::vector<BasicSourceLineResolver::ModuleHits> hottest =
+      resolver.HottestModules(2);
+  ASSERT_EQ(hottest.size(), 2U);
+  EXPECT_EQ(hottest[0].code_file, "module2");
+  EXPECT_EQ(hottest[0].hits, 2U);
+  EXPECT_EQ(hottest[1].code_file, "module1");
+  EXPECT_EQ(hottest[1].hits, 1U);
+
+  // A module loaded again starts over.
+  resolver.UnloadModule(&module2);
+  ASSERT_TRUE(resolver.LoadModule(&module2, testdata_dir + "/module2.out"));
+  hottest = resolver.HottestModules(10);
+  ASSERT_EQ(hottest.size(), 3U);
+  EXPECT_EQ(hottest[0].code_file, "module1");
+  EXPECT_EQ(hottest[1].hits, 0U);
+  EXPECT_EQ(hottest[2].hits, 0U);
+}
+
+TEST_F(TestBasicSourceLineResolver, TestModuleMemoryUsages)
+{
+  TestCodeModule module1("module1");
+  TestCodeModule module2("module2");
+  ASSERT_TRUE(resolver.LoadModule(&module1, testdata_dir + "/module1.out"));
+  size_t module1_bytes = resolver.module_cache_stats().resident_bytes;
+  ASSERT_TRUE(resolver.LoadModule(&module2, testdata_dir + "/module2.out"));
+  size_t module2_bytes =
+      resolver.module_cache_stats().resident_bytes - module1_bytes;
+
+  std::vector<BasicSourceLineResolver::ModuleMemoryUsage> usages =
+      resolver.ModuleMemoryUsages();
+  ASSERT_EQ(usages.size(), 2U);
+  EXPECT_GE(usages[0].resident_bytes, usages[1].resident_bytes);
+  for (const BasicSourceLineResolver::ModuleMemoryUsage& usage : usages) {
+    EXPECT_EQ(usage.resident_bytes,
+              usage.code_file == "module1" ? module1_bytes : module2_bytes);
+    EXPECT_EQ(usage.files + usage.functions + usage.public_symbols +
+                  usage.inline_origins + usage.windows_frame_info +
+                  usage.cfi_initial_rules + usage.cfi_delta_rules,
+              usage.resident_bytes);
+    EXPECT_GT(usage.files, 0U);
+    EXPECT_GT(usage.functions, 0U);
+    // The module does not keep the symbol data it was parsed from.
+    EXPECT_EQ(usage.copied_buffer_bytes, 0U);
+    EXPECT_EQ(usage.supplied_buffer_bytes, 0U);
+  }
+  const BasicSourceLineResolver::ModuleMemoryUsage& module2_usage =
+      usages[usages[0].code_file == "module2" ? 0 : 1];
+  EXPECT_GT(module2_usage.windows_frame_info, 0U);
+  EXPECT_GT(module2_usage.cfi_initial_rules, 0U);
+  EXPECT_GT(module2_usage.cfi_delta_rules, 0U);
+  EXPECT_EQ(module2_usage.inline_origins, 0U);
+
+  resolver.UnloadModule(&module2);
+  usages = resolver.ModuleMemoryUsages();
+  ASSERT_EQ(usages.size(), 1U);
+  EXPECT_EQ(usages[0].code_file, "module1");
+}
+
+TEST_F(TestBasicSourceLineResolver, TestParallelLoad)
+{
+  // A symbol file large enough to be split into many sections.  The last
+  // line record of each function follows its STACK records, so it still
+  // belongs to that FUNC when a section starts at one of them.
+  const int kFunctionCount = 20000;
+  string symbols = "MODULE Linux x86_64 000000000000000000000000000000000 "
+                   "module1\nFILE 0 file0.cc\nFILE 1 file1.cc\n";
+  char record[128];
+  for (int i = 0; i < kFunctionCount; ++i) {
+    uint64_t address = 0x1000 + i * 0x100;
+    snprintf(record, sizeof(record), "FUNC %" PRIx64 " 100 0 function%d\n",
+             address, i);
+    symbols += record;
+    snprintf(record, sizeof(record), "%" PRIx64 " 40 %d 0\n", address, i);
+    symbols += record;
+    snprintf(record, sizeof(record), "%" PRIx64 " 40 %d 1\n", address + 0x40,
+             i + 1);
+    symbols += record;
+    snprintf(record, sizeof(record),
+             "STACK CFI INIT %" PRIx64 " 100 .cfa: $esp 4 + .ra: .cfa 4 - ^\n",
+             address);
+    symbols += record;
+    snprintf(record, sizeof(record), "STACK CFI %" PRIx64 " .cfa: $esp %d +\n",
+             address + 1, i % 16 + 8);
+    symbols += record;
+    snprintf(record, sizeof(record), "%" PRIx64 " 80 %d 0\n", address + 0x80,
+             i + 2);
+    symbols += record;
+  }
+  for (int i = 0; i < kFunctionCount; i += 100) {
+    snprintf(record, sizeof(record), "PUBLIC %" PRIx64 " 0 public%d\n",
+             static_cast<uint64_t>(0x10000000 + i), i);
+    symbols += record;
+  }
+
+  TestCodeModule module("module");
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module, symbols));
+  BasicSourceLineResolver parallel_resolver;
+  parallel_resolver.set_load_thread_count(4);
+  ASSERT_TRUE(parallel_resolver.LoadModuleUsingMapBuffer(&module, symbols));
+  ASSERT_FALSE(resolver.IsModuleCorrupt(&module));
+  ASSERT_FALSE(parallel_resolver.IsModuleCorrupt(&module));
+
+  for (int i = 0; i < kFunctionCount; ++i) {
+    uint64_t address = 0x1000 + i * 0x100;
+    for (uint64_t offset = 0; offset < 0x100; offset += 0x40) {
+      StackFrame frame;
+      frame.instruction = address + offset;
+      frame.module = &module;
+      parallel_resolver.FillSourceLineInfo(&frame, nullptr);
+      StackFrame expected_frame;
+      expected_frame.instruction = address + offset;
+      expected_frame.module = &module;
+      resolver.FillSourceLineInfo(&expected_frame, nullptr);
+      ASSERT_EQ(frame.function_name, expected_frame.function_name);
+      ASSERT_EQ(frame.source_file_name, expected_frame.source_file_name);
+      ASSERT_EQ(frame.source_line, expected_frame.source_line);
+    }
+    StackFrame frame;
+    frame.instruction = address + 0x10;
+    frame.module = &module;
+    ASSERT_EQ(frame.function_name, "");
+    parallel_resolver.FillSourceLineInfo(&frame, nullptr);
+    ASSERT_EQ(frame.source_line, i);
+    scoped_ptr<CFIFrameInfo> cfi_frame_info(
+        parallel_resolver.FindCFIFrameInfo(&frame));
+    scoped_ptr<CFIFrameInfo> expected_cfi_frame_info(
+        resolver.FindCFIFrameInfo(&frame));
+    ASSERT_TRUE(cfi_frame_info.get());
+    ASSERT_TRUE(expected_cfi_frame_info.get());
+    ASSERT_EQ(cfi_frame_info->Serialize(),
+              expected_cfi_frame_info->Serialize());
+  }
+
+  StackFrame frame;
+  frame.instruction = 0x10000000 + 4200;
+  frame.module = &module;
+  parallel_resolver.FillSourceLineInfo(&frame, nullptr);
+  EXPECT_EQ(frame.function_name, "public4200");
+}
+
+// Repeated lookups are answered from the per-module rule set cache; they
+// must agree with a resolver that has never seen the address, and each
+// caller must own an independent copy.
+TEST_F(TestBasicSourceLineResolver, TestCFIFrameInfoCache)
+{
+  TestCodeModule module1("module1");
+  ASSERT_TRUE(resolver.LoadModule(&module1, testdata_dir + "/module1.out"));
+
+  StackFrame frame;
+  frame.module = &module1;
+  for (uint64_t address = 0x3d3f; address < 0x3d90; ++address) {
+    frame.instruction = address;
+    BasicSourceLineResolver fresh_resolver;
+    ASSERT_TRUE(fresh_resolver.LoadModule(&module1,
+                                          testdata_dir + "/module1.out"));
+    scoped_ptr<CFIFrameInfo> expected(fresh_resolver.FindCFIFrameInfo(&frame));
+    for (int pass = 0; pass < 2; ++pass) {
+      scoped_ptr<CFIFrameInfo> cfi_frame_info(
+          resolver.FindCFIFrameInfo(&frame));
+      ASSERT_EQ(expected.get() == NULL, cfi_frame_info.get() == NULL);
+      if (!expected.get())
+        continue;
+      ASSERT_EQ(expected->Serialize(), cfi_frame_info->Serialize());
+      // Scribbling on the copy must not leak into the cached rules.
+      cfi_frame_info->SetCFARule("$esp 1234 +");
+      cfi_frame_info->SetRegisterRule("$ebx", "$esp");
+    }
+  }
+}
+
 TEST_F(TestBasicSourceLineResolver, TestLoadAndResolveOldInlines) {
   TestCodeModule module("linux_inline");
   ASSERT_TRUE(resolver.LoadModule(
@@ -510,6 +820,139 @@ TEST_F(TestBasicSourceLineResolver, TestLoadAndResolveNewInlines) {
   ASSERT_EQ(inlined_frames[0]->trust, StackFrame::FRAME_TRUST_INLINE);
 }
 
+// A frozen module answers every lookup as the module it was frozen from.
+TEST_F(TestBasicSourceLineResolver, TestFreezeModules) {
+  BasicSourceLineResolver frozen_resolver;
+  frozen_resolver.set_freeze_modules(true);
+  const struct {
+    const char* code_file;
+    string symbol_file;
+    uint64_t low, high;
+  } kModules[] = {
+    { "module1", testdata_dir + "/module1.out", 0, 0xb000 },
+    { "module2", testdata_dir + "/module2.out", 0, 0x3000 },
+    { "linux_inline",
+      testdata_dir + "/symbols/linux_inline/BBA6FA10B8AAB33D00000000000000000/"
+                     "linux_inline.new.sym",
+      0x15b00, 0x16300 },
+  };
+  for (const auto& test_module : kModules) {
+    TestCodeModule module(test_module.code_file);
+    ASSERT_TRUE(resolver.LoadModule(&module, test_module.symbol_file));
+    ASSERT_TRUE(frozen_resolver.LoadModule(&module, test_module.symbol_file));
+    EXPECT_EQ(resolver.IsModuleCorrupt(&module),
+              frozen_resolver.IsModuleCorrupt(&module));
+
+    for (uint64_t address = test_module.low; address < test_module.high;
+         ++address) {
+      SCOPED_TRACE(address);
+      StackFrame expected;
+      expected.instruction = address;
+      expected.module = &module;
+      std::deque<std::unique_ptr<StackFrame>> expected_inlines;
+      resolver.FillSourceLineInfo(&expected, &expected_inlines);
+      StackFrame frame;
+      frame.instruction = address;
+      frame.module = &module;
+      std::deque<std::unique_ptr<StackFrame>> inlines;
+      frozen_resolver.FillSourceLineInfo(&frame, &inlines);
+      ASSERT_EQ(expected.function_name, frame.function_name);
+      ASSERT_EQ(expected.function_base, frame.function_base);
+      ASSERT_EQ(expected.source_file_name, frame.source_file_name);
+      ASSERT_EQ(expected.source_line, frame.source_line);
+      ASSERT_EQ(expected.source_line_base, frame.source_line_base);
+      ASSERT_EQ(expected.is_multiple, frame.is_multiple);
+      ASSERT_EQ(expected_inlines.size(), inlines.size());
+      for (size_t i = 0; i < inlines.size(); ++i) {
+        ASSERT_EQ(expected_inlines[i]->function_name,
+                  inlines[i]->function_name);
+        ASSERT_EQ(expected_inlines[i]->source_line, inlines[i]->source_line);
+      }
+
+      scoped_ptr<WindowsFrameInfo> expected_windows(
+          resolver.FindWindowsFrameInfo(&frame));
+      scoped_ptr<WindowsFrameInfo> windows(
+          frozen_resolver.FindWindowsFrameInfo(&frame));
+      ASSERT_EQ(!!expected_windows.get(), !!windows.get());
+      if (windows.get()) {
+        ASSERT_EQ(expected_windows->type_, windows->type_);
+        ASSERT_EQ(expected_windows->valid, windows->valid);
+        ASSERT_EQ(expected_windows->parameter_size, windows->parameter_size);
+        ASSERT_EQ(expected_windows->program_string, windows->program_string);
+      }
+
+      scoped_ptr<CFIFrameInfo> expected_cfi(
+          resolver.FindCFIFrameInfo(&frame));
+      scoped_ptr<CFIFrameInfo> cfi(frozen_resolver.FindCFIFrameInfo(&frame));
+      ASSERT_EQ(!!expected_cfi.get(), !!cfi.get());
+      if (cfi.get())
+        ASSERT_EQ(expected_cfi->Serialize(), cfi->Serialize());
+    }
+  }
+}
+
+// Inlined frames recorded during the lookup and expanded later are the
+// ones FillSourceLineInfo constructs.
+TEST_F(TestBasicSourceLineResolver, TestExpandInlineFrames) {
+  const char* kSymbolFiles[] = { "linux_inline.old.sym",
+                                 "linux_inline.new.sym" };
+  for (const char* symbol_file : kSymbolFiles) {
+    SCOPED_TRACE(symbol_file);
+    BasicSourceLineResolver inline_resolver;
+    TestCodeModule module("linux_inline");
+    ASSERT_TRUE(inline_resolver.LoadModule(
+        &module, testdata_dir +
+                     "/symbols/linux_inline/BBA6FA10B8AAB33D00000000000000000/" +
+                     symbol_file));
+    for (uint64_t address = 0x15b00; address < 0x16300; ++address) {
+      SCOPED_TRACE(address);
+      StackFrame expected;
+      expected.instruction = address;
+      expected.module = &module;
+      std::deque<std::unique_ptr<StackFrame>> expected_inlines;
+      inline_resolver.FillSourceLineInfo(&expected, &expected_inlines);
+      StackFrame frame;
+      frame.instruction = address;
+      frame.module = &module;
+      inline_resolver.FillSourceLineInfoWithInlineRecords(&frame);
+      ASSERT_EQ(expected.function_name, frame.function_name);
+      ASSERT_EQ(expected.function_base, frame.function_base);
+      ASSERT_EQ(expected.source_file_name, frame.source_file_name);
+      ASSERT_EQ(expected.source_line, frame.source_line);
+      ASSERT_EQ(expected.source_line_base, frame.source_line_base);
+      ASSERT_EQ(expected_inlines.size(), frame.inline_records.size());
+
+      std::deque<std::unique_ptr<StackFrame>> inlines;
+      ASSERT_TRUE(inline_resolver.ExpandInlineFrames(frame, &inlines));
+      ASSERT_EQ(expected_inlines.size(), inlines.size());
+      for (size_t i = 0; i < inlines.size(); ++i) {
+        ASSERT_EQ(expected_inlines[i]->function_name,
+                  inlines[i]->function_name);
+        ASSERT_EQ(expected_inlines[i]->function_base,
+                  inlines[i]->function_base);
+        ASSERT_EQ(expected_inlines[i]->source_file_name,
+                  inlines[i]->source_file_name);
+        ASSERT_EQ(expected_inlines[i]->source_line, inlines[i]->source_line);
+        ASSERT_EQ(expected_inlines[i]->source_line_base,
+                  inlines[i]->source_line_base);
+        ASSERT_EQ(expected_inlines[i]->trust, inlines[i]->trust);
+        ASSERT_TRUE(inlines[i]->inline_records.empty());
+      }
+    }
+
+    // Once the module is unloaded, the records can no longer be expanded.
+    StackFrame frame;
+    frame.instruction = 0x161b6;
+    frame.module = &module;
+    inline_resolver.FillSourceLineInfoWithInlineRecords(&frame);
+    ASSERT_EQ(3U, frame.inline_records.size());
+    inline_resolver.UnloadModule(&module);
+    std::deque<std::unique_ptr<StackFrame>> inlines;
+    ASSERT_FALSE(inline_resolver.ExpandInlineFrames(frame, &inlines));
+    ASSERT_TRUE(inlines.empty());
+  }
+}
+
 // Test parsing of valid FILE lines.  The format is:
 // FILE <id> <filename>
 TEST(SymbolParseHelper, ParseFileValid) {
@@ -692,6 +1135,21 @@ TEST(SymbolParseHelper, ParseLineValid) {
   EXPECT_EQ(0xa2ULL, size);
   EXPECT_EQ(0, line_number);
   EXPECT_EQ(4, source_file);
+
+  // Test hexadecimal prefixes, extra spaces and an all-ones address that
+  // just fits.
+  char kTestLine3[] = "0xa1  0XA2 3   4";
+  ASSERT_TRUE(SymbolParseHelper::ParseLine(kTestLine3, &address, &size,
+                                           &line_number, &source_file));
+  EXPECT_EQ(0xa1ULL, address);
+  EXPECT_EQ(0xa2ULL, size);
+  EXPECT_EQ(3, line_number);
+  EXPECT_EQ(4, source_file);
+
+  char kTestLine4[] = "fffffffffffffffe 1 2 3";
+  ASSERT_TRUE(SymbolParseHelper::ParseLine(kTestLine4, &address, &size,
+                                           &line_number, &source_file));
+  EXPECT_EQ(0xfffffffffffffffeULL, address);
 }
 
 // Test parsing of invalid lines.  The format is:
@@ -738,6 +1196,14 @@ TEST(SymbolParseHelper, ParseLineInvalid) {
   char kTestLine8[] = "1 2 3 f";
   ASSERT_FALSE(SymbolParseHelper::ParseLine(kTestLine8, &address, &size,
                                             &line_number, &source_file));
+  // Test a tab, which does not separate fields.
+  char kTestLine9[] = "1 2\t 3 4";
+  ASSERT_FALSE(SymbolParseHelper::ParseLine(kTestLine9, &address, &size,
+                                            &line_number, &source_file));
+  // Test the all-ones address, which strtoull also returns on overflow.
+  char kTestLine10[] = "ffffffffffffffff 2 3 4";
+  ASSERT_FALSE(SymbolParseHelper::ParseLine(kTestLine10, &address, &size,
+                                            &line_number, &source_file));
 }
 
 // Test parsing of valid PUBLIC lines.  The format is:
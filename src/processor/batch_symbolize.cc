@@ -0,0 +1,242 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// batch_symbolize.cc: Symbolize module-relative addresses read from stdin
+// with BatchSymbolizer, such as those a profiler records, printing one
+// line per address.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/path_helper.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/batch_symbolizer.h"
+#include "processor/basic_code_module.h"
+#include "processor/logging.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::BatchSymbolizer;
+using google_breakpad::CodeModule;
+using google_breakpad::SimpleSymbolSupplier;
+
+struct Options {
+  std::vector<string> symbol_paths;
+  // The name of the index file listing the symbol files in each of
+  // |symbol_paths|, or empty to look for each symbol file.
+  string symbol_index_file;
+  // The number of input lines symbolized together.
+  size_t batch_lines;
+  // Limits the memory used by loaded symbols (0 for no limit).
+  size_t module_cache_bytes;
+};
+
+// The modules named in the input so far, each identified by its debug
+// file and identifier.  A module's code file is set to both, so that the
+// resolver, which knows modules by code file, tells builds apart.
+class ModuleTable {
+ public:
+  // Returns the index of the module, adding it if it is new.
+  size_t Find(const string& debug_file, const string& debug_identifier) {
+    std::pair<string, string> key(debug_file, debug_identifier);
+    std::map<std::pair<string, string>, size_t>::const_iterator it =
+        indexes_.find(key);
+    if (it != indexes_.end())
+      return it->second;
+    size_t index = modules_.size();
+    owned_.emplace_back(new BasicCodeModule(
+        0, UINT64_MAX, debug_file + "/" + debug_identifier, "", debug_file,
+        debug_identifier, ""));
+    modules_.push_back(owned_.back().get());
+    indexes_[key] = index;
+    return index;
+  }
+
+  const std::vector<const CodeModule*>& modules() const { return modules_; }
+
+ private:
+  std::vector<std::unique_ptr<BasicCodeModule>> owned_;
+  std::vector<const CodeModule*> modules_;
+  std::map<std::pair<string, string>, size_t> indexes_;
+};
+
+// Prints the result for each line of a batch: the function and offset into
+// it, then the source file and line, with ?? for what is unknown.  Lines
+// that could not be parsed are printed as unknown.
+void PrintBatch(const BatchSymbolizer& symbolizer,
+                const std::vector<bool>& parsed,
+                const std::vector<BatchSymbolizer::Result>& results) {
+  const std::vector<string>& strings = symbolizer.strings();
+  size_t result_index = 0;
+  for (size_t i = 0; i < parsed.size(); ++i) {
+    if (!parsed[i]) {
+      printf("??\t??:0\n");
+      continue;
+    }
+    const BatchSymbolizer::Result& result = results[result_index++];
+    if (result.function_name == BatchSymbolizer::kNoString) {
+      printf("??");
+    } else {
+      printf("%s+0x%" PRIx64, strings[result.function_name].c_str(),
+             result.function_offset);
+    }
+    if (result.source_file == BatchSymbolizer::kNoString) {
+      printf("\t??:0\n");
+    } else {
+      printf("\t%s:%d\n", strings[result.source_file].c_str(),
+             result.source_line);
+    }
+  }
+}
+
+int SymbolizeInput(const Options& options) {
+  SimpleSymbolSupplier supplier(options.symbol_paths);
+  if (!options.symbol_index_file.empty())
+    supplier.set_index_file_name(options.symbol_index_file);
+  BasicSourceLineResolver resolver;
+  resolver.set_module_cache_budget(options.module_cache_bytes);
+  BatchSymbolizer symbolizer(&supplier, &resolver);
+
+  ModuleTable modules;
+  std::vector<bool> parsed;
+  std::vector<BatchSymbolizer::Address> addresses;
+  std::vector<BatchSymbolizer::Result> results;
+  char line[4096];
+  char debug_file[2048];
+  char debug_identifier[1024];
+  bool done = false;
+  while (!done) {
+    parsed.clear();
+    addresses.clear();
+    while (parsed.size() < options.batch_lines) {
+      if (!fgets(line, sizeof(line), stdin)) {
+        done = true;
+        break;
+      }
+      uint64_t offset;
+      bool ok = sscanf(line, "%2047s %1023s %" SCNx64, debug_file,
+                       debug_identifier, &offset) == 3;
+      parsed.push_back(ok);
+      if (ok) {
+        BatchSymbolizer::Address address = {
+          modules.Find(debug_file, debug_identifier), offset
+        };
+        addresses.push_back(address);
+      }
+    }
+    symbolizer.Symbolize(modules.modules(), addresses, &results);
+    PrintBatch(symbolizer, parsed, results);
+    // Each batch is printed before the next, so its strings can go.
+    symbolizer.ClearStrings();
+  }
+  return 0;
+}
+
+void Usage(int argc, const char* argv[], bool error) {
+  fprintf(error ? stderr : stdout,
+          "Usage: %s [options] [symbol-path ...]\n"
+          "\n"
+          "Read lines of the form\n"
+          "  <debug-file> <debug-identifier> <hex-offset>\n"
+          "from stdin, and print for each the function and source line at\n"
+          "that offset into the module, as\n"
+          "  <function>+0x<offset-into-function>\\t<source-file>:<line>\n"
+          "with ?? for what is unknown\n"
+          "\n"
+          "Options:\n"
+          "\n"
+          "  -b <n>     Symbolize this many lines at a time (default 65536)\n"
+          "  -M <mb>    Limit the memory used by loaded symbols to this many\n"
+          "             megabytes\n"
+          "  -x <name>  Find symbol files through the index file with this\n"
+          "             name in each symbol-path that has one\n",
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+void SetupOptions(int argc, const char* argv[], Options* options) {
+  options->batch_lines = 65536;
+  options->module_cache_bytes = 0;
+
+  int ch;
+  while ((ch = getopt(argc, (char * const*)argv, "b:hM:x:")) != -1) {
+    switch (ch) {
+      case 'h':
+        Usage(argc, argv, false);
+        exit(0);
+        break;
+
+      case 'b':
+        options->batch_lines = strtoul(optarg, NULL, 10);
+        if (options->batch_lines < 1) {
+          fprintf(stderr, "%s: -b needs a positive number\n", argv[0]);
+          exit(1);
+        }
+        break;
+      case 'M':
+        options->module_cache_bytes =
+            static_cast<size_t>(strtoul(optarg, NULL, 10)) << 20;
+        break;
+      case 'x':
+        options->symbol_index_file = optarg;
+        break;
+
+      case '?':
+        Usage(argc, argv, true);
+        exit(1);
+        break;
+    }
+  }
+
+  for (int argi = optind; argi < argc; ++argi)
+    options->symbol_paths.push_back(argv[argi]);
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  Options options;
+  SetupOptions(argc, argv, &options);
+  return SymbolizeInput(options);
+}
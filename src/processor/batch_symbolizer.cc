@@ -0,0 +1,169 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// batch_symbolizer.cc: Symbolizes many module-relative addresses at once.
+//
+// See batch_symbolizer.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "google_breakpad/processor/batch_symbolizer.h"
+
+#include <algorithm>
+
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/source_line_resolver_interface.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "google_breakpad/processor/symbol_supplier.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+const uint32_t BatchSymbolizer::kNoString;
+
+BatchSymbolizer::BatchSymbolizer(SymbolSupplier* supplier,
+                                 SourceLineResolverInterface* resolver)
+    : supplier_(supplier),
+      resolver_(resolver) {
+}
+
+size_t BatchSymbolizer::Symbolize(
+    const std::vector<const CodeModule*>& modules,
+    const std::vector<Address>& addresses,
+    std::vector<Result>* results) {
+  const Result unknown = { kNoString, kNoString, 0, 0 };
+  results->assign(addresses.size(), unknown);
+
+  // Visit the addresses by module and then by offset, so that each
+  // module's symbols are loaded once, its lookups run in address order,
+  // and repeats of an address are next to each other.
+  std::vector<size_t> order(addresses.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [&addresses](size_t a, size_t b) {
+    if (addresses[a].module != addresses[b].module)
+      return addresses[a].module < addresses[b].module;
+    return addresses[a].offset < addresses[b].offset;
+  });
+
+  size_t found = 0;
+  size_t begin = 0;
+  while (begin < order.size()) {
+    const size_t module_index = addresses[order[begin]].module;
+    size_t end = begin + 1;
+    while (end < order.size() && addresses[order[end]].module == module_index)
+      ++end;
+
+    const CodeModule* module =
+        module_index < modules.size() ? modules[module_index] : NULL;
+    if (module && LoadModule(module)) {
+      size_t i = begin;
+      while (i < end) {
+        const uint64_t offset = addresses[order[i]].offset;
+        const Result result = Lookup(module, offset);
+        for (; i < end && addresses[order[i]].offset == offset; ++i) {
+          (*results)[order[i]] = result;
+          if (result.function_name != kNoString)
+            ++found;
+        }
+      }
+    }
+    begin = end;
+  }
+  return found;
+}
+
+void BatchSymbolizer::ClearStrings() {
+  strings_.clear();
+  string_indexes_.clear();
+}
+
+bool BatchSymbolizer::LoadModule(const CodeModule* module) {
+  if (resolver_->HasModule(module))
+    return true;
+  if (!supplier_ || no_symbol_modules_.count(module->code_file()))
+    return false;
+
+  string symbol_file;
+  char* symbol_data = NULL;
+  size_t symbol_data_size = 0;
+  SymbolSupplier::SymbolResult symbol_result = supplier_->GetCStringSymbolData(
+      module, NULL, &symbol_file, &symbol_data, &symbol_data_size);
+  if (symbol_result == SymbolSupplier::INTERRUPT) {
+    // The symbols may be available for a later batch.
+    return false;
+  }
+
+  bool loaded = false;
+  if (symbol_result == SymbolSupplier::FOUND) {
+    loaded = resolver_->LoadModuleUsingMemoryBuffer(module, symbol_data,
+                                                    symbol_data_size);
+    if (resolver_->ShouldDeleteMemoryBufferAfterLoadModule())
+      supplier_->FreeSymbolData(module);
+    if (!loaded)
+      BPLOG(ERROR) << "Failed to load symbol file in resolver.";
+  }
+  if (!loaded)
+    no_symbol_modules_.insert(module->code_file());
+  return loaded;
+}
+
+BatchSymbolizer::Result BatchSymbolizer::Lookup(const CodeModule* module,
+                                                uint64_t offset) {
+  StackFrame frame;
+  frame.instruction = module->base_address() + offset;
+  frame.module = module;
+  resolver_->FillSourceLineInfo(&frame, NULL);
+
+  Result result = { kNoString, kNoString, 0, 0 };
+  if (!frame.function_name.empty()) {
+    result.function_name = Intern(frame.function_name);
+    result.function_offset = frame.instruction - frame.function_base;
+  }
+  if (!frame.source_file_name.empty()) {
+    result.source_file = Intern(frame.source_file_name);
+    result.source_line = frame.source_line;
+  }
+  return result;
+}
+
+uint32_t BatchSymbolizer::Intern(const string& str) {
+  std::unordered_map<string, uint32_t>::const_iterator it =
+      string_indexes_.find(str);
+  if (it != string_indexes_.end())
+    return it->second;
+  uint32_t index = static_cast<uint32_t>(strings_.size());
+  strings_.push_back(str);
+  string_indexes_[str] = index;
+  return index;
+}
+
+}  // namespace google_breakpad
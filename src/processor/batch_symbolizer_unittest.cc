@@ -0,0 +1,200 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// batch_symbolizer_unittest.cc: Unit tests for BatchSymbolizer.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/batch_symbolizer.h"
+#include "processor/basic_code_module.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::BatchSymbolizer;
+using google_breakpad::CodeModule;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::SystemInfo;
+using std::vector;
+
+// Counts the symbol files requested.
+class CountingSymbolSupplier : public SimpleSymbolSupplier {
+ public:
+  explicit CountingSymbolSupplier(const string& path)
+      : SimpleSymbolSupplier(path), requests_(0) {}
+
+  SymbolResult GetCStringSymbolData(const CodeModule* module,
+                                    const SystemInfo* system_info,
+                                    string* symbol_file,
+                                    char** symbol_data,
+                                    size_t* symbol_data_size) override {
+    ++requests_;
+    return SimpleSymbolSupplier::GetCStringSymbolData(
+        module, system_info, symbol_file, symbol_data, symbol_data_size);
+  }
+
+  int requests() const { return requests_; }
+
+ private:
+  int requests_;
+};
+
+class BatchSymbolizerTest : public ::testing::Test {
+ public:
+  BatchSymbolizerTest()
+      : module1_(0x10000000, 0x10000, "module1", "", "module1.pdb",
+                 "111111111111111111111111111111111", ""),
+        missing_(0x20000000, 0x10000, "missing", "", "missing.pdb",
+                 "222222222222222222222222222222222", "") {}
+
+  void SetUp() {
+    // Lay module1's symbol file out as SimpleSymbolSupplier expects.
+    string dir = temp_dir_.path() + "/module1.pdb";
+    mkdir(dir.c_str(), 0755);
+    dir += "/111111111111111111111111111111111";
+    mkdir(dir.c_str(), 0755);
+    string source = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                    "/src/processor/testdata/module1.out";
+    FILE* in = fopen(source.c_str(), "rb");
+    ASSERT_TRUE(in);
+    FILE* out = fopen((dir + "/module1.sym").c_str(), "wb");
+    ASSERT_TRUE(out);
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), in)) > 0)
+      ASSERT_EQ(count, fwrite(buffer, 1, count, out));
+    fclose(in);
+    fclose(out);
+
+    modules_.push_back(&module1_);
+    modules_.push_back(&missing_);
+  }
+
+  BatchSymbolizer::Address MakeAddress(size_t module, uint64_t offset) {
+    BatchSymbolizer::Address address = { module, offset };
+    return address;
+  }
+
+  AutoTempDir temp_dir_;
+  BasicCodeModule module1_;
+  BasicCodeModule missing_;
+  vector<const CodeModule*> modules_;
+};
+
+TEST_F(BatchSymbolizerTest, SymbolizesAddressesOfSeveralModules) {
+  CountingSymbolSupplier supplier(temp_dir_.path());
+  BasicSourceLineResolver resolver;
+  BatchSymbolizer symbolizer(&supplier, &resolver);
+
+  vector<BatchSymbolizer::Address> addresses;
+  addresses.push_back(MakeAddress(0, 0x1104));  // Function1_2, line 66
+  addresses.push_back(MakeAddress(1, 0x1000));  // no symbols
+  addresses.push_back(MakeAddress(0, 0x1004));  // Function1_1, line 45
+  addresses.push_back(MakeAddress(0, 0x2800));  // PublicSymbol
+  addresses.push_back(MakeAddress(0, 0x1104));  // a repeat
+  addresses.push_back(MakeAddress(5, 0x1000));  // no such module
+  addresses.push_back(MakeAddress(0, 0x0800));  // no function
+
+  vector<BatchSymbolizer::Result> results;
+  EXPECT_EQ(4U, symbolizer.Symbolize(modules_, addresses, &results));
+  ASSERT_EQ(addresses.size(), results.size());
+  const vector<string>& strings = symbolizer.strings();
+
+  ASSERT_NE(BatchSymbolizer::kNoString, results[0].function_name);
+  EXPECT_EQ("Function1_2", strings[results[0].function_name]);
+  EXPECT_EQ(4U, results[0].function_offset);
+  ASSERT_NE(BatchSymbolizer::kNoString, results[0].source_file);
+  EXPECT_EQ("file1_2.cc", strings[results[0].source_file]);
+  EXPECT_EQ(66, results[0].source_line);
+
+  EXPECT_EQ(BatchSymbolizer::kNoString, results[1].function_name);
+  EXPECT_EQ(BatchSymbolizer::kNoString, results[1].source_file);
+
+  ASSERT_NE(BatchSymbolizer::kNoString, results[2].function_name);
+  EXPECT_EQ("Function1_1", strings[results[2].function_name]);
+  EXPECT_EQ("file1_1.cc", strings[results[2].source_file]);
+  EXPECT_EQ(45, results[2].source_line);
+
+  ASSERT_NE(BatchSymbolizer::kNoString, results[3].function_name);
+  EXPECT_EQ("PublicSymbol", strings[results[3].function_name]);
+  EXPECT_EQ(BatchSymbolizer::kNoString, results[3].source_file);
+
+  EXPECT_EQ(results[0].function_name, results[4].function_name);
+  EXPECT_EQ(results[0].source_line, results[4].source_line);
+  EXPECT_EQ(BatchSymbolizer::kNoString, results[5].function_name);
+  EXPECT_EQ(BatchSymbolizer::kNoString, results[6].function_name);
+
+  // Each module was requested once, and neither is requested again.
+  EXPECT_EQ(2, supplier.requests());
+  EXPECT_EQ(4U, symbolizer.Symbolize(modules_, addresses, &results));
+  EXPECT_EQ(2, supplier.requests());
+}
+
+TEST_F(BatchSymbolizerTest, ClearsStrings) {
+  CountingSymbolSupplier supplier(temp_dir_.path());
+  BasicSourceLineResolver resolver;
+  BatchSymbolizer symbolizer(&supplier, &resolver);
+
+  vector<BatchSymbolizer::Address> addresses(1, MakeAddress(0, 0x1004));
+  vector<BatchSymbolizer::Result> results;
+  ASSERT_EQ(1U, symbolizer.Symbolize(modules_, addresses, &results));
+  EXPECT_EQ(2U, symbolizer.strings().size());
+
+  symbolizer.ClearStrings();
+  EXPECT_TRUE(symbolizer.strings().empty());
+  ASSERT_EQ(1U, symbolizer.Symbolize(modules_, addresses, &results));
+  EXPECT_EQ("Function1_1", symbolizer.strings()[results[0].function_name]);
+}
+
+TEST_F(BatchSymbolizerTest, HandlesEmptyBatch) {
+  BasicSourceLineResolver resolver;
+  BatchSymbolizer symbolizer(NULL, &resolver);
+  vector<BatchSymbolizer::Address> addresses;
+  vector<BatchSymbolizer::Result> results(3);
+  EXPECT_EQ(0U, symbolizer.Symbolize(modules_, addresses, &results));
+  EXPECT_TRUE(results.empty());
+}
+
+}  // namespace
@@ -0,0 +1,208 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// byte_swap.h: Bulk byte swapping of minidump structure arrays.
+//
+// Minidumps written on big-endian hosts have every field byte-swapped.
+// Rather than swapping each field of each record in turn, these routines
+// swap whole arrays of homogeneous records, such as the descriptors of a
+// memory list stream, in one pass.  Where SSE2 is available, each 16-byte
+// block of a record is swapped with a few vector operations.
+
+#ifndef PROCESSOR_BYTE_SWAP_H__
+#define PROCESSOR_BYTE_SWAP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "google_breakpad/common/minidump_format.h"
+
+namespace google_breakpad {
+
+namespace byte_swap_internal {
+
+inline uint32_t Reverse32(uint32_t value) {
+  return (value >> 24) |
+         ((value >> 8) & 0x0000ff00) |
+         ((value << 8) & 0x00ff0000) |
+         (value << 24);
+}
+
+inline uint64_t Reverse64(uint64_t value) {
+  return (static_cast<uint64_t>(Reverse32(static_cast<uint32_t>(value)))
+          << 32) |
+         Reverse32(static_cast<uint32_t>(value >> 32));
+}
+
+// Swap the 32- or 64-bit value at |data|, which need not be aligned.
+inline void Swap32At(uint8_t* data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  value = Reverse32(value);
+  memcpy(data, &value, sizeof(value));
+}
+
+inline void Swap64At(uint8_t* data) {
+  uint64_t value;
+  memcpy(&value, data, sizeof(value));
+  value = Reverse64(value);
+  memcpy(data, &value, sizeof(value));
+}
+
+#if defined(__SSE2__)
+// Once the two bytes of every 16-bit word in a block have been exchanged,
+// these orders of the four words in a 64-bit half finish reversing a single
+// 64-bit value, or two 32-bit values.
+const int kHalf64 = _MM_SHUFFLE(0, 1, 2, 3);
+const int kHalf32x2 = _MM_SHUFFLE(2, 3, 0, 1);
+
+// Swap the 16-byte block at |data|, whose low and high 8-byte halves hold
+// the values |kLowOrder| and |kHighOrder| describe.  |data| need not be
+// aligned.
+template <int kLowOrder, int kHighOrder>
+inline void SwapBlock(uint8_t* data) {
+  __m128i* block = reinterpret_cast<__m128i*>(data);
+  __m128i value = _mm_loadu_si128(block);
+  value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+  value = _mm_shufflelo_epi16(value, kLowOrder);
+  value = _mm_shufflehi_epi16(value, kHighOrder);
+  _mm_storeu_si128(block, value);
+}
+#endif  // __SSE2__
+
+}  // namespace byte_swap_internal
+
+// Swap each of the |count| 32-bit values at |values|, which need not be
+// aligned.
+inline void SwapUInt32Array(void* values, size_t count) {
+  using namespace byte_swap_internal;
+  uint8_t* data = static_cast<uint8_t*>(values);
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 4 <= count; i += 4)
+    SwapBlock<kHalf32x2, kHalf32x2>(data + i * 4);
+#endif
+  for (; i < count; ++i)
+    Swap32At(data + i * 4);
+}
+
+// Swap each of the |count| 64-bit values at |values|, which need not be
+// aligned.
+inline void SwapUInt64Array(void* values, size_t count) {
+  using namespace byte_swap_internal;
+  uint8_t* data = static_cast<uint8_t*>(values);
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 2 <= count; i += 2)
+    SwapBlock<kHalf64, kHalf64>(data + i * 8);
+#endif
+  for (; i < count; ++i)
+    Swap64At(data + i * 8);
+}
+
+// Swap every field of the |count| memory descriptors at |descriptors|.
+inline void SwapMemoryDescriptorArray(MDMemoryDescriptor* descriptors,
+                                      size_t count) {
+  static_assert(sizeof(MDMemoryDescriptor) == 16,
+                "MDMemoryDescriptor must be one 16-byte block");
+#if defined(__SSE2__)
+  using namespace byte_swap_internal;
+  uint8_t* data = reinterpret_cast<uint8_t*>(descriptors);
+  for (size_t i = 0; i < count; ++i) {
+    // start_of_memory_range; memory.data_size and memory.rva.
+    SwapBlock<kHalf64, kHalf32x2>(data + i * 16);
+  }
+#else
+  for (size_t i = 0; i < count; ++i) {
+    MDMemoryDescriptor* descriptor = &descriptors[i];
+    descriptor->start_of_memory_range =
+        byte_swap_internal::Reverse64(descriptor->start_of_memory_range);
+    descriptor->memory.data_size =
+        byte_swap_internal::Reverse32(descriptor->memory.data_size);
+    descriptor->memory.rva =
+        byte_swap_internal::Reverse32(descriptor->memory.rva);
+  }
+#endif
+}
+
+// Swap every field, including the alignment padding, of the |count|
+// memory info records at |infos|.
+inline void SwapMemoryInfoArray(MDRawMemoryInfo* infos, size_t count) {
+  static_assert(sizeof(MDRawMemoryInfo) == 48,
+                "MDRawMemoryInfo must be three 16-byte blocks");
+  using namespace byte_swap_internal;
+  uint8_t* data = reinterpret_cast<uint8_t*>(infos);
+  for (size_t i = 0; i < count; ++i) {
+    uint8_t* info = data + i * sizeof(MDRawMemoryInfo);
+#if defined(__SSE2__)
+    // base_address, allocation_base;
+    // allocation_protection, __alignment1, region_size;
+    // state, protection, type, __alignment2.
+    SwapBlock<kHalf64, kHalf64>(info);
+    SwapBlock<kHalf32x2, kHalf64>(info + 16);
+    SwapBlock<kHalf32x2, kHalf32x2>(info + 32);
+#else
+    Swap64At(info);
+    Swap64At(info + 8);
+    Swap32At(info + 16);
+    Swap32At(info + 20);
+    Swap64At(info + 24);
+    for (int j = 0; j < 4; ++j)
+      Swap32At(info + 32 + j * 4);
+#endif
+  }
+}
+
+// Swap the |count| module records, MD_MODULE_SIZE bytes apart, at
+// |records|.  As MinidumpModule has always done, the reserved fields are
+// left alone, because their contents and widths are unknown.
+inline void SwapModuleRecordArray(void* records, size_t count) {
+  // base_of_image is followed by 21 32-bit fields, from size_of_image
+  // through misc_record, and then by the reserved fields.
+  const size_t kUInt32FieldsOffset = 8;
+  const size_t kUInt32FieldCount = 21;
+  static_assert(kUInt32FieldsOffset + kUInt32FieldCount * 4 ==
+                    offsetof(MDRawModule, reserved0),
+                "MDRawModule's 32-bit fields must precede reserved0");
+  uint8_t* data = static_cast<uint8_t*>(records);
+  for (size_t i = 0; i < count; ++i) {
+    uint8_t* record = data + i * MD_MODULE_SIZE;
+    byte_swap_internal::Swap64At(record);
+    SwapUInt32Array(record + kUInt32FieldsOffset, kUInt32FieldCount);
+  }
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_BYTE_SWAP_H__
@@ -0,0 +1,177 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// byte_swap_unittest.cc: Unit tests for the bulk minidump swapping
+// routines, checking them against swapping one field at a time.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "processor/byte_swap.h"
+
+namespace {
+
+using google_breakpad::SwapMemoryDescriptorArray;
+using google_breakpad::SwapMemoryInfoArray;
+using google_breakpad::SwapModuleRecordArray;
+using google_breakpad::SwapUInt32Array;
+using google_breakpad::SwapUInt64Array;
+using std::vector;
+
+// Fill |size| bytes at |data| with distinct-looking values.
+void Fill(void* data, size_t size) {
+  uint8_t* bytes = static_cast<uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i)
+    bytes[i] = static_cast<uint8_t>(i * 37 + 11);
+}
+
+// Reverse the |size| bytes at |data|.
+void Reverse(uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size / 2; ++i) {
+    uint8_t byte = data[i];
+    data[i] = data[size - 1 - i];
+    data[size - 1 - i] = byte;
+  }
+}
+
+TEST(ByteSwap, UInt32Array) {
+  // Cover the vector loop, the tail, and unaligned starts.
+  for (size_t offset = 0; offset < 4; ++offset) {
+    for (size_t count = 0; count < 19; ++count) {
+      vector<uint8_t> actual(offset + count * 4);
+      Fill(&actual[0], actual.size());
+      vector<uint8_t> expected(actual);
+      for (size_t i = 0; i < count; ++i)
+        Reverse(&expected[offset + i * 4], 4);
+      SwapUInt32Array(&actual[offset], count);
+      EXPECT_EQ(expected, actual) << "offset " << offset << " count " << count;
+    }
+  }
+}
+
+TEST(ByteSwap, UInt64Array) {
+  for (size_t offset = 0; offset < 8; offset += 3) {
+    for (size_t count = 0; count < 11; ++count) {
+      vector<uint8_t> actual(offset + count * 8);
+      Fill(&actual[0], actual.size());
+      vector<uint8_t> expected(actual);
+      for (size_t i = 0; i < count; ++i)
+        Reverse(&expected[offset + i * 8], 8);
+      SwapUInt64Array(&actual[offset], count);
+      EXPECT_EQ(expected, actual) << "offset " << offset << " count " << count;
+    }
+  }
+}
+
+TEST(ByteSwap, MemoryDescriptorArray) {
+  MDMemoryDescriptor descriptors[3];
+  Fill(descriptors, sizeof(descriptors));
+  uint8_t expected[sizeof(descriptors)];
+  memcpy(expected, descriptors, sizeof(descriptors));
+  for (int i = 0; i < 3; ++i) {
+    Reverse(&expected[i * 16], 8);
+    Reverse(&expected[i * 16 + 8], 4);
+    Reverse(&expected[i * 16 + 12], 4);
+  }
+  SwapMemoryDescriptorArray(descriptors, 3);
+  EXPECT_EQ(0, memcmp(expected, descriptors, sizeof(descriptors)));
+}
+
+TEST(ByteSwap, MemoryInfoArray) {
+  MDRawMemoryInfo infos[2];
+  Fill(infos, sizeof(infos));
+  uint8_t expected[sizeof(infos)];
+  memcpy(expected, infos, sizeof(infos));
+  for (int i = 0; i < 2; ++i) {
+    uint8_t* info = &expected[i * sizeof(MDRawMemoryInfo)];
+    Reverse(info, 8);        // base_address
+    Reverse(info + 8, 8);    // allocation_base
+    Reverse(info + 16, 4);   // allocation_protection
+    Reverse(info + 20, 4);   // __alignment1
+    Reverse(info + 24, 8);   // region_size
+    Reverse(info + 32, 4);   // state
+    Reverse(info + 36, 4);   // protection
+    Reverse(info + 40, 4);   // type
+    Reverse(info + 44, 4);   // __alignment2
+  }
+  SwapMemoryInfoArray(infos, 2);
+  EXPECT_EQ(0, memcmp(expected, infos, sizeof(infos)));
+
+  // Swapping twice restores the original.
+  SwapMemoryInfoArray(infos, 2);
+  Fill(expected, sizeof(expected));
+  EXPECT_EQ(0, memcmp(expected, infos, sizeof(infos)));
+}
+
+TEST(ByteSwap, ModuleRecordArray) {
+  const size_t kCount = 3;
+  vector<uint8_t> actual(kCount * MD_MODULE_SIZE);
+  Fill(&actual[0], actual.size());
+  vector<uint8_t> expected(actual);
+  for (size_t i = 0; i < kCount; ++i) {
+    uint8_t* record = &expected[i * MD_MODULE_SIZE];
+    Reverse(record, 8);
+    for (size_t field = 0; field < 21; ++field)
+      Reverse(record + 8 + field * 4, 4);
+    // The reserved fields, from offset 92, are left alone.
+  }
+  SwapModuleRecordArray(&actual[0], kCount);
+  EXPECT_EQ(expected, actual);
+
+  // The fields land where the structure expects them.
+  MDRawModule module;
+  uint8_t raw[MD_MODULE_SIZE];
+  memset(raw, 0, sizeof(raw));
+  const uint8_t kBigEndianBase[8] = { 0x01, 0x02, 0x03, 0x04,
+                                      0x05, 0x06, 0x07, 0x08 };
+  const uint8_t kBigEndianRva[4] = { 0xca, 0xfe, 0xf0, 0x0d };
+  memcpy(raw, kBigEndianBase, sizeof(kBigEndianBase));
+  memcpy(raw + offsetof(MDRawModule, cv_record) +
+             offsetof(MDLocationDescriptor, rva),
+         kBigEndianRva, sizeof(kBigEndianRva));
+  SwapModuleRecordArray(raw, 1);
+  memcpy(&module, raw, MD_MODULE_SIZE);
+  uint8_t native_base[8];
+  uint64_t expected_base = 0x0102030405060708ULL;
+  memcpy(native_base, &expected_base, sizeof(native_base));
+  if (native_base[0] == 0x08) {
+    // These values are only meaningful on little-endian hosts.
+    EXPECT_EQ(0x0102030405060708ULL, module.base_of_image);
+    EXPECT_EQ(0xcafef00dU, module.cv_record.rva);
+  }
+}
+
+}  // namespace
@@ -37,12 +37,27 @@
 #endif
 
 #include "google_breakpad/processor/call_stack.h"
+
+#include <deque>
+#include <memory>
+
+#include "google_breakpad/processor/source_line_resolver_interface.h"
 #include "google_breakpad/processor/stack_frame.h"
+#include "processor/arena.h"
 
 namespace google_breakpad {
 
+namespace {
+
+// The size of the blocks frames are carved from, which holds a few frames
+// with the largest CPU contexts.
+const size_t kFramePoolBlockSize = 16 * 1024;
+
+}  // namespace
+
 CallStack::~CallStack() {
   Clear();
+  delete frame_pool_;
 }
 
 void CallStack::Clear() {
@@ -51,7 +66,40 @@ void CallStack::Clear() {
        ++iterator) {
     delete *iterator;
   }
+  frames_.clear();
+  // The frames were destroyed above, so their memory can go.
+  if (frame_pool_)
+    frame_pool_->Clear();
   tid_ = 0;
+  duplicate_of_ = -1;
+  budget_exhausted_ = false;
+}
+
+bool CallStack::ExpandInlineFrames(SourceLineResolverInterface* resolver) {
+  bool expanded = true;
+  vector<StackFrame*> frames;
+  frames.reserve(frames_.size());
+  for (StackFrame* frame : frames_) {
+    if (!frame->inline_records.empty()) {
+      std::deque<std::unique_ptr<StackFrame>> inlined_frames;
+      if (resolver->ExpandInlineFrames(*frame, &inlined_frames)) {
+        for (std::unique_ptr<StackFrame>& inlined_frame : inlined_frames)
+          frames.push_back(inlined_frame.release());
+      } else {
+        expanded = false;
+      }
+      frame->inline_records.clear();
+    }
+    frames.push_back(frame);
+  }
+  frames_.swap(frames);
+  return expanded;
+}
+
+void* CallStack::AllocateFrame(size_t size) {
+  if (!frame_pool_)
+    frame_pool_ = new Arena(kFramePoolBlockSize);
+  return frame_pool_->Allocate(size, alignof(max_align_t));
 }
 
 }  // namespace google_breakpad
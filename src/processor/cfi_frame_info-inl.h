@@ -47,46 +47,55 @@ bool SimpleCFIWalker<RegisterType, RawContextType>::FindCallerRegisters(
     int callee_validity,
     RawContextType* caller_context,
     int* caller_validity) const {
-  typedef CFIFrameInfo::RegisterValueMap<RegisterType> ValueMap;
-  ValueMap callee_registers;
-  ValueMap caller_registers;
-  // Just for brevity.
-  typename ValueMap::const_iterator caller_none = caller_registers.end();
-
-  // Populate callee_registers with register values from callee_context.
+  // Gather the callee's registers into a register file, indexed like
+  // register_map_.
+  const char* names[CFIFrameInfo::kMaxRegisters];
+  RegisterType callee_registers[CFIFrameInfo::kMaxRegisters];
+  RegisterType caller_registers[CFIFrameInfo::kMaxRegisters];
+  uint64_t callee_known = 0;
+  uint64_t caller_known;
+  RegisterType cfa, ra;
+  if (map_size_ > CFIFrameInfo::kMaxRegisters)
+    return false;
   for (size_t i = 0; i < map_size_; i++) {
     const RegisterSet& r = register_map_[i];
-    if (callee_validity & r.validity_flag)
-      callee_registers[r.name] = callee_context.*r.context_member;
+    names[i] = r.name;
+    if (callee_validity & r.validity_flag) {
+      callee_registers[i] = callee_context.*r.context_member;
+      callee_known |= uint64_t(1) << i;
+    }
   }
 
   // Apply the rules, and see what register values they yield.
-  if (!cfi_frame_info.FindCallerRegs<RegisterType>(callee_registers, memory,
-                                                   &caller_registers))
+  if (!cfi_frame_info.FindCallerRegs<RegisterType>(
+          names, map_size_, callee_registers, callee_known, memory,
+          caller_registers, &caller_known, &cfa, &ra))
     return false;
 
-  // Populate *caller_context with the values the rules placed in
-  // caller_registers.
+  // Populate *caller_context with the values the rules recovered.
   memset(caller_context, 0xda, sizeof(*caller_context));
   *caller_validity = 0;
   for (size_t i = 0; i < map_size_; i++) {
     const RegisterSet& r = register_map_[i];
-    typename ValueMap::const_iterator caller_entry;
 
     // Did the rules provide a value for this register by its name?
-    caller_entry = caller_registers.find(r.name);
-    if (caller_entry != caller_none) {
-      caller_context->*r.context_member = caller_entry->second;
+    if (caller_known & (uint64_t(1) << i)) {
+      caller_context->*r.context_member = caller_registers[i];
       *caller_validity |= r.validity_flag;
       continue;
     }
 
     // Did the rules provide a value for this register under its
-    // alternate name?
+    // alternate name? The only alternate names the rules yield are the
+    // call frame address and the return address.
     if (r.alternate_name) {
-      caller_entry = caller_registers.find(r.alternate_name);
-      if (caller_entry != caller_none) {
-        caller_context->*r.context_member = caller_entry->second;
+      if (strcmp(r.alternate_name, ".cfa") == 0) {
+        caller_context->*r.context_member = cfa;
+        *caller_validity |= r.validity_flag;
+        continue;
+      }
+      if (strcmp(r.alternate_name, ".ra") == 0) {
+        caller_context->*r.context_member = ra;
         *caller_validity |= r.validity_flag;
         continue;
       }
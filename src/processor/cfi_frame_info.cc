@@ -39,9 +39,12 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <sstream>
 
 #include "common/scoped_ptr.h"
+#include "google_breakpad/processor/memory_region.h"
+#include "processor/logging.h"
 #include "processor/postfix_evaluator-inl.h"
 
 namespace google_breakpad {
@@ -50,15 +53,457 @@ namespace google_breakpad {
 #define strtok_r strtok_s
 #endif
 
+namespace {
+
+// Parses |token| as PostfixEvaluator<V> would parse a literal.
+template<typename V>
+bool ParseLiteral(const string& token, V* value) {
+  std::istringstream token_stream(token);
+  V literal = V();
+  bool negative = token_stream.peek() == '-';
+  if (negative)
+    token_stream.get();
+  if (!(token_stream >> literal) || token_stream.peek() != EOF)
+    return false;
+  *value = negative ? -literal : literal;
+  return true;
+}
+
+}  // namespace
+
+void CFIFrameInfo::SetCFARule(const string& expression) {
+  RuleSet* rules = MutableRules();
+  SetRule(expression, rules, &rules->cfa_rule);
+}
+
+void CFIFrameInfo::SetRARule(const string& expression) {
+  RuleSet* rules = MutableRules();
+  SetRule(expression, rules, &rules->ra_rule);
+}
+
+void CFIFrameInfo::SetRegisterRule(const string& register_name,
+                                   const string& expression) {
+  RuleSet* rules = MutableRules();
+  SetRule(expression, rules, &rules->register_rules[register_name]);
+}
+
+CFIFrameInfo::RuleSet* CFIFrameInfo::MutableRules() {
+  if (!rules_)
+    rules_ = std::make_shared<RuleSet>();
+  else if (rules_.use_count() > 1)
+    rules_ = std::make_shared<RuleSet>(*rules_);
+  return rules_.get();
+}
+
+// static
+void CFIFrameInfo::SetRule(const string& expression, RuleSet* rules,
+                           Rule* rule) {
+  rule->expression = expression;
+  rule->code.clear();
+  rule->compiled = false;
+  rule->assigns = false;
+
+  // Split the expression the way PostfixEvaluator does, including its
+  // handling of assignments smashed up against the next token, as in
+  // "$T0 $ebp 128 + =$eip $T0 4 + ^ =$ebp $T0 ^ =".
+  vector<string> tokens;
+  std::istringstream stream(expression);
+  string token;
+  while (stream >> token) {
+    if (token.size() > 1 && token[0] == '=') {
+      tokens.push_back("=");
+      token.erase(0, 1);
+    }
+    tokens.push_back(token);
+  }
+
+  vector<Instruction> code;
+  code.reserve(tokens.size());
+  // The stack depth, as long as no instruction has failed for lack of
+  // operands, since evaluation stops at the first that does.
+  size_t depth = 0;
+  size_t max_depth = 0;
+  bool underflow = false;
+  for (const string& token : tokens) {
+    Instruction instruction = {Instruction::PUSH, 0, 0, 0, 0};
+    size_t operands = 0;
+    size_t results = 1;
+    if (token == "+") {
+      instruction.opcode = Instruction::ADD;
+      operands = 2;
+    } else if (token == "-") {
+      instruction.opcode = Instruction::SUBTRACT;
+      operands = 2;
+    } else if (token == "*") {
+      instruction.opcode = Instruction::MULTIPLY;
+      operands = 2;
+    } else if (token == "/") {
+      instruction.opcode = Instruction::DIVIDE_QUOTIENT;
+      operands = 2;
+    } else if (token == "%") {
+      instruction.opcode = Instruction::DIVIDE_MODULUS;
+      operands = 2;
+    } else if (token == "@") {
+      instruction.opcode = Instruction::ALIGN;
+      operands = 2;
+    } else if (token == "^") {
+      instruction.opcode = Instruction::DEREFERENCE;
+      operands = 1;
+    } else if (token == "=") {
+      instruction.opcode = Instruction::ASSIGN;
+      operands = 2;
+      results = 0;
+      rule->assigns = true;
+    } else {
+      // A literal, or an identifier looked up when it is popped.  Whether
+      // a token is a literal depends on the width it is evaluated at.
+      if (ParseLiteral(token, &instruction.literal_32))
+        instruction.literal_flags |= Instruction::LITERAL_32;
+      if (ParseLiteral(token, &instruction.literal_64))
+        instruction.literal_flags |= Instruction::LITERAL_64;
+      if (instruction.literal_flags !=
+          (Instruction::LITERAL_32 | Instruction::LITERAL_64)) {
+        vector<string>::const_iterator name =
+            std::find(rules->names.begin(), rules->names.end(), token);
+        if (name == rules->names.end()) {
+          if (rules->names.size() == kMaxNames)
+            return;
+          if (token == ".cfa")
+            rules->cfa_name = static_cast<int>(rules->names.size());
+          name = rules->names.insert(rules->names.end(), token);
+        }
+        instruction.name =
+            static_cast<uint16_t>(name - rules->names.begin());
+      }
+    }
+    code.push_back(instruction);
+
+    if (underflow)
+      continue;
+    if (depth < operands) {
+      underflow = true;
+      continue;
+    }
+    depth = depth - operands + results;
+    max_depth = std::max(max_depth, depth);
+  }
+  if (max_depth > kMaxStackDepth)
+    return;
+
+  rule->code.swap(code);
+  rule->compiled = true;
+}
+
+template<typename V>
+bool CFIFrameInfo::EvaluateRule(const Rule& rule, const MemoryRegion& memory,
+                                V* values, bool* known, V* result) const {
+  // Like PostfixEvaluator, keep identifiers on the stack until they are
+  // popped, so that assignments can find them.
+  struct Entry {
+    V value;
+    // The index of the identifier in rules_->names, or -1 for a value.
+    int name;
+  };
+  Entry stack[kMaxStackDepth];
+  size_t depth = 0;
+  const vector<string>& names = rules_->names;
+
+  auto pop_value = [&](V* value) {
+    if (depth == 0)
+      return false;
+    const Entry& entry = stack[--depth];
+    if (entry.name < 0) {
+      *value = entry.value;
+      return true;
+    }
+    if (!known[entry.name]) {
+      BPLOG(INFO) << "Identifier " << names[entry.name] << " not in dictionary";
+      return false;
+    }
+    *value = values[entry.name];
+    return true;
+  };
+
+  const bool wide = sizeof(V) > sizeof(uint32_t);
+  for (const Instruction& instruction : rule.code) {
+    switch (instruction.opcode) {
+      case Instruction::PUSH: {
+        if (depth == kMaxStackDepth)
+          return false;
+        Entry& entry = stack[depth++];
+        if (instruction.literal_flags &
+            (wide ? Instruction::LITERAL_64 : Instruction::LITERAL_32)) {
+          entry.value = static_cast<V>(wide ? instruction.literal_64
+                                            : instruction.literal_32);
+          entry.name = -1;
+        } else {
+          entry.name = instruction.name;
+        }
+        break;
+      }
+
+      case Instruction::DEREFERENCE: {
+        V address;
+        if (!pop_value(&address)) {
+          BPLOG(ERROR) << "Could not PopValue to get value to derefence: "
+                       << rule.expression;
+          return false;
+        }
+        V value;
+        if (!memory.GetMemoryAtAddress(address, &value)) {
+          BPLOG(ERROR) << "Could not dereference memory at address "
+                       << HexString(address) << ": " << rule.expression;
+          return false;
+        }
+        stack[depth].value = value;
+        stack[depth++].name = -1;
+        break;
+      }
+
+      case Instruction::ASSIGN: {
+        V value;
+        if (!pop_value(&value)) {
+          BPLOG(INFO) << "Could not PopValue to get value to assign: "
+                      << rule.expression;
+          return false;
+        }
+        if (depth == 0 || stack[depth - 1].name < 0) {
+          BPLOG(ERROR) << "An identifier is needed to assign "
+                       << HexString(value) << ": " << rule.expression;
+          return false;
+        }
+        int name = stack[--depth].name;
+        if (names[name][0] != '$') {
+          BPLOG(ERROR) << "Can't assign " << HexString(value) << " to "
+                       << names[name] << ": " << rule.expression;
+          return false;
+        }
+        values[name] = value;
+        known[name] = true;
+        break;
+      }
+
+      default: {
+        V operand1, operand2;
+        if (!pop_value(&operand2) || !pop_value(&operand1)) {
+          BPLOG(ERROR) << "Could not PopValues to get two values for binary "
+                          "operation: " << rule.expression;
+          return false;
+        }
+        V value = V();
+        switch (instruction.opcode) {
+          case Instruction::ADD:
+            value = operand1 + operand2;
+            break;
+          case Instruction::SUBTRACT:
+            value = operand1 - operand2;
+            break;
+          case Instruction::MULTIPLY:
+            value = operand1 * operand2;
+            break;
+          case Instruction::DIVIDE_QUOTIENT:
+          case Instruction::DIVIDE_MODULUS:
+            if (operand2 == 0) {
+              BPLOG(ERROR) << "Division by zero: " << rule.expression;
+              return false;
+            }
+            value = instruction.opcode == Instruction::DIVIDE_QUOTIENT
+                        ? operand1 / operand2
+                        : operand1 % operand2;
+            break;
+          case Instruction::ALIGN:
+            value = operand1 & (static_cast<V>(-1) ^ (operand2 - 1));
+            break;
+        }
+        stack[depth].value = value;
+        stack[depth++].name = -1;
+        break;
+      }
+    }
+  }
+
+  // A successful execution should leave exactly one value on the stack.
+  if (depth != 1) {
+    BPLOG(ERROR) << "Expression yielded bad number of results: "
+                 << "'" << rule.expression << "'";
+    return false;
+  }
+  return pop_value(result);
+}
+
+bool CFIFrameInfo::HasRules(bool* compiled) const {
+  // If there are not rules for both .ra and .cfa in effect at this address,
+  // don't use this CFI data for stack walking.
+  if (!rules_ || rules_->cfa_rule.expression.empty() ||
+      rules_->ra_rule.expression.empty())
+    return false;
+
+  const RuleSet& rules = *rules_;
+  *compiled = rules.cfa_rule.compiled && rules.ra_rule.compiled;
+  for (RuleMap::const_iterator it = rules.register_rules.begin();
+       *compiled && it != rules.register_rules.end(); it++) {
+    *compiled = it->second.compiled;
+  }
+  return true;
+}
+
+template<typename V, typename Lookup, typename Store>
+bool CFIFrameInfo::FindCallerRegsCompiled(const MemoryRegion& memory,
+                                          Lookup lookup, Store store,
+                                          V* cfa, V* ra) const {
+  const RuleSet& rules = *rules_;
+
+  // Look up the registers the rules refer to once, into a register file
+  // indexed like rules.names.
+  const size_t name_count = rules.names.size();
+  V values[kMaxNames];
+  bool known[kMaxNames];
+  for (size_t i = 0; i < name_count; i++) {
+    known[i] = lookup(rules.names[i], &values[i]);
+    if (!known[i])
+      values[i] = V();
+  }
+
+  // Rules that assign variables get a copy of the register file, so that
+  // each rule starts from the current frame's values.
+  auto evaluate = [&](const Rule& rule, V* result) {
+    if (!rule.assigns)
+      return EvaluateRule(rule, memory, values, known, result);
+    V working_values[kMaxNames];
+    bool working_known[kMaxNames];
+    std::copy(values, values + name_count, working_values);
+    std::copy(known, known + name_count, working_known);
+    return EvaluateRule(rule, memory, working_values, working_known, result);
+  };
+
+  // First, compute the CFA.
+  if (!evaluate(rules.cfa_rule, cfa))
+    return false;
+  if (rules.cfa_name >= 0) {
+    values[rules.cfa_name] = *cfa;
+    known[rules.cfa_name] = true;
+  }
+
+  // Then, compute the return address.
+  if (!evaluate(rules.ra_rule, ra))
+    return false;
+
+  // Now, compute values for all the registers register_rules mentions.
+  for (RuleMap::const_iterator it = rules.register_rules.begin();
+       it != rules.register_rules.end(); it++) {
+    V value;
+    if (!evaluate(it->second, &value))
+      continue;
+    store(it->first, value);
+  }
+  return true;
+}
+
 template<typename V>
 bool CFIFrameInfo::FindCallerRegs(const RegisterValueMap<V>& registers,
                                   const MemoryRegion& memory,
                                   RegisterValueMap<V>* caller_registers) const {
-  // If there are not rules for both .ra and .cfa in effect at this address,
-  // don't use this CFI data for stack walking.
-  if (cfa_rule_.empty() || ra_rule_.empty())
+  bool compiled;
+  if (!HasRules(&compiled))
     return false;
+  if (!compiled)
+    return FindCallerRegsFromText(registers, memory, caller_registers);
 
+  caller_registers->clear();
+  V cfa, ra;
+  bool found = FindCallerRegsCompiled(
+      memory,
+      [&registers](const string& name, V* value) {
+        typename RegisterValueMap<V>::const_iterator it = registers.find(name);
+        if (it == registers.end())
+          return false;
+        *value = it->second;
+        return true;
+      },
+      [caller_registers](const string& name, V value) {
+        (*caller_registers)[name] = value;
+      },
+      &cfa, &ra);
+  if (!found)
+    return false;
+
+  (*caller_registers)[".ra"] = ra;
+  (*caller_registers)[".cfa"] = cfa;
+
+  return true;
+}
+
+template<typename V>
+bool CFIFrameInfo::FindCallerRegs(const char* const* register_names,
+                                  size_t register_count,
+                                  const V* registers,
+                                  uint64_t known,
+                                  const MemoryRegion& memory,
+                                  V* caller_registers,
+                                  uint64_t* caller_known,
+                                  V* cfa,
+                                  V* ra) const {
+  bool compiled;
+  if (register_count > kMaxRegisters || !HasRules(&compiled))
+    return false;
+
+  // Returns the index of the register named |name|, or -1.
+  auto find = [register_names, register_count](const string& name) {
+    for (size_t i = 0; i < register_count; i++) {
+      if (name == register_names[i])
+        return static_cast<int>(i);
+    }
+    return -1;
+  };
+
+  *caller_known = 0;
+  if (!compiled) {
+    RegisterValueMap<V> callee_map;
+    for (size_t i = 0; i < register_count; i++) {
+      if (known & (uint64_t(1) << i))
+        callee_map[register_names[i]] = registers[i];
+    }
+    RegisterValueMap<V> caller_map;
+    if (!FindCallerRegsFromText(callee_map, memory, &caller_map))
+      return false;
+    for (typename RegisterValueMap<V>::const_iterator it = caller_map.begin();
+         it != caller_map.end(); it++) {
+      int index = find(it->first);
+      if (index >= 0) {
+        caller_registers[index] = it->second;
+        *caller_known |= uint64_t(1) << index;
+      }
+    }
+    *cfa = caller_map[".cfa"];
+    *ra = caller_map[".ra"];
+    return true;
+  }
+
+  return FindCallerRegsCompiled(
+      memory,
+      [&](const string& name, V* value) {
+        int index = find(name);
+        if (index < 0 || !(known & (uint64_t(1) << index)))
+          return false;
+        *value = registers[index];
+        return true;
+      },
+      [&](const string& name, V value) {
+        int index = find(name);
+        if (index >= 0) {
+          caller_registers[index] = value;
+          *caller_known |= uint64_t(1) << index;
+        }
+      },
+      cfa, ra);
+}
+
+template<typename V>
+bool CFIFrameInfo::FindCallerRegsFromText(
+    const RegisterValueMap<V>& registers,
+    const MemoryRegion& memory,
+    RegisterValueMap<V>* caller_registers) const {
+  const RuleSet& rules = *rules_;
   RegisterValueMap<V> working;
   PostfixEvaluator<V> evaluator(&working, &memory);
 
@@ -67,23 +512,23 @@ bool CFIFrameInfo::FindCallerRegs(const RegisterValueMap<V>& registers,
   // First, compute the CFA.
   V cfa;
   working = registers;
-  if (!evaluator.EvaluateForValue(cfa_rule_, &cfa))
+  if (!evaluator.EvaluateForValue(rules.cfa_rule.expression, &cfa))
     return false;
 
   // Then, compute the return address.
   V ra;
   working = registers;
   working[".cfa"] = cfa;
-  if (!evaluator.EvaluateForValue(ra_rule_, &ra))
+  if (!evaluator.EvaluateForValue(rules.ra_rule.expression, &ra))
     return false;
 
-  // Now, compute values for all the registers register_rules_ mentions.
-  for (RuleMap::const_iterator it = register_rules_.begin();
-       it != register_rules_.end(); it++) {
+  // Now, compute values for all the registers register_rules mentions.
+  for (RuleMap::const_iterator it = rules.register_rules.begin();
+       it != rules.register_rules.end(); it++) {
     V value;
     working = registers;
     working[".cfa"] = cfa;
-    if (!evaluator.EvaluateForValue(it->second, &value))
+    if (!evaluator.EvaluateForValue(it->second.expression, &value))
       continue;
     (*caller_registers)[it->first] = value;
   }
@@ -103,24 +548,36 @@ template bool CFIFrameInfo::FindCallerRegs<uint64_t>(
     const RegisterValueMap<uint64_t>& registers,
     const MemoryRegion& memory,
     RegisterValueMap<uint64_t>* caller_registers) const;
+template bool CFIFrameInfo::FindCallerRegs<uint32_t>(
+    const char* const* register_names, size_t register_count,
+    const uint32_t* registers, uint64_t known, const MemoryRegion& memory,
+    uint32_t* caller_registers, uint64_t* caller_known, uint32_t* cfa,
+    uint32_t* ra) const;
+template bool CFIFrameInfo::FindCallerRegs<uint64_t>(
+    const char* const* register_names, size_t register_count,
+    const uint64_t* registers, uint64_t known, const MemoryRegion& memory,
+    uint64_t* caller_registers, uint64_t* caller_known, uint64_t* cfa,
+    uint64_t* ra) const;
 
 string CFIFrameInfo::Serialize() const {
   std::ostringstream stream;
+  if (!rules_)
+    return stream.str();
 
-  if (!cfa_rule_.empty()) {
-    stream << ".cfa: " << cfa_rule_;
+  if (!rules_->cfa_rule.expression.empty()) {
+    stream << ".cfa: " << rules_->cfa_rule.expression;
   }
-  if (!ra_rule_.empty()) {
+  if (!rules_->ra_rule.expression.empty()) {
     if (static_cast<std::streamoff>(stream.tellp()) != 0)
       stream << " ";
-    stream << ".ra: " << ra_rule_;
+    stream << ".ra: " << rules_->ra_rule.expression;
   }
-  for (RuleMap::const_iterator iter = register_rules_.begin();
-       iter != register_rules_.end();
+  for (RuleMap::const_iterator iter = rules_->register_rules.begin();
+       iter != rules_->register_rules.end();
        ++iter) {
     if (static_cast<std::streamoff>(stream.tellp()) != 0)
       stream << " ";
-    stream << iter->first << ": " << iter->second;
+    stream << iter->first << ": " << iter->second.expression;
   }
 
   return stream.str();
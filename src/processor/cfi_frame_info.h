@@ -37,8 +37,12 @@
 #ifndef PROCESSOR_CFI_FRAME_INFO_H_
 #define PROCESSOR_CFI_FRAME_INFO_H_
 
+#include <stdint.h>
+
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
@@ -46,6 +50,7 @@
 namespace google_breakpad {
 
 using std::map;
+using std::vector;
 
 class MemoryRegion;
 
@@ -71,11 +76,13 @@ class CFIFrameInfo {
   // Set the expression for computing a call frame address, return
   // address, or register's value. At least the CFA rule and the RA
   // rule must be set before calling FindCallerRegs.
-  void SetCFARule(const string& expression) { cfa_rule_ = expression; }
-  void SetRARule(const string& expression)  { ra_rule_ = expression; }
-  void SetRegisterRule(const string& register_name, const string& expression) {
-    register_rules_[register_name] = expression;
-  }
+  //
+  // Each expression is compiled into a short program over numbered
+  // registers as it is set, so FindCallerRegs doesn't need to tokenize
+  // it or look registers up by name.
+  void SetCFARule(const string& expression);
+  void SetRARule(const string& expression);
+  void SetRegisterRule(const string& register_name, const string& expression);
 
   // Compute the values of the calling frame's registers, according to
   // this rule set. Use ValueType in expression evaluation; this
@@ -99,38 +106,148 @@ class CFIFrameInfo {
                       const MemoryRegion& memory,
                       RegisterValueMap<ValueType>* caller_registers) const;
 
+  // The most registers the register file form of FindCallerRegs takes.
+  static const size_t kMaxRegisters = 64;
+
+  // Like FindCallerRegs above, but over register files instead of
+  // dictionaries, so that walkers need not build or search maps of
+  // strings.  REGISTER_NAMES holds the names, as rules refer to them, of
+  // REGISTER_COUNT registers, at most kMaxRegisters; REGISTERS holds their
+  // values in the current frame, those known having their bit set in
+  // KNOWN.  CALLER_REGISTERS and CALLER_KNOWN are filled in likewise with
+  // the registers the rules recover, and CFA and RA are set to the call
+  // frame address and the return address.
+  template<typename ValueType>
+  bool FindCallerRegs(const char* const* register_names,
+                      size_t register_count,
+                      const ValueType* registers,
+                      uint64_t known,
+                      const MemoryRegion& memory,
+                      ValueType* caller_registers,
+                      uint64_t* caller_known,
+                      ValueType* cfa,
+                      ValueType* ra) const;
+
   // Serialize the rules in this object into a string in the format
   // of STACK CFI records.
   string Serialize() const;
 
  private:
+  // The most registers and variables compiled rules may refer to, and the
+  // deepest stack they may use.  Rules beyond these limits are evaluated
+  // from their text by PostfixEvaluator.
+  static const size_t kMaxNames = 64;
+  static const size_t kMaxStackDepth = 16;
+
+  // An operation of a compiled rule.  The operators are those of
+  // google_breakpad::PostfixEvaluator.
+  struct Instruction {
+    enum Opcode {
+      PUSH,
+      ADD,
+      SUBTRACT,
+      MULTIPLY,
+      DIVIDE_QUOTIENT,
+      DIVIDE_MODULUS,
+      ALIGN,
+      DEREFERENCE,
+      ASSIGN
+    };
+    // Set on PUSH of a token that is a literal of the given width.
+    enum LiteralFlags {
+      LITERAL_32 = 1,
+      LITERAL_64 = 2
+    };
+
+    uint8_t opcode;
+    uint8_t literal_flags;
+    // For a PUSH, the index in RuleSet::names of the token if it isn't a
+    // literal of the evaluation width.
+    uint16_t name;
+    uint32_t literal_32;
+    uint64_t literal_64;
+  };
+
+  // A postfix expression, of the sort interpreted by
+  // google_breakpad::PostfixEvaluator, and its compiled form.
+  struct Rule {
+    Rule() : compiled(false), assigns(false) {}
+
+    string expression;
+    vector<Instruction> code;
+    // False if the expression exceeds the limits of compiled rules.
+    bool compiled;
+    // Whether the expression assigns variables, so it needs a copy of the
+    // values it starts with.
+    bool assigns;
+  };
 
   // A map from register names onto evaluation rules. 
-  typedef map<string, string> RuleMap;
-
-  // In this type, a "postfix expression" is an expression of the sort
-  // interpreted by google_breakpad::PostfixEvaluator.
-
-  // A postfix expression for computing the current frame's CFA (call
-  // frame address). The CFA is a reference address for the frame that
-  // remains unchanged throughout the frame's lifetime. You should
-  // evaluate this expression with a dictionary initially populated
-  // with the values of the current frame's known registers.
-  string cfa_rule_;
-
-  // The following expressions should be evaluated with a dictionary
-  // initially populated with the values of the current frame's known
-  // registers, and with ".cfa" set to the result of evaluating the
-  // cfa_rule expression, above.
-
-  // A postfix expression for computing the current frame's return
-  // address. 
-  string ra_rule_;
-
-  // For a register named REG, rules[REG] is a postfix expression
-  // which leaves the value of REG in the calling frame on the top of
-  // the stack. You should evaluate this expression
-  RuleMap register_rules_;
+  typedef map<string, Rule> RuleMap;
+
+  struct RuleSet {
+    RuleSet() : cfa_name(-1) {}
+
+    // The rule for computing the current frame's CFA (call frame
+    // address). The CFA is a reference address for the frame that
+    // remains unchanged throughout the frame's lifetime. It is evaluated
+    // with the values of the current frame's known registers.
+    Rule cfa_rule;
+
+    // The following rules are evaluated with the values of the current
+    // frame's known registers, and with ".cfa" set to the result of
+    // evaluating the cfa_rule expression, above.
+
+    // The rule for computing the current frame's return address.
+    Rule ra_rule;
+
+    // For a register named REG, register_rules[REG] leaves the value of
+    // REG in the calling frame on the top of the stack.
+    RuleMap register_rules;
+
+    // The register and variable names compiled rules refer to, and the
+    // index of ".cfa" among them, or -1.
+    vector<string> names;
+    int cfa_name;
+  };
+
+  // Returns the rules for modification, copying them first if they are
+  // shared with another CFIFrameInfo.
+  RuleSet* MutableRules();
+
+  // Sets |rule| to |expression| and compiles it against |rules|.
+  static void SetRule(const string& expression, RuleSet* rules, Rule* rule);
+
+  // Evaluates the compiled |rule| with the values of |rules|' names in
+  // |values|, those known having their flag in |known| set, and stores
+  // the value it leaves in |*result|.  Returns false on failure.
+  template<typename ValueType>
+  bool EvaluateRule(const Rule& rule, const MemoryRegion& memory,
+                    ValueType* values, bool* known, ValueType* result) const;
+
+  // Returns true if rules for the CFA and the return address are in
+  // effect, and sets |*compiled| to whether every rule is compiled.
+  bool HasRules(bool* compiled) const;
+
+  // The body of both forms of FindCallerRegs for compiled rules.
+  // LOOKUP(name, &value) finds the current frame's value of a register,
+  // returning false if it is not known, and STORE(name, value) records
+  // the value a rule recovers for the caller's register.
+  template<typename ValueType, typename Lookup, typename Store>
+  bool FindCallerRegsCompiled(const MemoryRegion& memory, Lookup lookup,
+                              Store store, ValueType* cfa,
+                              ValueType* ra) const;
+
+  // FindCallerRegs for rule sets with rules that aren't compiled.
+  template<typename ValueType>
+  bool FindCallerRegsFromText(
+      const RegisterValueMap<ValueType>& registers,
+      const MemoryRegion& memory,
+      RegisterValueMap<ValueType>* caller_registers) const;
+
+  // Shared by copies of a CFIFrameInfo, so that copying one found in a
+  // cache is cheap.  NULL until a rule is set.
+  std::shared_ptr<RuleSet> rules_;
 };
 
 // A parser for STACK CFI-style rule sets.
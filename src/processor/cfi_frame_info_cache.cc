@@ -0,0 +1,86 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// cfi_frame_info_cache.cc: The rule sets a symbol module has assembled from
+// its STACK CFI records.
+//
+// See cfi_frame_info_cache.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/cfi_frame_info_cache.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The number of rule sets a module keeps.  A power of two.
+const size_t kCacheEntries = 256;
+
+}  // namespace
+
+CFIFrameInfoCache::CFIFrameInfoCache() {}
+
+CFIFrameInfo* CFIFrameInfoCache::Find(uint64_t initial_base, bool has_delta,
+                                      uint64_t delta_address) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!entries_)
+    return NULL;
+  const Entry& entry = entries_[Slot(initial_base, has_delta, delta_address)];
+  if (!entry.used || entry.initial_base != initial_base ||
+      entry.has_delta != has_delta || entry.delta_address != delta_address) {
+    return NULL;
+  }
+  return new CFIFrameInfo(entry.rules);
+}
+
+void CFIFrameInfoCache::Insert(uint64_t initial_base, bool has_delta,
+                               uint64_t delta_address,
+                               const CFIFrameInfo& rules) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!entries_)
+    entries_.reset(new Entry[kCacheEntries]);
+  Entry& entry = entries_[Slot(initial_base, has_delta, delta_address)];
+  entry.used = true;
+  entry.has_delta = has_delta;
+  entry.initial_base = initial_base;
+  entry.delta_address = delta_address;
+  entry.rules = rules;
+}
+
+// static
+size_t CFIFrameInfoCache::Slot(uint64_t initial_base, bool has_delta,
+                               uint64_t delta_address) {
+  uint64_t hash = (initial_base * 0x9e3779b97f4a7c15ULL) ^
+                  (delta_address * 0xc2b2ae3d27d4eb4fULL) ^ has_delta;
+  return static_cast<size_t>(hash >> 32) & (kCacheEntries - 1);
+}
+
+}  // namespace google_breakpad
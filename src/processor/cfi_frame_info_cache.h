@@ -0,0 +1,95 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// cfi_frame_info_cache.h: CFIFrameInfoCache, the rule sets a symbol
+// module has assembled from its STACK CFI records.
+//
+// A module finds the rules in effect at an address by parsing the STACK CFI
+// INIT record covering it and every delta record up to it.  The result
+// only depends on that INIT record and on the last delta applied, so
+// modules keep recent results in a CFIFrameInfoCache keyed by those two
+// addresses, and stack walks through the same code skip the parsing.
+
+#ifndef PROCESSOR_CFI_FRAME_INFO_CACHE_H__
+#define PROCESSOR_CFI_FRAME_INFO_CACHE_H__
+
+#include <stdint.h>
+
+#include <memory>
+#include <mutex>
+
+#include "processor/cfi_frame_info.h"
+
+namespace google_breakpad {
+
+class CFIFrameInfoCache {
+ public:
+  CFIFrameInfoCache();
+
+  // Returns a new copy of the rules cached for the STACK CFI INIT record
+  // starting at |initial_base|, with the delta records up to the one at
+  // |delta_address| applied, or none if |has_delta| is false.  The caller
+  // takes ownership.  Returns NULL if no such rules are cached.
+  CFIFrameInfo* Find(uint64_t initial_base, bool has_delta,
+                     uint64_t delta_address) const;
+
+  // Caches a copy of |rules| under the given key, replacing any rules
+  // cached under a key with the same slot.
+  void Insert(uint64_t initial_base, bool has_delta, uint64_t delta_address,
+              const CFIFrameInfo& rules);
+
+ private:
+  struct Entry {
+    Entry() : used(false), has_delta(false), initial_base(0),
+              delta_address(0) {}
+
+    bool used;
+    bool has_delta;
+    uint64_t initial_base;
+    uint64_t delta_address;
+    CFIFrameInfo rules;
+  };
+
+  // Returns the slot of the given key.
+  static size_t Slot(uint64_t initial_base, bool has_delta,
+                     uint64_t delta_address);
+
+  // Guards |entries_|, since modules are looked up from several threads.
+  mutable std::mutex mutex_;
+  // Allocated at the first insertion, since most modules never have their
+  // CFI looked up.
+  std::unique_ptr<Entry[]> entries_;
+
+  // Disallow copy constructor and assignment operator.
+  CFIFrameInfoCache(const CFIFrameInfoCache&);
+  void operator=(const CFIFrameInfoCache&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_CFI_FRAME_INFO_CACHE_H__
@@ -40,6 +40,7 @@
 #include "breakpad_googletest_includes.h"
 #include "common/using_std_string.h"
 #include "processor/cfi_frame_info.h"
+#include "processor/postfix_evaluator-inl.h"
 #include "google_breakpad/processor/memory_region.h"
 
 using google_breakpad::CFIFrameInfo;
@@ -294,6 +295,178 @@ TEST_F(Scope, SeparateTempsRA) {
                                              &caller_registers));
 }
 
+class Compiled: public CFIFixture, public Test {
+ public:
+  // Checks that FindCallerRegs computes the CFA from |expression| as
+  // PostfixEvaluator evaluates it, at width V.
+  template<typename V>
+  void ExpectEvaluatorResult(const string& expression) {
+    CFIFrameInfo::RegisterValueMap<V> registers, caller_registers;
+    registers["$rsp"] = 0x7fff1000;
+    registers["$rbp"] = 0x7fff1040;
+    registers["$big"] = static_cast<V>(0xfedcba9876543210ULL);
+    registers[".cfa"] = 77;
+
+    CFIFrameInfo cfi;
+    cfi.SetCFARule(expression);
+    cfi.SetRARule("0");
+    bool found = cfi.FindCallerRegs<V>(registers, memory, &caller_registers);
+
+    CFIFrameInfo::RegisterValueMap<V> dictionary = registers;
+    google_breakpad::PostfixEvaluator<V> evaluator(&dictionary, &memory);
+    V expected;
+    bool evaluated = evaluator.EvaluateForValue(expression, &expected);
+    EXPECT_EQ(evaluated, found) << expression;
+    if (evaluated && found)
+      EXPECT_EQ(expected, caller_registers[".cfa"]) << expression;
+  }
+
+  void ExpectEvaluatorResults(const string& expression) {
+    ExpectEvaluatorResult<uint32_t>(expression);
+    ExpectEvaluatorResult<uint64_t>(expression);
+  }
+};
+
+TEST_F(Compiled, MatchesPostfixEvaluator) {
+  ExpectNoMemoryReferences();
+
+  const char* const kExpressions[] = {
+    "$rsp 16 +",
+    "-8 $rsp +",
+    "$rbp $rsp - 3 *",
+    "$rbp 7 / $rbp 7 % +",
+    "$rsp 100 + 16 @",
+    "$big 1 +",
+    "4294967296 1 +",
+    "4294967295 -1 *",
+    "18446744073709551616",
+    ".cfa",
+    "$a 3 = $a $a *",
+    "$a 3 =$b 4 = $a $b +",
+    "$a 3 = $a",
+    "5 3 =",
+    "rsp 3 = rsp",
+    "$unknown 1 +",
+    "0x10",
+    "1 2",
+    "+",
+    "1 +",
+    "",
+  };
+  for (const char* expression : kExpressions)
+    ExpectEvaluatorResults(expression);
+}
+
+TEST_F(Compiled, Dereference) {
+  EXPECT_CALL(memory, GetMemoryAtAddress(0x7fff1008, A<uint64_t*>()))
+      .WillRepeatedly(DoAll(SetArgumentPointee<1>(0x401234),
+                            Return(true)));
+  EXPECT_CALL(memory, GetMemoryAtAddress(0x7fff2000, A<uint64_t*>()))
+      .WillRepeatedly(Return(false));
+
+  registers["$rsp"] = 0x7fff1000;
+  cfi.SetCFARule("$rsp 16 +");
+  cfi.SetRARule(".cfa 8 - ^");
+  cfi.SetRegisterRule("$rbx", "$rsp 4096 + ^");
+  ASSERT_TRUE(cfi.FindCallerRegs<uint64_t>(registers, memory,
+                                            &caller_registers));
+  EXPECT_EQ(0x7fff1010U, caller_registers[".cfa"]);
+  EXPECT_EQ(0x401234U, caller_registers[".ra"]);
+  EXPECT_EQ(0U, caller_registers.count("$rbx"));
+}
+
+// Rules naming more registers than compiled rules can refer to are still
+// evaluated.
+TEST_F(Compiled, ManyRegisters) {
+  ExpectNoMemoryReferences();
+
+  string expression = "0";
+  uint64_t sum = 0;
+  for (int i = 0; i < 100; i++) {
+    string name = "$r" + std::to_string(i);
+    registers[name] = i * 1000;
+    sum += i * 1000;
+    expression += " " + name + " +";
+  }
+  cfi.SetCFARule(expression);
+  cfi.SetRARule("$r99");
+  ASSERT_TRUE(cfi.FindCallerRegs<uint64_t>(registers, memory,
+                                            &caller_registers));
+  EXPECT_EQ(sum, caller_registers[".cfa"]);
+  EXPECT_EQ(99000U, caller_registers[".ra"]);
+}
+
+// Copies share their rules until one of them changes.
+TEST_F(Compiled, CopiesAreIndependent) {
+  ExpectNoMemoryReferences();
+
+  cfi.SetCFARule("$rsp 8 +");
+  cfi.SetRARule("1");
+  CFIFrameInfo copy(cfi);
+  copy.SetRegisterRule("$rbx", ".cfa");
+  copy.SetRARule("2");
+  EXPECT_EQ(".cfa: $rsp 8 + .ra: 1", cfi.Serialize());
+  EXPECT_EQ(".cfa: $rsp 8 + .ra: 2 $rbx: .cfa", copy.Serialize());
+
+  registers["$rsp"] = 100;
+  ASSERT_TRUE(cfi.FindCallerRegs<uint64_t>(registers, memory,
+                                            &caller_registers));
+  EXPECT_EQ(2U, caller_registers.size());
+  EXPECT_EQ(1U, caller_registers[".ra"]);
+  ASSERT_TRUE(copy.FindCallerRegs<uint64_t>(registers, memory,
+                                             &caller_registers));
+  EXPECT_EQ(3U, caller_registers.size());
+  EXPECT_EQ(108U, caller_registers["$rbx"]);
+}
+
+// The register file form of FindCallerRegs should recover the same values
+// as the dictionary form, treating registers not in KNOWN as absent.
+TEST_F(Compiled, RegisterFile) {
+  EXPECT_CALL(memory, GetMemoryAtAddress(0x7fff1008, A<uint64_t*>()))
+      .WillRepeatedly(DoAll(SetArgumentPointee<1>(0x401234),
+                            Return(true)));
+  EXPECT_CALL(memory, GetMemoryAtAddress(0x7fff1000, A<uint64_t*>()))
+      .WillRepeatedly(DoAll(SetArgumentPointee<1>(0x7fff2000),
+                            Return(true)));
+
+  static const char* const kNames[] = { "$rsp", "$rbp", "$rbx" };
+  const uint64_t values[] = { 0x7fff0ff0, 0x7fff1000, 0 };
+  uint64_t caller_values[3] = { 0, 0, 0 };
+  uint64_t caller_known = 0, cfa = 0, ra = 0;
+  cfi.SetCFARule("$rbp 16 +");
+  cfi.SetRARule(".cfa 8 - ^");
+  cfi.SetRegisterRule("$rbp", ".cfa 16 - ^");
+  cfi.SetRegisterRule("$rsp", ".cfa");
+  ASSERT_TRUE(cfi.FindCallerRegs<uint64_t>(kNames, 3, values, 0x3, memory,
+                                            caller_values, &caller_known,
+                                            &cfa, &ra));
+  EXPECT_EQ(0x7fff1010U, cfa);
+  EXPECT_EQ(0x401234U, ra);
+  EXPECT_EQ(0x3U, caller_known);
+  EXPECT_EQ(0x7fff1010U, caller_values[0]);
+  EXPECT_EQ(0x7fff2000U, caller_values[1]);
+
+  registers["$rsp"] = values[0];
+  registers["$rbp"] = values[1];
+  ASSERT_TRUE(cfi.FindCallerRegs<uint64_t>(registers, memory,
+                                            &caller_registers));
+  EXPECT_EQ(caller_registers[".cfa"], cfa);
+  EXPECT_EQ(caller_registers[".ra"], ra);
+  EXPECT_EQ(caller_registers["$rbp"], caller_values[1]);
+
+  // Register rules that can't be evaluated leave the register unknown,
+  // but a CFA that can't be is a failure.
+  cfi.SetRegisterRule("$rbx", "$rbx");
+  ASSERT_TRUE(cfi.FindCallerRegs<uint64_t>(kNames, 3, values, 0x3, memory,
+                                            caller_values, &caller_known,
+                                            &cfa, &ra));
+  EXPECT_EQ(0x3U, caller_known);
+  cfi.SetCFARule("$rbx 16 +");
+  EXPECT_FALSE(cfi.FindCallerRegs<uint64_t>(kNames, 3, values, 0x3, memory,
+                                             caller_values, &caller_known,
+                                             &cfa, &ra));
+}
+
 class MockCFIRuleParserHandler: public CFIRuleParser::Handler {
  public:
   MOCK_METHOD1(CFARule, void(const string&));
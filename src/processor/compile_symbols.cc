@@ -0,0 +1,184 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compile_symbols.cc: Compile a tree of text symbol files into fast symbol
+// files for FastSymbolSupplier, on a pool of threads.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/path_helper.h"
+#include "common/using_std_string.h"
+#include "processor/fast_symbol_file.h"
+#include "processor/module_serializer.h"
+
+namespace {
+
+using google_breakpad::ModuleSerializer;
+
+const char kSymbolFileExtension[] = ".sym";
+
+bool HasSuffix(const string& s, const string& suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Adds the paths of the symbol files under |directory|, relative to it and
+// prefixed with |prefix|, to |paths|.
+void FindSymbolFiles(const string& directory, const string& prefix,
+                     std::vector<string>* paths) {
+  DIR* dir = opendir(directory.c_str());
+  if (!dir) {
+    fprintf(stderr, "Can't read directory %s\n", directory.c_str());
+    return;
+  }
+  while (struct dirent* entry = readdir(dir)) {
+    string name = entry->d_name;
+    if (name == "." || name == "..")
+      continue;
+    string path = directory + "/" + name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+      continue;
+    if (S_ISDIR(st.st_mode))
+      FindSymbolFiles(path, prefix + name + "/", paths);
+    else if (S_ISREG(st.st_mode) && HasSuffix(name, kSymbolFileExtension))
+      paths->push_back(prefix + name);
+  }
+  closedir(dir);
+}
+
+// Creates the directories leading up to |path|.
+bool MakeParentDirectories(const string& path) {
+  for (size_t slash = path.find('/', 1); slash != string::npos;
+       slash = path.find('/', slash + 1)) {
+    string directory = path.substr(0, slash);
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+      fprintf(stderr, "Can't create directory %s\n", directory.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+void Usage(int argc, const char* argv[], bool error) {
+  fprintf(error ? stderr : stdout,
+          "Usage: %s [options] <symbol-path> [<fast-symbol-path>]\n"
+          "\n"
+          "Compile every .sym file under <symbol-path> into a %s file at\n"
+          "the same place under <fast-symbol-path>, or next to it if no\n"
+          "<fast-symbol-path> is given, for FastSymbolSupplier to map.\n"
+          "\n"
+          "Options:\n"
+          "\n"
+          "  -i         Give the compiled files a search index\n"
+          "  -j <jobs>  Compile this many files at once (default: the\n"
+          "             number of CPUs)\n",
+          google_breakpad::BaseName(argv[0]).c_str(),
+          google_breakpad::kFastSymbolFileExtension);
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  bool search_index = false;
+  int thread_count = std::thread::hardware_concurrency();
+  int ch;
+  while ((ch = getopt(argc, (char * const*)argv, "hij:")) != -1) {
+    switch (ch) {
+      case 'h':
+        Usage(argc, argv, false);
+        return 0;
+      case 'i':
+        search_index = true;
+        break;
+      case 'j':
+        thread_count = atoi(optarg);
+        if (thread_count < 1) {
+          Usage(argc, argv, true);
+          return 1;
+        }
+        break;
+      default:
+        Usage(argc, argv, true);
+        return 1;
+    }
+  }
+  if (argc - optind != 1 && argc - optind != 2) {
+    Usage(argc, argv, true);
+    return 1;
+  }
+  if (thread_count < 1)
+    thread_count = 1;
+  const string symbol_path = argv[optind];
+  const string fast_symbol_path =
+      argc - optind == 2 ? argv[optind + 1] : symbol_path;
+
+  std::vector<string> paths;
+  FindSymbolFiles(symbol_path, "", &paths);
+  std::sort(paths.begin(), paths.end());
+  std::vector<string> symbol_files;
+  std::vector<string> fast_symbol_files;
+  for (const string& path : paths) {
+    string fast_symbol_file =
+        fast_symbol_path + "/" +
+        path.substr(0, path.size() - strlen(kSymbolFileExtension)) +
+        google_breakpad::kFastSymbolFileExtension;
+    if (!MakeParentDirectories(fast_symbol_file))
+      return 1;
+    symbol_files.push_back(symbol_path + "/" + path);
+    fast_symbol_files.push_back(fast_symbol_file);
+  }
+
+  ModuleSerializer serializer;
+  serializer.set_search_index(search_index);
+  std::vector<bool> failed;
+  size_t failed_count = serializer.CompileSymbolFiles(
+      symbol_files, fast_symbol_files, thread_count, &failed);
+  for (size_t i = 0; i < failed.size(); ++i) {
+    if (failed[i])
+      fprintf(stderr, "Could not compile %s\n", symbol_files[i].c_str());
+  }
+  printf("Compiled %zu of %zu symbol files\n",
+         symbol_files.size() - failed_count, symbol_files.size());
+  return failed_count == 0 ? 0 : 1;
+}
@@ -0,0 +1,390 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// concurrent_source_line_resolver.cc: ConcurrentSourceLineResolver
+// implementation.
+//
+// See concurrent_source_line_resolver.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "google_breakpad/processor/concurrent_source_line_resolver.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/logging.h"
+#include "processor/module_factory.h"
+#include "processor/source_line_resolver_base_types.h"
+#include "processor/trace_probes.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Creates the factory for modules of |module_type|.  Text symbol files are
+// parsed into frozen modules, which the resolver never serializes.
+ModuleFactory* CreateModuleFactory(
+    ConcurrentSourceLineResolver::ModuleType module_type) {
+  if (module_type == ConcurrentSourceLineResolver::kFastModules)
+    return new FastModuleFactory;
+  BasicModuleFactory* factory = new BasicModuleFactory;
+  factory->set_freeze_modules(true);
+  return factory;
+}
+
+}  // namespace
+
+struct ConcurrentSourceLineResolver::LoadedModule {
+  LoadedModule(const CodeModule* code_module, Module* module, char* buffer)
+      : code_identifier(code_module->code_identifier()),
+        debug_file(code_module->debug_file()),
+        debug_identifier(code_module->debug_identifier()),
+        module(module), buffer(buffer), corrupt(module->IsCorrupt()),
+        hits(0) {}
+  ~LoadedModule() {
+    delete module;
+    delete [] buffer;
+  }
+
+  const string code_identifier;
+  const string debug_file;
+  const string debug_identifier;
+  Module* module;
+  // The symbol data |module| refers to, if the resolver owns it.
+  char* buffer;
+  bool corrupt;
+  // HasModule() calls that found this module.
+  std::atomic<uint64_t> hits;
+};
+
+class ConcurrentSourceLineResolver::ModuleShard {
+ public:
+  struct Entry {
+    // Empty until the module has been loaded.
+    std::shared_ptr<LoadedModule> module;
+    // Becomes ready once |module| is set, for threads waiting on the load.
+    std::shared_future<bool> loaded;
+  };
+
+  std::shared_mutex mutex;
+  std::unordered_map<string, Entry> entries;
+};
+
+ConcurrentSourceLineResolver::ConcurrentSourceLineResolver(
+    ModuleType module_type)
+    : SourceLineResolverBase(CreateModuleFactory(module_type)),
+      module_type_(module_type),
+      shards_(new ModuleShard[kShardCount]) {
+}
+
+ConcurrentSourceLineResolver::~ConcurrentSourceLineResolver() {
+  delete [] shards_;
+}
+
+ConcurrentSourceLineResolver::ModuleShard*
+ConcurrentSourceLineResolver::ShardFor(const string& code_file) const {
+  return &shards_[std::hash<string>()(code_file) % kShardCount];
+}
+
+bool ConcurrentSourceLineResolver::LoadModule(const CodeModule* module,
+                                              const string& map_file) {
+  if (module == NULL)
+    return false;
+
+  if (HasModule(module)) {
+    BPLOG(INFO) << "Symbols for module " << module->code_file()
+                << " already loaded";
+    return true;
+  }
+
+  BPLOG(INFO) << "Loading symbols for module " << module->code_file()
+              << " from " << map_file;
+
+  char* memory_buffer;
+  size_t memory_buffer_size;
+  if (!ReadSymbolFile(map_file, &memory_buffer, &memory_buffer_size,
+                      decompression_thread_count()))
+    return false;
+
+  // The fast modules point into memory_buffer, so it has to stay alive as
+  // long as the module.
+  bool keep_buffer = !ShouldDeleteMemoryBufferAfterLoadModule();
+  bool load_result = LoadModuleInternal(module, memory_buffer,
+                                        memory_buffer_size, keep_buffer);
+  if (!keep_buffer)
+    delete [] memory_buffer;
+  return load_result;
+}
+
+bool ConcurrentSourceLineResolver::LoadModuleUsingMapBuffer(
+    const CodeModule* module, const string& map_buffer) {
+  if (module == NULL)
+    return false;
+
+  if (HasModule(module)) {
+    BPLOG(INFO) << "Symbols for module " << module->code_file()
+                << " already loaded";
+    return true;
+  }
+
+  size_t memory_buffer_size = map_buffer.size() + 1;
+  char* memory_buffer = new char[memory_buffer_size];
+
+  // Can't use strcpy, as the data may contain '\0's before the end.
+  memcpy(memory_buffer, map_buffer.c_str(), map_buffer.size());
+  memory_buffer[map_buffer.size()] = '\0';
+
+  bool keep_buffer = !ShouldDeleteMemoryBufferAfterLoadModule();
+  bool load_result = LoadModuleInternal(module, memory_buffer,
+                                        memory_buffer_size, keep_buffer);
+  if (!keep_buffer)
+    delete [] memory_buffer;
+  return load_result;
+}
+
+bool ConcurrentSourceLineResolver::LoadModuleUsingMemoryBuffer(
+    const CodeModule* module,
+    char* memory_buffer,
+    size_t memory_buffer_size) {
+  return LoadModuleInternal(module, memory_buffer, memory_buffer_size,
+                            false /* owned_buffer */);
+}
+
+bool ConcurrentSourceLineResolver::LoadModuleInternal(
+    const CodeModule* module,
+    char* memory_buffer,
+    size_t memory_buffer_size,
+    bool owned_buffer) {
+  if (!module) {
+    if (owned_buffer)
+      delete [] memory_buffer;
+    return false;
+  }
+
+  const string code_file = module->code_file();
+  ModuleShard* shard = ShardFor(code_file);
+  std::promise<bool> loaded;
+  {
+    std::unique_lock<std::shared_mutex> lock(shard->mutex);
+    auto it = shard->entries.find(code_file);
+    if (it != shard->entries.end()) {
+      // Already loaded, or being loaded by another thread.  Wait for that
+      // instead of parsing the symbols a second time.
+      std::shared_future<bool> other_load = it->second.loaded;
+      lock.unlock();
+      if (owned_buffer)
+        delete [] memory_buffer;
+      BPLOG(INFO) << "Symbols for module " << code_file << " already loaded";
+      return other_load.get();
+    }
+    shard->entries[code_file].loaded = loaded.get_future().share();
+  }
+
+  BPLOG(INFO) << "Loading symbols for module " << code_file
+              << " from memory buffer, size: " << memory_buffer_size;
+
+  Module* new_module = module_factory_->CreateModule(code_file);
+
+  // Ownership of memory is NOT transfered to Module::LoadMapFromMemory().
+  BPTRACE2(load_module_begin, code_file.c_str(), memory_buffer_size);
+  if (!new_module->LoadMapFromMemory(memory_buffer, memory_buffer_size)) {
+    BPLOG(ERROR) << "Too many error while parsing symbol data for module "
+                 << code_file;
+    // As in SourceLineResolverBase, keep the module and report it as corrupt
+    // rather than as missing.
+  }
+  BPTRACE2(load_module_end, code_file.c_str(), new_module->IsCorrupt());
+
+  std::shared_ptr<LoadedModule> loaded_module(
+      new LoadedModule(module, new_module,
+                       owned_buffer ? memory_buffer : NULL));
+  {
+    std::unique_lock<std::shared_mutex> lock(shard->mutex);
+    shard->entries[code_file].module = loaded_module;
+  }
+  loaded.set_value(true);
+  return true;
+}
+
+bool ConcurrentSourceLineResolver::ShouldDeleteMemoryBufferAfterLoadModule() {
+  return module_type_ == kBasicModules;
+}
+
+void ConcurrentSourceLineResolver::UnloadModule(const CodeModule* module) {
+  if (!module)
+    return;
+
+  const string code_file = module->code_file();
+  ModuleShard* shard = ShardFor(code_file);
+  std::unique_lock<std::shared_mutex> lock(shard->mutex);
+  auto it = shard->entries.find(code_file);
+  // A module that is still being loaded is left alone; its loader and the
+  // threads waiting on it expect to find it.  Lookups that already hold a
+  // reference to the module keep it alive until they finish.
+  if (it != shard->entries.end() && it->second.module)
+    shard->entries.erase(it);
+}
+
+std::shared_ptr<ConcurrentSourceLineResolver::LoadedModule>
+ConcurrentSourceLineResolver::FindModule(const CodeModule* module) const {
+  if (!module)
+    return std::shared_ptr<LoadedModule>();
+
+  const string code_file = module->code_file();
+  ModuleShard* shard = ShardFor(code_file);
+  std::shared_lock<std::shared_mutex> lock(shard->mutex);
+  auto it = shard->entries.find(code_file);
+  if (it == shard->entries.end())
+    return std::shared_ptr<LoadedModule>();
+  return it->second.module;
+}
+
+bool ConcurrentSourceLineResolver::HasModule(const CodeModule* module) {
+  std::shared_ptr<LoadedModule> loaded_module = FindModule(module);
+  if (!loaded_module)
+    return false;
+  loaded_module->hits.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+std::vector<SourceLineResolverBase::ModuleHits>
+ConcurrentSourceLineResolver::HottestModules(size_t max_count) {
+  std::vector<ModuleHits> modules;
+  for (int i = 0; i < kShardCount; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    for (const auto& entry : shards_[i].entries) {
+      const LoadedModule* loaded_module = entry.second.module.get();
+      if (!loaded_module)
+        continue;
+      ModuleHits module;
+      module.code_file = entry.first;
+      module.code_identifier = loaded_module->code_identifier;
+      module.debug_file = loaded_module->debug_file;
+      module.debug_identifier = loaded_module->debug_identifier;
+      module.hits = loaded_module->hits.load(std::memory_order_relaxed);
+      modules.push_back(module);
+    }
+  }
+  // Shards are unordered, so ties are broken by code file.
+  std::sort(modules.begin(), modules.end(),
+            [](const ModuleHits& a, const ModuleHits& b) {
+              return a.hits != b.hits ? a.hits > b.hits :
+                                        a.code_file < b.code_file;
+            });
+  if (modules.size() > max_count)
+    modules.resize(max_count);
+  return modules;
+}
+
+std::vector<SourceLineResolverBase::ModuleMemoryUsage>
+ConcurrentSourceLineResolver::ModuleMemoryUsages() {
+  std::vector<ModuleMemoryUsage> usages;
+  for (int i = 0; i < kShardCount; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    for (const auto& entry : shards_[i].entries) {
+      const LoadedModule* loaded_module = entry.second.module.get();
+      if (!loaded_module)
+        continue;
+      ModuleMemoryUsage usage = ModuleMemoryUsage();
+      usage.code_file = entry.first;
+      loaded_module->module->GetMemoryUsage(&usage);
+      if (loaded_module->buffer) {
+        usage.copied_buffer_bytes = usage.supplied_buffer_bytes;
+        usage.supplied_buffer_bytes = 0;
+      }
+      usages.push_back(usage);
+    }
+  }
+  std::sort(usages.begin(), usages.end(),
+            [](const ModuleMemoryUsage& a, const ModuleMemoryUsage& b) {
+              return a.resident_bytes != b.resident_bytes ?
+                  a.resident_bytes > b.resident_bytes :
+                  a.code_file < b.code_file;
+            });
+  return usages;
+}
+
+bool ConcurrentSourceLineResolver::IsModuleCorrupt(const CodeModule* module) {
+  std::shared_ptr<LoadedModule> loaded_module = FindModule(module);
+  return loaded_module && loaded_module->corrupt;
+}
+
+void ConcurrentSourceLineResolver::FillSourceLineInfo(
+    StackFrame* frame,
+    std::deque<std::unique_ptr<StackFrame>>* inlined_frames) {
+  std::shared_ptr<LoadedModule> loaded_module = FindModule(frame->module);
+  if (loaded_module)
+    loaded_module->module->LookupAddress(frame, inlined_frames);
+}
+
+void ConcurrentSourceLineResolver::FillSourceLineInfoWithInlineRecords(
+    StackFrame* frame) {
+  std::shared_ptr<LoadedModule> loaded_module = FindModule(frame->module);
+  if (loaded_module)
+    loaded_module->module->LookupAddressWithInlineRecords(frame);
+}
+
+bool ConcurrentSourceLineResolver::ExpandInlineFrames(
+    const StackFrame& frame,
+    std::deque<std::unique_ptr<StackFrame>>* inlined_frames) {
+  if (frame.inline_records.empty())
+    return true;
+  std::shared_ptr<LoadedModule> loaded_module = FindModule(frame.module);
+  if (!loaded_module)
+    return false;
+  loaded_module->module->ExpandInlineFrames(frame, inlined_frames);
+  return true;
+}
+
+WindowsFrameInfo* ConcurrentSourceLineResolver::FindWindowsFrameInfo(
+    const StackFrame* frame) {
+  std::shared_ptr<LoadedModule> loaded_module = FindModule(frame->module);
+  return loaded_module ?
+      loaded_module->module->FindWindowsFrameInfo(frame) : NULL;
+}
+
+CFIFrameInfo* ConcurrentSourceLineResolver::FindCFIFrameInfo(
+    const StackFrame* frame) {
+  std::shared_ptr<LoadedModule> loaded_module = FindModule(frame->module);
+  return loaded_module ? loaded_module->module->FindCFIFrameInfo(frame) : NULL;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,328 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// concurrent_source_line_resolver_unittest.cc: Unit tests for
+// ConcurrentSourceLineResolver.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdlib.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/concurrent_source_line_resolver.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/cfi_frame_info.h"
+#include "processor/module_serializer.h"
+#include "processor/windows_frame_info.h"
+
+namespace {
+
+using google_breakpad::CFIFrameInfo;
+using google_breakpad::CodeModule;
+using google_breakpad::ConcurrentSourceLineResolver;
+using google_breakpad::ModuleSerializer;
+using google_breakpad::StackFrame;
+using google_breakpad::WindowsFrameInfo;
+using google_breakpad::scoped_array;
+using google_breakpad::scoped_ptr;
+
+class TestCodeModule : public CodeModule {
+ public:
+  TestCodeModule(string code_file) : code_file_(code_file) {}
+  virtual ~TestCodeModule() {}
+
+  virtual uint64_t base_address() const { return 0; }
+  virtual uint64_t size() const { return 0xb000; }
+  virtual string code_file() const { return code_file_; }
+  virtual string code_identifier() const { return ""; }
+  virtual string debug_file() const { return ""; }
+  virtual string debug_identifier() const { return ""; }
+  virtual string version() const { return ""; }
+  virtual CodeModule* Copy() const {
+    return new TestCodeModule(code_file_);
+  }
+  virtual bool is_unloaded() const { return false; }
+  virtual uint64_t shrink_down_delta() const { return 0; }
+  virtual void SetShrinkDownDelta(uint64_t shrink_down_delta) {}
+
+ private:
+  string code_file_;
+};
+
+class TestConcurrentSourceLineResolver : public ::testing::Test {
+ public:
+  void SetUp() {
+    testdata_dir = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                         "/src/processor/testdata";
+  }
+
+  string symbol_file(int file_index) {
+    std::stringstream ss;
+    ss << testdata_dir << "/module" << file_index << ".out";
+    return ss.str();
+  }
+
+  string ReadSymbolFile(int file_index) {
+    std::ifstream file(symbol_file(file_index).c_str());
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+  }
+
+  // Checks a few lookups in module1.out, as the BasicSourceLineResolver
+  // tests do.
+  static void ExpectModule1Lookups(ConcurrentSourceLineResolver* resolver,
+                                   const CodeModule* module1) {
+    StackFrame frame;
+    frame.instruction = 0x1000;
+    frame.module = module1;
+    resolver->FillSourceLineInfo(&frame, nullptr);
+    EXPECT_EQ(frame.function_name, "Function1_1");
+    EXPECT_EQ(frame.function_base, 0x1000U);
+    EXPECT_EQ(frame.source_file_name, "file1_1.cc");
+    EXPECT_EQ(frame.source_line, 44);
+
+    scoped_ptr<WindowsFrameInfo> windows_frame_info(
+        resolver->FindWindowsFrameInfo(&frame));
+    ASSERT_TRUE(windows_frame_info.get());
+    EXPECT_EQ(windows_frame_info->type_,
+              WindowsFrameInfo::STACK_INFO_FRAME_DATA);
+
+    frame.instruction = 0x1280;
+    frame.function_name.clear();
+    resolver->FillSourceLineInfo(&frame, nullptr);
+    EXPECT_EQ(frame.function_name, "Function1_3");
+
+    frame.instruction = 0x3d40;
+    scoped_ptr<CFIFrameInfo> cfi_frame_info(
+        resolver->FindCFIFrameInfo(&frame));
+    EXPECT_TRUE(cfi_frame_info.get());
+    frame.instruction = 0x3d3f;
+    cfi_frame_info.reset(resolver->FindCFIFrameInfo(&frame));
+    EXPECT_FALSE(cfi_frame_info.get());
+  }
+
+  string testdata_dir;
+};
+
+TEST_F(TestConcurrentSourceLineResolver, TestLoadAndResolve) {
+  ConcurrentSourceLineResolver resolver;
+  TestCodeModule module1("module1");
+  ASSERT_FALSE(resolver.HasModule(&module1));
+  ASSERT_TRUE(resolver.LoadModule(&module1, symbol_file(1)));
+  ASSERT_TRUE(resolver.HasModule(&module1));
+  ASSERT_FALSE(resolver.IsModuleCorrupt(&module1));
+  ExpectModule1Lookups(&resolver, &module1);
+
+  // Loading a module that is already loaded leaves it usable.
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module1, ReadSymbolFile(1)));
+  ExpectModule1Lookups(&resolver, &module1);
+
+  TestCodeModule module2("module2");
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module2, ReadSymbolFile(2)));
+  ASSERT_TRUE(resolver.HasModule(&module2));
+
+  StackFrame frame;
+  frame.instruction = 0x2181;
+  frame.module = &module2;
+  resolver.FillSourceLineInfo(&frame, nullptr);
+  EXPECT_EQ(frame.function_name, "Function2_2");
+  EXPECT_EQ(frame.source_file_name, "file2_2.cc");
+  EXPECT_EQ(frame.source_line, 21);
+
+  // Frames without a module, or in a module that is not loaded, are left
+  // alone.
+  TestCodeModule module3("module3");
+  frame.function_name.clear();
+  frame.module = &module3;
+  resolver.FillSourceLineInfo(&frame, nullptr);
+  EXPECT_TRUE(frame.function_name.empty());
+  frame.module = NULL;
+  resolver.FillSourceLineInfo(&frame, nullptr);
+  EXPECT_TRUE(frame.function_name.empty());
+  EXPECT_FALSE(resolver.FindWindowsFrameInfo(&frame));
+  EXPECT_FALSE(resolver.FindCFIFrameInfo(&frame));
+}
+
+TEST_F(TestConcurrentSourceLineResolver, TestInvalidLoads) {
+  ConcurrentSourceLineResolver resolver;
+  TestCodeModule module3("module3");
+  ASSERT_TRUE(resolver.LoadModule(&module3,
+                                  testdata_dir + "/module3_bad.out"));
+  ASSERT_TRUE(resolver.HasModule(&module3));
+  ASSERT_TRUE(resolver.IsModuleCorrupt(&module3));
+  TestCodeModule module5("module5");
+  ASSERT_FALSE(resolver.LoadModule(&module5,
+                                   testdata_dir + "/invalid-filename"));
+  ASSERT_FALSE(resolver.HasModule(&module5));
+  ASSERT_FALSE(resolver.IsModuleCorrupt(&module5));
+  ASSERT_FALSE(resolver.LoadModule(NULL, symbol_file(1)));
+}
+
+TEST_F(TestConcurrentSourceLineResolver, TestUnload) {
+  ConcurrentSourceLineResolver resolver;
+  TestCodeModule module1("module1");
+  ASSERT_TRUE(resolver.LoadModule(&module1, symbol_file(1)));
+  ASSERT_TRUE(resolver.HasModule(&module1));
+  resolver.UnloadModule(&module1);
+  ASSERT_FALSE(resolver.HasModule(&module1));
+  ASSERT_TRUE(resolver.LoadModule(&module1, symbol_file(1)));
+  ASSERT_TRUE(resolver.HasModule(&module1));
+  ExpectModule1Lookups(&resolver, &module1);
+}
+
+TEST_F(TestConcurrentSourceLineResolver, TestHottestModules) {
+  ConcurrentSourceLineResolver resolver;
+  TestCodeModule module1("module1");
+  TestCodeModule module2("module2");
+  ASSERT_TRUE(resolver.LoadModule(&module1, symbol_file(1)));
+  ASSERT_TRUE(resolver.LoadModule(&module2, symbol_file(2)));
+  ASSERT_TRUE(resolver.HasModule(&module2));
+  ASSERT_TRUE(resolver.HasModule(&module2));
+  ASSERT_TRUE(resolver.HasModule(&module1));
+
+  std::vector<ConcurrentSourceLineResolver::ModuleHits> hottest =
+      resolver.HottestModules(10);
+  ASSERT_EQ(hottest.size(), 2U);
+  EXPECT_EQ(hottest[0].code_file, "module2");
+  EXPECT_EQ(hottest[0].hits, 2U);
+  EXPECT_EQ(hottest[1].code_file, "module1");
+  EXPECT_EQ(hottest[1].hits, 1U);
+  EXPECT_EQ(resolver.HottestModules(1).size(), 1U);
+}
+
+TEST_F(TestConcurrentSourceLineResolver, TestModuleMemoryUsages) {
+  ConcurrentSourceLineResolver resolver(
+      ConcurrentSourceLineResolver::kFastModules);
+  ModuleSerializer serializer;
+  size_t size;
+  scoped_array<char> serialized;
+  serialized.reset(serializer.SerializeSymbolFileData(ReadSymbolFile(2),
+                                                      &size));
+  ASSERT_TRUE(serialized.get());
+
+  TestCodeModule module1("module1");
+  TestCodeModule module2("module2");
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(
+      &module1, string(serialized.get(), size)));
+  ASSERT_TRUE(resolver.LoadModuleUsingMemoryBuffer(&module2, serialized.get(),
+                                                   size));
+
+  // The same symbols, so the same size: ties are ordered by code file.
+  std::vector<ConcurrentSourceLineResolver::ModuleMemoryUsage> usages =
+      resolver.ModuleMemoryUsages();
+  ASSERT_EQ(usages.size(), 2U);
+  EXPECT_EQ(usages[0].code_file, "module1");
+  EXPECT_EQ(usages[0].copied_buffer_bytes, usages[0].resident_bytes);
+  EXPECT_EQ(usages[0].supplied_buffer_bytes, 0U);
+  EXPECT_EQ(usages[1].code_file, "module2");
+  EXPECT_EQ(usages[1].copied_buffer_bytes, 0U);
+  EXPECT_EQ(usages[1].supplied_buffer_bytes, size);
+  EXPECT_EQ(usages[1].functions, usages[0].functions);
+  resolver.UnloadModule(&module2);
+}
+
+TEST_F(TestConcurrentSourceLineResolver, TestFastModules) {
+  ConcurrentSourceLineResolver resolver(
+      ConcurrentSourceLineResolver::kFastModules);
+  ASSERT_FALSE(resolver.ShouldDeleteMemoryBufferAfterLoadModule());
+
+  ModuleSerializer serializer;
+  size_t size;
+  scoped_array<char> serialized;
+  serialized.reset(serializer.SerializeSymbolFileData(ReadSymbolFile(1),
+                                                      &size));
+  ASSERT_TRUE(serialized.get());
+
+  TestCodeModule module1("module1");
+  ASSERT_TRUE(resolver.LoadModuleUsingMemoryBuffer(&module1, serialized.get(),
+                                                   size));
+  ASSERT_TRUE(resolver.HasModule(&module1));
+  ExpectModule1Lookups(&resolver, &module1);
+  resolver.UnloadModule(&module1);
+  ASSERT_FALSE(resolver.HasModule(&module1));
+}
+
+// Several threads loading the same modules at once all see them loaded,
+// and can look them up while other modules are being loaded and unloaded.
+TEST_F(TestConcurrentSourceLineResolver, TestConcurrentLoadAndLookup) {
+  ConcurrentSourceLineResolver resolver;
+  TestCodeModule module1("module1");
+  TestCodeModule module2("module2");
+  const string symbols1 = ReadSymbolFile(1);
+  const string symbols2 = ReadSymbolFile(2);
+
+  const int kThreads = 8;
+  std::vector<std::thread> threads;
+  std::vector<int> failures(kThreads, 0);
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i]() {
+      if (!resolver.LoadModuleUsingMapBuffer(&module1, symbols1))
+        ++failures[i];
+      for (int j = 0; j < 100; ++j) {
+        StackFrame frame;
+        frame.instruction = 0x1000;
+        frame.module = &module1;
+        resolver.FillSourceLineInfo(&frame, nullptr);
+        if (frame.function_name != "Function1_1")
+          ++failures[i];
+
+        // Half of the threads churn module2 while the others use module1.
+        if (i % 2) {
+          if (!resolver.LoadModuleUsingMapBuffer(&module2, symbols2))
+            ++failures[i];
+          resolver.UnloadModule(&module2);
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (int i = 0; i < kThreads; ++i)
+    EXPECT_EQ(failures[i], 0) << "thread " << i;
+  EXPECT_TRUE(resolver.HasModule(&module1));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -68,6 +68,7 @@ namespace google_breakpad {
 
 // Forward declarations (for later friend declarations of specialized template).
 template<class, class> class ContainedRangeMapSerializer;
+template<typename, typename> class NestedRangeIndex;
 
 template<typename AddressType, typename EntryType>
 class ContainedRangeMap {
@@ -112,6 +113,7 @@ class ContainedRangeMap {
 
  private:
   friend class ContainedRangeMapSerializer<AddressType, EntryType>;
+  friend class NestedRangeIndex<AddressType, EntryType>;
   friend class ModuleComparer;
 
   // AddressToRangeMap stores pointers.  This makes reparenting simpler in
@@ -40,6 +40,7 @@
 #include <sys/wait.h>
 
 #include <array>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <iterator>
@@ -51,12 +52,15 @@
 #include "common/linux/scoped_pipe.h"
 #include "common/linux/scoped_tmpfile.h"
 #include "processor/logging.h"
+#include "processor/x86_instruction_decoder.h"
 
 namespace google_breakpad {
 namespace {
 
 const size_t kMaxX86InstructionLength = 15;
 
+std::atomic<bool> objdump_fallback_enabled(true);
+
 bool IsInstructionPrefix(const string& token) {
   if (token == "lock" || token == "rep" || token == "repz" ||
       token == "repnz") {
@@ -206,6 +210,16 @@ bool GetRegisterValue(const DumpContext& context, string register_name,
 }
 }  // namespace
 
+// static
+void DisassemblerObjdump::set_objdump_fallback(bool enabled) {
+  objdump_fallback_enabled = enabled;
+}
+
+// static
+bool DisassemblerObjdump::objdump_fallback() {
+  return objdump_fallback_enabled;
+}
+
 // static
 bool DisassemblerObjdump::DisassembleInstruction(uint32_t cpu,
                                                  const uint8_t* raw_bytes,
@@ -220,6 +234,26 @@ bool DisassemblerObjdump::DisassembleInstruction(uint32_t cpu,
     return false;
   }
 
+  if (X86InstructionDecoder::Decode(cpu, raw_bytes, raw_bytes_len,
+                                    &instruction)) {
+    return true;
+  }
+
+  if (!objdump_fallback_enabled)
+    return false;
+
+  return DisassembleInstructionWithObjdump(cpu, raw_bytes, raw_bytes_len,
+                                           instruction);
+}
+
+// static
+bool DisassemblerObjdump::DisassembleInstructionWithObjdump(
+    uint32_t cpu,
+    const uint8_t* raw_bytes,
+    unsigned int raw_bytes_len,
+    string& instruction) {
+  instruction = "";
+
   string architecture;
   if (cpu == MD_CONTEXT_X86) {
     architecture = "i386";
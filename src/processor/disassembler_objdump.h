@@ -42,10 +42,13 @@
 
 namespace google_breakpad {
 
-// Uses objdump to disassemble a single instruction.
+// Disassembles a single instruction, in objdump's Intel syntax.
 //
 // Currently supports disassembly for x86 and x86_64 on linux hosts only; on
 // unsupported platform or for unsupported architectures disassembly will fail.
+// Instructions are decoded in process by X86InstructionDecoder, and only
+// those it does not support are passed to objdump, which may be disabled
+// for processes that cannot fork and exec, such as sandboxed workers.
 //
 // If disassembly is successful, then this allows extracting the instruction
 // opcode, source and destination operands, and computing the source and
@@ -103,18 +106,32 @@ class DisassemblerObjdump {
   //   mov rax, QWORD PTR "[rdx]"
   const string& src() const { return src_; }
 
+  // Sets whether instructions that the in-process decoder does not support
+  // are disassembled by running objdump.  Enabled by default; this applies
+  // to all DisassemblerObjdump instances.
+  static void set_objdump_fallback(bool enabled);
+  static bool objdump_fallback();
+
  private:
   friend class DisassemblerObjdumpForTest;
 
-  // Writes out the provided `raw_bytes` to a temporary file, and executes objdump
-  // to disassemble according to `cpu`, which must be either MD_CONTEXT_X86 or
-  // MD_CONTEXT_AMD64. Once objdump has completed, parses out the instruction
-  // string from the first instruction in the output and stores it in
-  // `instruction`.
+  // Disassembles the first instruction in the provided `raw_bytes` according
+  // to `cpu`, which must be either MD_CONTEXT_X86 or MD_CONTEXT_AMD64, and
+  // stores the instruction string in `instruction`. Uses the in-process
+  // decoder, falling back to objdump if the fallback is enabled.
   static bool DisassembleInstruction(uint32_t cpu, const uint8_t* raw_bytes,
                                      unsigned int raw_bytes_len,
                                      string& instruction);
 
+  // Writes out the provided `raw_bytes` to a temporary file, and executes objdump
+  // to disassemble according to `cpu`. Once objdump has completed, parses out
+  // the instruction string from the first instruction in the output and stores
+  // it in `instruction`.
+  static bool DisassembleInstructionWithObjdump(uint32_t cpu,
+                                                const uint8_t* raw_bytes,
+                                                unsigned int raw_bytes_len,
+                                                string& instruction);
+
   // Splits an `instruction` into three parts, the "main" `operation` and
   // the `dest` and `src` operands.
   // Example:
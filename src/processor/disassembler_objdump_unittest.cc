@@ -226,6 +226,23 @@ TEST(DisassemblerObjdumpTest, DisassembleInstructionAMD64) {
   ASSERT_EQ(instruction, "pop    rax");
 }
 
+TEST(DisassemblerObjdumpTest, DisassembleInstructionWithoutObjdump) {
+  DisassemblerObjdump::set_objdump_fallback(false);
+  string instruction;
+  std::vector<uint8_t> pop_rax = {0x58};
+  EXPECT_TRUE(DisassemblerObjdumpForTest::DisassembleInstruction(
+      MD_CONTEXT_AMD64, pop_rax.data(), pop_rax.size(), instruction));
+  EXPECT_EQ(instruction, "pop    rax");
+  // vmovdqu64 zmm0,ZMMWORD PTR [rsi] is only decoded by objdump.
+  std::vector<uint8_t> vmovdqu64 = {0x62, 0xf1, 0xfe, 0x48, 0x6f, 0x06};
+  EXPECT_FALSE(DisassemblerObjdumpForTest::DisassembleInstruction(
+      MD_CONTEXT_AMD64, vmovdqu64.data(), vmovdqu64.size(), instruction));
+  DisassemblerObjdump::set_objdump_fallback(true);
+  EXPECT_TRUE(DisassemblerObjdumpForTest::DisassembleInstruction(
+      MD_CONTEXT_AMD64, vmovdqu64.data(), vmovdqu64.size(), instruction));
+  EXPECT_EQ(instruction, "vmovdqu64 zmm0,ZMMWORD PTR [rsi]");
+}
+
 TEST(DisassemblerObjdumpTest, TokenizeInstruction) {
   string operation, dest, src;
   ASSERT_TRUE(DisassemblerObjdumpForTest::TokenizeInstruction(
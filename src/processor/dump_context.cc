@@ -166,48 +166,10 @@ bool DumpContext::GetInstructionPointer(uint64_t* ip) const {
   assert(ip);
   *ip = 0;
 
-  if (!valid_) {
-    BPLOG(ERROR) << "Invalid DumpContext for GetInstructionPointer";
+  Registers registers;
+  if (!GetRegisters(&registers))
     return false;
-  }
-
-  switch (GetContextCPU()) {
-  case MD_CONTEXT_AMD64:
-    *ip = GetContextAMD64()->rip;
-    break;
-  case MD_CONTEXT_ARM:
-    *ip = GetContextARM()->iregs[MD_CONTEXT_ARM_REG_PC];
-    break;
-  case MD_CONTEXT_ARM64:
-    *ip = GetContextARM64()->iregs[MD_CONTEXT_ARM64_REG_PC];
-    break;
-  case MD_CONTEXT_PPC:
-    *ip = GetContextPPC()->srr0;
-    break;
-  case MD_CONTEXT_PPC64:
-    *ip = GetContextPPC64()->srr0;
-    break;
-  case MD_CONTEXT_SPARC:
-    *ip = GetContextSPARC()->pc;
-    break;
-  case MD_CONTEXT_X86:
-    *ip = GetContextX86()->eip;
-    break;
-  case MD_CONTEXT_MIPS:
-  case MD_CONTEXT_MIPS64:
-    *ip = GetContextMIPS()->epc;
-    break;
-  case MD_CONTEXT_RISCV:
-    *ip = GetContextRISCV()->pc;
-    break;
-  case MD_CONTEXT_RISCV64:
-    *ip = GetContextRISCV64()->pc;
-    break;
-  default:
-    // This should never happen.
-    BPLOG(ERROR) << "Unknown CPU architecture in GetInstructionPointer";
-    return false;
-  }
+  *ip = registers.instruction_pointer;
   return true;
 }
 
@@ -216,46 +178,89 @@ bool DumpContext::GetStackPointer(uint64_t* sp) const {
   assert(sp);
   *sp = 0;
 
+  Registers registers;
+  if (!GetRegisters(&registers))
+    return false;
+  *sp = registers.stack_pointer;
+  return true;
+}
+
+bool DumpContext::GetRegisters(Registers* registers) const {
+  BPLOG_IF(ERROR, !registers) << "DumpContext::GetRegisters requires "
+                                 "|registers|";
+  assert(registers);
+  *registers = Registers();
+
   if (!valid_) {
-    BPLOG(ERROR) << "Invalid DumpContext for GetStackPointer";
+    BPLOG(ERROR) << "Invalid DumpContext for GetRegisters";
     return false;
   }
 
-  switch (GetContextCPU()) {
+  // The CPU type has been checked here, so the union is read directly
+  // rather than through the checking GetContext* accessors.
+  registers->cpu = GetContextCPU();
+  switch (registers->cpu) {
   case MD_CONTEXT_AMD64:
-    *sp = GetContextAMD64()->rsp;
+    registers->pointer_size = sizeof(uint64_t);
+    registers->instruction_pointer = context_.amd64->rip;
+    registers->stack_pointer = context_.amd64->rsp;
     break;
   case MD_CONTEXT_ARM:
-    *sp = GetContextARM()->iregs[MD_CONTEXT_ARM_REG_SP];
+    registers->pointer_size = sizeof(uint32_t);
+    registers->instruction_pointer =
+        context_.arm->iregs[MD_CONTEXT_ARM_REG_PC];
+    registers->stack_pointer = context_.arm->iregs[MD_CONTEXT_ARM_REG_SP];
     break;
   case MD_CONTEXT_ARM64:
-    *sp = GetContextARM64()->iregs[MD_CONTEXT_ARM64_REG_SP];
+    registers->pointer_size = sizeof(uint64_t);
+    registers->instruction_pointer =
+        context_.arm64->iregs[MD_CONTEXT_ARM64_REG_PC];
+    registers->stack_pointer =
+        context_.arm64->iregs[MD_CONTEXT_ARM64_REG_SP];
     break;
   case MD_CONTEXT_PPC:
-    *sp = GetContextPPC()->gpr[MD_CONTEXT_PPC_REG_SP];
+    registers->pointer_size = sizeof(uint32_t);
+    registers->instruction_pointer = context_.ppc->srr0;
+    registers->stack_pointer = context_.ppc->gpr[MD_CONTEXT_PPC_REG_SP];
     break;
   case MD_CONTEXT_PPC64:
-    *sp = GetContextPPC64()->gpr[MD_CONTEXT_PPC64_REG_SP];
+    registers->pointer_size = sizeof(uint64_t);
+    registers->instruction_pointer = context_.ppc64->srr0;
+    registers->stack_pointer = context_.ppc64->gpr[MD_CONTEXT_PPC64_REG_SP];
     break;
   case MD_CONTEXT_SPARC:
-    *sp = GetContextSPARC()->g_r[MD_CONTEXT_SPARC_REG_SP];
+    registers->pointer_size = sizeof(uint64_t);
+    registers->instruction_pointer = context_.ctx_sparc->pc;
+    registers->stack_pointer =
+        context_.ctx_sparc->g_r[MD_CONTEXT_SPARC_REG_SP];
     break;
   case MD_CONTEXT_X86:
-    *sp = GetContextX86()->esp;
+    registers->pointer_size = sizeof(uint32_t);
+    registers->instruction_pointer = context_.x86->eip;
+    registers->stack_pointer = context_.x86->esp;
     break;
   case MD_CONTEXT_MIPS:
   case MD_CONTEXT_MIPS64:
-    *sp = GetContextMIPS()->iregs[MD_CONTEXT_MIPS_REG_SP];
+    registers->pointer_size = registers->cpu == MD_CONTEXT_MIPS64 ?
+        sizeof(uint64_t) : sizeof(uint32_t);
+    registers->instruction_pointer = context_.ctx_mips->epc;
+    registers->stack_pointer =
+        context_.ctx_mips->iregs[MD_CONTEXT_MIPS_REG_SP];
     break;
   case MD_CONTEXT_RISCV:
-    *sp = GetContextRISCV()->sp;
+    registers->pointer_size = sizeof(uint32_t);
+    registers->instruction_pointer = context_.riscv->pc;
+    registers->stack_pointer = context_.riscv->sp;
     break;
   case MD_CONTEXT_RISCV64:
-    *sp = GetContextRISCV64()->sp;
+    registers->pointer_size = sizeof(uint64_t);
+    registers->instruction_pointer = context_.riscv64->pc;
+    registers->stack_pointer = context_.riscv64->sp;
     break;
   default:
     // This should never happen.
-    BPLOG(ERROR) << "Unknown CPU architecture in GetStackPointer";
+    BPLOG(ERROR) << "Unknown CPU architecture in GetRegisters";
+    *registers = Registers();
     return false;
   }
   return true;
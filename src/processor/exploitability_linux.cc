@@ -39,8 +39,6 @@
 
 #include "processor/exploitability_linux.h"
 
-#include <string.h>
-
 #include "google_breakpad/common/minidump_exception_linux.h"
 #include "google_breakpad/processor/call_stack.h"
 #include "google_breakpad/processor/process_state.h"
@@ -52,10 +50,6 @@
 
 namespace {
 
-// Prefixes for memory mapping names.
-constexpr char kHeapPrefix[] = "[heap";
-constexpr char kStackPrefix[] =  "[stack";
-
 // This function in libc is called if the program was compiled with
 // -fstack-protector and a function's stack canary changes.
 constexpr char kStackCheckFailureFunction[] = "__stack_chk_fail";
@@ -143,10 +137,16 @@ ExploitabilityRating ExploitabilityLinux::CheckPlatformExploitability() {
   }
 
   // Checking for the instruction pointer in a valid instruction region,
-  // a misplaced stack pointer, and an executable stack or heap.
-  if (!this->InstructionPointerInCode(instruction_ptr) ||
-       this->StackPointerOffStack(stack_ptr) ||
-       this->ExecutableStackOrHeap()) {
+  // a misplaced stack pointer, and an executable stack or heap.  The
+  // mappings are indexed once, and both pointers looked up together.
+  MinidumpLinuxMapsList* linux_maps_list = dump_->GetLinuxMapsList();
+  address_classes_.Build(linux_maps_list);
+  const uint64_t pointers[] = { instruction_ptr, stack_ptr };
+  uint32_t classes[2];
+  address_classes_.Classify(pointers, 2, classes);
+  if (!this->InstructionPointerInCode(classes[0]) ||
+      (linux_maps_list && this->StackPointerOffStack(classes[1])) ||
+      this->ExecutableStackOrHeap()) {
     return EXPLOITABILITY_HIGH;
   }
 
@@ -167,10 +167,8 @@ bool ExploitabilityLinux::EndedOnIllegalWrite(uint64_t instruction_ptr) {
   return false;
 #else
   // Get memory region containing instruction pointer.
-  MinidumpMemoryList* memory_list = dump_->GetMemoryList();
   MinidumpMemoryRegion* memory_region =
-      memory_list ?
-      memory_list->GetMemoryRegionForAddress(instruction_ptr) : NULL;
+      dump_->GetMemoryRegionForAddress(instruction_ptr);
   if (!memory_region) {
     BPLOG(INFO) << "No memory region around instruction pointer.";
     return false;
@@ -229,52 +227,30 @@ bool ExploitabilityLinux::EndedOnIllegalWrite(uint64_t instruction_ptr) {
 #endif  // __linux__
 }
 
-bool ExploitabilityLinux::StackPointerOffStack(uint64_t stack_ptr) {
-  MinidumpLinuxMapsList* linux_maps_list = dump_->GetLinuxMapsList();
-  // Inconclusive if there are no mappings available.
-  if (!linux_maps_list) {
-    return false;
-  }
-  const MinidumpLinuxMaps* linux_maps =
-      linux_maps_list->GetLinuxMapsForAddress(stack_ptr);
+bool ExploitabilityLinux::StackPointerOffStack(uint32_t stack_classes) {
   // Checks if the stack pointer maps to a valid mapping and if the mapping
   // is not the stack. If the mapping has no name, it is inconclusive whether
   // it is off the stack.
-  return !linux_maps || (linux_maps->GetPathname().compare("") &&
-                         linux_maps->GetPathname().compare(
-                             0, strlen(kStackPrefix), kStackPrefix));
+  return !(stack_classes & AddressClassIndex::kMapped) ||
+         !(stack_classes & (AddressClassIndex::kAnonymous |
+                            AddressClassIndex::kStack));
 }
 
 bool ExploitabilityLinux::ExecutableStackOrHeap() {
-  MinidumpLinuxMapsList* linux_maps_list = dump_->GetLinuxMapsList();
-  if (linux_maps_list) {
-    for (size_t i = 0; i < linux_maps_list->get_maps_count(); i++) {
-      const MinidumpLinuxMaps* linux_maps =
-          linux_maps_list->GetLinuxMapsAtIndex(i);
-      // Check for executable stack or heap for each mapping.
-      if (linux_maps && (!linux_maps->GetPathname().compare(
-                             0, strlen(kStackPrefix), kStackPrefix) ||
-                         !linux_maps->GetPathname().compare(
-                             0, strlen(kHeapPrefix), kHeapPrefix)) &&
-          linux_maps->IsExecutable()) {
-        return true;
-      }
-    }
-  }
-  return false;
+  return address_classes_.HasMappingWith(AddressClassIndex::kExecutable |
+                                         AddressClassIndex::kStack) ||
+         address_classes_.HasMappingWith(AddressClassIndex::kExecutable |
+                                         AddressClassIndex::kHeap);
 }
 
-bool ExploitabilityLinux::InstructionPointerInCode(uint64_t instruction_ptr) {
-  // Get Linux memory mapping from /proc/self/maps. Checking whether the
-  // region the instruction pointer is in has executable permission can tell
-  // whether it is in a valid code region. If there is no mapping for the
-  // instruction pointer, it is indicative that the instruction pointer is
-  // not within a module, which implies that it is outside a valid area.
-  MinidumpLinuxMapsList* linux_maps_list = dump_->GetLinuxMapsList();
-  const MinidumpLinuxMaps* linux_maps =
-      linux_maps_list ?
-      linux_maps_list->GetLinuxMapsForAddress(instruction_ptr) : NULL;
-  return linux_maps ? linux_maps->IsExecutable() : false;
+bool ExploitabilityLinux::InstructionPointerInCode(
+    uint32_t instruction_classes) {
+  // Checking whether the mapping from /proc/self/maps that the instruction
+  // pointer is in has executable permission can tell whether it is in a
+  // valid code region. If there is no mapping for the instruction pointer,
+  // it is indicative that the instruction pointer is not within a module,
+  // which implies that it is outside a valid area.
+  return instruction_classes & AddressClassIndex::kExecutable;
 }
 
 bool ExploitabilityLinux::BenignCrashTrigger(
@@ -38,6 +38,7 @@
 
 #include "google_breakpad/common/breakpad_types.h"
 #include "google_breakpad/processor/exploitability.h"
+#include "processor/address_class_index.h"
 
 namespace google_breakpad {
 
@@ -61,9 +62,9 @@ class ExploitabilityLinux : public Exploitability {
  private:
   friend class ExploitabilityLinuxTest;
 
-  // Takes the address of the instruction pointer and returns
+  // Takes the classes of the instruction pointer and returns
   // whether the instruction pointer lies in a valid instruction region.
-  bool InstructionPointerInCode(uint64_t instruction_ptr);
+  bool InstructionPointerInCode(uint32_t instruction_classes);
 
   // Checks the exception that triggered the creation of the
   // minidump and reports whether the exception suggests no exploitability.
@@ -75,9 +76,9 @@ class ExploitabilityLinux : public Exploitability {
   // instruction is at a spot in memory that prohibits writes.
   bool EndedOnIllegalWrite(uint64_t instruction_ptr);
 
-  // Checks if the stack pointer points to a memory mapping that is not
-  // labelled as the stack.
-  bool StackPointerOffStack(uint64_t stack_ptr);
+  // Takes the classes of the stack pointer and checks if it points to a
+  // memory mapping that is not labelled as the stack.
+  bool StackPointerOffStack(uint32_t stack_classes);
 
   // Checks if the stack or heap are marked executable according
   // to the memory mappings.
@@ -86,6 +87,9 @@ class ExploitabilityLinux : public Exploitability {
   // Whether this exploitability engine is permitted to shell out to objdump
   // to disassemble raw bytes.
   bool enable_objdump_;
+
+  // The classes of the dump's memory mappings, built once per rating.
+  AddressClassIndex address_classes_;
 };
 
 }  // namespace google_breakpad
@@ -39,6 +39,7 @@
 #include "breakpad_googletest_includes.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/minidump.h"
 #include "google_breakpad/processor/minidump_processor.h"
 #include "google_breakpad/processor/process_state.h"
 #ifdef __linux__
@@ -67,7 +68,9 @@ using google_breakpad::BasicSourceLineResolver;
 #ifdef __linux__
 using google_breakpad::ExploitabilityLinuxTestMinidumpContext;
 #endif  // __linux__
+using google_breakpad::Minidump;
 using google_breakpad::MinidumpProcessor;
+using google_breakpad::ProcessingOptions;
 using google_breakpad::ProcessState;
 using google_breakpad::SimpleSymbolSupplier;
 
@@ -97,6 +100,43 @@ ExploitabilityFor(const string& filename) {
   return state.exploitability();
 }
 
+// Same as ExploitabilityFor, but processes the dump with |options|.
+google_breakpad::ExploitabilityRating
+ExploitabilityWithOptions(const string& filename,
+                          const ProcessingOptions& options) {
+  SimpleSymbolSupplier supplier(TestDataDir() + "/symbols");
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver);
+  ProcessState state;
+
+  Minidump dump(TestDataDir() + "/" + filename);
+  if (!dump.Read() ||
+      processor.Process(&dump, options, &state) !=
+          google_breakpad::PROCESS_OK) {
+    return google_breakpad::EXPLOITABILITY_ERR_PROCESSING;
+  }
+
+  return state.exploitability();
+}
+
+ProcessingOptions ExploitabilityOptions() {
+  ProcessingOptions options;
+  options.enable_exploitability = true;
+  options.enable_objdump_for_exploitability = true;
+  return options;
+}
+
+const char* const kExploitabilityDumps[] = {
+  "ascii_read_av.dmp",
+  "exec_av_on_stack.dmp",
+  "null_read_av.dmp",
+  "write_av_non_null.dmp",
+  "linux_overflow.dmp",
+  "linux_stacksmash.dmp",
+  "linux_outside_module.dmp",
+  "linux_stack_pointer_in_module.dmp",
+};
+
 TEST(ExploitabilityTest, TestWindowsEngine) {
   ASSERT_EQ(google_breakpad::EXPLOITABILITY_HIGH,
             ExploitabilityFor("ascii_read_av.dmp"));
@@ -179,4 +219,34 @@ TEST(ExploitabilityTest, TestLinuxEngine) {
 #endif  // __linux__
 }
 
+// Asking for the rating through ProcessingOptions gives the same result as
+// the processor's own settings.
+TEST(ExploitabilityTest, TestProcessingOptions) {
+  for (const char* filename : kExploitabilityDumps) {
+    EXPECT_EQ(ExploitabilityFor(filename),
+              ExploitabilityWithOptions(filename, ExploitabilityOptions()))
+        << filename;
+  }
+}
+
+// Rating the crash while the other stacks are walked gives the same result
+// as rating it afterwards.
+TEST(ExploitabilityTest, TestParallelWalks) {
+  ProcessingOptions options = ExploitabilityOptions();
+  options.stackwalk_worker_count = 4;
+  for (const char* filename : kExploitabilityDumps) {
+    EXPECT_EQ(ExploitabilityFor(filename),
+              ExploitabilityWithOptions(filename, options)) << filename;
+  }
+}
+
+TEST(ExploitabilityTest, TestDisableAnalysis) {
+  ProcessingOptions options = ExploitabilityOptions();
+  options.DisableAnalysis();
+  for (const char* filename : kExploitabilityDumps) {
+    EXPECT_EQ(google_breakpad::EXPLOITABILITY_NOT_ANALYZED,
+              ExploitabilityWithOptions(filename, options)) << filename;
+  }
+}
+
 }  // namespace
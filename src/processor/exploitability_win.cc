@@ -95,12 +95,6 @@ ExploitabilityRating ExploitabilityWin::CheckPlatformExploitability() {
     return EXPLOITABILITY_ERR_PROCESSING;
   }
 
-  MinidumpMemoryList* memory_list = dump_->GetMemoryList();
-  bool memory_available = true;
-  if (!memory_list) {
-    BPLOG(INFO) << "Minidump memory segments not available.";
-    memory_available = false;
-  }
   uint64_t address = process_state_->crash_address();
   uint32_t exception_code = raw_exception->exception_record.exception_code;
 
@@ -197,11 +191,9 @@ ExploitabilityRating ExploitabilityWin::CheckPlatformExploitability() {
             BPLOG(INFO) << "Unrecognized access violation type.";
             return EXPLOITABILITY_ERR_PROCESSING;
         }
-        MinidumpMemoryRegion* instruction_region = 0;
-        if (memory_available) {
-          instruction_region =
-              memory_list->GetMemoryRegionForAddress(instruction_ptr);
-        }
+        // Full-memory minidumps keep their memory in the Memory64 list.
+        MinidumpMemoryRegion* instruction_region =
+            dump_->GetMemoryRegionForAddress(instruction_ptr);
         if (!near_null && instruction_region &&
             context->GetContextCPU() == MD_CONTEXT_X86 &&
             (bad_read || bad_write)) {
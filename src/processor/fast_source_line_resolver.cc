@@ -48,6 +48,7 @@
 #include <map>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "common/scoped_ptr.h"
 #include "common/using_std_string.h"
@@ -70,6 +71,18 @@ bool FastSourceLineResolver::ShouldDeleteMemoryBufferAfterLoadModule() {
 void FastSourceLineResolver::Module::LookupAddress(
     StackFrame* frame,
     std::deque<std::unique_ptr<StackFrame>>* inlined_frames) const {
+  LookupAddress(frame, inlined_frames, false);
+}
+
+void FastSourceLineResolver::Module::LookupAddressWithInlineRecords(
+    StackFrame* frame) const {
+  LookupAddress(frame, NULL, true);
+}
+
+void FastSourceLineResolver::Module::LookupAddress(
+    StackFrame* frame,
+    std::deque<std::unique_ptr<StackFrame>>* inlined_frames,
+    bool record_inlines) const {
   MemAddr address = frame->instruction - frame->module->base_address();
 
   // First, look for a FUNC record that covers address. Use
@@ -78,9 +91,12 @@ void FastSourceLineResolver::Module::LookupAddress(
   // extent of the PUBLIC symbol we find, below. This does mean we
   // need to check that address indeed falls within the function we
   // find; do the range comparison in an overflow-friendly way.
-  scoped_ptr<Function> func(new Function);
+  //
+  // The records are read in place from the module's memory buffer, so a
+  // lookup allocates nothing beyond the frame's strings.
+  Function func;
   const Function* func_ptr = 0;
-  scoped_ptr<PublicSymbol> public_symbol(new PublicSymbol);
+  PublicSymbol public_symbol;
   const PublicSymbol* public_symbol_ptr = 0;
   MemAddr function_base;
   MemAddr function_size;
@@ -89,85 +105,93 @@ void FastSourceLineResolver::Module::LookupAddress(
   if (functions_.RetrieveNearestRange(address, func_ptr,
                                       &function_base, &function_size) &&
       address >= function_base && address - function_base < function_size) {
-    func->CopyFrom(func_ptr);
-    frame->function_name = func->name;
+    func.CopyFrom(func_ptr);
+    frame->function_name.assign(func.name.data(), func.name.size());
     frame->function_base = frame->module->base_address() + function_base;
-    frame->is_multiple = func->is_multiple;
+    frame->is_multiple = func.is_multiple;
 
-    scoped_ptr<Line> line(new Line);
+    Line line;
     const Line* line_ptr = 0;
     MemAddr line_base;
-    if (func->lines.RetrieveRange(address, line_ptr, &line_base, NULL)) {
-      line->CopyFrom(line_ptr);
-      FileMap::iterator it = files_.find(line->source_file_id);
+    int line_file_id = -1;
+    if (func.lines.RetrieveRange(address, line_ptr, &line_base, NULL)) {
+      line.CopyFrom(line_ptr);
+      FileMap::iterator it = files_.find(line.source_file_id);
       if (it != files_.end()) {
-        frame->source_file_name =
-            files_.find(line->source_file_id).GetValuePtr();
+        frame->source_file_name = it.GetValuePtr();
       }
-      frame->source_line = line->line;
+      frame->source_line = line.line;
       frame->source_line_base = frame->module->base_address() + line_base;
+      line_file_id = line.source_file_id;
     }
     // Check if this is inlined function call.
     if (inlined_frames) {
-      ConstructInlineFrames(frame, address, func->inlines, inlined_frames);
+      ConstructInlineFrames(frame, address, func.inlines, inlined_frames);
+    } else if (record_inlines) {
+      RecordInlines(frame, address, func.inlines, line_file_id);
     }
   } else if (public_symbols_.Retrieve(address,
                                       public_symbol_ptr, &public_address) &&
              (!func_ptr || public_address > function_base)) {
-    public_symbol->CopyFrom(public_symbol_ptr);
-    frame->function_name = public_symbol->name;
+    public_symbol.CopyFrom(public_symbol_ptr);
+    frame->function_name.assign(public_symbol.name.data(),
+                                public_symbol.name.size());
     frame->function_base = frame->module->base_address() + public_address;
-    frame->is_multiple = public_symbol->is_multiple;
+    frame->is_multiple = public_symbol.is_multiple;
   }
 }
 
 void FastSourceLineResolver::Module::ConstructInlineFrames(
     StackFrame* frame,
     MemAddr address,
-    const StaticContainedRangeMap<MemAddr, char>& inline_map,
+    const StaticNestedRangeIndex<MemAddr, char>& inline_map,
     std::deque<std::unique_ptr<StackFrame>>* inlined_frames) const {
-  std::vector<const char*> inline_ptrs;
-  if (!inline_map.RetrieveRanges(address, inline_ptrs)) {
-    return;
-  }
-
-  for (const char* inline_ptr : inline_ptrs) {
-    scoped_ptr<Inline> in(new Inline);
-    in->CopyFrom(inline_ptr);
-    unique_ptr<StackFrame> new_frame =
-        unique_ptr<StackFrame>(new StackFrame(*frame));
-    auto origin_iter = inline_origins_.find(in->origin_id);
+  // The ranges are visited from innermost to outermost.  By push_back, we
+  // will have inlined_frames with the same order.
+  bool found = inline_map.VisitRanges(address, [&](const char* inline_ptr) {
+    Inline in;
+    in.CopyFrom(inline_ptr);
+    // Only the fields an inlined frame keeps from |frame| are copied; the
+    // names are set below.
+    unique_ptr<StackFrame> new_frame(new StackFrame);
+    new_frame->instruction = frame->instruction;
+    new_frame->module = frame->module;
+    new_frame->source_line_base = frame->source_line_base;
+    new_frame->is_multiple = frame->is_multiple;
+    auto origin_iter = inline_origins_.find(in.origin_id);
     if (origin_iter != inline_origins_.end()) {
-      scoped_ptr<InlineOrigin> origin(new InlineOrigin);
-      origin->CopyFrom(origin_iter.GetValuePtr());
-      new_frame->function_name = origin->name;
+      InlineOrigin origin;
+      origin.CopyFrom(origin_iter.GetValuePtr());
+      new_frame->function_name.assign(origin.name.data(), origin.name.size());
     } else {
       new_frame->function_name = "<name omitted>";
     }
 
     // Store call site file and line in current frame, which will be updated
     // later.
-    new_frame->source_line = in->call_site_line;
-    if (in->has_call_site_file_id) {
-      auto file_iter = files_.find(in->call_site_file_id);
+    new_frame->source_line = in.call_site_line;
+    const char* call_site_file = NULL;
+    if (in.has_call_site_file_id) {
+      auto file_iter = files_.find(in.call_site_file_id);
       if (file_iter != files_.end()) {
-        new_frame->source_file_name = file_iter.GetValuePtr();
+        call_site_file = file_iter.GetValuePtr();
       }
     }
+    if (call_site_file)
+      new_frame->source_file_name = call_site_file;
+    else
+      new_frame->source_file_name = frame->source_file_name;
 
     // Use the starting address of the inlined range as inlined function base.
-    new_frame->function_base = new_frame->module->base_address();
-    for (const auto& range : in->inline_ranges) {
-      if (address >= range.first && address < range.first + range.second) {
-        new_frame->function_base += range.first;
-        break;
-      }
-    }
+    MemAddr range_address = 0;
+    in.FindRange(address, &range_address);
+    new_frame->function_base = new_frame->module->base_address() +
+                               range_address;
     new_frame->trust = StackFrame::FRAME_TRUST_INLINE;
-
-    // The inlines vector has an order from innermost entry to outermost entry.
-    // By push_back, we will have inlined_frames with the same order.
     inlined_frames->push_back(std::move(new_frame));
+  });
+  if (!found) {
+    return;
   }
 
   // Update the source file and source line for each inlined frame.
@@ -183,6 +207,51 @@ void FastSourceLineResolver::Module::ConstructInlineFrames(
   }
 }
 
+void FastSourceLineResolver::Module::RecordInlines(
+    StackFrame* frame,
+    MemAddr address,
+    const StaticNestedRangeIndex<MemAddr, char>& inline_map,
+    int line_file_id) const {
+  std::vector<InlineFrameRecord> records;
+  inline_map.VisitRanges(address, [&](const char* inline_ptr) {
+    Inline in;
+    in.CopyFrom(inline_ptr);
+    InlineFrameRecord record;
+    record.origin_id = in.origin_id;
+    record.source_line = in.call_site_line;
+    record.source_file_id = -1;
+    if (in.has_call_site_file_id &&
+        files_.find(in.call_site_file_id) != files_.end()) {
+      record.source_file_id = in.call_site_file_id;
+    }
+    MemAddr range_address = 0;
+    in.FindRange(address, &range_address);
+    record.function_base = range_address;
+    records.push_back(record);
+  });
+  RecordInlineFrames(frame, line_file_id, &records);
+}
+
+bool FastSourceLineResolver::Module::GetInlineOriginName(
+    int origin_id, string* name) const {
+  auto origin_iter = inline_origins_.find(origin_id);
+  if (origin_iter == inline_origins_.end())
+    return false;
+  InlineOrigin origin;
+  origin.CopyFrom(origin_iter.GetValuePtr());
+  name->assign(origin.name.data(), origin.name.size());
+  return true;
+}
+
+bool FastSourceLineResolver::Module::GetFileName(int file_id,
+                                                 string* name) const {
+  FileMap::iterator file = files_.find(file_id);
+  if (file == files_.end())
+    return false;
+  *name = file.GetValuePtr();
+  return true;
+}
+
 // WFI: WindowsFrameInfo.
 // Returns a WFI object reading from a raw memory chunk of data
 WindowsFrameInfo FastSourceLineResolver::CopyWFI(const char* raw) {
@@ -272,9 +341,30 @@ bool FastSourceLineResolver::Module::LoadMapFromMemory(
       StaticRangeMap<MemAddr, char>(mem_buffer + offsets[map_id++]);
   cfi_delta_rules_ = StaticMap<MemAddr, char>(mem_buffer + offsets[map_id++]);
   inline_origins_ = StaticMap<int, char>(mem_buffer + offsets[map_id++]);
+
+  map_id = 0;
+  memory_usage_.files = map_sizes[map_id++];
+  memory_usage_.functions = map_sizes[map_id++];
+  memory_usage_.public_symbols = map_sizes[map_id++];
+  memory_usage_.windows_frame_info = 0;
+  for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i) {
+    memory_usage_.windows_frame_info += map_sizes[map_id++];
+  }
+  memory_usage_.cfi_initial_rules = map_sizes[map_id++];
+  memory_usage_.cfi_delta_rules = map_sizes[map_id++];
+  memory_usage_.inline_origins = map_sizes[map_id++];
+  memory_usage_.resident_bytes = memory_buffer_size;
+  memory_usage_.supplied_buffer_bytes = memory_buffer_size;
   return true;
 }
 
+void FastSourceLineResolver::Module::GetMemoryUsage(
+    ModuleMemoryUsage* usage) const {
+  string code_file = usage->code_file;
+  *usage = memory_usage_;
+  usage->code_file = code_file;
+}
+
 WindowsFrameInfo* FastSourceLineResolver::Module::FindWindowsFrameInfo(
     const StackFrame* frame) const {
   MemAddr address = frame->instruction - frame->module->base_address();
@@ -343,6 +433,18 @@ CFIFrameInfo* FastSourceLineResolver::Module::FindCFIFrameInfo(
     return NULL;
   }
 
+  // The rules only depend on the initial rule and the last delta rule
+  // applied, so they may have been assembled before.
+  StaticMap<MemAddr, char>::iterator last_delta =
+    cfi_delta_rules_.upper_bound(address);
+  bool has_delta = last_delta != cfi_delta_rules_.begin() &&
+                   (--last_delta).GetKey() >= initial_base;
+  MemAddr delta_address = has_delta ? last_delta.GetKey() : 0;
+  CFIFrameInfo* cached =
+      cfi_frame_info_cache_.Find(initial_base, has_delta, delta_address);
+  if (cached)
+    return cached;
+
   // Create a frame info structure, and populate it with the rules from
   // the STACK CFI INIT record.
   scoped_ptr<CFIFrameInfo> rules(new CFIFrameInfo());
@@ -359,6 +461,8 @@ CFIFrameInfo* FastSourceLineResolver::Module::FindCFIFrameInfo(
     delta++;
   }
 
+  cfi_frame_info_cache_.Insert(initial_base, has_delta, delta_address,
+                               *rules);
   return rules.release();
 }
 
@@ -0,0 +1,259 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// fast_source_line_resolver_benchmark.cc: Times FillSourceLineInfo lookups
+// in FastSourceLineResolver modules serialized with and without a
+// StaticMapSearchIndex.
+//
+// Usage: fast_source_line_resolver_benchmark [-n functions] [-l lookups]
+//                                            [symbol-file]
+//
+// Without a symbol file, a synthetic module with the given number of
+// functions is generated.  Lookups go to pseudo-random addresses within the
+// module, and both resolvers must agree on every result.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/path_helper.h"
+#include "common/scoped_ptr.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/basic_code_module.h"
+#include "processor/logging.h"
+#include "processor/module_serializer.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::ModuleSerializer;
+using google_breakpad::StackFrame;
+using google_breakpad::scoped_array;
+using std::vector;
+
+struct Options {
+  Options() : num_functions(1000000), num_lookups(10000000) { }
+
+  uint64_t num_functions;
+  uint64_t num_lookups;
+  string symbol_file;
+};
+
+// Returns the text of a symbol file with |num_functions| functions of two
+// lines each, spaced 0x40 bytes apart.
+string SyntheticSymbolData(uint64_t num_functions) {
+  string data = "MODULE Linux x86_64 000000000000000000000000000000000 bench\n"
+                "FILE 0 bench.cc\n";
+  char line[128];
+  for (uint64_t i = 0; i < num_functions; ++i) {
+    uint64_t address = 0x1000 + i * 0x40;
+    snprintf(line, sizeof(line),
+             "FUNC %llx 30 0 function_%llu\n%llx 18 %llu 0\n%llx 18 %llu 0\n",
+             static_cast<unsigned long long>(address),
+             static_cast<unsigned long long>(i),
+             static_cast<unsigned long long>(address),
+             static_cast<unsigned long long>(i * 2),
+             static_cast<unsigned long long>(address + 0x18),
+             static_cast<unsigned long long>(i * 2 + 1));
+    data += line;
+  }
+  return data;
+}
+
+bool ReadSymbolFile(const string& path, string* data) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) {
+    fprintf(stderr, "Can't open %s\n", path.c_str());
+    return false;
+  }
+  char buffer[1 << 16];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    data->append(buffer, read);
+  fclose(file);
+  return true;
+}
+
+// Compiles |symbol_data| and loads it into |resolver| for |module|.  The
+// serialized data must outlive the resolver's use of the module, so it is
+// returned through |serialized|.
+bool LoadModule(const string& symbol_data, bool search_index,
+                const BasicCodeModule& module,
+                FastSourceLineResolver* resolver,
+                scoped_array<char>* serialized) {
+  ModuleSerializer serializer;
+  serializer.set_search_index(search_index);
+  vector<char> text(symbol_data.begin(), symbol_data.end());
+  text.push_back('\0');
+  size_t size = 0;
+  serialized->reset(
+      serializer.CompileSymbolFileData(&text[0], text.size(), &size));
+  if (!serialized->get())
+    return false;
+  return resolver->LoadModuleUsingMemoryBuffer(&module, serialized->get(),
+                                               size);
+}
+
+// Looks up |addresses| in |resolver| and returns the elapsed time in
+// nanoseconds.  Accumulates a checksum of the results into |checksum|.
+double TimeLookups(FastSourceLineResolver* resolver,
+                   const BasicCodeModule& module,
+                   const vector<uint64_t>& addresses, uint64_t* checksum) {
+  StackFrame frame;
+  frame.module = &module;
+  std::deque<std::unique_ptr<StackFrame>> inlined_frames;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  for (uint64_t address : addresses) {
+    frame.instruction = address;
+    frame.function_base = 0;
+    frame.source_line = 0;
+    resolver->FillSourceLineInfo(&frame, &inlined_frames);
+    inlined_frames.clear();
+    *checksum = *checksum * 31 + frame.function_base + frame.source_line;
+  }
+  return std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+void Usage(int argc, char* argv[], bool error) {
+  FILE* fp = error ? stderr : stdout;
+  fprintf(fp,
+          "Usage: %s [options...] [symbol-file]\n"
+          "Time FillSourceLineInfo with and without a search index.\n"
+          "\n"
+          "Options:\n"
+          "  -n <functions>\t Functions in the synthetic module "
+          "(default 1000000)\n"
+          "  -l <lookups>\t Number of lookups (default 10000000)\n"
+          "  -h:\t\t Usage\n",
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+void SetupOptions(int argc, char* argv[], Options* options) {
+  int ch;
+  while ((ch = getopt(argc, argv, "n:l:h")) != -1) {
+    switch (ch) {
+      case 'n':
+        options->num_functions = strtoull(optarg, NULL, 0);
+        break;
+      case 'l':
+        options->num_lookups = strtoull(optarg, NULL, 0);
+        break;
+      case 'h':
+        Usage(argc, argv, false);
+        exit(0);
+      default:
+        Usage(argc, argv, true);
+        exit(1);
+    }
+  }
+  if (options->num_functions == 0 || options->num_lookups == 0 ||
+      argc - optind > 1) {
+    Usage(argc, argv, true);
+    exit(1);
+  }
+  if (optind < argc)
+    options->symbol_file = argv[optind];
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  BPLOG_INIT(&argc, &argv);
+  Options options;
+  SetupOptions(argc, argv, &options);
+
+  string symbol_data;
+  if (options.symbol_file.empty()) {
+    symbol_data = SyntheticSymbolData(options.num_functions);
+  } else if (!ReadSymbolFile(options.symbol_file, &symbol_data)) {
+    return 1;
+  }
+
+  BasicCodeModule module(0, UINT64_MAX, "bench", "", "bench", "", "");
+  FastSourceLineResolver plain_resolver;
+  FastSourceLineResolver indexed_resolver;
+  scoped_array<char> plain_data;
+  scoped_array<char> indexed_data;
+  if (!LoadModule(symbol_data, false, module, &plain_resolver, &plain_data) ||
+      !LoadModule(symbol_data, true, module, &indexed_resolver,
+                  &indexed_data)) {
+    fprintf(stderr, "Can't load the symbol data\n");
+    return 1;
+  }
+
+  // Spread lookups over the address range the functions cover.  The
+  // synthetic module starts at 0x1000; real symbol files usually start near
+  // 0, so the range is a rough bound either way.
+  uint64_t high = options.symbol_file.empty()
+                      ? 0x1000 + options.num_functions * 0x40
+                      : symbol_data.size() * 16;
+  vector<uint64_t> addresses(options.num_lookups);
+  uint64_t state = 0x9e3779b97f4a7c15ULL;
+  for (uint64_t& address : addresses) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    address = state % high;
+  }
+
+  uint64_t plain_checksum = 0;
+  uint64_t indexed_checksum = 0;
+  // Warm up both modules before timing them.
+  TimeLookups(&plain_resolver, module, addresses, &plain_checksum);
+  TimeLookups(&indexed_resolver, module, addresses, &indexed_checksum);
+  plain_checksum = indexed_checksum = 0;
+  double plain_ns =
+      TimeLookups(&plain_resolver, module, addresses, &plain_checksum);
+  double indexed_ns =
+      TimeLookups(&indexed_resolver, module, addresses, &indexed_checksum);
+
+  printf("lookups: %llu\n",
+         static_cast<unsigned long long>(options.num_lookups));
+  printf("binary search: %.1f ns/lookup\n", plain_ns / addresses.size());
+  printf("search index:  %.1f ns/lookup\n", indexed_ns / addresses.size());
+  if (plain_checksum != indexed_checksum) {
+    fprintf(stderr, "Lookup results differ\n");
+    return 1;
+  }
+  return 0;
+}
@@ -43,12 +43,14 @@
 #include "google_breakpad/processor/fast_source_line_resolver.h"
 #include "google_breakpad/processor/stack_frame.h"
 #include "processor/cfi_frame_info.h"
+#include "processor/cfi_frame_info_cache.h"
 #include "processor/contained_range_map.h"
 #include "processor/simple_serializer-inl.h"
 #include "processor/source_line_resolver_base_types.h"
 #include "processor/static_address_map-inl.h"
 #include "processor/static_contained_range_map-inl.h"
 #include "processor/static_map.h"
+#include "processor/static_nested_range_index.h"
 #include "processor/static_range_map-inl.h"
 #include "processor/windows_frame_info.h"
 
@@ -83,7 +85,8 @@ public SourceLineResolverBase::Function {
   // De-serialize the memory data of a Function.
   void CopyFrom(const char* raw) {
     size_t name_size = strlen(raw) + 1;
-    name = raw;
+    // The name stays in the module's memory buffer.
+    name = StringView(raw, name_size - 1);
     raw += name_size;
     DESERIALIZE(raw, address);
     DESERIALIZE(raw, size);
@@ -91,11 +94,11 @@ public SourceLineResolverBase::Function {
     raw = SimpleSerializer<bool>::Read(raw, &is_multiple);
     int32_t inline_size;
     DESERIALIZE(raw, inline_size);
-    inlines = StaticContainedRangeMap<MemAddr, char>(raw);
+    inlines = StaticNestedRangeIndex<MemAddr, char>(raw);
     lines = StaticRangeMap<MemAddr, Line>(raw + inline_size);
   }
 
-  StaticContainedRangeMap<MemAddr, char> inlines;
+  StaticNestedRangeIndex<MemAddr, char> inlines;
   StaticRangeMap<MemAddr, Line> lines;
 };
 
@@ -105,22 +108,38 @@ struct FastSourceLineResolver::Inline : public SourceLineResolverBase::Inline {
     CopyFrom(raw);
   }
 
-  // De-serialize the memory data of a Inline.
+  // De-serialize the memory data of a Inline.  The (address, size) pairs
+  // are left in the module's memory buffer, to be searched by FindRange,
+  // and inline_ranges stays empty.
   void CopyFrom(const char* raw) {
     raw = SimpleSerializer<bool>::Read(raw, &has_call_site_file_id);
     DESERIALIZE(raw, inline_nest_level);
     DESERIALIZE(raw, call_site_line);
     DESERIALIZE(raw, call_site_file_id);
     DESERIALIZE(raw, origin_id);
-    uint32_t inline_range_size;
-    DESERIALIZE(raw, inline_range_size);
-    for (size_t i = 0; i < inline_range_size; i += 2) {
-      std::pair<MemAddr, MemAddr> range;
-      DESERIALIZE(raw, range.first);
-      DESERIALIZE(raw, range.second);
-      inline_ranges.push_back(range);
+    DESERIALIZE(raw, range_count);
+    ranges = raw;
+  }
+
+  // Sets |*range_address| to the start of the range containing |address|.
+  // Returns false if none does.
+  bool FindRange(MemAddr address, MemAddr* range_address) const {
+    const char* raw = ranges;
+    for (uint32_t i = 0; i < range_count; ++i) {
+      MemAddr range_start, range_size;
+      DESERIALIZE(raw, range_start);
+      DESERIALIZE(raw, range_size);
+      if (address >= range_start && address < range_start + range_size) {
+        *range_address = range_start;
+        return true;
+      }
     }
+    return false;
   }
+
+  // The serialized (address, size) pairs, and how many there are.
+  const char* ranges;
+  uint32_t range_count;
 };
 
 struct FastSourceLineResolver::InlineOrigin
@@ -148,7 +167,8 @@ public SourceLineResolverBase::PublicSymbol {
   // De-serialize the memory data of a PublicSymbol.
   void CopyFrom(const char* raw) {
     size_t name_size = strlen(raw) + 1;
-    name = raw;
+    // The name stays in the module's memory buffer.
+    name = StringView(raw, name_size - 1);
     raw += name_size;
     DESERIALIZE(raw, address);
     DESERIALIZE(raw, parameter_size);
@@ -160,7 +180,8 @@ public SourceLineResolverBase::PublicSymbol {
 
 class FastSourceLineResolver::Module: public SourceLineResolverBase::Module {
  public:
-  explicit Module(const string& name) : name_(name), is_corrupt_(false) { }
+  explicit Module(const string& name)
+      : name_(name), is_corrupt_(false), memory_usage_() { }
   virtual ~Module() { }
 
   // Looks up the given relative address, and fills the StackFrame struct
@@ -168,6 +189,7 @@ class FastSourceLineResolver::Module: public SourceLineResolverBase::Module {
   virtual void LookupAddress(
       StackFrame* frame,
       std::deque<std::unique_ptr<StackFrame>>* inlined_frames) const;
+  virtual void LookupAddressWithInlineRecords(StackFrame* frame) const;
 
   // Construct inlined frames for |frame| and store them in |inline_frames|.
   // |frame|'s source line and source file name may be updated if an inlined
@@ -176,7 +198,7 @@ class FastSourceLineResolver::Module: public SourceLineResolverBase::Module {
   virtual void ConstructInlineFrames(
       StackFrame* frame,
       MemAddr address,
-      const StaticContainedRangeMap<MemAddr, char>& inline_map,
+      const StaticNestedRangeIndex<MemAddr, char>& inline_map,
       std::deque<std::unique_ptr<StackFrame>>* inlined_frames) const;
 
   // Loads a map from the given buffer in char* type.
@@ -200,6 +222,14 @@ class FastSourceLineResolver::Module: public SourceLineResolverBase::Module {
   // returned CFIFrameInfo object.
   virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame) const;
 
+  // The module's maps live in the serialized memory buffer, so this is the
+  // size of that buffer.
+  virtual size_t ResidentBytes() const {
+    return memory_usage_.resident_bytes;
+  }
+  // Each kind of record's share is the size of its serialized maps.
+  virtual void GetMemoryUsage(ModuleMemoryUsage* usage) const;
+
   // Number of serialized map components of Module.
   static const int kNumberMaps_ = 6 + WindowsFrameInfo::STACK_INFO_LAST;
 
@@ -208,11 +238,28 @@ class FastSourceLineResolver::Module: public SourceLineResolverBase::Module {
   friend class ModuleComparer;
   typedef StaticMap<int, char> FileMap;
 
+  // Looks up the given relative address for LookupAddress, or with
+  // |record_inlines| set, for LookupAddressWithInlineRecords.
+  void LookupAddress(StackFrame* frame,
+                     std::deque<std::unique_ptr<StackFrame>>* inlined_frames,
+                     bool record_inlines) const;
+
+  // Records the inlines of |inline_map| containing |address| in |frame|,
+  // whose source line is in the FILE record |line_file_id|.
+  void RecordInlines(StackFrame* frame, MemAddr address,
+                     const StaticNestedRangeIndex<MemAddr, char>& inline_map,
+                     int line_file_id) const;
+
+  virtual bool GetInlineOriginName(int origin_id, string* name) const;
+  virtual bool GetFileName(int file_id, string* name) const;
+
   string name_;
   StaticMap<int, char> files_;
   StaticRangeMap<MemAddr, Function> functions_;
   StaticAddressMap<MemAddr, PublicSymbol> public_symbols_;
   bool is_corrupt_;
+  // Filled in from the buffer's map sizes when it is loaded.
+  ModuleMemoryUsage memory_usage_;
 
   // Each element in the array is a ContainedRangeMap for a type
   // listed in WindowsFrameInfoTypes. These are split by type because
@@ -239,6 +286,9 @@ class FastSourceLineResolver::Module: public SourceLineResolverBase::Module {
   // entry (which FindCFIFrameInfo looks up first).
   StaticMap<MemAddr, char> cfi_delta_rules_;
 
+  // The rule sets FindCFIFrameInfo has assembled from the records above.
+  mutable CFIFrameInfoCache cfi_frame_info_cache_;
+
   // INLINE_ORIGIN records: used as a function name string pool for INLINE
   // records.
   StaticMap<int, char> inline_origins_;
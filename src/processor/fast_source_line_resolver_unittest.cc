@@ -42,6 +42,7 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <sstream>
 #include <string>
@@ -67,6 +68,7 @@ using google_breakpad::CodeModule;
 using google_breakpad::MemoryRegion;
 using google_breakpad::StackFrame;
 using google_breakpad::WindowsFrameInfo;
+using google_breakpad::scoped_array;
 using google_breakpad::scoped_ptr;
 
 class TestCodeModule : public CodeModule {
@@ -519,6 +521,98 @@ TEST_F(TestFastSourceLineResolver, TestLoadAndResolveNewInlines) {
   ASSERT_EQ(inlined_frames[0]->trust, StackFrame::FRAME_TRUST_INLINE);
 }
 
+// An inlined function's base is the start of whichever of its ranges
+// holds the address, as in BasicSourceLineResolver.
+TEST_F(TestFastSourceLineResolver, TestInlineWithSeveralRanges) {
+  TestCodeModule module("several_ranges");
+  ASSERT_TRUE(basic_resolver.LoadModuleUsingMapBuffer(
+      &module,
+      "MODULE Linux x86_64 000000000000000000000000000000000 test\n"
+      "FILE 0 a.cc\n"
+      "FILE 1 b.h\n"
+      "INLINE_ORIGIN 0 inlined()\n"
+      "FUNC 1000 100 0 outer()\n"
+      "INLINE 0 10 0 0 1010 10 1040 20 1080 8\n"
+      "1000 100 5 1\n"));
+  ASSERT_TRUE(serializer.ConvertOneModule(module.code_file(), &basic_resolver,
+                                          &fast_resolver));
+
+  for (uint64_t address : {0x1014, 0x1048, 0x1084}) {
+    StackFrame basic_frame, fast_frame;
+    std::deque<std::unique_ptr<StackFrame>> basic_inlined, fast_inlined;
+    basic_frame.instruction = fast_frame.instruction = address;
+    basic_frame.module = fast_frame.module = &module;
+    basic_resolver.FillSourceLineInfo(&basic_frame, &basic_inlined);
+    fast_resolver.FillSourceLineInfo(&fast_frame, &fast_inlined);
+
+    EXPECT_EQ("outer()", fast_frame.function_name);
+    EXPECT_EQ("a.cc", fast_frame.source_file_name);
+    EXPECT_EQ(10, fast_frame.source_line);
+    ASSERT_EQ(1U, fast_inlined.size());
+    EXPECT_EQ("inlined()", fast_inlined[0]->function_name);
+    EXPECT_EQ(address & ~0xfULL, fast_inlined[0]->function_base);
+    EXPECT_EQ("b.h", fast_inlined[0]->source_file_name);
+    EXPECT_EQ(5, fast_inlined[0]->source_line);
+    EXPECT_EQ(StackFrame::FRAME_TRUST_INLINE, fast_inlined[0]->trust);
+
+    ASSERT_EQ(1U, basic_inlined.size());
+    EXPECT_EQ(basic_inlined[0]->function_base,
+              fast_inlined[0]->function_base);
+    EXPECT_EQ(basic_inlined[0]->source_file_name,
+              fast_inlined[0]->source_file_name);
+  }
+}
+
+// Inlined frames recorded during the lookup and expanded later are the
+// ones FillSourceLineInfo constructs.
+TEST_F(TestFastSourceLineResolver, TestExpandInlineFrames) {
+  const char* kSymbolFiles[] = { "linux_inline.old.sym",
+                                 "linux_inline.new.sym" };
+  for (const char* symbol_file : kSymbolFiles) {
+    SCOPED_TRACE(symbol_file);
+    BasicSourceLineResolver inline_basic_resolver;
+    FastSourceLineResolver inline_fast_resolver;
+    TestCodeModule module("linux_inline");
+    ASSERT_TRUE(inline_basic_resolver.LoadModule(
+        &module, testdata_dir +
+                     "/symbols/linux_inline/BBA6FA10B8AAB33D00000000000000000/" +
+                     symbol_file));
+    ASSERT_TRUE(serializer.ConvertOneModule(module.code_file(),
+                                            &inline_basic_resolver,
+                                            &inline_fast_resolver));
+    for (uint64_t address = 0x15b00; address < 0x16300; ++address) {
+      SCOPED_TRACE(address);
+      StackFrame expected;
+      expected.instruction = address;
+      expected.module = &module;
+      std::deque<std::unique_ptr<StackFrame>> expected_inlines;
+      inline_fast_resolver.FillSourceLineInfo(&expected, &expected_inlines);
+      StackFrame frame;
+      frame.instruction = address;
+      frame.module = &module;
+      inline_fast_resolver.FillSourceLineInfoWithInlineRecords(&frame);
+      ASSERT_EQ(expected.function_name, frame.function_name);
+      ASSERT_EQ(expected.source_file_name, frame.source_file_name);
+      ASSERT_EQ(expected.source_line, frame.source_line);
+      ASSERT_EQ(expected_inlines.size(), frame.inline_records.size());
+
+      std::deque<std::unique_ptr<StackFrame>> inlines;
+      ASSERT_TRUE(inline_fast_resolver.ExpandInlineFrames(frame, &inlines));
+      ASSERT_EQ(expected_inlines.size(), inlines.size());
+      for (size_t i = 0; i < inlines.size(); ++i) {
+        ASSERT_EQ(expected_inlines[i]->function_name,
+                  inlines[i]->function_name);
+        ASSERT_EQ(expected_inlines[i]->function_base,
+                  inlines[i]->function_base);
+        ASSERT_EQ(expected_inlines[i]->source_file_name,
+                  inlines[i]->source_file_name);
+        ASSERT_EQ(expected_inlines[i]->source_line, inlines[i]->source_line);
+        ASSERT_EQ(expected_inlines[i]->trust, inlines[i]->trust);
+      }
+    }
+  }
+}
+
 TEST_F(TestFastSourceLineResolver, TestInvalidLoads) {
   TestCodeModule module3("module3");
   ASSERT_TRUE(basic_resolver.LoadModule(&module3,
@@ -577,6 +671,70 @@ TEST_F(TestFastSourceLineResolver, TestUnload) {
   ASSERT_TRUE(fast_resolver.HasModule(&module1));
 }
 
+TEST_F(TestFastSourceLineResolver, TestModuleMemoryUsages) {
+  // module1 is copied into a buffer the resolver owns, module2 is loaded
+  // from one the test supplies.
+  TestCodeModule module1("module1");
+  ASSERT_TRUE(basic_resolver.LoadModule(&module1, symbol_file(1)));
+  ASSERT_TRUE(serializer.ConvertOneModule(module1.code_file(),
+                                          &basic_resolver,
+                                          &fast_resolver));
+  char* symbol_data;
+  size_t symbol_data_size;
+  ASSERT_TRUE(SourceLineResolverBase::ReadSymbolFile(
+      symbol_file(2), &symbol_data, &symbol_data_size));
+  string symbol_data_string(symbol_data, symbol_data_size);
+  delete [] symbol_data;
+  size_t serialized_size = 0;
+  scoped_array<char> serialized(
+      serializer.SerializeSymbolFileData(symbol_data_string, &serialized_size));
+  ASSERT_TRUE(serialized.get());
+  TestCodeModule module2("module2");
+  ASSERT_TRUE(fast_resolver.LoadModuleUsingMemoryBuffer(
+      &module2, serialized.get(), serialized_size));
+
+  std::vector<FastSourceLineResolver::ModuleMemoryUsage> usages =
+      fast_resolver.ModuleMemoryUsages();
+  ASSERT_EQ(usages.size(), 2U);
+  EXPECT_GE(usages[0].resident_bytes, usages[1].resident_bytes);
+  for (const FastSourceLineResolver::ModuleMemoryUsage& usage : usages) {
+    // The maps are the buffer, apart from its header.
+    EXPECT_LT(usage.files + usage.functions + usage.public_symbols +
+                  usage.inline_origins + usage.windows_frame_info +
+                  usage.cfi_initial_rules + usage.cfi_delta_rules,
+              usage.resident_bytes);
+    EXPECT_GT(usage.functions, 0U);
+    if (usage.code_file == "module1") {
+      EXPECT_EQ(usage.copied_buffer_bytes, usage.resident_bytes);
+      EXPECT_EQ(usage.supplied_buffer_bytes, 0U);
+    } else {
+      EXPECT_EQ(usage.code_file, "module2");
+      EXPECT_EQ(usage.copied_buffer_bytes, 0U);
+      EXPECT_EQ(usage.supplied_buffer_bytes, serialized_size);
+      EXPECT_GT(usage.cfi_delta_rules, 0U);
+    }
+  }
+  fast_resolver.UnloadModule(&module2);
+}
+
+TEST_F(TestFastSourceLineResolver, ConvertAllModulesOnThreads) {
+  TestCodeModule module1("module1");
+  TestCodeModule module2("module2");
+  ASSERT_TRUE(basic_resolver.LoadModule(&module1, symbol_file(1)));
+  ASSERT_TRUE(basic_resolver.LoadModule(&module2, symbol_file(2)));
+  serializer.ConvertAllModules(&basic_resolver, &fast_resolver, 4);
+  ASSERT_TRUE(fast_resolver.HasModule(&module1));
+  ASSERT_TRUE(fast_resolver.HasModule(&module2));
+
+  StackFrame frame;
+  frame.instruction = 0x1000;
+  frame.module = &module1;
+  fast_resolver.FillSourceLineInfo(&frame, nullptr);
+  EXPECT_EQ("Function1_1", frame.function_name);
+  EXPECT_EQ("file1_1.cc", frame.source_file_name);
+  EXPECT_EQ(44, frame.source_line);
+}
+
 TEST_F(TestFastSourceLineResolver, CompareModule) {
   char* symbol_data;
   size_t symbol_data_size;
@@ -595,6 +753,149 @@ TEST_F(TestFastSourceLineResolver, CompareModule) {
   }
 }
 
+// Compiles |symbol_data| with CompileSymbolFileData and expects exactly the
+// bytes SerializeSymbolFileData produces for it.
+static void ExpectCompiledMatchesSerialized(ModuleSerializer* serializer,
+                                            const string& symbol_data) {
+  size_t serialized_size = 0;
+  scoped_array<char> serialized(
+      serializer->SerializeSymbolFileData(symbol_data, &serialized_size));
+  ASSERT_TRUE(serialized.get());
+
+  scoped_array<char> buffer(new char[symbol_data.size() + 1]);
+  memcpy(buffer.get(), symbol_data.data(), symbol_data.size());
+  buffer[symbol_data.size()] = '\0';
+  size_t compiled_size = 0;
+  scoped_array<char> compiled(serializer->CompileSymbolFileData(
+      buffer.get(), symbol_data.size() + 1, &compiled_size));
+  ASSERT_TRUE(compiled.get());
+
+  ASSERT_EQ(serialized_size, compiled_size);
+  EXPECT_EQ(0, memcmp(serialized.get(), compiled.get(), compiled_size));
+}
+
+TEST_F(TestFastSourceLineResolver, CompileSymbolFileData) {
+  const char* kSymbolFiles[] = {
+    "module0.out",
+    "module1.out",
+    "module2.out",
+    "module3_bad.out",
+    "module4_bad.out",
+    "symbols/kernel32.pdb/BCE8785C57B44245A669896B6A19B9542/kernel32.sym",
+    "symbols/libc-2.13.so/F4F8DFCD5A5FB5A7CE64717E9E6AE3890/libc-2.13.so.sym",
+    "symbols/linux_inline/BBA6FA10B8AAB33D00000000000000000/"
+        "linux_inline.new.sym",
+    "symbols/linux_inline/BBA6FA10B8AAB33D00000000000000000/"
+        "linux_inline.old.sym",
+    "symbols/test_app.pdb/5A9832E5287241C1838ED98914E9B7FF1/test_app.sym",
+  };
+  for (const char* symbol_file_name : kSymbolFiles) {
+    SCOPED_TRACE(symbol_file_name);
+    char* symbol_data;
+    size_t symbol_data_size;
+    ASSERT_TRUE(SourceLineResolverBase::ReadSymbolFile(
+        testdata_dir + "/" + symbol_file_name, &symbol_data,
+        &symbol_data_size));
+    string symbol_data_string(symbol_data, symbol_data_size);
+    delete [] symbol_data;
+    ExpectCompiledMatchesSerialized(&serializer, symbol_data_string);
+    serializer.set_search_index(true);
+    ExpectCompiledMatchesSerialized(&serializer, symbol_data_string);
+    serializer.set_search_index(false);
+  }
+
+  // Records out of address order, overlapping ranges and repeated keys.
+  ExpectCompiledMatchesSerialized(&serializer,
+      "MODULE Linux x86 000000000000000000000000000000000 module\n"
+      "FILE 2 file2.cc\n"
+      "FILE 1 file1.cc\n"
+      "FILE 2 file2_again.cc\n"
+      "INLINE_ORIGIN 1 inlined\n"
+      "INLINE_ORIGIN 1 inlined_again\n"
+      "FUNC 3000 100 0 third\n"
+      "3000 10 7 1\n"
+      "3008 10 8 2\n"
+      "INLINE 0 7 1 1 3000 8\n"
+      "FUNC 1000 100 0 first\n"
+      "1000 20 3 1\n"
+      "FUNC 1080 100 0 overlaps_first\n"
+      "1080 10 4 1\n"
+      "FUNC 2000 0 0 empty\n"
+      "FUNC ffffffffffffff00 200 0 overflows\n"
+      "FUNC 1200 100 0 second\n"
+      "PUBLIC 1100 0 public1\n"
+      "PUBLIC 1100 0 public1_again\n"
+      "PUBLIC 0 0 public_at_zero\n"
+      "STACK CFI INIT 2000 100 .cfa: $esp 4 +\n"
+      "STACK CFI INIT 1000 100 .cfa: $esp 8 +\n"
+      "STACK CFI INIT 1010 10 .cfa: $esp 12 +\n"
+      "STACK CFI 1004 .cfa: $esp 16 +\n"
+      "STACK CFI 1004 .cfa: $esp 20 +\n"
+      "STACK WIN 4 1000 100 0 0 4 0 0 0 0 1 $eip 4 + ^ =\n"
+      "STACK WIN 4 1010 10 0 0 4 0 0 0 0 1 $eip 8 + ^ =\n");
+
+  // Parse errors and a null in the middle of the data mark the module
+  // corrupt.
+  ExpectCompiledMatchesSerialized(&serializer,
+      string("FUNC 1000 100 0 function\n"
+             "1000 zz 3 1\n"
+             "junk\n"
+             "PUBLIC 2000 0 public\n"
+             "INLINE 1 9 1 1000 4\n") + '\0' + "FILE 1 file.cc\n");
+  ExpectCompiledMatchesSerialized(&serializer, "");
+}
+
+TEST_F(TestFastSourceLineResolver, SearchIndex) {
+  // Enough functions for the function map to get a search index.
+  string symbol_data =
+      "MODULE Linux x86 000000000000000000000000000000000 module\n"
+      "FILE 1 file.cc\n";
+  const int kNumFunctions = 1000;
+  for (int i = 0; i < kNumFunctions; ++i) {
+    char record[128];
+    snprintf(record, sizeof(record), "FUNC %x 10 0 function%d\n%x 10 %d 1\n",
+             0x1000 + i * 0x20, i, 0x1000 + i * 0x20, i + 1);
+    symbol_data += record;
+  }
+
+  FastSourceLineResolver indexed_resolver;
+  TestCodeModule module("module");
+  size_t plain_size = 0;
+  scoped_array<char> plain(
+      serializer.SerializeSymbolFileData(symbol_data, &plain_size));
+  serializer.set_search_index(true);
+  size_t indexed_size = 0;
+  scoped_array<char> indexed(
+      serializer.SerializeSymbolFileData(symbol_data, &indexed_size));
+  EXPECT_GT(indexed_size, plain_size);
+  ASSERT_TRUE(fast_resolver.LoadModuleUsingMemoryBuffer(
+      &module, plain.get(), plain_size));
+  ASSERT_TRUE(indexed_resolver.LoadModuleUsingMemoryBuffer(
+      &module, indexed.get(), indexed_size));
+
+  for (uint64_t address = 0x0ff0; address < 0x1000 + kNumFunctions * 0x20 + 8;
+       address += 8) {
+    StackFrame plain_frame;
+    plain_frame.instruction = address;
+    plain_frame.module = &module;
+    fast_resolver.FillSourceLineInfo(&plain_frame, nullptr);
+    StackFrame indexed_frame;
+    indexed_frame.instruction = address;
+    indexed_frame.module = &module;
+    indexed_resolver.FillSourceLineInfo(&indexed_frame, nullptr);
+    ASSERT_EQ(plain_frame.function_name, indexed_frame.function_name);
+    ASSERT_EQ(plain_frame.function_base, indexed_frame.function_base);
+    ASSERT_EQ(plain_frame.source_file_name, indexed_frame.source_file_name);
+    ASSERT_EQ(plain_frame.source_line, indexed_frame.source_line);
+  }
+  StackFrame frame;
+  frame.instruction = 0x1000 + 500 * 0x20 + 4;
+  frame.module = &module;
+  indexed_resolver.FillSourceLineInfo(&frame, nullptr);
+  EXPECT_EQ("function500", frame.function_name);
+  EXPECT_EQ(501, frame.source_line);
+}
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
@@ -0,0 +1,195 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// fast_symbol_file.cc: Implementation of FastSymbolFile.  See
+// fast_symbol_file.h for the file layout.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/fast_symbol_file.h"
+
+#include <string.h>
+
+#include "common/linux/crc32.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+const char kFastSymbolFileExtension[] = ".fsym";
+
+namespace {
+
+const int kSectionCount = 2;
+
+uint64_t AlignUp(uint64_t offset) {
+  return (offset + kFastSymbolFileAlignment - 1) &
+         ~static_cast<uint64_t>(kFastSymbolFileAlignment - 1);
+}
+
+uint32_t HeaderCrc(const FastSymbolFileHeader& header,
+                   const FastSymbolFileSection* sections) {
+  FastSymbolFileHeader unchecked = header;
+  unchecked.header_crc = 0;
+  uint32_t crc = ComputeCrc32(&unchecked, sizeof(unchecked));
+  return UpdateCrc32(crc, sections,
+                     header.section_count * sizeof(FastSymbolFileSection));
+}
+
+bool WritePadded(const void* data, size_t size, uint64_t* offset,
+                 uint64_t padded_offset, FILE* file) {
+  static const char kPadding[kFastSymbolFileAlignment] = {0};
+  if (padded_offset > *offset &&
+      fwrite(kPadding, 1, padded_offset - *offset, file) !=
+          padded_offset - *offset) {
+    return false;
+  }
+  if (size > 0 && fwrite(data, 1, size, file) != size)
+    return false;
+  *offset = padded_offset + size;
+  return true;
+}
+
+}  // namespace
+
+// static
+bool FastSymbolFile::Write(const string& module_id,
+                           const char* module_data,
+                           size_t module_data_size,
+                           FILE* file) {
+  FastSymbolFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kFastSymbolFileMagic, sizeof(header.magic));
+  header.version = kFastSymbolFileVersion;
+  header.section_count = kSectionCount;
+
+  FastSymbolFileSection sections[kSectionCount];
+  memset(sections, 0, sizeof(sections));
+  uint64_t offset = AlignUp(sizeof(header) + sizeof(sections));
+  sections[0].type = FAST_SYMBOL_SECTION_MODULE_ID;
+  sections[0].offset = offset;
+  sections[0].size = module_id.size() + 1;
+  sections[0].crc = ComputeCrc32(module_id.c_str(), sections[0].size);
+  offset = AlignUp(offset + sections[0].size);
+  sections[1].type = FAST_SYMBOL_SECTION_MODULE_DATA;
+  sections[1].offset = offset;
+  sections[1].size = module_data_size;
+  sections[1].crc = ComputeCrc32(module_data, module_data_size);
+  header.header_crc = HeaderCrc(header, sections);
+
+  uint64_t written = 0;
+  if (!WritePadded(&header, sizeof(header), &written, 0, file) ||
+      !WritePadded(sections, sizeof(sections), &written, written, file)) {
+    BPLOG(ERROR) << "Could not write fast symbol file header";
+    return false;
+  }
+  for (int i = 0; i < kSectionCount; ++i) {
+    const char* section_data =
+        i == 0 ? module_id.c_str() : module_data;
+    if (!WritePadded(section_data, sections[i].size, &written,
+                     sections[i].offset, file)) {
+      BPLOG(ERROR) << "Could not write fast symbol file section "
+                   << sections[i].type;
+      return false;
+    }
+  }
+  return true;
+}
+
+// static
+bool FastSymbolFile::Parse(const char* data,
+                           size_t size,
+                           bool verify_sections,
+                           string* module_id,
+                           const char** module_data,
+                           size_t* module_data_size) {
+  FastSymbolFileHeader header;
+  if (!data || size < sizeof(header)) {
+    BPLOG(ERROR) << "Fast symbol file is too small: " << size;
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, kFastSymbolFileMagic, sizeof(header.magic)) != 0) {
+    BPLOG(ERROR) << "Not a fast symbol file";
+    return false;
+  }
+  if (header.version != kFastSymbolFileVersion) {
+    BPLOG(ERROR) << "Unsupported fast symbol file version " << header.version
+                 << ", expected " << kFastSymbolFileVersion;
+    return false;
+  }
+  if (header.section_count >
+      (size - sizeof(header)) / sizeof(FastSymbolFileSection)) {
+    BPLOG(ERROR) << "Fast symbol file section table is truncated";
+    return false;
+  }
+  // The table directly follows the 24 byte header, so it is only 8 byte
+  // aligned if the file data is; copy it to be safe on every platform.
+  string table(data + sizeof(header),
+               header.section_count * sizeof(FastSymbolFileSection));
+  const FastSymbolFileSection* sections =
+      reinterpret_cast<const FastSymbolFileSection*>(table.data());
+  if (HeaderCrc(header, sections) != header.header_crc) {
+    BPLOG(ERROR) << "Fast symbol file header checksum mismatch";
+    return false;
+  }
+
+  const FastSymbolFileSection* id_section = NULL;
+  const FastSymbolFileSection* data_section = NULL;
+  for (uint32_t i = 0; i < header.section_count; ++i) {
+    const FastSymbolFileSection& section = sections[i];
+    if (section.offset > size || section.size > size - section.offset) {
+      BPLOG(ERROR) << "Fast symbol file section " << section.type
+                   << " extends past the end of the file";
+      return false;
+    }
+    if (verify_sections &&
+        ComputeCrc32(data + section.offset, section.size) != section.crc) {
+      BPLOG(ERROR) << "Fast symbol file section " << section.type
+                   << " checksum mismatch";
+      return false;
+    }
+    if (section.type == FAST_SYMBOL_SECTION_MODULE_ID)
+      id_section = &section;
+    else if (section.type == FAST_SYMBOL_SECTION_MODULE_DATA)
+      data_section = &section;
+  }
+  if (!id_section || !data_section || id_section->size == 0 ||
+      data[id_section->offset + id_section->size - 1] != '\0') {
+    BPLOG(ERROR) << "Fast symbol file is missing its module sections";
+    return false;
+  }
+
+  module_id->assign(data + id_section->offset);
+  *module_data = data + data_section->offset;
+  *module_data_size = data_section->size;
+  return true;
+}
+
+}  // namespace google_breakpad
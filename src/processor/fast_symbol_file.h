@@ -0,0 +1,127 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// fast_symbol_file.h: The on-disk container for FastSourceLineResolver
+// symbol data.
+//
+// A fast symbol file holds a module already serialized by ModuleSerializer,
+// so FastSourceLineResolver can use it straight from a read-only mapping of
+// the file.  The layout is:
+//
+//   FastSymbolFileHeader
+//   FastSymbolFileSection[section_count]
+//   section data, each section starting at a multiple of
+//   kFastSymbolFileAlignment
+//
+// All integers are in the byte order of the machine that wrote the file,
+// like the serialized module itself; a file from a machine with the other
+// byte order fails the version check.  header_crc is the CRC-32 of the
+// header, with header_crc set to 0, followed by the section table, and each
+// section carries the CRC-32 of its data.  Readers skip sections whose type
+// they don't know.
+//
+// kFastSymbolFileVersion must be increased whenever the layout of the
+// container or of the serialized module changes.
+
+#ifndef PROCESSOR_FAST_SYMBOL_FILE_H__
+#define PROCESSOR_FAST_SYMBOL_FILE_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+// The file name extension SimpleSymbolSupplier-style lookups use for fast
+// symbol files, in place of ".sym".
+extern const char kFastSymbolFileExtension[];
+
+const char kFastSymbolFileMagic[8] = {'B', 'P', 'F', 'A', 'S', 'T', 'S', 'Y'};
+const uint32_t kFastSymbolFileVersion = 2;
+const uint32_t kFastSymbolFileAlignment = 16;
+
+enum FastSymbolFileSectionType {
+  // The debug identifier of the module, from its MODULE record, null
+  // terminated.
+  FAST_SYMBOL_SECTION_MODULE_ID = 1,
+  // The module as serialized by ModuleSerializer.
+  FAST_SYMBOL_SECTION_MODULE_DATA = 2
+};
+
+struct FastSymbolFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t section_count;
+  uint32_t header_crc;
+  uint32_t reserved;
+};
+
+struct FastSymbolFileSection {
+  uint32_t type;
+  uint32_t crc;
+  // Relative to the start of the file.
+  uint64_t offset;
+  uint64_t size;
+};
+
+class FastSymbolFile {
+ public:
+  // Writes a fast symbol file holding |module_data|, |module_data_size|
+  // bytes of serialized module, for the module with debug identifier
+  // |module_id| to |file|.  Returns false if writing fails.
+  static bool Write(const string& module_id,
+                    const char* module_data,
+                    size_t module_data_size,
+                    FILE* file);
+
+  // Checks that the |size| bytes at |data| are a fast symbol file of the
+  // current version and, on success, points |*module_data| at the
+  // serialized module inside it and sets |*module_data_size| and
+  // |*module_id|.  The header and section table are always checked against
+  // their CRC; the section data only if |verify_sections| is true, since
+  // that reads every page of the file.
+  static bool Parse(const char* data,
+                    size_t size,
+                    bool verify_sections,
+                    string* module_id,
+                    const char** module_data,
+                    size_t* module_data_size);
+
+ private:
+  // Only allow static methods.
+  FastSymbolFile();
+  FastSymbolFile(const FastSymbolFile&);
+  void operator=(const FastSymbolFile&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_FAST_SYMBOL_FILE_H__
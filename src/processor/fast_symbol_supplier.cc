@@ -0,0 +1,279 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// fast_symbol_supplier.cc: Implementation of FastSymbolSupplier.  See
+// fast_symbol_supplier.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/fast_symbol_supplier.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/scoped_ptr.h"
+#include "google_breakpad/processor/code_module.h"
+#include "processor/fast_symbol_file.h"
+#include "processor/logging.h"
+#include "processor/module_serializer.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Compiled files are written to "<fast symbol file>.compile.XXXXXX" and
+// renamed.
+const char kCompileInfix[] = ".compile.";
+
+// Creates |path| and any missing parent directories.
+bool MakeDirectories(const string& path) {
+  for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+    string prefix = path.substr(0, slash);
+    if (mkdir(prefix.c_str(), 0777) != 0 && errno != EEXIST) {
+      BPLOG(ERROR) << "Can't create directory " << prefix << ": " <<
+                      strerror(errno);
+      return false;
+    }
+    if (slash == string::npos)
+      return true;
+  }
+}
+
+string DirName(const string& path) {
+  size_t slash = path.rfind('/');
+  return slash == string::npos ? string(".") : path.substr(0, slash);
+}
+
+}  // namespace
+
+FastSymbolSupplier::FastSymbolSupplier(const string& path)
+    : SimpleSymbolSupplier(path), verify_checksums_(false) {
+  set_symbol_file_extension(kFastSymbolFileExtension);
+}
+
+FastSymbolSupplier::FastSymbolSupplier(const vector<string>& paths)
+    : SimpleSymbolSupplier(paths), verify_checksums_(false) {
+  set_symbol_file_extension(kFastSymbolFileExtension);
+}
+
+FastSymbolSupplier::~FastSymbolSupplier() {
+  for (const auto& mapping : mappings_)
+    Unmap(mapping.second);
+}
+
+SymbolSupplier::SymbolResult FastSymbolSupplier::GetSymbolFile(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    string* symbol_file,
+    string* symbol_data) {
+  symbol_data->clear();
+  SymbolResult result = FindSymbolFile(module, system_info, symbol_file);
+  if (result != FOUND)
+    return result;
+
+  Mapping mapping;
+  char* data;
+  size_t data_size;
+  result = MapSymbolFile(module, *symbol_file, &mapping, &data, &data_size);
+  if (result == FOUND) {
+    symbol_data->assign(data, data_size);
+    Unmap(mapping);
+  }
+  return result;
+}
+
+SymbolSupplier::SymbolResult FastSymbolSupplier::GetCStringSymbolData(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    string* symbol_file,
+    char** symbol_data,
+    size_t* symbol_data_size) {
+  SymbolResult result = FindSymbolFile(module, system_info, symbol_file);
+  if (result != FOUND)
+    return result;
+
+  Mapping mapping;
+  result = MapSymbolFile(module, *symbol_file, &mapping, symbol_data,
+                         symbol_data_size);
+  if (result == FOUND) {
+    FreeSymbolData(module);
+    mappings_[module->code_file()] = mapping;
+  }
+  return result;
+}
+
+void FastSymbolSupplier::FreeSymbolData(const CodeModule* module) {
+  if (!module)
+    return;
+  std::map<string, Mapping>::iterator it = mappings_.find(module->code_file());
+  if (it == mappings_.end())
+    return;
+  Unmap(it->second);
+  mappings_.erase(it);
+}
+
+SymbolSupplier::SymbolResult FastSymbolSupplier::MapSymbolFile(
+    const CodeModule* module,
+    const string& symbol_file,
+    Mapping* mapping,
+    char** symbol_data,
+    size_t* symbol_data_size) {
+  int fd = open(symbol_file.c_str(), O_RDONLY);
+  if (fd == -1) {
+    BPLOG(ERROR) << "Could not open " << symbol_file;
+    return NOT_FOUND;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size == 0) {
+    BPLOG(ERROR) << "Could not stat " << symbol_file;
+    close(fd);
+    return NOT_FOUND;
+  }
+  // A private writable mapping costs nothing until a page is written, and
+  // keeps a resolver that modifies its buffer from faulting.
+  mapping->size = st.st_size;
+  mapping->address = mmap(NULL, mapping->size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping->address == MAP_FAILED) {
+    BPLOG(ERROR) << "Could not map " << symbol_file;
+    return NOT_FOUND;
+  }
+
+  string module_id;
+  const char* module_data;
+  size_t module_data_size;
+  if (!FastSymbolFile::Parse(static_cast<const char*>(mapping->address),
+                             mapping->size, verify_checksums_, &module_id,
+                             &module_data, &module_data_size)) {
+    BPLOG(ERROR) << "Invalid fast symbol file " << symbol_file;
+    Unmap(*mapping);
+    return NOT_FOUND;
+  }
+  if (module_id != module->debug_identifier()) {
+    BPLOG(ERROR) << "Fast symbol file " << symbol_file << " is for module "
+                 << module_id << ", not " << module->debug_identifier();
+    Unmap(*mapping);
+    return NOT_FOUND;
+  }
+
+  *symbol_data = const_cast<char*>(module_data);
+  *symbol_data_size = module_data_size;
+  return FOUND;
+}
+
+// static
+void FastSymbolSupplier::Unmap(const Mapping& mapping) {
+  munmap(mapping.address, mapping.size);
+}
+
+void FastSymbolSupplier::set_compile_cache(
+    const string& cache_path,
+    const vector<string>& text_symbol_paths) {
+  cache_path_ = cache_path;
+  text_supplier_.reset(new SimpleSymbolSupplier(text_symbol_paths));
+}
+
+SymbolSupplier::SymbolResult FastSymbolSupplier::FindSymbolFile(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    string* symbol_file) {
+  SymbolResult result = GetSymbolFile(module, system_info, symbol_file);
+  if (result != NOT_FOUND || cache_path_.empty())
+    return result;
+
+  string relative_path;
+  if (!GetRelativeSymbolFilePath(module, &relative_path))
+    return NOT_FOUND;
+  *symbol_file = cache_path_ + "/" + relative_path;
+  if (access(symbol_file->c_str(), R_OK) == 0)
+    return FOUND;
+  return CompileIntoCache(module, system_info, *symbol_file);
+}
+
+SymbolSupplier::SymbolResult FastSymbolSupplier::CompileIntoCache(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    const string& fast_symbol_file) {
+  string text_symbol_file;
+  char* text_data;
+  size_t text_data_size;
+  SymbolResult result = text_supplier_->GetCStringSymbolData(
+      module, system_info, &text_symbol_file, &text_data, &text_data_size);
+  if (result != FOUND)
+    return result;
+
+  size_t size;
+  scoped_array<char> serialized(ModuleSerializer().CompileSymbolFileData(
+      text_data, text_data_size, &size));
+  text_supplier_->FreeSymbolData(module);
+  if (!serialized.get()) {
+    BPLOG(ERROR) << "Could not compile " << text_symbol_file;
+    return NOT_FOUND;
+  }
+
+  if (!MakeDirectories(DirName(fast_symbol_file)))
+    return NOT_FOUND;
+  string temp_path = fast_symbol_file + kCompileInfix + "XXXXXX";
+  int fd = mkstemp(&temp_path[0]);
+  if (fd < 0) {
+    BPLOG(ERROR) << "Can't create " << temp_path << ": " << strerror(errno);
+    return NOT_FOUND;
+  }
+  fchmod(fd, 0644);
+  FILE* file = fdopen(fd, "wb");
+  if (!file) {
+    close(fd);
+    unlink(temp_path.c_str());
+    return NOT_FOUND;
+  }
+  bool written = FastSymbolFile::Write(module->debug_identifier(),
+                                       serialized.get(), size, file);
+  if (fclose(file) != 0)
+    written = false;
+  // Another process may have compiled the same file meanwhile; renaming
+  // over it is harmless, as both are the same.
+  if (!written || rename(temp_path.c_str(), fast_symbol_file.c_str()) != 0) {
+    BPLOG(ERROR) << "Can't write " << fast_symbol_file;
+    unlink(temp_path.c_str());
+    return NOT_FOUND;
+  }
+  BPLOG(INFO) << "Compiled " << text_symbol_file << " into "
+              << fast_symbol_file;
+  return FOUND;
+}
+
+}  // namespace google_breakpad
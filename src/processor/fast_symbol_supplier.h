@@ -0,0 +1,142 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// fast_symbol_supplier.h: A SymbolSupplier that maps fast symbol files.
+//
+// FastSymbolSupplier looks for symbol files in the same hierarchy as
+// SimpleSymbolSupplier, but for files with the kFastSymbolFileExtension
+// extension written by ModuleSerializer::CompileSymbolFile rather than text
+// .sym files.  Each file is mapped into memory and the serialized module
+// inside it is handed out without copying, so that FastSourceLineResolver
+// answers lookups straight from the page cache.  The data it supplies is
+// only understood by FastSourceLineResolver.
+//
+// With set_compile_cache, a module that has no fast symbol file yet has its
+// text symbol file compiled into a shared cache directory.  Every process
+// on a host that uses the same cache directory maps the same compiled
+// files, so each module's symbols are parsed once and resident once per
+// host, however many processors use them.
+
+#ifndef PROCESSOR_FAST_SYMBOL_SUPPLIER_H__
+#define PROCESSOR_FAST_SYMBOL_SUPPLIER_H__
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace google_breakpad {
+
+class FastSymbolSupplier : public SimpleSymbolSupplier {
+ public:
+  explicit FastSymbolSupplier(const string& path);
+  explicit FastSymbolSupplier(const vector<string>& paths);
+  virtual ~FastSymbolSupplier();
+
+  // Copies the serialized module out of the fast symbol file into
+  // |symbol_data|.
+  virtual SymbolResult GetSymbolFile(const CodeModule* module,
+                                     const SystemInfo* system_info,
+                                     string* symbol_file,
+                                     string* symbol_data);
+  using SimpleSymbolSupplier::GetSymbolFile;
+
+  // Maps the fast symbol file for |module| and points |*symbol_data| at the
+  // serialized module inside it.  The mapping stays valid until
+  // FreeSymbolData is called for |module| or the supplier is destroyed.
+  virtual SymbolResult GetCStringSymbolData(const CodeModule* module,
+                                            const SystemInfo* system_info,
+                                            string* symbol_file,
+                                            char** symbol_data,
+                                            size_t* symbol_data_size);
+
+  // Unmaps the file mapped by GetCStringSymbolData.
+  virtual void FreeSymbolData(const CodeModule* module);
+
+  // Checks the CRC of every section of each file mapped from now on, which
+  // reads the whole file.  Off by default, where only the header and the
+  // section table are checked.
+  void set_verify_checksums(bool verify_checksums) {
+    verify_checksums_ = verify_checksums;
+  }
+
+  // Compiles symbol files into |cache_path| on demand.  When a module has
+  // no fast symbol file in this supplier's paths or in |cache_path|, its
+  // text symbol file is looked up in |text_symbol_paths| as
+  // SimpleSymbolSupplier does, compiled, and written to |cache_path| in the
+  // same layout.  Each file is written under a temporary name and renamed
+  // into place, so any number of processes may share |cache_path|.
+  void set_compile_cache(const string& cache_path,
+                         const vector<string>& text_symbol_paths);
+
+ private:
+  struct Mapping {
+    void* address;
+    size_t size;
+  };
+
+  // Maps |symbol_file| for |module| and parses it.  On success, stores the
+  // mapping in |*mapping|.
+  SymbolResult MapSymbolFile(const CodeModule* module,
+                             const string& symbol_file,
+                             Mapping* mapping,
+                             char** symbol_data,
+                             size_t* symbol_data_size);
+
+  static void Unmap(const Mapping& mapping);
+
+  // Finds the fast symbol file for |module| in this supplier's paths or in
+  // the compile cache, compiling it into the cache if necessary.
+  SymbolResult FindSymbolFile(const CodeModule* module,
+                              const SystemInfo* system_info,
+                              string* symbol_file);
+
+  // Compiles |module|'s text symbol file into |fast_symbol_file|.
+  SymbolResult CompileIntoCache(const CodeModule* module,
+                                const SystemInfo* system_info,
+                                const string& fast_symbol_file);
+
+  std::map<string, Mapping> mappings_;
+  bool verify_checksums_;
+
+  // The compile cache's directory, or empty if there is none, and the
+  // supplier of the text symbol files compiled into it.
+  string cache_path_;
+  std::unique_ptr<SimpleSymbolSupplier> text_supplier_;
+
+  // Disallow unwanted copy ctor and assignment operator
+  FastSymbolSupplier(const FastSymbolSupplier&);
+  void operator=(const FastSymbolSupplier&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_FAST_SYMBOL_SUPPLIER_H__
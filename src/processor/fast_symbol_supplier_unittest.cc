@@ -0,0 +1,353 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// fast_symbol_supplier_unittest.cc: Unit tests for FastSymbolFile and
+// FastSymbolSupplier.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/basic_code_module.h"
+#include "processor/fast_symbol_file.h"
+#include "processor/fast_symbol_supplier.h"
+#include "processor/module_serializer.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicCodeModule;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::FastSymbolFile;
+using google_breakpad::FastSymbolFileHeader;
+using google_breakpad::FastSymbolFileSection;
+using google_breakpad::FastSymbolSupplier;
+using google_breakpad::ModuleSerializer;
+using google_breakpad::SourceLineResolverBase;
+using google_breakpad::StackFrame;
+using google_breakpad::SymbolSupplier;
+using google_breakpad::kFastSymbolFileAlignment;
+using google_breakpad::kFastSymbolFileExtension;
+using google_breakpad::scoped_array;
+
+const char kModuleId[] = "111111111111111111111111111111111";
+
+string ReadFile(const string& path) {
+  string contents;
+  FILE* file = fopen(path.c_str(), "rb");
+  EXPECT_TRUE(file != NULL);
+  if (!file)
+    return contents;
+  char buffer[4096];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    contents.append(buffer, count);
+  fclose(file);
+  return contents;
+}
+
+void WriteFile(const string& path, const string& contents) {
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_TRUE(file != NULL);
+  EXPECT_EQ(contents.size(), fwrite(contents.data(), 1, contents.size(), file));
+  fclose(file);
+}
+
+class FastSymbolSupplierTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    testdata_dir_ = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                    "/src/processor/testdata";
+    // The SimpleSymbolSupplier layout for module1.pdb.
+    string module_dir = temp_dir_.path() + "/module1.pdb";
+    ASSERT_EQ(0, mkdir(module_dir.c_str(), 0755));
+    module_dir += string("/") + kModuleId;
+    ASSERT_EQ(0, mkdir(module_dir.c_str(), 0755));
+    fast_symbol_file_ = module_dir + "/module1" + kFastSymbolFileExtension;
+    ASSERT_TRUE(serializer_.CompileSymbolFile(testdata_dir_ + "/module1.out",
+                                              fast_symbol_file_));
+  }
+
+  string testdata_dir_;
+  AutoTempDir temp_dir_;
+  string fast_symbol_file_;
+  ModuleSerializer serializer_;
+};
+
+TEST_F(FastSymbolSupplierTest, WriteAndParse) {
+  string module_data("serialized\0module", 17);
+  FILE* file = tmpfile();
+  ASSERT_TRUE(file != NULL);
+  ASSERT_TRUE(FastSymbolFile::Write("ABCD0", module_data.data(),
+                                    module_data.size(), file));
+  rewind(file);
+  string contents;
+  char buffer[256];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    contents.append(buffer, count);
+  fclose(file);
+
+  string module_id;
+  const char* data;
+  size_t data_size;
+  ASSERT_TRUE(FastSymbolFile::Parse(contents.data(), contents.size(), true,
+                                    &module_id, &data, &data_size));
+  EXPECT_EQ("ABCD0", module_id);
+  EXPECT_EQ(module_data, string(data, data_size));
+  EXPECT_EQ(0U, (data - contents.data()) % kFastSymbolFileAlignment);
+}
+
+TEST_F(FastSymbolSupplierTest, RejectsDamagedFiles) {
+  string contents = ReadFile(fast_symbol_file_);
+  string module_id;
+  const char* data;
+  size_t data_size;
+  ASSERT_TRUE(FastSymbolFile::Parse(contents.data(), contents.size(), true,
+                                    &module_id, &data, &data_size));
+  EXPECT_EQ(kModuleId, module_id);
+
+  // Bad magic.
+  string damaged = contents;
+  damaged[0] = 'X';
+  EXPECT_FALSE(FastSymbolFile::Parse(damaged.data(), damaged.size(), false,
+                                     &module_id, &data, &data_size));
+
+  // A different version.
+  damaged = contents;
+  damaged[offsetof(FastSymbolFileHeader, version)]++;
+  EXPECT_FALSE(FastSymbolFile::Parse(damaged.data(), damaged.size(), false,
+                                     &module_id, &data, &data_size));
+
+  // A damaged section table.
+  damaged = contents;
+  damaged[sizeof(FastSymbolFileHeader) +
+          offsetof(FastSymbolFileSection, size)]++;
+  EXPECT_FALSE(FastSymbolFile::Parse(damaged.data(), damaged.size(), false,
+                                     &module_id, &data, &data_size));
+
+  // Truncated.
+  EXPECT_FALSE(FastSymbolFile::Parse(contents.data(), contents.size() - 1,
+                                     false, &module_id, &data, &data_size));
+  EXPECT_FALSE(FastSymbolFile::Parse(contents.data(), 10, false, &module_id,
+                                     &data, &data_size));
+
+  // Damaged section data is only noticed when sections are verified.
+  damaged = contents;
+  damaged[damaged.size() - 2] ^= 1;
+  EXPECT_TRUE(FastSymbolFile::Parse(damaged.data(), damaged.size(), false,
+                                    &module_id, &data, &data_size));
+  EXPECT_FALSE(FastSymbolFile::Parse(damaged.data(), damaged.size(), true,
+                                     &module_id, &data, &data_size));
+}
+
+TEST_F(FastSymbolSupplierTest, MapsIntoFastResolver) {
+  // The module data is what SerializeSymbolFileData produces.
+  char* symbol_data;
+  size_t symbol_data_size;
+  ASSERT_TRUE(SourceLineResolverBase::ReadSymbolFile(
+      testdata_dir_ + "/module1.out", &symbol_data, &symbol_data_size));
+  string symbol_data_string(symbol_data, symbol_data_size - 1);
+  delete [] symbol_data;
+  size_t serialized_size;
+  scoped_array<char> serialized(serializer_.SerializeSymbolFileData(
+      symbol_data_string, &serialized_size));
+
+  BasicCodeModule module(0x400000, 0x10000, "module1.exe", "",
+                         "C:\\module1.pdb", kModuleId, "");
+  FastSymbolSupplier supplier(temp_dir_.path());
+  supplier.set_verify_checksums(true);
+  string symbol_file;
+  char* data;
+  size_t data_size;
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetCStringSymbolData(&module, NULL, &symbol_file, &data,
+                                          &data_size));
+  EXPECT_EQ(fast_symbol_file_, symbol_file);
+  ASSERT_EQ(serialized_size, data_size);
+  EXPECT_EQ(0, memcmp(serialized.get(), data, data_size));
+
+  string data_string;
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module, NULL, &symbol_file, &data_string));
+  EXPECT_EQ(string(serialized.get(), serialized_size), data_string);
+
+  FastSourceLineResolver resolver;
+  ASSERT_TRUE(resolver.LoadModuleUsingMemoryBuffer(&module, data, data_size));
+  StackFrame frame;
+  frame.module = &module;
+  frame.instruction = 0x401000;
+  resolver.FillSourceLineInfo(&frame, NULL);
+  EXPECT_EQ("Function1_1", frame.function_name);
+  EXPECT_EQ("file1_1.cc", frame.source_file_name);
+  EXPECT_EQ(44, frame.source_line);
+
+  resolver.UnloadModule(&module);
+  supplier.FreeSymbolData(&module);
+}
+
+TEST_F(FastSymbolSupplierTest, RejectsOtherModules) {
+  // A text symbol file isn't picked up.
+  BasicCodeModule module(0x400000, 0x10000, "module1.exe", "",
+                         "module1.pdb", kModuleId, "");
+  FastSymbolSupplier supplier(temp_dir_.path());
+  string symbol_file;
+  char* data;
+  size_t data_size;
+  WriteFile(fast_symbol_file_, ReadFile(testdata_dir_ + "/module1.out"));
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            supplier.GetCStringSymbolData(&module, NULL, &symbol_file, &data,
+                                          &data_size));
+
+  // Nor is a fast symbol file for a different module id.
+  string other_dir = temp_dir_.path() + "/module1.pdb/ABCDEF";
+  ASSERT_EQ(0, mkdir(other_dir.c_str(), 0755));
+  ASSERT_TRUE(serializer_.CompileSymbolFile(
+      testdata_dir_ + "/module1.out",
+      other_dir + "/module1" + kFastSymbolFileExtension));
+  BasicCodeModule other_module(0x400000, 0x10000, "module1.exe", "",
+                               "module1.pdb", "ABCDEF", "");
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            supplier.GetCStringSymbolData(&other_module, NULL, &symbol_file,
+                                          &data, &data_size));
+}
+
+TEST_F(FastSymbolSupplierTest, CompilesIntoSharedCache) {
+  // A text symbol store, and an empty cache.
+  AutoTempDir text_dir;
+  string text_module_dir = text_dir.path() + "/module1.pdb";
+  ASSERT_EQ(0, mkdir(text_module_dir.c_str(), 0755));
+  text_module_dir += string("/") + kModuleId;
+  ASSERT_EQ(0, mkdir(text_module_dir.c_str(), 0755));
+  string text_symbol_file = text_module_dir + "/module1.sym";
+  WriteFile(text_symbol_file, ReadFile(testdata_dir_ + "/module1.out"));
+  AutoTempDir cache_dir;
+  string cached_file = cache_dir.path() + "/module1.pdb/" + kModuleId +
+                       "/module1" + kFastSymbolFileExtension;
+
+  BasicCodeModule module(0x400000, 0x10000, "module1.exe", "",
+                         "module1.pdb", kModuleId, "");
+  string symbol_file;
+  char* data;
+  size_t data_size;
+  {
+    FastSymbolSupplier supplier(cache_dir.path());
+    supplier.set_compile_cache(cache_dir.path(),
+                               std::vector<string>(1, text_dir.path()));
+    ASSERT_EQ(SymbolSupplier::FOUND,
+              supplier.GetCStringSymbolData(&module, NULL, &symbol_file,
+                                            &data, &data_size));
+    EXPECT_EQ(cached_file, symbol_file);
+
+    FastSourceLineResolver resolver;
+    ASSERT_TRUE(resolver.LoadModuleUsingMemoryBuffer(&module, data,
+                                                     data_size));
+    StackFrame frame;
+    frame.module = &module;
+    frame.instruction = 0x401000;
+    resolver.FillSourceLineInfo(&frame, NULL);
+    EXPECT_EQ("Function1_1", frame.function_name);
+    EXPECT_EQ(44, frame.source_line);
+    resolver.UnloadModule(&module);
+    supplier.FreeSymbolData(&module);
+
+    // A module without a text symbol file isn't found.
+    BasicCodeModule other_module(0x400000, 0x10000, "module1.exe", "",
+                                 "module1.pdb", "ABCDEF", "");
+    EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+              supplier.GetCStringSymbolData(&other_module, NULL,
+                                            &symbol_file, &data, &data_size));
+  }
+
+  // Another supplier sharing the cache, as another process would, maps the
+  // compiled file without needing the text symbol file.
+  ASSERT_EQ(0, unlink(text_symbol_file.c_str()));
+  FastSymbolSupplier supplier(cache_dir.path());
+  supplier.set_compile_cache(cache_dir.path(),
+                             std::vector<string>(1, text_dir.path()));
+  supplier.set_verify_checksums(true);
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetCStringSymbolData(&module, NULL, &symbol_file, &data,
+                                          &data_size));
+  EXPECT_EQ(cached_file, symbol_file);
+  supplier.FreeSymbolData(&module);
+}
+
+TEST_F(FastSymbolSupplierTest, CompileSymbolFiles) {
+  // Each file compiled on a thread is the file CompileSymbolFile writes for
+  // it, and a missing symbol file fails without stopping the others.
+  std::vector<string> symbol_files;
+  std::vector<string> fast_symbol_files;
+  for (int i = 0; i < 6; ++i) {
+    char name[32];
+    snprintf(name, sizeof(name), "/module%d", i % 3);
+    symbol_files.push_back(testdata_dir_ + name + ".out");
+    snprintf(name, sizeof(name), "/compiled%d", i);
+    fast_symbol_files.push_back(temp_dir_.path() + name +
+                                kFastSymbolFileExtension);
+  }
+  symbol_files[4] = testdata_dir_ + "/invalid-filename";
+
+  std::vector<bool> failed;
+  EXPECT_EQ(1U, serializer_.CompileSymbolFiles(symbol_files,
+                                               fast_symbol_files, 4, &failed));
+  ASSERT_EQ(symbol_files.size(), failed.size());
+  string expected_file = temp_dir_.path() + "/expected";
+  for (size_t i = 0; i < symbol_files.size(); ++i) {
+    struct stat st;
+    if (i == 4) {
+      EXPECT_TRUE(failed[i]);
+      EXPECT_NE(0, stat(fast_symbol_files[i].c_str(), &st));
+      continue;
+    }
+    EXPECT_FALSE(failed[i]);
+    ASSERT_TRUE(serializer_.CompileSymbolFile(symbol_files[i], expected_file));
+    EXPECT_EQ(ReadFile(expected_file), ReadFile(fast_symbol_files[i]));
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,89 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// flat_address_map-inl.h: FlatAddressMap implementation.
+//
+// See flat_address_map.h for documentation.
+
+#ifndef PROCESSOR_FLAT_ADDRESS_MAP_INL_H__
+#define PROCESSOR_FLAT_ADDRESS_MAP_INL_H__
+
+#include "processor/flat_address_map.h"
+
+#include <assert.h>
+
+#include <algorithm>
+
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+template<typename AddressType, typename EntryType>
+typename FlatAddressMap<AddressType, EntryType>::const_iterator
+FlatAddressMap<AddressType, EntryType>::lower_bound(
+    const AddressType& address) const {
+  return std::lower_bound(
+      entries_.begin(), entries_.end(), address,
+      [](const value_type& entry, const AddressType& address) {
+        return entry.first < address;
+      });
+}
+
+template<typename AddressType, typename EntryType>
+typename FlatAddressMap<AddressType, EntryType>::const_iterator
+FlatAddressMap<AddressType, EntryType>::upper_bound(
+    const AddressType& address) const {
+  return std::upper_bound(
+      entries_.begin(), entries_.end(), address,
+      [](const AddressType& address, const value_type& entry) {
+        return address < entry.first;
+      });
+}
+
+template<typename AddressType, typename EntryType>
+bool FlatAddressMap<AddressType, EntryType>::Retrieve(
+    const AddressType& address,
+    EntryType* entry, AddressType* entry_address) const {
+  BPLOG_IF(ERROR, !entry) << "FlatAddressMap::Retrieve requires |entry|";
+  assert(entry);
+
+  // The entry wanted is the last one at or below |address|.
+  const_iterator iterator = upper_bound(address);
+  if (iterator == entries_.begin())
+    return false;
+  --iterator;
+
+  *entry = iterator->second;
+  if (entry_address)
+    *entry_address = iterator->first;
+  return true;
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_FLAT_ADDRESS_MAP_INL_H__
@@ -0,0 +1,97 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// flat_address_map.h: Sorted-array form of an AddressMap or std::map.
+//
+// FlatAddressMap holds the entries of a complete AddressMap, or of a
+// std::map keyed by address, in one array sorted by address, which takes
+// a fraction of the memory of the map's tree and is searched with a single
+// binary search over contiguous entries.  Retrieve behaves as
+// AddressMap::Retrieve, and the entries can be walked in address order
+// with the same lower_bound and upper_bound as a std::map's.
+//
+// FlatAddressMap cannot be added to.
+
+#ifndef PROCESSOR_FLAT_ADDRESS_MAP_H__
+#define PROCESSOR_FLAT_ADDRESS_MAP_H__
+
+#include <stddef.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "processor/address_map.h"
+
+namespace google_breakpad {
+
+template<typename AddressType, typename EntryType>
+class FlatAddressMap {
+ public:
+  typedef std::pair<AddressType, EntryType> value_type;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+  FlatAddressMap() : entries_() {}
+
+  // Replaces the map with the entries stored in |map|.
+  void Build(const AddressMap<AddressType, EntryType>& map) {
+    Build(map.map_);
+  }
+  void Build(const std::map<AddressType, EntryType>& map) {
+    entries_.assign(map.begin(), map.end());
+  }
+
+  // As AddressMap::Retrieve.
+  bool Retrieve(const AddressType& address,
+                EntryType* entry, AddressType* entry_address) const;
+
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+  // The first entry at or above |address|, and the first above it.
+  const_iterator lower_bound(const AddressType& address) const;
+  const_iterator upper_bound(const AddressType& address) const;
+
+  bool empty() const { return entries_.empty(); }
+  size_t size() const { return entries_.size(); }
+
+  // The memory held by the map's array, not counting anything the entries
+  // point to.
+  size_t ResidentBytes() const {
+    return entries_.capacity() * sizeof(value_type);
+  }
+
+  void Clear() { entries_.clear(); }
+
+ private:
+  // Sorted by address, with no two at the same address.
+  std::vector<value_type> entries_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_FLAT_ADDRESS_MAP_H__
@@ -0,0 +1,127 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// flat_range_map-inl.h: FlatRangeMap implementation.
+//
+// See flat_range_map.h for documentation.
+
+#ifndef PROCESSOR_FLAT_RANGE_MAP_INL_H__
+#define PROCESSOR_FLAT_RANGE_MAP_INL_H__
+
+#include "processor/flat_range_map.h"
+
+#include <assert.h>
+
+#include <algorithm>
+
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+template<typename AddressType, typename EntryType>
+void FlatRangeMap<AddressType, EntryType>::Build(
+    const RangeMap<AddressType, EntryType>& map) {
+  Clear();
+  ranges_.reserve(map.map_.size());
+  entries_.reserve(map.map_.size());
+  typedef typename RangeMap<AddressType, EntryType>::MapConstIterator
+      MapConstIterator;
+  for (MapConstIterator it = map.map_.begin(); it != map.map_.end(); ++it) {
+    Range range;
+    range.base = it->second.base();
+    range.high = it->first;
+    range.delta = it->second.delta();
+    ranges_.push_back(range);
+    entries_.push_back(it->second.entry());
+  }
+}
+
+template<typename AddressType, typename EntryType>
+void FlatRangeMap<AddressType, EntryType>::GetRange(
+    size_t index, EntryType* entry, AddressType* entry_base,
+    AddressType* entry_delta, AddressType* entry_size) const {
+  const Range& range = ranges_[index];
+  *entry = entries_[index];
+  if (entry_base)
+    *entry_base = range.base;
+  if (entry_delta)
+    *entry_delta = range.delta;
+  if (entry_size)
+    *entry_size = range.high - range.base + 1;
+}
+
+template<typename AddressType, typename EntryType>
+bool FlatRangeMap<AddressType, EntryType>::RetrieveRange(
+    const AddressType& address, EntryType* entry, AddressType* entry_base,
+    AddressType* entry_delta, AddressType* entry_size) const {
+  BPLOG_IF(ERROR, !entry) << "FlatRangeMap::RetrieveRange requires |entry|";
+  assert(entry);
+
+  // The first range ending at or above |address| is the only one that can
+  // contain it.
+  typename std::vector<Range>::const_iterator range = std::lower_bound(
+      ranges_.begin(), ranges_.end(), address,
+      [](const Range& range, const AddressType& address) {
+        return range.high < address;
+      });
+  if (range == ranges_.end() || address < range->base)
+    return false;
+  GetRange(range - ranges_.begin(), entry, entry_base, entry_delta,
+           entry_size);
+  return true;
+}
+
+template<typename AddressType, typename EntryType>
+bool FlatRangeMap<AddressType, EntryType>::RetrieveNearestRange(
+    const AddressType& address, EntryType* entry, AddressType* entry_base,
+    AddressType* entry_delta, AddressType* entry_size) const {
+  BPLOG_IF(ERROR, !entry)
+      << "FlatRangeMap::RetrieveNearestRange requires |entry|";
+  assert(entry);
+
+  if (RetrieveRange(address, entry, entry_base, entry_delta, entry_size))
+    return true;
+
+  // Otherwise, the nearest range is the last one ending at or below
+  // |address|.
+  typename std::vector<Range>::const_iterator range = std::upper_bound(
+      ranges_.begin(), ranges_.end(), address,
+      [](const AddressType& address, const Range& range) {
+        return address < range.high;
+      });
+  if (range == ranges_.begin())
+    return false;
+  --range;
+  GetRange(range - ranges_.begin(), entry, entry_base, entry_delta,
+           entry_size);
+  return true;
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_FLAT_RANGE_MAP_INL_H__
@@ -0,0 +1,104 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// flat_range_map.h: Sorted-array form of a RangeMap.
+//
+// A RangeMap keeps its ranges in a std::map, with a heap node per range.
+// Once a RangeMap is complete, a FlatRangeMap built from it lays the same
+// ranges out in one array sorted by high address, which takes a fraction
+// of the memory and is searched with a single binary search over
+// contiguous entries.  Lookups return what the RangeMap's would, including
+// the deltas of ranges the RangeMap shrank to resolve overlaps.
+//
+// FlatRangeMap cannot be added to.
+
+#ifndef PROCESSOR_FLAT_RANGE_MAP_H__
+#define PROCESSOR_FLAT_RANGE_MAP_H__
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "processor/range_map.h"
+
+namespace google_breakpad {
+
+template<typename AddressType, typename EntryType>
+class FlatRangeMap {
+ public:
+  FlatRangeMap() : ranges_(), entries_() {}
+
+  // Replaces the map with the ranges stored in |map|.
+  void Build(const RangeMap<AddressType, EntryType>& map);
+
+  // As RangeMap::RetrieveRange and RangeMap::RetrieveNearestRange.
+  bool RetrieveRange(const AddressType& address, EntryType* entry,
+                     AddressType* entry_base, AddressType* entry_delta,
+                     AddressType* entry_size) const;
+  bool RetrieveNearestRange(const AddressType& address, EntryType* entry,
+                            AddressType* entry_base, AddressType* entry_delta,
+                            AddressType* entry_size) const;
+
+  bool empty() const { return ranges_.empty(); }
+  size_t size() const { return ranges_.size(); }
+
+  // The memory held by the map's arrays, not counting anything the
+  // entries point to.
+  size_t ResidentBytes() const {
+    return ranges_.capacity() * sizeof(Range) +
+           entries_.capacity() * sizeof(EntryType);
+  }
+
+  void Clear() {
+    ranges_.clear();
+    entries_.clear();
+  }
+
+ private:
+  struct Range {
+    AddressType base;
+    // The last address in the range.
+    AddressType high;
+    // How far RangeMap moved the base up when it shrank the range.
+    AddressType delta;
+  };
+
+  // Sets the results of a lookup that found the range at |index|.
+  void GetRange(size_t index, EntryType* entry, AddressType* entry_base,
+                AddressType* entry_delta, AddressType* entry_size) const;
+
+  // Sorted by high address.  Ranges do not overlap, so they are sorted by
+  // base address too.
+  std::vector<Range> ranges_;
+  // The entry of each range, by the same index.
+  std::vector<EntryType> entries_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_FLAT_RANGE_MAP_H__
@@ -0,0 +1,185 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// flat_range_map_unittest.cc: Unit tests for FlatRangeMap and
+// FlatAddressMap, which are checked against the RangeMap, AddressMap and
+// std::map they are built from.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdlib.h>
+
+#include <map>
+
+#include "breakpad_googletest_includes.h"
+#include "processor/address_map-inl.h"
+#include "processor/flat_address_map-inl.h"
+#include "processor/flat_range_map-inl.h"
+#include "processor/range_map-inl.h"
+
+namespace {
+
+using google_breakpad::AddressMap;
+using google_breakpad::FlatAddressMap;
+using google_breakpad::FlatRangeMap;
+using google_breakpad::MergeRangeStrategy;
+using google_breakpad::RangeMap;
+
+typedef RangeMap<unsigned int, int> TestRangeMap;
+typedef FlatRangeMap<unsigned int, int> TestFlatRangeMap;
+typedef AddressMap<unsigned int, int> TestAddressMap;
+typedef FlatAddressMap<unsigned int, int> TestFlatAddressMap;
+
+// Checks that |flat| retrieves the same ranges as |map| for every address
+// below |test_high|.
+void CheckAgainstRangeMap(const TestRangeMap& map,
+                          const TestFlatRangeMap& flat,
+                          unsigned int test_high) {
+  EXPECT_EQ(map.GetCount(), static_cast<int64_t>(flat.size()));
+  for (unsigned int address = 0; address < test_high; ++address) {
+    int entry = -1, flat_entry = -1;
+    unsigned int base = 0, delta = 0, size = 0;
+    unsigned int flat_base = 0, flat_delta = 0, flat_size = 0;
+    bool found = map.RetrieveRange(address, &entry, &base, &delta, &size);
+    EXPECT_EQ(found, flat.RetrieveRange(address, &flat_entry, &flat_base,
+                                        &flat_delta, &flat_size))
+        << "address " << address;
+    if (found) {
+      EXPECT_EQ(entry, flat_entry) << "address " << address;
+      EXPECT_EQ(base, flat_base) << "address " << address;
+      EXPECT_EQ(delta, flat_delta) << "address " << address;
+      EXPECT_EQ(size, flat_size) << "address " << address;
+    }
+
+    found = map.RetrieveNearestRange(address, &entry, &base, &delta, &size);
+    EXPECT_EQ(found, flat.RetrieveNearestRange(address, &flat_entry,
+                                               &flat_base, &flat_delta,
+                                               &flat_size))
+        << "address " << address;
+    if (found) {
+      EXPECT_EQ(entry, flat_entry) << "address " << address;
+      EXPECT_EQ(base, flat_base) << "address " << address;
+      EXPECT_EQ(delta, flat_delta) << "address " << address;
+      EXPECT_EQ(size, flat_size) << "address " << address;
+    }
+  }
+}
+
+TEST(FlatRangeMapTest, Empty) {
+  TestRangeMap map;
+  TestFlatRangeMap flat;
+  flat.Build(map);
+  EXPECT_TRUE(flat.empty());
+  CheckAgainstRangeMap(map, flat, 10);
+}
+
+TEST(FlatRangeMapTest, RandomRanges) {
+  srand(0);
+  const MergeRangeStrategy strategies[] = {
+    MergeRangeStrategy::kExclusiveRanges,
+    MergeRangeStrategy::kTruncateLower,
+    MergeRangeStrategy::kTruncateUpper,
+  };
+  for (int round = 0; round < 12; ++round) {
+    TestRangeMap map;
+    map.SetMergeStrategy(strategies[round % 3]);
+    for (int i = 0; i < 100; ++i) {
+      unsigned int base = rand() % 1000;
+      unsigned int size = 1 + rand() % 20;
+      map.StoreRange(base, size, i);
+    }
+    TestFlatRangeMap flat;
+    flat.Build(map);
+    CheckAgainstRangeMap(map, flat, 1050);
+  }
+}
+
+TEST(FlatRangeMapTest, Rebuild) {
+  TestRangeMap map;
+  map.StoreRange(10, 5, 1);
+  TestFlatRangeMap flat;
+  flat.Build(map);
+  map.Clear();
+  map.StoreRange(20, 5, 2);
+  flat.Build(map);
+  CheckAgainstRangeMap(map, flat, 30);
+}
+
+TEST(FlatAddressMapTest, MatchesAddressMap) {
+  srand(0);
+  TestAddressMap map;
+  std::map<unsigned int, int> std_map;
+  for (int i = 0; i < 100; ++i) {
+    unsigned int address = rand() % 1000;
+    if (map.Store(address, i))
+      std_map[address] = i;
+  }
+  TestFlatAddressMap flat;
+  flat.Build(map);
+  TestFlatAddressMap flat_from_std;
+  flat_from_std.Build(std_map);
+  EXPECT_EQ(std_map.size(), flat.size());
+
+  for (unsigned int address = 0; address < 1050; ++address) {
+    int entry = -1, flat_entry = -1, std_entry = -1;
+    unsigned int entry_address = 0, flat_address = 0, std_address = 0;
+    bool found = map.Retrieve(address, &entry, &entry_address);
+    EXPECT_EQ(found, flat.Retrieve(address, &flat_entry, &flat_address))
+        << "address " << address;
+    EXPECT_EQ(found, flat_from_std.Retrieve(address, &std_entry,
+                                            &std_address))
+        << "address " << address;
+    if (found) {
+      EXPECT_EQ(entry, flat_entry) << "address " << address;
+      EXPECT_EQ(entry_address, flat_address) << "address " << address;
+      EXPECT_EQ(entry, std_entry) << "address " << address;
+      EXPECT_EQ(entry_address, std_address) << "address " << address;
+    }
+
+    // The bounds walk the entries as the std::map's do.
+    EXPECT_EQ(std::distance(std_map.begin(), std_map.lower_bound(address)),
+              flat.lower_bound(address) - flat.begin())
+        << "address " << address;
+    EXPECT_EQ(std::distance(std_map.begin(), std_map.upper_bound(address)),
+              flat.upper_bound(address) - flat.begin())
+        << "address " << address;
+  }
+}
+
+TEST(FlatAddressMapTest, Empty) {
+  TestFlatAddressMap flat;
+  flat.Build(std::map<unsigned int, int>());
+  int entry;
+  EXPECT_TRUE(flat.empty());
+  EXPECT_FALSE(flat.Retrieve(5, &entry, NULL));
+  EXPECT_TRUE(flat.lower_bound(5) == flat.end());
+}
+
+}  // namespace
@@ -0,0 +1,242 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// growing_stream_buffer.cc: A stream buffer over data that is still
+// arriving.
+//
+// See growing_stream_buffer.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/growing_stream_buffer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+
+namespace google_breakpad {
+
+namespace {
+
+// How often a followed file is checked for new bytes while a read waits.
+const int kPollMilliseconds = 10;
+
+}  // namespace
+
+GrowingStreamBuffer::GrowingStreamBuffer()
+    : size_(0),
+      finished_(false),
+      fd_(-1),
+      timeout_milliseconds_(-1),
+      position_(0) {
+}
+
+GrowingStreamBuffer::~GrowingStreamBuffer() {
+#ifndef _WIN32
+  if (fd_ != -1)
+    close(fd_);
+#endif
+}
+
+void GrowingStreamBuffer::Append(const void* data, size_t size) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AppendLocked(static_cast<const char*>(data), size);
+  }
+  arrived_.notify_all();
+}
+
+void GrowingStreamBuffer::Finish() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_ = true;
+  }
+  arrived_.notify_all();
+}
+
+bool GrowingStreamBuffer::FollowFile(const string& path) {
+#ifdef _WIN32
+  return false;
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fd_ != -1)
+    close(fd_);
+  fd_ = fd;
+  return true;
+#endif
+}
+
+uint64_t GrowingStreamBuffer::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+void GrowingStreamBuffer::AppendLocked(const char* data, size_t size) {
+  while (size > 0) {
+    size_t offset = size_ % kChunkSize;
+    if (offset == 0 && size_ / kChunkSize == chunks_.size())
+      chunks_.emplace_back(new char[kChunkSize]);
+    size_t count = std::min(size, kChunkSize - offset);
+    memcpy(chunks_.back().get() + offset, data, count);
+    data += count;
+    size -= count;
+    size_ += count;
+  }
+}
+
+bool GrowingStreamBuffer::ReadFile() {
+#ifdef _WIN32
+  return false;
+#else
+  const uint64_t old_size = size_;
+  for (;;) {
+    size_t offset = size_ % kChunkSize;
+    if (offset == 0 && size_ / kChunkSize == chunks_.size())
+      chunks_.emplace_back(new char[kChunkSize]);
+    ssize_t count = pread(fd_, chunks_.back().get() + offset,
+                          kChunkSize - offset, size_);
+    if (count == -1 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      break;
+    size_ += count;
+  }
+  return size_ != old_size;
+#endif
+}
+
+bool GrowingStreamBuffer::WaitFor(uint64_t end) {
+  typedef std::chrono::steady_clock Clock;
+  const std::chrono::milliseconds timeout(timeout_milliseconds_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  Clock::time_point deadline = Clock::now() + timeout;
+  while (size_ < end) {
+    if (finished_)
+      return false;
+    if (fd_ != -1 && ReadFile()) {
+      // The file is still being written; wait as long again for more.
+      deadline = Clock::now() + timeout;
+      continue;
+    }
+    if (timeout_milliseconds_ >= 0 && Clock::now() >= deadline) {
+      // A file that stopped growing is complete.  Appended data may still
+      // arrive, but this read has waited long enough.
+      if (fd_ != -1)
+        finished_ = true;
+      return false;
+    }
+    if (fd_ != -1) {
+      Clock::time_point poll =
+          Clock::now() + std::chrono::milliseconds(kPollMilliseconds);
+      arrived_.wait_until(lock, timeout_milliseconds_ >= 0
+                                    ? std::min(poll, deadline) : poll);
+    } else if (timeout_milliseconds_ >= 0) {
+      arrived_.wait_until(lock, deadline);
+    } else {
+      arrived_.wait(lock);
+    }
+  }
+  return true;
+}
+
+void GrowingStreamBuffer::SetPosition(uint64_t position) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (position < size_) {
+    uint64_t start = position - position % kChunkSize;
+    uint64_t end = std::min<uint64_t>(start + kChunkSize, size_);
+    char* chunk = chunks_[position / kChunkSize].get();
+    setg(chunk, chunk + (position - start), chunk + (end - start));
+    position_ = start;
+  } else {
+    setg(NULL, NULL, NULL);
+    position_ = position;
+  }
+}
+
+GrowingStreamBuffer::int_type GrowingStreamBuffer::underflow() {
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+  uint64_t position = position_;
+  if (eback())
+    position += egptr() - eback();
+  if (!WaitFor(position + 1)) {
+    position_ = position;
+    setg(NULL, NULL, NULL);
+    return traits_type::eof();
+  }
+  SetPosition(position);
+  return traits_type::to_int_type(*gptr());
+}
+
+GrowingStreamBuffer::pos_type GrowingStreamBuffer::seekoff(
+    off_type offset, std::ios_base::seekdir direction,
+    std::ios_base::openmode mode) {
+  uint64_t base = position_;
+  if (direction == std::ios_base::cur) {
+    if (eback())
+      base += gptr() - eback();
+  } else if (direction == std::ios_base::end) {
+    // The end is only known once all of the data has arrived.
+    WaitFor(UINT64_MAX);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!finished_)
+      return pos_type(off_type(-1));
+    base = size_;
+  } else {
+    base = 0;
+  }
+  if (offset < 0 && static_cast<uint64_t>(-offset) > base)
+    return pos_type(off_type(-1));
+  return seekpos(pos_type(off_type(base + offset)), mode);
+}
+
+GrowingStreamBuffer::pos_type GrowingStreamBuffer::seekpos(
+    pos_type position, std::ios_base::openmode mode) {
+  // Like seeking in a file, seeking to the end of the data is allowed but
+  // seeking past it is not; the bytes before the target must arrive.
+  if (!(mode & std::ios_base::in) || off_type(position) < 0 ||
+      !WaitFor(off_type(position))) {
+    return pos_type(off_type(-1));
+  }
+  SetPosition(off_type(position));
+  return position;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,146 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// growing_stream_buffer.h: A stream buffer over data that is still
+// arriving, so that a minidump can be read while it is being uploaded or
+// written.
+//
+// A minidump's header, stream directory, and the streams a processor needs
+// first are normally near its start.  Reading a Minidump through this
+// buffer lets those be parsed, and the minidump processed, as soon as
+// their bytes have arrived; a read of bytes that have not yet arrived
+// waits for them, up to a timeout.
+
+#ifndef PROCESSOR_GROWING_STREAM_BUFFER_H__
+#define PROCESSOR_GROWING_STREAM_BUFFER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+// Data is either appended to the buffer, from any thread, or read from a
+// file that is still being written.  For example, while an upload arrives:
+//
+//   GrowingStreamBuffer buffer;
+//   std::istream stream(&buffer);
+//   Minidump dump(stream);
+//   // On the network thread, for each chunk and then at the end:
+//   buffer.Append(chunk, chunk_size);
+//   buffer.Finish();
+//   // Meanwhile, on the processing thread:
+//   if (dump.Read())
+//     processor.Process(&dump, &process_state);
+//
+// Only one thread may read from the buffer.
+class GrowingStreamBuffer : public std::streambuf {
+ public:
+  GrowingStreamBuffer();
+  ~GrowingStreamBuffer();
+
+  // Add SIZE bytes at DATA to the end of the data.
+  void Append(const void* data, size_t size);
+
+  // Mark the data complete.  Reads past its end then fail at once.
+  void Finish();
+
+  // Take the data from the file at PATH, which may still be growing.
+  // Bytes are read from the file as reads need them; the data is complete
+  // once Finish is called or, when the timeout is not negative, once the
+  // file has not grown for that long.  Return false if the file cannot be
+  // opened.
+  bool FollowFile(const string& path);
+
+  // How long a read waits for bytes that have not arrived before failing.
+  // Zero fails at once, and a negative timeout waits until Finish.  The
+  // default is to wait until Finish.
+  void set_timeout_milliseconds(int milliseconds) {
+    timeout_milliseconds_ = milliseconds;
+  }
+
+  // The number of bytes that have arrived.
+  uint64_t size();
+
+ protected:
+  int_type underflow();
+  pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+                   std::ios_base::openmode mode);
+  pos_type seekpos(pos_type position, std::ios_base::openmode mode);
+
+ private:
+  // The data is kept in chunks of this size, which stay where they are
+  // as more arrive.
+  static const size_t kChunkSize = 1 << 16;
+
+  // Append SIZE bytes at DATA.  mutex_ must be held.
+  void AppendLocked(const char* data, size_t size);
+
+  // Read what the followed file has gained since it was last read.
+  // Return true if it grew.  mutex_ must be held.
+  bool ReadFile();
+
+  // Wait until the bytes before END have arrived, or the data is complete.
+  // Return false if they did not arrive.
+  bool WaitFor(uint64_t end);
+
+  // Make POSITION the next character read, with the get area covering the
+  // bytes from there to the end of its chunk that have arrived.
+  void SetPosition(uint64_t position);
+
+  std::mutex mutex_;
+  std::condition_variable arrived_;
+  std::vector<std::unique_ptr<char[]> > chunks_;
+  uint64_t size_;
+  bool finished_;
+
+  // The followed file, or -1.
+  int fd_;
+
+  int timeout_milliseconds_;
+
+  // The position of eback(), or the position to read from next while the
+  // get area is empty.
+  uint64_t position_;
+
+  GrowingStreamBuffer(const GrowingStreamBuffer&);
+  void operator=(const GrowingStreamBuffer&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_GROWING_STREAM_BUFFER_H__
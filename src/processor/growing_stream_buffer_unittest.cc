@@ -0,0 +1,210 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// growing_stream_buffer_unittest.cc: Unit tests for GrowingStreamBuffer.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/minidump.h"
+#include "processor/growing_stream_buffer.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::GrowingStreamBuffer;
+using google_breakpad::Minidump;
+using google_breakpad::MinidumpThreadList;
+using std::vector;
+
+string MinidumpPath() {
+  return string(getenv("srcdir") ? getenv("srcdir") : ".") +
+         "/src/processor/testdata/minidump2.dmp";
+}
+
+vector<char> ReadMinidump() {
+  std::ifstream file(MinidumpPath().c_str(), std::ios::binary);
+  return vector<char>(std::istreambuf_iterator<char>(file),
+                      std::istreambuf_iterator<char>());
+}
+
+// Data that spans several chunks, each byte different from its neighbors.
+vector<char> MakeData(size_t size) {
+  vector<char> data(size);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<char>(i * 7 + i / 251);
+  return data;
+}
+
+TEST(GrowingStreamBufferTest, ReadsAndSeeksAppendedData) {
+  vector<char> data = MakeData(200000);
+  GrowingStreamBuffer buffer;
+  std::istream stream(&buffer);
+  buffer.Append(&data[0], 1000);
+  buffer.Append(&data[1000], data.size() - 1000);
+  buffer.Finish();
+  EXPECT_EQ(data.size(), buffer.size());
+
+  vector<char> read(data.size());
+  ASSERT_TRUE(stream.read(&read[0], read.size()));
+  EXPECT_TRUE(read == data);
+  EXPECT_EQ(EOF, stream.get());
+
+  // Reads crossing chunk boundaries, after seeks in either direction.
+  const size_t kOffsets[] = { 65530, 10, 131000, 199990 };
+  for (size_t offset : kOffsets) {
+    stream.clear();
+    ASSERT_TRUE(stream.seekg(offset));
+    char bytes[10];
+    ASSERT_TRUE(stream.read(bytes, sizeof(bytes)));
+    EXPECT_TRUE(std::equal(bytes, bytes + sizeof(bytes), &data[offset]));
+    EXPECT_EQ(static_cast<std::streamoff>(offset + sizeof(bytes)),
+              stream.tellg());
+  }
+
+  stream.clear();
+  EXPECT_EQ(static_cast<std::streamoff>(data.size()),
+            stream.seekg(0, std::ios::end).tellg());
+  EXPECT_FALSE(stream.seekg(data.size() + 1));
+}
+
+TEST(GrowingStreamBufferTest, FailsFastOnBytesNotYetArrived) {
+  vector<char> data = MakeData(100);
+  GrowingStreamBuffer buffer;
+  buffer.set_timeout_milliseconds(0);
+  std::istream stream(&buffer);
+  buffer.Append(&data[0], 50);
+
+  char bytes[60];
+  EXPECT_FALSE(stream.read(bytes, sizeof(bytes)));
+  stream.clear();
+  EXPECT_FALSE(stream.seekg(80));
+  stream.clear();
+  // The end is not known until the data is complete.
+  EXPECT_FALSE(stream.seekg(0, std::ios::end));
+
+  // Once the rest arrives, the same reads succeed.
+  buffer.Append(&data[50], 50);
+  stream.clear();
+  ASSERT_TRUE(stream.seekg(0));
+  ASSERT_TRUE(stream.read(bytes, sizeof(bytes)));
+  EXPECT_TRUE(std::equal(bytes, bytes + sizeof(bytes), &data[0]));
+  ASSERT_TRUE(stream.seekg(80));
+}
+
+TEST(GrowingStreamBufferTest, ReadsMinidumpWhileItArrives) {
+  vector<char> contents = ReadMinidump();
+  ASSERT_FALSE(contents.empty());
+
+  GrowingStreamBuffer buffer;
+  std::istream stream(&buffer);
+  std::thread upload([&buffer, &contents]() {
+    for (size_t offset = 0; offset < contents.size(); offset += 4096) {
+      buffer.Append(&contents[offset],
+                    std::min<size_t>(4096, contents.size() - offset));
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    buffer.Finish();
+  });
+
+  Minidump dump(stream);
+  bool read = dump.Read();
+  MinidumpThreadList* thread_list = read ? dump.GetThreadList() : NULL;
+  upload.join();
+  ASSERT_TRUE(read);
+  ASSERT_TRUE(thread_list);
+
+  Minidump complete(MinidumpPath());
+  ASSERT_TRUE(complete.Read());
+  EXPECT_EQ(complete.GetThreadList()->thread_count(),
+            thread_list->thread_count());
+  ASSERT_TRUE(dump.GetException());
+  EXPECT_EQ(complete.GetException()->exception()->exception_record
+                .exception_code,
+            dump.GetException()->exception()->exception_record
+                .exception_code);
+}
+
+TEST(GrowingStreamBufferTest, FollowsGrowingFile) {
+  vector<char> contents = ReadMinidump();
+  ASSERT_FALSE(contents.empty());
+
+  AutoTempDir temp_dir;
+  string path = temp_dir.path() + "/growing.dmp";
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_TRUE(file);
+  const size_t kHalf = contents.size() / 2;
+  ASSERT_EQ(kHalf, fwrite(&contents[0], 1, kHalf, file));
+  fflush(file);
+
+  GrowingStreamBuffer buffer;
+  ASSERT_TRUE(buffer.FollowFile(path));
+  buffer.set_timeout_milliseconds(5000);
+  std::istream stream(&buffer);
+  std::thread writer([file, &contents, kHalf]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    fwrite(&contents[kHalf], 1, contents.size() - kHalf, file);
+    fclose(file);
+  });
+
+  vector<char> read(contents.size());
+  bool complete = static_cast<bool>(stream.read(&read[0], read.size()));
+  writer.join();
+  ASSERT_TRUE(complete);
+  EXPECT_TRUE(read == contents);
+
+  // The file stops growing, so it is complete once the timeout passes.
+  buffer.set_timeout_milliseconds(10);
+  EXPECT_EQ(EOF, stream.get());
+  stream.clear();
+  EXPECT_EQ(static_cast<std::streamoff>(contents.size()),
+            stream.seekg(0, std::ios::end).tellg());
+}
+
+TEST(GrowingStreamBufferTest, FollowFileFailsForMissingFile) {
+  GrowingStreamBuffer buffer;
+  EXPECT_FALSE(buffer.FollowFile("/nonexistent/minidump.dmp"));
+}
+
+}  // namespace
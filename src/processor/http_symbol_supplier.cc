@@ -0,0 +1,460 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// http_symbol_supplier.cc: A SymbolSupplier that downloads symbol files from
+// HTTP symbol servers into a local cache.
+//
+// See http_symbol_supplier.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/http_symbol_supplier.h"
+
+#include <assert.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include "common/linux/libcurl_wrapper.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The suffix of the file recording that no server has a symbol file.
+const char kNotFoundSuffix[] = ".notfound";
+
+// Downloads are written to "<symbol file>.download.XXXXXX" and renamed.
+const char kDownloadInfix[] = ".download.";
+
+const time_t kDefaultNegativeCacheSeconds = 24 * 60 * 60;
+const int kDefaultMaxConcurrentDownloads = 8;
+
+struct CacheFile {
+  time_t mtime;
+  uint64_t size;
+  string path;
+
+  bool operator<(const CacheFile& other) const {
+    return mtime < other.mtime;
+  }
+};
+
+bool EndsWith(const string& s, const string& suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Creates |path| and any missing parent directories.
+bool MakeDirectories(const string& path) {
+  for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+    string prefix = path.substr(0, slash);
+    if (mkdir(prefix.c_str(), 0777) != 0 && errno != EEXIST) {
+      BPLOG(ERROR) << "Can't create directory " << prefix << ": " <<
+                      strerror(errno);
+      return false;
+    }
+    if (slash == string::npos)
+      return true;
+  }
+}
+
+string DirName(const string& path) {
+  size_t slash = path.rfind('/');
+  return slash == string::npos ? string(".") : path.substr(0, slash);
+}
+
+// Appends every symbol file under |directory| to |files|.
+void CollectCacheFiles(const string& directory, vector<CacheFile>* files) {
+  DIR* dir = opendir(directory.c_str());
+  if (!dir)
+    return;
+  while (struct dirent* entry = readdir(dir)) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+      continue;
+    string path = directory + "/" + entry->d_name;
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0)
+      continue;
+    if (S_ISDIR(st.st_mode)) {
+      CollectCacheFiles(path, files);
+    } else if (S_ISREG(st.st_mode) && !EndsWith(path, kNotFoundSuffix) &&
+               path.find(kDownloadInfix) == string::npos) {
+      CacheFile file = { st.st_mtime, static_cast<uint64_t>(st.st_size),
+                         path };
+      files->push_back(file);
+    }
+  }
+  closedir(dir);
+}
+
+}  // namespace
+
+HTTPSymbolSupplier::HTTPSymbolSupplier(const vector<string>& server_urls,
+                                       const string& cache_path)
+    : SimpleSymbolSupplier(cache_path),
+      server_urls_(server_urls),
+      cache_path_(cache_path),
+      max_cache_bytes_(0),
+      negative_cache_seconds_(kDefaultNegativeCacheSeconds),
+      max_concurrent_downloads_(kDefaultMaxConcurrentDownloads),
+      accept_compressed_(true),
+      cache_bytes_(0),
+      stopping_(false) {
+  for (size_t i = 0; i < server_urls_.size(); ++i) {
+    while (EndsWith(server_urls_[i], "/"))
+      server_urls_[i].erase(server_urls_[i].size() - 1);
+  }
+  MakeDirectories(cache_path_);
+}
+
+HTTPSymbolSupplier::~HTTPSymbolSupplier() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stopping_ = true;
+  }
+  queue_ready_.notify_all();
+  for (size_t i = 0; i < download_threads_.size(); ++i)
+    download_threads_[i].join();
+
+  // Requests still queued are answered, so that no caller waits forever.
+  for (size_t i = 0; i < queue_.size(); ++i)
+    queue_[i]();
+
+  for (size_t i = 0; i < all_curls_.size(); ++i)
+    delete all_curls_[i];
+}
+
+void HTTPSymbolSupplier::set_max_cache_bytes(uint64_t max_cache_bytes) {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  max_cache_bytes_ = max_cache_bytes;
+  if (max_cache_bytes_) {
+    // Only a bounded cache needs to know its size.
+    ScanCache();
+    EvictLocked(0, string());
+  }
+}
+
+SymbolSupplier::SymbolResult HTTPSymbolSupplier::GetSymbolFile(
+    const CodeModule* module, const SystemInfo* system_info,
+    string* symbol_file) {
+  BPLOG_IF(ERROR, !symbol_file) << "HTTPSymbolSupplier::GetSymbolFile "
+                                   "requires |symbol_file|";
+  assert(symbol_file);
+  symbol_file->clear();
+
+  string relative_path;
+  if (!GetRelativeSymbolFilePath(module, &relative_path))
+    return NOT_FOUND;
+  string cache_file = cache_path_ + "/" + relative_path;
+
+  // Touching a cached file keeps it from being evicted soon.
+  if (utimensat(AT_FDCWD, cache_file.c_str(), NULL, 0) == 0) {
+    *symbol_file = cache_file;
+    return FOUND;
+  }
+
+  struct stat st;
+  string not_found_file = cache_file + kNotFoundSuffix;
+  if (negative_cache_seconds_ > 0 &&
+      stat(not_found_file.c_str(), &st) == 0 &&
+      time(NULL) - st.st_mtime < negative_cache_seconds_) {
+    BPLOG(INFO) << "No server has " << relative_path << " (cached)";
+    return NOT_FOUND;
+  }
+
+  SymbolResult result = Download(relative_path, cache_file);
+  if (result == FOUND)
+    *symbol_file = cache_file;
+  return result;
+}
+
+SymbolSupplier::SymbolResult HTTPSymbolSupplier::GetSymbolFile(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    string* symbol_file,
+    string* symbol_data) {
+  assert(symbol_data);
+  symbol_data->clear();
+
+  SymbolResult result = GetSymbolFile(module, system_info, symbol_file);
+  if (result != FOUND)
+    return result;
+
+  // Another thread may evict the file before it is read.
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  std::ifstream in(symbol_file->c_str());
+  if (!in) {
+    BPLOG(INFO) << "Symbol file " << *symbol_file << " left the cache";
+    return NOT_FOUND;
+  }
+  std::getline(in, *symbol_data, string::traits_type::to_char_type(
+                   string::traits_type::eof()));
+  return FOUND;
+}
+
+SymbolSupplier::SymbolResult HTTPSymbolSupplier::GetCStringSymbolData(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    string* symbol_file,
+    char** symbol_data,
+    size_t* symbol_data_size) {
+  // Download first, so that concurrent requests do not wait on each other.
+  SymbolResult result = GetSymbolFile(module, system_info, symbol_file);
+  if (result != FOUND)
+    return result;
+
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  return SimpleSymbolSupplier::GetCStringSymbolData(
+      module, system_info, symbol_file, symbol_data, symbol_data_size);
+}
+
+void HTTPSymbolSupplier::FreeSymbolData(const CodeModule* module) {
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  SimpleSymbolSupplier::FreeSymbolData(module);
+}
+
+void HTTPSymbolSupplier::GetCStringSymbolDataAsync(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    SymbolDataCallback callback) {
+  std::function<void()> request = [this, module, system_info, callback]() {
+    string symbol_file;
+    char* symbol_data = NULL;
+    size_t symbol_data_size = 0;
+    SymbolResult result = GetCStringSymbolData(module, system_info,
+                                               &symbol_file, &symbol_data,
+                                               &symbol_data_size);
+    callback(result, symbol_file, symbol_data, symbol_data_size);
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (!stopping_) {
+      queue_.push_back(request);
+      if (download_threads_.size() < queue_.size() &&
+          download_threads_.size() <
+              static_cast<size_t>(std::max(max_concurrent_downloads_, 1))) {
+        download_threads_.push_back(
+            std::thread(&HTTPSymbolSupplier::DownloadThread, this));
+      }
+      request = NULL;
+    }
+  }
+  if (request) {
+    request();
+    return;
+  }
+  queue_ready_.notify_one();
+}
+
+bool HTTPSymbolSupplier::FetchURL(const string& url,
+                                  long* http_status_code,
+                                  string* body) {
+  LibcurlWrapper* curl = AcquireCurl();
+  if (!curl)
+    return false;
+  bool ok = curl->SendGetRequest(url, http_status_code, NULL, body);
+  ReleaseCurl(curl);
+  return ok;
+}
+
+SymbolSupplier::SymbolResult HTTPSymbolSupplier::Download(
+    const string& relative_path,
+    const string& cache_file) {
+  bool all_not_found = !server_urls_.empty();
+  for (size_t i = 0; i < server_urls_.size(); ++i) {
+    string url = server_urls_[i] + "/" + relative_path;
+    long http_status_code = 0;
+    string body;
+    if (!FetchURL(url, &http_status_code, &body)) {
+      BPLOG(ERROR) << "Can't fetch " << url;
+      all_not_found = false;
+      continue;
+    }
+    if (http_status_code == 200) {
+      BPLOG(INFO) << "Fetched " << url << " (" << body.size() << " bytes)";
+      return StoreInCache(cache_file, body) ? FOUND : NOT_FOUND;
+    }
+    if (http_status_code != 404) {
+      BPLOG(ERROR) << "Fetching " << url << " failed with HTTP status " <<
+                      http_status_code;
+      all_not_found = false;
+    }
+  }
+
+  // Only remember modules that servers definitely lack; a server that was
+  // unreachable may have the file next time.
+  if (all_not_found && negative_cache_seconds_ > 0 &&
+      MakeDirectories(DirName(cache_file))) {
+    string not_found_file = cache_file + kNotFoundSuffix;
+    int fd = open(not_found_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd >= 0)
+      close(fd);
+    utimensat(AT_FDCWD, not_found_file.c_str(), NULL, 0);
+  }
+  BPLOG(INFO) << "No server has " << relative_path;
+  return NOT_FOUND;
+}
+
+bool HTTPSymbolSupplier::StoreInCache(const string& path, const string& data) {
+  if (!MakeDirectories(DirName(path)))
+    return false;
+
+  string temp_path = path + kDownloadInfix + "XXXXXX";
+  int fd = mkstemp(&temp_path[0]);
+  if (fd < 0) {
+    BPLOG(ERROR) << "Can't create " << temp_path << ": " << strerror(errno);
+    return false;
+  }
+  fchmod(fd, 0644);
+  const char* next = data.data();
+  size_t remaining = data.size();
+  while (remaining > 0) {
+    ssize_t written = write(fd, next, remaining);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0) {
+      BPLOG(ERROR) << "Can't write " << temp_path << ": " << strerror(errno);
+      close(fd);
+      unlink(temp_path.c_str());
+      return false;
+    }
+    next += written;
+    remaining -= written;
+  }
+  close(fd);
+
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  if (max_cache_bytes_)
+    EvictLocked(data.size(), path);
+
+  // Another thread may have fetched the same file meanwhile.
+  struct stat st;
+  if (stat(path.c_str(), &st) == 0)
+    cache_bytes_ -= std::min(cache_bytes_, static_cast<uint64_t>(st.st_size));
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    BPLOG(ERROR) << "Can't rename " << temp_path << " to " << path << ": " <<
+                    strerror(errno);
+    unlink(temp_path.c_str());
+    return false;
+  }
+  cache_bytes_ += data.size();
+  unlink((path + kNotFoundSuffix).c_str());
+  return true;
+}
+
+void HTTPSymbolSupplier::EvictLocked(uint64_t reserve, const string& keep) {
+  if (cache_bytes_ + reserve <= max_cache_bytes_)
+    return;
+
+  vector<CacheFile> files;
+  CollectCacheFiles(cache_path_, &files);
+  std::sort(files.begin(), files.end());
+
+  // The directory may have changed under us, so start from what is there.
+  cache_bytes_ = 0;
+  for (size_t i = 0; i < files.size(); ++i)
+    cache_bytes_ += files[i].size;
+
+  for (size_t i = 0;
+       i < files.size() && cache_bytes_ + reserve > max_cache_bytes_; ++i) {
+    if (files[i].path == keep)
+      continue;
+    if (unlink(files[i].path.c_str()) == 0) {
+      BPLOG(INFO) << "Evicted " << files[i].path << " from the symbol cache";
+      cache_bytes_ -= files[i].size;
+    }
+  }
+}
+
+void HTTPSymbolSupplier::ScanCache() {
+  vector<CacheFile> files;
+  CollectCacheFiles(cache_path_, &files);
+  cache_bytes_ = 0;
+  for (size_t i = 0; i < files.size(); ++i)
+    cache_bytes_ += files[i].size;
+}
+
+LibcurlWrapper* HTTPSymbolSupplier::AcquireCurl() {
+  std::lock_guard<std::mutex> lock(curl_mutex_);
+  if (!curl_pool_.empty()) {
+    LibcurlWrapper* curl = curl_pool_.back();
+    curl_pool_.pop_back();
+    return curl;
+  }
+
+  // Initialization touches libcurl's global state, so it happens under the
+  // lock.
+  LibcurlWrapper* curl = new LibcurlWrapper();
+  if (!curl->Init()) {
+    BPLOG(ERROR) << "Can't load libcurl";
+    delete curl;
+    return NULL;
+  }
+  curl->set_accept_compressed(accept_compressed_);
+  curl->set_follow_redirects(true);
+  all_curls_.push_back(curl);
+  return curl;
+}
+
+void HTTPSymbolSupplier::ReleaseCurl(LibcurlWrapper* curl) {
+  std::lock_guard<std::mutex> lock(curl_mutex_);
+  curl_pool_.push_back(curl);
+}
+
+void HTTPSymbolSupplier::DownloadThread() {
+  for (;;) {
+    std::function<void()> request;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_ready_.wait(lock, [this]() {
+        return stopping_ || !queue_.empty();
+      });
+      if (stopping_)
+        return;
+      request = queue_.front();
+      queue_.pop_front();
+    }
+    request();
+  }
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,200 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// http_symbol_supplier.h: A SymbolSupplier that downloads symbol files from
+// HTTP symbol servers into a local cache.
+//
+// HTTPSymbolSupplier looks for each symbol file at the same relative path
+// SimpleSymbolSupplier uses, first under a local cache directory and then
+// under each server URL in turn:
+//
+//   <server>/test_app.pdb/63FE4780728D49379B9D7BB6460CB42A1/test_app.sym
+//
+// Downloaded files are stored in the cache at that path, so the cache is
+// itself a tree SimpleSymbolSupplier can read.  The cache may be bounded in
+// size, in which case the least recently used files are removed to make
+// room.  A module that every server answers with 404 is remembered with a
+// ".notfound" marker next to where its symbol file would be, and is not
+// requested again until the marker expires.
+//
+// GetCStringSymbolDataAsync queues downloads on a pool of worker threads,
+// so that a prefetch has several requests in flight at once.  All other
+// methods may be called from any thread.  Downloads use LibcurlWrapper,
+// which loads libcurl at runtime.
+
+#ifndef PROCESSOR_HTTP_SYMBOL_SUPPLIER_H__
+#define PROCESSOR_HTTP_SYMBOL_SUPPLIER_H__
+
+#include <stdint.h>
+#include <time.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace google_breakpad {
+
+class LibcurlWrapper;
+
+class HTTPSymbolSupplier : public SimpleSymbolSupplier {
+ public:
+  // Creates a supplier that tries each of |server_urls|, in order, for
+  // symbol files missing from |cache_path|.  |cache_path| is created if it
+  // does not exist.
+  HTTPSymbolSupplier(const vector<string>& server_urls,
+                     const string& cache_path);
+  virtual ~HTTPSymbolSupplier();
+
+  // Returns the path of |module|'s symbol file in the cache, downloading it
+  // first if necessary.  Returns NOT_FOUND if no server has the file or
+  // none could be reached; only the former is remembered.
+  virtual SymbolResult GetSymbolFile(const CodeModule* module,
+                                     const SystemInfo* system_info,
+                                     string* symbol_file);
+
+  // Same as above, but also reads the symbol file into |symbol_data|.
+  virtual SymbolResult GetSymbolFile(const CodeModule* module,
+                                     const SystemInfo* system_info,
+                                     string* symbol_file,
+                                     string* symbol_data);
+
+  virtual SymbolResult GetCStringSymbolData(const CodeModule* module,
+                                            const SystemInfo* system_info,
+                                            string* symbol_file,
+                                            char** symbol_data,
+                                            size_t* symbol_data_size);
+
+  virtual void FreeSymbolData(const CodeModule* module);
+
+  // Runs GetCStringSymbolData on one of the download threads.
+  virtual void GetCStringSymbolDataAsync(const CodeModule* module,
+                                         const SystemInfo* system_info,
+                                         SymbolDataCallback callback);
+
+  // Bounds the total size of the symbol files in the cache.  0, the
+  // default, leaves it unbounded.
+  void set_max_cache_bytes(uint64_t max_cache_bytes);
+
+  // Sets how long a module that no server has is remembered.  Defaults to
+  // one day; 0 disables negative caching.
+  void set_negative_cache_seconds(time_t seconds) {
+    negative_cache_seconds_ = seconds;
+  }
+
+  // Sets the number of download threads used by GetCStringSymbolDataAsync.
+  // Defaults to 8.  Only takes effect before the first asynchronous
+  // request.
+  void set_max_concurrent_downloads(int max_concurrent_downloads) {
+    max_concurrent_downloads_ = max_concurrent_downloads;
+  }
+
+  // Sets whether servers may compress their responses.  Defaults to true.
+  void set_accept_compressed(bool accept_compressed) {
+    accept_compressed_ = accept_compressed;
+  }
+
+ protected:
+  // Fetches |url| into |body|, setting |http_status_code|.  Returns false
+  // if no HTTP response was received.  Called from any thread.  Tests
+  // override this to serve files without a network.
+  virtual bool FetchURL(const string& url,
+                        long* http_status_code,
+                        string* body);
+
+ private:
+  // Downloads |relative_path| from the first server that has it into
+  // |cache_file|.  Returns NOT_FOUND if no server had it, recording that
+  // when every server answered 404.
+  SymbolResult Download(const string& relative_path,
+                        const string& cache_file);
+
+  // Writes |data| to |path| through a temporary file, so readers never see
+  // a partial file, and accounts for it in the cache size.
+  bool StoreInCache(const string& path, const string& data);
+
+  // Removes the least recently used symbol files until the cache holds at
+  // most max_cache_bytes_ minus |reserve| bytes, never removing |keep|.
+  // The caller must hold cache_mutex_.
+  void EvictLocked(uint64_t reserve, const string& keep);
+
+  // Sums the sizes of the symbol files already in the cache.
+  void ScanCache();
+
+  // Takes a LibcurlWrapper from the idle pool, creating one if none is
+  // idle, and returns it.  Returns NULL if libcurl cannot be loaded.
+  LibcurlWrapper* AcquireCurl();
+  void ReleaseCurl(LibcurlWrapper* curl);
+
+  // Runs queued requests until the supplier is destroyed.
+  void DownloadThread();
+
+  vector<string> server_urls_;
+  string cache_path_;
+  uint64_t max_cache_bytes_;
+  time_t negative_cache_seconds_;
+  int max_concurrent_downloads_;
+  bool accept_compressed_;
+
+  // Guards cache_bytes_ and the files in the cache while they are evicted
+  // or read back.
+  std::mutex cache_mutex_;
+  uint64_t cache_bytes_;
+
+  // Guards the buffers handed out by GetCStringSymbolData, which
+  // SimpleSymbolSupplier keeps.
+  std::mutex buffers_mutex_;
+
+  // Guards curl_pool_, which holds LibcurlWrappers not in use.  Every
+  // wrapper is kept until the supplier is destroyed, because destroying
+  // one releases libcurl's global state.
+  std::mutex curl_mutex_;
+  vector<LibcurlWrapper*> curl_pool_;
+  vector<LibcurlWrapper*> all_curls_;
+
+  // The download threads and their queue of pending requests.
+  std::mutex queue_mutex_;
+  std::condition_variable queue_ready_;
+  std::deque<std::function<void()> > queue_;
+  vector<std::thread> download_threads_;
+  bool stopping_;
+
+  // Disallow unwanted copy ctor and assignment operator
+  HTTPSymbolSupplier(const HTTPSymbolSupplier&);
+  void operator=(const HTTPSymbolSupplier&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_HTTP_SYMBOL_SUPPLIER_H__
@@ -0,0 +1,294 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// http_symbol_supplier_unittest.cc: Unit tests for HTTPSymbolSupplier.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "processor/basic_code_module.h"
+#include "processor/http_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicCodeModule;
+using google_breakpad::HTTPSymbolSupplier;
+using google_breakpad::SymbolSupplier;
+using google_breakpad::scoped_ptr;
+using std::map;
+using std::pair;
+using std::vector;
+
+const char kModuleId[] = "111111111111111111111111111111111";
+const char kServerA[] = "http://a.example.com/symbols";
+const char kServerB[] = "http://b.example.com/symbols/";
+
+// Serves canned responses instead of using the network.
+class FakeHTTPSymbolSupplier : public HTTPSymbolSupplier {
+ public:
+  FakeHTTPSymbolSupplier(const vector<string>& server_urls,
+                         const string& cache_path)
+      : HTTPSymbolSupplier(server_urls, cache_path) {}
+
+  // Serves |body| with |status| at |url|.  Unknown URLs return 404;
+  // status 0 means no response at all.
+  void Serve(const string& url, long status, const string& body) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    responses_[url] = std::make_pair(status, body);
+  }
+
+  int FetchCount(const string& url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fetch_counts_[url];
+  }
+
+ protected:
+  virtual bool FetchURL(const string& url,
+                        long* http_status_code,
+                        string* body) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++fetch_counts_[url];
+    map<string, pair<long, string> >::const_iterator it =
+        responses_.find(url);
+    if (it == responses_.end()) {
+      *http_status_code = 404;
+      return true;
+    }
+    if (it->second.first == 0)
+      return false;
+    *http_status_code = it->second.first;
+    *body = it->second.second;
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  map<string, pair<long, string> > responses_;
+  map<string, int> fetch_counts_;
+};
+
+BasicCodeModule* NewModule(const string& name) {
+  return new BasicCodeModule(0x1000, 0x1000, "/lib/" + name, "",
+                         name + ".pdb", kModuleId, "");
+}
+
+string RelativePath(const string& name) {
+  return name + ".pdb/" + kModuleId + "/" + name + ".sym";
+}
+
+bool FileExists(const string& path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0;
+}
+
+// Makes |path| look |age| seconds old to the cache.
+void SetAge(const string& path, time_t age) {
+  struct timeval times[2];
+  times[0].tv_sec = times[1].tv_sec = time(NULL) - age;
+  times[0].tv_usec = times[1].tv_usec = 0;
+  ASSERT_EQ(0, utimes(path.c_str(), times));
+}
+
+class HTTPSymbolSupplierTest : public ::testing::Test {
+ public:
+  HTTPSymbolSupplierTest() {
+    servers_.push_back(kServerA);
+    servers_.push_back(kServerB);
+  }
+
+  string ServerA(const string& name) {
+    return string(kServerA) + "/" + RelativePath(name);
+  }
+  string ServerB(const string& name) {
+    return string(kServerB) + RelativePath(name);
+  }
+  string CachePath(const string& name) {
+    return temp_dir_.path() + "/" + RelativePath(name);
+  }
+
+  AutoTempDir temp_dir_;
+  vector<string> servers_;
+};
+
+TEST_F(HTTPSymbolSupplierTest, DownloadsIntoCache) {
+  FakeHTTPSymbolSupplier supplier(servers_, temp_dir_.path());
+  supplier.Serve(ServerB("libfoo"), 200, "MODULE Linux x86_64 1 libfoo\n");
+  scoped_ptr<BasicCodeModule> module(NewModule("libfoo"));
+
+  string symbol_file;
+  string symbol_data;
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(module.get(), NULL, &symbol_file,
+                                   &symbol_data));
+  EXPECT_EQ(CachePath("libfoo"), symbol_file);
+  EXPECT_EQ("MODULE Linux x86_64 1 libfoo\n", symbol_data);
+  EXPECT_EQ(1, supplier.FetchCount(ServerA("libfoo")));
+  EXPECT_EQ(1, supplier.FetchCount(ServerB("libfoo")));
+
+  // The second request is served from the cache, even by a new supplier.
+  FakeHTTPSymbolSupplier second(servers_, temp_dir_.path());
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            second.GetSymbolFile(module.get(), NULL, &symbol_file, &symbol_data));
+  EXPECT_EQ("MODULE Linux x86_64 1 libfoo\n", symbol_data);
+  EXPECT_EQ(0, second.FetchCount(ServerA("libfoo")));
+  EXPECT_EQ(0, second.FetchCount(ServerB("libfoo")));
+}
+
+TEST_F(HTTPSymbolSupplierTest, CachesNotFound) {
+  FakeHTTPSymbolSupplier supplier(servers_, temp_dir_.path());
+  scoped_ptr<BasicCodeModule> module(NewModule("libbar"));
+
+  string symbol_file;
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            supplier.GetSymbolFile(module.get(), NULL, &symbol_file));
+  EXPECT_TRUE(FileExists(CachePath("libbar") + ".notfound"));
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            supplier.GetSymbolFile(module.get(), NULL, &symbol_file));
+  EXPECT_EQ(1, supplier.FetchCount(ServerA("libbar")));
+
+  // Once the marker expires the servers are asked again.
+  SetAge(CachePath("libbar") + ".notfound", 2 * 24 * 60 * 60);
+  supplier.Serve(ServerA("libbar"), 200, "MODULE Linux x86_64 1 libbar\n");
+  EXPECT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(module.get(), NULL, &symbol_file));
+  EXPECT_EQ(2, supplier.FetchCount(ServerA("libbar")));
+  EXPECT_FALSE(FileExists(CachePath("libbar") + ".notfound"));
+}
+
+TEST_F(HTTPSymbolSupplierTest, DoesNotCacheErrors) {
+  FakeHTTPSymbolSupplier supplier(servers_, temp_dir_.path());
+  supplier.Serve(ServerA("libbaz"), 503, "");
+  supplier.Serve(ServerB("libbaz"), 0, "");
+  scoped_ptr<BasicCodeModule> module(NewModule("libbaz"));
+
+  string symbol_file;
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            supplier.GetSymbolFile(module.get(), NULL, &symbol_file));
+  EXPECT_FALSE(FileExists(CachePath("libbaz") + ".notfound"));
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            supplier.GetSymbolFile(module.get(), NULL, &symbol_file));
+  EXPECT_EQ(2, supplier.FetchCount(ServerA("libbaz")));
+  EXPECT_EQ(2, supplier.FetchCount(ServerB("libbaz")));
+}
+
+TEST_F(HTTPSymbolSupplierTest, EvictsLeastRecentlyUsed) {
+  FakeHTTPSymbolSupplier supplier(servers_, temp_dir_.path());
+  supplier.set_max_cache_bytes(25);
+  const char* names[] = { "liba", "libb", "libc" };
+  for (int i = 0; i < 3; ++i)
+    supplier.Serve(ServerA(names[i]), 200, "0123456789");
+
+  scoped_ptr<BasicCodeModule> a(NewModule("liba"));
+  scoped_ptr<BasicCodeModule> b(NewModule("libb"));
+  scoped_ptr<BasicCodeModule> c(NewModule("libc"));
+  string symbol_file;
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(a.get(), NULL, &symbol_file));
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(b.get(), NULL, &symbol_file));
+  SetAge(CachePath("liba"), 200);
+  SetAge(CachePath("libb"), 100);
+
+  // Using liba makes libb the least recently used.
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(a.get(), NULL, &symbol_file));
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(c.get(), NULL, &symbol_file));
+  EXPECT_TRUE(FileExists(CachePath("liba")));
+  EXPECT_FALSE(FileExists(CachePath("libb")));
+  EXPECT_TRUE(FileExists(CachePath("libc")));
+  EXPECT_EQ(1, supplier.FetchCount(ServerA("liba")));
+}
+
+TEST_F(HTTPSymbolSupplierTest, AsyncDownloads) {
+  FakeHTTPSymbolSupplier supplier(servers_, temp_dir_.path());
+  supplier.set_max_concurrent_downloads(3);
+  const int kModules = 10;
+  vector<BasicCodeModule*> modules;
+  for (int i = 0; i < kModules; ++i) {
+    char name[16];
+    snprintf(name, sizeof(name), "lib%d", i);
+    modules.push_back(NewModule(name));
+    if (i % 2 == 0)
+      supplier.Serve(ServerA(name), 200, string("data ") + name);
+  }
+
+  std::mutex mutex;
+  std::condition_variable done;
+  int pending = kModules;
+  map<string, string> found;
+  for (int i = 0; i < kModules; ++i) {
+    const BasicCodeModule* module = modules[i];
+    supplier.GetCStringSymbolDataAsync(
+        module, NULL,
+        [&, module](SymbolSupplier::SymbolResult result,
+                    const string& symbol_file, char* symbol_data,
+                    size_t symbol_data_size) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (result == SymbolSupplier::FOUND)
+            found[module->code_file()] = symbol_data;
+          if (--pending == 0)
+            done.notify_one();
+        });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return pending == 0; });
+  }
+
+  EXPECT_EQ(5U, found.size());
+  EXPECT_EQ("data lib4", found["/lib/lib4"]);
+  for (int i = 0; i < kModules; ++i) {
+    supplier.FreeSymbolData(modules[i]);
+    delete modules[i];
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
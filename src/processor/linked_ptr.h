@@ -45,6 +45,11 @@
 // You can safely put linked_ptr<> in a vector<>.
 // Other uses may not be as good.
 //
+// Thread safety: changes to the circular list are serialized by a global
+// mutex, so linked_ptr<>s that share an object may be copied and destroyed
+// on different threads, for example when several threads look up entries in
+// the same const map.  The pointed-to object itself is not protected.
+//
 // Note: If you use an incomplete type with linked_ptr<>, the class
 // *containing* linked_ptr<> must have a constructor and destructor (even
 // if they do nothing!).
@@ -52,6 +57,8 @@
 #ifndef PROCESSOR_LINKED_PTR_H__
 #define PROCESSOR_LINKED_PTR_H__
 
+#include <mutex>
+
 namespace google_breakpad {
 
 // This is used internally by all instances of linked_ptr<>.  It needs to be
@@ -70,6 +77,7 @@ class linked_ptr_internal {
 
   // Join an existing circle.
   void join(linked_ptr_internal const* ptr) {
+    std::lock_guard<std::mutex> lock(mutex());
     linked_ptr_internal const* p = ptr;
     while (p->next_ != ptr) p = p->next_;
     p->next_ = this;
@@ -79,6 +87,7 @@ class linked_ptr_internal {
   // Leave whatever circle we're part of.  Returns true iff we were the
   // last member of the circle.  Once this is done, you can join() another.
   bool depart() {
+    std::lock_guard<std::mutex> lock(mutex());
     if (next_ == this) return true;
     linked_ptr_internal const* p = next_;
     while (p->next_ != this) p = p->next_;
@@ -87,6 +96,11 @@ class linked_ptr_internal {
   }
 
  private:
+  static std::mutex& mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
   mutable linked_ptr_internal const* next_;
 };
 
@@ -50,6 +50,36 @@
 
 namespace google_breakpad {
 
+namespace {
+
+// The messages suppressed before the calling thread's last allowed message.
+thread_local uint64_t suppressed_count = 0;
+
+}  // namespace
+
+std::atomic<int> LogStream::minimum_severity_(LogStream::SEVERITY_INFO);
+std::atomic<unsigned int> LogStream::rate_limit_(BPLOG_RATE_LIMIT);
+
+bool LogSite::Allow() {
+  uint64_t count = count_.fetch_add(1, std::memory_order_relaxed) + 1;
+  unsigned int limit = LogStream::rate_limit();
+  if (limit == 0 || count <= limit)
+    return true;
+
+  // Past the limit, only the 1st, 2nd, 4th, 8th, ... message is written.
+  uint64_t over = count - limit;
+  if (over & (over - 1))
+    return false;
+  suppressed_count = over > 1 ? over / 2 - 1 : 0;
+  return true;
+}
+
+uint64_t LogSite::TakeSuppressedCount() {
+  uint64_t count = suppressed_count;
+  suppressed_count = 0;
+  return count;
+}
+
 LogStream::LogStream(std::ostream& stream, Severity severity,
                      const char* file, int line)
     : stream_(stream) {
@@ -79,6 +109,9 @@ LogStream::LogStream(std::ostream& stream, Severity severity,
 
   stream_ << time_string << ": " << PathnameStripper::File(file) << ":" <<
              line << ": " << severity_string << ": ";
+  uint64_t suppressed = LogSite::TakeSuppressedCount();
+  if (suppressed)
+    stream_ << "(" << suppressed << " similar messages suppressed) ";
 }
 
 LogStream::~LogStream() {
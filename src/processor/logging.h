@@ -45,6 +45,15 @@
 // be specified by the BP_LOGGING_INCLUDE macro.  If defined, this header
 // will #include the header specified by that macro.
 //
+// Messages less severe than BPLOG_MINIMUM_SEVERITY are compiled out, and
+// LogStream::SetMinimumSeverity raises the bar at runtime.  Either way, a
+// message that isn't written doesn't evaluate its stream arguments.  Each
+// BPLOG statement is also rate limited: once it has written
+// LogStream::rate_limit() messages (BPLOG_RATE_LIMIT, as logging.cc is
+// compiled, until SetRateLimit changes it), it only writes its 1st, 2nd,
+// 4th, 8th, ... message after that, noting how many were suppressed, so
+// that malformed input can't flood the log.
+//
 // If any initialization is needed before logging, it can be performed by
 // a function called through the BPLOG_INIT macro.  Each main function of
 // an executable program in the Breakpad processor library calls
@@ -56,6 +65,7 @@
 #ifndef PROCESSOR_LOGGING_H__
 #define PROCESSOR_LOGGING_H__
 
+#include <atomic>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -100,7 +110,30 @@ class LogStream {
     return stream_ << t;
   }
 
+  // Sets the least severe messages that are written.  Messages below
+  // BPLOG_MINIMUM_SEVERITY are never written.
+  static void SetMinimumSeverity(Severity severity) {
+    minimum_severity_.store(severity, std::memory_order_relaxed);
+  }
+
+  static bool IsOn(Severity severity) {
+    return severity >= minimum_severity_.load(std::memory_order_relaxed);
+  }
+
+  // Sets how many messages each BPLOG statement writes before it is rate
+  // limited.  0 turns rate limiting off.
+  static void SetRateLimit(unsigned int limit) {
+    rate_limit_.store(limit, std::memory_order_relaxed);
+  }
+
+  static unsigned int rate_limit() {
+    return rate_limit_.load(std::memory_order_relaxed);
+  }
+
  private:
+  static std::atomic<int> minimum_severity_;
+  static std::atomic<unsigned int> rate_limit_;
+
   std::ostream& stream_;
 
   // Disallow copy constructor and assignment operator
@@ -108,6 +141,24 @@ class LogStream {
   void operator=(const LogStream& that);
 };
 
+// LogSite counts the messages of one BPLOG statement, to rate limit them.
+class LogSite {
+ public:
+  constexpr LogSite() : count_(0) {}
+
+  // Returns whether the statement's next message should be written.  If
+  // messages were suppressed before it, the LogStream that the calling
+  // thread constructs next reports how many.
+  bool Allow();
+
+  // Returns the number of messages that the calling thread's last allowed
+  // message followed the suppression of, and resets it.
+  static uint64_t TakeSuppressedCount();
+
+ private:
+  std::atomic<uint64_t> count_;
+};
+
 // This class is used to explicitly ignore values in the conditional logging
 // macros.  This avoids compiler warnings like "value computed is not used"
 // and "statement has no effect".
@@ -149,12 +200,31 @@ int ErrnoString(string* error_string);
 #define BPLOG_MINIMUM_SEVERITY SEVERITY_INFO
 #endif
 
+#ifndef BPLOG_RATE_LIMIT
+#define BPLOG_RATE_LIMIT 32
+#endif
+
 #define BPLOG_LOG_IS_ON(severity) \
     ((google_breakpad::LogStream::SEVERITY_ ## severity) >= \
      (google_breakpad::LogStream::BPLOG_MINIMUM_SEVERITY))
 
+// The LogSite of the BPLOG statement that this expands in.
+#define BPLOG_SITE() \
+    ([]() -> google_breakpad::LogSite& { \
+      static google_breakpad::LogSite site; \
+      return site; \
+    }())
+
+// Checks the compile-time severity first, so that disabled statements
+// compile to nothing.
+#define BPLOG_SHOULD_LOG(severity) \
+    (BPLOG_LOG_IS_ON(severity) && \
+     google_breakpad::LogStream::IsOn( \
+         google_breakpad::LogStream::SEVERITY_ ## severity) && \
+     BPLOG_SITE().Allow())
+
 #ifndef BPLOG
-#define BPLOG(severity) BPLOG_LAZY_STREAM(severity, BPLOG_LOG_IS_ON(severity))
+#define BPLOG(severity) BPLOG_LAZY_STREAM(severity, BPLOG_SHOULD_LOG(severity))
 #endif  // BPLOG
 
 #ifndef BPLOG_INFO
@@ -186,7 +256,7 @@ int ErrnoString(string* error_string);
 
 #ifndef BPLOG_IF
 #define BPLOG_IF(severity, condition) \
-    BPLOG_LAZY_STREAM(severity, ((condition) && BPLOG_LOG_IS_ON(severity)))
+    BPLOG_LAZY_STREAM(severity, ((condition) && BPLOG_SHOULD_LOG(severity)))
 #endif  // BPLOG_IF
 
 #endif  // PROCESSOR_LOGGING_H__
@@ -0,0 +1,124 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// logging_unittest.cc: Unit tests for BPLOG's severity filtering and rate
+// limiting.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "processor/logging.h"
+
+namespace {
+
+using google_breakpad::LogStream;
+
+// Captures what is written to std::cerr, where errors are logged, and
+// restores the logging settings that the test changes.
+class LoggingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    saved_buffer_ = std::cerr.rdbuf(captured_.rdbuf());
+  }
+
+  void TearDown() override {
+    std::cerr.rdbuf(saved_buffer_);
+    LogStream::SetMinimumSeverity(LogStream::SEVERITY_INFO);
+    LogStream::SetRateLimit(BPLOG_RATE_LIMIT);
+  }
+
+  int CountLines() const {
+    string text = captured_.str();
+    int lines = 0;
+    for (char c : text)
+      lines += c == '\n';
+    return lines;
+  }
+
+  std::stringstream captured_;
+  std::streambuf* saved_buffer_;
+};
+
+int Evaluate(int* evaluations) {
+  return ++*evaluations;
+}
+
+TEST_F(LoggingTest, DisabledSeverityEvaluatesNothing) {
+  int evaluations = 0;
+  LogStream::SetMinimumSeverity(LogStream::SEVERITY_CRITICAL);
+  BPLOG(ERROR) << Evaluate(&evaluations);
+  BPLOG_IF(ERROR, true) << Evaluate(&evaluations);
+  EXPECT_EQ(0, evaluations);
+  EXPECT_EQ(0, CountLines());
+
+  LogStream::SetMinimumSeverity(LogStream::SEVERITY_ERROR);
+  BPLOG(ERROR) << Evaluate(&evaluations);
+  EXPECT_EQ(1, evaluations);
+  EXPECT_EQ(1, CountLines());
+}
+
+TEST_F(LoggingTest, RepeatedMessagesAreRateLimited) {
+  LogStream::SetRateLimit(4);
+  int evaluations = 0;
+  for (int i = 0; i < 100; ++i)
+    BPLOG(ERROR) << "bad line " << i + 1 << " " << Evaluate(&evaluations);
+
+  // The first 4 messages, then the 5th, 6th, 8th, 12th, 20th, 36th and
+  // 68th.
+  EXPECT_EQ(11, CountLines());
+  EXPECT_EQ(11, evaluations);
+  EXPECT_NE(string::npos,
+            captured_.str().find("(31 similar messages suppressed) bad line "
+                                 "68 "));
+}
+
+TEST_F(LoggingTest, RateLimitIsPerStatement) {
+  LogStream::SetRateLimit(1);
+  for (int i = 0; i < 3; ++i) {
+    BPLOG(ERROR) << "first";
+    BPLOG(ERROR) << "second";
+  }
+  // Each statement writes its 1st, 2nd and 3rd message.
+  EXPECT_EQ(6, CountLines());
+}
+
+TEST_F(LoggingTest, ZeroRateLimitWritesEverything) {
+  LogStream::SetRateLimit(0);
+  for (int i = 0; i < 100; ++i)
+    BPLOG(ERROR) << "message";
+  EXPECT_EQ(100, CountLines());
+}
+
+}  // namespace
@@ -36,15 +36,19 @@
 #ifndef PROCESSOR_MAP_SERIALIZERS_INL_H__
 #define PROCESSOR_MAP_SERIALIZERS_INL_H__
 
+#include <string.h>
+
 #include <map>
 #include <string>
 
 #include "processor/map_serializers.h"
 #include "processor/simple_serializer.h"
+#include "processor/static_map_search_index-inl.h"
 
 #include "processor/address_map-inl.h"
 #include "processor/range_map-inl.h"
 #include "processor/contained_range_map-inl.h"
+#include "processor/nested_range_index-inl.h"
 
 #include "processor/logging.h"
 
@@ -56,6 +60,8 @@ size_t StdMapSerializer<Key, Value>::SizeOf(
   size_t size = 0;
   size_t header_size = (1 + m.size()) * sizeof(uint64_t);
   size += header_size;
+  if (search_index_)
+    size += StaticMapSearchIndex<Key>::SizeOf(m.size());
 
   typename std::map<Key, Value>::const_iterator iter;
   for (iter = m.begin(); iter != m.end(); ++iter) {
@@ -84,6 +90,11 @@ char* StdMapSerializer<Key, Value>::Write(const std::map<Key, Value>& m,
   char* key_address = dest;
   dest += sizeof(Key) * m.size();
 
+  // Search index goes between the keys and the values.
+  char* index_address = dest;
+  if (search_index_)
+    dest += StaticMapSearchIndex<Key>::SizeOf(m.size());
+
   // Traverse map.
   typename std::map<Key, Value>::const_iterator iter;
   int64_t index = 0;
@@ -92,6 +103,11 @@ char* StdMapSerializer<Key, Value>::Write(const std::map<Key, Value>& m,
     key_address = key_serializer_.Write(iter->first, key_address);
     dest = value_serializer_.Write(iter->second, dest);
   }
+  if (search_index_) {
+    StaticMapSearchIndex<Key>::Write(
+        reinterpret_cast<const Key*>(index_address) - m.size(), m.size(),
+        index_address);
+  }
   return dest;
 }
 
@@ -120,6 +136,8 @@ size_t RangeMapSerializer<Address, Entry>::SizeOf(
   size_t size = 0;
   size_t header_size = (1 + m.map_.size()) * sizeof(uint64_t);
   size += header_size;
+  if (search_index_)
+    size += StaticMapSearchIndex<Address>::SizeOf(m.map_.size());
 
   typename std::map<Address, Range>::const_iterator iter;
   for (iter = m.map_.begin(); iter != m.map_.end(); ++iter) {
@@ -152,6 +170,11 @@ char* RangeMapSerializer<Address, Entry>::Write(
   char* key_address = dest;
   dest += sizeof(Address) * m.map_.size();
 
+  // Search index goes between the keys and the values.
+  char* index_address = dest;
+  if (search_index_)
+    dest += StaticMapSearchIndex<Address>::SizeOf(m.map_.size());
+
   // Traverse map.
   typename std::map<Address, Range>::const_iterator iter;
   int64_t index = 0;
@@ -161,6 +184,11 @@ char* RangeMapSerializer<Address, Entry>::Write(
     dest = address_serializer_.Write(iter->second.base(), dest);
     dest = entry_serializer_.Write(iter->second.entry(), dest);
   }
+  if (search_index_) {
+    StaticMapSearchIndex<Address>::Write(
+        reinterpret_cast<const Address*>(index_address) - m.map_.size(),
+        m.map_.size(), index_address);
+  }
   return dest;
 }
 
@@ -260,6 +288,57 @@ char* ContainedRangeMapSerializer<AddrType, EntryType>::Serialize(
   return serialized_data;
 }
 
+template<class AddrType, class EntryType>
+size_t NestedRangeIndexSerializer<AddrType, EntryType>::SizeOf(
+    const NestedRangeIndex<AddrType, EntryType>& index) const {
+  size_t size = sizeof(uint64_t);
+  size += index.ranges_.size() *
+          (sizeof(NestedRange<AddrType>) + sizeof(uint64_t));
+  for (size_t i = 0; i < index.entries_.size(); ++i)
+    size += entry_serializer_.SizeOf(index.entries_[i]);
+  return size;
+}
+
+template<class AddrType, class EntryType>
+char* NestedRangeIndexSerializer<AddrType, EntryType>::Write(
+    const NestedRangeIndex<AddrType, EntryType>& index, char* dest) const {
+  if (!dest) {
+    BPLOG(ERROR) << "NestedRangeIndexSerializer failed: write to NULL address.";
+    return NULL;
+  }
+  const size_t count = index.ranges_.size();
+  dest = SimpleSerializer<uint64_t>::Write(count, dest);
+  if (count) {
+    memcpy(dest, &index.ranges_[0], count * sizeof(NestedRange<AddrType>));
+    dest += count * sizeof(NestedRange<AddrType>);
+  }
+
+  uint64_t* offsets = reinterpret_cast<uint64_t*>(dest);
+  dest += count * sizeof(uint64_t);
+  char* entries = dest;
+  for (size_t i = 0; i < count; ++i) {
+    offsets[i] = static_cast<uint64_t>(dest - entries);
+    dest = entry_serializer_.Write(index.entries_[i], dest);
+  }
+  return dest;
+}
+
+template<class AddrType, class EntryType>
+char* NestedRangeIndexSerializer<AddrType, EntryType>::Serialize(
+    const NestedRangeIndex<AddrType, EntryType>& index, uint64_t* size) const {
+  uint64_t size_to_alloc = SizeOf(index);
+  // Allocating memory.
+  char* serialized_data = new char[size_to_alloc];
+  if (!serialized_data) {
+    BPLOG(INFO) << "NestedRangeIndexSerializer memory allocation failed.";
+    if (size) *size = 0;
+    return NULL;
+  }
+  Write(index, serialized_data);
+  if (size) *size = size_to_alloc;
+  return serialized_data;
+}
+
 }  // namespace google_breakpad
 
 #endif  // PROCESSOR_MAP_SERIALIZERS_INL_H__
@@ -39,10 +39,12 @@
 #include <string>
 
 #include "processor/simple_serializer.h"
+#include "processor/static_map_search_index.h"
 
 #include "processor/address_map-inl.h"
 #include "processor/range_map-inl.h"
 #include "processor/contained_range_map-inl.h"
+#include "processor/nested_range_index-inl.h"
 
 namespace google_breakpad {
 
@@ -51,6 +53,12 @@ namespace google_breakpad {
 template<typename Key, typename Value>
 class StdMapSerializer {
  public:
+  StdMapSerializer() : search_index_(false) { }
+
+  // If |search_index| is true, maps large enough to benefit are serialized
+  // with a StaticMapSearchIndex.  Off by default.
+  void set_search_index(bool search_index) { search_index_ = search_index; }
+
   // Calculate the memory size of serialized data.
   size_t SizeOf(const std::map<Key, Value>& m) const;
 
@@ -68,6 +76,7 @@ class StdMapSerializer {
   char* Serialize(const std::map<Key, Value>& m, uint64_t* size) const;
 
  private:
+  bool search_index_;
   SimpleSerializer<Key> key_serializer_;
   SimpleSerializer<Value> value_serializer_;
 };
@@ -77,6 +86,11 @@ class StdMapSerializer {
 template<typename Addr, typename Entry>
 class AddressMapSerializer {
  public:
+  // See StdMapSerializer::set_search_index.
+  void set_search_index(bool search_index) {
+    std_map_serializer_.set_search_index(search_index);
+  }
+
   // Calculate the memory size of serialized data.
   size_t SizeOf(const AddressMap<Addr, Entry>& m) const {
     return std_map_serializer_.SizeOf(m.map_);
@@ -108,6 +122,11 @@ class AddressMapSerializer {
 template<typename Address, typename Entry>
 class RangeMapSerializer {
  public:
+  RangeMapSerializer() : search_index_(false) { }
+
+  // See StdMapSerializer::set_search_index.
+  void set_search_index(bool search_index) { search_index_ = search_index; }
+
   // Calculate the memory size of serialized data.
   size_t SizeOf(const RangeMap<Address, Entry>& m) const;
 
@@ -126,6 +145,8 @@ class RangeMapSerializer {
   // Convenient type name for Range.
   typedef typename RangeMap<Address, Entry>::Range Range;
 
+  bool search_index_;
+
   // Serializer for RangeMap's key and Range::base_.
   SimpleSerializer<Address> address_serializer_;
   // Serializer for RangeMap::Range::entry_.
@@ -162,6 +183,33 @@ class ContainedRangeMapSerializer {
   SimpleSerializer<EntryType> entry_serializer_;
 };
 
+// NestedRangeIndexSerializer allocates memory and serializes a
+// NestedRangeIndex instance into a chunk of memory data, in the layout that
+// StaticNestedRangeIndex reads.
+template<class AddrType, class EntryType>
+class NestedRangeIndexSerializer {
+ public:
+  // Calculate the memory size of serialized data.
+  size_t SizeOf(const NestedRangeIndex<AddrType, EntryType>& index) const;
+
+  // Write the serialized data to specified memory location.  Return the "end"
+  // of data, i.e., return the address after the final byte of data.
+  // NOTE: caller has to allocate enough memory before invoke Write() method.
+  char* Write(const NestedRangeIndex<AddrType, EntryType>& index,
+              char* dest) const;
+
+  // Serializes a NestedRangeIndex object into a chunk of memory data.
+  // Returns a pointer to the serialized data.  If size != NULL, *size is set
+  // to the size of serialized data, i.e., SizeOf(index).
+  // Caller has the ownership of memory allocated as "new char[]".
+  char* Serialize(const NestedRangeIndex<AddrType, EntryType>& index,
+                  uint64_t* size) const;
+
+ private:
+  // Serializer for entries stored in NestedRangeIndex.
+  SimpleSerializer<EntryType> entry_serializer_;
+};
+
 }  // namespace google_breakpad
 
 #endif  // PROCESSOR_MAP_SERIALIZERS_H__
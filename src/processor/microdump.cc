@@ -39,11 +39,19 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+#include <iostream>
 #include <memory>
-#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "common/string_view.h"
+
 #include "google_breakpad/common/minidump_cpu_arm.h"
 #include "google_breakpad/processor/code_module.h"
 #include "processor/basic_code_module.h"
@@ -63,6 +71,7 @@ static const char kGpuKey[] = ": G ";
 static const char kMmapKey[] = ": M ";
 static const char kStackKey[] = ": S ";
 static const char kStackFirstLineKey[] = ": S 0 ";
+static const char kFilteredStackKey[] = ": F ";
 static const char kArmArchitecture[] = "arm";
 static const char kArm64Architecture[] = "arm64";
 static const char kX86Architecture[] = "x86";
@@ -70,33 +79,168 @@ static const char kMipsArchitecture[] = "mips";
 static const char kMips64Architecture[] = "mips64";
 static const char kGpuUnknown[] = "UNKNOWN";
 
+using google_breakpad::StringView;
+
+// Returns the position of |key| in |str|, or string::npos.
+size_t Find(StringView str, const char* key) {
+  const char* end = str.data() + str.size();
+  const char* found = std::search(str.data(), end, key, key + strlen(key));
+  return found == end ? string::npos : found - str.data();
+}
+
+// Returns the part of |str| after its first |pos| characters.
+StringView Suffix(StringView str, size_t pos) {
+  return StringView(str.data() + pos, str.size() - pos);
+}
+
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+         c == '\r';
+}
+
+// Returns the next whitespace-delimited token of |*str|, or an empty view
+// if there is none, and advances |*str| past it.
+StringView NextToken(StringView* str) {
+  const char* p = str->data();
+  const char* end = p + str->size();
+  while (p < end && IsSpace(*p))
+    ++p;
+  const char* token = p;
+  while (p < end && !IsSpace(*p))
+    ++p;
+  *str = StringView(p, end - p);
+  return StringView(token, p - token);
+}
+
+// Returns the next |delimiter|-terminated field of |*str| and advances
+// |*str| past the field and its delimiter.
+StringView NextField(StringView* str, char delimiter) {
+  const char* end = str->data() + str->size();
+  const char* found = std::find(str->data(), end, delimiter);
+  StringView field(str->data(), found - str->data());
+  *str = found == end ? StringView(end, 0) : StringView(found + 1,
+                                                        end - found - 1);
+  return field;
+}
+
+// Returns the next line of |*contents| in |*line|, without its line
+// terminator, and advances |*contents| past it.  Both Unix and Windows/DOS
+// line endings are accepted; the adb tool generally writes logcat dumps in
+// Windows/DOS format.
+bool NextLine(StringView* contents, StringView* line) {
+  if (contents->empty())
+    return false;
+  const char* start = contents->data();
+  const char* end = start + contents->size();
+  const char* newline =
+      static_cast<const char*>(memchr(start, '\n', contents->size()));
+  const char* line_end = newline ? newline : end;
+  *contents = newline ? StringView(newline + 1, end - newline - 1)
+                      : StringView(end, 0);
+  if (line_end > start && line_end[-1] == '\r')
+    --line_end;
+  *line = StringView(start, line_end - start);
+  return true;
+}
+
+// Returns the value of hex digit |c|, or -1 if it isn't one.
+int HexDigit(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// Parses the hex number that |str| starts with, stopping at the first
+// character that isn't a hex digit.
 template<typename T>
-T HexStrToL(const string& str) {
+T HexStrToL(StringView str) {
   uint64_t res = 0;
-  std::istringstream ss(str);
-  ss >> std::hex >> res;
+  for (size_t i = 0; i < str.size(); ++i) {
+    int digit = HexDigit(str.data()[i]);
+    if (digit < 0)
+      break;
+    res = (res << 4) | digit;
+  }
   return static_cast<T>(res);
 }
 
-std::vector<uint8_t> ParseHexBuf(const string& str) {
-  std::vector<uint8_t> buf;
-  for (size_t i = 0; i < str.length(); i += 2) {
-    buf.push_back(HexStrToL<uint8_t>(str.substr(i, 2)));
-  }
-  return buf;
+// Returns the byte that the hex digit pair at |pair| holds, |count|
+// being 1 for a lone final digit.  As with HexStrToL, decoding stops at
+// the first character that isn't a hex digit.
+uint8_t DecodeHexPair(const char* pair, size_t count) {
+  int high = HexDigit(pair[0]);
+  if (high < 0)
+    return 0;
+  int low = count > 1 ? HexDigit(pair[1]) : -1;
+  return static_cast<uint8_t>(low < 0 ? high : (high << 4) | low);
 }
 
-bool GetLine(std::istringstream* istream, string* str) {
-  if (std::getline(*istream, *str)) {
-    // Trim any trailing newline from the end of the line. Allows us
-    // to seamlessly handle both Windows/DOS and Unix formatted input. The
-    // adb tool generally writes logcat dumps in Windows/DOS format.
-    if (!str->empty() && str->at(str->size() - 1) == '\r') {
-      str->erase(str->size() - 1);
+#if defined(__SSE2__)
+// Decodes the 16 hex digits at |hex| into 8 bytes at |out|, and returns
+// true, or returns false without writing anything if any of them isn't a
+// hex digit.
+bool DecodeHex16(const char* hex, uint8_t* out) {
+  __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex));
+  __m128i minus_one = _mm_set1_epi8(-1);
+
+  // Signed compares suffice: characters at or above 0x80 end up negative
+  // or far out of range.
+  __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+  __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(digit, minus_one),
+                                   _mm_cmplt_epi8(digit, _mm_set1_epi8(10)));
+  __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)),
+                                _mm_set1_epi8('a'));
+  __m128i is_letter = _mm_and_si128(_mm_cmpgt_epi8(letter, minus_one),
+                                    _mm_cmplt_epi8(letter, _mm_set1_epi8(6)));
+  if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xffff)
+    return false;
+
+  __m128i nibbles = _mm_or_si128(
+      _mm_and_si128(is_digit, digit),
+      _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+  // Each 16-bit lane holds a digit pair, the high nibble in its low byte.
+  __m128i high = _mm_slli_epi16(
+      _mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4);
+  __m128i low = _mm_srli_epi16(nibbles, 8);
+  __m128i bytes = _mm_packus_epi16(_mm_or_si128(high, low),
+                                   _mm_setzero_si128());
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(out), bytes);
+  return true;
+}
+#endif  // __SSE2__
+
+// Returns the number of bytes that DecodeHex writes for |str|.
+size_t DecodedHexSize(StringView str) {
+  return (str.size() + 1) / 2;
+}
+
+// Decodes the hex digit pairs of |str| into DecodedHexSize(str) bytes at
+// |out|.
+void DecodeHex(StringView str, uint8_t* out) {
+  const char* hex = str.data();
+  size_t size = str.size();
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= size; i += 16, out += 8) {
+    if (!DecodeHex16(hex + i, out)) {
+      for (size_t j = 0; j < 8; ++j)
+        out[j] = DecodeHexPair(hex + i + j * 2, 2);
     }
-    return true;
   }
-  return false;
+#endif  // __SSE2__
+  for (; i < size; i += 2)
+    *out++ = DecodeHexPair(hex + i, size - i);
+}
+
+std::vector<uint8_t> ParseHexBuf(StringView str) {
+  std::vector<uint8_t> buf(DecodedHexSize(str));
+  if (!buf.empty())
+    DecodeHex(str, &buf[0]);
+  return buf;
 }
 
 }  // namespace
@@ -108,6 +252,17 @@ namespace google_breakpad {
 //
 
 void MicrodumpModules::Add(const CodeModule* module) {
+  StoreModule(module);
+  IndexModules();
+}
+
+void MicrodumpModules::Add(const std::vector<const CodeModule*>& modules) {
+  for (const CodeModule* module : modules)
+    StoreModule(module);
+  IndexModules();
+}
+
+void MicrodumpModules::StoreModule(const CodeModule* module) {
   linked_ptr<const CodeModule> module_ptr(module);
   if (!map_.StoreRange(module->base_address(), module->size(), module_ptr)) {
     BPLOG(ERROR) << "Module " << module->code_file() <<
@@ -162,9 +317,9 @@ void MicrodumpContext::SetContextMIPS64(MDRawContextMIPS* mips64) {
 MicrodumpMemoryRegion::MicrodumpMemoryRegion() : base_address_(0) { }
 
 void MicrodumpMemoryRegion::Init(uint64_t base_address,
-                                 const std::vector<uint8_t>& contents) {
+                                 std::vector<uint8_t> contents) {
   base_address_ = base_address;
-  contents_ = contents;
+  contents_.swap(contents);
 }
 
 uint64_t MicrodumpMemoryRegion::GetBase() const { return base_address_; }
@@ -206,6 +361,35 @@ bool MicrodumpMemoryRegion::GetMemoryLittleEndian(uint64_t address,
   return true;
 }
 
+bool MicrodumpMemoryRegion::GetMemoryArrayAtAddress(uint64_t address,
+                                                    uint32_t* values,
+                                                    size_t count) const {
+  return GetMemoryArrayLittleEndian(address, values, count);
+}
+
+bool MicrodumpMemoryRegion::GetMemoryArrayAtAddress(uint64_t address,
+                                                    uint64_t* values,
+                                                    size_t count) const {
+  return GetMemoryArrayLittleEndian(address, values, count);
+}
+
+template<typename ValueType>
+bool MicrodumpMemoryRegion::GetMemoryArrayLittleEndian(uint64_t address,
+                                                       ValueType* values,
+                                                       size_t count) const {
+  if (!ContainsArray<ValueType>(address, count))
+    return false;
+  const uint8_t* bytes = &contents_[0] + (address - base_address_);
+  for (size_t index = 0; index < count; ++index, bytes += sizeof(ValueType)) {
+    ValueType v = 0;
+    // The loop condition is odd, but it's correct for size_t.
+    for (size_t i = sizeof(ValueType) - 1; i < sizeof(ValueType); i--)
+      v = (v << 8) | bytes[i];
+    values[index] = v;
+  }
+  return true;
+}
+
 void MicrodumpMemoryRegion::Print() const {
   // Not reached, just needed to honor the base class contract.
   assert(false);
@@ -224,44 +408,43 @@ Microdump::Microdump(const string& contents)
   assert(!contents.empty());
 
   bool in_microdump = false;
-  string line;
+  StringView line;
   uint64_t stack_start = 0;
+  uint64_t stack_length = 0;
+  bool stack_filtered = false;
   std::vector<uint8_t> stack_content;
+  std::vector<const CodeModule*> modules;
   string arch;
 
-  std::istringstream stream(contents);
-  while (GetLine(&stream, &line)) {
-    if (line.find(kGoogleBreakpadKey) == string::npos) {
+  StringView remaining(contents);
+  while (NextLine(&remaining, &line)) {
+    if (Find(line, kGoogleBreakpadKey) == string::npos) {
       continue;
     }
-    if (line.find(kMicrodumpBegin) != string::npos) {
+    if (Find(line, kMicrodumpBegin) != string::npos) {
       in_microdump = true;
       continue;
     }
     if (!in_microdump) {
       continue;
     }
-    if (line.find(kMicrodumpEnd) != string::npos) {
+    if (Find(line, kMicrodumpEnd) != string::npos) {
       break;
     }
 
     size_t pos;
-    if ((pos = line.find(kOsKey)) != string::npos) {
-      string os_str(line, pos + strlen(kOsKey));
-      std::istringstream os_tokens(os_str);
-      string os_id;
-      string num_cpus;
-      string os_version;
+    if ((pos = Find(line, kOsKey)) != string::npos) {
+      StringView os_tokens = Suffix(line, pos + strlen(kOsKey));
+      StringView os_id = NextToken(&os_tokens);
+      arch = NextToken(&os_tokens).str();
+      StringView num_cpus = NextToken(&os_tokens);
       // This reflect the actual HW arch and might not match the arch emulated
       // for the execution (e.g., running a 32-bit binary on a 64-bit cpu).
-      string hw_arch;
-
-      os_tokens >> os_id;
-      os_tokens >> arch;
-      os_tokens >> num_cpus;
-      os_tokens >> hw_arch;
-      GetLine(&os_tokens, &os_version);
-      os_version.erase(0, 1);  // remove leading space.
+      NextToken(&os_tokens);  // hw_arch
+      // The rest of the line, after the space that follows hw_arch.
+      string os_version;
+      if (!os_tokens.empty())
+        os_version = Suffix(os_tokens, 1).str();
 
       system_info_->cpu = arch;
       system_info_->cpu_count = HexStrToL<uint8_t>(num_cpus);
@@ -277,21 +460,27 @@ Microdump::Microdump(const string& contents)
       }
 
       // OS line also contains release and version for future use.
-    } else if ((pos = line.find(kStackKey)) != string::npos) {
-      if (line.find(kStackFirstLineKey) != string::npos) {
+    } else if ((pos = Find(line, kStackKey)) != string::npos) {
+      if (Find(line, kStackFirstLineKey) != string::npos) {
         // The first line of the stack (S 0 stack header) provides the value of
         // the stack pointer, the start address of the stack being dumped and
-        // the length of the stack. We could use it in future to double check
-        // that we received all the stack as expected.
+        // the length of the stack.  Use the length to allocate the stack
+        // once, though no more than the rest of the input could fill.  We
+        // could use it in future to double check that we received all the
+        // stack as expected.
+        StringView header =
+            Suffix(line, pos + strlen(kStackFirstLineKey));
+        NextToken(&header);  // stack pointer
+        NextToken(&header);  // start address
+        stack_length = HexStrToL<uint64_t>(NextToken(&header));
+        stack_content.reserve(static_cast<size_t>(
+            std::min(stack_length,
+                     static_cast<uint64_t>(remaining.size() / 2))));
         continue;
       }
-      string stack_str(line, pos + strlen(kStackKey));
-      std::istringstream stack_tokens(stack_str);
-      string start_addr_str;
-      string raw_content;
-      stack_tokens >> start_addr_str;
-      stack_tokens >> raw_content;
-      uint64_t start_addr = HexStrToL<uint64_t>(start_addr_str);
+      StringView stack_tokens = Suffix(line, pos + strlen(kStackKey));
+      uint64_t start_addr = HexStrToL<uint64_t>(NextToken(&stack_tokens));
+      StringView raw_content = NextToken(&stack_tokens);
 
       if (stack_start != 0) {
         // Verify that the stack chunks in the microdump are contiguous.
@@ -299,12 +488,42 @@ Microdump::Microdump(const string& contents)
       } else {
         stack_start = start_addr;
       }
-      std::vector<uint8_t> chunk = ParseHexBuf(raw_content);
-      stack_content.insert(stack_content.end(), chunk.begin(), chunk.end());
+      // Decode the chunk in place at the end of the stack.
+      size_t offset = stack_content.size();
+      stack_content.resize(offset + DecodedHexSize(raw_content));
+      if (stack_content.size() > offset)
+        DecodeHex(raw_content, &stack_content[offset]);
+
+    } else if ((pos = Find(line, kFilteredStackKey)) != string::npos) {
+      // A filtered stack chunk follows the stack's full chunks.  It holds
+      // runs of words, each after the hex number of bytes left out before
+      // it, which read back as zeros.  The stack length from the header
+      // bounds where runs may go.
+      StringView stack_tokens = Suffix(line, pos + strlen(kFilteredStackKey));
+      uint64_t addr = HexStrToL<uint64_t>(NextToken(&stack_tokens));
+      if (stack_start == 0)
+        stack_start = addr;
+      stack_filtered = true;
+      for (StringView run = NextToken(&stack_tokens); !run.empty();
+           run = NextToken(&stack_tokens)) {
+        addr += HexStrToL<uint64_t>(NextField(&run, ':'));
+        size_t size = DecodedHexSize(run);
+        if (addr < stack_start || addr - stack_start + size > stack_length) {
+          std::cerr << "Filtered stack run out of bounds at 0x" << std::hex
+                    << addr << std::dec << std::endl;
+          break;
+        }
+        size_t offset = static_cast<size_t>(addr - stack_start);
+        if (stack_content.size() < offset + size)
+          stack_content.resize(offset + size);
+        if (size)
+          DecodeHex(run, &stack_content[offset]);
+        addr += size;
+      }
 
-    } else if ((pos = line.find(kCpuKey)) != string::npos) {
-      string cpu_state_str(line, pos + strlen(kCpuKey));
-      std::vector<uint8_t> cpu_state_raw = ParseHexBuf(cpu_state_str);
+    } else if ((pos = Find(line, kCpuKey)) != string::npos) {
+      std::vector<uint8_t> cpu_state_raw =
+          ParseHexBuf(Suffix(line, pos + strlen(kCpuKey)));
       if (strcmp(arch.c_str(), kArmArchitecture) == 0) {
         if (cpu_state_raw.size() != sizeof(MDRawContextARM)) {
           std::cerr << "Malformed CPU context. Got " << cpu_state_raw.size()
@@ -365,34 +584,28 @@ Microdump::Microdump(const string& contents)
       } else {
         std::cerr << "Unsupported architecture: " << arch << std::endl;
       }
-    } else if ((pos = line.find(kCrashReasonKey)) != string::npos) {
-      string crash_reason_str(line, pos + strlen(kCrashReasonKey));
-      std::istringstream crash_reason_tokens(crash_reason_str);
-      string signal;
-      string address;
-      crash_reason_tokens >> signal;
-      crash_reason_tokens >> crash_reason_;
-      crash_reason_tokens >> address;
-      crash_address_ = HexStrToL<uint64_t>(address);
-    } else if ((pos = line.find(kGpuKey)) != string::npos) {
-      string gpu_str(line, pos + strlen(kGpuKey));
-      if (strcmp(gpu_str.c_str(), kGpuUnknown) != 0) {
-        std::istringstream gpu_tokens(gpu_str);
-        std::getline(gpu_tokens, system_info_->gl_version, '|');
-        std::getline(gpu_tokens, system_info_->gl_vendor, '|');
-        std::getline(gpu_tokens, system_info_->gl_renderer, '|');
+    } else if ((pos = Find(line, kCrashReasonKey)) != string::npos) {
+      StringView crash_reason_tokens =
+          Suffix(line, pos + strlen(kCrashReasonKey));
+      NextToken(&crash_reason_tokens);  // signal
+      crash_reason_ = NextToken(&crash_reason_tokens).str();
+      crash_address_ = HexStrToL<uint64_t>(NextToken(&crash_reason_tokens));
+    } else if ((pos = Find(line, kGpuKey)) != string::npos) {
+      StringView gpu_str = Suffix(line, pos + strlen(kGpuKey));
+      if (gpu_str != kGpuUnknown) {
+        system_info_->gl_version = NextField(&gpu_str, '|').str();
+        system_info_->gl_vendor = NextField(&gpu_str, '|').str();
+        system_info_->gl_renderer = NextField(&gpu_str, '|').str();
       }
-    } else if ((pos = line.find(kMmapKey)) != string::npos) {
-      string mmap_line(line, pos + strlen(kMmapKey));
-      std::istringstream mmap_tokens(mmap_line);
-      string addr, offset, size, identifier, filename;
-      mmap_tokens >> addr;
-      mmap_tokens >> offset;
-      mmap_tokens >> size;
-      mmap_tokens >> identifier;
-      mmap_tokens >> filename;
-
-      modules_->Add(new BasicCodeModule(
+    } else if ((pos = Find(line, kMmapKey)) != string::npos) {
+      StringView mmap_tokens = Suffix(line, pos + strlen(kMmapKey));
+      StringView addr = NextToken(&mmap_tokens);
+      NextToken(&mmap_tokens);  // offset
+      StringView size = NextToken(&mmap_tokens);
+      string identifier = NextToken(&mmap_tokens).str();
+      string filename = NextToken(&mmap_tokens).str();
+
+      modules.push_back(new BasicCodeModule(
           HexStrToL<uint64_t>(addr),  // base_address
           HexStrToL<uint64_t>(size),  // size
           filename,                   // code_file
@@ -402,7 +615,11 @@ Microdump::Microdump(const string& contents)
           ""));                       // version
     }
   }
-  stack_region_->Init(stack_start, stack_content);
+  modules_->Add(modules);
+  // Words a filtered stack left out at its top read back as zeros too.
+  if (stack_filtered && stack_content.size() < stack_length)
+    stack_content.resize(static_cast<size_t>(stack_length));
+  stack_region_->Init(stack_start, std::move(stack_content));
 }
 
 }  // namespace google_breakpad
@@ -39,6 +39,7 @@
 #include <assert.h>
 
 #include <string>
+#include <utility>
 
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/call_stack.h"
@@ -48,6 +49,14 @@
 #include "google_breakpad/processor/stack_frame_symbolizer.h"
 #include "processor/logging.h"
 
+namespace {
+
+const char kGoogleBreakpadKey[] = "google-breakpad";
+const char kMicrodumpBegin[] = "-----BEGIN BREAKPAD MICRODUMP-----";
+const char kMicrodumpEnd[] = "-----END BREAKPAD MICRODUMP-----";
+
+}  // namespace
+
 namespace google_breakpad {
 
 MicrodumpProcessor::MicrodumpProcessor(StackFrameSymbolizer* frame_symbolizer)
@@ -97,4 +106,149 @@ ProcessResult MicrodumpProcessor::Process(Microdump *microdump,
   return PROCESS_OK;
 }
 
+struct MicrodumpStreamProcessor::Job {
+  size_t index;
+  string contents;
+  // The process state refers to the microdump's memory, so the microdump
+  // is kept until the job is reported.
+  std::unique_ptr<Microdump> microdump;
+  ProcessState process_state;
+  ProcessResult result;
+  bool done;
+};
+
+MicrodumpStreamProcessor::MicrodumpStreamProcessor(
+    StackFrameSymbolizer* frame_symbolizer,
+    int worker_count,
+    ResultCallback callback)
+    : frame_symbolizer_(frame_symbolizer),
+      worker_count_(worker_count),
+      callback_(callback),
+      in_microdump_(false),
+      next_index_(0),
+      reporting_(false),
+      stopping_(false) {
+  assert(frame_symbolizer);
+  if (worker_count_ > 1) {
+    for (int i = 0; i < worker_count_; ++i)
+      workers_.push_back(std::thread(&MicrodumpStreamProcessor::RunWorker,
+                                     this));
+  }
+}
+
+MicrodumpStreamProcessor::~MicrodumpStreamProcessor() {
+  Finish();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  pending_ready_.notify_all();
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i].join();
+}
+
+void MicrodumpStreamProcessor::AddLine(const string& line) {
+  // Microdump only reads lines with the breakpad log tag, so drop the rest
+  // here rather than hold on to them.
+  if (line.find(kGoogleBreakpadKey) == string::npos)
+    return;
+
+  if (line.find(kMicrodumpBegin) != string::npos) {
+    // A microdump that never ended is dropped.
+    in_microdump_ = true;
+    contents_.clear();
+  }
+  if (!in_microdump_)
+    return;
+
+  contents_.append(line);
+  contents_.push_back('\n');
+  if (line.find(kMicrodumpEnd) != string::npos) {
+    in_microdump_ = false;
+    string contents;
+    contents.swap(contents_);
+    AddMicrodump(contents);
+  }
+}
+
+void MicrodumpStreamProcessor::AddMicrodump(const string& contents) {
+  if (contents.empty())
+    return;
+
+  size_t index = next_index_++;
+  if (worker_count_ <= 1) {
+    MicrodumpProcessor processor(frame_symbolizer_);
+    Microdump microdump(contents);
+    ProcessState process_state;
+    ProcessResult result = processor.Process(&microdump, &process_state);
+    callback_(index, contents, result, process_state);
+    return;
+  }
+
+  std::unique_ptr<Job> job(new Job);
+  job->index = index;
+  job->contents = contents;
+  job->result = PROCESS_OK;
+  job->done = false;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  const size_t max_unreported = 2 * worker_count_;
+  job_reported_.wait(lock, [&]() {
+    return unreported_.size() < max_unreported;
+  });
+  pending_.push_back(job.get());
+  unreported_.push_back(std::move(job));
+  pending_ready_.notify_one();
+}
+
+void MicrodumpStreamProcessor::Finish() {
+  in_microdump_ = false;
+  contents_.clear();
+  std::unique_lock<std::mutex> lock(mutex_);
+  job_reported_.wait(lock, [&]() {
+    return unreported_.empty() && !reporting_;
+  });
+}
+
+void MicrodumpStreamProcessor::RunWorker() {
+  MicrodumpProcessor processor(frame_symbolizer_);
+  for (;;) {
+    Job* job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      pending_ready_.wait(lock, [&]() {
+        return stopping_ || !pending_.empty();
+      });
+      if (pending_.empty())
+        return;
+      job = pending_.front();
+      pending_.pop_front();
+    }
+
+    job->microdump.reset(new Microdump(job->contents));
+    job->result = processor.Process(job->microdump.get(),
+                                    &job->process_state);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    job->done = true;
+    ReportJobs(&lock);
+  }
+}
+
+void MicrodumpStreamProcessor::ReportJobs(std::unique_lock<std::mutex>* lock) {
+  // Whichever thread finds the front job done reports it, along with any
+  // finished jobs behind it.  Others leave their jobs to that thread.
+  while (!reporting_ && !unreported_.empty() && unreported_.front()->done) {
+    std::unique_ptr<Job> job = std::move(unreported_.front());
+    unreported_.pop_front();
+    reporting_ = true;
+    lock->unlock();
+    callback_(job->index, job->contents, job->result, job->process_state);
+    job.reset();
+    lock->lock();
+    reporting_ = false;
+    job_reported_.notify_all();
+  }
+}
+
 }  // namespace google_breakpad
@@ -34,12 +34,14 @@
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
 #include "breakpad_googletest_includes.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
 #include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/concurrent_source_line_resolver.h"
 #include "google_breakpad/processor/microdump.h"
 #include "google_breakpad/processor/microdump_processor.h"
 #include "google_breakpad/processor/process_state.h"
@@ -51,8 +53,10 @@
 namespace {
 
 using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::ConcurrentSourceLineResolver;
 using google_breakpad::Microdump;
 using google_breakpad::MicrodumpProcessor;
+using google_breakpad::MicrodumpStreamProcessor;
 using google_breakpad::ProcessState;
 using google_breakpad::SimpleSymbolSupplier;
 using google_breakpad::StackFrameSymbolizer;
@@ -280,6 +284,150 @@ TEST_F(MicrodumpProcessorTest, TestProcessMips64) {
             state.threads()->at(0)->frames()->at(0)->module->debug_file());
 }
 
+TEST_F(MicrodumpProcessorTest, TestParse) {
+  // Windows/DOS line endings, lines without the google-breakpad tag, mixed
+  // case hex, and a stack chunk with a stray non-hex digit and an odd
+  // length tail.
+  string contents =
+      "I/other: -----BEGIN BREAKPAD MICRODUMP-----\r\n"
+      "W/google-breakpad( 1): -----BEGIN BREAKPAD MICRODUMP-----\r\n"
+      "W/google-breakpad( 1): O A arm64 04 aarch64 Version 1.2\r\n"
+      "W/google-breakpad( 1): G 3.1|Vendor Name|Renderer\r\n"
+      "W/google-breakpad( 1): R 5 SIGTRAP 4a7CB000\r\n"
+      "W/google-breakpad( 1): S 0 7FE2BA6000 7FE2BA6000 20\r\n"
+      "W/google-breakpad( 1): S 7fe2ba6000 "
+      "000102030405060708090a0B0c0D0e0F\r\n"
+      "W/google-breakpad( 1): S 7FE2BA6010 "
+      "F0E1D2C3b4a5968778695A4B3c2D1e0Fzz1\r\n"
+      "W/google-breakpad( 1): M 7f0000000000 0 2000 ABCD0 libfoo.so\r\n"
+      "W/google-breakpad( 1): -----END BREAKPAD MICRODUMP-----\r\n"
+      "W/google-breakpad( 1): M 7f1000000000 0 2000 ABCD1 libbar.so\n";
+  Microdump microdump(contents);
+
+  google_breakpad::SystemInfo* system_info = microdump.GetSystemInfo();
+  EXPECT_EQ("android", system_info->os_short);
+  EXPECT_EQ("arm64", system_info->cpu);
+  EXPECT_EQ(4, system_info->cpu_count);
+  EXPECT_EQ("Version 1.2", system_info->os_version);
+  EXPECT_EQ("3.1", system_info->gl_version);
+  EXPECT_EQ("Vendor Name", system_info->gl_vendor);
+  EXPECT_EQ("Renderer", system_info->gl_renderer);
+  EXPECT_EQ("SIGTRAP", microdump.GetCrashReason());
+  EXPECT_EQ(0x4a7cb000U, microdump.GetCrashAddress());
+
+  google_breakpad::MicrodumpMemoryRegion* stack = microdump.GetMemory();
+  EXPECT_EQ(0x7fe2ba6000ULL, stack->GetBase());
+  ASSERT_EQ(34U, stack->GetSize());
+  const uint8_t expected[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0xf0, 0xe1, 0xd2, 0xc3, 0xb4, 0xa5, 0x96, 0x87,
+    0x78, 0x69, 0x5a, 0x4b, 0x3c, 0x2d, 0x1e, 0x0f,
+    // A pair that isn't hex decodes as 0, a lone final digit as itself.
+    0x00, 0x01,
+  };
+  for (size_t i = 0; i < sizeof(expected); ++i) {
+    uint8_t byte = 0;
+    ASSERT_TRUE(stack->GetMemoryAtAddress(0x7fe2ba6000ULL + i, &byte));
+    EXPECT_EQ(expected[i], byte) << i;
+  }
+
+  ASSERT_EQ(1U, microdump.GetModules()->module_count());
+  EXPECT_EQ("libfoo.so",
+            microdump.GetModules()->GetModuleAtIndex(0)->code_file());
+}
+
+TEST_F(MicrodumpProcessorTest, TestParseFilteredStack) {
+  // The first 8 bytes in full, then two filtered lines: a word 8 bytes on,
+  // then two words after another 8 bytes, then one word in a later line.
+  // The last 8 bytes of the stack were left out.
+  string contents =
+      "W/google-breakpad( 1): -----BEGIN BREAKPAD MICRODUMP-----\n"
+      "W/google-breakpad( 1): O A arm64 04 aarch64 Version 1.2\n"
+      "W/google-breakpad( 1): S 0 7FE2BA6000 7FE2BA6000 40\n"
+      "W/google-breakpad( 1): S 7FE2BA6000 0001020304050607\n"
+      "W/google-breakpad( 1): F 7FE2BA6008 8:1011121314151617 "
+      "8:20212223242526273031323334353637\n"
+      "W/google-breakpad( 1): F 7FE2BA6030 0:4041424344454647\n"
+      "W/google-breakpad( 1): -----END BREAKPAD MICRODUMP-----\n";
+  Microdump microdump(contents);
+
+  google_breakpad::MicrodumpMemoryRegion* stack = microdump.GetMemory();
+  EXPECT_EQ(0x7fe2ba6000ULL, stack->GetBase());
+  ASSERT_EQ(0x40U, stack->GetSize());
+  uint64_t word = 0;
+  const uint64_t expected[] = {
+    0x0706050403020100ULL, 0, 0x1716151413121110ULL, 0,
+    0x2726252423222120ULL, 0x3736353433323130ULL, 0x4746454443424140ULL, 0,
+  };
+  for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i) {
+    ASSERT_TRUE(stack->GetMemoryAtAddress(0x7fe2ba6000ULL + i * 8, &word));
+    EXPECT_EQ(expected[i], word) << i;
+  }
+}
+
+// One microdump's result, as MicrodumpStreamProcessor reported it.
+struct StreamResult {
+  size_t index;
+  google_breakpad::ProcessResult result;
+  string cpu;
+  size_t frame_count;
+};
+
+TEST_F(MicrodumpProcessorTest, TestStreamProcessor) {
+  string arm64;
+  string x86;
+  ReadFile(files_path_ + "microdump-arm64.dmp", &arm64);
+  ReadFile(files_path_ + "microdump-x86.dmp", &x86);
+  // Log output from other tags, and a microdump that never ends, are
+  // skipped.
+  string round = "I/other( 1): unrelated\n" + arm64 +
+      "W/google-breakpad( 1): -----BEGIN BREAKPAD MICRODUMP-----\n"
+      "W/google-breakpad( 1): O A arm64 02 aarch64 Truncated\n" + x86;
+  const int kRounds = 4;
+
+  for (int worker_count = 1; worker_count <= 3; worker_count += 2) {
+    SimpleSymbolSupplier supplier(files_path_ + "symbols/microdump");
+    ConcurrentSourceLineResolver resolver;
+    StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+    std::vector<StreamResult> results;
+    {
+      MicrodumpStreamProcessor processor(
+          &frame_symbolizer, worker_count,
+          [&](size_t index, const string& contents,
+              google_breakpad::ProcessResult result,
+              const ProcessState& state) {
+            StreamResult stream_result = {
+              index, result, state.system_info()->cpu,
+              state.threads()->empty()
+                  ? 0 : state.threads()->at(0)->frames()->size()
+            };
+            results.push_back(stream_result);
+          });
+      for (int i = 0; i < kRounds; ++i) {
+        std::istringstream lines(round);
+        for (string line; std::getline(lines, line);)
+          processor.AddLine(line);
+      }
+      processor.Finish();
+      EXPECT_EQ(2U * kRounds, processor.microdump_count());
+    }
+
+    ASSERT_EQ(2U * kRounds, results.size()) << worker_count;
+    for (size_t i = 0; i < results.size(); ++i) {
+      EXPECT_EQ(i, results[i].index);
+      EXPECT_EQ(google_breakpad::PROCESS_OK, results[i].result);
+      if (i % 2 == 0) {
+        EXPECT_EQ("arm64", results[i].cpu);
+        EXPECT_EQ(9U, results[i].frame_count);
+      } else {
+        EXPECT_EQ("x86", results[i].cpu);
+        EXPECT_EQ(17U, results[i].frame_count);
+      }
+    }
+  }
+}
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
@@ -33,8 +33,12 @@
 #include <config.h>  // Must come first
 #endif
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include <fstream>
@@ -45,8 +49,10 @@
 #include "common/scoped_ptr.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/concurrent_source_line_resolver.h"
 #include "google_breakpad/processor/microdump.h"
 #include "google_breakpad/processor/microdump_processor.h"
+#include "google_breakpad/processor/missing_symbols_cache.h"
 #include "google_breakpad/processor/process_state.h"
 #include "google_breakpad/processor/stack_frame_symbolizer.h"
 #include "processor/logging.h"
@@ -62,15 +68,28 @@ struct Options {
 
   string microdump_file;
   std::vector<string> symbol_paths;
+
+  // Service mode processes every microdump in the log output read from
+  // |service_input| ("-" for stdin), or from each connection to a Unix
+  // socket listening at |service_socket|, with one resolver and symbol
+  // supplier.  |service_workers| microdumps are processed at once.
+  bool service;
+  string service_input;
+  string service_socket;
+  int service_workers;
 };
 
 using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::ConcurrentSourceLineResolver;
 using google_breakpad::Microdump;
 using google_breakpad::MicrodumpProcessor;
+using google_breakpad::MicrodumpStreamProcessor;
+using google_breakpad::MissingSymbolsCache;
 using google_breakpad::ProcessResult;
 using google_breakpad::ProcessState;
 using google_breakpad::scoped_ptr;
 using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::SourceLineResolverBase;
 using google_breakpad::StackFrameSymbolizer;
 
 // Processes |options.microdump_file| using
@@ -125,18 +144,172 @@ int PrintMicrodumpProcess(const Options& options) {
   return 1;
 }
 
+// Prints one microdump's result in service mode, after a line that
+// introduces it.
+void PrintServiceResult(const Options& options,
+                        SourceLineResolverBase* resolver,
+                        size_t index,
+                        ProcessResult result,
+                        const ProcessState& process_state) {
+  bool processed = result == google_breakpad::PROCESS_OK;
+  if (options.machine_readable) {
+    printf("Microdump|%zu|%s\n", index, processed ? "OK" : "FAILED");
+    if (processed)
+      PrintProcessStateMachineReadable(process_state);
+  } else {
+    printf("%sMicrodump %zu%s\n", index ? "\n" : "", index,
+           processed ? "" : " could not be processed");
+    if (processed) {
+      PrintProcessState(process_state, options.output_stack_contents,
+                        /*output_requesting_thread_only=*/false, resolver);
+    }
+  }
+  fflush(stdout);
+}
+
+// Feeds the lines read from |fd| to |processor| until the end of input.
+void ReadLogLines(int fd, MicrodumpStreamProcessor* processor) {
+  char buffer[64 * 1024];
+  string line;
+  for (;;) {
+    ssize_t bytes_read = read(fd, buffer, sizeof(buffer));
+    if (bytes_read < 0 && errno == EINTR)
+      continue;
+    if (bytes_read <= 0)
+      break;
+    const char* start = buffer;
+    const char* end = buffer + bytes_read;
+    while (const char* newline =
+               static_cast<const char*>(memchr(start, '\n', end - start))) {
+      line.append(start, newline - start);
+      processor->AddLine(line);
+      line.clear();
+      start = newline + 1;
+    }
+    line.append(start, end - start);
+  }
+  if (!line.empty())
+    processor->AddLine(line);
+}
+
+// Returns a socket listening at |path|, or -1 on failure.
+int ListenAt(const string& path) {
+  struct sockaddr_un addr;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    BPLOG(ERROR) << "Socket path is too long: " << path;
+    return -1;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path, path.c_str(), path.size());
+  unlink(path.c_str());
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    BPLOG(ERROR) << "Could not listen at " << path << ": " << strerror(errno);
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Processes the microdumps in the log output that |options| names, keeping
+// symbols loaded from one microdump to the next.  Reading from a socket
+// goes on until the process is killed, one connection at a time.  Returns
+// 0 if every microdump was processed.
+int PrintMicrodumpService(const Options& options) {
+  scoped_ptr<SimpleSymbolSupplier> symbol_supplier;
+  if (!options.symbol_paths.empty())
+    symbol_supplier.reset(new SimpleSymbolSupplier(options.symbol_paths));
+
+  // Several workers share one resolver, which must then allow modules to
+  // be loaded while others are looked up.
+  scoped_ptr<BasicSourceLineResolver> basic_resolver;
+  scoped_ptr<ConcurrentSourceLineResolver> concurrent_resolver;
+  SourceLineResolverBase* resolver;
+  if (options.service_workers > 1) {
+    concurrent_resolver.reset(new ConcurrentSourceLineResolver());
+    resolver = concurrent_resolver.get();
+  } else {
+    basic_resolver.reset(new BasicSourceLineResolver());
+    resolver = basic_resolver.get();
+  }
+
+  MissingSymbolsCache missing_symbols;
+  StackFrameSymbolizer symbolizer(symbol_supplier.get(), resolver);
+  symbolizer.set_missing_symbols_cache(&missing_symbols);
+  symbolizer.set_persist_frame_info_cache(true);
+  symbolizer.set_cache_source_line_info(true);
+
+  bool all_processed = true;
+  MicrodumpStreamProcessor processor(
+      &symbolizer, options.service_workers,
+      [&](size_t index, const string& contents, ProcessResult result,
+          const ProcessState& process_state) {
+        all_processed &= result == google_breakpad::PROCESS_OK;
+        PrintServiceResult(options, resolver, index, result,
+                           process_state);
+      });
+
+  if (!options.service_socket.empty()) {
+    int listen_fd = ListenAt(options.service_socket);
+    if (listen_fd < 0)
+      return 1;
+    for (;;) {
+      int fd = accept(listen_fd, NULL, NULL);
+      if (fd < 0) {
+        if (errno == EINTR)
+          continue;
+        BPLOG(ERROR) << "accept failed: " << strerror(errno);
+        close(listen_fd);
+        return 1;
+      }
+      ReadLogLines(fd, &processor);
+      close(fd);
+      processor.Finish();
+    }
+  }
+
+  int fd = STDIN_FILENO;
+  if (options.service_input != "-") {
+    fd = open(options.service_input.c_str(), O_RDONLY);
+    if (fd < 0) {
+      BPLOG(ERROR) << "Could not open " << options.service_input;
+      return 1;
+    }
+  }
+  ReadLogLines(fd, &processor);
+  if (fd != STDIN_FILENO)
+    close(fd);
+  processor.Finish();
+  return all_processed ? 0 : 1;
+}
+
 }  // namespace
 
 static void Usage(int argc, const char *argv[], bool error) {
   fprintf(error ? stderr : stdout,
           "Usage: %s [options] <microdump-file> [symbol-path ...]\n"
+          "       %s [options] -i <log-file> [symbol-path ...]\n"
+          "       %s [options] -l <socket-path> [symbol-path ...]\n"
           "\n"
-          "Output a stack trace for the provided microdump\n"
+          "Output a stack trace for the provided microdump, or for every\n"
+          "microdump in a stream of log output\n"
           "\n"
           "Options:\n"
           "\n"
           "  -m         Output in machine-readable format\n"
-          "  -s         Output stack contents\n",
+          "  -s         Output stack contents\n"
+          "  -i <file>  Process the microdumps in log output read from\n"
+          "             <file>, or from stdin if it is -\n"
+          "  -l <path>  Listen on a Unix socket at <path>, and process the\n"
+          "             microdumps in the log output written to each\n"
+          "             connection\n"
+          "  -j <n>     With -i or -l, process <n> microdumps at once\n",
+          google_breakpad::BaseName(argv[0]).c_str(),
+          google_breakpad::BaseName(argv[0]).c_str(),
           google_breakpad::BaseName(argv[0]).c_str());
 }
 
@@ -145,8 +318,10 @@ static void SetupOptions(int argc, const char *argv[], Options* options) {
 
   options->machine_readable = false;
   options->output_stack_contents = false;
+  options->service = false;
+  options->service_workers = 1;
 
-  while ((ch = getopt(argc, (char * const*)argv, "hms")) != -1) {
+  while ((ch = getopt(argc, (char * const*)argv, "hi:j:l:ms")) != -1) {
     switch (ch) {
       case 'h':
         Usage(argc, argv, false);
@@ -159,6 +334,21 @@ static void SetupOptions(int argc, const char *argv[], Options* options) {
       case 's':
         options->output_stack_contents = true;
         break;
+      case 'i':
+        options->service = true;
+        options->service_input = optarg;
+        break;
+      case 'l':
+        options->service = true;
+        options->service_socket = optarg;
+        break;
+      case 'j':
+        options->service_workers = atoi(optarg);
+        if (options->service_workers < 1) {
+          fprintf(stderr, "%s: -j needs a positive number\n", argv[0]);
+          exit(1);
+        }
+        break;
 
       case '?':
         Usage(argc, argv, true);
@@ -167,6 +357,12 @@ static void SetupOptions(int argc, const char *argv[], Options* options) {
     }
   }
 
+  if (options->service) {
+    for (int argi = optind; argi < argc; ++argi)
+      options->symbol_paths.push_back(argv[argi]);
+    return;
+  }
+
   if ((argc - optind) == 0) {
     fprintf(stderr, "%s: Missing microdump file\n", argv[0]);
     Usage(argc, argv, true);
@@ -183,5 +379,7 @@ int main(int argc, const char* argv[]) {
   Options options;
   SetupOptions(argc, argv, &options);
 
+  if (options.service)
+    return PrintMicrodumpService(options);
   return PrintMicrodumpProcess(options);
 }
@@ -54,24 +54,32 @@
 #ifdef _WIN32
 #include <io.h>
 #else  // _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif  // _WIN32
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <limits>
+#include <list>
+#include <unordered_map>
 #include <utility>
 
 #include "processor/range_map-inl.h"
 
+#include "common/block_gzip.h"
 #include "common/macros.h"
 #include "common/scoped_ptr.h"
 #include "common/stdio_wrapper.h"
 #include "google_breakpad/processor/dump_context.h"
 #include "processor/basic_code_module.h"
 #include "processor/basic_code_modules.h"
+#include "processor/byte_swap.h"
 #include "processor/convert_old_arm64_context.h"
 #include "processor/logging.h"
+#include "processor/trace_probes.h"
 
 namespace google_breakpad {
 
@@ -82,6 +90,20 @@ using std::vector;
 
 namespace {
 
+// Asks the kernel to start reading the |ranges| of the file at |path|, each
+// an offset and a length, into the page cache, without waiting for them.
+void AdviseWillNeed(const string& path,
+                    const vector<std::pair<off_t, off_t> >& ranges) {
+#ifdef POSIX_FADV_WILLNEED
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return;
+  for (const std::pair<off_t, off_t>& range : ranges)
+    posix_fadvise(fd, range.first, range.second, POSIX_FADV_WILLNEED);
+  close(fd);
+#endif  // POSIX_FADV_WILLNEED
+}
+
 // Limit arrived at by adding up possible states in Intel Ch. 13.5 X-SAVE
 // MANAGED STATE
 // (~ 3680 bytes) plus some extra for the future.
@@ -258,19 +280,60 @@ inline void Swap(uint16_t* data, size_t size_in_bytes) {
 // parameter, a converter that uses iconv would also need to take the host
 // CPU's endianness into consideration.  It doesn't seems worth the trouble
 // of making it a dependency when we don't care about anything but UTF-16.
-string* UTF16ToUTF8(const vector<uint16_t>& in, bool swap) {
-  scoped_ptr<string> out(new string());
+// Returns true if the |length| UTF-16 code units at |in| are all ASCII.
+// Four code units are checked at a time.
+bool IsUTF16ASCII(const uint8_t* in, size_t length, bool swap) {
+  // The bits of four code units, as loaded into a uint64_t, that are clear
+  // in ASCII ones.  Swapping moves each unit's high byte to the other end.
+  const uint64_t mask = swap ? 0x80ff80ff80ff80ffULL : 0xff80ff80ff80ff80ULL;
+  size_t index = 0;
+  for (; index + 4 <= length; index += 4) {
+    uint64_t units;
+    memcpy(&units, in + index * 2, sizeof(units));
+    if (units & mask)
+      return false;
+  }
+  for (; index < length; ++index) {
+    uint16_t unit;
+    memcpy(&unit, in + index * 2, sizeof(unit));
+    if (swap)
+      Swap(&unit);
+    if (unit >= 0x80)
+      return false;
+  }
+  return true;
+}
+
+// Converts the |length| UTF-16 code units at |in|, which need not be
+// aligned, to UTF-8 in |out|, reusing its storage.  Returns false if |in| is
+// not valid UTF-16.
+bool UTF16ToUTF8(const void* in, size_t length, bool swap, string* out) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(in);
+
+  // Nearly every string in a minidump is ASCII, which narrows one code unit
+  // to one byte.
+  if (IsUTF16ASCII(bytes, length, swap)) {
+    out->resize(length);
+    for (size_t index = 0; index < length; ++index) {
+      uint16_t unit;
+      memcpy(&unit, bytes + index * 2, sizeof(unit));
+      if (swap)
+        Swap(&unit);
+      (*out)[index] = static_cast<char>(unit);
+    }
+    return true;
+  }
 
   // Set the string's initial capacity to the number of UTF-16 characters,
   // because the UTF-8 representation will always be at least this long.
   // If the UTF-8 representation is longer, the string will grow dynamically.
-  out->reserve(in.size());
+  out->clear();
+  out->reserve(length);
 
-  for (vector<uint16_t>::const_iterator iterator = in.begin();
-       iterator != in.end();
-       ++iterator) {
+  for (size_t index = 0; index < length; ++index) {
     // Get a 16-bit value from the input
-    uint16_t in_word = *iterator;
+    uint16_t in_word;
+    memcpy(&in_word, bytes + index * 2, sizeof(in_word));
     if (swap)
       Swap(&in_word);
 
@@ -279,22 +342,24 @@ string* UTF16ToUTF8(const vector<uint16_t>& in, bool swap) {
     if (in_word >= 0xdc00 && in_word <= 0xdcff) {
       BPLOG(ERROR) << "UTF16ToUTF8 found low surrogate " <<
                       HexString(in_word) << " without high";
-      return NULL;
+      return false;
     } else if (in_word >= 0xd800 && in_word <= 0xdbff) {
       // High surrogate.
       unichar = (in_word - 0xd7c0) << 10;
-      if (++iterator == in.end()) {
+      if (++index == length) {
         BPLOG(ERROR) << "UTF16ToUTF8 found high surrogate " <<
                         HexString(in_word) << " at end of string";
-        return NULL;
+        return false;
       }
       uint32_t high_word = in_word;
-      in_word = *iterator;
+      memcpy(&in_word, bytes + index * 2, sizeof(in_word));
+      if (swap)
+        Swap(&in_word);
       if (in_word < 0xdc00 || in_word > 0xdcff) {
         BPLOG(ERROR) << "UTF16ToUTF8 found high surrogate " <<
                         HexString(high_word) << " without low " <<
                         HexString(in_word);
-        return NULL;
+        return false;
       }
       unichar |= in_word & 0x03ff;
     } else {
@@ -322,11 +387,11 @@ string* UTF16ToUTF8(const vector<uint16_t>& in, bool swap) {
     } else {
       BPLOG(ERROR) << "UTF16ToUTF8 cannot represent high value " <<
                       HexString(unichar) << " in UTF-8";
-      return NULL;
+      return false;
     }
   }
 
-  return out.release();
+  return true;
 }
 
 // Return the smaller of the number of code units in the UTF-16 string,
@@ -359,17 +424,8 @@ void ConvertUTF16BufferToUTF8String(const uint16_t* utf16_data,
   // length from that.
   size_t max_word_length = max_length_in_bytes / sizeof(utf16_data[0]);
   size_t word_length = UTF16codeunits(utf16_data, max_word_length);
-  if (word_length > 0) {
-    size_t byte_length = word_length * sizeof(utf16_data[0]);
-    vector<uint16_t> utf16_vector(word_length);
-    memcpy(&utf16_vector[0], &utf16_data[0], byte_length);
-    scoped_ptr<string> temp(UTF16ToUTF8(utf16_vector, swap));
-    if (temp.get()) {
-      utf8_result->assign(*temp);
-    }
-  } else {
+  if (!UTF16ToUTF8(utf16_data, word_length, swap, utf8_result))
     utf8_result->clear();
-  }
 }
 
 
@@ -1497,8 +1553,11 @@ uint32_t MinidumpMemoryRegion::max_bytes_ = 64 * 1024 * 1024;  // 64MB
 
 MinidumpMemoryRegion::MinidumpMemoryRegion(Minidump* minidump)
     : MinidumpObject(minidump),
-      descriptor_(NULL),
-      memory_(NULL) {
+      base_(0),
+      size_(0),
+      rva_(0),
+      memory_(NULL),
+      mapped_memory_(NULL) {
   hexdump_width_ = minidump_ ? minidump_->HexdumpMode() : 0;
   hexdump_ = hexdump_width_ != 0;
 }
@@ -1510,11 +1569,23 @@ MinidumpMemoryRegion::~MinidumpMemoryRegion() {
 
 
 void MinidumpMemoryRegion::SetDescriptor(MDMemoryDescriptor* descriptor) {
-  descriptor_ = descriptor;
-  valid_ = descriptor &&
-           descriptor_->memory.data_size <=
-               numeric_limits<uint64_t>::max() -
-               descriptor_->start_of_memory_range;
+  if (!descriptor) {
+    FreeMemory();
+    valid_ = false;
+    return;
+  }
+  SetRange(descriptor->start_of_memory_range, descriptor->memory.data_size,
+           descriptor->memory.rva);
+}
+
+
+void MinidumpMemoryRegion::SetRange(uint64_t base, uint32_t size,
+                                    uint64_t rva) {
+  FreeMemory();
+  base_ = base;
+  size_ = size;
+  rva_ = rva;
+  valid_ = size <= numeric_limits<uint64_t>::max() - base;
 }
 
 
@@ -1524,28 +1595,43 @@ const uint8_t* MinidumpMemoryRegion::GetMemory() const {
     return NULL;
   }
 
+  if (mapped_memory_) {
+    return mapped_memory_;
+  }
+
   if (!memory_) {
-    if (descriptor_->memory.data_size == 0) {
+    if (size_ == 0) {
       BPLOG(ERROR) << "MinidumpMemoryRegion is empty";
       return NULL;
     }
 
-    if (!minidump_->SeekSet(descriptor_->memory.rva)) {
+    if (minidump_->IsInMemory()) {
+      // The minidump data is already in memory, so there's nothing to copy
+      // and max_bytes_ doesn't apply.
+      mapped_memory_ = minidump_->GetDataAtOffset(
+          rva_, size_);
+      if (!mapped_memory_) {
+        BPLOG(ERROR) << "MinidumpMemoryRegion memory region out of range";
+      }
+      return mapped_memory_;
+    }
+
+    if (!minidump_->SeekSet(rva_)) {
       BPLOG(ERROR) << "MinidumpMemoryRegion could not seek to memory region";
       return NULL;
     }
 
-    if (descriptor_->memory.data_size > max_bytes_) {
+    if (size_ > max_bytes_) {
       BPLOG(ERROR) << "MinidumpMemoryRegion size " <<
-                      descriptor_->memory.data_size << " exceeds maximum " <<
+                      size_ << " exceeds maximum " <<
                       max_bytes_;
       return NULL;
     }
 
     scoped_ptr< vector<uint8_t> > memory(
-        new vector<uint8_t>(descriptor_->memory.data_size));
+        new vector<uint8_t>(size_));
 
-    if (!minidump_->ReadBytes(&(*memory)[0], descriptor_->memory.data_size)) {
+    if (!minidump_->ReadBytes(&(*memory)[0], size_)) {
       BPLOG(ERROR) << "MinidumpMemoryRegion could not read memory region";
       return NULL;
     }
@@ -1563,7 +1649,7 @@ uint64_t MinidumpMemoryRegion::GetBase() const {
     return static_cast<uint64_t>(-1);
   }
 
-  return descriptor_->start_of_memory_range;
+  return base_;
 }
 
 
@@ -1573,13 +1659,53 @@ uint32_t MinidumpMemoryRegion::GetSize() const {
     return 0;
   }
 
-  return descriptor_->memory.data_size;
+  return size_;
 }
 
 
 void MinidumpMemoryRegion::FreeMemory() {
   delete memory_;
   memory_ = NULL;
+  mapped_memory_ = NULL;
+}
+
+
+bool MinidumpMemoryRegion::CopyMemory(uint32_t offset, void* bytes,
+                                      size_t count) const {
+  if (memory_ || mapped_memory_ || minidump_->IsInMemory() ||
+      Minidump::page_cache_budget() == 0) {
+    const uint8_t* memory = GetMemory();
+    if (!memory) {
+      // GetMemory already logged a perfectly good message.
+      return false;
+    }
+    memcpy(bytes, &memory[offset], count);
+    return true;
+  }
+
+  // Read only the pages that hold the bytes, so that a large region that
+  // is barely touched, such as a stack being walked, is not read whole.
+  uint8_t* out = static_cast<uint8_t*>(bytes);
+  while (count > 0) {
+    const uint32_t page_offset = offset % Minidump::kPageCachePageSize;
+    const uint32_t page_start = offset - page_offset;
+    const uint32_t page_size =
+        std::min(Minidump::kPageCachePageSize,
+                 size_ - page_start);
+    const uint8_t* page = minidump_->ReadCachedPage(
+        rva_ + page_start, page_size);
+    if (!page) {
+      BPLOG(ERROR) << "MinidumpMemoryRegion could not read memory page";
+      return false;
+    }
+    const size_t copied =
+        std::min(count, static_cast<size_t>(page_size - page_offset));
+    memcpy(out, page + page_offset, copied);
+    out += copied;
+    offset += copied;
+    count -= copied;
+  }
+  return true;
 }
 
 
@@ -1598,28 +1724,25 @@ bool MinidumpMemoryRegion::GetMemoryAtAddressInternal(uint64_t address,
   }
 
   // Common failure case
-  if (address < descriptor_->start_of_memory_range ||
+  if (address < base_ ||
       sizeof(T) > numeric_limits<uint64_t>::max() - address ||
-      address + sizeof(T) > descriptor_->start_of_memory_range +
-                            descriptor_->memory.data_size) {
+      address + sizeof(T) > base_ +
+                            size_) {
     BPLOG(INFO) << "MinidumpMemoryRegion request out of range: " <<
                     HexString(address) << "+" << sizeof(T) << "/" <<
-                    HexString(descriptor_->start_of_memory_range) << "+" <<
-                    HexString(descriptor_->memory.data_size);
+                    HexString(base_) << "+" <<
+                    HexString(size_);
     return false;
   }
 
-  const uint8_t* memory = GetMemory();
-  if (!memory) {
-    // GetMemory already logged a perfectly good message.
+  // Memory mapped out of the minidump need not be aligned, so copy rather
+  // than dereference.
+  if (!CopyMemory(address - base_, value,
+                  sizeof(T))) {
+    // CopyMemory already logged a perfectly good message.
     return false;
   }
 
-  // If the CPU requires memory accesses to be aligned, this can crash.
-  // x86 and ppc are able to cope, though.
-  *value = *reinterpret_cast<const T*>(
-      &memory[address - descriptor_->start_of_memory_range]);
-
   if (minidump_->swap())
     Swap(value);
 
@@ -1651,6 +1774,58 @@ bool MinidumpMemoryRegion::GetMemoryAtAddress(uint64_t  address,
 }
 
 
+template<typename T>
+bool MinidumpMemoryRegion::GetMemoryArrayAtAddressInternal(uint64_t address,
+                                                           T*       values,
+                                                           size_t   count)
+    const {
+  if (!valid_) {
+    BPLOG(ERROR) << "Invalid MinidumpMemoryRegion for "
+                    "GetMemoryArrayAtAddressInternal";
+    return false;
+  }
+
+  if (!ContainsArray<T>(address, count)) {
+    BPLOG(INFO) << "MinidumpMemoryRegion array request out of range: " <<
+                    HexString(address) << "+" << count << "*" << sizeof(T) <<
+                    "/" << HexString(base_) <<
+                    "+" << HexString(size_);
+    return false;
+  }
+
+  if (count == 0) {
+    return true;
+  }
+
+  if (!CopyMemory(address - base_, values,
+                  count * sizeof(T))) {
+    // CopyMemory already logged a perfectly good message.
+    return false;
+  }
+
+  if (minidump_->swap()) {
+    for (size_t i = 0; i < count; ++i)
+      Swap(&values[i]);
+  }
+
+  return true;
+}
+
+
+bool MinidumpMemoryRegion::GetMemoryArrayAtAddress(uint64_t  address,
+                                                   uint32_t* values,
+                                                   size_t    count) const {
+  return GetMemoryArrayAtAddressInternal(address, values, count);
+}
+
+
+bool MinidumpMemoryRegion::GetMemoryArrayAtAddress(uint64_t  address,
+                                                   uint64_t* values,
+                                                   size_t    count) const {
+  return GetMemoryArrayAtAddressInternal(address, values, count);
+}
+
+
 void MinidumpMemoryRegion::Print() const {
   if (!valid_) {
     BPLOG(ERROR) << "MinidumpMemoryRegion cannot print invalid data";
@@ -1662,11 +1837,11 @@ void MinidumpMemoryRegion::Print() const {
     if (hexdump_) {
       // Pretty hexdump view.
       for (unsigned int byte_index = 0;
-           byte_index < descriptor_->memory.data_size;
+           byte_index < size_;
            byte_index += hexdump_width_) {
         // In case the memory won't fill a whole line.
         unsigned int num_bytes = std::min(
-            descriptor_->memory.data_size - byte_index, hexdump_width_);
+            size_ - byte_index, hexdump_width_);
 
         // Display the leading address.
         printf("%08x  ", byte_index);
@@ -1704,7 +1879,7 @@ void MinidumpMemoryRegion::Print() const {
       // Ugly raw string view.
       printf("0x");
       for (unsigned int i = 0;
-           i < descriptor_->memory.data_size;
+           i < size_;
            i++) {
         printf("%02x", memory[i]);
       }
@@ -1974,6 +2149,7 @@ bool MinidumpThreadList::Read(uint32_t expected_size) {
   if (thread_count != 0) {
     scoped_ptr<MinidumpThreads> threads(
         new MinidumpThreads(thread_count, MinidumpThread(minidump_)));
+    id_to_thread_map_.reserve(thread_count);
 
     for (unsigned int thread_index = 0;
          thread_index < thread_count;
@@ -2005,6 +2181,13 @@ bool MinidumpThreadList::Read(uint32_t expected_size) {
     }
 
     threads_ = threads.release();
+
+    if (minidump_->readahead()) {
+      vector<MDLocationDescriptor> stacks;
+      for (const MinidumpThread& thread : *threads_)
+        stacks.push_back(thread.thread()->stack.memory);
+      minidump_->ReadAhead(stacks);
+    }
   }
 
   thread_count_ = thread_count;
@@ -2031,10 +2214,11 @@ MinidumpThread* MinidumpThreadList::GetThreadAtIndex(unsigned int index)
 }
 
 
-MinidumpThread* MinidumpThreadList::GetThreadByID(uint32_t thread_id) {
+MinidumpThread* MinidumpThreadList::GetThreadByID(uint32_t thread_id) const {
   // Don't check valid_.  Read calls this method before everything is
   // validated.  It is safe to not check valid_ here.
-  return id_to_thread_map_[thread_id];
+  IDToThreadMap::const_iterator it = id_to_thread_map_.find(thread_id);
+  return it == id_to_thread_map_.end() ? NULL : it->second;
 }
 
 
@@ -2172,6 +2356,7 @@ bool MinidumpThreadNameList::Read(uint32_t expected_size) {
   delete thread_names_;
   thread_names_ = NULL;
   thread_name_count_ = 0;
+  id_to_thread_name_map_.clear();
 
   valid_ = false;
 
@@ -2238,6 +2423,13 @@ bool MinidumpThreadNameList::Read(uint32_t expected_size) {
       }
     }
 
+    id_to_thread_name_map_.reserve(thread_name_count);
+    for (MinidumpThreadName& thread_name : *thread_names) {
+      uint32_t thread_id;
+      if (thread_name.GetThreadID(&thread_id))
+        id_to_thread_name_map_.insert(std::make_pair(thread_id, &thread_name));
+    }
+
     thread_names_ = thread_names.release();
   }
 
@@ -2263,6 +2455,18 @@ MinidumpThreadName* MinidumpThreadNameList::GetThreadNameAtIndex(
   return &(*thread_names_)[index];
 }
 
+MinidumpThreadName* MinidumpThreadNameList::GetThreadNameByID(
+    uint32_t thread_id) const {
+  if (!valid_) {
+    BPLOG(ERROR) << "Invalid MinidumpThreadNameList for GetThreadNameByID";
+    return NULL;
+  }
+
+  IDToThreadNameMap::const_iterator it =
+      id_to_thread_name_map_.find(thread_id);
+  return it == id_to_thread_name_map_.end() ? NULL : it->second;
+}
+
 void MinidumpThreadNameList::Print() {
   if (!valid_) {
     BPLOG(ERROR) << "MinidumpThreadNameList cannot print invalid data";
@@ -2309,7 +2513,7 @@ MinidumpModule::~MinidumpModule() {
 }
 
 
-bool MinidumpModule::Read() {
+bool MinidumpModule::Read(const uint8_t* raw_module) {
   // Invalidate cached data.
   delete name_;
   name_ = NULL;
@@ -2323,35 +2527,7 @@ bool MinidumpModule::Read() {
   has_debug_info_ = false;
   valid_ = false;
 
-  if (!minidump_->ReadBytes(&module_, MD_MODULE_SIZE)) {
-    BPLOG(ERROR) << "MinidumpModule cannot read module";
-    return false;
-  }
-
-  if (minidump_->swap()) {
-    Swap(&module_.base_of_image);
-    Swap(&module_.size_of_image);
-    Swap(&module_.checksum);
-    Swap(&module_.time_date_stamp);
-    Swap(&module_.module_name_rva);
-    Swap(&module_.version_info.signature);
-    Swap(&module_.version_info.struct_version);
-    Swap(&module_.version_info.file_version_hi);
-    Swap(&module_.version_info.file_version_lo);
-    Swap(&module_.version_info.product_version_hi);
-    Swap(&module_.version_info.product_version_lo);
-    Swap(&module_.version_info.file_flags_mask);
-    Swap(&module_.version_info.file_flags);
-    Swap(&module_.version_info.file_os);
-    Swap(&module_.version_info.file_type);
-    Swap(&module_.version_info.file_subtype);
-    Swap(&module_.version_info.file_date_hi);
-    Swap(&module_.version_info.file_date_lo);
-    Swap(&module_.cv_record);
-    Swap(&module_.misc_record);
-    // Don't swap reserved fields because their contents are unknown (as
-    // are their proper widths).
-  }
+  memcpy(&module_, raw_module, MD_MODULE_SIZE);
 
   // Check for base + size overflow or undersize.
   if (module_.size_of_image == 0 ||
@@ -2561,18 +2737,11 @@ string MinidumpModule::debug_file() const {
         if (bytes % 2 == 0) {
           size_t utf16_words = bytes / 2;
 
-          // UTF16ToUTF8 expects a vector<uint16_t>, so create a temporary one
-          // and copy the UTF-16 data into it.
-          vector<uint16_t> string_utf16(utf16_words);
-          if (utf16_words)
-            memcpy(&string_utf16[0], &misc_record->data, bytes);
-
           // GetMiscRecord already byte-swapped the data[] field if it contains
           // UTF-16, so pass false as the swap argument.
-          scoped_ptr<string> new_file(UTF16ToUTF8(string_utf16, false));
-          if (new_file.get() != nullptr) {
-            file = *new_file;
-          }
+          string new_file;
+          if (UTF16ToUTF8(&misc_record->data, utf16_words, false, &new_file))
+            file.swap(new_file);
         }
       }
     }
@@ -3119,6 +3288,8 @@ MinidumpModuleList::~MinidumpModuleList() {
 bool MinidumpModuleList::Read(uint32_t expected_size) {
   // Invalidate cached data.
   range_map_->Clear();
+  ranges_.clear();
+  code_file_index_.clear();
   delete modules_;
   modules_ = NULL;
   module_count_ = 0;
@@ -3174,12 +3345,21 @@ bool MinidumpModuleList::Read(uint32_t expected_size) {
     scoped_ptr<MinidumpModules> modules(
         new MinidumpModules(module_count, MinidumpModule(minidump_)));
 
+    // Read and swap all of the module records at once.
+    vector<uint8_t> raw_modules(static_cast<size_t>(module_count) *
+                                MD_MODULE_SIZE);
+    if (!minidump_->ReadBytes(&raw_modules[0], raw_modules.size())) {
+      BPLOG(ERROR) << "MinidumpModuleList could not read modules";
+      return false;
+    }
+    if (minidump_->swap())
+      SwapModuleRecordArray(&raw_modules[0], module_count);
+
     for (uint32_t module_index = 0; module_index < module_count;
          ++module_index) {
       MinidumpModule* module = &(*modules)[module_index];
 
-      // Assume that the file offset is correct after the last read.
-      if (!module->Read()) {
+      if (!module->Read(&raw_modules[module_index * MD_MODULE_SIZE])) {
         BPLOG(ERROR) << "MinidumpModuleList could not read module " <<
                         module_index << "/" << module_count;
         return false;
@@ -3265,6 +3445,7 @@ bool MinidumpModuleList::Read(uint32_t expected_size) {
     }
 
     modules_ = modules.release();
+    IndexModules();
   }
 
   module_count_ = module_count;
@@ -3296,6 +3477,34 @@ bool MinidumpModuleList::StoreRange(const MinidumpModule& module,
   return false;
 }
 
+void MinidumpModuleList::IndexModules() {
+  ranges_.reserve(range_map_->GetCount());
+
+  // Walk the map from the top down, one nearest-range lookup per module,
+  // rather than by RetrieveRangeAtIndex, which walks the map from its start
+  // on every call.
+  uint64_t address = ~static_cast<uint64_t>(0);
+  unsigned int module_index = 0;
+  uint64_t base = 0;
+  uint64_t size = 0;
+  while (range_map_->RetrieveNearestRange(address, &module_index, &base,
+                                          NULL /* delta */, &size)) {
+    ModuleRange range = { base, base + size - 1, module_index };
+    ranges_.push_back(range);
+    if (base == 0)
+      break;
+    address = base - 1;
+  }
+  std::reverse(ranges_.begin(), ranges_.end());
+
+  code_file_index_.reserve(ranges_.size());
+  for (size_t i = 0; i < ranges_.size(); ++i) {
+    code_file_index_.insert(std::make_pair(
+        (*modules_)[ranges_[i].module_index].code_file(),
+        ranges_[i].module_index));
+  }
+}
+
 const MinidumpModule* MinidumpModuleList::GetModuleForAddress(
     uint64_t address) const {
   if (!valid_) {
@@ -3303,15 +3512,15 @@ const MinidumpModule* MinidumpModuleList::GetModuleForAddress(
     return NULL;
   }
 
-  unsigned int module_index;
-  if (!range_map_->RetrieveRange(address, &module_index, NULL /* base */,
-                                 NULL /* delta */, NULL /* size */)) {
+  vector<ModuleRange>::const_iterator range =
+      std::lower_bound(ranges_.begin(), ranges_.end(), address);
+  if (range == ranges_.end() || address < range->base) {
     BPLOG(INFO) << "MinidumpModuleList has no module at " <<
                    HexString(address);
     return NULL;
   }
 
-  return GetModuleAtIndex(module_index);
+  return GetModuleAtIndex(range->module_index);
 }
 
 
@@ -3340,15 +3549,12 @@ const MinidumpModule* MinidumpModuleList::GetModuleAtSequence(
     return NULL;
   }
 
-  unsigned int module_index;
-  if (!range_map_->RetrieveRangeAtIndex(sequence, &module_index,
-                                        NULL /* base */, NULL /* delta */,
-                                        NULL /* size */)) {
+  if (sequence >= ranges_.size()) {
     BPLOG(ERROR) << "MinidumpModuleList has no module at sequence " << sequence;
     return NULL;
   }
 
-  return GetModuleAtIndex(module_index);
+  return GetModuleAtIndex(ranges_[sequence].module_index);
 }
 
 
@@ -3369,13 +3575,50 @@ const MinidumpModule* MinidumpModuleList::GetModuleAtIndex(
 }
 
 
+const MinidumpModule* MinidumpModuleList::GetModuleForCodeFile(
+    const string& code_file) const {
+  if (!valid_) {
+    BPLOG(ERROR) << "Invalid MinidumpModuleList for GetModuleForCodeFile";
+    return NULL;
+  }
+
+  std::unordered_map<string, unsigned int>::const_iterator it =
+      code_file_index_.find(code_file);
+  if (it == code_file_index_.end())
+    return NULL;
+
+  return GetModuleAtIndex(it->second);
+}
+
+
 const CodeModules* MinidumpModuleList::Copy() const {
   return new BasicCodeModules(this, range_map_->GetMergeStrategy());
 }
 
 vector<linked_ptr<const CodeModule> >
 MinidumpModuleList::GetShrunkRangeModules() const {
-  return vector<linked_ptr<const CodeModule> >();
+  // These are found as BasicCodeModules finds them, so that a
+  // MinidumpModuleList borrowed by a ProcessState reports the same modules
+  // as a copy of it.
+  vector<linked_ptr<const CodeModule> > shrunk_range_modules;
+  if (!valid_)
+    return shrunk_range_modules;
+
+  for (size_t i = 0; i < ranges_.size(); ++i) {
+    const MinidumpModule& module = (*modules_)[ranges_[i].module_index];
+    unsigned int module_index = 0;
+    uint64_t delta = 0;
+    if (range_map_->RetrieveRange(module.base_address() + module.size() - 1,
+                                  &module_index, NULL /* base */, &delta,
+                                  NULL /* size */) &&
+        delta > 0) {
+      linked_ptr<CodeModule> shrunk_range_module(
+          GetModuleAtIndex(module_index)->Copy());
+      shrunk_range_module->SetShrinkDownDelta(delta);
+      shrunk_range_modules.push_back(shrunk_range_module);
+    }
+  }
+  return shrunk_range_modules;
 }
 
 void MinidumpModuleList::Print() {
@@ -3408,7 +3651,8 @@ uint32_t MinidumpMemoryList::max_regions_ = 4096;
 
 MinidumpMemoryList::MinidumpMemoryList(Minidump* minidump)
     : MinidumpStream(minidump),
-      range_map_(new RangeMap<uint64_t, unsigned int>()),
+      address_index_(),
+      last_hit_(0),
       descriptors_(NULL),
       regions_(NULL),
       region_count_(0) {
@@ -3416,7 +3660,6 @@ MinidumpMemoryList::MinidumpMemoryList(Minidump* minidump)
 
 
 MinidumpMemoryList::~MinidumpMemoryList() {
-  delete range_map_;
   delete descriptors_;
   delete regions_;
 }
@@ -3428,7 +3671,8 @@ bool MinidumpMemoryList::Read(uint32_t expected_size) {
   descriptors_ = NULL;
   delete regions_;
   regions_ = NULL;
-  range_map_->Clear();
+  address_index_.clear();
+  last_hit_ = 0;
   region_count_ = 0;
 
   valid_ = false;
@@ -3491,17 +3735,20 @@ bool MinidumpMemoryList::Read(uint32_t expected_size) {
       return false;
     }
 
+    if (minidump_->swap())
+      SwapMemoryDescriptorArray(&(*descriptors)[0], region_count);
+
     scoped_ptr<MemoryRegions> regions(
         new MemoryRegions(region_count, MinidumpMemoryRegion(minidump_)));
 
+    vector<AddressIndexEntry> address_index;
+    address_index.reserve(region_count);
+
     for (unsigned int region_index = 0;
          region_index < region_count;
          ++region_index) {
       MDMemoryDescriptor* descriptor = &(*descriptors)[region_index];
 
-      if (minidump_->swap())
-        Swap(descriptor);
-
       uint64_t base_address = descriptor->start_of_memory_range;
       uint32_t region_size = descriptor->memory.data_size;
 
@@ -3515,17 +3762,29 @@ bool MinidumpMemoryList::Read(uint32_t expected_size) {
         return false;
       }
 
-      if (!range_map_->StoreRange(base_address, region_size, region_index)) {
+      AddressIndexEntry entry = {base_address, base_address + region_size,
+                                 region_index};
+      address_index.push_back(entry);
+
+      (*regions)[region_index].SetDescriptor(descriptor);
+    }
+
+    // Regions are often already in address order, in which case checking
+    // that is the only pass needed.
+    if (!std::is_sorted(address_index.begin(), address_index.end()))
+      std::stable_sort(address_index.begin(), address_index.end());
+    for (size_t i = 1; i < address_index.size(); ++i) {
+      if (address_index[i - 1].end > address_index[i].base) {
+        const AddressIndexEntry& entry = address_index[i];
         BPLOG(ERROR) << "MinidumpMemoryList could not store memory region " <<
-                        region_index << "/" << region_count << ", " <<
-                        HexString(base_address) << "+" <<
-                        HexString(region_size);
+                        entry.region_index << "/" << region_count << ", " <<
+                        HexString(entry.base) << "+" <<
+                        HexString(entry.end - entry.base);
         return false;
       }
-
-      (*regions)[region_index].SetDescriptor(descriptor);
     }
 
+    address_index_.swap(address_index);
     descriptors_ = descriptors.release();
     regions_ = regions.release();
   }
@@ -3561,15 +3820,26 @@ MinidumpMemoryRegion* MinidumpMemoryList::GetMemoryRegionForAddress(
     return NULL;
   }
 
-  unsigned int region_index;
-  if (!range_map_->RetrieveRange(address, &region_index, NULL /* base */,
-                                 NULL /* delta */, NULL /* size */)) {
+  if (last_hit_ < address_index_.size()) {
+    const AddressIndexEntry& entry = address_index_[last_hit_];
+    if (address >= entry.base && address < entry.end) {
+      return &(*regions_)[entry.region_index];
+    }
+  }
+
+  // Find the last region that starts at or below address.
+  AddressIndexEntry key = {address, 0, 0};
+  vector<AddressIndexEntry>::const_iterator iterator =
+      std::upper_bound(address_index_.begin(), address_index_.end(), key);
+  if (iterator == address_index_.begin() || address >= (iterator - 1)->end) {
     BPLOG(INFO) << "MinidumpMemoryList has no memory region at " <<
                    HexString(address);
     return NULL;
   }
+  --iterator;
 
-  return GetMemoryRegionAtIndex(region_index);
+  last_hit_ = iterator - address_index_.begin();
+  return &(*regions_)[iterator->region_index];
 }
 
 
@@ -3605,6 +3875,225 @@ void MinidumpMemoryList::Print() {
 }
 
 
+//
+// MinidumpMemory64List
+//
+
+
+uint32_t MinidumpMemory64List::max_regions_ = 1024 * 1024;
+
+
+MinidumpMemory64List::MinidumpMemory64List(Minidump* minidump)
+    : MinidumpStream(minidump),
+      regions_(),
+      address_index_(),
+      last_hit_(0),
+      region_objects_() {
+}
+
+
+MinidumpMemory64List::~MinidumpMemory64List() {
+  for (MinidumpMemoryRegion* region : region_objects_)
+    delete region;
+}
+
+
+bool MinidumpMemory64List::Read(uint32_t expected_size) {
+  // Invalidate cached data.
+  for (MinidumpMemoryRegion* region : region_objects_)
+    delete region;
+  region_objects_.clear();
+  regions_.clear();
+  address_index_.clear();
+  last_hit_ = 0;
+
+  valid_ = false;
+
+  if (expected_size < MDRawMemory64List_minsize) {
+    BPLOG(ERROR) << "MinidumpMemory64List header size mismatch, " <<
+                    expected_size << " < " << MDRawMemory64List_minsize;
+    return false;
+  }
+
+  uint64_t range_count;
+  MDRVA64 base_rva;
+  if (!minidump_->ReadBytes(&range_count, sizeof(range_count)) ||
+      !minidump_->ReadBytes(&base_rva, sizeof(base_rva))) {
+    BPLOG(ERROR) << "MinidumpMemory64List could not read header";
+    return false;
+  }
+
+  if (minidump_->swap()) {
+    Swap(&range_count);
+    Swap(&base_rva);
+  }
+
+  if (range_count > (expected_size - MDRawMemory64List_minsize) /
+                        sizeof(MDMemoryDescriptor64) ||
+      expected_size != MDRawMemory64List_minsize +
+                       range_count * sizeof(MDMemoryDescriptor64)) {
+    BPLOG(ERROR) << "MinidumpMemory64List size mismatch, " << expected_size <<
+                    " for " << range_count << " ranges";
+    return false;
+  }
+
+  vector<MDMemoryDescriptor64> ranges(static_cast<size_t>(range_count));
+  if (range_count != 0 &&
+      !minidump_->ReadBytes(&ranges[0],
+                            sizeof(MDMemoryDescriptor64) * ranges.size())) {
+    BPLOG(ERROR) << "MinidumpMemory64List could not read memory range list";
+    return false;
+  }
+
+  // Each range's data follows the previous range's, so its position is
+  // the base RVA plus the sizes of the ranges before it.
+  vector<Region> regions;
+  uint64_t rva = base_rva;
+  for (size_t range_index = 0; range_index < ranges.size(); ++range_index) {
+    MDMemoryDescriptor64* range = &ranges[range_index];
+    if (minidump_->swap()) {
+      Swap(&range->start_of_memory_range);
+      Swap(&range->data_size);
+    }
+
+    uint64_t base_address = range->start_of_memory_range;
+    uint64_t range_size = range->data_size;
+    if (range_size == 0 ||
+        range_size > numeric_limits<uint64_t>::max() - base_address ||
+        range_size > numeric_limits<uint64_t>::max() - rva) {
+      BPLOG(ERROR) << "MinidumpMemory64List has a memory range problem, " <<
+                      " range " << range_index << "/" << range_count <<
+                      ", " << HexString(base_address) << "+" <<
+                      HexString(range_size);
+      return false;
+    }
+
+    for (uint64_t offset = 0; offset < range_size;
+         offset += kMaxRegionBytes) {
+      if (regions.size() >= max_regions_) {
+        BPLOG(ERROR) << "MinidumpMemory64List region count exceeds " <<
+                        "maximum " << max_regions_;
+        return false;
+      }
+      Region region = {
+        base_address + offset,
+        static_cast<uint32_t>(std::min<uint64_t>(range_size - offset,
+                                                 kMaxRegionBytes)),
+        rva + offset
+      };
+      regions.push_back(region);
+    }
+    rva += range_size;
+  }
+
+  // Ranges are usually already in address order, in which case this is a
+  // linear pass.
+  vector<unsigned int> address_index(regions.size());
+  for (unsigned int i = 0; i < address_index.size(); ++i)
+    address_index[i] = i;
+  std::stable_sort(address_index.begin(), address_index.end(),
+                   [&regions](unsigned int a, unsigned int b) {
+                     return regions[a].base < regions[b].base;
+                   });
+  for (size_t i = 1; i < address_index.size(); ++i) {
+    const Region& previous = regions[address_index[i - 1]];
+    const Region& region = regions[address_index[i]];
+    if (previous.base + previous.size > region.base) {
+      BPLOG(ERROR) << "MinidumpMemory64List has overlapping memory at " <<
+                      HexString(region.base) << "+" <<
+                      HexString(region.size);
+      return false;
+    }
+  }
+
+  regions_.swap(regions);
+  address_index_.swap(address_index);
+  region_objects_.resize(regions_.size(), NULL);
+
+  valid_ = true;
+  return true;
+}
+
+
+MinidumpMemoryRegion* MinidumpMemory64List::GetMemoryRegionAtIndex(
+      unsigned int index) {
+  if (!valid_) {
+    BPLOG(ERROR) << "Invalid MinidumpMemory64List for GetMemoryRegionAtIndex";
+    return NULL;
+  }
+
+  if (index >= regions_.size()) {
+    BPLOG(ERROR) << "MinidumpMemory64List index out of range: " <<
+                    index << "/" << regions_.size();
+    return NULL;
+  }
+
+  if (!region_objects_[index]) {
+    const Region& region = regions_[index];
+    MinidumpMemoryRegion* region_object = new MinidumpMemoryRegion(minidump_);
+    region_object->SetRange(region.base, region.size, region.rva);
+    region_objects_[index] = region_object;
+  }
+  return region_objects_[index];
+}
+
+
+MinidumpMemoryRegion* MinidumpMemory64List::GetMemoryRegionForAddress(
+    uint64_t address) {
+  if (!valid_) {
+    BPLOG(ERROR) << "Invalid MinidumpMemory64List for "
+                    "GetMemoryRegionForAddress";
+    return NULL;
+  }
+
+  if (last_hit_ < address_index_.size()) {
+    const Region& region = regions_[address_index_[last_hit_]];
+    if (address >= region.base && address - region.base < region.size)
+      return GetMemoryRegionAtIndex(address_index_[last_hit_]);
+  }
+
+  // Find the last region that starts at or below address.
+  vector<unsigned int>::const_iterator iterator =
+      std::upper_bound(address_index_.begin(), address_index_.end(), address,
+                       [this](uint64_t address, unsigned int index) {
+                         return address < regions_[index].base;
+                       });
+  if (iterator == address_index_.begin() ||
+      address - regions_[*(iterator - 1)].base >=
+          regions_[*(iterator - 1)].size) {
+    BPLOG(INFO) << "MinidumpMemory64List has no memory region at " <<
+                   HexString(address);
+    return NULL;
+  }
+  --iterator;
+
+  last_hit_ = iterator - address_index_.begin();
+  return GetMemoryRegionAtIndex(*iterator);
+}
+
+
+void MinidumpMemory64List::Print() {
+  if (!valid_) {
+    BPLOG(ERROR) << "MinidumpMemory64List cannot print invalid data";
+    return;
+  }
+
+  printf("MinidumpMemory64List\n");
+  printf("  region_count = %zu\n", regions_.size());
+  printf("\n");
+
+  for (size_t region_index = 0; region_index < regions_.size();
+       ++region_index) {
+    const Region& region = regions_[region_index];
+    printf("region[%zu]\n", region_index);
+    printf("  start_of_memory_range = 0x%" PRIx64 "\n", region.base);
+    printf("  data_size             = 0x%x\n", region.size);
+    printf("  rva                   = 0x%" PRIx64 "\n", region.rva);
+    printf("\n");
+  }
+}
+
+
 //
 // MinidumpException
 //
@@ -4912,20 +5401,22 @@ bool MinidumpMemoryInfo::IsWritable() const {
 bool MinidumpMemoryInfo::Read() {
   valid_ = false;
 
-  if (!minidump_->ReadBytes(&memory_info_, sizeof(memory_info_))) {
+  MDRawMemoryInfo memory_info;
+  if (!minidump_->ReadBytes(&memory_info, sizeof(memory_info))) {
     BPLOG(ERROR) << "MinidumpMemoryInfo cannot read memory info";
     return false;
   }
 
-  if (minidump_->swap()) {
-    Swap(&memory_info_.base_address);
-    Swap(&memory_info_.allocation_base);
-    Swap(&memory_info_.allocation_protection);
-    Swap(&memory_info_.region_size);
-    Swap(&memory_info_.state);
-    Swap(&memory_info_.protection);
-    Swap(&memory_info_.type);
-  }
+  if (minidump_->swap())
+    SwapMemoryInfoArray(&memory_info, 1);
+
+  return Read(memory_info);
+}
+
+
+bool MinidumpMemoryInfo::Read(const MDRawMemoryInfo& memory_info) {
+  valid_ = false;
+  memory_info_ = memory_info;
 
   // Check for base + size overflow or undersize.
   if (memory_info_.region_size == 0 ||
@@ -4971,7 +5462,9 @@ MinidumpMemoryInfoList::MinidumpMemoryInfoList(Minidump* minidump)
     : MinidumpStream(minidump),
       range_map_(new RangeMap<uint64_t, unsigned int>()),
       infos_(NULL),
-      info_count_(0) {
+      info_count_(0),
+      infos_offset_(0),
+      range_map_built_(false) {
 }
 
 
@@ -4986,6 +5479,7 @@ bool MinidumpMemoryInfoList::Read(uint32_t expected_size) {
   delete infos_;
   infos_ = NULL;
   range_map_->Clear();
+  range_map_built_ = false;
   info_count_ = 0;
 
   valid_ = false;
@@ -5057,13 +5551,30 @@ bool MinidumpMemoryInfoList::Read(uint32_t expected_size) {
         new MinidumpMemoryInfos(header_number_of_entries,
                                 MinidumpMemoryInfo(minidump_)));
 
-    for (unsigned int index = 0;
-         index < header.number_of_entries;
-         ++index) {
+    infos_offset_ = minidump_->Tell();
+    if (infos_offset_ == -1) {
+      BPLOG(ERROR) << "MinidumpMemoryInfoList could not get infos offset";
+      return false;
+    }
+
+    // In lazy mode, infos are read by ReadInfoAtIndex as they're needed.
+    // Otherwise, the whole array is read and swapped at once.
+    vector<MDRawMemoryInfo> raw_infos;
+    if (!minidump_->lazy_parsing()) {
+      raw_infos.resize(header_number_of_entries);
+      if (!minidump_->ReadBytes(&raw_infos[0],
+                                sizeof(MDRawMemoryInfo) * raw_infos.size())) {
+        BPLOG(ERROR) << "MinidumpMemoryInfoList could not read infos";
+        return false;
+      }
+      if (minidump_->swap())
+        SwapMemoryInfoArray(&raw_infos[0], raw_infos.size());
+    }
+
+    for (unsigned int index = 0; index < raw_infos.size(); ++index) {
       MinidumpMemoryInfo* info = &(*infos)[index];
 
-      // Assume that the file offset is correct after the last read.
-      if (!info->Read()) {
+      if (!info->Read(raw_infos[index])) {
         BPLOG(ERROR) << "MinidumpMemoryInfoList cannot read info " <<
                         index << "/" << header.number_of_entries;
         return false;
@@ -5086,12 +5597,65 @@ bool MinidumpMemoryInfoList::Read(uint32_t expected_size) {
   }
 
   info_count_ = static_cast<uint32_t>(header_number_of_entries);
+  range_map_built_ = !minidump_->lazy_parsing();
 
   valid_ = true;
   return true;
 }
 
 
+bool MinidumpMemoryInfoList::ReadInfoAtIndex(unsigned int index) const {
+  MinidumpMemoryInfo* info = &(*infos_)[index];
+  if (info->valid()) {
+    return true;
+  }
+
+  if (!minidump_->SeekSet(infos_offset_ +
+                          static_cast<off_t>(index) * sizeof(MDRawMemoryInfo))) {
+    BPLOG(ERROR) << "MinidumpMemoryInfoList could not seek to info " <<
+                    index << "/" << info_count_;
+    return false;
+  }
+
+  if (!info->Read()) {
+    BPLOG(ERROR) << "MinidumpMemoryInfoList cannot read info " <<
+                    index << "/" << info_count_;
+    return false;
+  }
+
+  return true;
+}
+
+
+bool MinidumpMemoryInfoList::BuildRangeMap() const {
+  // Only try once, even if a bad info leaves the map unusable.
+  range_map_built_ = true;
+
+  for (unsigned int index = 0; index < info_count_; ++index) {
+    if (!ReadInfoAtIndex(index)) {
+      range_map_->Clear();
+      return false;
+    }
+
+    const MinidumpMemoryInfo* info = &(*infos_)[index];
+    uint64_t base_address = info->GetBase();
+    uint64_t region_size = info->GetSize();
+
+    if (!range_map_->StoreRange(base_address, region_size, index)) {
+      BPLOG(ERROR) << "MinidumpMemoryInfoList could not store"
+                      " memory region " <<
+                      index << "/" << info_count_ << ", " <<
+                      HexString(base_address) << "+" <<
+                      HexString(region_size);
+      range_map_->Clear();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
 const MinidumpMemoryInfo* MinidumpMemoryInfoList::GetMemoryInfoAtIndex(
       unsigned int index) const {
   if (!valid_) {
@@ -5105,6 +5669,10 @@ const MinidumpMemoryInfo* MinidumpMemoryInfoList::GetMemoryInfoAtIndex(
     return NULL;
   }
 
+  if (!ReadInfoAtIndex(index)) {
+    return NULL;
+  }
+
   return &(*infos_)[index];
 }
 
@@ -5117,6 +5685,11 @@ const MinidumpMemoryInfo* MinidumpMemoryInfoList::GetMemoryInfoForAddress(
     return NULL;
   }
 
+  if (!range_map_built_ && !BuildRangeMap()) {
+    BPLOG(ERROR) << "MinidumpMemoryInfoList could not index memory info";
+    return NULL;
+  }
+
   unsigned int info_index;
   if (!range_map_->RetrieveRange(address, &info_index, NULL /* base */,
                                  NULL /* delta */, NULL /* size */)) {
@@ -5143,7 +5716,9 @@ void MinidumpMemoryInfoList::Print() {
        info_index < info_count_;
        ++info_index) {
     printf("info[%d]\n", info_index);
-    (*infos_)[info_index].Print();
+    if (ReadInfoAtIndex(info_index)) {
+      (*infos_)[info_index].Print();
+    }
     printf("\n");
   }
 }
@@ -5153,7 +5728,10 @@ void MinidumpMemoryInfoList::Print() {
 //
 
 MinidumpLinuxMaps::MinidumpLinuxMaps(Minidump* minidump)
-    : MinidumpObject(minidump) {
+    : MinidumpObject(minidump),
+      entry_(),
+      path_(NULL),
+      line_() {
 }
 
 void MinidumpLinuxMaps::Print() const {
@@ -5161,7 +5739,7 @@ void MinidumpLinuxMaps::Print() const {
     BPLOG(ERROR) << "MinidumpLinuxMaps cannot print invalid data";
     return;
   }
-  std::cout << region_.line << std::endl;
+  std::cout << line_ << std::endl;
 }
 
 //
@@ -5171,7 +5749,9 @@ void MinidumpLinuxMaps::Print() const {
 MinidumpLinuxMapsList::MinidumpLinuxMapsList(Minidump* minidump)
     : MinidumpStream(minidump),
       maps_(NULL),
-      maps_count_(0) {
+      maps_count_(0),
+      maps_offset_(0),
+      maps_length_(0) {
 }
 
 MinidumpLinuxMapsList::~MinidumpLinuxMapsList() {
@@ -5185,7 +5765,7 @@ MinidumpLinuxMapsList::~MinidumpLinuxMapsList() {
 
 const MinidumpLinuxMaps* MinidumpLinuxMapsList::GetLinuxMapsForAddress(
     uint64_t address) const {
-  if (!valid_ || (maps_ == NULL)) {
+  if (!valid_ || !ParseMaps()) {
     BPLOG(ERROR) << "Invalid MinidumpLinuxMapsList for GetLinuxMapsForAddress";
     return NULL;
   }
@@ -5207,7 +5787,7 @@ const MinidumpLinuxMaps* MinidumpLinuxMapsList::GetLinuxMapsForAddress(
 
 const MinidumpLinuxMaps* MinidumpLinuxMapsList::GetLinuxMapsAtIndex(
     unsigned int index) const {
-  if (!valid_ || (maps_ == NULL)) {
+  if (!valid_ || !ParseMaps()) {
     BPLOG(ERROR) << "Invalid MinidumpLinuxMapsList for GetLinuxMapsAtIndex";
     return NULL;
   }
@@ -5233,6 +5813,10 @@ bool MinidumpLinuxMapsList::Read(uint32_t expected_size) {
   }
   maps_ = NULL;
   maps_count_ = 0;
+  maps_data_.clear();
+  maps_table_.Clear();
+  maps_offset_ = 0;
+  maps_length_ = 0;
 
   valid_ = false;
 
@@ -5250,27 +5834,60 @@ bool MinidumpLinuxMapsList::Read(uint32_t expected_size) {
     return false;
   }
 
-  // Create a vector to read stream data. The vector needs to have
-  // at least enough capacity to read all the data.
-  vector<char> mapping_bytes(length);
-  if (!minidump_->ReadBytes(&mapping_bytes[0], length)) {
+  maps_offset_ = minidump_->Tell();
+  maps_length_ = length;
+  if (maps_offset_ == -1) {
+    BPLOG(ERROR) << "MinidumpLinuxMapsList could not get stream offset";
+    return false;
+  }
+
+  // In lazy mode, the mappings are parsed by the first accessor to need them.
+  if (!minidump_->lazy_parsing() && !ParseMaps()) {
+    return false;
+  }
+
+  valid_ = true;
+  return true;
+}
+
+bool MinidumpLinuxMapsList::ParseMaps() const {
+  if (maps_) {
+    return true;
+  }
+
+  if (!minidump_->SeekSet(maps_offset_)) {
+    BPLOG(ERROR) << "MinidumpLinuxMapsList could not seek to stream";
+    return false;
+  }
+
+  uint32_t length = maps_length_;
+  string maps_data(length, '\0');
+  if (length && !minidump_->ReadBytes(&maps_data[0], length)) {
     BPLOG(ERROR) << "MinidumpLinuxMapsList failed to read bytes";
     return false;
   }
-  string map_string(mapping_bytes.begin(), mapping_bytes.end());
-  vector<MappedMemoryRegion> all_regions;
 
   // Parse string into mapping data.
-  if (!ParseProcMaps(map_string, &all_regions)) {
+  ProcMapsTable table;
+  if (!ParseProcMapsTable(maps_data, &table)) {
     return false;
   }
+  maps_data_.swap(maps_data);
+  maps_table_.entries.swap(table.entries);
+  maps_table_.paths.swap(table.paths);
 
   scoped_ptr<MinidumpLinuxMappings> maps(new MinidumpLinuxMappings());
+  maps->reserve(maps_table_.entries.size());
 
-  // Push mapping data into wrapper classes.
-  for (size_t i = 0; i < all_regions.size(); i++) {
+  // Wrap each mapping, which refers to its path and line rather than
+  // holding copies of them.
+  for (size_t i = 0; i < maps_table_.entries.size(); i++) {
+    const ProcMapsEntry& entry = maps_table_.entries[i];
     scoped_ptr<MinidumpLinuxMaps> ele(new MinidumpLinuxMaps(minidump_));
-    ele->region_ = all_regions[i];
+    ele->entry_ = entry;
+    ele->path_ = &maps_table_.paths[entry.path_index];
+    ele->line_ = StringView(maps_data_.data() + entry.line_offset,
+                            entry.line_length);
     ele->valid_ = true;
     maps->push_back(ele.release());
   }
@@ -5278,12 +5895,11 @@ bool MinidumpLinuxMapsList::Read(uint32_t expected_size) {
   // Set instance variables.
   maps_ = maps.release();
   maps_count_ = static_cast<uint32_t>(maps_->size());
-  valid_ = true;
   return true;
 }
 
 void MinidumpLinuxMapsList::Print() const {
-  if (!valid_ || (maps_ == NULL)) {
+  if (!valid_ || !ParseMaps()) {
     BPLOG(ERROR) << "MinidumpLinuxMapsList cannot print valid data";
     return;
   }
@@ -5544,6 +6160,146 @@ void MinidumpCrashpadInfo::Print() {
 }
 
 
+//
+// MinidumpBreadcrumbs
+//
+
+
+MinidumpBreadcrumbs::MinidumpBreadcrumbs(Minidump* minidump)
+    : MinidumpStream(minidump),
+      threads_() {
+}
+
+
+bool MinidumpBreadcrumbs::Read(uint32_t expected_size) {
+  threads_.clear();
+  valid_ = false;
+
+  MDRawBreadcrumbList list;
+  if (expected_size < sizeof(list)) {
+    BPLOG(ERROR) << "MinidumpBreadcrumbs size mismatch, " << expected_size
+                 << " < " << sizeof(list);
+    return false;
+  }
+  if (!minidump_->ReadBytes(&list, sizeof(list))) {
+    BPLOG(ERROR) << "MinidumpBreadcrumbs cannot read breadcrumb list";
+    return false;
+  }
+  if (minidump_->swap()) {
+    Swap(&list.version);
+    Swap(&list.thread_count);
+  }
+  if (list.version != MD_BREADCRUMB_VERSION) {
+    BPLOG(ERROR) << "MinidumpBreadcrumbs unknown version " << list.version;
+    return false;
+  }
+
+  // Each thread is followed by its breadcrumbs, so the sizes are checked
+  // against what is left of the stream as it is read.
+  uint32_t remaining = expected_size - sizeof(list);
+  if (list.thread_count > remaining / MDRawBreadcrumbThread_minsize) {
+    BPLOG(ERROR) << "MinidumpBreadcrumbs thread count " << list.thread_count
+                 << " too large for " << remaining << " bytes";
+    return false;
+  }
+  threads_.resize(list.thread_count);
+
+  for (uint32_t thread_index = 0; thread_index < list.thread_count;
+       ++thread_index) {
+    MDRawBreadcrumbThread raw_thread;
+    if (remaining < MDRawBreadcrumbThread_minsize ||
+        !minidump_->ReadBytes(&raw_thread, MDRawBreadcrumbThread_minsize)) {
+      BPLOG(ERROR) << "MinidumpBreadcrumbs cannot read thread "
+                   << thread_index;
+      return false;
+    }
+    remaining -= MDRawBreadcrumbThread_minsize;
+    if (minidump_->swap()) {
+      Swap(&raw_thread.thread_id);
+      Swap(&raw_thread.breadcrumb_count);
+      Swap(&raw_thread.recorded_count);
+    }
+    if (raw_thread.breadcrumb_count > remaining / sizeof(MDRawBreadcrumb)) {
+      BPLOG(ERROR) << "MinidumpBreadcrumbs breadcrumb count "
+                   << raw_thread.breadcrumb_count << " too large for "
+                   << remaining << " bytes";
+      return false;
+    }
+
+    Thread& thread = threads_[thread_index];
+    thread.thread_id = raw_thread.thread_id;
+    thread.recorded_count = raw_thread.recorded_count;
+    thread.breadcrumbs.resize(raw_thread.breadcrumb_count);
+    if (raw_thread.breadcrumb_count &&
+        !minidump_->ReadBytes(
+            &thread.breadcrumbs[0],
+            raw_thread.breadcrumb_count * sizeof(MDRawBreadcrumb))) {
+      BPLOG(ERROR) << "MinidumpBreadcrumbs cannot read breadcrumbs of "
+                      "thread " << thread_index;
+      return false;
+    }
+    remaining -= raw_thread.breadcrumb_count * sizeof(MDRawBreadcrumb);
+
+    for (MDRawBreadcrumb& breadcrumb : thread.breadcrumbs) {
+      if (minidump_->swap()) {
+        Swap(&breadcrumb.timestamp_ns);
+        Swap(&breadcrumb.category);
+        Swap(&breadcrumb.data_size);
+      }
+      if (breadcrumb.data_size > MD_BREADCRUMB_DATA_SIZE)
+        breadcrumb.data_size = MD_BREADCRUMB_DATA_SIZE;
+    }
+  }
+
+  valid_ = true;
+  return true;
+}
+
+
+// static
+string MinidumpBreadcrumbs::DataToString(const MDRawBreadcrumb& breadcrumb) {
+  string data;
+  for (uint32_t i = 0;
+       i < breadcrumb.data_size && i < MD_BREADCRUMB_DATA_SIZE; ++i) {
+    uint8_t byte = breadcrumb.data[i];
+    if (byte >= 0x20 && byte < 0x7f && byte != '\\') {
+      data.append(1, static_cast<char>(byte));
+    } else {
+      char escaped[5];
+      snprintf(escaped, sizeof(escaped), "\\x%02x", byte);
+      data.append(escaped);
+    }
+  }
+  return data;
+}
+
+
+void MinidumpBreadcrumbs::Print() {
+  if (!valid_) {
+    BPLOG(ERROR) << "MinidumpBreadcrumbs cannot print invalid data";
+    return;
+  }
+
+  printf("MDRawBreadcrumbList\n");
+  printf("  thread_count = %zu\n", threads_.size());
+  for (size_t thread_index = 0; thread_index < threads_.size();
+       ++thread_index) {
+    const Thread& thread = threads_[thread_index];
+    printf("  thread[%zu].thread_id = 0x%x\n", thread_index,
+           thread.thread_id);
+    printf("  thread[%zu].recorded_count = %" PRIu64 "\n", thread_index,
+           thread.recorded_count);
+    for (size_t i = 0; i < thread.breadcrumbs.size(); ++i) {
+      const MDRawBreadcrumb& breadcrumb = thread.breadcrumbs[i];
+      printf("  thread[%zu].breadcrumbs[%zu] = %" PRIu64 " %u \"%s\"\n",
+             thread_index, i, breadcrumb.timestamp_ns, breadcrumb.category,
+             DataToString(breadcrumb).c_str());
+    }
+  }
+  printf("\n");
+}
+
+
 //
 // Minidump
 //
@@ -5551,6 +6307,79 @@ void MinidumpCrashpadInfo::Print() {
 
 uint32_t Minidump::max_streams_ = 128;
 unsigned int Minidump::max_string_length_ = 1024;
+uint64_t Minidump::page_cache_budget_ = 64 * 1024 * 1024;  // 64MB
+
+
+class Minidump::PageCache {
+ public:
+  explicit PageCache(Minidump* minidump) : minidump_(minidump), bytes_(0) {}
+
+  ~PageCache() { total_bytes_ -= bytes_; }
+
+  PageCache(const PageCache&) = delete;
+  void operator=(const PageCache&) = delete;
+
+  // See Minidump::ReadCachedPage.
+  const uint8_t* Get(off_t offset, size_t count) {
+    PageIndex::iterator found = index_.find(offset);
+    if (found != index_.end()) {
+      PageList::iterator page = found->second;
+      if (page->data.size() >= count) {
+        pages_.splice(pages_.begin(), pages_, page);
+        return &page->data[0];
+      }
+      // Another region's page at the same offset, but shorter.
+      Evict(page);
+    }
+
+    vector<uint8_t> data(count);
+    if (!minidump_->SeekSet(offset) ||
+        !minidump_->ReadBytes(&data[0], count)) {
+      return NULL;
+    }
+    pages_.push_front(Page());
+    pages_.front().offset = offset;
+    pages_.front().data.swap(data);
+    index_[offset] = pages_.begin();
+    bytes_ += count;
+    total_bytes_ += count;
+
+    // The other Minidumps evict their own pages as they read theirs, so
+    // that the budget holds for all of them together.
+    while (total_bytes_ > page_cache_budget_ && pages_.size() > 1)
+      Evict(--pages_.end());
+    return &pages_.front().data[0];
+  }
+
+  static uint64_t total_bytes() { return total_bytes_; }
+
+ private:
+  struct Page {
+    off_t offset;
+    vector<uint8_t> data;
+  };
+  typedef std::list<Page> PageList;
+  typedef std::unordered_map<off_t, PageList::iterator> PageIndex;
+
+  void Evict(PageList::iterator page) {
+    bytes_ -= page->data.size();
+    total_bytes_ -= page->data.size();
+    index_.erase(page->offset);
+    pages_.erase(page);
+  }
+
+  Minidump* minidump_;
+
+  // Most recently used first.
+  PageList pages_;
+  PageIndex index_;
+
+  // The bytes of pages_, and of the pages of every PageCache.
+  uint64_t bytes_;
+  static std::atomic<uint64_t> total_bytes_;
+};
+
+std::atomic<uint64_t> Minidump::PageCache::total_bytes_(0);
 
 
 Minidump::Minidump(const string& path, bool hexdump, unsigned int hexdump_width)
@@ -5559,11 +6388,21 @@ Minidump::Minidump(const string& path, bool hexdump, unsigned int hexdump_width)
       stream_map_(new MinidumpStreamMap()),
       path_(path),
       stream_(NULL),
+      compressed_file_(NULL),
+      decompressor_(NULL),
+      data_(NULL),
+      data_size_(0),
+      data_position_(0),
+      data_mapped_(false),
+      use_mmap_(false),
+      readahead_(false),
       swap_(false),
       is_big_endian_(false),
       valid_(false),
       hexdump_(hexdump),
-      hexdump_width_(hexdump_width) {
+      hexdump_width_(hexdump_width),
+      lazy_parsing_(false),
+      page_cache_(NULL) {
 }
 
 Minidump::Minidump(istream& stream)
@@ -5572,26 +6411,73 @@ Minidump::Minidump(istream& stream)
       stream_map_(new MinidumpStreamMap()),
       path_(),
       stream_(&stream),
+      compressed_file_(NULL),
+      decompressor_(NULL),
+      data_(NULL),
+      data_size_(0),
+      data_position_(0),
+      data_mapped_(false),
+      use_mmap_(false),
+      readahead_(false),
       swap_(false),
       is_big_endian_(false),
       valid_(false),
       hexdump_(false),
-      hexdump_width_(0) {
+      hexdump_width_(0),
+      lazy_parsing_(false),
+      page_cache_(NULL) {
+}
+
+Minidump::Minidump(const uint8_t* data, size_t size)
+    : header_(),
+      directory_(NULL),
+      stream_map_(new MinidumpStreamMap()),
+      path_(),
+      stream_(NULL),
+      compressed_file_(NULL),
+      decompressor_(NULL),
+      data_(data),
+      data_size_(size),
+      data_position_(0),
+      data_mapped_(false),
+      use_mmap_(false),
+      readahead_(false),
+      swap_(false),
+      is_big_endian_(false),
+      valid_(false),
+      hexdump_(false),
+      hexdump_width_(0),
+      lazy_parsing_(false),
+      page_cache_(NULL) {
 }
 
 Minidump::~Minidump() {
-  if (stream_) {
+  if (stream_ || data_mapped_) {
     BPLOG(INFO) << "Minidump closing minidump";
   }
   if (!path_.empty()) {
     delete stream_;
   }
+  delete decompressor_;
+  delete compressed_file_;
+#ifndef _WIN32
+  if (data_mapped_) {
+    munmap(const_cast<uint8_t*>(data_), data_size_);
+  }
+#endif  // _WIN32
   delete directory_;
   delete stream_map_;
+  delete page_cache_;
 }
 
 
 bool Minidump::Open() {
+  if (data_ != NULL) {
+    // The minidump is held in memory, either because it was provided that
+    // way or because it was already mapped.
+    return SeekSet(0);
+  }
+
   if (stream_ != NULL) {
     BPLOG(INFO) << "Minidump reopening minidump " << path_;
 
@@ -5600,6 +6486,11 @@ bool Minidump::Open() {
     return SeekSet(0);
   }
 
+  if (use_mmap_ && MapFile()) {
+    BPLOG(INFO) << "Minidump mapped minidump " << path_;
+    return true;
+  }
+
   stream_ = new ifstream(path_.c_str(), std::ios::in | std::ios::binary);
   if (!stream_ || !stream_->good()) {
     string error_string;
@@ -5609,10 +6500,92 @@ bool Minidump::Open() {
     return false;
   }
 
+  char magic[2];
+  if (stream_->read(magic, sizeof(magic)) &&
+      IsGzipData(magic, sizeof(magic))) {
+    // The minidump was compressed by MinidumpFileWriter.  Read it through
+    // a BlockGzipReader, which decompresses the blocks as they are read.
+    BlockGzipReader* decompressor = new BlockGzipReader(stream_);
+    compressed_file_ = stream_;
+    decompressor_ = decompressor;
+    stream_ = new istream(decompressor_);
+    if (!decompressor->Open()) {
+      BPLOG(ERROR) << "Minidump could not decompress minidump " << path_;
+      return false;
+    }
+    BPLOG(INFO) << "Minidump opened compressed minidump " << path_;
+    return true;
+  }
+  stream_->clear();
+  stream_->seekg(0);
+
   BPLOG(INFO) << "Minidump opened minidump " << path_;
   return true;
 }
 
+bool Minidump::MapFile() {
+#ifdef _WIN32
+  return false;
+#else  // _WIN32
+  int fd = open(path_.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size <= 0 ||
+      static_cast<uint64_t>(st.st_size) > numeric_limits<size_t>::max()) {
+    // Empty files can't be mapped; let the ifstream path report the error.
+    close(fd);
+    return false;
+  }
+
+  size_t size = static_cast<size_t>(st.st_size);
+  void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(INFO) << "Minidump could not map minidump " << path_ <<
+                   ", error " << error_code << ": " << error_string;
+    return false;
+  }
+  if (IsGzipData(static_cast<const char*>(data), size)) {
+    // Compressed minidumps are read through the stream, which decompresses
+    // only the parts that are read.
+    munmap(data, size);
+    return false;
+  }
+
+  data_ = static_cast<const uint8_t*>(data);
+  data_size_ = size;
+  data_position_ = 0;
+  data_mapped_ = true;
+  return true;
+#endif  // _WIN32
+}
+
+// static
+void Minidump::Prefetch(const string& path) {
+  vector<std::pair<off_t, off_t> > ranges;
+  ranges.push_back(std::make_pair(0, static_cast<off_t>(kPrefetchBytes)));
+  AdviseWillNeed(path, ranges);
+}
+
+void Minidump::ReadAhead(const vector<MDLocationDescriptor>& locations) {
+  // Offsets into a compressed minidump are not offsets into the file.
+  if (!readahead_ || path_.empty() || compressed_file_)
+    return;
+
+  vector<std::pair<off_t, off_t> > ranges;
+  for (const MDLocationDescriptor& location : locations) {
+    if (location.data_size != 0)
+      ranges.push_back(std::make_pair(location.rva, location.data_size));
+  }
+  std::sort(ranges.begin(), ranges.end());
+  AdviseWillNeed(path_, ranges);
+}
+
 bool Minidump::GetContextCPUFlagsFromSystemInfo(uint32_t* context_cpu_flags) {
   // Initialize output parameters
   *context_cpu_flags = 0;
@@ -5699,6 +6672,11 @@ bool Minidump::GetContextCPUFlagsFromSystemInfo(uint32_t* context_cpu_flags) {
 
 
 bool Minidump::Read() {
+  // The header, directory and streams already parsed stay valid, since
+  // the minidump cannot change underneath this object.
+  if (valid_)
+    return true;
+
   // Invalidate cached data.
   delete directory_;
   directory_ = NULL;
@@ -5808,10 +6786,12 @@ bool Minidump::Read() {
         case MD_THREAD_NAME_LIST_STREAM:
         case MD_MODULE_LIST_STREAM:
         case MD_MEMORY_LIST_STREAM:
+        case MD_MEMORY_64_LIST_STREAM:
         case MD_EXCEPTION_STREAM:
         case MD_SYSTEM_INFO_STREAM:
         case MD_MISC_INFO_STREAM:
         case MD_BREAKPAD_INFO_STREAM:
+        case MD_BREADCRUMB_STREAM:
         case MD_CRASHPAD_INFO_STREAM: {
           if (stream_map_->find(stream_type) != stream_map_->end()) {
             // Another stream with this type was already found.  A minidump
@@ -5832,6 +6812,13 @@ bool Minidump::Read() {
     }
 
     directory_ = directory.release();
+
+    if (readahead_) {
+      vector<MDLocationDescriptor> locations;
+      for (const MDRawDirectory& directory_entry : *directory_)
+        locations.push_back(directory_entry.location);
+      ReadAhead(locations);
+    }
   }
 
   valid_ = true;
@@ -5861,6 +6848,25 @@ MinidumpMemoryList* Minidump::GetMemoryList() {
 }
 
 
+MinidumpMemory64List* Minidump::GetMemory64List() {
+  MinidumpMemory64List* memory64_list;
+  return GetStream(&memory64_list);
+}
+
+
+MinidumpMemoryRegion* Minidump::GetMemoryRegionForAddress(uint64_t address) {
+  MinidumpMemoryList* memory_list = GetMemoryList();
+  MinidumpMemoryRegion* region =
+      memory_list ? memory_list->GetMemoryRegionForAddress(address) : NULL;
+  if (!region) {
+    MinidumpMemory64List* memory64_list = GetMemory64List();
+    if (memory64_list)
+      region = memory64_list->GetMemoryRegionForAddress(address);
+  }
+  return region;
+}
+
+
 MinidumpException* Minidump::GetException() {
   MinidumpException* exception;
   return GetStream(&exception);
@@ -5937,6 +6943,11 @@ MinidumpCrashpadInfo* Minidump::GetCrashpadInfo() {
   return GetStream(&crashpad_info);
 }
 
+MinidumpBreadcrumbs* Minidump::GetBreadcrumbs() {
+  MinidumpBreadcrumbs* breadcrumbs;
+  return GetStream(&breadcrumbs);
+}
+
 static const char* get_stream_name(uint32_t stream_type) {
   switch (stream_type) {
   case MD_UNUSED_STREAM:
@@ -6009,6 +7020,12 @@ static const char* get_stream_name(uint32_t stream_type) {
     return "MD_LINUX_MAPS";
   case MD_LINUX_DSO_DEBUG:
     return "MD_LINUX_DSO_DEBUG";
+  case MD_LINUX_DUMP_TIMING:
+    return "MD_LINUX_DUMP_TIMING";
+  case MD_BREADCRUMB_STREAM:
+    return "MD_BREADCRUMB_STREAM";
+  case MD_LINUX_LIVE_DUMP:
+    return "MD_LINUX_LIVE_DUMP";
   case MD_CRASHPAD_INFO_STREAM:
     return "MD_CRASHPAD_INFO_STREAM";
   default:
@@ -6083,6 +7100,18 @@ const MDRawDirectory* Minidump::GetDirectoryEntryAtIndex(unsigned int index)
 bool Minidump::ReadBytes(void* bytes, size_t count) {
   // Can't check valid_ because Read needs to call this method before
   // validity can be determined.
+  if (data_) {
+    if (count > data_size_ - data_position_) {
+      BPLOG(ERROR) << "ReadBytes: read " << data_size_ - data_position_ <<
+                      "/" << count;
+      data_position_ = data_size_;
+      return false;
+    }
+    memcpy(bytes, data_ + data_position_, count);
+    data_position_ += count;
+    return true;
+  }
+
   if (!stream_) {
     return false;
   }
@@ -6115,9 +7144,22 @@ bool Minidump::ReadBytes(void* bytes, size_t count) {
 bool Minidump::SeekSet(off_t offset) {
   // Can't check valid_ because Read needs to call this method before
   // validity can be determined.
+  if (data_) {
+    // Like seekg, allow seeking to the end but not past it.
+    if (offset < 0 || static_cast<uint64_t>(offset) > data_size_) {
+      BPLOG(ERROR) << "SeekSet: offset " << offset << " out of range";
+      return false;
+    }
+    data_position_ = static_cast<size_t>(offset);
+    return true;
+  }
+
   if (!stream_) {
     return false;
   }
+  // A failed read leaves the stream failed, but a stream whose data is
+  // still arriving may have the bytes at |offset| even so.
+  stream_->clear();
   stream_->seekg(offset, std::ios_base::beg);
   if (!stream_->good()) {
     string error_string;
@@ -6129,10 +7171,14 @@ bool Minidump::SeekSet(off_t offset) {
 }
 
 off_t Minidump::Tell() {
-  if (!valid_ || !stream_) {
+  if (!valid_ || (!stream_ && !data_)) {
     return (off_t)-1;
   }
 
+  if (data_) {
+    return static_cast<off_t>(data_position_);
+  }
+
   // Check for conversion data loss
   std::streamoff std_streamoff = stream_->tellg();
   off_t rv = static_cast<off_t>(std_streamoff);
@@ -6145,21 +7191,67 @@ off_t Minidump::Tell() {
 }
 
 
+const uint8_t* Minidump::GetDataAtOffset(off_t offset, size_t count) const {
+  if (!data_ || offset < 0 || static_cast<uint64_t>(offset) > data_size_ ||
+      count > data_size_ - static_cast<size_t>(offset)) {
+    return NULL;
+  }
+  return data_ + offset;
+}
+
+
+const uint8_t* Minidump::ReadCachedPage(off_t offset, size_t count) {
+  if (data_) {
+    return GetDataAtOffset(offset, count);
+  }
+  if (!page_cache_) {
+    page_cache_ = new PageCache(this);
+  }
+  return page_cache_->Get(offset, count);
+}
+
+
+// static
+uint64_t Minidump::page_cache_bytes() {
+  return PageCache::total_bytes();
+}
+
+
+void Minidump::ReleaseStream(uint32_t stream_type) {
+  if (!valid_)
+    return;
+
+  MinidumpStreamMap::iterator iterator = stream_map_->find(stream_type);
+  if (iterator == stream_map_->end())
+    return;
+  delete iterator->second.stream;
+  iterator->second.stream = NULL;
+}
+
+
 string* Minidump::ReadString(off_t offset) {
+  scoped_ptr<string> string_utf8(new string());
+  if (!ReadString(offset, string_utf8.get()))
+    return NULL;
+  return string_utf8.release();
+}
+
+
+bool Minidump::ReadString(off_t offset, string* string_utf8) {
   if (!valid_) {
     BPLOG(ERROR) << "Invalid Minidump for ReadString";
-    return NULL;
+    return false;
   }
   if (!SeekSet(offset)) {
     BPLOG(ERROR) << "ReadString could not seek to string at offset " << offset;
-    return NULL;
+    return false;
   }
 
   uint32_t bytes;
   if (!ReadBytes(&bytes, sizeof(bytes))) {
     BPLOG(ERROR) << "ReadString could not read string size at offset " <<
                     offset;
-    return NULL;
+    return false;
   }
   if (swap_)
     Swap(&bytes);
@@ -6167,7 +7259,7 @@ string* Minidump::ReadString(off_t offset) {
   if (bytes % 2 != 0) {
     BPLOG(ERROR) << "ReadString found odd-sized " << bytes <<
                     "-byte string at offset " << offset;
-    return NULL;
+    return false;
   }
   unsigned int utf16_words = bytes / 2;
 
@@ -6175,20 +7267,26 @@ string* Minidump::ReadString(off_t offset) {
     BPLOG(ERROR) << "ReadString string length " << utf16_words <<
                     " exceeds maximum " << max_string_length_ <<
                     " at offset " << offset;
-    return NULL;
+    return false;
   }
 
-  vector<uint16_t> string_utf16(utf16_words);
-
-  if (utf16_words) {
-    if (!ReadBytes(&string_utf16[0], bytes)) {
+  // A minidump held in memory is converted in place.  Otherwise the string
+  // is read into a buffer kept for the next one.
+  const uint8_t* utf16 = GetDataAtOffset(Tell(), bytes);
+  if (utf16) {
+    SeekSet(Tell() + bytes);
+  } else {
+    if (string_buffer_.size() < bytes)
+      string_buffer_.resize(bytes);
+    if (bytes && !ReadBytes(&string_buffer_[0], bytes)) {
       BPLOG(ERROR) << "ReadString could not read " << bytes <<
                       "-byte string at offset " << offset;
-      return NULL;
+      return false;
     }
+    utf16 = string_buffer_.data();
   }
 
-  return UTF16ToUTF8(string_utf16, swap_);
+  return UTF16ToUTF8(utf16, utf16_words, swap_, string_utf8);
 }
 
 
@@ -6485,18 +7583,26 @@ T* Minidump::GetStream(T** stream) {
     return *stream;
   }
 
+  if (info->read_failed)
+    return NULL;
+
   uint32_t stream_length;
   if (!SeekToStreamType(stream_type, &stream_length)) {
     BPLOG(ERROR) << "GetStream could not seek to stream type " << stream_type;
+    info->read_failed = true;
     return NULL;
   }
 
   scoped_ptr<T> new_stream(new T(this));
 
+  BPTRACE2(minidump_stream_begin, stream_type, stream_length);
   if (!new_stream->Read(stream_length)) {
+    BPTRACE2(minidump_stream_end, stream_type, 0);
     BPLOG(ERROR) << "GetStream could not read stream type " << stream_type;
+    info->read_failed = true;
     return NULL;
   }
+  BPTRACE2(minidump_stream_end, stream_type, 1);
 
   *stream = new_stream.release();
   info->stream = *stream;
@@ -35,10 +35,15 @@
 #include <config.h>  // Must come first
 #endif
 
+#include <ctype.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "common/path_helper.h"
 #include "common/scoped_ptr.h"
 #include "google_breakpad/processor/minidump.h"
@@ -57,17 +62,31 @@ using google_breakpad::MinidumpAssertion;
 using google_breakpad::MinidumpSystemInfo;
 using google_breakpad::MinidumpMiscInfo;
 using google_breakpad::MinidumpBreakpadInfo;
+using google_breakpad::MinidumpBreadcrumbs;
 using google_breakpad::MinidumpCrashpadInfo;
 
 struct Options {
   Options()
-      : minidumpPath(), hexdump(false), hexdump_width(16) {}
+      : minidumpPath(), hexdump(false), hexdump_width(16), stream(false),
+        print_memory(true) {}
 
   string minidumpPath;
   bool hexdump;
   unsigned int hexdump_width;
+
+  // Print the memory lists straight from the file through a fixed-size
+  // buffer instead of loading every region, so that the memory needed
+  // doesn't grow with the size of the minidump.
+  bool stream;
+
+  // When streaming, whether to print the contents of memory regions or
+  // only their descriptors.
+  bool print_memory;
 };
 
+// The size of the buffer through which streaming reads memory regions.
+static const size_t kStreamBufferSize = 64 * 1024;
+
 static void DumpRawStream(Minidump *minidump,
                           uint32_t stream_type,
                           const char *stream_name,
@@ -107,6 +126,312 @@ static void DumpRawStream(Minidump *minidump,
   printf("\n\n");
 }
 
+// Reverses the bytes of |value|, for minidumps of the other endianness.
+template<typename T>
+static void SwapBytes(T* value) {
+  uint8_t* bytes = reinterpret_cast<uint8_t*>(value);
+  for (size_t i = 0; i < sizeof(T) / 2; ++i)
+    std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+}
+
+// Prints |size| bytes of memory found at |rva| in the same form as
+// MinidumpMemoryRegion::Print, reading at most kStreamBufferSize bytes at
+// a time.
+static bool StreamMemory(Minidump *minidump,
+                         const Options& options,
+                         uint64_t rva,
+                         uint64_t size) {
+  if (!minidump->SeekSet(rva)) {
+    BPLOG(ERROR) << "minidump.SeekSet failed";
+    printf("No memory\n");
+    return false;
+  }
+
+  const unsigned int width = options.hexdump_width;
+  std::vector<uint8_t> buffer(std::max(kStreamBufferSize / width, size_t(1)) *
+                              width);
+  if (!options.hexdump)
+    printf("0x");
+  for (uint64_t offset = 0; offset < size;) {
+    size_t count = std::min<uint64_t>(size - offset, buffer.size());
+    if (!minidump->ReadBytes(&buffer[0], count)) {
+      printf("\n");
+      BPLOG(ERROR) << "minidump.ReadBytes failed";
+      return false;
+    }
+
+    if (!options.hexdump) {
+      for (size_t i = 0; i < count; ++i)
+        printf("%02x", buffer[i]);
+    } else {
+      // The buffer holds whole lines, so only the last one can be short.
+      for (size_t line = 0; line < count; line += width) {
+        size_t num_bytes = std::min<size_t>(count - line, width);
+        printf("%08" PRIx64 "  ", offset + line);
+        for (unsigned int i = 0; i < width; ++i) {
+          if (i < num_bytes)
+            printf("%02x ", buffer[line + i]);
+          else
+            printf("   ");
+          if (((i + 1) % 8) == 0)
+            printf(" ");
+        }
+        printf("|");
+        for (unsigned int i = 0; i < width; ++i) {
+          if (i < num_bytes) {
+            uint8_t byte = buffer[line + i];
+            printf("%c", isprint(byte) ? byte : '.');
+          } else {
+            printf(" ");
+          }
+        }
+        printf("|\n");
+      }
+    }
+    offset += count;
+  }
+  if (!options.hexdump)
+    printf("\n");
+  return true;
+}
+
+// Prints MD_MEMORY_LIST_STREAM in the same form as MinidumpMemoryList::Print,
+// reading one descriptor and one buffer of memory at a time.
+static void StreamMemoryList(Minidump *minidump,
+                             const Options& options,
+                             int *errors) {
+  uint32_t length = 0;
+  if (!minidump->SeekToStreamType(MD_MEMORY_LIST_STREAM, &length)) {
+    ++*errors;
+    BPLOG(ERROR) << "minidump.SeekToStreamType(MD_MEMORY_LIST_STREAM) failed";
+    return;
+  }
+
+  off_t list_rva = minidump->Tell();
+  uint32_t region_count;
+  if (length < sizeof(region_count) ||
+      !minidump->ReadBytes(&region_count, sizeof(region_count))) {
+    ++*errors;
+    BPLOG(ERROR) << "minidump.ReadBytes failed";
+    return;
+  }
+  if (minidump->swap())
+    SwapBytes(&region_count);
+
+  // Some writers pad the count to 8 bytes, so only require the descriptors
+  // to fit, and find them from the end of the stream.
+  if (region_count > (length - sizeof(region_count)) /
+                     sizeof(MDMemoryDescriptor)) {
+    ++*errors;
+    BPLOG(ERROR) << "MD_MEMORY_LIST_STREAM region count mismatch";
+    return;
+  }
+  off_t descriptors_rva = list_rva + length -
+                          region_count * sizeof(MDMemoryDescriptor);
+
+  printf("MinidumpMemoryList\n");
+  printf("  region_count = %d\n", region_count);
+  printf("\n");
+
+  for (uint32_t region_index = 0; region_index < region_count;
+       ++region_index) {
+    MDMemoryDescriptor descriptor;
+    if (!minidump->SeekSet(descriptors_rva +
+                           region_index * sizeof(descriptor)) ||
+        !minidump->ReadBytes(&descriptor, sizeof(descriptor))) {
+      ++*errors;
+      BPLOG(ERROR) << "minidump.ReadBytes failed";
+      return;
+    }
+    if (minidump->swap()) {
+      SwapBytes(&descriptor.start_of_memory_range);
+      SwapBytes(&descriptor.memory.data_size);
+      SwapBytes(&descriptor.memory.rva);
+    }
+
+    printf("region[%d]\n", region_index);
+    printf("MDMemoryDescriptor\n");
+    printf("  start_of_memory_range = 0x%" PRIx64 "\n",
+           descriptor.start_of_memory_range);
+    printf("  memory.data_size      = 0x%x\n", descriptor.memory.data_size);
+    printf("  memory.rva            = 0x%x\n", descriptor.memory.rva);
+    if (options.print_memory) {
+      printf("Memory\n");
+      if (!StreamMemory(minidump, options, descriptor.memory.rva,
+                        descriptor.memory.data_size)) {
+        ++*errors;
+      }
+    }
+    printf("\n");
+  }
+}
+
+// Prints MD_MEMORY_64_LIST_STREAM, which full-memory minidumps use, reading
+// one descriptor and one buffer of memory at a time.
+static void StreamMemory64List(Minidump *minidump,
+                               const Options& options,
+                               int *errors) {
+  uint32_t length = 0;
+  if (!minidump->SeekToStreamType(MD_MEMORY_64_LIST_STREAM, &length)) {
+    return;
+  }
+
+  off_t list_rva = minidump->Tell();
+  uint64_t header[2];
+  if (length < MDRawMemory64List_minsize ||
+      !minidump->ReadBytes(header, sizeof(header))) {
+    ++*errors;
+    BPLOG(ERROR) << "minidump.ReadBytes failed";
+    return;
+  }
+  if (minidump->swap()) {
+    SwapBytes(&header[0]);
+    SwapBytes(&header[1]);
+  }
+  uint64_t region_count = header[0];
+  uint64_t memory_rva = header[1];
+  if (region_count > (length - MDRawMemory64List_minsize) /
+                     sizeof(MDMemoryDescriptor64)) {
+    ++*errors;
+    BPLOG(ERROR) << "MD_MEMORY_64_LIST_STREAM region count mismatch";
+    return;
+  }
+
+  printf("MinidumpMemory64List\n");
+  printf("  region_count = %" PRIu64 "\n", region_count);
+  printf("  base_rva     = 0x%" PRIx64 "\n", memory_rva);
+  printf("\n");
+
+  for (uint64_t region_index = 0; region_index < region_count;
+       ++region_index) {
+    MDMemoryDescriptor64 descriptor;
+    if (!minidump->SeekSet(list_rva + MDRawMemory64List_minsize +
+                           region_index * sizeof(descriptor)) ||
+        !minidump->ReadBytes(&descriptor, sizeof(descriptor))) {
+      ++*errors;
+      BPLOG(ERROR) << "minidump.ReadBytes failed";
+      return;
+    }
+    if (minidump->swap()) {
+      SwapBytes(&descriptor.start_of_memory_range);
+      SwapBytes(&descriptor.data_size);
+    }
+
+    printf("region[%" PRIu64 "]\n", region_index);
+    printf("MDMemoryDescriptor64\n");
+    printf("  start_of_memory_range = 0x%" PRIx64 "\n",
+           descriptor.start_of_memory_range);
+    printf("  data_size             = 0x%" PRIx64 "\n", descriptor.data_size);
+    printf("  rva                   = 0x%" PRIx64 "\n", memory_rva);
+    if (options.print_memory) {
+      printf("Memory\n");
+      if (!StreamMemory(minidump, options, memory_rva,
+                        descriptor.data_size)) {
+        ++*errors;
+      }
+    }
+    printf("\n");
+    memory_rva += descriptor.data_size;
+  }
+}
+
+static const char* DumpTimingPhaseName(uint32_t phase) {
+  static const char* const kNames[MD_DUMP_TIMING_PHASE_COUNT] = {
+    "handler",
+    "clone",
+    "thread enumeration",
+    "mapping enumeration",
+    "threads suspend",
+    "thread list",
+    "proc files",
+    "module list",
+    "memory list",
+    "other streams",
+    "threads resume",
+    "file write",
+  };
+  return phase < MD_DUMP_TIMING_PHASE_COUNT ? kNames[phase] : "unknown";
+}
+
+static void DumpTimingStream(Minidump *minidump, int *errors) {
+  uint32_t length = 0;
+  if (!minidump->SeekToStreamType(MD_LINUX_DUMP_TIMING, &length)) {
+    return;
+  }
+
+  printf("Stream MD_LINUX_DUMP_TIMING:\n");
+
+  MDRawDumpTiming timing;
+  if (length < MDRawDumpTiming_minsize ||
+      !minidump->ReadBytes(&timing, MDRawDumpTiming_minsize)) {
+    ++*errors;
+    BPLOG(ERROR) << "minidump.ReadBytes failed";
+    return;
+  }
+  if (minidump->swap()) {
+    SwapBytes(&timing.version);
+    SwapBytes(&timing.phase_count);
+  }
+  printf("  version     = %u\n", timing.version);
+  printf("  phase_count = %u\n", timing.phase_count);
+  if (timing.phase_count > (length - MDRawDumpTiming_minsize) /
+                           sizeof(MDRawDumpTimingPhase)) {
+    ++*errors;
+    BPLOG(ERROR) << "MD_LINUX_DUMP_TIMING phase count mismatch";
+    return;
+  }
+
+  for (uint32_t i = 0; i < timing.phase_count; ++i) {
+    MDRawDumpTimingPhase phase;
+    if (!minidump->ReadBytes(&phase, sizeof(phase))) {
+      ++*errors;
+      BPLOG(ERROR) << "minidump.ReadBytes failed";
+      return;
+    }
+    if (minidump->swap()) {
+      SwapBytes(&phase.phase);
+      SwapBytes(&phase.start_ns);
+      SwapBytes(&phase.duration_ns);
+    }
+    printf("  phase[%u] %-20s start_ns = %llu duration_ns = %llu\n", i,
+           DumpTimingPhaseName(phase.phase),
+           static_cast<unsigned long long>(phase.start_ns),
+           static_cast<unsigned long long>(phase.duration_ns));
+  }
+  printf("\n");
+}
+
+static void DumpLiveDumpStream(Minidump *minidump, int *errors) {
+  uint32_t length = 0;
+  if (!minidump->SeekToStreamType(MD_LINUX_LIVE_DUMP, &length)) {
+    return;
+  }
+
+  printf("Stream MD_LINUX_LIVE_DUMP:\n");
+
+  MDRawLinuxLiveDump live;
+  if (length < sizeof(live) || !minidump->ReadBytes(&live, sizeof(live))) {
+    ++*errors;
+    BPLOG(ERROR) << "minidump.ReadBytes failed";
+    return;
+  }
+  if (minidump->swap()) {
+    SwapBytes(&live.version);
+    SwapBytes(&live.stopped_stream_count);
+    SwapBytes(&live.suspend_ns);
+    SwapBytes(&live.resume_ns);
+  }
+  printf("  version              = %u\n", live.version);
+  printf("  stopped_stream_count = %u\n", live.stopped_stream_count);
+  printf("  suspend_ns           = %llu\n",
+         static_cast<unsigned long long>(live.suspend_ns));
+  printf("  resume_ns            = %llu\n",
+         static_cast<unsigned long long>(live.resume_ns));
+  printf("  (the streams after the first %u were written while the process "
+         "ran)\n", live.stopped_stream_count);
+  printf("\n");
+}
+
 static bool PrintMinidumpDump(const Options& options) {
   Minidump minidump(options.minidumpPath,
                     options.hexdump);
@@ -142,13 +467,20 @@ static bool PrintMinidumpDump(const Options& options) {
     module_list->Print();
   }
 
-  MinidumpMemoryList *memory_list = minidump.GetMemoryList();
-  if (!memory_list) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetMemoryList() failed";
+  if (options.stream) {
+    StreamMemoryList(&minidump, options, &errors);
   } else {
-    memory_list->Print();
+    MinidumpMemoryList *memory_list = minidump.GetMemoryList();
+    if (!memory_list) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetMemoryList() failed";
+    } else {
+      memory_list->Print();
+    }
   }
+  // The 64-bit memory list, which is only found in full-memory minidumps,
+  // is always streamed, so that its memory is printed a buffer at a time.
+  StreamMemory64List(&minidump, options, &errors);
 
   MinidumpException *exception = minidump.GetException();
   if (!exception) {
@@ -202,6 +534,12 @@ static bool PrintMinidumpDump(const Options& options) {
     crashpad_info->Print();
   }
 
+  MinidumpBreadcrumbs *breadcrumbs = minidump.GetBreadcrumbs();
+  if (breadcrumbs) {
+    // Breadcrumbs are optional, so don't treat absence as an error.
+    breadcrumbs->Print();
+  }
+
   DumpRawStream(&minidump,
                 MD_LINUX_CMD_LINE,
                 "MD_LINUX_CMD_LINE",
@@ -226,6 +564,8 @@ static bool PrintMinidumpDump(const Options& options) {
                 MD_LINUX_MAPS,
                 "MD_LINUX_MAPS",
                 &errors);
+  DumpTimingStream(&minidump, &errors);
+  DumpLiveDumpStream(&minidump, &errors);
 
   return errors == 0;
 }
@@ -242,6 +582,9 @@ Usage(int argc, char *argv[], bool error) {
           "Options:\n"
           "  <minidump> should be a minidump.\n"
           "  -x:\t Display memory in a hexdump like format\n"
+          "  -s:\t Stream memory regions from the file in fixed-size\n"
+          "     \t pieces, for very large minidumps\n"
+          "  -m:\t With -s, print memory descriptors but not contents\n"
           "  -h:\t Usage\n",
           google_breakpad::BaseName(argv[0]).c_str());
 }
@@ -251,11 +594,17 @@ static void
 SetupOptions(int argc, char *argv[], Options *options) {
   int ch;
 
-  while ((ch = getopt(argc, (char * const*)argv, "xh")) != -1) {
+  while ((ch = getopt(argc, (char * const*)argv, "xsmh")) != -1) {
     switch (ch) {
       case 'x':
         options->hexdump = true;
         break;
+      case 's':
+        options->stream = true;
+        break;
+      case 'm':
+        options->print_memory = false;
+        break;
       case 'h':
         Usage(argc, argv, false);
         exit(0);
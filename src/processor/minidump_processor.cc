@@ -33,24 +33,40 @@
 #include "google_breakpad/processor/minidump_processor.h"
 
 #include <assert.h>
+#include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstdio>
+#include <deque>
+#include <functional>
 #include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
+#include <typeinfo>
 #include <utility>
+#include <vector>
 
 #include "common/scoped_ptr.h"
 #include "common/stdio_wrapper.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/call_stack.h"
 #include "google_breakpad/processor/minidump.h"
+#include "google_breakpad/processor/process_observer.h"
 #include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/process_stats.h"
 #include "google_breakpad/processor/exploitability.h"
+#include "google_breakpad/processor/stack_frame_cpu.h"
 #include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "google_breakpad/processor/stackwalk_budget.h"
+#include "processor/address_validity_cache.h"
 #include "processor/logging.h"
+#include "processor/pathname_stripper.h"
 #include "processor/stackwalker_x86.h"
 #include "processor/symbolic_constants_win.h"
 
@@ -60,14 +76,746 @@
 
 namespace google_breakpad {
 
+namespace {
+
+// A thread's registers and stack memory, as compared when looking for
+// threads whose walks would be identical.
+struct StackImage {
+  uint32_t cpu;
+  // The raw MDRawContext* structure, and the CPU's pointer size.
+  const uint8_t* context;
+  size_t context_size;
+  size_t word_size;
+  const MemoryRegion* memory;
+  uint64_t base;
+  uint64_t size;
+  uint64_t stack_pointer;
+};
+
+// Everything needed to walk one thread's stack.  The minidump is only read
+// while these are being gathered, so the walks themselves may run on any
+// thread.
+struct ThreadWalk {
+  uint32_t thread_id;
+  MinidumpContext* context;
+  MinidumpMemoryRegion* thread_memory;
+  string thread_string;
+  // Owned by the ProcessState.
+  CallStack* stack;
+  // The index of |stack| in ProcessState::threads().
+  int thread_index;
+  // Filled by parallel walks only, and merged into the ProcessState once
+  // every walk is done.
+  vector<const CodeModule*> modules_without_symbols;
+  vector<const CodeModule*> modules_with_corrupt_symbols;
+  bool interrupted;
+  // Set when stack deduplication is enabled and the thread's CPU is
+  // supported.
+  bool has_image;
+  StackImage image;
+  // The index, in the list of walks, of the walk whose frames this one
+  // reuses instead of walking, or -1.
+  int duplicate_of;
+  // Walks with lower ranks are handed out first by parallel walks.
+  unsigned int rank;
+};
+
+// The number of stack bytes above the stack pointer that are hashed; the
+// rest of the stack is only compared once the hashes match.
+const uint64_t kStackImageHashWindow = 1024;
+
+// Fills |image| from |context| and |memory|.  Returns false if the CPU is
+// not supported or the stack pointer is not within |memory|.
+bool GetStackImage(const MinidumpContext* context,
+                   const MinidumpMemoryRegion* memory,
+                   StackImage* image) {
+  if (!context || !memory)
+    return false;
+  image->cpu = context->GetContextCPU();
+  switch (image->cpu) {
+    case MD_CONTEXT_X86:
+      image->context =
+          reinterpret_cast<const uint8_t*>(context->GetContextX86());
+      image->context_size = sizeof(MDRawContextX86);
+      image->word_size = sizeof(uint32_t);
+      break;
+    case MD_CONTEXT_AMD64:
+      image->context =
+          reinterpret_cast<const uint8_t*>(context->GetContextAMD64());
+      image->context_size = sizeof(MDRawContextAMD64);
+      image->word_size = sizeof(uint64_t);
+      break;
+    case MD_CONTEXT_ARM:
+      image->context =
+          reinterpret_cast<const uint8_t*>(context->GetContextARM());
+      image->context_size = sizeof(MDRawContextARM);
+      image->word_size = sizeof(uint32_t);
+      break;
+    case MD_CONTEXT_ARM64:
+      image->context =
+          reinterpret_cast<const uint8_t*>(context->GetContextARM64());
+      image->context_size = sizeof(MDRawContextARM64);
+      image->word_size = sizeof(uint64_t);
+      break;
+    default:
+      return false;
+  }
+  image->memory = memory;
+  image->base = memory->GetBase();
+  image->size = memory->GetSize();
+  return image->context && image->size &&
+         context->GetStackPointer(&image->stack_pointer) &&
+         image->stack_pointer - image->base < image->size;
+}
+
+// Reads the word at |offset| in |image|'s raw context.
+uint64_t ContextWord(const StackImage& image, size_t offset) {
+  if (image.word_size == sizeof(uint32_t)) {
+    uint32_t word;
+    memcpy(&word, image.context + offset, sizeof(word));
+    return word;
+  }
+  uint64_t word;
+  memcpy(&word, image.context + offset, sizeof(word));
+  return word;
+}
+
+// Reads the word at |offset| in |image|'s stack.  The final, partial word
+// of a stack is read a byte at a time.
+uint64_t StackWord(const StackImage& image, uint64_t offset) {
+  uint64_t address = image.base + offset;
+  if (offset + image.word_size <= image.size) {
+    if (image.word_size == sizeof(uint32_t)) {
+      uint32_t word = 0;
+      image.memory->GetMemoryAtAddress(address, &word);
+      return word;
+    }
+    uint64_t word = 0;
+    image.memory->GetMemoryAtAddress(address, &word);
+    return word;
+  }
+  uint64_t word = 0;
+  for (uint64_t i = 0; offset + i < image.size; ++i) {
+    uint8_t byte = 0;
+    image.memory->GetMemoryAtAddress(address + i, &byte);
+    word |= static_cast<uint64_t>(byte) << (8 * i);
+  }
+  return word;
+}
+
+// Two words match if they are equal, or if both point into their own
+// thread's stack at the same offset.
+bool WordsMatch(const StackImage& a, uint64_t a_word,
+                const StackImage& b, uint64_t b_word) {
+  bool a_in_stack = a_word - a.base < a.size;
+  bool b_in_stack = b_word - b.base < b.size;
+  if (a_in_stack != b_in_stack)
+    return false;
+  return a_in_stack ? a_word - a.base == b_word - b.base : a_word == b_word;
+}
+
+// Mixes |word| into the FNV-1a hash |hash|.
+void MixHash(uint64_t word, uint64_t* hash) {
+  for (int i = 0; i < 8; ++i) {
+    *hash ^= (word >> (8 * i)) & 0xff;
+    *hash *= 0x100000001b3ULL;
+  }
+}
+
+// Mixes |word| into |hash|, taking it relative to the stack's base if it
+// points into the stack.
+void HashWord(const StackImage& image, uint64_t word, uint64_t* hash) {
+  if (word - image.base < image.size)
+    word = (word - image.base) ^ 0x9e3779b97f4a7c15ULL;
+  MixHash(word, hash);
+}
+
+// Hashes |image|'s registers and the stack just above its stack pointer.
+// Images that match always have the same hash.
+uint64_t HashStackImage(const StackImage& image) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  MixHash(image.cpu, &hash);
+  MixHash(image.size, &hash);
+  for (size_t offset = 0; offset + image.word_size <= image.context_size;
+       offset += image.word_size) {
+    HashWord(image, ContextWord(image, offset), &hash);
+  }
+  uint64_t end = std::min(image.size,
+                          image.stack_pointer - image.base +
+                              kStackImageHashWindow);
+  for (uint64_t offset = image.stack_pointer - image.base; offset < end;
+       offset += image.word_size) {
+    HashWord(image, StackWord(image, offset), &hash);
+  }
+  return hash;
+}
+
+// Returns true if walking |a| and |b| would produce the same frames, up to
+// the location of the stack.  The whole stack is compared, since a walk
+// may read any of it.
+bool StackImagesMatch(const StackImage& a, const StackImage& b) {
+  if (a.cpu != b.cpu || a.size != b.size ||
+      a.stack_pointer - a.base != b.stack_pointer - b.base) {
+    return false;
+  }
+  size_t offset = 0;
+  for (; offset + a.word_size <= a.context_size; offset += a.word_size) {
+    if (!WordsMatch(a, ContextWord(a, offset), b, ContextWord(b, offset)))
+      return false;
+  }
+  if (memcmp(a.context + offset, b.context + offset,
+             a.context_size - offset) != 0) {
+    return false;
+  }
+  for (uint64_t offset = 0; offset < a.size; offset += a.word_size) {
+    if (!WordsMatch(a, StackWord(a, offset), b, StackWord(b, offset)))
+      return false;
+  }
+  return true;
+}
+
+// Moves every |Word| in |data| that points into |from|'s stack to the same
+// offset in the stack starting at |to_base|.
+template<typename Word>
+void RebaseWords(uint8_t* data, size_t size, const StackImage& from,
+                 uint64_t to_base) {
+  for (size_t offset = 0; offset + sizeof(Word) <= size;
+       offset += sizeof(Word)) {
+    Word word;
+    memcpy(&word, data + offset, sizeof(word));
+    if (word - from.base < from.size) {
+      word = static_cast<Word>(word - from.base + to_base);
+      memcpy(data + offset, &word, sizeof(word));
+    }
+  }
+}
+
+// Copies a CPU-specific frame into |pool|, moving its registers to the new
+// stack.
+template<typename FrameType, typename Word>
+StackFrame* CopyCPUFrame(const StackFrame* frame, const StackImage& from,
+                         uint64_t to_base, CallStack* pool) {
+  FrameType* copy =
+      new (pool) FrameType(*static_cast<const FrameType*>(frame));
+  RebaseWords<Word>(reinterpret_cast<uint8_t*>(&copy->context),
+                    sizeof(copy->context), from, to_base);
+  return copy;
+}
+
+// Returns a copy of |frame|, which was walked on |from|'s stack, as it
+// would have been walked on the stack starting at |to_base|, allocated in
+// the frame pool of |pool|.
+StackFrame* CopyFrame(const StackFrame* frame, const StackImage& from,
+                      uint64_t to_base, CallStack* pool) {
+  if (typeid(*frame) == typeid(StackFrameX86)) {
+    StackFrame* copy =
+        CopyCPUFrame<StackFrameX86, uint32_t>(frame, from, to_base, pool);
+    // These are owned by the original frame, and only needed while
+    // walking.
+    static_cast<StackFrameX86*>(copy)->windows_frame_info = NULL;
+    static_cast<StackFrameX86*>(copy)->cfi_frame_info = NULL;
+    return copy;
+  }
+  if (typeid(*frame) == typeid(StackFrameAMD64))
+    return CopyCPUFrame<StackFrameAMD64, uint64_t>(frame, from, to_base,
+                                                   pool);
+  if (typeid(*frame) == typeid(StackFrameARM))
+    return CopyCPUFrame<StackFrameARM, uint32_t>(frame, from, to_base, pool);
+  if (typeid(*frame) == typeid(StackFrameARM64))
+    return CopyCPUFrame<StackFrameARM64, uint64_t>(frame, from, to_base,
+                                                   pool);
+  // Inlined frames carry no registers.
+  return new (pool) StackFrame(*frame);
+}
+
+// Fills |frames| with copies of |original|'s frames, moved to |walk|'s
+// stack.
+void CopyDuplicateWalk(const ThreadWalk& original, ThreadWalk* walk,
+                       vector<StackFrame*>* frames) {
+  for (const StackFrame* frame : *original.stack->frames())
+    frames->push_back(
+        CopyFrame(frame, original.image, walk->image.base, walk->stack));
+  walk->interrupted = original.interrupted;
+  walk->stack->set_tid(walk->thread_id);
+  walk->stack->set_duplicate_of(original.thread_index);
+  walk->stack->set_budget_exhausted(original.stack->budget_exhausted());
+}
+
+// Reads from another MemoryRegion, counting the reads that fail.
+class StatsMemoryRegion : public MemoryRegion {
+ public:
+  StatsMemoryRegion(const MemoryRegion* memory, ProcessStats* stats)
+      : memory_(memory), stats_(stats) { }
+
+  uint64_t GetBase() const override { return memory_->GetBase(); }
+  uint32_t GetSize() const override { return memory_->GetSize(); }
+
+  bool GetMemoryAtAddress(uint64_t address, uint8_t* value) const override {
+    return Count(memory_->GetMemoryAtAddress(address, value));
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint16_t* value) const override {
+    return Count(memory_->GetMemoryAtAddress(address, value));
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint32_t* value) const override {
+    return Count(memory_->GetMemoryAtAddress(address, value));
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const override {
+    return Count(memory_->GetMemoryAtAddress(address, value));
+  }
+  bool GetMemoryArrayAtAddress(uint64_t address, uint32_t* values,
+                               size_t count) const override {
+    return Count(memory_->GetMemoryArrayAtAddress(address, values, count));
+  }
+  bool GetMemoryArrayAtAddress(uint64_t address, uint64_t* values,
+                               size_t count) const override {
+    return Count(memory_->GetMemoryArrayAtAddress(address, values, count));
+  }
+
+  void Print() const override { memory_->Print(); }
+
+ private:
+  bool Count(bool read) const {
+    if (!read)
+      stats_->AddMemoryReadFailure();
+    return read;
+  }
+
+  const MemoryRegion* memory_;
+  ProcessStats* stats_;
+};
+
+// Walks |walk->context| into |walk->stack|, adding modules that need
+// attention to |modules_without_symbols| and |modules_with_corrupt_symbols|.
+// The walk is limited by |budget|, if it is not NULL, and recorded in
+// |stats|, if it is not NULL.  Its stack scans check candidate return
+// addresses against |validity_cache| first.  If |defer_source_line_info|
+// is true, the frames' source line info is left for later; see
+// Stackwalker::set_defer_source_line_info.
+void WalkThreadStack(const ProcessState* process_state,
+                     StackFrameSymbolizer* frame_symbolizer,
+                     StackwalkBudget* budget,
+                     ProcessStats* stats,
+                     AddressValidityCache* validity_cache,
+                     bool defer_source_line_info,
+                     ThreadWalk* walk,
+                     vector<const CodeModule*>* modules_without_symbols,
+                     vector<const CodeModule*>* modules_with_corrupt_symbols) {
+  MemoryRegion* memory = walk->thread_memory;
+  scoped_ptr<StatsMemoryRegion> stats_memory;
+  if (stats && memory) {
+    stats_memory.reset(new StatsMemoryRegion(memory, stats));
+    memory = stats_memory.get();
+  }
+
+  // Use process_state->modules() instead of module_list, because the
+  // |modules| argument will be used to populate the |module| fields in
+  // the returned StackFrame objects, which will be placed into the
+  // returned ProcessState object.  module_list's lifetime is only as
+  // long as the Minidump object: it will be deleted when this function
+  // returns.  process_state->modules() is owned by the ProcessState object
+  // (just like the StackFrame objects), and is much more suitable for this
+  // task.
+  scoped_ptr<Stackwalker> stackwalker(
+      Stackwalker::StackwalkerForCPU(process_state->system_info(),
+                                     walk->context,
+                                     memory,
+                                     process_state->modules(),
+                                     process_state->unloaded_modules(),
+                                     frame_symbolizer));
+
+  walk->interrupted = false;
+  if (stackwalker.get()) {
+    stackwalker->set_budget(budget);
+    stackwalker->set_stats(stats);
+    stackwalker->set_validity_cache(validity_cache);
+    stackwalker->set_defer_source_line_info(defer_source_line_info);
+    if (!stackwalker->Walk(walk->stack,
+                           modules_without_symbols,
+                           modules_with_corrupt_symbols)) {
+      BPLOG(INFO) << "Stackwalker interrupt (missing symbols?) at "
+                  << walk->thread_string;
+      walk->interrupted = true;
+    }
+  } else {
+    // Threads with missing CPU contexts will hit this, but
+    // don't abort processing the rest of the dump just for
+    // one bad thread.
+    BPLOG(ERROR) << "No stackwalker for " << walk->thread_string;
+  }
+  walk->stack->set_tid(walk->thread_id);
+}
+
+// Appends the modules in |from| that are not already in |to|.  Merging the
+// walks in thread order keeps the order a serial walk would have produced.
+void MergeModules(const vector<const CodeModule*>& from,
+                  vector<const CodeModule*>* to) {
+  for (const CodeModule* module : from) {
+    if (std::find(to->begin(), to->end(), module) == to->end())
+      to->push_back(module);
+  }
+}
+
+// Hands the threads of a ProcessState to a ProcessObserver as they are
+// walked: the requesting thread first, then the others in order, each held
+// back until those before it have been handed over.  Nothing is handed
+// over until the requesting thread's index is known.
+class ThreadDelivery {
+ public:
+  ThreadDelivery(ProcessObserver* observer, const ProcessState* process_state)
+      : observer_(observer),
+        process_state_(process_state),
+        requesting_thread_(-1),
+        requesting_thread_known_(false),
+        process_info_delivered_(false),
+        requesting_thread_delivered_(false),
+        next_thread_(0) {}
+
+  // Records that the requesting thread is at |index| in the ProcessState's
+  // threads, or that there is none if |index| is -1.
+  void SetRequestingThread(int index) {
+    requesting_thread_ = index;
+    requesting_thread_known_ = true;
+    Deliver();
+  }
+
+  // Records that the stack of the thread at |index| is complete.
+  void SetWalked(size_t index) {
+    if (walked_.size() <= index)
+      walked_.resize(index + 1, false);
+    walked_[index] = true;
+    Deliver();
+  }
+
+ private:
+  void Deliver() {
+    if (!observer_ || !requesting_thread_known_)
+      return;
+    if (!process_info_delivered_) {
+      observer_->OnProcessInfo(*process_state_);
+      process_info_delivered_ = true;
+    }
+    if (requesting_thread_ >= 0 && !requesting_thread_delivered_) {
+      if (static_cast<size_t>(requesting_thread_) >= walked_.size() ||
+          !walked_[requesting_thread_])
+        return;
+      observer_->OnThread(*process_state_, requesting_thread_);
+      requesting_thread_delivered_ = true;
+    }
+    for (; next_thread_ < walked_.size() && walked_[next_thread_];
+         ++next_thread_) {
+      if (static_cast<int>(next_thread_) != requesting_thread_)
+        observer_->OnThread(*process_state_, next_thread_);
+    }
+  }
+
+  ProcessObserver* observer_;
+  const ProcessState* process_state_;
+  int requesting_thread_;
+  bool requesting_thread_known_;
+  bool process_info_delivered_;
+  bool requesting_thread_delivered_;
+  // Whether each thread's stack is complete, by index.
+  vector<bool> walked_;
+  // The index of the first thread other than the requesting one that has
+  // not been handed over.
+  size_t next_thread_;
+};
+
+// Walks every entry of |walks| using up to |worker_count| threads, the
+// calling thread included.  The walk at |first_walk| is handed out first,
+// and the worker that walks it then runs |after_first_walk|, if set, while
+// the others carry on walking.  Every worker runs |after_walk|, if set, with
+// the index of each walk it completes, first.
+void WalkThreadStacksInParallel(
+    const ProcessState* process_state,
+    StackFrameSymbolizer* frame_symbolizer,
+    StackwalkBudget* budget,
+    ProcessStats* stats,
+    AddressValidityCache* validity_cache,
+    bool defer_source_line_info,
+    vector<ThreadWalk>* walks,
+    size_t first_walk,
+    int worker_count,
+    const std::function<void(size_t)>& after_walk,
+    const std::function<void()>& after_first_walk) {
+  vector<size_t> order;
+  order.reserve(walks->size());
+  if (first_walk < walks->size())
+    order.push_back(first_walk);
+  for (size_t i = 0; i < walks->size(); ++i) {
+    if (i != first_walk)
+      order.push_back(i);
+  }
+  std::stable_sort(order.begin() + (first_walk < walks->size() ? 1 : 0),
+                   order.end(), [walks](size_t a, size_t b) {
+                     return (*walks)[a].rank < (*walks)[b].rank;
+                   });
+
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    ProcessStats::Scope stats_scope(stats);
+    size_t i;
+    while ((i = next.fetch_add(1)) < order.size()) {
+      ThreadWalk* walk = &(*walks)[order[i]];
+      if (walk->duplicate_of >= 0)
+        continue;
+      WalkThreadStack(process_state, frame_symbolizer, budget, stats,
+                      validity_cache, defer_source_line_info, walk,
+                      &walk->modules_without_symbols,
+                      &walk->modules_with_corrupt_symbols);
+      if (after_walk)
+        after_walk(order[i]);
+      if (order[i] == first_walk && after_first_walk)
+        after_first_walk();
+    }
+  };
+
+  size_t thread_count =
+      std::min(static_cast<size_t>(worker_count), walks->size());
+  vector<std::thread> workers;
+  for (size_t i = 1; i < thread_count; ++i)
+    workers.emplace_back(worker);
+  worker();
+  for (std::thread& thread : workers)
+    thread.join();
+}
+
+// The number of stack words scanned for code addresses when ordering
+// modules for prefetching.
+const uint64_t kPrefetchStackScanWords = 8192;
+
+// Returns the modules in |modules| in the order their symbols should be
+// fetched: the module holding |context|'s instruction pointer, then the
+// modules that words just above its stack pointer in |stack| point into,
+// as the thread's frames most likely come from those, then, if
+// |include_others|, the rest.  |context| and |stack| may be NULL.
+vector<const CodeModule*> OrderModulesForPrefetch(const CodeModules* modules,
+                                                  const DumpContext* context,
+                                                  const MemoryRegion* stack,
+                                                  bool include_others) {
+  vector<const CodeModule*> ordered;
+  std::set<const CodeModule*> added;
+  auto add = [&](const CodeModule* module) {
+    if (module && added.insert(module).second)
+      ordered.push_back(module);
+  };
+
+  DumpContext::Registers registers;
+  if (context && context->GetRegisters(&registers))
+    add(modules->GetModuleForAddress(registers.instruction_pointer));
+
+  if (context && stack && registers.cpu) {
+    bool wide = registers.pointer_size == sizeof(uint64_t);
+    uint64_t word_size = registers.pointer_size;
+    uint64_t end = stack->GetBase() + stack->GetSize();
+    uint64_t address = std::max(registers.stack_pointer, stack->GetBase());
+    for (uint64_t i = 0;
+         i < kPrefetchStackScanWords && address + word_size <= end;
+         ++i, address += word_size) {
+      uint64_t word = 0;
+      if (wide) {
+        stack->GetMemoryAtAddress(address, &word);
+      } else {
+        uint32_t word32 = 0;
+        stack->GetMemoryAtAddress(address, &word32);
+        word = word32;
+      }
+      add(modules->GetModuleForAddress(word));
+    }
+  }
+
+  if (include_others) {
+    for (unsigned int i = 0; i < modules->module_count(); ++i)
+      add(modules->GetModuleAtIndex(i));
+  }
+  return ordered;
+}
+
+// Returns the region of |memory_list| holding |address|, or failing that,
+// the region of |memory64_list|, which full-memory minidumps have instead.
+// Either list may be NULL.
+MinidumpMemoryRegion* FindMemoryRegion(MinidumpMemoryList* memory_list,
+                                       MinidumpMemory64List* memory64_list,
+                                       uint64_t address) {
+  MinidumpMemoryRegion* region =
+      memory_list ? memory_list->GetMemoryRegionForAddress(address) : NULL;
+  if (!region && memory64_list)
+    region = memory64_list->GetMemoryRegionForAddress(address);
+  return region;
+}
+
+// What Process looks up about each of a minidump's threads, gathered once
+// so that the passes over the threads don't each repeat it.
+struct IndexedThread {
+  // NULL if the thread can't be read.
+  MinidumpThread* thread;
+  bool has_thread_id;
+  uint32_t thread_id;
+  // The thread's stack, from the thread itself or else from the memory
+  // lists.  NULL if neither has it.
+  MinidumpMemoryRegion* memory;
+};
+
+// Returns the threads of |threads| in order, with their stacks found in
+// |memory_list| or |memory64_list| when the thread itself doesn't have one.
+vector<IndexedThread> IndexThreads(MinidumpThreadList* threads,
+                                   MinidumpMemoryList* memory_list,
+                                   MinidumpMemory64List* memory64_list) {
+  const unsigned int thread_count = threads->thread_count();
+  vector<IndexedThread> indexed(thread_count);
+  for (unsigned int i = 0; i < thread_count; ++i) {
+    IndexedThread& entry = indexed[i];
+    entry.thread = threads->GetThreadAtIndex(i);
+    entry.has_thread_id =
+        entry.thread && entry.thread->GetThreadID(&entry.thread_id);
+    entry.memory = entry.thread ? entry.thread->GetMemory() : NULL;
+    if (entry.thread && !entry.memory) {
+      uint64_t start = entry.thread->GetStartOfStackMemoryRange();
+      if (start)
+        entry.memory = FindMemoryRegion(memory_list, memory64_list, start);
+    }
+  }
+  return indexed;
+}
+
+// Returns the position of each of |threads|, by index, in a ranking of how
+// worth walking their stacks are, using only their registers: the
+// requesting thread first, then the threads whose instruction pointer is
+// outside |idle_modules|, then the rest, each by the stack bytes in use
+// above the stack pointer, most first.  The thread that wrote the
+// minidump, and threads that cannot be read, come last.
+vector<unsigned int> RankThreads(const vector<IndexedThread>& threads,
+                                 const CodeModules* modules,
+                                 const std::set<string>& idle_modules,
+                                 bool has_dump_thread,
+                                 uint32_t dump_thread_id,
+                                 bool has_requesting_thread,
+                                 uint32_t requesting_thread_id) {
+  enum ThreadClass { REQUESTING, BUSY, IDLE, SKIPPED };
+  struct RankedThread {
+    ThreadClass thread_class;
+    uint64_t stack_used;
+    unsigned int index;
+  };
+
+  const unsigned int thread_count = threads.size();
+  vector<RankedThread> ranked;
+  ranked.reserve(thread_count);
+  for (unsigned int i = 0; i < thread_count; ++i) {
+    RankedThread entry = { SKIPPED, 0, i };
+    MinidumpThread* thread = threads[i].thread;
+    uint32_t thread_id = threads[i].thread_id;
+    MinidumpContext* context = thread ? thread->GetContext() : NULL;
+    if (!thread || !threads[i].has_thread_id ||
+        (has_dump_thread && thread_id == dump_thread_id)) {
+      ranked.push_back(entry);
+      continue;
+    }
+
+    entry.thread_class = BUSY;
+    DumpContext::Registers registers;
+    bool has_registers = context && context->GetRegisters(&registers);
+    if (has_requesting_thread && thread_id == requesting_thread_id) {
+      entry.thread_class = REQUESTING;
+    } else if (has_registers && modules) {
+      const CodeModule* module =
+          modules->GetModuleForAddress(registers.instruction_pointer);
+      if (module &&
+          idle_modules.count(PathnameStripper::File(module->code_file()))) {
+        entry.thread_class = IDLE;
+      }
+    }
+
+    MinidumpMemoryRegion* memory = threads[i].memory;
+    if (memory && has_registers) {
+      uint64_t stack_pointer = registers.stack_pointer;
+      uint64_t end = memory->GetBase() + memory->GetSize();
+      if (stack_pointer >= memory->GetBase() && stack_pointer < end)
+        entry.stack_used = end - stack_pointer;
+    }
+    ranked.push_back(entry);
+  }
+
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [](const RankedThread& a, const RankedThread& b) {
+                     if (a.thread_class != b.thread_class)
+                       return a.thread_class < b.thread_class;
+                     return a.stack_used > b.stack_used;
+                   });
+  vector<unsigned int> ranks(thread_count);
+  for (unsigned int i = 0; i < thread_count; ++i)
+    ranks[ranked[i].index] = i;
+  return ranks;
+}
+
+// The modules that wrap blocking system calls, which waiting threads sit
+// in.
+std::set<string> DefaultIdleModules() {
+  static const char* const kModules[] = {
+    "ntdll.dll", "kernelbase.dll", "win32u.dll", "libc.so", "libc.so.6",
+    "libpthread.so.0", "libsystem_kernel.dylib", "libsystem_pthread.dylib"
+  };
+  return std::set<string>(kModules, kModules + sizeof(kModules) /
+                                                   sizeof(kModules[0]));
+}
+
+// Rates how likely it is that the crash in |dump| is exploitable.  Only the
+// requesting thread's stack in |process_state| needs to have been walked.
+ExploitabilityRating RateExploitability(Minidump* dump,
+                                        ProcessState* process_state,
+                                        bool enable_objdump) {
+  scoped_ptr<Exploitability> exploitability(
+      Exploitability::ExploitabilityForPlatform(dump, process_state,
+                                                enable_objdump));
+  // The engine will be null if the platform is not supported
+  if (exploitability == NULL)
+    return EXPLOITABILITY_ERR_NOENGINE;
+  return exploitability->CheckExploitability();
+}
+
+}  // namespace
+
+ProcessingOptions::ProcessingOptions()
+    : enable_exploitability(false),
+      enable_objdump(false),
+      enable_objdump_for_exploitability(false),
+      max_thread_count(-1),
+      prioritize_threads(false),
+      idle_modules(DefaultIdleModules()),
+      stackwalk_worker_count(1),
+      deduplicate_stacks(false),
+      prefetch_symbols(false),
+      prefetch_requesting_thread_symbols(false),
+      defer_source_line_info(false),
+      collect_stats(false),
+      borrow_modules(false),
+      memory_limit(0) {
+}
+
+void ProcessingOptions::DisableAnalysis() {
+  enable_exploitability = false;
+  enable_objdump = false;
+  enable_objdump_for_exploitability = false;
+}
+
+void ProcessingOptions::EnableSignatureMode(int frame_count) {
+  DisableAnalysis();
+  // The requesting thread always ranks first.
+  max_thread_count = 1;
+  prioritize_threads = true;
+  stackwalk_worker_count = 1;
+  deduplicate_stacks = false;
+  prefetch_symbols = false;
+  prefetch_requesting_thread_symbols = false;
+  defer_source_line_info = false;
+  stackwalk_limits.max_frames_per_thread = frame_count;
+}
+
 MinidumpProcessor::MinidumpProcessor(SymbolSupplier* supplier,
                                      SourceLineResolverInterface* resolver)
     : frame_symbolizer_(new StackFrameSymbolizer(supplier, resolver)),
       own_frame_symbolizer_(true),
-      enable_exploitability_(false),
-      enable_objdump_(false),
-      enable_objdump_for_exploitability_(false),
-      max_thread_count_(-1) {
+      options_() {
 }
 
 MinidumpProcessor::MinidumpProcessor(SymbolSupplier* supplier,
@@ -75,20 +823,16 @@ MinidumpProcessor::MinidumpProcessor(SymbolSupplier* supplier,
                                      bool enable_exploitability)
     : frame_symbolizer_(new StackFrameSymbolizer(supplier, resolver)),
       own_frame_symbolizer_(true),
-      enable_exploitability_(enable_exploitability),
-      enable_objdump_(false),
-      enable_objdump_for_exploitability_(false),
-      max_thread_count_(-1) {
+      options_() {
+  options_.enable_exploitability = enable_exploitability;
 }
 
 MinidumpProcessor::MinidumpProcessor(StackFrameSymbolizer* frame_symbolizer,
                                      bool enable_exploitability)
     : frame_symbolizer_(frame_symbolizer),
       own_frame_symbolizer_(false),
-      enable_exploitability_(enable_exploitability),
-      enable_objdump_(false),
-      enable_objdump_for_exploitability_(false),
-      max_thread_count_(-1) {
+      options_() {
+  options_.enable_exploitability = enable_exploitability;
   assert(frame_symbolizer_);
 }
 
@@ -96,13 +840,72 @@ MinidumpProcessor::~MinidumpProcessor() {
   if (own_frame_symbolizer_) delete frame_symbolizer_;
 }
 
+void MinidumpProcessor::set_missing_symbols_cache(MissingSymbolsCache* cache) {
+  frame_symbolizer_->set_missing_symbols_cache(cache);
+}
+
+void MinidumpProcessor::set_frame_pointer_modules(
+    const std::set<string>& modules) {
+  frame_symbolizer_->set_frame_pointer_modules(modules);
+}
+
+void MinidumpProcessor::set_lazy_inline_frames(bool enabled) {
+  frame_symbolizer_->set_lazy_inline_frames(enabled);
+}
+
+void MinidumpProcessor::FillDeferredSourceLineInfo(
+    ProcessState* process_state) {
+  vector<StackFrame*> frames;
+  for (const CallStack* stack : process_state->threads_)
+    frames.insert(frames.end(), stack->frames_.begin(), stack->frames_.end());
+  vector<std::deque<std::unique_ptr<StackFrame>>> inlined_frames;
+  frame_symbolizer_->FillSourceLineInfoBatch(frames, &inlined_frames);
+
+  // Each frame's inlined frames go before it, innermost first, as the walk
+  // would have put them.
+  size_t frame_index = 0;
+  for (CallStack* stack : process_state->threads_) {
+    vector<StackFrame*> stack_frames;
+    stack_frames.reserve(stack->frames_.size());
+    for (StackFrame* frame : stack->frames_) {
+      for (std::unique_ptr<StackFrame>& inlined_frame :
+           inlined_frames[frame_index++]) {
+        stack_frames.push_back(inlined_frame.release());
+      }
+      stack_frames.push_back(frame);
+    }
+    stack->frames_.swap(stack_frames);
+  }
+}
+
 ProcessResult MinidumpProcessor::Process(
     Minidump* dump, ProcessState* process_state) {
+  return Process(dump, options_, process_state);
+}
+
+ProcessResult MinidumpProcessor::Process(
+    Minidump* dump, const ProcessingOptions& options,
+    ProcessState* process_state) {
+  return Process(dump, options, NULL, process_state);
+}
+
+ProcessResult MinidumpProcessor::Process(
+    Minidump* dump, const ProcessingOptions& options,
+    ProcessObserver* observer, ProcessState* process_state) {
   assert(dump);
   assert(process_state);
 
   process_state->Clear();
 
+  ProcessStats::Clock::time_point start = ProcessStats::Clock::now();
+  ProcessStats* stats = NULL;
+  if (options.collect_stats) {
+    stats = new ProcessStats();
+    process_state->stats_ = stats;
+  }
+  // The symbolizer records the symbols it fetches for this dump here.
+  ProcessStats::Scope stats_scope(stats);
+
   const MDRawHeader* header = dump->header();
   if (!header) {
     BPLOG(ERROR) << "Minidump " << dump->path() << " has no header";
@@ -134,7 +937,7 @@ ProcessResult MinidumpProcessor::Process(
     has_requesting_thread = exception->GetThreadID(&requesting_thread_id);
 
     process_state->crash_reason_ = GetCrashReason(
-        dump, &process_state->crash_address_, enable_objdump_);
+        dump, &process_state->crash_address_, options.enable_objdump);
 
     process_state->exception_record_.set_code(
         exception->exception()->exception_record.exception_code,
@@ -161,13 +964,27 @@ ProcessResult MinidumpProcessor::Process(
   // This will just return an empty string if it doesn't exist.
   process_state->assertion_ = GetAssertion(dump);
 
+  // Breadcrumbs are optional.
+  MinidumpBreadcrumbs* breadcrumbs = dump->GetBreadcrumbs();
+  if (breadcrumbs && breadcrumbs->threads())
+    process_state->breadcrumbs_ = *breadcrumbs->threads();
+
+  // Under a memory limit, the streams copied into |process_state| are
+  // released from |dump| as soon as they have been.
+  const bool release_streams = options.memory_limit != 0;
+  if (release_streams)
+    dump->ReleaseStream(MD_BREADCRUMB_STREAM);
+
   MinidumpModuleList* module_list = dump->GetModuleList();
 
   // Put a copy of the module list into ProcessState object.  This is not
   // necessarily a MinidumpModuleList, but it adheres to the CodeModules
-  // interface, which is all that ProcessState needs to expose.
+  // interface, which is all that ProcessState needs to expose.  A borrowed
+  // list is the MinidumpModuleList itself, which the dump owns.
+  process_state->modules_borrowed_ = options.borrow_modules;
   if (module_list) {
-    process_state->modules_ = module_list->Copy();
+    process_state->modules_ =
+        options.borrow_modules ? module_list : module_list->Copy();
     process_state->shrunk_range_modules_ =
         process_state->modules_->GetShrunkRangeModules();
     for (unsigned int i = 0;
@@ -184,7 +1001,9 @@ ProcessResult MinidumpProcessor::Process(
   MinidumpUnloadedModuleList* unloaded_module_list =
       dump->GetUnloadedModuleList();
   if (unloaded_module_list) {
-    process_state->unloaded_modules_ = unloaded_module_list->Copy();
+    process_state->unloaded_modules_ =
+        options.borrow_modules ? unloaded_module_list
+                               : unloaded_module_list->Copy();
   }
 
   MinidumpMemoryList* memory_list = dump->GetMemoryList();
@@ -192,6 +1011,11 @@ ProcessResult MinidumpProcessor::Process(
     BPLOG(INFO) << "Found " << memory_list->region_count()
                 << " memory regions.";
   }
+  MinidumpMemory64List* memory64_list = dump->GetMemory64List();
+  if (memory64_list) {
+    BPLOG(INFO) << "Found " << memory64_list->region_count()
+                << " full-memory regions.";
+  }
 
   MinidumpThreadList* threads = dump->GetThreadList();
   if (!threads) {
@@ -210,37 +1034,122 @@ ProcessResult MinidumpProcessor::Process(
       (has_requesting_thread   ? "" : "no ") << "requesting thread, and " <<
       (has_process_create_time ? "" : "no ") << "process create time";
 
+  if (release_streams && !options.borrow_modules) {
+    dump->ReleaseStream(MD_MODULE_LIST_STREAM);
+    dump->ReleaseStream(MD_UNLOADED_MODULE_LIST_STREAM);
+  }
+
   bool interrupted = false;
   bool found_requesting_thread = false;
   unsigned int thread_count = threads->thread_count();
   process_state->original_thread_count_ = thread_count;
+  const vector<IndexedThread> indexed_threads =
+      IndexThreads(threads, memory_list, memory64_list);
 
   // Reset frame_symbolizer_ at the beginning of stackwalk for each minidump.
   frame_symbolizer_->Reset();
 
-  MinidumpThreadNameList* thread_names = dump->GetThreadNameList();
-  std::map<uint32_t, string> thread_id_to_name;
-  if (thread_names) {
-    const unsigned int thread_name_count = thread_names->thread_name_count();
-    for (unsigned int thread_name_index = 0;
-         thread_name_index < thread_name_count; ++thread_name_index) {
-      MinidumpThreadName* thread_name =
-          thread_names->GetThreadNameAtIndex(thread_name_index);
-      if (!thread_name) {
-        BPLOG(ERROR) << "Could not get thread name for thread at index "
-                     << thread_name_index;
-        return PROCESS_ERROR_GETTING_THREAD_NAME;
-      }
-      uint32_t thread_id;
-      if (!thread_name->GetThreadID(&thread_id)) {
-        BPLOG(ERROR) << "Could not get thread ID for thread at index "
-                     << thread_name_index;
-        return PROCESS_ERROR_GETTING_THREAD_NAME;
+  if ((options.prefetch_symbols ||
+       options.prefetch_requesting_thread_symbols) &&
+      process_state->modules_) {
+    // Find the requesting thread's registers and stack, so its modules can
+    // be fetched first.
+    const DumpContext* requesting_context = NULL;
+    const MemoryRegion* requesting_memory = NULL;
+    if (has_requesting_thread) {
+      for (const IndexedThread& entry : indexed_threads) {
+        MinidumpThread* thread = entry.thread;
+        if (!thread || !entry.has_thread_id ||
+            entry.thread_id != requesting_thread_id) {
+          continue;
+        }
+        // As below, a crashed thread is walked from the exception context.
+        requesting_context = process_state->crashed_ ?
+            exception->GetContext() : NULL;
+        if (!requesting_context)
+          requesting_context = thread->GetContext();
+        requesting_memory = entry.memory;
+        break;
       }
-      thread_id_to_name.insert(
-          std::make_pair(thread_id, thread_name->GetThreadName()));
+    }
+    // The requesting thread's modules are fetched on their own first, so
+    // that none of them waits for a module only other threads need.
+    if (options.prefetch_requesting_thread_symbols) {
+      frame_symbolizer_->PrefetchSymbols(
+          OrderModulesForPrefetch(process_state->modules_, requesting_context,
+                                  requesting_memory, false),
+          &process_state->system_info_);
+    }
+    if (options.prefetch_symbols) {
+      frame_symbolizer_->PrefetchSymbols(
+          OrderModulesForPrefetch(process_state->modules_, requesting_context,
+                                  requesting_memory, true),
+          &process_state->system_info_);
+    }
+  }
+
+  // Looked up by thread ID as the threads are visited, and released once
+  // they all have been.
+  MinidumpThreadNameList* thread_names = dump->GetThreadNameList();
+
+  // When walking in parallel, the stacks are collected here and walked once
+  // every thread has been read from the minidump.  When deduplicating, the
+  // walks are kept so that later threads can be matched against them.
+  bool parallel = options.stackwalk_worker_count > 1;
+  if (parallel && options.memory_limit && !dump->IsInMemory()) {
+    // Walking in parallel reads every stack whole first, which must fit
+    // in the limit.
+    uint64_t held_bytes = Minidump::page_cache_bytes();
+    for (const IndexedThread& entry : indexed_threads) {
+      if (entry.memory)
+        held_bytes += entry.memory->GetSize();
+    }
+    if (held_bytes > options.memory_limit) {
+      BPLOG(INFO) << "Walking the stacks of " << dump->path()
+                  << " one at a time to stay within the memory limit";
+      parallel = false;
     }
   }
+  vector<ThreadWalk> walks;
+  size_t first_walk = 0;
+  // Maps HashStackImage values to the walks that are actually performed.
+  std::multimap<uint64_t, size_t> walks_by_hash;
+
+  // Shared by every thread's walk, so that the limits for the whole
+  // minidump apply across them.
+  scoped_ptr<StackwalkBudget> budget;
+  if (options.stackwalk_limits.IsLimited() || options.memory_limit)
+    budget.reset(new StackwalkBudget(options.stackwalk_limits));
+  bool scanning_stopped = false;
+  // Also shared by every thread's walk, since their stacks hold many of
+  // the same code addresses.
+  scoped_ptr<AddressValidityCache> validity_cache(new AddressValidityCache);
+
+  // An observer is handed each thread as it is walked, so its source line
+  // info can't wait for the rest.
+  bool defer_source_line_info = options.defer_source_line_info && !observer;
+
+  ProcessStats::Clock::time_point stackwalk_start = ProcessStats::Clock::now();
+
+  // Hands |observer| the threads as they are walked.  A minidump that names
+  // no requesting thread has its threads handed over in order from the
+  // start; otherwise the walks that come before the requesting thread's are
+  // held back until it is found.
+  ThreadDelivery delivery(observer, process_state);
+  if (!has_requesting_thread)
+    delivery.SetRequestingThread(-1);
+
+  // When prioritizing, only the highest-ranked threads are processed, rather
+  // than the first ones.
+  const bool prioritize =
+      options.max_thread_count >= 0 && options.prioritize_threads;
+  vector<unsigned int> thread_ranks;
+  if (prioritize) {
+    thread_ranks = RankThreads(indexed_threads, process_state->modules_,
+                               options.idle_modules, has_dump_thread,
+                               dump_thread_id, has_requesting_thread,
+                               requesting_thread_id);
+  }
 
   for (unsigned int thread_index = 0;
        thread_index < thread_count;
@@ -250,23 +1159,25 @@ ProcessResult MinidumpProcessor::Process(
              thread_index, thread_count);
     string thread_string = dump->path() + ":" + thread_string_buffer;
 
-    MinidumpThread* thread = threads->GetThreadAtIndex(thread_index);
+    const IndexedThread& indexed_thread = indexed_threads[thread_index];
+    MinidumpThread* thread = indexed_thread.thread;
     if (!thread) {
       BPLOG(ERROR) << "Could not get thread for " << thread_string;
       return PROCESS_ERROR_GETTING_THREAD;
     }
 
-    uint32_t thread_id;
-    if (!thread->GetThreadID(&thread_id)) {
+    if (!indexed_thread.has_thread_id) {
       BPLOG(ERROR) << "Could not get thread ID for " << thread_string;
       return PROCESS_ERROR_GETTING_THREAD_ID;
     }
+    uint32_t thread_id = indexed_thread.thread_id;
 
     thread_string += " id " + HexString(thread_id);
-    auto thread_name_iter = thread_id_to_name.find(thread_id);
+    MinidumpThreadName* thread_name_entry =
+        thread_names ? thread_names->GetThreadNameByID(thread_id) : NULL;
     string thread_name;
-    if (thread_name_iter != thread_id_to_name.end()) {
-      thread_name = thread_name_iter->second;
+    if (thread_name_entry) {
+      thread_name = thread_name_entry->GetThreadName();
     }
     if (!thread_name.empty()) {
       thread_string += " name [" + thread_name + "]";
@@ -284,7 +1195,14 @@ ProcessResult MinidumpProcessor::Process(
 
     MinidumpContext* context = thread->GetContext();
 
-    if (has_requesting_thread && thread_id == requesting_thread_id) {
+    bool is_requesting_thread =
+        has_requesting_thread && thread_id == requesting_thread_id;
+    if (prioritize && !is_requesting_thread &&
+        thread_ranks[thread_index] >=
+            static_cast<unsigned int>(options.max_thread_count)) {
+      continue;
+    }
+    if (is_requesting_thread) {
       if (found_requesting_thread) {
         // There can't be more than one requesting thread.
         BPLOG(ERROR) << "Duplicate requesting thread: " << thread_string;
@@ -299,15 +1217,18 @@ ProcessResult MinidumpProcessor::Process(
       // be the index of the current thread when it's pushed into the
       // vector.
       process_state->requesting_thread_ = process_state->threads_.size();
-      if (max_thread_count_ >= 0) {
+      if (options.max_thread_count >= 0 && !prioritize) {
         thread_count =
             std::min(thread_count,
                      std::max(static_cast<unsigned int>(
                                   process_state->requesting_thread_ + 1),
-                              static_cast<unsigned int>(max_thread_count_)));
+                              static_cast<unsigned int>(
+                                  options.max_thread_count)));
       }
 
       found_requesting_thread = true;
+      if (!parallel)
+        delivery.SetRequestingThread(process_state->requesting_thread_);
 
       if (process_state->crashed_) {
         // Use the exception record's context for the crashed thread, instead
@@ -322,55 +1243,153 @@ ProcessResult MinidumpProcessor::Process(
     }
 
     // If the memory region for the stack cannot be read using the RVA stored
-    // in the memory descriptor inside MINIDUMP_THREAD, try to locate and use
-    // a memory region (containing the stack) from the minidump memory list.
-    MinidumpMemoryRegion* thread_memory = thread->GetMemory();
-    if (!thread_memory && memory_list) {
-      uint64_t start_stack_memory_range = thread->GetStartOfStackMemoryRange();
-      if (start_stack_memory_range) {
-        thread_memory = memory_list->GetMemoryRegionForAddress(
-           start_stack_memory_range);
-      }
-    }
+    // in the memory descriptor inside MINIDUMP_THREAD, IndexThreads located
+    // a memory region (containing the stack) from the minidump memory list,
+    // or the full-memory list.
+    MinidumpMemoryRegion* thread_memory = indexed_thread.memory;
     if (!thread_memory) {
       BPLOG(ERROR) << "No memory region for " << thread_string;
     }
 
-    // Use process_state->modules_ instead of module_list, because the
-    // |modules| argument will be used to populate the |module| fields in
-    // the returned StackFrame objects, which will be placed into the
-    // returned ProcessState object.  module_list's lifetime is only as
-    // long as the Minidump object: it will be deleted when this function
-    // returns.  process_state->modules_ is owned by the ProcessState object
-    // (just like the StackFrame objects), and is much more suitable for this
-    // task.
-    scoped_ptr<Stackwalker> stackwalker(
-        Stackwalker::StackwalkerForCPU(process_state->system_info(),
-                                       context,
-                                       thread_memory,
-                                       process_state->modules_,
-                                       process_state->unloaded_modules_,
-                                       frame_symbolizer_));
-
     scoped_ptr<CallStack> stack(new CallStack());
-    if (stackwalker.get()) {
-      if (!stackwalker->Walk(stack.get(),
-                             &process_state->modules_without_symbols_,
-                             &process_state->modules_with_corrupt_symbols_)) {
-        BPLOG(INFO) << "Stackwalker interrupt (missing symbols?) at "
-                    << thread_string;
-        interrupted = true;
+    ThreadWalk walk;
+    walk.thread_id = thread_id;
+    walk.context = context;
+    walk.thread_memory = thread_memory;
+    walk.thread_string = thread_string;
+    walk.stack = stack.get();
+    walk.thread_index = process_state->threads_.size();
+    walk.interrupted = false;
+    walk.has_image = false;
+    walk.duplicate_of = -1;
+    walk.rank = prioritize ? thread_ranks[thread_index] : thread_index;
+    if (options.deduplicate_stacks &&
+        GetStackImage(context, thread_memory, &walk.image)) {
+      walk.has_image = true;
+      uint64_t hash = HashStackImage(walk.image);
+      auto candidates = walks_by_hash.equal_range(hash);
+      for (auto it = candidates.first; it != candidates.second; ++it) {
+        if (StackImagesMatch(walks[it->second].image, walk.image)) {
+          walk.duplicate_of = it->second;
+          break;
+        }
       }
+      if (walk.duplicate_of < 0)
+        walks_by_hash.insert(std::make_pair(hash, walks.size()));
+    }
+
+    if (parallel) {
+      // The walk will happen off this thread, so read the stack now while
+      // the minidump is still being accessed serially.
+      if (thread_memory)
+        thread_memory->GetMemory();
+      if (is_requesting_thread)
+        first_walk = walks.size();
+      walks.push_back(walk);
     } else {
-      // Threads with missing CPU contexts will hit this, but
-      // don't abort processing the rest of the dump just for
-      // one bad thread.
-      BPLOG(ERROR) << "No stackwalker for " << thread_string;
+      if (walk.duplicate_of >= 0) {
+        CopyDuplicateWalk(walks[walk.duplicate_of], &walk,
+                          &walk.stack->frames_);
+      } else {
+        // Scanning reads the most stack pages, so it is what is given up
+        // once the page caches hold more than the limit.
+        if (options.memory_limit && !scanning_stopped &&
+            Minidump::page_cache_bytes() > options.memory_limit) {
+          BPLOG(INFO) << "Not scanning the remaining stacks of "
+                      << dump->path() << " to stay within the memory limit";
+          budget->StopScanning();
+          scanning_stopped = true;
+        }
+        WalkThreadStack(process_state, frame_symbolizer_, budget.get(), stats,
+                        validity_cache.get(), defer_source_line_info, &walk,
+                        &process_state->modules_without_symbols_,
+                        &process_state->modules_with_corrupt_symbols_);
+        if (options.memory_limit && thread_memory)
+          thread_memory->FreeMemory();
+      }
+      interrupted |= walk.interrupted;
+      if (options.deduplicate_stacks)
+        walks.push_back(walk);
     }
-    stack->set_tid(thread_id);
+
     process_state->threads_.push_back(stack.release());
     process_state->thread_memory_regions_.push_back(thread_memory);
     process_state->thread_names_.push_back(thread_name);
+    if (!parallel)
+      delivery.SetWalked(walk.thread_index);
+  }
+
+  if (thread_names && release_streams)
+    dump->ReleaseStream(MD_THREAD_NAME_LIST_STREAM);
+
+  // The exploitability rating reads only the requesting thread's stack,
+  // and the parallel walks no longer read the minidump, so the rating can
+  // run while the other stacks are still being walked.
+  ExploitabilityRating exploitability = EXPLOITABILITY_NOT_ANALYZED;
+  bool exploitability_rated = false;
+  if (parallel) {
+    std::function<void()> after_first_walk;
+    // The rating reads function names, which deferred source line info
+    // only has once every stack is walked.
+    if (options.enable_exploitability && found_requesting_thread &&
+        walks[first_walk].duplicate_of < 0 && !defer_source_line_info) {
+      after_first_walk = [&]() {
+        ProcessStats::Clock::time_point exploitability_start =
+            ProcessStats::Clock::now();
+        exploitability = RateExploitability(
+            dump, process_state, options.enable_objdump_for_exploitability);
+        exploitability_rated = true;
+        if (stats) {
+          stats->set_exploitability_nanoseconds(
+              ProcessStats::NanosecondsSince(exploitability_start));
+        }
+      };
+    }
+    // With an observer, the walks that reuse a walk are completed as soon
+    // as it is, so that they are not held back until every walk is done.
+    std::function<void(size_t)> after_walk;
+    std::mutex delivery_mutex;
+    if (observer) {
+      delivery.SetRequestingThread(found_requesting_thread ?
+                                   process_state->requesting_thread_ : -1);
+      after_walk = [&](size_t walk_index) {
+        std::lock_guard<std::mutex> lock(delivery_mutex);
+        delivery.SetWalked(walk_index);
+        for (size_t i = 0; i < walks.size(); ++i) {
+          if (walks[i].duplicate_of == static_cast<int>(walk_index)) {
+            CopyDuplicateWalk(walks[walk_index], &walks[i],
+                              &walks[i].stack->frames_);
+            delivery.SetWalked(i);
+          }
+        }
+      };
+    }
+    WalkThreadStacksInParallel(process_state, frame_symbolizer_, budget.get(),
+                               stats, validity_cache.get(),
+                               defer_source_line_info, &walks, first_walk,
+                               options.stackwalk_worker_count, after_walk,
+                               after_first_walk);
+    for (ThreadWalk& walk : walks) {
+      if (walk.duplicate_of >= 0 && !observer) {
+        CopyDuplicateWalk(walks[walk.duplicate_of], &walk,
+                          &walk.stack->frames_);
+      }
+    }
+    for (const ThreadWalk& walk : walks) {
+      interrupted |= walk.interrupted;
+      MergeModules(walk.modules_without_symbols,
+                   &process_state->modules_without_symbols_);
+      MergeModules(walk.modules_with_corrupt_symbols,
+                   &process_state->modules_with_corrupt_symbols_);
+      if (options.memory_limit && walk.thread_memory)
+        walk.thread_memory->FreeMemory();
+    }
+  }
+  if (defer_source_line_info && !interrupted)
+    FillDeferredSourceLineInfo(process_state);
+  if (stats) {
+    stats->set_stackwalk_nanoseconds(
+        ProcessStats::NanosecondsSince(stackwalk_start));
   }
 
   if (interrupted) {
@@ -385,24 +1404,31 @@ ProcessResult MinidumpProcessor::Process(
         HexString(requesting_thread_id) << ", not found in " <<
         dump->path();
     process_state->requesting_thread_ = -1;
+    if (!parallel)
+      delivery.SetRequestingThread(-1);
   }
 
-  // Exploitability defaults to EXPLOITABILITY_NOT_ANALYZED
-  process_state->exploitability_ = EXPLOITABILITY_NOT_ANALYZED;
-
   // If an exploitability run was requested we perform the platform specific
-  // rating.
-  if (enable_exploitability_) {
-    scoped_ptr<Exploitability> exploitability(
-        Exploitability::ExploitabilityForPlatform(
-          dump, process_state, enable_objdump_for_exploitability_));
-    // The engine will be null if the platform is not supported
-    if (exploitability != NULL) {
-      process_state->exploitability_ = exploitability->CheckExploitability();
-    } else {
-      process_state->exploitability_ = EXPLOITABILITY_ERR_NOENGINE;
+  // rating.  Otherwise exploitability stays EXPLOITABILITY_NOT_ANALYZED.
+  if (options.enable_exploitability && !exploitability_rated) {
+    ProcessStats::Clock::time_point exploitability_start =
+        ProcessStats::Clock::now();
+    exploitability = RateExploitability(
+        dump, process_state, options.enable_objdump_for_exploitability);
+    if (stats) {
+      stats->set_exploitability_nanoseconds(
+          ProcessStats::NanosecondsSince(exploitability_start));
     }
   }
+  process_state->exploitability_ = exploitability;
+
+  if (stats) {
+    for (const CallStack* stack : process_state->threads_) {
+      for (const StackFrame* frame : *stack->frames())
+        stats->AddFrame(frame->trust);
+    }
+    stats->set_total_nanoseconds(ProcessStats::NanosecondsSince(start));
+  }
 
   BPLOG(INFO) << "Processed " << dump->path();
   return PROCESS_OK;
@@ -418,7 +1444,10 @@ ProcessResult MinidumpProcessor::Process(
      return PROCESS_ERROR_MINIDUMP_NOT_FOUND;
   }
 
-  return Process(&dump, process_state);
+  // |dump| is gone once this returns, so the modules can't stay borrowed.
+  ProcessResult result = Process(&dump, process_state);
+  process_state->CopyModules();
+  return result;
 }
 
 // Returns the MDRawSystemInfo from a minidump, or NULL if system info is
@@ -828,10 +1857,8 @@ static void CalculateFaultAddressFromInstruction(Minidump* dump,
   }
 
   // Get memory region containing instruction pointer.
-  MinidumpMemoryList* memory_list = dump->GetMemoryList();
   MinidumpMemoryRegion* memory_region =
-    memory_list ?
-    memory_list->GetMemoryRegionForAddress(instruction_ptr) : NULL;
+    dump->GetMemoryRegionForAddress(instruction_ptr);
   if (!memory_region) {
     BPLOG(INFO) << "No memory region around instruction pointer.";
     return;
@@ -35,11 +35,15 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "breakpad_googletest_includes.h"
 #include "common/scoped_ptr.h"
@@ -50,13 +54,18 @@
 #include "google_breakpad/processor/code_modules.h"
 #include "google_breakpad/processor/minidump.h"
 #include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/missing_symbols_cache.h"
+#include "google_breakpad/processor/process_observer.h"
 #include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/process_stats.h"
 #include "google_breakpad/processor/stack_frame.h"
+#include "google_breakpad/processor/stack_frame_cpu.h"
 #include "google_breakpad/processor/symbol_supplier.h"
 #include "processor/logging.h"
 #include "processor/stackwalker_unittest_utils.h"
 
 using std::map;
+using std::vector;
 
 namespace google_breakpad {
 class MockMinidump : public Minidump {
@@ -76,6 +85,7 @@ class MockMinidump : public Minidump {
   MOCK_METHOD0(GetModuleList, MinidumpModuleList*());
   MOCK_METHOD0(GetUnloadedModuleList, MinidumpUnloadedModuleList*());
   MOCK_METHOD0(GetMemoryList, MinidumpMemoryList*());
+  MOCK_METHOD0(GetMemory64List, MinidumpMemory64List*());
 };
 
 class MockMinidumpUnloadedModule : public MinidumpUnloadedModule {
@@ -93,6 +103,15 @@ class MockMinidumpUnloadedModuleList : public MinidumpUnloadedModuleList {
                      const MinidumpUnloadedModule*(uint64_t));
 };
 
+class MockMinidumpModuleList : public MinidumpModuleList {
+ public:
+  // MinidumpModuleList reads |minidump|'s platform.
+  explicit MockMinidumpModuleList(Minidump* minidump)
+      : MinidumpModuleList(minidump) {}
+
+  MOCK_CONST_METHOD0(Copy, const CodeModules*());
+};
+
 class MockMinidumpThreadList : public MinidumpThreadList {
  public:
   MockMinidumpThreadList() : MinidumpThreadList(NULL) {}
@@ -164,21 +183,29 @@ namespace {
 using google_breakpad::BasicSourceLineResolver;
 using google_breakpad::CallStack;
 using google_breakpad::CodeModule;
+using google_breakpad::Minidump;
 using google_breakpad::MinidumpContext;
 using google_breakpad::MinidumpMemoryRegion;
 using google_breakpad::MinidumpMiscInfo;
 using google_breakpad::MinidumpProcessor;
 using google_breakpad::MinidumpSystemInfo;
+using google_breakpad::MinidumpThreadName;
+using google_breakpad::MinidumpThreadNameList;
 using google_breakpad::MinidumpThreadList;
 using google_breakpad::MinidumpThread;
+using google_breakpad::MissingSymbolsCache;
 using google_breakpad::MockMinidump;
 using google_breakpad::MockMinidumpMemoryList;
 using google_breakpad::MockMinidumpMemoryRegion;
+using google_breakpad::MockMinidumpModuleList;
 using google_breakpad::MockMinidumpThread;
 using google_breakpad::MockMinidumpThreadList;
 using google_breakpad::MockMinidumpUnloadedModule;
 using google_breakpad::MockMinidumpUnloadedModuleList;
 using google_breakpad::ProcessState;
+using google_breakpad::ProcessStats;
+using google_breakpad::StackFrame;
+using google_breakpad::StackFrameX86;
 using google_breakpad::scoped_ptr;
 using google_breakpad::SymbolSupplier;
 using google_breakpad::SystemInfo;
@@ -502,6 +529,44 @@ TEST_F(MinidumpProcessorTest, TestSymbolSupplierLookupCounts) {
             google_breakpad::PROCESS_OK);
 }
 
+TEST_F(MinidumpProcessorTest, TestMissingSymbolsCache) {
+  MockSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MissingSymbolsCache cache;
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+
+  {
+    MinidumpProcessor processor(&supplier, &resolver);
+    processor.set_missing_symbols_cache(&cache);
+    ProcessState state;
+    EXPECT_CALL(supplier, GetCStringSymbolData(
+        Property(&google_breakpad::CodeModule::code_file,
+                 "c:\\test_app.exe"),
+        _, _, _, _)).WillOnce(Return(SymbolSupplier::NOT_FOUND));
+    EXPECT_CALL(supplier, GetCStringSymbolData(
+        Property(&google_breakpad::CodeModule::code_file,
+                 Ne("c:\\test_app.exe")),
+        _, _, _, _)).WillRepeatedly(Return(SymbolSupplier::NOT_FOUND));
+    EXPECT_CALL(supplier, FreeSymbolData(_)).Times(AnyNumber());
+    ASSERT_EQ(processor.Process(minidump_file, &state),
+              google_breakpad::PROCESS_OK);
+    ASSERT_TRUE(Mock::VerifyAndClearExpectations(&supplier));
+  }
+  EXPECT_LT(0U, cache.size());
+
+  // Another processor sharing the cache does not ask again.
+  MinidumpProcessor processor(&supplier, &resolver);
+  processor.set_missing_symbols_cache(&cache);
+  ProcessState state;
+  EXPECT_CALL(supplier, GetCStringSymbolData(_, _, _, _, _)).Times(0);
+  EXPECT_CALL(supplier, FreeSymbolData(_)).Times(AnyNumber());
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_EQ(1U, state.threads()->size());
+  EXPECT_EQ("c:\\test_app.exe",
+            state.threads()->at(0)->frames()->at(0)->module->code_file());
+}
+
 TEST_F(MinidumpProcessorTest, TestBasicProcessing) {
   TestSymbolSupplier supplier;
   BasicSourceLineResolver resolver;
@@ -586,6 +651,428 @@ TEST_F(MinidumpProcessorTest, TestBasicProcessing) {
             google_breakpad::PROCESS_SYMBOL_SUPPLIER_INTERRUPTED);
 }
 
+// Walking the threads in parallel must produce the same stacks, in the same
+// order, as walking them one after another.
+static void ExpectSameThreads(const ProcessState& serial_state,
+                              const ProcessState& parallel_state) {
+  EXPECT_EQ(serial_state.requesting_thread(),
+            parallel_state.requesting_thread());
+  EXPECT_EQ(*serial_state.thread_names(), *parallel_state.thread_names());
+  ASSERT_EQ(serial_state.modules_without_symbols()->size(),
+            parallel_state.modules_without_symbols()->size());
+  for (size_t i = 0; i < serial_state.modules_without_symbols()->size(); ++i) {
+    EXPECT_EQ(serial_state.modules_without_symbols()->at(i)->code_file(),
+              parallel_state.modules_without_symbols()->at(i)->code_file());
+  }
+  ASSERT_EQ(serial_state.threads()->size(), parallel_state.threads()->size());
+  for (size_t i = 0; i < serial_state.threads()->size(); ++i) {
+    const CallStack* serial_stack = serial_state.threads()->at(i);
+    const CallStack* parallel_stack = parallel_state.threads()->at(i);
+    EXPECT_EQ(serial_stack->tid(), parallel_stack->tid());
+    ASSERT_EQ(serial_stack->frames()->size(),
+              parallel_stack->frames()->size());
+    for (size_t j = 0; j < serial_stack->frames()->size(); ++j) {
+      const StackFrame* serial_frame = serial_stack->frames()->at(j);
+      const StackFrame* parallel_frame = parallel_stack->frames()->at(j);
+      EXPECT_EQ(serial_frame->instruction, parallel_frame->instruction);
+      EXPECT_EQ(serial_frame->trust, parallel_frame->trust);
+      EXPECT_EQ(serial_frame->function_name, parallel_frame->function_name);
+      EXPECT_EQ(serial_frame->source_line, parallel_frame->source_line);
+    }
+  }
+}
+
+TEST_F(MinidumpProcessorTest, TestParallelStackwalk) {
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+
+  TestSymbolSupplier serial_supplier;
+  BasicSourceLineResolver serial_resolver;
+  MinidumpProcessor serial_processor(&serial_supplier, &serial_resolver);
+  ProcessState serial_state;
+  ASSERT_EQ(serial_processor.Process(minidump_file, &serial_state),
+            google_breakpad::PROCESS_OK);
+
+  TestSymbolSupplier parallel_supplier;
+  BasicSourceLineResolver parallel_resolver;
+  MinidumpProcessor parallel_processor(&parallel_supplier, &parallel_resolver);
+  parallel_processor.set_stackwalk_worker_count(4);
+  ProcessState parallel_state;
+  ASSERT_EQ(parallel_processor.Process(minidump_file, &parallel_state),
+            google_breakpad::PROCESS_OK);
+  ExpectSameThreads(serial_state, parallel_state);
+  ASSERT_EQ(parallel_state.threads()->at(0)->frames()->at(0)->function_name,
+            "`anonymous namespace'::CrashFunction");
+
+  // A dump with several threads, walked without symbols.
+  minidump_file = GetTestDataPath() + "thread_name_list.dmp";
+  MinidumpProcessor serial_unsymbolized(NULL, &serial_resolver);
+  ASSERT_EQ(serial_unsymbolized.Process(minidump_file, &serial_state),
+            google_breakpad::PROCESS_OK);
+  MinidumpProcessor parallel_unsymbolized(NULL, &parallel_resolver);
+  parallel_unsymbolized.set_stackwalk_worker_count(4);
+  ASSERT_EQ(parallel_unsymbolized.Process(minidump_file, &parallel_state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_GT(parallel_state.threads()->size(), 1U);
+  ExpectSameThreads(serial_state, parallel_state);
+}
+
+TEST_F(MinidumpProcessorTest, TestDeferSourceLineInfo) {
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+
+  TestSymbolSupplier serial_supplier;
+  BasicSourceLineResolver serial_resolver;
+  MinidumpProcessor serial_processor(&serial_supplier, &serial_resolver);
+  ProcessState serial_state;
+  ASSERT_EQ(serial_processor.Process(minidump_file, &serial_state),
+            google_breakpad::PROCESS_OK);
+
+  for (int worker_count : {1, 4}) {
+    SCOPED_TRACE(worker_count);
+    TestSymbolSupplier deferred_supplier;
+    BasicSourceLineResolver deferred_resolver;
+    MinidumpProcessor deferred_processor(&deferred_supplier,
+                                         &deferred_resolver);
+    deferred_processor.set_defer_source_line_info(true);
+    deferred_processor.set_stackwalk_worker_count(worker_count);
+    ProcessState deferred_state;
+    ASSERT_EQ(deferred_processor.Process(minidump_file, &deferred_state),
+              google_breakpad::PROCESS_OK);
+    ExpectSameThreads(serial_state, deferred_state);
+    ASSERT_EQ(deferred_state.threads()->at(0)->frames()->at(0)->function_name,
+              "`anonymous namespace'::CrashFunction");
+  }
+}
+
+// A TestSymbolSupplier that answers asynchronous requests on their own
+// threads, and records the order they were made in.
+class AsyncTestSymbolSupplier : public TestSymbolSupplier {
+ public:
+  ~AsyncTestSymbolSupplier() {
+    for (std::thread& thread : threads_)
+      thread.join();
+  }
+
+  virtual SymbolResult GetCStringSymbolData(const CodeModule* module,
+                                            const SystemInfo* system_info,
+                                            string* symbol_file,
+                                            char** symbol_data,
+                                            size_t* symbol_data_size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lazy_requests_.push_back(module->code_file());
+    return TestSymbolSupplier::GetCStringSymbolData(
+        module, system_info, symbol_file, symbol_data, symbol_data_size);
+  }
+
+  virtual void FreeSymbolData(const CodeModule* module) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TestSymbolSupplier::FreeSymbolData(module);
+  }
+
+  virtual void GetCStringSymbolDataAsync(const CodeModule* module,
+                                         const SystemInfo* system_info,
+                                         SymbolDataCallback callback) {
+    requests_.push_back(module->code_file());
+    threads_.emplace_back([this, module, system_info, callback]() {
+      string symbol_file;
+      char* symbol_data = NULL;
+      size_t symbol_data_size = 0;
+      SymbolResult result;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result = TestSymbolSupplier::GetCStringSymbolData(
+            module, system_info, &symbol_file, &symbol_data,
+            &symbol_data_size);
+      }
+      callback(result, symbol_file, symbol_data, symbol_data_size);
+    });
+  }
+
+  // The modules requested through GetCStringSymbolDataAsync and through
+  // GetCStringSymbolData, in order.
+  vector<string> requests_;
+  vector<string> lazy_requests_;
+
+ private:
+  std::mutex mutex_;
+  vector<std::thread> threads_;
+};
+
+TEST_F(MinidumpProcessorTest, TestPrefetchSymbols) {
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+
+  TestSymbolSupplier lazy_supplier;
+  BasicSourceLineResolver lazy_resolver;
+  MinidumpProcessor lazy_processor(&lazy_supplier, &lazy_resolver);
+  ProcessState lazy_state;
+  ASSERT_EQ(lazy_processor.Process(minidump_file, &lazy_state),
+            google_breakpad::PROCESS_OK);
+
+  AsyncTestSymbolSupplier prefetch_supplier;
+  BasicSourceLineResolver prefetch_resolver;
+  MinidumpProcessor prefetch_processor(&prefetch_supplier,
+                                       &prefetch_resolver);
+  prefetch_processor.set_prefetch_symbols(true);
+  ProcessState prefetch_state;
+  ASSERT_EQ(prefetch_processor.Process(minidump_file, &prefetch_state),
+            google_breakpad::PROCESS_OK);
+  ExpectSameThreads(lazy_state, prefetch_state);
+  ASSERT_EQ(prefetch_state.threads()->at(0)->frames()->at(0)->function_name,
+            "`anonymous namespace'::CrashFunction");
+
+  // Every module was requested once, starting with the one the crash is
+  // in, and the walk needed nothing more.
+  ASSERT_EQ(prefetch_state.modules()->module_count(),
+            prefetch_supplier.requests_.size());
+  EXPECT_EQ("c:\\test_app.exe", prefetch_supplier.requests_[0]);
+  EXPECT_TRUE(prefetch_supplier.lazy_requests_.empty());
+}
+
+TEST_F(MinidumpProcessorTest, TestPrefetchRequestingThreadSymbols) {
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+
+  TestSymbolSupplier lazy_supplier;
+  BasicSourceLineResolver lazy_resolver;
+  MinidumpProcessor lazy_processor(&lazy_supplier, &lazy_resolver);
+  ProcessState lazy_state;
+  ASSERT_EQ(lazy_processor.Process(minidump_file, &lazy_state),
+            google_breakpad::PROCESS_OK);
+
+  // Only the modules the requesting thread points into are fetched up
+  // front, starting with the one the crash is in; the rest are fetched as
+  // the walk reaches them.
+  AsyncTestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver);
+  processor.set_prefetch_requesting_thread_symbols(true);
+  ProcessState state;
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ExpectSameThreads(lazy_state, state);
+  ASSERT_FALSE(supplier.requests_.empty());
+  EXPECT_EQ("c:\\test_app.exe", supplier.requests_[0]);
+  EXPECT_LT(supplier.requests_.size(), state.modules()->module_count());
+  for (const string& request : supplier.lazy_requests_) {
+    EXPECT_EQ(supplier.requests_.end(),
+              std::find(supplier.requests_.begin(), supplier.requests_.end(),
+                        request));
+  }
+
+  // With every module prefetched too, the requesting thread's come first
+  // and the walk needs nothing more.
+  AsyncTestSymbolSupplier both_supplier;
+  BasicSourceLineResolver both_resolver;
+  MinidumpProcessor both_processor(&both_supplier, &both_resolver);
+  both_processor.set_prefetch_requesting_thread_symbols(true);
+  both_processor.set_prefetch_symbols(true);
+  ASSERT_EQ(both_processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ExpectSameThreads(lazy_state, state);
+  ASSERT_EQ(state.modules()->module_count(), both_supplier.requests_.size());
+  EXPECT_TRUE(std::equal(supplier.requests_.begin(), supplier.requests_.end(),
+                         both_supplier.requests_.begin()));
+  EXPECT_TRUE(both_supplier.lazy_requests_.empty());
+}
+
+TEST_F(MinidumpProcessorTest, TestSignatureMode) {
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+
+  TestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver, true);
+  processor.set_signature_mode(2);
+  ProcessState state;
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_EQ(1U, state.threads()->size());
+  ASSERT_EQ(0, state.requesting_thread());
+  const CallStack* stack = state.threads()->at(0);
+  ASSERT_EQ(2U, stack->frames()->size());
+  EXPECT_TRUE(stack->budget_exhausted());
+  EXPECT_EQ("`anonymous namespace'::CrashFunction",
+            stack->frames()->at(0)->function_name);
+  EXPECT_EQ("main", stack->frames()->at(1)->function_name);
+  EXPECT_EQ(google_breakpad::EXPLOITABILITY_NOT_ANALYZED,
+            state.exploitability());
+
+  // Only the module those frames are in has its symbols looked up.
+  MockSymbolSupplier mock_supplier;
+  BasicSourceLineResolver mock_resolver;
+  MinidumpProcessor mock_processor(&mock_supplier, &mock_resolver);
+  mock_processor.set_signature_mode(2);
+  EXPECT_CALL(mock_supplier, GetCStringSymbolData(
+      Property(&google_breakpad::CodeModule::code_file,
+               "c:\\test_app.exe"),
+      _, _, _, _)).WillOnce(Return(SymbolSupplier::NOT_FOUND));
+  EXPECT_CALL(mock_supplier, GetCStringSymbolData(
+      Property(&google_breakpad::CodeModule::code_file,
+               Ne("c:\\test_app.exe")),
+      _, _, _, _)).Times(0);
+  EXPECT_CALL(mock_supplier, FreeSymbolData(_)).Times(AnyNumber());
+  ASSERT_EQ(mock_processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_EQ(1U, state.threads()->size());
+
+  // A minidump with several threads has only one walked.
+  minidump_file = GetTestDataPath() + "thread_name_list.dmp";
+  MinidumpProcessor unsymbolized(NULL, &resolver);
+  unsymbolized.set_signature_mode(2);
+  ASSERT_EQ(unsymbolized.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_EQ(1U, state.threads()->size());
+  EXPECT_GE(2U, state.threads()->at(0)->frames()->size());
+}
+
+TEST_F(MinidumpProcessorTest, TestProcessStats) {
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+  TestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver);
+  processor.set_collect_stats(true);
+
+  ProcessState state;
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  const ProcessStats* stats = state.stats();
+  ASSERT_NE(nullptr, stats);
+
+  // Every frame of every thread was counted by how it was found.
+  uint64_t frames = 0;
+  uint64_t context_frames = 0;
+  for (size_t i = 0; i < state.threads()->size(); ++i) {
+    frames += state.threads()->at(i)->frames()->size();
+    if (!state.threads()->at(i)->frames()->empty())
+      ++context_frames;
+  }
+  uint64_t counted_frames = 0;
+  for (int trust = 0; trust < ProcessStats::kFrameTrustCount; ++trust) {
+    counted_frames +=
+        stats->frames_by_trust(static_cast<StackFrame::FrameTrust>(trust));
+  }
+  EXPECT_EQ(frames, counted_frames);
+  EXPECT_EQ(context_frames,
+            stats->frames_by_trust(StackFrame::FRAME_TRUST_CONTEXT));
+
+  // The symbols of test_app.exe were supplied and loaded.
+  EXPECT_GT(stats->symbol_supplier_calls(), 0U);
+  bool loaded_test_app = false;
+  for (size_t i = 0; i < stats->module_loads().size(); ++i) {
+    const ProcessStats::ModuleLoad& load = stats->module_loads()[i];
+    if (load.code_file == "c:\\test_app.exe") {
+      loaded_test_app = load.loaded;
+      EXPECT_GT(load.symbol_data_size, 0U);
+    }
+  }
+  EXPECT_TRUE(loaded_test_app);
+  EXPECT_GT(stats->stackwalk_nanoseconds(), 0U);
+  EXPECT_GE(stats->total_nanoseconds(), stats->stackwalk_nanoseconds());
+
+  // Nothing is recorded unless asked for.
+  processor.set_collect_stats(false);
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  EXPECT_EQ(nullptr, state.stats());
+}
+
+TEST_F(MinidumpProcessorTest, TestBorrowModules) {
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+  TestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver);
+
+  ProcessState copied_state;
+  ASSERT_EQ(processor.Process(minidump_file, &copied_state),
+            google_breakpad::PROCESS_OK);
+  EXPECT_FALSE(copied_state.modules_borrowed());
+
+  processor.set_borrow_modules(true);
+  scoped_ptr<Minidump> dump(new Minidump(minidump_file));
+  ASSERT_TRUE(dump->Read());
+  ProcessState state;
+  ASSERT_EQ(processor.Process(dump.get(), &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_TRUE(state.modules_borrowed());
+  EXPECT_EQ(dump->GetModuleList(), state.modules());
+  ExpectSameThreads(copied_state, state);
+  const StackFrame* frame = state.threads()->at(0)->frames()->at(0);
+  ASSERT_TRUE(frame->module);
+  EXPECT_EQ(dump->GetModuleList()->GetModuleForAddress(frame->instruction),
+            frame->module);
+
+  // Once copied, the modules and the frames pointing at them outlive the
+  // dump.
+  state.CopyModules();
+  EXPECT_FALSE(state.modules_borrowed());
+  dump.reset();
+  ASSERT_TRUE(state.modules());
+  EXPECT_EQ(copied_state.modules()->module_count(),
+            state.modules()->module_count());
+  frame = state.threads()->at(0)->frames()->at(0);
+  EXPECT_EQ(state.modules()->GetModuleForAddress(frame->instruction),
+            frame->module);
+  EXPECT_EQ("c:\\test_app.exe", frame->module->code_file());
+  ExpectSameThreads(copied_state, state);
+
+  // Processing a file by name never leaves the modules borrowed.
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  EXPECT_FALSE(state.modules_borrowed());
+  ExpectSameThreads(copied_state, state);
+}
+
+TEST_F(MinidumpProcessorTest, TestMemoryLimit) {
+  string minidump_file = GetTestDataPath() + "thread_name_list.dmp";
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(NULL, &resolver);
+  ProcessState unlimited_state;
+  ASSERT_EQ(processor.Process(minidump_file, &unlimited_state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_GT(unlimited_state.threads()->size(), 1U);
+
+  // A limit the stacks fit in changes nothing, even walking in parallel.
+  processor.set_memory_limit(1024 * 1024 * 1024);
+  processor.set_stackwalk_worker_count(4);
+  ProcessState state;
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ExpectSameThreads(unlimited_state, state);
+
+  // Under a limit that nothing fits in, the stacks are walked one at a
+  // time, and once the page cache holds pages, without scanning.
+  processor.set_memory_limit(1);
+  Minidump dump(minidump_file);
+  ASSERT_TRUE(dump.Read());
+  ASSERT_EQ(processor.Process(&dump, &state), google_breakpad::PROCESS_OK);
+  EXPECT_EQ(*unlimited_state.thread_names(), *state.thread_names());
+  ASSERT_EQ(unlimited_state.threads()->size(), state.threads()->size());
+  for (size_t i = 0; i < state.threads()->size(); ++i) {
+    const CallStack* stack = state.threads()->at(i);
+    ASSERT_FALSE(stack->frames()->empty());
+    EXPECT_LE(stack->frames()->size(),
+              unlimited_state.threads()->at(i)->frames()->size());
+    for (size_t j = 1; i > 0 && j < stack->frames()->size(); ++j)
+      EXPECT_NE(StackFrame::FRAME_TRUST_SCAN, stack->frames()->at(j)->trust);
+  }
+
+  // The streams released while processing are read again when asked for.
+  ASSERT_TRUE(dump.GetModuleList());
+  EXPECT_EQ(unlimited_state.modules()->module_count(),
+            dump.GetModuleList()->module_count());
+  MinidumpThreadNameList* thread_names = dump.GetThreadNameList();
+  ASSERT_TRUE(thread_names);
+  EXPECT_GT(thread_names->thread_name_count(), 0U);
+
+  // Every thread name is found by its thread's ID.
+  for (unsigned int i = 0; i < thread_names->thread_name_count(); ++i) {
+    MinidumpThreadName* thread_name = thread_names->GetThreadNameAtIndex(i);
+    ASSERT_TRUE(thread_name);
+    uint32_t thread_id;
+    ASSERT_TRUE(thread_name->GetThreadID(&thread_id));
+    MinidumpThreadName* found = thread_names->GetThreadNameByID(thread_id);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(thread_name->GetThreadName(), found->GetThreadName());
+  }
+}
+
 TEST_F(MinidumpProcessorTest, TestThreadMissingMemory) {
   MockMinidump dump;
   EXPECT_CALL(dump, path()).WillRepeatedly(Return("mock minidump"));
@@ -744,6 +1231,291 @@ TEST_F(MinidumpProcessorTest, TestThreadMissingContext) {
   ASSERT_EQ(0U, state.threads()->at(0)->frames()->size());
 }
 
+// Processes two of four x86 threads, with ids 1 to 4, chosen by rank.  The
+// threads use the stack bytes given by kStackUsed, and the second thread's
+// instruction pointer is in libc.
+static void ProcessRankedThreads(int worker_count, ProcessState* state) {
+  MockMinidump dump;
+  EXPECT_CALL(dump, path()).WillRepeatedly(Return("mock minidump"));
+  EXPECT_CALL(dump, Read()).WillRepeatedly(Return(true));
+
+  MDRawHeader fake_header;
+  fake_header.time_date_stamp = 0;
+  EXPECT_CALL(dump, header()).WillRepeatedly(Return(&fake_header));
+
+  MDRawSystemInfo raw_system_info;
+  memset(&raw_system_info, 0, sizeof(raw_system_info));
+  raw_system_info.processor_architecture = MD_CPU_ARCHITECTURE_X86;
+  raw_system_info.platform_id = MD_OS_LINUX;
+  TestMinidumpSystemInfo dump_system_info(raw_system_info);
+  EXPECT_CALL(dump, GetSystemInfo()).
+      WillRepeatedly(Return(&dump_system_info));
+
+  MockCodeModule app(0x400000, 0x10000, "/usr/bin/app", "");
+  MockCodeModule libc(0x500000, 0x10000, "/lib/libc.so.6", "");
+  MockCodeModules* modules = new MockCodeModules();
+  modules->Add(&app);
+  modules->Add(&libc);
+  MockMinidumpModuleList module_list(&dump);
+  EXPECT_CALL(dump, GetModuleList()).WillOnce(Return(&module_list));
+  EXPECT_CALL(module_list, Copy()).WillOnce(Return(modules));
+
+  MockMinidumpThreadList thread_list;
+  EXPECT_CALL(dump, GetThreadList()).WillOnce(Return(&thread_list));
+  MockMinidumpMemoryList memory_list;
+  EXPECT_CALL(dump, GetMemoryList()).WillOnce(Return(&memory_list));
+
+  const uint32_t kStackUsed[4] = { 0x08, 0x30, 0x20, 0x10 };
+  const uint32_t kStackSize = 0x40;
+  MockMinidumpThread threads[4];
+  scoped_ptr<MockMinidumpMemoryRegion> memory[4];
+  scoped_ptr<TestMinidumpContext> contexts[4];
+  for (int i = 0; i < 4; ++i) {
+    uint32_t base = 0x7fe10000 + i * 0x10000;
+    memory[i].reset(new MockMinidumpMemoryRegion(
+        base, string(kStackSize, '\0')));
+    MDRawContextX86 raw_context;
+    memset(&raw_context, 0, sizeof(raw_context));
+    raw_context.context_flags = MD_CONTEXT_X86_FULL;
+    raw_context.eip = i == 1 ? 0x501000 : 0x401000;
+    raw_context.esp = base + kStackSize - kStackUsed[i];
+    contexts[i].reset(new TestMinidumpContext(raw_context));
+
+    EXPECT_CALL(threads[i], GetThreadID(_)).
+        WillRepeatedly(DoAll(SetArgumentPointee<0>(i + 1), Return(true)));
+    EXPECT_CALL(threads[i], GetMemory()).
+        WillRepeatedly(Return(memory[i].get()));
+    EXPECT_CALL(threads[i], GetContext()).
+        WillRepeatedly(Return(contexts[i].get()));
+    EXPECT_CALL(thread_list, GetThreadAtIndex(i)).
+        WillRepeatedly(Return(&threads[i]));
+  }
+  EXPECT_CALL(thread_list, thread_count()).WillRepeatedly(Return(4));
+
+  MinidumpProcessor processor(reinterpret_cast<SymbolSupplier*>(NULL), NULL);
+  processor.set_max_thread_count(2);
+  processor.set_prioritize_threads(true);
+  processor.set_stackwalk_worker_count(worker_count);
+  EXPECT_EQ(processor.Process(&dump, state), google_breakpad::PROCESS_OK);
+}
+
+// Returns the id of the thread whose stack |stack| is, from the stack
+// pointer of its first frame.
+static uint32_t RankedThreadId(const CallStack* stack) {
+  const StackFrameX86* frame =
+      static_cast<const StackFrameX86*>(stack->frames()->at(0));
+  return ((frame->context.esp - 0x7fe10000) >> 16) + 1;
+}
+
+TEST_F(MinidumpProcessorTest, TestPrioritizeThreads) {
+  // The idle second thread ranks last despite its deep stack, and the
+  // others by stack use, so the third and fourth threads are processed, in
+  // their order in the minidump.
+  for (int worker_count = 1; worker_count <= 4; worker_count += 3) {
+    ProcessState ranked_state;
+    ProcessRankedThreads(worker_count, &ranked_state);
+    ASSERT_EQ(2U, ranked_state.threads()->size());
+    EXPECT_EQ(3U, RankedThreadId(ranked_state.threads()->at(0)));
+    EXPECT_EQ(4U, RankedThreadId(ranked_state.threads()->at(1)));
+    EXPECT_EQ(4, ranked_state.original_thread_count());
+  }
+}
+
+// Builds a stack of little-endian 32-bit words.
+static string StackWords(const vector<uint32_t>& words) {
+  string contents;
+  for (uint32_t word : words) {
+    for (int i = 0; i < 4; ++i)
+      contents.push_back(static_cast<char>(word >> (8 * i)));
+  }
+  return contents;
+}
+
+// Processes three x86 threads whose stacks live at different addresses.
+// The first two hold the same frame pointer chain, so with deduplication
+// the second thread's frames are copied from the first's and moved to its
+// own stack.
+static void ProcessDuplicateStacks(
+    bool deduplicate, int worker_count, ProcessState* state,
+    google_breakpad::ProcessObserver* observer = NULL) {
+  MockMinidump dump;
+  EXPECT_CALL(dump, path()).WillRepeatedly(Return("mock minidump"));
+  EXPECT_CALL(dump, Read()).WillRepeatedly(Return(true));
+
+  MDRawHeader fake_header;
+  fake_header.time_date_stamp = 0;
+  EXPECT_CALL(dump, header()).WillRepeatedly(Return(&fake_header));
+
+  MDRawSystemInfo raw_system_info;
+  memset(&raw_system_info, 0, sizeof(raw_system_info));
+  raw_system_info.processor_architecture = MD_CPU_ARCHITECTURE_X86;
+  raw_system_info.platform_id = MD_OS_WIN32_NT;
+  TestMinidumpSystemInfo dump_system_info(raw_system_info);
+  EXPECT_CALL(dump, GetSystemInfo()).
+      WillRepeatedly(Return(&dump_system_info));
+
+  MockMinidumpThreadList thread_list;
+  EXPECT_CALL(dump, GetThreadList()).WillOnce(Return(&thread_list));
+  MockMinidumpMemoryList memory_list;
+  EXPECT_CALL(dump, GetMemoryList()).WillOnce(Return(&memory_list));
+
+  const uint32_t kBases[3] = { 0x7fe10000, 0x7fe20000, 0x7fe30000 };
+  const uint32_t kReturnAddresses[3] = { 0x40a000, 0x40a000, 0x40b000 };
+  MockMinidumpThread threads[3];
+  scoped_ptr<MockMinidumpMemoryRegion> memory[3];
+  scoped_ptr<TestMinidumpContext> contexts[3];
+  for (int i = 0; i < 3; ++i) {
+    uint32_t base = kBases[i];
+    memory[i].reset(new MockMinidumpMemoryRegion(base, StackWords({
+        0xdeadbeef,               // local
+        base + 0x10,              // saved %ebp
+        kReturnAddresses[i],      // return address
+        0x00000000, 0x00000000,
+        0x00000000,               // saved %ebp: end of chain
+        0x00000000 })));
+    MDRawContextX86 raw_context;
+    memset(&raw_context, 0, sizeof(raw_context));
+    raw_context.context_flags = MD_CONTEXT_X86_FULL;
+    raw_context.eip = 0x401000;
+    raw_context.esp = base;
+    raw_context.ebp = base + 4;
+    raw_context.esi = base + 0x18;  // another pointer into the stack
+    contexts[i].reset(new TestMinidumpContext(raw_context));
+
+    EXPECT_CALL(threads[i], GetThreadID(_)).
+        WillRepeatedly(DoAll(SetArgumentPointee<0>(i + 1), Return(true)));
+    EXPECT_CALL(threads[i], GetMemory()).
+        WillRepeatedly(Return(memory[i].get()));
+    EXPECT_CALL(threads[i], GetContext()).
+        WillRepeatedly(Return(contexts[i].get()));
+    EXPECT_CALL(thread_list, GetThreadAtIndex(i)).
+        WillOnce(Return(&threads[i]));
+  }
+  EXPECT_CALL(thread_list, thread_count()).WillRepeatedly(Return(3));
+
+  MinidumpProcessor processor(reinterpret_cast<SymbolSupplier*>(NULL), NULL);
+  processor.set_deduplicate_stacks(deduplicate);
+  processor.set_stackwalk_worker_count(worker_count);
+  EXPECT_EQ(processor.Process(&dump, processor.options(), observer, state),
+            google_breakpad::PROCESS_OK);
+}
+
+TEST_F(MinidumpProcessorTest, TestDeduplicateStacks) {
+  ProcessState walked_state;
+  ProcessDuplicateStacks(false, 1, &walked_state);
+  ProcessState deduplicated_state;
+  ProcessDuplicateStacks(true, 1, &deduplicated_state);
+
+  ASSERT_EQ(3U, deduplicated_state.threads()->size());
+  ExpectSameThreads(walked_state, deduplicated_state);
+  EXPECT_EQ(-1, walked_state.threads()->at(1)->duplicate_of());
+  EXPECT_EQ(-1, deduplicated_state.threads()->at(0)->duplicate_of());
+  EXPECT_EQ(0, deduplicated_state.threads()->at(1)->duplicate_of());
+  EXPECT_EQ(-1, deduplicated_state.threads()->at(2)->duplicate_of());
+
+  // The copied frames describe the second thread's own stack.
+  for (int i = 0; i < 3; ++i) {
+    const vector<StackFrame*>* walked =
+        walked_state.threads()->at(i)->frames();
+    const vector<StackFrame*>* copied =
+        deduplicated_state.threads()->at(i)->frames();
+    ASSERT_GT(walked->size(), 1U);
+    for (size_t j = 0; j < walked->size(); ++j) {
+      const StackFrameX86* walked_frame =
+          static_cast<const StackFrameX86*>(walked->at(j));
+      const StackFrameX86* copied_frame =
+          static_cast<const StackFrameX86*>(copied->at(j));
+      EXPECT_EQ(walked_frame->context_validity,
+                copied_frame->context_validity);
+      EXPECT_EQ(walked_frame->context.esp, copied_frame->context.esp);
+      EXPECT_EQ(walked_frame->context.ebp, copied_frame->context.ebp);
+      EXPECT_EQ(walked_frame->context.eip, copied_frame->context.eip);
+      EXPECT_EQ(walked_frame->context.esi, copied_frame->context.esi);
+    }
+  }
+
+  // Walking in parallel resolves the duplicates the same way.
+  ProcessState parallel_state;
+  ProcessDuplicateStacks(true, 4, &parallel_state);
+  ExpectSameThreads(walked_state, parallel_state);
+  EXPECT_EQ(0, parallel_state.threads()->at(1)->duplicate_of());
+  EXPECT_EQ(-1, parallel_state.threads()->at(2)->duplicate_of());
+}
+
+// Records what a ProcessObserver is handed, and the size of each thread's
+// stack when it was.
+class RecordingProcessObserver : public google_breakpad::ProcessObserver {
+ public:
+  RecordingProcessObserver() : info_count_(0), requesting_thread_(-2) {}
+
+  void OnProcessInfo(const ProcessState& process_state) override {
+    ++info_count_;
+    requesting_thread_ = process_state.requesting_thread();
+  }
+
+  void OnThread(const ProcessState& process_state,
+                int thread_index) override {
+    EXPECT_EQ(1, info_count_);
+    threads_.push_back(thread_index);
+    frame_counts_.push_back(
+        process_state.threads()->at(thread_index)->frames()->size());
+  }
+
+  int info_count_;
+  int requesting_thread_;
+  vector<int> threads_;
+  vector<size_t> frame_counts_;
+};
+
+// Checks that |observer| was handed every thread of |state| once, whole,
+// the requesting thread first.
+static void ExpectObservedThreads(const ProcessState& state,
+                                  const RecordingProcessObserver& observer) {
+  EXPECT_EQ(1, observer.info_count_);
+  EXPECT_EQ(state.requesting_thread(), observer.requesting_thread_);
+  ASSERT_EQ(state.threads()->size(), observer.threads_.size());
+  vector<int> expected;
+  if (state.requesting_thread() >= 0)
+    expected.push_back(state.requesting_thread());
+  for (int i = 0; i < static_cast<int>(state.threads()->size()); ++i) {
+    if (i != state.requesting_thread())
+      expected.push_back(i);
+  }
+  EXPECT_EQ(expected, observer.threads_);
+  for (size_t i = 0; i < observer.threads_.size(); ++i) {
+    EXPECT_EQ(state.threads()->at(observer.threads_[i])->frames()->size(),
+              observer.frame_counts_[i]);
+  }
+}
+
+TEST_F(MinidumpProcessorTest, TestProcessObserver) {
+  const string files[] = { "minidump2.dmp", "thread_name_list.dmp" };
+  for (const string& file : files) {
+    for (int worker_count = 1; worker_count <= 4; worker_count += 3) {
+      Minidump dump(GetTestDataPath() + file);
+      ASSERT_TRUE(dump.Read());
+      BasicSourceLineResolver resolver;
+      MinidumpProcessor processor(NULL, &resolver);
+      processor.set_stackwalk_worker_count(worker_count);
+      RecordingProcessObserver observer;
+      ProcessState state;
+      ASSERT_EQ(google_breakpad::PROCESS_OK,
+                processor.Process(&dump, processor.options(), &observer,
+                                  &state));
+      ExpectObservedThreads(state, observer);
+    }
+  }
+
+  // Threads that reuse another's walk are handed over whole too.
+  for (int worker_count = 1; worker_count <= 4; worker_count += 3) {
+    ProcessState state;
+    RecordingProcessObserver observer;
+    ProcessDuplicateStacks(true, worker_count, &state, &observer);
+    ASSERT_EQ(3U, state.threads()->size());
+    ExpectObservedThreads(state, observer);
+  }
+}
+
 TEST_F(MinidumpProcessorTest, Test32BitCrashingAddress) {
   TestSymbolSupplier supplier;
   BasicSourceLineResolver resolver;
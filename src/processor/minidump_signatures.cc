@@ -0,0 +1,448 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// minidump_signatures.cc: Tally the crash signatures of many minidumps,
+// processed on a pool of workers in signature mode, and print how often
+// each occurs, with a few of the minidumps that have it.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/path_helper.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/concurrent_source_line_resolver.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/missing_symbols_cache.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "processor/logging.h"
+#include "processor/pathname_stripper.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::CallStack;
+using google_breakpad::ConcurrentSourceLineResolver;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::MissingSymbolsCache;
+using google_breakpad::PathnameStripper;
+using google_breakpad::ProcessState;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::StackFrame;
+using google_breakpad::StackFrameSymbolizer;
+
+struct Options {
+  // The directory whose minidumps are tallied, unless |minidump_list| is
+  // set.
+  string minidump_directory;
+  // A file listing the minidumps, one path per line, or - for stdin.
+  string minidump_list;
+  std::vector<string> symbol_paths;
+  // The name of the index file listing the symbol files in each of
+  // |symbol_paths|, or empty to look for each symbol file.
+  string symbol_index_file;
+  // The frames of the requesting thread that make up a signature.
+  int signature_frames;
+  // The number of minidumps processed at once.
+  int workers;
+  // The number of signatures printed, most frequent first (0 for all).
+  size_t top_signatures;
+  // The number of minidumps named for each signature.
+  size_t examples;
+  // Print the tally so far after every this many minidumps (0 for only
+  // at the end).
+  uint64_t progress_interval;
+};
+
+// Hands out the paths of the minidumps to tally, to several workers.
+class MinidumpPathReader {
+ public:
+  explicit MinidumpPathReader(const Options& options)
+      : file_(NULL), next_path_(0) {
+    if (options.minidump_list == "-") {
+      file_ = stdin;
+    } else if (!options.minidump_list.empty()) {
+      file_ = fopen(options.minidump_list.c_str(), "r");
+      if (!file_)
+        BPLOG(ERROR) << "Can't open " << options.minidump_list;
+    } else {
+      ListDirectory(options.minidump_directory);
+    }
+  }
+
+  ~MinidumpPathReader() {
+    if (file_ && file_ != stdin)
+      fclose(file_);
+  }
+
+  // Sets |path| to the next minidump path.  Returns false at the end.
+  bool Next(string* path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) {
+      if (next_path_ == paths_.size())
+        return false;
+      *path = paths_[next_path_++];
+      return true;
+    }
+
+    char line[4096];
+    while (fgets(line, sizeof(line), file_)) {
+      size_t length = strlen(line);
+      while (length > 0 &&
+             (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+        line[--length] = '\0';
+      }
+      if (length > 0) {
+        *path = line;
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  // Collects the regular files in |directory|, sorted by name.
+  void ListDirectory(const string& directory) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+      BPLOG(ERROR) << "Can't read directory " << directory;
+      return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+      string path = directory + "/" + entry->d_name;
+      struct stat st;
+      if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+        paths_.push_back(path);
+    }
+    closedir(dir);
+    std::sort(paths_.begin(), paths_.end());
+  }
+
+  std::mutex mutex_;
+  FILE* file_;
+  std::vector<string> paths_;
+  size_t next_path_;
+};
+
+// Returns how |frame| appears in a signature: its function, or else its
+// module and offset into it, or else its address.
+string FrameSignature(const StackFrame* frame) {
+  if (!frame->function_name.empty())
+    return frame->function_name;
+  char offset[32];
+  if (frame->module) {
+    snprintf(offset, sizeof(offset), "+0x%" PRIx64,
+             frame->instruction - frame->module->base_address());
+    return PathnameStripper::File(frame->module->code_file()) + offset;
+  }
+  snprintf(offset, sizeof(offset), "0x%" PRIx64, frame->instruction);
+  return offset;
+}
+
+// Returns the signature of |process_state|: the first |frame_count|
+// frames of its requesting thread, or of the thread signature mode walked
+// if it names none, joined by " | ".
+string Signature(const ProcessState& process_state, int frame_count) {
+  const std::vector<CallStack*>* threads = process_state.threads();
+  int thread = process_state.requesting_thread();
+  if (thread < 0) {
+    if (threads->empty())
+      return "<no threads>";
+    thread = 0;
+  }
+  const std::vector<StackFrame*>* frames = threads->at(thread)->frames();
+  if (frames->empty())
+    return "<no frames>";
+  string signature;
+  int count = std::min(frame_count, static_cast<int>(frames->size()));
+  for (int i = 0; i < count; ++i) {
+    if (i > 0)
+      signature += " | ";
+    signature += FrameSignature(frames->at(i));
+  }
+  return signature;
+}
+
+// Returns the name a minidump is known by: its file name, without .dmp.
+string MinidumpId(const string& path) {
+  string id = google_breakpad::BaseName(path);
+  const string kSuffix = ".dmp";
+  if (id.size() > kSuffix.size() &&
+      id.compare(id.size() - kSuffix.size(), kSuffix.size(), kSuffix) == 0) {
+    id.resize(id.size() - kSuffix.size());
+  }
+  return id;
+}
+
+// The signatures found so far, shared by the workers.
+class SignatureTally {
+ public:
+  explicit SignatureTally(const Options& options)
+      : options_(options), processed_(0), failed_(0) { }
+
+  // Counts the minidump at |path|, which has |signature|.
+  void Add(const string& path, const string& signature) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[signature];
+    ++entry.count;
+    if (entry.examples.size() < options_.examples)
+      entry.examples.push_back(MinidumpId(path));
+    Processed();
+  }
+
+  // Counts the minidump at |path|, which could not be processed.
+  void AddFailure(const string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    BPLOG(ERROR) << "Could not process " << path;
+    ++failed_;
+    Processed();
+  }
+
+  // Prints the tally of every minidump.  Returns true if every minidump
+  // was processed.
+  bool Finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Print();
+    return failed_ == 0;
+  }
+
+ private:
+  struct Entry {
+    Entry() : count(0) { }
+    uint64_t count;
+    std::vector<string> examples;
+  };
+
+  // Counts a minidump, and prints the tally at each progress interval.
+  // The caller must hold mutex_.
+  void Processed() {
+    ++processed_;
+    if (options_.progress_interval &&
+        processed_ % options_.progress_interval == 0) {
+      Print();
+    }
+  }
+
+  // Prints the most frequent signatures, one per line, as
+  //   <count>\t<signature>\t<minidump-id>[,<minidump-id>...]
+  // after a line with the number of minidumps tallied.  The caller must
+  // hold mutex_.
+  void Print() {
+    std::vector<std::map<string, Entry>::const_iterator> sorted;
+    sorted.reserve(entries_.size());
+    for (auto it = entries_.begin(); it != entries_.end(); ++it)
+      sorted.push_back(it);
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](std::map<string, Entry>::const_iterator a,
+                        std::map<string, Entry>::const_iterator b) {
+                       return a->second.count > b->second.count;
+                     });
+    if (options_.top_signatures && sorted.size() > options_.top_signatures)
+      sorted.resize(options_.top_signatures);
+
+    printf("Minidumps %" PRIu64 " failed %" PRIu64 " signatures %zu\n",
+           processed_, failed_, entries_.size());
+    for (std::map<string, Entry>::const_iterator it : sorted) {
+      printf("%" PRIu64 "\t%s\t", it->second.count, it->first.c_str());
+      for (size_t i = 0; i < it->second.examples.size(); ++i)
+        printf("%s%s", i ? "," : "", it->second.examples[i].c_str());
+      printf("\n");
+    }
+    fflush(stdout);
+  }
+
+  const Options& options_;
+  std::mutex mutex_;
+  std::map<string, Entry> entries_;
+  uint64_t processed_;
+  uint64_t failed_;
+};
+
+// Tallies the signatures of every minidump that |options| names.  The
+// workers share one resolver and symbolizer, so that each module's symbols
+// are loaded once for the whole run.  Returns true if every minidump was
+// processed.
+bool TallySignatures(const Options& options) {
+  SimpleSymbolSupplier supplier(options.symbol_paths);
+  supplier.set_use_mmap(true);
+  if (!options.symbol_index_file.empty())
+    supplier.set_index_file_name(options.symbol_index_file);
+  ConcurrentSourceLineResolver resolver;
+  MissingSymbolsCache missing_symbols;
+  StackFrameSymbolizer symbolizer(&supplier, &resolver);
+  symbolizer.set_missing_symbols_cache(&missing_symbols);
+  symbolizer.set_persist_frame_info_cache(true);
+  symbolizer.set_cache_source_line_info(true);
+
+  MinidumpPathReader reader(options);
+  SignatureTally tally(options);
+  auto worker = [&]() {
+    MinidumpProcessor minidump_processor(&symbolizer, false);
+    minidump_processor.set_signature_mode(options.signature_frames);
+    string path;
+    while (reader.Next(&path)) {
+      ProcessState process_state;
+      if (minidump_processor.Process(path, &process_state) ==
+          google_breakpad::PROCESS_OK) {
+        tally.Add(path, Signature(process_state, options.signature_frames));
+      } else {
+        tally.AddFailure(path);
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 1; i < options.workers; ++i)
+    workers.emplace_back(worker);
+  worker();
+  for (std::thread& thread : workers)
+    thread.join();
+
+  return tally.Finish();
+}
+
+void Usage(int argc, const char* argv[], bool error) {
+  fprintf(error ? stderr : stdout,
+          "Usage: %s [options] <minidump-directory> [symbol-path ...]\n"
+          "       %s [options] -l <minidump-list> [symbol-path ...]\n"
+          "\n"
+          "Process every minidump in a directory, or listed one path per\n"
+          "line in a file, as far as its crash signature needs, and print\n"
+          "how many have each signature, most frequent first, as\n"
+          "  <count>\\t<signature>\\t<minidump-id>[,<minidump-id>...]\n"
+          "A signature is the first frames of the requesting thread, and a\n"
+          "minidump's id is its file name without .dmp\n"
+          "\n"
+          "Options:\n"
+          "\n"
+          "  -e <n>     Name this many minidumps for each signature\n"
+          "             (default 3)\n"
+          "  -j <n>     Process this many minidumps at once (default: the\n"
+          "             number of CPUs)\n"
+          "  -l <file>  Read the minidump paths from this file, or from\n"
+          "             stdin if it is -\n"
+          "  -n <n>     Make signatures of this many frames (default 5)\n"
+          "  -p <n>     Also print the tally so far after every this many\n"
+          "             minidumps\n"
+          "  -t <n>     Print only this many signatures (default 50, 0 for\n"
+          "             all)\n"
+          "  -x <name>  Find symbol files through the index file with this\n"
+          "             name in each symbol-path that has one\n",
+          google_breakpad::BaseName(argv[0]).c_str(),
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+void SetupOptions(int argc, const char* argv[], Options* options) {
+  options->signature_frames = 5;
+  options->workers = std::max(1U, std::thread::hardware_concurrency());
+  options->top_signatures = 50;
+  options->examples = 3;
+  options->progress_interval = 0;
+
+  int ch;
+  while ((ch = getopt(argc, (char * const*)argv, "e:hj:l:n:p:t:x:")) != -1) {
+    switch (ch) {
+      case 'h':
+        Usage(argc, argv, false);
+        exit(0);
+        break;
+
+      case 'e':
+        options->examples = strtoul(optarg, NULL, 10);
+        break;
+      case 'j':
+        options->workers = atoi(optarg);
+        if (options->workers < 1) {
+          fprintf(stderr, "%s: -j needs a positive number\n", argv[0]);
+          exit(1);
+        }
+        break;
+      case 'l':
+        options->minidump_list = optarg;
+        break;
+      case 'n':
+        options->signature_frames = atoi(optarg);
+        if (options->signature_frames < 1) {
+          fprintf(stderr, "%s: -n needs a positive number\n", argv[0]);
+          exit(1);
+        }
+        break;
+      case 'p':
+        options->progress_interval = strtoull(optarg, NULL, 10);
+        break;
+      case 't':
+        options->top_signatures = strtoul(optarg, NULL, 10);
+        break;
+      case 'x':
+        options->symbol_index_file = optarg;
+        break;
+
+      case '?':
+        Usage(argc, argv, true);
+        exit(1);
+        break;
+    }
+  }
+
+  int argi = optind;
+  if (options->minidump_list.empty()) {
+    if (argi >= argc) {
+      Usage(argc, argv, true);
+      exit(1);
+    }
+    options->minidump_directory = argv[argi++];
+  }
+  for (; argi < argc; ++argi)
+    options->symbol_paths.push_back(argv[argi]);
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  Options options;
+  SetupOptions(argc, argv, &options);
+  return TallySignatures(options) ? 0 : 1;
+}
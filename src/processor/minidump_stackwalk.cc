@@ -35,122 +35,831 @@
 #include <config.h>  // Must come first
 #endif
 
+#include <dirent.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <istream>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "common/path_helper.h"
 #include "common/scoped_ptr.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/concurrent_source_line_resolver.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
 #include "google_breakpad/processor/minidump.h"
 #include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/missing_symbols_cache.h"
 #include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "processor/fast_symbol_supplier.h"
+#include "processor/growing_stream_buffer.h"
 #include "processor/logging.h"
+#include "processor/process_result_cache.h"
+#include "processor/process_state_writer.h"
 #include "processor/simple_symbol_supplier.h"
+#ifdef __linux__
+#include "processor/http_symbol_supplier.h"
+#endif  // __linux__
 #include "processor/stackwalk_common.h"
+#include "processor/symbol_warmup_manifest.h"
 
 
 namespace {
 
+// Structured output formats, chosen with -o.
+enum OutputFormat {
+  kOutputText,
+  kOutputJSON,
+  kOutputProto,
+};
+
 struct Options {
+  OutputFormat output_format;
   bool machine_readable;
   bool output_stack_contents;
   bool output_requesting_thread_only;
   bool brief;
 
   string minidump_file;
+  // If not negative, |minidump_file| may still be being written, and is
+  // read as it grows until it has not grown for this many seconds.
+  int growing_timeout_seconds;
   std::vector<string> symbol_paths;
+  // The name of the index file listing the symbol files in each of
+  // |symbol_paths|, or empty to look for each symbol file.
+  string symbol_index_file;
+  // If positive, |symbol_paths| are probed at once for each symbol file,
+  // and one that hasn't answered in this many milliseconds is given up on.
+  int symbol_probe_timeout_ms;
+  // A directory that symbol files from |symbol_paths| are compiled into as
+  // fast symbol files, and resolved from, or empty to load symbol files
+  // directly.  Every process using the same directory maps the same
+  // compiled files.
+  string fast_symbol_cache_path;
+
+  // Batch mode processes every minidump named in |batch_list| ("-" for
+  // stdin), or every file in the directory |minidump_file|, with one
+  // resolver and symbol supplier.  |batch_workers| dumps are processed at
+  // once.  |module_cache_bytes| limits the memory used by loaded symbols
+  // (0 for no limit).
+  bool batch;
+  string batch_list;
+  int batch_workers;
+  size_t module_cache_bytes;
+  // A symbol warmup manifest whose modules are preloaded as the batch
+  // starts, and which is rewritten with the hottest modules when it ends,
+  // or empty for none.
+  string warmup_manifest_path;
+
+  // Symbol servers to download missing symbol files from, the directory
+  // they are cached in, and the cache's size limit in bytes (0 for none).
+  std::vector<string> symbol_servers;
+  string symbol_cache_path;
+  uint64_t symbol_cache_bytes;
+
+  // Modules whose callers are unwound by frame pointer before CFI.
+  std::set<string> frame_pointer_modules;
+
+  // Print where the time of processing each minidump went to stderr.
+  bool print_stats;
+
+  // If positive, only the requesting thread is walked, to this many
+  // frames, as for a crash signature.
+  int signature_frames;
+
+  // The most bytes of each minidump's data that processing holds in
+  // memory, or 0 for no limit.
+  uint64_t memory_limit;
+
+  // A directory in which structured results are kept, and reused for
+  // minidumps processed again with the same symbols, or empty to keep
+  // none.
+  string result_cache_path;
 };
 
 using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::ConcurrentSourceLineResolver;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::FastSymbolSupplier;
+using google_breakpad::GrowingStreamBuffer;
+#ifdef __linux__
+using google_breakpad::HTTPSymbolSupplier;
+#endif  // __linux__
 using google_breakpad::Minidump;
 using google_breakpad::MinidumpMemoryList;
+using google_breakpad::MinidumpMemory64List;
 using google_breakpad::MinidumpThreadList;
 using google_breakpad::MinidumpProcessor;
+using google_breakpad::MissingSymbolsCache;
+using google_breakpad::ProcessObserver;
+using google_breakpad::ProcessResultCache;
 using google_breakpad::ProcessState;
+using google_breakpad::ProcessStatePrinter;
+using google_breakpad::ProcessStateProtoStreamWriter;
 using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::SourceLineResolverBase;
+using google_breakpad::StackFrameSymbolizer;
+using google_breakpad::SymbolWarmupManifest;
 using google_breakpad::scoped_ptr;
 
-// Processes |options.minidump_file| using MinidumpProcessor.
-// |options.symbol_path|, if non-empty, is the base directory of a
-// symbol storage area, laid out in the format required by
-// SimpleSymbolSupplier.  If such a storage area is specified, it is
-// made available for use by the MinidumpProcessor.
-//
-// Returns the value of MinidumpProcessor::Process.  If processing succeeds,
-// prints identifying OS and CPU information from the minidump, crash
-// information if the minidump was produced as a result of a crash, and
-// call stacks for each thread contained in the minidump.  All information
-// is printed to stdout.
-bool PrintMinidumpProcess(const Options& options) {
-  scoped_ptr<SimpleSymbolSupplier> symbol_supplier;
-  if (!options.symbol_paths.empty()) {
+// The most modules a symbol warmup manifest lists.
+const size_t kWarmupManifestModules = 256;
+
+// Returns the symbol supplier |options| asks for, or NULL for none.
+// |options.symbol_paths|, if non-empty, are the base directories of
+// symbol storage areas, laid out in the format required by
+// SimpleSymbolSupplier.  If |options.symbol_servers| is non-empty, symbol
+// files are instead downloaded from those servers into
+// |options.symbol_cache_path|.
+SimpleSymbolSupplier* CreateSymbolSupplier(const Options& options) {
+  if (!options.symbol_servers.empty()) {
+#ifdef __linux__
+    HTTPSymbolSupplier* http_supplier =
+        new HTTPSymbolSupplier(options.symbol_servers,
+                               options.symbol_cache_path);
+    http_supplier->set_max_cache_bytes(options.symbol_cache_bytes);
+    return http_supplier;
+#endif  // __linux__
+  } else if (!options.fast_symbol_cache_path.empty()) {
+    FastSymbolSupplier* supplier =
+        new FastSymbolSupplier(options.fast_symbol_cache_path);
+    supplier->set_compile_cache(options.fast_symbol_cache_path,
+                                options.symbol_paths);
+    return supplier;
+  } else if (!options.symbol_paths.empty()) {
     // TODO(mmentovai): check existence of symbol_path if specified?
-    symbol_supplier.reset(new SimpleSymbolSupplier(options.symbol_paths));
+    SimpleSymbolSupplier* supplier =
+        new SimpleSymbolSupplier(options.symbol_paths);
+    supplier->set_use_mmap(true);
+    if (!options.symbol_index_file.empty())
+      supplier->set_index_file_name(options.symbol_index_file);
+    if (options.symbol_probe_timeout_ms > 0)
+      supplier->set_concurrent_probing(true, options.symbol_probe_timeout_ms);
+    return supplier;
+  }
+  return NULL;
+}
+
+// Sets the options of |minidump_processor| that |options| asks for.
+void ConfigureProcessor(const Options& options,
+                        MinidumpProcessor* minidump_processor) {
+  minidump_processor->set_collect_stats(options.print_stats);
+  // Downloads overlap when the processor asks for every module up front,
+  // and the requesting thread's finish first.
+  if (!options.symbol_servers.empty()) {
+    minidump_processor->set_prefetch_requesting_thread_symbols(true);
+    minidump_processor->set_prefetch_symbols(true);
   }
+  // A batch is printed whole once walked, so its source lines are looked
+  // up together, module by module.
+  if (options.batch)
+    minidump_processor->set_defer_source_line_info(true);
+  if (options.signature_frames > 0)
+    minidump_processor->set_signature_mode(options.signature_frames);
+  minidump_processor->set_memory_limit(options.memory_limit);
+}
 
-  BasicSourceLineResolver resolver;
-  MinidumpProcessor minidump_processor(symbol_supplier.get(), &resolver);
+// True if the inlined frames are to be constructed only for the threads
+// printed, when not all of them are.  That needs the modules to stay
+// loaded until the result is printed, so not with a module cache budget.
+bool LazyInlineFrames(const Options& options) {
+  return options.output_format == kOutputText && !options.machine_readable &&
+         (options.brief || options.output_requesting_thread_only) &&
+         options.module_cache_bytes == 0;
+}
 
-  // Increase the maximum number of threads and regions.
-  MinidumpThreadList::set_max_threads(std::numeric_limits<uint32_t>::max());
-  MinidumpMemoryList::set_max_regions(std::numeric_limits<uint32_t>::max());
-  // Process the minidump.
-  Minidump dump(options.minidump_file);
-  if (!dump.Read()) {
-     BPLOG(ERROR) << "Minidump " << dump.path() << " could not be read";
+// Reads |dump| and processes it with |minidump_processor| into
+// |process_state|, which refers to |dump|'s memory until it is printed.
+// |observer|, if not NULL, is handed the result as it is ready.  Returns
+// true on success.
+bool ProcessMinidump(Minidump* dump,
+                     MinidumpProcessor* minidump_processor,
+                     ProcessObserver* observer,
+                     ProcessState* process_state) {
+  dump->set_use_mmap(true);
+  dump->set_readahead(true);
+  dump->set_lazy_parsing(true);
+  if (!dump->Read()) {
+     BPLOG(ERROR) << "Minidump " << dump->path() << " could not be read";
      return false;
   }
-  ProcessState process_state;
-  if (minidump_processor.Process(&dump, &process_state) !=
+  if (minidump_processor->Process(dump, minidump_processor->options(),
+                                  observer, process_state) !=
       google_breakpad::PROCESS_OK) {
     BPLOG(ERROR) << "MinidumpProcessor::Process failed";
     return false;
   }
+  return true;
+}
+
+// Returns what, besides a minidump and the symbols, shapes the result
+// that |options| asks for, to be part of its key in a ProcessResultCache.
+string ResultSettings(const Options& options) {
+  string settings =
+      options.output_format == kOutputJSON ? "json" :
+      options.batch ? "proto-delimited" : "proto";
+  char numbers[64];
+  snprintf(numbers, sizeof(numbers), " %d %llu", options.signature_frames,
+           static_cast<unsigned long long>(options.memory_limit));
+  settings += numbers;
+  for (const string& module : options.frame_pointer_modules)
+    settings += " " + module;
+  return settings;
+}
+
+// Looks |minidump_file| up in |result_cache|, if it is not NULL.  Returns
+// true, setting |cached_result|, if a result is kept for it.  Otherwise
+// sets |cache_key| to the key its result is to be kept under, or clears
+// it if the result is not to be kept.
+bool LookupResult(const Options& options,
+                  ProcessResultCache* result_cache,
+                  const string& minidump_file,
+                  string* cache_key,
+                  string* cached_result) {
+  cache_key->clear();
+  if (!result_cache)
+    return false;
+  if (!ProcessResultCache::GetKey(minidump_file, ResultSettings(options),
+                                  cache_key)) {
+    cache_key->clear();
+    return false;
+  }
+  return result_cache->Lookup(*cache_key, cached_result);
+}
+
+// Writes |process_state| in the structured format |options| asks for to
+// |output|.
+void WriteStructuredResult(const Options& options,
+                           const ProcessState& process_state,
+                           FILE* output) {
+  if (options.output_format == kOutputJSON) {
+    google_breakpad::WriteProcessStateJSON(process_state, output);
+  } else {
+    // A batch writes one message after another, so each needs a length.
+    google_breakpad::WriteProcessStateProto(process_state, options.batch,
+                                            output);
+  }
+}
 
-  if (options.machine_readable) {
+// Prints |process_state| in the format |options| asks for.  If |cache_key|
+// is not empty, the result is also kept in |result_cache| under it.
+void PrintResult(const Options& options,
+                 const ProcessState& process_state,
+                 SourceLineResolverBase* resolver,
+                 ProcessResultCache* result_cache,
+                 const string& cache_key) {
+  if (options.output_format != kOutputText) {
+    char* buffer = NULL;
+    size_t size = 0;
+    FILE* memory = cache_key.empty() ? NULL : open_memstream(&buffer, &size);
+    if (memory) {
+      WriteStructuredResult(options, process_state, memory);
+      fclose(memory);
+      fwrite(buffer, 1, size, stdout);
+      if (!result_cache->Store(cache_key, process_state.modules(),
+                               string(buffer, size))) {
+        BPLOG(ERROR) << "Could not keep result " << cache_key;
+      }
+      free(buffer);
+    } else {
+      WriteStructuredResult(options, process_state, stdout);
+    }
+  } else if (options.machine_readable) {
     PrintProcessStateMachineReadable(process_state);
   } else if (options.brief) {
+    int requesting_thread = process_state.requesting_thread();
+    if (requesting_thread != -1) {
+      process_state.threads()->at(requesting_thread)->
+          ExpandInlineFrames(resolver);
+    }
     PrintRequestingThreadBrief(process_state);
   } else {
     PrintProcessState(process_state, options.output_stack_contents,
-                      options.output_requesting_thread_only, &resolver);
+                      options.output_requesting_thread_only, resolver);
+  }
+  if (options.print_stats && process_state.stats())
+    google_breakpad::PrintProcessStats(*process_state.stats(), stderr);
+}
+
+// Processes |options.minidump_file| using MinidumpProcessor.
+//
+// Returns the value of MinidumpProcessor::Process.  If processing succeeds,
+// prints identifying OS and CPU information from the minidump, crash
+// information if the minidump was produced as a result of a crash, and
+// call stacks for each thread contained in the minidump.  All information
+// is printed to stdout.
+bool PrintMinidumpProcess(const Options& options) {
+  scoped_ptr<SimpleSymbolSupplier> symbol_supplier(
+      CreateSymbolSupplier(options));
+
+  // Fast symbol files hold modules serialized for FastSourceLineResolver.
+  scoped_ptr<BasicSourceLineResolver> basic_resolver;
+  scoped_ptr<FastSourceLineResolver> fast_resolver;
+  SourceLineResolverBase* resolver;
+  if (options.fast_symbol_cache_path.empty()) {
+    basic_resolver.reset(new BasicSourceLineResolver());
+    basic_resolver->set_freeze_modules(true);
+    resolver = basic_resolver.get();
+  } else {
+    fast_resolver.reset(new FastSourceLineResolver());
+    resolver = fast_resolver.get();
+  }
+  MinidumpProcessor minidump_processor(symbol_supplier.get(), resolver);
+  minidump_processor.set_frame_pointer_modules(options.frame_pointer_modules);
+  minidump_processor.set_lazy_inline_frames(LazyInlineFrames(options));
+  ConfigureProcessor(options, &minidump_processor);
+
+  // A minidump that is still being written is processed as its parts
+  // arrive, rather than once it is complete.
+  GrowingStreamBuffer growing_buffer;
+  std::istream growing_stream(&growing_buffer);
+  scoped_ptr<Minidump> dump;
+  if (options.growing_timeout_seconds >= 0) {
+    if (!growing_buffer.FollowFile(options.minidump_file)) {
+      BPLOG(ERROR) << "Minidump " << options.minidump_file <<
+                      " could not be opened";
+      return false;
+    }
+    growing_buffer.set_timeout_milliseconds(
+        options.growing_timeout_seconds * 1000);
+    dump.reset(new Minidump(growing_stream));
+  } else {
+    dump.reset(new Minidump(options.minidump_file));
+  }
+  // A minidump still being written can't be looked up by its contents.
+  scoped_ptr<ProcessResultCache> result_cache;
+  if (!options.result_cache_path.empty() &&
+      options.growing_timeout_seconds < 0) {
+    result_cache.reset(new ProcessResultCache(options.result_cache_path,
+                                              symbol_supplier.get()));
+  }
+  string cache_key;
+  string cached_result;
+  if (LookupResult(options, result_cache.get(), options.minidump_file,
+                   &cache_key, &cached_result)) {
+    fwrite(cached_result.data(), 1, cached_result.size(), stdout);
+    return true;
+  }
+
+  // Each thread is printed as soon as it is walked, rather than once all
+  // of them are, unless the result is to be kept whole.
+  scoped_ptr<ProcessStatePrinter> printer;
+  scoped_ptr<ProcessStateProtoStreamWriter> proto_writer;
+  ProcessObserver* observer = NULL;
+  if (options.output_format == kOutputText && !options.brief) {
+    printer.reset(new ProcessStatePrinter(
+        options.machine_readable, options.output_stack_contents,
+        options.output_requesting_thread_only, resolver));
+    observer = printer.get();
+  } else if (options.output_format == kOutputProto && cache_key.empty()) {
+    proto_writer.reset(new ProcessStateProtoStreamWriter(stdout));
+    observer = proto_writer.get();
+  }
+
+  ProcessState process_state;
+  if (!ProcessMinidump(dump.get(), &minidump_processor, observer,
+                       &process_state)) {
+    return false;
   }
 
+  if (!observer) {
+    PrintResult(options, process_state, resolver, result_cache.get(),
+                cache_key);
+    return true;
+  }
+  if (printer.get())
+    printer->Finish(process_state);
+  else
+    proto_writer->Finish(process_state);
+  if (options.print_stats && process_state.stats())
+    google_breakpad::PrintProcessStats(*process_state.stats(), stderr);
   return true;
 }
 
+// Yields the minidump paths of a batch, one at a time, from a list file,
+// stdin, or a directory listing.
+class MinidumpPathReader {
+ public:
+  explicit MinidumpPathReader(const Options& options)
+      : file_(NULL), next_path_(0) {
+    if (options.batch_list == "-") {
+      file_ = stdin;
+    } else if (!options.batch_list.empty()) {
+      file_ = fopen(options.batch_list.c_str(), "r");
+      if (!file_)
+        BPLOG(ERROR) << "Can't open " << options.batch_list;
+    } else {
+      ListDirectory(options.minidump_file);
+    }
+  }
+
+  ~MinidumpPathReader() {
+    if (file_ && file_ != stdin)
+      fclose(file_);
+  }
+
+  // Sets |path| to the next minidump path.  Returns false at the end.
+  // Reading from stdin blocks until the next line arrives.
+  bool Next(string* path) {
+    if (!file_) {
+      if (next_path_ == paths_.size())
+        return false;
+      *path = paths_[next_path_++];
+      return true;
+    }
+
+    char line[4096];
+    while (fgets(line, sizeof(line), file_)) {
+      size_t length = strlen(line);
+      while (length > 0 &&
+             (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+        line[--length] = '\0';
+      }
+      if (length > 0) {
+        *path = line;
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  // Collects the regular files in |directory|, sorted by name.
+  void ListDirectory(const string& directory) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+      BPLOG(ERROR) << "Can't read directory " << directory;
+      return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+      string path = directory + "/" + entry->d_name;
+      struct stat st;
+      if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+        paths_.push_back(path);
+    }
+    closedir(dir);
+    std::sort(paths_.begin(), paths_.end());
+  }
+
+  FILE* file_;
+  std::vector<string> paths_;
+  size_t next_path_;
+};
+
+// Prints the line that introduces each minidump's output in batch mode.
+// Structured output has no header, so that the stream holds nothing but
+// one result per minidump, in order; a minidump that could not be
+// processed is written as a JSON null or an empty message.
+void PrintBatchHeader(const Options& options,
+                      const string& minidump_file,
+                      bool processed) {
+  if (options.output_format == kOutputJSON) {
+    if (!processed)
+      printf("null\n");
+  } else if (options.output_format == kOutputProto) {
+    if (!processed)
+      putchar(0);
+  } else if (options.machine_readable) {
+    printf("Minidump|%s|%s\n", minidump_file.c_str(),
+           processed ? "OK" : "FAILED");
+  } else {
+    printf("%sMinidump %s%s\n", processed ? "" : "\n", minidump_file.c_str(),
+           processed ? "" : " could not be processed");
+  }
+}
+
+// One minidump of a batch, from being read to being printed.
+struct BatchJob {
+  string minidump_file;
+  std::unique_ptr<Minidump> dump;
+  ProcessState process_state;
+  // The key the result is to be kept under, and the result kept from an
+  // earlier run, if |cached| is set.
+  string cache_key;
+  string cached_result;
+  bool cached;
+  bool processed;
+  bool done;
+};
+
+// Prints the result of |job|, which has been processed.
+void PrintJobResult(const Options& options,
+                    const BatchJob& job,
+                    SourceLineResolverBase* resolver,
+                    ProcessResultCache* result_cache) {
+  if (job.cached) {
+    fwrite(job.cached_result.data(), 1, job.cached_result.size(), stdout);
+  } else {
+    PrintResult(options, job.process_state, resolver, result_cache,
+                job.cache_key);
+  }
+}
+
+// Processes |job| with |minidump_processor|, unless |result_cache| has
+// its result.
+void RunJob(const Options& options,
+            MinidumpProcessor* minidump_processor,
+            ProcessResultCache* result_cache,
+            BatchJob* job) {
+  job->cached = LookupResult(options, result_cache, job->minidump_file,
+                             &job->cache_key, &job->cached_result);
+  job->processed = job->cached ||
+                   ProcessMinidump(job->dump.get(), minidump_processor, NULL,
+                                   &job->process_state);
+}
+
+// Processes every minidump in |reader| with |symbolizer|, printing the
+// results in order.  With more than one worker, dumps are processed on
+// worker threads while a printer thread prints finished dumps, so that
+// slow dumps do not hold up reading the next paths.  Results are looked
+// up in and kept in |result_cache|, if it is not NULL.  Returns true if
+// every minidump was processed.
+bool ProcessBatch(const Options& options,
+                  MinidumpPathReader* reader,
+                  StackFrameSymbolizer* symbolizer,
+                  SourceLineResolverBase* resolver,
+                  ProcessResultCache* result_cache) {
+  if (options.batch_workers <= 1) {
+    MinidumpProcessor minidump_processor(symbolizer, false);
+    ConfigureProcessor(options, &minidump_processor);
+
+    // The next minidump is read ahead while the current one is processed.
+    bool all_processed = true;
+    BatchJob job;
+    string next_file;
+    bool has_next = reader->Next(&next_file);
+    while (has_next) {
+      job.minidump_file = next_file;
+      has_next = reader->Next(&next_file);
+      if (has_next)
+        Minidump::Prefetch(next_file);
+      job.dump.reset(new Minidump(job.minidump_file));
+      job.process_state.Clear();
+      RunJob(options, &minidump_processor, result_cache, &job);
+      PrintBatchHeader(options, job.minidump_file, job.processed);
+      if (job.processed)
+        PrintJobResult(options, job, resolver, result_cache);
+      fflush(stdout);
+      all_processed &= job.processed;
+    }
+    return all_processed;
+  }
+
+  // Jobs move from |pending| to the workers, and are printed in the order
+  // they appear in |unprinted|.  At most |max_unprinted| are held at once.
+  std::mutex mutex;
+  std::condition_variable pending_ready;
+  std::condition_variable job_done;
+  std::condition_variable job_printed;
+  std::deque<BatchJob*> pending;
+  std::deque<std::unique_ptr<BatchJob> > unprinted;
+  const size_t max_unprinted = 2 * options.batch_workers;
+  bool reading_done = false;
+  bool all_processed = true;
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < options.batch_workers; ++i) {
+    workers.push_back(std::thread([&]() {
+      MinidumpProcessor minidump_processor(symbolizer, false);
+      ConfigureProcessor(options, &minidump_processor);
+      for (;;) {
+        BatchJob* job;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          pending_ready.wait(lock, [&]() {
+            return reading_done || !pending.empty();
+          });
+          if (pending.empty())
+            return;
+          job = pending.front();
+          pending.pop_front();
+        }
+        RunJob(options, &minidump_processor, result_cache, job);
+        std::lock_guard<std::mutex> lock(mutex);
+        job->done = true;
+        job_done.notify_all();
+      }
+    }));
+  }
+
+  std::thread printer([&]() {
+    for (;;) {
+      std::unique_ptr<BatchJob> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        job_done.wait(lock, [&]() {
+          return (!unprinted.empty() && unprinted.front()->done) ||
+                 (reading_done && unprinted.empty());
+        });
+        if (unprinted.empty())
+          return;
+        job = std::move(unprinted.front());
+        unprinted.pop_front();
+        all_processed &= job->processed;
+      }
+      job_printed.notify_one();
+      PrintBatchHeader(options, job->minidump_file, job->processed);
+      if (job->processed)
+        PrintJobResult(options, *job, resolver, result_cache);
+      fflush(stdout);
+    }
+  });
+
+  // Minidumps are read ahead as they are queued for the workers.
+  string minidump_file;
+  while (reader->Next(&minidump_file)) {
+    Minidump::Prefetch(minidump_file);
+    std::unique_ptr<BatchJob> job(new BatchJob);
+    job->minidump_file = minidump_file;
+    job->dump.reset(new Minidump(minidump_file));
+    job->processed = false;
+    job->done = false;
+    std::unique_lock<std::mutex> lock(mutex);
+    job_printed.wait(lock, [&]() { return unprinted.size() < max_unprinted; });
+    pending.push_back(job.get());
+    unprinted.push_back(std::move(job));
+    pending_ready.notify_one();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    reading_done = true;
+  }
+  pending_ready.notify_all();
+  job_done.notify_all();
+
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+  printer.join();
+  return all_processed;
+}
+
+// Processes the minidumps of a batch, keeping symbols loaded from one dump
+// to the next.  Returns true if every minidump was processed.
+bool PrintMinidumpBatch(const Options& options) {
+  scoped_ptr<SimpleSymbolSupplier> symbol_supplier(
+      CreateSymbolSupplier(options));
+
+  // Several workers share one resolver, which must then allow modules to
+  // be loaded while the printer looks up others.  Fast symbol files hold
+  // modules serialized for FastSourceLineResolver.
+  bool fast_modules = !options.fast_symbol_cache_path.empty();
+  scoped_ptr<BasicSourceLineResolver> basic_resolver;
+  scoped_ptr<FastSourceLineResolver> fast_resolver;
+  scoped_ptr<ConcurrentSourceLineResolver> concurrent_resolver;
+  SourceLineResolverBase* resolver;
+  if (options.batch_workers > 1) {
+    concurrent_resolver.reset(new ConcurrentSourceLineResolver(
+        fast_modules ? ConcurrentSourceLineResolver::kFastModules
+                     : ConcurrentSourceLineResolver::kBasicModules));
+    resolver = concurrent_resolver.get();
+  } else if (fast_modules) {
+    fast_resolver.reset(new FastSourceLineResolver());
+    fast_resolver->set_module_cache_budget(options.module_cache_bytes);
+    resolver = fast_resolver.get();
+  } else {
+    basic_resolver.reset(new BasicSourceLineResolver());
+    basic_resolver->set_freeze_modules(true);
+    basic_resolver->set_module_cache_budget(options.module_cache_bytes);
+    resolver = basic_resolver.get();
+  }
+
+  MissingSymbolsCache missing_symbols;
+  StackFrameSymbolizer symbolizer(symbol_supplier.get(), resolver);
+  symbolizer.set_missing_symbols_cache(&missing_symbols);
+  symbolizer.set_persist_frame_info_cache(true);
+  symbolizer.set_cache_source_line_info(true);
+  symbolizer.set_frame_pointer_modules(options.frame_pointer_modules);
+  symbolizer.set_lazy_inline_frames(LazyInlineFrames(options));
+
+  scoped_ptr<ProcessResultCache> result_cache;
+  if (!options.result_cache_path.empty()) {
+    result_cache.reset(new ProcessResultCache(options.result_cache_path,
+                                              symbol_supplier.get()));
+  }
+
+  // Load the symbols the last batch used most while this one gets going.
+  SymbolWarmupManifest warmup_manifest;
+  if (!options.warmup_manifest_path.empty() &&
+      warmup_manifest.ReadFromFile(options.warmup_manifest_path)) {
+    warmup_manifest.StartPreload(&symbolizer);
+  }
+
+  MinidumpPathReader reader(options);
+  bool ok = ProcessBatch(options, &reader, &symbolizer, resolver,
+                         result_cache.get());
+
+  if (!options.warmup_manifest_path.empty()) {
+    warmup_manifest.RecordHottestModules(resolver, kWarmupManifestModules);
+    if (!warmup_manifest.WriteToFile(options.warmup_manifest_path)) {
+      fprintf(stderr, "Could not write symbol warmup manifest %s\n",
+              options.warmup_manifest_path.c_str());
+    }
+  }
+  return ok;
+}
+
 }  // namespace
 
 static void Usage(int argc, const char *argv[], bool error) {
   fprintf(error ? stderr : stdout,
           "Usage: %s [options] <minidump-file> [symbol-path ...]\n"
+          "       %s [options] <minidump-directory> [symbol-path ...]\n"
+          "       %s [options] -i <minidump-list> [symbol-path ...]\n"
           "\n"
-          "Output a stack trace for the provided minidump\n"
+          "Output a stack trace for the provided minidump, or for each\n"
+          "minidump in a directory or named in a list file, keeping symbols\n"
+          "loaded from one minidump to the next\n"
           "\n"
           "Options:\n"
           "\n"
           "  -m         Output in machine-readable format\n"
           "  -s         Output stack contents\n"
           "  -c         Output thread that causes crash or dump only\n"
-          "  -b         Brief of the thread that causes crash or dump\n",
+          "  -b         Brief of the thread that causes crash or dump\n"
+          "  -n <n>     Walk only the thread that causes crash or dump, to\n"
+          "             this many frames, as for a crash signature\n"
+          "  -o <fmt>   Output in a structured format: json, one line per\n"
+          "             minidump, or proto, a ProcessStateProto message\n"
+          "             (length-delimited in batch mode)\n"
+          "  -i <file>  Read minidump paths from this file, one per line,\n"
+          "             or from stdin if it is -\n"
+          "  -j <n>     Process this many minidumps of a batch at once\n"
+          "  -M <mb>    Limit the memory used by loaded symbols to this many\n"
+          "             megabytes, when processing one minidump at a time\n"
+          "  -L <mb>    Limit the minidump data held in memory to this many\n"
+          "             megabytes, scanning stacks less if needed\n"
+          "  -f <file>  Unwind callers in the module with this file name by\n"
+          "             frame pointer before CFI; may be repeated\n"
+          "  -S         Print where the time of processing each minidump\n"
+          "             went to stderr\n"
+          "  -x <name>  Find symbol files through the index file with this\n"
+          "             name in each symbol-path that has one\n"
+          "  -t <ms>    Look in every symbol-path at once, giving up on one\n"
+          "             that hasn't answered in this many milliseconds\n"
+          "  -g <secs>  Read the minidump while it is still being written,\n"
+          "             until it has not grown for this many seconds\n"
+          "  -F <dir>   Compile symbol files into fast symbol files in this\n"
+          "             directory, and resolve symbols from those; processes\n"
+          "             sharing the directory share the compiled files\n"
+          "  -R <dir>   Keep structured results in this directory, and print\n"
+          "             a kept result again while the minidump and the\n"
+          "             symbol files of its modules are unchanged\n"
+          "  -W <file>  Preload the symbols of the modules listed in this\n"
+          "             warmup manifest as a batch starts, and list the\n"
+          "             modules the batch used most in it when it ends\n"
+#ifdef __linux__
+          "  -u <url>   Download symbol files from this symbol server; may be\n"
+          "             repeated.  symbol-path arguments are then ignored\n"
+          "  -d <dir>   Directory to cache downloaded symbol files in\n"
+          "             (default: ./symbols)\n"
+          "  -l <mb>    Limit the symbol cache to this many megabytes\n"
+#endif  // __linux__
+          ,
+          google_breakpad::BaseName(argv[0]).c_str(),
+          google_breakpad::BaseName(argv[0]).c_str(),
           google_breakpad::BaseName(argv[0]).c_str());
 }
 
 static void SetupOptions(int argc, const char *argv[], Options* options) {
   int ch;
 
+  options->output_format = kOutputText;
   options->machine_readable = false;
   options->output_stack_contents = false;
   options->output_requesting_thread_only = false;
   options->brief = false;
+  options->growing_timeout_seconds = -1;
+  options->symbol_cache_path = "symbols";
+  options->symbol_cache_bytes = 0;
+  options->batch = false;
+  options->batch_workers = 1;
+  options->module_cache_bytes = 0;
+  options->print_stats = false;
+  options->signature_frames = 0;
+  options->memory_limit = 0;
+  options->symbol_probe_timeout_ms = 0;
 
-  while ((ch = getopt(argc, (char* const*)argv, "bchms")) != -1) {
+#ifdef __linux__
+  const char* optstring = "bcd:F:f:g:hi:j:L:l:M:mn:o:R:St:su:W:x:";
+#else
+  const char* optstring = "bcF:f:g:hi:j:L:M:mn:o:R:St:sW:x:";
+#endif  // __linux__
+  while ((ch = getopt(argc, (char* const*)argv, optstring)) != -1) {
     switch (ch) {
       case 'h':
         Usage(argc, argv, false);
@@ -166,9 +875,71 @@ static void SetupOptions(int argc, const char *argv[], Options* options) {
       case 'm':
         options->machine_readable = true;
         break;
+      case 'n':
+        options->signature_frames = atoi(optarg);
+        break;
+      case 'o':
+        if (strcmp(optarg, "json") == 0) {
+          options->output_format = kOutputJSON;
+        } else if (strcmp(optarg, "proto") == 0) {
+          options->output_format = kOutputProto;
+        } else {
+          fprintf(stderr, "%s: Unknown output format %s\n", argv[0], optarg);
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
       case 's':
         options->output_stack_contents = true;
         break;
+      case 'S':
+        options->print_stats = true;
+        break;
+      case 'i':
+        options->batch = true;
+        options->batch_list = optarg;
+        break;
+      case 'j':
+        options->batch_workers = atoi(optarg);
+        break;
+      case 'M':
+        options->module_cache_bytes =
+            static_cast<size_t>(strtoull(optarg, NULL, 10)) * 1024 * 1024;
+        break;
+      case 'L':
+        options->memory_limit = strtoull(optarg, NULL, 10) * 1024 * 1024;
+        break;
+      case 'f':
+        options->frame_pointer_modules.insert(optarg);
+        break;
+      case 'd':
+        options->symbol_cache_path = optarg;
+        break;
+      case 'l':
+        options->symbol_cache_bytes =
+            strtoull(optarg, NULL, 10) * 1024 * 1024;
+        break;
+      case 'u':
+        options->symbol_servers.push_back(optarg);
+        break;
+      case 'x':
+        options->symbol_index_file = optarg;
+        break;
+      case 't':
+        options->symbol_probe_timeout_ms = atoi(optarg);
+        break;
+      case 'F':
+        options->fast_symbol_cache_path = optarg;
+        break;
+      case 'g':
+        options->growing_timeout_seconds = std::max(atoi(optarg), 0);
+        break;
+      case 'R':
+        options->result_cache_path = optarg;
+        break;
+      case 'W':
+        options->warmup_manifest_path = optarg;
+        break;
 
       case '?':
         Usage(argc, argv, true);
@@ -177,15 +948,28 @@ static void SetupOptions(int argc, const char *argv[], Options* options) {
     }
   }
 
-  if ((argc - optind) == 0) {
-    fprintf(stderr, "%s: Missing minidump file\n", argv[0]);
+  if (!options->result_cache_path.empty() &&
+      options->output_format == kOutputText) {
+    fprintf(stderr, "%s: -R requires -o\n", argv[0]);
     Usage(argc, argv, true);
     exit(1);
   }
 
-  options->minidump_file = argv[optind];
+  // With a list of minidumps, every argument is a symbol path.
+  if (!options->batch) {
+    if ((argc - optind) == 0) {
+      fprintf(stderr, "%s: Missing minidump file\n", argv[0]);
+      Usage(argc, argv, true);
+      exit(1);
+    }
+
+    options->minidump_file = argv[optind++];
+    struct stat st;
+    options->batch = stat(options->minidump_file.c_str(), &st) == 0 &&
+                     S_ISDIR(st.st_mode);
+  }
 
-  for (int argi = optind + 1; argi < argc; ++argi)
+  for (int argi = optind; argi < argc; ++argi)
     options->symbol_paths.push_back(argv[argi]);
 }
 
@@ -193,5 +977,13 @@ int main(int argc, const char* argv[]) {
   Options options;
   SetupOptions(argc, argv, &options);
 
+  // Increase the maximum number of threads and regions.
+  MinidumpThreadList::set_max_threads(std::numeric_limits<uint32_t>::max());
+  MinidumpMemoryList::set_max_regions(std::numeric_limits<uint32_t>::max());
+  MinidumpMemory64List::set_max_regions(
+      std::numeric_limits<uint32_t>::max());
+
+  if (options.batch)
+    return PrintMinidumpBatch(options) ? 0 : 1;
   return PrintMinidumpProcess(options) ? 0 : 1;
 }
@@ -49,12 +49,15 @@
 
 namespace {
 
+using google_breakpad::DumpContext;
 using google_breakpad::Minidump;
+using google_breakpad::MinidumpBreadcrumbs;
 using google_breakpad::MinidumpContext;
 using google_breakpad::MinidumpCrashpadInfo;
 using google_breakpad::MinidumpException;
 using google_breakpad::MinidumpMemoryInfo;
 using google_breakpad::MinidumpMemoryInfoList;
+using google_breakpad::MinidumpMemory64List;
 using google_breakpad::MinidumpMemoryList;
 using google_breakpad::MinidumpMemoryRegion;
 using google_breakpad::MinidumpModule;
@@ -135,6 +138,56 @@ TEST_F(MinidumpTest, TestMinidumpFromStream) {
   //TODO: add more checks here
 }
 
+TEST_F(MinidumpTest, TestMinidumpReadAgain) {
+  Minidump minidump(minidump_file_);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpThreadList* thread_list = minidump.GetThreadList();
+  ASSERT_TRUE(thread_list != NULL);
+  MinidumpModuleList* module_list = minidump.GetModuleList();
+  ASSERT_TRUE(module_list != NULL);
+
+  // A second consumer of the same Minidump gets the streams already
+  // parsed.
+  ASSERT_TRUE(minidump.Read());
+  EXPECT_EQ(thread_list, minidump.GetThreadList());
+  EXPECT_EQ(module_list, minidump.GetModuleList());
+  EXPECT_EQ(2U, thread_list->thread_count());
+}
+
+TEST_F(MinidumpTest, TestMinidumpFromFileMapped) {
+  Minidump minidump(minidump_file_);
+  minidump.set_use_mmap(true);
+  ASSERT_TRUE(minidump.Read());
+  ASSERT_TRUE(minidump.IsInMemory());
+  const MDRawHeader* header = minidump.header();
+  ASSERT_NE(header, (MDRawHeader*)NULL);
+  ASSERT_EQ(header->signature, uint32_t(MD_HEADER_SIGNATURE));
+
+  MinidumpModuleList* md_module_list = minidump.GetModuleList();
+  ASSERT_TRUE(md_module_list != NULL);
+  const MinidumpModule* md_module = md_module_list->GetModuleAtIndex(0);
+  ASSERT_TRUE(md_module != NULL);
+  ASSERT_EQ("c:\\test_app.exe", md_module->code_file());
+  ASSERT_EQ("5A9832E5287241C1838ED98914E9B7FF1", md_module->debug_identifier());
+}
+
+TEST_F(MinidumpTest, TestMinidumpFromFileReadAhead) {
+  // Reading ahead only hints the kernel; the streams read are the same.
+  Minidump::Prefetch(minidump_file_);
+  Minidump::Prefetch(minidump_file_ + ".missing");
+  Minidump minidump(minidump_file_);
+  minidump.set_readahead(true);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpThreadList* thread_list = minidump.GetThreadList();
+  ASSERT_TRUE(thread_list != NULL);
+  EXPECT_EQ(2U, thread_list->thread_count());
+  MinidumpModuleList* md_module_list = minidump.GetModuleList();
+  ASSERT_TRUE(md_module_list != NULL);
+  const MinidumpModule* md_module = md_module_list->GetModuleAtIndex(0);
+  ASSERT_TRUE(md_module != NULL);
+  ASSERT_EQ("c:\\test_app.exe", md_module->code_file());
+}
+
 TEST_F(MinidumpTest, TestMinidumpWithCrashpadAnnotations) {
   string crashpad_minidump_file =
       string(getenv("srcdir") ? getenv("srcdir") : ".") +
@@ -258,6 +311,296 @@ TEST(Dump, OneMemory) {
   ASSERT_TRUE(memcmp("memory contents", region1_bytes, 15) == 0);
 }
 
+TEST(Dump, MemoryArray) {
+  Dump dump(0, kBigEndian);
+  Memory memory(dump, 0x1000);
+  memory.D32(0x01020304).D32(0x05060708).D64(0x1112131415161718ULL);
+  dump.Add(&memory);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+
+  MinidumpMemoryList* memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(memory_list != NULL);
+  MinidumpMemoryRegion* region = memory_list->GetMemoryRegionAtIndex(0);
+  ASSERT_TRUE(region != NULL);
+
+  uint32_t words32[4];
+  ASSERT_TRUE(region->GetMemoryArrayAtAddress(0x1000, words32, 4));
+  EXPECT_EQ(0x01020304U, words32[0]);
+  EXPECT_EQ(0x05060708U, words32[1]);
+  EXPECT_EQ(0x11121314U, words32[2]);
+  EXPECT_EQ(0x15161718U, words32[3]);
+
+  uint64_t words64[2];
+  ASSERT_TRUE(region->GetMemoryArrayAtAddress(0x1008, words64, 1));
+  EXPECT_EQ(0x1112131415161718ULL, words64[0]);
+  ASSERT_TRUE(region->GetMemoryArrayAtAddress(0x1010, words64, 0));
+  EXPECT_FALSE(region->GetMemoryArrayAtAddress(0x1004, words64, 2));
+  EXPECT_FALSE(region->GetMemoryArrayAtAddress(0xffc, words32, 1));
+  EXPECT_FALSE(region->GetMemoryArrayAtAddress(0x1010, words32, 1));
+}
+
+TEST(Dump, MemoryPages) {
+  Dump dump(0, kLittleEndian);
+  // Three pages and a bit, each page filled with its own byte, and a word
+  // that straddles the first two.
+  Memory memory(dump, 0x10000);
+  memory.Append(Minidump::kPageCachePageSize - 4, 'a')
+        .D64(0x6262626261616161ULL)
+        .Append(Minidump::kPageCachePageSize - 4, 'b')
+        .Append(Minidump::kPageCachePageSize, 'c')
+        .Append(16, 'd');
+  dump.Add(&memory);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpMemoryList* memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(memory_list != NULL);
+  MinidumpMemoryRegion* region = memory_list->GetMemoryRegionAtIndex(0);
+  ASSERT_TRUE(region != NULL);
+
+  // Room for two pages, less whatever other Minidumps still hold.
+  const uint64_t old_budget = Minidump::page_cache_budget();
+  const uint64_t other_bytes = Minidump::page_cache_bytes();
+  Minidump::set_page_cache_budget(other_bytes +
+                                  2 * Minidump::kPageCachePageSize);
+
+  uint64_t word;
+  ASSERT_TRUE(region->GetMemoryAtAddress(
+      0x10000 + Minidump::kPageCachePageSize - 4, &word));
+  EXPECT_EQ(0x6262626261616161ULL, word);
+  EXPECT_EQ(other_bytes + 2 * Minidump::kPageCachePageSize,
+            Minidump::page_cache_bytes());
+
+  // The first page is evicted for the third, and the last page is short.
+  uint8_t byte;
+  ASSERT_TRUE(region->GetMemoryAtAddress(
+      0x10000 + 2 * Minidump::kPageCachePageSize, &byte));
+  EXPECT_EQ('c', byte);
+  ASSERT_TRUE(region->GetMemoryAtAddress(
+      0x10000 + 3 * Minidump::kPageCachePageSize + 15, &byte));
+  EXPECT_EQ('d', byte);
+  EXPECT_EQ(other_bytes + Minidump::kPageCachePageSize + 16,
+            Minidump::page_cache_bytes());
+  ASSERT_TRUE(region->GetMemoryAtAddress(0x10000, &byte));
+  EXPECT_EQ('a', byte);
+
+  uint32_t words[3];
+  ASSERT_TRUE(region->GetMemoryArrayAtAddress(
+      0x10000 + 2 * Minidump::kPageCachePageSize - 4, words, 3));
+  EXPECT_EQ(0x62626262U, words[0]);
+  EXPECT_EQ(0x63636363U, words[1]);
+  EXPECT_EQ(0x63636363U, words[2]);
+  EXPECT_FALSE(region->GetMemoryAtAddress(
+      0x10000 + 3 * Minidump::kPageCachePageSize + 16, &byte));
+
+  // Reading the region whole doesn't go through the page cache.
+  const uint8_t* bytes = region->GetMemory();
+  ASSERT_TRUE(bytes != NULL);
+  EXPECT_EQ('d', bytes[3 * Minidump::kPageCachePageSize]);
+
+  Minidump::set_page_cache_budget(old_budget);
+}
+
+TEST(Dump, MemoryListLookup) {
+  Dump dump(0, kLittleEndian);
+  // Out of order, with a gap between the second and third regions.
+  Memory memory1(dump, 0x3000);
+  memory1.Append(0x1000, 'c');
+  Memory memory2(dump, 0x1000);
+  memory2.Append(0x1000, 'a');
+  Memory memory3(dump, 0x2000);
+  memory3.Append(0x800, 'b');
+  dump.Add(&memory1);
+  dump.Add(&memory2);
+  dump.Add(&memory3);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+
+  MinidumpMemoryList* memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(memory_list != NULL);
+  ASSERT_EQ(3U, memory_list->region_count());
+
+  EXPECT_EQ(NULL, memory_list->GetMemoryRegionForAddress(0xfff));
+  EXPECT_EQ(memory_list->GetMemoryRegionAtIndex(1),
+            memory_list->GetMemoryRegionForAddress(0x1000));
+  // Repeated lookups in the same region.
+  EXPECT_EQ(memory_list->GetMemoryRegionAtIndex(1),
+            memory_list->GetMemoryRegionForAddress(0x1ff8));
+  EXPECT_EQ(memory_list->GetMemoryRegionAtIndex(2),
+            memory_list->GetMemoryRegionForAddress(0x2000));
+  EXPECT_EQ(memory_list->GetMemoryRegionAtIndex(2),
+            memory_list->GetMemoryRegionForAddress(0x27ff));
+  EXPECT_EQ(NULL, memory_list->GetMemoryRegionForAddress(0x2800));
+  EXPECT_EQ(NULL, memory_list->GetMemoryRegionForAddress(0x2fff));
+  EXPECT_EQ(memory_list->GetMemoryRegionAtIndex(0),
+            memory_list->GetMemoryRegionForAddress(0x3000));
+  EXPECT_EQ(memory_list->GetMemoryRegionAtIndex(0),
+            memory_list->GetMemoryRegionForAddress(0x3fff));
+  EXPECT_EQ(NULL, memory_list->GetMemoryRegionForAddress(0x4000));
+}
+
+TEST(Dump, MemoryListOverlap) {
+  Dump dump(0, kLittleEndian);
+  Memory memory1(dump, 0x2000);
+  memory1.Append(0x1000, 'b');
+  Memory memory2(dump, 0x1000);
+  memory2.Append(0x1001, 'a');
+  dump.Add(&memory1);
+  dump.Add(&memory2);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+  ASSERT_TRUE(minidump.GetMemoryList() == NULL);
+}
+
+// Checks the memory of the MD_MEMORY_64_LIST_STREAM that the Memory64List
+// test writes, as |minidump| reads it.
+void CheckMemory64List(Minidump* minidump) {
+  ASSERT_TRUE(minidump->Read());
+  EXPECT_TRUE(minidump->GetMemoryList() == NULL);
+
+  MinidumpMemory64List* memory64_list = minidump->GetMemory64List();
+  ASSERT_TRUE(memory64_list != NULL);
+  ASSERT_EQ(3U, memory64_list->region_count());
+
+  // Each range's data follows the previous range's.
+  MinidumpMemoryRegion* region = memory64_list->GetMemoryRegionAtIndex(1);
+  ASSERT_TRUE(region != NULL);
+  EXPECT_EQ(0x1000U, region->GetBase());
+  EXPECT_EQ(0x1000U, region->GetSize());
+  uint32_t word;
+  ASSERT_TRUE(region->GetMemoryAtAddress(0x1ffc, &word));
+  EXPECT_EQ(0x64636261U, word);
+  uint8_t byte;
+  ASSERT_TRUE(region->GetMemoryAtAddress(0x1000, &byte));
+  EXPECT_EQ('a', byte);
+
+  EXPECT_EQ(NULL, memory64_list->GetMemoryRegionForAddress(0xfff));
+  EXPECT_EQ(region, memory64_list->GetMemoryRegionForAddress(0x1800));
+  EXPECT_EQ(memory64_list->GetMemoryRegionAtIndex(2),
+            memory64_list->GetMemoryRegionForAddress(0x27ff));
+  EXPECT_EQ(NULL, memory64_list->GetMemoryRegionForAddress(0x2800));
+  MinidumpMemoryRegion* last = memory64_list->GetMemoryRegionAtIndex(0);
+  EXPECT_EQ(last, memory64_list->GetMemoryRegionForAddress(0x3fff));
+  EXPECT_EQ(NULL, memory64_list->GetMemoryRegionForAddress(0x4000));
+  ASSERT_TRUE(last->GetMemoryAtAddress(0x3fff, &byte));
+  EXPECT_EQ('c', byte);
+
+  // The minidump finds full-memory regions when the memory list has none.
+  MinidumpMemoryRegion* third = minidump->GetMemoryRegionForAddress(0x2400);
+  ASSERT_TRUE(third != NULL);
+  ASSERT_TRUE(third->GetMemoryAtAddress(0x2400, &byte));
+  EXPECT_EQ('b', byte);
+}
+
+TEST(Dump, Memory64List) {
+  Dump dump(0, kLittleEndian);
+  Stream stream(dump, MD_MEMORY_64_LIST_STREAM);
+  Section data(dump);
+  stream.D64(3)                     // number_of_memory_ranges
+        .D64(data.file_offset())    // base_rva
+        .D64(0x3000).D64(0x1000)    // memory_ranges[0]
+        .D64(0x1000).D64(0x1000)    // memory_ranges[1]
+        .D64(0x2000).D64(0x800);    // memory_ranges[2]
+  data.Append(0x1000, 'c').Append(0xffc, 'a').D32(0x64636261)
+      .Append(0x800, 'b');
+  dump.Add(&stream);
+  dump.Add(&data);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+
+  // Read through the page cache, and straight out of the data in memory.
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  CheckMemory64List(&minidump);
+
+  Minidump in_memory(reinterpret_cast<const uint8_t*>(contents.data()),
+                     contents.size());
+  CheckMemory64List(&in_memory);
+}
+
+TEST(Dump, Memory64ListOverlap) {
+  Dump dump(0, kLittleEndian);
+  Stream stream(dump, MD_MEMORY_64_LIST_STREAM);
+  Section data(dump);
+  stream.D64(2)                     // number_of_memory_ranges
+        .D64(data.file_offset())    // base_rva
+        .D64(0x2000).D64(0x1000)    // memory_ranges[0]
+        .D64(0x1000).D64(0x1001);   // memory_ranges[1]
+  data.Append(0x2001, 'a');
+  dump.Add(&stream);
+  dump.Add(&data);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+  ASSERT_TRUE(minidump.GetMemory64List() == NULL);
+}
+
+TEST(Dump, OneMemoryInMemory) {
+  Dump dump(0, kBigEndian);
+  Memory memory(dump, 0x309d68010bd21b2cULL);
+  memory.D32(0x01020304).Append("memory contents");
+  dump.Add(&memory);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(contents.data());
+  Minidump minidump(data, contents.size());
+  ASSERT_TRUE(minidump.Read());
+  ASSERT_TRUE(minidump.IsInMemory());
+  ASSERT_EQ(1U, minidump.GetDirectoryEntryCount());
+
+  MinidumpMemoryList* memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(memory_list != NULL);
+  ASSERT_EQ(1U, memory_list->region_count());
+
+  MinidumpMemoryRegion* region1 = memory_list->GetMemoryRegionAtIndex(0);
+  ASSERT_EQ(0x309d68010bd21b2cULL, region1->GetBase());
+  ASSERT_EQ(19U, region1->GetSize());
+  const uint8_t* region1_bytes = region1->GetMemory();
+  // The region points into the caller's buffer rather than a copy.
+  ASSERT_GE(region1_bytes, data);
+  ASSERT_LE(region1_bytes + 19, data + contents.size());
+  ASSERT_TRUE(memcmp("memory contents", region1_bytes + 4, 15) == 0);
+
+  // Values are still byte-swapped on access, including unaligned ones.
+  uint32_t value;
+  ASSERT_TRUE(region1->GetMemoryAtAddress(0x309d68010bd21b2cULL, &value));
+  EXPECT_EQ(0x01020304U, value);
+  uint16_t value16;
+  ASSERT_TRUE(region1->GetMemoryAtAddress(0x309d68010bd21b2dULL, &value16));
+  EXPECT_EQ(0x0203U, value16);
+
+  // Reads past the end of the buffer fail.
+  ASSERT_EQ(NULL, minidump.GetDataAtOffset(0, contents.size() + 1));
+}
+
 // One thread --- and its requisite entourage.
 TEST(Dump, OneThread) {
   Dump dump(0, kLittleEndian);
@@ -316,6 +659,8 @@ TEST(Dump, OneThread) {
   uint32_t thread_id;
   ASSERT_TRUE(md_thread->GetThreadID(&thread_id));
   ASSERT_EQ(0xa898f11bU, thread_id);
+  EXPECT_EQ(md_thread, thread_list->GetThreadByID(0xa898f11b));
+  EXPECT_EQ(NULL, thread_list->GetThreadByID(0xa898f11c));
   MinidumpMemoryRegion* md_stack = md_thread->GetMemory();
   ASSERT_TRUE(md_stack != NULL);
   ASSERT_EQ(0x2326a0faU, md_stack->GetBase());
@@ -331,6 +676,13 @@ TEST(Dump, OneThread) {
   ASSERT_TRUE(md_context->GetInstructionPointer(&eip));
   EXPECT_EQ(kExpectedEIP, eip);
 
+  DumpContext::Registers registers;
+  ASSERT_TRUE(md_context->GetRegisters(&registers));
+  EXPECT_EQ((uint32_t) MD_CONTEXT_X86, registers.cpu);
+  EXPECT_EQ(sizeof(uint32_t), registers.pointer_size);
+  EXPECT_EQ(kExpectedEIP, registers.instruction_pointer);
+  EXPECT_EQ(raw_context.esp, registers.stack_pointer);
+
   const MDRawContextX86* md_raw_context = md_context->GetContextX86();
   ASSERT_TRUE(md_raw_context != NULL);
   ASSERT_EQ((uint32_t) (MD_CONTEXT_X86_INTEGER | MD_CONTEXT_X86_CONTROL),
@@ -570,6 +922,15 @@ TEST(Dump, OneModule) {
   ASSERT_EQ(0x34571371U, md_raw_module->checksum);
   ASSERT_TRUE(memcmp(&md_raw_module->version_info, &fixed_file_info,
                      sizeof(fixed_file_info)) == 0);
+
+  EXPECT_EQ(md_module, md_module_list->GetModuleAtSequence(0));
+  EXPECT_EQ(md_module,
+            md_module_list->GetModuleForAddress(0xa90206ca83eb2852ULL));
+  EXPECT_EQ(md_module,
+            md_module_list->GetModuleForAddress(0xa90206cb31906b0eULL));
+  EXPECT_FALSE(md_module_list->GetModuleForAddress(0xa90206cb31906b0fULL));
+  EXPECT_EQ(md_module, md_module_list->GetModuleForCodeFile("single module"));
+  EXPECT_FALSE(md_module_list->GetModuleForCodeFile("other module"));
 }
 
 // Test that a module with a MDCVInfoELF CV record is handled properly.
@@ -825,6 +1186,146 @@ TEST(Dump, OneSystemInfo) {
   ASSERT_EQ("GenuineIntel", *md_system_info->GetCPUVendor());
 }
 
+// Reads back strings of UTF-16 code units written in |endianness|.
+void CheckReadStrings(
+    google_breakpad::test_assembler::Endianness endianness) {
+  Dump dump(0, endianness);
+  Stream stream(dump, MD_SYSTEM_INFO_STREAM);
+  stream.Append(sizeof(MDRawSystemInfo), 0);
+
+  // Long enough to take the ASCII fast path, with an odd tail.
+  const string ascii = "libPetulantPierogi-1.2.3.so";
+  Section ascii_string(dump);
+  ascii_string.D32(ascii.size() * 2);
+  for (size_t i = 0; i < ascii.size(); ++i)
+    ascii_string.D16(ascii[i]);
+
+  // "Aé€" followed by U+10000 as a surrogate pair.
+  Section unicode_string(dump);
+  unicode_string.D32(10).D16('A').D16(0xe9).D16(0x20ac)
+      .D16(0xd800).D16(0xdc00);
+
+  // A low surrogate with no high one before it.
+  Section invalid_string(dump);
+  invalid_string.D32(8).D16('a').D16('b').D16('c').D16(0xdc00);
+
+  Section empty_string(dump);
+  empty_string.D32(0);
+
+  dump.Add(&stream);
+  dump.Add(&ascii_string);
+  dump.Add(&unicode_string);
+  dump.Add(&invalid_string);
+  dump.Add(&empty_string);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+
+  // Read through the stream, and straight out of the data in memory.
+  istringstream minidump_stream(contents);
+  Minidump streamed(minidump_stream);
+  Minidump in_memory(reinterpret_cast<const uint8_t*>(contents.data()),
+                     contents.size());
+  Minidump* minidumps[] = { &streamed, &in_memory };
+  for (size_t i = 0; i < sizeof(minidumps) / sizeof(minidumps[0]); ++i) {
+    Minidump* minidump = minidumps[i];
+    ASSERT_TRUE(minidump->Read());
+
+    // The same string is reused across reads.
+    string value;
+    ASSERT_TRUE(minidump->ReadString(unicode_string.file_offset().Value(),
+                                     &value));
+    EXPECT_EQ("A\xc3\xa9\xe2\x82\xac\xf0\x90\x80\x80", value);
+    ASSERT_TRUE(minidump->ReadString(ascii_string.file_offset().Value(),
+                                     &value));
+    EXPECT_EQ(ascii, value);
+    ASSERT_TRUE(minidump->ReadString(empty_string.file_offset().Value(),
+                                     &value));
+    EXPECT_EQ("", value);
+    EXPECT_FALSE(minidump->ReadString(invalid_string.file_offset().Value(),
+                                      &value));
+
+    string* owned = minidump->ReadString(ascii_string.file_offset().Value());
+    ASSERT_TRUE(owned != NULL);
+    EXPECT_EQ(ascii, *owned);
+    delete owned;
+    EXPECT_EQ(NULL, minidump->ReadString(invalid_string.file_offset().Value()));
+  }
+}
+
+TEST(Dump, ReadString) {
+  CheckReadStrings(kLittleEndian);
+}
+
+TEST(Dump, ReadStringBigEndian) {
+  CheckReadStrings(kBigEndian);
+}
+
+// Appends a breadcrumb holding |data| to |stream|.
+void AppendBreadcrumb(Stream* stream, uint64_t timestamp_ns,
+                      uint32_t category, const string& data) {
+  stream->D64(timestamp_ns).D32(category).D32(data.size())
+      .Append(data).Append(MD_BREADCRUMB_DATA_SIZE - data.size(), 0);
+}
+
+TEST(Dump, Breadcrumbs) {
+  Dump dump(0, kBigEndian);
+  Stream stream(dump, MD_BREADCRUMB_STREAM);
+  stream.D32(MD_BREADCRUMB_VERSION).D32(2);
+  stream.D32(0x1234).D32(2).D64(7);
+  AppendBreadcrumb(&stream, 1000, 1, "rpc sent");
+  AppendBreadcrumb(&stream, 2000, 2, string("a\0b", 3));
+  stream.D32(0x5678).D32(0).D64(0);
+  dump.Add(&stream);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+
+  MinidumpBreadcrumbs* md_breadcrumbs = minidump.GetBreadcrumbs();
+  ASSERT_TRUE(md_breadcrumbs != NULL);
+  const vector<MinidumpBreadcrumbs::Thread>* threads =
+      md_breadcrumbs->threads();
+  ASSERT_EQ(2U, threads->size());
+
+  const MinidumpBreadcrumbs::Thread& first = threads->at(0);
+  EXPECT_EQ(0x1234U, first.thread_id);
+  EXPECT_EQ(7U, first.recorded_count);
+  ASSERT_EQ(2U, first.breadcrumbs.size());
+  EXPECT_EQ(1000U, first.breadcrumbs[0].timestamp_ns);
+  EXPECT_EQ(1U, first.breadcrumbs[0].category);
+  EXPECT_EQ("rpc sent",
+            MinidumpBreadcrumbs::DataToString(first.breadcrumbs[0]));
+  EXPECT_EQ(2000U, first.breadcrumbs[1].timestamp_ns);
+  EXPECT_EQ("a\\x00b",
+            MinidumpBreadcrumbs::DataToString(first.breadcrumbs[1]));
+
+  EXPECT_EQ(0x5678U, threads->at(1).thread_id);
+  EXPECT_TRUE(threads->at(1).breadcrumbs.empty());
+}
+
+TEST(Dump, BreadcrumbsTruncated) {
+  Dump dump(0, kLittleEndian);
+  Stream stream(dump, MD_BREADCRUMB_STREAM);
+  stream.D32(MD_BREADCRUMB_VERSION).D32(1);
+  // The thread claims more breadcrumbs than the stream holds.
+  stream.D32(0x1234).D32(3).D64(3);
+  AppendBreadcrumb(&stream, 1000, 1, "only one");
+  dump.Add(&stream);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+  EXPECT_TRUE(minidump.GetBreadcrumbs() == NULL);
+}
+
 TEST(Dump, BigDump) {
   Dump dump(0, kLittleEndian);
 
@@ -1086,6 +1587,66 @@ TEST(Dump, OneMemoryInfo) {
   ASSERT_EQ(kRegionSize, info2->GetSize());
 }
 
+TEST(Dump, MemoryInfoLazy) {
+  Dump dump(0, kLittleEndian);
+  Stream stream(dump, MD_MEMORY_INFO_LIST_STREAM);
+
+  // Add the MDRawMemoryInfoList header.
+  const uint64_t kNumberOfEntries = 2;
+  stream.D32(sizeof(MDRawMemoryInfoList))  // size_of_header
+        .D32(sizeof(MDRawMemoryInfo))      // size_of_entry
+        .D64(kNumberOfEntries);            // number_of_entries
+
+  // Two entries that overlap, which makes the list unusable for address
+  // lookups but doesn't keep individual entries from being read lazily.
+  const uint64_t kBaseAddress = 0x1000;
+  const uint64_t kRegionSize = 0x2000;
+  for (uint64_t i = 0; i < kNumberOfEntries; ++i) {
+    stream.D64(kBaseAddress + i * kRegionSize / 2)   // base_address
+          .D64(kBaseAddress)                         // allocation_base
+          .D32(MD_MEMORY_PROTECT_EXECUTE_READWRITE)  // allocation_protection
+          .D32(0)                                    // __alignment1
+          .D64(kRegionSize)                          // region_size
+          .D32(MD_MEMORY_STATE_COMMIT)               // state
+          .D32(MD_MEMORY_PROTECT_READONLY)           // protection
+          .D32(MD_MEMORY_TYPE_PRIVATE)               // type
+          .D32(0);                                   // __alignment2
+  }
+
+  dump.Add(&stream);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+
+  // Eagerly, the overlap makes the whole stream fail.
+  istringstream eager_stream(contents);
+  Minidump eager_minidump(eager_stream);
+  ASSERT_TRUE(eager_minidump.Read());
+  ASSERT_TRUE(eager_minidump.GetMemoryInfoList() == NULL);
+
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  minidump.set_lazy_parsing(true);
+  ASSERT_TRUE(minidump.Read());
+
+  MinidumpMemoryInfoList* info_list = minidump.GetMemoryInfoList();
+  ASSERT_TRUE(info_list != NULL);
+  ASSERT_EQ(2U, info_list->info_count());
+
+  const MinidumpMemoryInfo* info2 = info_list->GetMemoryInfoAtIndex(1);
+  ASSERT_TRUE(info2 != NULL);
+  ASSERT_EQ(kBaseAddress + kRegionSize / 2, info2->GetBase());
+  ASSERT_EQ(kRegionSize, info2->GetSize());
+  ASSERT_FALSE(info2->IsWritable());
+
+  const MinidumpMemoryInfo* info1 = info_list->GetMemoryInfoAtIndex(0);
+  ASSERT_TRUE(info1 != NULL);
+  ASSERT_EQ(kBaseAddress, info1->GetBase());
+
+  ASSERT_TRUE(info_list->GetMemoryInfoForAddress(kBaseAddress) == NULL);
+}
+
 TEST(Dump, OneExceptionX86) {
   Dump dump(0, kLittleEndian);
 
@@ -0,0 +1,147 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// missing_symbols_cache.cc: Remembers modules that have no symbols.
+//
+// See missing_symbols_cache.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "google_breakpad/processor/missing_symbols_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "google_breakpad/processor/code_module.h"
+#include "processor/pathname_stripper.h"
+
+namespace google_breakpad {
+
+MissingSymbolsCache::MissingSymbolsCache(time_t ttl_seconds,
+                                         size_t max_entries)
+    : ttl_seconds_(ttl_seconds),
+      max_entries_(std::max(max_entries, static_cast<size_t>(1))) {}
+
+bool MissingSymbolsCache::IsMissing(const CodeModule* module) {
+  Key key;
+  if (!GetKey(module, &key))
+    return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<Key, time_t>::iterator it = entries_.find(key);
+  if (it == entries_.end())
+    return false;
+  if (Now() - it->second >= ttl_seconds_) {
+    entries_.erase(it);
+    return false;
+  }
+  return true;
+}
+
+void MissingSymbolsCache::AddMissing(const CodeModule* module) {
+  Key key;
+  if (!GetKey(module, &key))
+    return;
+
+  time_t now = Now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<Key, time_t>::iterator it = entries_.find(key);
+  if (it != entries_.end()) {
+    it->second = now;
+    return;
+  }
+  if (entries_.size() >= max_entries_)
+    TrimLocked(now);
+  entries_[key] = now;
+}
+
+void MissingSymbolsCache::Remove(const CodeModule* module) {
+  Key key;
+  if (!GetKey(module, &key))
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.erase(key);
+}
+
+void MissingSymbolsCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+}
+
+size_t MissingSymbolsCache::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+time_t MissingSymbolsCache::Now() const {
+  return time(NULL);
+}
+
+// static
+bool MissingSymbolsCache::GetKey(const CodeModule* module, Key* key) {
+  if (!module)
+    return false;
+  key->first = PathnameStripper::File(module->debug_file());
+  key->second = module->debug_identifier();
+  return !key->first.empty() && !key->second.empty();
+}
+
+void MissingSymbolsCache::TrimLocked(time_t now) {
+  for (std::map<Key, time_t>::iterator it = entries_.begin();
+       it != entries_.end();) {
+    if (now - it->second >= ttl_seconds_)
+      entries_.erase(it++);
+    else
+      ++it;
+  }
+  if (entries_.size() < max_entries_)
+    return;
+
+  // Nothing has expired, so drop the older half.
+  std::vector<time_t> times;
+  times.reserve(entries_.size());
+  for (std::map<Key, time_t>::const_iterator it = entries_.begin();
+       it != entries_.end(); ++it) {
+    times.push_back(it->second);
+  }
+  std::vector<time_t>::iterator median = times.begin() + times.size() / 2;
+  std::nth_element(times.begin(), median, times.end());
+  time_t cutoff = *median;
+  for (std::map<Key, time_t>::iterator it = entries_.begin();
+       it != entries_.end();) {
+    if (it->second <= cutoff)
+      entries_.erase(it++);
+    else
+      ++it;
+  }
+}
+
+}  // namespace google_breakpad
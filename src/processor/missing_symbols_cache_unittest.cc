@@ -0,0 +1,147 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// missing_symbols_cache_unittest.cc: Unit tests for MissingSymbolsCache.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/missing_symbols_cache.h"
+#include "processor/basic_code_module.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::MissingSymbolsCache;
+using google_breakpad::scoped_ptr;
+
+// A MissingSymbolsCache whose clock the test sets.
+class TestMissingSymbolsCache : public MissingSymbolsCache {
+ public:
+  TestMissingSymbolsCache(time_t ttl_seconds, size_t max_entries)
+      : MissingSymbolsCache(ttl_seconds, max_entries), now_(1000) {}
+
+  void Advance(time_t seconds) { now_ += seconds; }
+
+ protected:
+  virtual time_t Now() const { return now_; }
+
+ private:
+  time_t now_;
+};
+
+BasicCodeModule* NewModule(const string& code_file,
+                           const string& debug_file,
+                           const string& debug_identifier) {
+  return new BasicCodeModule(0x1000, 0x1000, code_file, "", debug_file,
+                             debug_identifier, "");
+}
+
+TEST(MissingSymbolsCacheTest, KeyedByDebugFileAndIdentifier) {
+  MissingSymbolsCache cache;
+  scoped_ptr<BasicCodeModule> module(
+      NewModule("c:\\windows\\ntdll.dll", "ntdll.pdb", "AAAA1"));
+  scoped_ptr<BasicCodeModule> same(
+      NewModule("d:\\other\\ntdll.dll", "c:\\build\\ntdll.pdb", "AAAA1"));
+  scoped_ptr<BasicCodeModule> other_build(
+      NewModule("c:\\windows\\ntdll.dll", "ntdll.pdb", "BBBB1"));
+  scoped_ptr<BasicCodeModule> no_identifier(
+      NewModule("c:\\windows\\ntdll.dll", "ntdll.pdb", ""));
+
+  EXPECT_FALSE(cache.IsMissing(module.get()));
+  cache.AddMissing(module.get());
+  EXPECT_TRUE(cache.IsMissing(module.get()));
+  EXPECT_TRUE(cache.IsMissing(same.get()));
+  EXPECT_FALSE(cache.IsMissing(other_build.get()));
+
+  cache.AddMissing(no_identifier.get());
+  EXPECT_FALSE(cache.IsMissing(no_identifier.get()));
+  EXPECT_EQ(1U, cache.size());
+  EXPECT_FALSE(cache.IsMissing(NULL));
+
+  cache.Remove(same.get());
+  EXPECT_FALSE(cache.IsMissing(module.get()));
+  EXPECT_EQ(0U, cache.size());
+}
+
+TEST(MissingSymbolsCacheTest, EntriesExpire) {
+  TestMissingSymbolsCache cache(60, 100);
+  scoped_ptr<BasicCodeModule> module(NewModule("a.so", "a.so", "A0"));
+
+  cache.AddMissing(module.get());
+  cache.Advance(59);
+  EXPECT_TRUE(cache.IsMissing(module.get()));
+  cache.Advance(1);
+  EXPECT_FALSE(cache.IsMissing(module.get()));
+  EXPECT_EQ(0U, cache.size());
+}
+
+TEST(MissingSymbolsCacheTest, BoundedSize) {
+  TestMissingSymbolsCache cache(60, 4);
+  scoped_ptr<BasicCodeModule> modules[6];
+  for (int i = 0; i < 6; ++i) {
+    char name[16];
+    snprintf(name, sizeof(name), "lib%d.so", i);
+    modules[i].reset(NewModule(name, name, "A0"));
+  }
+
+  // Expired entries make room first.
+  cache.AddMissing(modules[0].get());
+  cache.Advance(60);
+  for (int i = 1; i < 4; ++i)
+    cache.AddMissing(modules[i].get());
+  cache.Advance(1);
+  cache.AddMissing(modules[4].get());
+  EXPECT_EQ(4U, cache.size());
+  EXPECT_FALSE(cache.IsMissing(modules[0].get()));
+
+  // Without expired entries, the oldest are dropped.
+  cache.AddMissing(modules[5].get());
+  EXPECT_FALSE(cache.IsMissing(modules[1].get()));
+  EXPECT_TRUE(cache.IsMissing(modules[4].get()));
+  EXPECT_TRUE(cache.IsMissing(modules[5].get()));
+  EXPECT_GE(4U, cache.size());
+
+  cache.Clear();
+  EXPECT_EQ(0U, cache.size());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,205 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// module_address_filter.cc: Fast prefilter for stack scanning.
+//
+// See module_address_filter.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/module_address_filter.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/code_modules.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// A module address range [base, end).
+struct Range {
+  uint64_t base;
+  uint64_t end;
+};
+
+}  // namespace
+
+ModuleAddressFilter::ModuleAddressFilter()
+    : range_count_(0),
+      all_32_(false) {
+}
+
+void ModuleAddressFilter::Init(const CodeModules* modules) {
+  range_count_ = 0;
+  all_32_ = false;
+  if (!modules) {
+    return;
+  }
+
+  // GetModuleAtSequence returns modules in address order, so overlapping
+  // and adjacent modules can be merged in a single pass.
+  std::vector<Range> ranges;
+  unsigned int module_count = modules->module_count();
+  ranges.reserve(module_count);
+  for (unsigned int sequence = 0; sequence < module_count; ++sequence) {
+    const CodeModule* module = modules->GetModuleAtSequence(sequence);
+    if (!module || module->size() == 0) {
+      continue;
+    }
+    uint64_t base = module->base_address();
+    uint64_t end = base + module->size();
+    if (end < base) {
+      // Clamp modules that run off the end of the address space.
+      end = ~static_cast<uint64_t>(0);
+    }
+    if (!ranges.empty() && base <= ranges.back().end) {
+      ranges.back().end = std::max(ranges.back().end, end);
+    } else {
+      Range range = {base, end};
+      ranges.push_back(range);
+    }
+  }
+
+  if (ranges.size() > kMaxRanges) {
+    // Keep the kMaxRanges - 1 largest gaps between ranges, and merge across
+    // all of the others.
+    std::vector<size_t> gaps(ranges.size() - 1);
+    for (size_t i = 0; i < gaps.size(); ++i) {
+      gaps[i] = i;
+    }
+    std::partial_sort(gaps.begin(), gaps.begin() + (kMaxRanges - 1),
+                      gaps.end(),
+                      [&ranges](size_t a, size_t b) {
+                        return ranges[a + 1].base - ranges[a].end >
+                               ranges[b + 1].base - ranges[b].end;
+                      });
+    gaps.resize(kMaxRanges - 1);
+    std::sort(gaps.begin(), gaps.end());
+
+    std::vector<Range> merged;
+    size_t first = 0;
+    for (size_t i = 0; i <= gaps.size(); ++i) {
+      size_t last = i < gaps.size() ? gaps[i] : ranges.size() - 1;
+      Range range = {ranges[first].base, ranges[last].end};
+      merged.push_back(range);
+      first = last + 1;
+    }
+    ranges.swap(merged);
+  }
+
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    bases_[i] = ranges[i].base;
+    sizes_[i] = ranges[i].end - ranges[i].base;
+
+    const uint64_t kLimit32 = static_cast<uint64_t>(1) << 32;
+    if (ranges[i].base >= kLimit32) {
+      bases_32_[i] = 0;
+      sizes_32_[i] = 0;
+    } else {
+      uint64_t end = std::min(ranges[i].end, kLimit32);
+      if (end - ranges[i].base == kLimit32) {
+        all_32_ = true;
+      }
+      bases_32_[i] = static_cast<uint32_t>(ranges[i].base);
+      sizes_32_[i] = static_cast<uint32_t>(end - ranges[i].base);
+    }
+  }
+  range_count_ = ranges.size();
+}
+
+uint32_t ModuleAddressFilter::Filter(const uint32_t* words,
+                                     size_t count) const {
+  assert(count <= kMaxWords);
+  if (all_32_) {
+    return count == kMaxWords ? ~0U : (1U << count) - 1;
+  }
+
+  uint32_t mask = 0;
+  size_t i = 0;
+#if defined(__SSE2__)
+  // Four words at a time.  SSE2 only has signed comparisons, so flip the
+  // sign bits to compare unsigned values.
+  const __m128i sign = _mm_set1_epi32(static_cast<int>(0x80000000U));
+  const __m128i one = _mm_set1_epi32(1);
+  for (; i + 4 <= count; i += 4) {
+    __m128i addresses = _mm_sub_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i)), one);
+    __m128i in_range = _mm_setzero_si128();
+    for (size_t range = 0; range < range_count_; ++range) {
+      __m128i offsets = _mm_sub_epi32(
+          addresses, _mm_set1_epi32(static_cast<int>(bases_32_[range])));
+      __m128i sizes = _mm_set1_epi32(static_cast<int>(sizes_32_[range]));
+      in_range = _mm_or_si128(
+          in_range, _mm_cmplt_epi32(_mm_xor_si128(offsets, sign),
+                                    _mm_xor_si128(sizes, sign)));
+    }
+    mask |= static_cast<uint32_t>(
+                _mm_movemask_ps(_mm_castsi128_ps(in_range))) << i;
+  }
+#endif  // __SSE2__
+  for (; i < count; ++i) {
+    uint32_t address = words[i] - 1;
+    uint32_t in_range = 0;
+    for (size_t range = 0; range < range_count_; ++range) {
+      in_range |= address - bases_32_[range] < sizes_32_[range];
+    }
+    mask |= in_range << i;
+  }
+  return mask;
+}
+
+uint32_t ModuleAddressFilter::Filter(const uint64_t* words,
+                                     size_t count) const {
+  assert(count <= kMaxWords);
+
+  // SSE2 has no 64-bit comparisons, so this is left as a branch-free loop
+  // for the compiler to vectorize where the target allows it.
+  uint32_t mask = 0;
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t address = words[i] - 1;
+    uint32_t in_range = 0;
+    for (size_t range = 0; range < range_count_; ++range) {
+      in_range |= address - bases_[range] < sizes_[range];
+    }
+    mask |= in_range << i;
+  }
+  return mask;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,89 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// module_address_filter.h: Fast prefilter for stack scanning.
+//
+// When a stackwalker resorts to scanning the stack, it looks at each stack
+// word to decide whether it could be a return address.  Most words aren't,
+// and the full check (a module lookup followed by a symbol lookup) is
+// expensive.  ModuleAddressFilter summarizes the address ranges of the
+// loaded modules as a handful of enclosing ranges, and tests a whole block
+// of stack words against them at once.  The test is conservative: a word
+// that fails it is certainly not in any module, while a word that passes
+// it still needs the full check.
+
+#ifndef PROCESSOR_MODULE_ADDRESS_FILTER_H__
+#define PROCESSOR_MODULE_ADDRESS_FILTER_H__
+
+#include <stddef.h>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+class CodeModules;
+
+class ModuleAddressFilter {
+ public:
+  // The most words that one call to Filter can test.
+  static const size_t kMaxWords = 32;
+
+  // The number of ranges that the modules' address ranges are summarized
+  // as.  Modules are merged into ranges across the smallest gaps first.
+  static const size_t kMaxRanges = 4;
+
+  ModuleAddressFilter();
+
+  // Summarizes the address ranges of modules, which may be NULL.
+  void Init(const CodeModules* modules);
+
+  // Returns a mask in which bit i is set if words[i] - 1 may lie within a
+  // module.  (A return address points after the call instruction, so it's
+  // checked with 1 subtracted, as the stackwalkers do.)  count must not
+  // exceed kMaxWords.
+  uint32_t Filter(const uint32_t* words, size_t count) const;
+  uint32_t Filter(const uint64_t* words, size_t count) const;
+
+ private:
+  // The ranges, each as a base and a size, so that an address is in range
+  // i when address - bases_[i] < sizes_[i].
+  uint64_t bases_[kMaxRanges];
+  uint64_t sizes_[kMaxRanges];
+  size_t range_count_;
+
+  // The same ranges restricted to the 32-bit address space, for Filter on
+  // 32-bit words.  If any range covers the whole 32-bit address space,
+  // all_32_ is set instead, since its size doesn't fit in 32 bits.
+  uint32_t bases_32_[kMaxRanges];
+  uint32_t sizes_32_[kMaxRanges];
+  bool all_32_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_MODULE_ADDRESS_FILTER_H__
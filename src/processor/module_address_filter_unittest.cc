@@ -0,0 +1,132 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// module_address_filter_unittest.cc: Unit tests for ModuleAddressFilter.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/module_address_filter.h"
+
+#include "breakpad_googletest_includes.h"
+#include "processor/stackwalker_unittest_utils.h"
+
+namespace {
+
+using google_breakpad::ModuleAddressFilter;
+
+TEST(ModuleAddressFilter, NoModules) {
+  ModuleAddressFilter filter;
+  filter.Init(NULL);
+  uint64_t words[] = { 0x1000, 0x2000 };
+  EXPECT_EQ(0U, filter.Filter(words, 2));
+}
+
+TEST(ModuleAddressFilter, Words64) {
+  MockCodeModule module1(0x10000, 0x1000, "module1", "version1");
+  MockCodeModule module2(0x7f0000000000ULL, 0x10000, "module2", "version2");
+  MockCodeModules modules;
+  modules.Add(&module1);
+  modules.Add(&module2);
+
+  ModuleAddressFilter filter;
+  filter.Init(&modules);
+
+  // The filter checks word - 1, like the stack scanner.
+  uint64_t words[] = {
+    0x10000,               // address 0xffff, just below module1
+    0x10001,               // address 0x10000, the base of module1
+    0x11000,               // address 0x10fff, the end of module1
+    0x11001,               // just past module1
+    0,                     // wraps to the top of the address space
+    0x7f0000000800ULL,     // in module2
+    0x7ffc00000000ULL,     // stack-like, above module2
+  };
+  EXPECT_EQ(0x26U, filter.Filter(words, sizeof(words) / sizeof(words[0])));
+}
+
+TEST(ModuleAddressFilter, Words32) {
+  MockCodeModule module1(0x40000000, 0x10000, "module1", "version1");
+  MockCodeModule module2(0x50000000, 0x10000, "module2", "version2");
+  MockCodeModules modules;
+  modules.Add(&module1);
+  modules.Add(&module2);
+
+  ModuleAddressFilter filter;
+  filter.Init(&modules);
+
+  uint32_t words[ModuleAddressFilter::kMaxWords];
+  uint32_t expected = 0;
+  for (size_t i = 0; i < ModuleAddressFilter::kMaxWords; ++i) {
+    // Alternate between addresses in the modules and between them, so that
+    // both the vectorized and the scalar paths see both outcomes.
+    switch (i % 3) {
+      case 0: words[i] = 0x40000001 + i; expected |= 1U << i; break;
+      case 1: words[i] = 0x48000000 + i; break;
+      case 2: words[i] = 0x50000001 + i; expected |= 1U << i; break;
+    }
+  }
+  EXPECT_EQ(expected, filter.Filter(words, ModuleAddressFilter::kMaxWords));
+  EXPECT_EQ(expected & 0x1f, filter.Filter(words, 5));
+}
+
+TEST(ModuleAddressFilter, MergesToMaxRanges) {
+  // More separate modules than the filter has ranges: the filter must still
+  // accept every address in every module.
+  const size_t kModuleCount = ModuleAddressFilter::kMaxRanges * 3;
+  MockCodeModule* module_storage[kModuleCount];
+  MockCodeModules modules;
+  for (size_t i = 0; i < kModuleCount; ++i) {
+    // Gaps of varying sizes between the modules.
+    module_storage[i] = new MockCodeModule(0x100000 * (i + 1) * (i + 1),
+                                           0x1000, "module", "version");
+    modules.Add(module_storage[i]);
+  }
+
+  ModuleAddressFilter filter;
+  filter.Init(&modules);
+
+  uint64_t words[kModuleCount * 2];
+  for (size_t i = 0; i < kModuleCount; ++i) {
+    words[i * 2] = module_storage[i]->base_address() + 1;
+    words[i * 2 + 1] = module_storage[i]->base_address() + 0x1000;
+  }
+  uint32_t all = (1U << (kModuleCount * 2)) - 1;
+  EXPECT_EQ(all, filter.Filter(words, kModuleCount * 2));
+
+  // Addresses below the first module and above the last are still rejected.
+  uint64_t outside[] = { 0x1000, 0xffffffffffff0000ULL };
+  EXPECT_EQ(0U, filter.Filter(outside, 2));
+
+  for (size_t i = 0; i < kModuleCount; ++i) {
+    delete module_storage[i];
+  }
+}
+
+}  // namespace
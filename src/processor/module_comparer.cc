@@ -110,7 +110,7 @@ bool ModuleComparer::CompareModule(const BasicModule *basic_module,
 
   // Compare functions_:
   {
-    RangeMap<MemAddr, linked_ptr<BasicFunc> >::MapConstIterator iter1;
+    RangeMap<MemAddr, BasicFunc*>::MapConstIterator iter1;
     StaticRangeMap<MemAddr, FastFunc>::MapConstIterator iter2;
     iter1 = basic_module->functions_.map_.begin();
     iter2 = fast_module->functions_.map_.begin();
@@ -119,7 +119,7 @@ bool ModuleComparer::CompareModule(const BasicModule *basic_module,
       ASSERT_TRUE(iter1->first == iter2.GetKey());
       ASSERT_TRUE(iter1->second.base() == iter2.GetValuePtr()->base());
       ASSERT_TRUE(CompareFunction(
-          iter1->second.entry().get(), iter2.GetValuePtr()->entryptr()));
+          iter1->second.entry(), iter2.GetValuePtr()->entryptr()));
       ++iter1;
       ++iter2;
     }
@@ -129,7 +129,7 @@ bool ModuleComparer::CompareModule(const BasicModule *basic_module,
 
   // Compare public_symbols_:
   {
-    AddressMap<MemAddr, linked_ptr<BasicPubSymbol> >::MapConstIterator iter1;
+    AddressMap<MemAddr, BasicPubSymbol*>::MapConstIterator iter1;
     StaticAddressMap<MemAddr, FastPubSymbol>::MapConstIterator iter2;
     iter1 = basic_module->public_symbols_.map_.begin();
     iter2 = fast_module->public_symbols_.map_.begin();
@@ -137,7 +137,7 @@ bool ModuleComparer::CompareModule(const BasicModule *basic_module,
           && iter2 != fast_module->public_symbols_.map_.end()) {
       ASSERT_TRUE(iter1->first == iter2.GetKey());
       ASSERT_TRUE(ComparePubSymbol(
-          iter1->second.get(), iter2.GetValuePtr()));
+          iter1->second, iter2.GetValuePtr()));
       ++iter1;
       ++iter2;
     }
@@ -200,7 +200,7 @@ bool ModuleComparer::CompareFunction(const BasicFunc *basic_func,
   ASSERT_TRUE(basic_func->size == fast_func->size);
 
   // compare range map of lines:
-  RangeMap<MemAddr, linked_ptr<BasicLine> >::MapConstIterator iter1;
+  RangeMap<MemAddr, BasicLine*>::MapConstIterator iter1;
   StaticRangeMap<MemAddr, FastLine>::MapConstIterator iter2;
   iter1 = basic_func->lines.map_.begin();
   iter2 = fast_func->lines.map_.begin();
@@ -208,7 +208,7 @@ bool ModuleComparer::CompareFunction(const BasicFunc *basic_func,
       && iter2 != fast_func->lines.map_.end()) {
     ASSERT_TRUE(iter1->first == iter2.GetKey());
     ASSERT_TRUE(iter1->second.base() == iter2.GetValuePtr()->base());
-    ASSERT_TRUE(CompareLine(iter1->second.entry().get(),
+    ASSERT_TRUE(CompareLine(iter1->second.entry(),
                             iter2.GetValuePtr()->entryptr()));
     ++iter1;
     ++iter2;
@@ -262,17 +262,17 @@ bool ModuleComparer::CompareWFI(const WindowsFrameInfo& wfi1,
 
 // Compare ContainedRangeMap
 bool ModuleComparer::CompareCRM(
-    const ContainedRangeMap<MemAddr, linked_ptr<WFI> >* basic_crm,
+    const ContainedRangeMap<MemAddr, WFI*>* basic_crm,
     const StaticContainedRangeMap<MemAddr, char>* fast_crm) const {
   ASSERT_TRUE(basic_crm->base_ == fast_crm->base_);
 
-  if (!basic_crm->entry_.get() || !fast_crm->entry_ptr_) {
+  if (!basic_crm->entry_ || !fast_crm->entry_ptr_) {
     // empty entry:
-    ASSERT_TRUE(!basic_crm->entry_.get() && !fast_crm->entry_ptr_);
+    ASSERT_TRUE(!basic_crm->entry_ && !fast_crm->entry_ptr_);
   } else {
     WFI newwfi;
     newwfi.CopyFrom(fast_resolver_->CopyWFI(fast_crm->entry_ptr_));
-    ASSERT_TRUE(CompareWFI(*(basic_crm->entry_.get()), newwfi));
+    ASSERT_TRUE(CompareWFI(*basic_crm->entry_, newwfi));
   }
 
   if ((!basic_crm->map_ || basic_crm->map_->empty())
@@ -280,7 +280,7 @@ bool ModuleComparer::CompareCRM(
     ASSERT_TRUE((!basic_crm->map_ || basic_crm->map_->empty())
                && fast_crm->map_.empty());
   } else {
-    ContainedRangeMap<MemAddr, linked_ptr<WFI> >::MapConstIterator iter1;
+    ContainedRangeMap<MemAddr, WFI*>::MapConstIterator iter1;
     StaticContainedRangeMap<MemAddr, char>::MapConstIterator iter2;
     iter1 = basic_crm->map_->begin();
     iter2 = fast_crm->map_.begin();
@@ -84,7 +84,7 @@ class ModuleComparer {
   bool CompareWFI(const WindowsFrameInfo&, const WindowsFrameInfo&) const;
 
   // Compare ContainedRangeMap
-  bool CompareCRM(const ContainedRangeMap<MemAddr, linked_ptr<WFI> >*,
+  bool CompareCRM(const ContainedRangeMap<MemAddr, WFI*>*,
                   const StaticContainedRangeMap<MemAddr, char>*) const;
 
   FastSourceLineResolver *fast_resolver_;
@@ -50,11 +50,25 @@ class ModuleFactory {
 
 class BasicModuleFactory : public ModuleFactory {
  public:
+  BasicModuleFactory() : load_thread_count_(1), freeze_modules_(false) { }
   virtual ~BasicModuleFactory() { }
   virtual BasicSourceLineResolver::Module* CreateModule(
       const string& name) const {
-    return new BasicSourceLineResolver::Module(name);
+    return new BasicSourceLineResolver::Module(name, load_thread_count_,
+                                               freeze_modules_);
   }
+
+  void set_load_thread_count(int load_thread_count) {
+    load_thread_count_ = load_thread_count;
+  }
+
+  void set_freeze_modules(bool freeze_modules) {
+    freeze_modules_ = freeze_modules;
+  }
+
+ private:
+  int load_thread_count_;
+  bool freeze_modules_;
 };
 
 class FastModuleFactory : public ModuleFactory {
@@ -38,33 +38,307 @@
 
 #include "processor/module_serializer.h"
 
+#include <assert.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <map>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "common/scoped_ptr.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
 #include "google_breakpad/processor/code_module.h"
 #include "google_breakpad/processor/fast_source_line_resolver.h"
 #include "processor/basic_code_module.h"
-#include "processor/linked_ptr.h"
+#include "processor/fast_symbol_file.h"
 #include "processor/logging.h"
 #include "processor/map_serializers.h"
 #include "processor/simple_serializer.h"
+#include "processor/static_map_search_index-inl.h"
 #include "processor/windows_frame_info.h"
 
 namespace google_breakpad {
 
+using std::vector;
+
+namespace {
+
+// CompileSymbolFileData stops reading a symbol file after as many parse
+// errors as BasicSourceLineResolver::Module::LoadMapFromMemory does.
+const int kCompileMaxErrorsBeforeBailing = 100;
+
+// Serialized values are kept in blocks of at least this size, so that
+// storing them never has to copy the ones already kept.
+const size_t kCompiledValueBlockSize = 1 << 20;
+
+// A map entry gathered by CompileSymbolFileData: its key, or for a range
+// map its base and size, and the |length| bytes of its serialized value.
+struct CompiledEntry {
+  MemAddr key;
+  MemAddr size;
+  const char* value;
+  size_t length;
+};
+
+template<typename Key>
+bool CompiledKeyLess(const CompiledEntry& a, const CompiledEntry& b) {
+  return static_cast<Key>(a.key) < static_cast<Key>(b.key);
+}
+
+template<typename Key>
+bool CompiledKeyEqual(const CompiledEntry& a, const CompiledEntry& b) {
+  return static_cast<Key>(a.key) == static_cast<Key>(b.key);
+}
+
+// Sorts |entries| by key and keeps the first one given for each key, as
+// std::map::insert does.  Returns the number of entries dropped.
+template<typename Key>
+size_t KeepFirstPerKey(vector<CompiledEntry>* entries) {
+  std::stable_sort(entries->begin(), entries->end(), CompiledKeyLess<Key>);
+  size_t count = entries->size();
+  entries->erase(std::unique(entries->begin(), entries->end(),
+                             CompiledKeyEqual<Key>),
+                 entries->end());
+  return count - entries->size();
+}
+
+// Sorts |entries| by key and keeps the last one given for each key, as
+// assigning through std::map::operator[] does.
+template<typename Key>
+void KeepLastPerKey(vector<CompiledEntry>* entries) {
+  std::stable_sort(entries->begin(), entries->end(), CompiledKeyLess<Key>);
+  size_t kept = 0;
+  for (size_t i = 0; i < entries->size(); ++i) {
+    if (i + 1 < entries->size() &&
+        CompiledKeyEqual<Key>((*entries)[i], (*entries)[i + 1])) {
+      continue;
+    }
+    (*entries)[kept++] = (*entries)[i];
+  }
+  entries->resize(kept);
+}
+
+// Keeps the ranges in |entries| that RangeMap::StoreRange would accept if
+// they were stored in order, sorted by address.  Symbol files list most
+// ranges in ascending order, which is checked without building a map.
+void KeepExclusiveRanges(vector<CompiledEntry>* entries) {
+  size_t kept = 0;
+  size_t i = 0;
+  for (; i < entries->size(); ++i) {
+    const CompiledEntry entry = (*entries)[i];
+    if (entry.size == 0 || entry.key + (entry.size - 1) < entry.key)
+      continue;
+    if (kept > 0) {
+      const CompiledEntry& last = (*entries)[kept - 1];
+      if (entry.key < last.key)
+        break;
+      if (entry.key <= last.key + (last.size - 1))
+        continue;
+    }
+    (*entries)[kept++] = entry;
+  }
+  if (i == entries->size()) {
+    entries->resize(kept);
+    return;
+  }
+
+  // Out of order ranges: replay the rest against the ranges kept so far,
+  // keyed by high address like RangeMap.
+  std::map<MemAddr, CompiledEntry> ranges;
+  for (size_t j = 0; j < kept; ++j) {
+    const CompiledEntry& entry = (*entries)[j];
+    ranges.insert(ranges.end(),
+                  std::make_pair(entry.key + (entry.size - 1), entry));
+  }
+  for (; i < entries->size(); ++i) {
+    const CompiledEntry& entry = (*entries)[i];
+    if (entry.size == 0 || entry.key + (entry.size - 1) < entry.key)
+      continue;
+    MemAddr high = entry.key + (entry.size - 1);
+    std::map<MemAddr, CompiledEntry>::const_iterator iterator_base =
+        ranges.lower_bound(entry.key);
+    std::map<MemAddr, CompiledEntry>::const_iterator iterator_high =
+        ranges.lower_bound(high);
+    if (iterator_base != iterator_high ||
+        (iterator_high != ranges.end() && iterator_high->second.key <= high)) {
+      continue;
+    }
+    ranges.insert(iterator_high, std::make_pair(high, entry));
+  }
+  entries->clear();
+  for (const auto& range : ranges)
+    entries->push_back(range.second);
+}
+
+// Returns the size of |entries| in the StdMapSerializer layout, with a
+// StaticMapSearchIndex if |search_index|.
+template<typename Key>
+size_t CompiledStdMapSize(const vector<CompiledEntry>& entries,
+                          bool search_index) {
+  size_t size = (1 + entries.size()) * sizeof(uint64_t) +
+                entries.size() * sizeof(Key);
+  if (search_index)
+    size += StaticMapSearchIndex<Key>::SizeOf(entries.size());
+  for (const CompiledEntry& entry : entries)
+    size += entry.length;
+  return size;
+}
+
+// Writes |entries| in the StdMapSerializer layout.  Returns the address
+// after the final byte.
+template<typename Key>
+char* WriteCompiledStdMap(const vector<CompiledEntry>& entries,
+                          bool search_index, char* dest) {
+  char* start_address = dest;
+  dest = SimpleSerializer<uint64_t>::Write(entries.size(), dest);
+  uint64_t* offsets = reinterpret_cast<uint64_t*>(dest);
+  dest += sizeof(uint64_t) * entries.size();
+  const Key* keys = reinterpret_cast<const Key*>(dest);
+  char* key_address = dest;
+  dest += sizeof(Key) * entries.size();
+  char* index_address = dest;
+  if (search_index)
+    dest += StaticMapSearchIndex<Key>::SizeOf(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    offsets[i] = static_cast<uint64_t>(dest - start_address);
+    key_address = SimpleSerializer<Key>::Write(
+        static_cast<Key>(entries[i].key), key_address);
+    memcpy(dest, entries[i].value, entries[i].length);
+    dest += entries[i].length;
+  }
+  if (search_index)
+    StaticMapSearchIndex<Key>::Write(keys, entries.size(), index_address);
+  return dest;
+}
+
+// Returns the size of |entries| in the RangeMapSerializer layout, with a
+// StaticMapSearchIndex if |search_index|.
+size_t CompiledRangeMapSize(const vector<CompiledEntry>& entries,
+                            bool search_index) {
+  size_t size = (1 + entries.size()) * sizeof(uint64_t) +
+                entries.size() * 2 * sizeof(MemAddr);
+  if (search_index)
+    size += StaticMapSearchIndex<MemAddr>::SizeOf(entries.size());
+  for (const CompiledEntry& entry : entries)
+    size += entry.length;
+  return size;
+}
+
+// Writes |entries| in the RangeMapSerializer layout.  Returns the address
+// after the final byte.
+char* WriteCompiledRangeMap(const vector<CompiledEntry>& entries,
+                            bool search_index, char* dest) {
+  char* start_address = dest;
+  dest = SimpleSerializer<uint64_t>::Write(entries.size(), dest);
+  uint64_t* offsets = reinterpret_cast<uint64_t*>(dest);
+  dest += sizeof(uint64_t) * entries.size();
+  const MemAddr* keys = reinterpret_cast<const MemAddr*>(dest);
+  char* key_address = dest;
+  dest += sizeof(MemAddr) * entries.size();
+  char* index_address = dest;
+  if (search_index)
+    dest += StaticMapSearchIndex<MemAddr>::SizeOf(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const CompiledEntry& entry = entries[i];
+    offsets[i] = static_cast<uint64_t>(dest - start_address);
+    key_address = SimpleSerializer<MemAddr>::Write(
+        entry.key + (entry.size - 1), key_address);
+    dest = SimpleSerializer<MemAddr>::Write(entry.key, dest);
+    memcpy(dest, entry.value, entry.length);
+    dest += entry.length;
+  }
+  if (search_index)
+    StaticMapSearchIndex<MemAddr>::Write(keys, entries.size(), index_address);
+  return dest;
+}
+
+}  // namespace
+
+struct ModuleSerializer::CompileState {
+  CompileState()
+      : block_free(NULL),
+        block_left(0),
+        function(NULL),
+        num_errors(0),
+        parse_errors(0),
+        inline_errors(0) {}
+
+  // Serializes |value| into |value_blocks| and returns its entry.
+  template<typename Value>
+  CompiledEntry AddValue(const Value& value, MemAddr key, MemAddr size) {
+    size_t length = SimpleSerializer<Value>::SizeOf(value);
+    if (length > block_left) {
+      block_left = std::max(length, kCompiledValueBlockSize);
+      value_blocks.push_back(std::unique_ptr<char[]>(new char[block_left]));
+      block_free = value_blocks.back().get();
+    }
+    CompiledEntry entry = {key, size, block_free, length};
+    SimpleSerializer<Value>::Write(value, block_free);
+    block_free += length;
+    block_left -= length;
+    return entry;
+  }
+
+  // Returns the entry for the null terminated |text|, which stays in the
+  // symbol data.
+  static CompiledEntry AddText(const char* text, MemAddr key, MemAddr size) {
+    CompiledEntry entry = {key, size, text, strlen(text) + 1};
+    return entry;
+  }
+
+  // Serialized functions, public symbols and inline origins.  File names
+  // and CFI rules are left in the symbol data.
+  vector<std::unique_ptr<char[]> > value_blocks;
+  char* block_free;
+  size_t block_left;
+  vector<CompiledEntry> files;
+  vector<CompiledEntry> functions;
+  vector<CompiledEntry> public_symbols;
+  // The STACK WIN records.
+  Arena windows_frame_info_arena;
+  ContainedRangeMap<MemAddr, WindowsFrameInfo*>
+      windows_frame_info[WindowsFrameInfo::STACK_INFO_LAST];
+  vector<CompiledEntry> cfi_initial_rules;
+  vector<CompiledEntry> cfi_delta_rules;
+  vector<CompiledEntry> inline_origins;
+  // The function the line and INLINE records being read belong to, which
+  // is allocated in |function_arena| along with its records.  The arena is
+  // cleared as each function is closed.
+  Arena function_arena;
+  Function* function;
+  int num_errors;
+  // Errors counted towards kCompileMaxErrorsBeforeBailing.
+  int parse_errors;
+  // Like BasicSourceLineResolver, errors in inline records don't mark the
+  // module corrupt.
+  int inline_errors;
+};
+
 // Definition of static member variables in SimplerSerializer<Funcion> and
 // SimplerSerializer<Inline>, which are declared in file
 // "simple_serializer-inl.h"
-RangeMapSerializer<MemAddr, linked_ptr<BasicSourceLineResolver::Line>>
+RangeMapSerializer<MemAddr, BasicSourceLineResolver::Line*>
     SimpleSerializer<BasicSourceLineResolver::Function>::range_map_serializer_;
-ContainedRangeMapSerializer<MemAddr,
-                            linked_ptr<BasicSourceLineResolver::Inline>>
+NestedRangeIndexSerializer<MemAddr, BasicSourceLineResolver::Inline*>
     SimpleSerializer<
-        BasicSourceLineResolver::Function>::inline_range_map_serializer_;
+        BasicSourceLineResolver::Function>::inline_index_serializer_;
+
+void ModuleSerializer::set_search_index(bool search_index) {
+  search_index_ = search_index;
+  files_serializer_.set_search_index(search_index);
+  functions_serializer_.set_search_index(search_index);
+  pubsym_serializer_.set_search_index(search_index);
+  cfi_init_rules_serializer_.set_search_index(search_index);
+  cfi_delta_rules_serializer_.set_search_index(search_index);
+  inline_origin_serializer_.set_search_index(search_index);
+}
 
 size_t ModuleSerializer::SizeOf(const BasicSourceLineResolver::Module& module) {
   size_t total_size_alloc_ = 0;
@@ -123,6 +397,14 @@ char* ModuleSerializer::Write(const BasicSourceLineResolver::Module& module,
 
 char* ModuleSerializer::Serialize(const BasicSourceLineResolver::Module& module,
                                   size_t* size) {
+  // A frozen module's records are no longer in the maps serialized here.
+  if (module.IsFrozen()) {
+    BPLOG(ERROR) << "ModuleSerializer: cannot serialize frozen module "
+                 << module.name_;
+    if (size) *size = 0;
+    return NULL;
+  }
+
   // Compute size of memory to allocate.
   const size_t size_to_alloc = SizeOf(module);
 
@@ -169,14 +451,21 @@ bool ModuleSerializer::SerializeModuleAndLoadIntoFastResolver(
   }
   BPLOG(INFO) << "Serialized Symbol Size " << size;
 
+  return LoadIntoFastResolver(iter->first, symbol_data.get(), size,
+                              fast_resolver);
+}
+
+// static
+bool ModuleSerializer::LoadIntoFastResolver(
+    const string& name, const char* symbol_data, size_t size,
+    FastSourceLineResolver* fast_resolver) {
   // Copy the data into string.
   // Must pass string to LoadModuleUsingMapBuffer(), instead of passing char* to
   // LoadModuleUsingMemoryBuffer(), because of data ownership/lifetime issue.
-  string symbol_data_string(symbol_data.get(), size);
-  symbol_data.reset();
+  string symbol_data_string(symbol_data, size);
 
   scoped_ptr<CodeModule> code_module(
-      new BasicCodeModule(0, 0, iter->first, "", "", "", ""));
+      new BasicCodeModule(0, 0, name, "", "", "", ""));
 
   return fast_resolver->LoadModuleUsingMapBuffer(code_module.get(),
                                                  symbol_data_string);
@@ -184,16 +473,61 @@ bool ModuleSerializer::SerializeModuleAndLoadIntoFastResolver(
 
 void ModuleSerializer::ConvertAllModules(
     const BasicSourceLineResolver* basic_resolver,
-    FastSourceLineResolver* fast_resolver) {
+    FastSourceLineResolver* fast_resolver,
+    int thread_count) {
   // Check for NULL pointer.
   if (!basic_resolver || !fast_resolver)
     return;
 
   // Traverse module list in basic resolver.
   BasicSourceLineResolver::ModuleMap::const_iterator iter;
-  iter = basic_resolver->modules_->begin();
-  for (; iter != basic_resolver->modules_->end(); ++iter)
-    SerializeModuleAndLoadIntoFastResolver(iter, fast_resolver);
+  if (thread_count <= 1) {
+    iter = basic_resolver->modules_->begin();
+    for (; iter != basic_resolver->modules_->end(); ++iter)
+      SerializeModuleAndLoadIntoFastResolver(iter, fast_resolver);
+    return;
+  }
+
+  // Serializing only reads the modules, so each thread serializes the
+  // modules it takes with a serializer of its own.  The fast resolver is
+  // not thread safe, so the results are loaded afterwards, in order.
+  std::vector<BasicSourceLineResolver::ModuleMap::const_iterator> modules;
+  for (iter = basic_resolver->modules_->begin();
+       iter != basic_resolver->modules_->end(); ++iter) {
+    modules.push_back(iter);
+  }
+  std::vector<std::unique_ptr<char[]>> serialized(modules.size());
+  std::vector<size_t> sizes(modules.size());
+  std::atomic<size_t> next_module(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count && i < static_cast<int>(modules.size());
+       ++i) {
+    threads.emplace_back([&]() {
+      ModuleSerializer serializer;
+      serializer.set_search_index(search_index_);
+      size_t index;
+      while ((index = next_module++) < modules.size()) {
+        const BasicSourceLineResolver::Module* basic_module =
+            dynamic_cast<const BasicSourceLineResolver::Module*>(
+                modules[index]->second);
+        serialized[index].reset(
+            serializer.Serialize(*basic_module, &sizes[index]));
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (size_t i = 0; i < modules.size(); ++i) {
+    BPLOG(INFO) << "Converting symbol " << modules[i]->first;
+    if (!serialized[i]) {
+      BPLOG(ERROR) << "Serialization failed for module: "
+                   << modules[i]->first;
+      continue;
+    }
+    LoadIntoFastResolver(modules[i]->first, serialized[i].get(), sizes[i],
+                         fast_resolver);
+  }
 }
 
 bool ModuleSerializer::ConvertOneModule(
@@ -226,4 +560,349 @@ char* ModuleSerializer::SerializeSymbolFileData(const string& symbol_data,
   return Serialize(*module, size);
 }
 
+char* ModuleSerializer::CompileSymbolFileData(char* symbol_data,
+                                              size_t symbol_data_size,
+                                              size_t* size) {
+  CompileState state;
+
+  // Prepare the buffer the way LoadMapFromMemory does.
+  if (symbol_data_size > 0) {
+    size_t last_null_terminator = symbol_data_size - 1;
+    symbol_data[last_null_terminator] = '\0';
+    while (last_null_terminator > 0 &&
+           symbol_data[last_null_terminator - 1] == '\0') {
+      last_null_terminator--;
+    }
+    bool has_null_terminator_in_the_middle = false;
+    for (size_t i = 0; i < last_null_terminator; i++) {
+      if (symbol_data[i] == '\0') {
+        symbol_data[i] = '_';
+        has_null_terminator_in_the_middle = true;
+      }
+    }
+    if (has_null_terminator_in_the_middle) {
+      BasicSourceLineResolver::Module::LogParseError(
+          "Null terminator is not expected in the middle of the symbol data",
+          0, &state.num_errors);
+    }
+    CompileRecords(symbol_data, &state);
+  }
+
+  KeepFirstPerKey<int>(&state.files);
+  KeepExclusiveRanges(&state.functions);
+  size_t duplicate_public_symbols =
+      KeepFirstPerKey<MemAddr>(&state.public_symbols);
+  if (duplicate_public_symbols > 0) {
+    BPLOG(ERROR) << duplicate_public_symbols
+                 << " PUBLIC records have the address of an earlier one";
+    state.num_errors += duplicate_public_symbols;
+  }
+  KeepExclusiveRanges(&state.cfi_initial_rules);
+  KeepLastPerKey<MemAddr>(&state.cfi_delta_rules);
+  KeepFirstPerKey<int>(&state.inline_origins);
+
+  int map_index = 0;
+  map_sizes_[map_index++] =
+      CompiledStdMapSize<int>(state.files, search_index_);
+  map_sizes_[map_index++] =
+      CompiledRangeMapSize(state.functions, search_index_);
+  map_sizes_[map_index++] =
+      CompiledStdMapSize<MemAddr>(state.public_symbols, search_index_);
+  for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i)
+    map_sizes_[map_index++] = wfi_serializer_.SizeOf(
+        &state.windows_frame_info[i]);
+  map_sizes_[map_index++] =
+      CompiledRangeMapSize(state.cfi_initial_rules, search_index_);
+  map_sizes_[map_index++] =
+      CompiledStdMapSize<MemAddr>(state.cfi_delta_rules, search_index_);
+  map_sizes_[map_index++] =
+      CompiledStdMapSize<int>(state.inline_origins, search_index_);
+
+  size_t size_to_alloc = SimpleSerializer<bool>::SizeOf(false) +
+                         kNumberMaps_ * sizeof(uint64_t) +
+                         SimpleSerializer<char>::SizeOf(0);
+  for (int i = 0; i < kNumberMaps_; ++i)
+    size_to_alloc += map_sizes_[i];
+
+  char* serialized_data = new char[size_to_alloc];
+  char* dest = SimpleSerializer<bool>::Write(state.num_errors > 0,
+                                             serialized_data);
+  memcpy(dest, map_sizes_, kNumberMaps_ * sizeof(uint64_t));
+  dest += kNumberMaps_ * sizeof(uint64_t);
+  dest = WriteCompiledStdMap<int>(state.files, search_index_, dest);
+  dest = WriteCompiledRangeMap(state.functions, search_index_, dest);
+  dest = WriteCompiledStdMap<MemAddr>(state.public_symbols, search_index_,
+                                     dest);
+  for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i)
+    dest = wfi_serializer_.Write(&state.windows_frame_info[i], dest);
+  dest = WriteCompiledRangeMap(state.cfi_initial_rules, search_index_, dest);
+  dest = WriteCompiledStdMap<MemAddr>(state.cfi_delta_rules, search_index_,
+                                     dest);
+  dest = WriteCompiledStdMap<int>(state.inline_origins, search_index_, dest);
+  dest = SimpleSerializer<char>::Write(0, dest);
+
+  const size_t size_written = static_cast<size_t>(dest - serialized_data);
+  if (size_to_alloc != size_written) {
+    BPLOG(ERROR) << "size_to_alloc differs from size_written: "
+                 << size_to_alloc << " vs " << size_written;
+  }
+  if (size)
+    *size = size_to_alloc;
+  return serialized_data;
+}
+
+bool ModuleSerializer::CompileSymbolFile(const string& symbol_file,
+                                         const string& fast_symbol_file) {
+  char* symbol_data;
+  size_t symbol_data_size;
+  if (!SourceLineResolverBase::ReadSymbolFile(symbol_file, &symbol_data,
+                                              &symbol_data_size)) {
+    return false;
+  }
+  scoped_array<char> symbol_data_owner(symbol_data);
+
+  // MODULE <os> <cpu> <id> <filename>, which compiling overwrites.
+  string module_id;
+  if (strncmp(symbol_data, "MODULE ", 7) == 0) {
+    const char* id = symbol_data + 7;
+    for (int field = 0; field < 2 && id; ++field) {
+      id = strchr(id, ' ');
+      if (id)
+        ++id;
+    }
+    if (id)
+      module_id.assign(id, strcspn(id, " \r\n"));
+  }
+  if (module_id.empty()) {
+    BPLOG(ERROR) << "No MODULE record with an identifier in " << symbol_file;
+    return false;
+  }
+
+  size_t size;
+  scoped_array<char> serialized(
+      CompileSymbolFileData(symbol_data, symbol_data_size, &size));
+  symbol_data_owner.reset();
+
+  FILE* file = fopen(fast_symbol_file.c_str(), "wb");
+  if (!file) {
+    BPLOG(ERROR) << "Could not open " << fast_symbol_file;
+    return false;
+  }
+  bool written = FastSymbolFile::Write(module_id, serialized.get(), size,
+                                       file);
+  if (fclose(file) != 0)
+    written = false;
+  return written;
+}
+
+size_t ModuleSerializer::CompileSymbolFiles(
+    const std::vector<string>& symbol_files,
+    const std::vector<string>& fast_symbol_files,
+    int thread_count,
+    std::vector<bool>* failed) {
+  assert(symbol_files.size() == fast_symbol_files.size());
+  std::vector<std::pair<off_t, size_t>> order;
+  order.reserve(symbol_files.size());
+  for (size_t i = 0; i < symbol_files.size(); ++i) {
+    struct stat st;
+    off_t file_size = stat(symbol_files[i].c_str(), &st) == 0 ? st.st_size : 0;
+    order.push_back(std::make_pair(file_size, i));
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [](const std::pair<off_t, size_t>& a,
+                      const std::pair<off_t, size_t>& b) {
+                     return a.first > b.first;
+                   });
+
+  // A vector<bool> packs its elements, so the threads can't each set one.
+  std::vector<char> file_failed(symbol_files.size(), 0);
+  std::atomic<size_t> next_file(0);
+  std::atomic<size_t> failed_count(0);
+  auto compile = [&]() {
+    ModuleSerializer serializer;
+    serializer.set_search_index(search_index_);
+    size_t next;
+    while ((next = next_file++) < order.size()) {
+      size_t index = order[next].second;
+      if (!serializer.CompileSymbolFile(symbol_files[index],
+                                        fast_symbol_files[index])) {
+        file_failed[index] = 1;
+        ++failed_count;
+      }
+    }
+  };
+  if (thread_count < 1)
+    thread_count = 1;
+  if (static_cast<size_t>(thread_count) > order.size())
+    thread_count = static_cast<int>(order.size());
+  std::vector<std::thread> threads;
+  for (int i = 1; i < thread_count; ++i)
+    threads.emplace_back(compile);
+  compile();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  if (failed)
+    failed->assign(file_failed.begin(), file_failed.end());
+  return failed_count;
+}
+
+// static
+void ModuleSerializer::CompileRecords(char* symbol_data,
+                                      CompileState* state) {
+  typedef BasicSourceLineResolver::Module Module;
+  int line_number = 0;
+  char* save_ptr;
+  char* buffer = strtok_r(symbol_data, "\r\n", &save_ptr);
+
+  while (buffer != NULL) {
+    ++line_number;
+    const char* error = NULL;
+    const char* inline_error = NULL;
+
+    if (strncmp(buffer, "FILE ", 5) == 0) {
+      long index;
+      char* filename;
+      if (SymbolParseHelper::ParseFile(buffer, &index, &filename)) {
+        state->files.push_back(
+            state->AddText(filename, static_cast<int>(index), 0));
+      } else {
+        error = "ParseFile on buffer failed";
+      }
+    } else if (strncmp(buffer, "STACK ", 6) == 0) {
+      if (!CompileStackInfo(buffer, state))
+        error = "ParseStackInfo failed";
+    } else if (strncmp(buffer, "FUNC ", 5) == 0) {
+      CloseFunction(state);
+      state->function = Module::ParseFunction(buffer, &state->function_arena);
+      if (!state->function)
+        error = "ParseFunction failed";
+    } else if (strncmp(buffer, "PUBLIC ", 7) == 0) {
+      // Public symbols don't contain line number information.
+      CloseFunction(state);
+      bool is_multiple;
+      uint64_t address;
+      long stack_param_size;
+      char* name;
+      if (SymbolParseHelper::ParsePublicSymbol(buffer, &is_multiple, &address,
+                                               &stack_param_size, &name)) {
+        // See BasicSourceLineResolver::Module::ParsePublicSymbol for why
+        // symbols at address 0 are accepted but left out.
+        if (address != 0) {
+          PublicSymbol symbol(name, address, stack_param_size, is_multiple);
+          state->public_symbols.push_back(
+              state->AddValue(symbol, address, 0));
+        }
+      } else {
+        error = "ParsePublicSymbol failed";
+      }
+    } else if (strncmp(buffer, "MODULE ", 7) == 0 ||
+               strncmp(buffer, "INFO ", 5) == 0) {
+      // Housekeeping records, see BasicSourceLineResolver.
+    } else if (strncmp(buffer, "INLINE_ORIGIN ", 14) == 0) {
+      bool has_file_id;
+      long origin_id;
+      long source_file_id = -1;
+      char* origin_name;
+      if (SymbolParseHelper::ParseInlineOrigin(buffer, &has_file_id,
+                                               &origin_id, &source_file_id,
+                                               &origin_name)) {
+        InlineOrigin origin(has_file_id, source_file_id, origin_name);
+        state->inline_origins.push_back(
+            state->AddValue(origin, static_cast<int>(origin_id), 0));
+      } else {
+        inline_error = "ParseInlineOrigin failed";
+      }
+    } else if (strncmp(buffer, "INLINE ", 7) == 0) {
+      BasicSourceLineResolver::Inline* in =
+          Module::ParseInline(buffer, &state->function_arena);
+      if (!in) {
+        inline_error = "ParseInline failed";
+      } else if (!state->function) {
+        inline_error = "Found inline data without a function";
+      } else {
+        state->function->AppendInline(in);
+      }
+    } else if (!state->function) {
+      error = "Found source line data without a function";
+    } else {
+      Line* line = Module::ParseLine(buffer, &state->function_arena);
+      if (!line) {
+        error = "ParseLine failed";
+      } else {
+        state->function->lines.StoreRange(line->address, line->size, line);
+      }
+    }
+
+    if (error) {
+      Module::LogParseError(error, line_number, &state->num_errors);
+      if (++state->parse_errors > kCompileMaxErrorsBeforeBailing)
+        break;
+    } else if (inline_error) {
+      Module::LogParseError(inline_error, line_number, &state->inline_errors);
+    }
+    buffer = strtok_r(NULL, "\r\n", &save_ptr);
+  }
+  CloseFunction(state);
+}
+
+// static
+bool ModuleSerializer::CompileStackInfo(char* stack_info_line,
+                                        CompileState* state) {
+  // Skip "STACK " prefix and find the platform token.
+  stack_info_line += 6;
+  while (*stack_info_line == ' ')
+    stack_info_line++;
+  const char* platform = stack_info_line;
+  while (!strchr(" \r\n", *stack_info_line))
+    stack_info_line++;
+  *stack_info_line++ = '\0';
+
+  if (strcmp(platform, "WIN") == 0) {
+    int type = 0;
+    uint64_t rva, code_size;
+    scoped_ptr<WindowsFrameInfo>
+      parsed_info(WindowsFrameInfo::ParseFromString(stack_info_line,
+                                                    type,
+                                                    rva,
+                                                    code_size));
+    if (parsed_info == NULL)
+      return false;
+    // See BasicSourceLineResolver::Module::ParseStackInfo for why a failure
+    // to store is not an error.
+    state->windows_frame_info[type].StoreRange(
+        rva, code_size,
+        state->windows_frame_info_arena.New<WindowsFrameInfo>(*parsed_info));
+    return true;
+  } else if (strcmp(platform, "CFI") == 0) {
+    bool is_initial;
+    MemAddr address;
+    MemAddr size;
+    char* rules;
+    if (!BasicSourceLineResolver::Module::ParseCFIRecord(
+            stack_info_line, &is_initial, &address, &size, &rules)) {
+      return false;
+    }
+    if (is_initial) {
+      state->cfi_initial_rules.push_back(state->AddText(rules, address, size));
+    } else {
+      state->cfi_delta_rules.push_back(state->AddText(rules, address, 0));
+    }
+    return true;
+  }
+  return false;
+}
+
+// static
+void ModuleSerializer::CloseFunction(CompileState* state) {
+  if (!state->function)
+    return;
+  state->function->IndexInlines();
+  const Function& function = *state->function;
+  state->functions.push_back(
+      state->AddValue(function, function.address, function.size));
+  state->function = NULL;
+  state->function_arena.Clear();
+}
+
 }  // namespace google_breakpad
@@ -39,12 +39,12 @@
 #include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "google_breakpad/processor/basic_source_line_resolver.h"
 #include "google_breakpad/processor/fast_source_line_resolver.h"
 #include "processor/basic_source_line_resolver_types.h"
 #include "processor/fast_source_line_resolver_types.h"
-#include "processor/linked_ptr.h"
 #include "processor/map_serializers-inl.h"
 #include "processor/simple_serializer-inl.h"
 #include "processor/windows_frame_info.h"
@@ -59,6 +59,16 @@ namespace google_breakpad {
 // FastSourceLineResolver::Module.
 class ModuleSerializer {
  public:
+  ModuleSerializer() : search_index_(false) { }
+
+  // If |search_index| is true, the address and id maps of serialized modules
+  // carry a StaticMapSearchIndex (see static_map_search_index.h), which makes
+  // lookups in large modules touch far fewer cache lines at the cost of
+  // about 1.5 bytes per entry.  FastSourceLineResolver detects the index when
+  // it loads a module, so the option needs no reader-side counterpart.  Off
+  // by default.
+  void set_search_index(bool search_index);
+
   // Compute the size of memory required to serialize a module.  Return the
   // total size needed for serialization.
   size_t SizeOf(const BasicSourceLineResolver::Module& module);
@@ -81,6 +91,38 @@ class ModuleSerializer {
   char* SerializeSymbolFileData(const string& symbol_data,
                                 size_t* size = nullptr);
 
+  // Compiles the string format symbol data in |symbol_data| straight into
+  // the serialized data SerializeSymbolFileData produces for it, without
+  // building a BasicSourceLineResolver::Module first.  Functions are
+  // serialized as soon as their records end and other records are kept as
+  // compact references into |symbol_data|, so peak memory stays close to the
+  // size of the symbol data plus the size of the serialized data.  As with
+  // BasicSourceLineResolver::Module::LoadMapFromMemory, |symbol_data| should
+  // end with a null terminator and is modified in place.
+  // Caller takes ownership of the serialized data (on heap), and owner should
+  // call delete [] to free the memory after use.
+  char* CompileSymbolFileData(char* symbol_data, size_t symbol_data_size,
+                              size_t* size = nullptr);
+
+  // Compiles the symbol file at |symbol_file| with CompileSymbolFileData and
+  // writes the result to |fast_symbol_file| as a fast symbol file (see
+  // fast_symbol_file.h), with the debug identifier from its MODULE record.
+  // Returns false if either file can't be read or written.
+  bool CompileSymbolFile(const string& symbol_file,
+                         const string& fast_symbol_file);
+
+  // Compiles each of |symbol_files| with CompileSymbolFile into the fast
+  // symbol file at the same index of |fast_symbol_files|, on up to
+  // |thread_count| threads that each have a serializer of their own set up
+  // like this one.  The largest files are started first, so that one large
+  // file started last doesn't keep the other threads waiting.  Returns the
+  // number of files that could not be compiled; if |failed| is not NULL,
+  // it is set to whether each one failed.
+  size_t CompileSymbolFiles(const std::vector<string>& symbol_files,
+                            const std::vector<string>& fast_symbol_files,
+                            int thread_count,
+                            std::vector<bool>* failed = NULL);
+
   // Serializes one loaded module with given moduleid in the basic source line
   // resolver, and loads the serialized data into the fast source line resolver.
   // Return false if the basic source line doesn't have a module with the given
@@ -90,9 +132,12 @@ class ModuleSerializer {
                         FastSourceLineResolver* fast_resolver);
 
   // Serializes all the loaded modules in a basic source line resolver, and
-  // loads the serialized data into a fast source line resolver.
+  // loads the serialized data into a fast source line resolver.  With
+  // |thread_count| above 1, the modules are serialized on that many threads
+  // and then loaded in the same order as with one.
   void ConvertAllModules(const BasicSourceLineResolver* basic_resolver,
-                         FastSourceLineResolver* fast_resolver);
+                         FastSourceLineResolver* fast_resolver,
+                         int thread_count = 1);
 
  private:
   // Convenient type names.
@@ -101,11 +146,29 @@ class ModuleSerializer {
   typedef BasicSourceLineResolver::PublicSymbol PublicSymbol;
   typedef BasicSourceLineResolver::InlineOrigin InlineOrigin;
 
+  // The records CompileSymbolFileData gathers from a symbol file.
+  struct CompileState;
+
+  // Parses the records of the null terminated |symbol_data| into |state|.
+  static void CompileRecords(char* symbol_data, CompileState* state);
+
+  // Parses a STACK WIN or STACK CFI record into |state|.
+  static bool CompileStackInfo(char* stack_info_line, CompileState* state);
+
+  // Serializes the function |state| has open, if any, and closes it.
+  static void CloseFunction(CompileState* state);
+
   // Internal implementation for ConvertOneModule and ConvertAllModules methods.
   bool SerializeModuleAndLoadIntoFastResolver(
       const BasicSourceLineResolver::ModuleMap::const_iterator& iter,
       FastSourceLineResolver* fast_resolver);
 
+  // Loads the |size| bytes of |symbol_data| serialized from the module
+  // named |name| into |fast_resolver|.
+  static bool LoadIntoFastResolver(const string& name,
+                                   const char* symbol_data, size_t size,
+                                   FastSourceLineResolver* fast_resolver);
+
   // Number of Maps that Module class contains.
   static const int32_t kNumberMaps_ =
       FastSourceLineResolver::Module::kNumberMaps_;
@@ -113,15 +176,17 @@ class ModuleSerializer {
   // Memory sizes required to serialize map components in Module.
   uint64_t map_sizes_[kNumberMaps_];
 
+  // Whether serialized maps carry a search index.
+  bool search_index_;
+
   // Serializers for each individual map component in Module class.
-  StdMapSerializer<int, string> files_serializer_;
-  RangeMapSerializer<MemAddr, linked_ptr<Function> > functions_serializer_;
-  AddressMapSerializer<MemAddr, linked_ptr<PublicSymbol> > pubsym_serializer_;
-  ContainedRangeMapSerializer<MemAddr,
-                              linked_ptr<WindowsFrameInfo> > wfi_serializer_;
+  StdMapSerializer<int, StringView> files_serializer_;
+  RangeMapSerializer<MemAddr, Function*> functions_serializer_;
+  AddressMapSerializer<MemAddr, PublicSymbol*> pubsym_serializer_;
+  ContainedRangeMapSerializer<MemAddr, WindowsFrameInfo*> wfi_serializer_;
   RangeMapSerializer<MemAddr, string> cfi_init_rules_serializer_;
   StdMapSerializer<MemAddr, string> cfi_delta_rules_serializer_;
-  StdMapSerializer<int, linked_ptr<InlineOrigin>> inline_origin_serializer_;
+  StdMapSerializer<int, InlineOrigin*> inline_origin_serializer_;
 };
 
 }  // namespace google_breakpad
@@ -0,0 +1,120 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// nested_range_index-inl.h: NestedRangeIndex implementation.
+//
+// See nested_range_index.h for documentation.
+
+#ifndef PROCESSOR_NESTED_RANGE_INDEX_INL_H__
+#define PROCESSOR_NESTED_RANGE_INDEX_INL_H__
+
+#include "processor/nested_range_index.h"
+
+#include <algorithm>
+
+namespace google_breakpad {
+
+template<typename AddressType>
+int32_t FindInnermostNestedRange(const NestedRange<AddressType>* ranges,
+                                 size_t count, const AddressType& address) {
+  // Ranges start in ascending order, so the first one starting above
+  // |address| follows every range that contains it.  Those are the last
+  // range starting at or below |address| and its ancestors, since any other
+  // range before it lies within an earlier sibling of one of them, which
+  // ends before that one starts, and so before |address|.
+  const NestedRange<AddressType>* after = std::upper_bound(
+      ranges, ranges + count, address,
+      [](const AddressType& address, const NestedRange<AddressType>& range) {
+        return address < range.base;
+      });
+  int32_t index = static_cast<int32_t>(after - ranges) - 1;
+  // Once a range contains |address|, so do all of its ancestors.
+  while (index >= 0 && ranges[index].high < address)
+    index = ranges[index].parent;
+  return index;
+}
+
+template<typename AddressType, typename EntryType>
+void NestedRangeIndex<AddressType, EntryType>::Build(
+    const ContainedRangeMap<AddressType, EntryType>& map) {
+  Clear();
+  AppendChildren(map, -1, 0);
+}
+
+template<typename AddressType, typename EntryType>
+void NestedRangeIndex<AddressType, EntryType>::AppendChildren(
+    const ContainedRangeMap<AddressType, EntryType>& map,
+    int32_t parent, uint32_t depth) {
+  if (!map.map_)
+    return;
+  // Children are keyed by their high addresses, and don't overlap, so they
+  // are in ascending order of their bases too.
+  typedef typename ContainedRangeMap<AddressType, EntryType>::MapConstIterator
+      MapConstIterator;
+  for (MapConstIterator child = map.map_->begin(); child != map.map_->end();
+       ++child) {
+    NestedRange<AddressType> range;
+    range.base = child->second->base_;
+    range.high = child->first;
+    range.parent = parent;
+    range.depth = depth;
+    ranges_.push_back(range);
+    entries_.push_back(child->second->entry_);
+    AppendChildren(*child->second, static_cast<int32_t>(ranges_.size() - 1),
+                   depth + 1);
+  }
+}
+
+template<typename AddressType, typename EntryType>
+bool NestedRangeIndex<AddressType, EntryType>::RetrieveRange(
+    const AddressType& address, EntryType* entry) const {
+  int32_t index =
+      FindInnermostNestedRange(ranges_.data(), ranges_.size(), address);
+  if (index < 0)
+    return false;
+  *entry = entries_[index];
+  return true;
+}
+
+template<typename AddressType, typename EntryType>
+bool NestedRangeIndex<AddressType, EntryType>::RetrieveRanges(
+    const AddressType& address,
+    std::vector<const EntryType*>& entries) const {
+  int32_t index =
+      FindInnermostNestedRange(ranges_.data(), ranges_.size(), address);
+  if (index < 0)
+    return false;
+  entries.reserve(entries.size() + ranges_[index].depth + 1);
+  for (; index >= 0; index = ranges_[index].parent)
+    entries.push_back(&entries_[index]);
+  return true;
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_NESTED_RANGE_INDEX_INL_H__
@@ -0,0 +1,127 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// nested_range_index.h: Flattened index of a ContainedRangeMap.
+//
+// A ContainedRangeMap is a tree of std::maps, and finding all of the ranges
+// that contain an address walks down it, searching a map at each level.
+// NestedRangeIndex lays the same ranges out in one array, in pre-order, so
+// that each range comes after the ones containing it and ranges that are
+// not nested are sorted by address.  Each range records the index of the
+// range containing it and how deeply it is nested.  The innermost range
+// containing an address is then found with one binary search, for the
+// last range starting at or below it, and the others by following the
+// parent indices from there.
+//
+// NestedRangeIndex is built from a ContainedRangeMap once it is complete,
+// and cannot be added to.  StaticNestedRangeIndex reads the same index as
+// serialized by NestedRangeIndexSerializer.
+
+#ifndef PROCESSOR_NESTED_RANGE_INDEX_H__
+#define PROCESSOR_NESTED_RANGE_INDEX_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "processor/contained_range_map.h"
+
+namespace google_breakpad {
+
+template<class, class> class NestedRangeIndexSerializer;
+
+// One range of a NestedRangeIndex, as it is also serialized.
+template<typename AddressType>
+struct NestedRange {
+  AddressType base;
+  // The last address in the range.
+  AddressType high;
+  // The index of the range containing this one, or -1 for a range at the
+  // top level.
+  int32_t parent;
+  // The number of ranges containing this one.
+  uint32_t depth;
+};
+
+// Returns the index of the innermost of the |count| |ranges|, in the order
+// NestedRangeIndex keeps them, that contains |address|, or -1 if none do.
+// The ranges containing that one, which also contain |address|, are found
+// through its parent.
+template<typename AddressType>
+int32_t FindInnermostNestedRange(const NestedRange<AddressType>* ranges,
+                                 size_t count, const AddressType& address);
+
+template<typename AddressType, typename EntryType>
+class NestedRangeIndex {
+ public:
+  NestedRangeIndex() : ranges_(), entries_() {}
+
+  // Replaces the index with one of the ranges stored in |map|.
+  void Build(const ContainedRangeMap<AddressType, EntryType>& map);
+
+  // Retrieves the entry of the innermost range containing |address|.
+  // Returns false if no range contains it.
+  bool RetrieveRange(const AddressType& address, EntryType* entry) const;
+
+  // Retrieves the entries of the ranges containing |address|, from the
+  // innermost to the outermost, as ContainedRangeMap::RetrieveRanges does.
+  bool RetrieveRanges(const AddressType& address,
+                      std::vector<const EntryType*>& entries) const;
+
+  bool empty() const { return ranges_.empty(); }
+  size_t size() const { return ranges_.size(); }
+
+  // The memory held by the index's arrays, not counting anything the
+  // entries point to.
+  size_t ResidentBytes() const {
+    return ranges_.capacity() * sizeof(NestedRange<AddressType>) +
+           entries_.capacity() * sizeof(EntryType);
+  }
+
+  void Clear() {
+    ranges_.clear();
+    entries_.clear();
+  }
+
+ private:
+  friend class NestedRangeIndexSerializer<AddressType, EntryType>;
+
+  // Appends the descendants of |map|, whose range is at |parent| and
+  // nested |depth| deep, in pre-order.
+  void AppendChildren(const ContainedRangeMap<AddressType, EntryType>& map,
+                      int32_t parent, uint32_t depth);
+
+  std::vector<NestedRange<AddressType> > ranges_;
+  // The entry of each range, by the same index.
+  std::vector<EntryType> entries_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_NESTED_RANGE_INDEX_H__
@@ -0,0 +1,197 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// nested_range_index_unittest.cc: Unit tests for NestedRangeIndex and
+// StaticNestedRangeIndex, which are checked against the ContainedRangeMap
+// they are built from.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "processor/contained_range_map-inl.h"
+#include "processor/map_serializers-inl.h"
+#include "processor/nested_range_index-inl.h"
+#include "processor/simple_serializer-inl.h"
+#include "processor/static_nested_range_index.h"
+
+namespace {
+
+using google_breakpad::ContainedRangeMap;
+using google_breakpad::NestedRangeIndex;
+using google_breakpad::NestedRangeIndexSerializer;
+using google_breakpad::StaticNestedRangeIndex;
+using google_breakpad::scoped_array;
+using std::vector;
+
+typedef ContainedRangeMap<unsigned int, int> CRMMap;
+typedef NestedRangeIndex<unsigned int, int> Index;
+typedef StaticNestedRangeIndex<unsigned int, int> StaticIndex;
+
+// Returns the values of |entries|.
+vector<int> Values(const vector<const int*>& entries) {
+  vector<int> values;
+  for (const int* entry : entries)
+    values.push_back(*entry);
+  return values;
+}
+
+// Checks that |index|, and the serialized form of it, retrieve the same
+// ranges as |map| for every address below |test_high|.
+void CheckAgainstMap(const CRMMap& map, const Index& index,
+                     unsigned int test_high) {
+  NestedRangeIndexSerializer<unsigned int, int> serializer;
+  uint64_t size;
+  scoped_array<char> serialized(serializer.Serialize(index, &size));
+  ASSERT_EQ(serializer.SizeOf(index), size);
+  StaticIndex static_index(serialized.get());
+
+  for (unsigned int address = 0; address < test_high; ++address) {
+    vector<const int*> expected;
+    const bool found = map.RetrieveRanges(address, expected);
+
+    vector<const int*> entries;
+    EXPECT_EQ(found, index.RetrieveRanges(address, entries))
+        << "address " << address;
+    EXPECT_EQ(Values(expected), Values(entries)) << "address " << address;
+
+    vector<const int*> static_entries;
+    EXPECT_EQ(found, static_index.RetrieveRanges(address, static_entries))
+        << "address " << address;
+    EXPECT_EQ(Values(expected), Values(static_entries))
+        << "address " << address;
+
+    int entry = 0;
+    const int* static_entry = NULL;
+    EXPECT_EQ(found, index.RetrieveRange(address, &entry));
+    EXPECT_EQ(found, static_index.RetrieveRange(address, static_entry));
+    if (found) {
+      EXPECT_EQ(*expected[0], entry) << "address " << address;
+      EXPECT_EQ(*expected[0], *static_entry) << "address " << address;
+    }
+  }
+}
+
+TEST(NestedRangeIndexTest, Empty) {
+  CRMMap map;
+  Index index;
+  index.Build(map);
+  EXPECT_TRUE(index.empty());
+  CheckAgainstMap(map, index, 10);
+}
+
+TEST(NestedRangeIndexTest, NestedRanges) {
+  // The ranges of static_contained_range_map_unittest.cc.
+  CRMMap map;
+  map.StoreRange(10, 10,  1);
+  map.StoreRange(11,  9,  5);
+  map.StoreRange(12,  7,  6);
+  map.StoreRange( 9, 12,  7);
+  map.StoreRange( 9, 13,  8);
+  map.StoreRange( 8, 14,  9);
+  map.StoreRange(30,  3, 10);
+  map.StoreRange(33,  3, 11);
+  map.StoreRange(30,  6, 12);
+  map.StoreRange(40,  8, 13);
+  map.StoreRange(40,  4, 14);
+  map.StoreRange(44,  4, 15);
+  map.StoreRange(50, 10, 18);
+  map.StoreRange(50,  1, 19);
+  map.StoreRange(59,  1, 20);
+  map.StoreRange(60,  1, 21);
+  map.StoreRange(69,  1, 22);
+  map.StoreRange(60, 10, 23);
+  map.StoreRange(68,  1, 24);
+  map.StoreRange(61,  1, 25);
+  map.StoreRange(61,  8, 26);
+  map.StoreRange(70, 10, 30);
+  map.StoreRange(74,  2, 31);
+  map.StoreRange(77,  2, 32);
+  map.StoreRange(80,  3, 34);
+  map.StoreRange(81,  1, 35);
+  map.StoreRange(82,  1, 36);
+  map.StoreRange(83,  3, 37);
+  map.StoreRange(84,  1, 38);
+  map.StoreRange(83,  1, 39);
+  map.StoreRange(86,  5, 40);
+  map.StoreRange(88,  1, 41);
+  map.StoreRange(90,  1, 42);
+  map.StoreRange(86,  1, 43);
+  map.StoreRange(87,  1, 44);
+  map.StoreRange(89,  1, 45);
+  map.StoreRange(87,  4, 46);
+  map.StoreRange(87,  3, 47);
+
+  Index index;
+  index.Build(map);
+  EXPECT_FALSE(index.empty());
+  CheckAgainstMap(map, index, 100);
+}
+
+TEST(NestedRangeIndexTest, EqualRanges) {
+  CRMMap map(true);
+  map.StoreRange(2, 5, 0);
+  map.StoreRange(2, 6, 1);
+  map.StoreRange(2, 7, 2);
+  map.StoreRange(2, 5, 3);
+  map.StoreRange(20, 4, 4);
+
+  Index index;
+  index.Build(map);
+  EXPECT_EQ(5U, index.size());
+  vector<const int*> entries;
+  ASSERT_TRUE(index.RetrieveRanges(3, entries));
+  EXPECT_EQ((vector<int>{3, 0, 1, 2}), Values(entries));
+  CheckAgainstMap(map, index, 30);
+}
+
+TEST(NestedRangeIndexTest, RandomRanges) {
+  // Inlines nest deeply; build trees of random ranges, most of which are
+  // refused for overlapping partially.
+  srand(0);
+  for (int round = 0; round < 20; ++round) {
+    CRMMap map(round % 2 == 0);
+    for (int i = 0; i < 200; ++i) {
+      unsigned int base = rand() % 1000;
+      unsigned int size = 1 + rand() % (i < 20 ? 200 : 20);
+      map.StoreRange(base, size, i);
+    }
+    Index index;
+    index.Build(map);
+    CheckAgainstMap(map, index, 1250);
+  }
+}
+
+}  // namespace
@@ -2,106 +2,229 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-// For <inttypes.h> PRI* macros, before anything else might #include it.
-#ifndef __STDC_FORMAT_MACROS
-#define __STDC_FORMAT_MACROS
-#endif  /* __STDC_FORMAT_MACROS */
-
 #ifdef HAVE_CONFIG_H
 #include <config.h>  // Must come first
 #endif
 
 #include "google_breakpad/processor/proc_maps_linux.h"
 
-#include <fcntl.h>
-#include <inttypes.h>
-#include <stdio.h>
+#include <map>
 
 #include "common/using_std_string.h"
 #include "processor/logging.h"
 
-#if defined(OS_ANDROID) && !defined(__LP64__)
-// In 32-bit mode, Bionic's inttypes.h defines PRI/SCNxPTR as an
-// unsigned long int, which is incompatible with Bionic's stdint.h
-// defining uintptr_t as an unsigned int:
-// https://code.google.com/p/android/issues/detail?id=57218
-#undef SCNxPTR
-#define SCNxPTR "x"
-#endif
-
 namespace google_breakpad {
 
-bool ParseProcMaps(const string& input,
-                   std::vector<MappedMemoryRegion>* regions_out) {
-  std::vector<MappedMemoryRegion> regions;
-
-  // This isn't async safe nor terribly efficient, but it doesn't need to be at
-  // this point in time.
-
-  // Split the string by newlines.
-  std::vector<string> lines;
-  string l = "";
-  for (size_t i = 0; i < input.size(); i++) {
-    if (input[i] != '\n' && input[i] != '\r') {
-      l.push_back(input[i]);
-    } else if (l.size() > 0) {
-      lines.push_back(l);
-      l.clear();
+namespace {
+
+// Reads the fields of one line of /proc/<pid>/maps. The fields follow the
+// rules of the sscanf format this replaces,
+// "%x-%x %4c %x %hhx:%hhx %d %n": numbers may be preceded by whitespace,
+// and the whitespace between fields may be missing.
+class ProcMapsLineReader {
+ public:
+  ProcMapsLineReader(const char* line, const char* end)
+      : cursor_(line), end_(end) {}
+
+  bool ReadHex(uint64_t* value) {
+    SkipWhitespace();
+    const char* start = cursor_;
+    uint64_t result = 0;
+    for (; cursor_ < end_; ++cursor_) {
+      char c = *cursor_;
+      int digit;
+      if (c >= '0' && c <= '9')
+        digit = c - '0';
+      else if (c >= 'a' && c <= 'f')
+        digit = c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F')
+        digit = c - 'A' + 10;
+      else
+        break;
+      result = (result << 4) | digit;
     }
+    *value = result;
+    return cursor_ != start;
   }
-  if (l.size() > 0) {
-    BPLOG(ERROR) << "Input doesn't end in newline";
-    return false;
+
+  // Like %hhx, keeps only the low byte of the value.
+  bool ReadHexByte(uint8_t* value) {
+    uint64_t result;
+    if (!ReadHex(&result))
+      return false;
+    *value = static_cast<uint8_t>(result);
+    return true;
+  }
+
+  bool ReadDecimal(uint64_t* value) {
+    SkipWhitespace();
+    const char* start = cursor_;
+    uint64_t result = 0;
+    for (; cursor_ < end_ && *cursor_ >= '0' && *cursor_ <= '9'; ++cursor_)
+      result = result * 10 + (*cursor_ - '0');
+    *value = result;
+    return cursor_ != start;
+  }
+
+  bool ReadChar(char expected) {
+    if (cursor_ == end_ || *cursor_ != expected)
+      return false;
+    ++cursor_;
+    return true;
   }
 
-  for (size_t i = 0; i < lines.size(); ++i) {
-    MappedMemoryRegion region;
-    const char* line = lines[i].c_str();
-    char permissions[5] = {'\0'};  // Ensure NUL-terminated string.
-    int path_index = 0;
+  // Returns the next |length| characters, without skipping whitespace.
+  const char* ReadChars(size_t length) {
+    if (static_cast<size_t>(end_ - cursor_) < length)
+      return NULL;
+    const char* chars = cursor_;
+    cursor_ += length;
+    return chars;
+  }
+
+  void SkipWhitespace() {
+    while (cursor_ < end_ &&
+           (*cursor_ == ' ' || *cursor_ == '\t' || *cursor_ == '\v' ||
+            *cursor_ == '\f'))
+      ++cursor_;
+  }
+
+  StringView Rest() const { return StringView(cursor_, end_ - cursor_); }
+
+ private:
+  const char* cursor_;
+  const char* end_;
+};
+
+// Sets |permissions| from the four characters of a maps line's permissions
+// field, such as "r-xp".
+bool ParsePermissions(const char* chars, uint8_t* permissions) {
+  *permissions = 0;
+
+  if (chars[0] == 'r')
+    *permissions |= MappedMemoryRegion::READ;
+  else if (chars[0] != '-')
+    return false;
+
+  if (chars[1] == 'w')
+    *permissions |= MappedMemoryRegion::WRITE;
+  else if (chars[1] != '-')
+    return false;
+
+  if (chars[2] == 'x')
+    *permissions |= MappedMemoryRegion::EXECUTE;
+  else if (chars[2] != '-')
+    return false;
+
+  if (chars[3] == 'p')
+    *permissions |= MappedMemoryRegion::PRIVATE;
+  else if (chars[3] != 's' && chars[3] != 'S')  // Shared memory.
+    return false;
+
+  return true;
+}
+
+}  // namespace
+
+bool ParseProcMapsTable(StringView input, ProcMapsTable* table) {
+  ProcMapsTable result;
+  // Paths are interned by their text in |input|.
+  std::map<StringView, uint32_t> path_indexes;
+
+  const char* data = input.data();
+  const char* end = data + input.size();
+  const char* line = data;
+  while (line < end) {
+    // Lines end at either of '\n' and '\r'; the empty lines between them
+    // are skipped.
+    const char* line_end = line;
+    while (line_end < end && *line_end != '\n' && *line_end != '\r')
+      ++line_end;
+    if (line_end == end) {
+      BPLOG(ERROR) << "Input doesn't end in newline";
+      return false;
+    }
+    if (line_end == line) {
+      ++line;
+      continue;
+    }
 
     // Sample format from man 5 proc:
     //
     // address           perms offset  dev   inode   pathname
     // 08048000-08056000 r-xp 00000000 03:0c 64593   /usr/sbin/gpm
-    //
-    // The final %n term captures the offset in the input string, which is used
-    // to determine the path name. It *does not* increment the return value.
-    // Refer to man 3 sscanf for details.
-    if (sscanf(line, "%" SCNx64 "-%" SCNx64 " %4c %" SCNx64" %hhx:%hhx %"
-               SCNd64 " %n", &region.start, &region.end, permissions,
-               &region.offset, &region.major_device, &region.minor_device,
-               &region.inode, &path_index) < 7) {
-      BPLOG(ERROR) << "sscanf failed for line: " << line;
+    ProcMapsLineReader reader(line, line_end);
+    ProcMapsEntry entry;
+    const char* permissions = NULL;
+    bool parsed = reader.ReadHex(&entry.start) &&
+                  reader.ReadChar('-') &&
+                  reader.ReadHex(&entry.end);
+    if (parsed) {
+      reader.SkipWhitespace();
+      permissions = reader.ReadChars(4);
+    }
+    parsed = parsed && permissions &&
+             reader.ReadHex(&entry.offset) &&
+             reader.ReadHexByte(&entry.major_device) &&
+             reader.ReadChar(':') &&
+             reader.ReadHexByte(&entry.minor_device) &&
+             reader.ReadDecimal(&entry.inode);
+    if (!parsed) {
+      BPLOG(ERROR) << "Failed to parse line: "
+                   << StringView(line, line_end - line);
       return false;
     }
-
-    region.permissions = 0;
-
-    if (permissions[0] == 'r')
-      region.permissions |= MappedMemoryRegion::READ;
-    else if (permissions[0] != '-')
+    if (!ParsePermissions(permissions, &entry.permissions))
       return false;
 
-    if (permissions[1] == 'w')
-      region.permissions |= MappedMemoryRegion::WRITE;
-    else if (permissions[1] != '-')
-      return false;
+    reader.SkipWhitespace();
+    StringView path = reader.Rest();
+    // A file's mappings are usually adjacent, so the previous line's path
+    // is checked before the map.
+    if (!result.entries.empty() &&
+        StringView(result.paths[result.entries.back().path_index]) == path) {
+      entry.path_index = result.entries.back().path_index;
+    } else {
+      std::map<StringView, uint32_t>::iterator path_index =
+          path_indexes.find(path);
+      if (path_index == path_indexes.end()) {
+        path_index = path_indexes.insert(std::make_pair(
+            path, static_cast<uint32_t>(result.paths.size()))).first;
+        result.paths.push_back(path.str());
+      }
+      entry.path_index = path_index->second;
+    }
+    entry.line_offset = line - data;
+    entry.line_length = line_end - line;
+    result.entries.push_back(entry);
 
-    if (permissions[2] == 'x')
-      region.permissions |= MappedMemoryRegion::EXECUTE;
-    else if (permissions[2] != '-')
-      return false;
+    line = line_end + 1;
+  }
 
-    if (permissions[3] == 'p')
-      region.permissions |= MappedMemoryRegion::PRIVATE;
-    else if (permissions[3] != 's' && permissions[3] != 'S')  // Shared memory.
-      return false;
+  table->entries.swap(result.entries);
+  table->paths.swap(result.paths);
+  return true;
+}
+
+bool ParseProcMaps(const string& input,
+                   std::vector<MappedMemoryRegion>* regions_out) {
+  ProcMapsTable table;
+  if (!ParseProcMapsTable(input, &table))
+    return false;
 
-    // Pushing then assigning saves us a string copy.
-    regions.push_back(region);
-    regions.back().path.assign(line + path_index);
-    regions.back().line.assign(line);
+  std::vector<MappedMemoryRegion> regions(table.entries.size());
+  for (size_t i = 0; i < table.entries.size(); ++i) {
+    const ProcMapsEntry& entry = table.entries[i];
+    MappedMemoryRegion& region = regions[i];
+    region.start = entry.start;
+    region.end = entry.end;
+    region.offset = entry.offset;
+    region.permissions = entry.permissions;
+    region.major_device = entry.major_device;
+    region.minor_device = entry.minor_device;
+    region.inode = entry.inode;
+    region.path = table.paths[entry.path_index];
+    region.line.assign(input, entry.line_offset, entry.line_length);
   }
 
   regions_out->swap(regions);
@@ -252,4 +252,35 @@ TEST(ProcMapsTest, ParseProcMapsWeirdCorrectInput) {
   EXPECT_EQ("[vsys call]", regions[4].path);
 }
 
+TEST(ProcMapsTest, TableInternsPaths) {
+  const string kContents =
+      "00400000-0040b000 r-xp 00000000 fc:00 794418 /bin/cat\n"
+      "0060a000-0060b000 r--p 0000a000 fc:00 794418 /bin/cat\n"
+      "01c7c000-01c9d000 rw-p 00000000 00:00 0 [heap]\n"
+      "0060b000-0060c000 rw-p 0000b000 fc:00 794418 /bin/cat\n";
+  google_breakpad::ProcMapsTable table;
+  ASSERT_TRUE(ParseProcMapsTable(kContents, &table));
+  ASSERT_EQ(4u, table.entries.size());
+  ASSERT_EQ(2u, table.paths.size());
+  EXPECT_EQ("/bin/cat", table.paths[0]);
+  EXPECT_EQ("[heap]", table.paths[1]);
+  EXPECT_EQ(0u, table.entries[0].path_index);
+  EXPECT_EQ(0u, table.entries[1].path_index);
+  EXPECT_EQ(1u, table.entries[2].path_index);
+  EXPECT_EQ(0u, table.entries[3].path_index);
+
+  const google_breakpad::ProcMapsEntry& entry = table.entries[1];
+  EXPECT_EQ(0x0060a000u, entry.start);
+  EXPECT_EQ(0x0060b000u, entry.end);
+  EXPECT_EQ(0x0000a000u, entry.offset);
+  EXPECT_EQ(google_breakpad::MappedMemoryRegion::READ |
+            google_breakpad::MappedMemoryRegion::PRIVATE,
+            entry.permissions);
+  EXPECT_EQ(0xfcu, entry.major_device);
+  EXPECT_EQ(0u, entry.minor_device);
+  EXPECT_EQ(794418u, entry.inode);
+  EXPECT_EQ("0060a000-0060b000 r--p 0000a000 fc:00 794418 /bin/cat",
+            kContents.substr(entry.line_offset, entry.line_length));
+}
+
 }  // namespace
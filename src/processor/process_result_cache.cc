@@ -0,0 +1,259 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_result_cache.cc: Keeps the results of processing minidumps.
+//
+// See process_result_cache.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/process_result_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <memory>
+#include <vector>
+
+#include "common/md5.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/symbol_supplier.h"
+#include "processor/basic_code_module.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The first line of every entry.  Entries that start otherwise, from
+// another version, are ignored.
+const char kEntryHeader[] = "BREAKPAD_PROCESS_RESULT 1\n";
+
+// Splits |line| at tabs into |fields|.
+void SplitFields(const string& line, std::vector<string>* fields) {
+  fields->clear();
+  size_t start = 0;
+  for (;;) {
+    size_t tab = line.find('\t', start);
+    fields->push_back(line.substr(start, tab - start));
+    if (tab == string::npos)
+      return;
+    start = tab + 1;
+  }
+}
+
+// Returns true if |field| can be written as a field of an entry line.
+bool IsPlainField(const string& field) {
+  return field.find_first_of("\t\n") == string::npos;
+}
+
+// Reads the whole of |path| into |contents|.  Returns false on failure.
+bool ReadWholeFile(const string& path, string* contents) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+  contents->clear();
+  char buffer[1 << 16];
+  size_t length;
+  while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    contents->append(buffer, length);
+  bool ok = !ferror(file);
+  fclose(file);
+  return ok;
+}
+
+}  // namespace
+
+ProcessResultCache::ProcessResultCache(const string& directory,
+                                       SymbolSupplier* supplier)
+    : directory_(directory), supplier_(supplier) {}
+
+// static
+bool ProcessResultCache::GetKey(const string& minidump_file,
+                                const string& settings,
+                                string* key) {
+  FILE* file = fopen(minidump_file.c_str(), "rb");
+  if (!file)
+    return false;
+  MD5Context context;
+  MD5Init(&context);
+  // The settings go first, with their length, so that no minidump and
+  // settings can hash as another minidump with other settings.
+  char length[32];
+  snprintf(length, sizeof(length), "%zu\n", settings.size());
+  MD5Update(&context, reinterpret_cast<const unsigned char*>(length),
+            strlen(length));
+  MD5Update(&context, reinterpret_cast<const unsigned char*>(settings.data()),
+            settings.size());
+  std::unique_ptr<unsigned char[]> buffer(new unsigned char[1 << 20]);
+  size_t read_length;
+  while ((read_length = fread(buffer.get(), 1, 1 << 20, file)) > 0)
+    MD5Update(&context, buffer.get(), read_length);
+  bool ok = !ferror(file);
+  fclose(file);
+  if (!ok)
+    return false;
+
+  unsigned char digest[16];
+  MD5Final(digest, &context);
+  key->clear();
+  for (size_t i = 0; i < sizeof(digest); ++i) {
+    char hex[3];
+    snprintf(hex, sizeof(hex), "%02x", digest[i]);
+    key->append(hex);
+  }
+  return true;
+}
+
+bool ProcessResultCache::Lookup(const string& key, string* result) {
+  string contents;
+  if (!ReadWholeFile(directory_ + "/" + key, &contents) ||
+      contents.compare(0, strlen(kEntryHeader), kEntryHeader) != 0) {
+    return false;
+  }
+
+  size_t position = strlen(kEntryHeader);
+  std::vector<string> fields;
+  for (;;) {
+    size_t end = contents.find('\n', position);
+    if (end == string::npos)
+      return false;
+    SplitFields(contents.substr(position, end - position), &fields);
+    position = end + 1;
+
+    if (fields.size() == 2 && fields[0] == "R") {
+      uint64_t length = strtoull(fields[1].c_str(), NULL, 10);
+      if (contents.size() - position != length)
+        return false;
+      result->assign(contents, position, string::npos);
+      return true;
+    }
+
+    if (fields.size() != 9 || fields[0] != "M")
+      return false;
+    BasicCodeModule module(strtoull(fields[1].c_str(), NULL, 16),
+                           strtoull(fields[2].c_str(), NULL, 16),
+                           fields[3], fields[4], fields[5], fields[6],
+                           fields[7]);
+    string fingerprint;
+    if (!GetSymbolFingerprint(&module, &fingerprint) ||
+        fingerprint != fields[8]) {
+      BPLOG(INFO) << "Symbols for " << fields[5] << " " << fields[6]
+                  << " changed since result " << key << " was kept";
+      return false;
+    }
+  }
+}
+
+bool ProcessResultCache::Store(const string& key,
+                               const CodeModules* modules,
+                               const string& result) {
+  string contents = kEntryHeader;
+  unsigned int module_count = modules ? modules->module_count() : 0;
+  for (unsigned int i = 0; i < module_count; ++i) {
+    const CodeModule* module = modules->GetModuleAtSequence(i);
+    string fields[] = {
+      module->code_file(), module->code_identifier(), module->debug_file(),
+      module->debug_identifier(), module->version(), string()
+    };
+    if (!GetSymbolFingerprint(module, &fields[5]))
+      return false;
+    char addresses[64];
+    snprintf(addresses, sizeof(addresses), "M\t%llx\t%llx",
+             static_cast<unsigned long long>(module->base_address()),
+             static_cast<unsigned long long>(module->size()));
+    contents.append(addresses);
+    for (const string& field : fields) {
+      if (!IsPlainField(field))
+        return false;
+      contents.append("\t").append(field);
+    }
+    contents.append("\n");
+  }
+  char length[32];
+  snprintf(length, sizeof(length), "R\t%zu\n", result.size());
+  contents.append(length).append(result);
+
+  // Write the entry under another name and move it into place, so that
+  // another process never reads a partial entry.
+  string path = directory_ + "/" + key;
+  char temp_suffix[32];
+  snprintf(temp_suffix, sizeof(temp_suffix), ".%d.tmp",
+           static_cast<int>(getpid()));
+  string temp_path = path + temp_suffix;
+  FILE* file = fopen(temp_path.c_str(), "wb");
+  if (!file)
+    return false;
+  bool ok = fwrite(contents.data(), 1, contents.size(), file) ==
+            contents.size();
+  ok = fclose(file) == 0 && ok;
+  if (!ok || rename(temp_path.c_str(), path.c_str()) != 0) {
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ProcessResultCache::GetSymbolFingerprint(const CodeModule* module,
+                                              string* fingerprint) {
+  string symbol_file;
+  if (!supplier_) {
+    *fingerprint = "none";
+    return true;
+  }
+  switch (supplier_->GetSymbolFile(module, NULL, &symbol_file)) {
+    case SymbolSupplier::NOT_FOUND:
+      *fingerprint = "none";
+      return true;
+    case SymbolSupplier::FOUND:
+      break;
+    default:
+      return false;
+  }
+
+  // A file replaced by another, even of the same size within the same
+  // second, is a new inode.
+  struct stat st;
+  if (stat(symbol_file.c_str(), &st) != 0)
+    return false;
+  char file_state[96];
+  snprintf(file_state, sizeof(file_state), " %llu %lld %llu",
+           static_cast<unsigned long long>(st.st_size),
+           static_cast<long long>(st.st_mtime),
+           static_cast<unsigned long long>(st.st_ino));
+  *fingerprint = symbol_file + file_state;
+  return true;
+}
+
+}  // namespace google_breakpad
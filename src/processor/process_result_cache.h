@@ -0,0 +1,104 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_result_cache.h: Keeps the results of processing minidumps, so
+// that processing a minidump again returns the earlier result as long as
+// none of the symbol files it could have used have changed.
+//
+// Reprocessing, after uploading new symbols or changing a setting, runs
+// the same minidumps through MinidumpProcessor again, and most of them
+// come out as they did before.  A ProcessResultCache keeps each result,
+// serialized by the caller (for instance with WriteProcessStateProto), in
+// a file of its own in a directory, named by a key made from the contents
+// of the minidump and from the settings that shape the result.  With the
+// result, it records the symbol file that the SymbolSupplier finds for
+// each of the minidump's modules, or that it finds none, along with the
+// file's size and modification time.  A result is only returned if the
+// supplier still finds the same files, unchanged, and still finds none
+// for the modules that had none.
+//
+// Every module of the minidump is recorded, not just those with frames,
+// since stack scanning consults the symbols of any module a candidate
+// return address falls in.
+
+#ifndef PROCESSOR_PROCESS_RESULT_CACHE_H__
+#define PROCESSOR_PROCESS_RESULT_CACHE_H__
+
+#include <string>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class CodeModule;
+class CodeModules;
+class SymbolSupplier;
+
+class ProcessResultCache {
+ public:
+  // Keeps results in |directory|, which must exist, checking them against
+  // the symbol files |supplier| finds.  |supplier| is not owned, and may
+  // be NULL when minidumps are processed without symbols.
+  ProcessResultCache(const string& directory, SymbolSupplier* supplier);
+
+  // Sets |key| to the key for the minidump in |minidump_file| processed
+  // with |settings|, which should name whatever besides the minidump and
+  // the symbols affects the result, such as the output format.  Returns
+  // false if the minidump cannot be read.
+  static bool GetKey(const string& minidump_file,
+                     const string& settings,
+                     string* key);
+
+  // Sets |result| to the result kept for |key|, and returns true, if
+  // there is one and the symbol files it was made with are unchanged.
+  bool Lookup(const string& key, string* result);
+
+  // Keeps |result| for |key|, made with the symbol files that the
+  // supplier now finds for |modules|.  Returns false if it could not be
+  // kept.
+  bool Store(const string& key,
+             const CodeModules* modules,
+             const string& result);
+
+ private:
+  // Sets |fingerprint| to what identifies the symbol file the supplier
+  // finds for |module|, or that it finds none.  Returns false if the
+  // supplier can't say.
+  bool GetSymbolFingerprint(const CodeModule* module, string* fingerprint);
+
+  string directory_;
+  SymbolSupplier* supplier_;
+
+  // Disallow unwanted copy ctor and assignment operator
+  ProcessResultCache(const ProcessResultCache&);
+  void operator=(const ProcessResultCache&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_PROCESS_RESULT_CACHE_H__
@@ -0,0 +1,176 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_result_cache_unittest.cc: Unit tests for ProcessResultCache.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "processor/process_result_cache.h"
+#include "processor/simple_symbol_supplier.h"
+#include "processor/stackwalker_unittest_utils.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::ProcessResultCache;
+using google_breakpad::SimpleSymbolSupplier;
+
+void WriteFile(const string& path, const string& contents) {
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_TRUE(file != NULL);
+  fwrite(contents.data(), 1, contents.size(), file);
+  fclose(file);
+}
+
+class ProcessResultCacheTest : public ::testing::Test {
+ public:
+  ProcessResultCacheTest()
+      : cache_dir_(temp_dir_.path() + "/cache"),
+        symbol_dir_(temp_dir_.path() + "/symbols"),
+        minidump_file_(temp_dir_.path() + "/dump.dmp"),
+        module1_(0x10000, 0x1000, "module1", "1.0"),
+        module2_(0x20000, 0x1000, "module2", "2.0"),
+        supplier_(symbol_dir_),
+        cache_(cache_dir_, &supplier_) {
+    mkdir(cache_dir_.c_str(), 0755);
+    mkdir(symbol_dir_.c_str(), 0755);
+    WriteFile(minidump_file_, "MDMP minidump contents");
+    modules_.Add(&module1_);
+    modules_.Add(&module2_);
+  }
+
+  // Writes |contents| as the symbol file SimpleSymbolSupplier finds for
+  // the mock module named |name|.
+  void WriteSymbolFile(const string& name, const string& contents) {
+    string path = symbol_dir_ + "/" + name;
+    mkdir(path.c_str(), 0755);
+    path += "/" + name;
+    mkdir(path.c_str(), 0755);
+    WriteFile(path + "/" + name + ".sym", contents);
+  }
+
+  AutoTempDir temp_dir_;
+  string cache_dir_;
+  string symbol_dir_;
+  string minidump_file_;
+  MockCodeModule module1_;
+  MockCodeModule module2_;
+  MockCodeModules modules_;
+  SimpleSymbolSupplier supplier_;
+  ProcessResultCache cache_;
+};
+
+TEST_F(ProcessResultCacheTest, StoreThenLookup) {
+  WriteSymbolFile("module1", "MODULE Linux x86_64 module1 module1\n");
+
+  string key;
+  ASSERT_TRUE(ProcessResultCache::GetKey(minidump_file_, "json", &key));
+  string result;
+  EXPECT_FALSE(cache_.Lookup(key, &result));
+
+  const string kResult("{\"status\":\"OK\"}\n\0binary", 24);
+  ASSERT_TRUE(cache_.Store(key, &modules_, kResult));
+  ASSERT_TRUE(cache_.Lookup(key, &result));
+  EXPECT_EQ(kResult, result);
+}
+
+TEST_F(ProcessResultCacheTest, KeyDependsOnDumpAndSettings) {
+  string key;
+  ASSERT_TRUE(ProcessResultCache::GetKey(minidump_file_, "json", &key));
+  string same_key;
+  ASSERT_TRUE(ProcessResultCache::GetKey(minidump_file_, "json", &same_key));
+  EXPECT_EQ(key, same_key);
+
+  string proto_key;
+  ASSERT_TRUE(ProcessResultCache::GetKey(minidump_file_, "proto",
+                                         &proto_key));
+  EXPECT_NE(key, proto_key);
+
+  WriteFile(minidump_file_, "MDMP other minidump contents");
+  string other_key;
+  ASSERT_TRUE(ProcessResultCache::GetKey(minidump_file_, "json",
+                                         &other_key));
+  EXPECT_NE(key, other_key);
+
+  EXPECT_FALSE(ProcessResultCache::GetKey(temp_dir_.path() + "/missing",
+                                          "json", &key));
+}
+
+TEST_F(ProcessResultCacheTest, ChangedSymbolFileMisses) {
+  WriteSymbolFile("module1", "MODULE Linux x86_64 module1 module1\n");
+
+  string key;
+  ASSERT_TRUE(ProcessResultCache::GetKey(minidump_file_, "json", &key));
+  ASSERT_TRUE(cache_.Store(key, &modules_, "result"));
+
+  WriteSymbolFile("module1", "MODULE Linux x86_64 module1 module1\n"
+                             "FUNC 0 10 0 function\n");
+  string result;
+  EXPECT_FALSE(cache_.Lookup(key, &result));
+}
+
+TEST_F(ProcessResultCacheTest, NewSymbolFileMisses) {
+  WriteSymbolFile("module1", "MODULE Linux x86_64 module1 module1\n");
+
+  string key;
+  ASSERT_TRUE(ProcessResultCache::GetKey(minidump_file_, "json", &key));
+  ASSERT_TRUE(cache_.Store(key, &modules_, "result"));
+
+  // Symbols uploaded for a module that had none.
+  WriteSymbolFile("module2", "MODULE Linux x86_64 module2 module2\n");
+  string result;
+  EXPECT_FALSE(cache_.Lookup(key, &result));
+}
+
+TEST_F(ProcessResultCacheTest, WithoutSupplier) {
+  ProcessResultCache cache(cache_dir_, NULL);
+
+  string key;
+  ASSERT_TRUE(ProcessResultCache::GetKey(minidump_file_, "json", &key));
+  ASSERT_TRUE(cache.Store(key, &modules_, "result"));
+  string result;
+  ASSERT_TRUE(cache.Lookup(key, &result));
+  EXPECT_EQ("result", result);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -37,11 +37,53 @@
 #endif
 
 #include "google_breakpad/processor/process_state.h"
+
+#include <map>
+
 #include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
 #include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/process_stats.h"
+#include "google_breakpad/processor/stack_frame.h"
 
 namespace google_breakpad {
 
+namespace {
+
+typedef std::map<const CodeModule*, const CodeModule*> ModuleMapping;
+
+// Returns a copy of |modules|, and adds to |mapping| the copy of each of
+// its modules.  A copy behaves as the original does, so the modules at each
+// sequence correspond.
+const CodeModules* CopyAndMap(const CodeModules* modules,
+                              ModuleMapping* mapping) {
+  if (!modules)
+    return NULL;
+  const CodeModules* copy = modules->Copy();
+  unsigned int count = copy->module_count();
+  for (unsigned int sequence = 0; sequence < count; ++sequence) {
+    const CodeModule* module = modules->GetModuleAtSequence(sequence);
+    if (!module)
+      continue;
+    const CodeModule* copied = copy->GetModuleAtSequence(sequence);
+    if (!copied || copied->base_address() != module->base_address() ||
+        copied->code_file() != module->code_file()) {
+      copied = copy->GetModuleForAddress(module->base_address());
+    }
+    if (copied)
+      (*mapping)[module] = copied;
+  }
+  return copy;
+}
+
+void Remap(const ModuleMapping& mapping, const CodeModule** module) {
+  ModuleMapping::const_iterator it = mapping.find(*module);
+  if (it != mapping.end())
+    *module = it->second;
+}
+
+}  // namespace
+
 ProcessState::~ProcessState() {
   Clear();
 }
@@ -63,14 +105,49 @@ void ProcessState::Clear() {
   threads_.clear();
   system_info_.Clear();
   thread_names_.clear();
+  breadcrumbs_.clear();
   // modules_without_symbols_ and modules_with_corrupt_symbols_ DO NOT own
   // the underlying CodeModule pointers.  Just clear the vectors.
   modules_without_symbols_.clear();
   modules_with_corrupt_symbols_.clear();
-  delete modules_;
+  if (!modules_borrowed_) {
+    delete modules_;
+    delete unloaded_modules_;
+  }
   modules_ = NULL;
-  delete unloaded_modules_;
   unloaded_modules_ = NULL;
+  modules_borrowed_ = false;
+  delete stats_;
+  stats_ = NULL;
+}
+
+bool ProcessState::ExpandInlineFrames(SourceLineResolverInterface* resolver) {
+  bool expanded = true;
+  for (CallStack* thread : threads_)
+    expanded &= thread->ExpandInlineFrames(resolver);
+  return expanded;
+}
+
+void ProcessState::CopyModules() {
+  if (!modules_borrowed_)
+    return;
+
+  ModuleMapping mapping;
+  modules_ = CopyAndMap(modules_, &mapping);
+  unloaded_modules_ = CopyAndMap(unloaded_modules_, &mapping);
+  modules_borrowed_ = false;
+
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    const vector<StackFrame*>* frames = threads_[i]->frames();
+    for (size_t j = 0; j < frames->size(); ++j) {
+      if ((*frames)[j]->module)
+        Remap(mapping, &(*frames)[j]->module);
+    }
+  }
+  for (size_t i = 0; i < modules_without_symbols_.size(); ++i)
+    Remap(mapping, &modules_without_symbols_[i]);
+  for (size_t i = 0; i < modules_with_corrupt_symbols_.size(); ++i)
+    Remap(mapping, &modules_with_corrupt_symbols_[i]);
 }
 
 }  // namespace google_breakpad
@@ -0,0 +1,529 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_writer.cc: Writes a ProcessState in structured forms.
+//
+// See process_state_writer.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/process_state_writer.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "google_breakpad/processor/system_info.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Field numbers from process_state.proto.
+enum ProcessStateField {
+  kTimeDateStamp = 1,
+  kCrash = 2,
+  kAssertion = 3,
+  kRequestingThread = 4,
+  kThreads = 5,
+  kModules = 6,
+  kOS = 7,
+  kOSShort = 8,
+  kOSVersion = 9,
+  kCPU = 10,
+  kCPUInfo = 11,
+  kCPUCount = 12,
+  kProcessCreateTime = 13,
+};
+
+enum CrashField {
+  kCrashReason = 1,
+  kCrashAddress = 2,
+};
+
+enum ThreadField {
+  kThreadFrames = 1,
+  kThreadBudgetExhausted = 2,
+};
+
+enum StackFrameField {
+  kFrameInstruction = 1,
+  kFrameModule = 2,
+  kFrameFunctionName = 3,
+  kFrameFunctionBase = 4,
+  kFrameSourceFileName = 5,
+  kFrameSourceLine = 6,
+  kFrameSourceLineBase = 7,
+};
+
+enum CodeModuleField {
+  kModuleBaseAddress = 1,
+  kModuleSize = 2,
+  kModuleCodeFile = 3,
+  kModuleCodeIdentifier = 4,
+  kModuleDebugFile = 5,
+  kModuleDebugIdentifier = 6,
+  kModuleVersion = 7,
+};
+
+// Protocol buffer wire types.
+const int kWireVarint = 0;
+const int kWireLengthDelimited = 2;
+
+// Encodes protocol buffer fields to |output|, or, with a NULL |output|,
+// only counts the bytes they would take, which is how the length of an
+// embedded message is found before the message is written.
+class ProtoWriter {
+ public:
+  explicit ProtoWriter(FILE* output) : output_(output), size_(0) {}
+
+  size_t size() const { return size_; }
+
+  void Varint(uint64_t value) {
+    do {
+      int byte = value & 0x7f;
+      value >>= 7;
+      if (value)
+        byte |= 0x80;
+      if (output_)
+        putc(byte, output_);
+      ++size_;
+    } while (value);
+  }
+
+  void Tag(int field, int wire_type) {
+    Varint(static_cast<uint64_t>(field) << 3 | wire_type);
+  }
+
+  // int32 and int64 fields share an encoding; negative values take ten
+  // bytes either way.
+  void IntField(int field, int64_t value) {
+    Tag(field, kWireVarint);
+    Varint(static_cast<uint64_t>(value));
+  }
+
+  void StringField(int field, const string& value) {
+    Tag(field, kWireLengthDelimited);
+    Varint(value.size());
+    if (output_)
+      fwrite(value.data(), 1, value.size(), output_);
+    size_ += value.size();
+  }
+
+  // Writes |value| as an embedded message, using |write| to encode it.
+  template<typename T>
+  void MessageField(int field,
+                    void (*write)(const T& value, ProtoWriter* writer),
+                    const T& value) {
+    ProtoWriter counter(NULL);
+    write(value, &counter);
+    Tag(field, kWireLengthDelimited);
+    Varint(counter.size());
+    if (output_)
+      write(value, this);
+    else
+      size_ += counter.size();
+  }
+
+ private:
+  FILE* output_;
+  size_t size_;
+};
+
+void WriteCodeModuleProto(const CodeModule& module, ProtoWriter* writer) {
+  writer->IntField(kModuleBaseAddress, module.base_address());
+  writer->IntField(kModuleSize, module.size());
+  if (!module.code_file().empty())
+    writer->StringField(kModuleCodeFile, module.code_file());
+  if (!module.code_identifier().empty())
+    writer->StringField(kModuleCodeIdentifier, module.code_identifier());
+  if (!module.debug_file().empty())
+    writer->StringField(kModuleDebugFile, module.debug_file());
+  if (!module.debug_identifier().empty())
+    writer->StringField(kModuleDebugIdentifier, module.debug_identifier());
+  if (!module.version().empty())
+    writer->StringField(kModuleVersion, module.version());
+}
+
+void WriteStackFrameProto(const StackFrame& frame, ProtoWriter* writer) {
+  writer->IntField(kFrameInstruction, frame.instruction);
+  if (frame.module)
+    writer->MessageField(kFrameModule, WriteCodeModuleProto, *frame.module);
+  if (!frame.function_name.empty()) {
+    writer->StringField(kFrameFunctionName, frame.function_name);
+    writer->IntField(kFrameFunctionBase, frame.function_base);
+  }
+  if (!frame.source_file_name.empty()) {
+    writer->StringField(kFrameSourceFileName, frame.source_file_name);
+    writer->IntField(kFrameSourceLine, frame.source_line);
+    writer->IntField(kFrameSourceLineBase, frame.source_line_base);
+  }
+}
+
+void WriteThreadProto(const CallStack& stack, ProtoWriter* writer) {
+  const vector<StackFrame*>* frames = stack.frames();
+  for (size_t i = 0; i < frames->size(); ++i)
+    writer->MessageField(kThreadFrames, WriteStackFrameProto, *frames->at(i));
+  if (stack.budget_exhausted())
+    writer->IntField(kThreadBudgetExhausted, 1);
+}
+
+void WriteCrashProto(const ProcessState& process_state, ProtoWriter* writer) {
+  writer->StringField(kCrashReason, process_state.crash_reason());
+  writer->IntField(kCrashAddress, process_state.crash_address());
+}
+
+// Writes the fields that come before the threads.
+void WriteProcessStateProtoHead(const ProcessState& process_state,
+                                ProtoWriter* writer) {
+  writer->IntField(kTimeDateStamp, process_state.time_date_stamp());
+  if (process_state.crashed())
+    writer->MessageField(kCrash, WriteCrashProto, process_state);
+  if (!process_state.assertion().empty())
+    writer->StringField(kAssertion, process_state.assertion());
+  if (process_state.requesting_thread() >= 0)
+    writer->IntField(kRequestingThread, process_state.requesting_thread());
+}
+
+// Writes the fields that come after the threads.
+void WriteProcessStateProtoTail(const ProcessState& process_state,
+                                ProtoWriter* writer) {
+  const CodeModules* modules = process_state.modules();
+  if (modules) {
+    for (unsigned int i = 0; i < modules->module_count(); ++i) {
+      writer->MessageField(kModules, WriteCodeModuleProto,
+                           *modules->GetModuleAtSequence(i));
+    }
+  }
+
+  const SystemInfo* system_info = process_state.system_info();
+  if (!system_info->os.empty())
+    writer->StringField(kOS, system_info->os);
+  if (!system_info->os_short.empty())
+    writer->StringField(kOSShort, system_info->os_short);
+  if (!system_info->os_version.empty())
+    writer->StringField(kOSVersion, system_info->os_version);
+  if (!system_info->cpu.empty())
+    writer->StringField(kCPU, system_info->cpu);
+  if (!system_info->cpu_info.empty())
+    writer->StringField(kCPUInfo, system_info->cpu_info);
+  writer->IntField(kCPUCount, system_info->cpu_count);
+  if (process_state.process_create_time())
+    writer->IntField(kProcessCreateTime, process_state.process_create_time());
+}
+
+void WriteProcessStateProtoFields(const ProcessState& process_state,
+                                  ProtoWriter* writer) {
+  WriteProcessStateProtoHead(process_state, writer);
+  const vector<CallStack*>* threads = process_state.threads();
+  for (size_t i = 0; i < threads->size(); ++i)
+    writer->MessageField(kThreads, WriteThreadProto, *threads->at(i));
+  WriteProcessStateProtoTail(process_state, writer);
+}
+
+// Writes JSON to a stream, inserting the commas between members and
+// elements.
+class JSONWriter {
+ public:
+  explicit JSONWriter(FILE* output) : output_(output), after_key_(false) {}
+
+  void BeginObject() {
+    BeginValue();
+    putc('{', output_);
+    first_.push_back(true);
+  }
+
+  void EndObject() {
+    first_.pop_back();
+    putc('}', output_);
+  }
+
+  void BeginArray() {
+    BeginValue();
+    putc('[', output_);
+    first_.push_back(true);
+  }
+
+  void EndArray() {
+    first_.pop_back();
+    putc(']', output_);
+  }
+
+  // Starts an object member; its value must follow.
+  void Key(const char* name) {
+    BeginValue();
+    Escaped(name, strlen(name));
+    putc(':', output_);
+    after_key_ = true;
+  }
+
+  void String(const string& value) {
+    BeginValue();
+    Escaped(value.data(), value.size());
+  }
+
+  void Int(int64_t value) {
+    BeginValue();
+    fprintf(output_, "%" PRId64, value);
+  }
+
+  void Hex(uint64_t value) {
+    BeginValue();
+    fprintf(output_, "\"0x%" PRIx64 "\"", value);
+  }
+
+  void Bool(bool value) {
+    BeginValue();
+    fputs(value ? "true" : "false", output_);
+  }
+
+ private:
+  void BeginValue() {
+    if (after_key_) {
+      after_key_ = false;
+      return;
+    }
+    if (!first_.empty()) {
+      if (!first_.back())
+        putc(',', output_);
+      first_.back() = false;
+    }
+  }
+
+  // Writes |value| as a quoted string.
+  void Escaped(const char* value, size_t size) {
+    putc('"', output_);
+    for (size_t i = 0; i < size; ++i) {
+      unsigned char c = value[i];
+      if (c == '"' || c == '\\') {
+        putc('\\', output_);
+        putc(c, output_);
+      } else if (c < 0x20) {
+        fprintf(output_, "\\u%04x", c);
+      } else {
+        putc(c, output_);
+      }
+    }
+    putc('"', output_);
+  }
+
+  FILE* output_;
+  // Whether the innermost open object or array is still empty.
+  std::vector<bool> first_;
+  // Whether a member's key has been written without its value.
+  bool after_key_;
+};
+
+void WriteCodeModuleJSON(const CodeModule& module, JSONWriter* writer) {
+  writer->BeginObject();
+  writer->Key("base_address");
+  writer->Hex(module.base_address());
+  writer->Key("size");
+  writer->Hex(module.size());
+  writer->Key("code_file");
+  writer->String(module.code_file());
+  writer->Key("code_identifier");
+  writer->String(module.code_identifier());
+  writer->Key("debug_file");
+  writer->String(module.debug_file());
+  writer->Key("debug_identifier");
+  writer->String(module.debug_identifier());
+  writer->Key("version");
+  writer->String(module.version());
+  writer->EndObject();
+}
+
+void WriteStackFrameJSON(const StackFrame& frame, JSONWriter* writer) {
+  writer->BeginObject();
+  writer->Key("instruction");
+  writer->Hex(frame.instruction);
+  if (frame.module) {
+    // The module itself is among the process's modules.
+    writer->Key("module");
+    writer->String(frame.module->code_file());
+    writer->Key("module_offset");
+    writer->Hex(frame.instruction - frame.module->base_address());
+  }
+  if (!frame.function_name.empty()) {
+    writer->Key("function_name");
+    writer->String(frame.function_name);
+    writer->Key("function_base");
+    writer->Hex(frame.function_base);
+  }
+  if (!frame.source_file_name.empty()) {
+    writer->Key("source_file_name");
+    writer->String(frame.source_file_name);
+    writer->Key("source_line");
+    writer->Int(frame.source_line);
+    writer->Key("source_line_base");
+    writer->Hex(frame.source_line_base);
+  }
+  writer->Key("trust");
+  writer->String(frame.trust_description());
+  writer->EndObject();
+}
+
+}  // namespace
+
+bool WriteProcessStateProto(const ProcessState& process_state,
+                            bool delimited,
+                            FILE* output) {
+  ProtoWriter writer(output);
+  if (delimited) {
+    ProtoWriter counter(NULL);
+    WriteProcessStateProtoFields(process_state, &counter);
+    writer.Varint(counter.size());
+  }
+  WriteProcessStateProtoFields(process_state, &writer);
+  return !ferror(output);
+}
+
+ProcessStateProtoStreamWriter::ProcessStateProtoStreamWriter(FILE* output)
+    : output_(output), threads_written_(0) {
+}
+
+void ProcessStateProtoStreamWriter::OnProcessInfo(
+    const ProcessState& process_state) {
+  ProtoWriter writer(output_);
+  WriteProcessStateProtoHead(process_state, &writer);
+  fflush(output_);
+}
+
+void ProcessStateProtoStreamWriter::OnThread(const ProcessState& process_state,
+                                             int thread_index) {
+  if (walked_.size() <= static_cast<size_t>(thread_index))
+    walked_.resize(thread_index + 1, false);
+  walked_[thread_index] = true;
+
+  // The threads are written in order, so one delivered ahead of those
+  // before it, as the requesting thread is, waits for them.
+  ProtoWriter writer(output_);
+  const size_t threads_written = threads_written_;
+  for (; threads_written_ < walked_.size() && walked_[threads_written_];
+       ++threads_written_) {
+    writer.MessageField(kThreads, WriteThreadProto,
+                        *process_state.threads()->at(threads_written_));
+  }
+  if (threads_written_ != threads_written)
+    fflush(output_);
+}
+
+bool ProcessStateProtoStreamWriter::Finish(const ProcessState& process_state) {
+  ProtoWriter writer(output_);
+  WriteProcessStateProtoTail(process_state, &writer);
+  return !ferror(output_);
+}
+
+bool WriteProcessStateJSON(const ProcessState& process_state, FILE* output) {
+  JSONWriter writer(output);
+  writer.BeginObject();
+  writer.Key("time_date_stamp");
+  writer.Int(process_state.time_date_stamp());
+  if (process_state.process_create_time()) {
+    writer.Key("process_create_time");
+    writer.Int(process_state.process_create_time());
+  }
+  if (process_state.crashed()) {
+    writer.Key("crash");
+    writer.BeginObject();
+    writer.Key("reason");
+    writer.String(process_state.crash_reason());
+    writer.Key("address");
+    writer.Hex(process_state.crash_address());
+    writer.EndObject();
+  }
+  if (!process_state.assertion().empty()) {
+    writer.Key("assertion");
+    writer.String(process_state.assertion());
+  }
+  if (process_state.requesting_thread() >= 0) {
+    writer.Key("requesting_thread");
+    writer.Int(process_state.requesting_thread());
+  }
+
+  const SystemInfo* system_info = process_state.system_info();
+  writer.Key("os");
+  writer.String(system_info->os);
+  writer.Key("os_short");
+  writer.String(system_info->os_short);
+  writer.Key("os_version");
+  writer.String(system_info->os_version);
+  writer.Key("cpu");
+  writer.String(system_info->cpu);
+  writer.Key("cpu_info");
+  writer.String(system_info->cpu_info);
+  writer.Key("cpu_count");
+  writer.Int(system_info->cpu_count);
+
+  writer.Key("modules");
+  writer.BeginArray();
+  const CodeModules* modules = process_state.modules();
+  if (modules) {
+    for (unsigned int i = 0; i < modules->module_count(); ++i)
+      WriteCodeModuleJSON(*modules->GetModuleAtSequence(i), &writer);
+  }
+  writer.EndArray();
+
+  writer.Key("threads");
+  writer.BeginArray();
+  const vector<CallStack*>* threads = process_state.threads();
+  for (size_t i = 0; i < threads->size(); ++i) {
+    const CallStack* stack = threads->at(i);
+    writer.BeginObject();
+    writer.Key("thread_id");
+    writer.Int(stack->tid());
+    if (stack->budget_exhausted()) {
+      writer.Key("budget_exhausted");
+      writer.Bool(true);
+    }
+    writer.Key("frames");
+    writer.BeginArray();
+    const vector<StackFrame*>* frames = stack->frames();
+    for (size_t j = 0; j < frames->size(); ++j)
+      WriteStackFrameJSON(*frames->at(j), &writer);
+    writer.EndArray();
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  writer.EndObject();
+  putc('\n', output);
+  return !ferror(output);
+}
+
+}  // namespace google_breakpad
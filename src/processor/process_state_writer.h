@@ -0,0 +1,90 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_writer.h: Writes a ProcessState in structured forms meant
+// for programs rather than people.
+//
+// WriteProcessStateProto writes the ProcessStateProto message described by
+// src/processor/proto/process_state.proto in protocol buffer wire format,
+// without needing the protobuf library.  WriteProcessStateJSON writes the
+// same information, and a little more, as one line of JSON.  Both stream
+// directly to |output| instead of building the result in memory.
+
+#ifndef PROCESSOR_PROCESS_STATE_WRITER_H__
+#define PROCESSOR_PROCESS_STATE_WRITER_H__
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "google_breakpad/processor/process_observer.h"
+
+namespace google_breakpad {
+
+class ProcessState;
+
+// Writes |process_state| to |output| as a ProcessStateProto.  If
+// |delimited| is true, the message is preceded by its length as a varint,
+// so that several messages can be written to one stream, as protobuf's
+// writeDelimitedTo does.  Returns false if writing failed.
+bool WriteProcessStateProto(const ProcessState& process_state,
+                            bool delimited,
+                            FILE* output);
+
+// Writes |process_state| to |output| as a JSON object on a single line,
+// ending with a newline.  Field names follow process_state.proto.
+// Addresses are written as hexadecimal strings, since JSON readers often
+// cannot represent 64-bit integers.  Frames also carry "trust", and
+// threads "thread_id".  Returns false if writing failed.
+bool WriteProcessStateJSON(const ProcessState& process_state, FILE* output);
+
+// Writes a ProcessState to |output| as MinidumpProcessor::Process delivers
+// it, as the same bytes WriteProcessStateProto writes without |delimited|.
+// Each thread is written once it and the threads before it are walked.
+class ProcessStateProtoStreamWriter : public ProcessObserver {
+ public:
+  explicit ProcessStateProtoStreamWriter(FILE* output);
+
+  void OnProcessInfo(const ProcessState& process_state) override;
+  void OnThread(const ProcessState& process_state, int thread_index) override;
+
+  // Writes what follows the threads, once Process has returned PROCESS_OK.
+  // Returns false if writing failed.
+  bool Finish(const ProcessState& process_state);
+
+ private:
+  FILE* output_;
+  // Whether each thread has been delivered, by index.
+  std::vector<bool> walked_;
+  // The number of threads written.
+  size_t threads_written_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_PROCESS_STATE_WRITER_H__
@@ -0,0 +1,260 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_writer_unittest.cc: Unit tests for the structured
+// ProcessState writers.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "processor/process_state_writer.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::ProcessState;
+using google_breakpad::ProcessStateProtoStreamWriter;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::WriteProcessStateJSON;
+using google_breakpad::WriteProcessStateProto;
+using std::multimap;
+using std::vector;
+
+string GetTestDataPath() {
+  char* srcdir = getenv("srcdir");
+
+  return string(srcdir ? srcdir : ".") + "/src/processor/testdata/";
+}
+
+// Reads everything written to |file|.
+string ReadBack(FILE* file) {
+  string contents;
+  rewind(file);
+  char buffer[4096];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    contents.append(buffer, count);
+  return contents;
+}
+
+// Just enough of a protocol buffer decoder to check the writer's output:
+// splits a message into its fields, keeping varints as numbers and
+// length-delimited fields as bytes.
+struct ProtoField {
+  uint64_t number;
+  string bytes;
+};
+typedef multimap<int, ProtoField> ProtoFields;
+
+bool ReadVarint(const string& data, size_t* offset, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64 && *offset < data.size(); shift += 7) {
+    uint8_t byte = data[(*offset)++];
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+bool DecodeProto(const string& data, ProtoFields* fields) {
+  size_t offset = 0;
+  while (offset < data.size()) {
+    uint64_t tag;
+    ProtoField field;
+    if (!ReadVarint(data, &offset, &tag))
+      return false;
+    switch (tag & 7) {
+      case 0:
+        if (!ReadVarint(data, &offset, &field.number))
+          return false;
+        break;
+      case 2: {
+        uint64_t length;
+        if (!ReadVarint(data, &offset, &length) ||
+            length > data.size() - offset)
+          return false;
+        field.bytes = data.substr(offset, length);
+        offset += length;
+        break;
+      }
+      default:
+        return false;
+    }
+    fields->insert(std::make_pair(static_cast<int>(tag >> 3), field));
+  }
+  return true;
+}
+
+vector<ProtoField> Repeated(const ProtoFields& fields, int number) {
+  vector<ProtoField> result;
+  for (ProtoFields::const_iterator it = fields.lower_bound(number);
+       it != fields.upper_bound(number); ++it)
+    result.push_back(it->second);
+  return result;
+}
+
+class ProcessStateWriterTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    SimpleSymbolSupplier supplier(GetTestDataPath() + "symbols");
+    BasicSourceLineResolver resolver;
+    MinidumpProcessor processor(&supplier, &resolver);
+    ASSERT_EQ(google_breakpad::PROCESS_OK,
+              processor.Process(GetTestDataPath() + "minidump2.dmp", &state_));
+    file_ = tmpfile();
+    ASSERT_TRUE(file_ != NULL);
+  }
+
+  virtual void TearDown() {
+    if (file_)
+      fclose(file_);
+  }
+
+  ProcessState state_;
+  FILE* file_;
+};
+
+TEST_F(ProcessStateWriterTest, Proto) {
+  ASSERT_TRUE(WriteProcessStateProto(state_, false, file_));
+  ProtoFields fields;
+  ASSERT_TRUE(DecodeProto(ReadBack(file_), &fields));
+
+  ASSERT_EQ(1U, fields.count(1));
+  EXPECT_EQ(state_.time_date_stamp(), fields.find(1)->second.number);
+  EXPECT_EQ("x86", fields.find(10)->second.bytes);
+  EXPECT_EQ(state_.modules()->module_count(), Repeated(fields, 6).size());
+
+  ProtoFields crash;
+  ASSERT_TRUE(DecodeProto(fields.find(2)->second.bytes, &crash));
+  EXPECT_EQ("EXCEPTION_ACCESS_VIOLATION_WRITE", crash.find(1)->second.bytes);
+  EXPECT_EQ(0x45U, crash.find(2)->second.number);
+
+  vector<ProtoField> threads = Repeated(fields, 5);
+  ASSERT_EQ(state_.threads()->size(), threads.size());
+  ProtoFields thread;
+  ASSERT_TRUE(DecodeProto(threads[0].bytes, &thread));
+  vector<ProtoField> frames = Repeated(thread, 1);
+  ASSERT_EQ(4U, frames.size());
+
+  ProtoFields frame;
+  ASSERT_TRUE(DecodeProto(frames[0].bytes, &frame));
+  EXPECT_EQ(0x40429eU, frame.find(1)->second.number);
+  EXPECT_EQ("`anonymous namespace'::CrashFunction",
+            frame.find(3)->second.bytes);
+  EXPECT_EQ(58U, frame.find(6)->second.number);
+  ProtoFields module;
+  ASSERT_TRUE(DecodeProto(frame.find(2)->second.bytes, &module));
+  EXPECT_EQ(0x400000U, module.find(1)->second.number);
+
+  // The last frame has no symbols, so its optional fields are left out.
+  frame.clear();
+  ASSERT_TRUE(DecodeProto(frames[3].bytes, &frame));
+  EXPECT_EQ(0U, frame.count(5));
+  EXPECT_EQ(0U, frame.count(6));
+}
+
+TEST_F(ProcessStateWriterTest, DelimitedProto) {
+  ASSERT_TRUE(WriteProcessStateProto(state_, true, file_));
+  ASSERT_TRUE(WriteProcessStateProto(state_, true, file_));
+  string contents = ReadBack(file_);
+
+  size_t offset = 0;
+  for (int i = 0; i < 2; ++i) {
+    uint64_t length;
+    ASSERT_TRUE(ReadVarint(contents, &offset, &length));
+    ASSERT_LE(length, contents.size() - offset);
+    ProtoFields fields;
+    EXPECT_TRUE(DecodeProto(contents.substr(offset, length), &fields));
+    EXPECT_EQ(state_.time_date_stamp(), fields.find(1)->second.number);
+    offset += length;
+  }
+  EXPECT_EQ(contents.size(), offset);
+}
+
+TEST_F(ProcessStateWriterTest, StreamedProto) {
+  ASSERT_TRUE(WriteProcessStateProto(state_, false, file_));
+  const string expected = ReadBack(file_);
+
+  FILE* streamed = tmpfile();
+  ASSERT_TRUE(streamed != NULL);
+  ProcessStateProtoStreamWriter writer(streamed);
+  writer.OnProcessInfo(state_);
+  const long head_size = ftell(streamed);
+  EXPECT_GT(head_size, 0);
+
+  // Each thread is written as it is handed over.
+  ASSERT_EQ(1U, state_.threads()->size());
+  writer.OnThread(state_, 0);
+  EXPECT_LT(head_size, ftell(streamed));
+  ASSERT_TRUE(writer.Finish(state_));
+
+  EXPECT_EQ(expected, ReadBack(streamed));
+  fclose(streamed);
+}
+
+TEST_F(ProcessStateWriterTest, JSON) {
+  ASSERT_TRUE(WriteProcessStateJSON(state_, file_));
+  string contents = ReadBack(file_);
+
+  ASSERT_FALSE(contents.empty());
+  EXPECT_EQ('{', contents[0]);
+  EXPECT_EQ("}\n", contents.substr(contents.size() - 2));
+  EXPECT_EQ(contents.size() - 1, contents.find('\n'));
+  EXPECT_NE(string::npos, contents.find("\"time_date_stamp\":1171480435"));
+  EXPECT_NE(string::npos,
+            contents.find("\"reason\":\"EXCEPTION_ACCESS_VIOLATION_WRITE\""));
+  EXPECT_NE(string::npos, contents.find("\"address\":\"0x45\""));
+  EXPECT_NE(string::npos, contents.find(
+      "\"function_name\":\"`anonymous namespace'::CrashFunction\""));
+  EXPECT_NE(string::npos, contents.find("\"source_file_name\":"
+                                        "\"c:\\\\test_app.cc\""));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,78 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_stats.cc: Records where the time and work of processing a
+// minidump went.
+//
+// See process_stats.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "google_breakpad/processor/process_stats.h"
+
+namespace google_breakpad {
+
+namespace {
+
+thread_local ProcessStats* current_stats = NULL;
+
+}  // namespace
+
+ProcessStats::ProcessStats()
+    : symbol_supplier_calls_(0),
+      symbol_supplier_nanoseconds_(0),
+      scanned_words_(0),
+      memory_read_failures_(0),
+      stackwalk_nanoseconds_(0),
+      exploitability_nanoseconds_(0),
+      total_nanoseconds_(0) {
+  for (int i = 0; i < kFrameTrustCount; ++i)
+    frames_by_trust_[i] = 0;
+}
+
+void ProcessStats::AddModuleLoad(const ModuleLoad& load) {
+  std::lock_guard<std::mutex> lock(module_loads_mutex_);
+  module_loads_.push_back(load);
+}
+
+// static
+ProcessStats* ProcessStats::Current() {
+  return current_stats;
+}
+
+ProcessStats::Scope::Scope(ProcessStats* stats) : previous_(current_stats) {
+  current_stats = stats;
+}
+
+ProcessStats::Scope::~Scope() {
+  current_stats = previous_;
+}
+
+}  // namespace google_breakpad
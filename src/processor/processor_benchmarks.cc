@@ -0,0 +1,686 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// processor_benchmarks.cc: Times the stages of processing a minidump on
+// synthetic input: Minidump::Read, Stackwalker::Walk for each CPU with and
+// without STACK CFI records, a pass over the registers of a 1000-thread
+// list, loading symbols into and looking them up in both source line
+// resolvers, and PrintProcessState.
+//
+// Usage: processor_benchmarks [-t threads] [-d depth] [-m modules]
+//                             [-r regions] [-f functions] [-l lookups]
+//                             [-i iterations] [-j]
+//
+// The dumps are built with SynthMinidump.  Each thread's stack is a chain
+// of |depth| frame pointers whose return addresses fall in |modules|
+// modules, and the memory list holds |regions| ranges besides the stacks.
+// The symbol file has |functions| functions.  With -j, the results are
+// printed as JSON so that runs can be compared over time.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/path_helper.h"
+#include "common/scoped_ptr.h"
+#include "common/test_assembler.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/common/minidump_format.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
+#include "google_breakpad/processor/minidump.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "google_breakpad/processor/stackwalker.h"
+#include "google_breakpad/processor/system_info.h"
+#include "processor/basic_code_module.h"
+#include "processor/logging.h"
+#include "processor/module_serializer.h"
+#include "processor/stackwalk_common.h"
+#include "processor/synth_minidump.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CallStack;
+using google_breakpad::CodeModule;
+using google_breakpad::DumpContext;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::LogStream;
+using google_breakpad::Minidump;
+using google_breakpad::MinidumpContext;
+using google_breakpad::MinidumpMemoryRegion;
+using google_breakpad::MinidumpModuleList;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::MinidumpThread;
+using google_breakpad::MinidumpThreadList;
+using google_breakpad::ModuleSerializer;
+using google_breakpad::ProcessState;
+using google_breakpad::SourceLineResolverInterface;
+using google_breakpad::StackFrame;
+using google_breakpad::StackFrameSymbolizer;
+using google_breakpad::Stackwalker;
+using google_breakpad::SystemInfo;
+using google_breakpad::scoped_array;
+using google_breakpad::scoped_ptr;
+using google_breakpad::test_assembler::kLittleEndian;
+using std::unique_ptr;
+using std::vector;
+
+namespace synth = google_breakpad::SynthMinidump;
+
+struct Options {
+  Options()
+      : num_threads(32),
+        stack_depth(64),
+        num_modules(100),
+        num_regions(100),
+        num_functions(100000),
+        num_lookups(1000000),
+        iterations(10),
+        json(false) { }
+
+  uint64_t num_threads;
+  uint64_t stack_depth;
+  uint64_t num_modules;
+  uint64_t num_regions;
+  uint64_t num_functions;
+  uint64_t num_lookups;
+  uint64_t iterations;
+  bool json;
+};
+
+// The CPUs that dumps are built for.
+struct CPU {
+  const char* name;
+  uint16_t architecture;
+  // The size of a pointer, and so of a stack slot.
+  size_t pointer_size;
+  // STACK CFI rules that unwind the frame pointer chains BuildDump lays
+  // out.
+  const char* cfi_rules;
+};
+
+const CPU kCPUs[] = {
+  { "x86", MD_CPU_ARCHITECTURE_X86, 4,
+    ".cfa: $ebp 8 + .ra: .cfa 4 - ^ $ebp: .cfa 8 - ^" },
+  { "amd64", MD_CPU_ARCHITECTURE_AMD64, 8,
+    ".cfa: $rbp 16 + .ra: .cfa 8 - ^ $rbp: .cfa 16 - ^" },
+  { "arm64", MD_CPU_ARCHITECTURE_ARM64, 8,
+    ".cfa: x29 16 + .ra: .cfa 8 - ^ x29: .cfa 16 - ^" },
+};
+
+// Where the synthetic process's pieces are.  The addresses fit in 32 bits
+// so that every CPU can use them.
+const uint64_t kModuleBase = 0x40000000;
+const uint64_t kModuleSize = 0x100000;
+const uint64_t kStackBase = 0x10000000;
+const uint64_t kStackStride = 0x100000;
+const uint64_t kRegionBase = 0x20000000;
+const uint64_t kRegionSize = 0x100;
+
+// The result of one benchmark.
+struct Result {
+  string name;
+  uint64_t iterations;
+  double ns_per_iteration;
+  // What one iteration covers, such as frames walked, and how many.
+  const char* item;
+  uint64_t items_per_iteration;
+};
+
+// Runs |function| |iterations| times and returns the mean nanoseconds per
+// run.
+template <typename Function>
+double Time(uint64_t iterations, Function function) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; ++i)
+    function();
+  return std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+// Returns the address that frame |frame| of a stack returns to.
+uint64_t ReturnAddress(const Options& options, uint64_t frame) {
+  return kModuleBase + (frame % options.num_modules) * kModuleSize +
+         0x1000 + (frame % 256) * 0x10;
+}
+
+// Appends a pointer-sized |value| to |section|.
+void AppendPointer(const CPU& cpu, synth::Section* section, uint64_t value) {
+  if (cpu.pointer_size == 4)
+    section->D32(static_cast<uint32_t>(value));
+  else
+    section->D64(value);
+}
+
+// Returns a context for a thread stopped with its stack pointer and frame
+// pointer at |stack_base|, in the first module.
+unique_ptr<synth::Context> MakeContext(const CPU& cpu, const synth::Dump& dump,
+                                       const Options& options,
+                                       uint64_t stack_base) {
+  uint64_t pc = kModuleBase + 0x100;
+  if (cpu.architecture == MD_CPU_ARCHITECTURE_X86) {
+    MDRawContextX86 raw_context = MDRawContextX86();
+    raw_context.context_flags = MD_CONTEXT_X86_FULL;
+    raw_context.eip = static_cast<uint32_t>(pc);
+    raw_context.esp = static_cast<uint32_t>(stack_base);
+    raw_context.ebp = static_cast<uint32_t>(stack_base);
+    return unique_ptr<synth::Context>(new synth::Context(dump, raw_context));
+  }
+
+  // SynthMinidump has no contexts for these CPUs, so the raw structures are
+  // copied in; this host's byte order is the dump's.
+  unique_ptr<synth::Context> context(new synth::Context(dump));
+  if (cpu.architecture == MD_CPU_ARCHITECTURE_AMD64) {
+    MDRawContextAMD64 raw_context = MDRawContextAMD64();
+    raw_context.context_flags = MD_CONTEXT_AMD64_FULL;
+    raw_context.rip = pc;
+    raw_context.rsp = stack_base;
+    raw_context.rbp = stack_base;
+    context->Append(reinterpret_cast<const uint8_t*>(&raw_context),
+                    sizeof(raw_context));
+  } else {
+    MDRawContextARM64 raw_context = MDRawContextARM64();
+    raw_context.context_flags = MD_CONTEXT_ARM64_FULL;
+    raw_context.iregs[MD_CONTEXT_ARM64_REG_PC] = pc;
+    raw_context.iregs[MD_CONTEXT_ARM64_REG_SP] = stack_base;
+    raw_context.iregs[MD_CONTEXT_ARM64_REG_FP] = stack_base;
+    raw_context.iregs[MD_CONTEXT_ARM64_REG_LR] = ReturnAddress(options, 0);
+    context->Append(reinterpret_cast<const uint8_t*>(&raw_context),
+                    sizeof(raw_context));
+  }
+  return context;
+}
+
+// Returns the contents of a minidump of a process running on |cpu|, shaped
+// by |options|.
+string BuildDump(const CPU& cpu, const Options& options) {
+  synth::Dump dump(0, kLittleEndian);
+
+  MDRawSystemInfo raw_system_info = synth::SystemInfo::windows_x86;
+  raw_system_info.processor_architecture = cpu.architecture;
+  raw_system_info.platform_id = MD_OS_LINUX;
+  synth::String csd_version(dump, "");
+  synth::SystemInfo system_info(dump, raw_system_info, csd_version);
+  dump.Add(&system_info);
+  dump.Add(&csd_version);
+
+  vector<unique_ptr<synth::String>> names;
+  vector<unique_ptr<synth::Module>> modules;
+  for (uint64_t i = 0; i < options.num_modules; ++i) {
+    names.emplace_back(new synth::String(
+        dump, "/system/lib/libbench" + std::to_string(i) + ".so"));
+    modules.emplace_back(new synth::Module(
+        dump, kModuleBase + i * kModuleSize, kModuleSize, *names.back()));
+    dump.Add(modules.back().get());
+    dump.Add(names.back().get());
+  }
+
+  // Each frame holds its caller's frame pointer and its return address,
+  // followed by room for locals.
+  const uint64_t frame_size = cpu.pointer_size * 4;
+  vector<unique_ptr<synth::Memory>> stacks;
+  vector<unique_ptr<synth::Context>> contexts;
+  vector<unique_ptr<synth::Thread>> threads;
+  for (uint64_t t = 0; t < options.num_threads; ++t) {
+    uint64_t stack_base = kStackBase + t * kStackStride;
+    stacks.emplace_back(new synth::Memory(dump, stack_base));
+    synth::Memory* stack = stacks.back().get();
+    for (uint64_t frame = 0; frame < options.stack_depth; ++frame) {
+      bool last = frame + 1 == options.stack_depth;
+      AppendPointer(cpu, stack,
+                    last ? 0 : stack_base + (frame + 1) * frame_size);
+      AppendPointer(cpu, stack, last ? 0 : ReturnAddress(options, frame + 1));
+      stack->Append(frame_size - 2 * cpu.pointer_size, 0);
+    }
+    contexts.push_back(MakeContext(cpu, dump, options, stack_base));
+    threads.emplace_back(new synth::Thread(dump, static_cast<uint32_t>(t + 1),
+                                           *stack, *contexts.back()));
+    dump.Add(stack);
+    dump.Add(contexts.back().get());
+    dump.Add(threads.back().get());
+  }
+
+  vector<unique_ptr<synth::Memory>> regions;
+  for (uint64_t i = 0; i < options.num_regions; ++i) {
+    regions.emplace_back(new synth::Memory(dump,
+                                           kRegionBase + i * kRegionSize));
+    regions.back()->Append(kRegionSize, static_cast<uint8_t>(i));
+    dump.Add(regions.back().get());
+  }
+
+  dump.Finish();
+  string contents;
+  if (!dump.GetContents(&contents)) {
+    fprintf(stderr, "Can't build the %s dump\n", cpu.name);
+    exit(1);
+  }
+  return contents;
+}
+
+// Returns the text of a symbol file with |num_functions| functions of two
+// lines each, spaced 0x40 bytes apart.
+string SyntheticSymbolData(uint64_t num_functions) {
+  string data = "MODULE Linux x86_64 000000000000000000000000000000000 bench\n"
+                "FILE 0 bench.cc\n";
+  char line[128];
+  for (uint64_t i = 0; i < num_functions; ++i) {
+    uint64_t address = 0x1000 + i * 0x40;
+    snprintf(line, sizeof(line),
+             "FUNC %llx 30 0 function_%llu\n%llx 18 %llu 0\n%llx 18 %llu 0\n",
+             static_cast<unsigned long long>(address),
+             static_cast<unsigned long long>(i),
+             static_cast<unsigned long long>(address),
+             static_cast<unsigned long long>(i * 2),
+             static_cast<unsigned long long>(address + 0x18),
+             static_cast<unsigned long long>(i * 2 + 1));
+    data += line;
+  }
+  return data;
+}
+
+// Returns the text of a symbol file covering all of a module with
+// |cpu|'s STACK CFI rules.
+string CFISymbolData(const CPU& cpu) {
+  char data[256];
+  snprintf(data, sizeof(data),
+           "MODULE Linux %s 000000000000000000000000000000000 bench\n"
+           "STACK CFI INIT 0 %llx %s\n",
+           cpu.name, static_cast<unsigned long long>(kModuleSize),
+           cpu.cfi_rules);
+  return data;
+}
+
+// Walks every thread in |thread_list| through |symbolizer| and returns the
+// number of frames found.
+uint64_t WalkThreads(const CPU& cpu, const SystemInfo& system_info,
+                     MinidumpThreadList* thread_list,
+                     MinidumpModuleList* module_list,
+                     StackFrameSymbolizer* symbolizer) {
+  uint64_t frames = 0;
+  for (unsigned int i = 0; i < thread_list->thread_count(); ++i) {
+    MinidumpThread* thread = thread_list->GetThreadAtIndex(i);
+    MinidumpMemoryRegion* memory = thread->GetMemory();
+    scoped_ptr<Stackwalker> walker(Stackwalker::StackwalkerForCPU(
+        &system_info, thread->GetContext(), memory, module_list, NULL,
+        symbolizer));
+    CallStack stack;
+    vector<const CodeModule*> modules_without_symbols;
+    vector<const CodeModule*> modules_with_corrupt_symbols;
+    if (!walker.get() ||
+        !walker->Walk(&stack, &modules_without_symbols,
+                      &modules_with_corrupt_symbols)) {
+      fprintf(stderr, "Can't walk a %s stack\n", cpu.name);
+      exit(1);
+    }
+    frames += stack.frames()->size();
+  }
+  return frames;
+}
+
+void BenchmarkMinidump(const CPU& cpu, const Options& options,
+                       vector<Result>* results) {
+  string contents = BuildDump(cpu, options);
+
+  results->push_back(Result{
+      string("minidump_read/") + cpu.name, options.iterations,
+      Time(options.iterations, [&contents]() {
+        std::istringstream stream(contents);
+        Minidump minidump(stream);
+        if (!minidump.Read()) {
+          fprintf(stderr, "Can't read the synthetic dump\n");
+          exit(1);
+        }
+      }),
+      "threads", options.num_threads});
+
+  std::istringstream stream(contents);
+  Minidump minidump(stream);
+  if (!minidump.Read()) {
+    fprintf(stderr, "Can't read the synthetic dump\n");
+    exit(1);
+  }
+  SystemInfo system_info;
+  MinidumpProcessor::GetCPUInfo(&minidump, &system_info);
+  MinidumpProcessor::GetOSInfo(&minidump, &system_info);
+  MinidumpThreadList* thread_list = minidump.GetThreadList();
+  MinidumpModuleList* module_list = minidump.GetModuleList();
+  BasicSourceLineResolver resolver;
+  StackFrameSymbolizer symbolizer(NULL, &resolver);
+
+  uint64_t frames = 0;
+  double walk_ns = Time(options.iterations, [&]() {
+    frames = WalkThreads(cpu, system_info, thread_list, module_list,
+                         &symbolizer);
+  });
+  results->push_back(Result{string("stackwalk/") + cpu.name,
+                            options.iterations, walk_ns, "frames", frames});
+
+  // The same walk, with every module's frames unwound by STACK CFI rules
+  // rather than by the frame pointer heuristics.
+  BasicSourceLineResolver cfi_resolver;
+  string cfi_symbol_data = CFISymbolData(cpu);
+  for (unsigned int i = 0; i < module_list->module_count(); ++i) {
+    if (!cfi_resolver.LoadModuleUsingMapBuffer(
+            module_list->GetModuleAtIndex(i), cfi_symbol_data)) {
+      fprintf(stderr, "Can't load the %s CFI symbols\n", cpu.name);
+      exit(1);
+    }
+  }
+  StackFrameSymbolizer cfi_symbolizer(NULL, &cfi_resolver);
+  double cfi_walk_ns = Time(options.iterations, [&]() {
+    frames = WalkThreads(cpu, system_info, thread_list, module_list,
+                         &cfi_symbolizer);
+  });
+  results->push_back(Result{string("stackwalk_cfi/") + cpu.name,
+                            options.iterations, cfi_walk_ns, "frames",
+                            frames});
+
+  ProcessState process_state;
+  MinidumpProcessor processor(NULL, &resolver);
+  if (processor.Process(&minidump, &process_state) !=
+      google_breakpad::PROCESS_OK) {
+    fprintf(stderr, "Can't process the %s dump\n", cpu.name);
+    exit(1);
+  }
+  // The report goes to /dev/null, so only its formatting is timed.
+  fflush(stdout);
+  int saved_stdout = dup(STDOUT_FILENO);
+  int null_fd = open("/dev/null", O_WRONLY);
+  if (saved_stdout < 0 || null_fd < 0 || dup2(null_fd, STDOUT_FILENO) < 0) {
+    fprintf(stderr, "Can't redirect stdout\n");
+    exit(1);
+  }
+  close(null_fd);
+  double print_ns = Time(options.iterations, [&]() {
+    PrintProcessState(process_state, true, false, &resolver);
+    fflush(stdout);
+  });
+  dup2(saved_stdout, STDOUT_FILENO);
+  close(saved_stdout);
+  results->push_back(Result{string("print_process_state/") + cpu.name,
+                            options.iterations, print_ns, "threads",
+                            options.num_threads});
+}
+
+// Times reading each thread's instruction and stack pointers, as thread
+// ranking and prefetching do, out of a dump with at least
+// kThreadListThreads threads: once through the per-register accessors and
+// once through DumpContext::GetRegisters.
+const uint64_t kThreadListThreads = 1000;
+
+void BenchmarkThreadList(const CPU& cpu, const Options& options,
+                         vector<Result>* results) {
+  Options dump_options = options;
+  dump_options.num_threads = std::max(options.num_threads,
+                                      kThreadListThreads);
+  dump_options.stack_depth = 2;
+  std::istringstream stream(BuildDump(cpu, dump_options));
+  Minidump minidump(stream);
+  if (!minidump.Read()) {
+    fprintf(stderr, "Can't read the synthetic dump\n");
+    exit(1);
+  }
+  MinidumpThreadList* thread_list = minidump.GetThreadList();
+  const unsigned int thread_count = thread_list->thread_count();
+  vector<const MinidumpContext*> contexts;
+  for (unsigned int i = 0; i < thread_count; ++i)
+    contexts.push_back(thread_list->GetThreadAtIndex(i)->GetContext());
+
+  // The accessors are out of line, so the unused values still get read.
+  double accessors_ns = Time(options.iterations * 100, [&]() {
+    for (const MinidumpContext* context : contexts) {
+      uint64_t instruction_pointer, stack_pointer;
+      context->GetContextCPU();
+      context->GetInstructionPointer(&instruction_pointer);
+      context->GetStackPointer(&stack_pointer);
+    }
+  });
+  results->push_back(Result{string("thread_accessors/") + cpu.name,
+                            options.iterations * 100, accessors_ns,
+                            "threads", thread_count});
+
+  double registers_ns = Time(options.iterations * 100, [&]() {
+    for (const MinidumpContext* context : contexts) {
+      DumpContext::Registers registers;
+      context->GetRegisters(&registers);
+    }
+  });
+  results->push_back(Result{string("thread_registers/") + cpu.name,
+                            options.iterations * 100, registers_ns,
+                            "threads", thread_count});
+}
+
+// Times loading |symbol_data| into |resolver|, through |load|, and looking
+// up |addresses| in it.
+template <typename Load>
+void BenchmarkResolver(const char* name, SourceLineResolverInterface* resolver,
+                       Load load, const vector<uint64_t>& addresses,
+                       const Options& options, vector<Result>* results) {
+  BasicCodeModule module(0, UINT64_MAX, "bench", "", "bench", "", "");
+  double load_ns = Time(options.iterations, [&]() {
+    if (!load(&module)) {
+      fprintf(stderr, "Can't load the symbol data into the %s\n", name);
+      exit(1);
+    }
+    resolver->UnloadModule(&module);
+  });
+  results->push_back(Result{string(name) + "/load", options.iterations,
+                            load_ns, "functions", options.num_functions});
+
+  load(&module);
+  StackFrame frame;
+  frame.module = &module;
+  std::deque<std::unique_ptr<StackFrame>> inlined_frames;
+  double lookup_ns = Time(1, [&]() {
+    for (uint64_t address : addresses) {
+      frame.instruction = address;
+      resolver->FillSourceLineInfo(&frame, &inlined_frames);
+      inlined_frames.clear();
+    }
+  });
+  resolver->UnloadModule(&module);
+  results->push_back(Result{string(name) + "/lookup", 1, lookup_ns,
+                            "lookups", addresses.size()});
+}
+
+void BenchmarkResolvers(const Options& options, vector<Result>* results) {
+  string symbol_data = SyntheticSymbolData(options.num_functions);
+  vector<uint64_t> addresses(options.num_lookups);
+  uint64_t high = 0x1000 + options.num_functions * 0x40;
+  uint64_t state = 0x9e3779b97f4a7c15ULL;
+  for (uint64_t& address : addresses) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    address = state % high;
+  }
+
+  BasicSourceLineResolver basic_resolver;
+  BenchmarkResolver(
+      "basic_resolver", &basic_resolver,
+      [&](const CodeModule* module) {
+        return basic_resolver.LoadModuleUsingMapBuffer(module, symbol_data);
+      },
+      addresses, options, results);
+
+  ModuleSerializer serializer;
+  vector<char> text(symbol_data.begin(), symbol_data.end());
+  text.push_back('\0');
+  size_t serialized_size = 0;
+  scoped_array<char> serialized(
+      serializer.CompileSymbolFileData(&text[0], text.size(),
+                                       &serialized_size));
+  if (!serialized.get()) {
+    fprintf(stderr, "Can't serialize the symbol data\n");
+    exit(1);
+  }
+  FastSourceLineResolver fast_resolver;
+  BenchmarkResolver(
+      "fast_resolver", &fast_resolver,
+      [&](const CodeModule* module) {
+        return fast_resolver.LoadModuleUsingMemoryBuffer(
+            module, serialized.get(), serialized_size);
+      },
+      addresses, options, results);
+}
+
+void PrintResults(const Options& options, const vector<Result>& results) {
+  if (!options.json) {
+    for (const Result& result : results) {
+      printf("%-28s %14.0f ns/iteration  (%llu %s)\n", result.name.c_str(),
+             result.ns_per_iteration,
+             static_cast<unsigned long long>(result.items_per_iteration),
+             result.item);
+    }
+    return;
+  }
+
+  printf("{\n  \"parameters\": {\"threads\": %llu, \"stack_depth\": %llu, "
+         "\"modules\": %llu, \"regions\": %llu, \"functions\": %llu, "
+         "\"lookups\": %llu},\n  \"benchmarks\": [\n",
+         static_cast<unsigned long long>(options.num_threads),
+         static_cast<unsigned long long>(options.stack_depth),
+         static_cast<unsigned long long>(options.num_modules),
+         static_cast<unsigned long long>(options.num_regions),
+         static_cast<unsigned long long>(options.num_functions),
+         static_cast<unsigned long long>(options.num_lookups));
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& result = results[i];
+    printf("    {\"name\": \"%s\", \"iterations\": %llu, "
+           "\"ns_per_iteration\": %.1f, \"%s\": %llu}%s\n",
+           result.name.c_str(),
+           static_cast<unsigned long long>(result.iterations),
+           result.ns_per_iteration, result.item,
+           static_cast<unsigned long long>(result.items_per_iteration),
+           i + 1 < results.size() ? "," : "");
+  }
+  printf("  ]\n}\n");
+}
+
+void Usage(int argc, char* argv[], bool error) {
+  FILE* fp = error ? stderr : stdout;
+  fprintf(fp,
+          "Usage: %s [options...]\n"
+          "Time the stages of processing synthetic minidumps.\n"
+          "\n"
+          "Options:\n"
+          "  -t <threads>\t Threads in each dump (default 32)\n"
+          "  -d <depth>\t Frames on each stack (default 64)\n"
+          "  -m <modules>\t Modules in each dump (default 100)\n"
+          "  -r <regions>\t Memory regions besides stacks (default 100)\n"
+          "  -f <functions>\t Functions in the symbol file (default 100000)\n"
+          "  -l <lookups>\t Symbol lookups (default 1000000)\n"
+          "  -i <iterations> Runs of each other benchmark (default 10)\n"
+          "  -j\t\t Print results as JSON\n"
+          "  -h:\t\t Usage\n",
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+void SetupOptions(int argc, char* argv[], Options* options) {
+  int ch;
+  while ((ch = getopt(argc, argv, "t:d:m:r:f:l:i:jh")) != -1) {
+    switch (ch) {
+      case 't':
+        options->num_threads = strtoull(optarg, NULL, 0);
+        break;
+      case 'd':
+        options->stack_depth = strtoull(optarg, NULL, 0);
+        break;
+      case 'm':
+        options->num_modules = strtoull(optarg, NULL, 0);
+        break;
+      case 'r':
+        options->num_regions = strtoull(optarg, NULL, 0);
+        break;
+      case 'f':
+        options->num_functions = strtoull(optarg, NULL, 0);
+        break;
+      case 'l':
+        options->num_lookups = strtoull(optarg, NULL, 0);
+        break;
+      case 'i':
+        options->iterations = strtoull(optarg, NULL, 0);
+        break;
+      case 'j':
+        options->json = true;
+        break;
+      case 'h':
+        Usage(argc, argv, false);
+        exit(0);
+      default:
+        Usage(argc, argv, true);
+        exit(1);
+    }
+  }
+  if (options->num_threads == 0 || options->stack_depth == 0 ||
+      options->num_modules == 0 || options->num_functions == 0 ||
+      options->num_lookups == 0 || options->iterations == 0 ||
+      optind != argc) {
+    Usage(argc, argv, true);
+    exit(1);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  BPLOG_INIT(&argc, &argv);
+  Options options;
+  SetupOptions(argc, argv, &options);
+  // Logging would be timed along with the work it reports on.
+  LogStream::SetMinimumSeverity(LogStream::SEVERITY_CRITICAL);
+
+  vector<Result> results;
+  for (const CPU& cpu : kCPUs) {
+    BenchmarkMinidump(cpu, options, &results);
+    BenchmarkThreadList(cpu, options, &results);
+  }
+  BenchmarkResolvers(options, &results);
+  PrintResults(options, results);
+  return 0;
+}
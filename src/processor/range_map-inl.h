@@ -76,6 +76,14 @@ bool RangeMap<AddressType, EntryType>::StoreRangeInternal(
     return false;
   }
 
+  // A range above every stored range can't overlap any of them.  Symbol
+  // files list most of their ranges in increasing order, so append those
+  // at the end of the map without searching it.
+  if (map_.empty() || base > map_.rbegin()->first) {
+    map_.emplace_hint(map_.end(), high, Range(base, delta, entry));
+    return true;
+  }
+
   // Ensure that this range does not overlap with another one already in the
   // map.
   MapConstIterator iterator_base = map_.lower_bound(base);
@@ -48,6 +48,7 @@ namespace google_breakpad {
 
 // Forward declarations (for later friend declarations of specialized template).
 template<class, class> class RangeMapSerializer;
+template<typename, typename> class FlatRangeMap;
 
 // Determines what happens when two ranges overlap.
 enum class MergeRangeStrategy {
@@ -125,6 +126,7 @@ class RangeMap {
   // Friend declarations.
   friend class ModuleComparer;
   friend class RangeMapSerializer<AddressType, EntryType>;
+  friend class FlatRangeMap<AddressType, EntryType>;
 
   // Same a StoreRange() with the only exception that the |delta| can be
   // passed in.
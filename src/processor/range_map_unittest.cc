@@ -457,12 +457,28 @@ static bool RunTests() {
     { INT_MAX,     0, 113, false }   // makes RetrieveRange check high end
   };
 
+  // Ranges stored in increasing order, as symbol files list them, which
+  // StoreRange appends without searching the map, mixed with ranges that
+  // touch the highest stored range or fall below it.
+  const RangeTest range_tests_4[] = {
+    { 0,       10,      120, true },   // 0 to 9
+    { 10,      10,      121, true },   // 10 to 19, adjacent
+    { 19,      5,       122, false },  // overlaps the highest range's end
+    { 30,      1,       123, true },   // 30, after a gap
+    { 20,      5,       124, true },   // 20 to 24, fills part of the gap
+    { 22,      5,       125, false },  // overlaps a range below the highest
+    { 31,      INT_MAX, 126, false },  // overflows
+    { 31,      0,       127, false },  // empty
+    { 40,      10,      128, true },   // 40 to 49
+  };
+
   // The range map is cleared between sets of tests listed here.
   const RangeTestSet range_test_sets[] = {
     { range_tests_0, sizeof(range_tests_0) / sizeof(RangeTest) },
     { range_tests_1, sizeof(range_tests_1) / sizeof(RangeTest) },
     { range_tests_2, sizeof(range_tests_2) / sizeof(RangeTest) },
     { range_tests_3, sizeof(range_tests_3) / sizeof(RangeTest) },
+    { range_tests_4, sizeof(range_tests_4) / sizeof(RangeTest) },
     { range_tests_0, sizeof(range_tests_0) / sizeof(RangeTest) }   // Run again
   };
 
@@ -28,7 +28,7 @@
 //
 // simple_serializer-inl.h: template specializations for following types:
 // bool, const char *(C-string), string,
-// Line, Function, PublicSymbol, WindowsFrameInfo and their linked pointers.
+// Line, Function, PublicSymbol, WindowsFrameInfo and pointers to them.
 //
 // See simple_serializer.h for moredocumentation.
 //
@@ -40,11 +40,12 @@
 #include "processor/simple_serializer.h"
 
 #include <cstdint>
+#include <cstring>
 #include <string>
 
+#include "common/string_view.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
 #include "processor/basic_source_line_resolver_types.h"
-#include "processor/linked_ptr.h"
 #include "processor/map_serializers-inl.h"
 #include "processor/windows_frame_info.h"
 
@@ -79,6 +80,19 @@ class SimpleSerializer<string> {
   }
 };
 
+// Specializations of SimpleSerializer: StringView, written like a string.
+template<>
+class SimpleSerializer<StringView> {
+ public:
+  static size_t SizeOf(StringView str) { return str.size() + 1; }
+
+  static char* Write(StringView str, char* dest) {
+    memcpy(dest, str.data(), str.size());
+    dest[str.size()] = '\0';
+    return dest + SizeOf(str);
+  }
+};
+
 // Specializations of SimpleSerializer: C-string
 template<>
 class SimpleSerializer<const char*> {
@@ -122,12 +136,12 @@ class SimpleSerializer<BasicSourceLineResolver::InlineOrigin> {
   static size_t SizeOf(const InlineOrigin& origin) {
     return SimpleSerializer<bool>::SizeOf(origin.has_file_id) +
            SimpleSerializer<int32_t>::SizeOf(origin.source_file_id) +
-           SimpleSerializer<string>::SizeOf(origin.name);
+           SimpleSerializer<StringView>::SizeOf(origin.name);
   }
   static char* Write(const InlineOrigin& origin, char* dest) {
     dest = SimpleSerializer<bool>::Write(origin.has_file_id, dest);
     dest = SimpleSerializer<int32_t>::Write(origin.source_file_id, dest);
-    dest = SimpleSerializer<string>::Write(origin.name, dest);
+    dest = SimpleSerializer<StringView>::Write(origin.name, dest);
     return dest;
   }
 };
@@ -138,13 +152,13 @@ class SimpleSerializer<BasicSourceLineResolver::PublicSymbol> {
   typedef BasicSourceLineResolver::PublicSymbol PublicSymbol;
  public:
   static size_t SizeOf(const PublicSymbol& pubsymbol) {
-    return SimpleSerializer<string>::SizeOf(pubsymbol.name)
+    return SimpleSerializer<StringView>::SizeOf(pubsymbol.name)
          + SimpleSerializer<MemAddr>::SizeOf(pubsymbol.address)
          + SimpleSerializer<int32_t>::SizeOf(pubsymbol.parameter_size)
          + SimpleSerializer<bool>::SizeOf(pubsymbol.is_multiple);
   }
   static char* Write(const PublicSymbol& pubsymbol, char* dest) {
-    dest = SimpleSerializer<string>::Write(pubsymbol.name, dest);
+    dest = SimpleSerializer<StringView>::Write(pubsymbol.name, dest);
     dest = SimpleSerializer<MemAddr>::Write(pubsymbol.address, dest);
     dest = SimpleSerializer<int32_t>::Write(pubsymbol.parameter_size, dest);
     dest = SimpleSerializer<bool>::Write(pubsymbol.is_multiple, dest);
@@ -185,43 +199,43 @@ class SimpleSerializer<WindowsFrameInfo> {
   }
 };
 
-// Specializations of SimpleSerializer: Linked_ptr version of
+// Specializations of SimpleSerializer: pointer version of
 // Line, InlineOrigin, Inline, Function, PublicSymbol, WindowsFrameInfo.
 template<>
-class SimpleSerializer< linked_ptr<BasicSourceLineResolver::Line> > {
+class SimpleSerializer<BasicSourceLineResolver::Line*> {
   typedef BasicSourceLineResolver::Line Line;
  public:
-  static size_t SizeOf(const linked_ptr<Line>& lineptr) {
-    if (lineptr.get() == NULL) return 0;
-    return SimpleSerializer<Line>::SizeOf(*(lineptr.get()));
+  static size_t SizeOf(const Line* lineptr) {
+    if (lineptr == NULL) return 0;
+    return SimpleSerializer<Line>::SizeOf(*lineptr);
   }
-  static char* Write(const linked_ptr<Line>& lineptr, char* dest) {
-    if (lineptr.get())
-      dest = SimpleSerializer<Line>::Write(*(lineptr.get()), dest);
+  static char* Write(const Line* lineptr, char* dest) {
+    if (lineptr)
+      dest = SimpleSerializer<Line>::Write(*lineptr, dest);
     return dest;
   }
 };
 
 template <>
-class SimpleSerializer<linked_ptr<BasicSourceLineResolver::InlineOrigin>> {
+class SimpleSerializer<BasicSourceLineResolver::InlineOrigin*> {
   typedef BasicSourceLineResolver::InlineOrigin InlineOrigin;
 
  public:
-  static size_t SizeOf(const linked_ptr<InlineOrigin>& origin_ptr) {
-    if (origin_ptr.get() == NULL)
+  static size_t SizeOf(const InlineOrigin* origin_ptr) {
+    if (origin_ptr == NULL)
       return 0;
-    return SimpleSerializer<InlineOrigin>::SizeOf(*(origin_ptr.get()));
+    return SimpleSerializer<InlineOrigin>::SizeOf(*origin_ptr);
   }
-  static char* Write(const linked_ptr<InlineOrigin>& origin_ptr, char* dest) {
-    if (origin_ptr.get())
-      dest = SimpleSerializer<InlineOrigin>::Write(*(origin_ptr.get()), dest);
+  static char* Write(const InlineOrigin* origin_ptr, char* dest) {
+    if (origin_ptr)
+      dest = SimpleSerializer<InlineOrigin>::Write(*origin_ptr, dest);
     return dest;
   }
 };
 
 // Specializations of SimpleSerializer: Inline
 template <>
-class SimpleSerializer<linked_ptr<BasicSourceLineResolver::Inline>>;
+class SimpleSerializer<BasicSourceLineResolver::Inline*>;
 template <>
 class SimpleSerializer<BasicSourceLineResolver::Inline> {
   typedef BasicSourceLineResolver::Inline Inline;
@@ -232,18 +246,18 @@ class SimpleSerializer<BasicSourceLineResolver::Inline> {
 };
 
 template <>
-class SimpleSerializer<linked_ptr<BasicSourceLineResolver::Inline>> {
+class SimpleSerializer<BasicSourceLineResolver::Inline*> {
   typedef BasicSourceLineResolver::Inline Inline;
 
  public:
-  static size_t SizeOf(const linked_ptr<Inline>& inline_ptr) {
-    if (inline_ptr.get() == NULL)
+  static size_t SizeOf(const Inline* inline_ptr) {
+    if (inline_ptr == NULL)
       return 0;
-    return SimpleSerializer<Inline>::SizeOf(*(inline_ptr.get()));
+    return SimpleSerializer<Inline>::SizeOf(*inline_ptr);
   }
-  static char* Write(const linked_ptr<Inline>& inline_ptr, char* dest) {
-    if (inline_ptr.get())
-      dest = SimpleSerializer<Inline>::Write(*(inline_ptr.get()), dest);
+  static char* Write(const Inline* inline_ptr, char* dest) {
+    if (inline_ptr)
+      dest = SimpleSerializer<Inline>::Write(*inline_ptr, dest);
     return dest;
   }
 };
@@ -285,83 +299,83 @@ class SimpleSerializer<BasicSourceLineResolver::Function> {
  public:
   static size_t SizeOf(const Function& func) {
     unsigned int size = 0;
-    size += SimpleSerializer<string>::SizeOf(func.name);
+    size += SimpleSerializer<StringView>::SizeOf(func.name);
     size += SimpleSerializer<MemAddr>::SizeOf(func.address);
     size += SimpleSerializer<MemAddr>::SizeOf(func.size);
     size += SimpleSerializer<int32_t>::SizeOf(func.parameter_size);
     size += SimpleSerializer<bool>::SizeOf(func.is_multiple);
-    // This extra size is used to store the size of serialized func.inlines, so
-    // we know where to start de-serialize func.lines.
+    // This extra size is used to store the size of serialized
+    // func.inline_index, so we know where to start de-serialize func.lines.
     size += sizeof(int32_t);
-    size += inline_range_map_serializer_.SizeOf(&func.inlines);
+    size += inline_index_serializer_.SizeOf(func.inline_index);
     size += range_map_serializer_.SizeOf(func.lines);
     return size;
   }
 
   static char* Write(const Function& func, char* dest) {
-    dest = SimpleSerializer<string>::Write(func.name, dest);
+    dest = SimpleSerializer<StringView>::Write(func.name, dest);
     dest = SimpleSerializer<MemAddr>::Write(func.address, dest);
     dest = SimpleSerializer<MemAddr>::Write(func.size, dest);
     dest = SimpleSerializer<int32_t>::Write(func.parameter_size, dest);
     dest = SimpleSerializer<bool>::Write(func.is_multiple, dest);
     char* old_dest = dest;
     dest += sizeof(int32_t);
-    dest = inline_range_map_serializer_.Write(&func.inlines, dest);
-    // Write the size of serialized func.inlines. The size doesn't include size
-    // field itself.
-    SimpleSerializer<MemAddr>::Write(dest - old_dest - sizeof(int32_t),
-                                     old_dest);
+    dest = inline_index_serializer_.Write(func.inline_index, dest);
+    // Write the size of serialized func.inline_index. The size doesn't
+    // include size field itself.
+    SimpleSerializer<int32_t>::Write(
+        static_cast<int32_t>(dest - old_dest - sizeof(int32_t)), old_dest);
     dest = range_map_serializer_.Write(func.lines, dest);
     return dest;
   }
  private:
   // This static member is defined in module_serializer.cc.
-  static RangeMapSerializer<MemAddr, linked_ptr<Line>> range_map_serializer_;
-  static ContainedRangeMapSerializer<MemAddr, linked_ptr<Inline>>
-      inline_range_map_serializer_;
+  static RangeMapSerializer<MemAddr, Line*> range_map_serializer_;
+  static NestedRangeIndexSerializer<MemAddr, Inline*>
+      inline_index_serializer_;
 };
 
 template<>
-class SimpleSerializer< linked_ptr<BasicSourceLineResolver::Function> > {
+class SimpleSerializer<BasicSourceLineResolver::Function*> {
   typedef BasicSourceLineResolver::Function Function;
  public:
-  static size_t SizeOf(const linked_ptr<Function>& func) {
-    if (!func.get()) return 0;
-    return SimpleSerializer<Function>::SizeOf(*(func.get()));
+  static size_t SizeOf(const Function* func) {
+    if (!func) return 0;
+    return SimpleSerializer<Function>::SizeOf(*func);
   }
 
-  static char* Write(const linked_ptr<Function>& func, char* dest) {
-    if (func.get())
-      dest = SimpleSerializer<Function>::Write(*(func.get()), dest);
+  static char* Write(const Function* func, char* dest) {
+    if (func)
+      dest = SimpleSerializer<Function>::Write(*func, dest);
     return dest;
   }
 };
 
 template<>
-class SimpleSerializer< linked_ptr<BasicSourceLineResolver::PublicSymbol> > {
+class SimpleSerializer<BasicSourceLineResolver::PublicSymbol*> {
   typedef BasicSourceLineResolver::PublicSymbol PublicSymbol;
  public:
-  static size_t SizeOf(const linked_ptr<PublicSymbol>& pubsymbol) {
-    if (pubsymbol.get() == NULL) return 0;
-    return SimpleSerializer<PublicSymbol>::SizeOf(*(pubsymbol.get()));
+  static size_t SizeOf(const PublicSymbol* pubsymbol) {
+    if (pubsymbol == NULL) return 0;
+    return SimpleSerializer<PublicSymbol>::SizeOf(*pubsymbol);
   }
-  static char* Write(const linked_ptr<PublicSymbol>& pubsymbol, char* dest) {
-    if (pubsymbol.get())
-      dest = SimpleSerializer<PublicSymbol>::Write(*(pubsymbol.get()), dest);
+  static char* Write(const PublicSymbol* pubsymbol, char* dest) {
+    if (pubsymbol)
+      dest = SimpleSerializer<PublicSymbol>::Write(*pubsymbol, dest);
     return dest;
   }
 };
 
 template<>
-class SimpleSerializer< linked_ptr<WindowsFrameInfo> > {
+class SimpleSerializer<WindowsFrameInfo*> {
  public:
-  static size_t SizeOf(const linked_ptr<WindowsFrameInfo>& wfi) {
-    if (wfi.get() == NULL) return 0;
-    return SimpleSerializer<WindowsFrameInfo>::SizeOf(*(wfi.get()));
+  static size_t SizeOf(const WindowsFrameInfo* wfi) {
+    if (wfi == NULL) return 0;
+    return SimpleSerializer<WindowsFrameInfo>::SizeOf(*wfi);
   }
-  static char* Write(const linked_ptr<WindowsFrameInfo>& wfi, char* dest) {
-    if (wfi.get())
-      dest = SimpleSerializer<WindowsFrameInfo>::Write(*(wfi.get()), dest);
+  static char* Write(const WindowsFrameInfo* wfi, char* dest) {
+    if (wfi)
+      dest = SimpleSerializer<WindowsFrameInfo>::Write(*wfi, dest);
     return dest;
   }
 };
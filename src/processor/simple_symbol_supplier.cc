@@ -39,27 +39,76 @@
 #include "processor/simple_symbol_supplier.h"
 
 #include <assert.h>
+#include <fcntl.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
 #include <fstream>
+#include <thread>
 
+#include "common/block_gzip.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/code_module.h"
 #include "google_breakpad/processor/system_info.h"
 #include "processor/logging.h"
 #include "processor/pathname_stripper.h"
+#include "processor/symbol_delta.h"
 
 namespace google_breakpad {
 
+const char SimpleSymbolSupplier::kDeltaExtension[] = ".delta";
+
 static bool file_exists(const string& file_name) {
   struct stat sb;
   return stat(file_name.c_str(), &sb) == 0;
 }
 
+namespace {
+
+// The answers to one lookup's concurrent probes, shared with the probe
+// threads, which may outlive the lookup.
+struct ProbeAnswers {
+  enum Answer { PENDING, ABSENT, PRESENT };
+
+  explicit ProbeAnswers(size_t count)
+      : answers(count, PENDING), pending(count), present(false) {}
+
+  std::mutex mutex;
+  std::condition_variable answered;
+  vector<Answer> answers;
+  size_t pending;
+  bool present;
+};
+
+// Checks for the symbol file at |relative_path| in |root_path|, through
+// |index| if there is one, and records the answer in |answers| at |slot|.
+void ProbeRoot(std::shared_ptr<ProbeAnswers> answers, size_t slot,
+               string root_path, string relative_path,
+               std::shared_ptr<SymbolStoreIndex> index) {
+  SymbolStoreIndex::LookupResult lookup = SymbolStoreIndex::NO_INDEX;
+  if (index)
+    lookup = index->Lookup(relative_path);
+  bool present = lookup == SymbolStoreIndex::PRESENT ||
+      (lookup == SymbolStoreIndex::NO_INDEX &&
+       file_exists(root_path + "/" + relative_path));
+
+  std::lock_guard<std::mutex> lock(answers->mutex);
+  answers->answers[slot] = present ? ProbeAnswers::PRESENT :
+                                     ProbeAnswers::ABSENT;
+  --answers->pending;
+  answers->present = answers->present || present;
+  answers->answered.notify_one();
+}
+
+}  // namespace
+
 SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFile(
     const CodeModule* module, const SystemInfo* system_info,
     string* symbol_file) {
@@ -68,7 +117,27 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFile(
   assert(symbol_file);
   symbol_file->clear();
 
+  string relative_path;
+  if (concurrent_probing_ && paths_.size() > 1) {
+    if (!GetRelativeSymbolFilePath(module, &relative_path))
+      return NOT_FOUND;
+    return GetSymbolFileConcurrently(relative_path, symbol_file);
+  }
+
+  if (!indexes_.empty() && !GetRelativeSymbolFilePath(module, &relative_path))
+    return NOT_FOUND;
+
   for (unsigned int path_index = 0; path_index < paths_.size(); ++path_index) {
+    if (!indexes_.empty()) {
+      SymbolStoreIndex::LookupResult lookup =
+          indexes_[path_index]->Lookup(relative_path);
+      if (lookup == SymbolStoreIndex::PRESENT) {
+        *symbol_file = paths_[path_index] + "/" + relative_path;
+        return FOUND;
+      }
+      if (lookup == SymbolStoreIndex::ABSENT)
+        continue;
+    }
     SymbolResult result;
     if ((result = GetSymbolFileAtPathFromRoot(module, system_info,
                                               paths_[path_index],
@@ -79,6 +148,102 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFile(
   return NOT_FOUND;
 }
 
+SimpleSymbolSupplier::~SimpleSymbolSupplier() {
+  for (const auto& mapping : mappings_)
+    munmap(mapping.second.address, mapping.second.size);
+}
+
+void SimpleSymbolSupplier::set_index_file_name(const string& index_file_name,
+                                               time_t refresh_seconds) {
+  indexes_.clear();
+  for (unsigned int path_index = 0; path_index < paths_.size(); ++path_index) {
+    indexes_.push_back(std::shared_ptr<SymbolStoreIndex>(new SymbolStoreIndex(
+        paths_[path_index] + "/" + index_file_name, refresh_seconds)));
+  }
+}
+
+void SimpleSymbolSupplier::set_concurrent_probing(bool concurrent_probing,
+                                                  int timeout_milliseconds) {
+  std::lock_guard<std::mutex> lock(health_mutex_);
+  concurrent_probing_ = concurrent_probing;
+  probe_timeout_milliseconds_ = timeout_milliseconds;
+  root_health_.assign(paths_.size(), RootHealth());
+}
+
+bool SimpleSymbolSupplier::IsRootDeprioritized(size_t path_index) {
+  std::lock_guard<std::mutex> lock(health_mutex_);
+  return path_index < root_health_.size() &&
+         root_health_[path_index].deprioritized_until > time(NULL);
+}
+
+SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFileConcurrently(
+    const string& relative_path, string* symbol_file) {
+  // Roots that keep timing out are left until the others have missed.
+  vector<size_t> healthy;
+  vector<size_t> deprioritized;
+  for (size_t path_index = 0; path_index < paths_.size(); ++path_index) {
+    if (IsRootDeprioritized(path_index))
+      deprioritized.push_back(path_index);
+    else
+      healthy.push_back(path_index);
+  }
+
+  if (!healthy.empty() &&
+      ProbeRoots(healthy, relative_path, symbol_file) == FOUND) {
+    return FOUND;
+  }
+  if (!deprioritized.empty())
+    return ProbeRoots(deprioritized, relative_path, symbol_file);
+  return NOT_FOUND;
+}
+
+SymbolSupplier::SymbolResult SimpleSymbolSupplier::ProbeRoots(
+    const vector<size_t>& path_indexes, const string& relative_path,
+    string* symbol_file) {
+  std::shared_ptr<ProbeAnswers> answers(
+      new ProbeAnswers(path_indexes.size()));
+  for (size_t slot = 0; slot < path_indexes.size(); ++slot) {
+    size_t path_index = path_indexes[slot];
+    std::shared_ptr<SymbolStoreIndex> index;
+    if (!indexes_.empty())
+      index = indexes_[path_index];
+    std::thread(ProbeRoot, answers, slot, paths_[path_index], relative_path,
+                index).detach();
+  }
+
+  std::unique_lock<std::mutex> lock(answers->mutex);
+  bool settled = answers->answered.wait_for(
+      lock, std::chrono::milliseconds(probe_timeout_milliseconds_),
+      [&answers]() { return answers->present || answers->pending == 0; });
+
+  SymbolResult result = NOT_FOUND;
+  for (size_t slot = 0; slot < path_indexes.size(); ++slot) {
+    if (answers->answers[slot] == ProbeAnswers::PRESENT) {
+      *symbol_file = paths_[path_indexes[slot]] + "/" + relative_path;
+      result = FOUND;
+      break;
+    }
+  }
+  if (result == NOT_FOUND)
+    BPLOG(INFO) << "No symbol file " << relative_path << " in any root";
+
+  // A root still pending after a hit was only beaten, not timed out.
+  time_t now = time(NULL);
+  std::lock_guard<std::mutex> health_lock(health_mutex_);
+  for (size_t slot = 0; slot < path_indexes.size(); ++slot) {
+    RootHealth& health = root_health_[path_indexes[slot]];
+    if (answers->answers[slot] != ProbeAnswers::PENDING) {
+      health.consecutive_timeouts = 0;
+    } else if (!settled) {
+      BPLOG(INFO) << "Symbol root " << paths_[path_indexes[slot]] <<
+                     " timed out";
+      if (++health.consecutive_timeouts >= kMaxProbeTimeouts)
+        health.deprioritized_until = now + kProbePenaltySeconds;
+    }
+  }
+  return result;
+}
+
 SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFile(
     const CodeModule* module,
     const SystemInfo* system_info,
@@ -90,14 +255,100 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFile(
   SymbolSupplier::SymbolResult s = GetSymbolFile(module, system_info,
                                                  symbol_file);
   if (s == FOUND) {
-    std::ifstream in(symbol_file->c_str());
-    std::getline(in, *symbol_data, string::traits_type::to_char_type(
-                     string::traits_type::eof()));
-    in.close();
+    if (!ReadSymbolData(*symbol_file, symbol_data))
+      return NOT_FOUND;
+    return s;
+  }
+  if (s != NOT_FOUND)
+    return s;
+
+  // Look for a delta against another symbol file instead.
+  string relative_path;
+  if (!GetRelativeSymbolFilePath(module, &relative_path))
+    return s;
+  for (unsigned int path_index = 0; path_index < paths_.size(); ++path_index) {
+    string delta_file = paths_[path_index] + "/" + relative_path +
+        kDeltaExtension;
+    if (!file_exists(delta_file))
+      continue;
+    if (!ReadDeltaSymbolData(paths_[path_index], delta_file, 0,
+                             symbol_data)) {
+      symbol_data->clear();
+      continue;
+    }
+    *symbol_file = delta_file;
+    return FOUND;
   }
   return s;
 }
 
+bool SimpleSymbolSupplier::ReadSymbolData(const string& path,
+                                          string* symbol_data) {
+  // Read the file in one piece.  Reading up to an EOF character instead
+  // would stop at the first 0xff byte of compressed data.
+  std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+  std::streamoff size = in.tellg();
+  symbol_data->clear();
+  if (size > 0) {
+    symbol_data->resize(size);
+    in.seekg(0);
+    in.read(&(*symbol_data)[0], size);
+    symbol_data->resize(in.gcount());
+  }
+  in.close();
+
+  if (IsGzipData(symbol_data->data(), symbol_data->size())) {
+    char* contents;
+    size_t contents_size;
+    if (!GunzipData(symbol_data->data(), symbol_data->size(),
+                    decompression_thread_count_,
+                    &contents, &contents_size)) {
+      BPLOG(ERROR) << "Could not decompress " << path;
+      symbol_data->clear();
+      return false;
+    }
+    // Drop the terminator GunzipData adds.
+    symbol_data->assign(contents, contents_size - 1);
+    delete [] contents;
+  }
+  return true;
+}
+
+bool SimpleSymbolSupplier::ReadDeltaSymbolData(const string& root_path,
+                                               const string& delta_file,
+                                               int depth,
+                                               string* symbol_data) {
+  string delta;
+  string base_path;
+  if (!ReadSymbolData(delta_file, &delta) ||
+      !SymbolDelta::GetBasePath(delta, &base_path)) {
+    BPLOG(ERROR) << "Could not read symbol delta " << delta_file;
+    return false;
+  }
+
+  // The base is a symbol file in the same root, or a delta itself.
+  string base;
+  string base_file = root_path + "/" + base_path;
+  if (file_exists(base_file)) {
+    if (!ReadSymbolData(base_file, &base))
+      return false;
+  } else if (depth + 1 >= kMaxDeltaChainLength ||
+             !file_exists(base_file + kDeltaExtension) ||
+             !ReadDeltaSymbolData(root_path, base_file + kDeltaExtension,
+                                  depth + 1, &base)) {
+    BPLOG(ERROR) << "Could not read the base " << base_file <<
+                    " of symbol delta " << delta_file;
+    return false;
+  }
+
+  if (!SymbolDelta::Apply(delta, base, symbol_data)) {
+    BPLOG(ERROR) << "Could not apply symbol delta " << delta_file <<
+                    " to " << base_file;
+    return false;
+  }
+  return true;
+}
+
 SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetCStringSymbolData(
     const CodeModule* module,
     const SystemInfo* system_info,
@@ -107,6 +358,27 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetCStringSymbolData(
   assert(symbol_data);
   assert(symbol_data_size);
 
+  if (use_mmap_) {
+    SymbolSupplier::SymbolResult s =
+        GetSymbolFile(module, system_info, symbol_file);
+    Mapping mapping;
+    if (s == FOUND && MapSymbolData(*symbol_file, &mapping)) {
+      std::lock_guard<std::mutex> lock(buffers_mutex_);
+      map<string, Mapping>::iterator old = mappings_.find(module->code_file());
+      if (old != mappings_.end())
+        munmap(old->second.address, old->second.size);
+      mappings_[module->code_file()] = mapping;
+      *symbol_data = static_cast<char*>(mapping.address);
+      // The zero byte after the file's contents is part of the data, as
+      // it is for a copied buffer.
+      *symbol_data_size = mapping.data_size + 1;
+      return FOUND;
+    }
+    if (s != FOUND && s != NOT_FOUND)
+      return s;
+    // A compressed symbol file or a delta is read as usual below.
+  }
+
   string symbol_data_string;
   SymbolSupplier::SymbolResult s =
       GetSymbolFile(module, system_info, symbol_file, &symbol_data_string);
@@ -121,6 +393,7 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetCStringSymbolData(
     }
     memcpy(*symbol_data, symbol_data_string.c_str(), symbol_data_string.size());
     (*symbol_data)[symbol_data_string.size()] = '\0';
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
     memory_buffers_.insert(make_pair(module->code_file(), *symbol_data));
   }
   return s;
@@ -132,6 +405,14 @@ void SimpleSymbolSupplier::FreeSymbolData(const CodeModule* module) {
     return;
   }
 
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  map<string, Mapping>::iterator mapping = mappings_.find(module->code_file());
+  if (mapping != mappings_.end()) {
+    munmap(mapping->second.address, mapping->second.size);
+    mappings_.erase(mapping);
+    return;
+  }
+
   map<string, char*>::iterator it = memory_buffers_.find(module->code_file());
   if (it == memory_buffers_.end()) {
     BPLOG(INFO) << "Cannot find symbol data buffer for module "
@@ -142,6 +423,47 @@ void SimpleSymbolSupplier::FreeSymbolData(const CodeModule* module) {
   memory_buffers_.erase(it);
 }
 
+bool SimpleSymbolSupplier::MapSymbolData(const string& path,
+                                         Mapping* mapping) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  // Reserve room for the file and at least one zero byte after it, then
+  // map the file over the start of the reservation.  The reservation's
+  // anonymous pages stay zero, so the data is terminated even when the
+  // file ends on a page boundary.
+  size_t page_size = getpagesize();
+  size_t file_size = st.st_size;
+  mapping->size = (file_size + 1 + page_size - 1) / page_size * page_size;
+  mapping->address = mmap(NULL, mapping->size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping->address == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  void* file_data = mmap(mapping->address, file_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_FIXED, fd, 0);
+  close(fd);
+  if (file_data == MAP_FAILED) {
+    BPLOG(ERROR) << "Could not map " << path;
+    munmap(mapping->address, mapping->size);
+    return false;
+  }
+
+  if (IsGzipData(static_cast<const char*>(file_data), file_size)) {
+    munmap(mapping->address, mapping->size);
+    return false;
+  }
+  mapping->data_size = file_size;
+  return true;
+}
+
 SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFileAtPathFromRoot(
     const CodeModule* module, const SystemInfo* system_info,
     const string& root_path, string* symbol_file) {
@@ -150,58 +472,69 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFileAtPathFromRoot(
   assert(symbol_file);
   symbol_file->clear();
 
-  if (!module)
+  string relative_path;
+  if (!GetRelativeSymbolFilePath(module, &relative_path))
     return NOT_FOUND;
 
   // Start with the base path.
   string path = root_path;
-
-  // Append the debug (pdb) file name as a directory name.
   path.append("/");
+  path.append(relative_path);
+
+  if (!file_exists(path)) {
+    BPLOG(INFO) << "No symbol file at " << path;
+    return NOT_FOUND;
+  }
+
+  *symbol_file = path;
+  return FOUND;
+}
+
+bool SimpleSymbolSupplier::GetRelativeSymbolFilePath(const CodeModule* module,
+                                                     string* path) const {
+  path->clear();
+  if (!module)
+    return false;
+
+  // Start with the debug (pdb) file name as a directory name.
   string debug_file_name = PathnameStripper::File(module->debug_file());
   if (debug_file_name.empty()) {
     BPLOG(ERROR) << "Can't construct symbol file path without debug_file "
                     "(code_file = " <<
                     PathnameStripper::File(module->code_file()) << ")";
-    return NOT_FOUND;
+    return false;
   }
-  path.append(debug_file_name);
+  path->append(debug_file_name);
 
   // Append the identifier as a directory name.
-  path.append("/");
+  path->append("/");
   string identifier = module->debug_identifier();
   if (identifier.empty()) {
     BPLOG(ERROR) << "Can't construct symbol file path without debug_identifier "
                     "(code_file = " <<
                     PathnameStripper::File(module->code_file()) <<
                     ", debug_file = " << debug_file_name << ")";
-    return NOT_FOUND;
+    path->clear();
+    return false;
   }
-  path.append(identifier);
+  path->append(identifier);
 
-  // Transform the debug file name into one ending in .sym.  If the existing
-  // name ends in .pdb, strip the .pdb.  Otherwise, add .sym to the non-.pdb
-  // name.
-  path.append("/");
+  // Transform the debug file name into one ending in .sym, or the extension
+  // set by a subclass.  If the existing name ends in .pdb, strip the .pdb.
+  // Otherwise, add .sym to the non-.pdb name.
+  path->append("/");
   string debug_file_extension;
   if (debug_file_name.size() > 4)
     debug_file_extension = debug_file_name.substr(debug_file_name.size() - 4);
   std::transform(debug_file_extension.begin(), debug_file_extension.end(),
                  debug_file_extension.begin(), tolower);
   if (debug_file_extension == ".pdb") {
-    path.append(debug_file_name.substr(0, debug_file_name.size() - 4));
+    path->append(debug_file_name.substr(0, debug_file_name.size() - 4));
   } else {
-    path.append(debug_file_name);
-  }
-  path.append(".sym");
-
-  if (!file_exists(path)) {
-    BPLOG(INFO) << "No symbol file at " << path;
-    return NOT_FOUND;
+    path->append(debug_file_name);
   }
-
-  *symbol_file = path;
-  return FOUND;
+  path->append(symbol_file_extension_);
+  return true;
 }
 
 }  // namespace google_breakpad
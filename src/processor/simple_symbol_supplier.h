@@ -62,7 +62,16 @@
 // format using a tool such as dump_syms, and given a .sym extension.
 //
 // SimpleSymbolSupplier will iterate over all root paths searching for
-// a symbol file existing in that path.
+// a symbol file existing in that path.  By default this takes a stat() of
+// each root path for each module.  With set_index_file_name, a root path
+// that has an index file listing its symbol files is searched in the index
+// instead; see symbol_store_index.h.
+//
+// Where there is no symbol file, SimpleSymbolSupplier also looks for a
+// delta next to where it would be, named like it with a further .delta
+// extension, and returns the symbol file the delta stands for.  The delta's
+// base must be in the same root path, as a symbol file or as a delta
+// itself, up to kMaxDeltaChainLength deltas deep.  See symbol_delta.h.
 //
 // SimpleSymbolSupplier supports any debugging file which can be identified
 // by a CodeModule object's debug_file and debug_identifier accessors.  The
@@ -75,12 +84,17 @@
 #ifndef PROCESSOR_SIMPLE_SYMBOL_SUPPLIER_H__
 #define PROCESSOR_SIMPLE_SYMBOL_SUPPLIER_H__
 
+#include <time.h>
+
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/symbol_supplier.h"
+#include "processor/symbol_store_index.h"
 
 namespace google_breakpad {
 
@@ -93,13 +107,21 @@ class SimpleSymbolSupplier : public SymbolSupplier {
  public:
   // Creates a new SimpleSymbolSupplier, using path as the root path where
   // symbols are stored.
-  explicit SimpleSymbolSupplier(const string& path) : paths_(1, path) {}
+  explicit SimpleSymbolSupplier(const string& path)
+      : paths_(1, path), symbol_file_extension_(".sym"),
+        decompression_thread_count_(1), use_mmap_(false),
+        concurrent_probing_(false),
+        probe_timeout_milliseconds_(kDefaultProbeTimeoutMilliseconds) {}
 
   // Creates a new SimpleSymbolSupplier, using paths as a list of root
   // paths where symbols may be stored.
-  explicit SimpleSymbolSupplier(const vector<string>& paths) : paths_(paths) {}
+  explicit SimpleSymbolSupplier(const vector<string>& paths)
+      : paths_(paths), symbol_file_extension_(".sym"),
+        decompression_thread_count_(1), use_mmap_(false),
+        concurrent_probing_(false),
+        probe_timeout_milliseconds_(kDefaultProbeTimeoutMilliseconds) {}
 
-  virtual ~SimpleSymbolSupplier() {}
+  virtual ~SimpleSymbolSupplier();
 
   // Returns the path to the symbol file for the given module.  See the
   // description above.
@@ -107,31 +129,159 @@ class SimpleSymbolSupplier : public SymbolSupplier {
                                      const SystemInfo* system_info,
                                      string* symbol_file);
 
+  // Returns the symbol file's path and contents.  A gzip-compressed symbol
+  // file is returned decompressed.
   virtual SymbolResult GetSymbolFile(const CodeModule* module,
                                      const SystemInfo* system_info,
                                      string* symbol_file,
                                      string* symbol_data);
 
   // Allocates data buffer on heap and writes symbol data into buffer.
-  // Symbol supplier ALWAYS takes ownership of the data buffer.
+  // Symbol supplier ALWAYS takes ownership of the data buffer.  With
+  // set_use_mmap, an uncompressed symbol file is mapped instead.
   virtual SymbolResult GetCStringSymbolData(const CodeModule* module,
                                             const SystemInfo* system_info,
                                             string* symbol_file,
                                             char** symbol_data,
                                             size_t* symbol_data_size);
 
-  // Free the data buffer allocated in the above GetCStringSymbolData();
+  // Free the data buffer allocated in the above GetCStringSymbolData(), or
+  // unmap the file it mapped.
   virtual void FreeSymbolData(const CodeModule* module);
 
+  // Maps uncompressed symbol files into memory in GetCStringSymbolData,
+  // instead of reading them into a string and copying that into a heap
+  // buffer.  The mapping is private and writable, as resolvers modify the
+  // buffer while parsing it, and is followed by a zero byte that
+  // terminates the data.  A symbol file must not be truncated while it is
+  // mapped.  Off by default.
+  void set_use_mmap(bool use_mmap) { use_mmap_ = use_mmap; }
+
+  // Sets the number of threads used to decompress a symbol file written in
+  // blocks by BlockGzipWriter.  Defaults to 1.
+  void set_decompression_thread_count(int thread_count) {
+    decompression_thread_count_ = thread_count;
+  }
+
+  static const time_t kDefaultIndexRefreshSeconds = 60;
+
+  // The extension added to a symbol file's name to name a delta that
+  // stands for it.
+  static const char kDeltaExtension[];
+
+  // The most deltas applied one to another's result to read one symbol
+  // file.
+  static const int kMaxDeltaChainLength = 8;
+
+  // Searches each root path through the index file named |index_file_name|
+  // in it, when it has one, instead of checking for the symbol file.  The
+  // index files are checked for changes at most every |refresh_seconds|
+  // seconds.  Root paths without an index file are searched as usual.
+  void set_index_file_name(const string& index_file_name,
+                           time_t refresh_seconds = kDefaultIndexRefreshSeconds);
+
+  static const int kDefaultProbeTimeoutMilliseconds = 2000;
+
+  // The number of lookups in a row a root path may time out in before it
+  // is deprioritized, and for how long it then is.
+  static const int kMaxProbeTimeouts = 3;
+  static const time_t kProbePenaltySeconds = 60;
+
+  // Probes all root paths at once in GetSymbolFile, each on its own
+  // thread, instead of one after another, so that a slow or hung network
+  // share doesn't hold up the lookup.  The first root found to hold the
+  // symbol file wins; when several have answered by then, the earliest in
+  // the list does.  A lookup stops waiting for roots that haven't answered
+  // within |timeout_milliseconds|, and leaves their probes to finish on
+  // their own.  A root that times out kMaxProbeTimeouts lookups in a row is
+  // deprioritized for kProbePenaltySeconds: it is only probed, last, when
+  // no other root holds the file.  Off by default.
+  void set_concurrent_probing(
+      bool concurrent_probing,
+      int timeout_milliseconds = kDefaultProbeTimeoutMilliseconds);
+
+  // Returns true if the root path at |path_index| is deprioritized, as
+  // set_concurrent_probing describes.
+  bool IsRootDeprioritized(size_t path_index);
+
  protected:
   SymbolResult GetSymbolFileAtPathFromRoot(const CodeModule* module,
                                            const SystemInfo* system_info,
                                            const string& root_path,
                                            string* symbol_file);
 
+  // Sets |path| to the location of |module|'s symbol file relative to a
+  // root path, for example "test_app.pdb/<identifier>/test_app.sym".
+  // Returns false if |module| lacks the debug file or identifier needed.
+  bool GetRelativeSymbolFilePath(const CodeModule* module,
+                                 string* path) const;
+
+  // Replaces the ".sym" extension of the symbol files looked for.
+  void set_symbol_file_extension(const string& extension) {
+    symbol_file_extension_ = extension;
+  }
+
  private:
+  // Reads the symbol file at |path|, decompressing it if it is
+  // gzip-compressed.
+  bool ReadSymbolData(const string& path, string* symbol_data);
+
+  // Reads the delta at |delta_file| and applies it to its base, found in
+  // |root_path|.  |depth| is the number of deltas whose base this delta
+  // is.
+  bool ReadDeltaSymbolData(const string& root_path, const string& delta_file,
+                           int depth, string* symbol_data);
+
+  // A mapped symbol file.  |size| is the size of the whole mapping, and
+  // |data_size| that of the file at its start.
+  struct Mapping {
+    void* address;
+    size_t size;
+    size_t data_size;
+  };
+
+  // Maps the symbol file at |path| as set_use_mmap describes.  Returns
+  // false if it is empty, compressed or can't be mapped, for the caller to
+  // read it instead.
+  bool MapSymbolData(const string& path, Mapping* mapping);
+
+  // Looks for the symbol file at |relative_path| in every root path at
+  // once, as set_concurrent_probing describes.
+  SymbolResult GetSymbolFileConcurrently(const string& relative_path,
+                                         string* symbol_file);
+
+  // Probes the root paths at |path_indexes| at once, in that order of
+  // priority, and records which of them timed out.
+  SymbolResult ProbeRoots(const vector<size_t>& path_indexes,
+                          const string& relative_path,
+                          string* symbol_file);
+
+  // How a root path has answered concurrent probes.
+  struct RootHealth {
+    RootHealth() : consecutive_timeouts(0), deprioritized_until(0) {}
+    int consecutive_timeouts;
+    time_t deprioritized_until;
+  };
+
+  // The symbol data handed out and not yet freed, by code file.  Symbols
+  // may be fetched on several threads at once (see
+  // StackFrameSymbolizer::PrefetchSymbols), so |buffers_mutex_| guards
+  // them.
   map<string, char*> memory_buffers_;
+  map<string, Mapping> mappings_;
+  std::mutex buffers_mutex_;
   vector<string> paths_;
+  string symbol_file_extension_;
+  int decompression_thread_count_;
+  bool use_mmap_;
+  // The indexes of |paths_|, by position, if set_index_file_name was
+  // called.  Shared with probes that may outlive a lookup.
+  vector<std::shared_ptr<SymbolStoreIndex> > indexes_;
+  bool concurrent_probing_;
+  int probe_timeout_milliseconds_;
+  // The health of |paths_|, by position.  |health_mutex_| guards it.
+  vector<RootHealth> root_health_;
+  std::mutex health_mutex_;
 };
 
 }  // namespace google_breakpad
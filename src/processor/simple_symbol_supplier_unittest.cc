@@ -0,0 +1,209 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// simple_symbol_supplier_unittest.cc: Unit tests for SimpleSymbolSupplier's
+// handling of symbol data buffers.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/block_gzip.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "processor/basic_code_module.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicCodeModule;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::SymbolSupplier;
+
+const char kModuleId[] = "111111111111111111111111111111111";
+
+void WriteFile(const string& path, const string& contents) {
+  FILE* file = fopen(path.c_str(), "w");
+  ASSERT_TRUE(file != NULL) << path;
+  fwrite(contents.data(), 1, contents.size(), file);
+  fclose(file);
+}
+
+string ReadFile(const string& path) {
+  std::ifstream in(path.c_str());
+  string contents;
+  std::getline(in, contents, string::traits_type::to_char_type(
+                   string::traits_type::eof()));
+  return contents;
+}
+
+class SimpleSymbolSupplierTest : public ::testing::Test {
+ public:
+  SimpleSymbolSupplierTest()
+      : module_(0x1000, 0x1000, "/lib/app", "", "app.pdb", kModuleId, "") {}
+
+  void SetUp() {
+    mkdir((temp_dir_.path() + "/app.pdb").c_str(), 0755);
+    mkdir((temp_dir_.path() + "/app.pdb/" + kModuleId).c_str(), 0755);
+    symbol_file_ = temp_dir_.path() + "/app.pdb/" + kModuleId + "/app.sym";
+  }
+
+  // Gets the symbol data for module_ from |supplier| and checks that it
+  // holds |contents| followed by a terminating zero byte.
+  void CheckSymbolData(SimpleSymbolSupplier* supplier,
+                       const string& contents,
+                       char** data) {
+    string symbol_file;
+    size_t size;
+    ASSERT_EQ(SymbolSupplier::FOUND,
+              supplier->GetCStringSymbolData(&module_, NULL, &symbol_file,
+                                             data, &size));
+    EXPECT_EQ(symbol_file_, symbol_file);
+    ASSERT_EQ(contents.size() + 1, size);
+    EXPECT_EQ(0, memcmp(contents.data(), *data, contents.size()));
+    EXPECT_EQ('\0', (*data)[contents.size()]);
+  }
+
+  BasicCodeModule module_;
+  AutoTempDir temp_dir_;
+  string symbol_file_;
+};
+
+TEST_F(SimpleSymbolSupplierTest, CopiesSymbolData) {
+  const string contents = "MODULE Linux x86_64 1 app\nPUBLIC 1000 0 f\n";
+  WriteFile(symbol_file_, contents);
+
+  SimpleSymbolSupplier supplier(temp_dir_.path());
+  char* data;
+  CheckSymbolData(&supplier, contents, &data);
+  supplier.FreeSymbolData(&module_);
+}
+
+TEST_F(SimpleSymbolSupplierTest, MapsSymbolData) {
+  // A file that fills whole pages is still followed by a zero byte.
+  string contents = "MODULE Linux x86_64 1 app\n";
+  contents.resize(getpagesize() * 2, 'x');
+  WriteFile(symbol_file_, contents);
+
+  SimpleSymbolSupplier supplier(temp_dir_.path());
+  supplier.set_use_mmap(true);
+  char* data;
+  CheckSymbolData(&supplier, contents, &data);
+
+  // The mapping is private, so writing to it leaves the file alone.
+  data[0] = 'm';
+  data[contents.size() - 1] = '\0';
+  EXPECT_EQ(contents, ReadFile(symbol_file_));
+  supplier.FreeSymbolData(&module_);
+
+  // A file that ends partway through a page.
+  contents.resize(100);
+  WriteFile(symbol_file_, contents);
+  CheckSymbolData(&supplier, contents, &data);
+
+  // Getting the data again replaces the earlier mapping.
+  CheckSymbolData(&supplier, contents, &data);
+  supplier.FreeSymbolData(&module_);
+}
+
+#ifdef HAVE_LIBZ
+TEST_F(SimpleSymbolSupplierTest, ReadsCompressedSymbolDataWhenMapping) {
+  const string contents = "MODULE Linux x86_64 1 app\nPUBLIC 1000 0 f\n";
+  {
+    std::ofstream file(symbol_file_.c_str(), std::ios::binary);
+    google_breakpad::BlockGzipWriter writer(&file, 1, 256);
+    std::ostream stream(&writer);
+    stream.write(contents.data(), contents.size());
+    ASSERT_TRUE(writer.Finish());
+  }
+
+  SimpleSymbolSupplier supplier(temp_dir_.path());
+  supplier.set_use_mmap(true);
+  char* data;
+  CheckSymbolData(&supplier, contents, &data);
+  supplier.FreeSymbolData(&module_);
+}
+#endif  // HAVE_LIBZ
+
+TEST_F(SimpleSymbolSupplierTest, ProbesRootsConcurrently) {
+  WriteFile(symbol_file_, "MODULE Linux x86_64 1 app\n");
+
+  // The first root's index is a FIFO with no writer, so reading it hangs
+  // until the test opens the FIFO itself.
+  AutoTempDir hung_dir;
+  const string index_path = hung_dir.path() + "/index.txt";
+  ASSERT_EQ(0, mkfifo(index_path.c_str(), 0600));
+
+  std::vector<string> paths;
+  paths.push_back(hung_dir.path());
+  paths.push_back(temp_dir_.path());
+  SimpleSymbolSupplier supplier(paths);
+  supplier.set_index_file_name("index.txt");
+  supplier.set_concurrent_probing(true, 50);
+
+  // The second root answers without waiting for the first.
+  string symbol_file;
+  EXPECT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module_, NULL, &symbol_file));
+  EXPECT_EQ(symbol_file_, symbol_file);
+  EXPECT_FALSE(supplier.IsRootDeprioritized(0));
+
+  // A miss waits for the first root until it times out, and enough of
+  // those deprioritize it.
+  BasicCodeModule missing(0x1000, 0x1000, "/lib/other", "", "other.pdb",
+                          kModuleId, "");
+  for (int i = 0; i < SimpleSymbolSupplier::kMaxProbeTimeouts; ++i) {
+    EXPECT_FALSE(supplier.IsRootDeprioritized(0));
+    EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+              supplier.GetSymbolFile(&missing, NULL, &symbol_file));
+  }
+  EXPECT_TRUE(supplier.IsRootDeprioritized(0));
+  EXPECT_FALSE(supplier.IsRootDeprioritized(1));
+
+  EXPECT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module_, NULL, &symbol_file));
+  EXPECT_EQ(symbol_file_, symbol_file);
+
+  // Let the hung probes finish.
+  int fd = open(index_path.c_str(), O_WRONLY | O_NONBLOCK);
+  EXPECT_NE(-1, fd);
+  close(fd);
+}
+
+}  // namespace
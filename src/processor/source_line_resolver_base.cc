@@ -41,13 +41,18 @@
 #include <string.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <map>
+#include <mutex>
 #include <utility>
+#include <vector>
 
+#include "common/block_gzip.h"
 #include "google_breakpad/processor/source_line_resolver_base.h"
 #include "processor/logging.h"
 #include "processor/module_factory.h"
 #include "processor/source_line_resolver_base_types.h"
+#include "processor/trace_probes.h"
 
 using std::make_pair;
 
@@ -58,7 +63,13 @@ SourceLineResolverBase::SourceLineResolverBase(
   : modules_(new ModuleMap),
     corrupt_modules_(new ModuleSet),
     memory_buffers_(new MemoryMap),
-    module_factory_(module_factory) {
+    module_factory_(module_factory),
+    module_cache_budget_(0),
+    resident_bytes_(0),
+    module_cache_hits_(0),
+    module_cache_misses_(0),
+    module_cache_evictions_(0),
+    decompression_thread_count_(1) {
 }
 
 SourceLineResolverBase::~SourceLineResolverBase() {
@@ -90,7 +101,8 @@ SourceLineResolverBase::~SourceLineResolverBase() {
 
 bool SourceLineResolverBase::ReadSymbolFile(const string& map_file,
                                             char** symbol_data,
-                                            size_t* symbol_data_size) {
+                                            size_t* symbol_data_size,
+                                            int decompression_thread_count) {
   if (symbol_data == NULL || symbol_data_size == NULL) {
     BPLOG(ERROR) << "Could not Read file into Null memory pointer";
     return false;
@@ -148,6 +160,22 @@ bool SourceLineResolverBase::ReadSymbolFile(const string& map_file,
   }
 
   (*symbol_data)[file_size] = '\0';
+
+  if (IsGzipData(*symbol_data, file_size)) {
+    char* contents;
+    size_t contents_size;
+    bool decompressed = GunzipData(*symbol_data, file_size,
+                                   decompression_thread_count,
+                                   &contents, &contents_size);
+    delete [] (*symbol_data);
+    *symbol_data = NULL;
+    if (!decompressed) {
+      BPLOG(ERROR) << "Could not decompress " << map_file;
+      return false;
+    }
+    *symbol_data = contents;
+    *symbol_data_size = contents_size;
+  }
   return true;
 }
 
@@ -168,7 +196,8 @@ bool SourceLineResolverBase::LoadModule(const CodeModule* module,
 
   char* memory_buffer;
   size_t memory_buffer_size;
-  if (!ReadSymbolFile(map_file, &memory_buffer, &memory_buffer_size))
+  if (!ReadSymbolFile(map_file, &memory_buffer, &memory_buffer_size,
+                      decompression_thread_count_))
     return false;
 
   BPLOG(INFO) << "Read symbol file " << map_file << " succeeded. "
@@ -247,6 +276,7 @@ bool SourceLineResolverBase::LoadModuleUsingMemoryBuffer(
   Module* basic_module = module_factory_->CreateModule(module->code_file());
 
   // Ownership of memory is NOT transfered to Module::LoadMapFromMemory().
+  BPTRACE2(load_module_begin, module->code_file().c_str(), memory_buffer_size);
   if (!basic_module->LoadMapFromMemory(memory_buffer, memory_buffer_size)) {
     BPLOG(ERROR) << "Too many error while parsing symbol data for module "
                  << module->code_file();
@@ -254,11 +284,29 @@ bool SourceLineResolverBase::LoadModuleUsingMemoryBuffer(
     // this module are missing which would be wrong.  Intentionally fall through
     // and add the module to both the modules_ and the corrupt_modules_ lists.
   }
+  BPTRACE2(load_module_end, module->code_file().c_str(),
+           basic_module->IsCorrupt());
 
   modules_->insert(make_pair(module->code_file(), basic_module));
   if (basic_module->IsCorrupt()) {
     corrupt_modules_->insert(module->code_file());
   }
+
+  CachedModule cached_module;
+  cached_module.code_file = module->code_file();
+  cached_module.code_identifier = module->code_identifier();
+  cached_module.debug_file = module->debug_file();
+  cached_module.debug_identifier = module->debug_identifier();
+  cached_module.resident_bytes = basic_module->ResidentBytes();
+  cached_module.hits = 0;
+  {
+    std::lock_guard<std::mutex> lock(module_lru_mutex_);
+    module_lru_.push_front(cached_module);
+    module_lru_index_[cached_module.code_file] = module_lru_.begin();
+    resident_bytes_ += cached_module.resident_bytes;
+  }
+  if (module_cache_budget_)
+    EvictModules(cached_module.code_file);
   return true;
 }
 
@@ -269,8 +317,11 @@ bool SourceLineResolverBase::ShouldDeleteMemoryBufferAfterLoadModule() {
 void SourceLineResolverBase::UnloadModule(const CodeModule* code_module) {
   if (!code_module)
     return;
+  UnloadModuleByName(code_module->code_file());
+}
 
-  ModuleMap::iterator mod_iter = modules_->find(code_module->code_file());
+void SourceLineResolverBase::UnloadModuleByName(const string& code_file) {
+  ModuleMap::iterator mod_iter = modules_->find(code_file);
   if (mod_iter != modules_->end()) {
     Module* symbol_module = mod_iter->second;
     delete symbol_module;
@@ -278,11 +329,21 @@ void SourceLineResolverBase::UnloadModule(const CodeModule* code_module) {
     modules_->erase(mod_iter);
   }
 
+  {
+    std::lock_guard<std::mutex> lock(module_lru_mutex_);
+    ModuleLRUIndex::iterator lru_iter = module_lru_index_.find(code_file);
+    if (lru_iter != module_lru_index_.end()) {
+      resident_bytes_ -= lru_iter->second->resident_bytes;
+      module_lru_.erase(lru_iter->second);
+      module_lru_index_.erase(lru_iter);
+    }
+  }
+
   if (ShouldDeleteMemoryBufferAfterLoadModule()) {
     // No-op.  Because we never store any memory buffers.
   } else {
     // There may be a buffer stored locally, we need to find and delete it.
-    MemoryMap::iterator iter = memory_buffers_->find(code_module->code_file());
+    MemoryMap::iterator iter = memory_buffers_->find(code_file);
     if (iter != memory_buffers_->end()) {
       delete [] iter->second;
       memory_buffers_->erase(iter);
@@ -290,10 +351,128 @@ void SourceLineResolverBase::UnloadModule(const CodeModule* code_module) {
   }
 }
 
+void SourceLineResolverBase::set_module_cache_budget(size_t budget) {
+  module_cache_budget_ = budget;
+  if (module_cache_budget_)
+    EvictModules(string());
+}
+
+SourceLineResolverBase::ModuleCacheStats
+SourceLineResolverBase::module_cache_stats() const {
+  ModuleCacheStats stats;
+  stats.hits = module_cache_hits_;
+  stats.misses = module_cache_misses_;
+  stats.evictions = module_cache_evictions_;
+  stats.module_count = modules_->size();
+  stats.resident_bytes = resident_bytes_;
+  return stats;
+}
+
+void SourceLineResolverBase::TouchModule(const string& code_file) {
+  if (!module_cache_budget_)
+    return;
+  std::lock_guard<std::mutex> lock(module_lru_mutex_);
+  ModuleLRUIndex::iterator lru_iter = module_lru_index_.find(code_file);
+  if (lru_iter != module_lru_index_.end())
+    module_lru_.splice(module_lru_.begin(), module_lru_, lru_iter->second);
+}
+
+void SourceLineResolverBase::CountModuleHit(const string& code_file) {
+  std::lock_guard<std::mutex> lock(module_lru_mutex_);
+  ModuleLRUIndex::iterator lru_iter = module_lru_index_.find(code_file);
+  if (lru_iter == module_lru_index_.end())
+    return;
+  ++lru_iter->second->hits;
+  if (module_cache_budget_)
+    module_lru_.splice(module_lru_.begin(), module_lru_, lru_iter->second);
+}
+
+std::vector<SourceLineResolverBase::ModuleHits>
+SourceLineResolverBase::HottestModules(size_t max_count) {
+  std::vector<ModuleHits> modules;
+  {
+    std::lock_guard<std::mutex> lock(module_lru_mutex_);
+    modules.reserve(module_lru_.size());
+    for (const CachedModule& cached_module : module_lru_) {
+      ModuleHits module;
+      module.code_file = cached_module.code_file;
+      module.code_identifier = cached_module.code_identifier;
+      module.debug_file = cached_module.debug_file;
+      module.debug_identifier = cached_module.debug_identifier;
+      module.hits = cached_module.hits;
+      modules.push_back(module);
+    }
+  }
+  // Ties keep the more recently used module, or with no budget the more
+  // recently loaded one, first.
+  std::stable_sort(modules.begin(), modules.end(),
+                   [](const ModuleHits& a, const ModuleHits& b) {
+                     return a.hits > b.hits;
+                   });
+  if (modules.size() > max_count)
+    modules.resize(max_count);
+  return modules;
+}
+
+std::vector<SourceLineResolverBase::ModuleMemoryUsage>
+SourceLineResolverBase::ModuleMemoryUsages() {
+  std::vector<ModuleMemoryUsage> usages;
+  usages.reserve(modules_->size());
+  for (ModuleMap::const_iterator it = modules_->begin();
+       it != modules_->end(); ++it) {
+    ModuleMemoryUsage usage = ModuleMemoryUsage();
+    usage.code_file = it->first;
+    it->second->GetMemoryUsage(&usage);
+    if (memory_buffers_->find(it->first) != memory_buffers_->end()) {
+      usage.copied_buffer_bytes = usage.supplied_buffer_bytes;
+      usage.supplied_buffer_bytes = 0;
+    }
+    usages.push_back(usage);
+  }
+  std::stable_sort(usages.begin(), usages.end(),
+                   [](const ModuleMemoryUsage& a, const ModuleMemoryUsage& b) {
+                     return a.resident_bytes > b.resident_bytes;
+                   });
+  return usages;
+}
+
+void SourceLineResolverBase::EvictModules(const string& keep) {
+  while (true) {
+    string victim;
+    {
+      std::lock_guard<std::mutex> lock(module_lru_mutex_);
+      if (resident_bytes_ <= module_cache_budget_ || module_lru_.empty())
+        return;
+      victim = module_lru_.back().code_file;
+      if (victim == keep) {
+        // Only the module being loaded is left; it stays even if it does
+        // not fit.
+        if (module_lru_.size() == 1)
+          return;
+        module_lru_.splice(module_lru_.begin(), module_lru_,
+                           --module_lru_.end());
+        victim = module_lru_.back().code_file;
+      }
+    }
+    BPLOG(INFO) << "Evicting symbols for module " << victim
+                << " to stay within the module cache budget of "
+                << module_cache_budget_ << " bytes";
+    UnloadModuleByName(victim);
+    ++module_cache_evictions_;
+  }
+}
+
 bool SourceLineResolverBase::HasModule(const CodeModule* module) {
   if (!module)
     return false;
-  return modules_->find(module->code_file()) != modules_->end();
+  const string code_file = module->code_file();
+  if (modules_->find(code_file) == modules_->end()) {
+    module_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  module_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+  CountModuleHit(code_file);
+  return true;
 }
 
 bool SourceLineResolverBase::IsModuleCorrupt(const CodeModule* module) {
@@ -308,16 +487,45 @@ void SourceLineResolverBase::FillSourceLineInfo(
   if (frame->module) {
     ModuleMap::const_iterator it = modules_->find(frame->module->code_file());
     if (it != modules_->end()) {
+      TouchModule(it->first);
       it->second->LookupAddress(frame, inlined_frames);
     }
   }
 }
 
+void SourceLineResolverBase::FillSourceLineInfoWithInlineRecords(
+    StackFrame* frame) {
+  if (frame->module) {
+    ModuleMap::const_iterator it = modules_->find(frame->module->code_file());
+    if (it != modules_->end()) {
+      TouchModule(it->first);
+      it->second->LookupAddressWithInlineRecords(frame);
+    }
+  }
+}
+
+bool SourceLineResolverBase::ExpandInlineFrames(
+    const StackFrame& frame,
+    std::deque<std::unique_ptr<StackFrame>>* inlined_frames) {
+  if (frame.inline_records.empty())
+    return true;
+  if (frame.module) {
+    ModuleMap::const_iterator it = modules_->find(frame.module->code_file());
+    if (it != modules_->end()) {
+      TouchModule(it->first);
+      it->second->ExpandInlineFrames(frame, inlined_frames);
+      return true;
+    }
+  }
+  return false;
+}
+
 WindowsFrameInfo* SourceLineResolverBase::FindWindowsFrameInfo(
     const StackFrame* frame) {
   if (frame->module) {
     ModuleMap::const_iterator it = modules_->find(frame->module->code_file());
     if (it != modules_->end()) {
+      TouchModule(it->first);
       return it->second->FindWindowsFrameInfo(frame);
     }
   }
@@ -329,6 +537,7 @@ CFIFrameInfo* SourceLineResolverBase::FindCFIFrameInfo(
   if (frame->module) {
     ModuleMap::const_iterator it = modules_->find(frame->module->code_file());
     if (it != modules_->end()) {
+      TouchModule(it->first);
       return it->second->FindCFIFrameInfo(frame);
     }
   }
@@ -340,6 +549,46 @@ bool SourceLineResolverBase::CompareString::operator()(
   return strcmp(s1.c_str(), s2.c_str()) < 0;
 }
 
+void SourceLineResolverBase::Module::ExpandInlineFrames(
+    const StackFrame& frame,
+    std::deque<std::unique_ptr<StackFrame>>* inlined_frames) const {
+  for (const InlineFrameRecord& record : frame.inline_records) {
+    std::unique_ptr<StackFrame> inlined_frame(new StackFrame(frame));
+    inlined_frame->inline_records.clear();
+    if (!GetInlineOriginName(record.origin_id,
+                             &inlined_frame->function_name)) {
+      inlined_frame->function_name = "<name omitted>";
+    }
+    inlined_frame->function_base =
+        frame.module->base_address() + record.function_base;
+    inlined_frame->source_line = record.source_line;
+    inlined_frame->source_file_name.clear();
+    GetFileName(record.source_file_id, &inlined_frame->source_file_name);
+    inlined_frame->trust = StackFrame::FRAME_TRUST_INLINE;
+    inlined_frames->push_back(std::move(inlined_frame));
+  }
+}
+
+void SourceLineResolverBase::Module::RecordInlineFrames(
+    StackFrame* frame, int line_file_id,
+    std::vector<InlineFrameRecord>* records) const {
+  if (records->empty())
+    return;
+
+  int source_line = frame->source_line;
+  int source_file_id = line_file_id;
+  for (InlineFrameRecord& record : *records) {
+    if (record.source_file_id == -1)
+      record.source_file_id = line_file_id;
+    std::swap(record.source_line, source_line);
+    std::swap(record.source_file_id, source_file_id);
+  }
+  frame->source_line = source_line;
+  frame->source_file_name.clear();
+  GetFileName(source_file_id, &frame->source_file_name);
+  frame->inline_records.swap(*records);
+}
+
 bool SourceLineResolverBase::Module::ParseCFIRuleSet(
     const string& rule_set, CFIFrameInfo* frame_info) const {
   CFIFrameInfoParseHandler handler(frame_info);
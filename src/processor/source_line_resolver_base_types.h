@@ -43,7 +43,9 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "common/string_view.h"
 #include "google_breakpad/common/breakpad_types.h"
 #include "google_breakpad/processor/source_line_resolver_base.h"
 #include "google_breakpad/processor/stack_frame.h"
@@ -71,14 +73,15 @@ class SourceLineResolverBase::AutoFileCloser {
 
 struct SourceLineResolverBase::InlineOrigin {
   InlineOrigin() {}
-  InlineOrigin(bool has_file_id, int32_t source_file_id, const string& name)
+  InlineOrigin(bool has_file_id, int32_t source_file_id, StringView name)
       : has_file_id(has_file_id),
         source_file_id(source_file_id),
         name(name) {}
   // If it's old format, source file id is set, otherwise not useful.
   bool has_file_id;
   int32_t source_file_id;
-  string name;
+  // Owned by the module the origin belongs to.
+  StringView name;
 };
 
 struct SourceLineResolverBase::Inline {
@@ -122,7 +125,7 @@ struct SourceLineResolverBase::Line {
 
 struct SourceLineResolverBase::Function {
   Function() { }
-  Function(const string& function_name,
+  Function(StringView function_name,
            MemAddr function_address,
            MemAddr code_size,
            int set_parameter_size,
@@ -130,7 +133,8 @@ struct SourceLineResolverBase::Function {
       : name(function_name), address(function_address), size(code_size),
         parameter_size(set_parameter_size), is_multiple(is_multiple) { }
 
-  string name;
+  // Owned by the module the function belongs to.
+  StringView name;
   MemAddr address;
   MemAddr size;
 
@@ -143,7 +147,7 @@ struct SourceLineResolverBase::Function {
 
 struct SourceLineResolverBase::PublicSymbol {
   PublicSymbol() { }
-  PublicSymbol(const string& set_name,
+  PublicSymbol(StringView set_name,
                MemAddr set_address,
                int set_parameter_size,
                bool is_multiple)
@@ -152,7 +156,8 @@ struct SourceLineResolverBase::PublicSymbol {
         parameter_size(set_parameter_size),
         is_multiple(is_multiple) {}
 
-  string name;
+  // Owned by the module the symbol belongs to.
+  StringView name;
   MemAddr address;
 
   // If the public symbol is used as a function entry point, parameter_size
@@ -186,6 +191,21 @@ class SourceLineResolverBase::Module {
       StackFrame* frame,
       std::deque<std::unique_ptr<StackFrame>>* inlined_frames) const = 0;
 
+  // Looks up the given relative address as LookupAddress does, but records
+  // the inlined frames in the frame's inline_records instead of
+  // constructing them.  Modules that cannot record inlined frames fill in
+  // the frame without them.
+  virtual void LookupAddressWithInlineRecords(StackFrame* frame) const {
+    LookupAddress(frame, nullptr);
+  }
+
+  // Constructs the inlined frames recorded in |frame|'s inline_records by
+  // LookupAddressWithInlineRecords, adding them to |inlined_frames|
+  // innermost first, as LookupAddress would have.
+  void ExpandInlineFrames(
+      const StackFrame& frame,
+      std::deque<std::unique_ptr<StackFrame>>* inlined_frames) const;
+
   // If Windows stack walking information is available covering ADDRESS,
   // return a WindowsFrameInfo structure describing it. If the information
   // is not available, returns NULL. A NULL return value does not indicate
@@ -199,9 +219,36 @@ class SourceLineResolverBase::Module {
   // is not available, return NULL. The caller takes ownership of any
   // returned CFIFrameInfo object.
   virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame) const = 0;
+
+  // Returns an estimate of the memory used by the loaded symbol data,
+  // including the memory buffer if the module keeps referring to it.
+  virtual size_t ResidentBytes() const = 0;
+
+  // Sets |usage| to the module's share of ResidentBytes() by kind of
+  // record, counting the memory buffer the module keeps referring to, if
+  // any, as supplied_buffer_bytes.  Leaves code_file alone.
+  virtual void GetMemoryUsage(ModuleMemoryUsage* usage) const = 0;
  protected:
   virtual bool ParseCFIRuleSet(const string& rule_set,
                                CFIFrameInfo* frame_info) const;
+
+  // Set |name| to the name of the INLINE_ORIGIN record |origin_id|, or of
+  // the FILE record |file_id|.  Return false if there is no such record.
+  // Modules that record inlined frames override these.
+  virtual bool GetInlineOriginName(int origin_id, string* name) const {
+    return false;
+  }
+  virtual bool GetFileName(int file_id, string* name) const { return false; }
+
+  // Stores |records|, the inlines containing |frame|'s address from the
+  // innermost to the outermost, each at its call site, in |frame|'s
+  // inline_records.  As ConstructInlineFrames does, each inlined frame is
+  // then at the call site of the one inside it, the innermost at |frame|'s
+  // own source line, in the FILE record |line_file_id|, and |frame| itself
+  // at the call site of the outermost.  Call sites with a source_file_id of
+  // -1 are taken to be in |line_file_id|.
+  void RecordInlineFrames(StackFrame* frame, int line_file_id,
+                          std::vector<InlineFrameRecord>* records) const;
 };
 
 }  // namespace google_breakpad
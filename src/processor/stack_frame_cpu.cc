@@ -38,8 +38,22 @@
 
 #include "google_breakpad/processor/stack_frame_cpu.h"
 
+#include <stddef.h>
+#include <string.h>
+
 namespace google_breakpad {
 
+// The registers that frames recover come before the floating-point save
+// area in both contexts.
+
+void StackFrameAMD64::CopyIntegerRegisters(const StackFrameAMD64& callee) {
+  memcpy(&context, &callee.context, offsetof(MDRawContextAMD64, flt_save));
+}
+
+void StackFrameARM64::CopyIntegerRegisters(const StackFrameARM64& callee) {
+  memcpy(&context, &callee.context, offsetof(MDRawContextARM64, float_save));
+}
+
 const uint64_t StackFrameARM64::CONTEXT_VALID_X0;
 const uint64_t StackFrameARM64::CONTEXT_VALID_X1;
 const uint64_t StackFrameARM64::CONTEXT_VALID_X2;
@@ -39,22 +39,62 @@
 
 #include <assert.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+
 #include "common/scoped_ptr.h"
 #include "google_breakpad/processor/code_module.h"
 #include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/missing_symbols_cache.h"
+#include "google_breakpad/processor/process_stats.h"
 #include "google_breakpad/processor/source_line_resolver_interface.h"
 #include "google_breakpad/processor/stack_frame.h"
 #include "google_breakpad/processor/symbol_supplier.h"
 #include "google_breakpad/processor/system_info.h"
+#include "processor/cfi_frame_info.h"
 #include "processor/linked_ptr.h"
 #include "processor/logging.h"
+#include "processor/pathname_stripper.h"
+#include "processor/trace_probes.h"
+#include "processor/windows_frame_info.h"
 
 namespace google_breakpad {
 
 StackFrameSymbolizer::StackFrameSymbolizer(
     SymbolSupplier* supplier,
-    SourceLineResolverInterface* resolver) : supplier_(supplier),
-                                             resolver_(resolver) { }
+    SourceLineResolverInterface* resolver)
+    : supplier_(supplier),
+      resolver_(resolver),
+      missing_symbols_cache_(NULL),
+      persist_frame_info_cache_(false),
+      cache_source_line_info_(false),
+      lazy_inline_frames_(false) { }
+
+StackFrameSymbolizer::~StackFrameSymbolizer() { }
+
+void StackFrameSymbolizer::Reset() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  no_symbol_modules_.clear();
+  std::lock_guard<std::mutex> cache_lock(cache_mutex_);
+  if (!persist_frame_info_cache_) {
+    windows_frame_info_cache_.clear();
+    cfi_frame_info_cache_.clear();
+    source_line_info_cache_.clear();
+  }
+}
+
+bool StackFrameSymbolizer::PrefersFramePointer(const StackFrame* frame) const {
+  if (frame_pointer_modules_.empty() || !frame->module)
+    return false;
+  return frame_pointer_modules_.count(
+             PathnameStripper::File(frame->module->code_file())) ||
+         frame_pointer_modules_.count(
+             PathnameStripper::File(frame->module->debug_file()));
+}
 
 StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::FillSourceLineInfo(
     const CodeModules* modules,
@@ -62,6 +102,68 @@ StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::FillSourceLineInfo(
     const SystemInfo* system_info,
     StackFrame* frame,
     std::deque<std::unique_ptr<StackFrame>>* inlined_frames) {
+  return Symbolize(modules, unloaded_modules, system_info, frame,
+                   inlined_frames, true);
+}
+
+StackFrameSymbolizer::SymbolizerResult
+StackFrameSymbolizer::LoadSymbolsForFrame(const CodeModules* modules,
+                                          const CodeModules* unloaded_modules,
+                                          const SystemInfo* system_info,
+                                          StackFrame* frame) {
+  return Symbolize(modules, unloaded_modules, system_info, frame, nullptr,
+                   false);
+}
+
+void StackFrameSymbolizer::FillSourceLineInfoBatch(
+    const std::vector<StackFrame*>& frames,
+    std::vector<std::deque<std::unique_ptr<StackFrame>>>* inlined_frames) {
+  inlined_frames->clear();
+  inlined_frames->resize(frames.size());
+  if (!resolver_)
+    return;
+
+  std::vector<size_t> order;
+  order.reserve(frames.size());
+  for (size_t i = 0; i < frames.size(); ++i) {
+    if (frames[i]->module)
+      order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [&frames](size_t a, size_t b) {
+    const StackFrame* frame_a = frames[a];
+    const StackFrame* frame_b = frames[b];
+    uint64_t base_a = frame_a->module->base_address();
+    uint64_t base_b = frame_b->module->base_address();
+    if (base_a != base_b)
+      return base_a < base_b;
+    if (frame_a->module != frame_b->module)
+      return frame_a->module < frame_b->module;
+    return frame_a->instruction < frame_b->instruction;
+  });
+
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  const CodeModule* module = NULL;
+  bool loaded = false;
+  for (size_t i : order) {
+    StackFrame* frame = frames[i];
+    if (frame->module != module) {
+      module = frame->module;
+      loaded = no_symbol_modules_.find(module->code_file()) ==
+                   no_symbol_modules_.end() &&
+               resolver_->HasModule(module);
+    }
+    if (loaded)
+      FillFromLoadedModule(frame, &(*inlined_frames)[i]);
+  }
+}
+
+StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::Symbolize(
+    const CodeModules* modules,
+    const CodeModules* unloaded_modules,
+    const SystemInfo* system_info,
+    StackFrame* frame,
+    std::deque<std::unique_ptr<StackFrame>>* inlined_frames,
+    bool fill) {
   assert(frame);
 
   const CodeModule* module = NULL;
@@ -76,17 +178,12 @@ StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::FillSourceLineInfo(
   frame->module = module;
 
   if (!resolver_) return kError;  // no resolver.
-  // If module is known to have missing symbol file, return.
-  if (no_symbol_modules_.find(module->code_file()) !=
-      no_symbol_modules_.end()) {
-    return kError;
-  }
 
-  // If module is already loaded, go ahead to fill source line info and return.
-  if (resolver_->HasModule(frame->module)) {
-    resolver_->FillSourceLineInfo(frame, inlined_frames);
-    return resolver_->IsModuleCorrupt(frame->module) ?
-        kWarningCorruptSymbols : kNoError;
+  SymbolizerResult result;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (FillFromKnownModule(module, frame, inlined_frames, fill, &result))
+      return result;
   }
 
   // Module needs to fetch symbol file. First check to see if supplier exists.
@@ -94,36 +191,56 @@ StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::FillSourceLineInfo(
     return kError;
   }
 
+  // Loading is serialized.  Another thread may have loaded this module, or
+  // found it to have no symbols, while the shared lock was released, so
+  // check again before asking the supplier.
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  prefetched_.wait(lock, [this, module] {
+    return prefetching_modules_.find(module->code_file()) ==
+           prefetching_modules_.end();
+  });
+  if (FillFromKnownModule(module, frame, inlined_frames, fill, &result))
+    return result;
+
   // Start fetching symbol from supplier.
+  ProcessStats* stats = ProcessStats::Current();
+  ProcessStats::Clock::time_point start;
+  if (stats)
+    start = ProcessStats::Clock::now();
   string symbol_file;
   char* symbol_data = NULL;
-  size_t symbol_data_size;
+  size_t symbol_data_size = 0;
+  BPTRACE1(symbol_supplier_begin, module->code_file().c_str());
   SymbolSupplier::SymbolResult symbol_result = supplier_->GetCStringSymbolData(
       module, system_info, &symbol_file, &symbol_data, &symbol_data_size);
+  BPTRACE3(symbol_supplier_end, module->code_file().c_str(), symbol_result,
+           symbol_data_size);
+  uint64_t supplier_nanoseconds = 0;
+  if (stats) {
+    supplier_nanoseconds = ProcessStats::NanosecondsSince(start);
+    stats->AddSymbolSupplierCall(supplier_nanoseconds);
+  }
 
   switch (symbol_result) {
     case SymbolSupplier::FOUND: {
-      bool load_success = resolver_->LoadModuleUsingMemoryBuffer(
-          frame->module,
-          symbol_data,
-          symbol_data_size);
+      bool load_success = LoadModule(module, symbol_data, symbol_data_size,
+                                     stats, supplier_nanoseconds);
       if (resolver_->ShouldDeleteMemoryBufferAfterLoadModule()) {
         supplier_->FreeSymbolData(module);
       }
 
       if (load_success) {
-        resolver_->FillSourceLineInfo(frame, inlined_frames);
-        return resolver_->IsModuleCorrupt(frame->module) ?
-            kWarningCorruptSymbols : kNoError;
+        return fill ? FillFromLoadedModule(frame, inlined_frames) :
+                      LoadedModuleResult(module);
       } else {
         BPLOG(ERROR) << "Failed to load symbol file in resolver.";
-        no_symbol_modules_.insert(module->code_file());
+        RecordNoSymbols(module);
         return kError;
       }
     }
 
     case SymbolSupplier::NOT_FOUND:
-      no_symbol_modules_.insert(module->code_file());
+      RecordNoSymbols(module);
       return kError;
 
     case SymbolSupplier::INTERRUPT:
@@ -138,12 +255,326 @@ StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::FillSourceLineInfo(
 
 WindowsFrameInfo* StackFrameSymbolizer::FindWindowsFrameInfo(
     const StackFrame* frame) {
-  return resolver_ ? resolver_->FindWindowsFrameInfo(frame) : NULL;
+  if (!resolver_) return NULL;
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  FrameInfoKey key;
+  if (!GetFrameInfoKey(frame, &key))
+    return resolver_->FindWindowsFrameInfo(frame);
+
+  {
+    std::lock_guard<std::mutex> cache_lock(cache_mutex_);
+    WindowsFrameInfoCache::const_iterator it =
+        windows_frame_info_cache_.find(key);
+    if (it != windows_frame_info_cache_.end())
+      return it->second ? new WindowsFrameInfo(*it->second) : NULL;
+  }
+
+  // Ask the resolver without holding cache_mutex_; if another thread
+  // raced us to the same key, both results are equal and either will do.
+  WindowsFrameInfo* info = resolver_->FindWindowsFrameInfo(frame);
+  std::lock_guard<std::mutex> cache_lock(cache_mutex_);
+  if (windows_frame_info_cache_.size() >= kMaxCachedFrameInfo)
+    windows_frame_info_cache_.clear();
+  windows_frame_info_cache_[key].reset(
+      info ? new WindowsFrameInfo(*info) : NULL);
+  return info;
 }
 
 CFIFrameInfo* StackFrameSymbolizer::FindCFIFrameInfo(
     const StackFrame* frame) {
-  return resolver_ ? resolver_->FindCFIFrameInfo(frame) : NULL;
+  if (!resolver_) return NULL;
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  FrameInfoKey key;
+  if (!GetFrameInfoKey(frame, &key))
+    return resolver_->FindCFIFrameInfo(frame);
+
+  {
+    std::lock_guard<std::mutex> cache_lock(cache_mutex_);
+    CFIFrameInfoCache::const_iterator it = cfi_frame_info_cache_.find(key);
+    if (it != cfi_frame_info_cache_.end())
+      return it->second ? new CFIFrameInfo(*it->second) : NULL;
+  }
+
+  // Copies of a CFIFrameInfo share their compiled rules, so keeping one
+  // here is cheap.
+  CFIFrameInfo* info = resolver_->FindCFIFrameInfo(frame);
+  std::lock_guard<std::mutex> cache_lock(cache_mutex_);
+  if (cfi_frame_info_cache_.size() >= kMaxCachedFrameInfo)
+    cfi_frame_info_cache_.clear();
+  cfi_frame_info_cache_[key].reset(info ? new CFIFrameInfo(*info) : NULL);
+  return info;
+}
+
+void StackFrameSymbolizer::PrefetchSymbols(
+    const std::vector<const CodeModule*>& modules,
+    const SystemInfo* system_info) {
+  if (!resolver_ || !supplier_) return;
+
+  std::vector<const CodeModule*> pending;
+  {
+    // Modules another call is already prefetching are left to it.
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (const CodeModule* module : modules) {
+      if (!module ||
+          no_symbol_modules_.find(module->code_file()) !=
+              no_symbol_modules_.end() ||
+          resolver_->HasModule(module) ||
+          (missing_symbols_cache_ &&
+           missing_symbols_cache_->IsMissing(module)) ||
+          !prefetching_modules_.insert(module->code_file()).second) {
+        continue;
+      }
+      pending.push_back(module);
+    }
+  }
+
+  // The results may arrive on other threads, so they are recorded in the
+  // calling thread's stats.
+  ProcessStats* stats = ProcessStats::Current();
+  std::mutex done_mutex;
+  std::condition_variable done;
+  size_t remaining = pending.size();
+  for (const CodeModule* module : pending) {
+    ProcessStats::Clock::time_point start;
+    if (stats)
+      start = ProcessStats::Clock::now();
+    BPTRACE1(symbol_supplier_begin, module->code_file().c_str());
+    supplier_->GetCStringSymbolDataAsync(
+        module, system_info,
+        [this, module, stats, start, &done_mutex, &done, &remaining](
+            SymbolSupplier::SymbolResult result, const string& symbol_file,
+            char* symbol_data, size_t symbol_data_size) {
+          BPTRACE3(symbol_supplier_end, module->code_file().c_str(), result,
+                   symbol_data_size);
+          uint64_t supplier_nanoseconds = 0;
+          if (stats) {
+            supplier_nanoseconds = ProcessStats::NanosecondsSince(start);
+            stats->AddSymbolSupplierCall(supplier_nanoseconds);
+          }
+          LoadPrefetchedSymbols(module, result, symbol_data,
+                                symbol_data_size, stats,
+                                supplier_nanoseconds);
+          // Notify while holding done_mutex, so the waiter cannot return
+          // and destroy |done| first.
+          std::lock_guard<std::mutex> lock(done_mutex);
+          if (--remaining == 0)
+            done.notify_all();
+        });
+  }
+
+  std::unique_lock<std::mutex> lock(done_mutex);
+  done.wait(lock, [&remaining] { return remaining == 0; });
+}
+
+void StackFrameSymbolizer::LoadPrefetchedSymbols(
+    const CodeModule* module,
+    SymbolSupplier::SymbolResult result,
+    char* symbol_data,
+    size_t symbol_data_size,
+    ProcessStats* stats,
+    uint64_t supplier_nanoseconds) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  switch (result) {
+    case SymbolSupplier::FOUND:
+      if (!resolver_->HasModule(module) &&
+          !LoadModule(module, symbol_data, symbol_data_size, stats,
+                      supplier_nanoseconds)) {
+        BPLOG(ERROR) << "Failed to load symbol file in resolver.";
+        RecordNoSymbols(module);
+      }
+      if (resolver_->ShouldDeleteMemoryBufferAfterLoadModule()) {
+        supplier_->FreeSymbolData(module);
+      }
+      break;
+
+    case SymbolSupplier::NOT_FOUND:
+      RecordNoSymbols(module);
+      break;
+
+    case SymbolSupplier::INTERRUPT:
+      // Leave the module to be fetched when a frame needs it, which
+      // interrupts the walk.
+      break;
+
+    default:
+      BPLOG(ERROR) << "Unknown SymbolResult enum: " << result;
+      break;
+  }
+  prefetching_modules_.erase(module->code_file());
+  prefetched_.notify_all();
+}
+
+bool StackFrameSymbolizer::LoadModule(const CodeModule* module,
+                                      char* symbol_data,
+                                      size_t symbol_data_size,
+                                      ProcessStats* stats,
+                                      uint64_t supplier_nanoseconds) {
+  if (!stats) {
+    return resolver_->LoadModuleUsingMemoryBuffer(module, symbol_data,
+                                                  symbol_data_size);
+  }
+
+  ProcessStats::Clock::time_point start = ProcessStats::Clock::now();
+  ProcessStats::ModuleLoad load;
+  load.code_file = module->code_file();
+  load.supplier_nanoseconds = supplier_nanoseconds;
+  load.symbol_data_size = symbol_data_size;
+  load.loaded = resolver_->LoadModuleUsingMemoryBuffer(module, symbol_data,
+                                                       symbol_data_size);
+  load.load_nanoseconds = ProcessStats::NanosecondsSince(start);
+  stats->AddModuleLoad(load);
+  return load.loaded;
+}
+
+bool StackFrameSymbolizer::GetFrameInfoKey(const StackFrame* frame,
+                                           FrameInfoKey* key) {
+  const CodeModule* module = frame->module;
+  if (!module || frame->instruction < module->base_address() ||
+      !resolver_->HasModule(module)) {
+    return false;
+  }
+  key->code_file = module->code_file();
+  key->debug_identifier = module->debug_identifier();
+  key->rva = frame->instruction - module->base_address();
+  return true;
+}
+
+bool StackFrameSymbolizer::FillFromKnownModule(
+    const CodeModule* module,
+    StackFrame* frame,
+    std::deque<std::unique_ptr<StackFrame>>* inlined_frames,
+    bool fill,
+    SymbolizerResult* result) {
+  // If module is known to have missing symbol file, return.
+  if (no_symbol_modules_.find(module->code_file()) !=
+      no_symbol_modules_.end()) {
+    *result = kError;
+    return true;
+  }
+
+  // If module is already loaded, go ahead to fill source line info and return.
+  if (resolver_->HasModule(frame->module)) {
+    *result = fill ? FillFromLoadedModule(frame, inlined_frames) :
+                     LoadedModuleResult(module);
+    return true;
+  }
+
+  // Another processor sharing the cache may have found it has no symbols.
+  if (missing_symbols_cache_ && missing_symbols_cache_->IsMissing(module)) {
+    *result = kError;
+    return true;
+  }
+  return false;
+}
+
+StackFrameSymbolizer::SymbolizerResult
+StackFrameSymbolizer::LoadedModuleResult(const CodeModule* module) {
+  return resolver_->IsModuleCorrupt(module) ? kWarningCorruptSymbols :
+                                              kNoError;
+}
+
+StackFrameSymbolizer::SymbolizerResult
+StackFrameSymbolizer::FillFromLoadedModule(
+    StackFrame* frame,
+    std::deque<std::unique_ptr<StackFrame>>* inlined_frames) {
+  // Inlined frames that are wanted are recorded in the frame instead of
+  // being constructed in lazy mode.
+  bool record_inlines = lazy_inline_frames_ && inlined_frames;
+  FrameInfoKey key;
+  bool cacheable = cache_source_line_info_ && GetFrameInfoKey(frame, &key);
+  if (cacheable) {
+    std::lock_guard<std::mutex> cache_lock(cache_mutex_);
+    SourceLineInfoCache::const_iterator it =
+        source_line_info_cache_.find(key);
+    if (it != source_line_info_cache_.end()) {
+      const CachedSourceLineInfo& cached = it->second;
+      RestoreSourceLineInfo(cached.frame, frame);
+      if (record_inlines) {
+        frame->inline_records = cached.inline_records;
+      } else if (inlined_frames) {
+        for (const SourceLineInfo& inlined : cached.inlined_frames) {
+          std::unique_ptr<StackFrame> inlined_frame(new StackFrame(*frame));
+          RestoreSourceLineInfo(inlined, inlined_frame.get());
+          inlined_frame->trust = StackFrame::FRAME_TRUST_INLINE;
+          inlined_frames->push_back(std::move(inlined_frame));
+        }
+      }
+      return cached.result;
+    }
+  }
+
+  // Without a list of inlined frames to fill, the resolver won't produce
+  // them, so the result can't serve later frames that want them.
+  cacheable = cacheable && inlined_frames;
+  StackFrame unfilled(*frame);
+  size_t inlined_start = inlined_frames ? inlined_frames->size() : 0;
+  if (record_inlines)
+    resolver_->FillSourceLineInfoWithInlineRecords(frame);
+  else
+    resolver_->FillSourceLineInfo(frame, inlined_frames);
+  SymbolizerResult result = resolver_->IsModuleCorrupt(frame->module) ?
+      kWarningCorruptSymbols : kNoError;
+  if (!cacheable)
+    return result;
+
+  CachedSourceLineInfo cached;
+  SaveSourceLineInfo(*frame, unfilled, &cached.frame);
+  cached.inline_records = frame->inline_records;
+  cached.inlined_frames.resize(inlined_frames->size() - inlined_start);
+  for (size_t i = 0; i < cached.inlined_frames.size(); ++i) {
+    SaveSourceLineInfo(*(*inlined_frames)[inlined_start + i], unfilled,
+                       &cached.inlined_frames[i]);
+  }
+  cached.result = result;
+
+  std::lock_guard<std::mutex> cache_lock(cache_mutex_);
+  if (source_line_info_cache_.size() >= kMaxCachedFrameInfo)
+    source_line_info_cache_.clear();
+  source_line_info_cache_[key] = cached;
+  return result;
+}
+
+// static
+void StackFrameSymbolizer::SaveSourceLineInfo(const StackFrame& frame,
+                                              const StackFrame& unfilled,
+                                              SourceLineInfo* info) {
+  uint64_t module_base = frame.module->base_address();
+  info->function_name = frame.function_name;
+  info->has_function_base = frame.function_base != unfilled.function_base;
+  info->function_base = frame.function_base - module_base;
+  info->source_file_name = frame.source_file_name;
+  info->source_line = frame.source_line;
+  info->has_source_line_base =
+      frame.source_line_base != unfilled.source_line_base;
+  info->source_line_base = frame.source_line_base - module_base;
+  info->is_multiple = frame.is_multiple;
+}
+
+// static
+void StackFrameSymbolizer::RestoreSourceLineInfo(const SourceLineInfo& info,
+                                                 StackFrame* frame) {
+  uint64_t module_base = frame->module->base_address();
+  frame->function_name = info.function_name;
+  if (info.has_function_base)
+    frame->function_base = module_base + info.function_base;
+  frame->source_file_name = info.source_file_name;
+  frame->source_line = info.source_line;
+  if (info.has_source_line_base)
+    frame->source_line_base = module_base + info.source_line_base;
+  frame->is_multiple = info.is_multiple;
+}
+
+size_t StackFrameSymbolizer::FrameInfoKeyHash::operator()(
+    const FrameInfoKey& key) const {
+  size_t hash = std::hash<string>()(key.code_file);
+  hash = hash * 31 + std::hash<string>()(key.debug_identifier);
+  return hash * 31 + std::hash<uint64_t>()(key.rva);
+}
+
+void StackFrameSymbolizer::RecordNoSymbols(const CodeModule* module) {
+  no_symbol_modules_.insert(module->code_file());
+  if (missing_symbols_cache_)
+    missing_symbols_cache_->AddMissing(module);
 }
 
 }  // namespace google_breakpad
@@ -0,0 +1,217 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// stack_frame_symbolizer_unittest.cc: Unit tests for StackFrameSymbolizer.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+
+#include <stdlib.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/microdump.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/basic_code_module.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::MicrodumpModules;
+using google_breakpad::StackFrame;
+using google_breakpad::StackFrameSymbolizer;
+using std::deque;
+using std::unique_ptr;
+
+// A BasicSourceLineResolver that counts its source line lookups.
+class CountingResolver : public BasicSourceLineResolver {
+ public:
+  CountingResolver() : lookups(0) { }
+  virtual void FillSourceLineInfo(StackFrame* frame,
+                                  deque<unique_ptr<StackFrame>>* inlined) {
+    ++lookups;
+    BasicSourceLineResolver::FillSourceLineInfo(frame, inlined);
+  }
+  int lookups;
+};
+
+class StackFrameSymbolizerTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    string symbol_file = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+        "/src/processor/testdata/symbols/linux_inline/"
+        "BBA6FA10B8AAB33D00000000000000000/linux_inline.new.sym";
+    BasicCodeModule module(0, 0x20000, "linux_inline", "id", "linux_inline",
+                           "BBA6FA10B8AAB33D00000000000000000", "1");
+    ASSERT_TRUE(resolver_.LoadModule(&module, symbol_file));
+  }
+
+  // Returns modules holding linux_inline, loaded at |base|.
+  static MicrodumpModules* NewModules(uint64_t base) {
+    MicrodumpModules* modules = new MicrodumpModules();
+    modules->Add(new BasicCodeModule(base, 0x20000, "linux_inline", "id",
+                                     "linux_inline",
+                                     "BBA6FA10B8AAB33D00000000000000000",
+                                     "1"));
+    return modules;
+  }
+
+  // Fills a frame at |base| + 0x161b6, in main with three inlined
+  // frames, and checks the result.
+  void CheckFill(StackFrameSymbolizer* symbolizer, uint64_t base) {
+    unique_ptr<MicrodumpModules> modules(NewModules(base));
+    StackFrame frame;
+    frame.instruction = base + 0x161b6;
+    deque<unique_ptr<StackFrame>> inlined_frames;
+    ASSERT_EQ(StackFrameSymbolizer::kNoError,
+              symbolizer->FillSourceLineInfo(modules.get(), NULL, NULL,
+                                             &frame, &inlined_frames));
+    EXPECT_EQ("main", frame.function_name);
+    EXPECT_EQ(base + 0x15b30, frame.function_base);
+    EXPECT_EQ("a.cpp", frame.source_file_name);
+    EXPECT_EQ(42, frame.source_line);
+    EXPECT_EQ(base + 0x161b6, frame.source_line_base);
+
+    ASSERT_EQ(3U, inlined_frames.size());
+    const char* names[] = { "func()", "bar()", "foo()" };
+    const char* files[] = { "linux_inline.cpp", "c.cpp", "b.cpp" };
+    int lines[] = { 27, 32, 39 };
+    uint64_t function_bases[] = { 0x15b83, 0x15b72, 0x15b45 };
+    for (size_t i = 0; i < 3; ++i) {
+      const StackFrame* inlined = inlined_frames[i].get();
+      EXPECT_EQ(names[i], inlined->function_name) << i;
+      EXPECT_EQ(files[i], inlined->source_file_name) << i;
+      EXPECT_EQ(lines[i], inlined->source_line) << i;
+      EXPECT_EQ(base + function_bases[i], inlined->function_base) << i;
+      EXPECT_EQ(base + 0x161b6, inlined->source_line_base) << i;
+      EXPECT_EQ(frame.instruction, inlined->instruction) << i;
+      EXPECT_EQ(frame.module, inlined->module) << i;
+      EXPECT_EQ(StackFrame::FRAME_TRUST_INLINE, inlined->trust) << i;
+    }
+  }
+
+  CountingResolver resolver_;
+};
+
+TEST_F(StackFrameSymbolizerTest, Uncached) {
+  StackFrameSymbolizer symbolizer(NULL, &resolver_);
+  CheckFill(&symbolizer, 0);
+  CheckFill(&symbolizer, 0);
+  EXPECT_EQ(2, resolver_.lookups);
+}
+
+TEST_F(StackFrameSymbolizerTest, CachedSourceLineInfo) {
+  StackFrameSymbolizer symbolizer(NULL, &resolver_);
+  symbolizer.set_cache_source_line_info(true);
+  CheckFill(&symbolizer, 0);
+  EXPECT_EQ(1, resolver_.lookups);
+
+  // The same address, and the same module loaded elsewhere, come from the
+  // cache.
+  CheckFill(&symbolizer, 0);
+  CheckFill(&symbolizer, 0x7f0000000000ULL);
+  EXPECT_EQ(1, resolver_.lookups);
+
+  // Reset evicts the cache unless it is persistent.
+  symbolizer.Reset();
+  CheckFill(&symbolizer, 0);
+  EXPECT_EQ(2, resolver_.lookups);
+  symbolizer.set_persist_frame_info_cache(true);
+  symbolizer.Reset();
+  CheckFill(&symbolizer, 0x1000000);
+  EXPECT_EQ(2, resolver_.lookups);
+}
+
+TEST_F(StackFrameSymbolizerTest, NoInlinedFrames) {
+  // A lookup without inlined frames isn't cached, lest a later lookup
+  // that wants them get none.
+  StackFrameSymbolizer symbolizer(NULL, &resolver_);
+  symbolizer.set_cache_source_line_info(true);
+  unique_ptr<MicrodumpModules> modules(NewModules(0));
+  StackFrame frame;
+  frame.instruction = 0x161b6;
+  ASSERT_EQ(StackFrameSymbolizer::kNoError,
+            symbolizer.FillSourceLineInfo(modules.get(), NULL, NULL, &frame,
+                                          NULL));
+  EXPECT_EQ("main", frame.function_name);
+  CheckFill(&symbolizer, 0);
+  EXPECT_EQ(2, resolver_.lookups);
+}
+
+TEST_F(StackFrameSymbolizerTest, FillSourceLineInfoBatch) {
+  // Loading the symbols for frames looks none of them up; filling them in
+  // a batch then fills them as FillSourceLineInfo would have.
+  StackFrameSymbolizer symbolizer(NULL, &resolver_);
+  unique_ptr<MicrodumpModules> modules(NewModules(0));
+  const uint64_t kAddresses[] = { 0x161b6, 0x15b40, 0x161b6, 0x30000 };
+  std::vector<unique_ptr<StackFrame>> owned_frames;
+  std::vector<StackFrame*> frames;
+  for (uint64_t address : kAddresses) {
+    owned_frames.emplace_back(new StackFrame());
+    owned_frames.back()->instruction = address;
+    frames.push_back(owned_frames.back().get());
+    symbolizer.LoadSymbolsForFrame(modules.get(), NULL, NULL, frames.back());
+  }
+  EXPECT_EQ(0, resolver_.lookups);
+  EXPECT_TRUE(frames[0]->module);
+  EXPECT_FALSE(frames[3]->module);
+
+  std::vector<deque<unique_ptr<StackFrame>>> inlined_frames;
+  symbolizer.FillSourceLineInfoBatch(frames, &inlined_frames);
+  EXPECT_EQ(3, resolver_.lookups);
+  ASSERT_EQ(frames.size(), inlined_frames.size());
+  for (size_t i = 0; i < frames.size(); ++i) {
+    StackFrame expected;
+    expected.instruction = kAddresses[i];
+    deque<unique_ptr<StackFrame>> expected_inlined;
+    symbolizer.FillSourceLineInfo(modules.get(), NULL, NULL, &expected,
+                                  &expected_inlined);
+    EXPECT_EQ(expected.function_name, frames[i]->function_name) << i;
+    EXPECT_EQ(expected.source_line, frames[i]->source_line) << i;
+    ASSERT_EQ(expected_inlined.size(), inlined_frames[i].size()) << i;
+    for (size_t j = 0; j < expected_inlined.size(); ++j) {
+      EXPECT_EQ(expected_inlined[j]->function_name,
+                inlined_frames[i][j]->function_name) << i;
+      EXPECT_EQ(expected_inlined[j]->source_line,
+                inlined_frames[i][j]->source_line) << i;
+    }
+  }
+  EXPECT_EQ(3U, inlined_frames[0].size());
+}
+
+}  // namespace
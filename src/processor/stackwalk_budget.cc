@@ -0,0 +1,110 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// stackwalk_budget.cc: Limits the work done walking a minidump's stacks.
+//
+// See stackwalk_budget.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "google_breakpad/processor/stackwalk_budget.h"
+
+#include <stdint.h>
+
+namespace google_breakpad {
+
+namespace {
+
+// Returns how much of |limit| is left after |used|, where a zero |limit|
+// is unlimited.
+uint64_t Remaining(uint64_t limit, uint64_t used) {
+  if (!limit)
+    return UINT64_MAX;
+  return used < limit ? limit - used : 0;
+}
+
+}  // namespace
+
+StackwalkLimits::StackwalkLimits()
+    : max_scanned_words_per_thread(0),
+      max_symbolizer_calls_per_thread(0),
+      max_milliseconds_per_thread(0),
+      max_frames_per_thread(0),
+      max_unsymbolized_scanned_frames(0),
+      stop_outside_stack(false),
+      max_scanned_words(0),
+      max_symbolizer_calls(0),
+      max_milliseconds(0) {
+}
+
+bool StackwalkLimits::IsLimited() const {
+  return max_scanned_words_per_thread || max_symbolizer_calls_per_thread ||
+         max_milliseconds_per_thread || max_frames_per_thread ||
+         max_unsymbolized_scanned_frames || stop_outside_stack ||
+         max_scanned_words || max_symbolizer_calls || max_milliseconds;
+}
+
+StackwalkBudget::StackwalkBudget(const StackwalkLimits& limits)
+    : limits_(limits),
+      start_(Clock::now()),
+      scanned_words_(0),
+      symbolizer_calls_(0),
+      scanning_stopped_(false) {
+}
+
+uint64_t StackwalkBudget::ScannableWords(uint64_t thread_words) const {
+  if (scanning_stopped_)
+    return 0;
+  uint64_t thread_remaining =
+      Remaining(limits_.max_scanned_words_per_thread, thread_words);
+  uint64_t dump_remaining =
+      Remaining(limits_.max_scanned_words, scanned_words_);
+  return thread_remaining < dump_remaining ? thread_remaining : dump_remaining;
+}
+
+bool StackwalkBudget::AllowsSymbolizerCall(uint64_t thread_calls) const {
+  return Remaining(limits_.max_symbolizer_calls_per_thread, thread_calls) &&
+         Remaining(limits_.max_symbolizer_calls, symbolizer_calls_);
+}
+
+bool StackwalkBudget::OutOfTime(Clock::time_point thread_start) const {
+  if (!limits_.max_milliseconds_per_thread && !limits_.max_milliseconds)
+    return false;
+  Clock::time_point now = Clock::now();
+  if (limits_.max_milliseconds_per_thread &&
+      now - thread_start >= std::chrono::milliseconds(
+                                limits_.max_milliseconds_per_thread)) {
+    return true;
+  }
+  return limits_.max_milliseconds &&
+         now - start_ >= std::chrono::milliseconds(limits_.max_milliseconds);
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,120 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// stackwalk_budget_unittest.cc: Unit tests for StackwalkBudget.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdint.h>
+
+#include <chrono>
+
+#include "breakpad_googletest_includes.h"
+#include "google_breakpad/processor/stackwalk_budget.h"
+
+namespace {
+
+using google_breakpad::StackwalkBudget;
+using google_breakpad::StackwalkLimits;
+
+TEST(StackwalkBudgetTest, Unlimited) {
+  StackwalkLimits limits;
+  EXPECT_FALSE(limits.IsLimited());
+  StackwalkBudget budget(limits);
+  budget.AddScannedWords(1 << 20);
+  budget.AddSymbolizerCall();
+  EXPECT_EQ(UINT64_MAX, budget.ScannableWords(1 << 20));
+  EXPECT_TRUE(budget.AllowsSymbolizerCall(1 << 20));
+  EXPECT_FALSE(budget.OutOfTime(StackwalkBudget::Clock::now() -
+                                std::chrono::hours(1)));
+}
+
+TEST(StackwalkBudgetTest, ScannedWords) {
+  StackwalkLimits limits;
+  limits.max_scanned_words_per_thread = 100;
+  limits.max_scanned_words = 150;
+  EXPECT_TRUE(limits.IsLimited());
+  StackwalkBudget budget(limits);
+  EXPECT_EQ(100U, budget.ScannableWords(0));
+  EXPECT_EQ(40U, budget.ScannableWords(60));
+  EXPECT_EQ(0U, budget.ScannableWords(100));
+  EXPECT_EQ(0U, budget.ScannableWords(200));
+
+  // Another thread's walk uses up most of the minidump's words.
+  budget.AddScannedWords(120);
+  EXPECT_EQ(30U, budget.ScannableWords(0));
+  budget.AddScannedWords(30);
+  EXPECT_EQ(0U, budget.ScannableWords(0));
+}
+
+TEST(StackwalkBudgetTest, StopScanning) {
+  StackwalkLimits limits;
+  StackwalkBudget budget(limits);
+  EXPECT_EQ(UINT64_MAX, budget.ScannableWords(0));
+  budget.StopScanning();
+  EXPECT_EQ(0U, budget.ScannableWords(0));
+  EXPECT_TRUE(budget.AllowsSymbolizerCall(0));
+}
+
+TEST(StackwalkBudgetTest, SymbolizerCalls) {
+  StackwalkLimits limits;
+  limits.max_symbolizer_calls_per_thread = 2;
+  limits.max_symbolizer_calls = 3;
+  StackwalkBudget budget(limits);
+  EXPECT_TRUE(budget.AllowsSymbolizerCall(0));
+  EXPECT_TRUE(budget.AllowsSymbolizerCall(1));
+  EXPECT_FALSE(budget.AllowsSymbolizerCall(2));
+
+  for (int i = 0; i < 3; ++i)
+    budget.AddSymbolizerCall();
+  EXPECT_FALSE(budget.AllowsSymbolizerCall(0));
+}
+
+TEST(StackwalkBudgetTest, Time) {
+  StackwalkLimits limits;
+  limits.max_milliseconds_per_thread = 1000;
+  StackwalkBudget budget(limits);
+  StackwalkBudget::Clock::time_point now = StackwalkBudget::Clock::now();
+  EXPECT_FALSE(budget.OutOfTime(now));
+  EXPECT_TRUE(budget.OutOfTime(now - std::chrono::seconds(2)));
+
+  // The minidump's time counts from the budget's construction.
+  limits.max_milliseconds_per_thread = 0;
+  limits.max_milliseconds = 60 * 1000;
+  StackwalkBudget dump_budget(limits);
+  EXPECT_FALSE(dump_budget.OutOfTime(now - std::chrono::hours(1)));
+  limits.max_milliseconds = 1;
+  StackwalkBudget expired_budget(limits);
+  while (StackwalkBudget::Clock::now() - now < std::chrono::milliseconds(2)) {
+  }
+  EXPECT_TRUE(expired_budget.OutOfTime(StackwalkBudget::Clock::now()));
+}
+
+}  // namespace
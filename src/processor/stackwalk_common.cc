@@ -50,10 +50,12 @@
 #include "google_breakpad/processor/code_module.h"
 #include "google_breakpad/processor/code_modules.h"
 #include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/process_stats.h"
 #include "google_breakpad/processor/source_line_resolver_interface.h"
 #include "google_breakpad/processor/stack_frame_cpu.h"
 #include "processor/logging.h"
 #include "processor/pathname_stripper.h"
+#include "processor/trace_probes.h"
 
 namespace google_breakpad {
 
@@ -946,6 +948,8 @@ static void PrintStack(const CallStack* stack,
                          cpu, memory, modules, resolver);
     }
   }
+  if (stack->budget_exhausted())
+    printf(" <stack walk stopped: work budget exhausted>\n");
 }
 
 // PrintStackMachineReadable prints the call stack in |stack| to stdout,
@@ -957,6 +961,7 @@ static void PrintStack(const CallStack* stack,
 // PrintStack above.
 static void PrintStackMachineReadable(int thread_num, const CallStack* stack) {
   int frame_count = stack->frames()->size();
+  BPTRACE2(print_thread_begin, thread_num, frame_count);
   for (int frame_index = 0; frame_index < frame_count; ++frame_index) {
     const StackFrame* frame = stack->frames()->at(frame_index);
     printf("%d%c%d%c", thread_num, kOutputSeparator, frame_index,
@@ -1005,6 +1010,7 @@ static void PrintStackMachineReadable(int thread_num, const CallStack* stack) {
     }
     printf("\n");
   }
+  BPTRACE1(print_thread_end, thread_num);
 }
 
 // ContainsModule checks whether a given |module| is in the vector
@@ -1116,12 +1122,73 @@ static void PrintModulesMachineReadable(const CodeModules* modules) {
   }
 }
 
-}  // namespace
+// PrintBreadcrumbs prints the breadcrumbs of each thread that recorded
+// any, oldest first.  Each is timed relative to the most recent breadcrumb
+// in the dump, so that those of different threads can be lined up.
+static void PrintBreadcrumbs(const ProcessState& process_state) {
+  const vector<MinidumpBreadcrumbs::Thread>* breadcrumbs =
+      process_state.breadcrumbs();
+  if (breadcrumbs->empty())
+    return;
 
-void PrintProcessState(const ProcessState& process_state,
-                       bool output_stack_contents,
-                       bool output_requesting_thread_only,
-                       SourceLineResolverInterface* resolver) {
+  uint64_t latest_ns = 0;
+  for (const MinidumpBreadcrumbs::Thread& thread : *breadcrumbs) {
+    for (const MDRawBreadcrumb& breadcrumb : thread.breadcrumbs) {
+      if (breadcrumb.timestamp_ns > latest_ns)
+        latest_ns = breadcrumb.timestamp_ns;
+    }
+  }
+
+  const vector<CallStack*>* threads = process_state.threads();
+  for (const MinidumpBreadcrumbs::Thread& thread : *breadcrumbs) {
+    printf("\n");
+    printf("Breadcrumbs of thread id 0x%x", thread.thread_id);
+    for (size_t thread_index = 0; thread_index < threads->size();
+         ++thread_index) {
+      if (threads->at(thread_index)->tid() == thread.thread_id) {
+        printf(" (Thread %zu)", thread_index);
+        break;
+      }
+    }
+    printf(", %zu of %" PRIu64 " recorded\n", thread.breadcrumbs.size(),
+           thread.recorded_count);
+    for (const MDRawBreadcrumb& breadcrumb : thread.breadcrumbs) {
+      uint64_t age_ns = latest_ns - breadcrumb.timestamp_ns;
+      printf("  -%" PRIu64 ".%06" PRIu64 "s  %u  %s\n",
+             age_ns / 1000000000, age_ns % 1000000000 / 1000,
+             breadcrumb.category,
+             MinidumpBreadcrumbs::DataToString(breadcrumb).c_str());
+    }
+  }
+}
+
+// PrintBreadcrumbsMachineReadable prints the breadcrumbs of each thread,
+// oldest first, one per line, in the following machine-readable
+// pipe-delimited text format:
+// Breadcrumb|{Thread ID}|{Timestamp in ns}|{Category}|{Data}
+// Returns |nanoseconds| in milliseconds.
+static double Milliseconds(uint64_t nanoseconds) {
+  return nanoseconds / 1e6;
+}
+
+static void PrintBreadcrumbsMachineReadable(
+    const ProcessState& process_state) {
+  for (const MinidumpBreadcrumbs::Thread& thread :
+       *process_state.breadcrumbs()) {
+    for (const MDRawBreadcrumb& breadcrumb : thread.breadcrumbs) {
+      printf("Breadcrumb%c0x%x%c%" PRIu64 "%c%u%c%s\n",
+             kOutputSeparator, thread.thread_id,
+             kOutputSeparator, breadcrumb.timestamp_ns,
+             kOutputSeparator, breadcrumb.category,
+             kOutputSeparator,
+             StripSeparator(
+                 MinidumpBreadcrumbs::DataToString(breadcrumb)).c_str());
+    }
+  }
+}
+
+// Prints what PrintProcessState prints before the threads.
+static void PrintProcessInfo(const ProcessState& process_state) {
   // Print OS and CPU information.
   string cpu = process_state.system_info()->cpu;
   string cpu_info = process_state.system_info()->cpu_info;
@@ -1176,43 +1243,42 @@ void PrintProcessState(const ProcessState& process_state,
   } else {
     printf("Process uptime: not available\n");
   }
+}
 
-  // If the thread that requested the dump is known, print it first.
-  int requesting_thread = process_state.requesting_thread();
-  if (requesting_thread != -1) {
-    printf("\n");
+// Prints the thread at |thread_index| as PrintProcessState does.
+static void PrintThread(const ProcessState& process_state, int thread_index,
+                        bool output_stack_contents,
+                        SourceLineResolverInterface* resolver) {
+  BPTRACE2(print_thread_begin, thread_index,
+           process_state.threads()->at(thread_index)->frames()->size());
+  printf("\n");
+  if (thread_index == process_state.requesting_thread()) {
     printf("Thread %d (%s)\n",
-          requesting_thread,
+          thread_index,
           process_state.crashed() ? "crashed" :
                                     "requested dump, did not crash");
-    PrintStack(process_state.threads()->at(requesting_thread), cpu,
-               output_stack_contents,
-               process_state.thread_memory_regions()->at(requesting_thread),
-               process_state.modules(), resolver);
+  } else {
+    printf("Thread %d\n", thread_index);
   }
+  PrintStack(process_state.threads()->at(thread_index),
+             process_state.system_info()->cpu, output_stack_contents,
+             process_state.thread_memory_regions()->at(thread_index),
+             process_state.modules(), resolver);
+  BPTRACE1(print_thread_end, thread_index);
+}
 
-  if (!output_requesting_thread_only) {
-    // Print all of the threads in the dump.
-    int thread_count = process_state.threads()->size();
-    for (int thread_index = 0; thread_index < thread_count; ++thread_index) {
-      if (thread_index != requesting_thread) {
-        // Don't print the crash thread again, it was already printed.
-        printf("\n");
-        printf("Thread %d\n", thread_index);
-        PrintStack(process_state.threads()->at(thread_index), cpu,
-                  output_stack_contents,
-                  process_state.thread_memory_regions()->at(thread_index),
-                  process_state.modules(), resolver);
-      }
-    }
-  }
+// Prints what PrintProcessState prints after the threads.
+static void PrintProcessTail(const ProcessState& process_state) {
+  PrintBreadcrumbs(process_state);
 
   PrintModules(process_state.modules(),
                process_state.modules_without_symbols(),
                process_state.modules_with_corrupt_symbols());
 }
 
-void PrintProcessStateMachineReadable(const ProcessState& process_state) {
+// Prints what PrintProcessStateMachineReadable prints before the threads.
+static void PrintProcessInfoMachineReadable(
+    const ProcessState& process_state) {
   // Print OS and CPU information.
   // OS|{OS Name}|{OS Version}
   // CPU|{CPU Name}|{CPU Info}|{Number of CPUs}
@@ -1263,11 +1329,58 @@ void PrintProcessStateMachineReadable(const ProcessState& process_state) {
   }
 
   PrintModulesMachineReadable(process_state.modules());
+  PrintBreadcrumbsMachineReadable(process_state);
 
   // blank line to indicate start of threads
   printf("\n");
+}
+
+}  // namespace
+
+void PrintProcessState(const ProcessState& process_state,
+                       bool output_stack_contents,
+                       bool output_requesting_thread_only,
+                       SourceLineResolverInterface* resolver) {
+  BPTRACE2(print_begin, process_state.threads()->size(), 0);
+  PrintProcessInfo(process_state);
+
+  // If the thread that requested the dump is known, print it first.
+  int requesting_thread = process_state.requesting_thread();
+  if (requesting_thread != -1) {
+    if (resolver) {
+      process_state.threads()->at(requesting_thread)->
+          ExpandInlineFrames(resolver);
+    }
+    PrintThread(process_state, requesting_thread, output_stack_contents,
+                resolver);
+  }
+
+  if (!output_requesting_thread_only) {
+    // Print all of the threads in the dump.
+    int thread_count = process_state.threads()->size();
+    for (int thread_index = 0; thread_index < thread_count; ++thread_index) {
+      if (thread_index != requesting_thread) {
+        if (resolver) {
+          process_state.threads()->at(thread_index)->
+              ExpandInlineFrames(resolver);
+        }
+        // Don't print the crash thread again, it was already printed.
+        PrintThread(process_state, thread_index, output_stack_contents,
+                    resolver);
+      }
+    }
+  }
+
+  PrintProcessTail(process_state);
+  BPTRACE1(print_end, process_state.threads()->size());
+}
+
+void PrintProcessStateMachineReadable(const ProcessState& process_state) {
+  BPTRACE2(print_begin, process_state.threads()->size(), 1);
+  PrintProcessInfoMachineReadable(process_state);
 
   // If the thread that requested the dump is known, print it first.
+  int requesting_thread = process_state.requesting_thread();
   if (requesting_thread != -1) {
     PrintStackMachineReadable(requesting_thread,
                               process_state.threads()->at(requesting_thread));
@@ -1282,6 +1395,46 @@ void PrintProcessStateMachineReadable(const ProcessState& process_state) {
                                 process_state.threads()->at(thread_index));
     }
   }
+  BPTRACE1(print_end, process_state.threads()->size());
+}
+
+ProcessStatePrinter::ProcessStatePrinter(
+    bool machine_readable,
+    bool output_stack_contents,
+    bool output_requesting_thread_only,
+    SourceLineResolverInterface* resolver)
+    : machine_readable_(machine_readable),
+      output_stack_contents_(output_stack_contents),
+      output_requesting_thread_only_(output_requesting_thread_only),
+      resolver_(resolver) {
+}
+
+void ProcessStatePrinter::OnProcessInfo(const ProcessState& process_state) {
+  if (machine_readable_)
+    PrintProcessInfoMachineReadable(process_state);
+  else
+    PrintProcessInfo(process_state);
+  fflush(stdout);
+}
+
+void ProcessStatePrinter::OnThread(const ProcessState& process_state,
+                                   int thread_index) {
+  if (machine_readable_) {
+    PrintStackMachineReadable(thread_index,
+                              process_state.threads()->at(thread_index));
+  } else if (!output_requesting_thread_only_ ||
+             thread_index == process_state.requesting_thread()) {
+    if (resolver_)
+      process_state.threads()->at(thread_index)->ExpandInlineFrames(resolver_);
+    PrintThread(process_state, thread_index, output_stack_contents_,
+                resolver_);
+  }
+  fflush(stdout);
+}
+
+void ProcessStatePrinter::Finish(const ProcessState& process_state) {
+  if (!machine_readable_)
+    PrintProcessTail(process_state);
 }
 
 void PrintRequestingThreadBrief(const ProcessState& process_state) {
@@ -1301,4 +1454,52 @@ void PrintRequestingThreadBrief(const ProcessState& process_state) {
   }
 }
 
+void PrintProcessStats(const ProcessStats& stats, FILE* file) {
+  fprintf(file, "Processing statistics:\n");
+  fprintf(file, "  total                  %10.3f ms\n",
+          Milliseconds(stats.total_nanoseconds()));
+  fprintf(file, "  stackwalk              %10.3f ms\n",
+          Milliseconds(stats.stackwalk_nanoseconds()));
+  fprintf(file, "  exploitability         %10.3f ms\n",
+          Milliseconds(stats.exploitability_nanoseconds()));
+  fprintf(file, "  symbol supplier        %10.3f ms in %" PRIu64 " calls\n",
+          Milliseconds(stats.symbol_supplier_nanoseconds()),
+          stats.symbol_supplier_calls());
+
+  const vector<ProcessStats::ModuleLoad>& loads = stats.module_loads();
+  fprintf(file, "  modules loaded         %10zu\n", loads.size());
+  for (size_t i = 0; i < loads.size(); ++i) {
+    const ProcessStats::ModuleLoad& load = loads[i];
+    fprintf(file, "    %s: supplier %.3f ms, load %.3f ms, %zu bytes%s\n",
+            PathnameStripper::File(load.code_file).c_str(),
+            Milliseconds(load.supplier_nanoseconds),
+            Milliseconds(load.load_nanoseconds), load.symbol_data_size,
+            load.loaded ? "" : " (failed)");
+  }
+
+  static const struct {
+    StackFrame::FrameTrust trust;
+    const char* name;
+  } kTrusts[] = {
+    { StackFrame::FRAME_TRUST_CONTEXT, "context" },
+    { StackFrame::FRAME_TRUST_PREWALKED, "prewalked" },
+    { StackFrame::FRAME_TRUST_CFI, "cfi" },
+    { StackFrame::FRAME_TRUST_CFI_SCAN, "cfi_scan" },
+    { StackFrame::FRAME_TRUST_FP, "frame_pointer" },
+    { StackFrame::FRAME_TRUST_SCAN, "scan" },
+    { StackFrame::FRAME_TRUST_INLINE, "inline" },
+    { StackFrame::FRAME_TRUST_LEAF, "leaf" },
+    { StackFrame::FRAME_TRUST_NONE, "none" },
+  };
+  fprintf(file, "  frames by trust:\n");
+  for (size_t i = 0; i < sizeof(kTrusts) / sizeof(kTrusts[0]); ++i) {
+    fprintf(file, "    %-20s %10" PRIu64 "\n", kTrusts[i].name,
+            stats.frames_by_trust(kTrusts[i].trust));
+  }
+  fprintf(file, "  scanned stack words    %10" PRIu64 "\n",
+          stats.scanned_words());
+  fprintf(file, "  memory read failures   %10" PRIu64 "\n",
+          stats.memory_read_failures());
+}
+
 }  // namespace google_breakpad
@@ -33,9 +33,14 @@
 #ifndef PROCESSOR_STACKWALK_COMMON_H__
 #define PROCESSOR_STACKWALK_COMMON_H__
 
+#include <stdio.h>
+
+#include "google_breakpad/processor/process_observer.h"
+
 namespace google_breakpad {
 
 class ProcessState;
+class ProcessStats;
 class SourceLineResolverInterface;
 
 void PrintProcessStateMachineReadable(const ProcessState& process_state);
@@ -44,6 +49,34 @@ void PrintProcessState(const ProcessState& process_state,
                        bool output_requesting_thread_only,
                        SourceLineResolverInterface* resolver);
 void PrintRequestingThreadBrief(const ProcessState& process_state);
+// Prints where the time and work of processing a dump went to |file|.
+void PrintProcessStats(const ProcessStats& stats, FILE* file);
+
+// Prints a ProcessState to stdout as MinidumpProcessor::Process delivers
+// it, in the format of PrintProcessState, or of
+// PrintProcessStateMachineReadable if |machine_readable| is true, so that
+// each thread is shown as soon as it is walked.  The inlined frames of the
+// threads shown are constructed with the resolver, if any, first.  See
+// MinidumpProcessor::set_lazy_inline_frames.
+class ProcessStatePrinter : public ProcessObserver {
+ public:
+  ProcessStatePrinter(bool machine_readable,
+                      bool output_stack_contents,
+                      bool output_requesting_thread_only,
+                      SourceLineResolverInterface* resolver);
+
+  void OnProcessInfo(const ProcessState& process_state) override;
+  void OnThread(const ProcessState& process_state, int thread_index) override;
+
+  // Prints what follows the threads, once Process has returned PROCESS_OK.
+  void Finish(const ProcessState& process_state);
+
+ private:
+  bool machine_readable_;
+  bool output_stack_contents_;
+  bool output_requesting_thread_only_;
+  SourceLineResolverInterface* resolver_;
+};
 
 }  // namespace google_breakpad
 
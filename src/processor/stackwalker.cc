@@ -48,6 +48,7 @@
 #include "google_breakpad/processor/stack_frame.h"
 #include "google_breakpad/processor/stack_frame_symbolizer.h"
 #include "google_breakpad/processor/system_info.h"
+#include "processor/address_validity_cache.h"
 #include "processor/linked_ptr.h"
 #include "processor/logging.h"
 #include "processor/stackwalker_ppc.h"
@@ -60,6 +61,7 @@
 #include "processor/stackwalker_mips.h"
 #include "processor/stackwalker_riscv.h"
 #include "processor/stackwalker_riscv64.h"
+#include "processor/trace_probes.h"
 
 namespace google_breakpad {
 
@@ -83,10 +85,35 @@ Stackwalker::Stackwalker(const SystemInfo* system_info,
       memory_(memory),
       modules_(modules),
       unloaded_modules_(NULL),
-      frame_symbolizer_(frame_symbolizer) {
+      frame_pool_(NULL),
+      frame_symbolizer_(frame_symbolizer),
+      module_filter_(),
+      module_filter_initialized_(false),
+      basic_modules_(NULL),
+      budget_(NULL),
+      words_scanned_(0),
+      symbolizer_calls_(0),
+      budget_exhausted_(false),
+      stats_(NULL),
+      validity_cache_(NULL),
+      defer_source_line_info_(false) {
   assert(frame_symbolizer_);
 }
 
+bool Stackwalker::ChargeNextFrame() {
+  if (!budget_)
+    return true;
+  if (budget_exhausted_ ||
+      !budget_->AllowsSymbolizerCall(symbolizer_calls_) ||
+      budget_->OutOfTime(walk_start_)) {
+    budget_exhausted_ = true;
+    return false;
+  }
+  ++symbolizer_calls_;
+  budget_->AddSymbolizerCall();
+  return true;
+}
+
 void InsertSpecialAttentionModule(
     StackFrameSymbolizer::SymbolizerResult symbolizer_result,
     const CodeModule* module,
@@ -128,15 +155,78 @@ bool Stackwalker::Walk(
   assert(modules_without_symbols);
   assert(modules_with_corrupt_symbols);
 
+  StartWalk(stack);
+  BPTRACE1(stackwalk_begin, memory_ ? memory_->GetBase() : 0);
+
   // Begin with the context frame, and keep getting callers until there are
   // no more.
+  StackFrame* frame = GetContextFrame();
+  if (frame && !ChargeNextFrame()) {
+    delete frame;
+    frame = NULL;
+  }
+  return WalkFrom(frame, 0, stack, modules_without_symbols,
+                  modules_with_corrupt_symbols);
+}
+
+bool Stackwalker::ResumeWalk(
+    CallStack* stack,
+    vector<const CodeModule*>* modules_without_symbols,
+    vector<const CodeModule*>* modules_with_corrupt_symbols) {
+  assert(stack);
+  if (stack->frames_.empty()) {
+    return Walk(stack, modules_without_symbols,
+                modules_with_corrupt_symbols);
+  }
+  assert(modules_without_symbols);
+  assert(modules_with_corrupt_symbols);
+
+  StartWalk(stack);
+  stack->budget_exhausted_ = false;
+  BPTRACE1(stackwalk_begin, memory_ ? memory_->GetBase() : 0);
 
-  // Keep track of the number of scanned or otherwise dubious frames seen
-  // so far, as the caller may have set a limit.
   uint32_t scanned_frames = 0;
+  for (const StackFrame* frame : stack->frames_) {
+    if (frame->trust == StackFrame::FRAME_TRUST_NONE ||
+        frame->trust == StackFrame::FRAME_TRUST_SCAN ||
+        frame->trust == StackFrame::FRAME_TRUST_CFI_SCAN) {
+      scanned_frames++;
+    }
+  }
 
-  // Take ownership of the pointer returned by GetContextFrame.
-  scoped_ptr<StackFrame> frame(GetContextFrame());
+  // The outermost frame is the last one unwound to; any inlined frames
+  // were added before it.
+  StackFrame* frame =
+      GetCallerFrame(stack, scanned_frames < max_frames_scanned_);
+  if (frame && !ChargeNextFrame()) {
+    delete frame;
+    frame = NULL;
+  }
+  return WalkFrom(frame, scanned_frames, stack, modules_without_symbols,
+                  modules_with_corrupt_symbols);
+}
+
+void Stackwalker::StartWalk(CallStack* stack) {
+  frame_pool_ = stack;
+  words_scanned_ = 0;
+  symbolizer_calls_ = 0;
+  budget_exhausted_ = false;
+  if (budget_)
+    walk_start_ = StackwalkBudget::Clock::now();
+}
+
+bool Stackwalker::WalkFrom(
+    StackFrame* first_frame,
+    uint32_t scanned_frames,
+    CallStack* stack,
+    vector<const CodeModule*>* modules_without_symbols,
+    vector<const CodeModule*>* modules_with_corrupt_symbols) {
+  // Take ownership of the first frame.  |scanned_frames| keeps track of
+  // the number of scanned or otherwise dubious frames seen so far, as the
+  // caller may have set a limit, and the budget may limit the scanned
+  // frames without symbols in a row.
+  scoped_ptr<StackFrame> frame(first_frame);
+  uint64_t unsymbolized_scanned_frames = 0;
 
   while (frame.get()) {
     // frame already contains a good frame with properly set instruction and
@@ -146,12 +236,16 @@ bool Stackwalker::Walk(
     std::deque<std::unique_ptr<StackFrame>> inlined_frames;
     // Resolve the module information, if a module map was provided.
     StackFrameSymbolizer::SymbolizerResult symbolizer_result =
+        defer_source_line_info_ ?
+        frame_symbolizer_->LoadSymbolsForFrame(modules_, unloaded_modules_,
+                                               system_info_, frame.get()) :
         frame_symbolizer_->FillSourceLineInfo(modules_, unloaded_modules_,
                                               system_info_,
                                               frame.get(), &inlined_frames);
     switch (symbolizer_result) {
       case StackFrameSymbolizer::kInterrupt:
         BPLOG(INFO) << "Stack walk is interrupted.";
+        BPTRACE2(stackwalk_end, stack->frames_.size(), 0);
         return false;
         break;
       case StackFrameSymbolizer::kError:
@@ -179,6 +273,17 @@ bool Stackwalker::Walk(
       default:
         break;
     }
+    // A deferred frame has no function name yet, so only its module's
+    // symbols are considered.
+    bool scanned = frame->trust == StackFrame::FRAME_TRUST_SCAN ||
+                   frame->trust == StackFrame::FRAME_TRUST_CFI_SCAN;
+    bool unsymbolized =
+        symbolizer_result != StackFrameSymbolizer::kNoError ||
+        (!defer_source_line_info_ && frame->function_name.empty());
+    if (scanned && unsymbolized)
+      unsymbolized_scanned_frames++;
+    else
+      unsymbolized_scanned_frames = 0;
     // Add all nested inlined frames belonging to this frame from the innermost
     // frame to the outermost frame.
     while (!inlined_frames.empty()) {
@@ -195,12 +300,34 @@ bool Stackwalker::Walk(
         BPLOG(ERROR) << "The stack is over " << max_frames_ << " frames.";
       break;
     }
+    if (budget_ && budget_->limits().max_frames_per_thread &&
+        stack->frames_.size() >= budget_->limits().max_frames_per_thread) {
+      budget_exhausted_ = true;
+      break;
+    }
+    if (budget_ && budget_->limits().max_unsymbolized_scanned_frames &&
+        unsymbolized_scanned_frames >=
+            budget_->limits().max_unsymbolized_scanned_frames) {
+      budget_exhausted_ = true;
+      break;
+    }
 
     // Get the next frame and take ownership.
     bool stack_scan_allowed = scanned_frames < max_frames_scanned_;
     frame.reset(GetCallerFrame(stack, stack_scan_allowed));
+    if (frame.get()) {
+      BPTRACE3(stackwalk_frame, stack->frames_.size(), frame->trust,
+               frame->instruction);
+    }
+    if (frame.get() && !ChargeNextFrame())
+      frame.reset();
   }
+  BPTRACE2(stackwalk_end, stack->frames_.size(), 1);
 
+  stack->budget_exhausted_ = budget_exhausted_;
+  if (budget_exhausted_)
+    BPLOG(INFO) << "Stack walk ran out of budget after "
+                << stack->frames_.size() << " frames.";
   return true;
 }
 
@@ -307,7 +434,7 @@ Stackwalker* Stackwalker::StackwalkerForCPU(
 bool Stackwalker::TerminateWalk(uint64_t caller_ip,
                                 uint64_t caller_sp,
                                 uint64_t callee_sp,
-                                bool first_unwind) const {
+                                bool first_unwind) {
   // Treat an instruction address less than 4k as end-of-stack.
   // (using InstructionAddressSeemsValid() here is very tempting,
   // but we need to handle JITted code)
@@ -326,10 +453,24 @@ bool Stackwalker::TerminateWalk(uint64_t caller_ip,
     return true;
   }
 
+  // Unwinding by CFI or frame pointer can compute a stack pointer outside
+  // the stack without reading there.  The outermost frame's may be just
+  // past its end.
+  if (budget_ && budget_->limits().stop_outside_stack && memory_ &&
+      (caller_sp < memory_->GetBase() ||
+       caller_sp - memory_->GetBase() > memory_->GetSize())) {
+    budget_exhausted_ = true;
+    return true;
+  }
+
   return false;
 }
 
 bool Stackwalker::InstructionAddressSeemsValid(uint64_t address) const {
+  bool valid;
+  if (validity_cache_ && validity_cache_->Lookup(address, &valid))
+    return valid;
+
   StackFrame frame;
   frame.instruction = address;
   StackFrameSymbolizer::SymbolizerResult symbolizer_result =
@@ -338,23 +479,28 @@ bool Stackwalker::InstructionAddressSeemsValid(uint64_t address) const {
 
   if (!frame.module) {
     // not inside any loaded module
-    return false;
-  }
-
-  if (!frame_symbolizer_->HasImplementation()) {
+    valid = false;
+  } else if (!frame_symbolizer_->HasImplementation()) {
     // No valid implementation to symbolize stack frame, but the address is
     // within a known module.
-    return true;
-  }
-
-  if (symbolizer_result != StackFrameSymbolizer::kNoError &&
-      symbolizer_result != StackFrameSymbolizer::kWarningCorruptSymbols) {
+    valid = true;
+  } else if (symbolizer_result != StackFrameSymbolizer::kNoError &&
+             symbolizer_result !=
+                 StackFrameSymbolizer::kWarningCorruptSymbols) {
     // Some error occurred during symbolization, but the address is within a
     // known module
-    return true;
+    valid = true;
+  } else {
+    valid = !frame.function_name.empty();
   }
 
-  return !frame.function_name.empty();
+  // An interrupted lookup may find the module's symbols when it is retried,
+  // and then give a different answer, so only the others are remembered.
+  if (validity_cache_ &&
+      symbolizer_result != StackFrameSymbolizer::kInterrupt) {
+    validity_cache_->Insert(address, valid);
+  }
+  return valid;
 }
 
 }  // namespace google_breakpad
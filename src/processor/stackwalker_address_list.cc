@@ -66,7 +66,7 @@ StackFrame* StackwalkerAddressList::GetContextFrame() {
   if (frame_count_ == 0)
     return NULL;
 
-  StackFrame* frame = new StackFrame();
+  StackFrame* frame = new (frame_pool_) StackFrame();
   frame->instruction = frames_[0];
   frame->trust = StackFrame::FRAME_TRUST_PREWALKED;
 
@@ -83,7 +83,7 @@ StackFrame* StackwalkerAddressList::GetCallerFrame(const CallStack*,
 
   // All frames have the highest level of trust because they were
   // explicitly provided.
-  StackFrame* frame = new StackFrame();
+  StackFrame* frame = new (frame_pool_) StackFrame();
   frame->instruction = frames_[next_frame_index_++];
   frame->trust = StackFrame::FRAME_TRUST_PREWALKED;
   return frame;
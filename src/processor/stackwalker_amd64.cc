@@ -116,7 +116,7 @@ StackFrame* StackwalkerAMD64::GetContextFrame() {
     return NULL;
   }
 
-  StackFrameAMD64* frame = new StackFrameAMD64();
+  StackFrameAMD64* frame = new (frame_pool_) StackFrameAMD64();
 
   // The instruction pointer is stored directly in a register, so pull it
   // straight out of the CPU context structure.
@@ -133,7 +133,7 @@ StackFrameAMD64* StackwalkerAMD64::GetCallerByCFIFrameInfo(
     CFIFrameInfo* cfi_frame_info) {
   StackFrameAMD64* last_frame = static_cast<StackFrameAMD64*>(frames.back());
 
-  scoped_ptr<StackFrameAMD64> frame(new StackFrameAMD64());
+  scoped_ptr<StackFrameAMD64> frame(new (frame_pool_) StackFrameAMD64());
   if (!cfi_walker_
       .FindCallerRegisters(*memory_, *cfi_frame_info,
                            last_frame->context, last_frame->context_validity,
@@ -208,9 +208,9 @@ StackFrameAMD64* StackwalkerAMD64::GetCallerByFramePointerRecovery(
       return NULL;
     }
 
-    StackFrameAMD64* frame = new StackFrameAMD64();
+    StackFrameAMD64* frame = new (frame_pool_) StackFrameAMD64();
     frame->trust = StackFrame::FRAME_TRUST_FP;
-    frame->context = last_frame->context;
+    frame->CopyIntegerRegisters(*last_frame);
     frame->context.rip = caller_rip;
     frame->context.rsp = caller_rsp;
     frame->context.rbp = caller_rbp;
@@ -239,10 +239,10 @@ StackFrameAMD64* StackwalkerAMD64::GetCallerBySimulatingReturn(
 
   // Create a new stack frame (ownership will be transferred to the caller)
   // and fill it in.
-  StackFrameAMD64* frame = new StackFrameAMD64();
+  StackFrameAMD64* frame = new (frame_pool_) StackFrameAMD64();
 
   frame->trust = StackFrame::FRAME_TRUST_LEAF;
-  frame->context = last_frame->context;
+  frame->CopyIntegerRegisters(*last_frame);
   frame->context.rip = caller_rip;
   // The caller's %rsp is directly underneath the return address pushed by
   // the call.
@@ -267,10 +267,10 @@ StackFrameAMD64* StackwalkerAMD64::GetCallerByStackScan(
 
   // Create a new stack frame (ownership will be transferred to the caller)
   // and fill it in.
-  StackFrameAMD64* frame = new StackFrameAMD64();
+  StackFrameAMD64* frame = new (frame_pool_) StackFrameAMD64();
 
   frame->trust = StackFrame::FRAME_TRUST_SCAN;
-  frame->context = last_frame->context;
+  frame->CopyIntegerRegisters(*last_frame);
   frame->context.rip = caller_rip;
   // The caller's %rsp is directly underneath the return address pushed by
   // the call.
@@ -314,11 +314,23 @@ StackFrame* StackwalkerAMD64::GetCallerFrame(const CallStack* stack,
   StackFrameAMD64* last_frame = static_cast<StackFrameAMD64*>(frames.back());
   scoped_ptr<StackFrameAMD64> new_frame;
 
+  // Frames in modules known to keep a frame pointer are unwound with it
+  // before looking for CFI.  The context frame is left to CFI, since it may
+  // have stopped before its prologue set up the frame pointer.
+  bool frame_pointer_first =
+      last_frame->trust != StackFrame::FRAME_TRUST_CONTEXT &&
+      system_info_->os_short != "windows" &&
+      frame_symbolizer_->PrefersFramePointer(last_frame);
+  if (frame_pointer_first)
+    new_frame.reset(GetCallerByFramePointerRecovery(frames));
+
   // If we have CFI information, use it.
-  scoped_ptr<CFIFrameInfo> cfi_frame_info(
-      frame_symbolizer_->FindCFIFrameInfo(last_frame));
-  if (cfi_frame_info.get())
-    new_frame.reset(GetCallerByCFIFrameInfo(frames, cfi_frame_info.get()));
+  if (!new_frame.get()) {
+    scoped_ptr<CFIFrameInfo> cfi_frame_info(
+        frame_symbolizer_->FindCFIFrameInfo(last_frame));
+    if (cfi_frame_info.get())
+      new_frame.reset(GetCallerByCFIFrameInfo(frames, cfi_frame_info.get()));
+  }
 
   // If CFI was not available and this is a Windows x64 stack, check whether
   // this is a leaf function which doesn't touch any callee-saved registers.
@@ -335,7 +347,8 @@ StackFrame* StackwalkerAMD64::GetCallerFrame(const CallStack* stack,
   // Never try to use frame pointer unwinding on Windows x64 stack. MSVC never
   // generates code that works with frame pointer chasing, and LLVM does the
   // same. Stack scanning would be better.
-  if (!new_frame.get() && system_info_->os_short != "windows") {
+  if (!new_frame.get() && !frame_pointer_first &&
+      system_info_->os_short != "windows") {
     new_frame.reset(GetCallerByFramePointerRecovery(frames));
   }
 
@@ -56,6 +56,8 @@ using google_breakpad::CodeModule;
 using google_breakpad::StackFrameSymbolizer;
 using google_breakpad::StackFrame;
 using google_breakpad::StackFrameAMD64;
+using google_breakpad::StackwalkBudget;
+using google_breakpad::StackwalkLimits;
 using google_breakpad::Stackwalker;
 using google_breakpad::StackwalkerAMD64;
 using google_breakpad::SystemInfo;
@@ -267,6 +269,8 @@ TEST_F(GetCallerFrame, ScanWithoutSymbols) {
   raw_context.rip = 0x00007400c0000200ULL;
   raw_context.rbp = frame1_rbp.Value();
   raw_context.rsp = stack_section.start().Value();
+  raw_context.rbx = 0x3c9a2a6a4d04d1f5ULL;
+  raw_context.sse_registers.xmm0.low = 0x5b2f7e3e1f0b2c4dULL;
 
   StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
   StackwalkerAMD64 walker(&system_info, &raw_context, &stack_region, &modules,
@@ -296,6 +300,11 @@ TEST_F(GetCallerFrame, ScanWithoutSymbols) {
   EXPECT_EQ(return_address1, frame1->context.rip);
   EXPECT_EQ(frame1_sp.Value(), frame1->context.rsp);
   EXPECT_EQ(frame1_rbp.Value(), frame1->context.rbp);
+  // The integer registers are carried over from the callee, but not the
+  // vector registers, which caller frames never recover.
+  EXPECT_EQ(raw_context.context_flags, frame1->context.context_flags);
+  EXPECT_EQ(0x3c9a2a6a4d04d1f5ULL, frame1->context.rbx);
+  EXPECT_EQ(0U, frame1->context.sse_registers.xmm0.low);
 
   StackFrameAMD64 *frame2 = static_cast<StackFrameAMD64*>(frames->at(2));
   EXPECT_EQ(StackFrame::FRAME_TRUST_SCAN, frame2->trust);
@@ -306,6 +315,168 @@ TEST_F(GetCallerFrame, ScanWithoutSymbols) {
   EXPECT_EQ(frame2_sp.Value(), frame2->context.rsp);
 }
 
+TEST_F(GetCallerFrame, ScanBudget) {
+  // The same stack as ScanWithoutSymbols: frame 1's return address is the
+  // fifth word scanned from frame 0, and frame 2's the sixth from frame 1.
+  stack_section.start() = 0x8000000080000000ULL;
+  Label frame1_rbp;
+  stack_section
+    .Append(16, 0)
+    .D64(0x00007400b0000000ULL)
+    .D64(0x00007500d0000000ULL)
+    .D64(0x00007500b0000100ULL)
+    .Append(16, 0)
+    .D64(0x00007400b0000000ULL)
+    .D64(0x00007500d0000000ULL)
+    .Mark(&frame1_rbp)
+    .D64(stack_section.start())
+    .D64(0x00007500b0000900ULL)
+    .Append(32, 0);
+  RegionFromSection();
+
+  raw_context.rip = 0x00007400c0000200ULL;
+  raw_context.rbp = frame1_rbp.Value();
+  raw_context.rsp = stack_section.start().Value();
+
+  struct {
+    uint64_t max_scanned_words_per_thread;
+    uint64_t max_symbolizer_calls_per_thread;
+    uint64_t max_frames_per_thread;
+    size_t frame_count;
+    bool budget_exhausted;
+  } cases[] = {
+    { 0, 0, 0, 3, false },
+    { 15, 3, 0, 3, false },
+    { 11, 0, 0, 3, true },
+    { 4, 0, 0, 1, true },
+    { 5, 0, 0, 2, true },
+    { 10, 0, 0, 2, true },
+    { 0, 2, 0, 2, true },
+    { 0, 0, 2, 2, true },
+    { 0, 0, 1, 1, true },
+  };
+  for (const auto& c : cases) {
+    StackwalkLimits limits;
+    limits.max_scanned_words_per_thread = c.max_scanned_words_per_thread;
+    limits.max_symbolizer_calls_per_thread = c.max_symbolizer_calls_per_thread;
+    limits.max_frames_per_thread = c.max_frames_per_thread;
+    StackwalkBudget budget(limits);
+
+    StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+    StackwalkerAMD64 walker(&system_info, &raw_context, &stack_region,
+                            &modules, &frame_symbolizer);
+    walker.set_budget(&budget);
+    CallStack stack;
+    vector<const CodeModule*> modules_without_symbols;
+    vector<const CodeModule*> modules_with_corrupt_symbols;
+    ASSERT_TRUE(walker.Walk(&stack, &modules_without_symbols,
+                            &modules_with_corrupt_symbols));
+    EXPECT_EQ(c.frame_count, stack.frames()->size())
+        << c.max_scanned_words_per_thread << " words, "
+        << c.max_symbolizer_calls_per_thread << " calls, "
+        << c.max_frames_per_thread << " frames";
+    EXPECT_EQ(c.budget_exhausted, stack.budget_exhausted())
+        << c.max_scanned_words_per_thread << " words, "
+        << c.max_symbolizer_calls_per_thread << " calls, "
+        << c.max_frames_per_thread << " frames";
+  }
+}
+
+TEST_F(GetCallerFrame, StopAfterUnsymbolizedScans) {
+  // The same stack as ScanWithoutSymbols, where both callers are found by
+  // scanning modules without symbols.
+  stack_section.start() = 0x8000000080000000ULL;
+  uint64_t return_address2 = 0x00007500b0000900ULL;
+  Label frame1_rbp, frame2_sp;
+  stack_section
+    .Append(16, 0)
+    .D64(0x00007400b0000000ULL)
+    .D64(0x00007500d0000000ULL)
+    .D64(0x00007500b0000100ULL)
+    .Append(16, 0)
+    .D64(0x00007400b0000000ULL)
+    .D64(0x00007500d0000000ULL)
+    .Mark(&frame1_rbp)
+    .D64(stack_section.start())
+    .D64(return_address2)
+    .Mark(&frame2_sp)
+    .Append(32, 0);
+  RegionFromSection();
+
+  raw_context.rip = 0x00007400c0000200ULL;
+  raw_context.rbp = frame1_rbp.Value();
+  raw_context.rsp = stack_section.start().Value();
+
+  StackwalkLimits limits;
+  limits.max_unsymbolized_scanned_frames = 1;
+  StackwalkBudget budget(limits);
+  StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+  StackwalkerAMD64 walker(&system_info, &raw_context, &stack_region,
+                          &modules, &frame_symbolizer);
+  walker.set_budget(&budget);
+  vector<const CodeModule*> modules_without_symbols;
+  vector<const CodeModule*> modules_with_corrupt_symbols;
+  ASSERT_TRUE(walker.Walk(&call_stack, &modules_without_symbols,
+                          &modules_with_corrupt_symbols));
+  ASSERT_EQ(2U, call_stack.frames()->size());
+  EXPECT_TRUE(call_stack.budget_exhausted());
+
+  // Resumed without the limit, the walk finds the frame it stopped short
+  // of.
+  StackwalkerAMD64 full_walker(&system_info, &raw_context, &stack_region,
+                               &modules, &frame_symbolizer);
+  ASSERT_TRUE(full_walker.ResumeWalk(&call_stack, &modules_without_symbols,
+                                     &modules_with_corrupt_symbols));
+  frames = call_stack.frames();
+  ASSERT_EQ(3U, frames->size());
+  EXPECT_FALSE(call_stack.budget_exhausted());
+  StackFrameAMD64 *frame2 = static_cast<StackFrameAMD64*>(frames->at(2));
+  EXPECT_EQ(StackFrame::FRAME_TRUST_SCAN, frame2->trust);
+  EXPECT_EQ(return_address2, frame2->context.rip);
+  EXPECT_EQ(frame2_sp.Value(), frame2->context.rsp);
+}
+
+TEST_F(GetCallerFrame, StopOutsideStack) {
+  // module1's CFI puts the caller's stack pointer past the end of the
+  // stack, and takes its return address from a register.
+  stack_section.start() = 0x8000000080000000ULL;
+  stack_section.Append(64, 0);
+  RegionFromSection();
+
+  raw_context.rip = 0x00007400c0004010ULL;
+  raw_context.rsp = stack_section.start().Value();
+  raw_context.rbx = 0x00007500b0000100ULL;
+
+  SetModuleSymbols(&module1,
+                   "FUNC 4000 1000 10 enchiridion\n"
+                   "STACK CFI INIT 4000 1000 .cfa: $rsp 4096 + .ra: $rbx\n");
+
+  StackwalkLimits limits;
+  limits.stop_outside_stack = true;
+  StackwalkBudget budget(limits);
+  StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+  StackwalkerAMD64 walker(&system_info, &raw_context, &stack_region,
+                          &modules, &frame_symbolizer);
+  walker.set_budget(&budget);
+  vector<const CodeModule*> modules_without_symbols;
+  vector<const CodeModule*> modules_with_corrupt_symbols;
+  ASSERT_TRUE(walker.Walk(&call_stack, &modules_without_symbols,
+                          &modules_with_corrupt_symbols));
+  ASSERT_EQ(1U, call_stack.frames()->size());
+  EXPECT_TRUE(call_stack.budget_exhausted());
+
+  StackwalkerAMD64 full_walker(&system_info, &raw_context, &stack_region,
+                               &modules, &frame_symbolizer);
+  ASSERT_TRUE(full_walker.ResumeWalk(&call_stack, &modules_without_symbols,
+                                     &modules_with_corrupt_symbols));
+  frames = call_stack.frames();
+  ASSERT_LE(2U, frames->size());
+  StackFrameAMD64 *frame1 = static_cast<StackFrameAMD64*>(frames->at(1));
+  EXPECT_EQ(StackFrame::FRAME_TRUST_CFI, frame1->trust);
+  EXPECT_EQ(0x00007500b0000100ULL, frame1->context.rip);
+  EXPECT_EQ(stack_section.start().Value() + 4096, frame1->context.rsp);
+}
+
 TEST_F(GetCallerFrame, ScanWithFunctionSymbols) {
   // During stack scanning, if a potential return address
   // is located within a loaded module that has symbols,
@@ -741,6 +912,77 @@ TEST_F(GetCallerFrame, CallerPushedRBP) {
   EXPECT_EQ(0x00007500b0000100ULL, frame1->function_base);
 }
 
+TEST_F(GetCallerFrame, PreferFramePointer) {
+  // module1's CFI and its frame pointer disagree about frame 1's caller.
+  // CFI wins unless module1 is named as keeping a frame pointer.
+  stack_section.start() = 0x8000000080000000ULL;
+  uint64_t cfi_return_address = 0x00007500b0000300ULL;
+  uint64_t fp_return_address = 0x00007500b0000500ULL;
+  Label frame0_rbp, frame1_sp, frame1_rbp, frame2_sp, frame2_rbp;
+
+  stack_section
+    // frame 0
+    .Append(16, 0)                      // space
+
+    .Mark(&frame0_rbp)
+    .D64(frame1_rbp)                    // caller-pushed %rbp
+    .D64(0x00007400c0004010ULL)         // return address into module1
+    // frame 1
+    .Mark(&frame1_sp)
+    .D64(cfi_return_address)            // return address CFI points to
+    .Append(16, 0)                      // body of frame1
+    .Mark(&frame1_rbp)
+    .D64(frame2_rbp)                    // caller-pushed %rbp
+    .D64(fp_return_address)             // return address %rbp points to
+    // frame 2
+    .Mark(&frame2_sp)
+    .Append(16, 0)                      // body of frame2
+    .Mark(&frame2_rbp)                  // end of stack
+    .D64(0)
+    .D64(0);
+  RegionFromSection();
+
+  raw_context.rip = 0x00007500b0000100ULL;
+  raw_context.rbp = frame0_rbp.Value();
+  raw_context.rsp = stack_section.start().Value();
+
+  SetModuleSymbols(&module1,
+                   "FUNC 4000 1000 10 enchiridion\n"
+                   "STACK CFI INIT 4000 1000 .cfa: $rsp 8 + .ra: .cfa 8 - ^\n");
+  Stackwalker::set_max_frames_scanned(0);
+
+  for (bool prefer_frame_pointer : {false, true}) {
+    StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+    if (prefer_frame_pointer)
+      frame_symbolizer.set_frame_pointer_modules({"module1"});
+    StackwalkerAMD64 walker(&system_info, &raw_context, &stack_region,
+                            &modules, &frame_symbolizer);
+    CallStack stack;
+    vector<const CodeModule*> modules_without_symbols;
+    vector<const CodeModule*> modules_with_corrupt_symbols;
+    ASSERT_TRUE(walker.Walk(&stack, &modules_without_symbols,
+                            &modules_with_corrupt_symbols));
+    frames = stack.frames();
+    ASSERT_LE(3U, frames->size());
+
+    StackFrameAMD64 *frame1 = static_cast<StackFrameAMD64*>(frames->at(1));
+    EXPECT_EQ(StackFrame::FRAME_TRUST_FP, frame1->trust);
+    EXPECT_EQ("enchiridion", frame1->function_name);
+
+    StackFrameAMD64 *frame2 = static_cast<StackFrameAMD64*>(frames->at(2));
+    if (prefer_frame_pointer) {
+      EXPECT_EQ(StackFrame::FRAME_TRUST_FP, frame2->trust);
+      EXPECT_EQ(fp_return_address, frame2->context.rip);
+      EXPECT_EQ(frame2_sp.Value(), frame2->context.rsp);
+      EXPECT_EQ(frame2_rbp.Value(), frame2->context.rbp);
+    } else {
+      EXPECT_EQ(StackFrame::FRAME_TRUST_CFI, frame2->trust);
+      EXPECT_EQ(cfi_return_address, frame2->context.rip);
+      EXPECT_EQ(frame1_sp.Value() + 8, frame2->context.rsp);
+    }
+  }
+}
+
 struct CFIFixture: public StackwalkerAMD64Fixture {
   CFIFixture() {
     // Provide a bunch of STACK CFI records; we'll walk to the caller
@@ -935,3 +1177,64 @@ TEST_F(CFI, At4006) {
   raw_context.r13 = 0x00007400c0005510ULL; // return address
   CheckWalk();
 }
+
+// A BasicSourceLineResolver that counts its CFI lookups.
+class CountingResolver : public BasicSourceLineResolver {
+ public:
+  CountingResolver() : cfi_lookups(0) { }
+  using BasicSourceLineResolver::FindCFIFrameInfo;
+  virtual google_breakpad::CFIFrameInfo* FindCFIFrameInfo(
+      const StackFrame* frame) {
+    ++cfi_lookups;
+    return BasicSourceLineResolver::FindCFIFrameInfo(frame);
+  }
+  int cfi_lookups;
+};
+
+// Walking the same stack again with the same symbolizer takes its CFI
+// from the symbolizer's cache until the symbolizer is Reset().
+TEST_F(CFI, CachedAcrossWalks) {
+  Label frame1_rsp = expected.rsp;
+  stack_section
+    .D64(0x00007400c0005510ULL) // return address
+    .Mark(&frame1_rsp);         // This effectively sets stack_section.start().
+  raw_context.rip = 0x00007400c0004000ULL;
+  RegionFromSection();
+  raw_context.rsp = stack_section.start().Value();
+
+  CountingResolver counting_resolver;
+  StackFrameSymbolizer frame_symbolizer(&supplier, &counting_resolver);
+  int lookups_per_walk = 0;
+  for (int walk = 0; walk < 4; ++walk) {
+    if (walk == 2)
+      frame_symbolizer.Reset();
+    if (walk == 3) {
+      frame_symbolizer.set_persist_frame_info_cache(true);
+      frame_symbolizer.Reset();
+    }
+    StackwalkerAMD64 walker(&system_info, &raw_context, &stack_region,
+                            &modules, &frame_symbolizer);
+    CallStack walk_call_stack;
+    vector<const CodeModule*> modules_without_symbols;
+    vector<const CodeModule*> modules_with_corrupt_symbols;
+    ASSERT_TRUE(walker.Walk(&walk_call_stack, &modules_without_symbols,
+                            &modules_with_corrupt_symbols));
+    ASSERT_EQ(2U, walk_call_stack.frames()->size());
+    StackFrameAMD64 *frame1 =
+        static_cast<StackFrameAMD64*>(walk_call_stack.frames()->at(1));
+    EXPECT_EQ(StackFrame::FRAME_TRUST_CFI, frame1->trust);
+    EXPECT_EQ(expected.rip, frame1->context.rip);
+    EXPECT_EQ(expected.rsp, frame1->context.rsp);
+
+    if (walk == 0) {
+      lookups_per_walk = counting_resolver.cfi_lookups;
+      ASSERT_LT(0, lookups_per_walk);
+    } else if (walk == 1) {
+      EXPECT_EQ(lookups_per_walk, counting_resolver.cfi_lookups);
+    } else {
+      // The Reset() before walk 2 evicts the cache; the persistent Reset()
+      // before walk 3 keeps it.
+      EXPECT_EQ(2 * lookups_per_walk, counting_resolver.cfi_lookups);
+    }
+  }
+}
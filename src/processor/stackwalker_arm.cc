@@ -68,7 +68,7 @@ StackFrame* StackwalkerARM::GetContextFrame() {
     return NULL;
   }
 
-  StackFrameARM* frame = new StackFrameARM();
+  StackFrameARM* frame = new (frame_pool_) StackFrameARM();
 
   // The instruction pointer is stored directly in a register (r15), so pull it
   // straight out of the CPU context structure.
@@ -85,36 +85,36 @@ StackFrameARM* StackwalkerARM::GetCallerByCFIFrameInfo(
     CFIFrameInfo* cfi_frame_info) {
   StackFrameARM* last_frame = static_cast<StackFrameARM*>(frames.back());
 
-  static const char* register_names[] = {
+  // The floating-point registers and cpsr are not in context.iregs, so
+  // only the general registers are recovered.
+  static const char* const register_names[] = {
     "r0",  "r1",  "r2",  "r3",  "r4",  "r5",  "r6",  "r7",
-    "r8",  "r9",  "r10", "r11", "r12", "sp",  "lr",  "pc",
-    "f0",  "f1",  "f2",  "f3",  "f4",  "f5",  "f6",  "f7",
-    "fps", "cpsr",
-    NULL
+    "r8",  "r9",  "r10", "r11", "r12", "sp",  "lr",  "pc"
   };
+  const size_t register_count = MD_CONTEXT_ARM_GPR_COUNT;
 
-  // Populate a dictionary with the valid register values in last_frame.
-  CFIFrameInfo::RegisterValueMap<uint32_t> callee_registers;
-  for (int i = 0; register_names[i]; i++)
+  // The valid register values in last_frame, and their flags.
+  uint64_t callee_known = 0;
+  for (size_t i = 0; i < register_count; i++) {
     if (last_frame->context_validity & StackFrameARM::RegisterValidFlag(i))
-      callee_registers[register_names[i]] = last_frame->context.iregs[i];
+      callee_known |= uint64_t(1) << i;
+  }
 
   // Use the STACK CFI data to recover the caller's register values.
-  CFIFrameInfo::RegisterValueMap<uint32_t> caller_registers;
-  if (!cfi_frame_info->FindCallerRegs(callee_registers, *memory_,
-                                      &caller_registers))
+  scoped_ptr<StackFrameARM> frame(new (frame_pool_) StackFrameARM());
+  uint64_t caller_known;
+  uint32_t cfa, ra;
+  if (!cfi_frame_info->FindCallerRegs<uint32_t>(
+          register_names, register_count, last_frame->context.iregs,
+          callee_known, *memory_, frame->context.iregs, &caller_known, &cfa,
+          &ra))
     return NULL;
 
   // Construct a new stack frame given the values the CFI recovered.
-  scoped_ptr<StackFrameARM> frame(new StackFrameARM());
-  for (int i = 0; register_names[i]; i++) {
-    CFIFrameInfo::RegisterValueMap<uint32_t>::iterator entry =
-      caller_registers.find(register_names[i]);
-    if (entry != caller_registers.end()) {
-      // We recovered the value of this register; fill the context with the
-      // value from caller_registers.
+  for (size_t i = 0; i < register_count; i++) {
+    if (caller_known & (uint64_t(1) << i)) {
+      // We recovered the value of this register.
       frame->context_validity |= StackFrameARM::RegisterValidFlag(i);
-      frame->context.iregs[i] = entry->second;
     } else if (4 <= i && i <= 11 && (last_frame->context_validity &
                                      StackFrameARM::RegisterValidFlag(i))) {
       // If the STACK CFI data doesn't mention some callee-saves register, and
@@ -127,31 +127,23 @@ StackFrameARM* StackwalkerARM::GetCallerByCFIFrameInfo(
   }
   // If the CFI doesn't recover the PC explicitly, then use .ra.
   if (!(frame->context_validity & StackFrameARM::CONTEXT_VALID_PC)) {
-    CFIFrameInfo::RegisterValueMap<uint32_t>::iterator entry =
-      caller_registers.find(".ra");
-    if (entry != caller_registers.end()) {
-      if (fp_register_ == -1) {
-        frame->context_validity |= StackFrameARM::CONTEXT_VALID_PC;
-        frame->context.iregs[MD_CONTEXT_ARM_REG_PC] = entry->second;
-      } else {
-        // The CFI updated the link register and not the program counter.
-        // Handle getting the program counter from the link register.
-        frame->context_validity |= StackFrameARM::CONTEXT_VALID_PC;
-        frame->context_validity |= StackFrameARM::CONTEXT_VALID_LR;
-        frame->context.iregs[MD_CONTEXT_ARM_REG_LR] = entry->second;
-        frame->context.iregs[MD_CONTEXT_ARM_REG_PC] =
-            last_frame->context.iregs[MD_CONTEXT_ARM_REG_LR];
-      }
+    if (fp_register_ == -1) {
+      frame->context_validity |= StackFrameARM::CONTEXT_VALID_PC;
+      frame->context.iregs[MD_CONTEXT_ARM_REG_PC] = ra;
+    } else {
+      // The CFI updated the link register and not the program counter.
+      // Handle getting the program counter from the link register.
+      frame->context_validity |= StackFrameARM::CONTEXT_VALID_PC;
+      frame->context_validity |= StackFrameARM::CONTEXT_VALID_LR;
+      frame->context.iregs[MD_CONTEXT_ARM_REG_LR] = ra;
+      frame->context.iregs[MD_CONTEXT_ARM_REG_PC] =
+          last_frame->context.iregs[MD_CONTEXT_ARM_REG_LR];
     }
   }
   // If the CFI doesn't recover the SP explicitly, then use .cfa.
   if (!(frame->context_validity & StackFrameARM::CONTEXT_VALID_SP)) {
-    CFIFrameInfo::RegisterValueMap<uint32_t>::iterator entry =
-      caller_registers.find(".cfa");
-    if (entry != caller_registers.end()) {
-      frame->context_validity |= StackFrameARM::CONTEXT_VALID_SP;
-      frame->context.iregs[MD_CONTEXT_ARM_REG_SP] = entry->second;
-    }
+    frame->context_validity |= StackFrameARM::CONTEXT_VALID_SP;
+    frame->context.iregs[MD_CONTEXT_ARM_REG_SP] = cfa;
   }
 
   // If we didn't recover the PC and the SP, then the frame isn't very useful.
@@ -184,7 +176,7 @@ StackFrameARM* StackwalkerARM::GetCallerByStackScan(
 
   // Create a new stack frame (ownership will be transferred to the caller)
   // and fill it in.
-  StackFrameARM* frame = new StackFrameARM();
+  StackFrameARM* frame = new (frame_pool_) StackFrameARM();
 
   frame->trust = StackFrame::FRAME_TRUST_SCAN;
   frame->context = last_frame->context;
@@ -226,7 +218,7 @@ StackFrameARM* StackwalkerARM::GetCallerByFramePointer(
 
   // Create a new stack frame (ownership will be transferred to the caller)
   // and fill it in.
-  StackFrameARM* frame = new StackFrameARM();
+  StackFrameARM* frame = new (frame_pool_) StackFrameARM();
 
   frame->trust = StackFrame::FRAME_TRUST_FP;
   frame->context = last_frame->context;
@@ -36,6 +36,7 @@
 #include <config.h>  // Must come first
 #endif
 
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 
@@ -79,7 +80,45 @@ StackwalkerARM64::StackwalkerARM64(const SystemInfo* system_info,
 
 uint64_t StackwalkerARM64::PtrauthStrip(uint64_t ptr) {
   uint64_t stripped = ptr & address_range_mask_;
-  return modules_ && modules_->GetModuleForAddress(stripped) ? stripped : ptr;
+  if (stripped == ptr)
+    return ptr;
+  return AddressIsInModule(stripped) ? stripped : ptr;
+}
+
+bool StackwalkerARM64::ReadFrameRecord(uint64_t fp,
+                                       uint64_t* caller_fp,
+                                       uint64_t* caller_lr) {
+  FrameRecord key = {fp, 0, 0};
+  vector<FrameRecord>::const_iterator record = std::lower_bound(
+      frame_records_.begin(), frame_records_.end(), key,
+      [](const FrameRecord& a, const FrameRecord& b) { return a.fp < b.fp; });
+  if (record == frame_records_.end() || record->fp != fp) {
+    // Follow the chain up from fp.  Each link must point higher, to an
+    // aligned address within the stack memory; anything else ends the
+    // chain here, and is left to the caller to make sense of.
+    frame_records_.clear();
+    uint64_t memory_end = memory_->GetBase() + memory_->GetSize();
+    uint64_t record_fp = fp;
+    for (;;) {
+      uint64_t words[2];
+      if (!memory_->GetMemoryArrayAtAddress(record_fp, words, 2))
+        break;
+      FrameRecord next = {record_fp, words[0], PtrauthStrip(words[1])};
+      frame_records_.push_back(next);
+      if (words[0] <= record_fp || words[0] % 8 != 0 ||
+          words[0] >= memory_end) {
+        break;
+      }
+      record_fp = words[0];
+    }
+    if (frame_records_.empty())
+      return false;
+    record = frame_records_.begin();
+  }
+
+  *caller_fp = record->caller_fp;
+  *caller_lr = record->caller_lr;
+  return true;
 }
 
 StackFrame* StackwalkerARM64::GetContextFrame() {
@@ -88,7 +127,7 @@ StackFrame* StackwalkerARM64::GetContextFrame() {
     return NULL;
   }
 
-  StackFrameARM64* frame = new StackFrameARM64();
+  StackFrameARM64* frame = new (frame_pool_) StackFrameARM64();
 
   // The instruction pointer is stored directly in a register (x32), so pull it
   // straight out of the CPU context structure.
@@ -112,32 +151,32 @@ StackFrameARM64* StackwalkerARM64::GetCallerByCFIFrameInfo(
     "x8",  "x9",  "x10", "x11", "x12", "x13", "x14", "x15",
     "x16", "x17", "x18", "x19", "x20", "x21", "x22", "x23",
     "x24", "x25", "x26", "x27", "x28", "x29", "x30", "sp",
-    "pc",  NULL
+    "pc"
   };
 
-  // Populate a dictionary with the valid register values in last_frame.
-  CFIFrameInfo::RegisterValueMap<uint64_t> callee_registers;
-  for (int i = 0; register_names[i]; i++) {
+  // The valid register values in last_frame, and their flags.
+  const size_t register_count = MD_CONTEXT_ARM64_GPR_COUNT;
+  uint64_t callee_known = 0;
+  for (size_t i = 0; i < register_count; i++) {
     if (last_frame->context_validity & StackFrameARM64::RegisterValidFlag(i))
-      callee_registers[register_names[i]] = last_frame->context.iregs[i];
+      callee_known |= uint64_t(1) << i;
   }
 
   // Use the STACK CFI data to recover the caller's register values.
-  CFIFrameInfo::RegisterValueMap<uint64_t> caller_registers;
-  if (!cfi_frame_info->FindCallerRegs(callee_registers, *memory_,
-                                      &caller_registers)) {
+  scoped_ptr<StackFrameARM64> frame(new (frame_pool_) StackFrameARM64());
+  uint64_t caller_known;
+  uint64_t cfa, ra;
+  if (!cfi_frame_info->FindCallerRegs<uint64_t>(
+          register_names, register_count, last_frame->context.iregs,
+          callee_known, *memory_, frame->context.iregs, &caller_known, &cfa,
+          &ra)) {
     return NULL;
   }
   // Construct a new stack frame given the values the CFI recovered.
-  scoped_ptr<StackFrameARM64> frame(new StackFrameARM64());
-  for (int i = 0; register_names[i]; i++) {
-    CFIFrameInfo::RegisterValueMap<uint64_t>::iterator entry =
-      caller_registers.find(register_names[i]);
-    if (entry != caller_registers.end()) {
-      // We recovered the value of this register; fill the context with the
-      // value from caller_registers.
+  for (size_t i = 0; i < register_count; i++) {
+    if (caller_known & (uint64_t(1) << i)) {
+      // We recovered the value of this register.
       frame->context_validity |= StackFrameARM64::RegisterValidFlag(i);
-      frame->context.iregs[i] = entry->second;
     } else if (19 <= i && i <= 29 && (last_frame->context_validity &
                                       StackFrameARM64::RegisterValidFlag(i))) {
       // If the STACK CFI data doesn't mention some callee-saves register, and
@@ -151,21 +190,13 @@ StackFrameARM64* StackwalkerARM64::GetCallerByCFIFrameInfo(
   }
   // If the CFI doesn't recover the PC explicitly, then use .ra.
   if (!(frame->context_validity & StackFrameARM64::CONTEXT_VALID_PC)) {
-    CFIFrameInfo::RegisterValueMap<uint64_t>::iterator entry =
-      caller_registers.find(".ra");
-    if (entry != caller_registers.end()) {
-      frame->context_validity |= StackFrameARM64::CONTEXT_VALID_PC;
-      frame->context.iregs[MD_CONTEXT_ARM64_REG_PC] = entry->second;
-    }
+    frame->context_validity |= StackFrameARM64::CONTEXT_VALID_PC;
+    frame->context.iregs[MD_CONTEXT_ARM64_REG_PC] = ra;
   }
   // If the CFI doesn't recover the SP explicitly, then use .cfa.
   if (!(frame->context_validity & StackFrameARM64::CONTEXT_VALID_SP)) {
-    CFIFrameInfo::RegisterValueMap<uint64_t>::iterator entry =
-      caller_registers.find(".cfa");
-    if (entry != caller_registers.end()) {
-      frame->context_validity |= StackFrameARM64::CONTEXT_VALID_SP;
-      frame->context.iregs[MD_CONTEXT_ARM64_REG_SP] = entry->second;
-    }
+    frame->context_validity |= StackFrameARM64::CONTEXT_VALID_SP;
+    frame->context.iregs[MD_CONTEXT_ARM64_REG_SP] = cfa;
   }
 
   // If we didn't recover the PC and the SP, then the frame isn't very useful.
@@ -200,10 +231,10 @@ StackFrameARM64* StackwalkerARM64::GetCallerByStackScan(
 
   // Create a new stack frame (ownership will be transferred to the caller)
   // and fill it in.
-  StackFrameARM64* frame = new StackFrameARM64();
+  StackFrameARM64* frame = new (frame_pool_) StackFrameARM64();
 
   frame->trust = StackFrame::FRAME_TRUST_SCAN;
-  frame->context = last_frame->context;
+  frame->CopyIntegerRegisters(*last_frame);
   frame->context.iregs[MD_CONTEXT_ARM64_REG_PC] = caller_pc;
   frame->context.iregs[MD_CONTEXT_ARM64_REG_SP] = caller_sp;
   frame->context_validity = StackFrameARM64::CONTEXT_VALID_PC |
@@ -222,30 +253,22 @@ StackFrameARM64* StackwalkerARM64::GetCallerByFramePointer(
   uint64_t last_fp = last_frame->context.iregs[MD_CONTEXT_ARM64_REG_FP];
 
   uint64_t caller_fp = 0;
-  if (last_fp && !memory_->GetMemoryAtAddress(last_fp, &caller_fp)) {
-    BPLOG(ERROR) << "Unable to read caller_fp from last_fp: 0x"
-                 << std::hex << last_fp;
-    return NULL;
-  }
-
   uint64_t caller_lr = 0;
-  if (last_fp && !memory_->GetMemoryAtAddress(last_fp + 8, &caller_lr)) {
-    BPLOG(ERROR) << "Unable to read caller_lr from last_fp + 8: 0x"
-                 << std::hex << (last_fp + 8);
+  if (last_fp && !ReadFrameRecord(last_fp, &caller_fp, &caller_lr)) {
+    BPLOG(ERROR) << "Unable to read frame record at last_fp: 0x"
+                 << std::hex << last_fp;
     return NULL;
   }
 
-  caller_lr = PtrauthStrip(caller_lr);
-
   uint64_t caller_sp = last_fp ? last_fp + 16 :
       last_frame->context.iregs[MD_CONTEXT_ARM64_REG_SP];
 
   // Create a new stack frame (ownership will be transferred to the caller)
   // and fill it in.
-  StackFrameARM64* frame = new StackFrameARM64();
+  StackFrameARM64* frame = new (frame_pool_) StackFrameARM64();
 
   frame->trust = StackFrame::FRAME_TRUST_FP;
-  frame->context = last_frame->context;
+  frame->CopyIntegerRegisters(*last_frame);
   frame->context.iregs[MD_CONTEXT_ARM64_REG_FP] = caller_fp;
   frame->context.iregs[MD_CONTEXT_ARM64_REG_SP] = caller_sp;
   frame->context.iregs[MD_CONTEXT_ARM64_REG_PC] =
@@ -287,23 +310,15 @@ void StackwalkerARM64::CorrectRegLRByFramePointer(
       last_frame_callee->context.iregs[MD_CONTEXT_ARM64_REG_FP];
 
   uint64_t last_fp = 0;
+  uint64_t last_lr = 0;
   if (last_frame_callee_fp &&
-      !memory_->GetMemoryAtAddress(last_frame_callee_fp, &last_fp)) {
+      !ReadFrameRecord(last_frame_callee_fp, &last_fp, &last_lr)) {
     return;
   }
   // Give up if STACK CFI doesn't agree with frame pointer.
   if (last_frame->context.iregs[MD_CONTEXT_ARM64_REG_FP] != last_fp)
     return;
 
-  uint64_t last_lr = 0;
-  if (last_frame_callee_fp &&
-      !memory_->GetMemoryAtAddress(last_frame_callee_fp + 8, &last_lr)) {
-    BPLOG(ERROR) << "Unable to read last_lr from (last_last_fp + 8): 0x"
-                 << std::hex << (last_frame_callee_fp + 8);
-    return;
-  }
-  last_lr = PtrauthStrip(last_lr);
-
   last_frame->context.iregs[MD_CONTEXT_ARM64_REG_LR] = last_lr;
 }
 
@@ -318,14 +333,25 @@ StackFrame* StackwalkerARM64::GetCallerFrame(const CallStack* stack,
   StackFrameARM64* last_frame = static_cast<StackFrameARM64*>(frames.back());
   scoped_ptr<StackFrameARM64> frame;
 
+  // Frames in modules known to keep a frame pointer are unwound with it
+  // before looking for CFI.  The context frame is left to CFI, since it may
+  // be a leaf function, or have stopped before its prologue saved FP and LR.
+  bool frame_pointer_first =
+      last_frame->trust != StackFrame::FRAME_TRUST_CONTEXT &&
+      frame_symbolizer_->PrefersFramePointer(last_frame);
+  if (frame_pointer_first)
+    frame.reset(GetCallerByFramePointer(frames));
+
   // See if there is DWARF call frame information covering this address.
-  scoped_ptr<CFIFrameInfo> cfi_frame_info(
-      frame_symbolizer_->FindCFIFrameInfo(last_frame));
-  if (cfi_frame_info.get())
-    frame.reset(GetCallerByCFIFrameInfo(frames, cfi_frame_info.get()));
+  if (!frame.get()) {
+    scoped_ptr<CFIFrameInfo> cfi_frame_info(
+        frame_symbolizer_->FindCFIFrameInfo(last_frame));
+    if (cfi_frame_info.get())
+      frame.reset(GetCallerByCFIFrameInfo(frames, cfi_frame_info.get()));
+  }
 
   // If CFI failed, or there wasn't CFI available, fall back to frame pointer.
-  if (!frame.get())
+  if (!frame.get() && !frame_pointer_first)
     frame.reset(GetCallerByFramePointer(frames));
 
   // If everything failed, fall back to stack scanning.
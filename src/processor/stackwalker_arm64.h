@@ -67,9 +67,25 @@ class StackwalkerARM64 : public Stackwalker {
   }
 
  private:
+  // A frame record: the caller's x29 ($FP) and x30 ($LR), saved at the
+  // address that the callee's x29 points to.
+  struct FrameRecord {
+    uint64_t fp;
+    uint64_t caller_fp;
+    // With pointer authentication codes stripped.
+    uint64_t caller_lr;
+  };
+
   // Strip pointer authentication codes from an address.
   uint64_t PtrauthStrip(uint64_t ptr);
 
+  // Sets |caller_fp| and |caller_lr| from the frame record at |fp|.  The
+  // first record asked for that is not in frame_records_ replaces them
+  // with the x29 chain from it, followed in one go for as long as each
+  // link points higher up the stack memory.  Returns false if the record
+  // at |fp| cannot be read.
+  bool ReadFrameRecord(uint64_t fp, uint64_t* caller_fp, uint64_t* caller_lr);
+
   // Implementation of Stackwalker, using arm64 context and stack conventions.
   virtual StackFrame* GetContextFrame();
   virtual StackFrame* GetCallerFrame(const CallStack* stack,
@@ -108,6 +124,10 @@ class StackwalkerARM64 : public Stackwalker {
   // A mask of the valid address bits, determined from the address range of
   // modules_.
   uint64_t address_range_mask_;
+
+  // The frame records of the x29 chain last followed by ReadFrameRecord,
+  // in order of increasing address.
+  vector<FrameRecord> frame_records_;
 };
 
 
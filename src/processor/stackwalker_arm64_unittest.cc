@@ -538,6 +538,142 @@ TEST_F(GetFramesByFramePointer, OnlyFramePointer) {
   EXPECT_EQ(0U, frame2->context.iregs[MD_CONTEXT_ARM64_REG_FP]);
 }
 
+TEST_F(GetFramesByFramePointer, PointerAuthentication) {
+  // Return addresses signed with pointer authentication codes are
+  // stripped if what's left is in a module, and kept whole if not.
+  stack_section.start() = 0x80000000;
+  uint64_t return_address1 = 0x50000100;
+  uint64_t return_address2 = 0x50000900;
+  uint64_t return_address3 = 0x60000900;
+  uint64_t pac = 0x002a000000000000ULL;
+  Label frame1_fp, frame2_fp, frame3_fp;
+  stack_section
+    // frame 0
+    .Append(32, 0)
+    .Mark(&frame1_fp)
+    .D64(frame2_fp)
+    .D64(pac | return_address2)
+
+    // frame 1
+    .Append(32, 0)
+    .Mark(&frame2_fp)
+    .D64(frame3_fp)
+    .D64(pac | return_address3)
+
+    // frame 2
+    .Append(32, 0)
+    .Mark(&frame3_fp)
+    .D64(0)
+    .D64(0);
+  RegionFromSection();
+
+  raw_context.iregs[MD_CONTEXT_ARM64_REG_PC] = 0x40005510;
+  raw_context.iregs[MD_CONTEXT_ARM64_REG_LR] = pac | return_address1;
+  raw_context.iregs[MD_CONTEXT_ARM64_REG_FP] = frame1_fp.Value();
+  raw_context.iregs[MD_CONTEXT_ARM64_REG_SP] = stack_section.start().Value();
+
+  StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+  StackwalkerARM64 walker(&system_info, &raw_context,
+                          &stack_region, &modules, &frame_symbolizer);
+
+  vector<const CodeModule*> modules_without_symbols;
+  vector<const CodeModule*> modules_with_corrupt_symbols;
+  ASSERT_TRUE(walker.Walk(&call_stack, &modules_without_symbols,
+                          &modules_with_corrupt_symbols));
+  frames = call_stack.frames();
+  ASSERT_EQ(4U, frames->size());
+
+  StackFrameARM64 *frame1 = static_cast<StackFrameARM64*>(frames->at(1));
+  EXPECT_EQ(StackFrame::FRAME_TRUST_FP, frame1->trust);
+  EXPECT_EQ(return_address1, frame1->context.iregs[MD_CONTEXT_ARM64_REG_PC]);
+  EXPECT_EQ(return_address2, frame1->context.iregs[MD_CONTEXT_ARM64_REG_LR]);
+
+  StackFrameARM64 *frame2 = static_cast<StackFrameARM64*>(frames->at(2));
+  EXPECT_EQ(StackFrame::FRAME_TRUST_FP, frame2->trust);
+  EXPECT_EQ(return_address2, frame2->context.iregs[MD_CONTEXT_ARM64_REG_PC]);
+  EXPECT_EQ(pac | return_address3,
+            frame2->context.iregs[MD_CONTEXT_ARM64_REG_LR]);
+  EXPECT_EQ(frame3_fp.Value(),
+            frame2->context.iregs[MD_CONTEXT_ARM64_REG_FP]);
+
+  StackFrameARM64 *frame3 = static_cast<StackFrameARM64*>(frames->at(3));
+  EXPECT_EQ(StackFrame::FRAME_TRUST_FP, frame3->trust);
+  EXPECT_EQ(pac | return_address3,
+            frame3->context.iregs[MD_CONTEXT_ARM64_REG_PC]);
+  EXPECT_EQ(0U, frame3->context.iregs[MD_CONTEXT_ARM64_REG_FP]);
+}
+
+TEST_F(GetFramesByFramePointer, PreferFramePointer) {
+  // module1's CFI and its frame pointer disagree about frame 1's caller.
+  // CFI wins unless module1 is named as keeping a frame pointer.
+  stack_section.start() = 0x80000000;
+  uint64_t cfi_return_address = 0x50000300;
+  uint64_t fp_return_address = 0x50000500;
+  Label frame0_fp, frame1_sp, frame1_fp;
+  stack_section
+    // frame 0
+    .Append(16, 0)           // Whatever values on the stack.
+
+    .Mark(&frame0_fp)
+    .D64(frame1_fp)          // Save current frame pointer.
+    .D64(fp_return_address)  // Save current link register.
+    .Mark(&frame1_sp)
+
+    // frame 1
+    .D64(cfi_return_address) // Return address CFI points to.
+    .Append(16, 0)           // Whatever values on the stack.
+
+    .Mark(&frame1_fp)
+    .D64(0)
+    .D64(0)
+
+    // frame 2
+    .Append(16, 0);          // Whatever values on the stack.
+  RegionFromSection();
+
+  raw_context.iregs[MD_CONTEXT_ARM64_REG_PC] = 0x50000100;
+  raw_context.iregs[MD_CONTEXT_ARM64_REG_LR] = 0x40004010;
+  raw_context.iregs[MD_CONTEXT_ARM64_REG_FP] = frame0_fp.Value();
+  raw_context.iregs[MD_CONTEXT_ARM64_REG_SP] = stack_section.start().Value();
+
+  SetModuleSymbols(&module1,
+                   "FUNC 4000 1000 10 enchiridion\n"
+                   "STACK CFI INIT 4000 1000 .cfa: sp 16 + .ra: .cfa -16 + ^\n");
+  Stackwalker::set_max_frames_scanned(0);
+
+  for (bool prefer_frame_pointer : {false, true}) {
+    StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+    if (prefer_frame_pointer)
+      frame_symbolizer.set_frame_pointer_modules({"module1"});
+    StackwalkerARM64 walker(&system_info, &raw_context,
+                            &stack_region, &modules, &frame_symbolizer);
+    CallStack stack;
+    vector<const CodeModule*> modules_without_symbols;
+    vector<const CodeModule*> modules_with_corrupt_symbols;
+    ASSERT_TRUE(walker.Walk(&stack, &modules_without_symbols,
+                            &modules_with_corrupt_symbols));
+    frames = stack.frames();
+    ASSERT_LE(3U, frames->size());
+
+    StackFrameARM64 *frame1 = static_cast<StackFrameARM64*>(frames->at(1));
+    EXPECT_EQ(StackFrame::FRAME_TRUST_FP, frame1->trust);
+    EXPECT_EQ("enchiridion", frame1->function_name);
+    EXPECT_EQ(frame1_sp.Value(),
+              frame1->context.iregs[MD_CONTEXT_ARM64_REG_SP]);
+
+    StackFrameARM64 *frame2 = static_cast<StackFrameARM64*>(frames->at(2));
+    if (prefer_frame_pointer) {
+      EXPECT_EQ(StackFrame::FRAME_TRUST_FP, frame2->trust);
+      EXPECT_EQ(fp_return_address,
+                frame2->context.iregs[MD_CONTEXT_ARM64_REG_PC]);
+    } else {
+      EXPECT_EQ(StackFrame::FRAME_TRUST_CFI, frame2->trust);
+      EXPECT_EQ(cfi_return_address,
+                frame2->context.iregs[MD_CONTEXT_ARM64_REG_PC]);
+    }
+  }
+}
+
 struct CFIFixture: public StackwalkerARM64Fixture {
   CFIFixture() {
     // Provide a bunch of STACK CFI records; we'll walk to the caller
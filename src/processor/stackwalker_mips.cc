@@ -85,7 +85,7 @@ StackFrame* StackwalkerMIPS::GetContextFrame() {
     return NULL;
   }
 
-  StackFrameMIPS* frame = new StackFrameMIPS();
+  StackFrameMIPS* frame = new (frame_pool_) StackFrameMIPS();
 
   // The instruction pointer is stored directly in a register, so pull it
   // straight out of the CPU context structure.
@@ -143,7 +143,7 @@ StackFrameMIPS* StackwalkerMIPS::GetCallerByCFIFrameInfo(
     }
     caller_registers["$pc"] = pc;
     // Construct a new stack frame given the values the CFI recovered.
-    scoped_ptr<StackFrameMIPS> frame(new StackFrameMIPS());
+    scoped_ptr<StackFrameMIPS> frame(new (frame_pool_) StackFrameMIPS());
 
     for (int i = 0; kRegisterNames[i]; ++i) {
       CFIFrameInfo::RegisterValueMap<uint32_t>::const_iterator caller_entry =
@@ -210,7 +210,7 @@ StackFrameMIPS* StackwalkerMIPS::GetCallerByCFIFrameInfo(
     }
     caller_registers["$pc"] = pc;
     // Construct a new stack frame given the values the CFI recovered.
-    scoped_ptr<StackFrameMIPS> frame(new StackFrameMIPS());
+    scoped_ptr<StackFrameMIPS> frame(new (frame_pool_) StackFrameMIPS());
 
     for (int i = 0; kRegisterNames[i]; ++i) {
       CFIFrameInfo::RegisterValueMap<uint64_t>::const_iterator caller_entry =
@@ -356,7 +356,7 @@ StackFrameMIPS* StackwalkerMIPS::GetCallerByStackScan(
 
     // Create a new stack frame (ownership will be transferred to the caller)
     // and fill it in.
-    StackFrameMIPS* frame = new StackFrameMIPS();
+    StackFrameMIPS* frame = new (frame_pool_) StackFrameMIPS();
     frame->trust = StackFrame::FRAME_TRUST_SCAN;
     frame->context = last_frame->context;
     frame->context.epc = caller_pc;
@@ -422,7 +422,7 @@ StackFrameMIPS* StackwalkerMIPS::GetCallerByStackScan(
 
     // Create a new stack frame (ownership will be transferred to the caller)
     // and fill it in.
-    StackFrameMIPS* frame = new StackFrameMIPS();
+    StackFrameMIPS* frame = new (frame_pool_) StackFrameMIPS();
     frame->trust = StackFrame::FRAME_TRUST_SCAN;
     frame->context = last_frame->context;
     frame->context.epc = caller_pc;
@@ -72,7 +72,7 @@ StackFrame* StackwalkerPPC::GetContextFrame() {
     return NULL;
   }
 
-  StackFramePPC* frame = new StackFramePPC();
+  StackFramePPC* frame = new (frame_pool_) StackFramePPC();
 
   // The instruction pointer is stored directly in a register, so pull it
   // straight out of the CPU context structure.
@@ -125,7 +125,7 @@ StackFrame* StackwalkerPPC::GetCallerFrame(const CallStack* stack,
     return NULL;
   }
 
-  scoped_ptr<StackFramePPC> frame(new StackFramePPC());
+  scoped_ptr<StackFramePPC> frame(new (frame_pool_) StackFramePPC());
 
   frame->context = last_frame->context;
   frame->context.srr0 = instruction;
@@ -63,7 +63,7 @@ StackFrame* StackwalkerPPC64::GetContextFrame() {
     return NULL;
   }
 
-  StackFramePPC64* frame = new StackFramePPC64();
+  StackFramePPC64* frame = new (frame_pool_) StackFramePPC64();
 
   // The instruction pointer is stored directly in a register, so pull it
   // straight out of the CPU context structure.
@@ -116,7 +116,7 @@ StackFrame* StackwalkerPPC64::GetCallerFrame(const CallStack* stack,
     return NULL;
   }
 
-  scoped_ptr<StackFramePPC64> frame(new StackFramePPC64());
+  scoped_ptr<StackFramePPC64> frame(new (frame_pool_) StackFramePPC64());
 
   frame->context = last_frame->context;
   frame->context.srr0 = instruction;
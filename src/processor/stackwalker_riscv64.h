@@ -39,6 +39,7 @@
 
 #include "google_breakpad/common/minidump_format.h"
 #include "google_breakpad/processor/stackwalker.h"
+#include "processor/cfi_frame_info.h"
 
 namespace google_breakpad {
 
@@ -64,6 +65,9 @@ public:
   }
 
 private:
+  // A STACK CFI-driven frame walker for the RISC-V.
+  typedef SimpleCFIWalker<uint64_t, MDRawContextRISCV64> CFIWalker;
+
   // Implementation of Stackwalker, using riscv context and stack conventions.
   virtual StackFrame* GetContextFrame();
   virtual StackFrame* GetCallerFrame(
@@ -93,6 +97,12 @@ private:
   // CONTEXT_VALID_ALL in real use; it is only changeable for the sake of
   // unit tests.
   int context_frame_validity_;
+
+  // Our register map, for cfi_walker_.
+  static const CFIWalker::RegisterSet cfi_register_map_[];
+
+  // Our CFI frame walker.
+  const CFIWalker cfi_walker_;
 };
 
 }  // namespace google_breakpad
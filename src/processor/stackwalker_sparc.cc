@@ -62,7 +62,7 @@ StackFrame* StackwalkerSPARC::GetContextFrame() {
     return NULL;
   }
 
-  StackFrameSPARC* frame = new StackFrameSPARC();
+  StackFrameSPARC* frame = new (frame_pool_) StackFrameSPARC();
 
   // The instruction pointer is stored directly in a register, so pull it
   // straight out of the CPU context structure.
@@ -121,7 +121,7 @@ StackFrame* StackwalkerSPARC::GetCallerFrame(const CallStack* stack,
     return NULL;
   }
 
-  StackFrameSPARC* frame = new StackFrameSPARC();
+  StackFrameSPARC* frame = new (frame_pool_) StackFrameSPARC();
 
   frame->context = last_frame->context;
   frame->context.g_r[14] = stack_pointer;
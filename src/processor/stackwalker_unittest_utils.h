@@ -76,6 +76,14 @@ class MockMemoryRegion: public google_breakpad::MemoryRegion {
   bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const {
     return GetMemoryLittleEndian(address, value);
   }
+  bool GetMemoryArrayAtAddress(uint64_t address, uint32_t* values,
+                               size_t count) const {
+    return GetMemoryArrayLittleEndian(address, values, count);
+  }
+  bool GetMemoryArrayAtAddress(uint64_t address, uint64_t* values,
+                               size_t count) const {
+    return GetMemoryArrayLittleEndian(address, values, count);
+  }
   void Print() const {
     assert(false);
   }
@@ -97,6 +105,20 @@ class MockMemoryRegion: public google_breakpad::MemoryRegion {
     return true;
   }
 
+  // Fetch COUNT consecutive little-endian values starting at ADDRESS.
+  template<typename ValueType>
+  bool GetMemoryArrayLittleEndian(uint64_t address, ValueType* values,
+                                  size_t count) const {
+    if (!ContainsArray<ValueType>(address, count))
+      return false;
+    for (size_t index = 0; index < count; ++index) {
+      if (!GetMemoryLittleEndian(address + index * sizeof(ValueType),
+                                 &values[index]))
+        return false;
+    }
+    return true;
+  }
+
   uint64_t base_address_;
   string contents_;
 };
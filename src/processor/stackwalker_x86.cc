@@ -37,6 +37,7 @@
 #endif
 
 #include <assert.h>
+#include <memory>
 #include <string>
 
 #include "common/scoped_ptr.h"
@@ -46,9 +47,9 @@
 #include "google_breakpad/processor/source_line_resolver_interface.h"
 #include "google_breakpad/processor/stack_frame_cpu.h"
 #include "processor/logging.h"
-#include "processor/postfix_evaluator-inl.h"
 #include "processor/stackwalker_x86.h"
 #include "processor/windows_frame_info.h"
+#include "processor/windows_frame_program.h"
 #include "processor/cfi_frame_info.h"
 
 namespace google_breakpad {
@@ -126,7 +127,7 @@ StackFrame* StackwalkerX86::GetContextFrame() {
     return NULL;
   }
 
-  StackFrameX86* frame = new StackFrameX86();
+  StackFrameX86* frame = new (frame_pool_) StackFrameX86();
 
   // The instruction pointer is stored directly in a register, so pull it
   // straight out of the CPU context structure.
@@ -212,23 +213,25 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
     }
   }
 
-  // Set up the dictionary for the PostfixEvaluator.  %ebp, %esp, and sometimes
+  // Set up the variables for the program string.  %ebp, %esp, and sometimes
   // %ebx are used in program strings, and their previous values are known, so
   // set them here.
-  PostfixEvaluator<uint32_t>::DictionaryType dictionary;
+  WindowsFrameProgram::Values values;
   // Provide the current register values.
-  dictionary["$ebp"] = last_frame->context.ebp;
-  dictionary["$esp"] = last_frame->context.esp;
+  values.Set(WindowsFrameProgram::EBP, last_frame->context.ebp);
+  values.Set(WindowsFrameProgram::ESP, last_frame->context.esp);
   if (last_frame->context_validity & StackFrameX86::CONTEXT_VALID_EBX)
-    dictionary["$ebx"] = last_frame->context.ebx;
+    values.Set(WindowsFrameProgram::EBX, last_frame->context.ebx);
   // Provide constants from the debug info for last_frame and its callee.
   // .cbCalleeParams is a Breakpad extension that allows us to use the
   // PostfixEvaluator engine when certain types of debugging information
   // are present without having to write the constants into the program
   // string as literals.
-  dictionary[".cbCalleeParams"] = last_frame_callee_parameter_size;
-  dictionary[".cbSavedRegs"] = last_frame_info->saved_register_size;
-  dictionary[".cbLocals"] = last_frame_info->local_size;
+  values.Set(WindowsFrameProgram::CB_CALLEE_PARAMS,
+             last_frame_callee_parameter_size);
+  values.Set(WindowsFrameProgram::CB_SAVED_REGS,
+             last_frame_info->saved_register_size);
+  values.Set(WindowsFrameProgram::CB_LOCALS, last_frame_info->local_size);
 
   uint32_t raSearchStart = last_frame->context.esp +
                            last_frame_callee_parameter_size +
@@ -268,15 +271,20 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
     ScanForReturnAddress(raSearchStart, &raSearchStart, &found, 3);
   }
 
-  dictionary[".cbParams"] = last_frame_info->parameter_size;
+  values.Set(WindowsFrameProgram::CB_PARAMS, last_frame_info->parameter_size);
 
   // Decide what type of program string to use. The program string is in
-  // postfix notation and will be passed to PostfixEvaluator::Evaluate.
-  // Given the dictionary and the program string, it is possible to compute
+  // postfix notation, of the sort PostfixEvaluator::Evaluate interprets.
+  // Given the variables and the program string, it is possible to compute
   // the return address and the values of other registers in the calling
   // function. Because of bugs described below, the stack may need to be
   // scanned for these values. The results of program string evaluation
   // will be used to determine whether to scan for better values.
+  //
+  // Program strings are run compiled when they can be.  The resolver
+  // compiles those from symbol files as it loads them, and the fixed ones
+  // below are compiled once.
+  std::shared_ptr<const WindowsFrameProgram> program;
   string program_string;
   bool recover_ebp = true;
 
@@ -288,6 +296,11 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
     // parameters.  In some cases, particularly with program strings that use
     // .raSearchStart, the stack may need to be scanned afterward.
     program_string = last_frame_info->program_string;
+    program = last_frame_info->compiled_program;
+    if (program.get() == NULL) {
+      // The resolver doesn't compile program strings as it loads them.
+      program = WindowsFrameProgram::Compile(program_string);
+    }
   } else if (last_frame_info->allocates_base_pointer) {
     // The function corresponding to the last frame doesn't use the frame
     // pointer for conventional purposes, but it does allocate a new
@@ -324,9 +337,12 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
     // %eip_new = *(%esp_old + callee_params + saved_regs + locals)
     // %ebp_new = *(%esp_old + callee_params + saved_regs - 8)
     // %esp_new = %esp_old + callee_params + saved_regs + locals + 4
-    program_string = "$eip .raSearchStart ^ = "
-        "$ebp $esp .cbCalleeParams + .cbSavedRegs + 8 - ^ = "
-        "$esp .raSearchStart 4 + =";
+    static const std::shared_ptr<const WindowsFrameProgram>
+        base_pointer_program = WindowsFrameProgram::Compile(
+            "$eip .raSearchStart ^ = "
+            "$ebp $esp .cbCalleeParams + .cbSavedRegs + 8 - ^ = "
+            "$esp .raSearchStart 4 + =");
+    program = base_pointer_program;
   } else {
     // The function corresponding to the last frame doesn't use %ebp at
     // all.  The callee frame is located relative to %esp.
@@ -353,10 +369,17 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
     // %esp_new = %esp_old + callee_params + saved_regs + locals + 4
     // %ebp_new = %ebp_old
     // %ebx_new = %ebx_old  // If available.
-    program_string = "$eip .raSearchStart ^ = "
-                     "$esp .raSearchStart 4 + =";
+    static const std::shared_ptr<const WindowsFrameProgram> no_ebp_program =
+        WindowsFrameProgram::Compile("$eip .raSearchStart ^ = "
+                                     "$esp .raSearchStart 4 + =");
+    static const std::shared_ptr<const WindowsFrameProgram>
+        no_ebp_ebx_program = WindowsFrameProgram::Compile(
+            "$eip .raSearchStart ^ = "
+            "$esp .raSearchStart 4 + = $ebx $ebx =");
     if (last_frame->context_validity & StackFrameX86::CONTEXT_VALID_EBX)
-      program_string += " $ebx $ebx =";
+      program = no_ebp_ebx_program;
+    else
+      program = no_ebp_program;
     recover_ebp = false;
   }
 
@@ -371,24 +394,26 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
   // at the saved return address (ebp + 4).
   // For some more details on this topic, take a look at the following thread:
   // https://groups.google.com/forum/#!topic/google-breakpad-dev/ZP1FA9B1JjM
+  bool aligns = program.get() ? program->aligns() :
+                                program_string.find('@') != string::npos;
   if ((StackFrameX86::CONTEXT_VALID_EBP & last_frame->context_validity) != 0 &&
-      program_string.find('@') != string::npos) {
+      aligns) {
     raSearchStart = last_frame->context.ebp + 4;
   }
 
   // The difference between raSearch and raSearchStart is unknown,
   // but making them the same seems to work well in practice.
-  dictionary[".raSearchStart"] = raSearchStart;
-  dictionary[".raSearch"] = raSearchStart;
+  values.Set(WindowsFrameProgram::RA_SEARCH_START, raSearchStart);
+  values.Set(WindowsFrameProgram::RA_SEARCH, raSearchStart);
 
   // Now crank it out, making sure that the program string set at least the
   // two required variables.
-  PostfixEvaluator<uint32_t> evaluator =
-      PostfixEvaluator<uint32_t>(&dictionary, memory_);
-  PostfixEvaluator<uint32_t>::DictionaryValidityType dictionary_validity;
-  if (!evaluator.Evaluate(program_string, &dictionary_validity) ||
-      dictionary_validity.find("$eip") == dictionary_validity.end() ||
-      dictionary_validity.find("$esp") == dictionary_validity.end()) {
+  bool evaluated = program.get() ?
+      program->Evaluate(*memory_, &values) :
+      WindowsFrameProgram::EvaluateText(program_string, *memory_, &values);
+  if (!evaluated ||
+      !values.Assigned(WindowsFrameProgram::EIP) ||
+      !values.Assigned(WindowsFrameProgram::ESP)) {
     // Program string evaluation failed. It may be that %eip is not somewhere
     // with stack frame info, and %ebp is pointing to non-stack memory, so
     // our evaluation couldn't succeed. We'll scan the stack for a return
@@ -409,8 +434,8 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
     // This seems like a reasonable return address. Since program string
     // evaluation failed, use it and set %esp to the location above the
     // one where the return address was found.
-    dictionary["$eip"] = eip;
-    dictionary["$esp"] = location + 4;
+    values.Set(WindowsFrameProgram::EIP, eip);
+    values.Set(WindowsFrameProgram::ESP, location + 4);
     trust = StackFrame::FRAME_TRUST_SCAN;
   }
 
@@ -421,7 +446,8 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
   // However, if program string evaluation resulted in both %eip and
   // %ebp values of 0, trust that the end of the stack has been
   // reached and don't scan for anything else.
-  if (dictionary["$eip"] != 0 || dictionary["$ebp"] != 0) {
+  if (values.Get(WindowsFrameProgram::EIP) != 0 ||
+      values.Get(WindowsFrameProgram::EBP) != 0) {
     int offset = 0;
 
     // This scan can only be done if a CodeModules object is available, to
@@ -436,11 +462,12 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
     // ability, older OSes (pre-XP SP2) and CPUs (pre-P4) don't enforce
     // an independent execute privilege on memory pages.
 
-    uint32_t eip = dictionary["$eip"];
+    uint32_t eip = values.Get(WindowsFrameProgram::EIP);
     if (modules_ && !modules_->GetModuleForAddress(eip)) {
       // The instruction pointer at .raSearchStart was invalid, so start
       // looking one 32-bit word above that location.
-      uint32_t location_start = dictionary[".raSearchStart"] + 4;
+      uint32_t location_start =
+          values.Get(WindowsFrameProgram::RA_SEARCH_START) + 4;
       uint32_t location;
       if (stack_scan_allowed &&
           ScanForReturnAddress(location_start, &location, &eip,
@@ -449,8 +476,8 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
         // This is a better return address that what program string
         // evaluation found.  Use it, and set %esp to the location above the
         // one where the return address was found.
-        dictionary["$eip"] = eip;
-        dictionary["$esp"] = location + 4;
+        values.Set(WindowsFrameProgram::EIP, eip);
+        values.Set(WindowsFrameProgram::ESP, location + 4);
         offset = location - location_start;
         trust = StackFrame::FRAME_TRUST_CFI_SCAN;
       }
@@ -464,7 +491,7 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
       // stack.  The scan is performed from the highest possible address to
       // the lowest, because the expectation is that the function's prolog
       // would have saved %ebp early.
-      uint32_t ebp = dictionary["$ebp"];
+      uint32_t ebp = values.Get(WindowsFrameProgram::EBP);
 
       // When a scan for return address is used, it is possible to skip one or
       // more frames (when return address is not in a known module).  One
@@ -488,7 +515,7 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
           if (memory_->GetMemoryAtAddress(ebp, &value)) {
             // The candidate value is a pointer to the same memory region
             // (the stack).  Prefer it as a recovered %ebp result.
-            dictionary["$ebp"] = ebp;
+            values.Set(WindowsFrameProgram::EBP, ebp);
             break;
           }
         }
@@ -498,29 +525,29 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
 
   // Create a new stack frame (ownership will be transferred to the caller)
   // and fill it in.
-  StackFrameX86* frame = new StackFrameX86();
+  StackFrameX86* frame = new (frame_pool_) StackFrameX86();
 
   frame->trust = trust;
   frame->context = last_frame->context;
-  frame->context.eip = dictionary["$eip"];
-  frame->context.esp = dictionary["$esp"];
-  frame->context.ebp = dictionary["$ebp"];
+  frame->context.eip = values.Get(WindowsFrameProgram::EIP);
+  frame->context.esp = values.Get(WindowsFrameProgram::ESP);
+  frame->context.ebp = values.Get(WindowsFrameProgram::EBP);
   frame->context_validity = StackFrameX86::CONTEXT_VALID_EIP |
                                 StackFrameX86::CONTEXT_VALID_ESP |
                                 StackFrameX86::CONTEXT_VALID_EBP;
 
   // These are nonvolatile (callee-save) registers, and the program string
   // may have filled them in.
-  if (dictionary_validity.find("$ebx") != dictionary_validity.end()) {
-    frame->context.ebx = dictionary["$ebx"];
+  if (values.Assigned(WindowsFrameProgram::EBX)) {
+    frame->context.ebx = values.Get(WindowsFrameProgram::EBX);
     frame->context_validity |= StackFrameX86::CONTEXT_VALID_EBX;
   }
-  if (dictionary_validity.find("$esi") != dictionary_validity.end()) {
-    frame->context.esi = dictionary["$esi"];
+  if (values.Assigned(WindowsFrameProgram::ESI)) {
+    frame->context.esi = values.Get(WindowsFrameProgram::ESI);
     frame->context_validity |= StackFrameX86::CONTEXT_VALID_ESI;
   }
-  if (dictionary_validity.find("$edi") != dictionary_validity.end()) {
-    frame->context.edi = dictionary["$edi"];
+  if (values.Assigned(WindowsFrameProgram::EDI)) {
+    frame->context.edi = values.Get(WindowsFrameProgram::EDI);
     frame->context_validity |= StackFrameX86::CONTEXT_VALID_EDI;
   }
 
@@ -536,7 +563,7 @@ StackFrameX86* StackwalkerX86::GetCallerByCFIFrameInfo(
   StackFrameX86* last_frame = static_cast<StackFrameX86*>(frames.back());
   last_frame->cfi_frame_info = cfi_frame_info;
 
-  scoped_ptr<StackFrameX86> frame(new StackFrameX86());
+  scoped_ptr<StackFrameX86> frame(new (frame_pool_) StackFrameX86());
   if (!cfi_walker_
       .FindCallerRegisters(*memory_, *cfi_frame_info,
                            last_frame->context, last_frame->context_validity,
@@ -632,7 +659,7 @@ StackFrameX86* StackwalkerX86::GetCallerByEBPAtBase(
 
   // Create a new stack frame (ownership will be transferred to the caller)
   // and fill it in.
-  StackFrameX86* frame = new StackFrameX86();
+  StackFrameX86* frame = new (frame_pool_) StackFrameX86();
 
   frame->trust = trust;
   frame->context = last_frame->context;
@@ -38,6 +38,7 @@
 
 #include "processor/static_map.h"
 #include "processor/static_map_iterator-inl.h"
+#include "processor/static_map_search_index-inl.h"
 #include "processor/logging.h"
 
 namespace google_breakpad {
@@ -54,14 +55,26 @@ StaticMap<Key, Value, Compare>::StaticMap(const char* raw_data)
 
   keys_ = reinterpret_cast<const Key*>(
       raw_data_ + (1 + num_nodes_) * sizeof(uint64_t));
+
+  // A search index, if any, fills the gap between the keys and the values.
+  if (num_nodes_ > 0) {
+    uint64_t keys_end = (1 + num_nodes_) * sizeof(uint64_t) +
+                        num_nodes_ * sizeof(Key);
+    if (offsets_[0] > keys_end) {
+      search_index_.Load(raw_data_ + keys_end, offsets_[0] - keys_end,
+                         num_nodes_);
+    }
+  }
 }
 
-// find(), lower_bound() and upper_bound() implement binary search algorithm.
+// find(), lower_bound() and upper_bound() implement binary search algorithm,
+// confined to a single block of keys if the map has a search index.
 template<typename Key, typename Value, typename Compare>
 StaticMapIterator<Key, Value, Compare>
 StaticMap<Key, Value, Compare>::find(const Key& key) const {
   int64_t begin = 0;
   int64_t end = num_nodes_;
+  search_index_.Narrow(key, false, compare_, &begin, &end);
   int64_t middle;
   int64_t compare_result;
   while (begin < end) {
@@ -83,6 +96,7 @@ StaticMapIterator<Key, Value, Compare>
 StaticMap<Key, Value, Compare>::lower_bound(const Key& key) const {
   int64_t begin = 0;
   int64_t end = num_nodes_;
+  search_index_.Narrow(key, false, compare_, &begin, &end);
   int64_t middle;
   int64_t comp_result;
   while (begin < end) {
@@ -104,6 +118,7 @@ StaticMapIterator<Key, Value, Compare>
 StaticMap<Key, Value, Compare>::upper_bound(const Key& key) const {
   int64_t begin = 0;
   int64_t end = num_nodes_;
+  search_index_.Narrow(key, true, compare_, &begin, &end);
   int64_t middle;
   int64_t compare_result;
   while (begin < end) {
@@ -139,7 +154,8 @@ bool StaticMap<Key, Value, Compare>::ValidateInMemoryStructure() const {
       BPLOG(INFO) << "StaticMap check failed: size exceeds limit";
       return false;
     }
-    if (offsets_[node_index] != static_cast<uint64_t>(first_offset)) {
+    if (offsets_[node_index] !=
+        static_cast<uint64_t>(first_offset) + search_index_.size()) {
       BPLOG(INFO) << "StaticMap check failed: first node offset is incorrect";
       return false;
     }
@@ -158,7 +174,7 @@ bool StaticMap<Key, Value, Compare>::ValidateInMemoryStructure() const {
       return false;
     }
   }
-  return true;
+  return search_index_.Validate(keys_);
 }
 
 template<typename Key, typename Value, typename Compare>
@@ -54,6 +54,11 @@
 //
 // REQUIREMENT: Key type MUST be primitive type or pointers so that:
 // X = sizeof(typename Key);
+//
+// A serializer may place a StaticMapSearchIndex (see
+// static_map_search_index.h) between the key array and the value array to
+// speed up lookups in large maps.  StaticMap detects it at load time from the
+// gap it leaves before node1's mapped_value.
 
 // Author: Siyang Xie (lambxsy@google.com)
 
@@ -62,6 +67,7 @@
 #define PROCESSOR_STATIC_MAP_H__
 
 #include "processor/static_map_iterator-inl.h"
+#include "processor/static_map_search_index.h"
 
 namespace google_breakpad {
 
@@ -113,9 +119,13 @@ class StaticMap {
 
   // Checks if the underlying memory data conforms to the predefined pattern:
   // first check the number of nodes is non-negative,
-  // then check both offsets and keys are strictly increasing (sorted).
+  // then check both offsets and keys are strictly increasing (sorted),
+  // and that the search index, if there is one, agrees with the keys.
   bool ValidateInMemoryStructure() const;
 
+  // Returns true if lookups use a search index.
+  inline bool has_search_index() const { return !search_index_.empty(); }
+
  private:
   const Key GetKeyAtIndex(int64_t i) const;
 
@@ -133,6 +143,9 @@ class StaticMap {
   // keys_[i] = key of i_th node
   const Key* keys_;
 
+  // Optional index that narrows lookups down to one block of keys_.
+  StaticMapSearchIndex<Key> search_index_;
+
   Compare compare_;
 };
 
@@ -0,0 +1,161 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// static_map_search_index-inl.h: StaticMapSearchIndex implementation.
+//
+// See static_map_search_index.h for documentation.
+
+#ifndef PROCESSOR_STATIC_MAP_SEARCH_INDEX_INL_H__
+#define PROCESSOR_STATIC_MAP_SEARCH_INDEX_INL_H__
+
+#include "processor/static_map_search_index.h"
+
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+// static
+template<typename Key>
+size_t StaticMapSearchIndex<Key>::SizeOf(uint64_t num_nodes) {
+  uint64_t num_blocks = NumBlocks(num_nodes);
+  if (num_blocks < kMinBlocks || num_blocks > UINT32_MAX)
+    return 0;
+  uint64_t num_separators = (UINT64_C(1) << Height(num_blocks)) - 1;
+  return kHeaderSize + num_separators * sizeof(Key);
+}
+
+// static
+template<typename Key>
+char* StaticMapSearchIndex<Key>::Write(const Key* sorted_keys,
+                                       uint64_t num_nodes, char* dest) {
+  if (SizeOf(num_nodes) == 0)
+    return dest;
+  uint32_t* header = reinterpret_cast<uint32_t*>(dest);
+  header[0] = kStaticMapSearchIndexMagic;
+  header[1] = static_cast<uint32_t>(kKeysPerBlock);
+  Key* separators = reinterpret_cast<Key*>(dest + kHeaderSize);
+  int height = Height(NumBlocks(num_nodes));
+  uint64_t node = 1;
+  for (int depth = 0; depth < height; ++depth) {
+    for (; node < (UINT64_C(2) << depth); ++node) {
+      separators[node - 1] = LastKeyOf(sorted_keys, num_nodes,
+                                       BlockAt(node, depth, height));
+    }
+  }
+  return reinterpret_cast<char*>(separators + node - 1);
+}
+
+template<typename Key>
+bool StaticMapSearchIndex<Key>::Load(const char* data, uint64_t size,
+                                     int64_t num_nodes) {
+  num_nodes_ = 0;
+  num_blocks_ = 0;
+  height_ = 0;
+  separators_ = NULL;
+  if (num_nodes <= 0 || size < kHeaderSize)
+    return false;
+  const uint32_t* header = reinterpret_cast<const uint32_t*>(data);
+  // An index written for a different block size is ignored rather than
+  // rejected; the sorted keys can always be searched without it.
+  if (header[0] != kStaticMapSearchIndexMagic || header[1] != kKeysPerBlock)
+    return false;
+  uint64_t index_size = SizeOf(num_nodes);
+  if (index_size == 0 || index_size > size)
+    return false;
+  num_nodes_ = num_nodes;
+  num_blocks_ = NumBlocks(num_nodes);
+  height_ = Height(num_blocks_);
+  separators_ = reinterpret_cast<const Key*>(data + kHeaderSize);
+  return true;
+}
+
+template<typename Key>
+template<typename Compare>
+void StaticMapSearchIndex<Key>::Narrow(const Key& key, bool strict,
+                                       const Compare& compare,
+                                       int64_t* begin, int64_t* end) const {
+  if (empty())
+    return;
+  // Go right while the separator is less than |key| (or equal to it, if
+  // |strict|); |node| records the path taken as a bit string.  The tree is
+  // perfect, so every search takes exactly height_ steps.
+  uint64_t num_separators = (UINT64_C(1) << height_) - 1;
+  uint64_t node = 1;
+  for (int step = 0; step < height_; ++step) {
+#if defined(__GNUC__)
+    // The descendants kKeysPerBlock nodes down share one cache line.
+    uint64_t descendant = node * kKeysPerBlock;
+    if (descendant <= num_separators)
+      __builtin_prefetch(separators_ + descendant - 1);
+#endif
+    int64_t result = compare(separators_[node - 1], key);
+    node = 2 * node + (strict ? result <= 0 : result < 0);
+  }
+  // Undo the trailing right turns and the last left turn, which leaves the
+  // node where the search last went left: the first separator satisfying
+  // the bound.  If the search never went left, |node| ends up at 0.
+  int depth = height_;
+  while (node & 1) {
+    node >>= 1;
+    --depth;
+  }
+  node >>= 1;
+  --depth;
+  uint64_t block = node ? BlockAt(node, depth, height_) : num_blocks_;
+  if (block >= num_blocks_) {
+    *begin = *end = num_nodes_;
+    return;
+  }
+  *begin = static_cast<int64_t>(block * kKeysPerBlock);
+  *end = *begin + static_cast<int64_t>(kKeysPerBlock);
+  if (*end > num_nodes_)
+    *end = num_nodes_;
+}
+
+template<typename Key>
+bool StaticMapSearchIndex<Key>::Validate(const Key* sorted_keys) const {
+  if (empty())
+    return true;
+  uint64_t node = 1;
+  for (int depth = 0; depth < height_; ++depth) {
+    for (; node < (UINT64_C(2) << depth); ++node) {
+      Key expected = LastKeyOf(sorted_keys, num_nodes_,
+                               BlockAt(node, depth, height_));
+      if (!(separators_[node - 1] == expected)) {
+        BPLOG(INFO) << "StaticMap check failed: search index separator "
+                       "mismatch";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_STATIC_MAP_SEARCH_INDEX_INL_H__
@@ -0,0 +1,161 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// static_map_search_index.h: StaticMapSearchIndex.
+//
+// StaticMapSearchIndex is an optional, cache friendly search index over the
+// sorted key array of a serialized StaticMap.  A plain binary search over a
+// large key array touches a new cache line on nearly every probe.  The index
+// instead splits the key array into blocks of one cache line's worth of keys
+// and stores the last key of each block in Eytzinger (breadth-first) order,
+// so the first levels of every search share a few hot cache lines and the
+// children of a node are adjacent in memory and can be prefetched.  A search
+// walks the index down to a single block and finishes with a binary search
+// confined to that block.
+//
+// The sorted key array itself is left untouched, so iterators, IteratorAtIndex
+// and readers that don't know about the index keep working.  A serializer
+// that emits the index places it between the key array and the first mapped
+// value, where those readers never look:
+// **************** header ***************
+// uint32 (4 bytes): kStaticMapSearchIndexMagic
+// uint32 (4 bytes): number of keys per block, B
+// ************* Separator array ************
+// (X bytes): last key of a block, for each of the M = ceil(N / B) blocks, in
+//            Eytzinger order: the children of the i-th separator (counting
+//            from 1) are the 2i-th and (2i+1)-th separators.  The array is
+//            padded to a perfect tree of 2^H - 1 separators with copies of
+//            the last key, so a separator's block number follows from its
+//            position and need not be stored.
+//
+// X = sizeof(typename Key); N is the number of nodes in the StaticMap.
+// StaticMap detects the index at load time from the gap it leaves before the
+// first mapped value, so maps with and without an index can be mixed freely.
+
+#ifndef PROCESSOR_STATIC_MAP_SEARCH_INDEX_H__
+#define PROCESSOR_STATIC_MAP_SEARCH_INDEX_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace google_breakpad {
+
+// "BPSI" in little-endian byte order.
+static const uint32_t kStaticMapSearchIndexMagic = 0x49535042;
+
+template<typename Key>
+class StaticMapSearchIndex {
+ public:
+  StaticMapSearchIndex() : num_nodes_(0),
+                           num_blocks_(0),
+                           height_(0),
+                           separators_(NULL) { }
+
+  // Returns the size of the index for a map with |num_nodes| nodes, or 0 if
+  // the map is too small for an index to pay off.  In that case Write writes
+  // nothing and the map is searched with a plain binary search.
+  static size_t SizeOf(uint64_t num_nodes);
+
+  // Writes the index for the |num_nodes| sorted keys at |sorted_keys| to
+  // |dest|, which must have room for SizeOf(num_nodes) bytes.  Returns the
+  // address after the final byte written.
+  static char* Write(const Key* sorted_keys, uint64_t num_nodes, char* dest);
+
+  // Attaches to the index at |data|, which has |size| bytes available before
+  // the first mapped value of a map with |num_nodes| nodes.  Returns false,
+  // leaving the index empty, if those bytes don't hold an index this class
+  // can use.
+  bool Load(const char* data, uint64_t size, int64_t num_nodes);
+
+  inline bool empty() const { return num_blocks_ == 0; }
+
+  // Returns the number of bytes the loaded index occupies.
+  inline uint64_t size() const {
+    return empty() ? 0 : SizeOf(num_nodes_);
+  }
+
+  // Narrows [*begin, *end) to the block of the |num_nodes| sorted keys that
+  // holds the first key not less than |key| (greater than |key| if |strict|),
+  // or to the empty range at the end of the map if there is no such key.
+  // Leaves the range alone if the index is empty.
+  template<typename Compare>
+  void Narrow(const Key& key, bool strict, const Compare& compare,
+              int64_t* begin, int64_t* end) const;
+
+  // Checks that the loaded index agrees with the |num_nodes_| sorted keys at
+  // |sorted_keys|.
+  bool Validate(const Key* sorted_keys) const;
+
+ private:
+  // Number of keys per block: one cache line's worth.
+  static const uint64_t kKeysPerBlock =
+      sizeof(Key) >= 64 ? 1 : 64 / sizeof(Key);
+
+  // Maps with fewer blocks than this are searched without an index.
+  static const uint64_t kMinBlocks = 16;
+
+  // Size of the index header.
+  static const size_t kHeaderSize = 2 * sizeof(uint32_t);
+
+  // Returns the number of blocks of a map with |num_nodes| nodes.
+  static uint64_t NumBlocks(uint64_t num_nodes) {
+    return (num_nodes + kKeysPerBlock - 1) / kKeysPerBlock;
+  }
+
+  // Returns the height of the smallest perfect tree with |num_blocks| nodes.
+  static int Height(uint64_t num_blocks) {
+    int height = 0;
+    while ((UINT64_C(1) << height) - 1 < num_blocks)
+      ++height;
+    return height;
+  }
+
+  // Returns the block number of the separator at |node| (counting from 1),
+  // which is at depth |depth| of a perfect tree of height |height|.  Padding
+  // separators get numbers beyond the last block.
+  static uint64_t BlockAt(uint64_t node, int depth, int height) {
+    return ((2 * (node - (UINT64_C(1) << depth)) + 1) <<
+            (height - 1 - depth)) - 1;
+  }
+
+  // Returns the last key of |block|, or the last key of the map for padding.
+  static Key LastKeyOf(const Key* sorted_keys, uint64_t num_nodes,
+                       uint64_t block) {
+    uint64_t last = (block + 1) * kKeysPerBlock - 1;
+    return sorted_keys[last < num_nodes ? last : num_nodes - 1];
+  }
+
+  int64_t num_nodes_;
+  uint64_t num_blocks_;
+  int height_;
+  const Key* separators_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_STATIC_MAP_SEARCH_INDEX_H__
@@ -39,6 +39,8 @@
 #include <map>
 
 #include "breakpad_googletest_includes.h"
+#include "processor/map_serializers-inl.h"
+#include "processor/simple_serializer-inl.h"
 #include "processor/static_map-inl.h"
 
 
@@ -383,6 +385,87 @@ TEST_F(TestValidMap, Test1000RandomElements) {
   LookupTester(test_case);
 }
 
+// Maps serialized with a search index must answer every lookup exactly as
+// the same maps serialized without one.
+TEST(TestSearchIndex, LookupsMatchPlainMap) {
+  const int kSizes[] = { 0, 1, 100, 240, 241, 1000, 4099 };
+  for (int num_nodes : kSizes) {
+    SCOPED_TRACE(num_nodes);
+    StdMap std_map;
+    for (int i = 0; i < num_nodes; ++i)
+      std_map.insert(std::make_pair(i * 3 - 50, i));
+
+    google_breakpad::StdMapSerializer<KeyType, ValueType> serializer;
+    uint64_t plain_size = 0;
+    char* plain_data = serializer.Serialize(std_map, &plain_size);
+    serializer.set_search_index(true);
+    uint64_t indexed_size = 0;
+    char* indexed_data = serializer.Serialize(std_map, &indexed_size);
+    TestMap plain_map(plain_data);
+    TestMap indexed_map(indexed_data);
+
+    ASSERT_FALSE(plain_map.has_search_index());
+    // Maps of fewer than 16 blocks of 16 keys are written without an index
+    // even when asked for one.
+    ASSERT_EQ(num_nodes > 240, indexed_map.has_search_index());
+    ASSERT_EQ(indexed_map.has_search_index(), indexed_size > plain_size);
+    ASSERT_TRUE(indexed_map.ValidateInMemoryStructure());
+
+    for (KeyType key = -55; key < num_nodes * 3 - 45; ++key) {
+      TestMap::iterator plain_iter = plain_map.find(key);
+      TestMap::iterator indexed_iter = indexed_map.find(key);
+      ASSERT_EQ(plain_iter == plain_map.end(),
+                indexed_iter == indexed_map.end());
+      if (plain_iter != plain_map.end())
+        ASSERT_EQ(*plain_iter.GetValuePtr(), *indexed_iter.GetValuePtr());
+
+      plain_iter = plain_map.lower_bound(key);
+      indexed_iter = indexed_map.lower_bound(key);
+      ASSERT_EQ(plain_iter == plain_map.end(),
+                indexed_iter == indexed_map.end());
+      if (plain_iter != plain_map.end())
+        ASSERT_EQ(*plain_iter.GetValuePtr(), *indexed_iter.GetValuePtr());
+
+      plain_iter = plain_map.upper_bound(key);
+      indexed_iter = indexed_map.upper_bound(key);
+      ASSERT_EQ(plain_iter == plain_map.end(),
+                indexed_iter == indexed_map.end());
+      if (plain_iter != plain_map.end())
+        ASSERT_EQ(*plain_iter.GetValuePtr(), *indexed_iter.GetValuePtr());
+    }
+    delete [] plain_data;
+    delete [] indexed_data;
+  }
+}
+
+TEST(TestSearchIndex, CorruptIndex) {
+  StdMap std_map;
+  for (int i = 0; i < 1000; ++i)
+    std_map.insert(std::make_pair(i, i));
+  google_breakpad::StdMapSerializer<KeyType, ValueType> serializer;
+  serializer.set_search_index(true);
+  char* data = serializer.Serialize(std_map, NULL);
+  char* index = data + sizeof(uint64_t) +
+                std_map.size() * (sizeof(uint64_t) + sizeof(KeyType));
+  ASSERT_TRUE(TestMap(data).has_search_index());
+
+  // A wrong separator is caught by validation.
+  KeyType* separators = reinterpret_cast<KeyType*>(index + 8);
+  ++separators[0];
+  ASSERT_FALSE(TestMap(data).ValidateInMemoryStructure());
+  --separators[0];
+  ASSERT_TRUE(TestMap(data).ValidateInMemoryStructure());
+
+  // Without the magic number the gap is not an index, so lookups fall back
+  // to binary search but the offsets no longer validate.
+  memset(index, 0, 4);
+  TestMap map(data);
+  ASSERT_FALSE(map.has_search_index());
+  ASSERT_FALSE(map.ValidateInMemoryStructure());
+  ASSERT_EQ(500, *map.find(500).GetValuePtr());
+  delete [] data;
+}
+
 int main(int argc, char *argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -0,0 +1,127 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// static_nested_range_index.h: StaticNestedRangeIndex.
+//
+// StaticNestedRangeIndex reads a NestedRangeIndex in place, as
+// NestedRangeIndexSerializer wrote it, and provides the same
+// RetrieveRange(...) interfaces.  The serialized index is laid out as:
+//   uint64_t count;
+//   NestedRange<AddressType> ranges[count];
+//   uint64_t entry_offsets[count];  // from the end of this array
+//   serialized entries
+//
+// Please see nested_range_index.h for more documentation.
+
+#ifndef PROCESSOR_STATIC_NESTED_RANGE_INDEX_H__
+#define PROCESSOR_STATIC_NESTED_RANGE_INDEX_H__
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "processor/nested_range_index-inl.h"
+
+namespace google_breakpad {
+
+template<typename AddressType, typename EntryType>
+class StaticNestedRangeIndex {
+ public:
+  StaticNestedRangeIndex()
+      : count_(0), ranges_(NULL), entry_offsets_(NULL), entries_(NULL) {}
+  explicit StaticNestedRangeIndex(const char* base);
+
+  // Retrieves the serialized entry of the innermost range containing
+  // |address|.  Returns false if no range contains it.
+  bool RetrieveRange(const AddressType& address, const EntryType*& entry) const;
+
+  // Retrieves the serialized entries of the ranges containing |address|,
+  // from the innermost to the outermost.
+  bool RetrieveRanges(const AddressType& address,
+                      std::vector<const EntryType*>& entries) const;
+
+  // Calls |visit| with the serialized entry of each range containing
+  // |address|, from the innermost to the outermost, without allocating.
+  // Returns false if no range contains it.
+  template<typename Visitor>
+  bool VisitRanges(const AddressType& address, Visitor visit) const {
+    int32_t index = FindInnermostNestedRange(ranges_, count_, address);
+    if (index < 0)
+      return false;
+    for (; index >= 0; index = ranges_[index].parent)
+      visit(GetEntry(index));
+    return true;
+  }
+
+ private:
+  const EntryType* GetEntry(int32_t index) const {
+    return reinterpret_cast<const EntryType*>(entries_ +
+                                              entry_offsets_[index]);
+  }
+
+  uint64_t count_;
+  const NestedRange<AddressType>* ranges_;
+  const uint64_t* entry_offsets_;
+  const char* entries_;
+};
+
+template<typename AddressType, typename EntryType>
+StaticNestedRangeIndex<AddressType, EntryType>::StaticNestedRangeIndex(
+    const char* base)
+    : count_(*reinterpret_cast<const uint64_t*>(base)),
+      ranges_(reinterpret_cast<const NestedRange<AddressType>*>(
+          base + sizeof(count_))),
+      entry_offsets_(reinterpret_cast<const uint64_t*>(ranges_ + count_)),
+      entries_(reinterpret_cast<const char*>(entry_offsets_ + count_)) {}
+
+template<typename AddressType, typename EntryType>
+bool StaticNestedRangeIndex<AddressType, EntryType>::RetrieveRange(
+    const AddressType& address, const EntryType*& entry) const {
+  int32_t index = FindInnermostNestedRange(ranges_, count_, address);
+  if (index < 0)
+    return false;
+  entry = GetEntry(index);
+  return true;
+}
+
+template<typename AddressType, typename EntryType>
+bool StaticNestedRangeIndex<AddressType, EntryType>::RetrieveRanges(
+    const AddressType& address,
+    std::vector<const EntryType*>& entries) const {
+  int32_t index = FindInnermostNestedRange(ranges_, count_, address);
+  if (index < 0)
+    return false;
+  entries.reserve(entries.size() + ranges_[index].depth + 1);
+  for (; index >= 0; index = ranges_[index].parent)
+    entries.push_back(GetEntry(index));
+  return true;
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_STATIC_NESTED_RANGE_INDEX_H__
@@ -0,0 +1,117 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// string_pool.cc: StringPool implementation.
+//
+// See string_pool.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/string_pool.h"
+
+#include <stdint.h>
+#include <string.h>
+
+
+namespace google_breakpad {
+
+namespace {
+
+const size_t kInitialIndexSize = 1024;
+
+// FNV-1a.
+uint64_t Hash(const char* data, size_t length) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+}  // namespace
+
+StringPool::StringPool() : index_count_(0) {}
+
+StringView StringPool::Add(StringView str) {
+  if (str.empty())
+    return StringView();
+
+  if (index_.empty())
+    index_.resize(kInitialIndexSize, IndexSlot());
+  size_t mask = index_.size() - 1;
+  size_t slot = Hash(str.data(), str.size()) & mask;
+  while (index_[slot].data) {
+    if (index_[slot].length == str.size() &&
+        memcmp(index_[slot].data, str.data(), str.size()) == 0) {
+      return StringView(index_[slot].data, index_[slot].length);
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  char* copy = static_cast<char*>(storage_.Allocate(str.size() + 1, 1));
+  memcpy(copy, str.data(), str.size());
+  copy[str.size()] = '\0';
+  index_[slot].data = copy;
+  index_[slot].length = str.size();
+  if (++index_count_ * 2 > index_.size())
+    GrowIndex();
+  return StringView(copy, str.size());
+}
+
+void StringPool::Adopt(StringPool* other) {
+  storage_.Adopt(&other->storage_);
+  other->ReleaseIndex();
+}
+
+void StringPool::ReleaseIndex() {
+  std::vector<IndexSlot>().swap(index_);
+  index_count_ = 0;
+}
+
+size_t StringPool::allocated_bytes() const {
+  return storage_.allocated_bytes() + index_.capacity() * sizeof(IndexSlot);
+}
+
+void StringPool::GrowIndex() {
+  std::vector<IndexSlot> old_index(index_.size() * 2, IndexSlot());
+  old_index.swap(index_);
+  size_t mask = index_.size() - 1;
+  for (const IndexSlot& entry : old_index) {
+    if (!entry.data)
+      continue;
+    size_t slot = Hash(entry.data, entry.length) & mask;
+    while (index_[slot].data)
+      slot = (slot + 1) & mask;
+    index_[slot] = entry;
+  }
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,93 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// string_pool.h: StringPool, an arena of interned strings.
+//
+// StringPool copies strings into an Arena and hands out StringViews of the
+// copies, giving equal strings the same copy.  The names and file paths of a
+// loaded symbol module live in one pool, so each costs a single null
+// terminated copy next to the others instead of an std::string heap
+// allocation per record, and they are all freed at once with the pool.
+
+#ifndef PROCESSOR_STRING_POOL_H__
+#define PROCESSOR_STRING_POOL_H__
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "common/string_view.h"
+#include "processor/arena.h"
+
+namespace google_breakpad {
+
+class StringPool {
+ public:
+  StringPool();
+
+  // Returns a view of a copy of |str| that stays valid, and is followed by
+  // a null terminator, for the lifetime of the pool.  Returns the same view
+  // for strings equal to one added earlier, unless that was before the last
+  // ReleaseIndex call or was added to another pool and adopted.
+  StringView Add(StringView str);
+
+  // Moves the strings of |other| into this pool, leaving |other| empty.
+  // Views of the moved strings stay valid.  Used to gather the strings of
+  // symbol file sections parsed on separate threads into one pool.
+  void Adopt(StringPool* other);
+
+  // Frees the index Add uses to find equal strings, for when no more
+  // strings are expected.  Strings added afterwards are stored as new
+  // copies.
+  void ReleaseIndex();
+
+  // Returns the number of bytes the pool has allocated for its strings and
+  // index.
+  size_t allocated_bytes() const;
+
+ private:
+  // A slot of the open addressing index of the pool's strings.  |data| is
+  // NULL for an empty slot.
+  struct IndexSlot {
+    const char* data;
+    size_t length;
+  };
+
+  // Doubles the index capacity, rehashing the strings it holds.
+  void GrowIndex();
+
+  Arena storage_;
+
+  // Power of two sized, and kept at most half full.
+  std::vector<IndexSlot> index_;
+  size_t index_count_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_STRING_POOL_H__
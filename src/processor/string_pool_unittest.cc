@@ -0,0 +1,105 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// string_pool_unittest.cc: Unit tests for StringPool.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/string_pool.h"
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+
+namespace {
+
+using google_breakpad::StringPool;
+using google_breakpad::StringView;
+using std::string;
+
+TEST(StringPool, CopiesAndTerminates) {
+  StringPool pool;
+  char text[] = "function(int) const";
+  StringView added = pool.Add(StringView(text, 8));
+  text[0] = 'X';
+  EXPECT_EQ("function", added.str());
+  EXPECT_NE(text, added.data());
+  EXPECT_EQ('\0', added.data()[added.size()]);
+  EXPECT_TRUE(pool.Add("").empty());
+}
+
+TEST(StringPool, InternsEqualStrings) {
+  StringPool pool;
+  string name = "std::vector<int, std::allocator<int> >::push_back";
+  StringView first = pool.Add(name);
+  StringView second = pool.Add(string(name));
+  EXPECT_EQ(first.data(), second.data());
+  EXPECT_NE(first.data(), pool.Add("std::vector").data());
+
+  // Many strings, to grow the index and use several blocks, stay interned.
+  std::vector<StringView> views;
+  for (int i = 0; i < 20000; ++i)
+    views.push_back(pool.Add("name" + std::to_string(i)));
+  for (int i = 0; i < 20000; ++i) {
+    StringView view = pool.Add("name" + std::to_string(i));
+    ASSERT_EQ(views[i].data(), view.data());
+    ASSERT_EQ("name" + std::to_string(i), view.str());
+  }
+  EXPECT_EQ(first.data(), pool.Add(name).data());
+
+  // Strings too long to share a block are kept too.
+  string long_name(100000, 'x');
+  StringView long_view = pool.Add(long_name);
+  EXPECT_EQ(long_name, long_view.str());
+  EXPECT_EQ(long_view.data(), pool.Add(long_name).data());
+}
+
+TEST(StringPool, AdoptKeepsViews) {
+  StringPool pool;
+  StringPool other;
+  StringView kept = pool.Add("kept");
+  StringView moved = other.Add("moved");
+  size_t other_bytes = other.allocated_bytes();
+  pool.Adopt(&other);
+  EXPECT_EQ(0U, other.allocated_bytes());
+  EXPECT_GE(pool.allocated_bytes(), other_bytes);
+  EXPECT_EQ("kept", kept.str());
+  EXPECT_EQ("moved", moved.str());
+  EXPECT_EQ(kept.data(), pool.Add("kept").data());
+
+  // Adopted strings aren't indexed, and nothing is once the index is gone.
+  EXPECT_NE(moved.data(), pool.Add("moved").data());
+  pool.ReleaseIndex();
+  EXPECT_NE(kept.data(), pool.Add("kept").data());
+  EXPECT_EQ("kept", kept.str());
+}
+
+}  // namespace
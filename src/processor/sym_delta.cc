@@ -0,0 +1,144 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// sym_delta.cc: Write a symbol file as a delta against the symbol file of
+// an earlier build of the same module, or turn a delta back into the
+// symbol file it stands for.  See processor/symbol_delta.h.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+
+#include "common/block_gzip.h"
+#include "common/path_helper.h"
+#include "common/using_std_string.h"
+#include "processor/symbol_delta.h"
+
+namespace {
+
+using google_breakpad::SymbolDelta;
+
+bool ReadFile(const char* path, string* contents) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    fprintf(stderr, "Could not open %s\n", path);
+    return false;
+  }
+  std::getline(in, *contents, string::traits_type::to_char_type(
+                   string::traits_type::eof()));
+  if (google_breakpad::IsGzipData(contents->data(), contents->size())) {
+    char* data;
+    size_t size;
+    if (!google_breakpad::GunzipData(contents->data(), contents->size(), 1,
+                                     &data, &size)) {
+      fprintf(stderr, "Could not decompress %s\n", path);
+      return false;
+    }
+    // Drop the terminator GunzipData adds.
+    contents->assign(data, size - 1);
+    delete [] data;
+  }
+  return true;
+}
+
+bool WriteOutput(const string& contents) {
+  return fwrite(contents.data(), 1, contents.size(), stdout) ==
+             contents.size() &&
+         fflush(stdout) == 0;
+}
+
+void Usage(int argc, const char* argv[], bool error) {
+  fprintf(error ? stderr : stdout,
+          "Usage: %s <base.sym> <base-path> <target.sym>\n"
+          "       %s -a <base.sym> <delta>\n"
+          "\n"
+          "Print <target.sym> as a delta against <base.sym>, which is\n"
+          "stored at <base-path> relative to the root of the symbol store,\n"
+          "for example app/<identifier>/app.sym.  Store the delta next\n"
+          "to where <target.sym> would be, with a further .delta\n"
+          "extension, for SimpleSymbolSupplier to find it.\n"
+          "\n"
+          "Options:\n"
+          "\n"
+          "  -a  Apply <delta> to <base.sym>, and print the symbol file\n",
+          google_breakpad::BaseName(argv[0]).c_str(),
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  bool apply = false;
+  int ch;
+  while ((ch = getopt(argc, (char * const*)argv, "ah")) != -1) {
+    switch (ch) {
+      case 'a':
+        apply = true;
+        break;
+      case 'h':
+        Usage(argc, argv, false);
+        return 0;
+      default:
+        Usage(argc, argv, true);
+        return 1;
+    }
+  }
+  if (argc - optind != (apply ? 2 : 3)) {
+    Usage(argc, argv, true);
+    return 1;
+  }
+
+  string base;
+  if (!ReadFile(argv[optind], &base))
+    return 1;
+  if (apply) {
+    string delta, target;
+    if (!ReadFile(argv[optind + 1], &delta))
+      return 1;
+    if (!SymbolDelta::Apply(delta, base, &target)) {
+      fprintf(stderr, "%s is not a delta against %s\n", argv[optind + 1],
+              argv[optind]);
+      return 1;
+    }
+    return WriteOutput(target) ? 0 : 1;
+  }
+
+  string target, delta;
+  if (!ReadFile(argv[optind + 2], &target))
+    return 1;
+  SymbolDelta::Create(base, argv[optind + 1], target, &delta);
+  return WriteOutput(delta) ? 0 : 1;
+}
@@ -0,0 +1,470 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// symbol_delta.cc: Symbol files expressed as deltas against other symbol
+// files.
+//
+// See symbol_delta.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/symbol_delta.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/linux/crc32.h"
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+namespace {
+
+using std::string_view;
+using std::vector;
+
+const char kMagic[] = "SYMDELTA";
+const int kVersion = 1;
+
+// The most base lines with the same shape tried for a target line that
+// doesn't continue the current run, and the most lines each is followed
+// for to pick the longest run.
+const size_t kMaxCandidates = 8;
+const size_t kMaxLookahead = 32;
+
+// An address field of a line: its position and length in the line, and
+// its value.
+struct AddressField {
+  size_t start;
+  size_t length;
+  uint64_t value;
+};
+
+// Splits |data| at newlines.  The last line is empty if |data| ends with
+// a newline, so joining the lines with newlines gives |data| back.
+void SplitLines(string_view data, vector<string_view>* lines) {
+  size_t start = 0;
+  for (;;) {
+    size_t end = data.find('\n', start);
+    if (end == string_view::npos) {
+      lines->push_back(data.substr(start));
+      return;
+    }
+    lines->push_back(data.substr(start, end - start));
+    start = end + 1;
+  }
+}
+
+bool ParseHex(string_view text, uint64_t* value) {
+  if (text.empty() || text.size() > 16)
+    return false;
+  *value = 0;
+  for (char c : text) {
+    int digit;
+    if (c >= '0' && c <= '9')
+      digit = c - '0';
+    else if (c >= 'a' && c <= 'f')
+      digit = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      digit = c - 'A' + 10;
+    else
+      return false;
+    *value = (*value << 4) | digit;
+  }
+  return true;
+}
+
+bool ParseDecimal(string_view text, uint64_t* value) {
+  if (text.empty() || text.size() > 19)
+    return false;
+  *value = 0;
+  for (char c : text) {
+    if (c < '0' || c > '9')
+      return false;
+    *value = *value * 10 + (c - '0');
+  }
+  return true;
+}
+
+// Sets |fields| to the address fields of |line|, a symbol file record.
+void FindAddressFields(string_view line, vector<AddressField>* fields) {
+  fields->clear();
+  vector<string_view> tokens;
+  size_t start = 0;
+  while (start < line.size()) {
+    size_t end = line.find(' ', start);
+    if (end == string_view::npos)
+      end = line.size();
+    tokens.push_back(line.substr(start, end - start));
+    start = end + 1;
+  }
+  if (tokens.empty())
+    return;
+
+  vector<size_t> indexes;
+  if (tokens[0] == "FUNC" || tokens[0] == "PUBLIC") {
+    indexes.push_back(tokens.size() > 1 && tokens[1] == "m" ? 2 : 1);
+  } else if (tokens[0] == "STACK") {
+    if (tokens.size() > 2 && tokens[1] == "CFI")
+      indexes.push_back(tokens[2] == "INIT" ? 3 : 2);
+    else if (tokens.size() > 1 && tokens[1] == "WIN")
+      indexes.push_back(3);
+  } else if (tokens[0] == "INLINE") {
+    // INLINE <depth> <line> <file> <origin> [<address> <size>]+
+    for (size_t i = 5; i + 1 < tokens.size(); i += 2)
+      indexes.push_back(i);
+  } else if (tokens[0] != "MODULE" && tokens[0] != "FILE" &&
+             tokens[0] != "INFO" && tokens[0] != "INLINE_ORIGIN") {
+    // A line record.
+    indexes.push_back(0);
+  }
+
+  for (size_t index : indexes) {
+    AddressField field;
+    if (index >= tokens.size() || !ParseHex(tokens[index], &field.value))
+      continue;
+    field.start = tokens[index].data() - line.data();
+    field.length = tokens[index].size();
+    fields->push_back(field);
+  }
+}
+
+// Returns |line| with its address fields |fields| removed, so that lines
+// that differ only in their addresses have the same shape.
+string Shape(string_view line, const vector<AddressField>& fields) {
+  string shape;
+  size_t position = 0;
+  for (const AddressField& field : fields) {
+    shape.append(line.data() + position, field.start - position);
+    position = field.start + field.length;
+  }
+  shape.append(line.data() + position, line.size() - position);
+  return shape;
+}
+
+// Appends |line| to |output| with |shift| added to its address fields
+// |fields|.
+void AppendShifted(string_view line, const vector<AddressField>& fields,
+                   uint64_t shift, string* output) {
+  size_t position = 0;
+  for (const AddressField& field : fields) {
+    output->append(line.data() + position, field.start - position);
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%" PRIx64, field.value + shift);
+    output->append(buffer);
+    position = field.start + field.length;
+  }
+  output->append(line.data() + position, line.size() - position);
+}
+
+// The lines of a symbol file, with their address fields found as needed.
+class LineTable {
+ public:
+  explicit LineTable(string_view data) {
+    SplitLines(data, &lines_);
+    fields_.resize(lines_.size());
+    found_.resize(lines_.size(), false);
+  }
+
+  size_t size() const { return lines_.size(); }
+  string_view line(size_t i) const { return lines_[i]; }
+
+  const vector<AddressField>& fields(size_t i) {
+    if (!found_[i]) {
+      FindAddressFields(lines_[i], &fields_[i]);
+      found_[i] = true;
+    }
+    return fields_[i];
+  }
+
+ private:
+  vector<string_view> lines_;
+  vector<vector<AddressField>> fields_;
+  vector<bool> found_;
+};
+
+// A run of copied lines being built.
+struct Run {
+  size_t first;
+  size_t count;
+  uint64_t shift;
+  // False until a line with addresses is copied; until then, any shift
+  // will do.
+  bool shift_known;
+};
+
+// Returns true if target line |t| is base line |b| shifted by the shift
+// of |run|, or by any shift if it isn't known yet.  Updates |run|'s shift
+// from the lines if so.
+bool Continues(LineTable* base, size_t b, LineTable* target, size_t t,
+               Run* run) {
+  const vector<AddressField>& base_fields = base->fields(b);
+  const vector<AddressField>& target_fields = target->fields(t);
+  if (base_fields.size() != target_fields.size())
+    return false;
+  if (base_fields.empty())
+    return base->line(b) == target->line(t);
+  uint64_t shift = target_fields[0].value - base_fields[0].value;
+  if (run->shift_known && shift != run->shift)
+    return false;
+  // Unshifted lines are copied as they are, so they must match as they
+  // are.
+  if (shift == 0 && base->line(b) != target->line(t))
+    return false;
+  string shifted;
+  AppendShifted(base->line(b), base_fields, shift, &shifted);
+  if (shifted != target->line(t))
+    return false;
+  run->shift = shift;
+  run->shift_known = true;
+  return true;
+}
+
+void AppendCopy(const Run& run, string* delta) {
+  char buffer[80];
+  uint64_t shift = run.shift_known ? run.shift : 0;
+  bool negative = static_cast<int64_t>(shift) < 0;
+  snprintf(buffer, sizeof(buffer), "C %zu %zu %s%" PRIx64 "\n",
+           run.first, run.count, negative ? "-" : "",
+           negative ? 0 - shift : shift);
+  delta->append(buffer);
+}
+
+void AppendInsert(LineTable* target, size_t first, size_t count,
+                  string* delta) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "I %zu\n", count);
+  delta->append(buffer);
+  for (size_t i = first; i < first + count; ++i) {
+    delta->append(target->line(i).data(), target->line(i).size());
+    delta->push_back('\n');
+  }
+}
+
+}  // namespace
+
+// static
+void SymbolDelta::Create(const string& base, const string& base_path,
+                         const string& target, string* delta) {
+  LineTable base_lines(base);
+  LineTable target_lines(target);
+
+  // The base lines of each shape, in order.
+  std::unordered_map<string, vector<size_t>> shapes;
+  for (size_t b = 0; b < base_lines.size(); ++b)
+    shapes[Shape(base_lines.line(b), base_lines.fields(b))].push_back(b);
+
+  char header[64];
+  snprintf(header, sizeof(header), "%s %d %zu %08x ", kMagic, kVersion,
+           base.size(), ComputeCrc32(base));
+  delta->assign(header);
+  delta->append(base_path);
+  delta->push_back('\n');
+
+  bool in_run = false;
+  Run run = {0, 0, 0, false};
+  size_t insert_first = 0, insert_count = 0;
+  for (size_t t = 0; t < target_lines.size(); ++t) {
+    // The base line after the last run, where the next run most likely
+    // starts.
+    size_t next = run.first + run.count;
+    if (in_run && next < base_lines.size() &&
+        Continues(&base_lines, next, &target_lines, t, &run)) {
+      ++run.count;
+      continue;
+    }
+
+    // Look for the base line that starts the longest run, among those of
+    // the same shape that follow the last run.
+    Run best = {0, 0, 0, false};
+    auto shape = shapes.find(Shape(target_lines.line(t),
+                                   target_lines.fields(t)));
+    if (shape != shapes.end()) {
+      const vector<size_t>& candidates = shape->second;
+      size_t start = std::lower_bound(candidates.begin(), candidates.end(),
+                                      next) - candidates.begin();
+      if (start + kMaxCandidates > candidates.size())
+        start = candidates.size() > kMaxCandidates
+                    ? candidates.size() - kMaxCandidates
+                    : 0;
+      for (size_t c = start;
+           c < candidates.size() && c < start + kMaxCandidates; ++c) {
+        Run candidate = {candidates[c], 0, 0, false};
+        while (candidate.count < kMaxLookahead &&
+               candidate.first + candidate.count < base_lines.size() &&
+               t + candidate.count < target_lines.size() &&
+               Continues(&base_lines, candidate.first + candidate.count,
+                         &target_lines, t + candidate.count, &candidate)) {
+          ++candidate.count;
+        }
+        if (candidate.count > best.count)
+          best = candidate;
+      }
+    }
+
+    if (in_run) {
+      AppendCopy(run, delta);
+      in_run = false;
+    }
+    if (best.count == 0) {
+      if (insert_count == 0)
+        insert_first = t;
+      ++insert_count;
+      continue;
+    }
+    if (insert_count != 0) {
+      AppendInsert(&target_lines, insert_first, insert_count, delta);
+      insert_count = 0;
+    }
+    // Continue the run from its first line, as the lookahead may have
+    // stopped before its end.
+    run = best;
+    run.count = 1;
+    in_run = true;
+  }
+  if (in_run)
+    AppendCopy(run, delta);
+  if (insert_count != 0)
+    AppendInsert(&target_lines, insert_first, insert_count, delta);
+}
+
+// static
+bool SymbolDelta::GetBasePath(const string& data, string* base_path) {
+  // SYMDELTA <version> <size> <crc32> <path>
+  size_t magic_length = sizeof(kMagic) - 1;
+  if (data.compare(0, magic_length, kMagic) != 0 ||
+      data.size() <= magic_length || data[magic_length] != ' ')
+    return false;
+  size_t end = data.find('\n');
+  if (end == string::npos)
+    return false;
+  size_t start = magic_length;
+  for (int field = 0; field < 3; ++field) {
+    start = data.find(' ', start + 1);
+    if (start == string::npos || start > end)
+      return false;
+  }
+  base_path->assign(data, start + 1, end - start - 1);
+  return true;
+}
+
+// static
+bool SymbolDelta::Apply(const string& delta, const string& base,
+                        string* target) {
+  target->clear();
+  vector<string_view> lines;
+  SplitLines(delta, &lines);
+  // The header and the empty line after the final newline.
+  if (lines.size() < 2 || !lines.back().empty())
+    return false;
+
+  vector<string_view> header;
+  size_t start = 0;
+  for (int field = 0; field < 4; ++field) {
+    size_t end = lines[0].find(' ', start);
+    if (end == string_view::npos)
+      return false;
+    header.push_back(lines[0].substr(start, end - start));
+    start = end + 1;
+  }
+  uint64_t version, size, crc;
+  if (header[0] != kMagic || !ParseDecimal(header[1], &version) ||
+      version != kVersion || !ParseDecimal(header[2], &size) ||
+      !ParseHex(header[3], &crc)) {
+    return false;
+  }
+  if (size != base.size() || crc != ComputeCrc32(base))
+    return false;
+
+  LineTable base_lines(base);
+  bool first_line = true;
+  size_t i = 1;
+  while (i + 1 < lines.size()) {
+    string_view op = lines[i++];
+    if (op.size() < 2 || op[1] != ' ')
+      return false;
+    if (op[0] == 'I') {
+      uint64_t count;
+      if (!ParseDecimal(op.substr(2), &count) ||
+          count > lines.size() - 1 - i)
+        return false;
+      for (uint64_t j = 0; j < count; ++j, ++i) {
+        if (!first_line)
+          target->push_back('\n');
+        target->append(lines[i].data(), lines[i].size());
+        first_line = false;
+      }
+    } else if (op[0] == 'C') {
+      string_view args = op.substr(2);
+      size_t space1 = args.find(' ');
+      size_t space2 = space1 == string_view::npos
+                          ? space1
+                          : args.find(' ', space1 + 1);
+      if (space2 == string_view::npos)
+        return false;
+      uint64_t first, count, shift;
+      string_view shift_text = args.substr(space2 + 1);
+      bool negative = !shift_text.empty() && shift_text[0] == '-';
+      if (negative)
+        shift_text.remove_prefix(1);
+      if (!ParseDecimal(args.substr(0, space1), &first) ||
+          !ParseDecimal(args.substr(space1 + 1, space2 - space1 - 1),
+                        &count) ||
+          !ParseHex(shift_text, &shift) ||
+          first > base_lines.size() || count > base_lines.size() - first)
+        return false;
+      if (negative)
+        shift = 0 - shift;
+      for (uint64_t b = first; b < first + count; ++b) {
+        if (!first_line)
+          target->push_back('\n');
+        if (shift == 0) {
+          target->append(base_lines.line(b).data(), base_lines.line(b).size());
+        } else {
+          AppendShifted(base_lines.line(b), base_lines.fields(b), shift,
+                        target);
+        }
+        first_line = false;
+      }
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace google_breakpad
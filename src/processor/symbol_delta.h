@@ -0,0 +1,84 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// symbol_delta.h: Symbol files expressed as deltas against other symbol
+// files.
+//
+// The symbol files of consecutive builds of a module are mostly the same,
+// except that code added or removed moves everything after it to another
+// address.  A delta records a symbol file as runs of lines copied from a
+// base symbol file, each with the addresses in it shifted by one amount,
+// and the lines that have no counterpart in the base.  It looks like:
+//
+// SYMDELTA 1 <base size> <base crc32> <base path>
+// C <first base line> <line count> <address shift>
+// I <line count>
+// <line count lines of the symbol file>
+// ...
+//
+// Lines are numbered from 0.  The shift is written in hexadecimal, with a
+// '-' sign if negative.  The base path is the base symbol file's path
+// relative to the root of the symbol store, as SimpleSymbolSupplier lays
+// them out, so a delta can be stored next to the symbol file it stands
+// for; see simple_symbol_supplier.h.  The base's size and checksum are
+// checked before the delta is applied to it.
+//
+// A copied line's addresses are the address fields of its record: the
+// address of a FUNC, PUBLIC, STACK CFI or line record, the RVA of a
+// STACK WIN record and the range starts of an INLINE record.
+
+#ifndef PROCESSOR_SYMBOL_DELTA_H__
+#define PROCESSOR_SYMBOL_DELTA_H__
+
+#include <string>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class SymbolDelta {
+ public:
+  // Sets |delta| to a delta that turns |base|, the symbol file stored at
+  // |base_path|, into |target|.
+  static void Create(const string& base, const string& base_path,
+                     const string& target, string* delta);
+
+  // Returns true if |data| is a delta, setting |base_path| to the path of
+  // its base.
+  static bool GetBasePath(const string& data, string* base_path);
+
+  // Applies |delta| to |base|, setting |target| to the symbol file it
+  // stands for.  Returns false if |delta| is malformed or was made
+  // against another base.
+  static bool Apply(const string& delta, const string& base, string* target);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_SYMBOL_DELTA_H__
@@ -0,0 +1,242 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// symbol_delta_unittest.cc: Unit tests for SymbolDelta and
+// SimpleSymbolSupplier's use of it.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "processor/basic_code_module.h"
+#include "processor/simple_symbol_supplier.h"
+#include "processor/symbol_delta.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicCodeModule;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::SymbolDelta;
+using google_breakpad::SymbolSupplier;
+using google_breakpad::scoped_ptr;
+
+const char kBase[] =
+    "MODULE Linux x86_64 000000000000000000000000000000000 app\n"
+    "FILE 0 a.cc\n"
+    "INLINE_ORIGIN 0 inlined\n"
+    "FUNC 1000 20 0 first\n"
+    "1000 10 1 0\n"
+    "1010 10 2 0\n"
+    "FUNC m 1020 30 0 second\n"
+    "INLINE 0 3 0 0 1020 8 1030 4\n"
+    "1020 30 3 0\n"
+    "PUBLIC 1050 0 third\n"
+    "STACK CFI INIT 1000 20 .cfa: $rsp 8 + .ra: .cfa -8 + ^\n"
+    "STACK CFI 1004 .cfa: $rsp 16 +\n"
+    "STACK WIN 4 1020 30 0 0 0 0 0 0 1 $eip\n";
+
+// kBase with a function added before "second", which moved everything
+// after it by 0x40, and "first" resized.
+const char kTarget[] =
+    "MODULE Linux x86_64 111111111111111111111111111111111 app\n"
+    "FILE 0 a.cc\n"
+    "INLINE_ORIGIN 0 inlined\n"
+    "FUNC 1000 28 0 first\n"
+    "1000 10 1 0\n"
+    "1010 18 2 0\n"
+    "FUNC 1030 30 0 added\n"
+    "1030 30 5 0\n"
+    "FUNC m 1060 30 0 second\n"
+    "INLINE 0 3 0 0 1060 8 1070 4\n"
+    "1060 30 3 0\n"
+    "PUBLIC 1090 0 third\n"
+    "STACK CFI INIT 1000 20 .cfa: $rsp 8 + .ra: .cfa -8 + ^\n"
+    "STACK CFI 1004 .cfa: $rsp 16 +\n"
+    "STACK WIN 4 1060 30 0 0 0 0 0 0 1 $eip\n";
+
+TEST(SymbolDelta, RoundTrip) {
+  string delta;
+  SymbolDelta::Create(kBase, "app/0/app.sym", kTarget, &delta);
+  string base_path;
+  ASSERT_TRUE(SymbolDelta::GetBasePath(delta, &base_path));
+  EXPECT_EQ("app/0/app.sym", base_path);
+  string target;
+  ASSERT_TRUE(SymbolDelta::Apply(delta, kBase, &target));
+  EXPECT_EQ(kTarget, target);
+  // The moved lines are copied with their addresses shifted, rather than
+  // inserted.
+  EXPECT_NE(string::npos, delta.find("C 6 4 40\n"));
+  EXPECT_EQ(string::npos, delta.find("second"));
+}
+
+TEST(SymbolDelta, NegativeShift) {
+  string delta;
+  SymbolDelta::Create(kTarget, "base", kBase, &delta);
+  EXPECT_NE(string::npos, delta.find(" -40\n"));
+  string target;
+  ASSERT_TRUE(SymbolDelta::Apply(delta, kTarget, &target));
+  EXPECT_EQ(kBase, target);
+}
+
+TEST(SymbolDelta, Unrelated) {
+  const char* const files[] = { "", "\n", "no newline", "FUNC 10 1 0 f",
+                                "PUBLIC zz 0 odd\n\n" };
+  for (const char* base : files) {
+    for (const char* target : files) {
+      string delta;
+      SymbolDelta::Create(base, "base", target, &delta);
+      string result;
+      ASSERT_TRUE(SymbolDelta::Apply(delta, base, &result));
+      EXPECT_EQ(target, result);
+    }
+  }
+}
+
+TEST(SymbolDelta, WrongBase) {
+  string delta;
+  SymbolDelta::Create(kBase, "base", kTarget, &delta);
+  string target;
+  EXPECT_FALSE(SymbolDelta::Apply(delta, kTarget, &target));
+  string altered = kBase;
+  altered[altered.size() - 2] = 'x';
+  EXPECT_FALSE(SymbolDelta::Apply(delta, altered, &target));
+}
+
+TEST(SymbolDelta, Malformed) {
+  string delta;
+  SymbolDelta::Create(kBase, "base", kTarget, &delta);
+  string target;
+  EXPECT_FALSE(SymbolDelta::Apply("", kBase, &target));
+  EXPECT_FALSE(SymbolDelta::Apply(kTarget, kBase, &target));
+  EXPECT_FALSE(SymbolDelta::Apply(delta.substr(0, delta.size() - 1), kBase,
+                                  &target));
+  string header = delta.substr(0, delta.find('\n') + 1);
+  EXPECT_FALSE(SymbolDelta::Apply(header + "C 0 100 0\n", kBase, &target));
+  EXPECT_FALSE(SymbolDelta::Apply(header + "I 2\nline\n", kBase, &target));
+  EXPECT_FALSE(SymbolDelta::Apply(header + "X 1\n", kBase, &target));
+  string base_path;
+  EXPECT_FALSE(SymbolDelta::GetBasePath(kBase, &base_path));
+}
+
+const char kModuleId[] = "111111111111111111111111111111111";
+const char kBaseModuleId[] = "000000000000000000000000000000000";
+
+void WriteFile(const string& path, const string& contents) {
+  FILE* file = fopen(path.c_str(), "w");
+  ASSERT_TRUE(file != NULL) << path;
+  fwrite(contents.data(), 1, contents.size(), file);
+  fclose(file);
+}
+
+class SymbolDeltaSupplierTest : public ::testing::Test {
+ public:
+  // Returns the path of the symbol file of the app module with
+  // |identifier|, relative to the root, creating its directories.
+  string MakeDirectories(const string& identifier) {
+    mkdir((temp_dir_.path() + "/app.pdb").c_str(), 0755);
+    mkdir((temp_dir_.path() + "/app.pdb/" + identifier).c_str(), 0755);
+    return "app.pdb/" + identifier + "/app.sym";
+  }
+
+  SymbolSupplier::SymbolResult Get(SimpleSymbolSupplier* supplier,
+                                   string* symbol_file, string* data) {
+    scoped_ptr<BasicCodeModule> module(new BasicCodeModule(
+        0x1000, 0x1000, "/lib/app", "", "app.pdb", kModuleId, ""));
+    return supplier->GetSymbolFile(module.get(), NULL, symbol_file, data);
+  }
+
+  AutoTempDir temp_dir_;
+};
+
+TEST_F(SymbolDeltaSupplierTest, AppliesDelta) {
+  string base_path = MakeDirectories(kBaseModuleId);
+  string target_path = MakeDirectories(kModuleId);
+  WriteFile(temp_dir_.path() + "/" + base_path, kBase);
+  string delta;
+  SymbolDelta::Create(kBase, base_path, kTarget, &delta);
+  WriteFile(temp_dir_.path() + "/" + target_path + ".delta", delta);
+
+  SimpleSymbolSupplier supplier(temp_dir_.path());
+  string symbol_file, data;
+  ASSERT_EQ(SymbolSupplier::FOUND, Get(&supplier, &symbol_file, &data));
+  EXPECT_EQ(temp_dir_.path() + "/" + target_path + ".delta", symbol_file);
+  EXPECT_EQ(kTarget, data);
+
+  // A symbol file is preferred to a delta.
+  WriteFile(temp_dir_.path() + "/" + target_path, "MODULE\n");
+  ASSERT_EQ(SymbolSupplier::FOUND, Get(&supplier, &symbol_file, &data));
+  EXPECT_EQ("MODULE\n", data);
+}
+
+TEST_F(SymbolDeltaSupplierTest, DeltaChain) {
+  // The base is itself a delta, against an empty symbol file.
+  string empty_path = MakeDirectories("2");
+  string base_path = MakeDirectories(kBaseModuleId);
+  string target_path = MakeDirectories(kModuleId);
+  WriteFile(temp_dir_.path() + "/" + empty_path, "");
+  string delta;
+  SymbolDelta::Create("", empty_path, kBase, &delta);
+  WriteFile(temp_dir_.path() + "/" + base_path + ".delta", delta);
+  SymbolDelta::Create(kBase, base_path, kTarget, &delta);
+  WriteFile(temp_dir_.path() + "/" + target_path + ".delta", delta);
+
+  SimpleSymbolSupplier supplier(temp_dir_.path());
+  string symbol_file, data;
+  ASSERT_EQ(SymbolSupplier::FOUND, Get(&supplier, &symbol_file, &data));
+  EXPECT_EQ(kTarget, data);
+}
+
+TEST_F(SymbolDeltaSupplierTest, MissingBase) {
+  string base_path = MakeDirectories(kBaseModuleId);
+  string target_path = MakeDirectories(kModuleId);
+  string delta;
+  SymbolDelta::Create(kBase, base_path, kTarget, &delta);
+  WriteFile(temp_dir_.path() + "/" + target_path + ".delta", delta);
+
+  SimpleSymbolSupplier supplier(temp_dir_.path());
+  string symbol_file, data;
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND, Get(&supplier, &symbol_file, &data));
+
+  // A delta whose base is itself does not loop.
+  SymbolDelta::Create(kBase, target_path, kTarget, &delta);
+  WriteFile(temp_dir_.path() + "/" + target_path + ".delta", delta);
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND, Get(&supplier, &symbol_file, &data));
+}
+
+}  // namespace
@@ -0,0 +1,133 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// symbol_store_index.cc: Lists the symbol files in a symbol store.
+//
+// See symbol_store_index.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/symbol_store_index.h"
+
+#include <sys/stat.h>
+
+#include <fstream>
+
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+#if defined(__APPLE__)
+struct timespec ModificationTime(const struct stat& sb) {
+  return sb.st_mtimespec;
+}
+#else
+struct timespec ModificationTime(const struct stat& sb) {
+  return sb.st_mtim;
+}
+#endif
+
+}  // namespace
+
+SymbolStoreIndex::SymbolStoreIndex(const string& index_path,
+                                   time_t refresh_seconds)
+    : index_path_(index_path),
+      refresh_seconds_(refresh_seconds),
+      loaded_(false),
+      file_size_(0),
+      file_mtime_(),
+      last_check_(0) {}
+
+SymbolStoreIndex::LookupResult SymbolStoreIndex::Lookup(
+    const string& relative_path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RefreshLocked();
+  if (!loaded_)
+    return NO_INDEX;
+  return entries_.count(relative_path) ? PRESENT : ABSENT;
+}
+
+size_t SymbolStoreIndex::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RefreshLocked();
+  return entries_.size();
+}
+
+void SymbolStoreIndex::RefreshLocked() {
+  time_t now = time(NULL);
+  if (last_check_ != 0 && now - last_check_ < refresh_seconds_)
+    return;
+  last_check_ = now;
+
+  struct stat sb;
+  if (stat(index_path_.c_str(), &sb) != 0) {
+    if (loaded_)
+      BPLOG(INFO) << "Symbol store index " << index_path_ << " is gone";
+    loaded_ = false;
+    entries_.clear();
+    return;
+  }
+  struct timespec mtime = ModificationTime(sb);
+  if (loaded_ && sb.st_size == file_size_ &&
+      mtime.tv_sec == file_mtime_.tv_sec &&
+      mtime.tv_nsec == file_mtime_.tv_nsec) {
+    return;
+  }
+
+  std::ifstream in(index_path_.c_str());
+  if (!in.is_open()) {
+    BPLOG(ERROR) << "Could not open symbol store index " << index_path_;
+    loaded_ = false;
+    entries_.clear();
+    return;
+  }
+  std::unordered_set<string> entries;
+  string line;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      line.erase(line.size() - 1);
+    if (line.empty() || line[0] == '#')
+      continue;
+    if (line.compare(0, 2, "./") == 0)
+      line.erase(0, 2);
+    entries.insert(line);
+  }
+  entries_.swap(entries);
+  loaded_ = true;
+  file_size_ = sb.st_size;
+  file_mtime_ = mtime;
+  BPLOG(INFO) << "Read " << entries_.size() << " symbol files from index "
+              << index_path_;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,108 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// symbol_store_index.h: SymbolStoreIndex lists the symbol files in a
+// symbol store, so that SimpleSymbolSupplier can find them without
+// probing the file system for each module.
+//
+// The index is a text file kept in the root of the store.  Each line is
+// the path of one symbol file relative to the root, as SimpleSymbolSupplier
+// lays them out:
+//
+// test_app.pdb/63FE4780728D49379B9D7BB6460CB42A1/test_app.sym
+// kernel32.pdb/BCE8785C57B44245A669896B6A19B9542/kernel32.sym
+//
+// A leading "./" is ignored, as are empty lines and lines starting with
+// '#', so the output of "find . -name '*.sym'" run in the root is an
+// index.  The index file is read once, and read again when its size or
+// modification time changes; those are checked at most once per refresh
+// interval.  Symbol files added to the store are not found until they are
+// added to the index.
+
+#ifndef PROCESSOR_SYMBOL_STORE_INDEX_H__
+#define PROCESSOR_SYMBOL_STORE_INDEX_H__
+
+#include <sys/types.h>
+#include <time.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class SymbolStoreIndex {
+ public:
+  enum LookupResult {
+    // The index lists the file.
+    PRESENT,
+    // The index doesn't list the file.
+    ABSENT,
+    // There is no readable index file, so the store must be searched.
+    NO_INDEX
+  };
+
+  // The index is read from |index_path|.  Its size and modification time
+  // are checked at most every |refresh_seconds| seconds.
+  SymbolStoreIndex(const string& index_path, time_t refresh_seconds);
+
+  // Looks for |relative_path| in the index, reading the index file first
+  // if it is due to be checked and has changed.  Thread-safe.
+  LookupResult Lookup(const string& relative_path);
+
+  // The number of files the index lists.
+  size_t size();
+
+ private:
+  // Reads the index file again if it changed.  |mutex_| must be held.
+  void RefreshLocked();
+
+  const string index_path_;
+  const time_t refresh_seconds_;
+
+  std::mutex mutex_;
+  std::unordered_set<string> entries_;
+  // Whether an index file was read, and the size and modification time it
+  // had.
+  bool loaded_;
+  off_t file_size_;
+  struct timespec file_mtime_;
+  // When the index file was last checked, or 0 if it never was.
+  time_t last_check_;
+
+  // Disallow unwanted copy ctor and assignment operator
+  SymbolStoreIndex(const SymbolStoreIndex&);
+  void operator=(const SymbolStoreIndex&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_SYMBOL_STORE_INDEX_H__
@@ -0,0 +1,192 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// symbol_store_index_unittest.cc: Unit tests for SymbolStoreIndex and
+// SimpleSymbolSupplier's use of it.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "processor/basic_code_module.h"
+#include "processor/simple_symbol_supplier.h"
+#include "processor/symbol_store_index.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicCodeModule;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::SymbolStoreIndex;
+using google_breakpad::SymbolSupplier;
+using google_breakpad::scoped_ptr;
+using std::vector;
+
+const char kModuleId[] = "111111111111111111111111111111111";
+
+BasicCodeModule* NewModule(const string& name) {
+  return new BasicCodeModule(0x1000, 0x1000, "/lib/" + name, "",
+                             name + ".pdb", kModuleId, "");
+}
+
+string RelativePath(const string& name) {
+  return name + ".pdb/" + kModuleId + "/" + name + ".sym";
+}
+
+void WriteFile(const string& path, const string& contents) {
+  FILE* file = fopen(path.c_str(), "w");
+  ASSERT_TRUE(file != NULL) << path;
+  fwrite(contents.data(), 1, contents.size(), file);
+  fclose(file);
+}
+
+class SymbolStoreIndexTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    root_a_ = temp_dir_.path() + "/a";
+    root_b_ = temp_dir_.path() + "/b";
+    mkdir(root_a_.c_str(), 0755);
+    mkdir(root_b_.c_str(), 0755);
+  }
+
+  // Writes a symbol file for the module |name| under |root|.
+  void AddSymbolFile(const string& root, const string& name) {
+    string path = root + "/" + name + ".pdb";
+    mkdir(path.c_str(), 0755);
+    path += string("/") + kModuleId;
+    mkdir(path.c_str(), 0755);
+    WriteFile(root + "/" + RelativePath(name), "MODULE Linux x86 " +
+              string(kModuleId) + " " + name + ".pdb\n");
+  }
+
+  SymbolSupplier::SymbolResult Find(SimpleSymbolSupplier* supplier,
+                                    const string& name,
+                                    string* symbol_file) {
+    scoped_ptr<BasicCodeModule> module(NewModule(name));
+    return supplier->GetSymbolFile(module.get(), NULL, symbol_file);
+  }
+
+  AutoTempDir temp_dir_;
+  string root_a_;
+  string root_b_;
+};
+
+TEST_F(SymbolStoreIndexTest, ReadsIndexFile) {
+  string index_path = root_a_ + "/index";
+  WriteFile(index_path,
+            "# symbol files\n"
+            "\n"
+            "./" + RelativePath("one") + "\n" +
+            RelativePath("two") + "\r\n");
+  SymbolStoreIndex index(index_path, 60);
+  EXPECT_EQ(2U, index.size());
+  EXPECT_EQ(SymbolStoreIndex::PRESENT, index.Lookup(RelativePath("one")));
+  EXPECT_EQ(SymbolStoreIndex::PRESENT, index.Lookup(RelativePath("two")));
+  EXPECT_EQ(SymbolStoreIndex::ABSENT, index.Lookup(RelativePath("three")));
+  EXPECT_EQ(SymbolStoreIndex::ABSENT, index.Lookup("# symbol files"));
+
+  SymbolStoreIndex missing(root_b_ + "/index", 60);
+  EXPECT_EQ(SymbolStoreIndex::NO_INDEX, missing.Lookup(RelativePath("one")));
+}
+
+TEST_F(SymbolStoreIndexTest, RefreshesChangedIndexFile) {
+  string index_path = root_a_ + "/index";
+  WriteFile(index_path, RelativePath("one") + "\n");
+  SymbolStoreIndex index(index_path, 0);
+  EXPECT_EQ(SymbolStoreIndex::ABSENT, index.Lookup(RelativePath("two")));
+
+  WriteFile(index_path, RelativePath("one") + "\n" + RelativePath("two"));
+  EXPECT_EQ(SymbolStoreIndex::PRESENT, index.Lookup(RelativePath("two")));
+
+  unlink(index_path.c_str());
+  EXPECT_EQ(SymbolStoreIndex::NO_INDEX, index.Lookup(RelativePath("two")));
+}
+
+TEST_F(SymbolStoreIndexTest, WaitsForRefreshInterval) {
+  string index_path = root_a_ + "/index";
+  WriteFile(index_path, RelativePath("one") + "\n");
+  SymbolStoreIndex index(index_path, 3600);
+  EXPECT_EQ(SymbolStoreIndex::ABSENT, index.Lookup(RelativePath("two")));
+
+  WriteFile(index_path, RelativePath("one") + "\n" + RelativePath("two"));
+  EXPECT_EQ(SymbolStoreIndex::ABSENT, index.Lookup(RelativePath("two")));
+}
+
+TEST_F(SymbolStoreIndexTest, SupplierUsesIndexes) {
+  // Root a has an index, which lists "one" but not "two", though both are
+  // there.  Root b has no index.
+  AddSymbolFile(root_a_, "one");
+  AddSymbolFile(root_a_, "two");
+  AddSymbolFile(root_b_, "two");
+  AddSymbolFile(root_b_, "three");
+  WriteFile(root_a_ + "/index", RelativePath("one") + "\n");
+
+  vector<string> paths;
+  paths.push_back(root_a_);
+  paths.push_back(root_b_);
+  SimpleSymbolSupplier supplier(paths);
+  supplier.set_index_file_name("index");
+
+  string symbol_file;
+  EXPECT_EQ(SymbolSupplier::FOUND, Find(&supplier, "one", &symbol_file));
+  EXPECT_EQ(root_a_ + "/" + RelativePath("one"), symbol_file);
+  EXPECT_EQ(SymbolSupplier::FOUND, Find(&supplier, "two", &symbol_file));
+  EXPECT_EQ(root_b_ + "/" + RelativePath("two"), symbol_file);
+  EXPECT_EQ(SymbolSupplier::FOUND, Find(&supplier, "three", &symbol_file));
+  EXPECT_EQ(root_b_ + "/" + RelativePath("three"), symbol_file);
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            Find(&supplier, "four", &symbol_file));
+
+  // The symbol data is read from the file the index names.
+  scoped_ptr<BasicCodeModule> module(NewModule("one"));
+  string symbol_data;
+  EXPECT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(module.get(), NULL, &symbol_file,
+                                   &symbol_data));
+  EXPECT_EQ("MODULE Linux x86 " + string(kModuleId) + " one.pdb\n",
+            symbol_data);
+
+  // Without indexes, "two" is found in root a.
+  SimpleSymbolSupplier plain_supplier(paths);
+  EXPECT_EQ(SymbolSupplier::FOUND,
+            Find(&plain_supplier, "two", &symbol_file));
+  EXPECT_EQ(root_a_ + "/" + RelativePath("two"), symbol_file);
+}
+
+}  // namespace
@@ -0,0 +1,205 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_warmup_manifest.cc: Records and preloads the hottest modules.
+//
+// See symbol_warmup_manifest.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/symbol_warmup_manifest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "google_breakpad/processor/source_line_resolver_base.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "google_breakpad/processor/system_info.h"
+#include "processor/basic_code_module.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The first line of every manifest.  Files that start otherwise, from
+// another version, are not read.
+const char kManifestHeader[] = "BREAKPAD_WARMUP_MANIFEST 1";
+
+// Splits |line| at tabs into |fields|.
+void SplitFields(const string& line, std::vector<string>* fields) {
+  fields->clear();
+  size_t start = 0;
+  for (;;) {
+    size_t tab = line.find('\t', start);
+    fields->push_back(line.substr(start, tab - start));
+    if (tab == string::npos)
+      return;
+    start = tab + 1;
+  }
+}
+
+// Returns true if |field| can be written as a field of a module line.
+bool IsPlainField(const string& field) {
+  return field.find_first_of("\t\n") == string::npos;
+}
+
+// Reads one line of |file|, without its newline, into |line|.  Returns
+// false at the end of the file.
+bool ReadLine(FILE* file, string* line) {
+  line->clear();
+  int c;
+  while ((c = getc(file)) != EOF) {
+    if (c == '\n')
+      return true;
+    line->push_back(static_cast<char>(c));
+  }
+  return !line->empty();
+}
+
+}  // namespace
+
+SymbolWarmupManifest::SymbolWarmupManifest() {}
+
+SymbolWarmupManifest::~SymbolWarmupManifest() {
+  WaitForPreload();
+}
+
+void SymbolWarmupManifest::RecordHottestModules(
+    SourceLineResolverBase* resolver, size_t max_modules) {
+  WaitForPreload();
+  modules_.clear();
+  std::vector<SourceLineResolverBase::ModuleHits> hottest =
+      resolver->HottestModules(max_modules);
+  for (const SourceLineResolverBase::ModuleHits& module : hottest) {
+    if (module.hits == 0)
+      break;
+    Entry entry;
+    entry.module.reset(new BasicCodeModule(
+        0, 0, module.code_file, module.code_identifier, module.debug_file,
+        module.debug_identifier, ""));
+    entry.hits = module.hits;
+    modules_.push_back(std::move(entry));
+  }
+}
+
+bool SymbolWarmupManifest::ReadFromFile(const string& path) {
+  WaitForPreload();
+  modules_.clear();
+  FILE* file = fopen(path.c_str(), "r");
+  if (!file)
+    return false;
+
+  string line;
+  if (!ReadLine(file, &line) || line != kManifestHeader) {
+    BPLOG(ERROR) << path << " is not a symbol warmup manifest";
+    fclose(file);
+    return false;
+  }
+
+  std::vector<string> fields;
+  while (ReadLine(file, &line)) {
+    SplitFields(line, &fields);
+    char* end;
+    uint64_t hits = strtoull(fields[0].c_str(), &end, 10);
+    if (fields.size() != 5 || fields[0].empty() || *end != '\0' ||
+        fields[1].empty()) {
+      continue;
+    }
+    Entry entry;
+    entry.module.reset(new BasicCodeModule(0, 0, fields[1], fields[2],
+                                           fields[3], fields[4], ""));
+    entry.hits = hits;
+    modules_.push_back(std::move(entry));
+  }
+  fclose(file);
+  return true;
+}
+
+bool SymbolWarmupManifest::WriteToFile(const string& path) const {
+  string contents = kManifestHeader;
+  contents.append("\n");
+  for (const Entry& entry : modules_) {
+    const string fields[] = {
+      entry.module->code_file(),
+      entry.module->code_identifier(),
+      entry.module->debug_file(),
+      entry.module->debug_identifier(),
+    };
+    string line = std::to_string(entry.hits);
+    bool plain = true;
+    for (const string& field : fields) {
+      plain = plain && IsPlainField(field);
+      line.append("\t").append(field);
+    }
+    if (plain)
+      contents.append(line).append("\n");
+  }
+
+  // Write the manifest under another name and move it into place, so that
+  // a process starting up never reads a partial manifest.
+  char temp_suffix[32];
+  snprintf(temp_suffix, sizeof(temp_suffix), ".%d.tmp",
+           static_cast<int>(getpid()));
+  string temp_path = path + temp_suffix;
+  FILE* file = fopen(temp_path.c_str(), "wb");
+  if (!file)
+    return false;
+  bool ok = fwrite(contents.data(), 1, contents.size(), file) ==
+            contents.size();
+  ok = fclose(file) == 0 && ok;
+  if (!ok || rename(temp_path.c_str(), path.c_str()) != 0) {
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+void SymbolWarmupManifest::StartPreload(StackFrameSymbolizer* symbolizer) {
+  if (modules_.empty() || preload_thread_.joinable())
+    return;
+  std::vector<const CodeModule*> modules;
+  for (const Entry& entry : modules_)
+    modules.push_back(entry.module.get());
+  preload_thread_ = std::thread([symbolizer, modules]() {
+    // The manifest does not record what system the modules are from; the
+    // suppliers find symbol files by debug file and identifier alone.
+    SystemInfo system_info;
+    symbolizer->PrefetchSymbols(modules, &system_info);
+  });
+}
+
+void SymbolWarmupManifest::WaitForPreload() {
+  if (preload_thread_.joinable())
+    preload_thread_.join();
+}
+
+}  // namespace google_breakpad
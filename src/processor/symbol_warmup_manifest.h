@@ -0,0 +1,121 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_warmup_manifest.h: Lists the modules whose symbols a long-running
+// processor used most, so that when it restarts it can load them again
+// before the first minidump needs them.
+//
+// A service that processes one minidump after another keeps the symbols it
+// has loaded, and most minidumps then find the symbols they need already
+// loaded.  After a restart, the first minidumps pay for loading all of
+// them.  A SymbolWarmupManifest records the loaded modules that
+// SourceLineResolverBase::HottestModules() reports, writes them to a file
+// when the service stops, and after it starts again reads them back and
+// preloads their symbols on a background thread while minidumps are
+// already being processed.
+//
+// The file is text.  Its first line is a header; each following line
+// describes one module, hottest first, as tab-separated fields: the number
+// of hits, the code file, the code identifier, the debug file and the debug
+// identifier.  Lines that do not have these fields are skipped, so a
+// damaged manifest only costs the modules it no longer names.
+
+#ifndef PROCESSOR_SYMBOL_WARMUP_MANIFEST_H__
+#define PROCESSOR_SYMBOL_WARMUP_MANIFEST_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class CodeModule;
+class SourceLineResolverBase;
+class StackFrameSymbolizer;
+
+class SymbolWarmupManifest {
+ public:
+  SymbolWarmupManifest();
+  // Waits for any preload to finish.
+  ~SymbolWarmupManifest();
+
+  // Replaces the modules in the manifest with the |max_modules| modules
+  // loaded in |resolver| that have had the most hits, leaving out modules
+  // that have had none.  Waits for any preload to finish first.
+  void RecordHottestModules(SourceLineResolverBase* resolver,
+                            size_t max_modules);
+
+  // Reads the manifest from |path|, replacing the modules in it.  Returns
+  // false, leaving the manifest empty, if |path| cannot be read or is not
+  // a manifest.  Waits for any preload to finish first.
+  bool ReadFromFile(const string& path);
+
+  // Writes the manifest to |path|, replacing it whole so that a reader
+  // never sees a partial manifest.  Returns false on failure.
+  bool WriteToFile(const string& path) const;
+
+  // Starts loading the symbols for every module in the manifest through
+  // |symbolizer| on a background thread.  The requests are issued together,
+  // hottest first, with StackFrameSymbolizer::PrefetchSymbols, which may be
+  // used concurrently with processing.  |symbolizer| must remain alive
+  // until WaitForPreload() returns.  Does nothing if the manifest is empty
+  // or a preload is already running.
+  void StartPreload(StackFrameSymbolizer* symbolizer);
+
+  // Waits for the preload started by StartPreload(), if any, to finish.
+  void WaitForPreload();
+
+  size_t module_count() const { return modules_.size(); }
+  const CodeModule* module(size_t index) const {
+    return modules_[index].module.get();
+  }
+  uint64_t hits(size_t index) const { return modules_[index].hits; }
+
+ private:
+  struct Entry {
+    std::unique_ptr<CodeModule> module;
+    uint64_t hits;
+  };
+
+  std::vector<Entry> modules_;
+  std::thread preload_thread_;
+
+  // Disallow unwanted copy ctor and assignment operator
+  SymbolWarmupManifest(const SymbolWarmupManifest&);
+  void operator=(const SymbolWarmupManifest&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_SYMBOL_WARMUP_MANIFEST_H__
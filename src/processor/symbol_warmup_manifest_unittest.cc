@@ -0,0 +1,188 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_warmup_manifest_unittest.cc: Unit tests for SymbolWarmupManifest.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <memory>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "processor/basic_code_module.h"
+#include "processor/simple_symbol_supplier.h"
+#include "processor/symbol_warmup_manifest.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::StackFrameSymbolizer;
+using google_breakpad::SymbolWarmupManifest;
+
+void WriteFile(const string& path, const string& contents) {
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_TRUE(file != NULL);
+  fwrite(contents.data(), 1, contents.size(), file);
+  fclose(file);
+}
+
+// A module whose debug file and identifier are both |name|, as
+// WriteSymbolFile lays out its symbol file.
+BasicCodeModule* NewModule(const string& name) {
+  return new BasicCodeModule(0x1000, 0x1000, "/lib/" + name, "CODE_" + name,
+                             name, name, "");
+}
+
+class SymbolWarmupManifestTest : public ::testing::Test {
+ public:
+  SymbolWarmupManifestTest()
+      : symbol_dir_(temp_dir_.path() + "/symbols"),
+        manifest_file_(temp_dir_.path() + "/warmup") {
+    mkdir(symbol_dir_.c_str(), 0755);
+  }
+
+  // Writes a symbol file for the module NewModule(|name|) returns, where
+  // SimpleSymbolSupplier finds it.
+  void WriteSymbolFile(const string& name) {
+    string path = symbol_dir_ + "/" + name;
+    mkdir(path.c_str(), 0755);
+    path += "/" + name;
+    mkdir(path.c_str(), 0755);
+    WriteFile(path + "/" + name + ".sym",
+              "MODULE Linux x86_64 " + name + " " + name + "\n"
+              "FUNC 0 10 0 Function\n");
+  }
+
+  AutoTempDir temp_dir_;
+  string symbol_dir_;
+  string manifest_file_;
+};
+
+TEST_F(SymbolWarmupManifestTest, RecordWriteRead) {
+  BasicSourceLineResolver resolver;
+  std::unique_ptr<BasicCodeModule> module1(NewModule("module1"));
+  std::unique_ptr<BasicCodeModule> module2(NewModule("module2"));
+  std::unique_ptr<BasicCodeModule> module3(NewModule("module3"));
+  const string kSymbols = "FUNC 0 10 0 Function\n";
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(module1.get(), kSymbols));
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(module2.get(), kSymbols));
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(module3.get(), kSymbols));
+  ASSERT_TRUE(resolver.HasModule(module2.get()));
+  ASSERT_TRUE(resolver.HasModule(module2.get()));
+  ASSERT_TRUE(resolver.HasModule(module1.get()));
+
+  // module3 has had no hits, so it is left out.
+  SymbolWarmupManifest manifest;
+  manifest.RecordHottestModules(&resolver, 10);
+  ASSERT_EQ(manifest.module_count(), 2U);
+  ASSERT_TRUE(manifest.WriteToFile(manifest_file_));
+
+  SymbolWarmupManifest read_manifest;
+  ASSERT_TRUE(read_manifest.ReadFromFile(manifest_file_));
+  ASSERT_EQ(read_manifest.module_count(), 2U);
+  EXPECT_EQ(read_manifest.module(0)->code_file(), "/lib/module2");
+  EXPECT_EQ(read_manifest.module(0)->code_identifier(), "CODE_module2");
+  EXPECT_EQ(read_manifest.module(0)->debug_file(), "module2");
+  EXPECT_EQ(read_manifest.module(0)->debug_identifier(), "module2");
+  EXPECT_EQ(read_manifest.hits(0), 2U);
+  EXPECT_EQ(read_manifest.module(1)->code_file(), "/lib/module1");
+  EXPECT_EQ(read_manifest.hits(1), 1U);
+
+  manifest.RecordHottestModules(&resolver, 1);
+  EXPECT_EQ(manifest.module_count(), 1U);
+}
+
+TEST_F(SymbolWarmupManifestTest, ReadSkipsDamagedLines) {
+  WriteFile(manifest_file_,
+            "BREAKPAD_WARMUP_MANIFEST 1\n"
+            "5\t/lib/a\tA\ta.pdb\tAAAA\n"
+            "garbage\n"
+            "x\t/lib/b\tB\tb.pdb\tBBBB\n"
+            "3\t\tC\tc.pdb\tCCCC\n"
+            "2\t/lib/d\tD\td.pdb\n"
+            "1\t/lib/e\t\te.pdb\tEEEE");
+  SymbolWarmupManifest manifest;
+  ASSERT_TRUE(manifest.ReadFromFile(manifest_file_));
+  ASSERT_EQ(manifest.module_count(), 2U);
+  EXPECT_EQ(manifest.module(0)->code_file(), "/lib/a");
+  EXPECT_EQ(manifest.hits(0), 5U);
+  EXPECT_EQ(manifest.module(1)->code_file(), "/lib/e");
+  EXPECT_EQ(manifest.module(1)->code_identifier(), "");
+  EXPECT_EQ(manifest.module(1)->debug_identifier(), "EEEE");
+}
+
+TEST_F(SymbolWarmupManifestTest, ReadRejectsOtherFiles) {
+  SymbolWarmupManifest manifest;
+  EXPECT_FALSE(manifest.ReadFromFile(manifest_file_));
+  WriteFile(manifest_file_,
+            "BREAKPAD_WARMUP_MANIFEST 2\n"
+            "5\t/lib/a\tA\ta.pdb\tAAAA\n");
+  EXPECT_FALSE(manifest.ReadFromFile(manifest_file_));
+  EXPECT_EQ(manifest.module_count(), 0U);
+}
+
+TEST_F(SymbolWarmupManifestTest, PreloadLoadsSymbols) {
+  WriteSymbolFile("module1");
+  WriteSymbolFile("module2");
+  WriteFile(manifest_file_,
+            "BREAKPAD_WARMUP_MANIFEST 1\n"
+            "9\t/lib/module1\tCODE_module1\tmodule1\tmodule1\n"
+            "4\t/lib/module2\tCODE_module2\tmodule2\tmodule2\n"
+            "1\t/lib/missing\tCODE_missing\tmissing\tmissing\n");
+  SymbolWarmupManifest manifest;
+  ASSERT_TRUE(manifest.ReadFromFile(manifest_file_));
+  ASSERT_EQ(manifest.module_count(), 3U);
+
+  SimpleSymbolSupplier supplier(symbol_dir_);
+  BasicSourceLineResolver resolver;
+  StackFrameSymbolizer symbolizer(&supplier, &resolver);
+  manifest.StartPreload(&symbolizer);
+  manifest.WaitForPreload();
+
+  std::unique_ptr<BasicCodeModule> module1(NewModule("module1"));
+  std::unique_ptr<BasicCodeModule> module2(NewModule("module2"));
+  std::unique_ptr<BasicCodeModule> missing(NewModule("missing"));
+  EXPECT_TRUE(resolver.HasModule(module1.get()));
+  EXPECT_TRUE(resolver.HasModule(module2.get()));
+  EXPECT_FALSE(resolver.HasModule(missing.get()));
+}
+
+}  // namespace
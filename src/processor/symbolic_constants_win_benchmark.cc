@@ -0,0 +1,137 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbolic_constants_win_benchmark.cc: Times NTStatusToString() for codes it
+// names and for codes it formats as numbers.
+//
+// Usage: symbolic_constants_win_benchmark [-l lookups]
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "common/path_helper.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+#include "processor/symbolic_constants_win.h"
+
+namespace {
+
+using google_breakpad::NTStatusToString;
+using std::vector;
+
+struct Options {
+  Options() : num_lookups(10000000) { }
+
+  uint64_t num_lookups;
+};
+
+// Converts |codes| and returns the elapsed time in nanoseconds.
+// Accumulates the length of the results into |checksum|.
+double TimeLookups(const vector<uint32_t>& codes, uint64_t* checksum) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  for (uint32_t code : codes)
+    *checksum += NTStatusToString(code).size();
+  return std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+void Usage(int argc, char* argv[], bool error) {
+  FILE* fp = error ? stderr : stdout;
+  fprintf(fp,
+          "Usage: %s [options...]\n"
+          "Time NTStatusToString for known and unknown codes.\n"
+          "\n"
+          "Options:\n"
+          "  -l <lookups>\t Number of lookups (default 10000000)\n"
+          "  -h:\t\t Usage\n",
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+void SetupOptions(int argc, char* argv[], Options* options) {
+  int ch;
+  while ((ch = getopt(argc, argv, "l:h")) != -1) {
+    switch (ch) {
+      case 'l':
+        options->num_lookups = strtoull(optarg, NULL, 0);
+        break;
+      case 'h':
+        Usage(argc, argv, false);
+        exit(0);
+      default:
+        Usage(argc, argv, true);
+        exit(1);
+    }
+  }
+  if (options->num_lookups == 0 || optind != argc) {
+    Usage(argc, argv, true);
+    exit(1);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  SetupOptions(argc, argv, &options);
+
+  // Most named codes lie in 0xC0000001-0xC00002FF, the range crash reasons
+  // usually come from; codes with the severity bits clear are never named.
+  vector<uint32_t> known(options.num_lookups);
+  vector<uint32_t> unknown(options.num_lookups);
+  uint32_t state = 0x9e3779b9;
+  for (uint64_t i = 0; i < options.num_lookups; ++i) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    known[i] = 0xC0000001 + state % 0x2ff;
+    unknown[i] = state & 0x3fffffff;
+  }
+
+  uint64_t checksum = 0;
+  // Warm up before timing.
+  TimeLookups(known, &checksum);
+  double known_ns = TimeLookups(known, &checksum);
+  double unknown_ns = TimeLookups(unknown, &checksum);
+
+  printf("lookups: %llu (checksum %llu)\n",
+         static_cast<unsigned long long>(options.num_lookups),
+         static_cast<unsigned long long>(checksum));
+  printf("named codes:   %.1f ns/lookup\n", known_ns / known.size());
+  printf("unnamed codes: %.1f ns/lookup\n", unknown_ns / unknown.size());
+  return 0;
+}
@@ -0,0 +1,73 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbolic_constants_win_unittest.cc: Unit tests for NTStatusToString.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/symbolic_constants_win.h"
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "google_breakpad/common/minidump_exception_win32.h"
+
+namespace {
+
+using google_breakpad::NTStatusToString;
+using std::string;
+
+// The expected names are those the switch statement that the sorted table
+// replaced returned.
+
+TEST(NTStatusToString, FirstCode) {
+  EXPECT_EQ(0xC0000001U, MD_NTSTATUS_WIN_STATUS_UNSUCCESSFUL);
+  EXPECT_EQ("STATUS_UNSUCCESSFUL", NTStatusToString(0xC0000001));
+}
+
+TEST(NTStatusToString, LastCode) {
+  EXPECT_EQ(0xC0E7000BU, MD_NTSTATUS_WIN_STATUS_SPACES_NOT_ENOUGH_DRIVES);
+  EXPECT_EQ("STATUS_SPACES_NOT_ENOUGH_DRIVES", NTStatusToString(0xC0E7000B));
+}
+
+TEST(NTStatusToString, MiddleCode) {
+  EXPECT_EQ(0xC002003DU, MD_NTSTATUS_WIN_RPC_NT_ENTRY_ALREADY_EXISTS);
+  EXPECT_EQ("RPC_NT_ENTRY_ALREADY_EXISTS", NTStatusToString(0xC002003D));
+}
+
+TEST(NTStatusToString, UnknownCodes) {
+  EXPECT_EQ("0x00000000", NTStatusToString(0));
+  // Just outside the table at either end.
+  EXPECT_EQ("0xc0000000", NTStatusToString(0xC0000000));
+  EXPECT_EQ("0xc0e7000c", NTStatusToString(0xC0E7000C));
+  EXPECT_EQ("0xffffffff", NTStatusToString(0xFFFFFFFF));
+}
+
+}  // namespace
@@ -146,6 +146,10 @@ class Section: public test_assembler::Section {
   // do differently.)
   void CiteLocationIn(test_assembler::Section* section) const;
 
+  // The offset of this section within the minidump file, for citing it
+  // other than through an MDLocationDescriptor.
+  const Label& file_offset() const { return file_offset_; }
+
   // Note that this section's contents are complete, and that it has
   // been placed in the minidump file at OFFSET. The 'Add' member
   // functions call the Finish member function of the object being
@@ -0,0 +1,91 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// trace_probes.h: Static tracepoints at the boundaries of the processor's
+// stages, for attaching perf or eBPF to a running processor.
+//
+// Configured with --enable-trace-probes, each BPTRACE statement is a USDT
+// probe in the "breakpad" provider (see <sys/sdt.h>), a single nop until a
+// tracer attaches to it.  Otherwise BPTRACE statements expand to nothing,
+// and their arguments are not evaluated.  The arguments are integers and C
+// strings, and are kept to what is already at hand where the probe is, so
+// that an unattached probe costs nothing more.
+//
+// Stages are traced as a *_begin and *_end pair on the same thread, so a
+// tracer takes a stage's duration from the pair.  The probes are:
+//
+//   minidump_stream_begin(stream_type, stream_length)
+//   minidump_stream_end(stream_type, read)
+//     Minidump::GetStream reading a stream the first time it is asked for.
+//
+//   symbol_supplier_begin(code_file)
+//   symbol_supplier_end(code_file, symbol_result, symbol_data_size)
+//     StackFrameSymbolizer asking its SymbolSupplier for symbol data.  For
+//     prefetches, the end may be on a supplier thread.
+//
+//   load_module_begin(code_file, symbol_data_size)
+//   load_module_end(code_file, corrupt)
+//     A source line resolver parsing a module's symbol data.
+//
+//   stackwalk_begin(stack_base)
+//   stackwalk_frame(frame_index, trust, instruction)
+//   stackwalk_end(frame_count, completed)
+//     Stackwalker::Walk walking one thread's stack, which begins at
+//     |stack_base| (0 if the thread has no stack memory).  stackwalk_frame
+//     follows each caller frame found, whose |trust| (a
+//     StackFrame::FrameTrust) tells the strategy that found it: CFI, frame
+//     pointer, or scanning.
+//
+//   print_begin(thread_count, machine_readable)
+//   print_thread_begin(thread_index, frame_count)
+//   print_thread_end(thread_index)
+//   print_end(thread_count)
+//     PrintProcessState and PrintProcessStateMachineReadable, and each
+//     thread they print.
+
+#ifndef PROCESSOR_TRACE_PROBES_H__
+#define PROCESSOR_TRACE_PROBES_H__
+
+#ifdef BREAKPAD_TRACE_PROBES
+
+#include <sys/sdt.h>
+
+#define BPTRACE1(name, a1) DTRACE_PROBE1(breakpad, name, a1)
+#define BPTRACE2(name, a1, a2) DTRACE_PROBE2(breakpad, name, a1, a2)
+#define BPTRACE3(name, a1, a2, a3) DTRACE_PROBE3(breakpad, name, a1, a2, a3)
+
+#else  // BREAKPAD_TRACE_PROBES
+
+#define BPTRACE1(name, a1) do {} while (0)
+#define BPTRACE2(name, a1, a2) do {} while (0)
+#define BPTRACE3(name, a1, a2, a3) do {} while (0)
+
+#endif  // BREAKPAD_TRACE_PROBES
+
+#endif  // PROCESSOR_TRACE_PROBES_H__
@@ -40,6 +40,7 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -54,6 +55,8 @@ namespace google_breakpad {
 #define strtoull _strtoui64
 #endif
 
+class WindowsFrameProgram;
+
 struct WindowsFrameInfo {
  public:
   enum Validity {
@@ -170,6 +173,7 @@ struct WindowsFrameInfo {
     max_stack_size = that.max_stack_size;
     allocates_base_pointer = that.allocates_base_pointer;
     program_string = that.program_string;
+    compiled_program = that.compiled_program;
   }
 
   // Clears the WindowsFrameInfo object so that users will see it as though
@@ -178,6 +182,7 @@ struct WindowsFrameInfo {
     type_ = STACK_INFO_UNKNOWN;
     valid = VALID_NONE;
     program_string.erase();
+    compiled_program.reset();
   }
 
   StackInfoTypes type_;
@@ -200,6 +205,10 @@ struct WindowsFrameInfo {
   // If program_string is empty, use allocates_base_pointer.
   bool allocates_base_pointer;
   string program_string;
+
+  // program_string compiled by the resolver that loaded it, shared by the
+  // copies it hands out, or NULL if it was not compiled.
+  std::shared_ptr<const WindowsFrameProgram> compiled_program;
 };
 
 }  // namespace google_breakpad
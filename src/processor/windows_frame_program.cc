@@ -0,0 +1,314 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// windows_frame_program.cc: A STACK WIN program string compiled for
+// StackwalkerX86.
+//
+// See windows_frame_program.h for documentation.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/windows_frame_program.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "google_breakpad/processor/memory_region.h"
+#include "processor/logging.h"
+#include "processor/postfix_evaluator-inl.h"
+
+namespace google_breakpad {
+
+namespace {
+
+const char* const kFixedNames[WindowsFrameProgram::FIXED_VARIABLE_COUNT] = {
+  "$eip", "$esp", "$ebp", "$ebx", "$esi", "$edi",
+  ".raSearchStart", ".raSearch",
+  ".cbCalleeParams", ".cbSavedRegs", ".cbLocals", ".cbParams"
+};
+
+// Parses |token| as PostfixEvaluator<uint32_t> would parse a literal.
+bool ParseLiteral(const string& token, uint32_t* value) {
+  std::istringstream token_stream(token);
+  uint32_t literal = 0;
+  bool negative = token_stream.peek() == '-';
+  if (negative)
+    token_stream.get();
+  if (!(token_stream >> literal) || token_stream.peek() != EOF)
+    return false;
+  *value = negative ? -literal : literal;
+  return true;
+}
+
+}  // namespace
+
+// static
+std::shared_ptr<const WindowsFrameProgram> WindowsFrameProgram::Compile(
+    const string& program_string) {
+  std::shared_ptr<WindowsFrameProgram> program(new WindowsFrameProgram());
+  program->program_string_ = program_string;
+  program->names_.assign(kFixedNames, kFixedNames + FIXED_VARIABLE_COUNT);
+
+  // Split the string the way PostfixEvaluator does, including its handling
+  // of assignments smashed up against the next token, as in
+  // "$T0 $ebp 128 + =$eip $T0 4 + ^ =$ebp $T0 ^ =".
+  std::vector<string> tokens;
+  std::istringstream stream(program_string);
+  string token;
+  while (stream >> token) {
+    if (token.size() > 1 && token[0] == '=') {
+      tokens.push_back("=");
+      token.erase(0, 1);
+    }
+    tokens.push_back(token);
+  }
+
+  program->code_.reserve(tokens.size());
+  // The stack depth, as long as no instruction has failed for lack of
+  // operands, since evaluation stops at the first that does.
+  size_t depth = 0;
+  size_t max_depth = 0;
+  bool underflow = false;
+  for (const string& token : tokens) {
+    Instruction instruction = {Instruction::PUSH_LITERAL, 0, 0};
+    size_t operands = 0;
+    size_t results = 1;
+    if (token == "+") {
+      instruction.opcode = Instruction::ADD;
+      operands = 2;
+    } else if (token == "-") {
+      instruction.opcode = Instruction::SUBTRACT;
+      operands = 2;
+    } else if (token == "*") {
+      instruction.opcode = Instruction::MULTIPLY;
+      operands = 2;
+    } else if (token == "/") {
+      instruction.opcode = Instruction::DIVIDE_QUOTIENT;
+      operands = 2;
+    } else if (token == "%") {
+      instruction.opcode = Instruction::DIVIDE_MODULUS;
+      operands = 2;
+    } else if (token == "@") {
+      instruction.opcode = Instruction::ALIGN;
+      operands = 2;
+      program->aligns_ = true;
+    } else if (token == "^") {
+      instruction.opcode = Instruction::DEREFERENCE;
+      operands = 1;
+    } else if (token == "=") {
+      instruction.opcode = Instruction::ASSIGN;
+      operands = 2;
+      results = 0;
+    } else if (!ParseLiteral(token, &instruction.literal)) {
+      std::vector<string>& names = program->names_;
+      std::vector<string>::const_iterator name =
+          std::find(names.begin(), names.end(), token);
+      if (name == names.end()) {
+        if (names.size() == kMaxVariables)
+          return NULL;
+        name = names.insert(names.end(), token);
+      }
+      instruction.opcode = Instruction::PUSH_VARIABLE;
+      instruction.variable = static_cast<uint8_t>(name - names.begin());
+    }
+    program->code_.push_back(instruction);
+
+    if (underflow)
+      continue;
+    if (depth < operands) {
+      underflow = true;
+      continue;
+    }
+    depth = depth - operands + results;
+    max_depth = std::max(max_depth, depth);
+  }
+  if (max_depth > kMaxStackDepth)
+    return NULL;
+
+  return program;
+}
+
+bool WindowsFrameProgram::Evaluate(const MemoryRegion& memory,
+                                   Values* values) const {
+  // Like PostfixEvaluator, keep variables on the stack until they are
+  // popped, so that assignments can find them.
+  struct Entry {
+    uint32_t value;
+    // The index of the variable, or -1 for a value.
+    int variable;
+  };
+  Entry stack[kMaxStackDepth];
+  size_t depth = 0;
+
+  auto pop_value = [&](uint32_t* value) {
+    if (depth == 0)
+      return false;
+    const Entry& entry = stack[--depth];
+    if (entry.variable < 0) {
+      *value = entry.value;
+      return true;
+    }
+    if (!values->Known(entry.variable)) {
+      BPLOG(INFO) << "Identifier " << names_[entry.variable]
+                  << " not in dictionary";
+      return false;
+    }
+    *value = values->values_[entry.variable];
+    return true;
+  };
+
+  for (const Instruction& instruction : code_) {
+    switch (instruction.opcode) {
+      case Instruction::PUSH_LITERAL:
+      case Instruction::PUSH_VARIABLE: {
+        if (depth == kMaxStackDepth)
+          return false;
+        Entry& entry = stack[depth++];
+        entry.value = instruction.literal;
+        entry.variable = instruction.opcode == Instruction::PUSH_VARIABLE ?
+            instruction.variable : -1;
+        break;
+      }
+
+      case Instruction::DEREFERENCE: {
+        uint32_t address;
+        if (!pop_value(&address)) {
+          BPLOG(ERROR) << "Could not PopValue to get value to derefence: "
+                       << program_string_;
+          return false;
+        }
+        uint32_t value;
+        if (!memory.GetMemoryAtAddress(address, &value)) {
+          BPLOG(ERROR) << "Could not dereference memory at address "
+                       << HexString(address) << ": " << program_string_;
+          return false;
+        }
+        stack[depth].value = value;
+        stack[depth++].variable = -1;
+        break;
+      }
+
+      case Instruction::ASSIGN: {
+        uint32_t value;
+        if (!pop_value(&value)) {
+          BPLOG(INFO) << "Could not PopValue to get value to assign: "
+                      << program_string_;
+          return false;
+        }
+        if (depth == 0 || stack[depth - 1].variable < 0) {
+          BPLOG(ERROR) << "An identifier is needed to assign "
+                       << HexString(value) << ": " << program_string_;
+          return false;
+        }
+        int variable = stack[--depth].variable;
+        if (names_[variable][0] != '$') {
+          BPLOG(ERROR) << "Can't assign " << HexString(value) << " to "
+                       << names_[variable] << ": " << program_string_;
+          return false;
+        }
+        values->Set(variable, value);
+        values->assigned_ |= 1U << variable;
+        break;
+      }
+
+      default: {
+        uint32_t operand1, operand2;
+        if (!pop_value(&operand2) || !pop_value(&operand1)) {
+          BPLOG(ERROR) << "Could not PopValues to get two values for binary "
+                          "operation: " << program_string_;
+          return false;
+        }
+        uint32_t value = 0;
+        switch (instruction.opcode) {
+          case Instruction::ADD:
+            value = operand1 + operand2;
+            break;
+          case Instruction::SUBTRACT:
+            value = operand1 - operand2;
+            break;
+          case Instruction::MULTIPLY:
+            value = operand1 * operand2;
+            break;
+          case Instruction::DIVIDE_QUOTIENT:
+          case Instruction::DIVIDE_MODULUS:
+            if (operand2 == 0) {
+              BPLOG(ERROR) << "Division by zero: " << program_string_;
+              return false;
+            }
+            value = instruction.opcode == Instruction::DIVIDE_QUOTIENT ?
+                operand1 / operand2 : operand1 % operand2;
+            break;
+          case Instruction::ALIGN:
+            value = operand1 & (static_cast<uint32_t>(-1) ^ (operand2 - 1));
+            break;
+        }
+        stack[depth].value = value;
+        stack[depth++].variable = -1;
+        break;
+      }
+    }
+  }
+
+  // If there's anything left on the stack, it indicates incomplete
+  // execution.
+  if (depth != 0) {
+    BPLOG(ERROR) << "Incomplete execution: " << program_string_;
+    return false;
+  }
+  return true;
+}
+
+// static
+bool WindowsFrameProgram::EvaluateText(const string& program_string,
+                                       const MemoryRegion& memory,
+                                       Values* values) {
+  PostfixEvaluator<uint32_t>::DictionaryType dictionary;
+  for (int i = 0; i < FIXED_VARIABLE_COUNT; ++i) {
+    if (values->Known(i))
+      dictionary[kFixedNames[i]] = values->Get(i);
+  }
+
+  PostfixEvaluator<uint32_t> evaluator(&dictionary, &memory);
+  PostfixEvaluator<uint32_t>::DictionaryValidityType assigned;
+  bool result = evaluator.Evaluate(program_string, &assigned);
+
+  for (int i = 0; i < FIXED_VARIABLE_COUNT; ++i) {
+    if (assigned.find(kFixedNames[i]) != assigned.end()) {
+      values->Set(i, dictionary[kFixedNames[i]]);
+      values->assigned_ |= 1U << i;
+    }
+  }
+  return result;
+}
+
+}  // namespace google_breakpad
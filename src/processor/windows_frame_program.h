@@ -0,0 +1,166 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// windows_frame_program.h: A STACK WIN program string compiled for
+// StackwalkerX86.
+//
+// A program string is a postfix expression of the sort interpreted by
+// google_breakpad::PostfixEvaluator, which recovers a caller's registers
+// from the values of the callee's and from constants of its frame.
+// PostfixEvaluator tokenizes the string and keeps its variables in a map
+// keyed by name every time it runs.  WindowsFrameProgram tokenizes the
+// string once, into operations on numbered variables, so that a program
+// found in a symbol file can be run for every frame it covers without
+// parsing it again.
+
+#ifndef PROCESSOR_WINDOWS_FRAME_PROGRAM_H__
+#define PROCESSOR_WINDOWS_FRAME_PROGRAM_H__
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+class MemoryRegion;
+
+class WindowsFrameProgram {
+ public:
+  // The registers and variables that StackwalkerX86 provides to programs
+  // or reads back from them.  They have the same index in every program;
+  // other variables, such as $T0, are numbered after them.
+  enum Variable {
+    EIP,
+    ESP,
+    EBP,
+    EBX,
+    ESI,
+    EDI,
+    RA_SEARCH_START,   // .raSearchStart
+    RA_SEARCH,         // .raSearch
+    CB_CALLEE_PARAMS,  // .cbCalleeParams
+    CB_SAVED_REGS,     // .cbSavedRegs
+    CB_LOCALS,         // .cbLocals
+    CB_PARAMS,         // .cbParams
+    FIXED_VARIABLE_COUNT
+  };
+
+  // The most variables, and the deepest stack, a compiled program may
+  // use.  Programs beyond these limits are evaluated from their text.
+  static const size_t kMaxVariables = 32;
+  static const size_t kMaxStackDepth = 16;
+
+  // The values of a program's variables, and which of them are known and
+  // which the program assigned.  Variables that are not known read as 0,
+  // as a PostfixEvaluator dictionary's operator[] would have them.
+  class Values {
+   public:
+    Values() : known_(0), assigned_(0) {
+      for (size_t i = 0; i < kMaxVariables; ++i)
+        values_[i] = 0;
+    }
+
+    uint32_t Get(int variable) const { return values_[variable]; }
+    void Set(int variable, uint32_t value) {
+      values_[variable] = value;
+      known_ |= 1U << variable;
+    }
+    bool Known(int variable) const { return known_ & (1U << variable); }
+    bool Assigned(int variable) const { return assigned_ & (1U << variable); }
+
+   private:
+    friend class WindowsFrameProgram;
+
+    uint32_t values_[kMaxVariables];
+    uint32_t known_;
+    uint32_t assigned_;
+  };
+
+  // Compiles |program_string|.  Returns NULL if it exceeds the limits of
+  // compiled programs.
+  static std::shared_ptr<const WindowsFrameProgram> Compile(
+      const string& program_string);
+
+  // Runs the program as PostfixEvaluator<uint32_t>::Evaluate would, with
+  // the known |values|, dereferencing addresses in |memory|.  Variables
+  // the program assigns are set and marked assigned in |values|.  Returns
+  // false if the program fails, keeping the assignments made until then.
+  bool Evaluate(const MemoryRegion& memory, Values* values) const;
+
+  // Runs |program_string| through PostfixEvaluator, for programs that
+  // can't be compiled, with the same effect on |values| as Evaluate.
+  // Only the fixed variables are passed in and out.
+  static bool EvaluateText(const string& program_string,
+                           const MemoryRegion& memory,
+                           Values* values);
+
+  const string& program_string() const { return program_string_; }
+
+  // True if the program uses the @ (align) operator.
+  bool aligns() const { return aligns_; }
+
+ private:
+  struct Instruction {
+    enum Opcode {
+      PUSH_LITERAL,
+      PUSH_VARIABLE,
+      ADD,
+      SUBTRACT,
+      MULTIPLY,
+      DIVIDE_QUOTIENT,
+      DIVIDE_MODULUS,
+      ALIGN,
+      DEREFERENCE,
+      ASSIGN
+    };
+
+    uint8_t opcode;
+    // For PUSH_VARIABLE, the variable's index.
+    uint8_t variable;
+    // For PUSH_LITERAL, the value.
+    uint32_t literal;
+  };
+
+  WindowsFrameProgram() : aligns_(false) {}
+
+  string program_string_;
+  std::vector<Instruction> code_;
+  // The names of the variables, by index, for messages and assignments.
+  std::vector<string> names_;
+  bool aligns_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_WINDOWS_FRAME_PROGRAM_H__
@@ -0,0 +1,192 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// windows_frame_program_unittest.cc: Unit tests for WindowsFrameProgram,
+// checking that compiled programs agree with PostfixEvaluator.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/memory_region.h"
+#include "processor/windows_frame_program.h"
+
+namespace {
+
+using google_breakpad::MemoryRegion;
+using google_breakpad::WindowsFrameProgram;
+
+// Dereferencing an address yields the address plus one, as in
+// postfix_evaluator_unittest.cc.  Addresses below 0x100 can't be read.
+class FakeMemoryRegion : public MemoryRegion {
+ public:
+  uint64_t GetBase() const { return 0x100; }
+  uint32_t GetSize() const { return 0xffffff00; }
+  bool GetMemoryAtAddress(uint64_t address, uint8_t* value) const {
+    return Get(address, value);
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint16_t* value) const {
+    return Get(address, value);
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint32_t* value) const {
+    return Get(address, value);
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const {
+    return Get(address, value);
+  }
+  void Print() const {}
+
+ private:
+  template<typename T>
+  bool Get(uint64_t address, T* value) const {
+    if (address < GetBase())
+      return false;
+    *value = address + 1;
+    return true;
+  }
+};
+
+class WindowsFrameProgramTest : public ::testing::Test {
+ public:
+  WindowsFrameProgramTest() {
+    initial_.Set(WindowsFrameProgram::EBP, 0x1000);
+    initial_.Set(WindowsFrameProgram::ESP, 0x2000);
+    initial_.Set(WindowsFrameProgram::CB_SAVED_REGS, 8);
+    initial_.Set(WindowsFrameProgram::RA_SEARCH_START, 0x2010);
+  }
+
+  // Runs |program_string| both compiled and through PostfixEvaluator,
+  // and checks that they agree on the result and on every fixed variable.
+  // Returns the result.
+  bool EvaluateBoth(const string& program_string,
+                    WindowsFrameProgram::Values* values) {
+    std::shared_ptr<const WindowsFrameProgram> program =
+        WindowsFrameProgram::Compile(program_string);
+    EXPECT_TRUE(program.get() != NULL);
+    WindowsFrameProgram::Values compiled = initial_;
+    WindowsFrameProgram::Values text = initial_;
+    bool compiled_result = program.get() != NULL &&
+                           program->Evaluate(memory_, &compiled);
+    bool text_result =
+        WindowsFrameProgram::EvaluateText(program_string, memory_, &text);
+    EXPECT_EQ(text_result, compiled_result) << program_string;
+    for (int i = 0; i < WindowsFrameProgram::FIXED_VARIABLE_COUNT; ++i) {
+      EXPECT_EQ(text.Assigned(i), compiled.Assigned(i))
+          << program_string << " variable " << i;
+      EXPECT_EQ(text.Get(i), compiled.Get(i))
+          << program_string << " variable " << i;
+    }
+    *values = compiled;
+    return compiled_result;
+  }
+
+  FakeMemoryRegion memory_;
+  WindowsFrameProgram::Values initial_;
+};
+
+TEST_F(WindowsFrameProgramTest, FramePointer) {
+  WindowsFrameProgram::Values values;
+  ASSERT_TRUE(EvaluateBoth(
+      "$T0 $ebp = $eip $T0 4 + ^ = $ebp $T0 ^ = $esp $T0 8 + =", &values));
+  EXPECT_TRUE(values.Assigned(WindowsFrameProgram::EIP));
+  EXPECT_EQ(0x1005U, values.Get(WindowsFrameProgram::EIP));
+  EXPECT_EQ(0x1001U, values.Get(WindowsFrameProgram::EBP));
+  EXPECT_EQ(0x1008U, values.Get(WindowsFrameProgram::ESP));
+  EXPECT_FALSE(values.Assigned(WindowsFrameProgram::EBX));
+}
+
+TEST_F(WindowsFrameProgramTest, Operators) {
+  WindowsFrameProgram::Values values;
+  ASSERT_TRUE(EvaluateBoth(
+      "$ebx $esp 3 * 7 - = $esi $ebp 7 / = $edi $ebp 7 % = "
+      "$eip $esp 16 @ = $ebp .cbSavedRegs .raSearchStart + =", &values));
+  EXPECT_EQ(0x2000U * 3 - 7, values.Get(WindowsFrameProgram::EBX));
+  EXPECT_EQ(0x1000U / 7, values.Get(WindowsFrameProgram::ESI));
+  EXPECT_EQ(0x1000U % 7, values.Get(WindowsFrameProgram::EDI));
+  EXPECT_EQ(0x2000U, values.Get(WindowsFrameProgram::EIP));
+  EXPECT_EQ(0x2018U, values.Get(WindowsFrameProgram::EBP));
+  EXPECT_TRUE(WindowsFrameProgram::Compile("$eip $esp 16 @ =")->aligns());
+  EXPECT_FALSE(WindowsFrameProgram::Compile("$eip $esp ^ =")->aligns());
+}
+
+// Some symbol files have no space between an operand and "=".
+TEST_F(WindowsFrameProgramTest, SmashedAssignment) {
+  WindowsFrameProgram::Values values;
+  ASSERT_TRUE(EvaluateBoth("$eip $esp ^ =$esp $esp 4 + =", &values));
+  EXPECT_EQ(0x2001U, values.Get(WindowsFrameProgram::EIP));
+  EXPECT_EQ(0x2004U, values.Get(WindowsFrameProgram::ESP));
+}
+
+TEST_F(WindowsFrameProgramTest, Failures) {
+  WindowsFrameProgram::Values values;
+  // Unreadable memory, after an assignment has been made.
+  EXPECT_FALSE(EvaluateBoth("$eip $esp = $esp 16 ^ =", &values));
+  EXPECT_TRUE(values.Assigned(WindowsFrameProgram::EIP));
+  EXPECT_FALSE(values.Assigned(WindowsFrameProgram::ESP));
+  // Division by zero, which PostfixEvaluator doesn't guard against.
+  values = initial_;
+  EXPECT_FALSE(WindowsFrameProgram::Compile("$eip $esp 0 / =")->Evaluate(
+      memory_, &values));
+  // Operands left on the stack.
+  EXPECT_FALSE(EvaluateBoth("$eip $esp = $esp", &values));
+  // Assignment to something other than an identifier.
+  EXPECT_FALSE(EvaluateBoth("4 $esp =", &values));
+  // Too few operands.
+  EXPECT_FALSE(EvaluateBoth("$eip + =", &values));
+}
+
+// Programs beyond the limits aren't compiled, and evaluating them from
+// their text gives the same results.
+TEST_F(WindowsFrameProgramTest, Limits) {
+  string many_variables;
+  for (size_t i = 0; i < WindowsFrameProgram::kMaxVariables; ++i)
+    many_variables += "$T" + std::to_string(i) + " 1 = ";
+  many_variables += "$eip $esp =";
+  EXPECT_TRUE(WindowsFrameProgram::Compile(many_variables).get() == NULL);
+
+  string deep = "$eip";
+  for (size_t i = 0; i <= WindowsFrameProgram::kMaxStackDepth; ++i)
+    deep += " 1";
+  for (size_t i = 0; i < WindowsFrameProgram::kMaxStackDepth; ++i)
+    deep += " +";
+  deep += " =";
+  EXPECT_TRUE(WindowsFrameProgram::Compile(deep).get() == NULL);
+
+  WindowsFrameProgram::Values values = initial_;
+  ASSERT_TRUE(WindowsFrameProgram::EvaluateText(deep, memory_, &values));
+  EXPECT_TRUE(values.Assigned(WindowsFrameProgram::EIP));
+  EXPECT_EQ(WindowsFrameProgram::kMaxStackDepth + 1,
+            values.Get(WindowsFrameProgram::EIP));
+}
+
+}  // namespace
@@ -0,0 +1,1924 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// x86_instruction_decoder.cc: Decodes single x86 and x86-64 instructions
+// into objdump's Intel syntax.
+//
+// See x86_instruction_decoder.h for documentation.
+//
+// Instructions are described by tables of opcodes whose operands are
+// written in a notation close to the one in the Intel and AMD manuals: a
+// letter for the addressing method followed by one for the operand size.
+//
+//   E  ModRM r/m, a register or memory     G  ModRM reg, a register
+//   M  ModRM r/m, memory only              Z  register in the opcode's
+//   I  immediate                              low three bits
+//   J  branch displacement                 O  absolute memory offset
+//   X  string source, ds:[rsi]             Y  string destination, es:[rdi]
+//   S  segment register in ModRM reg       A  accumulator
+//   V  vector register in ModRM reg        W  vector register or memory
+//   U  vector register in ModRM r/m        H  VEX.vvvv vector register
+//   P  MMX register in ModRM reg           Q  MMX register or memory
+//   N  MMX register in ModRM r/m           B  VEX.vvvv general register
+//   =  the rest of the operand is printed as is
+//
+// with sizes
+//
+//   b  byte            w  word            d  doubleword
+//   q  quadword        o  octword (xmm)   t  ten bytes
+//   v  the operand size: 16, 32 or 64 bits
+//   y  doubleword, or quadword with REX.W or VEX.W
+//   z  an immediate of the operand size, at most 32 bits, sign extended
+//   s  a byte immediate, sign extended to the operand size
+//   f  the stack operand size, for pushes, pops and indirect branches
+//   p  a far pointer
+//   m  a register of the operand size, or a word of memory
+//   x  xmm, or ymm with VEX.L
+//
+// Vector instructions also have VEX forms, whose mnemonics are prefixed
+// with "v" and which take the H operands that their legacy forms lack.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include "processor/x86_instruction_decoder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "google_breakpad/common/minidump_format.h"
+
+namespace google_breakpad {
+namespace {
+
+using std::vector;
+
+const char* const kRegisters8[] = {
+  "al", "cl", "dl", "bl", "ah", "ch", "dh", "bh"
+};
+const char* const kRegisters8REX[] = {
+  "al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil",
+  "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b"
+};
+const char* const kRegisters16[] = {
+  "ax", "cx", "dx", "bx", "sp", "bp", "si", "di",
+  "r8w", "r9w", "r10w", "r11w", "r12w", "r13w", "r14w", "r15w"
+};
+const char* const kRegisters32[] = {
+  "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi",
+  "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"
+};
+const char* const kRegisters64[] = {
+  "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+  "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"
+};
+const char* const kSegmentRegisters[] = {"es", "cs", "ss", "ds", "fs", "gs"};
+const char* const kConditions[] = {
+  "o", "no", "b", "ae", "e", "ne", "be", "a",
+  "s", "ns", "p", "np", "l", "ge", "le", "g"
+};
+
+// Mnemonics of the instruction groups that are selected by ModRM reg.
+const char* const kGroup1[] = {
+  "add", "or", "adc", "sbb", "and", "sub", "xor", "cmp"
+};
+const char* const kGroup1A[] = {
+  "pop", NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+const char* const kGroup2[] = {
+  "rol", "ror", "rcl", "rcr", "shl", "shr", NULL, "sar"
+};
+const char* const kGroup3[] = {
+  "test", NULL, "not", "neg", "mul", "imul", "div", "idiv"
+};
+const char* const kGroup4[] = {
+  "inc", "dec", NULL, NULL, NULL, NULL, NULL, NULL
+};
+const char* const kGroup11[] = {
+  "mov", NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+const char* const kGroup8[] = {
+  NULL, NULL, NULL, NULL, "bt", "bts", "btr", "btc"
+};
+const char* const kGroup16[] = {
+  "prefetchnta", "prefetcht0", "prefetcht1", "prefetcht2",
+  NULL, NULL, NULL, NULL
+};
+const char* const kGroupPrefetch[] = {
+  "prefetch", "prefetchw", NULL, NULL, NULL, NULL, NULL, NULL
+};
+const char* const kGroupNop[] = {
+  "nop", NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+const char* const kGroup17[] = {
+  NULL, "blsr", "blsmsk", "blsi", NULL, NULL, NULL, NULL
+};
+
+// Flags for Opcode.
+enum {
+  // Not valid in 64-bit mode.
+  kNot64 = 1 << 0,
+  // Only valid in 64-bit mode.
+  kOnly64 = 1 << 1,
+  // The instruction's 66, F3 or F2 prefix selects it, instead of changing
+  // its operand size or repeating it.  Opcode::prefix is that prefix, or 0
+  // for none.
+  kMandatoryPrefix = 1 << 2,
+  // Only valid with a memory operand.
+  kMemoryOnly = 1 << 3,
+  // Only valid with a register operand.
+  kRegisterOnly = 1 << 4,
+  // Also valid with a VEX prefix.
+  kVEX = 1 << 5,
+  // Only valid with a VEX prefix, with a mnemonic that is used unchanged.
+  kVEXOnly = 1 << 6,
+  // REX.W or VEX.W changes the final "d" of the mnemonic to "q".
+  kWideQ = 1 << 7,
+  // A string instruction, which may be repeated with F3.
+  kString = 1 << 8,
+  // A string instruction whose F3 and F2 prefixes print as repz and repnz.
+  kStringCompare = 1 << 9,
+  // A branch, which may carry an F2 (bnd) prefix, or a 3E (notrack) prefix
+  // if it is indirect.
+  kBranch = 1 << 10,
+  // A conditional instruction: the mnemonic is completed with the
+  // condition in the opcode's low four bits.
+  kCondition = 1 << 11,
+  // A stack instruction whose mnemonic gets a "w" suffix with a 16-bit
+  // stack operand size, because no operand shows the size.
+  kStackSuffix = 1 << 12,
+};
+
+struct Opcode {
+  // 0 for one-byte opcodes, 1 for 0F xx, 2 for 0F 38 xx and 3 for 0F 3A xx.
+  uint8_t map;
+  // The range of opcodes that the entry covers.
+  uint8_t first;
+  uint8_t last;
+  // With kMandatoryPrefix, the prefix that selects this entry.  Otherwise
+  // 0, or F3 for the few general instructions that the F3 prefix selects.
+  uint8_t prefix;
+  int flags;
+  const char* mnemonic;
+  // When set, the mnemonics selected by ModRM reg, replacing |mnemonic|.
+  const char* const* group;
+  const char* operands;
+};
+
+const Opcode kOpcodes[] = {
+  // One-byte opcodes.
+  {0, 0x00, 0x00, 0, 0, "add", NULL, "Eb,Gb"},
+  {0, 0x01, 0x01, 0, 0, "add", NULL, "Ev,Gv"},
+  {0, 0x02, 0x02, 0, 0, "add", NULL, "Gb,Eb"},
+  {0, 0x03, 0x03, 0, 0, "add", NULL, "Gv,Ev"},
+  {0, 0x04, 0x04, 0, 0, "add", NULL, "=al,Ib"},
+  {0, 0x05, 0x05, 0, 0, "add", NULL, "Av,Iz"},
+  {0, 0x06, 0x06, 0, kNot64 | kStackSuffix, "push", NULL, "=es"},
+  {0, 0x07, 0x07, 0, kNot64 | kStackSuffix, "pop", NULL, "=es"},
+  {0, 0x08, 0x08, 0, 0, "or", NULL, "Eb,Gb"},
+  {0, 0x09, 0x09, 0, 0, "or", NULL, "Ev,Gv"},
+  {0, 0x0a, 0x0a, 0, 0, "or", NULL, "Gb,Eb"},
+  {0, 0x0b, 0x0b, 0, 0, "or", NULL, "Gv,Ev"},
+  {0, 0x0c, 0x0c, 0, 0, "or", NULL, "=al,Ib"},
+  {0, 0x0d, 0x0d, 0, 0, "or", NULL, "Av,Iz"},
+  {0, 0x0e, 0x0e, 0, kNot64 | kStackSuffix, "push", NULL, "=cs"},
+  {0, 0x10, 0x10, 0, 0, "adc", NULL, "Eb,Gb"},
+  {0, 0x11, 0x11, 0, 0, "adc", NULL, "Ev,Gv"},
+  {0, 0x12, 0x12, 0, 0, "adc", NULL, "Gb,Eb"},
+  {0, 0x13, 0x13, 0, 0, "adc", NULL, "Gv,Ev"},
+  {0, 0x14, 0x14, 0, 0, "adc", NULL, "=al,Ib"},
+  {0, 0x15, 0x15, 0, 0, "adc", NULL, "Av,Iz"},
+  {0, 0x16, 0x16, 0, kNot64 | kStackSuffix, "push", NULL, "=ss"},
+  {0, 0x17, 0x17, 0, kNot64 | kStackSuffix, "pop", NULL, "=ss"},
+  {0, 0x18, 0x18, 0, 0, "sbb", NULL, "Eb,Gb"},
+  {0, 0x19, 0x19, 0, 0, "sbb", NULL, "Ev,Gv"},
+  {0, 0x1a, 0x1a, 0, 0, "sbb", NULL, "Gb,Eb"},
+  {0, 0x1b, 0x1b, 0, 0, "sbb", NULL, "Gv,Ev"},
+  {0, 0x1c, 0x1c, 0, 0, "sbb", NULL, "=al,Ib"},
+  {0, 0x1d, 0x1d, 0, 0, "sbb", NULL, "Av,Iz"},
+  {0, 0x1e, 0x1e, 0, kNot64 | kStackSuffix, "push", NULL, "=ds"},
+  {0, 0x1f, 0x1f, 0, kNot64 | kStackSuffix, "pop", NULL, "=ds"},
+  {0, 0x20, 0x20, 0, 0, "and", NULL, "Eb,Gb"},
+  {0, 0x21, 0x21, 0, 0, "and", NULL, "Ev,Gv"},
+  {0, 0x22, 0x22, 0, 0, "and", NULL, "Gb,Eb"},
+  {0, 0x23, 0x23, 0, 0, "and", NULL, "Gv,Ev"},
+  {0, 0x24, 0x24, 0, 0, "and", NULL, "=al,Ib"},
+  {0, 0x25, 0x25, 0, 0, "and", NULL, "Av,Iz"},
+  {0, 0x27, 0x27, 0, kNot64, "daa", NULL, ""},
+  {0, 0x28, 0x28, 0, 0, "sub", NULL, "Eb,Gb"},
+  {0, 0x29, 0x29, 0, 0, "sub", NULL, "Ev,Gv"},
+  {0, 0x2a, 0x2a, 0, 0, "sub", NULL, "Gb,Eb"},
+  {0, 0x2b, 0x2b, 0, 0, "sub", NULL, "Gv,Ev"},
+  {0, 0x2c, 0x2c, 0, 0, "sub", NULL, "=al,Ib"},
+  {0, 0x2d, 0x2d, 0, 0, "sub", NULL, "Av,Iz"},
+  {0, 0x2f, 0x2f, 0, kNot64, "das", NULL, ""},
+  {0, 0x30, 0x30, 0, 0, "xor", NULL, "Eb,Gb"},
+  {0, 0x31, 0x31, 0, 0, "xor", NULL, "Ev,Gv"},
+  {0, 0x32, 0x32, 0, 0, "xor", NULL, "Gb,Eb"},
+  {0, 0x33, 0x33, 0, 0, "xor", NULL, "Gv,Ev"},
+  {0, 0x34, 0x34, 0, 0, "xor", NULL, "=al,Ib"},
+  {0, 0x35, 0x35, 0, 0, "xor", NULL, "Av,Iz"},
+  {0, 0x37, 0x37, 0, kNot64, "aaa", NULL, ""},
+  {0, 0x38, 0x38, 0, 0, "cmp", NULL, "Eb,Gb"},
+  {0, 0x39, 0x39, 0, 0, "cmp", NULL, "Ev,Gv"},
+  {0, 0x3a, 0x3a, 0, 0, "cmp", NULL, "Gb,Eb"},
+  {0, 0x3b, 0x3b, 0, 0, "cmp", NULL, "Gv,Ev"},
+  {0, 0x3c, 0x3c, 0, 0, "cmp", NULL, "=al,Ib"},
+  {0, 0x3d, 0x3d, 0, 0, "cmp", NULL, "Av,Iz"},
+  {0, 0x3f, 0x3f, 0, kNot64, "aas", NULL, ""},
+  {0, 0x40, 0x47, 0, kNot64, "inc", NULL, "Zv"},
+  {0, 0x48, 0x4f, 0, kNot64, "dec", NULL, "Zv"},
+  {0, 0x50, 0x57, 0, 0, "push", NULL, "Zf"},
+  {0, 0x58, 0x5f, 0, 0, "pop", NULL, "Zf"},
+  {0, 0x60, 0x60, 0, kNot64 | kStackSuffix, "pusha", NULL, ""},
+  {0, 0x61, 0x61, 0, kNot64 | kStackSuffix, "popa", NULL, ""},
+  {0, 0x63, 0x63, 0, kNot64, "arpl", NULL, "Ew,Gw"},
+  {0, 0x63, 0x63, 0, kOnly64, "movsxd", NULL, "Gv,Ed"},
+  {0, 0x68, 0x68, 0, kStackSuffix, "push", NULL, "If"},
+  {0, 0x69, 0x69, 0, 0, "imul", NULL, "Gv,Ev,Iz"},
+  {0, 0x6a, 0x6a, 0, kStackSuffix, "push", NULL, "Ibf"},
+  {0, 0x6b, 0x6b, 0, 0, "imul", NULL, "Gv,Ev,Is"},
+  {0, 0x6c, 0x6c, 0, kString, "ins", NULL, "Yb,=dx"},
+  {0, 0x6d, 0x6d, 0, kString, "ins", NULL, "Yz,=dx"},
+  {0, 0x6e, 0x6e, 0, kString, "outs", NULL, "=dx,Xb"},
+  {0, 0x6f, 0x6f, 0, kString, "outs", NULL, "=dx,Xz"},
+  {0, 0x70, 0x7f, 0, kBranch | kCondition, "j", NULL, "Jb"},
+  {0, 0x80, 0x80, 0, 0, NULL, kGroup1, "Eb,Ib"},
+  {0, 0x81, 0x81, 0, 0, NULL, kGroup1, "Ev,Iz"},
+  {0, 0x82, 0x82, 0, kNot64, NULL, kGroup1, "Eb,Ib"},
+  {0, 0x83, 0x83, 0, 0, NULL, kGroup1, "Ev,Is"},
+  {0, 0x84, 0x84, 0, 0, "test", NULL, "Eb,Gb"},
+  {0, 0x85, 0x85, 0, 0, "test", NULL, "Ev,Gv"},
+  {0, 0x86, 0x86, 0, 0, "xchg", NULL, "Eb,Gb"},
+  {0, 0x87, 0x87, 0, 0, "xchg", NULL, "Ev,Gv"},
+  {0, 0x88, 0x88, 0, 0, "mov", NULL, "Eb,Gb"},
+  {0, 0x89, 0x89, 0, 0, "mov", NULL, "Ev,Gv"},
+  {0, 0x8a, 0x8a, 0, 0, "mov", NULL, "Gb,Eb"},
+  {0, 0x8b, 0x8b, 0, 0, "mov", NULL, "Gv,Ev"},
+  {0, 0x8c, 0x8c, 0, 0, "mov", NULL, "Em,Sw"},
+  {0, 0x8d, 0x8d, 0, 0, "lea", NULL, "Gv,M"},
+  {0, 0x8e, 0x8e, 0, 0, "mov", NULL, "Sw,Em"},
+  {0, 0x8f, 0x8f, 0, 0, NULL, kGroup1A, "Ef"},
+  {0, 0x91, 0x97, 0, 0, "xchg", NULL, "Zv,Av"},
+  {0, 0x9b, 0x9b, 0, 0, "fwait", NULL, ""},
+  {0, 0x9c, 0x9c, 0, kStackSuffix, "pushf", NULL, ""},
+  {0, 0x9d, 0x9d, 0, kStackSuffix, "popf", NULL, ""},
+  {0, 0x9e, 0x9e, 0, 0, "sahf", NULL, ""},
+  {0, 0x9f, 0x9f, 0, 0, "lahf", NULL, ""},
+  {0, 0xa0, 0xa0, 0, 0, "mov", NULL, "=al,Ob"},
+  {0, 0xa1, 0xa1, 0, 0, "mov", NULL, "Av,Ov"},
+  {0, 0xa2, 0xa2, 0, 0, "mov", NULL, "Ob,=al"},
+  {0, 0xa3, 0xa3, 0, 0, "mov", NULL, "Ov,Av"},
+  {0, 0xa4, 0xa4, 0, kString, "movs", NULL, "Yb,Xb"},
+  {0, 0xa5, 0xa5, 0, kString, "movs", NULL, "Yv,Xv"},
+  {0, 0xa6, 0xa6, 0, kString | kStringCompare, "cmps", NULL, "Xb,Yb"},
+  {0, 0xa7, 0xa7, 0, kString | kStringCompare, "cmps", NULL, "Xv,Yv"},
+  {0, 0xa8, 0xa8, 0, 0, "test", NULL, "=al,Ib"},
+  {0, 0xa9, 0xa9, 0, 0, "test", NULL, "Av,Iz"},
+  {0, 0xaa, 0xaa, 0, kString, "stos", NULL, "Yb,=al"},
+  {0, 0xab, 0xab, 0, kString, "stos", NULL, "Yv,Av"},
+  {0, 0xac, 0xac, 0, kString, "lods", NULL, "=al,Xb"},
+  {0, 0xad, 0xad, 0, kString, "lods", NULL, "Av,Xv"},
+  {0, 0xae, 0xae, 0, kString | kStringCompare, "scas", NULL, "=al,Yb"},
+  {0, 0xaf, 0xaf, 0, kString | kStringCompare, "scas", NULL, "Av,Yv"},
+  {0, 0xb0, 0xb7, 0, 0, "mov", NULL, "Zb,Ib"},
+  {0, 0xb8, 0xbf, 0, 0, "mov", NULL, "Zv,Iv"},
+  {0, 0xc0, 0xc0, 0, 0, NULL, kGroup2, "Eb,Ib"},
+  {0, 0xc1, 0xc1, 0, 0, NULL, kGroup2, "Ev,Ib"},
+  {0, 0xc2, 0xc2, 0, kBranch | kStackSuffix, "ret", NULL, "Iw"},
+  {0, 0xc3, 0xc3, 0, kBranch | kStackSuffix, "ret", NULL, ""},
+  {0, 0xc6, 0xc6, 0, 0, NULL, kGroup11, "Eb,Ib"},
+  {0, 0xc7, 0xc7, 0, 0, NULL, kGroup11, "Ev,Iz"},
+  {0, 0xc8, 0xc8, 0, kStackSuffix, "enter", NULL, "Iw,Ib"},
+  {0, 0xc9, 0xc9, 0, kStackSuffix, "leave", NULL, ""},
+  {0, 0xcc, 0xcc, 0, 0, "int3", NULL, ""},
+  {0, 0xcd, 0xcd, 0, 0, "int", NULL, "Ib"},
+  {0, 0xce, 0xce, 0, kNot64, "into", NULL, ""},
+  {0, 0xd0, 0xd0, 0, 0, NULL, kGroup2, "Eb,=1"},
+  {0, 0xd1, 0xd1, 0, 0, NULL, kGroup2, "Ev,=1"},
+  {0, 0xd2, 0xd2, 0, 0, NULL, kGroup2, "Eb,=cl"},
+  {0, 0xd3, 0xd3, 0, 0, NULL, kGroup2, "Ev,=cl"},
+  {0, 0xd4, 0xd4, 0, kNot64, "aam", NULL, "Ib"},
+  {0, 0xd5, 0xd5, 0, kNot64, "aad", NULL, "Ib"},
+  {0, 0xe0, 0xe0, 0, 0, "loopne", NULL, "Jb"},
+  {0, 0xe1, 0xe1, 0, 0, "loope", NULL, "Jb"},
+  {0, 0xe2, 0xe2, 0, 0, "loop", NULL, "Jb"},
+  {0, 0xe4, 0xe4, 0, 0, "in", NULL, "=al,Ib"},
+  {0, 0xe5, 0xe5, 0, 0, "in", NULL, "Az,Ib"},
+  {0, 0xe6, 0xe6, 0, 0, "out", NULL, "Ib,=al"},
+  {0, 0xe7, 0xe7, 0, 0, "out", NULL, "Ib,Az"},
+  {0, 0xe8, 0xe8, 0, kBranch, "call", NULL, "Jz"},
+  {0, 0xe9, 0xe9, 0, kBranch, "jmp", NULL, "Jz"},
+  {0, 0xeb, 0xeb, 0, kBranch, "jmp", NULL, "Jb"},
+  {0, 0xec, 0xec, 0, 0, "in", NULL, "=al,=dx"},
+  {0, 0xed, 0xed, 0, 0, "in", NULL, "Az,=dx"},
+  {0, 0xee, 0xee, 0, 0, "out", NULL, "=dx,=al"},
+  {0, 0xef, 0xef, 0, 0, "out", NULL, "=dx,Az"},
+  {0, 0xf4, 0xf4, 0, 0, "hlt", NULL, ""},
+  {0, 0xf5, 0xf5, 0, 0, "cmc", NULL, ""},
+  {0, 0xf6, 0xf6, 0, 0, NULL, kGroup3, "Eb"},
+  {0, 0xf7, 0xf7, 0, 0, NULL, kGroup3, "Ev"},
+  {0, 0xf8, 0xf8, 0, 0, "clc", NULL, ""},
+  {0, 0xf9, 0xf9, 0, 0, "stc", NULL, ""},
+  {0, 0xfa, 0xfa, 0, 0, "cli", NULL, ""},
+  {0, 0xfb, 0xfb, 0, 0, "sti", NULL, ""},
+  {0, 0xfc, 0xfc, 0, 0, "cld", NULL, ""},
+  {0, 0xfd, 0xfd, 0, 0, "std", NULL, ""},
+  {0, 0xfe, 0xfe, 0, 0, NULL, kGroup4, "Eb"},
+
+  // General instructions in the 0F maps.  The entries that an F3 or F2
+  // prefix selects come before those that the prefix would repeat.
+  {1, 0xb8, 0xb8, 0xf3, 0, "popcnt", NULL, "Gv,Ev"},
+  {1, 0xbc, 0xbc, 0xf3, 0, "tzcnt", NULL, "Gv,Ev"},
+  {1, 0xbd, 0xbd, 0xf3, 0, "lzcnt", NULL, "Gv,Ev"},
+  {2, 0xf0, 0xf0, 0xf2, 0, "crc32", NULL, "Gy,Eb"},
+  {2, 0xf1, 0xf1, 0xf2, 0, "crc32", NULL, "Gy,Ev"},
+  {1, 0x05, 0x05, 0, kOnly64, "syscall", NULL, ""},
+  {1, 0x0b, 0x0b, 0, 0, "ud2", NULL, ""},
+  {1, 0x0d, 0x0d, 0, kMemoryOnly, NULL, kGroupPrefetch, "Mb"},
+  {1, 0x18, 0x18, 0, kMemoryOnly, NULL, kGroup16, "Mb"},
+  {1, 0x1f, 0x1f, 0, 0, NULL, kGroupNop, "Ev"},
+  {1, 0x31, 0x31, 0, 0, "rdtsc", NULL, ""},
+  {1, 0x40, 0x4f, 0, kCondition, "cmov", NULL, "Gv,Ev"},
+  {1, 0x80, 0x8f, 0, kBranch | kCondition, "j", NULL, "Jz"},
+  {1, 0x90, 0x9f, 0, kCondition, "set", NULL, "Eb"},
+  {1, 0xa0, 0xa0, 0, kStackSuffix, "push", NULL, "=fs"},
+  {1, 0xa1, 0xa1, 0, kStackSuffix, "pop", NULL, "=fs"},
+  {1, 0xa2, 0xa2, 0, 0, "cpuid", NULL, ""},
+  {1, 0xa3, 0xa3, 0, 0, "bt", NULL, "Ev,Gv"},
+  {1, 0xa4, 0xa4, 0, 0, "shld", NULL, "Ev,Gv,Ib"},
+  {1, 0xa5, 0xa5, 0, 0, "shld", NULL, "Ev,Gv,=cl"},
+  {1, 0xa8, 0xa8, 0, kStackSuffix, "push", NULL, "=gs"},
+  {1, 0xa9, 0xa9, 0, kStackSuffix, "pop", NULL, "=gs"},
+  {1, 0xab, 0xab, 0, 0, "bts", NULL, "Ev,Gv"},
+  {1, 0xac, 0xac, 0, 0, "shrd", NULL, "Ev,Gv,Ib"},
+  {1, 0xad, 0xad, 0, 0, "shrd", NULL, "Ev,Gv,=cl"},
+  {1, 0xaf, 0xaf, 0, 0, "imul", NULL, "Gv,Ev"},
+  {1, 0xb0, 0xb0, 0, 0, "cmpxchg", NULL, "Eb,Gb"},
+  {1, 0xb1, 0xb1, 0, 0, "cmpxchg", NULL, "Ev,Gv"},
+  {1, 0xb3, 0xb3, 0, 0, "btr", NULL, "Ev,Gv"},
+  {1, 0xb6, 0xb6, 0, 0, "movzx", NULL, "Gv,Eb"},
+  {1, 0xb7, 0xb7, 0, 0, "movzx", NULL, "Gv,Ew"},
+  {1, 0xba, 0xba, 0, 0, NULL, kGroup8, "Ev,Ib"},
+  {1, 0xbb, 0xbb, 0, 0, "btc", NULL, "Ev,Gv"},
+  {1, 0xbc, 0xbc, 0, 0, "bsf", NULL, "Gv,Ev"},
+  {1, 0xbd, 0xbd, 0, 0, "bsr", NULL, "Gv,Ev"},
+  {1, 0xbe, 0xbe, 0, 0, "movsx", NULL, "Gv,Eb"},
+  {1, 0xbf, 0xbf, 0, 0, "movsx", NULL, "Gv,Ew"},
+  {1, 0xc0, 0xc0, 0, 0, "xadd", NULL, "Eb,Gb"},
+  {1, 0xc1, 0xc1, 0, 0, "xadd", NULL, "Ev,Gv"},
+  {1, 0xc3, 0xc3, 0, kMemoryOnly, "movnti", NULL, "My,Gy"},
+  {1, 0xc8, 0xcf, 0, 0, "bswap", NULL, "Zv"},
+  {2, 0xf0, 0xf0, 0, kMemoryOnly, "movbe", NULL, "Gv,Mv"},
+  {2, 0xf1, 0xf1, 0, kMemoryOnly, "movbe", NULL, "Mv,Gv"},
+
+  // SSE and AVX instructions.
+  {1, 0x10, 0x10, 0x00, kMandatoryPrefix | kVEX, "movups", NULL, "Vx,Wx"},
+  {1, 0x10, 0x10, 0x66, kMandatoryPrefix | kVEX, "movupd", NULL, "Vx,Wx"},
+  {1, 0x10, 0x10, 0xf3, kMandatoryPrefix | kVEX | kMemoryOnly, "movss", NULL,
+   "Vo,Wd"},
+  {1, 0x10, 0x10, 0xf3, kMandatoryPrefix | kVEX | kRegisterOnly, "movss",
+   NULL, "Vo,Ho,Uo"},
+  {1, 0x10, 0x10, 0xf2, kMandatoryPrefix | kVEX | kMemoryOnly, "movsd", NULL,
+   "Vo,Wq"},
+  {1, 0x10, 0x10, 0xf2, kMandatoryPrefix | kVEX | kRegisterOnly, "movsd",
+   NULL, "Vo,Ho,Uo"},
+  {1, 0x11, 0x11, 0x00, kMandatoryPrefix | kVEX, "movups", NULL, "Wx,Vx"},
+  {1, 0x11, 0x11, 0x66, kMandatoryPrefix | kVEX, "movupd", NULL, "Wx,Vx"},
+  {1, 0x11, 0x11, 0xf3, kMandatoryPrefix | kVEX | kMemoryOnly, "movss", NULL,
+   "Wd,Vo"},
+  {1, 0x11, 0x11, 0xf3, kMandatoryPrefix | kVEX | kRegisterOnly, "movss",
+   NULL, "Uo,Ho,Vo"},
+  {1, 0x11, 0x11, 0xf2, kMandatoryPrefix | kVEX | kMemoryOnly, "movsd", NULL,
+   "Wq,Vo"},
+  {1, 0x11, 0x11, 0xf2, kMandatoryPrefix | kVEX | kRegisterOnly, "movsd",
+   NULL, "Uo,Ho,Vo"},
+  {1, 0x12, 0x12, 0x00, kMandatoryPrefix | kVEX | kMemoryOnly, "movlps", NULL,
+   "Vo,Ho,Mq"},
+  {1, 0x12, 0x12, 0x00, kMandatoryPrefix | kVEX | kRegisterOnly, "movhlps",
+   NULL, "Vo,Ho,Uo"},
+  {1, 0x12, 0x12, 0x66, kMandatoryPrefix | kVEX | kMemoryOnly, "movlpd", NULL,
+   "Vo,Ho,Mq"},
+  {1, 0x13, 0x13, 0x00, kMandatoryPrefix | kVEX | kMemoryOnly, "movlps", NULL,
+   "Mq,Vo"},
+  {1, 0x13, 0x13, 0x66, kMandatoryPrefix | kVEX | kMemoryOnly, "movlpd", NULL,
+   "Mq,Vo"},
+  {1, 0x14, 0x14, 0x00, kMandatoryPrefix | kVEX, "unpcklps", NULL,
+   "Vx,Hx,Wx"},
+  {1, 0x14, 0x14, 0x66, kMandatoryPrefix | kVEX, "unpcklpd", NULL,
+   "Vx,Hx,Wx"},
+  {1, 0x15, 0x15, 0x00, kMandatoryPrefix | kVEX, "unpckhps", NULL,
+   "Vx,Hx,Wx"},
+  {1, 0x15, 0x15, 0x66, kMandatoryPrefix | kVEX, "unpckhpd", NULL,
+   "Vx,Hx,Wx"},
+  {1, 0x16, 0x16, 0x00, kMandatoryPrefix | kVEX | kMemoryOnly, "movhps", NULL,
+   "Vo,Ho,Mq"},
+  {1, 0x16, 0x16, 0x00, kMandatoryPrefix | kVEX | kRegisterOnly, "movlhps",
+   NULL, "Vo,Ho,Uo"},
+  {1, 0x16, 0x16, 0x66, kMandatoryPrefix | kVEX | kMemoryOnly, "movhpd", NULL,
+   "Vo,Ho,Mq"},
+  {1, 0x17, 0x17, 0x00, kMandatoryPrefix | kVEX | kMemoryOnly, "movhps", NULL,
+   "Mq,Vo"},
+  {1, 0x17, 0x17, 0x66, kMandatoryPrefix | kVEX | kMemoryOnly, "movhpd", NULL,
+   "Mq,Vo"},
+  {1, 0x28, 0x28, 0x00, kMandatoryPrefix | kVEX, "movaps", NULL, "Vx,Wx"},
+  {1, 0x28, 0x28, 0x66, kMandatoryPrefix | kVEX, "movapd", NULL, "Vx,Wx"},
+  {1, 0x29, 0x29, 0x00, kMandatoryPrefix | kVEX, "movaps", NULL, "Wx,Vx"},
+  {1, 0x29, 0x29, 0x66, kMandatoryPrefix | kVEX, "movapd", NULL, "Wx,Vx"},
+  {1, 0x2a, 0x2a, 0xf3, kMandatoryPrefix | kVEX, "cvtsi2ss", NULL,
+   "Vo,Ho,Ey"},
+  {1, 0x2a, 0x2a, 0xf2, kMandatoryPrefix | kVEX, "cvtsi2sd", NULL,
+   "Vo,Ho,Ey"},
+  {1, 0x2b, 0x2b, 0x00, kMandatoryPrefix | kVEX | kMemoryOnly, "movntps",
+   NULL, "Mx,Vx"},
+  {1, 0x2b, 0x2b, 0x66, kMandatoryPrefix | kVEX | kMemoryOnly, "movntpd",
+   NULL, "Mx,Vx"},
+  {1, 0x2c, 0x2c, 0xf3, kMandatoryPrefix | kVEX, "cvttss2si", NULL, "Gy,Wd"},
+  {1, 0x2c, 0x2c, 0xf2, kMandatoryPrefix | kVEX, "cvttsd2si", NULL, "Gy,Wq"},
+  {1, 0x2d, 0x2d, 0xf3, kMandatoryPrefix | kVEX, "cvtss2si", NULL, "Gy,Wd"},
+  {1, 0x2d, 0x2d, 0xf2, kMandatoryPrefix | kVEX, "cvtsd2si", NULL, "Gy,Wq"},
+  {1, 0x2e, 0x2e, 0x00, kMandatoryPrefix | kVEX, "ucomiss", NULL, "Vo,Wd"},
+  {1, 0x2e, 0x2e, 0x66, kMandatoryPrefix | kVEX, "ucomisd", NULL, "Vo,Wq"},
+  {1, 0x2f, 0x2f, 0x00, kMandatoryPrefix | kVEX, "comiss", NULL, "Vo,Wd"},
+  {1, 0x2f, 0x2f, 0x66, kMandatoryPrefix | kVEX, "comisd", NULL, "Vo,Wq"},
+  {1, 0x50, 0x50, 0x00, kMandatoryPrefix | kVEX | kRegisterOnly, "movmskps",
+   NULL, "Gy,Ux"},
+  {1, 0x50, 0x50, 0x66, kMandatoryPrefix | kVEX | kRegisterOnly, "movmskpd",
+   NULL, "Gy,Ux"},
+  {1, 0x51, 0x51, 0x00, kMandatoryPrefix | kVEX, "sqrtps", NULL, "Vx,Wx"},
+  {1, 0x51, 0x51, 0x66, kMandatoryPrefix | kVEX, "sqrtpd", NULL, "Vx,Wx"},
+  {1, 0x51, 0x51, 0xf3, kMandatoryPrefix | kVEX, "sqrtss", NULL, "Vo,Ho,Wd"},
+  {1, 0x51, 0x51, 0xf2, kMandatoryPrefix | kVEX, "sqrtsd", NULL, "Vo,Ho,Wq"},
+  {1, 0x54, 0x54, 0x00, kMandatoryPrefix | kVEX, "andps", NULL, "Vx,Hx,Wx"},
+  {1, 0x54, 0x54, 0x66, kMandatoryPrefix | kVEX, "andpd", NULL, "Vx,Hx,Wx"},
+  {1, 0x55, 0x55, 0x00, kMandatoryPrefix | kVEX, "andnps", NULL, "Vx,Hx,Wx"},
+  {1, 0x55, 0x55, 0x66, kMandatoryPrefix | kVEX, "andnpd", NULL, "Vx,Hx,Wx"},
+  {1, 0x56, 0x56, 0x00, kMandatoryPrefix | kVEX, "orps", NULL, "Vx,Hx,Wx"},
+  {1, 0x56, 0x56, 0x66, kMandatoryPrefix | kVEX, "orpd", NULL, "Vx,Hx,Wx"},
+  {1, 0x57, 0x57, 0x00, kMandatoryPrefix | kVEX, "xorps", NULL, "Vx,Hx,Wx"},
+  {1, 0x57, 0x57, 0x66, kMandatoryPrefix | kVEX, "xorpd", NULL, "Vx,Hx,Wx"},
+#define SSE_ARITHMETIC(opcode, name)                                \
+  {1, opcode, opcode, 0x00, kMandatoryPrefix | kVEX, name "ps", NULL, \
+   "Vx,Hx,Wx"},                                                     \
+  {1, opcode, opcode, 0x66, kMandatoryPrefix | kVEX, name "pd", NULL, \
+   "Vx,Hx,Wx"},                                                     \
+  {1, opcode, opcode, 0xf3, kMandatoryPrefix | kVEX, name "ss", NULL, \
+   "Vo,Ho,Wd"},                                                     \
+  {1, opcode, opcode, 0xf2, kMandatoryPrefix | kVEX, name "sd", NULL, \
+   "Vo,Ho,Wq"}
+  SSE_ARITHMETIC(0x58, "add"),
+  SSE_ARITHMETIC(0x59, "mul"),
+  SSE_ARITHMETIC(0x5c, "sub"),
+  SSE_ARITHMETIC(0x5d, "min"),
+  SSE_ARITHMETIC(0x5e, "div"),
+  SSE_ARITHMETIC(0x5f, "max"),
+#undef SSE_ARITHMETIC
+  {1, 0x5a, 0x5a, 0x00, kMandatoryPrefix | kVEX, "cvtps2pd", NULL, "Vx,Wq"},
+  {1, 0x5a, 0x5a, 0x66, kMandatoryPrefix | kVEX, "cvtpd2ps", NULL, "Vo,Wx"},
+  {1, 0x5a, 0x5a, 0xf3, kMandatoryPrefix | kVEX, "cvtss2sd", NULL,
+   "Vo,Ho,Wd"},
+  {1, 0x5a, 0x5a, 0xf2, kMandatoryPrefix | kVEX, "cvtsd2ss", NULL,
+   "Vo,Ho,Wq"},
+  {1, 0x5b, 0x5b, 0x00, kMandatoryPrefix | kVEX, "cvtdq2ps", NULL, "Vx,Wx"},
+  {1, 0x5b, 0x5b, 0x66, kMandatoryPrefix | kVEX, "cvtps2dq", NULL, "Vx,Wx"},
+  {1, 0x5b, 0x5b, 0xf3, kMandatoryPrefix | kVEX, "cvttps2dq", NULL, "Vx,Wx"},
+// Integer instructions with an MMX form and an SSE form selected by 66.
+#define PACKED_INTEGER(map, opcode, name)                          \
+  {map, opcode, opcode, 0x00, kMandatoryPrefix, name, NULL, "Pq,Qq"}, \
+  {map, opcode, opcode, 0x66, kMandatoryPrefix | kVEX, name, NULL,  \
+   "Vx,Hx,Wx"}
+// Shifts by a count in the low quadword of an MMX or xmm register.
+#define PACKED_SHIFT(opcode, name)                                  \
+  {1, opcode, opcode, 0x00, kMandatoryPrefix, name, NULL, "Pq,Qq"}, \
+  {1, opcode, opcode, 0x66, kMandatoryPrefix | kVEX, name, NULL,    \
+   "Vx,Hx,Wo"}
+  {1, 0x60, 0x60, 0x00, kMandatoryPrefix, "punpcklbw", NULL, "Pq,Qd"},
+  {1, 0x61, 0x61, 0x00, kMandatoryPrefix, "punpcklwd", NULL, "Pq,Qd"},
+  {1, 0x62, 0x62, 0x00, kMandatoryPrefix, "punpckldq", NULL, "Pq,Qd"},
+  {1, 0x60, 0x60, 0x66, kMandatoryPrefix | kVEX, "punpcklbw", NULL,
+   "Vx,Hx,Wx"},
+  {1, 0x61, 0x61, 0x66, kMandatoryPrefix | kVEX, "punpcklwd", NULL,
+   "Vx,Hx,Wx"},
+  {1, 0x62, 0x62, 0x66, kMandatoryPrefix | kVEX, "punpckldq", NULL,
+   "Vx,Hx,Wx"},
+  PACKED_INTEGER(1, 0x63, "packsswb"),
+  PACKED_INTEGER(1, 0x64, "pcmpgtb"),
+  PACKED_INTEGER(1, 0x65, "pcmpgtw"),
+  PACKED_INTEGER(1, 0x66, "pcmpgtd"),
+  PACKED_INTEGER(1, 0x67, "packuswb"),
+  PACKED_INTEGER(1, 0x68, "punpckhbw"),
+  PACKED_INTEGER(1, 0x69, "punpckhwd"),
+  PACKED_INTEGER(1, 0x6a, "punpckhdq"),
+  PACKED_INTEGER(1, 0x6b, "packssdw"),
+  PACKED_INTEGER(1, 0x74, "pcmpeqb"),
+  PACKED_INTEGER(1, 0x75, "pcmpeqw"),
+  PACKED_INTEGER(1, 0x76, "pcmpeqd"),
+  PACKED_SHIFT(0xd1, "psrlw"),
+  PACKED_SHIFT(0xd2, "psrld"),
+  PACKED_SHIFT(0xd3, "psrlq"),
+  PACKED_INTEGER(1, 0xd4, "paddq"),
+  PACKED_INTEGER(1, 0xd5, "pmullw"),
+  PACKED_INTEGER(1, 0xd8, "psubusb"),
+  PACKED_INTEGER(1, 0xd9, "psubusw"),
+  PACKED_INTEGER(1, 0xda, "pminub"),
+  PACKED_INTEGER(1, 0xdb, "pand"),
+  PACKED_INTEGER(1, 0xdc, "paddusb"),
+  PACKED_INTEGER(1, 0xdd, "paddusw"),
+  PACKED_INTEGER(1, 0xde, "pmaxub"),
+  PACKED_INTEGER(1, 0xdf, "pandn"),
+  PACKED_INTEGER(1, 0xe0, "pavgb"),
+  PACKED_SHIFT(0xe1, "psraw"),
+  PACKED_SHIFT(0xe2, "psrad"),
+  PACKED_INTEGER(1, 0xe3, "pavgw"),
+  PACKED_INTEGER(1, 0xe4, "pmulhuw"),
+  PACKED_INTEGER(1, 0xe5, "pmulhw"),
+  PACKED_INTEGER(1, 0xe8, "psubsb"),
+  PACKED_INTEGER(1, 0xe9, "psubsw"),
+  PACKED_INTEGER(1, 0xea, "pminsw"),
+  PACKED_INTEGER(1, 0xeb, "por"),
+  PACKED_INTEGER(1, 0xec, "paddsb"),
+  PACKED_INTEGER(1, 0xed, "paddsw"),
+  PACKED_INTEGER(1, 0xee, "pmaxsw"),
+  PACKED_INTEGER(1, 0xef, "pxor"),
+  PACKED_SHIFT(0xf1, "psllw"),
+  PACKED_SHIFT(0xf2, "pslld"),
+  PACKED_SHIFT(0xf3, "psllq"),
+  PACKED_INTEGER(1, 0xf4, "pmuludq"),
+  PACKED_INTEGER(1, 0xf5, "pmaddwd"),
+  PACKED_INTEGER(1, 0xf6, "psadbw"),
+  PACKED_INTEGER(1, 0xf8, "psubb"),
+  PACKED_INTEGER(1, 0xf9, "psubw"),
+  PACKED_INTEGER(1, 0xfa, "psubd"),
+  PACKED_INTEGER(1, 0xfb, "psubq"),
+  PACKED_INTEGER(1, 0xfc, "paddb"),
+  PACKED_INTEGER(1, 0xfd, "paddw"),
+  PACKED_INTEGER(1, 0xfe, "paddd"),
+  PACKED_INTEGER(2, 0x00, "pshufb"),
+#undef PACKED_INTEGER
+#undef PACKED_SHIFT
+  {1, 0x6c, 0x6c, 0x66, kMandatoryPrefix | kVEX, "punpcklqdq", NULL,
+   "Vx,Hx,Wx"},
+  {1, 0x6d, 0x6d, 0x66, kMandatoryPrefix | kVEX, "punpckhqdq", NULL,
+   "Vx,Hx,Wx"},
+  {1, 0x6e, 0x6e, 0x00, kMandatoryPrefix | kWideQ, "movd", NULL, "Pq,Ey"},
+  {1, 0x6e, 0x6e, 0x66, kMandatoryPrefix | kVEX | kWideQ, "movd", NULL,
+   "Vo,Ey"},
+  {1, 0x6f, 0x6f, 0x00, kMandatoryPrefix, "movq", NULL, "Pq,Qq"},
+  {1, 0x6f, 0x6f, 0x66, kMandatoryPrefix | kVEX, "movdqa", NULL, "Vx,Wx"},
+  {1, 0x6f, 0x6f, 0xf3, kMandatoryPrefix | kVEX, "movdqu", NULL, "Vx,Wx"},
+  {1, 0x70, 0x70, 0x00, kMandatoryPrefix, "pshufw", NULL, "Pq,Qq,Ib"},
+  {1, 0x70, 0x70, 0x66, kMandatoryPrefix | kVEX, "pshufd", NULL, "Vx,Wx,Ib"},
+  {1, 0x70, 0x70, 0xf3, kMandatoryPrefix | kVEX, "pshufhw", NULL,
+   "Vx,Wx,Ib"},
+  {1, 0x70, 0x70, 0xf2, kMandatoryPrefix | kVEX, "pshuflw", NULL,
+   "Vx,Wx,Ib"},
+  {1, 0x77, 0x77, 0x00, kMandatoryPrefix, "emms", NULL, ""},
+  {1, 0x7e, 0x7e, 0x00, kMandatoryPrefix | kWideQ, "movd", NULL, "Ey,Pq"},
+  {1, 0x7e, 0x7e, 0x66, kMandatoryPrefix | kVEX | kWideQ, "movd", NULL,
+   "Ey,Vo"},
+  {1, 0x7e, 0x7e, 0xf3, kMandatoryPrefix | kVEX, "movq", NULL, "Vo,Wq"},
+  {1, 0x7f, 0x7f, 0x00, kMandatoryPrefix, "movq", NULL, "Qq,Pq"},
+  {1, 0x7f, 0x7f, 0x66, kMandatoryPrefix | kVEX, "movdqa", NULL, "Wx,Vx"},
+  {1, 0x7f, 0x7f, 0xf3, kMandatoryPrefix | kVEX, "movdqu", NULL, "Wx,Vx"},
+  {1, 0xc6, 0xc6, 0x00, kMandatoryPrefix | kVEX, "shufps", NULL,
+   "Vx,Hx,Wx,Ib"},
+  {1, 0xc6, 0xc6, 0x66, kMandatoryPrefix | kVEX, "shufpd", NULL,
+   "Vx,Hx,Wx,Ib"},
+  {1, 0xd6, 0xd6, 0x66, kMandatoryPrefix | kVEX, "movq", NULL, "Wq,Vo"},
+  {1, 0xd7, 0xd7, 0x00, kMandatoryPrefix | kRegisterOnly, "pmovmskb", NULL,
+   "Gy,Nq"},
+  {1, 0xd7, 0xd7, 0x66, kMandatoryPrefix | kVEX | kRegisterOnly, "pmovmskb",
+   NULL, "Gy,Ux"},
+  {1, 0xc4, 0xc4, 0x66, kMandatoryPrefix | kVEX, "pinsrw", NULL,
+   "Vo,Ho,Em,Ib"},
+  {1, 0xc5, 0xc5, 0x00, kMandatoryPrefix | kRegisterOnly, "pextrw", NULL,
+   "Gd,Nq,Ib"},
+  {1, 0xc5, 0xc5, 0x66, kMandatoryPrefix | kVEX | kRegisterOnly, "pextrw",
+   NULL, "Gd,Uo,Ib"},
+  {1, 0xe7, 0xe7, 0x00, kMandatoryPrefix | kMemoryOnly, "movntq", NULL,
+   "Mq,Pq"},
+  {1, 0xe7, 0xe7, 0x66, kMandatoryPrefix | kVEX | kMemoryOnly, "movntdq",
+   NULL, "Mx,Vx"},
+  {2, 0x17, 0x17, 0x66, kMandatoryPrefix | kVEX, "ptest", NULL, "Vx,Wx"},
+  {2, 0x29, 0x29, 0x66, kMandatoryPrefix | kVEX, "pcmpeqq", NULL,
+   "Vx,Hx,Wx"},
+  {2, 0x37, 0x37, 0x66, kMandatoryPrefix | kVEX, "pcmpgtq", NULL,
+   "Vx,Hx,Wx"},
+  {2, 0x38, 0x38, 0x66, kMandatoryPrefix | kVEX, "pminsb", NULL, "Vx,Hx,Wx"},
+  {2, 0x39, 0x39, 0x66, kMandatoryPrefix | kVEX, "pminsd", NULL, "Vx,Hx,Wx"},
+  {2, 0x3a, 0x3a, 0x66, kMandatoryPrefix | kVEX, "pminuw", NULL, "Vx,Hx,Wx"},
+  {2, 0x3b, 0x3b, 0x66, kMandatoryPrefix | kVEX, "pminud", NULL, "Vx,Hx,Wx"},
+  {2, 0x3c, 0x3c, 0x66, kMandatoryPrefix | kVEX, "pmaxsb", NULL, "Vx,Hx,Wx"},
+  {2, 0x3d, 0x3d, 0x66, kMandatoryPrefix | kVEX, "pmaxsd", NULL, "Vx,Hx,Wx"},
+  {2, 0x3e, 0x3e, 0x66, kMandatoryPrefix | kVEX, "pmaxuw", NULL, "Vx,Hx,Wx"},
+  {2, 0x3f, 0x3f, 0x66, kMandatoryPrefix | kVEX, "pmaxud", NULL, "Vx,Hx,Wx"},
+  {3, 0x0f, 0x0f, 0x00, kMandatoryPrefix, "palignr", NULL, "Pq,Qq,Ib"},
+  {3, 0x0f, 0x0f, 0x66, kMandatoryPrefix | kVEX, "palignr", NULL,
+   "Vx,Hx,Wx,Ib"},
+  {3, 0x16, 0x16, 0x66, kMandatoryPrefix | kVEX | kWideQ, "pextrd", NULL,
+   "Ey,Vo,Ib"},
+  {3, 0x22, 0x22, 0x66, kMandatoryPrefix | kVEX | kWideQ, "pinsrd", NULL,
+   "Vo,Ho,Ey,Ib"},
+  {3, 0x60, 0x60, 0x66, kMandatoryPrefix | kVEX, "pcmpestrm", NULL,
+   "Vo,Wo,Ib"},
+  {3, 0x61, 0x61, 0x66, kMandatoryPrefix | kVEX, "pcmpestri", NULL,
+   "Vo,Wo,Ib"},
+  {3, 0x62, 0x62, 0x66, kMandatoryPrefix | kVEX, "pcmpistrm", NULL,
+   "Vo,Wo,Ib"},
+  {3, 0x63, 0x63, 0x66, kMandatoryPrefix | kVEX, "pcmpistri", NULL,
+   "Vo,Wo,Ib"},
+
+  // Instructions that only have VEX forms.
+  {2, 0x18, 0x18, 0x66, kMandatoryPrefix | kVEXOnly, "vbroadcastss", NULL,
+   "Vx,Wd"},
+  {2, 0x58, 0x58, 0x66, kMandatoryPrefix | kVEXOnly, "vpbroadcastd", NULL,
+   "Vx,Wd"},
+  {2, 0x59, 0x59, 0x66, kMandatoryPrefix | kVEXOnly, "vpbroadcastq", NULL,
+   "Vx,Wq"},
+  {2, 0x78, 0x78, 0x66, kMandatoryPrefix | kVEXOnly, "vpbroadcastb", NULL,
+   "Vx,Wb"},
+  {2, 0x79, 0x79, 0x66, kMandatoryPrefix | kVEXOnly, "vpbroadcastw", NULL,
+   "Vx,Ww"},
+  {2, 0xf2, 0xf2, 0x00, kMandatoryPrefix | kVEXOnly, "andn", NULL,
+   "Gy,By,Ey"},
+  {2, 0xf3, 0xf3, 0x00, kMandatoryPrefix | kVEXOnly, NULL, kGroup17,
+   "By,Ey"},
+  {2, 0xf5, 0xf5, 0x00, kMandatoryPrefix | kVEXOnly, "bzhi", NULL,
+   "Gy,Ey,By"},
+  {2, 0xf5, 0xf5, 0xf3, kMandatoryPrefix | kVEXOnly, "pext", NULL,
+   "Gy,By,Ey"},
+  {2, 0xf5, 0xf5, 0xf2, kMandatoryPrefix | kVEXOnly, "pdep", NULL,
+   "Gy,By,Ey"},
+  {2, 0xf7, 0xf7, 0x00, kMandatoryPrefix | kVEXOnly, "bextr", NULL,
+   "Gy,Ey,By"},
+  {2, 0xf7, 0xf7, 0x66, kMandatoryPrefix | kVEXOnly, "shlx", NULL,
+   "Gy,Ey,By"},
+  {2, 0xf7, 0xf7, 0xf3, kMandatoryPrefix | kVEXOnly, "sarx", NULL,
+   "Gy,Ey,By"},
+  {2, 0xf7, 0xf7, 0xf2, kMandatoryPrefix | kVEXOnly, "shrx", NULL,
+   "Gy,Ey,By"},
+};
+
+// The memory forms of the x87 instructions, D8 to DF, by opcode and ModRM
+// reg, and the size of their memory operands in bits, or 0 if objdump
+// prints no size.
+struct X87Opcode {
+  const char* mnemonic;
+  int size;
+};
+
+const X87Opcode kX87MemoryOpcodes[8][8] = {
+  {{"fadd", 32}, {"fmul", 32}, {"fcom", 32}, {"fcomp", 32},
+   {"fsub", 32}, {"fsubr", 32}, {"fdiv", 32}, {"fdivr", 32}},
+  {{"fld", 32}, {NULL, 0}, {"fst", 32}, {"fstp", 32},
+   {"fldenv", 0}, {"fldcw", 16}, {"fnstenv", 0}, {"fnstcw", 16}},
+  {{"fiadd", 32}, {"fimul", 32}, {"ficom", 32}, {"ficomp", 32},
+   {"fisub", 32}, {"fisubr", 32}, {"fidiv", 32}, {"fidivr", 32}},
+  {{"fild", 32}, {"fisttp", 32}, {"fist", 32}, {"fistp", 32},
+   {NULL, 0}, {"fld", 80}, {NULL, 0}, {"fstp", 80}},
+  {{"fadd", 64}, {"fmul", 64}, {"fcom", 64}, {"fcomp", 64},
+   {"fsub", 64}, {"fsubr", 64}, {"fdiv", 64}, {"fdivr", 64}},
+  {{"fld", 64}, {"fisttp", 64}, {"fst", 64}, {"fstp", 64},
+   {"frstor", 0}, {NULL, 0}, {"fnsave", 0}, {"fnstsw", 16}},
+  {{"fiadd", 16}, {"fimul", 16}, {"ficom", 16}, {"ficomp", 16},
+   {"fisub", 16}, {"fisubr", 16}, {"fidiv", 16}, {"fidivr", 16}},
+  {{"fild", 16}, {"fisttp", 16}, {"fist", 16}, {"fistp", 16},
+   {"fbld", 80}, {"fild", 64}, {"fbstp", 80}, {"fistp", 64}},
+};
+
+// The register forms of the x87 instructions, by opcode and ModRM byte.
+// Their operands are "i" for st(i), "0i" for st,st(i), "i0" for st(i),st,
+// or a literal.
+struct X87RegisterOpcode {
+  uint8_t opcode;
+  uint8_t first;
+  uint8_t last;
+  const char* mnemonic;
+  const char* operands;
+};
+
+const X87RegisterOpcode kX87RegisterOpcodes[] = {
+  {0xd8, 0xc0, 0xc7, "fadd", "0i"},
+  {0xd8, 0xc8, 0xcf, "fmul", "0i"},
+  {0xd8, 0xd0, 0xd7, "fcom", "i"},
+  {0xd8, 0xd8, 0xdf, "fcomp", "i"},
+  {0xd8, 0xe0, 0xe7, "fsub", "0i"},
+  {0xd8, 0xe8, 0xef, "fsubr", "0i"},
+  {0xd8, 0xf0, 0xf7, "fdiv", "0i"},
+  {0xd8, 0xf8, 0xff, "fdivr", "0i"},
+  {0xd9, 0xc0, 0xc7, "fld", "i"},
+  {0xd9, 0xc8, 0xcf, "fxch", "i"},
+  {0xd9, 0xd0, 0xd0, "fnop", ""},
+  {0xd9, 0xe0, 0xe0, "fchs", ""},
+  {0xd9, 0xe1, 0xe1, "fabs", ""},
+  {0xd9, 0xe4, 0xe4, "ftst", ""},
+  {0xd9, 0xe5, 0xe5, "fxam", ""},
+  {0xd9, 0xe8, 0xe8, "fld1", ""},
+  {0xd9, 0xe9, 0xe9, "fldl2t", ""},
+  {0xd9, 0xea, 0xea, "fldl2e", ""},
+  {0xd9, 0xeb, 0xeb, "fldpi", ""},
+  {0xd9, 0xec, 0xec, "fldlg2", ""},
+  {0xd9, 0xed, 0xed, "fldln2", ""},
+  {0xd9, 0xee, 0xee, "fldz", ""},
+  {0xd9, 0xf0, 0xf0, "f2xm1", ""},
+  {0xd9, 0xf1, 0xf1, "fyl2x", ""},
+  {0xd9, 0xf2, 0xf2, "fptan", ""},
+  {0xd9, 0xf3, 0xf3, "fpatan", ""},
+  {0xd9, 0xf4, 0xf4, "fxtract", ""},
+  {0xd9, 0xf5, 0xf5, "fprem1", ""},
+  {0xd9, 0xf6, 0xf6, "fdecstp", ""},
+  {0xd9, 0xf7, 0xf7, "fincstp", ""},
+  {0xd9, 0xf8, 0xf8, "fprem", ""},
+  {0xd9, 0xf9, 0xf9, "fyl2xp1", ""},
+  {0xd9, 0xfa, 0xfa, "fsqrt", ""},
+  {0xd9, 0xfb, 0xfb, "fsincos", ""},
+  {0xd9, 0xfc, 0xfc, "frndint", ""},
+  {0xd9, 0xfd, 0xfd, "fscale", ""},
+  {0xd9, 0xfe, 0xfe, "fsin", ""},
+  {0xd9, 0xff, 0xff, "fcos", ""},
+  {0xda, 0xc0, 0xc7, "fcmovb", "0i"},
+  {0xda, 0xc8, 0xcf, "fcmove", "0i"},
+  {0xda, 0xd0, 0xd7, "fcmovbe", "0i"},
+  {0xda, 0xd8, 0xdf, "fcmovu", "0i"},
+  {0xda, 0xe9, 0xe9, "fucompp", ""},
+  {0xdb, 0xc0, 0xc7, "fcmovnb", "0i"},
+  {0xdb, 0xc8, 0xcf, "fcmovne", "0i"},
+  {0xdb, 0xd0, 0xd7, "fcmovnbe", "0i"},
+  {0xdb, 0xd8, 0xdf, "fcmovnu", "0i"},
+  {0xdb, 0xe2, 0xe2, "fnclex", ""},
+  {0xdb, 0xe3, 0xe3, "fninit", ""},
+  {0xdb, 0xe8, 0xef, "fucomi", "0i"},
+  {0xdb, 0xf0, 0xf7, "fcomi", "0i"},
+  {0xdc, 0xc0, 0xc7, "fadd", "i0"},
+  {0xdc, 0xc8, 0xcf, "fmul", "i0"},
+  {0xdc, 0xe0, 0xe7, "fsubr", "i0"},
+  {0xdc, 0xe8, 0xef, "fsub", "i0"},
+  {0xdc, 0xf0, 0xf7, "fdivr", "i0"},
+  {0xdc, 0xf8, 0xff, "fdiv", "i0"},
+  {0xdd, 0xc0, 0xc7, "ffree", "i"},
+  {0xdd, 0xd0, 0xd7, "fst", "i"},
+  {0xdd, 0xd8, 0xdf, "fstp", "i"},
+  {0xdd, 0xe0, 0xe7, "fucom", "i"},
+  {0xdd, 0xe8, 0xef, "fucomp", "i"},
+  {0xde, 0xc0, 0xc7, "faddp", "i0"},
+  {0xde, 0xc8, 0xcf, "fmulp", "i0"},
+  {0xde, 0xd9, 0xd9, "fcompp", ""},
+  {0xde, 0xe0, 0xe7, "fsubrp", "i0"},
+  {0xde, 0xe8, 0xef, "fsubp", "i0"},
+  {0xde, 0xf0, 0xf7, "fdivrp", "i0"},
+  {0xde, 0xf8, 0xff, "fdivp", "i0"},
+  {0xdf, 0xe0, 0xe0, "fnstsw", "ax"},
+  {0xdf, 0xe8, 0xef, "fucomip", "0i"},
+  {0xdf, 0xf0, 0xf7, "fcomip", "0i"},
+};
+
+// The instructions that 0F 01 and a register-form ModRM byte select.
+struct SystemOpcode {
+  uint8_t modrm;
+  const char* mnemonic;
+};
+
+const SystemOpcode kSystemOpcodes[] = {
+  {0xd0, "xgetbv"},
+  {0xd5, "xend"},
+  {0xd6, "xtest"},
+  {0xee, "rdpkru"},
+  {0xef, "wrpkru"},
+  {0xf8, "swapgs"},
+  {0xf9, "rdtscp"},
+};
+
+// The shifts by an immediate in groups 12 to 14, 0F 71 to 0F 73, by opcode
+// and ModRM reg.
+const char* const kShiftGroups[3][8] = {
+  {NULL, NULL, "psrlw", NULL, "psraw", NULL, "psllw", NULL},
+  {NULL, NULL, "psrld", NULL, "psrad", NULL, "pslld", NULL},
+  {NULL, NULL, "psrlq", "psrldq", NULL, NULL, "psllq", "pslldq"},
+};
+
+const char* SizeName(int bits) {
+  switch (bits) {
+    case 8: return "BYTE";
+    case 16: return "WORD";
+    case 32: return "DWORD";
+    case 48: return "FWORD";
+    case 64: return "QWORD";
+    case 80: return "TBYTE";
+    case 128: return "XMMWORD";
+    case 256: return "YMMWORD";
+  }
+  return NULL;
+}
+
+string Hex(uint64_t value) {
+  char buffer[24];
+  snprintf(buffer, sizeof(buffer), "0x%" PRIx64, value);
+  return buffer;
+}
+
+uint64_t Truncate(uint64_t value, int bits) {
+  return bits >= 64 ? value : value & ((1ULL << bits) - 1);
+}
+
+// The state of decoding one instruction.
+class Decoder {
+ public:
+  Decoder(bool mode64, const uint8_t* bytes, size_t length)
+      : mode64_(mode64),
+        bytes_(bytes),
+        length_(length),
+        position_(0),
+        opcode_(0),
+        operand_size_prefix_(false),
+        operand_size_used_(false),
+        address_size_prefix_(false),
+        address_size_used_(false),
+        lock_(false),
+        repeat_(0),
+        segment_(-1),
+        segment_used_(false),
+        notrack_(false),
+        rex_(0),
+        rex_used_(0),
+        vex_(false),
+        vex_w_(false),
+        vex_l_(false),
+        vex_vvvv_(0),
+        mandatory_prefix_used_(false),
+        has_modrm_(false),
+        mod_(0),
+        reg_(0),
+        rm_(0),
+        has_base_(false),
+        base_(0),
+        has_sib_(false),
+        has_index_(false),
+        zero_index_(false),
+        index_(0),
+        scale_(1),
+        has_displacement_(false),
+        displacement_(0),
+        rip_relative_(false) {}
+
+  bool Decode(string* instruction);
+
+ private:
+  bool ReadByte(uint8_t* byte);
+  bool ReadImmediate(int bits, uint64_t* value);
+  bool ReadModRM();
+  bool ReadPrefixes(uint8_t* opcode);
+  bool ReadVEX(uint8_t first_byte, int* map, uint8_t* opcode);
+  const Opcode* FindOpcode(int map, uint8_t opcode, bool* uses_modrm);
+  bool DecodeX87(uint8_t opcode, string* mnemonic,
+                 vector<string>* operands);
+  bool DecodeOperands(const Opcode& entry, vector<string>* operands);
+  bool DecodeOperand(const char* spec, size_t length, string* operand);
+
+  int OperandSize() const;
+  int StackOperandSize() const;
+  int AddressSize() const;
+  bool rex_w() const;
+  int Segment() const;
+  string Prefixes(int flags) const;
+  int Size(char code) const;
+  bool Register(int bits, int number, string* name) const;
+  string VectorRegister(char size, int number) const;
+  string AddressRegister(int number) const;
+  string Memory(int bits);
+  void AppendJoined(const vector<string>& operands, string* text) const;
+
+  bool mode64_;
+  const uint8_t* bytes_;
+  size_t length_;
+  size_t position_;
+
+  // The last opcode byte.
+  uint8_t opcode_;
+
+  // The legacy prefixes, in order.  objdump prints those that have no
+  // effect on the instruction as words before its mnemonic.
+  vector<uint8_t> prefixes_;
+
+  // The legacy prefixes' effects, and whether the instruction used them.
+  // repeat_ is cleared when the instruction consumes the prefix.
+  bool operand_size_prefix_;
+  mutable bool operand_size_used_;
+  bool address_size_prefix_;
+  mutable bool address_size_used_;
+  bool lock_;
+  uint8_t repeat_;
+  int segment_;
+  bool segment_used_;
+  bool notrack_;
+
+  // The REX prefix, or 0, and the bits of it that the instruction used,
+  // with 0x40 for an 8-bit register that needed the prefix.
+  uint8_t rex_;
+  mutable uint8_t rex_used_;
+
+  // The VEX prefix's fields, with R, X and B kept in rex_.
+  bool vex_;
+  bool vex_w_;
+  bool vex_l_;
+  int vex_vvvv_;
+
+  // Set when a 66 prefix selected the instruction instead of changing its
+  // operand size.
+  bool mandatory_prefix_used_;
+
+  // The ModRM byte, its SIB byte and displacement, with the REX bits
+  // applied to the register numbers.
+  bool has_modrm_;
+  int mod_;
+  int reg_;
+  int rm_;
+  bool has_base_;
+  int base_;
+  bool has_sib_;
+  bool has_index_;
+  // Set when the SIB byte has no index, but objdump prints one, eiz or riz,
+  // because the byte was not needed to encode the base alone.
+  bool zero_index_;
+  int index_;
+  int scale_;
+  bool has_displacement_;
+  int64_t displacement_;
+  bool rip_relative_;
+};
+
+bool Decoder::ReadByte(uint8_t* byte) {
+  if (position_ >= length_)
+    return false;
+  *byte = bytes_[position_++];
+  return true;
+}
+
+bool Decoder::ReadImmediate(int bits, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < bits; shift += 8) {
+    uint8_t byte;
+    if (!ReadByte(&byte))
+      return false;
+    *value |= static_cast<uint64_t>(byte) << shift;
+  }
+  return true;
+}
+
+// Sign extends the |bits|-bit |value|.
+int64_t SignExtend(uint64_t value, int bits) {
+  if (bits >= 64)
+    return static_cast<int64_t>(value);
+  uint64_t sign = 1ULL << (bits - 1);
+  return static_cast<int64_t>((Truncate(value, bits) ^ sign) - sign);
+}
+
+bool Decoder::ReadModRM() {
+  if (has_modrm_)
+    return true;
+  uint8_t modrm;
+  if (!ReadByte(&modrm))
+    return false;
+  has_modrm_ = true;
+  mod_ = modrm >> 6;
+  reg_ = ((modrm >> 3) & 7) | ((rex_ & 4) << 1);
+  rm_ = (modrm & 7) | ((rex_ & 1) << 3);
+  if (mod_ == 3)
+    return true;
+
+  // 16-bit addressing is not supported.
+  if (AddressSize() == 16)
+    return false;
+
+  int displacement_bits = mod_ == 1 ? 8 : mod_ == 2 ? 32 : 0;
+  if ((modrm & 7) == 4) {
+    uint8_t sib;
+    if (!ReadByte(&sib))
+      return false;
+    has_sib_ = true;
+    scale_ = 1 << (sib >> 6);
+    index_ = ((sib >> 3) & 7) | ((rex_ & 2) << 2);
+    has_index_ = index_ != 4;
+    base_ = (sib & 7) | ((rex_ & 1) << 3);
+    has_base_ = true;
+    if ((sib & 7) == 5 && mod_ == 0) {
+      has_base_ = false;
+      displacement_bits = 32;
+    }
+    if (!has_index_) {
+      zero_index_ = has_base_ ? (sib & 7) != 4 || scale_ != 1 :
+                                !mode64_ || scale_ != 1;
+    }
+  } else if ((modrm & 7) == 5 && mod_ == 0) {
+    rip_relative_ = mode64_;
+    displacement_bits = 32;
+  } else {
+    has_base_ = true;
+    base_ = rm_;
+  }
+
+  if (displacement_bits) {
+    uint64_t displacement;
+    if (!ReadImmediate(displacement_bits, &displacement))
+      return false;
+    has_displacement_ = true;
+    displacement_ = SignExtend(displacement, displacement_bits);
+  }
+  return true;
+}
+
+bool Decoder::rex_w() const {
+  if (vex_)
+    return vex_w_ && mode64_;
+  rex_used_ |= rex_ & 8;
+  return (rex_ & 8) != 0;
+}
+
+// Returns the segment that a segment prefix selects for memory operands,
+// or -1.  In 64-bit mode, only fs and gs have any effect.
+int Decoder::Segment() const {
+  if ((mode64_ && segment_ <= 3) || notrack_)
+    return -1;
+  return segment_;
+}
+
+int Decoder::OperandSize() const {
+  if (rex_w())
+    return 64;
+  if (!operand_size_prefix_ || mandatory_prefix_used_)
+    return 32;
+  operand_size_used_ = true;
+  return 16;
+}
+
+int Decoder::StackOperandSize() const {
+  // In 64-bit mode, REX.W overrides the operand size prefix, though
+  // objdump still prints it.
+  if (mode64_ && operand_size_prefix_ && (rex_ & 8) && !vex_)
+    return 64;
+  if (operand_size_prefix_) {
+    operand_size_used_ = true;
+    return 16;
+  }
+  return mode64_ ? 64 : 32;
+}
+
+int Decoder::AddressSize() const {
+  address_size_used_ = true;
+  if (mode64_)
+    return address_size_prefix_ ? 32 : 64;
+  return address_size_prefix_ ? 16 : 32;
+}
+
+// Returns the size in bits of an operand whose size is |code|.
+int Decoder::Size(char code) const {
+  switch (code) {
+    case 'b': return 8;
+    case 'w': return 16;
+    case 'd': return 32;
+    case 'q': return 64;
+    case 't': return 80;
+    case 'o': return 128;
+    case 'x': return vex_l_ ? 256 : 128;
+    case 'v': return OperandSize();
+    case 'y': return rex_w() ? 64 : 32;
+    case 'z':
+      // REX.W leaves these at 32 bits.
+      if (operand_size_prefix_ && !mandatory_prefix_used_ && !(rex_ & 8)) {
+        operand_size_used_ = true;
+        return 16;
+      }
+      return 32;
+    case 'f': return StackOperandSize();
+    case 'p':
+      // Only the plain 48-bit far pointer is supported.
+      return operand_size_prefix_ || rex_w() ? 0 : 48;
+  }
+  return 0;
+}
+
+bool Decoder::Register(int bits, int number, string* name) const {
+  switch (bits) {
+    case 8:
+      if (rex_ || vex_) {
+        if (number >= 4)
+          rex_used_ |= 0x40;
+        *name = kRegisters8REX[number];
+      } else if (number < 8) {
+        *name = kRegisters8[number];
+      } else {
+        return false;
+      }
+      return true;
+    case 16:
+      *name = kRegisters16[number];
+      return true;
+    case 32:
+      *name = kRegisters32[number];
+      return true;
+    case 64:
+      *name = kRegisters64[number];
+      return true;
+  }
+  return false;
+}
+
+string Decoder::VectorRegister(char size, int number) const {
+  char buffer[8];
+  snprintf(buffer, sizeof(buffer), "%cmm%d",
+           size == 'x' && vex_l_ ? 'y' : 'x', number);
+  return buffer;
+}
+
+string Decoder::AddressRegister(int number) const {
+  switch (AddressSize()) {
+    case 16: return kRegisters16[number];
+    case 32: return kRegisters32[number];
+  }
+  return kRegisters64[number];
+}
+
+// Formats the ModRM memory operand, which is |bits| wide, or has no size
+// printed if |bits| is 0.
+string Decoder::Memory(int bits) {
+  string text;
+  if (SizeName(bits)) {
+    text = SizeName(bits);
+    text += " PTR ";
+  }
+  string segment;
+  if (Segment() >= 0) {
+    segment = kSegmentRegisters[Segment()];
+    segment += ":";
+    segment_used_ = true;
+  }
+  rex_used_ |= rex_ & 1;
+  if (has_sib_)
+    rex_used_ |= rex_ & 2;
+  if (!has_base_ && !has_index_ && !zero_index_ && !rip_relative_) {
+    text += segment.empty() ? "ds:" : segment;
+    text += Hex(Truncate(displacement_, AddressSize()));
+    return text;
+  }
+  text += segment + "[";
+  if (rip_relative_) {
+    text += AddressSize() == 64 ? "rip" : "eip";
+  } else if (has_base_) {
+    text += AddressRegister(base_);
+  }
+  if (has_index_ || zero_index_) {
+    char scale[4];
+    snprintf(scale, sizeof(scale), "*%d", scale_);
+    if (has_base_)
+      text += "+";
+    if (has_index_)
+      text += AddressRegister(index_);
+    else
+      text += AddressSize() == 64 ? "riz" : "eiz";
+    text += scale;
+  }
+  if (has_displacement_) {
+    if (rip_relative_) {
+      // objdump prints rip-relative displacements as unsigned 64-bit
+      // values, even with a 32-bit address size.
+      text += "+" + Hex(displacement_);
+    } else if (zero_index_ && !has_base_ && mode64_ && address_size_prefix_) {
+      text += "+" + Hex(Truncate(displacement_, 32));
+    } else if (displacement_ < 0) {
+      text += "-" + Hex(-static_cast<uint64_t>(displacement_));
+    } else {
+      text += "+" + Hex(displacement_);
+    }
+  }
+  text += "]";
+  return text;
+}
+
+bool Decoder::ReadPrefixes(uint8_t* opcode) {
+  for (;;) {
+    uint8_t byte;
+    if (!ReadByte(&byte))
+      return false;
+    switch (byte) {
+      case 0xf0: case 0xf2: case 0xf3: case 0x66: case 0x67:
+      case 0x26: case 0x2e: case 0x36: case 0x3e: case 0x64: case 0x65:
+        prefixes_.push_back(byte);
+        break;
+    }
+    switch (byte) {
+      case 0xf0:
+        if (lock_)
+          return false;
+        lock_ = true;
+        continue;
+      case 0xf2:
+      case 0xf3:
+        if (repeat_)
+          return false;
+        repeat_ = byte;
+        continue;
+      case 0x66:
+        operand_size_prefix_ = true;
+        continue;
+      case 0x67:
+        if (address_size_prefix_)
+          return false;
+        address_size_prefix_ = true;
+        continue;
+      case 0x26: case 0x2e: case 0x36: case 0x3e: case 0x64: case 0x65:
+        if (segment_ >= 0)
+          return false;
+        segment_ = byte == 0x26 ? 0 : byte == 0x2e ? 1 : byte == 0x36 ? 2 :
+                   byte == 0x3e ? 3 : byte == 0x64 ? 4 : 5;
+        continue;
+    }
+    if (mode64_ && (byte & 0xf0) == 0x40) {
+      // REX must come last, directly before the opcode.
+      rex_ = byte;
+      if (!ReadByte(&byte) || (byte & 0xf0) == 0x40)
+        return false;
+      switch (byte) {
+        case 0xf0: case 0xf2: case 0xf3: case 0x66: case 0x67:
+        case 0x26: case 0x2e: case 0x36: case 0x3e: case 0x64: case 0x65:
+          return false;
+      }
+    }
+    *opcode = byte;
+    return true;
+  }
+}
+
+bool Decoder::ReadVEX(uint8_t first_byte, int* map, uint8_t* opcode) {
+  if (rex_ || operand_size_prefix_ || repeat_ || lock_)
+    return false;
+  uint8_t byte1, byte2;
+  if (!ReadByte(&byte1))
+    return false;
+  if (first_byte == 0xc5) {
+    *map = 1;
+    byte2 = byte1;
+    // Form the first byte of the equivalent three-byte prefix, without X
+    // and B.
+    byte1 = (byte1 & 0x80) | 0x60;
+  } else {
+    if (!ReadByte(&byte2))
+      return false;
+    *map = byte1 & 0x1f;
+    if (*map < 1 || *map > 3)
+      return false;
+  }
+  vex_ = true;
+  rex_ = 0x40 | ((~byte1 >> 5) & 7);
+  vex_w_ = first_byte == 0xc4 && (byte2 & 0x80);
+  if (vex_w_)
+    rex_ |= 8;
+  vex_vvvv_ = (~byte2 >> 3) & 0xf;
+  vex_l_ = (byte2 & 4) != 0;
+  if (!mode64_) {
+    rex_ = 0;
+    vex_vvvv_ &= 7;
+  }
+  static const uint8_t kImpliedPrefixes[] = {0, 0x66, 0xf3, 0xf2};
+  uint8_t prefix = kImpliedPrefixes[byte2 & 3];
+  if (prefix == 0x66)
+    operand_size_prefix_ = true;
+  else if (prefix)
+    repeat_ = prefix;
+  return ReadByte(opcode);
+}
+
+// Finds the entry for |opcode| in |map|, reading the ModRM byte if the
+// entry depends on it.
+const Opcode* Decoder::FindOpcode(int map, uint8_t opcode, bool* uses_modrm) {
+  uint8_t mandatory_prefix = repeat_ ? repeat_ :
+                             operand_size_prefix_ ? 0x66 : 0;
+  for (const Opcode& entry : kOpcodes) {
+    if (entry.map != map || opcode < entry.first || opcode > entry.last)
+      continue;
+    if ((entry.flags & kNot64) && mode64_)
+      continue;
+    if ((entry.flags & kOnly64) && !mode64_)
+      continue;
+    if ((entry.flags & kVEXOnly) && !vex_)
+      continue;
+    if (vex_ && !(entry.flags & (kVEX | kVEXOnly)))
+      continue;
+    if (entry.flags & kMandatoryPrefix) {
+      if (entry.prefix != mandatory_prefix)
+        continue;
+      // Only one of 66, F3 and F2 may be present.
+      if (repeat_ && operand_size_prefix_ && !vex_)
+        continue;
+    } else if (entry.prefix && entry.prefix != repeat_) {
+      continue;
+    }
+    if (entry.flags & (kMemoryOnly | kRegisterOnly)) {
+      if (!ReadModRM())
+        return NULL;
+      if ((entry.flags & kMemoryOnly) && mod_ == 3)
+        continue;
+      if ((entry.flags & kRegisterOnly) && mod_ != 3)
+        continue;
+    }
+    *uses_modrm = entry.group != NULL;
+    return &entry;
+  }
+  return NULL;
+}
+
+bool Decoder::DecodeX87(uint8_t opcode, string* mnemonic,
+                        vector<string>* operands) {
+  // objdump gives some of these 16-bit forms their own mnemonics.
+  if (operand_size_prefix_ || !ReadModRM())
+    return false;
+  if (mod_ == 3) {
+    uint8_t modrm = bytes_[position_ - 1];
+    for (const X87RegisterOpcode& entry : kX87RegisterOpcodes) {
+      if (entry.opcode != opcode || modrm < entry.first ||
+          modrm > entry.last) {
+        continue;
+      }
+      *mnemonic = entry.mnemonic;
+      char st[8];
+      snprintf(st, sizeof(st), "st(%d)", modrm & 7);
+      if (strcmp(entry.operands, "i") == 0) {
+        operands->push_back(st);
+      } else if (strcmp(entry.operands, "0i") == 0) {
+        operands->push_back("st");
+        operands->push_back(st);
+      } else if (strcmp(entry.operands, "i0") == 0) {
+        operands->push_back(st);
+        operands->push_back("st");
+      } else if (entry.operands[0]) {
+        operands->push_back(entry.operands);
+      }
+      return true;
+    }
+    return false;
+  }
+  const X87Opcode& entry = kX87MemoryOpcodes[opcode - 0xd8][reg_ & 7];
+  if (!entry.mnemonic)
+    return false;
+  *mnemonic = entry.mnemonic;
+  operands->push_back(Memory(entry.size));
+  return true;
+}
+
+bool Decoder::DecodeOperands(const Opcode& entry, vector<string>* operands) {
+  const char* spec = entry.operands;
+  while (*spec) {
+    const char* end = strchr(spec, ',');
+    size_t length = end ? end - spec : strlen(spec);
+    // H and B operands only exist in VEX forms.
+    if (spec[0] == 'H' && !vex_) {
+      spec += length + (end ? 1 : 0);
+      continue;
+    }
+    string operand;
+    if (!DecodeOperand(spec, length, &operand))
+      return false;
+    operands->push_back(operand);
+    spec += length + (end ? 1 : 0);
+  }
+  return true;
+}
+
+bool Decoder::DecodeOperand(const char* spec, size_t length,
+                            string* operand) {
+  if (spec[0] == '=') {
+    operand->assign(spec + 1, length - 1);
+    return true;
+  }
+  char size = length > 1 ? spec[1] : 0;
+  switch (spec[0]) {
+    case 'E':
+    case 'M': {
+      if (!ReadModRM())
+        return false;
+      if (spec[0] == 'M' && mod_ == 3)
+        return false;
+      int bits = size == 'f' ? StackOperandSize() : Size(size);
+      if (size && !bits)
+        return false;
+      if (mod_ == 3) {
+        rex_used_ |= rex_ & 1;
+        return Register(size == 'm' ? OperandSize() : bits, rm_, operand);
+      }
+      *operand = Memory(size == 'm' ? 16 : bits);
+      return true;
+    }
+    case 'G':
+      rex_used_ |= rex_ & 4;
+      return ReadModRM() && Register(Size(size), reg_, operand);
+    case 'B':
+      return Register(Size(size), vex_vvvv_, operand);
+    case 'Z': {
+      int bits = size == 'f' ? StackOperandSize() : Size(size);
+      rex_used_ |= rex_ & 1;
+      return Register(bits, (opcode_ & 7) | ((rex_ & 1) << 3), operand);
+    }
+    case 'A':
+      return Register(Size(size), 0, operand);
+    case 'S':
+      if (!ReadModRM() || (reg_ & 7) > 5)
+        return false;
+      *operand = kSegmentRegisters[reg_ & 7];
+      return true;
+    case 'I': {
+      uint64_t value;
+      if (size == 'b' && length > 2) {
+        // Ibf: a byte, sign extended to the stack operand size.
+        if (!ReadImmediate(8, &value))
+          return false;
+        *operand = Hex(Truncate(SignExtend(value, 8), StackOperandSize()));
+        return true;
+      }
+      switch (size) {
+        case 'b':
+        case 'w':
+          if (!ReadImmediate(Size(size), &value))
+            return false;
+          *operand = Hex(value);
+          return true;
+        case 's':
+          if (!ReadImmediate(8, &value))
+            return false;
+          *operand = Hex(Truncate(SignExtend(value, 8), OperandSize()));
+          return true;
+        case 'z':
+          if (!ReadImmediate(Size('z'), &value))
+            return false;
+          *operand = Hex(Truncate(SignExtend(value, Size('z')),
+                                  OperandSize()));
+          return true;
+        case 'v':
+          if (!ReadImmediate(OperandSize(), &value))
+            return false;
+          *operand = Hex(value);
+          return true;
+        case 'f': {
+          int bits = Size('z');
+          if (!ReadImmediate(bits, &value))
+            return false;
+          *operand = Hex(Truncate(SignExtend(value, bits),
+                                  StackOperandSize()));
+          return true;
+        }
+      }
+      return false;
+    }
+    case 'J': {
+      if (operand_size_prefix_)
+        return false;
+      int bits = size == 'b' ? 8 : 32;
+      uint64_t value;
+      if (!ReadImmediate(bits, &value))
+        return false;
+      uint64_t target = position_ + SignExtend(value, bits);
+      *operand = Hex(Truncate(target, mode64_ ? 64 : 32));
+      return true;
+    }
+    case 'O': {
+      // objdump prints addr32 even though it shortens the offset.
+      bool address_size_used = address_size_used_;
+      uint64_t address;
+      if (!ReadImmediate(AddressSize(), &address))
+        return false;
+      address_size_used_ = address_size_used;
+      *operand = Segment() >= 0 ? kSegmentRegisters[Segment()] : "ds";
+      *operand += ":" + Hex(address);
+      segment_used_ = Segment() >= 0;
+      return true;
+    }
+    case 'X':
+    case 'Y': {
+      int bits = Size(size);
+      *operand = SizeName(bits);
+      *operand += " PTR ";
+      if (spec[0] == 'X') {
+        // In 64-bit mode, objdump prints ds for the ignored segments, but
+        // treats their prefixes as used.
+        *operand += Segment() >= 0 ? kSegmentRegisters[Segment()] : "ds";
+        segment_used_ = segment_ >= 0;
+        *operand += ":[" + AddressRegister(6) + "]";
+      } else {
+        *operand += "es:[" + AddressRegister(7) + "]";
+      }
+      return true;
+    }
+    case 'V':
+      if (!ReadModRM())
+        return false;
+      rex_used_ |= rex_ & 4;
+      *operand = VectorRegister(size, reg_);
+      return true;
+    case 'H':
+      *operand = VectorRegister(size, vex_vvvv_);
+      return true;
+    case 'U':
+    case 'W':
+      if (!ReadModRM())
+        return false;
+      if (mod_ == 3) {
+        rex_used_ |= rex_ & 1;
+        *operand = VectorRegister(size, rm_);
+        return true;
+      }
+      if (spec[0] == 'U')
+        return false;
+      *operand = Memory(Size(size));
+      return true;
+    case 'P':
+    case 'N':
+    case 'Q': {
+      if (!ReadModRM())
+        return false;
+      char buffer[8];
+      if (spec[0] == 'P') {
+        snprintf(buffer, sizeof(buffer), "mm%d", reg_ & 7);
+      } else if (mod_ == 3) {
+        snprintf(buffer, sizeof(buffer), "mm%d", rm_ & 7);
+      } else if (spec[0] == 'Q') {
+        *operand = Memory(Size(size));
+        return true;
+      } else {
+        return false;
+      }
+      *operand = buffer;
+      return true;
+    }
+  }
+  return false;
+}
+
+string Decoder::Prefixes(int flags) const {
+  string text;
+  size_t operand_size_prefixes = 0;
+  for (uint8_t prefix : prefixes_) {
+    if (prefix == 0x66)
+      ++operand_size_prefixes;
+  }
+  for (uint8_t prefix : prefixes_) {
+    switch (prefix) {
+      case 0xf0:
+        text += "lock ";
+        break;
+      case 0xf2:
+        if (repeat_)
+          text += flags & kBranch ? "bnd " : "repnz ";
+        break;
+      case 0xf3:
+        if (repeat_) {
+          text += (flags & kString) && !(flags & kStringCompare) ? "rep " :
+                                                                   "repz ";
+        }
+        break;
+      case 0x66:
+        // Only the last of several operand size prefixes takes effect.
+        if (--operand_size_prefixes ||
+            !(operand_size_used_ || mandatory_prefix_used_)) {
+          text += "data16 ";
+        }
+        break;
+      case 0x67:
+        if (!address_size_used_)
+          text += mode64_ ? "addr32 " : "addr16 ";
+        break;
+      default:
+        if (notrack_) {
+          text += "notrack ";
+        } else if (!segment_used_) {
+          text += kSegmentRegisters[segment_];
+          text += " ";
+        }
+        break;
+    }
+  }
+  // objdump prints the whole REX prefix if any of its bits had no effect.
+  if (rex_ && !vex_ &&
+      ((rex_ & 0xf & ~rex_used_) || (rex_ == 0x40 && !rex_used_))) {
+    text += "rex";
+    if (rex_ & 0xf) {
+      text += ".";
+      if (rex_ & 8) text += "W";
+      if (rex_ & 4) text += "R";
+      if (rex_ & 2) text += "X";
+      if (rex_ & 1) text += "B";
+    }
+    text += " ";
+  }
+  return text;
+}
+
+void Decoder::AppendJoined(const vector<string>& operands,
+                           string* text) const {
+  for (size_t i = 0; i < operands.size(); ++i) {
+    if (i)
+      *text += ",";
+    *text += operands[i];
+  }
+}
+
+bool Decoder::Decode(string* instruction) {
+  uint8_t opcode;
+  if (!ReadPrefixes(&opcode))
+    return false;
+
+  int map = 0;
+  if (opcode == 0x0f) {
+    if (!ReadByte(&opcode))
+      return false;
+    map = 1;
+    if (opcode == 0x38 || opcode == 0x3a) {
+      map = opcode == 0x38 ? 2 : 3;
+      if (!ReadByte(&opcode))
+        return false;
+    }
+  } else if ((opcode == 0xc4 || opcode == 0xc5) &&
+             (mode64_ ||
+              (position_ < length_ && (bytes_[position_] & 0xc0) == 0xc0))) {
+    if (!ReadVEX(opcode, &map, &opcode))
+      return false;
+  } else if (opcode == 0x62 && mode64_) {
+    // EVEX.
+    return false;
+  }
+  opcode_ = opcode;
+
+
+  string mnemonic;
+  vector<string> operands;
+  int flags = 0;
+
+  if (map == 0 && opcode == 0x9b && position_ < length_ &&
+      bytes_[position_] >= 0xd8 && bytes_[position_] <= 0xdf) {
+    // objdump merges fwait with the x87 instruction after it.
+    return false;
+  } else if (map == 0 && opcode >= 0xd8 && opcode <= 0xdf) {
+    if (!DecodeX87(opcode, &mnemonic, &operands))
+      return false;
+  } else if (map == 0 && opcode == 0x90) {
+    // objdump's treatment of the operand size prefix with REX here is
+    // irregular.
+    if (operand_size_prefix_ && (rex_ & 9))
+      return false;
+    if (repeat_ == 0xf3) {
+      mnemonic = "pause";
+      repeat_ = 0;
+    } else if (rex_ & 1) {
+      rex_used_ |= 1;
+      mnemonic = "xchg";
+      int size = OperandSize();
+      operands.push_back(size == 64 ? "r8" : size == 16 ? "r8w" : "r8d");
+      operands.push_back(size == 64 ? "rax" : size == 16 ? "ax" : "eax");
+    } else if (operand_size_prefix_) {
+      operand_size_used_ = true;
+      mnemonic = "xchg";
+      operands.push_back("ax");
+      operands.push_back("ax");
+    } else {
+      mnemonic = "nop";
+    }
+  } else if (map == 0 && (opcode == 0x98 || opcode == 0x99)) {
+    static const char* const kNames[2][3] = {
+      {"cbw", "cwde", "cdqe"}, {"cwd", "cdq", "cqo"}
+    };
+    int size = OperandSize();
+    mnemonic = kNames[opcode & 1][size == 16 ? 0 : size == 32 ? 1 : 2];
+  } else if (map == 0 && opcode == 0xe3) {
+    mnemonic = AddressSize() == 64 ? "jrcxz" :
+               AddressSize() == 32 ? "jecxz" : "jcxz";
+    string target;
+    if (!DecodeOperand("Jb", 2, &target))
+      return false;
+    operands.push_back(target);
+  } else if (map == 0 && opcode == 0xff) {
+    if (!ReadModRM())
+      return false;
+    static const char* const kGroup5[] = {
+      "inc", "dec", "call", "call", "jmp", "jmp", "push", NULL
+    };
+    static const char* const kGroup5Operands[] = {
+      "Ev", "Ev", "Ef", "Mp", "Ef", "Mp", "Ef", NULL
+    };
+    int reg = reg_ & 7;
+    if (!kGroup5[reg])
+      return false;
+    mnemonic = kGroup5[reg];
+    if (reg == 2 || reg == 4)
+      flags = kBranch;
+    if (segment_ == 3 && (reg == 2 || reg == 4))
+      notrack_ = true;
+    string operand;
+    if (!DecodeOperand(kGroup5Operands[reg], 2, &operand))
+      return false;
+    operands.push_back(operand);
+  } else if (map == 1 && opcode == 0x1e && repeat_ == 0xf3) {
+    uint8_t modrm;
+    if (!ReadByte(&modrm) || (modrm != 0xfa && modrm != 0xfb))
+      return false;
+    mnemonic = modrm == 0xfa ? "endbr64" : "endbr32";
+    repeat_ = 0;
+  } else if (map == 1 && opcode == 0xae) {
+    if (operand_size_prefix_ || !ReadModRM())
+      return false;
+    int reg = reg_ & 7;
+    if (mod_ == 3) {
+      static const char* const kFences[] = {"lfence", "mfence", "sfence"};
+      if (reg < 5 || (rm_ & 7) != 0)
+        return false;
+      mnemonic = kFences[reg - 5];
+    } else {
+      static const char* const kGroup15[] = {
+        "fxsave", "fxrstor", "ldmxcsr", "stmxcsr",
+        "xsave", "xrstor", "xsaveopt", "clflush"
+      };
+      static const int kGroup15Sizes[] = {0, 0, 32, 32, 0, 0, 0, 8};
+      if (rex_w())
+        return false;
+      mnemonic = kGroup15[reg];
+      operands.push_back(Memory(kGroup15Sizes[reg]));
+    }
+  } else if (map == 1 && opcode == 0x01) {
+    uint8_t modrm;
+    if (!ReadByte(&modrm))
+      return false;
+    for (const SystemOpcode& entry : kSystemOpcodes) {
+      if (entry.modrm == modrm)
+        mnemonic = entry.mnemonic;
+    }
+    if (mnemonic.empty() || (modrm == 0xf8 && !mode64_))
+      return false;
+  } else if (map == 1 && opcode >= 0x71 && opcode <= 0x73) {
+    if (!ReadModRM() || mod_ != 3 || repeat_)
+      return false;
+    const char* name = kShiftGroups[opcode - 0x71][reg_ & 7];
+    if (!name || (!operand_size_prefix_ && (reg_ & 7) != 2 &&
+                  (reg_ & 7) != 4 && (reg_ & 7) != 6)) {
+      return false;
+    }
+    if (vex_ && !operand_size_prefix_)
+      return false;
+    mandatory_prefix_used_ = operand_size_prefix_;
+    mnemonic = vex_ ? string("v") + name : name;
+    static const Opcode kMMXShift = {1, 0, 0, 0, 0, NULL, NULL, "Nq,Ib"};
+    static const Opcode kSSEShift = {1, 0, 0, 0, 0, NULL, NULL, "Hx,Ux,Ib"};
+    if (!DecodeOperands(operand_size_prefix_ ? kSSEShift : kMMXShift,
+                        &operands)) {
+      return false;
+    }
+  } else if (map == 0 && (opcode == 0xc6 || opcode == 0xc7) &&
+             position_ < length_ && bytes_[position_] == 0xf8) {
+    ++position_;
+    mnemonic = opcode == 0xc6 ? "xabort" : "xbegin";
+    string operand;
+    if (!DecodeOperand(opcode == 0xc6 ? "Ib" : "Jz", 2, &operand))
+      return false;
+    operands.push_back(operand);
+  } else if (map == 1 && opcode == 0xc7) {
+    if (!ReadModRM() || mod_ == 3 || (reg_ & 7) != 1)
+      return false;
+    if (rex_w()) {
+      mnemonic = "cmpxchg16b";
+      operands.push_back("OWORD PTR " + Memory(0));
+    } else {
+      mnemonic = "cmpxchg8b";
+      operands.push_back(Memory(64));
+    }
+  } else if (map == 1 && opcode == 0x77 && vex_) {
+    mnemonic = vex_l_ ? "vzeroall" : "vzeroupper";
+    repeat_ = 0;
+    operand_size_prefix_ = false;
+  } else {
+    bool uses_modrm = false;
+    const Opcode* entry = FindOpcode(map, opcode, &uses_modrm);
+    if (!entry)
+      return false;
+    // objdump's handling of 66 with REX.W depends on its own opcode
+    // tables for these.
+    if (((map == 1 && (opcode == 0xb8 || opcode == 0xbc || opcode == 0xbd)) ||
+         (map == 2 && (opcode == 0xf0 || opcode == 0xf1)) ||
+         (map == 0 && opcode == 0x63)) &&
+        operand_size_prefix_ && (rex_ & 8)) {
+      return false;
+    }
+    // REX.W gives these string comparisons a "q" suffix.
+    if (map == 3 && opcode >= 0x60 && opcode <= 0x63 && rex_w())
+      return false;
+    flags = entry->flags;
+    if (entry->group) {
+      if (!ReadModRM())
+        return false;
+      const char* name = entry->group[reg_ & 7];
+      if (!name)
+        return false;
+      mnemonic = name;
+    } else {
+      mnemonic = entry->mnemonic;
+    }
+    if (flags & kCondition)
+      mnemonic += kConditions[opcode & 0xf];
+    if ((flags & kWideQ) && rex_w())
+      mnemonic[mnemonic.size() - 1] = 'q';
+    if (vex_ && !(flags & kVEXOnly))
+      mnemonic = "v" + mnemonic;
+    if (flags & kMandatoryPrefix) {
+      mandatory_prefix_used_ = operand_size_prefix_;
+      repeat_ = 0;
+    } else if (entry->prefix) {
+      repeat_ = 0;
+    }
+    if ((flags & kStackSuffix) && StackOperandSize() == 16)
+      mnemonic += "w";
+    // Immediate moves of 64-bit values and 64-bit absolute addresses.
+    if (map == 0 && mode64_ &&
+        ((opcode >= 0xb8 && opcode <= 0xbf && rex_w()) ||
+         (opcode >= 0xa0 && opcode <= 0xa3 && !address_size_prefix_))) {
+      mnemonic = "movabs";
+    }
+    Opcode test;
+    if (map == 0 && (opcode == 0xf6 || opcode == 0xf7) && (reg_ & 7) == 0) {
+      // Group 3's test is the only member that takes an immediate.
+      test = *entry;
+      test.operands = opcode == 0xf6 ? "Eb,Ib" : "Ev,Iz";
+      entry = &test;
+    }
+    if (!DecodeOperands(*entry, &operands))
+      return false;
+    // objdump prints a ymm destination for the register forms of these,
+    // when VEX.L is set.
+    if (vex_ && vex_l_ && mod_ == 3 && map == 1 &&
+        (opcode == 0x10 || opcode == 0x11) && (flags & kRegisterOnly)) {
+      return false;
+    }
+  }
+
+  if (repeat_) {
+    // Other instructions in the 0F maps treat F3 and F2 as mandatory
+    // prefixes, and with lock they are xacquire and xrelease.
+    if ((map && !(flags & kBranch)) || lock_)
+      return false;
+    // F3 also makes stores xrelease, and both are allowed on xchg, which
+    // is implicitly locked.
+    if (map == 0 && has_modrm_ && mod_ != 3 &&
+        (opcode == 0x86 || opcode == 0x87 ||
+         (repeat_ == 0xf3 && (opcode == 0x88 || opcode == 0x89 ||
+                              opcode == 0xc6 || opcode == 0xc7)))) {
+      return false;
+    }
+  }
+
+  string text = Prefixes(flags) + mnemonic;
+  if (!operands.empty()) {
+    if (text.size() < 6)
+      text.resize(6, ' ');
+    text += " ";
+    AppendJoined(operands, &text);
+  }
+  if (rip_relative_) {
+    uint64_t target = position_ + displacement_;
+    text += "        # " + Hex(target);
+  }
+  *instruction = text;
+  return true;
+}
+
+}  // namespace
+
+// static
+bool X86InstructionDecoder::Decode(uint32_t cpu, const uint8_t* bytes,
+                                   size_t length, string* instruction) {
+  if (!bytes || (cpu != MD_CONTEXT_X86 && cpu != MD_CONTEXT_AMD64))
+    return false;
+  Decoder decoder(cpu == MD_CONTEXT_AMD64, bytes, length);
+  return decoder.Decode(instruction);
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,63 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// x86_instruction_decoder.h: Decodes single x86 and x86-64 instructions
+// into objdump's Intel syntax, without running objdump.
+
+#ifndef PROCESSOR_X86_INSTRUCTION_DECODER_H__
+#define PROCESSOR_X86_INSTRUCTION_DECODER_H__
+
+#include <stddef.h>
+
+#include <string>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+// Decodes the general purpose instructions, and the common x87, SSE and
+// AVX moves and integer operations, that crashing instructions usually
+// are.  The text matches what "objdump -M intel" prints for the same bytes
+// when disassembled from address 0, so DisassemblerObjdump can parse it in
+// the same way.  Instructions outside that set, such as AVX-512 and the
+// less common x87 and system instructions, are not decoded.
+class X86InstructionDecoder {
+ public:
+  // Decodes the instruction at the start of the |length| bytes at |bytes|,
+  // for |cpu|, which must be MD_CONTEXT_X86 or MD_CONTEXT_AMD64.  On
+  // success, stores the instruction's text in |instruction| and returns
+  // true.  Returns false if the bytes are not an instruction this decoder
+  // supports, or if they end partway through one.
+  static bool Decode(uint32_t cpu, const uint8_t* bytes, size_t length,
+                     string* instruction);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_X86_INSTRUCTION_DECODER_H__
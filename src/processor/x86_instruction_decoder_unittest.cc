@@ -0,0 +1,134 @@
+// Copyright 2026 Google LLC
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google LLC nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// x86_instruction_decoder_unittest.cc: Unit tests for X86InstructionDecoder.
+// The expected strings are objdump's output for the same bytes.
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>  // Must come first
+#endif
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/common/minidump_format.h"
+#include "processor/x86_instruction_decoder.h"
+
+namespace {
+
+using google_breakpad::X86InstructionDecoder;
+
+struct DecoderCase {
+  std::vector<uint8_t> bytes;
+  const char* instruction;
+};
+
+void CheckCases(uint32_t cpu, const std::vector<DecoderCase>& cases) {
+  for (const DecoderCase& decoder_case : cases) {
+    string instruction;
+    ASSERT_TRUE(X86InstructionDecoder::Decode(cpu, decoder_case.bytes.data(),
+                                              decoder_case.bytes.size(),
+                                              &instruction))
+        << decoder_case.instruction;
+    EXPECT_EQ(decoder_case.instruction, instruction);
+  }
+}
+
+TEST(X86InstructionDecoderTest, AMD64) {
+  CheckCases(MD_CONTEXT_AMD64, {
+    {{0x58}, "pop    rax"},
+    {{0xf3, 0x48, 0xab}, "rep stos QWORD PTR es:[rdi],rax"},
+    {{0x48, 0x8b, 0x05, 0x10, 0x00, 0x00, 0x00},
+     "mov    rax,QWORD PTR [rip+0x10]        # 0x17"},
+    {{0xf0, 0x48, 0x0f, 0xb1, 0x0a}, "lock cmpxchg QWORD PTR [rdx],rcx"},
+    {{0xe8, 0x00, 0x00, 0x00, 0x00}, "call   0x5"},
+    {{0x74, 0x10}, "je     0x12"},
+    {{0x48, 0xb8, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11},
+     "movabs rax,0x1122334455667788"},
+    {{0x64, 0x48, 0x8b, 0x04, 0x25, 0x28, 0x00, 0x00, 0x00},
+     "mov    rax,QWORD PTR fs:0x28"},
+    {{0x48, 0x8b, 0x34, 0xc8}, "mov    rsi,QWORD PTR [rax+rcx*8]"},
+    {{0x0f, 0x1f, 0x44, 0x00, 0x00}, "nop    DWORD PTR [rax+rax*1+0x0]"},
+    {{0x66, 0x2e, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+     "cs nop WORD PTR [rax+rax*1+0x0]"},
+    {{0x66, 0x90}, "xchg   ax,ax"},
+    {{0x41, 0xc3}, "rex.B ret"},
+    {{0x41, 0xff, 0xd4}, "call   r12"},
+    {{0xf3, 0x0f, 0x6f, 0x06}, "movdqu xmm0,XMMWORD PTR [rsi]"},
+    {{0xc5, 0xfe, 0x6f, 0x06}, "vmovdqu ymm0,YMMWORD PTR [rsi]"},
+    {{0xdd, 0x04, 0x24}, "fld    QWORD PTR [rsp]"},
+    {{0xd9, 0xc9}, "fxch   st(1)"},
+    {{0x0f, 0x0b}, "ud2"},
+    {{0xcc}, "int3"},
+  });
+}
+
+TEST(X86InstructionDecoderTest, X86) {
+  CheckCases(MD_CONTEXT_X86, {
+    {{0x58}, "pop    eax"},
+    {{0x8b, 0x44, 0x24, 0x04}, "mov    eax,DWORD PTR [esp+0x4]"},
+    {{0x66, 0x8b, 0x03}, "mov    ax,WORD PTR [ebx]"},
+    {{0x64, 0xa1, 0x00, 0x00, 0x00, 0x00}, "mov    eax,fs:0x0"},
+    {{0xff, 0x15, 0x10, 0x20, 0x30, 0x40}, "call   DWORD PTR ds:0x40302010"},
+    {{0xc3}, "ret"},
+  });
+}
+
+TEST(X86InstructionDecoderTest, OnlyUsesLeadingInstruction) {
+  const uint8_t bytes[] = {0x58, 0x5b, 0xc3};
+  string instruction;
+  ASSERT_TRUE(X86InstructionDecoder::Decode(MD_CONTEXT_AMD64, bytes,
+                                            sizeof(bytes), &instruction));
+  EXPECT_EQ("pop    rax", instruction);
+}
+
+TEST(X86InstructionDecoderTest, Truncated) {
+  const uint8_t bytes[] = {0x48, 0x8b, 0x05, 0x10, 0x00, 0x00, 0x00};
+  string instruction;
+  for (size_t length = 0; length < sizeof(bytes); ++length) {
+    EXPECT_FALSE(X86InstructionDecoder::Decode(MD_CONTEXT_AMD64, bytes,
+                                               length, &instruction));
+  }
+}
+
+TEST(X86InstructionDecoderTest, Unsupported) {
+  string instruction;
+
+  // AVX-512 vmovdqu64 zmm0,ZMMWORD PTR [rsi]
+  const uint8_t evex[] = {0x62, 0xf1, 0xfe, 0x48, 0x6f, 0x06};
+  EXPECT_FALSE(X86InstructionDecoder::Decode(MD_CONTEXT_AMD64, evex,
+                                             sizeof(evex), &instruction));
+
+  const uint8_t ret[] = {0xc3};
+  EXPECT_FALSE(X86InstructionDecoder::Decode(MD_CONTEXT_ARM64, ret,
+                                             sizeof(ret), &instruction));
+}
+
+}  // namespace
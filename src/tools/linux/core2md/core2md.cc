@@ -33,6 +33,8 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 #include "client/linux/minidump_writer/minidump_writer.h"
 #include "client/linux/minidump_writer/linux_core_dumper.h"
@@ -43,32 +45,52 @@ using google_breakpad::MappingList;
 using google_breakpad::LinuxCoreDumper;
 
 static int ShowUsage(const char* argv0) {
-  fprintf(stderr, "Usage: %s <core file> <procfs dir> <output>\n",
+  fprintf(stderr,
+          "Usage: %s [-j <tasks>] <core file> <procfs dir> <output>\n"
+          "\n"
+          "  -j <tasks>  Copy the thread stacks on this many tasks at once,\n"
+          "              up to 16. Worthwhile for large cores with many\n"
+          "              threads. Defaults to 1.\n",
           google_breakpad::BaseName(argv0).c_str());
   return 1;
 }
 
 bool WriteMinidumpFromCore(const char* filename,
                            const char* core_path,
-                           const char* procfs_override) {
+                           const char* procfs_override,
+                           int stack_capture_tasks) {
   MappingList mappings;
   AppMemoryList memory_list;
   LinuxCoreDumper dumper(0, core_path, procfs_override);
   return google_breakpad::WriteMinidump(filename, mappings, memory_list,
-                                        &dumper);
+                                        &dumper, stack_capture_tasks);
 }
 
 int main(int argc, char *argv[]) {
-  if (argc != 4) {
+  int stack_capture_tasks = 1;
+  int ch;
+  while ((ch = getopt(argc, argv, "j:")) != -1) {
+    switch (ch) {
+      case 'j':
+        stack_capture_tasks = atoi(optarg);
+        if (stack_capture_tasks < 1)
+          return ShowUsage(argv[0]);
+        break;
+      default:
+        return ShowUsage(argv[0]);
+    }
+  }
+  if (argc - optind != 3) {
     return ShowUsage(argv[0]);
   }
 
-  const char* core_file = argv[1];
-  const char* procfs_dir = argv[2];
-  const char* minidump_file = argv[3];
+  const char* core_file = argv[optind];
+  const char* procfs_dir = argv[optind + 1];
+  const char* minidump_file = argv[optind + 2];
   if (!WriteMinidumpFromCore(minidump_file,
                              core_file,
-                             procfs_dir)) {
+                             procfs_dir,
+                             stack_capture_tasks)) {
     perror("core2md: Unable to generate minidump");
     return 1;
   }
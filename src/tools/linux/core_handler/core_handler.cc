@@ -32,14 +32,20 @@
 #include <config.h>  // Must come first
 #endif
 
+#include <elf.h>
+#include <link.h>
 #include <pwd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <syslog.h>
 #include <unistd.h>
+
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 #include "client/linux/minidump_writer/linux_core_dumper.h"
 #include "client/linux/minidump_writer/minidump_writer.h"
@@ -50,9 +56,14 @@ namespace {
 
 using google_breakpad::AppMemoryList;
 using google_breakpad::LinuxCoreDumper;
+using google_breakpad::MappingInfo;
 using google_breakpad::MappingList;
+using google_breakpad::ThreadInfo;
 using google_breakpad::scoped_array;
 
+typedef ElfW(Ehdr) Ehdr;
+typedef ElfW(Phdr) Phdr;
+
 // Size of the core dump to read in order to access all the threads
 // descriptions.
 //
@@ -61,12 +72,24 @@ using google_breakpad::scoped_array;
 // several hundreds of threads.
 const int core_read_size = 1024 * 1024;
 
+// The most bytes of notes that the streaming mode reads, which allows tens
+// of thousands of threads.
+const size_t kMaxNotesSize = 256 * 1024 * 1024;
+
+// The bytes kept on each side of each thread's instruction pointer, as
+// the minidump writer copies them for the crashing thread.
+const uintptr_t kInstructionPointerWindow = 128;
+
 void ShowUsage(const char* argv0) {
-  fprintf(stderr, "Usage: %s <process id> <minidump file>\n\n",
+  fprintf(stderr, "Usage: %s [--stream] <process id> <minidump file>\n\n",
           google_breakpad::BaseName(argv0).c_str());
   fprintf(stderr,
           "A tool which serves as a core dump handler and produces "
-          "minidump files.\n");
+          "minidump files.\n\n");
+  fprintf(stderr,
+          "With --stream, the whole core dump is read from the standard "
+          "input once, and\nthe thread stacks are taken from it rather than "
+          "from /proc/<pid>/mem.\n\n");
   fprintf(stderr, "Please refer to the online documentation:\n");
   fprintf(stderr,
           "https://chromium.googlesource.com/breakpad/breakpad/+/HEAD"
@@ -83,6 +106,286 @@ bool WriteMinidumpFromCore(const char* filename,
                                         &dumper);
 }
 
+bool ReadFully(int fd, void* buffer, size_t length) {
+  uint8_t* bytes = static_cast<uint8_t*>(buffer);
+  while (length > 0) {
+    const ssize_t r = read(fd, bytes, length);
+    if (r <= 0)
+      return false;
+    bytes += r;
+    length -= r;
+  }
+  return true;
+}
+
+bool WriteFully(int fd, const void* buffer, size_t length) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+  while (length > 0) {
+    const ssize_t w = write(fd, bytes, length);
+    if (w <= 0)
+      return false;
+    bytes += w;
+    length -= w;
+  }
+  return true;
+}
+
+// A part of a PT_LOAD segment of the core dump to keep.
+struct KeptRange {
+  uint64_t file_offset;
+  uint64_t virtual_address;
+  uint64_t size;
+  ElfW(Word) flags;
+
+  bool operator<(const KeptRange& other) const {
+    return file_offset < other.file_offset;
+  }
+};
+
+// Adds the parts of the PT_LOAD segments in |headers| that hold the
+// |size| bytes at |address| to |ranges|.
+void KeepMemory(const std::vector<Phdr>& headers, uintptr_t address,
+                uintptr_t size, std::vector<KeptRange>* ranges) {
+  for (size_t i = 0; i < headers.size(); ++i) {
+    const Phdr& header = headers[i];
+    if (header.p_type != PT_LOAD || header.p_filesz == 0)
+      continue;
+    const uintptr_t start = std::max<uintptr_t>(address, header.p_vaddr);
+    const uintptr_t end = std::min<uintptr_t>(address + size,
+                                              header.p_vaddr + header.p_filesz);
+    if (start >= end)
+      continue;
+    KeptRange range;
+    range.file_offset = header.p_offset + (start - header.p_vaddr);
+    range.virtual_address = start;
+    range.size = end - start;
+    range.flags = header.p_flags;
+    ranges->push_back(range);
+  }
+}
+
+// Reads the core dump from stdin in a single pass and writes to |out_fd| a
+// core dump that holds its notes, but only the parts of its memory that
+// the minidump is made of: each thread's stack, the bytes around each
+// thread's instruction pointer, and linux-gate.so. Memory that the writer
+// needs beyond these is still read from /proc/<pid>/mem, if it can be.
+//
+// The threads' stack pointers are found by dumping the notes alone first.
+// The kernel writes the notes before all of the memory, so the whole core
+// never needs to be held.
+bool StreamCore(const char* procfs_dir, int out_fd) {
+  Ehdr ehdr;
+  if (!ReadFully(STDIN_FILENO, &ehdr, sizeof(ehdr)) ||
+      memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0 ||
+      ehdr.e_ident[EI_CLASS] != google_breakpad::ElfCoreDump::kClass ||
+      ehdr.e_type != ET_CORE || ehdr.e_phentsize != sizeof(Phdr) ||
+      ehdr.e_phoff < sizeof(ehdr) || ehdr.e_phnum == 0 ||
+      ehdr.e_phnum == PN_XNUM) {
+    return false;
+  }
+
+  // The headers and notes come first; read them whole.
+  std::vector<uint8_t> head(sizeof(ehdr));
+  memcpy(&head[0], &ehdr, sizeof(ehdr));
+  const size_t headers_end = ehdr.e_phoff + ehdr.e_phnum * sizeof(Phdr);
+  head.resize(headers_end);
+  if (!ReadFully(STDIN_FILENO, &head[sizeof(ehdr)],
+                 headers_end - sizeof(ehdr))) {
+    return false;
+  }
+  std::vector<Phdr> headers(ehdr.e_phnum);
+  memcpy(&headers[0], &head[ehdr.e_phoff], headers_end - ehdr.e_phoff);
+
+  size_t notes_end = headers_end;
+  for (size_t i = 0; i < headers.size(); ++i) {
+    if (headers[i].p_type == PT_NOTE) {
+      if (headers[i].p_offset < headers_end ||
+          headers[i].p_offset + headers[i].p_filesz > kMaxNotesSize) {
+        return false;
+      }
+      notes_end = std::max<size_t>(notes_end,
+                                   headers[i].p_offset + headers[i].p_filesz);
+    }
+  }
+  head.resize(notes_end);
+  if (!ReadFully(STDIN_FILENO, &head[headers_end], notes_end - headers_end))
+    return false;
+
+  // Dump the notes alone, to find where the threads' stacks are.
+  std::vector<KeptRange> ranges;
+  {
+    int notes_fd = memfd_create("core_notes", MFD_CLOEXEC);
+    if (notes_fd == -1)
+      return false;
+    Ehdr notes_ehdr = ehdr;
+    std::vector<uint8_t> notes_core(head);
+    std::vector<Phdr> notes_headers;
+    for (size_t i = 0; i < headers.size(); ++i) {
+      if (headers[i].p_type == PT_NOTE)
+        notes_headers.push_back(headers[i]);
+    }
+    notes_ehdr.e_phnum = notes_headers.size();
+    notes_ehdr.e_shoff = 0;
+    notes_ehdr.e_shnum = 0;
+    notes_ehdr.e_shstrndx = 0;
+    memcpy(&notes_core[0], &notes_ehdr, sizeof(notes_ehdr));
+    memcpy(&notes_core[ehdr.e_phoff], &notes_headers[0],
+           notes_headers.size() * sizeof(Phdr));
+    if (!WriteFully(notes_fd, &notes_core[0], notes_core.size())) {
+      close(notes_fd);
+      return false;
+    }
+
+    std::stringstream notes_path_ss;
+    notes_path_ss << "/proc/self/fd/" << notes_fd;
+    std::string notes_path(notes_path_ss.str());
+    LinuxCoreDumper dumper(0, notes_path.c_str(), procfs_dir);
+    if (!dumper.Init()) {
+      close(notes_fd);
+      return false;
+    }
+    for (size_t i = 0; i < dumper.threads().size(); ++i) {
+      ThreadInfo info;
+      if (!dumper.GetThreadInfoByIndex(i, &info))
+        continue;
+      const void* stack;
+      size_t stack_len;
+      if (dumper.GetStackInfo(&stack, &stack_len, info.stack_pointer)) {
+        KeepMemory(headers, reinterpret_cast<uintptr_t>(stack), stack_len,
+                   &ranges);
+      }
+      const uintptr_t ip = info.GetInstructionPointer();
+      if (ip > kInstructionPointerWindow) {
+        KeepMemory(headers, ip - kInstructionPointerWindow,
+                   2 * kInstructionPointerWindow, &ranges);
+      }
+    }
+    for (size_t i = 0; i < dumper.mappings().size(); ++i) {
+      const MappingInfo& mapping = *dumper.mappings()[i];
+      if (strcmp(mapping.name, google_breakpad::kLinuxGateLibraryName) == 0)
+        KeepMemory(headers, mapping.start_addr, mapping.size, &ranges);
+    }
+    close(notes_fd);
+  }
+
+  // Merge the ranges that overlap or touch within a segment, so that each
+  // is read in file order and only once.
+  std::sort(ranges.begin(), ranges.end());
+  std::vector<KeptRange> kept;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    const KeptRange& range = ranges[i];
+    if (range.file_offset < notes_end)
+      continue;
+    if (!kept.empty()) {
+      KeptRange& last = kept.back();
+      const uint64_t last_end = last.file_offset + last.size;
+      if (range.file_offset <= last_end &&
+          range.file_offset - last.file_offset ==
+              range.virtual_address - last.virtual_address) {
+        last.size = std::max(last_end, range.file_offset + range.size) -
+                    last.file_offset;
+        continue;
+      }
+      // Ranges of different segments never share bytes of the file.
+      if (range.file_offset < last_end)
+        continue;
+    }
+    kept.push_back(range);
+  }
+
+  // The new core dump has the notes' headers and one PT_LOAD segment for
+  // each kept range, followed by the notes and the ranges' data.
+  std::vector<Phdr> out_headers;
+  for (size_t i = 0; i < headers.size(); ++i) {
+    if (headers[i].p_type == PT_NOTE)
+      out_headers.push_back(headers[i]);
+  }
+  const size_t note_count = out_headers.size();
+  uint64_t out_offset =
+      sizeof(Ehdr) + (note_count + kept.size()) * sizeof(Phdr);
+  for (size_t i = 0; i < note_count; ++i) {
+    const uint64_t note_offset = out_headers[i].p_offset;
+    out_headers[i].p_offset = out_offset;
+    if (pwrite(out_fd, &head[note_offset], out_headers[i].p_filesz,
+               out_offset) != static_cast<ssize_t>(out_headers[i].p_filesz)) {
+      return false;
+    }
+    out_offset += out_headers[i].p_filesz;
+  }
+
+  // Copy the kept ranges as they go by, and stop reading once the last is
+  // copied: the process stays until this handler closes its input.
+  uint64_t in_offset = notes_end;
+  std::vector<uint8_t> buffer(1024 * 1024);
+  for (size_t i = 0; i < kept.size(); ++i) {
+    const KeptRange& range = kept[i];
+    bool copied = true;
+    while (copied && in_offset < range.file_offset) {
+      const size_t chunk = std::min<uint64_t>(buffer.size(),
+                                              range.file_offset - in_offset);
+      copied = ReadFully(STDIN_FILENO, &buffer[0], chunk);
+      in_offset += chunk;
+    }
+    for (uint64_t done = 0; copied && done < range.size;) {
+      const size_t chunk = std::min<uint64_t>(buffer.size(),
+                                              range.size - done);
+      copied = ReadFully(STDIN_FILENO, &buffer[0], chunk) &&
+               pwrite(out_fd, &buffer[0], chunk, out_offset + done) ==
+                   static_cast<ssize_t>(chunk);
+      done += chunk;
+    }
+    // A truncated core keeps the ranges that were read whole.
+    if (!copied)
+      break;
+    in_offset += range.size;
+
+    Phdr header;
+    memset(&header, 0, sizeof(header));
+    header.p_type = PT_LOAD;
+    header.p_flags = range.flags;
+    header.p_offset = out_offset;
+    header.p_vaddr = range.virtual_address;
+    header.p_filesz = range.size;
+    header.p_memsz = range.size;
+    header.p_align = 1;
+    out_headers.push_back(header);
+    out_offset += range.size;
+  }
+
+  Ehdr out_ehdr = ehdr;
+  out_ehdr.e_phoff = sizeof(Ehdr);
+  out_ehdr.e_phnum = out_headers.size();
+  out_ehdr.e_shoff = 0;
+  out_ehdr.e_shnum = 0;
+  out_ehdr.e_shstrndx = 0;
+  const size_t out_headers_size = out_headers.size() * sizeof(Phdr);
+  return pwrite(out_fd, &out_ehdr, sizeof(out_ehdr), 0) ==
+             static_cast<ssize_t>(sizeof(out_ehdr)) &&
+         pwrite(out_fd, &out_headers[0], out_headers_size, sizeof(Ehdr)) ==
+             static_cast<ssize_t>(out_headers_size);
+}
+
+bool HandleStreamedCrash(const char* procfs_dir, const char* md_filename) {
+  int fd = memfd_create("core_file", MFD_CLOEXEC);
+  if (fd == -1) {
+    return false;
+  }
+
+  if (!StreamCore(procfs_dir, fd)) {
+    close(fd);
+    return false;
+  }
+
+  std::stringstream core_file_ss;
+  core_file_ss << "/proc/self/fd/" << fd;
+  std::string core_file(core_file_ss.str());
+
+  const bool success =
+      WriteMinidumpFromCore(md_filename, core_file.c_str(), procfs_dir);
+  close(fd);
+  return success;
+}
+
 bool HandleCrash(pid_t pid, const char* procfs_dir, const char* md_filename) {
   int r = 0;
   scoped_array<char> buf(new char[core_read_size]);
@@ -125,13 +428,14 @@ bool HandleCrash(pid_t pid, const char* procfs_dir, const char* md_filename) {
 int main(int argc, char* argv[]) {
   int ret = EXIT_FAILURE;
 
-  if (argc != 3) {
+  const bool stream = argc == 4 && strcmp(argv[1], "--stream") == 0;
+  if (argc != 3 && !stream) {
     ShowUsage(argv[0]);
     return ret;
   }
 
-  const char* pid_str = argv[1];
-  const char* md_filename = argv[2];
+  const char* pid_str = argv[argc - 2];
+  const char* md_filename = argv[argc - 1];
   pid_t pid = atoi(pid_str);
 
   std::stringstream proc_dir_ss;
@@ -139,7 +443,10 @@ int main(int argc, char* argv[]) {
   std::string proc_dir(proc_dir_ss.str());
 
   openlog("core_handler", 0, 0);
-  if (HandleCrash(pid, proc_dir.c_str(), md_filename)) {
+  const bool handled =
+      stream ? HandleStreamedCrash(proc_dir.c_str(), md_filename)
+             : HandleCrash(pid, proc_dir.c_str(), md_filename);
+  if (handled) {
     syslog(LOG_NOTICE, "Minidump generated at %s\n", md_filename);
     ret = EXIT_SUCCESS;
   } else {
@@ -30,25 +30,114 @@
 #include <config.h>  // Must come first
 #endif
 
+#include <dirent.h>
+#include <elf.h>
 #include <paths.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "common/block_gzip.h"
+#include "common/linux/bulk_dump_symbols.h"
+#include "common/linux/debug_file_finder.h"
 #include "common/linux/dump_symbols.h"
+#include "common/linux/libcurl_wrapper.h"
 #include "common/path_helper.h"
 
+using google_breakpad::DumpSymbolsToStore;
 using google_breakpad::WriteSymbolFile;
 using google_breakpad::WriteSymbolFileHeader;
 
+// Return true if PATH is an ELF executable or shared library, as opposed
+// to an object file or something else.
+static bool IsLinkedELFFile(const std::string& path) {
+  unsigned char header[EI_NIDENT + 2];
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+      memcmp(header, ELFMAG, SELFMAG) != 0) {
+    return false;
+  }
+  // e_type follows e_ident in both ELF classes.
+  int type = header[EI_DATA] == ELFDATA2MSB
+      ? header[EI_NIDENT] << 8 | header[EI_NIDENT + 1]
+      : header[EI_NIDENT + 1] << 8 | header[EI_NIDENT];
+  return type == ET_EXEC || type == ET_DYN;
+}
+
+// Add the ELF executables and shared libraries in DIRECTORY and its
+// subdirectories to FILES.
+static void FindELFFiles(const std::string& directory,
+                         std::vector<std::string>* files) {
+  DIR* dir = opendir(directory.c_str());
+  if (!dir) {
+    fprintf(stderr, "Could not open directory %s\n", directory.c_str());
+    return;
+  }
+  std::vector<std::string> entries;
+  while (dirent* entry = readdir(dir)) {
+    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+      entries.push_back(directory + "/" + entry->d_name);
+  }
+  closedir(dir);
+  // Keep the order the same from one run to the next.
+  std::sort(entries.begin(), entries.end());
+  for (const std::string& path : entries) {
+    struct stat st;
+    // Symbolic links would only list the files they lead to again.
+    if (lstat(path.c_str(), &st) != 0)
+      continue;
+    if (S_ISDIR(st.st_mode)) {
+      FindELFFiles(path, files);
+    } else if (S_ISREG(st.st_mode) && IsLinkedELFFile(path)) {
+      files->push_back(path);
+    }
+  }
+}
+
+// Fetch URL into the file at PATH with LIBCURL, returning true if the
+// server had it.
+static bool FetchDebugFile(google_breakpad::LibcurlWrapper* libcurl,
+                           const std::string& url,
+                           const std::string& path) {
+  long http_status_code = 0;
+  std::string response;
+  if (!libcurl->SendGetRequest(url, &http_status_code, NULL, &response) ||
+      http_status_code != 200) {
+    return false;
+  }
+  std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+  file.write(response.data(), response.size());
+  file.close();
+  return !file.fail();
+}
+
+// Return the directory debuginfod clients keep their cache in by default.
+static std::string DefaultDebuginfodCache() {
+  if (const char* path = getenv("DEBUGINFOD_CACHE_PATH"))
+    return path;
+  if (const char* path = getenv("XDG_CACHE_HOME"))
+    return std::string(path) + "/debuginfod_client";
+  const char* home = getenv("HOME");
+  return std::string(home ? home : "") + "/.cache/debuginfod_client";
+}
+
 int usage(const char* self) {
   fprintf(stderr,
           "Usage: %s [OPTION] <binary-with-debugging-info> "
-          "[directories-for-debug-file]\n\n",
+          "[directories-for-debug-file]\n",
+          google_breakpad::BaseName(self).c_str());
+  fprintf(stderr,
+          "       %s [OPTION] -O <store> [-M <manifest>] "
+          "[binaries-or-directories]\n\n",
           google_breakpad::BaseName(self).c_str());
   fprintf(stderr, "Options:\n");
   fprintf(stderr, "  -i:         Output module header information only.\n");
@@ -59,6 +148,32 @@ int usage(const char* self) {
   fprintf(stderr, "  -r          Do not handle inter-compilation "
                                  "unit references\n");
   fprintf(stderr, "  -v          Print all warnings to stderr\n");
+  fprintf(stderr, "  -j <count>  Decompress debug sections and convert DWARF "
+                                 "compilation units and CFI on <count> "
+                                 "threads\n");
+  fprintf(stderr, "  -s <MiB>    Spill symbol data to temporary files beyond "
+                                 "<MiB> of it in memory\n");
+  fprintf(stderr, "  -C <dir>    Keep the symbols of each DWARF compilation "
+                                 "unit in <dir>, and reuse those of unchanged "
+                                 "units\n");
+  fprintf(stderr, "  -u <url>    Fetch the debug file of a stripped binary "
+                                 "from the debuginfod server at <url> when it "
+                                 "isn't in the directories; may be repeated\n");
+  fprintf(stderr, "  -k <dir>    Cache the debug files fetched with -u in "
+                                 "<dir>, by default as debuginfod clients "
+                                 "do\n");
+  fprintf(stderr, "  -z          Compress the symbol file with gzip, in "
+                                 "blocks that can be decompressed on the "
+                                 "-j threads\n");
+  fprintf(stderr, "  -O <store>  Write the symbols of each binary, and of each "
+                                 "ELF executable and shared library in the "
+                                 "directories, to "
+                                 "<store>/<debug_file>/<id>/<debug_file>.sym, "
+                                 "dumping several at once on the -j threads\n");
+  fprintf(stderr, "  -M <file>   With -O, also dump the binaries listed in "
+                                 "<file>, one per line\n");
+  fprintf(stderr, "  -B <MiB>    With -O, only start another binary while "
+                                 "those being dumped total at most <MiB>\n");
   fprintf(stderr, "  -b <id>     Use specified id for the module id\n");
   fprintf(stderr, "  -n <name>   Use specified name for name of the object\n");
   fprintf(stderr, "  -o <os>     Use specified name for the "
@@ -79,6 +194,15 @@ int main(int argc, char** argv) {
   bool handle_inter_cu_refs = true;
   bool log_to_stderr = false;
   bool enable_multiple_field = false;
+  bool compress_output = false;
+  int thread_count = 1;
+  size_t memory_budget = 0;
+  std::string unit_cache_directory;
+  std::vector<std::string> debuginfod_urls;
+  std::string debuginfod_cache;
+  std::string store_directory;
+  std::string manifest;
+  size_t bulk_memory_budget = 0;
   std::string obj_name;
   std::string module_id;
   const char* obj_os = "Linux";
@@ -120,13 +244,114 @@ int main(int argc, char** argv) {
       ++arg_index;
     } else if (strcmp("-m", argv[arg_index]) == 0) {
       enable_multiple_field = true;
+    } else if (strcmp("-z", argv[arg_index]) == 0) {
+#ifdef HAVE_LIBZ
+      compress_output = true;
+#else
+      fprintf(stderr, "-z requires dump_syms to be built with zlib\n");
+      return usage(argv[0]);
+#endif
+    } else if (strcmp("-j", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -j\n");
+        return usage(argv[0]);
+      }
+      thread_count = atoi(argv[arg_index + 1]);
+      if (thread_count < 1) {
+        fprintf(stderr, "Invalid argument to -j\n");
+        return usage(argv[0]);
+      }
+      ++arg_index;
+    } else if (strcmp("-s", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -s\n");
+        return usage(argv[0]);
+      }
+      int megabytes = atoi(argv[arg_index + 1]);
+      if (megabytes < 1) {
+        fprintf(stderr, "Invalid argument to -s\n");
+        return usage(argv[0]);
+      }
+      memory_budget = static_cast<size_t>(megabytes) << 20;
+      ++arg_index;
+    } else if (strcmp("-u", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -u\n");
+        return usage(argv[0]);
+      }
+      debuginfod_urls.push_back(argv[arg_index + 1]);
+      ++arg_index;
+    } else if (strcmp("-k", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -k\n");
+        return usage(argv[0]);
+      }
+      debuginfod_cache = argv[arg_index + 1];
+      ++arg_index;
+    } else if (strcmp("-O", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -O\n");
+        return usage(argv[0]);
+      }
+      struct stat st;
+      if (stat(argv[arg_index + 1], &st) != 0 || !S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "Invalid argument to -O\n");
+        return usage(argv[0]);
+      }
+      store_directory = argv[arg_index + 1];
+      ++arg_index;
+    } else if (strcmp("-M", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -M\n");
+        return usage(argv[0]);
+      }
+      manifest = argv[arg_index + 1];
+      ++arg_index;
+    } else if (strcmp("-B", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -B\n");
+        return usage(argv[0]);
+      }
+      int megabytes = atoi(argv[arg_index + 1]);
+      if (megabytes < 1) {
+        fprintf(stderr, "Invalid argument to -B\n");
+        return usage(argv[0]);
+      }
+      bulk_memory_budget = static_cast<size_t>(megabytes) << 20;
+      ++arg_index;
+    } else if (strcmp("-C", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -C\n");
+        return usage(argv[0]);
+      }
+      struct stat st;
+      if (stat(argv[arg_index + 1], &st) != 0 || !S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "Invalid argument to -C\n");
+        return usage(argv[0]);
+      }
+      unit_cache_directory = argv[arg_index + 1];
+      ++arg_index;
     } else {
       printf("2.4 %s\n", argv[arg_index]);
       return usage(argv[0]);
     }
     ++arg_index;
   }
-  if (arg_index == argc)
+  bool bulk = !store_directory.empty();
+  if (!bulk && (!manifest.empty() || bulk_memory_budget)) {
+    fprintf(stderr, "-M and -B require -O\n");
+    return usage(argv[0]);
+  }
+  if (bulk && (header_only || compress_output || !obj_name.empty() ||
+               !module_id.empty() || !debuginfod_urls.empty())) {
+    fprintf(stderr, "-i, -z, -n, -b and -u cannot be combined with -O\n");
+    return usage(argv[0]);
+  }
+  if (!debuginfod_cache.empty() && debuginfod_urls.empty()) {
+    fprintf(stderr, "-k requires -u\n");
+    return usage(argv[0]);
+  }
+  if (arg_index == argc && (!bulk || manifest.empty()))
     return usage(argv[0]);
   // Save stderr so it can be used below.
   FILE* saved_stderr = fdopen(dup(fileno(stderr)), "w");
@@ -136,6 +361,49 @@ int main(int argc, char** argv) {
       // Add this brace section to silence gcc warnings.
     }
   }
+  if (bulk) {
+    std::vector<std::string> binaries;
+    if (!manifest.empty()) {
+      std::ifstream manifest_file(manifest.c_str());
+      if (!manifest_file) {
+        fprintf(saved_stderr, "Could not read %s\n", manifest.c_str());
+        return 1;
+      }
+      std::string line;
+      while (std::getline(manifest_file, line)) {
+        if (!line.empty())
+          binaries.push_back(line);
+      }
+    }
+    for (; arg_index < argc; ++arg_index) {
+      struct stat st;
+      if (stat(argv[arg_index], &st) == 0 && S_ISDIR(st.st_mode))
+        FindELFFiles(argv[arg_index], &binaries);
+      else
+        binaries.push_back(argv[arg_index]);
+    }
+
+    SymbolData symbol_data = (handle_inlines ? INLINES : NO_DATA) |
+                             (cfi ? CFI : NO_DATA) | SYMBOLS_AND_FILES;
+    google_breakpad::DumpOptions options(symbol_data, handle_inter_cu_refs,
+                                         enable_multiple_field,
+                                         preserve_load_address);
+    options.thread_count = thread_count;
+    options.memory_budget = memory_budget;
+    options.unit_cache_directory = unit_cache_directory;
+    std::vector<std::string> failed_binaries;
+    if (!DumpSymbolsToStore(binaries, obj_os, std::vector<string>(), options,
+                            bulk_memory_budget, store_directory,
+                            &failed_binaries)) {
+      for (const std::string& failed_binary : failed_binaries) {
+        fprintf(saved_stderr, "Failed to write symbol file for %s.\n",
+                failed_binary.c_str());
+      }
+      return 1;
+    }
+    return 0;
+  }
+
   const char* binary;
   std::vector<string> debug_dirs;
   binary = argv[arg_index];
@@ -148,8 +416,18 @@ int main(int argc, char** argv) {
   if (obj_name.empty())
     obj_name = binary;
 
+  std::ostream* output = &std::cout;
+  std::unique_ptr<google_breakpad::BlockGzipWriter> gzip_writer;
+  std::unique_ptr<std::ostream> gzip_stream;
+  if (compress_output) {
+    gzip_writer.reset(
+        new google_breakpad::BlockGzipWriter(&std::cout, thread_count));
+    gzip_stream.reset(new std::ostream(gzip_writer.get()));
+    output = gzip_stream.get();
+  }
+
   if (header_only) {
-    if (!WriteSymbolFileHeader(binary, obj_name, obj_os, module_id, std::cout)) {
+    if (!WriteSymbolFileHeader(binary, obj_name, obj_os, module_id, *output)) {
       fprintf(saved_stderr, "Failed to process file.\n");
       return 1;
     }
@@ -158,12 +436,38 @@ int main(int argc, char** argv) {
                              (cfi ? CFI : NO_DATA) | SYMBOLS_AND_FILES;
     google_breakpad::DumpOptions options(symbol_data, handle_inter_cu_refs,
                                          enable_multiple_field, preserve_load_address);
+    options.thread_count = thread_count;
+    options.memory_budget = memory_budget;
+    options.unit_cache_directory = unit_cache_directory;
+    google_breakpad::LibcurlWrapper libcurl;
+    std::unique_ptr<google_breakpad::DebuginfodFinder> debuginfod_finder;
+    if (!debuginfod_urls.empty()) {
+      if (!libcurl.Init()) {
+        fprintf(saved_stderr, "Failed to load libcurl for -u.\n");
+        return 1;
+      }
+      libcurl.set_accept_compressed(true);
+      libcurl.set_follow_redirects(true);
+      if (debuginfod_cache.empty())
+        debuginfod_cache = DefaultDebuginfodCache();
+      debuginfod_finder.reset(new google_breakpad::DebuginfodFinder(
+          debuginfod_urls, debuginfod_cache,
+          [&libcurl](const std::string& url, const std::string& path) {
+            return FetchDebugFile(&libcurl, url, path);
+          }));
+      options.debug_file_finder = debuginfod_finder.get();
+    }
     if (!WriteSymbolFile(binary, obj_name, obj_os, module_id, debug_dirs, options,
-                         std::cout)) {
+                         *output)) {
       fprintf(saved_stderr, "Failed to write symbol file.\n");
       return 1;
     }
   }
 
+  if (gzip_writer && !gzip_writer->Finish()) {
+    fprintf(saved_stderr, "Failed to compress symbol file.\n");
+    return 1;
+  }
+
   return 0;
 }
@@ -36,22 +36,25 @@
 
 #include <elf.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <link.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <sys/user.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "common/linux/memory_mapped_file.h"
 #include "common/minidump_type_helper.h"
 #include "common/path_helper.h"
-#include "common/scoped_ptr.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
 #include "google_breakpad/common/minidump_format.h"
@@ -110,6 +113,12 @@ struct Options {
   bool use_filename;
   bool inc_guid;
   string so_basedir;
+  // If not empty, only these threads are written to the core.
+  std::set<pid_t> thread_ids;
+  // If not empty, only mappings of files whose names contain one of these
+  // strings are written to the core, along with the memory that the
+  // selected threads and the debugger need.
+  std::vector<string> mapping_names;
 };
 
 static void
@@ -140,6 +149,13 @@ Usage(int argc, const char* argv[]) {
           "             lookups to be done in this directory rather than the filesystem\n"
           "             layout as it exists in the crashing image.  This path should end\n"
           "             with a slash if it's a directory.  e.g. /var/lib/breakpad/\n"
+          "  -t <tid>   Only write the thread with ID <tid>.  May be repeated.\n"
+          "  -m <name>  Only write the mappings of files whose names contain <name>.\n"
+          "             May be repeated.  Thread stacks and the link map are always\n"
+          "             written.\n"
+          "\n"
+          "When the core is written to a regular file, runs of zero pages are left as\n"
+          "holes, so the core takes little more disk space than the memory it holds.\n"
           "", google_breakpad::BaseName(argv[0]).c_str());
 }
 
@@ -154,7 +170,7 @@ SetupOptions(int argc, const char* argv[], Options* options) {
   options->use_filename = false;
   options->inc_guid = false;
 
-  while ((ch = getopt(argc, (char * const*)argv, "fhio:S:v")) != -1) {
+  while ((ch = getopt(argc, (char * const*)argv, "fhim:o:S:t:v")) != -1) {
     switch (ch) {
       case 'h':
         Usage(argc, argv);
@@ -169,12 +185,25 @@ SetupOptions(int argc, const char* argv[], Options* options) {
       case 'i':
         options->inc_guid = true;
         break;
+      case 'm':
+        options->mapping_names.push_back(optarg);
+        break;
       case 'o':
         output_file = optarg;
         break;
       case 'S':
         options->so_basedir = optarg;
         break;
+      case 't': {
+        char* end;
+        long tid = strtol(optarg, &end, 0);
+        if (*optarg == '\0' || *end != '\0' || tid <= 0) {
+          fprintf(stderr, "%s: invalid thread ID %s\n", argv[0], optarg);
+          exit(1);
+        }
+        options->thread_ids.insert(static_cast<pid_t>(tid));
+        break;
+      }
       case 'v':
         options->verbose = true;
         break;
@@ -201,26 +230,123 @@ SetupOptions(int argc, const char* argv[], Options* options) {
   options->minidump_path = argv[optind];
 }
 
-// Write all of the given buffer, handling short writes and EINTR. Return true
-// iff successful.
-static bool
-writea(int fd, const void* idata, size_t length) {
-  const uint8_t* data = (const uint8_t*) idata;
+static const size_t kCorePageSize = 4096;
+static const size_t kCoreWriteBatch = 1 << 20;
+
+// Writes the core file.  Headers and notes are gathered and written out in
+// large batches rather than piece by piece.  If the output is a regular file,
+// writes go to explicit offsets and runs of zero pages are seeked over,
+// leaving holes in a sparse file.  Otherwise, e.g. for a pipe, everything is
+// written in order, zeros included.
+class CoreWriter {
+ public:
+  explicit CoreWriter(int fd) : fd_(fd), seekable_(false), offset_(0) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+        !(fcntl(fd, F_GETFL) & O_APPEND)) {
+      offset_ = lseek(fd, 0, SEEK_CUR);
+      seekable_ = offset_ != -1;
+      if (!seekable_)
+        offset_ = 0;
+    }
+    buffer_.reserve(kCoreWriteBatch);
+  }
 
-  size_t done = 0;
-  while (done < length) {
-    ssize_t r;
-    do {
-      r = write(fd, data + done, length - done);
-    } while (r == -1 && errno == EINTR);
+  // Appends |length| bytes at |data|.  Returns true iff successful.
+  bool Write(const void* data, size_t length) {
+    if (buffer_.size() + length > kCoreWriteBatch && !Flush())
+      return false;
+    if (length >= kCoreWriteBatch)
+      return WriteOut(data, length);
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + length);
+    return true;
+  }
+
+  // Appends |length| zero bytes, as a hole if it spans at least a page.
+  bool WriteZeros(size_t length) {
+    if (seekable_ && length >= kCorePageSize) {
+      if (!Flush())
+        return false;
+      offset_ += length;
+      return true;
+    }
+    while (length) {
+      if (buffer_.size() == kCoreWriteBatch && !Flush())
+        return false;
+      size_t zeros = std::min(length, kCoreWriteBatch - buffer_.size());
+      buffer_.insert(buffer_.end(), zeros, 0);
+      length -= zeros;
+    }
+    return true;
+  }
+
+  // Appends |length| bytes of memory at |data|, leaving a hole for each run
+  // of zero pages in it.
+  bool WriteMemory(const uint8_t* data, size_t length) {
+    if (!seekable_)
+      return Write(data, length);
+    size_t done = 0;
+    while (done < length) {
+      bool zero = IsZeroPage(data + done, length - done);
+      size_t run = 0;
+      do {
+        run += std::min(length - done - run, kCorePageSize);
+      } while (done + run < length &&
+               IsZeroPage(data + done + run, length - done - run) == zero);
+      if (!(zero ? WriteZeros(run) : Write(data + done, run)))
+        return false;
+      done += run;
+    }
+    return true;
+  }
 
-    if (r < 1)
+  // Writes out whatever is still gathered and, if the core ends in a hole,
+  // extends the file over it.  Returns true iff successful.
+  bool Finish() {
+    if (!Flush())
       return false;
-    done += r;
+    return !seekable_ || ftruncate(fd_, offset_) == 0;
+  }
+
+ private:
+  bool Flush() {
+    bool ok = WriteOut(buffer_.data(), buffer_.size());
+    buffer_.clear();
+    return ok;
+  }
+
+  // Writes all of |length| bytes at |data|, handling short writes and EINTR.
+  bool WriteOut(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t done = 0;
+    while (done < length) {
+      ssize_t r;
+      do {
+        r = seekable_ ? pwrite(fd_, bytes + done, length - done, offset_) :
+                        write(fd_, bytes + done, length - done);
+      } while (r == -1 && errno == EINTR);
+
+      if (r < 1)
+        return false;
+      done += r;
+      offset_ += r;
+    }
+    return true;
   }
 
-  return true;
-}
+  // Returns true if the page at |data|, or the |length| bytes left if that
+  // is less, are all zero.
+  static bool IsZeroPage(const uint8_t* data, size_t length) {
+    length = std::min(length, kCorePageSize);
+    return data[0] == 0 && memcmp(data, data + 1, length - 1) == 0;
+  }
+
+  int fd_;
+  bool seekable_;
+  off_t offset_;
+  std::vector<uint8_t> buffer_;
+};
 
 /* Dynamically determines the byte sex of the system. Returns non-zero
  * for big-endian machines.
@@ -295,14 +421,25 @@ struct CrashedProcess {
       : permissions(0xFFFFFFFF),
         start_address(0),
         end_address(0),
-        offset(0) {
+        offset(0),
+        data(NULL),
+        data_length(0),
+        data_offset(0),
+        data_size(0) {
     }
 
     uint32_t permissions;
     uint64_t start_address, end_address, offset;
     // The name we write out to the core.
     string filename;
-    string data;
+    // The contents written to the core for this mapping, if any: the
+    // |data_length| bytes at |data| (which point into the minidump or into
+    // CrashedProcess), placed |data_offset| bytes into |data_size| bytes
+    // that are zero otherwise.
+    const uint8_t* data;
+    size_t data_length;
+    size_t data_offset;
+    size_t data_size;
   };
   std::map<uint64_t, Mapping> mappings;
 
@@ -347,6 +484,8 @@ struct CrashedProcess {
   string dynamic_data;
   MDRawDebug debug;
   std::vector<MDRawLinkMap> link_map;
+  // The link map rebuilt for the core, which a mapping's data points into.
+  string link_map_data;
 };
 
 /* NT_FILE note as defined by linux kernel in fs/binfmt_elf.c
@@ -1045,7 +1184,7 @@ ParseExceptionStream(const Options& options, CrashedProcess* crashinfo,
 }
 
 static bool
-WriteThread(const Options& options, const CrashedProcess::Thread& thread,
+WriteThread(CoreWriter* writer, const CrashedProcess::Thread& thread,
             int fatal_signal) {
   struct prstatus pr;
   memset(&pr, 0, sizeof(pr));
@@ -1066,18 +1205,18 @@ WriteThread(const Options& options, const CrashedProcess::Thread& thread,
   nhdr.n_namesz = 5;
   nhdr.n_descsz = sizeof(struct prstatus);
   nhdr.n_type = NT_PRSTATUS;
-  if (!writea(options.out_fd, &nhdr, sizeof(nhdr)) ||
-      !writea(options.out_fd, "CORE\0\0\0\0", 8) ||
-      !writea(options.out_fd, &pr, sizeof(struct prstatus))) {
+  if (!writer->Write(&nhdr, sizeof(nhdr)) ||
+      !writer->Write("CORE\0\0\0\0", 8) ||
+      !writer->Write(&pr, sizeof(struct prstatus))) {
     return false;
   }
 
 #if defined(__i386__) || defined(__x86_64__)
   nhdr.n_descsz = sizeof(user_fpregs_struct);
   nhdr.n_type = NT_FPREGSET;
-  if (!writea(options.out_fd, &nhdr, sizeof(nhdr)) ||
-      !writea(options.out_fd, "CORE\0\0\0\0", 8) ||
-      !writea(options.out_fd, &thread.fpregs, sizeof(user_fpregs_struct))) {
+  if (!writer->Write(&nhdr, sizeof(nhdr)) ||
+      !writer->Write("CORE\0\0\0\0", 8) ||
+      !writer->Write(&thread.fpregs, sizeof(user_fpregs_struct))) {
     return false;
   }
 #endif
@@ -1085,9 +1224,9 @@ WriteThread(const Options& options, const CrashedProcess::Thread& thread,
 #if defined(__i386__)
   nhdr.n_descsz = sizeof(user_fpxregs_struct);
   nhdr.n_type = NT_PRXFPREG;
-  if (!writea(options.out_fd, &nhdr, sizeof(nhdr)) ||
-      !writea(options.out_fd, "LINUX\0\0\0", 8) ||
-      !writea(options.out_fd, &thread.fpxregs, sizeof(user_fpxregs_struct))) {
+  if (!writer->Write(&nhdr, sizeof(nhdr)) ||
+      !writer->Write("LINUX\0\0\0", 8) ||
+      !writer->Write(&thread.fpxregs, sizeof(user_fpxregs_struct))) {
     return false;
   }
 #endif
@@ -1148,9 +1287,20 @@ ParseModuleStream(const Options& options, CrashedProcess* crashinfo,
   }
 }
 
+// Makes |length| bytes at |data|, found at |addr| in the crashed process,
+// the contents of |mapping|, padded with zeros to whole pages.
+static void
+SetMappingData(CrashedProcess::Mapping* mapping, const uint8_t* data,
+               size_t length, uintptr_t addr) {
+  mapping->data = data;
+  mapping->data_length = length;
+  mapping->data_offset = addr & 4095;
+  mapping->data_size = (mapping->data_offset + length + 4095) & ~4095;
+}
+
 static void
-AddDataToMapping(CrashedProcess* crashinfo, const string& data,
-                 uintptr_t addr) {
+AddDataToMapping(CrashedProcess* crashinfo, const uint8_t* data,
+                 size_t length, uintptr_t addr) {
   for (std::map<uint64_t, CrashedProcess::Mapping>::iterator
          iter = crashinfo->mappings.begin();
        iter != crashinfo->mappings.end();
@@ -1180,8 +1330,7 @@ AddDataToMapping(CrashedProcess* crashinfo, const string& data,
       // file. But it is OK if the mapping itself extends past the end of
       // the data.
       mapping.start_address = addr & ~4095;
-      mapping.data.assign(addr & 4095, 0).append(data);
-      mapping.data.append(-mapping.data.size() & 4095, 0);
+      SetMappingData(&mapping, data, length, addr);
       crashinfo->mappings[mapping.start_address] = mapping;
       return;
     }
@@ -1191,9 +1340,8 @@ AddDataToMapping(CrashedProcess* crashinfo, const string& data,
   mapping.permissions = PF_R | PF_W;
   mapping.start_address = addr & ~4095;
   mapping.end_address =
-    (addr + data.size() + 4095) & ~4095;
-  mapping.data.assign(addr & 4095, 0).append(data);
-  mapping.data.append(-mapping.data.size() & 4095, 0);
+    (addr + length + 4095) & ~4095;
+  SetMappingData(&mapping, data, length, addr);
   crashinfo->mappings[mapping.start_address] = mapping;
 }
 
@@ -1204,8 +1352,7 @@ AugmentMappings(const Options& options, CrashedProcess* crashinfo,
   // Then adjust the mapping to include the stack dump.
   for (unsigned i = 0; i < crashinfo->threads.size(); ++i) {
     const CrashedProcess::Thread& thread = crashinfo->threads[i];
-    AddDataToMapping(crashinfo,
-                     string((char*)thread.stack, thread.stack_length),
+    AddDataToMapping(crashinfo, thread.stack, thread.stack_length,
                      thread.stack_addr);
   }
 
@@ -1213,7 +1360,7 @@ AugmentMappings(const Options& options, CrashedProcess* crashinfo,
   // the beginning of the address space, as this area should always be
   // available.
   static const uintptr_t start_addr = 4096;
-  string data;
+  string& data = crashinfo->link_map_data;
   struct r_debug debug = { 0 };
   debug.r_version = crashinfo->debug.version;
   debug.r_brk = (ElfW(Addr))crashinfo->debug.brk;
@@ -1298,7 +1445,8 @@ AugmentMappings(const Options& options, CrashedProcess* crashinfo,
     data.append(filename);
     data.append(8 - (filename.size() & 7), 0);
   }
-  AddDataToMapping(crashinfo, data, start_addr);
+  AddDataToMapping(crashinfo, (const uint8_t*)data.data(), data.size(),
+                   start_addr);
 
   // Map the page containing the _DYNAMIC array
   if (!crashinfo->dynamic_data.empty()) {
@@ -1324,13 +1472,56 @@ AugmentMappings(const Options& options, CrashedProcess* crashinfo,
         goto no_dt_debug;
       }
     }
-    AddDataToMapping(crashinfo, crashinfo->dynamic_data,
+    AddDataToMapping(crashinfo,
+                     (const uint8_t*)crashinfo->dynamic_data.data(),
+                     crashinfo->dynamic_data.size(),
                      (uintptr_t)crashinfo->debug.dynamic);
   } else {
     fprintf(stderr, "dynamic data empty\n");
   }
 }
 
+// Drops the threads that were not selected with -t, so that neither their
+// registers nor their stacks are written.
+static void
+SelectThreads(const Options& options, CrashedProcess* crashinfo) {
+  std::vector<CrashedProcess::Thread> selected;
+  for (const auto& thread : crashinfo->threads) {
+    if (options.thread_ids.count(thread.tid))
+      selected.push_back(thread);
+  }
+  if (options.verbose) {
+    fprintf(stderr, "Writing %zu of %zu threads\n",
+            selected.size(), crashinfo->threads.size());
+  }
+  crashinfo->threads.swap(selected);
+}
+
+// Drops the mappings that were not selected with -m.  Mappings that hold
+// data, i.e. the stacks of the threads written, the link map and _DYNAMIC,
+// are kept so that the debugger can still unwind and find the modules.
+static void
+SelectMappings(const Options& options, CrashedProcess* crashinfo) {
+  for (auto iter = crashinfo->mappings.begin();
+       iter != crashinfo->mappings.end();) {
+    bool selected = iter->second.data_size != 0;
+    for (const string& name : options.mapping_names) {
+      if (selected)
+        break;
+      selected = iter->second.filename.find(name) != string::npos;
+    }
+    if (selected) {
+      ++iter;
+    } else {
+      if (options.verbose) {
+        fprintf(stderr, "Skipping mapping 0x%" PRIx64 " \"%s\"\n",
+                iter->second.start_address, iter->second.filename.c_str());
+      }
+      iter = crashinfo->mappings.erase(iter);
+    }
+  }
+}
+
 int
 main(int argc, const char* argv[]) {
   Options options;
@@ -1418,7 +1609,11 @@ main(int argc, const char* argv[]) {
     }
   }
 
+  if (!options.thread_ids.empty())
+    SelectThreads(options, &crashinfo);
   AugmentMappings(options, &crashinfo, dump);
+  if (!options.mapping_names.empty())
+    SelectMappings(options, &crashinfo);
 
   // Write the ELF header. The file will look like:
   //   ELF header
@@ -1444,7 +1639,8 @@ main(int argc, const char* argv[]) {
   ehdr.e_phnum    = 1 +                         // PT_NOTE
                     crashinfo.mappings.size();  // memory mappings
   ehdr.e_shentsize= sizeof(Shdr);
-  if (!writea(options.out_fd, &ehdr, sizeof(Ehdr)))
+  CoreWriter writer(options.out_fd);
+  if (!writer.Write(&ehdr, sizeof(Ehdr)))
     return 1;
 
   struct NtFileNote nt_file;
@@ -1487,7 +1683,7 @@ main(int argc, const char* argv[]) {
   phdr.p_type = PT_NOTE;
   phdr.p_offset = offset;
   phdr.p_filesz = filesz;
-  if (!writea(options.out_fd, &phdr, sizeof(phdr)))
+  if (!writer.Write(&phdr, sizeof(phdr)))
     return 1;
 
   phdr.p_type = PT_LOAD;
@@ -1511,16 +1707,16 @@ main(int argc, const char* argv[]) {
     }
     phdr.p_vaddr = mapping.start_address;
     phdr.p_memsz = mapping.end_address - mapping.start_address;
-    if (mapping.data.size()) {
+    if (mapping.data_size) {
       offset += filesz;
-      filesz = mapping.data.size();
-      phdr.p_filesz = mapping.data.size();
+      filesz = mapping.data_size;
+      phdr.p_filesz = mapping.data_size;
       phdr.p_offset = offset;
     } else {
       phdr.p_filesz = 0;
       phdr.p_offset = 0;
     }
-    if (!writea(options.out_fd, &phdr, sizeof(phdr)))
+    if (!writer.Write(&phdr, sizeof(phdr)))
       return 1;
   }
 
@@ -1529,40 +1725,41 @@ main(int argc, const char* argv[]) {
   nhdr.n_namesz = 5;
   nhdr.n_descsz = sizeof(prpsinfo);
   nhdr.n_type = NT_PRPSINFO;
-  if (!writea(options.out_fd, &nhdr, sizeof(nhdr)) ||
-      !writea(options.out_fd, "CORE\0\0\0\0", 8) ||
-      !writea(options.out_fd, &crashinfo.prps, sizeof(prpsinfo))) {
+  if (!writer.Write(&nhdr, sizeof(nhdr)) ||
+      !writer.Write("CORE\0\0\0\0", 8) ||
+      !writer.Write(&crashinfo.prps, sizeof(prpsinfo))) {
     return 1;
   }
 
   nhdr.n_descsz = crashinfo.auxv_length;
   nhdr.n_type = NT_AUXV;
-  if (!writea(options.out_fd, &nhdr, sizeof(nhdr)) ||
-      !writea(options.out_fd, "CORE\0\0\0\0", 8) ||
-      !writea(options.out_fd, crashinfo.auxv, crashinfo.auxv_length)) {
+  if (!writer.Write(&nhdr, sizeof(nhdr)) ||
+      !writer.Write("CORE\0\0\0\0", 8) ||
+      !writer.Write(crashinfo.auxv, crashinfo.auxv_length)) {
     return 1;
   }
 
   nhdr.n_descsz = nt_file_data_sz;
   nhdr.n_type = NT_FILE;
-  if (!writea(options.out_fd, &nhdr, sizeof(nhdr)) ||
-      !writea(options.out_fd, "CORE\0\0\0\0", 8) ||
-      !writea(options.out_fd,
-      &nt_file.filename_count, sizeof(nt_file.filename_count)) ||
-      !writea(options.out_fd, &nt_file.page_sz, sizeof(nt_file.page_sz))) {
+  if (!writer.Write(&nhdr, sizeof(nhdr)) ||
+      !writer.Write("CORE\0\0\0\0", 8) ||
+      !writer.Write(&nt_file.filename_count,
+                    sizeof(nt_file.filename_count)) ||
+      !writer.Write(&nt_file.page_sz, sizeof(nt_file.page_sz))) {
     return 1;
   }
   for (auto iter = nt_file.file_mappings.begin();
        iter != nt_file.file_mappings.end(); iter++) {
-    if (!writea(options.out_fd, &*iter, sizeof(*iter)))
+    if (!writer.Write(&*iter, sizeof(*iter)))
       return 1;
   }
   for (auto iter = nt_file.filenames.begin();
        iter != nt_file.filenames.end(); iter++) {
-    if (!writea(options.out_fd, iter->c_str(), iter->length() + 1))
+    if (!writer.Write(iter->c_str(), iter->length() + 1))
       return 1;
   }
-  writea(options.out_fd, "\0\0\0\0", nt_file_align);
+  if (!writer.WriteZeros(nt_file_align))
+    return 1;
 
   for (const auto& current_thread : crashinfo.threads) {
     if (current_thread.tid == crashinfo.exception.tid) {
@@ -1571,32 +1768,37 @@ main(int argc, const char* argv[]) {
       // context is the state inside the exception handler. Using it would not
       // result in the expected stack trace from the time of the crash.
       // The stack memory has already been provided by current_thread.
-      WriteThread(options, crashinfo.exception, crashinfo.fatal_signal);
+      if (!WriteThread(&writer, crashinfo.exception, crashinfo.fatal_signal))
+        return 1;
       break;
     }
   }
 
   for (const auto& current_thread : crashinfo.threads) {
-    if (current_thread.tid != crashinfo.exception.tid)
-      WriteThread(options, current_thread, 0);
-  }
-
-  if (note_align) {
-    google_breakpad::scoped_array<char> scratch(new char[note_align]);
-    memset(scratch.get(), 0, note_align);
-    if (!writea(options.out_fd, scratch.get(), note_align))
+    if (current_thread.tid != crashinfo.exception.tid &&
+        !WriteThread(&writer, current_thread, 0)) {
       return 1;
+    }
   }
 
+  if (!writer.WriteZeros(note_align))
+    return 1;
+
   for (std::map<uint64_t, CrashedProcess::Mapping>::const_iterator iter =
          crashinfo.mappings.begin();
        iter != crashinfo.mappings.end(); ++iter) {
     const CrashedProcess::Mapping& mapping = iter->second;
-    if (mapping.data.size()) {
-      if (!writea(options.out_fd, mapping.data.c_str(), mapping.data.size()))
+    if (mapping.data_size) {
+      if (!writer.WriteZeros(mapping.data_offset) ||
+          !writer.WriteMemory(mapping.data, mapping.data_length) ||
+          !writer.WriteZeros(mapping.data_size - mapping.data_offset -
+                             mapping.data_length)) {
         return 1;
+      }
     }
   }
+  if (!writer.Finish())
+    return 1;
 
   if (options.out_fd != STDOUT_FILENO) {
     close(options.out_fd);
@@ -34,26 +34,33 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "client/linux/minidump_writer/minidump_writer.h"
 #include "common/path_helper.h"
 
 int main(int argc, char* argv[]) {
-  if (argc != 3) {
-    fprintf(stderr, "Usage: %s <process id> <minidump file>\n\n",
+  const bool live = argc == 4 && strcmp(argv[1], "--live") == 0;
+  if (argc != 3 && !live) {
+    fprintf(stderr, "Usage: %s [--live] <process id> <minidump file>\n\n",
             google_breakpad::BaseName(argv[0]).c_str());
     fprintf(stderr,
             "A tool to generate a minidump from a running process. The process "
             "resumes its\nactivity once the operation is completed. Permission "
-            "to trace the process is\nrequired.\n");
+            "to trace the process is\nrequired.\n\n");
+    fprintf(stderr,
+            "With --live, the process resumes as soon as the registers and "
+            "stacks of its\nthreads are written, and the rest of the minidump "
+            "is a best-effort snapshot\nof the running process.\n");
     return EXIT_FAILURE;
   }
 
-  pid_t process_id = atoi(argv[1]);
-  const char* minidump_file = argv[2];
+  pid_t process_id = atoi(argv[argc - 2]);
+  const char* minidump_file = argv[argc - 1];
 
-  if (!google_breakpad::WriteMinidump(minidump_file, process_id, process_id)) {
+  if (!google_breakpad::WriteMinidump(minidump_file, process_id, process_id,
+                                      live)) {
     fprintf(stderr, "Unable to generate minidump.\n");
     return EXIT_FAILURE;
   }
@@ -56,6 +56,7 @@ struct Options {
   string version;
   string proxy;
   string proxy_user_pwd;
+  bool compress;
   bool success;
 };
 
@@ -79,7 +80,8 @@ static void Start(Options *options) {
                                          "",
                                          &response,
                                          NULL,
-                                         &error);
+                                         &error,
+                                         options->compress);
 
   if (success) {
     printf("Successfully sent the minidump file.\n");
@@ -107,6 +109,7 @@ Usage(int argc, const char *argv[]) {
   fprintf(stderr, "-v:\t <version> Product version\n");
   fprintf(stderr, "-x:\t <host[:port]> Use HTTP proxy on given port\n");
   fprintf(stderr, "-u:\t <user[:password]> Set proxy user and password\n");
+  fprintf(stderr, "-z:\t Compress the request with gzip as it is sent\n");
   fprintf(stderr, "-h:\t Usage\n");
   fprintf(stderr, "-?:\t Usage\n");
 }
@@ -117,7 +120,8 @@ SetupOptions(int argc, const char *argv[], Options *options) {
   extern int optind;
   int ch;
 
-  while ((ch = getopt(argc, (char * const*)argv, "p:u:v:x:h?")) != -1) {
+  options->compress = false;
+  while ((ch = getopt(argc, (char * const*)argv, "p:u:v:x:zh?")) != -1) {
     switch (ch) {
       case 'p':
         options->product = optarg;
@@ -131,6 +135,9 @@ SetupOptions(int argc, const char *argv[], Options *options) {
       case 'x':
         options->proxy = optarg;
         break;
+      case 'z':
+        options->compress = true;
+        break;
 
       default:
         fprintf(stderr, "Invalid option '%c'\n", ch);
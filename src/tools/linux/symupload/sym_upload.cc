@@ -69,18 +69,23 @@ static void StrToUpper(std::string* str) {
 static void
 Usage(int argc, const char *argv[]) {
   fprintf(stderr, "Submit symbol information.\n");
-  fprintf(stderr, "Usage: %s [options...] <symbol-file> <upload-URL>\n",
+  fprintf(stderr,
+          "Usage: %s [options...] <symbol-file>... <upload-URL>\n",
           google_breakpad::BaseName(argv[0]).c_str());
   fprintf(stderr, "Options:\n");
   fprintf(stderr,
           "<symbol-file> should be created by using the dump_syms "
           "tool.\n");
   fprintf(stderr, "<upload-URL> is the destination for the upload\n");
+  fprintf(stderr, "Several symbol files may be given, and are uploaded "
+      "concurrently, each\nthread reusing its connections to the server.\n");
   fprintf(stderr, "-p:\t <protocol> One of ['sym-upload-v1',"
     " 'sym-upload-v2'], defaults to 'sym-upload-v1'.\n");
   fprintf(stderr, "-v:\t Version information (e.g., 1.2.3.4)\n");
   fprintf(stderr, "-x:\t <host[:port]> Use HTTP proxy on given port\n");
   fprintf(stderr, "-u:\t <user[:password]> Set proxy user and password\n");
+  fprintf(stderr, "-j:\t <threads> Upload up to this many symbol files at "
+      "once (default 1).\n");
   fprintf(stderr, "-h:\t Usage\n");
   fprintf(stderr, "-?:\t Usage\n");
   fprintf(stderr, "\n");
@@ -88,12 +93,20 @@ Usage(int argc, const char *argv[]) {
   fprintf(stderr, "-k:\t <API-key> A secret used to authenticate with the"
       " API.\n");
   fprintf(stderr, "-f:\t Force symbol upload if already exists.\n");
+  fprintf(stderr, "-z:\t Compress symbol files with gzip as they are "
+      "sent.\n");
+  fprintf(stderr, "-l:\t List the symbol files the server lacks, and upload "
+      "nothing.\n"
+      "\t Only each file's MODULE line is read, so the output of "
+      "'dump_syms -i'\n"
+      "\t can be checked before dumping the full symbols.\n");
   fprintf(stderr, "-t:\t <symbol-type> Explicitly set symbol upload type ("
       "default is 'breakpad').\n"
       "\t One of ['breakpad', 'elf', 'pe', 'macho', 'debug_only', 'dwp', "
       "'dsym', 'pdb'].\n"
       "\t Note: When this flag is set to anything other than 'breakpad', then "
-      "the '-c' and '-i' flags must also be set.\n");
+      "the '-c' and '-i' flags must also be set, and only one symbol file "
+      "may be given.\n");
   fprintf(stderr, "-c:\t <code-file> Explicitly set 'code_file' for symbol "
       "upload (basename of executable).\n");
   fprintf(stderr, "-i:\t <debug-id> Explicitly set 'debug_id' for symbol "
@@ -111,6 +124,10 @@ Usage(int argc, const char *argv[]) {
   fprintf(stderr, "    %s -p sym-upload-v2 -k mysecret123! -t elf "
       "-c app -i 11111111BBBB3333DDDD555555555555F "
       "path/to/symbol_file http://myuploadserver\n", argv[0]);
+  fprintf(stderr, "    [Upload a directory of symbol files, 8 at a time, "
+      "skipping those\n     the server already has]\n");
+  fprintf(stderr, "    %s -p sym-upload-v2 -k mysecret123! -j 8 -z "
+      "path/to/symbols/*.sym http://myuploadserver\n", argv[0]);
 }
 
 //=============================================================================
@@ -118,7 +135,7 @@ static void
 SetupOptions(int argc, const char *argv[], Options *options) {
   extern int optind, optopt;
   int ch;
-  constexpr char flag_pattern[] = "u:v:x:p:k:t:c:i:hf?";
+  constexpr char flag_pattern[] = "u:v:x:p:k:t:c:i:j:hflz?";
 
   while ((ch = getopt(argc, (char * const*)argv, flag_pattern)) != -1) {
     switch (ch) {
@@ -169,6 +186,26 @@ SetupOptions(int argc, const char *argv[], Options *options) {
       case 'f':
         options->force = true;
         break;
+      case 'l':
+        options->list_missing = true;
+        break;
+      case 'j':
+        options->parallelism = atoi(optarg);
+        if (options->parallelism < 1) {
+          fprintf(stderr, "Invalid thread count '%s'\n", optarg);
+          Usage(argc, argv);
+          exit(1);
+        }
+        break;
+      case 'z':
+#ifdef HAVE_LIBZ
+        options->compress = true;
+#else
+        fprintf(stderr, "%s: -z needs zlib, which this build lacks.\n",
+                argv[0]);
+        exit(1);
+#endif
+        break;
 
       default:
         fprintf(stderr, "Invalid option '%c'\n", ch);
@@ -177,7 +214,7 @@ SetupOptions(int argc, const char *argv[], Options *options) {
     }
   }
 
-  if ((argc - optind) != 2) {
+  if ((argc - optind) < 2) {
     fprintf(stderr, "%s: Missing symbols file and/or upload-URL\n", argv[0]);
     Usage(argc, argv);
     exit(1);
@@ -204,8 +241,25 @@ SetupOptions(int argc, const char *argv[], Options *options) {
     exit(1);
   }
 
+  if (options->list_missing &&
+      options->upload_protocol != UploadProtocol::SYM_UPLOAD_V2) {
+    fprintf(stderr, "%s: -l only works with 'sym-upload-v2'.\n", argv[0]);
+    Usage(argc, argv);
+    exit(1);
+  }
+  if ((argc - optind) > 2 && !is_breakpad_upload) {
+    fprintf(stderr, "\n");
+    fprintf(stderr, "%s: Only one symbol file may be uploaded with -c and "
+        "-i.\n", argv[0]);
+    fprintf(stderr, "\n");
+    Usage(argc, argv);
+    exit(1);
+  }
+
   options->symbolsPath = argv[optind];
-  options->uploadURLStr = argv[optind + 1];
+  if ((argc - optind) > 2)
+    options->symbol_files.assign(argv + optind, argv + argc - 1);
+  options->uploadURLStr = argv[argc - 1];
 }
 
 //=============================================================================
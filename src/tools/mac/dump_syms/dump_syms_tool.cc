@@ -39,8 +39,10 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -60,6 +62,10 @@ struct Options {
   string srcPath;
   string dsymPath;
   std::optional<ArchInfo> arch;
+  vector<ArchInfo> archs;
+  vector<string> images;
+  string output_dir;
+  int thread_count = 0;
   bool header_only = false;
   bool cfi = true;
   bool handle_inter_cu_refs = true;
@@ -139,6 +145,97 @@ static bool SetArchitecture(DumpSymbols& dump_symbols,
   return true;
 }
 
+// Return true if |cfi_module|, read from the Mach-O file, describes the same
+// code as |module|, read from its dSYM, so that its CFI can be copied over.
+// Otherwise, report the differences and return false.
+static bool CheckSplitModulesMatch(const Options& options,
+                                   const Module* module,
+                                   const Module* cfi_module) {
+  bool name_matches;
+  if (!options.module_name.empty()) {
+    // Ignore the basename of the dSYM and binary and use the passed-in module
+    // name.
+    name_matches = true;
+  } else {
+    name_matches = cfi_module->name() == module->name();
+  }
+
+  // Ensure that the modules are for the same debug code file.
+  if (!name_matches || cfi_module->os() != module->os() ||
+      cfi_module->architecture() != module->architecture() ||
+      cfi_module->identifier() != module->identifier()) {
+    fprintf(stderr, "Cannot generate a symbol file from split sources that do"
+                    " not match.\n");
+    if (!name_matches) {
+      fprintf(stderr, "Name mismatch: binary=[%s], dSYM=[%s]\n",
+              cfi_module->name().c_str(), module->name().c_str());
+    }
+    if (cfi_module->os() != module->os()) {
+      fprintf(stderr, "OS mismatch: binary=[%s], dSYM=[%s]\n",
+              cfi_module->os().c_str(), module->os().c_str());
+    }
+    if (cfi_module->architecture() != module->architecture()) {
+      fprintf(stderr, "Architecture mismatch: binary=[%s], dSYM=[%s]\n",
+              cfi_module->architecture().c_str(),
+              module->architecture().c_str());
+    }
+    if (cfi_module->identifier() != module->identifier()) {
+      fprintf(stderr, "Identifier mismatch: binary=[%s], dSYM=[%s]\n",
+              cfi_module->identifier().c_str(), module->identifier().c_str());
+    }
+    return false;
+  }
+  return true;
+}
+
+// Write |module| to its own file in |output_dir|.
+static bool WriteModuleFile(const string& output_dir, Module* module,
+                            SymbolData symbol_data) {
+  string path = output_dir + "/" + module->name() + "." +
+                module->architecture() + ".sym";
+  std::ofstream stream(path.c_str());
+  if (!module->Write(stream, symbol_data) || !stream.flush()) {
+    fprintf(stderr, "Failed to write %s\n", path.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Dump the images in options.images, or every image if none were given,
+// from the dyld shared cache |dump_symbols| has read.  Without
+// options.output_dir, the single image selected is written to stdout.
+static bool StartSharedCache(const Options& options,
+                             DumpSymbols& dump_symbols,
+                             SymbolData symbol_data) {
+  if (options.header_only || !options.dsymPath.empty()) {
+    fprintf(stderr, "-i and -g cannot be used with a dyld shared cache\n");
+    return false;
+  }
+
+  if (options.output_dir.empty()) {
+    if (options.images.size() != 1) {
+      fprintf(stderr, "Select one image with -s to dump a dyld shared cache"
+                      " to stdout, or use -O\n");
+      return false;
+    }
+    return dump_symbols.ReadSharedCacheImages(
+        options.images, 1, [symbol_data](Module* module) {
+          scoped_ptr<Module> scoped_module(module);
+          return module->Write(std::cout, symbol_data);
+        });
+  }
+
+  int thread_count = options.thread_count;
+  if (thread_count < 1)
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+  return dump_symbols.ReadSharedCacheImages(
+      options.images, thread_count,
+      [&options, symbol_data](Module* module) {
+        scoped_ptr<Module> scoped_module(module);
+        return WriteModuleFile(options.output_dir, module, symbol_data);
+      });
+}
+
 static bool Start(const Options& options) {
   SymbolData symbol_data =
       (options.handle_inlines ? INLINES : NO_DATA) |
@@ -165,6 +262,9 @@ static bool Start(const Options& options) {
   if (!dump_symbols.Read(primary_file))
     return false;
 
+  if (dump_symbols.IsSharedCache())
+    return StartSharedCache(options, dump_symbols, symbol_data);
+
   if (options.arch &&
       !SetArchitecture(dump_symbols, *options.arch, primary_file)) {
     return false;
@@ -194,40 +294,8 @@ static bool Start(const Options& options) {
       return false;
     scoped_ptr<Module> scoped_cfi_module(cfi_module);
 
-    bool name_matches;
-    if (!options.module_name.empty()) {
-      // Ignore the basename of the dSYM and binary and use the passed-in module
-      // name.
-      name_matches = true;
-    } else {
-      name_matches = cfi_module->name() == module->name();
-    }
-
-    // Ensure that the modules are for the same debug code file.
-    if (!name_matches || cfi_module->os() != module->os() ||
-        cfi_module->architecture() != module->architecture() ||
-        cfi_module->identifier() != module->identifier()) {
-      fprintf(stderr, "Cannot generate a symbol file from split sources that do"
-                      " not match.\n");
-      if (!name_matches) {
-        fprintf(stderr, "Name mismatch: binary=[%s], dSYM=[%s]\n",
-                cfi_module->name().c_str(), module->name().c_str());
-      }
-      if (cfi_module->os() != module->os()) {
-        fprintf(stderr, "OS mismatch: binary=[%s], dSYM=[%s]\n",
-                cfi_module->os().c_str(), module->os().c_str());
-      }
-      if (cfi_module->architecture() != module->architecture()) {
-        fprintf(stderr, "Architecture mismatch: binary=[%s], dSYM=[%s]\n",
-                cfi_module->architecture().c_str(),
-                module->architecture().c_str());
-      }
-      if (cfi_module->identifier() != module->identifier()) {
-        fprintf(stderr, "Identifier mismatch: binary=[%s], dSYM=[%s]\n",
-                cfi_module->identifier().c_str(), module->identifier().c_str());
-      }
+    if (!CheckSplitModulesMatch(options, module, cfi_module))
       return false;
-    }
 
     CopyCFIDataBetweenModules(module, cfi_module);
   }
@@ -235,17 +303,91 @@ static bool Start(const Options& options) {
   return module->Write(std::cout, symbol_data);
 }
 
+// Dump every architecture in options.archs, or every one in the file if
+// none were given, writing each to its own file in options.output_dir.  The
+// file is read once and its object files are converted concurrently.
+static bool StartAllArchitectures(const Options& options) {
+  SymbolData symbol_data =
+      (options.handle_inlines ? INLINES : NO_DATA) |
+      (options.cfi ? CFI : NO_DATA) | SYMBOLS_AND_FILES;
+  DumpSymbols dump_symbols(symbol_data, options.handle_inter_cu_refs,
+                           options.enable_multiple, options.module_name,
+                           options.prefer_extern_name);
+  dump_symbols.SetReportWarnings(options.report_warnings);
+
+  // As in Start, a dSYM and its Mach-O file form a split module.
+  bool split_module =
+    !options.dsymPath.empty() && !options.srcPath.empty() && options.cfi;
+  const string& primary_file =
+    split_module ? options.dsymPath : options.srcPath;
+
+  int thread_count = options.thread_count;
+  if (thread_count < 1)
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+
+  if (!dump_symbols.Read(primary_file))
+    return false;
+  if (dump_symbols.IsSharedCache())
+    return StartSharedCache(options, dump_symbols, symbol_data);
+  vector<Module*> modules;
+  if (!dump_symbols.ReadSymbolDataForArchitectures(options.archs,
+                                                   thread_count, &modules)) {
+    return false;
+  }
+  vector<std::unique_ptr<Module>> scoped_modules;
+  for (Module* module : modules)
+    scoped_modules.emplace_back(module);
+
+  if (split_module) {
+    // Select the same architectures from the Mach-O file as from the dSYM.
+    vector<ArchInfo> archs = options.archs;
+    if (archs.empty()) {
+      size_t available_size;
+      const SuperFatArch* available =
+          dump_symbols.AvailableArchitectures(&available_size);
+      for (size_t i = 0; i < available_size; i++) {
+        archs.push_back(
+            ArchInfo{static_cast<cpu_type_t>(available[i].cputype),
+                     static_cast<cpu_subtype_t>(available[i].cpusubtype)});
+      }
+    }
+    if (!dump_symbols.Read(options.srcPath))
+      return false;
+    vector<Module*> cfi_modules;
+    if (!dump_symbols.ReadSymbolDataForArchitectures(archs, thread_count,
+                                                     &cfi_modules)) {
+      return false;
+    }
+    vector<std::unique_ptr<Module>> scoped_cfi_modules;
+    for (Module* cfi_module : cfi_modules)
+      scoped_cfi_modules.emplace_back(cfi_module);
+    for (size_t i = 0; i < modules.size(); i++) {
+      if (!CheckSplitModulesMatch(options, modules[i], cfi_modules[i]))
+        return false;
+      CopyCFIDataBetweenModules(modules[i], cfi_modules[i]);
+    }
+  }
+
+  for (Module* module : modules) {
+    if (!WriteModuleFile(options.output_dir, module, symbol_data))
+      return false;
+  }
+  return true;
+}
+
 //=============================================================================
 static void Usage(int argc, const char *argv[]) {
   fprintf(stderr, "Output a Breakpad symbol file from a Mach-o file.\n");
   fprintf(stderr,
           "Usage: %s [-a ARCHITECTURE] [-c] [-g dSYM path] "
-          "[-n MODULE] [-x] <Mach-o file>\n",
+          "[-n MODULE] [-x] [-O DIRECTORY [-j THREADS]] [-s IMAGE]\n"
+          "       <Mach-o file or dyld shared cache>\n",
           argv[0]);
   fprintf(stderr, "\t-i: Output module header information only.\n");
   fprintf(stderr, "\t-w: Output warning information.\n");
   fprintf(stderr, "\t-a: Architecture type [default: native, or whatever is\n");
   fprintf(stderr, "\t    in the file, if it contains only one architecture]\n");
+  fprintf(stderr, "\t    With -O, may be given more than once\n");
   fprintf(stderr, "\t-g: Debug symbol file (dSYM) to dump in addition to the "
                   "Mach-o file\n");
   fprintf(stderr, "\t-c: Do not generate CFI section\n");
@@ -260,6 +402,18 @@ static void Usage(int argc, const char *argv[]) {
   fprintf(stderr,
           "\t-x: Prefer the PUBLIC (extern) name over the FUNC if\n"
           "they do not match.\n");
+  fprintf(stderr,
+          "\t-O: Dump the architectures given with -a, or every architecture\n"
+          "\t    in the file, at once, writing each to\n"
+          "\t    DIRECTORY/MODULE.ARCHITECTURE.sym\n");
+  fprintf(stderr,
+          "\t-j: With -O, dump up to THREADS architectures concurrently\n"
+          "\t    [default: the number of processors]\n");
+  fprintf(stderr,
+          "\t-s: Dump the image IMAGE, by install name or basename, from a\n"
+          "\t    dyld shared cache; may be given more than once. With -O,\n"
+          "\t    every image is dumped if none is given, up to THREADS\n"
+          "\t    images at once\n");
   fprintf(stderr, "\t-h: Usage\n");
   fprintf(stderr, "\t-?: Usage\n");
 }
@@ -269,7 +423,7 @@ static void SetupOptions(int argc, const char *argv[], Options *options) {
   extern int optind;
   signed char ch;
 
-  while ((ch = getopt(argc, (char* const*)argv, "iwa:g:crdm?hn:x")) != -1) {
+  while ((ch = getopt(argc, (char* const*)argv, "iwa:g:crdm?hn:xO:j:s:")) != -1) {
     switch (ch) {
       case 'i':
         options->header_only = true;
@@ -285,6 +439,7 @@ static void SetupOptions(int argc, const char *argv[], Options *options) {
           exit(1);
         }
         options->arch = arch_info;
+        options->archs.push_back(*arch_info);
         break;
       }
       case 'g':
@@ -308,6 +463,20 @@ static void SetupOptions(int argc, const char *argv[], Options *options) {
       case 'x':
         options->prefer_extern_name = true;
         break;
+      case 'O':
+        options->output_dir = optarg;
+        break;
+      case 's':
+        options->images.push_back(optarg);
+        break;
+      case 'j':
+        options->thread_count = atoi(optarg);
+        if (options->thread_count < 1) {
+          fprintf(stderr, "%s: Invalid thread count: %s\n", argv[0], optarg);
+          Usage(argc, argv);
+          exit(1);
+        }
+        break;
       case '?':
       case 'h':
         Usage(argc, argv);
@@ -322,6 +491,17 @@ static void SetupOptions(int argc, const char *argv[], Options *options) {
     exit(1);
   }
 
+  if (options->output_dir.empty() && options->archs.size() > 1) {
+    fprintf(stderr, "Only one architecture can be dumped without -O\n");
+    Usage(argc, argv);
+    exit(1);
+  }
+  if (!options->output_dir.empty() && options->header_only) {
+    fprintf(stderr, "-i cannot be combined with -O\n");
+    Usage(argc, argv);
+    exit(1);
+  }
+
   options->srcPath = argv[optind];
 }
 
@@ -331,7 +511,10 @@ int main (int argc, const char * argv[]) {
   bool result;
 
   SetupOptions(argc, argv, &options);
-  result = Start(options);
+  if (options.output_dir.empty())
+    result = Start(options);
+  else
+    result = StartAllArchitectures(options);
 
   return !result;
 }
@@ -502,6 +502,37 @@ BOOL CALLBACK MSSymbolServerConverter::SymFindFileInPathCallback(
   return FALSE;
 }
 
+MSSymbolServerConverter::LocateResult
+MSSymbolServerConverter::LocateSymbolAndPEFiles(const MissingSymbolInfo& missing,
+                                                string* pdb_file,
+                                                string* pe_file) {
+  assert(pdb_file);
+  assert(pe_file);
+  pe_file->clear();
+
+  LocateResult result = LocateSymbolFile(missing, pdb_file);
+  if (result != LOCATE_SUCCESS) {
+    fprintf(stderr, "Fallback to PE-only symbol generation for: %s\n",
+        missing.debug_file.c_str());
+    pdb_file->clear();
+    result = LocatePEFile(missing, pe_file);
+    if (result != LOCATE_SUCCESS) {
+      fprintf(stderr, "WARNING: Could not download: %s\n", pe_file->c_str());
+    }
+    return result;
+  }
+
+  // The conversion of a symbol file for a Windows 64-bit module requires
+  // loading of the executable file.  If there is no executable file, convert
+  // using only the PDB file.  Without an executable file, the conversion will
+  // fail for 64-bit modules but it should succeed for 32-bit modules.
+  result = LocatePEFile(missing, pe_file);
+  if (result != LOCATE_SUCCESS) {
+    fprintf(stderr, "WARNING: Could not download: %s\n", pe_file->c_str());
+  }
+  return LOCATE_SUCCESS;
+}
+
 MSSymbolServerConverter::LocateResult
 MSSymbolServerConverter::LocateAndConvertSymbolFile(
     const MissingSymbolInfo& missing,
@@ -517,32 +548,39 @@ MSSymbolServerConverter::LocateAndConvertSymbolFile(
   }
 
   string pdb_file;
-  LocateResult result = LocateSymbolFile(missing, &pdb_file);
+  string pe_file;
+  LocateResult result = LocateSymbolAndPEFiles(missing, &pdb_file, &pe_file);
   if (result != LOCATE_SUCCESS) {
-    fprintf(stderr, "Fallback to PE-only symbol generation for: %s\n",
-        missing.debug_file.c_str());
-    return LocateAndConvertPEFile(missing, keep_pe_file, converted_symbol_file,
-        out_pe_file);
+    return result;
   }
 
-  if (symbol_file && keep_symbol_file) {
-    *symbol_file = pdb_file;
+  if (out_pe_file && keep_pe_file) {
+    *out_pe_file = pe_file;
   }
 
-  // The conversion of a symbol file for a Windows 64-bit module requires
-  // loading of the executable file.  If there is no executable file, convert
-  // using only the PDB file.  Without an executable file, the conversion will
-  // fail for 64-bit modules but it should succeed for 32-bit modules.
-  string pe_file;
-  result = LocatePEFile(missing, &pe_file);
-  if (result != LOCATE_SUCCESS) {
-    fprintf(stderr, "WARNING: Could not download: %s\n", pe_file.c_str());
+  if (pdb_file.empty()) {
+    return ConvertPEFile(missing, pe_file, keep_pe_file,
+                         converted_symbol_file);
   }
 
-  if (out_pe_file && keep_pe_file) {
-    *out_pe_file = pe_file;
+  if (symbol_file && keep_symbol_file) {
+    *symbol_file = pdb_file;
   }
 
+  return ConvertSymbolFile(missing, pdb_file, pe_file, keep_symbol_file,
+                           keep_pe_file, converted_symbol_file);
+}
+
+MSSymbolServerConverter::LocateResult
+MSSymbolServerConverter::ConvertSymbolFile(const MissingSymbolInfo& missing,
+                                           const string& pdb_file,
+                                           const string& pe_file,
+                                           bool keep_symbol_file,
+                                           bool keep_pe_file,
+                                           string* converted_symbol_file) {
+  assert(converted_symbol_file);
+  converted_symbol_file->clear();
+
   // Conversion may fail because the file is corrupt.  If a broken file is
   // kept in the local cache, LocateSymbolFile will not hit the network again
   // to attempt to locate it.  To guard against problems like this, the
@@ -671,6 +709,17 @@ MSSymbolServerConverter::LocateAndConvertPEFile(
     *out_pe_file = pe_file;
   }
 
+  return ConvertPEFile(missing, pe_file, keep_pe_file, converted_symbol_file);
+}
+
+MSSymbolServerConverter::LocateResult
+MSSymbolServerConverter::ConvertPEFile(const MissingSymbolInfo& missing,
+                                       const string& pe_file,
+                                       bool keep_pe_file,
+                                       string* converted_symbol_file) {
+  assert(converted_symbol_file);
+  converted_symbol_file->clear();
+
   // Conversion may fail because the file is corrupt.  If a broken file is
   // kept in the local cache, LocatePEFile will not hit the network again
   // to attempt to locate it.  To guard against problems like this, the
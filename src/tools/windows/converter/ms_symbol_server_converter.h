@@ -196,6 +196,31 @@ class MSSymbolServerConverter {
                                       string* converted_symbol_file,
                                       string* pe_file);
 
+  // The locating half of LocateAndConvertSymbolFile: locates the symbol file
+  // and, if possible, the PE file for |missing|.  If the symbol file can't be
+  // located, |pdb_file| is left empty and the result of locating only the PE
+  // file is returned, as for the fallback to LocateAndConvertPEFile.
+  LocateResult LocateSymbolAndPEFiles(const MissingSymbolInfo& missing,
+                                      string* pdb_file,
+                                      string* pe_file);
+
+  // The conversion halves of LocateAndConvertSymbolFile and
+  // LocateAndConvertPEFile, for files already located.  |pe_file| may be
+  // empty for ConvertSymbolFile.  The files are deleted as by those
+  // functions, and the same values are returned.  Unlike the Locate
+  // functions, these don't use SymSrv, so several files may be converted on
+  // different threads while another is being located.
+  static LocateResult ConvertSymbolFile(const MissingSymbolInfo& missing,
+                                        const string& pdb_file,
+                                        const string& pe_file,
+                                        bool keep_symbol_file,
+                                        bool keep_pe_file,
+                                        string* converted_symbol_file);
+  static LocateResult ConvertPEFile(const MissingSymbolInfo& missing,
+                                    const string& pe_file,
+                                    bool keep_pe_file,
+                                    string* converted_symbol_file);
+
  private:
   // Locates the PDB or PE file (DLL or EXE) specified by the identifying
   // information in |debug_or_code_file| and |debug_or_code_id|, by checking
@@ -36,11 +36,18 @@
 #endif
 
 #include <cassert>
+#include <condition_variable>
 #include <cstdio>
+#include <cstdlib>
 #include <ctime>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <regex>
+#include <set>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "common/windows/http_upload.h"
@@ -309,7 +316,10 @@ static bool SafeToMakeExternalRequest(const MissingSymbolInfo& missing_info,
 // Converter options derived from command line parameters.
 struct ConverterOptions {
   ConverterOptions()
-      : report_fetch_failures(true), trace_symsrv(false), keep_files(false) {}
+      : report_fetch_failures(true),
+        trace_symsrv(false),
+        keep_files(false),
+        thread_count(0) {}
 
   ~ConverterOptions() {
   }
@@ -362,53 +372,64 @@ struct ConverterOptions {
   // If set then Breakpad/PE/PDB files won't be deleted after processing.
   bool keep_files;
 
+  // If non-zero, the number of threads converting symbol files, and the
+  // number uploading them, while another thread downloads.  If zero, each
+  // file is downloaded, converted and uploaded in turn.
+  int thread_count;
+
+  // File recording the missing symbol files already handled, which are
+  // skipped.  Empty if no record is kept.
+  string journal_file;
+
  private:
   // DISABLE_COPY_AND_ASSIGN
   ConverterOptions(const ConverterOptions&);
   ConverterOptions& operator=(const ConverterOptions&);
 };
 
-// ConverMissingSymbolFile takes a single MissingSymbolInfo structure and
-// attempts to locate it from the symbol servers provided in the
+// IsExeFile returns true if |missing_info| describes a main program
+// executable, whose symbols are only requested from the "full" servers.
+static bool IsExeFile(const MissingSymbolInfo& missing_info) {
+  if (missing_info.code_file.length() < 4) {
+    return false;
+  }
+
+  string code_extension =
+      missing_info.code_file.substr(missing_info.code_file.size() - 4);
+
+  // Firefox is a special case: .dll-only servers should be consulted for
+  // its symbols.  This enables us to get its symbols from Mozilla's
+  // symbol server when crashes occur in Google extension code hosted by a
+  // Firefox process.
+  return _stricmp(code_extension.c_str(), ".exe") == 0 &&
+         _stricmp(missing_info.code_file.c_str(), "firefox.exe") != 0;
+}
+
+// LocateMissingSymbolFile attempts to locate the files for a single
+// MissingSymbolInfo structure from the symbol servers provided in the
 // |options.*_msss_servers| arguments.  "Full" servers are those that will be
 // queried for all symbol files; "No-EXE" servers will only be queried for
-// modules whose missing symbol data indicates are not main program executables.
-// Results will be sent to the |options.upload_symbols_url| on success or
-// |options.fetch_symbol_failure_url| on failure, and the local cache will be
-// stored at |options.local_cache_path|.  Because nothing can be done even in
-// the event of a failure, this function returns no value, although it
-// may result in error messages being printed.
-static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
-                                     const ConverterOptions& options) {
-  string time_string = CurrentDateAndTime();
-  FprintfFlush(stdout, "converter: %s: attempting %s %s %s\n",
-               time_string.c_str(),
-               missing_info.debug_file.c_str(),
-               missing_info.debug_identifier.c_str(),
-               missing_info.version.c_str());
-
+// modules whose missing symbol data indicates are not main program
+// executables.  Internal servers are asked first, then external ones if that
+// fails and it's safe to do so.  If |convert| is set, the files are also
+// converted, and the converted file is returned in |converted_file|;
+// otherwise |symbol_file| is left empty if only a PE file was found, and the
+// files must be converted with MSSymbolServerConverter::ConvertSymbolFile or
+// ConvertPEFile.  Returns the result of the last lookup made.
+static MSSymbolServerConverter::LocateResult LocateMissingSymbolFile(
+    const MissingSymbolInfo& missing_info,
+    const ConverterOptions& options,
+    bool convert,
+    string* converted_file,
+    string* symbol_file,
+    string* pe_file) {
   // The first lookup is always to internal symbol servers.
   // Always ask the symbol servers identified as "full."
   vector<string> msss_servers = options.full_internal_msss_servers;
 
   // If the file is not an .exe file, also ask an additional set of symbol
   // servers, such as Microsoft's public symbol server.
-  bool is_exe = false;
-
-  if (missing_info.code_file.length() >= 4) {
-    string code_extension =
-        missing_info.code_file.substr(missing_info.code_file.size() - 4);
-
-    // Firefox is a special case: .dll-only servers should be consulted for
-    // its symbols.  This enables us to get its symbols from Mozilla's
-    // symbol server when crashes occur in Google extension code hosted by a
-    // Firefox process.
-    if (_stricmp(code_extension.c_str(), ".exe") == 0 &&
-        _stricmp(missing_info.code_file.c_str(), "firefox.exe") != 0) {
-      is_exe = true;
-    }
-  }
-
+  bool is_exe = IsExeFile(missing_info);
   if (!is_exe) {
     msss_servers.insert(msss_servers.end(),
                         options.no_exe_internal_msss_servers.begin(),
@@ -418,9 +439,6 @@ static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
   // If there are any suitable internal symbol servers, make a request.
   MSSymbolServerConverter::LocateResult located =
       MSSymbolServerConverter::LOCATE_FAILURE;
-  string converted_file;
-  string symbol_file;
-  string pe_file;
   if (msss_servers.size() > 0) {
     // Attempt to fetch the symbol file and convert it.
     FprintfFlush(stderr, "Making internal request for %s (%s)\n",
@@ -428,45 +446,19 @@ static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
                    missing_info.debug_identifier.c_str());
     MSSymbolServerConverter converter(options.local_cache_path, msss_servers,
                                       options.trace_symsrv);
-    located = converter.LocateAndConvertSymbolFile(
-        missing_info,
-        /*keep_symbol_file=*/true,
-        /*keep_pe_file=*/true, &converted_file, &symbol_file, &pe_file);
+    if (convert) {
+      located = converter.LocateAndConvertSymbolFile(
+          missing_info,
+          /*keep_symbol_file=*/true,
+          /*keep_pe_file=*/true, converted_file, symbol_file, pe_file);
+    } else {
+      located = converter.LocateSymbolAndPEFiles(missing_info, symbol_file,
+                                                 pe_file);
+    }
     switch (located) {
       case MSSymbolServerConverter::LOCATE_SUCCESS:
         FprintfFlush(stderr, "LocateResult = LOCATE_SUCCESS\n");
-        // Upload it. Don't bother checking the return value. If this
-        // succeeds, it should disappear from the missing symbol list.
-        // If it fails, something will print an error message indicating
-        // the cause of the failure, and the item will remain on the
-        // missing symbol list.
-        UploadSymbolFile(options.upload_symbols_url, options.api_key,
-                         missing_info.debug_file, missing_info.debug_identifier,
-                         converted_file, kSymbolUploadTypeBreakpad);
-        if (!options.keep_files)
-          remove(converted_file.c_str());
-
-        // Upload PDB/PE if we have them
-        if (!symbol_file.empty()) {
-          UploadSymbolFile(options.upload_symbols_url, options.api_key,
-                           missing_info.debug_file,
-                           missing_info.debug_identifier, symbol_file,
-                           kSymbolUploadTypePDB);
-          if (!options.keep_files)
-            remove(symbol_file.c_str());
-        }
-        if (!pe_file.empty()) {
-          UploadSymbolFile(options.upload_symbols_url, options.api_key,
-                           missing_info.code_file,
-                           missing_info.debug_identifier, pe_file,
-                           kSymbolUploadTypePE);
-          if (!options.keep_files)
-            remove(pe_file.c_str());
-        }
-
-        // Note: this does leave some directories behind that could be
-        // cleaned up.  The directories inside options.local_cache_path for
-        // debug_file/debug_identifier can be removed at this point.
+        // The files are uploaded by FinishMissingSymbolFile.
         break;
 
       case MSSymbolServerConverter::LOCATE_NOT_FOUND:
@@ -529,52 +521,78 @@ static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
                    missing_info.debug_identifier.c_str());
       MSSymbolServerConverter external_converter(
           options.local_cache_path, msss_servers, options.trace_symsrv);
-      located = external_converter.LocateAndConvertSymbolFile(
-          missing_info,
-          /*keep_symbol_file=*/true,
-          /*keep_pe_file=*/true, &converted_file, &symbol_file, &pe_file);
+      if (convert) {
+        located = external_converter.LocateAndConvertSymbolFile(
+            missing_info,
+            /*keep_symbol_file=*/true,
+            /*keep_pe_file=*/true, converted_file, symbol_file, pe_file);
+      } else {
+        located = external_converter.LocateSymbolAndPEFiles(
+            missing_info, symbol_file, pe_file);
+      }
     } else {
       FprintfFlush(stderr, "ERROR: No suitable external symbol servers.\n");
     }
   }
 
-  // Final handling for this symbol file is based on the result from the
-  // external request (if performed above), or on the result from the
-  // previous internal lookup.
+  return located;
+}
+
+// FinishMissingSymbolFile handles the result |located| of converting the
+// symbol file for |missing_info|.  Results will be sent to the
+// |options.upload_symbols_url| on success or |options.fetch_symbol_failure_url|
+// on failure.  Returns true if the symbol file was handled, and false if it
+// should be attempted again: if the failure may be transient, or an upload
+// failed.  The downloaded files are deleted, unless |options.keep_files| is
+// set or an upload failed, so that another attempt can find them in the local
+// cache.
+static bool FinishMissingSymbolFile(
+    const MissingSymbolInfo& missing_info,
+    MSSymbolServerConverter::LocateResult located,
+    const string& converted_file,
+    const string& symbol_file,
+    const string& pe_file,
+    const ConverterOptions& options) {
   switch (located) {
-    case MSSymbolServerConverter::LOCATE_SUCCESS:
+    case MSSymbolServerConverter::LOCATE_SUCCESS: {
       FprintfFlush(stderr, "LocateResult = LOCATE_SUCCESS\n");
-      // Upload it. Don't bother checking the return value. If this
-      // succeeds, it should disappear from the missing symbol list.
-      // If it fails, something will print an error message indicating
-      // the cause of the failure, and the item will remain on the
+      // Upload it. If this succeeds, it should disappear from the missing
+      // symbol list.  If it fails, something will print an error message
+      // indicating the cause of the failure, and the item will remain on the
       // missing symbol list.
-      UploadSymbolFile(options.upload_symbols_url, options.api_key,
-                       missing_info.debug_file, missing_info.debug_identifier,
-                       converted_file, kSymbolUploadTypeBreakpad);
-      if (!options.keep_files)
-        remove(converted_file.c_str());
+      bool uploaded =
+          UploadSymbolFile(options.upload_symbols_url, options.api_key,
+                           missing_info.debug_file,
+                           missing_info.debug_identifier, converted_file,
+                           kSymbolUploadTypeBreakpad);
 
       // Upload PDB/PE if we have them
       if (!symbol_file.empty()) {
-        UploadSymbolFile(options.upload_symbols_url, options.api_key,
-                         missing_info.debug_file, missing_info.debug_identifier,
-                         symbol_file, kSymbolUploadTypePDB);
-        if (!options.keep_files)
-          remove(symbol_file.c_str());
+        uploaded &= UploadSymbolFile(options.upload_symbols_url,
+                                     options.api_key, missing_info.debug_file,
+                                     missing_info.debug_identifier,
+                                     symbol_file, kSymbolUploadTypePDB);
       }
       if (!pe_file.empty()) {
-        UploadSymbolFile(options.upload_symbols_url, options.api_key,
-                         missing_info.code_file, missing_info.debug_identifier,
-                         pe_file, kSymbolUploadTypePE);
-        if (!options.keep_files)
+        uploaded &= UploadSymbolFile(options.upload_symbols_url,
+                                     options.api_key, missing_info.code_file,
+                                     missing_info.debug_identifier, pe_file,
+                                     kSymbolUploadTypePE);
+      }
+
+      if (!options.keep_files && uploaded) {
+        remove(converted_file.c_str());
+        if (!symbol_file.empty())
+          remove(symbol_file.c_str());
+        if (!pe_file.empty())
           remove(pe_file.c_str());
       }
 
       // Note: this does leave some directories behind that could be
       // cleaned up.  The directories inside options.local_cache_path for
       // debug_file/debug_identifier can be removed at this point.
-      break;
+      return uploaded;
+    }
 
     case MSSymbolServerConverter::LOCATE_NOT_FOUND:
       // The symbol file definitively didn't exist.  Inform the server.
@@ -590,7 +608,7 @@ static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
       } else {
         FprintfFlush(stderr, "SendFetchFailedPing failed\n");
       }
-      break;
+      return true;
 
     case MSSymbolServerConverter::LOCATE_RETRY:
       FprintfFlush(stderr, "LocateResult = LOCATE_RETRY\n");
@@ -602,7 +620,7 @@ static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
                    missing_info.debug_file.c_str(),
                    missing_info.debug_identifier.c_str(),
                    missing_info.version.c_str());
-      break;
+      return false;
 
     case MSSymbolServerConverter::LOCATE_HTTP_HTTPS_REDIR:
       FprintfFlush(
@@ -611,7 +629,7 @@ static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
           "One of the specified URLs is using HTTP, which causes a redirect "
           "from the server to HTTPS, which causes the SymSrv lookup to fail.\n"
           "This URL must be replaced with the correct HTTPS URL.\n");
-      break;
+      return false;
 
     case MSSymbolServerConverter::LOCATE_FAILURE:
       FprintfFlush(stderr, "LocateResult = LOCATE_FAILURE\n");
@@ -626,7 +644,7 @@ static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
       } else {
         FprintfFlush(stderr, "SendFetchFailedPing failed\n");
       }
-      break;
+      return true;
 
     default:
       FprintfFlush(
@@ -635,10 +653,233 @@ static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
           "LocateAndConvertSymbolFile()\n",
           located);
       assert(0);
-      break;
+      return false;
   }
 }
 
+// ConvertMissingSymbolFile takes a single MissingSymbolInfo structure,
+// attempts to locate and convert it with LocateMissingSymbolFile, and
+// handles the result with FinishMissingSymbolFile.  Because nothing can be
+// done even in the event of a failure, this function only returns whether
+// the symbol file was handled, although it may result in error messages
+// being printed.
+static bool ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
+                                     const ConverterOptions& options) {
+  string time_string = CurrentDateAndTime();
+  FprintfFlush(stdout, "converter: %s: attempting %s %s %s\n",
+               time_string.c_str(),
+               missing_info.debug_file.c_str(),
+               missing_info.debug_identifier.c_str(),
+               missing_info.version.c_str());
+
+  string converted_file;
+  string symbol_file;
+  string pe_file;
+  MSSymbolServerConverter::LocateResult located = LocateMissingSymbolFile(
+      missing_info, options, /*convert=*/true, &converted_file, &symbol_file,
+      &pe_file);
+
+  // Final handling for this symbol file is based on the result from the
+  // external request (if performed), or on the result from the internal
+  // lookup.
+  return FinishMissingSymbolFile(missing_info, located, converted_file,
+                                 symbol_file, pe_file, options);
+}
+
+// A record of the missing symbol files that have been handled, so that a
+// converter restarted after a crash can skip them.  Each line of the file is
+// a decoded line of the missing symbol list.  The downloaded files of an
+// entry not yet recorded are still in the local cache, so restarting doesn't
+// download them again.
+class ConversionJournal {
+ public:
+  ConversionJournal() : file_(NULL) {}
+
+  ~ConversionJournal() {
+    if (file_)
+      fclose(file_);
+  }
+
+  // Reads the entries already recorded in |journal_file|, if it exists, and
+  // opens it to record more.  Returns true on success.
+  bool Open(const string& journal_file) {
+    FILE* fp = fopen(journal_file.c_str(), "rt");
+    if (fp) {
+      char buffer[1024 * 8];
+      while (fgets(buffer, sizeof(buffer), fp) != NULL) {
+        string line(buffer);
+        if (!line.empty() && line[line.size() - 1] == '\n')
+          line.erase(line.size() - 1);
+        lines_.insert(line);
+      }
+      fclose(fp);
+    }
+
+    file_ = fopen(journal_file.c_str(), "at");
+    if (!file_) {
+      FprintfFlush(stderr, "ConversionJournal: can't open %s\n",
+                   journal_file.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  // Returns true if |line| has been recorded.
+  bool Contains(const string& line) const {
+    return lines_.find(line) != lines_.end();
+  }
+
+  // Records |line| as handled.  May be called from several threads.
+  void Add(const string& line) {
+    if (!file_)
+      return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    FprintfFlush(file_, "%s\n", line.c_str());
+  }
+
+  size_t size() const { return lines_.size(); }
+
+ private:
+  std::set<string> lines_;
+  FILE* file_;
+  std::mutex mutex_;
+
+  // DISABLE_COPY_AND_ASSIGN
+  ConversionJournal(const ConversionJournal&);
+  ConversionJournal& operator=(const ConversionJournal&);
+};
+
+// A queue between two stages of ConvertMissingSymbolFiles.  Push waits while
+// the queue is full, so that a fast stage can't get far ahead of a slow one.
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(size_t capacity)
+      : capacity_(capacity), closed_(false) {}
+
+  // Adds |item| once there is room for it.
+  void Push(T item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] { return items_.size() < capacity_; });
+    items_.push_back(std::move(item));
+    changed_.notify_all();
+  }
+
+  // Removes the oldest item into |item|, waiting for one if need be.
+  // Returns false once the queue is closed and empty.
+  bool Pop(T* item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] { return closed_ || !items_.empty(); });
+    if (items_.empty())
+      return false;
+    *item = std::move(items_.front());
+    items_.pop_front();
+    changed_.notify_all();
+    return true;
+  }
+
+  // Indicates that no more items will be pushed.
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    changed_.notify_all();
+  }
+
+ private:
+  const size_t capacity_;
+  std::deque<T> items_;
+  bool closed_;
+  std::mutex mutex_;
+  std::condition_variable changed_;
+
+  // DISABLE_COPY_AND_ASSIGN
+  BoundedQueue(const BoundedQueue&);
+  BoundedQueue& operator=(const BoundedQueue&);
+};
+
+// A missing symbol file as it moves through ConvertMissingSymbolFiles.
+struct ConversionJob {
+  ConversionJob() : located(MSSymbolServerConverter::LOCATE_FAILURE) {}
+
+  // The decoded line of the missing symbol list, for the journal.
+  string line;
+  MissingSymbolInfo missing_info;
+  MSSymbolServerConverter::LocateResult located;
+  string converted_file;
+  string symbol_file;
+  string pe_file;
+};
+
+// ConvertMissingSymbolFiles does the work of ConvertMissingSymbolFile for
+// each of |jobs| in a pipeline: the calling thread locates the files, one at
+// a time because DbgHelp and SymSrv are single-threaded, while
+// |options.thread_count| threads convert them and as many upload the results.
+// Each handled job is recorded in |journal|.
+static void ConvertMissingSymbolFiles(const vector<ConversionJob>& jobs,
+                                      const ConverterOptions& options,
+                                      ConversionJournal* journal) {
+  const size_t kQueueCapacity = 2 * options.thread_count;
+  BoundedQueue<ConversionJob> located_jobs(kQueueCapacity);
+  BoundedQueue<ConversionJob> converted_jobs(kQueueCapacity);
+
+  vector<std::thread> converters;
+  for (int i = 0; i < options.thread_count; ++i) {
+    converters.push_back(std::thread([&located_jobs, &converted_jobs] {
+      ConversionJob job;
+      while (located_jobs.Pop(&job)) {
+        if (job.located == MSSymbolServerConverter::LOCATE_SUCCESS) {
+          if (!job.symbol_file.empty()) {
+            job.located = MSSymbolServerConverter::ConvertSymbolFile(
+                job.missing_info, job.symbol_file, job.pe_file,
+                /*keep_symbol_file=*/true,
+                /*keep_pe_file=*/true, &job.converted_file);
+          } else {
+            job.located = MSSymbolServerConverter::ConvertPEFile(
+                job.missing_info, job.pe_file, /*keep_pe_file=*/true,
+                &job.converted_file);
+          }
+        }
+        converted_jobs.Push(std::move(job));
+      }
+    }));
+  }
+
+  vector<std::thread> uploaders;
+  for (int i = 0; i < options.thread_count; ++i) {
+    uploaders.push_back(std::thread([&converted_jobs, &options, journal] {
+      ConversionJob job;
+      while (converted_jobs.Pop(&job)) {
+        if (FinishMissingSymbolFile(job.missing_info, job.located,
+                                    job.converted_file, job.symbol_file,
+                                    job.pe_file, options)) {
+          journal->Add(job.line);
+        }
+      }
+    }));
+  }
+
+  for (const ConversionJob& pending : jobs) {
+    ConversionJob job = pending;
+    string time_string = CurrentDateAndTime();
+    FprintfFlush(stdout, "converter: %s: attempting %s %s %s\n",
+                 time_string.c_str(),
+                 job.missing_info.debug_file.c_str(),
+                 job.missing_info.debug_identifier.c_str(),
+                 job.missing_info.version.c_str());
+    job.located = LocateMissingSymbolFile(job.missing_info, options,
+                                          /*convert=*/false,
+                                          &job.converted_file,
+                                          &job.symbol_file, &job.pe_file);
+    located_jobs.Push(std::move(job));
+  }
+
+  located_jobs.Close();
+  for (std::thread& converter : converters)
+    converter.join();
+  converted_jobs.Close();
+  for (std::thread& uploader : uploaders)
+    uploader.join();
+}
 
 // Reads the contents of file |file_name| and populates |contents|.
 // Returns true on success.
@@ -658,8 +899,19 @@ static bool ReadFile(string file_name, string* contents) {
 
 // ConvertMissingSymbolsList obtains a missing symbol list from
 // |options.missing_symbols_url| or |options.missing_symbols_file| and calls
-// ConvertMissingSymbolFile for each missing symbol file in the list.
+// ConvertMissingSymbolFile for each missing symbol file in the list, or
+// ConvertMissingSymbolFiles for all of them if |options.thread_count| is set.
+// Files recorded in |options.journal_file| are skipped.
 static bool ConvertMissingSymbolsList(const ConverterOptions& options) {
+  ConversionJournal journal;
+  if (!options.journal_file.empty()) {
+    if (!journal.Open(options.journal_file)) {
+      return false;
+    }
+    FprintfFlush(stderr, "Skipping %d missing symbol files in journal.\n",
+                 static_cast<int>(journal.size()));
+  }
+
   // Set param to indicate requesting for encoded response.
   map<wstring, wstring> parameters;
   parameters[L"product"] = kConverterProductName;
@@ -682,6 +934,7 @@ static bool ConvertMissingSymbolsList(const ConverterOptions& options) {
   FprintfFlush(stderr, "Found %d missing symbol files in list.\n",
                missing_symbol_lines.size() - 1);  // last line is empty.
   int convert_attempts = 0;
+  vector<ConversionJob> jobs;
   for (vector<string>::const_iterator iterator = missing_symbol_lines.begin();
        iterator != missing_symbol_lines.end();
        ++iterator) {
@@ -711,8 +964,23 @@ static bool ConvertMissingSymbolsList(const ConverterOptions& options) {
       continue;
     }
 
+    if (journal.Contains(line)) {
+      continue;
+    }
+
     ++convert_attempts;
-    ConvertMissingSymbolFile(missing_info, options);
+    if (options.thread_count > 0) {
+      ConversionJob job;
+      job.line = line;
+      job.missing_info = missing_info;
+      jobs.push_back(job);
+    } else if (ConvertMissingSymbolFile(missing_info, options)) {
+      journal.Add(line);
+    }
+  }
+
+  if (!jobs.empty()) {
+    ConvertMissingSymbolFiles(jobs, options, &journal);
   }
 
   // Say something reassuring, since ConvertMissingSymbolFile was never called
@@ -748,6 +1016,12 @@ static int usage(const char* program_name) {
       "                               traced to stderr.\n"
       "    -keep-files                If set then don't delete Breakpad/PE/\n"
       "                               PDB files after conversion.\n"
+      "    -j  <threads>              Convert and upload on this many\n"
+      "                               threads each, while downloading the\n"
+      "                               next files.\n"
+      "    -r  <journal_file>         Record handled files here, and skip\n"
+      "                               those already recorded, so that an\n"
+      "                               interrupted run can be resumed.\n"
       " Note that any server specified by -f or -n that starts with \\filer\n"
       " will be treated as internal, and all others as external.\n",
       program_name);
@@ -848,6 +1122,13 @@ int main(int argc, char** argv) {
       }
     } else if (option == "-b") {
       blacklist_regex_str = value;
+    } else if (option == "-j") {
+      options.thread_count = atoi(value.c_str());
+      if (options.thread_count < 1) {
+        return usage(argv[0]);
+      }
+    } else if (option == "-r") {
+      options.journal_file = value;
     } else {
       return usage(argv[0]);
     }
@@ -34,6 +34,7 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <wchar.h>
 
 #include <memory>
@@ -48,7 +49,8 @@ using std::unique_ptr;
 using std::wstring;
 
 int usage(const wchar_t* self) {
-  fprintf(stderr, "Usage: %ws [--pe] [--i] <file.[pdb|exe|dll]>\n", self);
+  fprintf(stderr, "Usage: %ws [--pe] [--i] [--j <threads>] "
+          "<file.[pdb|exe|dll]>\n", self);
   fprintf(stderr, "Options:\n");
   fprintf(stderr,
           "--pe:\tRead debugging information from PE file and do "
@@ -57,6 +59,11 @@ int usage(const wchar_t* self) {
   fprintf(stderr,
           "--i:\tOutput INLINE/INLINE_ORIGIN record\n"
           "\tThis cannot be used with [--pe].\n");
+  fprintf(stderr,
+          "--j <threads>:\tGather functions and public symbols on this many "
+          "threads, each with its own DIA session.\n"
+          "\tThe output is the same as with one thread, the default.\n"
+          "\tThis cannot be used with [--pe].\n");
   return 1;
 }
 
@@ -64,6 +71,7 @@ int wmain(int argc, wchar_t** argv) {
   bool success = false;
   bool pe = false;
   bool handle_inline = false;
+  int thread_count = 1;
   int arg_index = 1;
   while (arg_index < argc && wcslen(argv[arg_index]) > 0 &&
          wcsncmp(L"--", argv[arg_index], 2) == 0) {
@@ -71,11 +79,18 @@ int wmain(int argc, wchar_t** argv) {
       pe = true;
     } else if (wcscmp(L"--i", argv[arg_index]) == 0) {
       handle_inline = true;
+    } else if (wcscmp(L"--j", argv[arg_index]) == 0 &&
+               arg_index + 1 < argc) {
+      thread_count = _wtoi(argv[++arg_index]);
+      if (thread_count < 1) {
+        usage(argv[0]);
+        return 1;
+      }
     }
     ++arg_index;
   }
 
-  if ((pe && handle_inline) || arg_index == argc) {
+  if ((pe && (handle_inline || thread_count > 1)) || arg_index == argc) {
     usage(argv[0]);
     return 1;
   }
@@ -86,6 +101,7 @@ int wmain(int argc, wchar_t** argv) {
     success = pe_writer.WriteSymbols(stdout);
   } else {
     PDBSourceLineWriter pdb_writer(handle_inline);
+    pdb_writer.set_thread_count(thread_count);
     if (!pdb_writer.Open(wstring(file_path), PDBSourceLineWriter::ANY_FILE)) {
       fprintf(stderr, "Open failed.\n");
       return 1;